@@ -0,0 +1,70 @@
+// Encode and decode base64 in a Transform stream, either with the native
+// incremental encoder and decoder or by carrying the bytes of an incomplete
+// group over in JavaScript.
+'use strict';
+
+const common = require('../common.js');
+const { Transform } = require('stream');
+
+const bench = common.createBenchmark(main, {
+  op: ['encode', 'decode'],
+  impl: ['native', 'js'],
+  chunkSize: [1024, 64 * 1024],
+  size: [64 * 1024 * 1024],
+}, {
+  flags: ['--expose-internals'],
+});
+
+function createNative(op) {
+  const { internalBinding } = require('internal/test/binding');
+  const { Base64Encoder, Base64Decoder } = internalBinding('encoding_binding');
+  const coder = op === 'encode' ? new Base64Encoder(false) :
+    new Base64Decoder(false);
+  const method = op === 'encode' ? 'encode' : 'decode';
+  return new Transform({
+    transform(chunk, encoding, callback) {
+      callback(null, coder[method](chunk, false));
+    },
+    flush(callback) {
+      callback(null, coder[method](undefined, true));
+    },
+  });
+}
+
+function createJS(op) {
+  const groupSize = op === 'encode' ? 3 : 4;
+  const from = op === 'encode' ? undefined : 'base64';
+  let pending = Buffer.alloc(0);
+  const convert = (buffer) => {
+    return op === 'encode' ?
+      Buffer.from(buffer.toString('base64'), 'latin1') :
+      Buffer.from(buffer.toString('latin1'), from);
+  };
+  return new Transform({
+    transform(chunk, encoding, callback) {
+      const data = pending.length > 0 ? Buffer.concat([pending, chunk]) : chunk;
+      const end = data.length - data.length % groupSize;
+      pending = data.subarray(end);
+      callback(null, convert(data.subarray(0, end)));
+    },
+    flush(callback) {
+      callback(null, convert(pending));
+    },
+  });
+}
+
+function main({ op, impl, chunkSize, size }) {
+  let input = Buffer.alloc(chunkSize, 'abc');
+  if (op === 'decode') {
+    input = Buffer.from(input.toString('base64').slice(0, chunkSize), 'latin1');
+  }
+  const chunks = size / chunkSize;
+
+  const stream = impl === 'native' ? createNative(op) : createJS(op);
+  stream.on('data', () => {});
+  stream.on('end', () => bench.end(size));
+
+  bench.start();
+  for (let i = 0; i < chunks; i++) stream.write(input);
+  stream.end();
+}
@@ -0,0 +1,68 @@
+#include <node.h>
+#include <uv.h>
+#include <v8.h>
+
+// The same as napi_binding.c, on top of uv_queue_work() and
+// node::AsyncResource.
+class Run : public node::AsyncResource {
+ public:
+  Run(v8::Isolate* isolate, uint32_t n, v8::Local<v8::Function> done)
+      : AsyncResource(isolate, v8::Object::New(isolate), "bench"),
+        isolate_(isolate),
+        left_(n),
+        done_(isolate, done) {}
+
+  void QueueWork() {
+    uv_work_t* req = new uv_work_t();
+    req->data = this;
+    uv_queue_work(
+        node::GetCurrentEventLoop(isolate_),
+        req,
+        [](uv_work_t* req) {},
+        [](uv_work_t* req, int status) {
+          Run* run = static_cast<Run*>(req->data);
+          delete req;
+          run->Complete();
+        });
+    left_--;
+    in_flight_++;
+  }
+
+  uint32_t left() const { return left_; }
+  uint32_t in_flight() const { return in_flight_; }
+
+ private:
+  void Complete() {
+    in_flight_--;
+    if (left_ > 0) {
+      QueueWork();
+    } else if (in_flight_ == 0) {
+      v8::HandleScope scope(isolate_);
+      MakeCallback(done_.Get(isolate_), 0, nullptr);
+      delete this;
+    }
+  }
+
+  v8::Isolate* isolate_;
+  uint32_t left_;
+  uint32_t in_flight_ = 0;
+  v8::Global<v8::Function> done_;
+};
+
+static void Start(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  uint32_t concurrency = args[1]->Uint32Value(context).FromJust();
+  Run* run = new Run(isolate,
+                     args[0]->Uint32Value(context).FromJust(),
+                     args[2].As<v8::Function>());
+  while (run->in_flight() < concurrency && run->left() > 0) run->QueueWork();
+}
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> module,
+                void* data) {
+  NODE_SET_METHOD(target, "start", Start);
+}
+
+NODE_MODULE(NODE_GYP_MODULE_NAME, Initialize)
@@ -0,0 +1,26 @@
+// Compare the round trip of empty work through the libuv threadpool, as
+// Node-API async work and as plain uv_queue_work() requests.
+'use strict';
+
+const common = require('../../common.js');
+
+let v8;
+let napi;
+try {
+  v8 = require(`./build/${common.buildType}/binding`);
+  napi = require(`./build/${common.buildType}/napi_binding`);
+} catch {
+  console.error(`${__filename}: Binding failed to load`);
+  process.exit(0);
+}
+
+const bench = common.createBenchmark(main, {
+  type: ['v8', 'napi'],
+  concurrency: [1, 16],
+  n: [1e5],
+});
+
+function main({ n, type, concurrency }) {
+  bench.start();
+  (type === 'v8' ? v8 : napi).start(n, concurrency, () => bench.end(n));
+}
@@ -0,0 +1,78 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <node_api.h>
+
+#define NAPI_CALL(call)                                                        \
+  do {                                                                         \
+    napi_status status = call;                                                 \
+    assert(status == napi_ok && #call " failed");                              \
+  } while (0);
+
+typedef struct {
+  uint32_t left;
+  uint32_t in_flight;
+  napi_ref done;
+} Run;
+
+typedef struct {
+  Run* run;
+  napi_async_work work;
+} Work;
+
+static void Execute(napi_env env, void* data) {}
+
+static void QueueWork(napi_env env, Run* run);
+
+static void Complete(napi_env env, napi_status status, void* data) {
+  Work* work = data;
+  Run* run = work->run;
+  NAPI_CALL(napi_delete_async_work(env, work->work));
+  free(work);
+  run->in_flight--;
+  if (run->left > 0) {
+    QueueWork(env, run);
+  } else if (run->in_flight == 0) {
+    napi_value done, undefined;
+    NAPI_CALL(napi_get_reference_value(env, run->done, &done));
+    NAPI_CALL(napi_delete_reference(env, run->done));
+    NAPI_CALL(napi_get_undefined(env, &undefined));
+    free(run);
+    NAPI_CALL(napi_call_function(env, undefined, done, 0, NULL, NULL));
+  }
+}
+
+static void QueueWork(napi_env env, Run* run) {
+  napi_value name;
+  Work* work = malloc(sizeof(*work));
+  work->run = run;
+  NAPI_CALL(napi_create_string_utf8(env, "bench", NAPI_AUTO_LENGTH, &name));
+  NAPI_CALL(napi_create_async_work(
+      env, NULL, name, Execute, Complete, work, &work->work));
+  NAPI_CALL(napi_queue_async_work(env, work->work));
+  run->left--;
+  run->in_flight++;
+}
+
+// start(n, concurrency, done) runs n empty works with up to concurrency of
+// them queued at the same time, and calls done() once they have completed.
+static napi_value Start(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value argv[3];
+  uint32_t concurrency;
+  Run* run = malloc(sizeof(*run));
+  NAPI_CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NAPI_CALL(napi_get_value_uint32(env, argv[0], &run->left));
+  NAPI_CALL(napi_get_value_uint32(env, argv[1], &concurrency));
+  NAPI_CALL(napi_create_reference(env, argv[2], 1, &run->done));
+  run->in_flight = 0;
+  while (run->in_flight < concurrency && run->left > 0) QueueWork(env, run);
+  return NULL;
+}
+
+NAPI_MODULE_INIT() {
+  napi_value start;
+  NAPI_CALL(napi_create_function(
+      env, "start", NAPI_AUTO_LENGTH, Start, NULL, &start));
+  NAPI_CALL(napi_set_named_property(env, exports, "start", start));
+  return exports;
+}
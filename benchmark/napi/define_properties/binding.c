@@ -70,6 +70,67 @@ static napi_value Runner(napi_env env,
   return undefined;
 }
 
+// Creates as many result objects with three properties as there are
+// objects in the array, either one property at a time or in bulk.
+static napi_value ResultRunner(napi_env env,
+                               napi_callback_info info,
+                               bool bulk) {
+  napi_value argv[2], undefined, js_array_length, start, end;
+  napi_handle_scope scope;
+  size_t argc = 2;
+  uint32_t array_length = 0;
+  napi_value names[3], values[3], prototype, result;
+  const char* utf8names[3] = {"x", "y", "z"};
+
+  NODE_API_CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  ABORT_IF_FALSE(argc == 2);
+  NODE_API_CALL(napi_get_array_length(env, argv[1], &array_length));
+  NODE_API_CALL(napi_get_named_property(env, argv[0], "start", &start));
+  NODE_API_CALL(napi_get_named_property(env, argv[0], "end", &end));
+  NODE_API_CALL(napi_get_undefined(env, &undefined));
+  NODE_API_CALL(napi_create_uint32(env, array_length, &js_array_length));
+
+  // Take Object.prototype from a plain object.
+  NODE_API_CALL(napi_create_object(env, &result));
+  NODE_API_CALL(napi_get_prototype(env, result, &prototype));
+
+  for (int i = 0; i < 3; i++) {
+    NODE_API_CALL(node_api_create_property_key_latin1(
+        env, utf8names[i], NAPI_AUTO_LENGTH, &names[i]));
+    NODE_API_CALL(napi_create_int32(env, i, &values[i]));
+  }
+
+  napi_call_function(env, argv[0], start, 0, NULL, NULL);
+
+  for (uint32_t idx = 0; idx < array_length; idx++) {
+    NODE_API_CALL(napi_open_handle_scope(env, &scope));
+    if (bulk) {
+      NODE_API_CALL(node_api_create_object_with_properties(
+          env, prototype, names, values, 3, &result));
+    } else {
+      NODE_API_CALL(napi_create_object(env, &result));
+      for (int i = 0; i < 3; i++) {
+        NODE_API_CALL(
+            napi_set_named_property(env, result, utf8names[i], values[i]));
+      }
+    }
+    NODE_API_CALL(napi_close_handle_scope(env, scope));
+  }
+
+  NODE_API_CALL(
+      napi_call_function(env, argv[0], end, 1, &js_array_length, NULL));
+
+  return undefined;
+}
+
+static napi_value RunSetNamed(napi_env env, napi_callback_info info) {
+  return ResultRunner(env, info, false);
+}
+
+static napi_value RunBulk(napi_env env, napi_callback_info info) {
+  return ResultRunner(env, info, true);
+}
+
 static napi_value RunFastPath(napi_env env, napi_callback_info info) {
   return Runner(env, info, napi_writable | napi_enumerable | napi_configurable);
 }
@@ -96,6 +157,22 @@ NAPI_MODULE_INIT() {
        NULL,
        napi_writable | napi_configurable | napi_enumerable,
        NULL},
+      {"runSetNamed",
+       NULL,
+       RunSetNamed,
+       NULL,
+       NULL,
+       NULL,
+       napi_writable | napi_configurable | napi_enumerable,
+       NULL},
+      {"runBulk",
+       NULL,
+       RunBulk,
+       NULL,
+       NULL,
+       NULL,
+       napi_writable | napi_configurable | napi_enumerable,
+       NULL},
   };
 
   NODE_API_CALL(napi_define_properties(
@@ -2,7 +2,8 @@
   'targets': [
     {
       'target_name': 'binding',
-      'sources': [ 'binding.c' ]
+      'sources': [ 'binding.c' ],
+      'defines': [ 'NAPI_EXPERIMENTAL' ]
     }
   ]
 }
@@ -6,7 +6,7 @@ const binding = require(`./build/${common.buildType}/binding`);
 
 const bench = common.createBenchmark(main, {
   n: [5e6],
-  implem: ['runFastPath', 'runSlowPath'],
+  implem: ['runFastPath', 'runSlowPath', 'runSetNamed', 'runBulk'],
 });
 
 function main({ n, implem }) {
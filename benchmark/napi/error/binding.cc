@@ -0,0 +1,29 @@
+#include <node.h>
+#include <v8.h>
+
+static void Throw(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::Object> error =
+      v8::Exception::Error(v8::String::NewFromUtf8Literal(isolate, "bench"))
+          .As<v8::Object>();
+  error
+      ->Set(context,
+            v8::String::NewFromUtf8Literal(isolate, "code"),
+            v8::String::NewFromUtf8Literal(isolate, "ERR_BENCH"))
+      .Check();
+  isolate->ThrowException(error);
+}
+
+static void CheckInt32(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  args.GetReturnValue().Set(args[0]->IsInt32());
+}
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> module,
+                void* data) {
+  NODE_SET_METHOD(target, "throw", Throw);
+  NODE_SET_METHOD(target, "checkInt32", CheckInt32);
+}
+
+NODE_MODULE(NODE_GYP_MODULE_NAME, Initialize)
@@ -0,0 +1,44 @@
+// Compare the error paths of a binding: throwing an error with a code, and
+// rejecting an argument of the wrong type, through Node-API and through V8.
+'use strict';
+
+const common = require('../../common.js');
+
+let v8;
+let napi;
+try {
+  v8 = require(`./build/${common.buildType}/binding`);
+  napi = require(`./build/${common.buildType}/napi_binding`);
+} catch {
+  console.error(`${__filename}: Binding failed to load`);
+  process.exit(0);
+}
+
+const bench = common.createBenchmark(main, {
+  type: ['v8', 'napi'],
+  op: ['throw', 'status'],
+  n: [1e6],
+});
+
+function main({ n, type, op }) {
+  const binding = type === 'v8' ? v8 : napi;
+  let failures = 0;
+  if (op === 'throw') {
+    bench.start();
+    for (let i = 0; i < n; i++) {
+      try {
+        binding.throw();
+      } catch {
+        failures++;
+      }
+    }
+    bench.end(n);
+  } else {
+    bench.start();
+    for (let i = 0; i < n; i++) {
+      if (!binding.checkInt32('1')) failures++;
+    }
+    bench.end(n);
+  }
+  if (failures !== n) throw new Error('unexpected failure count');
+}
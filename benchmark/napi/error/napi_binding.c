@@ -0,0 +1,40 @@
+#include <assert.h>
+#include <node_api.h>
+
+#define NAPI_CALL(call)                                                        \
+  do {                                                                         \
+    napi_status status = call;                                                 \
+    assert(status == napi_ok && #call " failed");                              \
+  } while (0);
+
+static napi_value Throw(napi_env env, napi_callback_info info) {
+  NAPI_CALL(napi_throw_error(env, "ERR_BENCH", "bench"));
+  return NULL;
+}
+
+// Returns whether the argument is an int32, by way of the error that
+// napi_get_value_int32() reports for other values.
+static napi_value CheckInt32(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1], result;
+  int32_t value;
+  const napi_extended_error_info* error_info;
+  NAPI_CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  napi_status status = napi_get_value_int32(env, argv[0], &value);
+  if (status != napi_ok) {
+    NAPI_CALL(napi_get_last_error_info(env, &error_info));
+  }
+  NAPI_CALL(napi_get_boolean(env, status == napi_ok, &result));
+  return result;
+}
+
+NAPI_MODULE_INIT() {
+  napi_value fn;
+  NAPI_CALL(napi_create_function(
+      env, "throw", NAPI_AUTO_LENGTH, Throw, NULL, &fn));
+  NAPI_CALL(napi_set_named_property(env, exports, "throw", fn));
+  NAPI_CALL(napi_create_function(
+      env, "checkInt32", NAPI_AUTO_LENGTH, CheckInt32, NULL, &fn));
+  NAPI_CALL(napi_set_named_property(env, exports, "checkInt32", fn));
+  return exports;
+}
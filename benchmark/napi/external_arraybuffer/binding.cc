@@ -0,0 +1,26 @@
+#include <node.h>
+#include <v8.h>
+
+#include <cstdlib>
+#include <memory>
+#include <utility>
+
+static void Create(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  size_t length =
+      args[0]->Uint32Value(isolate->GetCurrentContext()).FromJust();
+  std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(
+      malloc(length),
+      length,
+      [](void* data, size_t length, void* deleter_data) { free(data); },
+      nullptr);
+  args.GetReturnValue().Set(v8::ArrayBuffer::New(isolate, std::move(store)));
+}
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> module,
+                void* data) {
+  NODE_SET_METHOD(target, "create", Create);
+}
+
+NODE_MODULE(NODE_GYP_MODULE_NAME, Initialize)
@@ -0,0 +1,28 @@
+// Compare creating ArrayBuffers over native memory that is freed when they
+// are collected, through Node-API and through V8 backing stores.
+'use strict';
+
+const common = require('../../common.js');
+
+let v8;
+let napi;
+try {
+  v8 = require(`./build/${common.buildType}/binding`);
+  napi = require(`./build/${common.buildType}/napi_binding`);
+} catch {
+  console.error(`${__filename}: Binding failed to load`);
+  process.exit(0);
+}
+
+const bench = common.createBenchmark(main, {
+  type: ['v8', 'napi'],
+  size: [16, 64 * 1024],
+  n: [1e5],
+});
+
+function main({ n, type, size }) {
+  const create = (type === 'v8' ? v8 : napi).create;
+  bench.start();
+  for (let i = 0; i < n; i++) create(size);
+  bench.end(n);
+}
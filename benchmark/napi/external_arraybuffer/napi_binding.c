@@ -0,0 +1,32 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <node_api.h>
+
+#define NAPI_CALL(call)                                                        \
+  do {                                                                         \
+    napi_status status = call;                                                 \
+    assert(status == napi_ok && #call " failed");                              \
+  } while (0);
+
+static void Finalize(napi_env env, void* data, void* hint) {
+  free(data);
+}
+
+static napi_value Create(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1], result;
+  uint32_t length;
+  NAPI_CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NAPI_CALL(napi_get_value_uint32(env, argv[0], &length));
+  NAPI_CALL(napi_create_external_arraybuffer(
+      env, malloc(length), length, Finalize, NULL, &result));
+  return result;
+}
+
+NAPI_MODULE_INIT() {
+  napi_value create;
+  NAPI_CALL(napi_create_function(
+      env, "create", NAPI_AUTO_LENGTH, Create, NULL, &create));
+  NAPI_CALL(napi_set_named_property(env, exports, "create", create));
+  return exports;
+}
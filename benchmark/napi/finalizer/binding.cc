@@ -0,0 +1,36 @@
+#include <node.h>
+#include <v8.h>
+
+// The same as napi_binding.c, on top of weak handles.
+static uint32_t finalized = 0;
+
+static void Finalize(const v8::WeakCallbackInfo<v8::Global<v8::Object>>& info) {
+  v8::Global<v8::Object>* handle = info.GetParameter();
+  handle->Reset();
+  delete handle;
+  finalized++;
+}
+
+static void Create(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  uint32_t n = args[0]->Uint32Value(isolate->GetCurrentContext()).FromJust();
+  for (uint32_t i = 0; i < n; i++) {
+    v8::HandleScope scope(isolate);
+    auto* handle =
+        new v8::Global<v8::Object>(isolate, v8::Object::New(isolate));
+    handle->SetWeak(handle, Finalize, v8::WeakCallbackType::kParameter);
+  }
+}
+
+static void Finalized(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  args.GetReturnValue().Set(finalized);
+}
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> module,
+                void* data) {
+  NODE_SET_METHOD(target, "create", Create);
+  NODE_SET_METHOD(target, "finalized", Finalized);
+}
+
+NODE_MODULE(NODE_GYP_MODULE_NAME, Initialize)
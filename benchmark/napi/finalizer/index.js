@@ -0,0 +1,37 @@
+// Compare creating objects with a native finalizer and collecting them,
+// through Node-API finalizers and through V8 weak callbacks.
+'use strict';
+
+const common = require('../../common.js');
+
+let v8;
+let napi;
+try {
+  v8 = require(`./build/${common.buildType}/binding`);
+  napi = require(`./build/${common.buildType}/napi_binding`);
+} catch {
+  console.error(`${__filename}: Binding failed to load`);
+  process.exit(0);
+}
+
+const bench = common.createBenchmark(main, {
+  type: ['v8', 'napi'],
+  n: [1e5],
+}, { flags: ['--expose-gc'] });
+
+function main({ n, type }) {
+  const binding = type === 'v8' ? v8 : napi;
+  const start = binding.finalized();
+  bench.start();
+  binding.create(n);
+  // Node-API finalizers that touch JavaScript run after the GC, from
+  // setImmediate().
+  (function collect() {
+    global.gc();
+    if (binding.finalized() - start < n) {
+      setImmediate(collect);
+    } else {
+      bench.end(n);
+    }
+  })();
+}
@@ -0,0 +1,50 @@
+#include <assert.h>
+#include <node_api.h>
+
+#define NAPI_CALL(call)                                                        \
+  do {                                                                         \
+    napi_status status = call;                                                 \
+    assert(status == napi_ok && #call " failed");                              \
+  } while (0);
+
+static uint32_t finalized = 0;
+
+static void Finalize(napi_env env, void* data, void* hint) {
+  finalized++;
+}
+
+// create(n) creates n objects with a finalizer each and drops them.
+static napi_value Create(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  uint32_t n, i;
+  NAPI_CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NAPI_CALL(napi_get_value_uint32(env, argv[0], &n));
+  for (i = 0; i < n; i++) {
+    napi_handle_scope scope;
+    napi_value object;
+    NAPI_CALL(napi_open_handle_scope(env, &scope));
+    NAPI_CALL(napi_create_object(env, &object));
+    NAPI_CALL(napi_add_finalizer(env, object, NULL, Finalize, NULL, NULL));
+    NAPI_CALL(napi_close_handle_scope(env, scope));
+  }
+  return NULL;
+}
+
+static napi_value Finalized(napi_env env, napi_callback_info info) {
+  napi_value result;
+  NAPI_CALL(napi_create_uint32(env, finalized, &result));
+  return result;
+}
+
+NAPI_MODULE_INIT() {
+  napi_value create, get_finalized;
+  finalized = 0;
+  NAPI_CALL(napi_create_function(
+      env, "create", NAPI_AUTO_LENGTH, Create, NULL, &create));
+  NAPI_CALL(napi_set_named_property(env, exports, "create", create));
+  NAPI_CALL(napi_create_function(
+      env, "finalized", NAPI_AUTO_LENGTH, Finalized, NULL, &get_finalized));
+  NAPI_CALL(napi_set_named_property(env, exports, "finalized", get_finalized));
+  return exports;
+}
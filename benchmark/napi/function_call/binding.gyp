@@ -2,7 +2,8 @@
   'targets': [
     {
       'target_name': 'napi_binding',
-      'sources': [ 'napi_binding.c' ]
+      'sources': [ 'napi_binding.c' ],
+      'defines': [ 'NAPI_EXPERIMENTAL' ]
     },
     {
       'target_name': 'binding',
@@ -10,6 +10,10 @@ static napi_value Hello(napi_env env, napi_callback_info info) {
   return result;
 }
 
+static int32_t HelloFast(void* receiver, node_api_fast_options options) {
+  return increment++;
+}
+
 NAPI_MODULE_INIT() {
   napi_value hello;
   napi_status status =
@@ -22,5 +26,19 @@ NAPI_MODULE_INIT() {
   assert(status == napi_ok);
   status = napi_set_named_property(env, exports, "hello", hello);
   assert(status == napi_ok);
+
+  node_api_fast_signature signature = { node_api_fast_int32, 0, NULL };
+  napi_value hello_fast;
+  status = node_api_create_fast_function(env,
+                                         "helloFast",
+                                         NAPI_AUTO_LENGTH,
+                                         Hello,
+                                         &signature,
+                                         HelloFast,
+                                         NULL,
+                                         &hello_fast);
+  assert(status == napi_ok);
+  status = napi_set_named_property(env, exports, "helloFast", hello_fast);
+  assert(status == napi_ok);
   return exports;
 }
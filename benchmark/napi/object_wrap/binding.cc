@@ -0,0 +1,48 @@
+#include <node.h>
+#include <v8.h>
+
+// The same class as in napi_binding.c, on top of an internal field and a
+// weak handle.
+struct Wrapped {
+  int32_t value;
+  v8::Global<v8::Object> handle;
+};
+
+static void Finalize(const v8::WeakCallbackInfo<Wrapped>& info) {
+  Wrapped* wrapped = info.GetParameter();
+  wrapped->handle.Reset();
+  delete wrapped;
+}
+
+static void Constructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  Wrapped* wrapped = new Wrapped();
+  wrapped->value = args[0]->Int32Value(isolate->GetCurrentContext()).FromJust();
+  wrapped->handle.Reset(isolate, args.This());
+  wrapped->handle.SetWeak(wrapped, Finalize, v8::WeakCallbackType::kParameter);
+  args.This()->SetAlignedPointerInInternalField(0, wrapped);
+}
+
+static void Get(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Wrapped* wrapped = static_cast<Wrapped*>(
+      args.This()->GetAlignedPointerFromInternalField(0));
+  args.GetReturnValue().Set(wrapped->value);
+}
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> module,
+                void* data) {
+  v8::Isolate* isolate = target->GetIsolate();
+  v8::Local<v8::Context> context = isolate->GetCurrentContext();
+  v8::Local<v8::FunctionTemplate> tmpl =
+      v8::FunctionTemplate::New(isolate, Constructor);
+  tmpl->InstanceTemplate()->SetInternalFieldCount(1);
+  NODE_SET_PROTOTYPE_METHOD(tmpl, "get", Get);
+  target
+      ->Set(context,
+            v8::String::NewFromUtf8Literal(isolate, "Wrapped"),
+            tmpl->GetFunction(context).ToLocalChecked())
+      .Check();
+}
+
+NODE_MODULE(NODE_GYP_MODULE_NAME, Initialize)
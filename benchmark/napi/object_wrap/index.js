@@ -0,0 +1,37 @@
+// Compare wrapping native data into objects of a class, and getting it back
+// out in a method, through Node-API and through V8 internal fields.
+'use strict';
+
+const common = require('../../common.js');
+
+let v8;
+let napi;
+try {
+  v8 = require(`./build/${common.buildType}/binding`);
+  napi = require(`./build/${common.buildType}/napi_binding`);
+} catch {
+  console.error(`${__filename}: Binding failed to load`);
+  process.exit(0);
+}
+
+const bench = common.createBenchmark(main, {
+  type: ['v8', 'napi'],
+  op: ['wrap', 'unwrap'],
+  n: [1e6],
+});
+
+function main({ n, type, op }) {
+  const Wrapped = (type === 'v8' ? v8 : napi).Wrapped;
+  if (op === 'wrap') {
+    bench.start();
+    for (let i = 0; i < n; i++) new Wrapped(i);
+    bench.end(n);
+  } else {
+    const wrapped = new Wrapped(1);
+    let sum = 0;
+    bench.start();
+    for (let i = 0; i < n; i++) sum += wrapped.get();
+    bench.end(n);
+    if (sum !== n) throw new Error('unexpected sum');
+  }
+}
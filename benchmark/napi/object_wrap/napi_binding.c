@@ -0,0 +1,42 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <node_api.h>
+
+#define NAPI_CALL(call)                                                        \
+  do {                                                                         \
+    napi_status status = call;                                                 \
+    assert(status == napi_ok && #call " failed");                              \
+  } while (0);
+
+static void Finalize(napi_env env, void* data, void* hint) {
+  free(data);
+}
+
+static napi_value Constructor(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1], this_arg;
+  int32_t* value = malloc(sizeof(*value));
+  NAPI_CALL(napi_get_cb_info(env, info, &argc, argv, &this_arg, NULL));
+  NAPI_CALL(napi_get_value_int32(env, argv[0], value));
+  NAPI_CALL(napi_wrap(env, this_arg, value, Finalize, NULL, NULL));
+  return NULL;
+}
+
+static napi_value Get(napi_env env, napi_callback_info info) {
+  napi_value this_arg, result;
+  int32_t* value;
+  NAPI_CALL(napi_get_cb_info(env, info, NULL, NULL, &this_arg, NULL));
+  NAPI_CALL(napi_unwrap(env, this_arg, (void**)&value));
+  NAPI_CALL(napi_create_int32(env, *value, &result));
+  return result;
+}
+
+NAPI_MODULE_INIT() {
+  napi_property_descriptor get = {
+      "get", NULL, Get, NULL, NULL, NULL, napi_default, NULL};
+  napi_value cons;
+  NAPI_CALL(napi_define_class(
+      env, "Wrapped", NAPI_AUTO_LENGTH, Constructor, NULL, 1, &get, &cons));
+  NAPI_CALL(napi_set_named_property(env, exports, "Wrapped", cons));
+  return exports;
+}
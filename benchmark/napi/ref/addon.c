@@ -57,6 +57,35 @@ NewWeak(napi_env env, napi_callback_info info) {
   return result;
 }
 
+// Creates and deletes `n` references to the same object, of the kind given
+// by the second argument: 0 for weak, 1 for strong napi_refs and 2 for
+// node_api_strong_refs.
+static napi_value
+Churn(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2], object;
+  uint32_t n, kind;
+
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NAPI_CALL(env, napi_get_value_uint32(env, argv[0], &n));
+  NAPI_CALL(env, napi_get_value_uint32(env, argv[1], &kind));
+  NAPI_CALL(env, napi_create_object(env, &object));
+
+  for (uint32_t i = 0; i < n; i++) {
+    if (kind == 2) {
+      node_api_strong_ref ref;
+      NAPI_CALL(env, node_api_create_strong_reference(env, object, &ref));
+      NAPI_CALL(env, node_api_delete_strong_reference(env, ref));
+    } else {
+      napi_ref ref;
+      NAPI_CALL(env, napi_create_reference(env, object, kind, &ref));
+      NAPI_CALL(env, napi_delete_reference(env, ref));
+    }
+  }
+
+  return NULL;
+}
+
 static void
 FreeCount(napi_env env, void* data, void* hint) {
   free(data);
@@ -66,7 +95,8 @@ FreeCount(napi_env env, void* data, void* hint) {
 NAPI_MODULE_INIT(/* napi_env env, napi_value exports */) {
   napi_property_descriptor props[] = {
     { "count", NULL, NULL, GetCount, SetCount, NULL, napi_enumerable, NULL },
-    { "newWeak", NULL, NewWeak, NULL, NULL, NULL, napi_enumerable, NULL }
+    { "newWeak", NULL, NewWeak, NULL, NULL, NULL, napi_enumerable, NULL },
+    { "churn", NULL, Churn, NULL, NULL, NULL, napi_enumerable, NULL }
   };
 
   size_t* count = malloc(sizeof(*count));
@@ -0,0 +1,14 @@
+'use strict';
+const common = require('../../common');
+const addon = require(`./build/${common.buildType}/addon`);
+const bench = common.createBenchmark(main, {
+  type: ['weak', 'strong', 'strong-only'],
+  n: [1e7],
+});
+
+function main({ n, type }) {
+  const kind = ['weak', 'strong', 'strong-only'].indexOf(type);
+  bench.start();
+  addon.churn(n, kind);
+  bench.end(n);
+}
@@ -0,0 +1,86 @@
+#include <node.h>
+#include <uv.h>
+#include <v8.h>
+
+#include <mutex>
+#include <thread>
+
+// The same as napi_binding.c without batching, on top of a mutex, a uv_async_t
+// and node::AsyncResource.
+class Run : public node::AsyncResource {
+ public:
+  Run(v8::Isolate* isolate,
+      uint32_t n,
+      v8::Local<v8::Function> cb,
+      v8::Local<v8::Function> done)
+      : AsyncResource(isolate, v8::Object::New(isolate), "bench"),
+        isolate_(isolate),
+        n_(n),
+        cb_(isolate, cb),
+        done_(isolate, done) {
+    async_.data = this;
+    uv_async_init(node::GetCurrentEventLoop(isolate), &async_, OnAsync);
+    thread_ = std::thread([this]() {
+      for (uint32_t i = 0; i < n_; i++) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          queued_++;
+        }
+        uv_async_send(&async_);
+      }
+    });
+  }
+
+ private:
+  static void OnAsync(uv_async_t* async) {
+    static_cast<Run*>(async->data)->Dispatch();
+  }
+
+  void Dispatch() {
+    v8::HandleScope scope(isolate_);
+    v8::Local<v8::Function> cb = cb_.Get(isolate_);
+    v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate_, 1)};
+    for (;;) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queued_ == 0) break;
+        queued_--;
+      }
+      MakeCallback(cb, 1, argv);
+      received_++;
+    }
+    if (received_ < n_) return;
+
+    thread_.join();
+    MakeCallback(done_.Get(isolate_), 0, nullptr);
+    uv_close(reinterpret_cast<uv_handle_t*>(&async_), [](uv_handle_t* handle) {
+      delete static_cast<Run*>(handle->data);
+    });
+  }
+
+  v8::Isolate* isolate_;
+  uint32_t n_;
+  uint32_t received_ = 0;
+  v8::Global<v8::Function> cb_;
+  v8::Global<v8::Function> done_;
+  std::mutex mutex_;
+  uint32_t queued_ = 0;
+  std::thread thread_;
+  uv_async_t async_;
+};
+
+static void Start(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  new Run(isolate,
+          args[0]->Uint32Value(isolate->GetCurrentContext()).FromJust(),
+          args[2].As<v8::Function>(),
+          args[3].As<v8::Function>());
+}
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> module,
+                void* data) {
+  NODE_SET_METHOD(target, "start", Start);
+}
+
+NODE_MODULE(NODE_GYP_MODULE_NAME, Initialize)
@@ -0,0 +1,33 @@
+// Compare calling into JavaScript from another thread through Node-API
+// thread-safe functions, with and without batching, and through a uv_async_t.
+'use strict';
+
+const common = require('../../common.js');
+
+let v8;
+let napi;
+try {
+  v8 = require(`./build/${common.buildType}/binding`);
+  napi = require(`./build/${common.buildType}/napi_binding`);
+} catch {
+  console.error(`${__filename}: Binding failed to load`);
+  process.exit(0);
+}
+
+const bench = common.createBenchmark(main, {
+  type: ['v8', 'napi', 'napi-batched'],
+  n: [1e6],
+});
+
+function main({ n, type }) {
+  let received = 0;
+  bench.start();
+  (type === 'v8' ? v8 : napi).start(
+    n,
+    type === 'napi-batched' ? 256 : 0,
+    (count) => { received += count; },
+    () => {
+      bench.end(n);
+      if (received !== n) throw new Error('unexpected call count');
+    });
+}
@@ -0,0 +1,88 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <node_api.h>
+#include <uv.h>
+
+#define NAPI_CALL(call)                                                        \
+  do {                                                                         \
+    napi_status status = call;                                                 \
+    assert(status == napi_ok && #call " failed");                              \
+  } while (0);
+
+typedef struct {
+  napi_threadsafe_function tsfn;
+  uv_thread_t thread;
+  uint32_t n;
+  napi_ref done;
+} Run;
+
+static void Produce(void* data) {
+  Run* run = data;
+  uint32_t i;
+  for (i = 0; i < run->n; i++) {
+    NAPI_CALL(napi_call_threadsafe_function(run->tsfn, NULL,
+                                            napi_tsfn_nonblocking));
+  }
+  NAPI_CALL(napi_release_threadsafe_function(run->tsfn, napi_tsfn_release));
+}
+
+static void CallWithCount(napi_env env, napi_value cb, size_t count) {
+  napi_value undefined, argv[1];
+  NAPI_CALL(napi_get_undefined(env, &undefined));
+  NAPI_CALL(napi_create_uint32(env, count, &argv[0]));
+  NAPI_CALL(napi_call_function(env, undefined, cb, 1, argv, NULL));
+}
+
+static void CallJs(napi_env env, napi_value cb, void* context, void* data) {
+  if (env != NULL) CallWithCount(env, cb, 1);
+}
+
+static void CallJsBatch(
+    napi_env env, napi_value cb, void* context, void** data, size_t count) {
+  if (env != NULL) CallWithCount(env, cb, count);
+}
+
+static void Finalize(napi_env env, void* data, void* hint) {
+  Run* run = data;
+  napi_value done, undefined;
+  uv_thread_join(&run->thread);
+  NAPI_CALL(napi_get_reference_value(env, run->done, &done));
+  NAPI_CALL(napi_delete_reference(env, run->done));
+  NAPI_CALL(napi_get_undefined(env, &undefined));
+  free(run);
+  NAPI_CALL(napi_call_function(env, undefined, done, 0, NULL, NULL));
+}
+
+// start(n, batchSize, cb, done) calls cb(count) for the n calls that another
+// thread makes, in batches of up to batchSize calls if batchSize is not 0,
+// and done() once they have all arrived.
+static napi_value Start(napi_env env, napi_callback_info info) {
+  size_t argc = 4;
+  napi_value argv[4], name;
+  uint32_t batch_size;
+  Run* run = malloc(sizeof(*run));
+  NAPI_CALL(napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NAPI_CALL(napi_get_value_uint32(env, argv[0], &run->n));
+  NAPI_CALL(napi_get_value_uint32(env, argv[1], &batch_size));
+  NAPI_CALL(napi_create_reference(env, argv[3], 1, &run->done));
+  NAPI_CALL(napi_create_string_utf8(env, "bench", NAPI_AUTO_LENGTH, &name));
+  if (batch_size == 0) {
+    NAPI_CALL(napi_create_threadsafe_function(
+        env, argv[2], NULL, name, 0, 1, run, Finalize, NULL, CallJs,
+        &run->tsfn));
+  } else {
+    NAPI_CALL(node_api_create_batched_threadsafe_function(
+        env, argv[2], NULL, name, 0, 1, run, Finalize, NULL, batch_size,
+        CallJsBatch, &run->tsfn));
+  }
+  if (uv_thread_create(&run->thread, Produce, run) != 0) abort();
+  return NULL;
+}
+
+NAPI_MODULE_INIT() {
+  napi_value start;
+  NAPI_CALL(napi_create_function(
+      env, "start", NAPI_AUTO_LENGTH, Start, NULL, &start));
+  NAPI_CALL(napi_set_named_property(env, exports, "start", start));
+  return exports;
+}
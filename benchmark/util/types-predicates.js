@@ -0,0 +1,55 @@
+// Measure the util.types predicates that are implemented in C++, which have
+// V8 fast API versions.
+'use strict';
+
+const common = require('../common.js');
+const { types } = require('util');
+
+const args = {
+  Promise: {
+    'true': Promise.resolve(),
+    'false-primitive': 1,
+    'false-object': {},
+  },
+  Map: {
+    'true': new Map(),
+    'false-primitive': 'map',
+    'false-object': new Set(),
+  },
+  NativeError: {
+    'true': new Error(),
+    'false-primitive': true,
+    'false-object': { message: 'error' },
+  },
+  AnyArrayBuffer: {
+    'true': new ArrayBuffer(1),
+    'false-primitive': 1,
+    'false-object': new Uint8Array(1),
+  },
+  BoxedPrimitive: {
+    'true': Object(1),
+    'false-primitive': 1,
+    'false-object': {},
+  },
+};
+
+const bench = common.createBenchmark(main, {
+  type: Object.keys(args),
+  argument: ['true', 'false-primitive', 'false-object'],
+  n: [1e7],
+});
+
+function main({ type, argument, n }) {
+  const fn = types[`is${type}`];
+  const arg = args[type][argument];
+  const expected = argument === 'true';
+  let matches = 0;
+
+  bench.start();
+  for (let i = 0; i < n; i++) {
+    if (fn(arg)) matches++;
+  }
+  bench.end(n);
+
+  if (matches !== (expected ? n : 0)) throw new Error('unexpected result');
+}
@@ -516,6 +516,28 @@ shared_optgroup.add_argument('--shared-brotli-libpath',
     dest='shared_brotli_libpath',
     help='a directory to search for the shared brotli DLL')
 
+shared_optgroup.add_argument('--shared-zstd',
+    action='store_true',
+    dest='shared_zstd',
+    default=None,
+    help='link to a shared zstd DLL and enable the zstd codec in zlib')
+
+shared_optgroup.add_argument('--shared-zstd-includes',
+    action='store',
+    dest='shared_zstd_includes',
+    help='directory containing zstd header files')
+
+shared_optgroup.add_argument('--shared-zstd-libname',
+    action='store',
+    dest='shared_zstd_libname',
+    default='zstd',
+    help='alternative lib name to link to [default: %(default)s]')
+
+shared_optgroup.add_argument('--shared-zstd-libpath',
+    action='store',
+    dest='shared_zstd_libpath',
+    help='a directory to search for the shared zstd DLL')
+
 shared_optgroup.add_argument('--shared-cares',
     action='store_true',
     dest='shared_cares',
@@ -719,6 +741,15 @@ parser.add_argument('--without-node-code-cache',
     default=None,
     help='Turn off V8 Code cache integration.')
 
+parser.add_argument('--compress-builtins',
+    action='store_true',
+    dest='compress_builtins',
+    default=None,
+    help='Embed the builtin modules compressed with Brotli and decompress '
+         'each one when it is first used. Makes the binary smaller, but '
+         'the builtins in use are held in memory instead of being read from '
+         'the binary.')
+
 intl_optgroup.add_argument('--download',
     action='store',
     dest='download_list',
@@ -1410,6 +1441,8 @@ def configure_node(o):
     o['variables']['node_use_node_code_cache'] = b(
       not cross_compiling and not options.shared)
 
+  o['variables']['node_compress_builtins'] = b(options.compress_builtins)
+
   if options.write_snapshot_as_array_literals is not None:
      o['variables']['node_write_snapshot_as_array_literals'] = b(options.write_snapshot_as_array_literals)
   else:
@@ -2151,6 +2184,7 @@ configure_library('ada', output)
 configure_library('simdjson', output)
 configure_library('simdutf', output)
 configure_library('brotli', output, pkgname=['libbrotlidec', 'libbrotlienc'])
+configure_library('zstd', output, pkgname='libzstd')
 configure_library('cares', output, pkgname='libcares')
 configure_library('nghttp2', output, pkgname='libnghttp2')
 configure_library('nghttp3', output, pkgname='libnghttp3')
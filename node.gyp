@@ -15,6 +15,7 @@
     'ossfuzz' : 'false',
     'node_module_version%': '',
     'node_shared_brotli%': 'false',
+    'node_shared_zstd%': 'false',
     'node_shared_zlib%': 'false',
     'node_shared_http_parser%': 'false',
     'node_shared_cares%': 'false',
@@ -29,6 +30,7 @@
     'node_lib_target_name%': 'libnode',
     'node_intermediate_lib_type%': 'static_library',
     'node_builtin_modules_path%': '',
+    'node_compress_builtins%': 'false',
     'linked_module_files': [
     ],
     # We list the deps/ files out instead of globbing them in js2c.cc since we
@@ -66,6 +68,7 @@
       'src/api/exceptions.cc',
       'src/api/hooks.cc',
       'src/api/utils.cc',
+      'src/async_context_frame.cc',
       'src/async_wrap.cc',
       'src/base_object.cc',
       'src/cares_wrap.cc',
@@ -80,6 +83,7 @@
       'src/env.cc',
       'src/fs_event_wrap.cc',
       'src/handle_wrap.cc',
+      'src/heap_snapshot_writer.cc',
       'src/heap_utils.cc',
       'src/histogram.cc',
       'src/internal_only_v8.cc',
@@ -93,16 +97,21 @@
       'src/js_udp_wrap.cc',
       'src/json_parser.h',
       'src/json_parser.cc',
+      'src/module_fs_cache.cc',
+      'src/module_graph_loader.cc',
       'src/module_wrap.cc',
       'src/node.cc',
       'src/node_api.cc',
+      'src/node_array_buffer_pool.cc',
       'src/node_binding.cc',
       'src/node_blob.cc',
       'src/node_buffer.cc',
       'src/node_builtins.cc',
+      'src/node_checksum.cc',
       'src/node_config.cc',
       'src/node_constants.cc',
       'src/node_contextify.cc',
+      'src/node_coverage.cc',
       'src/node_credentials.cc',
       'src/node_dir.cc',
       'src/node_dotenv.cc',
@@ -113,15 +122,19 @@
       'src/node_http_parser.cc',
       'src/node_http2.cc',
       'src/node_i18n.cc',
+      'src/node_log_sink.cc',
       'src/node_main_instance.cc',
       'src/node_messaging.cc',
       'src/node_metadata.cc',
+      'src/node_metrics.cc',
+      'src/node_module_pack.cc',
       'src/node_modules.cc',
       'src/node_options.cc',
       'src/node_os.cc',
       'src/node_perf.cc',
       'src/node_platform.cc',
       'src/node_postmortem_metadata.cc',
+      'src/node_pprof.cc',
       'src/node_process_events.cc',
       'src/node_process_methods.cc',
       'src/node_process_object.cc',
@@ -132,6 +145,8 @@
       'src/node_sea.cc',
       'src/node_serdes.cc',
       'src/node_shadow_realm.cc',
+      'src/node_shared_arena.cc',
+      'src/node_shm_channel.cc',
       'src/node_snapshotable.cc',
       'src/node_sockaddr.cc',
       'src/node_stat_watcher.cc',
@@ -142,12 +157,14 @@
       'src/node_types.cc',
       'src/node_url.cc',
       'src/node_util.cc',
+      'src/node_util_inspect.cc',
       'src/node_v8.cc',
       'src/node_wasi.cc',
       'src/node_wasm_web_api.cc',
       'src/node_watchdog.cc',
       'src/node_worker.cc',
       'src/node_zlib.cc',
+      'src/node_zygote.cc',
       'src/path.cc',
       'src/permission/child_process_permission.cc',
       'src/permission/fs_permission.cc',
@@ -165,10 +182,12 @@
       'src/string_decoder.cc',
       'src/tcp_wrap.cc',
       'src/timers.cc',
+      'src/timer_wheel.cc',
       'src/timer_wrap.cc',
       'src/tracing/agent.cc',
       'src/tracing/node_trace_buffer.cc',
       'src/tracing/node_trace_writer.cc',
+      'src/tracing/perfetto_trace_writer.cc',
       'src/tracing/trace_event.cc',
       'src/tracing/traced_value.cc',
       'src/tty_wrap.cc',
@@ -180,6 +199,7 @@
       'src/aliased_buffer-inl.h',
       'src/aliased_struct.h',
       'src/aliased_struct-inl.h',
+      'src/async_context_frame.h',
       'src/async_wrap.h',
       'src/async_wrap-inl.h',
       'src/base_object.h',
@@ -196,6 +216,7 @@
       'src/compile_cache.h',
       'src/connect_wrap.h',
       'src/connection_wrap.h',
+      'src/cppgc_helpers.h',
       'src/dataqueue/queue.h',
       'src/debug_utils.h',
       'src/debug_utils-inl.h',
@@ -205,25 +226,33 @@
       'src/env.h',
       'src/env-inl.h',
       'src/handle_wrap.h',
+      'src/heap_snapshot_writer.h',
       'src/histogram.h',
       'src/histogram-inl.h',
       'src/js_stream.h',
       'src/json_utils.h',
       'src/large_pages/node_large_page.cc',
+      'src/large_pages/node_large_page_heap.cc',
       'src/large_pages/node_large_page.h',
       'src/memory_tracker.h',
       'src/memory_tracker-inl.h',
+      'src/module_fs_cache.h',
+      'src/module_graph_loader.h',
       'src/module_wrap.h',
+      'src/mpsc_queue.h',
       'src/node.h',
       'src/node_api.h',
       'src/node_api_types.h',
+      'src/node_array_buffer_pool.h',
       'src/node_binding.h',
       'src/node_blob.h',
       'src/node_buffer.h',
       'src/node_builtins.h',
+      'src/node_checksum.h',
       'src/node_constants.h',
       'src/node_context_data.h',
       'src/node_contextify.h',
+      'src/node_coverage.h',
       'src/node_dir.h',
       'src/node_dotenv.h',
       'src/node_errors.h',
@@ -237,12 +266,15 @@
       'src/node_http2_state.h',
       'src/node_i18n.h',
       'src/node_internals.h',
+      'src/node_log_sink.h',
       'src/node_main_instance.h',
       'src/node_mem.h',
       'src/node_mem-inl.h',
       'src/node_messaging.h',
       'src/node_metadata.h',
+      'src/node_metrics.h',
       'src/node_mutex.h',
+      'src/node_module_pack.h',
       'src/node_modules.h',
       'src/node_object_wrap.h',
       'src/node_options.h',
@@ -250,6 +282,7 @@
       'src/node_perf.h',
       'src/node_perf_common.h',
       'src/node_platform.h',
+      'src/node_pprof.h',
       'src/node_process.h',
       'src/node_process-inl.h',
       'src/node_realm.h',
@@ -259,6 +292,8 @@
       'src/node_root_certs.h',
       'src/node_sea.h',
       'src/node_shadow_realm.h',
+      'src/node_shared_arena.h',
+      'src/node_shm_channel.h',
       'src/node_snapshotable.h',
       'src/node_snapshot_builder.h',
       'src/node_sockaddr.h',
@@ -266,12 +301,14 @@
       'src/node_stat_watcher.h',
       'src/node_union_bytes.h',
       'src/node_url.h',
+      'src/node_util_inspect.h',
       'src/node_version.h',
       'src/node_v8.h',
       'src/node_v8_platform-inl.h',
       'src/node_wasi.h',
       'src/node_watchdog.h',
       'src/node_worker.h',
+      'src/node_zygote.h',
       'src/path.h',
       'src/permission/child_process_permission.h',
       'src/permission/fs_permission.h',
@@ -279,9 +316,11 @@
       'src/permission/permission.h',
       'src/permission/worker_permission.h',
       'src/pipe_wrap.h',
+      'src/protobuf_writer.h',
       'src/req_wrap.h',
       'src/req_wrap-inl.h',
       'src/spawn_sync.h',
+      'src/spsc_ring_buffer.h',
       'src/stream_base.h',
       'src/stream_base-inl.h',
       'src/stream_pipe.h',
@@ -292,9 +331,11 @@
       'src/string_search.h',
       'src/tcp_wrap.h',
       'src/timers.h',
+      'src/timer_wheel.h',
       'src/tracing/agent.h',
       'src/tracing/node_trace_buffer.h',
       'src/tracing/node_trace_writer.h',
+      'src/tracing/perfetto_trace_writer.h',
       'src/tracing/trace_event.h',
       'src/tracing/trace_event_common.h',
       'src/tracing/traced_value.h',
@@ -306,6 +347,7 @@
       'src/util-inl.h',
     ],
     'node_crypto_sources': [
+      'src/crypto/crypto_aead.cc',
       'src/crypto/crypto_aes.cc',
       'src/crypto/crypto_bio.cc',
       'src/crypto/crypto_common.cc',
@@ -328,8 +370,10 @@
       'src/crypto/crypto_keys.cc',
       'src/crypto/crypto_keygen.cc',
       'src/crypto/crypto_scrypt.cc',
+      'src/crypto/crypto_session_cache.cc',
       'src/crypto/crypto_tls.cc',
       'src/crypto/crypto_x509.cc',
+      'src/crypto/crypto_aead.h',
       'src/crypto/crypto_bio.h',
       'src/crypto/crypto_clienthello-inl.h',
       'src/crypto/crypto_dh.h',
@@ -344,6 +388,7 @@
       'src/crypto/crypto_keys.h',
       'src/crypto/crypto_keygen.h',
       'src/crypto/crypto_scrypt.h',
+      'src/crypto/crypto_session_cache.h',
       'src/crypto/crypto_tls.h',
       'src/crypto/crypto_clienthello.h',
       'src/crypto/crypto_context.h',
@@ -395,32 +440,107 @@
       'test/cctest/node_test_fixture.cc',
       'test/cctest/node_test_fixture.h',
       'test/cctest/test_aliased_buffer.cc',
+      'test/cctest/test_array_buffer_pool.cc',
+      'test/cctest/test_async_context_frame.cc',
       'test/cctest/test_base64.cc',
       'test/cctest/test_base_object_ptr.cc',
+      'test/cctest/test_callback_queue.cc',
+      'test/cctest/test_cares_address_cache.cc',
+      'test/cctest/test_cares_wrap.cc',
+      'test/cctest/test_checksum.cc',
+      'test/cctest/test_cleanup_queue.cc',
+      'test/cctest/test_compile_cache.cc',
+      'test/cctest/test_connection_wrap.cc',
+      'test/cctest/test_coverage.cc',
       'test/cctest/test_cppgc.cc',
+      'test/cctest/test_encoding_binding.cc',
+      'test/cctest/test_node_buffer.cc',
+      'test/cctest/test_node_contextify.cc',
+      'test/cctest/test_node_dir.cc',
+      'test/cctest/test_node_dotenv.cc',
+      'test/cctest/test_node_env_var.cc',
+      'test/cctest/test_node_file.cc',
+      'test/cctest/test_node_http2.cc',
+      'test/cctest/test_node_http_parser.cc',
+      'test/cctest/test_node_i18n.cc',
+      'test/cctest/test_node_mem.cc',
+      'test/cctest/test_node_messaging.cc',
+      'test/cctest/test_node_perf.cc',
       'test/cctest/test_node_postmortem_metadata.cc',
+      'test/cctest/test_node_sea.cc',
+      'test/cctest/test_node_stat_watcher.cc',
       'test/cctest/test_node_task_runner.cc',
+      'test/cctest/test_node_url.cc',
+      'test/cctest/test_node_v8.cc',
+      'test/cctest/test_node_wasi.cc',
+      'test/cctest/test_node_zlib.cc',
       'test/cctest/test_environment.cc',
+      'test/cctest/test_fs_event_wrap.cc',
+      'test/cctest/test_fs_permission.cc',
+      'test/cctest/test_heap_snapshot_writer.cc',
+      'test/cctest/test_histogram.cc',
       'test/cctest/test_linked_binding.cc',
+      'test/cctest/test_log_sink.cc',
+      'test/cctest/test_metrics.cc',
+      'test/cctest/test_module_graph_loader.cc',
+      'test/cctest/test_module_pack.cc',
+      'test/cctest/test_mpsc_queue.cc',
       'test/cctest/test_node_api.cc',
+      'test/cctest/test_os.cc',
       'test/cctest/test_path.cc',
+      'test/cctest/test_perfetto_trace_writer.cc',
       'test/cctest/test_per_process.cc',
       'test/cctest/test_platform.cc',
+      'test/cctest/test_pprof.cc',
+      'test/cctest/test_process_wrap.cc',
       'test/cctest/test_report.cc',
+      'test/cctest/test_serdes.cc',
+      'test/cctest/test_shared_arena.cc',
+      'test/cctest/test_shm_channel.cc',
       'test/cctest/test_json_utils.cc',
       'test/cctest/test_sockaddr.cc',
+      'test/cctest/test_spsc_ring_buffer.cc',
+      'test/cctest/test_stream_base.cc',
+      'test/cctest/test_stream_wrap.cc',
+      'test/cctest/test_string_bytes.cc',
+      'test/cctest/test_string_search.cc',
+      'test/cctest/test_tcp_wrap.cc',
+      'test/cctest/test_timer_wheel.cc',
       'test/cctest/test_traced_value.cc',
+      'test/cctest/test_udp_wrap.cc',
+      'test/cctest/test_union_bytes.cc',
       'test/cctest/test_util.cc',
+      'test/cctest/test_util_inspect.cc',
+      'test/cctest/test_zygote.cc',
       'test/cctest/test_dataqueue.cc',
     ],
     'node_cctest_openssl_sources': [
+      'test/cctest/test_crypto_aead.cc',
       'test/cctest/test_crypto_clienthello.cc',
+      'test/cctest/test_crypto_hash.cc',
+      'test/cctest/test_crypto_keypool.cc',
+      'test/cctest/test_crypto_keys.cc',
+      'test/cctest/test_crypto_session_cache.cc',
+      'test/cctest/test_crypto_sig.cc',
       'test/cctest/test_node_crypto.cc',
       'test/cctest/test_node_crypto_env.cc',
       'test/cctest/test_quic_cid.cc',
       'test/cctest/test_quic_error.cc',
+      'test/cctest/test_quic_sessionticket.cc',
       'test/cctest/test_quic_tokens.cc',
     ],
+    'node_bench_native_sources': [
+      'src/node_snapshot_stub.cc',
+      'test/cctest/node_test_fixture.cc',
+      'test/cctest/node_test_fixture.h',
+      'test/cctest/bench/bench_base64.cc',
+      'test/cctest/bench/bench_dataqueue.cc',
+      'test/cctest/bench/bench_fs_permission.cc',
+      'test/cctest/bench/bench_sockaddr.cc',
+      'test/cctest/bench/bench_string_bytes.cc',
+      'test/cctest/bench/node_bench.cc',
+      'test/cctest/bench/node_bench.h',
+    ],
     'node_cctest_inspector_sources': [
       'test/cctest/test_inspector_socket.cc',
       'test/cctest/test_inspector_socket_server.cc',
@@ -1223,6 +1343,79 @@
       ],
     }, # cctest
 
+    {
+      'target_name': 'node_bench_native',
+      'type': 'executable',
+
+      'dependencies': [
+        '<(node_lib_target_name)',
+        'deps/googletest/googletest.gyp:gtest',
+        'deps/histogram/histogram.gyp:histogram',
+        'deps/simdjson/simdjson.gyp:simdjson',
+        'deps/simdutf/simdutf.gyp:simdutf',
+        'deps/ada/ada.gyp:ada',
+      ],
+
+      'includes': [
+        'node.gypi'
+      ],
+
+      'include_dirs': [
+        'src',
+        'tools/msvs/genfiles',
+        'deps/v8/include',
+        'deps/cares/include',
+        'deps/uv/include',
+        'test/cctest',
+        'test/cctest/bench',
+      ],
+
+      'defines': [
+        'NODE_ARCH="<(target_arch)"',
+        'NODE_PLATFORM="<(OS)"',
+        'NODE_WANT_INTERNALS=1',
+      ],
+
+      'sources': [ '<@(node_bench_native_sources)' ],
+
+      'conditions': [
+        [ 'node_use_openssl=="true"', {
+          'defines': [
+            'HAVE_OPENSSL=1',
+          ],
+        }],
+        ['v8_enable_inspector==1', {
+          'defines': [
+            'HAVE_INSPECTOR=1',
+          ],
+        }, {
+           'defines': [
+             'HAVE_INSPECTOR=0',
+           ]
+        }],
+        # Skip the benchmarks while building shared lib node for Windows
+        [ 'OS=="win" and node_shared=="true"', {
+          'type': 'none',
+        }],
+        [ 'node_shared=="true"', {
+          'xcode_settings': {
+            'OTHER_LDFLAGS': [ '-Wl,-rpath,@loader_path', ],
+          },
+        }],
+        ['OS=="win"', {
+          'libraries': [
+            'Dbghelp.lib',
+            'winmm.lib',
+            'Ws2_32.lib',
+          ],
+        }],
+        # Avoid excessive LTO
+        ['enable_lto=="true"', {
+          'ldflags': [ '-fno-lto' ],
+        }],
+      ],
+    }, # node_bench_native
+
     {
       'target_name': 'embedtest',
       'type': 'executable',
@@ -1324,6 +1517,14 @@
         [ 'OS in "linux mac"', {
           'defines': ['NODE_JS2C_USE_STRING_LITERALS'],
         }],
+        [ 'node_compress_builtins=="true"', {
+          'defines': ['NODE_JS2C_COMPRESS_BUILTINS'],
+          'conditions': [
+            [ 'node_shared_brotli=="false"', {
+              'dependencies': [ 'deps/brotli/brotli.gyp:brotli#host' ],
+            }],
+          ],
+        }],
         [ 'debug_node=="true"', {
           'cflags!': [ '-O3' ],
           'cflags': [ '-g', '-O0' ],
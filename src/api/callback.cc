@@ -1,4 +1,5 @@
 #include "node.h"
+#include "async_context_frame.h"
 #include "async_wrap-inl.h"
 #include "env-inl.h"
 #include "v8.h"
@@ -42,17 +43,28 @@ InternalCallbackScope::InternalCallbackScope(AsyncWrap* async_wrap, int flags)
                             async_wrap->object(),
                             { async_wrap->get_async_id(),
                               async_wrap->get_trigger_async_id() },
-                            flags) {}
+                            flags,
+                            async_wrap->context_frame()) {}
+
+BatchTaskQueuesScope::BatchTaskQueuesScope(AsyncWrap* async_wrap) {
+  if (async_wrap->env()->options()->experimental_batch_io_callbacks) {
+    scope_.emplace(async_wrap,
+                   InternalCallbackScope::kSkipAsyncHooks |
+                       InternalCallbackScope::kBatchTaskQueues);
+  }
+}
 
 InternalCallbackScope::InternalCallbackScope(Environment* env,
                                              Local<Object> object,
                                              const async_context& asyncContext,
-                                             int flags)
+                                             int flags,
+                                             Local<Value> context_frame)
   : env_(env),
     async_context_(asyncContext),
     object_(object),
     skip_hooks_(flags & kSkipAsyncHooks),
-    skip_task_queues_(flags & kSkipTaskQueues) {
+    skip_task_queues_(flags & kSkipTaskQueues),
+    batch_task_queues_(flags & kBatchTaskQueues) {
   CHECK_NOT_NULL(env);
   env->PushAsyncCallbackScope();
 
@@ -63,6 +75,13 @@ InternalCallbackScope::InternalCallbackScope(Environment* env,
 
   Isolate* isolate = env->isolate();
 
+  // This has to be outside of the HandleScope below, so that the prior frame
+  // stays alive until Close().
+  if (!context_frame.IsEmpty()) {
+    prior_context_frame_ =
+        async_context_frame::exchange(isolate, context_frame);
+  }
+
   HandleScope handle_scope(isolate);
   Local<Context> current_context = isolate->GetCurrentContext();
   // If you hit this assertion, the caller forgot to enter the right Node.js
@@ -97,6 +116,11 @@ void InternalCallbackScope::Close() {
   if (closed_) return;
   closed_ = true;
 
+  if (!prior_context_frame_.IsEmpty()) {
+    env_->isolate()->SetContinuationPreservedEmbedderData(
+        prior_context_frame_);
+  }
+
   // This function must ends up with either cleanup the
   // async id stack or pop the topmost one from it
 
@@ -130,6 +154,11 @@ void InternalCallbackScope::Close() {
 
   if (!env_->can_call_into_js()) return;
 
+  if (batch_task_queues_ && env_->options()->experimental_batch_io_callbacks) {
+    env_->ScheduleTaskQueueFlush();
+    return;
+  }
+
   auto weakref_cleanup = OnScopeLeave([&]() { env_->RunWeakRefCleanup(); });
 
   Local<Context> context = env_->context();
@@ -173,7 +202,8 @@ MaybeLocal<Value> InternalMakeCallback(Environment* env,
                                        const Local<Function> callback,
                                        int argc,
                                        Local<Value> argv[],
-                                       async_context asyncContext) {
+                                       async_context asyncContext,
+                                       Local<Value> context_frame) {
   CHECK(!recv.IsEmpty());
 #ifdef DEBUG
   for (int i = 0; i < argc; i++)
@@ -194,7 +224,8 @@ MaybeLocal<Value> InternalMakeCallback(Environment* env,
         async_hooks->fields()[AsyncHooks::kUsesExecutionAsyncResource] > 0;
   }
 
-  InternalCallbackScope scope(env, resource, asyncContext, flags);
+  InternalCallbackScope scope(
+      env, resource, asyncContext, flags, context_frame);
   if (scope.Failed()) {
     return MaybeLocal<Value>();
   }
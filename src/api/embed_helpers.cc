@@ -269,6 +269,32 @@ Maybe<int> SpinEventLoop(Environment* env) {
   return Just(static_cast<int>(result.FromJust()));
 }
 
+int GetEventLoopBackendFd(Environment* env) {
+  CHECK_NOT_NULL(env);
+  return uv_backend_fd(env->event_loop());
+}
+
+int GetEventLoopTimeout(Environment* env) {
+  CHECK_NOT_NULL(env);
+  return uv_backend_timeout(env->event_loop());
+}
+
+Maybe<bool> RunEventLoopOnce(Environment* env) {
+  CHECK_NOT_NULL(env);
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+  SealHandleScope seal(isolate);
+
+  if (env->is_stopping()) return Nothing<bool>();
+  // Unlike SpinEventLoop(), this does not call platform->DrainTasks(),
+  // which blocks until the background tasks of the isolate are done.
+  // Foreground tasks are still run, they are posted to the event loop.
+  uv_run(env->event_loop(), UV_RUN_NOWAIT);
+  if (env->is_stopping()) return Nothing<bool>();
+  return Just(uv_loop_alive(env->event_loop()) != 0);
+}
+
 uv_loop_t* CommonEnvironmentSetup::event_loop() const {
   return &impl_->loop;
 }
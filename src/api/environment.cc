@@ -101,19 +101,41 @@ MaybeLocal<Value> PrepareStackTraceCallback(Local<Context> context,
   return result;
 }
 
+NodeArrayBufferAllocator::NodeArrayBufferAllocator()
+    : pool_(per_process::cli_options->array_buffer_pool ? ArrayBufferPool::Get()
+                                                        : nullptr) {}
+
 void* NodeArrayBufferAllocator::Allocate(size_t size) {
-  void* ret;
-  if (zero_fill_field_ || per_process::cli_options->zero_fill_all_buffers)
-    ret = allocator_->Allocate(size);
-  else
-    ret = allocator_->AllocateUninitialized(size);
+  void* ret = nullptr;
+  bool zero_fill =
+      zero_fill_field_ || per_process::cli_options->zero_fill_all_buffers;
+  // Large pages are always zero-filled.
+  if (UNLIKELY(size >= large_page_threshold_))
+    ret = large_pages::AllocateArrayBuffer(size);
+  if (ret == nullptr) {
+    if (IsPooled(size)) {
+      // Pooled memory is reused, so it is cleared here. Pooled sizes never
+      // fall back to `allocator_`, which is how Free() tells them apart.
+      ret = pool_->Allocate(size);
+      if (ret != nullptr && zero_fill) memset(ret, 0, size);
+    } else if (zero_fill) {
+      ret = allocator_->Allocate(size);
+    } else {
+      ret = allocator_->AllocateUninitialized(size);
+    }
+  }
   if (LIKELY(ret != nullptr))
     total_mem_usage_.fetch_add(size, std::memory_order_relaxed);
   return ret;
 }
 
 void* NodeArrayBufferAllocator::AllocateUninitialized(size_t size) {
-  void* ret = allocator_->AllocateUninitialized(size);
+  void* ret = nullptr;
+  if (UNLIKELY(size >= large_page_threshold_))
+    ret = large_pages::AllocateArrayBuffer(size);
+  if (ret == nullptr)
+    ret = IsPooled(size) ? pool_->Allocate(size)
+                         : allocator_->AllocateUninitialized(size);
   if (LIKELY(ret != nullptr))
     total_mem_usage_.fetch_add(size, std::memory_order_relaxed);
   return ret;
@@ -121,6 +143,23 @@ void* NodeArrayBufferAllocator::AllocateUninitialized(size_t size) {
 
 void* NodeArrayBufferAllocator::Reallocate(
     void* data, size_t old_size, size_t size) {
+  if (UNLIKELY(std::max(old_size, size) >= large_page_threshold_) ||
+      IsPooled(old_size) || IsPooled(size)) {
+    // Either side may be in large pages or in the pool, which cannot be
+    // resized in place.
+    // The qualified calls keep subclasses from seeing this as a separate
+    // allocation.
+    void* ret = nullptr;
+    if (size != 0) {
+      ret = NodeArrayBufferAllocator::AllocateUninitialized(size);
+      if (ret == nullptr) return nullptr;
+      memcpy(ret, data, std::min(old_size, size));
+      if (size > old_size)
+        memset(static_cast<char*>(ret) + old_size, 0, size - old_size);
+    }
+    NodeArrayBufferAllocator::Free(data, old_size);
+    return ret;
+  }
   void* ret = allocator_->Reallocate(data, old_size, size);
   if (LIKELY(ret != nullptr) || UNLIKELY(size == 0))
     total_mem_usage_.fetch_add(size - old_size, std::memory_order_relaxed);
@@ -129,6 +168,11 @@ void* NodeArrayBufferAllocator::Reallocate(
 
 void NodeArrayBufferAllocator::Free(void* data, size_t size) {
   total_mem_usage_.fetch_sub(size, std::memory_order_relaxed);
+  if (UNLIKELY(size >= large_page_threshold_) &&
+      large_pages::FreeArrayBuffer(data, size)) {
+    return;
+  }
+  if (IsPooled(size)) return pool_->Free(data, size);
   allocator_->Free(data, size);
 }
 
@@ -355,6 +399,14 @@ Isolate* NewIsolate(Isolate::CreateParams* params,
   platform->RegisterIsolate(isolate, event_loop);
 
   SetIsolateCreateParamsForNode(params);
+  if (settings.max_young_generation_size_in_bytes != 0) {
+    params->constraints.set_max_young_generation_size_in_bytes(
+        settings.max_young_generation_size_in_bytes);
+  }
+  if (settings.max_old_generation_size_in_bytes != 0) {
+    params->constraints.set_max_old_generation_size_in_bytes(
+        settings.max_old_generation_size_in_bytes);
+  }
   Isolate::Initialize(isolate, *params);
 
   Isolate::Scope isolate_scope(isolate);
@@ -0,0 +1,70 @@
+#include "async_context_frame.h"  // NOLINT(build/include_inline)
+#include "env-inl.h"
+#include "node_external_reference.h"
+#include "util-inl.h"
+#include "v8.h"
+
+namespace node {
+namespace async_context_frame {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+Local<Value> current(Isolate* isolate) {
+  return isolate->GetContinuationPreservedEmbedderData();
+}
+
+Local<Value> exchange(Isolate* isolate, Local<Value> frame) {
+  Local<Value> prior = current(isolate);
+  isolate->SetContinuationPreservedEmbedderData(frame);
+  return prior;
+}
+
+Scope::Scope(Isolate* isolate, Local<Value> frame)
+    : isolate_(isolate), prior_(exchange(isolate, frame)) {}
+
+Scope::~Scope() {
+  isolate_->SetContinuationPreservedEmbedderData(prior_);
+}
+
+static void GetContinuationPreservedEmbedderData(
+    const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(current(args.GetIsolate()));
+}
+
+static void SetContinuationPreservedEmbedderData(
+    const FunctionCallbackInfo<Value>& args) {
+  args.GetIsolate()->SetContinuationPreservedEmbedderData(args[0]);
+}
+
+static void Initialize(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context,
+                       void* priv) {
+  SetMethodNoSideEffect(context,
+                        target,
+                        "getContinuationPreservedEmbedderData",
+                        GetContinuationPreservedEmbedderData);
+  SetMethod(context,
+            target,
+            "setContinuationPreservedEmbedderData",
+            SetContinuationPreservedEmbedderData);
+}
+
+static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(GetContinuationPreservedEmbedderData);
+  registry->Register(SetContinuationPreservedEmbedderData);
+}
+
+}  // namespace async_context_frame
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(
+    async_context_frame, node::async_context_frame::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(
+    async_context_frame,
+    node::async_context_frame::RegisterExternalReferences)
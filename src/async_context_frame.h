@@ -0,0 +1,42 @@
+#ifndef SRC_ASYNC_CONTEXT_FRAME_H_
+#define SRC_ASYNC_CONTEXT_FRAME_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "v8.h"
+
+namespace node {
+namespace async_context_frame {
+
+// The async context frame is the value that AsyncLocalStorage keeps its
+// stores in. It lives in V8's continuation-preserved embedder data, so V8
+// carries it across promise continuations on its own, and native code only
+// has to carry it from where an AsyncWrap is created to where its callbacks
+// run. Nothing here needs async_hooks to be enabled.
+
+// Returns the current frame, which is undefined if there is none.
+v8::Local<v8::Value> current(v8::Isolate* isolate);
+// Makes `frame` the current frame and returns the previous one.
+v8::Local<v8::Value> exchange(v8::Isolate* isolate,
+                              v8::Local<v8::Value> frame);
+
+// Makes `frame` the current frame until the scope is left.
+class Scope {
+ public:
+  Scope(v8::Isolate* isolate, v8::Local<v8::Value> frame);
+  ~Scope();
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  v8::Isolate* isolate_;
+  v8::Local<v8::Value> prior_;
+};
+
+}  // namespace async_context_frame
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_ASYNC_CONTEXT_FRAME_H_
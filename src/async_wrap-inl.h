@@ -49,6 +49,12 @@ inline double AsyncWrap::get_trigger_async_id() const {
   return trigger_async_id_;
 }
 
+inline v8::Local<v8::Value> AsyncWrap::context_frame() const {
+  v8::Isolate* isolate = env()->isolate();
+  if (context_frame_.IsEmpty()) return v8::Undefined(isolate);
+  return context_frame_.Get(isolate);
+}
+
 
 inline v8::MaybeLocal<v8::Value> AsyncWrap::MakeCallback(
     const v8::Local<v8::String> symbol,
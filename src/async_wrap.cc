@@ -21,21 +21,26 @@
 
 #include "async_wrap.h"  // NOLINT(build/include_inline)
 #include "async_wrap-inl.h"
+#include "async_context_frame.h"
 #include "env-inl.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "node_perf.h"
 #include "tracing/traced_value.h"
 #include "util-inl.h"
 
 #include "v8.h"
 
+#include <cstring>
+
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::DontDelete;
 using v8::EscapableHandleScope;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
-using v8::Global;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
@@ -66,6 +71,7 @@ static const char* const provider_names[] = {
 
 void AsyncWrap::DestroyAsyncIdsCallback(Environment* env) {
   Local<Function> fn = env->async_hooks_destroy_function();
+  Local<Function> batch_fn = env->async_hooks_destroy_batch_function();
 
   TryCatchScope try_catch(env, TryCatchScope::CatchMode::kFatal);
 
@@ -73,6 +79,26 @@ void AsyncWrap::DestroyAsyncIdsCallback(Environment* env) {
     std::vector<double> destroy_async_id_list;
     destroy_async_id_list.swap(*env->destroy_async_id_list());
     if (!env->can_call_into_js()) return;
+    // The list may have been emptied by a microtask since this callback
+    // was scheduled. Do not call the hook for nothing then.
+    if (destroy_async_id_list.empty()) return;
+    if (!batch_fn.IsEmpty()) {
+      // Hand all ids to JS at once, which saves a call into JS per id.
+      HandleScope scope(env->isolate());
+      const size_t count = destroy_async_id_list.size();
+      Local<ArrayBuffer> ab;
+      {
+        NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+        ab = ArrayBuffer::New(env->isolate(), count * sizeof(double));
+      }
+      memcpy(ab->Data(), destroy_async_id_list.data(), count * sizeof(double));
+      Local<Value> ids = Float64Array::New(ab, 0, count);
+      if (batch_fn->Call(env->context(), Undefined(env->isolate()), 1, &ids)
+              .IsEmpty()) {
+        return;
+      }
+      continue;
+    }
     for (auto async_id : destroy_async_id_list) {
       // Want each callback to be cleaned up after itself, instead of cleaning
       // them all up after the while() loop completes.
@@ -108,6 +134,8 @@ void AsyncWrap::EmitPromiseResolve(Environment* env, double async_id) {
 
 
 void AsyncWrap::EmitTraceEventBefore() {
+  if (!env()->is_trace_category_enabled(Environment::kTraceAsyncHooks))
+    return;
   switch (provider_type()) {
 #define V(PROVIDER)                                                           \
     case PROVIDER_ ## PROVIDER:                                               \
@@ -129,7 +157,11 @@ void AsyncWrap::EmitBefore(Environment* env, double async_id) {
 }
 
 
-void AsyncWrap::EmitTraceEventAfter(ProviderType type, double async_id) {
+void AsyncWrap::EmitTraceEventAfter(Environment* env,
+                                    ProviderType type,
+                                    double async_id) {
+  if (!env->is_trace_category_enabled(Environment::kTraceAsyncHooks))
+    return;
   switch (type) {
 #define V(PROVIDER)                                                           \
     case PROVIDER_ ## PROVIDER:                                               \
@@ -181,6 +213,17 @@ static void SetupHooks(const FunctionCallbackInfo<Value>& args) {
   SET_HOOK_FN(destroy);
   SET_HOOK_FN(promise_resolve);
 #undef SET_HOOK_FN
+
+  // Optional. If it is set, it is called with a Float64Array of the ids of
+  // all resources that were destroyed since the last call, instead of calling
+  // `destroy` once for each of them.
+  Local<Value> destroy_batch;
+  if (fn_obj->Get(env->context(),
+                  FIXED_ONE_BYTE_STRING(env->isolate(), "destroy_batch"))
+          .ToLocal(&destroy_batch) &&
+      destroy_batch->IsFunction()) {
+    env->set_async_hooks_destroy_batch_function(destroy_batch.As<Function>());
+  }
 }
 
 static void SetPromiseHooks(const FunctionCallbackInfo<Value>& args) {
@@ -193,18 +236,6 @@ static void SetPromiseHooks(const FunctionCallbackInfo<Value>& args) {
       args[3]->IsFunction() ? args[3].As<Function>() : Local<Function>());
 }
 
-class DestroyParam {
- public:
-  double asyncId;
-  Environment* env;
-  Global<Object> target;
-  Global<Object> propBag;
-};
-
-static void DestroyParamCleanupHook(void* ptr) {
-  delete static_cast<DestroyParam*>(ptr);
-}
-
 void AsyncWrap::WeakCallback(const WeakCallbackInfo<DestroyParam>& info) {
   HandleScope scope(info.GetIsolate());
 
@@ -213,8 +244,6 @@ void AsyncWrap::WeakCallback(const WeakCallbackInfo<DestroyParam>& info) {
                                                       p->propBag);
   Local<Value> val;
 
-  p->env->RemoveCleanupHook(DestroyParamCleanupHook, p.get());
-
   if (!prop_bag.IsEmpty() &&
       !prop_bag->Get(p->env->context(), p->env->destroyed_string())
         .ToLocal(&val)) {
@@ -242,7 +271,9 @@ static void RegisterDestroyHook(const FunctionCallbackInfo<Value>& args) {
     p->propBag.Reset(isolate, args[2].As<Object>());
   }
   p->target.SetWeak(p, AsyncWrap::WeakCallback, WeakCallbackType::kParameter);
-  p->env->AddCleanupHook(DestroyParamCleanupHook, p);
+  // This is much cheaper than a cleanup hook per object, which matters for
+  // programs that create a large number of promises.
+  p->env->destroy_param_queue()->PushBack(p);
 }
 
 void AsyncWrap::GetAsyncId(const FunctionCallbackInfo<Value>& args) {
@@ -538,7 +569,35 @@ AsyncWrap::~AsyncWrap() {
   EmitDestroy(true /* from gc */);
 }
 
+void AsyncWrap::EmitTraceEventInit() {
+  if (!env()->is_trace_category_enabled(Environment::kTraceAsyncHooks))
+    return;
+  switch (provider_type()) {
+#define V(PROVIDER)                                                           \
+    case PROVIDER_ ## PROVIDER:                                               \
+      if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(                        \
+          TRACING_CATEGORY_NODE1(async_hooks))) {                             \
+        auto data = tracing::TracedValue::Create();                           \
+        data->SetInteger("executionAsyncId",                                  \
+                         static_cast<int64_t>(env()->execution_async_id()));  \
+        data->SetInteger("triggerAsyncId",                                    \
+                         static_cast<int64_t>(get_trigger_async_id()));       \
+        TRACE_EVENT_NESTABLE_ASYNC_BEGIN1(                                    \
+          TRACING_CATEGORY_NODE1(async_hooks),                                \
+          #PROVIDER, static_cast<int64_t>(get_async_id()),                    \
+          "data", std::move(data));                                           \
+        }                                                                     \
+      break;
+    NODE_ASYNC_PROVIDER_TYPES(V)
+#undef V
+    default:
+      UNREACHABLE();
+  }
+}
+
 void AsyncWrap::EmitTraceEventDestroy() {
+  if (!env()->is_trace_category_enabled(Environment::kTraceAsyncHooks))
+    return;
   switch (provider_type()) {
   #define V(PROVIDER)                                                         \
     case PROVIDER_ ## PROVIDER:                                               \
@@ -600,6 +659,12 @@ void AsyncWrap::AsyncReset(Local<Object> resource, double execution_async_id,
 
   {
     HandleScope handle_scope(env()->isolate());
+    Local<Value> frame = async_context_frame::current(env()->isolate());
+    if (frame->IsUndefined())
+      context_frame_.Reset();
+    else
+      context_frame_.Reset(env()->isolate(), frame);
+
     Local<Object> obj = object();
     CHECK(!obj.IsEmpty());
     if (resource != obj) {
@@ -607,27 +672,7 @@ void AsyncWrap::AsyncReset(Local<Object> resource, double execution_async_id,
     }
   }
 
-  switch (provider_type()) {
-#define V(PROVIDER)                                                           \
-    case PROVIDER_ ## PROVIDER:                                               \
-      if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(                        \
-          TRACING_CATEGORY_NODE1(async_hooks))) {                             \
-        auto data = tracing::TracedValue::Create();                           \
-        data->SetInteger("executionAsyncId",                                  \
-                         static_cast<int64_t>(env()->execution_async_id()));  \
-        data->SetInteger("triggerAsyncId",                                    \
-                         static_cast<int64_t>(get_trigger_async_id()));       \
-        TRACE_EVENT_NESTABLE_ASYNC_BEGIN1(                                    \
-          TRACING_CATEGORY_NODE1(async_hooks),                                \
-          #PROVIDER, static_cast<int64_t>(get_async_id()),                    \
-          "data", std::move(data));                                           \
-        }                                                                     \
-      break;
-    NODE_ASYNC_PROVIDER_TYPES(V)
-#undef V
-    default:
-      UNREACHABLE();
-  }
+  EmitTraceEventInit();
 
   if (silent) return;
 
@@ -670,14 +715,17 @@ MaybeLocal<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
                                           Local<Value>* argv) {
   EmitTraceEventBefore();
 
+  Environment* env = this->env();
   ProviderType provider = provider_type();
   async_context context { get_async_id(), get_trigger_async_id() };
+  uint64_t start = uv_hrtime();
   MaybeLocal<Value> ret = InternalMakeCallback(
-      env(), object(), object(), cb, argc, argv, context);
+      env, object(), object(), cb, argc, argv, context, context_frame());
 
   // This is a static call with cached values because the `this` object may
   // no longer be alive at this point.
-  EmitTraceEventAfter(provider, context.async_id);
+  EmitTraceEventAfter(env, provider, context.async_id);
+  env->event_loop_histograms()->RecordCallback(provider, uv_hrtime() - start);
 
   return ret;
 }
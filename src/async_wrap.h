@@ -25,6 +25,7 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include "base_object.h"
+#include "util.h"
 #include "v8.h"
 
 #include <cstdint>
@@ -33,7 +34,9 @@ namespace node {
 
 #define NODE_ASYNC_NON_CRYPTO_PROVIDER_TYPES(V)                                \
   V(NONE)                                                                      \
+  V(DIRCOPY)                                                                   \
   V(DIRHANDLE)                                                                 \
+  V(DIRWALK)                                                                   \
   V(DNSCHANNEL)                                                                \
   V(ELDHISTOGRAM)                                                              \
   V(FILEHANDLE)                                                                \
@@ -66,6 +69,7 @@ namespace node {
   V(QUIC_SESSION)                                                              \
   V(QUIC_STREAM)                                                               \
   V(QUIC_UDP)                                                                  \
+  V(SHMCHANNEL)                                                                \
   V(SHUTDOWNWRAP)                                                              \
   V(SIGNALWRAP)                                                                \
   V(STATWATCHER)                                                               \
@@ -73,6 +77,7 @@ namespace node {
   V(TCPCONNECTWRAP)                                                            \
   V(TCPSERVERWRAP)                                                             \
   V(TCPWRAP)                                                                   \
+  V(TIMERWHEEL)                                                                \
   V(TTYWRAP)                                                                   \
   V(UDPSENDWRAP)                                                               \
   V(UDPWRAP)                                                                   \
@@ -107,9 +112,20 @@ namespace node {
   NODE_ASYNC_CRYPTO_PROVIDER_TYPES(V)
 
 class Environment;
-class DestroyParam;
 class ExternalReferenceRegistry;
 
+// An object whose garbage collection emits a destroy hook, as registered
+// through registerDestroyHook(). The Environment keeps these in a list, so
+// that it can free the ones that are left when it is torn down.
+class DestroyParam {
+ public:
+  double asyncId;
+  Environment* env;
+  v8::Global<v8::Object> target;
+  v8::Global<v8::Object> propBag;
+  ListNode<DestroyParam> destroy_param_queue_;
+};
+
 class AsyncWrap : public BaseObject {
  public:
   enum ProviderType {
@@ -175,8 +191,11 @@ class AsyncWrap : public BaseObject {
 
   void EmitDestroy(bool from_gc = false);
 
+  void EmitTraceEventInit();
   void EmitTraceEventBefore();
-  static void EmitTraceEventAfter(ProviderType type, double async_id);
+  static void EmitTraceEventAfter(Environment* env,
+                                  ProviderType type,
+                                  double async_id);
   void EmitTraceEventDestroy();
 
   static void DestroyAsyncIdsCallback(Environment* env);
@@ -186,6 +205,9 @@ class AsyncWrap : public BaseObject {
 
   inline double get_async_id() const;
   inline double get_trigger_async_id() const;
+  // The async context frame that was current when this object was last
+  // (re)initialized. Its callbacks run with this frame.
+  inline v8::Local<v8::Value> context_frame() const;
 
   void AsyncReset(v8::Local<v8::Object> resource,
                   double execution_async_id = kInvalidAsyncId,
@@ -239,6 +261,9 @@ class AsyncWrap : public BaseObject {
   // Because the values may be Reset(), cannot be made const.
   double async_id_ = kInvalidAsyncId;
   double trigger_async_id_ = kInvalidAsyncId;
+  // Empty if there was no frame, which is the common case when
+  // AsyncLocalStorage is not in use.
+  v8::Global<v8::Value> context_frame_;
 };
 
 }  // namespace node
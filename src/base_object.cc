@@ -23,13 +23,13 @@ BaseObject::BaseObject(Realm* realm, Local<Object> object)
   CHECK_EQ(false, object.IsEmpty());
   CHECK_GE(object->InternalFieldCount(), BaseObject::kInternalFieldCount);
   SetInternalFields(realm->isolate_data(), object, static_cast<void*>(this));
-  realm->AddCleanupHook(DeleteMe, static_cast<void*>(this));
+  realm->AddCleanupHook(&cleanup_hook_);
   realm->modify_base_object_count(1);
 }
 
 BaseObject::~BaseObject() {
   realm()->modify_base_object_count(-1);
-  realm()->RemoveCleanupHook(DeleteMe, static_cast<void*>(this));
+  realm()->RemoveCleanupHook(&cleanup_hook_);
 
   if (UNLIKELY(has_pointer_data())) {
     PointerData* metadata = pointer_data();
@@ -43,6 +43,10 @@ BaseObject::~BaseObject() {
     return;
   }
 
+  // The JS object is about to be thrown away along with the isolate. Not
+  // touching it saves a write into the heap for every object.
+  if (env()->is_discarding()) return;
+
   {
     HandleScope handle_scope(realm()->isolate());
     object()->SetAlignedPointerInInternalField(BaseObject::kSlot, nullptr);
@@ -26,6 +26,7 @@
 
 #include <type_traits>  // std::remove_reference
 #include "base_object_types.h"
+#include "cleanup_queue.h"
 #include "memory_tracker.h"
 #include "v8.h"
 
@@ -232,6 +233,8 @@ class BaseObject : public MemoryRetainer {
 
   Realm* realm_;
   PointerData* pointer_data_ = nullptr;
+  // Deletes this object when the realm is cleaned up.
+  CleanupQueue::CleanupHook cleanup_hook_{DeleteMe, this};
 };
 
 // Global alias for FromJSObject() to avoid churn.
@@ -7,6 +7,39 @@
 
 namespace node {
 
+void* CallbackBlockPool::Allocate(size_t size) {
+  if (size > kBlockSize) return ::operator new(size);
+  FreeList* list = free_list();
+  FreeBlock* block = list->head;
+  if (block == nullptr) return ::operator new(kBlockSize);
+  list->head = block->next;
+  list->count--;
+  return block;
+}
+
+void CallbackBlockPool::Free(void* ptr, size_t size) {
+  if (size > kBlockSize) return ::operator delete(ptr);
+  FreeList* list = free_list();
+  if (list->count >= kMaxFreeBlocks) return ::operator delete(ptr);
+  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+  block->next = list->head;
+  list->head = block;
+  list->count++;
+}
+
+CallbackBlockPool::FreeList::~FreeList() {
+  while (head != nullptr) {
+    FreeBlock* next = head->next;
+    ::operator delete(head);
+    head = next;
+  }
+}
+
+CallbackBlockPool::FreeList* CallbackBlockPool::free_list() {
+  thread_local FreeList list;
+  return &list;
+}
+
 template <typename R, typename... Args>
 template <typename Fn>
 std::unique_ptr<typename CallbackQueue<R, Args...>::Callback>
@@ -90,6 +123,48 @@ R CallbackQueue<R, Args...>::CallbackImpl<Fn>::Call(Args... args) {
   return callback_(std::forward<Args>(args)...);
 }
 
+template <typename R, typename... Args>
+ThreadsafeCallbackQueue<R, Args...>::~ThreadsafeCallbackQueue() {
+  Callback* cb = head_.exchange(nullptr, std::memory_order_acquire);
+  while (cb != nullptr) {
+    Callback* next = cb->next_.release();
+    delete cb;
+    cb = next;
+  }
+}
+
+template <typename R, typename... Args>
+bool ThreadsafeCallbackQueue<R, Args...>::Push(std::unique_ptr<Callback> cb) {
+  Callback* node = cb.release();
+  Callback* head = head_.load(std::memory_order_relaxed);
+  do {
+    // `next_` does not own anything until the entry has been taken over.
+    node->next_.release();
+    node->next_.reset(head);
+  } while (!head_.compare_exchange_weak(
+      head, node, std::memory_order_release, std::memory_order_relaxed));
+  return head == nullptr;
+}
+
+template <typename R, typename... Args>
+void ThreadsafeCallbackQueue<R, Args...>::TakeAll(Queue* queue) {
+  Callback* cb = head_.exchange(nullptr, std::memory_order_acquire);
+  // The list is in reverse order of insertion.
+  Callback* reversed = nullptr;
+  while (cb != nullptr) {
+    Callback* next = cb->next_.release();
+    cb->next_.reset(reversed);
+    reversed = cb;
+    cb = next;
+  }
+  std::unique_ptr<Callback> entry(reversed);
+  while (entry) {
+    std::unique_ptr<Callback> next = entry->get_next();
+    queue->Push(std::move(entry));
+    entry = std::move(next);
+  }
+}
+
 }  // namespace node
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
@@ -4,6 +4,7 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include <atomic>
+#include <cstddef>
 #include <memory>
 
 namespace node {
@@ -15,6 +16,36 @@ enum Flags {
 };
 }
 
+// Fixed-size blocks for the entries of callback queues, so that scheduling a
+// small callback does not have to go through the general-purpose allocator.
+// Each thread keeps its own list of free blocks. An entry that is created on
+// one thread and run on another, as for Environment::SetImmediateThreadsafe(),
+// ends up in the free list of the thread that destroys it.
+class CallbackBlockPool {
+ public:
+  static constexpr size_t kBlockSize = 128;
+  static constexpr size_t kMaxFreeBlocks = 256;
+
+  // Sizes larger than kBlockSize go to ::operator new() directly.
+  static inline void* Allocate(size_t size);
+  static inline void Free(void* ptr, size_t size);
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  struct FreeList {
+    inline ~FreeList();
+    FreeBlock* head = nullptr;
+    size_t count = 0;
+  };
+
+  static inline FreeList* free_list();
+};
+
+template <typename R, typename... Args>
+class ThreadsafeCallbackQueue;
+
 // A queue of C++ functions that take Args... as arguments and return R
 // (this is similar to the signature of std::function).
 // New entries are added using `CreateCallback()`/`Push()`, and removed using
@@ -33,6 +64,13 @@ class CallbackQueue {
 
     inline CallbackFlags::Flags flags() const;
 
+    static void* operator new(size_t size) {
+      return CallbackBlockPool::Allocate(size);
+    }
+    static void operator delete(void* ptr, size_t size) {
+      CallbackBlockPool::Free(ptr, size);
+    }
+
    private:
     inline std::unique_ptr<Callback> get_next();
     inline void set_next(std::unique_ptr<Callback> next);
@@ -41,10 +79,11 @@ class CallbackQueue {
     std::unique_ptr<Callback> next_;
 
     friend class CallbackQueue;
+    friend class ThreadsafeCallbackQueue<R, Args...>;
   };
 
   template <typename Fn>
-  inline std::unique_ptr<Callback> CreateCallback(
+  static inline std::unique_ptr<Callback> CreateCallback(
       Fn&& fn, CallbackFlags::Flags);
 
   inline std::unique_ptr<Callback> Shift();
@@ -72,6 +111,41 @@ class CallbackQueue {
   Callback* tail_ = nullptr;
 };
 
+// A list of callbacks that any number of threads can add to without taking a
+// lock, and that a single consumer takes over in one go.
+template <typename R, typename... Args>
+class ThreadsafeCallbackQueue {
+ public:
+  using Queue = CallbackQueue<R, Args...>;
+  using Callback = typename Queue::Callback;
+
+  ThreadsafeCallbackQueue() = default;
+  inline ~ThreadsafeCallbackQueue();
+  ThreadsafeCallbackQueue(const ThreadsafeCallbackQueue&) = delete;
+  ThreadsafeCallbackQueue& operator=(const ThreadsafeCallbackQueue&) = delete;
+
+  template <typename Fn>
+  static inline std::unique_ptr<Callback> CreateCallback(
+      Fn&& fn, CallbackFlags::Flags flags) {
+    return Queue::CreateCallback(std::move(fn), flags);
+  }
+
+  // May be called from any thread. Returns true if the list was empty before,
+  // i.e. if the consumer may need to be woken up.
+  inline bool Push(std::unique_ptr<Callback> cb);
+  // Moves all entries to the end of `queue`, in the order in which they were
+  // pushed. Must only be called from one thread at a time.
+  inline void TakeAll(Queue* queue);
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  // The most recently pushed entry, linked to the ones before it.
+  std::atomic<Callback*> head_{nullptr};
+};
+
 }  // namespace node
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
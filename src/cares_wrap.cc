@@ -34,8 +34,11 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <unordered_set>
@@ -640,10 +643,12 @@ ChannelWrap::ChannelWrap(
       Environment* env,
       Local<Object> object,
       int timeout,
-      int tries)
+      int tries,
+      uint32_t max_cache_ttl)
     : AsyncWrap(env, object, PROVIDER_DNSCHANNEL),
       timeout_(timeout),
-      tries_(tries) {
+      tries_(tries),
+      max_cache_ttl_(max_cache_ttl) {
   MakeWeak();
 
   Setup();
@@ -657,13 +662,19 @@ void ChannelWrap::MemoryInfo(MemoryTracker* tracker) const {
 
 void ChannelWrap::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
-  CHECK_EQ(args.Length(), 2);
+  CHECK(args.Length() == 2 || args.Length() == 3);
   CHECK(args[0]->IsInt32());
   CHECK(args[1]->IsInt32());
   const int timeout = args[0].As<Int32>()->Value();
   const int tries = args[1].As<Int32>()->Value();
+  // maxCacheTtl, in seconds. Caching is disabled when it is missing or 0.
+  uint32_t max_cache_ttl = 0;
+  if (args.Length() == 3) {
+    CHECK(args[2]->IsUint32());
+    max_cache_ttl = args[2].As<Uint32>()->Value();
+  }
   Environment* env = Environment::GetCurrent(args);
-  new ChannelWrap(env, args.This(), timeout, tries);
+  new ChannelWrap(env, args.This(), timeout, tries, max_cache_ttl);
 }
 
 GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
@@ -672,6 +683,17 @@ GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
     : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_GETADDRINFOREQWRAP),
       order_(order) {}
 
+GetAddrInfoReqWrap::~GetAddrInfoReqWrap() = default;
+
+void GetAddrInfoReqWrap::AddWaiter(BaseObjectPtr<GetAddrInfoReqWrap> waiter) {
+  waiters_.push_back(std::move(waiter));
+}
+
+std::vector<BaseObjectPtr<GetAddrInfoReqWrap>>
+GetAddrInfoReqWrap::TakeWaiters() {
+  return std::move(waiters_);
+}
+
 GetNameInfoReqWrap::GetNameInfoReqWrap(
     Environment* env,
     Local<Object> req_wrap_obj)
@@ -728,9 +750,15 @@ void ChannelWrap::Setup() {
   }
 
   /* We do the call to ares_init_option for caller. */
-  const int optmask =
+  int optmask =
       ARES_OPT_FLAGS | ARES_OPT_TIMEOUTMS |
       ARES_OPT_SOCK_STATE_CB | ARES_OPT_TRIES;
+  if (max_cache_ttl_ > 0) {
+    // Let c-ares keep answers for up to their TTL, so that the resolve*()
+    // methods benefit as well.
+    options.qcache_max_ttl = max_cache_ttl_;
+    optmask |= ARES_OPT_QUERY_CACHE;
+  }
   r = ares_init_options(&channel_, &options, optmask);
 
   if (r != ARES_SUCCESS) {
@@ -777,6 +805,238 @@ ChannelWrap::~ChannelWrap() {
 }
 
 
+AddressCache* AddressCache::GetInstance() {
+  // Intentionally leaked, so that it outlives every thread that uses it.
+  static AddressCache* cache = new AddressCache();
+  return cache;
+}
+
+std::string AddressCache::MakeKey(const std::string& hostname, int family) {
+  std::string key = std::to_string(family) + ":" + hostname;
+  std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) {
+    return std::tolower(c);
+  });
+  return key;
+}
+
+bool AddressCache::Lookup(const std::string& hostname,
+                          int family,
+                          uint64_t now,
+                          std::vector<std::string>* addresses) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = entries_.find(MakeKey(hostname, family));
+  if (it == entries_.end()) return false;
+  if (it->second.expires_at <= now) {
+    entries_.erase(it);
+    return false;
+  }
+  *addresses = it->second.addresses;
+  return true;
+}
+
+void AddressCache::Store(const std::string& hostname,
+                         int family,
+                         const std::vector<std::string>& addresses,
+                         uint64_t now,
+                         uint64_t expires_at) {
+  if (addresses.empty() || expires_at <= now) return;
+  std::string key = MakeKey(hostname, family);
+  Mutex::ScopedLock lock(mutex_);
+  if (entries_.size() >= kMaxEntries && entries_.count(key) == 0) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second.expires_at <= now)
+        it = entries_.erase(it);
+      else
+        ++it;
+    }
+    if (entries_.size() >= kMaxEntries) entries_.erase(entries_.begin());
+  }
+  entries_[key] = Entry{addresses, expires_at};
+}
+
+void AddressCache::Clear() {
+  Mutex::ScopedLock lock(mutex_);
+  entries_.clear();
+}
+
+size_t AddressCache::size() {
+  Mutex::ScopedLock lock(mutex_);
+  return entries_.size();
+}
+
+LookupWrap::LookupWrap(ChannelWrap* channel,
+                       Local<Object> req_wrap_obj,
+                       int family,
+                       uint8_t order)
+    : AsyncWrap(channel->env(),
+                req_wrap_obj,
+                AsyncWrap::PROVIDER_GETADDRINFOREQWRAP),
+      channel_(channel),
+      family_(family),
+      order_(order) {}
+
+LookupWrap::~LookupWrap() {
+  CHECK_EQ(false, persistent().IsEmpty());
+
+  // Let Callback() know that this object no longer exists.
+  if (callback_ptr_ != nullptr)
+    *callback_ptr_ = nullptr;
+}
+
+void LookupWrap::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackField("channel", channel_);
+  tracker->TrackField("hostname", hostname_);
+  tracker->TrackField("addresses", addresses_);
+}
+
+void LookupWrap::Start(const std::string& hostname) {
+  hostname_ = hostname;
+  TRACE_EVENT_NESTABLE_ASYNC_BEGIN2(TRACING_CATEGORY_NODE2(dns, native),
+                                    "lookup",
+                                    this,
+                                    "hostname",
+                                    TRACE_STR_COPY(hostname_.c_str()),
+                                    "family",
+                                    family_ == AF_INET    ? "ipv4"
+                                    : family_ == AF_INET6 ? "ipv6"
+                                                          : "unspec");
+
+  channel_->ModifyActivityQueryCount(1);
+  if (channel_->max_cache_ttl() > 0 &&
+      AddressCache::GetInstance()->Lookup(
+          hostname_, family_, uv_hrtime(), &addresses_)) {
+    return QueueResponseCallback(ARES_SUCCESS);
+  }
+
+  channel_->EnsureServers();
+  struct ares_addrinfo_hints hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = family_;
+  hints.ai_socktype = SOCK_STREAM;
+
+  CHECK_NULL(callback_ptr_);
+  callback_ptr_ = new LookupWrap*(this);
+  ares_getaddrinfo(channel_->cares_channel(),
+                   hostname_.c_str(),
+                   nullptr,
+                   &hints,
+                   Callback,
+                   callback_ptr_);
+}
+
+void LookupWrap::Callback(void* arg,
+                          int status,
+                          int timeouts,
+                          struct ares_addrinfo* result) {
+  auto cleanup = OnScopeLeave([&]() { ares_freeaddrinfo(result); });
+  std::unique_ptr<LookupWrap*> wrap_ptr{static_cast<LookupWrap**>(arg)};
+  LookupWrap* wrap = *wrap_ptr;
+  if (wrap == nullptr) return;
+  wrap->callback_ptr_ = nullptr;
+
+  if (status == ARES_SUCCESS) {
+    int ttl = std::numeric_limits<int>::max();
+    for (ares_addrinfo_node* p = result->nodes; p != nullptr; p = p->ai_next) {
+      const void* addr;
+      if (p->ai_family == AF_INET) {
+        addr = &reinterpret_cast<sockaddr_in*>(p->ai_addr)->sin_addr;
+      } else if (p->ai_family == AF_INET6) {
+        addr = &reinterpret_cast<sockaddr_in6*>(p->ai_addr)->sin6_addr;
+      } else {
+        continue;
+      }
+      char ip[INET6_ADDRSTRLEN];
+      if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip))) continue;
+      wrap->addresses_.emplace_back(ip);
+      ttl = std::min(ttl, p->ai_ttl);
+    }
+
+    // Answers from the hosts file or for numeric hosts have no TTL and are
+    // cheap to get again anyway.
+    uint32_t max_cache_ttl = wrap->channel_->max_cache_ttl();
+    if (max_cache_ttl > 0 && ttl > 0 && !wrap->addresses_.empty()) {
+      uint64_t now = uv_hrtime();
+      uint64_t lifetime = std::min(static_cast<uint32_t>(ttl), max_cache_ttl);
+      AddressCache::GetInstance()->Store(wrap->hostname_,
+                                         wrap->family_,
+                                         wrap->addresses_,
+                                         now,
+                                         now + lifetime * 1000000000);
+    }
+  }
+
+  wrap->channel_->set_query_last_ok(status != ARES_ECONNREFUSED);
+  wrap->QueueResponseCallback(status);
+}
+
+void LookupWrap::QueueResponseCallback(int status) {
+  BaseObjectPtr<LookupWrap> strong_ref{this};
+  env()->SetImmediate([this, strong_ref, status](Environment*) {
+    AfterResponse(status);
+
+    // Delete once strong_ref goes out of scope.
+    Detach();
+  });
+
+  channel_->ModifyActivityQueryCount(-1);
+}
+
+void LookupWrap::AfterResponse(int status) {
+  Isolate* isolate = env()->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env()->context());
+
+  if (status == ARES_SUCCESS && addresses_.empty()) status = ARES_ENODATA;
+  if (status != ARES_SUCCESS) {
+    TRACE_EVENT_NESTABLE_ASYNC_END1(TRACING_CATEGORY_NODE2(dns, native),
+                                    "lookup",
+                                    this,
+                                    "error",
+                                    status);
+    Local<Value> arg = OneByteString(isolate, ToErrorCodeString(status));
+    MakeCallback(env()->oncomplete_string(), 1, &arg);
+    return;
+  }
+
+  std::vector<Local<Value>> results;
+  results.reserve(addresses_.size());
+  auto add = [&](bool want_ipv4, bool want_ipv6) {
+    for (const std::string& address : addresses_) {
+      bool is_ipv6 = address.find(':') != std::string::npos;
+      if (is_ipv6 ? want_ipv6 : want_ipv4)
+        results.push_back(
+            OneByteString(isolate, address.data(), address.size()));
+    }
+  };
+  switch (order_) {
+    case DNS_ORDER_IPV4_FIRST:
+      add(true, false);
+      add(false, true);
+      break;
+    case DNS_ORDER_IPV6_FIRST:
+      add(false, true);
+      add(true, false);
+      break;
+    default:
+      add(true, true);
+      break;
+  }
+
+  TRACE_EVENT_NESTABLE_ASYNC_END2(TRACING_CATEGORY_NODE2(dns, native),
+                                  "lookup",
+                                  this,
+                                  "count",
+                                  results.size(),
+                                  "order",
+                                  order_);
+
+  Local<Value> argv[] = {
+    Integer::New(isolate, 0),
+    Array::New(isolate, results.data(), results.size())
+  };
+  MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+}
+
 void ChannelWrap::ModifyActivityQueryCount(int count) {
   active_query_count_ += count;
   CHECK_GE(active_query_count_, 0);
@@ -1429,11 +1689,52 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(err);
 }
 
+void Lookup(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ChannelWrap* channel;
+  ASSIGN_OR_RETURN_UNWRAP(&channel, args.Holder());
 
-void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
-  auto cleanup = OnScopeLeave([&]() { uv_freeaddrinfo(res); });
-  BaseObjectPtr<GetAddrInfoReqWrap> req_wrap{
-      static_cast<GetAddrInfoReqWrap*>(req->data)};
+  CHECK(args[0]->IsObject());  // req
+  CHECK(args[1]->IsString());  // hostname
+  CHECK(args[2]->IsInt32());   // family
+  CHECK(args[3]->IsUint32());  // order
+
+  int family;
+  switch (args[2].As<Int32>()->Value()) {
+    case 0:
+      family = AF_UNSPEC;
+      break;
+    case 4:
+      family = AF_INET;
+      break;
+    case 6:
+      family = AF_INET6;
+      break;
+    default:
+      UNREACHABLE("bad address family");
+  }
+
+  node::Utf8Value hostname(env->isolate(), args[1]);
+  std::string ascii_hostname = ada::idna::to_ascii(hostname.ToStringView());
+  auto wrap = std::make_unique<LookupWrap>(
+      channel,
+      args[0].As<Object>(),
+      family,
+      static_cast<uint8_t>(args[3].As<Uint32>()->Value()));
+  wrap->Start(ascii_hostname);
+  // Release ownership of the pointer allowing the ownership to be transferred
+  USE(wrap.release());
+
+  args.GetReturnValue().Set(0);
+}
+
+void ClearLookupCache(const FunctionCallbackInfo<Value>& args) {
+  AddressCache::GetInstance()->Clear();
+}
+
+void CompleteGetAddrInfo(GetAddrInfoReqWrap* req_wrap,
+                         int status,
+                         const addrinfo* res) {
   Environment* env = req_wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -1504,7 +1805,7 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
 
   TRACE_EVENT_NESTABLE_ASYNC_END2(TRACING_CATEGORY_NODE2(dns, native),
                                   "lookup",
-                                  req_wrap.get(),
+                                  req_wrap,
                                   "count",
                                   n,
                                   "order",
@@ -1514,6 +1815,39 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
   req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
 }
 
+void TraceGetAddrInfoBegin(GetAddrInfoReqWrap* req_wrap,
+                           const std::string& hostname,
+                           int family) {
+  TRACE_EVENT_NESTABLE_ASYNC_BEGIN2(TRACING_CATEGORY_NODE2(dns, native),
+                                    "lookup",
+                                    req_wrap,
+                                    "hostname",
+                                    TRACE_STR_COPY(hostname.data()),
+                                    "family",
+                                    family == AF_INET    ? "ipv4"
+                                    : family == AF_INET6 ? "ipv6"
+                                                         : "unspec");
+}
+
+void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
+  auto cleanup = OnScopeLeave([&]() { uv_freeaddrinfo(res); });
+  BaseObjectPtr<GetAddrInfoReqWrap> req_wrap{
+      static_cast<GetAddrInfoReqWrap*>(req->data)};
+  Environment* env = req_wrap->env();
+
+  // Lookups that start from here on, even from the callbacks below, need a
+  // fresh answer.
+  env->pending_getaddrinfo()->erase(req_wrap->key());
+  std::vector<BaseObjectPtr<GetAddrInfoReqWrap>> waiters =
+      req_wrap->TakeWaiters();
+
+  CompleteGetAddrInfo(req_wrap.get(), status, res);
+  for (const BaseObjectPtr<GetAddrInfoReqWrap>& waiter : waiters) {
+    if (!env->can_call_into_js()) break;
+    CompleteGetAddrInfo(waiter.get(), status, res);
+  }
+}
+
 
 void AfterGetNameInfo(uv_getnameinfo_t* req,
                       int status,
@@ -1602,6 +1936,20 @@ void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
 
   auto req_wrap =
       std::make_unique<GetAddrInfoReqWrap>(env, req_wrap_obj, order->Value());
+  TraceGetAddrInfoBegin(req_wrap.get(), ascii_hostname, family);
+
+  // When a connection pool warms up, it looks up the same host many times at
+  // once. Those lookups wait for the one that is already in flight instead
+  // of each taking up a threadpool thread. The order only affects how the
+  // answer is turned into a list, so it is not part of the key.
+  std::string key = std::to_string(family) + ":" + std::to_string(flags) +
+                    ":" + ascii_hostname;
+  auto pending = env->pending_getaddrinfo()->find(key);
+  if (pending != env->pending_getaddrinfo()->end()) {
+    pending->second->AddWaiter(
+        BaseObjectPtr<GetAddrInfoReqWrap>(req_wrap.release()));
+    return args.GetReturnValue().Set(0);
+  }
 
   struct addrinfo hints;
   memset(&hints, 0, sizeof(hints));
@@ -1609,21 +1957,14 @@ void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
   hints.ai_socktype = SOCK_STREAM;
   hints.ai_flags = flags;
 
-  TRACE_EVENT_NESTABLE_ASYNC_BEGIN2(TRACING_CATEGORY_NODE2(dns, native),
-                                    "lookup",
-                                    req_wrap.get(),
-                                    "hostname",
-                                    TRACE_STR_COPY(ascii_hostname.data()),
-                                    "family",
-                                    family == AF_INET    ? "ipv4"
-                                    : family == AF_INET6 ? "ipv6"
-                                                         : "unspec");
-
   int err = req_wrap->Dispatch(
       uv_getaddrinfo, AfterGetAddrInfo, ascii_hostname.data(), nullptr, &hints);
-  if (err == 0)
+  if (err == 0) {
+    req_wrap->set_key(key);
+    env->pending_getaddrinfo()->emplace(std::move(key), req_wrap.get());
     // Release ownership of the pointer allowing the ownership to be transferred
     USE(req_wrap.release());
+  }
 
   args.GetReturnValue().Set(err);
 }
@@ -1903,6 +2244,7 @@ void Initialize(Local<Object> target,
   SetMethodNoSideEffect(context, target, "canonicalizeIP", CanonicalizeIP);
 
   SetMethod(context, target, "strerror", StrError);
+  SetMethod(context, target, "clearLookupCache", ClearLookupCache);
 
   target->Set(env->context(), FIXED_ONE_BYTE_STRING(env->isolate(), "AF_INET"),
               Integer::New(env->isolate(), AF_INET)).Check();
@@ -1981,6 +2323,7 @@ void Initialize(Local<Object> target,
   SetProtoMethod(isolate, channel_wrap, "querySoa", Query<QuerySoaWrap>);
   SetProtoMethod(
       isolate, channel_wrap, "getHostByAddr", Query<GetHostByAddrWrap>);
+  SetProtoMethod(isolate, channel_wrap, "lookup", Lookup);
 
   SetProtoMethodNoSideEffect(isolate, channel_wrap, "getServers", GetServers);
   SetProtoMethod(isolate, channel_wrap, "setServers", SetServers);
@@ -1995,6 +2338,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetNameInfo);
   registry->Register(CanonicalizeIP);
   registry->Register(StrError);
+  registry->Register(ClearLookupCache);
   registry->Register(ChannelWrap::New);
 
   registry->Register(Query<QueryAnyWrap>);
@@ -2010,6 +2354,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Query<QueryNaptrWrap>);
   registry->Register(Query<QuerySoaWrap>);
   registry->Register(Query<GetHostByAddrWrap>);
+  registry->Register(Lookup);
 
   registry->Register(GetServers);
   registry->Register(SetServers);
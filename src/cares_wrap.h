@@ -11,13 +11,17 @@
 #include "memory_tracker.h"
 #include "node.h"
 #include "node_internals.h"
+#include "node_mutex.h"
 #include "util.h"
 
 #include "ares.h"
 #include "v8.h"
 #include "uv.h"
 
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #ifdef __POSIX__
 # include <netdb.h>
@@ -155,7 +159,8 @@ class ChannelWrap final : public AsyncWrap {
       Environment* env,
       v8::Local<v8::Object> object,
       int timeout,
-      int tries);
+      int tries,
+      uint32_t max_cache_ttl);
   ~ChannelWrap() override;
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -174,6 +179,9 @@ class ChannelWrap final : public AsyncWrap {
     is_servers_default_ = is_default;
   }
   inline int active_query_count() { return active_query_count_; }
+  // In seconds. 0 if neither c-ares nor the AddressCache may cache answers
+  // for this channel.
+  inline uint32_t max_cache_ttl() const { return max_cache_ttl_; }
   inline NodeAresTask::List* task_list() { return &task_list_; }
 
   void MemoryInfo(MemoryTracker* tracker) const override;
@@ -190,6 +198,7 @@ class ChannelWrap final : public AsyncWrap {
   bool library_inited_ = false;
   int timeout_;
   int tries_;
+  uint32_t max_cache_ttl_;
   int active_query_count_ = 0;
   NodeAresTask::List task_list_;
 };
@@ -199,6 +208,7 @@ class GetAddrInfoReqWrap final : public ReqWrap<uv_getaddrinfo_t> {
   GetAddrInfoReqWrap(Environment* env,
                      v8::Local<v8::Object> req_wrap_obj,
                      uint8_t order);
+  ~GetAddrInfoReqWrap() override;
 
   SET_NO_MEMORY_INFO()
   SET_MEMORY_INFO_NAME(GetAddrInfoReqWrap)
@@ -206,8 +216,19 @@ class GetAddrInfoReqWrap final : public ReqWrap<uv_getaddrinfo_t> {
 
   uint8_t order() const { return order_; }
 
+  // The key of the request in Environment::pending_getaddrinfo(), if other
+  // lookups can wait for it.
+  const std::string& key() const { return key_; }
+  void set_key(std::string key) { key_ = std::move(key); }
+
+  // Lookups of the same host that complete together with this one.
+  void AddWaiter(BaseObjectPtr<GetAddrInfoReqWrap> waiter);
+  std::vector<BaseObjectPtr<GetAddrInfoReqWrap>> TakeWaiters();
+
  private:
   const uint8_t order_;
+  std::string key_;
+  std::vector<BaseObjectPtr<GetAddrInfoReqWrap>> waiters_;
 };
 
 class GetNameInfoReqWrap final : public ReqWrap<uv_getnameinfo_t> {
@@ -219,6 +240,76 @@ class GetNameInfoReqWrap final : public ReqWrap<uv_getnameinfo_t> {
   SET_SELF_SIZE(GetNameInfoReqWrap)
 };
 
+// The addresses that LookupWrap resolved, shared by all channels in the
+// process that have a cache TTL, so that every Environment benefits from the
+// lookups of the others. An entry expires with the shortest TTL among the
+// records it was built from, capped by the TTL of the channel that stored it.
+class AddressCache final {
+ public:
+  static constexpr size_t kMaxEntries = 1024;
+
+  static AddressCache* GetInstance();
+
+  // `now` and `expires_at` are uv_hrtime() values. `family` is AF_INET,
+  // AF_INET6 or AF_UNSPEC.
+  bool Lookup(const std::string& hostname,
+              int family,
+              uint64_t now,
+              std::vector<std::string>* addresses);
+  void Store(const std::string& hostname,
+             int family,
+             const std::vector<std::string>& addresses,
+             uint64_t now,
+             uint64_t expires_at);
+  void Clear();
+
+  size_t size();
+
+ private:
+  struct Entry {
+    std::vector<std::string> addresses;
+    uint64_t expires_at;
+  };
+
+  static std::string MakeKey(const std::string& hostname, int family);
+
+  Mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+// dns.lookup() through c-ares and the AddressCache, instead of a blocking
+// getaddrinfo() call on the threadpool.
+class LookupWrap final : public AsyncWrap {
+ public:
+  LookupWrap(ChannelWrap* channel,
+             v8::Local<v8::Object> req_wrap_obj,
+             int family,
+             uint8_t order);
+  ~LookupWrap() override;
+
+  void Start(const std::string& hostname);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(LookupWrap)
+  SET_SELF_SIZE(LookupWrap)
+
+ private:
+  static void Callback(void* arg,
+                       int status,
+                       int timeouts,
+                       struct ares_addrinfo* result);
+  void QueueResponseCallback(int status);
+  void AfterResponse(int status);
+
+  BaseObjectPtr<ChannelWrap> channel_;
+  const int family_;
+  const uint8_t order_;
+  std::string hostname_;
+  std::vector<std::string> addresses_;
+  // Same as QueryWrap::callback_ptr_.
+  LookupWrap** callback_ptr_ = nullptr;
+};
+
 struct ResponseData final {
   int status;
   bool is_host;
@@ -6,7 +6,7 @@
 #include "base_object.h"
 #include "cleanup_queue.h"
 #include "memory_tracker-inl.h"
-#include "util.h"
+#include "util-inl.h"
 
 namespace node {
 
@@ -17,40 +17,50 @@ inline void CleanupQueue::MemoryInfo(MemoryTracker* tracker) const {
 }
 
 inline size_t CleanupQueue::SelfSize() const {
-  return sizeof(CleanupQueue) +
-         cleanup_hooks_.size() * sizeof(CleanupHookCallback);
+  // Embedded hooks are accounted for by the objects that contain them.
+  return sizeof(CleanupQueue) + owned_hooks_.size() * sizeof(CleanupHook);
 }
 
 bool CleanupQueue::empty() const {
-  return cleanup_hooks_.empty();
+  return hooks_.IsEmpty();
 }
 
 void CleanupQueue::Add(Callback cb, void* arg) {
-  auto insertion_info =
-      cleanup_hooks_.emplace(cb, arg, cleanup_hook_counter_++);
+  auto insertion_info = owned_hooks_.try_emplace(Key{cb, arg}, cb, arg);
   // Make sure there was no existing element with these values.
   CHECK_EQ(insertion_info.second, true);
+  CleanupHook* hook = &insertion_info.first->second;
+  hook->owned_ = true;
+  hooks_.PushFront(hook);
 }
 
 void CleanupQueue::Remove(Callback cb, void* arg) {
-  CleanupHookCallback search{cb, arg, 0};
-  cleanup_hooks_.erase(search);
+  // Destroying the hook unlinks it.
+  owned_hooks_.erase(Key{cb, arg});
+}
+
+void CleanupQueue::Add(CleanupHook* hook) {
+  // Make sure the hook is not in a queue already.
+  CHECK(hook->list_node_.IsEmpty());
+  hooks_.PushFront(hook);
+}
+
+void CleanupQueue::Remove(CleanupHook* hook) {
+  DCHECK(!hook->owned_);
+  hook->list_node_.Remove();
 }
 
 template <typename T>
 void CleanupQueue::ForEachBaseObject(T&& iterator) const {
-  std::vector<CleanupHookCallback> callbacks = GetOrdered();
-
-  for (const auto& hook : callbacks) {
+  for (const CleanupHook* hook : hooks_) {
     BaseObject* obj = GetBaseObject(hook);
     if (obj != nullptr) iterator(obj);
   }
 }
 
-BaseObject* CleanupQueue::GetBaseObject(
-    const CleanupHookCallback& callback) const {
-  if (callback.fn_ == BaseObject::DeleteMe)
-    return static_cast<BaseObject*>(callback.arg_);
+BaseObject* CleanupQueue::GetBaseObject(const CleanupHook* hook) const {
+  if (hook->fn_ == BaseObject::DeleteMe)
+    return static_cast<BaseObject*>(hook->arg_);
   else
     return nullptr;
 }
@@ -1,52 +1,33 @@
 #include "cleanup_queue.h"  // NOLINT(build/include_inline)
-#include <algorithm>
-#include <vector>
 #include "cleanup_queue-inl.h"
 
 namespace node {
 
-std::vector<CleanupQueue::CleanupHookCallback> CleanupQueue::GetOrdered()
-    const {
-  // Copy into a vector, since we can't sort an unordered_set in-place.
-  std::vector<CleanupHookCallback> callbacks(cleanup_hooks_.begin(),
-                                             cleanup_hooks_.end());
-  // We can't erase the copied elements from `cleanup_hooks_` yet, because we
-  // need to be able to check whether they were un-scheduled by another hook.
+CleanupQueue::CleanupHook::CleanupHook(Callback fn, void* arg)
+    : fn_(fn), arg_(arg) {}
 
-  std::sort(callbacks.begin(),
-            callbacks.end(),
-            [](const CleanupHookCallback& a, const CleanupHookCallback& b) {
-              // Sort in descending order so that the most recently inserted
-              // callbacks are run first.
-              return a.insertion_order_counter_ > b.insertion_order_counter_;
-            });
-
-  return callbacks;
-}
+CleanupQueue::CleanupHook::~CleanupHook() = default;
 
 void CleanupQueue::Drain() {
-  std::vector<CleanupHookCallback> callbacks = GetOrdered();
-
-  for (const CleanupHookCallback& cb : callbacks) {
-    if (cleanup_hooks_.count(cb) == 0) {
-      // This hook was removed from the `cleanup_hooks_` set during another
-      // hook that was run earlier. Nothing to do here.
-      continue;
-    }
-
-    cb.fn_(cb.arg_);
-    cleanup_hooks_.erase(cb);
+  // Take the hooks that are currently in the queue. Hooks that are added by
+  // the callbacks are run by the next call instead, as they were before.
+  HookList pending;
+  while (CleanupHook* hook = hooks_.PopFront()) pending.PushBack(hook);
+
+  // Hooks that are removed by a callback that runs earlier are unlinked from
+  // `pending`, so that they are skipped.
+  while (CleanupHook* hook = pending.PopFront()) {
+    Callback fn = hook->fn_;
+    void* arg = hook->arg_;
+    // The hook is gone before the callback runs, which may free it along
+    // with the object that embeds it, or add it again.
+    if (hook->owned_) owned_hooks_.erase(Key{fn, arg});
+    fn(arg);
   }
 }
 
-size_t CleanupQueue::CleanupHookCallback::Hash::operator()(
-    const CleanupHookCallback& cb) const {
-  return std::hash<void*>()(cb.arg_);
-}
-
-bool CleanupQueue::CleanupHookCallback::Equal::operator()(
-    const CleanupHookCallback& a, const CleanupHookCallback& b) const {
-  return a.fn_ == b.fn_ && a.arg_ == b.arg_;
+size_t CleanupQueue::KeyHash::operator()(const Key& key) const {
+  return std::hash<void*>()(key.arg);
 }
 
 }  // namespace node
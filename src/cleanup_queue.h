@@ -5,10 +5,10 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <unordered_set>
-#include <vector>
+#include <unordered_map>
 
 #include "memory_tracker.h"
+#include "util.h"
 
 namespace node {
 
@@ -18,6 +18,31 @@ class CleanupQueue : public MemoryRetainer {
  public:
   typedef void (*Callback)(void*);
 
+  // An entry of the queue. Hooks are kept in an intrusive list in insertion
+  // order, so that adding and removing one takes constant time and the
+  // queue can be drained in reverse order without sorting it first.
+  // Objects that are registered for their whole lifetime, like BaseObjects,
+  // embed their hook and pass it to Add(CleanupHook*), which also avoids a
+  // separate allocation and a hash table lookup for each of them.
+  class CleanupHook {
+   public:
+    // Out of line, so that users of this header do not need util-inl.h for
+    // the ListNode.
+    CleanupHook(Callback fn, void* arg);
+    ~CleanupHook();
+
+    CleanupHook(const CleanupHook&) = delete;
+    CleanupHook& operator=(const CleanupHook&) = delete;
+
+   private:
+    friend class CleanupQueue;
+    ListNode<CleanupHook> list_node_;
+    Callback fn_;
+    void* arg_;
+    // Whether the hook is stored in `owned_hooks_`.
+    bool owned_ = false;
+  };
+
   CleanupQueue() = default;
 
   // Not copyable.
@@ -31,51 +56,40 @@ class CleanupQueue : public MemoryRetainer {
 
   inline void Add(Callback cb, void* arg);
   inline void Remove(Callback cb, void* arg);
+  // The hook is owned by the caller and must stay alive until it is
+  // removed or has been run. Removing a hook that is not in the queue is a
+  // no-op.
+  inline void Add(CleanupHook* hook);
+  inline void Remove(CleanupHook* hook);
   void Drain();
 
   template <typename T>
   inline void ForEachBaseObject(T&& iterator) const;
 
  private:
-  class CleanupHookCallback {
-   public:
-    CleanupHookCallback(Callback fn,
-                        void* arg,
-                        uint64_t insertion_order_counter)
-        : fn_(fn),
-          arg_(arg),
-          insertion_order_counter_(insertion_order_counter) {}
-
-    // Only hashes `arg_`, since that is usually enough to identify the hook.
-    struct Hash {
-      size_t operator()(const CleanupHookCallback& cb) const;
-    };
-
-    // Compares by `fn_` and `arg_` being equal.
-    struct Equal {
-      bool operator()(const CleanupHookCallback& a,
-                      const CleanupHookCallback& b) const;
-    };
+  typedef ListHead<CleanupHook, &CleanupHook::list_node_> HookList;
 
-   private:
-    friend class CleanupQueue;
-    Callback fn_;
-    void* arg_;
+  struct Key {
+    Callback fn;
+    void* arg;
+
+    bool operator==(const Key& other) const {
+      return fn == other.fn && arg == other.arg;
+    }
+  };
 
-    // We keep track of the insertion order for these objects, so that we can
-    // call the callbacks in reverse order when we are cleaning up.
-    uint64_t insertion_order_counter_;
+  // Only hashes `arg`, since that is usually enough to identify the hook.
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
   };
 
-  std::vector<CleanupHookCallback> GetOrdered() const;
-  inline BaseObject* GetBaseObject(const CleanupHookCallback& callback) const;
+  inline BaseObject* GetBaseObject(const CleanupHook* hook) const;
 
-  // Use an unordered_set, so that we have efficient insertion and removal.
-  std::unordered_set<CleanupHookCallback,
-                     CleanupHookCallback::Hash,
-                     CleanupHookCallback::Equal>
-      cleanup_hooks_;
-  uint64_t cleanup_hook_counter_ = 0;
+  // Most recently added hooks first.
+  HookList hooks_;
+  // The storage of the hooks that were added with Add(cb, arg). Elements of
+  // an unordered_map keep their address when it rehashes.
+  std::unordered_map<Key, CleanupHook, KeyHash> owned_hooks_;
 };
 
 }  // namespace node
@@ -3,10 +3,18 @@
 #include "env-inl.h"
 #include "node_file.h"
 #include "node_internals.h"
+#include "node_mutex.h"
 #include "node_version.h"
 #include "path.h"
 #include "zlib.h"
 
+#include <climits>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 namespace node {
 std::string Uint32ToHex(uint32_t crc) {
   std::string str;
@@ -27,6 +35,24 @@ uint32_t GetHash(const char* data, size_t size) {
   return crc32(crc, reinterpret_cast<const Bytef*>(data), size);
 }
 
+uint32_t UpdateHash(uint32_t hash, const char* data, size_t size) {
+  return crc32(hash, reinterpret_cast<const Bytef*>(data), size);
+}
+
+const char* CachedCodeTypeName(CachedCodeType type) {
+  switch (type) {
+    case CachedCodeType::kCommonJS:
+      return "CommonJS";
+    case CachedCodeType::kESM:
+      return "ESM";
+    case CachedCodeType::kWasm:
+      return "WebAssembly";
+    case CachedCodeType::kScript:
+      return "script";
+  }
+  UNREACHABLE();
+}
+
 uint32_t GetCacheVersionTag() {
   std::string_view node_version(NODE_VERSION);
   uint32_t v8_tag = v8::ScriptCompiler::CachedDataVersionTag();
@@ -57,22 +83,37 @@ inline void CompileCacheHandler::Debug(const char* format,
 v8::ScriptCompiler::CachedData* CompileCacheEntry::CopyCache() const {
   DCHECK_NOT_NULL(cache);
   int cache_size = cache->length;
+  if (cache->buffer_policy == v8::ScriptCompiler::CachedData::BufferNotOwned) {
+    // Points into the cache pack, which stays mapped until the handler goes
+    // away, long after V8 is done consuming it.
+    return new v8::ScriptCompiler::CachedData(
+        cache->data,
+        cache_size,
+        v8::ScriptCompiler::CachedData::BufferNotOwned);
+  }
   uint8_t* data = new uint8_t[cache_size];
   memcpy(data, cache->data, cache_size);
   return new v8::ScriptCompiler::CachedData(
       data, cache_size, v8::ScriptCompiler::CachedData::BufferOwned);
 }
 
-void CompileCacheHandler::ReadCacheFile(CompileCacheEntry* entry) {
-  Debug("[compile cache] reading cache from %s for %s %s...",
-        entry->cache_filename,
-        entry->type == CachedCodeType::kCommonJS ? "CommonJS" : "ESM",
-        entry->source_filename);
+void CompileCacheHandler::OpenPack() {
+  pack_filename_ = compile_cache_dir_ + kPathSeparator + "pack";
+  Debug("[compile cache] opening cache pack %s...", pack_filename_);
 
+#ifdef _WIN32
+  int err = ReadFileSync(&pack_contents_, pack_filename_.c_str());
+  if (err < 0) {
+    Debug(" %s\n", uv_strerror(err));
+    return;
+  }
+  pack_data_ = reinterpret_cast<const uint8_t*>(pack_contents_.data());
+  pack_size_ = pack_contents_.size();
+#else
   uv_fs_t req;
   auto defer_req_cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
-  const char* path = entry->cache_filename.c_str();
-  uv_file file = uv_fs_open(nullptr, &req, path, O_RDONLY, 0, nullptr);
+  uv_file file =
+      uv_fs_open(nullptr, &req, pack_filename_.c_str(), O_RDONLY, 0, nullptr);
   if (req.result < 0) {
     // req will be cleaned up by scope leave.
     Debug(" %s\n", uv_strerror(req.result));
@@ -80,26 +121,95 @@ void CompileCacheHandler::ReadCacheFile(CompileCacheEntry* entry) {
   }
   uv_fs_req_cleanup(&req);
 
+  // The mapping stays valid after the file is closed.
   auto defer_close = OnScopeLeave([file]() {
     uv_fs_t close_req;
     CHECK_EQ(0, uv_fs_close(nullptr, &close_req, file, nullptr));
     uv_fs_req_cleanup(&close_req);
   });
 
-  // Read the headers.
-  std::vector<uint32_t> headers(kHeaderCount);
-  uv_buf_t headers_buf = uv_buf_init(reinterpret_cast<char*>(headers.data()),
-                                     kHeaderCount * sizeof(uint32_t));
-  const int r = uv_fs_read(nullptr, &req, file, &headers_buf, 1, 0, nullptr);
-  if (r != static_cast<int>(headers_buf.len)) {
-    Debug("reading header failed, bytes read %d", r);
-    if (req.result < 0 && is_debug_) {
-      Debug(", %s", uv_strerror(req.result));
-    }
-    Debug("\n");
+  if (uv_fs_fstat(nullptr, &req, file, nullptr) < 0) {
+    Debug(" %s\n", uv_strerror(req.result));
+    return;
+  }
+  size_t size = req.statbuf.st_size;
+  if (size < kPackHeaderSize) {
+    Debug(" empty\n");
+    pack_needs_rewrite_ = size > 0;
+    return;
+  }
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  if (mapping == MAP_FAILED) {
+    Debug(" mmap failed, %s\n", uv_strerror(uv_translate_sys_error(errno)));
+    return;
+  }
+  pack_data_ = static_cast<const uint8_t*>(mapping);
+  pack_size_ = size;
+#endif
+
+  uint32_t header[2];
+  if (pack_size_ < kPackHeaderSize) {
+    Debug(" empty\n");
+    pack_needs_rewrite_ = pack_size_ > 0;
+    return;
+  }
+  memcpy(header, pack_data_, sizeof(header));
+  if (header[0] != kPackMagic || header[1] != compiler_cache_key_) {
+    Debug(" invalid header\n");
+    pack_needs_rewrite_ = true;
     return;
   }
 
+  // Only the record headers are touched here, the content is paged in when
+  // (and if) the module is actually loaded. A truncated or garbled record,
+  // e.g. from a process that crashed while appending, ends the pack.
+  size_t offset = kPackHeaderSize;
+  while (pack_size_ - offset >= kPackRecordHeaderSize) {
+    uint32_t fields[kHeaderCount + 2];
+    memcpy(fields, pack_data_ + offset, sizeof(fields));
+    if (fields[0] != kPackRecordMagic) {
+      break;
+    }
+    PackRecord record;
+    memcpy(record.headers, fields + 2, sizeof(record.headers));
+    record.record_size =
+        RoundUp(kPackRecordHeaderSize + record.headers[kCacheSizeOffset],
+                kPackAlignment);
+    if (pack_size_ - offset < record.record_size) {
+      break;
+    }
+    record.data = pack_data_ + offset + kPackRecordHeaderSize;
+
+    auto existing = pack_index_.find(fields[1]);
+    if (existing != pack_index_.end()) {
+      pack_dead_bytes_ += existing->second.record_size;
+      existing->second = record;
+    } else {
+      pack_index_.emplace(fields[1], record);
+    }
+    offset += record.record_size;
+  }
+  pack_needs_rewrite_ = offset != pack_size_;
+
+  Debug(" %d records, %d bytes superseded%s\n",
+        pack_index_.size(),
+        pack_dead_bytes_,
+        pack_needs_rewrite_ ? ", broken tail" : "");
+}
+
+bool CompileCacheHandler::ReadFromPack(CompileCacheEntry* entry) {
+  Debug("[compile cache] reading cache from pack for %s %s...",
+        CachedCodeTypeName(entry->type),
+        entry->source_filename);
+
+  auto it = pack_index_.find(entry->cache_key);
+  if (it == pack_index_.end()) {
+    Debug(" no cache found\n");
+    return false;
+  }
+  const PackRecord& record = it->second;
+  const uint32_t* headers = record.headers;
+
   Debug("[%d %d %d %d]...",
         headers[kCodeSizeOffset],
         headers[kCacheSizeOffset],
@@ -111,69 +221,32 @@ void CompileCacheHandler::ReadCacheFile(CompileCacheEntry* entry) {
     Debug("code size mismatch: expected %d, actual %d\n",
           entry->code_size,
           headers[kCodeSizeOffset]);
-    return;
+    return false;
   }
   if (headers[kCodeHashOffset] != entry->code_hash) {
     Debug("code hash mismatch: expected %d, actual %d\n",
           entry->code_hash,
           headers[kCodeHashOffset]);
-    return;
-  }
-
-  // Read the cache, grow the buffer exponentially whenever it fills up.
-  size_t offset = headers_buf.len;
-  size_t capacity = 4096;  // Initial buffer capacity
-  size_t total_read = 0;
-  uint8_t* buffer = new uint8_t[capacity];
-
-  while (true) {
-    // If there is not enough space to read more data, do a simple
-    // realloc here (we don't actually realloc because V8 requires
-    // the underlying buffer to be delete[]-able).
-    if (total_read == capacity) {
-      size_t new_capacity = capacity * 2;
-      auto* new_buffer = new uint8_t[new_capacity];
-      memcpy(new_buffer, buffer, capacity);
-      delete[] buffer;
-      buffer = new_buffer;
-      capacity = new_capacity;
-    }
-
-    uv_buf_t iov = uv_buf_init(reinterpret_cast<char*>(buffer + total_read),
-                               capacity - total_read);
-    int bytes_read =
-        uv_fs_read(nullptr, &req, file, &iov, 1, offset + total_read, nullptr);
-    if (req.result < 0) {  // Error.
-      // req will be cleaned up by scope leave.
-      delete[] buffer;
-      Debug(" %s\n", uv_strerror(req.result));
-      return;
-    }
-    uv_fs_req_cleanup(&req);
-    if (bytes_read <= 0) {
-      break;
-    }
-    total_read += bytes_read;
+    return false;
   }
 
-  // Check the cache size and hash.
-  if (headers[kCacheSizeOffset] != total_read) {
-    Debug("cache size mismatch: expected %d, actual %d\n",
-          headers[kCacheSizeOffset],
-          total_read);
-    return;
-  }
-  uint32_t cache_hash = GetHash(reinterpret_cast<char*>(buffer), total_read);
+  uint32_t cache_size = headers[kCacheSizeOffset];
+  uint32_t cache_hash =
+      GetHash(reinterpret_cast<const char*>(record.data), cache_size);
   if (headers[kCacheHashOffset] != cache_hash) {
     Debug("cache hash mismatch: expected %d, actual %d\n",
           headers[kCacheHashOffset],
           cache_hash);
-    return;
+    return false;
   }
 
+  // The pack outlives the entries, so the cache can point straight into it.
   entry->cache.reset(new v8::ScriptCompiler::CachedData(
-      buffer, total_read, v8::ScriptCompiler::CachedData::BufferOwned));
-  Debug(" success, size=%d\n", total_read);
+      record.data,
+      cache_size,
+      v8::ScriptCompiler::CachedData::BufferNotOwned));
+  Debug(" success, size=%d\n", cache_size);
+  return true;
 }
 
 CompileCacheEntry* CompileCacheHandler::GetOrInsert(
@@ -205,15 +278,11 @@ CompileCacheEntry* CompileCacheHandler::GetOrInsert(
   result->code_hash = code_hash;
   result->code_size = code_utf8.length();
   result->cache_key = key;
-  result->cache_filename =
-      compile_cache_dir_ + kPathSeparator + Uint32ToHex(result->cache_key);
   result->source_filename = filename_utf8.ToString();
   result->cache = nullptr;
   result->type = type;
 
-  // TODO(joyeecheung): if we fail enough times, stop trying for any future
-  // files.
-  ReadCacheFile(result);
+  ReadFromPack(result);
 
   return result;
 }
@@ -227,6 +296,11 @@ v8::ScriptCompiler::CachedData* SerializeCodeCache(v8::Local<v8::Module> mod) {
   return v8::ScriptCompiler::CreateCodeCache(mod->GetUnboundModuleScript());
 }
 
+v8::ScriptCompiler::CachedData* SerializeCodeCache(
+    v8::Local<v8::UnboundScript> script) {
+  return v8::ScriptCompiler::CreateCodeCache(script);
+}
+
 template <typename T>
 void CompileCacheHandler::MaybeSaveImpl(CompileCacheEntry* entry,
                                         v8::Local<T> func_or_mod,
@@ -248,6 +322,7 @@ void CompileCacheHandler::MaybeSaveImpl(CompileCacheEntry* entry,
   DCHECK_EQ(data->buffer_policy, v8::ScriptCompiler::CachedData::BufferOwned);
   entry->refreshed = true;
   entry->cache.reset(data);
+  MaybeScheduleFlush();
 }
 
 void CompileCacheHandler::MaybeSave(CompileCacheEntry* entry,
@@ -263,12 +338,240 @@ void CompileCacheHandler::MaybeSave(CompileCacheEntry* entry,
   MaybeSaveImpl(entry, func, rejected);
 }
 
-// Layout of a cache file:
+void CompileCacheHandler::MaybeSave(CompileCacheEntry* entry,
+                                    v8::Local<v8::UnboundScript> script,
+                                    bool rejected) {
+  MaybeSaveImpl(entry, script, rejected);
+}
+
+// Shared between the handler and the serializers V8 holds on to.
+struct CompileCacheHandler::WasmCacheSlot {
+  Mutex mutex;
+  std::unique_ptr<v8::ScriptCompiler::CachedData> cache;
+  uint32_t code_hash = 0;
+  uint32_t code_size = 0;
+};
+
+CompileCacheEntry* CompileCacheHandler::GetOrInsertWasm(std::string_view url) {
+  DCHECK(!compile_cache_dir_.empty());
+  uint32_t key = GetCacheKey(url, CachedCodeType::kWasm);
+  auto loaded = compiler_cache_store_.find(key);
+  if (loaded != compiler_cache_store_.end()) {
+    return loaded->second.get();
+  }
+
+  auto emplaced =
+      compiler_cache_store_.emplace(key, std::make_unique<CompileCacheEntry>());
+  auto* result = emplaced.first->second.get();
+  result->code_hash = 0;
+  result->code_size = 0;
+  result->cache_key = key;
+  result->source_filename = url;
+  result->type = CachedCodeType::kWasm;
+
+  // Take whatever module bytes the record was made for, see above.
+  auto it = pack_index_.find(key);
+  if (it != pack_index_.end()) {
+    result->code_hash = it->second.headers[kCodeHashOffset];
+    result->code_size = it->second.headers[kCodeSizeOffset];
+  }
+  ReadFromPack(result);
+  return result;
+}
+
+std::function<void(v8::CompiledWasmModule)>
+CompileCacheHandler::GetWasmSerializer(CompileCacheEntry* entry) {
+  DCHECK_EQ(entry->type, CachedCodeType::kWasm);
+  std::shared_ptr<WasmCacheSlot>& slot = wasm_slots_[entry->cache_key];
+  if (!slot) {
+    slot = std::make_shared<WasmCacheSlot>();
+  }
+  return [slot](v8::CompiledWasmModule module) {
+    v8::OwnedBuffer serialized = module.Serialize();
+    v8::MemorySpan<const uint8_t> wire_bytes = module.GetWireBytesRef();
+    if (serialized.size == 0 || serialized.size > INT_MAX ||
+        wire_bytes.size() > UINT32_MAX) {
+      return;
+    }
+    auto cache = std::make_unique<v8::ScriptCompiler::CachedData>(
+        serialized.buffer.release(),
+        static_cast<int>(serialized.size),
+        v8::ScriptCompiler::CachedData::BufferOwned);
+    uint32_t code_hash =
+        GetHash(reinterpret_cast<const char*>(wire_bytes.data()),
+                wire_bytes.size());
+    Mutex::ScopedLock lock(slot->mutex);
+    slot->cache = std::move(cache);
+    slot->code_hash = code_hash;
+    slot->code_size = static_cast<uint32_t>(wire_bytes.size());
+  };
+}
+
+void CompileCacheHandler::CollectWasmCaches() {
+  for (auto& [key, slot] : wasm_slots_) {
+    Mutex::ScopedLock lock(slot->mutex);
+    if (slot->cache == nullptr) continue;
+    CompileCacheEntry* entry = compiler_cache_store_[key].get();
+    DCHECK_NOT_NULL(entry);
+    Debug("[compile cache] collecting the cache of WebAssembly module %s\n",
+          entry->source_filename);
+    entry->cache = std::move(slot->cache);
+    entry->code_hash = slot->code_hash;
+    entry->code_size = slot->code_size;
+    entry->refreshed = true;
+  }
+}
+
+namespace {
+constexpr uint32_t kPackageJSONCacheMagic = 0x4e4a5043;  // "CPJN"
+constexpr const char* kPackageJSONCacheFilename = "package_json";
+}  // anonymous namespace
+
+const std::string* CompileCacheHandler::GetPackageJSON(const std::string& path,
+                                                       const uv_stat_t* stat) {
+  DCHECK(!compile_cache_dir_.empty());
+  if (!package_json_cache_loaded_) {
+    ReadPackageJSONCache();
+  }
+
+  auto it = package_json_cache_.find(path);
+  if (it == package_json_cache_.end()) {
+    return nullptr;
+  }
+  const PackageJSONCacheEntry& entry = it->second;
+  if (entry.file_size != stat->st_size ||
+      entry.mtime_sec != stat->st_mtim.tv_sec ||
+      entry.mtime_nsec != stat->st_mtim.tv_nsec) {
+    Debug("[compile cache] package.json cache for %s is stale\n", path);
+    return nullptr;
+  }
+  return &entry.record;
+}
+
+void CompileCacheHandler::SavePackageJSON(const std::string& path,
+                                          const uv_stat_t* stat,
+                                          std::string&& record) {
+  DCHECK(!compile_cache_dir_.empty());
+  package_json_cache_[path] = {stat->st_size,
+                               stat->st_mtim.tv_sec,
+                               stat->st_mtim.tv_nsec,
+                               std::move(record)};
+  package_json_cache_dirty_ = true;
+}
+
+size_t CompileCacheHandler::NativeMemorySize() const {
+  size_t size = pack_size_;
+  for (const auto& pair : compiler_cache_store_) {
+    const v8::ScriptCompiler::CachedData* cache = pair.second->cache.get();
+    if (cache != nullptr &&
+        cache->buffer_policy == v8::ScriptCompiler::CachedData::BufferOwned) {
+      size += cache->length;
+    }
+  }
+  for (const auto& pair : package_json_cache_) {
+    size += pair.first.size() + pair.second.record.size();
+  }
+  return size;
+}
+
+// Layout of the package.json cache file:
+// [uint32_t] magic
+// [uint32_t] payload hash
+// .... payload ....
+// where the payload is a sequence of entries of
+// [uint32_t] path length, path
+// [uint64_t] file size
+// [int64_t] mtime seconds
+// [int64_t] mtime nanoseconds
+// [uint32_t] record length, record
+void CompileCacheHandler::ReadPackageJSONCache() {
+  package_json_cache_loaded_ = true;
+  std::string filename =
+      compile_cache_dir_ + kPathSeparator + kPackageJSONCacheFilename;
+  Debug("[compile cache] reading package.json cache from %s...", filename);
+
+  std::string content;
+  int err = ReadFileSync(&content, filename.c_str());
+  if (err < 0) {
+    Debug(" %s\n", uv_strerror(err));
+    return;
+  }
+
+  CacheReader reader(content);
+  uint32_t magic;
+  uint32_t hash;
+  if (!reader.Read(&magic) || !reader.Read(&hash) ||
+      magic != kPackageJSONCacheMagic) {
+    Debug(" invalid header\n");
+    return;
+  }
+  constexpr size_t kPayloadOffset = 2 * sizeof(uint32_t);
+  if (GetHash(content.data() + kPayloadOffset,
+              content.size() - kPayloadOffset) != hash) {
+    Debug(" hash mismatch\n");
+    return;
+  }
+
+  while (!reader.done()) {
+    std::string path;
+    PackageJSONCacheEntry entry;
+    if (!reader.Read(&path) || !reader.Read(&entry.file_size) ||
+        !reader.Read(&entry.mtime_sec) || !reader.Read(&entry.mtime_nsec) ||
+        !reader.Read(&entry.record)) {
+      Debug(" truncated entry\n");
+      package_json_cache_.clear();
+      return;
+    }
+    package_json_cache_.emplace(std::move(path), std::move(entry));
+  }
+  Debug(" success, %d entries\n", package_json_cache_.size());
+}
+
+void CompileCacheHandler::PersistPackageJSONCache() {
+  if (!package_json_cache_dirty_) {
+    return;
+  }
+  std::string filename =
+      compile_cache_dir_ + kPathSeparator + kPackageJSONCacheFilename;
+
+  std::string payload;
+  for (const auto& [path, entry] : package_json_cache_) {
+    AppendString(&payload, path);
+    AppendValue(&payload, entry.file_size);
+    AppendValue(&payload, entry.mtime_sec);
+    AppendValue(&payload, entry.mtime_nsec);
+    AppendString(&payload, entry.record);
+  }
+  uint32_t headers[] = {kPackageJSONCacheMagic,
+                        GetHash(payload.data(), payload.size())};
+
+  Debug("[compile cache] writing package.json cache with %d entries to %s...",
+        package_json_cache_.size(),
+        filename);
+  uv_buf_t bufs[] = {
+      uv_buf_init(reinterpret_cast<char*>(headers), sizeof(headers)),
+      uv_buf_init(payload.data(), payload.size())};
+  int err = WriteFileSync(filename.c_str(), bufs, arraysize(bufs));
+  if (err < 0) {
+    Debug("failed: %s\n", uv_strerror(err));
+  } else {
+    package_json_cache_dirty_ = false;
+    Debug("success\n");
+  }
+}
+
+// Layout of the cache pack:
+// [uint32_t] kPackMagic
+// [uint32_t] compiler cache key
+// .... records ....
+// Layout of a record:
+// [uint32_t] kPackRecordMagic
+// [uint32_t] cache key
 // [uint32_t] code size
-// [uint32_t] code hash
 // [uint32_t] cache size
+// [uint32_t] code hash
 // [uint32_t] cache hash
-// .... compile cache content ....
+// .... compile cache content, padded to kPackAlignment ....
 void CompileCacheHandler::Persist() {
   DCHECK(!compile_cache_dir_.empty());
 
@@ -279,6 +582,144 @@ void CompileCacheHandler::Persist() {
   // Also in most use cases users should not change the files on disk
   // too rapidly. Therefore locking is not currently implemented to
   // avoid the cost.
+  WaitForBackgroundWrites();
+  PersistPack();
+  PersistPackageJSONCache();
+}
+
+// Shared between the handler and the background writers. The writers only
+// get to see snapshots of the records, never the entries or the mapping.
+struct CompileCacheHandler::PackWriteState {
+  Mutex mutex;
+  ConditionVariable cond;
+  size_t pending = 0;
+
+  // Appends `contents` to the pack, or replaces the pack with it if
+  // `replace` is true. Writers are serialized so that records from
+  // different flushes never interleave.
+  int Write(const std::string& filename,
+            const std::string& contents,
+            uint32_t compiler_cache_key,
+            bool replace) {
+    Mutex::ScopedLock lock(mutex);
+    const uint32_t pack_header[] = {kPackMagic, compiler_cache_key};
+    uv_buf_t bufs[] = {
+        uv_buf_init(reinterpret_cast<char*>(const_cast<uint32_t*>(pack_header)),
+                    kPackHeaderSize),
+        uv_buf_init(const_cast<char*>(contents.data()), contents.size())};
+
+    if (replace) {
+      // Write into a temporary file and rename it over the pack, so that
+      // the current mapping and concurrent readers keep seeing the old
+      // content.
+      std::string tmp_filename = filename + ".tmp";
+      int err = WriteFileSync(tmp_filename.c_str(), bufs, arraysize(bufs));
+      if (err < 0) return err;
+      uv_fs_t req;
+      err = uv_fs_rename(
+          nullptr, &req, tmp_filename.c_str(), filename.c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+      return err;
+    }
+
+    uv_fs_t req;
+    uv_file file = uv_fs_open(nullptr,
+                              &req,
+                              filename.c_str(),
+                              O_WRONLY | O_CREAT | O_APPEND,
+                              S_IWUSR | S_IRUSR,
+                              nullptr);
+    uv_fs_req_cleanup(&req);
+    if (file < 0) return file;
+    int err = uv_fs_fstat(nullptr, &req, file, nullptr);
+    bool needs_header = err == 0 && req.statbuf.st_size == 0;
+    uv_fs_req_cleanup(&req);
+    if (err == 0) {
+      err = uv_fs_write(nullptr,
+                        &req,
+                        file,
+                        needs_header ? bufs : bufs + 1,
+                        needs_header ? 2 : 1,
+                        -1,
+                        nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+    uv_fs_close(nullptr, &req, file, nullptr);
+    uv_fs_req_cleanup(&req);
+    return err < 0 ? err : 0;
+  }
+};
+
+namespace {
+class PackWriteTask : public v8::Task {
+ public:
+  PackWriteTask(std::shared_ptr<CompileCacheHandler::PackWriteState> state,
+                std::string filename,
+                std::string contents,
+                uint32_t compiler_cache_key,
+                bool is_debug)
+      : state_(std::move(state)),
+        filename_(std::move(filename)),
+        contents_(std::move(contents)),
+        compiler_cache_key_(compiler_cache_key),
+        is_debug_(is_debug) {}
+
+  void Run() override {
+    int err = state_->Write(filename_, contents_, compiler_cache_key_, false);
+    if (UNLIKELY(is_debug_ && err < 0)) {
+      FPrintF(stderr,
+              "[compile cache] background write to %s failed: %s\n",
+              filename_,
+              uv_strerror(err));
+    }
+    Mutex::ScopedLock lock(state_->mutex);
+    CHECK_GT(state_->pending, 0);
+    if (--state_->pending == 0) state_->cond.Broadcast(lock);
+  }
+
+ private:
+  std::shared_ptr<CompileCacheHandler::PackWriteState> state_;
+  std::string filename_;
+  std::string contents_;
+  uint32_t compiler_cache_key_;
+  bool is_debug_;
+};
+}  // anonymous namespace
+
+void CompileCacheHandler::AppendPackRecord(std::string* out,
+                                           uint32_t key,
+                                           const uint32_t* headers,
+                                           const uint8_t* data) {
+  uint32_t fields[kHeaderCount + 2];
+  fields[0] = kPackRecordMagic;
+  fields[1] = key;
+  memcpy(fields + 2, headers, kHeaderCount * sizeof(uint32_t));
+  size_t cache_size = headers[kCacheSizeOffset];
+  out->append(reinterpret_cast<const char*>(fields), kPackRecordHeaderSize);
+  out->append(reinterpret_cast<const char*>(data), cache_size);
+  out->resize(RoundUp(out->size(), kPackAlignment), '\0');
+}
+
+void CompileCacheHandler::AppendEntry(std::string* out,
+                                      CompileCacheEntry* entry) {
+  uint32_t headers[kHeaderCount];
+  const char* cache_ptr = reinterpret_cast<const char*>(entry->cache->data);
+  uint32_t cache_size = static_cast<uint32_t>(entry->cache->length);
+  headers[kCodeSizeOffset] = entry->code_size;
+  headers[kCacheSizeOffset] = cache_size;
+  headers[kCodeHashOffset] = entry->code_hash;
+  headers[kCacheHashOffset] = GetHash(cache_ptr, cache_size);
+  Debug("[compile cache] writing cache for %s [%d %d %d %d]\n",
+        entry->source_filename,
+        headers[kCodeSizeOffset],
+        headers[kCacheSizeOffset],
+        headers[kCodeHashOffset],
+        headers[kCacheHashOffset]);
+  AppendPackRecord(out, entry->cache_key, headers, entry->cache->data);
+}
+
+size_t CompileCacheHandler::SerializeRefreshedEntries(std::string* out) {
+  size_t count = 0;
   for (auto& pair : compiler_cache_store_) {
     auto* entry = pair.second.get();
     if (entry->cache == nullptr) {
@@ -291,56 +732,149 @@ void CompileCacheHandler::Persist() {
             entry->source_filename);
       continue;
     }
-
     DCHECK_EQ(entry->cache->buffer_policy,
               v8::ScriptCompiler::CachedData::BufferOwned);
-    char* cache_ptr =
-        reinterpret_cast<char*>(const_cast<uint8_t*>(entry->cache->data));
-    uint32_t cache_size = static_cast<uint32_t>(entry->cache->length);
-    uint32_t cache_hash = GetHash(cache_ptr, cache_size);
-
-    // Generating headers.
-    std::vector<uint32_t> headers(kHeaderCount);
-    headers[kCodeSizeOffset] = entry->code_size;
-    headers[kCacheSizeOffset] = cache_size;
-    headers[kCodeHashOffset] = entry->code_hash;
-    headers[kCacheHashOffset] = cache_hash;
-
-    Debug("[compile cache] writing cache for %s in %s [%d %d %d %d]...",
-          entry->source_filename,
-          entry->cache_filename,
-          headers[kCodeSizeOffset],
-          headers[kCacheSizeOffset],
-          headers[kCodeHashOffset],
-          headers[kCacheHashOffset]);
-
-    uv_buf_t headers_buf = uv_buf_init(reinterpret_cast<char*>(headers.data()),
-                                       headers.size() * sizeof(uint32_t));
-    uv_buf_t data_buf = uv_buf_init(cache_ptr, entry->cache->length);
-    uv_buf_t bufs[] = {headers_buf, data_buf};
-
-    int err = WriteFileSync(entry->cache_filename.c_str(), bufs, 2);
-    if (err < 0) {
-      Debug("failed: %s\n", uv_strerror(err));
-    } else {
-      Debug("success\n");
+    AppendEntry(out, entry);
+    entry->refreshed = false;
+    count++;
+    auto it = pack_index_.find(pair.first);
+    if (it != pack_index_.end()) {
+      pack_dead_bytes_ += it->second.record_size;
+    }
+  }
+  pack_appended_bytes_ += out->size();
+  return count;
+}
+
+void CompileCacheHandler::MaybeScheduleFlush() {
+  if (flush_scheduled_) {
+    return;
+  }
+  flush_scheduled_ = true;
+  // Wait for the current synchronous batch of module loading to finish, and
+  // hand whatever it has compiled to a platform worker thread.
+  env_->SetImmediate(
+      [](Environment* env) {
+        if (env->use_compile_cache()) {
+          env->compile_cache_handler()->FlushInBackground();
+        }
+      },
+      CallbackFlags::kUnrefed);
+}
+
+void CompileCacheHandler::FlushInBackground() {
+  flush_scheduled_ = false;
+  MultiIsolatePlatform* platform = env_->isolate_data()->platform();
+  if (platform == nullptr || pack_needs_rewrite_) {
+    return;
+  }
+  CollectWasmCaches();
+  std::string contents;
+  size_t count = SerializeRefreshedEntries(&contents);
+  if (count == 0) {
+    return;
+  }
+  Debug("[compile cache] appending %d records to %s in the background\n",
+        count,
+        pack_filename_);
+  {
+    Mutex::ScopedLock lock(write_state_->mutex);
+    write_state_->pending++;
+  }
+  platform->CallOnWorkerThread(
+      std::make_unique<PackWriteTask>(write_state_,
+                                      pack_filename_,
+                                      std::move(contents),
+                                      compiler_cache_key_,
+                                      is_debug_));
+}
+
+void CompileCacheHandler::WaitForBackgroundWrites() {
+  Mutex::ScopedLock lock(write_state_->mutex);
+  while (write_state_->pending > 0) {
+    write_state_->cond.Wait(lock);
+  }
+}
+
+void CompileCacheHandler::PersistPack() {
+  CollectWasmCaches();
+  // Once more than half of the pack would be made of superseded records,
+  // rewrite it with only the live ones instead of appending.
+  size_t superseded_bytes = pack_dead_bytes_;
+  for (const auto& pair : compiler_cache_store_) {
+    auto it = pack_index_.find(pair.first);
+    if (pair.second->refreshed && it != pack_index_.end()) {
+      superseded_bytes += it->second.record_size;
+    }
+  }
+  const bool compact = pack_needs_rewrite_ ||
+                       superseded_bytes * 2 > pack_size_ + pack_appended_bytes_;
+
+  std::string contents;
+  size_t count;
+  if (compact) {
+    Debug("[compile cache] compacting %s...\n", pack_filename_);
+    count = 0;
+    for (const auto& [key, record] : pack_index_) {
+      auto it = compiler_cache_store_.find(key);
+      if (it != compiler_cache_store_.end() && it->second->cache != nullptr) {
+        continue;
+      }
+      AppendPackRecord(&contents, key, record.headers, record.data);
+      count++;
+    }
+    for (auto& pair : compiler_cache_store_) {
+      if (pair.second->cache == nullptr) continue;
+      AppendEntry(&contents, pair.second.get());
+      pair.second->refreshed = false;
+      count++;
+    }
+  } else {
+    count = SerializeRefreshedEntries(&contents);
+    if (count == 0) {
+      return;
     }
   }
+
+  Debug("[compile cache] %s %d records to %s...",
+        compact ? "writing" : "appending",
+        count,
+        pack_filename_);
+  int err =
+      write_state_->Write(pack_filename_, contents, compiler_cache_key_, compact);
+  if (err < 0) {
+    Debug("failed: %s\n", uv_strerror(err));
+  } else {
+    Debug("success\n");
+    if (compact) pack_needs_rewrite_ = false;
+  }
 }
 
 CompileCacheHandler::CompileCacheHandler(Environment* env)
-    : isolate_(env->isolate()),
+    : env_(env),
+      isolate_(env->isolate()),
       is_debug_(
-          env->enabled_debug_list()->enabled(DebugCategory::COMPILE_CACHE)) {}
+          env->enabled_debug_list()->enabled(DebugCategory::COMPILE_CACHE)),
+      write_state_(std::make_shared<PackWriteState>()) {}
+
+CompileCacheHandler::~CompileCacheHandler() {
+  // Don't let the environment go away with flushes in flight.
+  WaitForBackgroundWrites();
+#ifndef _WIN32
+  if (pack_data_ != nullptr) {
+    CHECK_EQ(0, munmap(const_cast<uint8_t*>(pack_data_), pack_size_));
+  }
+#endif
+}
 
 // Directory structure:
 // - Compile cache directory (from NODE_COMPILE_CACHE)
 //   - <cache_version_tag_1>: hash of CachedDataVersionTag + NODE_VERESION
 //   - <cache_version_tag_2>
 //   - <cache_version_tag_3>
-//     - <cache_file_1>: a hash of filename + module type
-//     - <cache_file_2>
-//     - <cache_file_3>
+//     - pack: the caches of all the modules, see Persist()
+//     - package_json: parsed package.json files, see
+//       PersistPackageJSONCache()
 bool CompileCacheHandler::InitializeDirectory(Environment* env,
                                               const std::string& dir) {
   compiler_cache_key_ = GetCacheVersionTag();
@@ -381,6 +915,7 @@ bool CompileCacheHandler::InitializeDirectory(Environment* env,
   }
 
   compile_cache_dir_ = cache_dir;
+  OpenPack();
   return true;
 }
 
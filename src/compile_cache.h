@@ -4,18 +4,71 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include <cinttypes>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include "uv.h"
 #include "v8.h"
 
 namespace node {
 class Environment;
 
+uint32_t GetHash(const char* data, size_t size);
+// Continues a hash returned by GetHash() over more data, so that hashing
+// the chunks of a buffer one after another gives the hash of the whole.
+uint32_t UpdateHash(uint32_t hash, const char* data, size_t size);
+
+// Helpers for the binary formats of the files in the cache directory.
+template <typename T>
+inline void AppendValue(std::string* out, T value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void AppendString(std::string* out, std::string_view str) {
+  AppendValue(out, static_cast<uint32_t>(str.size()));
+  out->append(str);
+}
+
+// Reads values out of a buffer, failing (sticky) on out-of-bounds accesses.
+class CacheReader {
+ public:
+  explicit CacheReader(std::string_view data) : data_(data) {}
+
+  template <typename T>
+  bool Read(T* value) {
+    if (data_.size() - offset_ < sizeof(T)) return false;
+    memcpy(value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  bool Read(std::string* str) {
+    uint32_t size;
+    if (!Read(&size) || data_.size() - offset_ < size) return false;
+    str->assign(data_.data() + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool done() const { return offset_ == data_.size(); }
+
+ private:
+  std::string_view data_;
+  size_t offset_ = 0;
+};
+
 // TODO(joyeecheung): move it into a CacheHandler class.
 enum class CachedCodeType : uint8_t {
   kCommonJS = 0,
   kESM,
+  // A module compiled by WebAssembly.compileStreaming() and friends. The
+  // cache is the machine code V8 serialized after tiering up.
+  kWasm,
+  // A script compiled by vm.Script.
+  kScript,
 };
 
 struct CompileCacheEntry {
@@ -24,18 +77,30 @@ struct CompileCacheEntry {
   uint32_t code_hash;
   uint32_t code_size;
 
-  std::string cache_filename;
   std::string source_filename;
   CachedCodeType type;
   bool refreshed = false;
   // Copy the cache into a new store for V8 to consume. Caller takes
-  // ownership.
+  // ownership. If the cache points into the mapped cache pack, the returned
+  // store references the mapping instead of copying it.
   v8::ScriptCompiler::CachedData* CopyCache() const;
 };
 
+// A package.json parsed by the modules binding and serialized into an opaque
+// record. These are persisted next to the code cache so that a fresh process
+// can skip reading and parsing package.json files that have not changed,
+// which is checked using the size and the modification time of the file.
+struct PackageJSONCacheEntry {
+  uint64_t file_size;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  std::string record;
+};
+
 class CompileCacheHandler {
  public:
   explicit CompileCacheHandler(Environment* env);
+  ~CompileCacheHandler();
   bool InitializeDirectory(Environment* env, const std::string& dir);
 
   void Persist();
@@ -49,9 +114,55 @@ class CompileCacheHandler {
   void MaybeSave(CompileCacheEntry* entry,
                  v8::Local<v8::Module> mod,
                  bool rejected);
+  void MaybeSave(CompileCacheEntry* entry,
+                 v8::Local<v8::UnboundScript> script,
+                 bool rejected);
+
+  // Streamed WebAssembly modules are cached under the URL they came from, as
+  // V8 has to be given the cache before the bytes arrive. The code size and
+  // hash of the returned entry are those of the module bytes the cache was
+  // made for, and the caller has to check them against the bytes it gets
+  // before letting V8 use the cache.
+  CompileCacheEntry* GetOrInsertWasm(std::string_view url);
+  // Returns a callback for WasmStreaming::
+  // SetMoreFunctionsCanBeSerializedCallback() which keeps the latest
+  // serialization of the module to be written out with the other caches.
+  // V8 may call it on any thread, and after the handler is gone.
+  std::function<void(v8::CompiledWasmModule)> GetWasmSerializer(
+      CompileCacheEntry* entry);
+
+  // Returns the cached record of the package.json at `path`, or nullptr if
+  // there is none or if `stat` shows that the file has changed since.
+  const std::string* GetPackageJSON(const std::string& path,
+                                    const uv_stat_t* stat);
+  void SavePackageJSON(const std::string& path,
+                       const uv_stat_t* stat,
+                       std::string&& record);
+
+  // Appends snapshots of the entries refreshed since the last flush to the
+  // pack on a platform worker thread. Persist() waits for these to finish
+  // before writing out whatever is left.
+  void FlushInBackground();
+
+  // The memory held by the caches: the pack, the caches that V8 produced
+  // since it was read, and the package.json records. This walks the
+  // entries, which is cheap next to the compilations that created them.
+  size_t NativeMemorySize() const;
+
+  struct PackWriteState;
+  struct WasmCacheSlot;
 
  private:
-  void ReadCacheFile(CompileCacheEntry* entry);
+  bool ReadFromPack(CompileCacheEntry* entry);
+  void OpenPack();
+  void PersistPack();
+  void MaybeScheduleFlush();
+  void WaitForBackgroundWrites();
+  size_t SerializeRefreshedEntries(std::string* out);
+  void AppendEntry(std::string* out, CompileCacheEntry* entry);
+  void CollectWasmCaches();
+  void ReadPackageJSONCache();
+  void PersistPackageJSONCache();
 
   template <typename T>
   void MaybeSaveImpl(CompileCacheEntry* entry,
@@ -67,6 +178,27 @@ class CompileCacheHandler {
   static constexpr size_t kCacheHashOffset = 3;
   static constexpr size_t kHeaderCount = 4;
 
+  // A record in the cache pack, which consists of a kPackRecordMagic, the
+  // cache key, the four headers above and the cache content padded to a
+  // multiple of kPackAlignment.
+  struct PackRecord {
+    uint32_t headers[kHeaderCount];
+    const uint8_t* data;
+    size_t record_size;
+  };
+  static constexpr uint32_t kPackMagic = 0x4b504343;  // "CCPK"
+  static constexpr uint32_t kPackRecordMagic = 0x52504343;  // "CCPR"
+  static constexpr size_t kPackHeaderSize = 2 * sizeof(uint32_t);
+  static constexpr size_t kPackRecordHeaderSize =
+      (kHeaderCount + 2) * sizeof(uint32_t);
+  static constexpr size_t kPackAlignment = 8;
+
+  static void AppendPackRecord(std::string* out,
+                               uint32_t key,
+                               const uint32_t* headers,
+                               const uint8_t* data);
+
+  Environment* env_ = nullptr;
   v8::Isolate* isolate_ = nullptr;
   bool is_debug_ = false;
 
@@ -76,6 +208,36 @@ class CompileCacheHandler {
   uint32_t compiler_cache_key_ = 0;
   std::unordered_map<uint32_t, std::unique_ptr<CompileCacheEntry>>
       compiler_cache_store_;
+  // Where the serializers of the WebAssembly entries leave their caches,
+  // which are moved into the entries before they are written out.
+  std::unordered_map<uint32_t, std::shared_ptr<WasmCacheSlot>> wasm_slots_;
+
+  // All the caches live in a single append-only pack file which is mapped
+  // (or on Windows, read) in one go when the directory is initialized, so
+  // that loading a few thousand modules does not take a few thousand
+  // open/read/close round trips. Records appended later in the pack
+  // supersede earlier ones with the same key.
+  std::string pack_filename_;
+  const uint8_t* pack_data_ = nullptr;
+  size_t pack_size_ = 0;
+  size_t pack_dead_bytes_ = 0;
+  size_t pack_appended_bytes_ = 0;
+  // Whether the pack has an invalid header or ends in a broken record.
+  // Records appended to it could not be read back, so it is rewritten on
+  // Persist() instead, and nothing is appended in the background.
+  bool pack_needs_rewrite_ = false;
+  bool flush_scheduled_ = false;
+  std::shared_ptr<PackWriteState> write_state_;
+#ifdef _WIN32
+  std::string pack_contents_;
+#endif
+  std::unordered_map<uint32_t, PackRecord> pack_index_;
+
+  // The package.json cache is a single file, read lazily when the modules
+  // binding first asks for it and rewritten on Persist() if it changed.
+  bool package_json_cache_loaded_ = false;
+  bool package_json_cache_dirty_ = false;
+  std::unordered_map<std::string, PackageJSONCacheEntry> package_json_cache_;
 };
 }  // namespace node
 
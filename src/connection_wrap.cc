@@ -2,6 +2,7 @@
 
 #include "connect_wrap.h"
 #include "env-inl.h"
+#include "node_internals.h"
 #include "pipe_wrap.h"
 #include "stream_base-inl.h"
 #include "stream_wrap.h"
@@ -69,6 +70,9 @@ void ConnectionWrap<WrapType, UVType>::OnConnection(uv_stream_t* handle,
     client_handle = Undefined(env->isolate());
   }
 
+  // libuv accepts all pending connections in one go and calls this for each
+  // of them, so a burst of connections only runs the task queues once.
+  BatchTaskQueuesScope batch_scope(wrap_data);
   Local<Value> argv[] = { Integer::New(env->isolate(), status), client_handle };
   wrap_data->MakeCallback(env->onconnection_string(), arraysize(argv), argv);
 }
@@ -0,0 +1,125 @@
+#ifndef SRC_CPPGC_HELPERS_H_
+#define SRC_CPPGC_HELPERS_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <type_traits>  // std::remove_reference
+#include "base_object.h"
+#include "cppgc/garbage-collected.h"
+#include "cppgc/name-provider.h"
+#include "env.h"
+#include "node.h"
+#include "v8-cppgc.h"
+#include "v8-traced-handle.h"
+
+namespace node {
+
+// A mixin for wrappers whose memory is managed by cppgc instead of the weak
+// global handle of a BaseObject. The JavaScript object keeps the C++ object
+// alive through the CppHeap and the C++ object keeps the JavaScript object
+// alive through a traced reference, so there is no global handle and no weak
+// callback for each object, and the two are collected together once neither
+// is reachable. The reference is droppable, which lets V8 reclaim an
+// unmodified wrapper in a scavenge.
+//
+// The layout of the JavaScript object is the same as that of a BaseObject,
+// so that the two kinds can be told apart by the embedder ID in the first
+// internal field. A wrapper class looks like this:
+//
+//   class Foo final : public cppgc::GarbageCollected<Foo>,
+//                     public cppgc::NameProvider,
+//                     public CppgcMixin {
+//    public:
+//     SET_CPPGC_NAME(Foo)
+//     Foo(Environment* env, v8::Local<v8::Object> object) {
+//       CppgcMixin::Wrap(this, env, object);
+//     }
+//     void Trace(cppgc::Visitor* visitor) const final;
+//   };
+//
+//   cppgc::MakeGarbageCollected<Foo>(
+//       env->isolate()->GetCppHeap()->GetAllocationHandle(), env, object);
+//
+// Unlike that of a BaseObject, the destructor may run on a background thread
+// during sweeping, or after the Environment is gone. It must not touch V8 or
+// the Environment, which is why JavaScript values are kept in traced
+// references rather than in globals. Wrappers that own resources that have
+// to be released with the Environment should stay BaseObjects for now.
+//
+// ContextifyScript is the only wrapper that uses this so far. The
+// AsyncWrap-based ones, such as TCPWrap, WriteWrap or FSReqCallback, are
+// tied to libuv handles, requests and async_hooks, and need a cppgc-aware
+// AsyncWrap first.
+class CppgcMixin : public cppgc::GarbageCollectedMixin {
+ public:
+  enum InternalFields {
+    kEmbedderType = BaseObject::kEmbedderType,
+    kSlot = BaseObject::kSlot,
+    kInternalFieldCount
+  };
+
+  // This cannot be done in the constructor of the mixin, and has to be
+  // called from the constructor of the class, per the rules of
+  // cppgc::GarbageCollectedMixin. `ptr` must be of the concrete type.
+  template <typename T>
+  static void Wrap(T* ptr, Environment* env, v8::Local<v8::Object> object) {
+    CHECK_GE(object->InternalFieldCount(), T::kInternalFieldCount);
+    v8::Isolate* isolate = env->isolate();
+    ptr->env_ = env;
+    ptr->traced_reference_ = v8::TracedReference<v8::Object>(
+        isolate, object, v8::TracedReference<v8::Object>::IsDroppable{});
+    SetCppgcReference(isolate, object, ptr);
+  }
+
+  // Returns nullptr if `object` is not a cppgc-managed wrapper of this
+  // kind. The embedder ID tells cppgc-managed wrappers from BaseObjects and
+  // from objects of other embedders. Telling the classes apart relies on
+  // them having different numbers of internal fields, as with
+  // BaseObject::FromJSObject(), where the caller knows the class in advance.
+  template <typename T>
+  static T* Unwrap(IsolateData* isolate_data, v8::Local<v8::Object> object) {
+    if (object->InternalFieldCount() != T::kInternalFieldCount ||
+        object->GetAlignedPointerFromInternalField(kEmbedderType) !=
+            isolate_data->embedder_id_for_cppgc()) {
+      return nullptr;
+    }
+    return static_cast<T*>(object->GetAlignedPointerFromInternalField(kSlot));
+  }
+
+  v8::Local<v8::Object> object() const {
+    return traced_reference_.Get(env_->isolate());
+  }
+  Environment* env() const { return env_; }
+
+  void Trace(cppgc::Visitor* visitor) const override {
+    visitor->Trace(traced_reference_);
+  }
+
+ private:
+  Environment* env_ = nullptr;
+  v8::TracedReference<v8::Object> traced_reference_;
+};
+
+// The name under which heap snapshots show instances of the class.
+#define SET_CPPGC_NAME(Klass)                                                  \
+  const char* GetHumanReadableName() const final {                             \
+    return "Node / " #Klass;                                                   \
+  }
+
+// The counterpart of ASSIGN_OR_RETURN_UNWRAP for cppgc-managed wrappers.
+#define ASSIGN_OR_RETURN_UNWRAP_CPPGC(ptr, obj, ...)                           \
+  do {                                                                         \
+    using Type = std::remove_pointer_t<                                        \
+        std::remove_reference_t<decltype(*ptr)>>;                              \
+    v8::Local<v8::Object> unwrap_obj = (obj);                                  \
+    *ptr = CppgcMixin::Unwrap<Type>(                                           \
+        Environment::GetCurrent(unwrap_obj->GetIsolate())->isolate_data(),     \
+        unwrap_obj);                                                           \
+    if (*ptr == nullptr) return __VA_ARGS__;                                   \
+  } while (0)
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_CPPGC_HELPERS_H_
@@ -0,0 +1,531 @@
+#include "crypto/crypto_aead.h"
+#include "async_wrap-inl.h"
+#include "base_object-inl.h"
+#include "crypto/crypto_cipher.h"
+#include "crypto/crypto_util.h"
+#include "env-inl.h"
+#include "memory_tracker-inl.h"
+#include "node_buffer.h"
+#include "threadpoolwork-inl.h"
+#include "v8.h"
+
+namespace node {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Isolate;
+using v8::Just;
+using v8::Local;
+using v8::Maybe;
+using v8::MaybeLocal;
+using v8::Nothing;
+using v8::Object;
+using v8::Uint32;
+using v8::Uint8Array;
+using v8::Value;
+
+namespace crypto {
+AEADCipher::AEADCipher(CipherCtxPointer seal_ctx,
+                       CipherCtxPointer open_ctx,
+                       size_t iv_length,
+                       size_t tag_length)
+    : seal_ctx_(std::move(seal_ctx)),
+      open_ctx_(std::move(open_ctx)),
+      iv_length_(iv_length),
+      tag_length_(tag_length) {}
+
+std::unique_ptr<AEADCipher> AEADCipher::Create(const EVP_CIPHER* cipher,
+                                               const unsigned char* key,
+                                               size_t key_length,
+                                               size_t iv_length,
+                                               size_t tag_length) {
+  if (cipher == nullptr) return nullptr;
+  if (EVP_CIPHER_mode(cipher) == EVP_CIPH_GCM_MODE) {
+    if (!IsValidGCMTagLength(tag_length)) return nullptr;
+  } else if (EVP_CIPHER_nid(cipher) == NID_chacha20_poly1305) {
+    if (tag_length == 0 || tag_length > 16) return nullptr;
+  } else {
+    return nullptr;
+  }
+  if (key_length != static_cast<size_t>(EVP_CIPHER_key_length(cipher)) ||
+      iv_length == 0 || iv_length > INT_MAX) {
+    return nullptr;
+  }
+
+  // The key is only expanded here. Seal() and Open() only set the IV.
+  CipherCtxPointer ctx[2];
+  for (int encrypt = 0; encrypt < 2; encrypt++) {
+    ctx[encrypt].reset(EVP_CIPHER_CTX_new());
+    if (!ctx[encrypt] ||
+        !EVP_CipherInit_ex(
+            ctx[encrypt].get(), cipher, nullptr, nullptr, nullptr, encrypt) ||
+        !EVP_CIPHER_CTX_ctrl(ctx[encrypt].get(),
+                             EVP_CTRL_AEAD_SET_IVLEN,
+                             iv_length,
+                             nullptr) ||
+        !EVP_CipherInit_ex(
+            ctx[encrypt].get(), nullptr, nullptr, key, nullptr, encrypt)) {
+      return nullptr;
+    }
+  }
+
+  return std::unique_ptr<AEADCipher>(new AEADCipher(
+      std::move(ctx[1]), std::move(ctx[0]), iv_length, tag_length));
+}
+
+std::unique_ptr<AEADCipher> AEADCipher::Clone() const {
+  CipherCtxPointer seal_ctx(EVP_CIPHER_CTX_new());
+  CipherCtxPointer open_ctx(EVP_CIPHER_CTX_new());
+  if (!seal_ctx || !open_ctx ||
+      !EVP_CIPHER_CTX_copy(seal_ctx.get(), seal_ctx_.get()) ||
+      !EVP_CIPHER_CTX_copy(open_ctx.get(), open_ctx_.get())) {
+    return nullptr;
+  }
+  return std::unique_ptr<AEADCipher>(new AEADCipher(
+      std::move(seal_ctx), std::move(open_ctx), iv_length_, tag_length_));
+}
+
+size_t AEADCipher::OutputLength(Operation op, size_t length) const {
+  if (op == kSeal) return length + tag_length_;
+  return length < tag_length_ ? 0 : length - tag_length_;
+}
+
+bool AEADCipher::Seal(const unsigned char* iv,
+                      const unsigned char* in,
+                      size_t length,
+                      const unsigned char* aad,
+                      size_t aad_length,
+                      unsigned char* out) {
+  EVP_CIPHER_CTX* ctx = seal_ctx_.get();
+  int out_length;
+  if (!EVP_CipherInit_ex(ctx, nullptr, nullptr, nullptr, iv, 1) ||
+      (aad_length > 0 &&
+       !EVP_CipherUpdate(ctx, nullptr, &out_length, aad, aad_length)) ||
+      (length > 0 && !EVP_CipherUpdate(ctx, out, &out_length, in, length)) ||
+      !EVP_CipherFinal_ex(ctx, out + length, &out_length)) {
+    return false;
+  }
+  return EVP_CIPHER_CTX_ctrl(
+             ctx, EVP_CTRL_AEAD_GET_TAG, tag_length_, out + length) == 1;
+}
+
+bool AEADCipher::Open(const unsigned char* iv,
+                      const unsigned char* in,
+                      size_t length,
+                      const unsigned char* aad,
+                      size_t aad_length,
+                      unsigned char* out) {
+  if (length < tag_length_) return false;
+  EVP_CIPHER_CTX* ctx = open_ctx_.get();
+  const size_t ciphertext_length = length - tag_length_;
+  unsigned char* tag = const_cast<unsigned char*>(in) + ciphertext_length;
+  int out_length;
+  if (!EVP_CipherInit_ex(ctx, nullptr, nullptr, nullptr, iv, 0) ||
+      !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, tag_length_, tag) ||
+      (aad_length > 0 &&
+       !EVP_CipherUpdate(ctx, nullptr, &out_length, aad, aad_length)) ||
+      (ciphertext_length > 0 &&
+       !EVP_CipherUpdate(ctx, out, &out_length, in, ciphertext_length)) ||
+      EVP_CipherFinal_ex(ctx, out + ciphertext_length, &out_length) <= 0) {
+    // Never hand out plaintext that has not been authenticated.
+    OPENSSL_cleanse(out, ciphertext_length);
+    return false;
+  }
+  return true;
+}
+
+bool ProcessAEADBatch(AEADCipher* cipher,
+                      AEADCipher::Operation op,
+                      const std::vector<AEADRecord>& records,
+                      ByteSource* out) {
+  size_t size = records.size();
+  for (const AEADRecord& record : records)
+    size += cipher->OutputLength(op, record.data.size());
+
+  ByteSource::Builder buf(size);
+  unsigned char* status = buf.data<unsigned char>();
+  unsigned char* output = status + records.size();
+  for (size_t i = 0; i < records.size(); i++) {
+    const AEADRecord& record = records[i];
+    bool ok;
+    if (op == AEADCipher::kSeal) {
+      ok = cipher->Seal(record.iv.data<unsigned char>(),
+                        record.data.data<unsigned char>(),
+                        record.data.size(),
+                        record.aad.data<unsigned char>(),
+                        record.aad.size(),
+                        output);
+      if (!ok) return false;
+    } else {
+      ok = cipher->Open(record.iv.data<unsigned char>(),
+                        record.data.data<unsigned char>(),
+                        record.data.size(),
+                        record.aad.data<unsigned char>(),
+                        record.aad.size(),
+                        output);
+    }
+    status[i] = ok ? 1 : 0;
+    output += cipher->OutputLength(op, record.data.size());
+  }
+
+  *out = std::move(buf).release();
+  return true;
+}
+
+namespace {
+Maybe<bool> GetAEADRecord(Environment* env,
+                          const AEADCipher& cipher,
+                          Local<Value> iv_value,
+                          Local<Value> data_value,
+                          Local<Value> aad_value,
+                          bool copy,
+                          AEADRecord* record) {
+  if (!IsAnyBufferSource(iv_value) || !IsAnyBufferSource(data_value) ||
+      (!aad_value->IsUndefined() && !IsAnyBufferSource(aad_value))) {
+    THROW_ERR_INVALID_ARG_TYPE(env, "The IV, data and AAD must be buffers");
+    return Nothing<bool>();
+  }
+
+  ArrayBufferOrViewContents<char> iv(iv_value);
+  if (iv.size() != cipher.iv_length()) {
+    THROW_ERR_CRYPTO_INVALID_IV(env);
+    return Nothing<bool>();
+  }
+  ArrayBufferOrViewContents<char> data(data_value);
+  if (UNLIKELY(!data.CheckSizeInt32())) {
+    THROW_ERR_OUT_OF_RANGE(env, "data is too large");
+    return Nothing<bool>();
+  }
+  record->iv = copy ? iv.ToCopy() : iv.ToByteSource();
+  record->data = copy ? data.ToCopy() : data.ToByteSource();
+
+  if (!aad_value->IsUndefined()) {
+    ArrayBufferOrViewContents<char> aad(aad_value);
+    if (UNLIKELY(!aad.CheckSizeInt32())) {
+      THROW_ERR_OUT_OF_RANGE(env, "AAD is too large");
+      return Nothing<bool>();
+    }
+    record->aad = copy ? aad.ToCopy() : aad.ToByteSource();
+  }
+  return Just(true);
+}
+
+// Reads the records of a batch from the arrays of IVs, data and, unless
+// it is undefined, AADs.
+Maybe<bool> GetAEADRecords(Environment* env,
+                           const AEADCipher& cipher,
+                           AEADCipher::Operation op,
+                           Local<Value> ivs_value,
+                           Local<Value> data_value,
+                           Local<Value> aads_value,
+                           bool copy,
+                           std::vector<AEADRecord>* records) {
+  CHECK(ivs_value->IsArray());
+  CHECK(data_value->IsArray());
+  CHECK(aads_value->IsUndefined() || aads_value->IsArray());
+  Local<Array> ivs = ivs_value.As<Array>();
+  Local<Array> data = data_value.As<Array>();
+  if (ivs->Length() != data->Length() ||
+      (aads_value->IsArray() &&
+       aads_value.As<Array>()->Length() != data->Length())) {
+    THROW_ERR_INVALID_ARG_VALUE(env, "The batch arrays must be equally long");
+    return Nothing<bool>();
+  }
+
+  // Reading the elements can run getters, which could detach or shrink the
+  // buffers of records that are not copied. All elements are read before
+  // any of their contents are taken, and no JavaScript runs after that.
+  Local<v8::Context> context = env->context();
+  const uint32_t count = data->Length();
+  std::vector<Local<Value>> elements(3 * count, Undefined(env->isolate()));
+  for (uint32_t i = 0; i < count; i++) {
+    if (!ivs->Get(context, i).ToLocal(&elements[3 * i]) ||
+        !data->Get(context, i).ToLocal(&elements[3 * i + 1]) ||
+        (aads_value->IsArray() &&
+         !aads_value.As<Array>()->Get(context, i).ToLocal(
+             &elements[3 * i + 2]))) {
+      return Nothing<bool>();
+    }
+  }
+
+  size_t size = count;
+  records->resize(count);
+  for (uint32_t i = 0; i < count; i++) {
+    if (GetAEADRecord(env,
+                      cipher,
+                      elements[3 * i],
+                      elements[3 * i + 1],
+                      elements[3 * i + 2],
+                      copy,
+                      &(*records)[i])
+            .IsNothing()) {
+      return Nothing<bool>();
+    }
+    size += cipher.OutputLength(op, (*records)[i].data.size());
+    if (size > Buffer::kMaxLength) {
+      THROW_ERR_OUT_OF_RANGE(env, "The batch is too large");
+      return Nothing<bool>();
+    }
+  }
+  return Just(true);
+}
+
+// Turns the output of ProcessAEADBatch() into an array with a Buffer for
+// every record, or undefined for records that could not be opened. The
+// Buffers share a single ArrayBuffer.
+MaybeLocal<Value> EncodeAEADBatch(Environment* env,
+                                  const AEADCipher& cipher,
+                                  AEADCipher::Operation op,
+                                  const std::vector<AEADRecord>& records,
+                                  ByteSource* out) {
+  Local<ArrayBuffer> ab = out->ToArrayBuffer(env);
+  const unsigned char* status = static_cast<unsigned char*>(ab->Data());
+  std::vector<Local<Value>> results(records.size());
+  size_t offset = records.size();
+  for (size_t i = 0; i < records.size(); i++) {
+    size_t length = cipher.OutputLength(op, records[i].data.size());
+    if (status[i] == 1) {
+      Local<Uint8Array> buffer;
+      if (!Buffer::New(env, ab, offset, length).ToLocal(&buffer))
+        return MaybeLocal<Value>();
+      results[i] = buffer;
+    } else {
+      results[i] = Undefined(env->isolate());
+    }
+    offset += length;
+  }
+  return Array::New(env->isolate(), results.data(), results.size());
+}
+}  // anonymous namespace
+
+AEADKey::AEADKey(Environment* env,
+                 Local<Object> wrap,
+                 std::unique_ptr<AEADCipher> cipher)
+    : BaseObject(env, wrap), cipher_(std::move(cipher)) {
+  MakeWeak();
+}
+
+void AEADKey::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("contexts", 2 * kSizeOf_EVP_CIPHER_CTX);
+}
+
+// The arguments are the cipher name, the key, the IV length and the tag
+// length.
+void AEADKey::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  CHECK(IsAnyBufferSource(args[1]));
+  CHECK(args[2]->IsUint32());
+  CHECK(args[3]->IsUint32());
+
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+  const Utf8Value cipher_name(env->isolate(), args[0]);
+  const EVP_CIPHER* cipher = GetCipherByName(*cipher_name);
+  if (cipher == nullptr) return THROW_ERR_CRYPTO_UNKNOWN_CIPHER(env);
+
+  ArrayBufferOrViewContents<unsigned char> key(args[1]);
+  std::unique_ptr<AEADCipher> aead =
+      AEADCipher::Create(cipher,
+                         key.data(),
+                         key.size(),
+                         args[2].As<Uint32>()->Value(),
+                         args[3].As<Uint32>()->Value());
+  if (!aead) {
+    return THROW_ERR_CRYPTO_INVALID_STATE(
+        env, "Unsupported AEAD cipher, key, IV or tag length");
+  }
+
+  new AEADKey(env, args.This(), std::move(aead));
+}
+
+// The arguments are the IV, the data and the AAD, which may be undefined.
+// Opening returns undefined if authentication fails.
+template <AEADCipher::Operation op>
+void AEADKey::Process(const FunctionCallbackInfo<Value>& args) {
+  AEADKey* key;
+  ASSIGN_OR_RETURN_UNWRAP(&key, args.This());
+  Environment* env = Environment::GetCurrent(args);
+
+  AEADRecord record;
+  if (GetAEADRecord(env, *key->cipher(), args[0], args[1], args[2], false,
+                    &record)
+          .IsNothing()) {
+    return;
+  }
+
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+  const size_t length = key->cipher()->OutputLength(op, record.data.size());
+  ByteSource::Builder out(length);
+  if (op == AEADCipher::kSeal) {
+    if (!key->cipher()->Seal(record.iv.data<unsigned char>(),
+                             record.data.data<unsigned char>(),
+                             record.data.size(),
+                             record.aad.data<unsigned char>(),
+                             record.aad.size(),
+                             out.data<unsigned char>())) {
+      return ThrowCryptoError(env, ERR_get_error(), "Sealing failed");
+    }
+  } else if (!key->cipher()->Open(record.iv.data<unsigned char>(),
+                                  record.data.data<unsigned char>(),
+                                  record.data.size(),
+                                  record.aad.data<unsigned char>(),
+                                  record.aad.size(),
+                                  out.data<unsigned char>())) {
+    return;
+  }
+
+  Local<Value> buffer;
+  if (std::move(out).release().ToBuffer(env).ToLocal(&buffer))
+    args.GetReturnValue().Set(buffer);
+}
+
+// The arguments are arrays of IVs, data and AADs, which may be undefined.
+template <AEADCipher::Operation op>
+void AEADKey::ProcessBatch(const FunctionCallbackInfo<Value>& args) {
+  AEADKey* key;
+  ASSIGN_OR_RETURN_UNWRAP(&key, args.This());
+  Environment* env = Environment::GetCurrent(args);
+
+  std::vector<AEADRecord> records;
+  if (GetAEADRecords(
+          env, *key->cipher(), op, args[0], args[1], args[2], false, &records)
+          .IsNothing()) {
+    return;
+  }
+
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+  ByteSource out;
+  if (!ProcessAEADBatch(key->cipher(), op, records, &out))
+    return ThrowCryptoError(env, ERR_get_error(), "Sealing failed");
+
+  Local<Value> result;
+  if (EncodeAEADBatch(env, *key->cipher(), op, records, &out)
+          .ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
+}
+
+void AEADKey::Initialize(Environment* env, Local<Object> target) {
+  Isolate* isolate = env->isolate();
+  Local<FunctionTemplate> t = NewFunctionTemplate(isolate, New);
+  t->InstanceTemplate()->SetInternalFieldCount(AEADKey::kInternalFieldCount);
+
+  SetProtoMethod(isolate, t, "seal", Process<AEADCipher::kSeal>);
+  SetProtoMethod(isolate, t, "open", Process<AEADCipher::kOpen>);
+  SetProtoMethod(isolate, t, "sealBatch", ProcessBatch<AEADCipher::kSeal>);
+  SetProtoMethod(isolate, t, "openBatch", ProcessBatch<AEADCipher::kOpen>);
+  SetConstructorFunction(env->context(), target, "AEADKey", t);
+}
+
+void AEADKey::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Process<AEADCipher::kSeal>);
+  registry->Register(Process<AEADCipher::kOpen>);
+  registry->Register(ProcessBatch<AEADCipher::kSeal>);
+  registry->Register(ProcessBatch<AEADCipher::kOpen>);
+}
+
+AEADBatchConfig::AEADBatchConfig(AEADBatchConfig&& other) noexcept
+    : mode(other.mode),
+      op(other.op),
+      cipher(std::move(other.cipher)),
+      records(std::move(other.records)) {}
+
+AEADBatchConfig& AEADBatchConfig::operator=(AEADBatchConfig&& other) noexcept {
+  if (&other == this) return *this;
+  this->~AEADBatchConfig();
+  return *new (this) AEADBatchConfig(std::move(other));
+}
+
+void AEADBatchConfig::MemoryInfo(MemoryTracker* tracker) const {
+  if (mode == kCryptoJobAsync) {
+    size_t size = 0;
+    for (const AEADRecord& record : records)
+      size += record.iv.size() + record.data.size() + record.aad.size();
+    tracker->TrackFieldWithSize("records", size);
+  }
+}
+
+// The input arguments for the job are:
+//   1. CryptoJobMode
+//   2. The AEADKey
+//   3. The AEADCipher::Operation
+//   4. An array of IVs
+//   5. An array of data
+//   6. An array of AADs, or undefined
+Maybe<bool> AEADBatchTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    AEADBatchConfig* params) {
+  Environment* env = Environment::GetCurrent(args);
+
+  params->mode = mode;
+
+  CHECK(args[offset]->IsObject());  // AEADKey
+  CHECK(args[offset + 1]->IsUint32());  // Operation
+  AEADKey* key;
+  ASSIGN_OR_RETURN_UNWRAP(&key, args[offset], Nothing<bool>());
+  uint32_t op = args[offset + 1].As<Uint32>()->Value();
+  CHECK_LE(op, AEADCipher::kOpen);
+  params->op = static_cast<AEADCipher::Operation>(op);
+
+  if (GetAEADRecords(env,
+                     *key->cipher(),
+                     params->op,
+                     args[offset + 2],
+                     args[offset + 3],
+                     args[offset + 4],
+                     mode == kCryptoJobAsync,
+                     &params->records)
+          .IsNothing()) {
+    return Nothing<bool>();
+  }
+
+  params->cipher = key->cipher()->Clone();
+  if (!params->cipher) {
+    THROW_ERR_CRYPTO_OPERATION_FAILED(env, "Failed to copy the AEAD key");
+    return Nothing<bool>();
+  }
+
+  return Just(true);
+}
+
+bool AEADBatchTraits::DeriveBits(
+    Environment* env,
+    const AEADBatchConfig& params,
+    ByteSource* out) {
+  return ProcessAEADBatch(params.cipher.get(), params.op, params.records, out);
+}
+
+Maybe<bool> AEADBatchTraits::EncodeOutput(
+    Environment* env,
+    const AEADBatchConfig& params,
+    ByteSource* out,
+    Local<Value>* result) {
+  return Just(
+      EncodeAEADBatch(env, *params.cipher, params.op, params.records, out)
+          .ToLocal(result));
+}
+
+namespace AEAD {
+void Initialize(Environment* env, Local<Object> target) {
+  AEADKey::Initialize(env, target);
+  AEADBatchJob::Initialize(env, target);
+
+  constexpr int kAEADSeal = AEADCipher::kSeal;
+  constexpr int kAEADOpen = AEADCipher::kOpen;
+  NODE_DEFINE_CONSTANT(target, kAEADSeal);
+  NODE_DEFINE_CONSTANT(target, kAEADOpen);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  AEADKey::RegisterExternalReferences(registry);
+  AEADBatchJob::RegisterExternalReferences(registry);
+}
+}  // namespace AEAD
+}  // namespace crypto
+}  // namespace node
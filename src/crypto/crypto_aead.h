@@ -0,0 +1,169 @@
+#ifndef SRC_CRYPTO_CRYPTO_AEAD_H_
+#define SRC_CRYPTO_CRYPTO_AEAD_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "async_wrap.h"
+#include "base_object.h"
+#include "crypto/crypto_util.h"
+#include "env.h"
+#include "memory_tracker.h"
+#include "v8.h"
+
+#include <memory>
+#include <vector>
+
+namespace node {
+namespace crypto {
+// A key for AES-GCM or ChaCha20-Poly1305 that seals and opens whole
+// messages. Unlike CipherBase, which needs a new cipher context, and so a
+// new key schedule, for every message, the contexts are set up for the key
+// once and only get a new IV for every message.
+class AEADCipher final {
+ public:
+  enum Operation : int {
+    kSeal,
+    kOpen
+  };
+
+  // Returns nullptr if the cipher is not AES-GCM or ChaCha20-Poly1305, or if
+  // the key, IV or tag length is not valid for it.
+  static std::unique_ptr<AEADCipher> Create(const EVP_CIPHER* cipher,
+                                            const unsigned char* key,
+                                            size_t key_length,
+                                            size_t iv_length,
+                                            size_t tag_length);
+
+  // Returns a copy of the cipher, including its key schedule, that can be
+  // used by another thread, or nullptr.
+  std::unique_ptr<AEADCipher> Clone() const;
+
+  size_t iv_length() const { return iv_length_; }
+  size_t tag_length() const { return tag_length_; }
+
+  // The size of the output for an input of |length| bytes, or 0 if an
+  // input of that size cannot be opened.
+  size_t OutputLength(Operation op, size_t length) const;
+
+  // Writes the ciphertext followed by the tag to |out|.
+  bool Seal(const unsigned char* iv,
+            const unsigned char* in,
+            size_t length,
+            const unsigned char* aad,
+            size_t aad_length,
+            unsigned char* out);
+  // Verifies the tag at the end of |in| and writes the plaintext to |out|.
+  // Returns false if authentication fails, in which case |out| is wiped.
+  bool Open(const unsigned char* iv,
+            const unsigned char* in,
+            size_t length,
+            const unsigned char* aad,
+            size_t aad_length,
+            unsigned char* out);
+
+ private:
+  AEADCipher(CipherCtxPointer seal_ctx,
+             CipherCtxPointer open_ctx,
+             size_t iv_length,
+             size_t tag_length);
+
+  CipherCtxPointer seal_ctx_;
+  CipherCtxPointer open_ctx_;
+  const size_t iv_length_;
+  const size_t tag_length_;
+};
+
+struct AEADRecord {
+  ByteSource iv;
+  ByteSource data;
+  ByteSource aad;
+};
+
+// Seals or opens every record. For every record, |out| starts with one
+// byte that is 1 if the record succeeded, followed by the outputs of all
+// records. Opening a record can fail without failing the batch, sealing
+// cannot.
+bool ProcessAEADBatch(AEADCipher* cipher,
+                      AEADCipher::Operation op,
+                      const std::vector<AEADRecord>& records,
+                      ByteSource* out);
+
+class AEADKey final : public BaseObject {
+ public:
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+  AEADCipher* cipher() const { return cipher_.get(); }
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(AEADKey)
+  SET_SELF_SIZE(AEADKey)
+
+ private:
+  AEADKey(Environment* env,
+          v8::Local<v8::Object> wrap,
+          std::unique_ptr<AEADCipher> cipher);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  template <AEADCipher::Operation op>
+  static void Process(const v8::FunctionCallbackInfo<v8::Value>& args);
+  template <AEADCipher::Operation op>
+  static void ProcessBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  std::unique_ptr<AEADCipher> cipher_;
+};
+
+struct AEADBatchConfig final : public MemoryRetainer {
+  CryptoJobMode mode;
+  AEADCipher::Operation op;
+  // A copy of the cipher of the AEADKey, so that the key can still be used
+  // on the main thread while the job runs.
+  std::unique_ptr<AEADCipher> cipher;
+  std::vector<AEADRecord> records;
+
+  AEADBatchConfig() = default;
+
+  explicit AEADBatchConfig(AEADBatchConfig&& other) noexcept;
+
+  AEADBatchConfig& operator=(AEADBatchConfig&& other) noexcept;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(AEADBatchConfig)
+  SET_SELF_SIZE(AEADBatchConfig)
+};
+
+struct AEADBatchTraits final {
+  using AdditionalParameters = AEADBatchConfig;
+  static constexpr const char* JobName = "AEADBatchJob";
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_CIPHERREQUEST;
+
+  static v8::Maybe<bool> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      AEADBatchConfig* params);
+
+  static bool DeriveBits(
+      Environment* env,
+      const AEADBatchConfig& params,
+      ByteSource* out);
+
+  static v8::Maybe<bool> EncodeOutput(
+      Environment* env,
+      const AEADBatchConfig& params,
+      ByteSource* out,
+      v8::Local<v8::Value>* result);
+};
+
+using AEADBatchJob = DeriveBitsJob<AEADBatchTraits>;
+
+namespace AEAD {
+void Initialize(Environment* env, v8::Local<v8::Object> target);
+void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+}  // namespace AEAD
+}  // namespace crypto
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+#endif  // SRC_CRYPTO_CRYPTO_AEAD_H_
@@ -42,44 +42,45 @@ WebCryptoCipherStatus AES_Cipher(
   CHECK_EQ(key_data->GetKeyType(), kKeyTypeSecret);
 
   const int mode = EVP_CIPHER_mode(params.cipher);
-
-  CipherCtxPointer ctx(EVP_CIPHER_CTX_new());
-  EVP_CIPHER_CTX_init(ctx.get());
-  if (mode == EVP_CIPH_WRAP_MODE)
-    EVP_CIPHER_CTX_set_flags(ctx.get(), EVP_CIPHER_CTX_FLAG_WRAP_ALLOW);
-
   const bool encrypt = cipher_mode == kWebCryptoCipherEncrypt;
 
-  if (!EVP_CipherInit_ex(
-          ctx.get(),
-          params.cipher,
-          nullptr,
-          nullptr,
-          nullptr,
-          encrypt)) {
-    // Cipher init failed
-    return WebCryptoCipherStatus::FAILED;
-  }
-
-  if (mode == EVP_CIPH_GCM_MODE && !EVP_CIPHER_CTX_ctrl(
-        ctx.get(),
-        EVP_CTRL_AEAD_SET_IVLEN,
-        params.iv.size(),
-        nullptr)) {
-    return WebCryptoCipherStatus::FAILED;
-  }
-
-  if (!EVP_CIPHER_CTX_set_key_length(
-          ctx.get(),
-          key_data->GetSymmetricKeySize()) ||
-      !EVP_CipherInit_ex(
-          ctx.get(),
-          nullptr,
-          nullptr,
-          reinterpret_cast<const unsigned char*>(key_data->GetSymmetricKey()),
-          params.iv.data<unsigned char>(),
-          encrypt)) {
-    return WebCryptoCipherStatus::FAILED;
+  CipherCtxPointer ctx;
+  if (mode == EVP_CIPH_WRAP_MODE) {
+    ctx.reset(EVP_CIPHER_CTX_new());
+    EVP_CIPHER_CTX_set_flags(ctx.get(), EVP_CIPHER_CTX_FLAG_WRAP_ALLOW);
+    if (!EVP_CipherInit_ex(
+            ctx.get(),
+            params.cipher,
+            nullptr,
+            nullptr,
+            nullptr,
+            encrypt) ||
+        !EVP_CIPHER_CTX_set_key_length(
+            ctx.get(),
+            key_data->GetSymmetricKeySize()) ||
+        !EVP_CipherInit_ex(
+            ctx.get(),
+            nullptr,
+            nullptr,
+            reinterpret_cast<const unsigned char*>(
+                key_data->GetSymmetricKey()),
+            params.iv.data<unsigned char>(),
+            encrypt)) {
+      return WebCryptoCipherStatus::FAILED;
+    }
+  } else {
+    // The key schedule is kept by the key, so only the IV needs to be set.
+    ctx = key_data->NewCipherContext(params.cipher, encrypt, params.iv.size());
+    if (!ctx ||
+        !EVP_CipherInit_ex(
+            ctx.get(),
+            nullptr,
+            nullptr,
+            nullptr,
+            params.iv.data<unsigned char>(),
+            encrypt)) {
+      return WebCryptoCipherStatus::FAILED;
+    }
   }
 
   size_t tag_len = 0;
@@ -227,14 +228,15 @@ WebCryptoCipherStatus AES_CTR_Cipher2(
     const ByteSource& in,
     unsigned const char* counter,
     unsigned char* out) {
-  CipherCtxPointer ctx(EVP_CIPHER_CTX_new());
   const bool encrypt = cipher_mode == kWebCryptoCipherEncrypt;
+  CipherCtxPointer ctx = key_data->NewCipherContext(params.cipher, encrypt, 0);
 
-  if (!EVP_CipherInit_ex(
+  if (!ctx ||
+      !EVP_CipherInit_ex(
           ctx.get(),
-          params.cipher,
           nullptr,
-          reinterpret_cast<const unsigned char*>(key_data->GetSymmetricKey()),
+          nullptr,
+          nullptr,
           counter,
           encrypt)) {
     // Cipher init failed
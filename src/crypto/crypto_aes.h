@@ -57,6 +57,8 @@ struct AESCipherConfig final : public MemoryRetainer {
 
 struct AESCipherTraits final {
   static constexpr const char* JobName = "AESCipherJob";
+  // Small inputs are processed on the main thread, see CipherJob.
+  static constexpr bool kRunsInline = true;
 
   using AdditionalParameters = AESCipherConfig;
 
@@ -155,8 +155,11 @@ class NodeBIO : public MemoryRetainer {
                                            len_(len),
                                            next_(nullptr) {
       data_ = new char[len];
-      if (env_ != nullptr)
+      if (env_ != nullptr) {
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(len);
+        env_->native_memory_counters()->Increase(
+            mem::NativeMemoryCounters::kTls, len);
+      }
     }
 
     ~Buffer() {
@@ -164,6 +167,8 @@ class NodeBIO : public MemoryRetainer {
       if (env_ != nullptr) {
         const int64_t len = static_cast<int64_t>(len_);
         env_->isolate()->AdjustAmountOfExternalAllocatedMemory(-len);
+        env_->native_memory_counters()->Decrease(
+            mem::NativeMemoryCounters::kTls, len_);
       }
     }
 
@@ -14,6 +14,8 @@
 
 namespace node {
 namespace crypto {
+bool IsValidGCMTagLength(unsigned int tag_len);
+
 class CipherBase : public BaseObject {
  public:
   static void GetSSLCiphers(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -219,6 +221,10 @@ class CipherJob final : public CryptoJob<CipherTraits> {
 
   WebCryptoCipherMode cipher_mode() const { return cipher_mode_; }
 
+  bool RunsInline() const override {
+    return CipherTraits::kRunsInline && in_.size() <= kCryptoJobInlineLimit;
+  }
+
   void DoThreadPoolWork() override {
     const WebCryptoCipherStatus status =
         CipherTraits::DoCipher(
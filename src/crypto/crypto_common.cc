@@ -23,6 +23,7 @@
 
 namespace node {
 
+using v8::AccessorNameGetterCallback;
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::BackingStore;
@@ -32,8 +33,10 @@ using v8::EscapableHandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::MaybeLocal;
+using v8::Name;
 using v8::NewStringType;
 using v8::Object;
+using v8::PropertyCallbackInfo;
 using v8::String;
 using v8::Undefined;
 using v8::Value;
@@ -1256,6 +1259,83 @@ MaybeLocal<Value> GetPeerCert(
   return result;
 }
 
+namespace {
+// Getters for the fields of X509ToObject() results that are expensive to
+// compute and often not looked at. V8 calls one on the first access of its
+// property and then turns the property into an ordinary data property.
+// `info.Data()` is an X509Certificate that keeps the certificate alive until
+// then.
+template <MaybeLocal<Value> (*Get)(Environment* env, X509* cert)>
+void GetLazyX509Field(Local<Name> property,
+                      const PropertyCallbackInfo<Value>& info) {
+  Environment* env = Environment::GetCurrent(info);
+  X509Certificate* cert;
+  ASSIGN_OR_RETURN_UNWRAP(&cert, info.Data().As<Object>());
+  ClearErrorOnReturn clear_error_on_return;
+  Local<Value> value;
+  if (Get(env, cert->get()).ToLocal(&value))
+    info.GetReturnValue().Set(value);
+}
+
+MaybeLocal<Value> GetSubjectAltNameField(Environment* env, X509* cert) {
+  BIOPointer bio(BIO_new(BIO_s_mem()));
+  CHECK(bio);
+  return GetSubjectAltNameString(env, cert, bio);
+}
+
+MaybeLocal<Value> GetInfoAccessField(Environment* env, X509* cert) {
+  BIOPointer bio(BIO_new(BIO_s_mem()));
+  CHECK(bio);
+  return GetInfoAccessString(env, cert, bio);
+}
+
+template <const EVP_MD* (*algorithm)()>
+MaybeLocal<Value> GetFingerprintField(Environment* env, X509* cert) {
+  return GetFingerprintDigest(env, algorithm(), cert);
+}
+
+RSAPointer GetRSAPublicKey(X509* cert) {
+  EVPKeyPointer pkey(X509_get_pubkey(cert));
+  CHECK(pkey);
+  RSAPointer rsa(EVP_PKEY_get1_RSA(pkey.get()));
+  CHECK(rsa);
+  return rsa;
+}
+
+MaybeLocal<Value> GetModulusField(Environment* env, X509* cert) {
+  RSAPointer rsa = GetRSAPublicKey(cert);
+  const BIGNUM* n;
+  RSA_get0_key(rsa.get(), &n, nullptr, nullptr);
+  BIOPointer bio(BIO_new(BIO_s_mem()));
+  CHECK(bio);
+  return GetModulusString(env, bio, n);
+}
+
+MaybeLocal<Value> GetExponentField(Environment* env, X509* cert) {
+  RSAPointer rsa = GetRSAPublicKey(cert);
+  const BIGNUM* e;
+  RSA_get0_key(rsa.get(), nullptr, &e, nullptr);
+  BIOPointer bio(BIO_new(BIO_s_mem()));
+  CHECK(bio);
+  return GetExponentString(env, bio, e);
+}
+
+MaybeLocal<Value> GetRSAPubKeyField(Environment* env, X509* cert) {
+  Local<Object> pubkey;
+  if (!GetPubKey(env, GetRSAPublicKey(cert)).ToLocal(&pubkey))
+    return MaybeLocal<Value>();
+  return pubkey;
+}
+
+MaybeLocal<Value> GetECPubKeyField(Environment* env, X509* cert) {
+  EVPKeyPointer pkey(X509_get_pubkey(cert));
+  CHECK(pkey);
+  ECPointer ec(EVP_PKEY_get1_EC_KEY(pkey.get()));
+  CHECK(ec);
+  return GetECPubKey(env, EC_KEY_get0_group(ec.get()), ec);
+}
+}  // namespace
+
 MaybeLocal<Object> X509ToObject(
     Environment* env,
     X509* cert) {
@@ -1263,6 +1343,15 @@ MaybeLocal<Object> X509ToObject(
   Local<Context> context = env->context();
   Local<Object> info = Object::New(env->isolate());
 
+  // Keeps `cert` alive for the lazily computed fields.
+  Local<Object> holder;
+  X509_up_ref(cert);
+  if (!X509Certificate::New(env, X509Pointer(cert)).ToLocal(&holder))
+    return MaybeLocal<Object>();
+  auto set_lazy = [&](Local<String> name, AccessorNameGetterCallback getter) {
+    return info->SetLazyDataProperty(context, name, getter, holder).IsJust();
+  };
+
   BIOPointer bio(BIO_new(BIO_s_mem()));
   CHECK(bio);
 
@@ -1276,14 +1365,10 @@ MaybeLocal<Object> X509ToObject(
                   info,
                   env->issuer_string(),
                   GetX509NameObject<X509_get_issuer_name>(env, cert)) ||
-      !Set<Value>(context,
-                  info,
-                  env->subjectaltname_string(),
-                  GetSubjectAltNameString(env, cert, bio)) ||
-      !Set<Value>(context,
-                  info,
-                  env->infoaccess_string(),
-                  GetInfoAccessString(env, cert, bio)) ||
+      !set_lazy(env->subjectaltname_string(),
+                GetLazyX509Field<GetSubjectAltNameField>) ||
+      !set_lazy(env->infoaccess_string(),
+                GetLazyX509Field<GetInfoAccessField>) ||
       !Set<Boolean>(context, info, env->ca_string(), is_ca)) {
     return MaybeLocal<Object>();
   }
@@ -1304,21 +1389,12 @@ MaybeLocal<Object> X509ToObject(
 
   if (rsa) {
     const BIGNUM* n;
-    const BIGNUM* e;
-    RSA_get0_key(rsa.get(), &n, &e, nullptr);
-    if (!Set<Value>(context,
-                    info,
-                    env->modulus_string(),
-                    GetModulusString(env, bio, n)) ||
+    RSA_get0_key(rsa.get(), &n, nullptr, nullptr);
+    if (!set_lazy(env->modulus_string(), GetLazyX509Field<GetModulusField>) ||
         !Set<Value>(context, info, env->bits_string(), GetBits(env, n)) ||
-        !Set<Value>(context,
-                    info,
-                    env->exponent_string(),
-                    GetExponentString(env, bio, e)) ||
-        !Set<Object>(context,
-                     info,
-                     env->pubkey_string(),
-                     GetPubKey(env, rsa))) {
+        !set_lazy(env->exponent_string(),
+                  GetLazyX509Field<GetExponentField>) ||
+        !set_lazy(env->pubkey_string(), GetLazyX509Field<GetRSAPubKeyField>)) {
       return MaybeLocal<Object>();
     }
   } else if (ec) {
@@ -1328,10 +1404,7 @@ MaybeLocal<Object> X509ToObject(
                     info,
                     env->bits_string(),
                     GetECGroup(env, group, ec)) ||
-        !Set<Value>(context,
-                    info,
-                    env->pubkey_string(),
-                    GetECPubKey(env, group, ec))) {
+        !set_lazy(env->pubkey_string(), GetLazyX509Field<GetECPubKeyField>)) {
       return MaybeLocal<Object>();
     }
 
@@ -1374,26 +1447,16 @@ MaybeLocal<Object> X509ToObject(
   // bio is no longer needed
   bio.reset();
 
-  if (!Set<Value>(context,
-                  info,
-                  env->fingerprint_string(),
-                  GetFingerprintDigest(env, EVP_sha1(), cert)) ||
-      !Set<Value>(context,
-                  info,
-                  env->fingerprint256_string(),
-                  GetFingerprintDigest(env, EVP_sha256(), cert)) ||
-      !Set<Value>(context,
-                  info,
-                  env->fingerprint512_string(),
-                  GetFingerprintDigest(env, EVP_sha512(), cert)) ||
-      !Set<Value>(
-          context, info, env->ext_key_usage_string(), GetKeyUsage(env, cert)) ||
-      !Set<Value>(context,
-                  info,
-                  env->serial_number_string(),
-                  GetSerialNumber(env, cert)) ||
-      !Set<Value>(
-          context, info, env->raw_string(), GetRawDERCertificate(env, cert))) {
+  if (!set_lazy(env->fingerprint_string(),
+                GetLazyX509Field<GetFingerprintField<EVP_sha1>>) ||
+      !set_lazy(env->fingerprint256_string(),
+                GetLazyX509Field<GetFingerprintField<EVP_sha256>>) ||
+      !set_lazy(env->fingerprint512_string(),
+                GetLazyX509Field<GetFingerprintField<EVP_sha512>>) ||
+      !set_lazy(env->ext_key_usage_string(), GetLazyX509Field<GetKeyUsage>) ||
+      !set_lazy(env->serial_number_string(),
+                GetLazyX509Field<GetSerialNumber>) ||
+      !set_lazy(env->raw_string(), GetLazyX509Field<GetRawDERCertificate>)) {
     return MaybeLocal<Object>();
   }
 
@@ -1,6 +1,7 @@
 #include "crypto/crypto_context.h"
 #include "crypto/crypto_bio.h"
 #include "crypto/crypto_common.h"
+#include "crypto/crypto_session_cache.h"
 #include "crypto/crypto_util.h"
 #include "base_object-inl.h"
 #include "env-inl.h"
@@ -287,6 +288,8 @@ Local<FunctionTemplate> SecureContext::GetConstructorTemplate(
     SetProtoMethod(isolate, tmpl, "setOptions", SetOptions);
     SetProtoMethod(isolate, tmpl, "setSessionIdContext", SetSessionIdContext);
     SetProtoMethod(isolate, tmpl, "setSessionTimeout", SetSessionTimeout);
+    SetProtoMethod(
+        isolate, tmpl, "enableSharedSessionCache", EnableSharedSessionCache);
     SetProtoMethod(isolate, tmpl, "close", Close);
     SetProtoMethod(isolate, tmpl, "loadPKCS12", LoadPKCS12);
     SetProtoMethod(isolate, tmpl, "setTicketKeys", SetTicketKeys);
@@ -366,6 +369,7 @@ void SecureContext::RegisterExternalReferences(
   registry->Register(SetOptions);
   registry->Register(SetSessionIdContext);
   registry->Register(SetSessionTimeout);
+  registry->Register(EnableSharedSessionCache);
   registry->Register(Close);
   registry->Register(LoadPKCS12);
   registry->Register(SetTicketKeys);
@@ -400,11 +404,15 @@ SecureContext::SecureContext(Environment* env, Local<Object> wrap)
     : BaseObject(env, wrap) {
   MakeWeak();
   env->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
+  env->native_memory_counters()->Increase(mem::NativeMemoryCounters::kTls,
+                                          kExternalSize);
 }
 
 inline void SecureContext::Reset() {
   if (ctx_ != nullptr) {
     env()->isolate()->AdjustAmountOfExternalAllocatedMemory(-kExternalSize);
+    env()->native_memory_counters()->Decrease(
+        mem::NativeMemoryCounters::kTls, kExternalSize);
   }
   ctx_.reset();
   cert_.reset();
@@ -971,8 +979,11 @@ void SecureContext::SetSessionIdContext(
       reinterpret_cast<const unsigned char*>(*sessionIdContext);
   unsigned int sid_ctx_len = sessionIdContext.length();
 
-  if (SSL_CTX_set_session_id_context(sc->ctx_.get(), sid_ctx, sid_ctx_len) == 1)
+  SSL_CTX* ctx = sc->ctx_.get();
+  if (SSL_CTX_set_session_id_context(ctx, sid_ctx, sid_ctx_len) == 1) {
+    sc->session_id_context_.assign(*sessionIdContext, sid_ctx_len);
     return;
+  }
 
   BUF_MEM* mem;
   Local<String> message;
@@ -1002,6 +1013,28 @@ void SecureContext::SetSessionTimeout(const FunctionCallbackInfo<Value>& args) {
   SSL_CTX_set_timeout(sc->ctx_.get(), sessionTimeout);
 }
 
+void SecureContext::EnableSharedSessionCache(
+    const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc;
+  ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
+  Environment* env = sc->env();
+
+  // Without a path, the cache is shared by the SecureContexts of this
+  // process. With a path, it is shared by all processes that use that path.
+  if (args[0]->IsUndefined()) {
+    sc->session_cache_ = TLSSessionCache::GetProcessCache();
+    return;
+  }
+
+  CHECK(args[0]->IsString());
+  Utf8Value path(env->isolate(), args[0]);
+  int err = 0;
+  TLSSessionCache* cache = TLSSessionCache::GetSharedCache(*path, &err);
+  if (cache == nullptr)
+    return env->ThrowErrnoException(err, "mmap", nullptr, *path);
+  sc->session_cache_ = cache;
+}
+
 void SecureContext::Close(const FunctionCallbackInfo<Value>& args) {
   SecureContext* sc;
   ASSIGN_OR_RETURN_UNWRAP(&sc, args.Holder());
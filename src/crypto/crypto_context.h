@@ -28,6 +28,8 @@ X509_STORE* GetOrCreateRootCertStore();
 
 BIOPointer LoadBIO(Environment* env, v8::Local<v8::Value> v);
 
+class TLSSessionCache;
+
 class SecureContext final : public BaseObject {
  public:
   using GetSessionCb = SSL_SESSION* (*)(SSL*, const unsigned char*, int, int*);
@@ -57,6 +59,11 @@ class SecureContext final : public BaseObject {
   void SetNewSessionCallback(NewSessionCb cb);
   void SetSelectSNIContextCallback(SelectSNIContextCb cb);
 
+  // The native session cache that server sessions are stored in and looked
+  // up from, or nullptr if enableSharedSessionCache() was not called.
+  TLSSessionCache* session_cache() const { return session_cache_; }
+  const std::string& session_id_context() const { return session_id_context_; }
+
   inline const X509Pointer& issuer() const { return issuer_; }
   inline const X509Pointer& cert() const { return cert_; }
 
@@ -105,6 +112,8 @@ class SecureContext final : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetSessionTimeout(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableSharedSessionCache(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetMinProto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetMaxProto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetMinProto(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -150,6 +159,9 @@ class SecureContext final : public BaseObject {
   EnginePointer private_key_engine_;
 #endif  // !OPENSSL_NO_ENGINE
 
+  TLSSessionCache* session_cache_ = nullptr;
+  std::string session_id_context_;
+
   unsigned char ticket_key_name_[16];
   unsigned char ticket_key_aes_[16];
   unsigned char ticket_key_hmac_[16];
@@ -75,6 +75,7 @@ using DhKeyPairGenConfig = KeyPairGenConfig<DhKeyPairParams>;
 struct DhKeyGenTraits final {
   using AdditionalParameters = DhKeyPairGenConfig;
   static constexpr const char* JobName = "DhKeyPairGenJob";
+  static constexpr bool kPoolable = false;
 
   static EVPKeyCtxPointer Setup(DhKeyPairGenConfig* params);
 
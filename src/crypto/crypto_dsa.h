@@ -25,6 +25,7 @@ using DsaKeyPairGenConfig = KeyPairGenConfig<DsaKeyPairParams>;
 struct DsaKeyGenTraits final {
   using AdditionalParameters = DsaKeyPairGenConfig;
   static constexpr const char* JobName = "DsaKeyPairGenJob";
+  static constexpr bool kPoolable = false;
 
   static EVPKeyCtxPointer Setup(DsaKeyPairGenConfig* params);
 
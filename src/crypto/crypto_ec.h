@@ -104,6 +104,7 @@ using EcKeyPairGenConfig = KeyPairGenConfig<EcKeyPairParams>;
 struct EcKeyGenTraits final {
   using AdditionalParameters = EcKeyPairGenConfig;
   static constexpr const char* JobName = "EcKeyPairGenJob";
+  static constexpr bool kPoolable = true;
 
   static EVPKeyCtxPointer Setup(EcKeyPairGenConfig* params);
 
@@ -8,9 +8,14 @@
 #include "v8.h"
 
 #include <cstdio>
+#include <limits>
+#include <vector>
 
 namespace node {
 
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::BackingStore;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -23,6 +28,7 @@ using v8::MaybeLocal;
 using v8::Name;
 using v8::Nothing;
 using v8::Object;
+using v8::String;
 using v8::Uint32;
 using v8::Value;
 
@@ -267,6 +273,94 @@ void Hash::OneShotDigest(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(rc.FromMaybe(Local<Value>()));
 }
 
+// crypto.digestMany(algorithm, algorithmId, algorithmCache,
+//                   inputs, outputEncoding, outputEncodingId)
+void Hash::OneShotDigestMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+  CHECK_EQ(args.Length(), 6);
+  CHECK(args[0]->IsString());                            // algorithm
+  CHECK(args[1]->IsInt32());                             // algorithmId
+  CHECK(args[2]->IsObject());                            // algorithmCache
+  CHECK(args[3]->IsArray());                             // inputs
+  CHECK(args[4]->IsString());                            // outputEncoding
+  CHECK(args[5]->IsUint32() || args[5]->IsUndefined());  // outputEncodingId
+
+  const EVP_MD* md = GetDigestImplementation(env, args[0], args[1], args[2]);
+  if (md == nullptr) {
+    Utf8Value method(isolate, args[0]);
+    std::string message =
+        "Digest method " + method.ToString() + " is not supported";
+    return ThrowCryptoError(env, ERR_get_error(), message.c_str());
+  }
+
+  enum encoding output_enc = ParseEncoding(isolate, args[4], args[5], HEX);
+
+  Local<Array> inputs = args[3].As<Array>();
+  uint32_t count = inputs->Length();
+  size_t md_len = EVP_MD_size(md);
+  if (count > std::numeric_limits<size_t>::max() / md_len) {
+    return THROW_ERR_OUT_OF_RANGE(env, "Too many inputs");
+  }
+
+  // All digests go into one buffer, and a single context is reused for all
+  // of them, so that the cost per input is little more than the hashing.
+  std::unique_ptr<BackingStore> store =
+      ArrayBuffer::NewBackingStore(isolate, count * md_len);
+  unsigned char* out = static_cast<unsigned char*>(store->Data());
+  EVPMDCtxPointer ctx(EVP_MD_CTX_new());
+  if (!ctx) return ThrowCryptoError(env, ERR_get_error());
+
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> input;
+    if (!inputs->Get(context, i).ToLocal(&input)) return;
+
+    int success = EVP_DigestInit_ex(ctx.get(), md, nullptr);
+    if (input->IsString()) {
+      Utf8Value utf8(isolate, input);
+      success = success &&
+                EVP_DigestUpdate(ctx.get(), utf8.out(), utf8.length());
+    } else if (IsAnyBufferSource(input)) {
+      ArrayBufferOrViewContents<unsigned char> contents(input);
+      success = success &&
+                EVP_DigestUpdate(ctx.get(), contents.data(), contents.size());
+    } else {
+      return THROW_ERR_INVALID_ARG_TYPE(
+          env,
+          "The \"inputs[%u]\" argument must be of type string or an "
+          "instance of ArrayBuffer or ArrayBufferView",
+          i);
+    }
+    if (!success ||
+        EVP_DigestFinal_ex(ctx.get(), out + i * md_len, nullptr) != 1) {
+      return ThrowCryptoError(env, ERR_get_error());
+    }
+  }
+
+  if (output_enc == BUFFER) {
+    return args.GetReturnValue().Set(
+        ArrayBuffer::New(isolate, std::move(store)));
+  }
+
+  std::vector<Local<Value>> digests(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> error;
+    MaybeLocal<Value> rc =
+        StringBytes::Encode(isolate,
+                            reinterpret_cast<const char*>(out + i * md_len),
+                            md_len,
+                            output_enc,
+                            &error);
+    if (!rc.ToLocal(&digests[i])) {
+      CHECK(!error.IsEmpty());
+      isolate->ThrowException(error);
+      return;
+    }
+  }
+  args.GetReturnValue().Set(Array::New(isolate, digests.data(), count));
+}
+
 void Hash::Initialize(Environment* env, Local<Object> target) {
   Isolate* isolate = env->isolate();
   Local<Context> context = env->context();
@@ -282,8 +376,11 @@ void Hash::Initialize(Environment* env, Local<Object> target) {
   SetMethodNoSideEffect(context, target, "getHashes", GetHashes);
   SetMethodNoSideEffect(context, target, "getCachedAliases", GetCachedAliases);
   SetMethodNoSideEffect(context, target, "oneShotDigest", OneShotDigest);
+  SetMethodNoSideEffect(
+      context, target, "oneShotDigestMany", OneShotDigestMany);
 
   HashJob::Initialize(env, target);
+  HashManyJob::Initialize(env, target);
 
   SetMethodNoSideEffect(
       context, target, "internalVerifyIntegrity", InternalVerifyIntegrity);
@@ -296,8 +393,10 @@ void Hash::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetHashes);
   registry->Register(GetCachedAliases);
   registry->Register(OneShotDigest);
+  registry->Register(OneShotDigestMany);
 
   HashJob::RegisterExternalReferences(registry);
+  HashManyJob::RegisterExternalReferences(registry);
 
   registry->Register(InternalVerifyIntegrity);
 }
@@ -468,7 +567,7 @@ Maybe<bool> HashTraits::AdditionalConfig(
 
   CHECK(args[offset]->IsString());  // Hash algorithm
   Utf8Value digest(env->isolate(), args[offset]);
-  params->digest = EVP_get_digestbyname(*digest);
+  params->digest = GetDigestByName(*digest);
   if (UNLIKELY(params->digest == nullptr)) {
     THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *digest);
     return Nothing<bool>();
@@ -534,6 +633,108 @@ bool HashTraits::DeriveBits(
   return true;
 }
 
+HashManyConfig::HashManyConfig(HashManyConfig&& other) noexcept
+    : mode(other.mode), in(std::move(other.in)), digest(other.digest) {}
+
+HashManyConfig& HashManyConfig::operator=(HashManyConfig&& other) noexcept {
+  if (&other == this) return *this;
+  this->~HashManyConfig();
+  return *new (this) HashManyConfig(std::move(other));
+}
+
+void HashManyConfig::MemoryInfo(MemoryTracker* tracker) const {
+  // If the Job is sync, then the HashManyConfig does not own the data.
+  if (mode == kCryptoJobAsync) {
+    size_t size = 0;
+    for (const ByteSource& input : in) size += input.size();
+    tracker->TrackFieldWithSize("in", size);
+  }
+}
+
+Maybe<bool> HashManyTraits::EncodeOutput(
+    Environment* env,
+    const HashManyConfig& params,
+    ByteSource* out,
+    v8::Local<v8::Value>* result) {
+  *result = out->ToArrayBuffer(env);
+  return Just(!result->IsEmpty());
+}
+
+Maybe<bool> HashManyTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    HashManyConfig* params) {
+  Environment* env = Environment::GetCurrent(args);
+
+  params->mode = mode;
+
+  CHECK(args[offset]->IsString());  // Hash algorithm
+  Utf8Value digest(env->isolate(), args[offset]);
+  params->digest = GetDigestByName(*digest);
+  if (UNLIKELY(params->digest == nullptr)) {
+    THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *digest);
+    return Nothing<bool>();
+  }
+
+  CHECK(args[offset + 1]->IsArray());  // Inputs
+  Local<Array> inputs = args[offset + 1].As<Array>();
+  uint32_t count = inputs->Length();
+  if (count > std::numeric_limits<size_t>::max() /
+                  EVP_MD_size(params->digest)) {
+    THROW_ERR_OUT_OF_RANGE(env, "Too many inputs");
+    return Nothing<bool>();
+  }
+  params->in.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> input;
+    if (!inputs->Get(env->context(), i).ToLocal(&input))
+      return Nothing<bool>();
+    if (input->IsString()) {
+      params->in.emplace_back(
+          ByteSource::FromString(env, input.As<String>()));
+      continue;
+    }
+    if (!IsAnyBufferSource(input)) {
+      THROW_ERR_INVALID_ARG_TYPE(
+          env,
+          "The \"inputs[%u]\" argument must be of type string or an "
+          "instance of ArrayBuffer or ArrayBufferView",
+          i);
+      return Nothing<bool>();
+    }
+    ArrayBufferOrViewContents<char> data(input);
+    params->in.emplace_back(mode == kCryptoJobAsync ? data.ToCopy()
+                                                    : data.ToByteSource());
+  }
+
+  return Just(true);
+}
+
+bool HashManyTraits::DeriveBits(
+    Environment* env,
+    const HashManyConfig& params,
+    ByteSource* out) {
+  EVPMDCtxPointer ctx(EVP_MD_CTX_new());
+  if (UNLIKELY(!ctx)) return false;
+
+  size_t md_len = EVP_MD_size(params.digest);
+  ByteSource::Builder buf(params.in.size() * md_len);
+  unsigned char* digest = buf.data<unsigned char>();
+  for (const ByteSource& input : params.in) {
+    if (UNLIKELY(EVP_DigestInit_ex(ctx.get(), params.digest, nullptr) <= 0 ||
+                 EVP_DigestUpdate(
+                     ctx.get(), input.data<char>(), input.size()) <= 0 ||
+                 EVP_DigestFinal_ex(ctx.get(), digest, nullptr) <= 0)) {
+      return false;
+    }
+    digest += md_len;
+  }
+
+  *out = std::move(buf).release();
+  return true;
+}
+
 void InternalVerifyIntegrity(const v8::FunctionCallbackInfo<v8::Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -548,7 +749,7 @@ void InternalVerifyIntegrity(const v8::FunctionCallbackInfo<v8::Value>& args) {
   CHECK(args[2]->IsArrayBufferView());
   ArrayBufferOrViewContents<unsigned char> expected(args[2]);
 
-  const EVP_MD* md_type = EVP_get_digestbyname(*algorithm);
+  const EVP_MD* md_type = GetDigestByName(*algorithm);
   unsigned char digest[EVP_MAX_MD_SIZE];
   unsigned int digest_size;
   if (md_type == nullptr || EVP_Digest(content.data(),
@@ -27,6 +27,8 @@ class Hash final : public BaseObject {
   static void GetHashes(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetCachedAliases(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void OneShotDigest(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void OneShotDigestMany(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -84,6 +86,50 @@ struct HashTraits final {
 
 using HashJob = DeriveBitsJob<HashTraits>;
 
+struct HashManyConfig final : public MemoryRetainer {
+  CryptoJobMode mode;
+  std::vector<ByteSource> in;
+  const EVP_MD* digest;
+
+  HashManyConfig() = default;
+
+  explicit HashManyConfig(HashManyConfig&& other) noexcept;
+
+  HashManyConfig& operator=(HashManyConfig&& other) noexcept;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(HashManyConfig)
+  SET_SELF_SIZE(HashManyConfig)
+};
+
+// Hashes a list of inputs with the same algorithm. The digests are written
+// one after another into a single ArrayBuffer.
+struct HashManyTraits final {
+  using AdditionalParameters = HashManyConfig;
+  static constexpr const char* JobName = "HashManyJob";
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_HASHREQUEST;
+
+  static v8::Maybe<bool> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      HashManyConfig* params);
+
+  static bool DeriveBits(
+      Environment* env,
+      const HashManyConfig& params,
+      ByteSource* out);
+
+  static v8::Maybe<bool> EncodeOutput(
+      Environment* env,
+      const HashManyConfig& params,
+      ByteSource* out,
+      v8::Local<v8::Value>* result);
+};
+
+using HashManyJob = DeriveBitsJob<HashManyTraits>;
+
 void InternalVerifyIntegrity(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 }  // namespace crypto
@@ -85,6 +85,10 @@ struct HmacTraits final {
       v8::Local<v8::Value>* result);
 };
 
+inline bool IsInlineCryptoJob(const HmacConfig& params) {
+  return params.data.size() <= kCryptoJobInlineLimit;
+}
+
 using HmacJob = DeriveBitsJob<HmacTraits>;
 
 }  // namespace crypto
@@ -4,7 +4,9 @@
 #include "debug_utils-inl.h"
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
+#include "node_external_reference.h"
 #include "threadpoolwork-inl.h"
+#include "util-inl.h"
 #include "v8.h"
 
 #include <cmath>
@@ -21,6 +23,149 @@ using v8::Uint32;
 using v8::Value;
 
 namespace crypto {
+KeyPool::~KeyPool() {
+  {
+    Mutex::ScopedLock lock(mutex_);
+    if (!started_) return;
+    stopping_ = true;
+    wake_.Signal(lock);
+  }
+  CHECK_EQ(uv_thread_join(&thread_), 0);
+}
+
+KeyPool* KeyPool::GetInstance() {
+  // Leaked on purpose, the thread may still be generating a key on exit.
+  static KeyPool* pool = new KeyPool();
+  return pool;
+}
+
+EVPKeyPointer KeyPool::Take(const std::string& id,
+                            const std::function<EVPKeyCtxPointer()>& setup) {
+  {
+    Mutex::ScopedLock lock(mutex_);
+    if (size_ == 0) return EVPKeyPointer();
+    auto it = pools_.find(id);
+    if (it != pools_.end()) {
+      Pool& pool = it->second;
+      if (pool.keys.empty()) return EVPKeyPointer();
+      EVPKeyPointer pkey = std::move(pool.keys.front());
+      pool.keys.pop_front();
+      wake_.Signal(lock);
+      return pkey;
+    }
+    if (pools_.size() >= kMaxPools) return EVPKeyPointer();
+  }
+
+  // The pool gets a context of its own, because the context of the job
+  // cannot be used by two threads at the same time.
+  EVPKeyCtxPointer ctx = setup();
+  if (!ctx) return EVPKeyPointer();
+
+  Mutex::ScopedLock lock(mutex_);
+  if (pools_.size() >= kMaxPools || pools_.count(id) != 0)
+    return EVPKeyPointer();
+  pools_[id].ctx = std::move(ctx);
+  if (!started_) {
+    if (uv_thread_create(&thread_, ThreadMain, this) != 0) {
+      pools_.clear();
+      return EVPKeyPointer();
+    }
+    started_ = true;
+  }
+  wake_.Signal(lock);
+  return EVPKeyPointer();
+}
+
+void KeyPool::SetSize(size_t size) {
+  Mutex::ScopedLock lock(mutex_);
+  size_ = size;
+  for (auto& entry : pools_) {
+    std::deque<EVPKeyPointer>& keys = entry.second.keys;
+    if (keys.size() > size) keys.resize(size);
+  }
+  wake_.Signal(lock);
+}
+
+size_t KeyPool::size() {
+  Mutex::ScopedLock lock(mutex_);
+  return size_;
+}
+
+size_t KeyPool::available(const std::string& id) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = pools_.find(id);
+  return it == pools_.end() ? 0 : it->second.keys.size();
+}
+
+KeyPool::Pool* KeyPool::NextPoolToFill() {
+  // Fill the emptiest pool first.
+  Pool* next = nullptr;
+  for (auto& entry : pools_) {
+    Pool& pool = entry.second;
+    if (!pool.ctx || pool.keys.size() >= size_) continue;
+    if (next == nullptr || pool.keys.size() < next->keys.size())
+      next = &pool;
+  }
+  return next;
+}
+
+void KeyPool::ThreadMain(void* data) {
+  KeyPool* key_pool = static_cast<KeyPool*>(data);
+  // Key generation is CPU-bound, so stay out of the way of everything else.
+  // This may fail without privileges, which only makes refilling more
+  // intrusive.
+  uv_thread_setpriority(uv_thread_self(), UV_THREAD_PRIORITY_LOWEST);
+
+  Mutex::ScopedLock lock(key_pool->mutex_);
+  while (!key_pool->stopping_) {
+    Pool* pool = key_pool->NextPoolToFill();
+    if (pool == nullptr) {
+      key_pool->wake_.Wait(lock);
+      continue;
+    }
+
+    EVP_PKEY* pkey = nullptr;
+    bool ok;
+    {
+      Mutex::ScopedUnlock unlock(lock);
+      ClearErrorOnReturn clear_error_on_return;
+      ok = EVP_PKEY_keygen(pool->ctx.get(), &pkey) == 1;
+    }
+    EVPKeyPointer key(pkey);
+    if (!ok) {
+      pool->ctx.reset();
+    } else if (pool->keys.size() < key_pool->size_) {
+      pool->keys.push_back(std::move(key));
+    }
+  }
+}
+
+std::string GetKeyPoolId(const char* job_name,
+                         const FunctionCallbackInfo<Value>& args,
+                         unsigned int start,
+                         unsigned int end) {
+  std::string id = job_name;
+  for (unsigned int i = start; i < end; i++) {
+    Local<Value> arg = args[i];
+    if (arg->IsUndefined()) {
+      id += ":u";
+    } else if (arg->IsInt32()) {
+      id += SPrintF(":i%d", arg.As<Int32>()->Value());
+    } else if (arg->IsUint32()) {
+      id += SPrintF(":i%u", arg.As<Uint32>()->Value());
+    } else if (arg->IsString()) {
+      Utf8Value value(args.GetIsolate(), arg);
+      id += SPrintF(":s%zu:", value.length());
+      id.append(*value, value.length());
+    } else {
+      // Keys generated from buffers or objects, such as a DH prime, are
+      // not pooled.
+      return std::string();
+    }
+  }
+  return id;
+}
+
 // NidKeyPairGenJob input arguments:
 //   1. CryptoJobMode
 //   2. NID
@@ -30,6 +175,7 @@ namespace crypto {
 //   6. Private Type
 //   7. Cipher
 //   8. Passphrase
+//   9. Use the KeyPool (optional)
 Maybe<bool> NidKeyPairGenTraits::AdditionalConfig(
     CryptoJobMode mode,
     const FunctionCallbackInfo<Value>& args,
@@ -86,14 +232,23 @@ Maybe<bool> SecretKeyGenTraits::EncodeKey(Environment* env,
 }
 
 namespace Keygen {
+namespace {
+void SetKeyPoolSize(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  KeyPool::GetInstance()->SetSize(args[0].As<Uint32>()->Value());
+}
+}  // anonymous namespace
+
 void Initialize(Environment* env, Local<Object> target) {
   NidKeyPairGenJob::Initialize(env, target);
   SecretKeyGenJob::Initialize(env, target);
+  SetMethod(env->context(), target, "setKeyPoolSize", SetKeyPoolSize);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   NidKeyPairGenJob::RegisterExternalReferences(registry);
   SecretKeyGenJob::RegisterExternalReferences(registry);
+  registry->Register(SetKeyPoolSize);
 }
 
 }  // namespace Keygen
@@ -9,8 +9,14 @@
 #include "crypto/crypto_util.h"
 #include "env.h"
 #include "memory_tracker.h"
+#include "node_mutex.h"
 #include "v8.h"
 
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
 namespace node {
 namespace crypto {
 namespace Keygen {
@@ -23,6 +29,68 @@ enum class KeyGenJobStatus {
   FAILED
 };
 
+// Keeps up to size() pre-generated key pairs for every set of key
+// generation parameters that has been asked for, so that jobs which opt in
+// can be given a key without waiting for it to be generated. The pools are
+// refilled by a single background thread that runs at the lowest priority,
+// so that it mostly uses otherwise idle CPU time. Every key is handed out
+// at most once.
+class KeyPool final {
+ public:
+  static constexpr size_t kDefaultSize = 4;
+  // The number of distinct parameter sets that are pooled.
+  static constexpr size_t kMaxPools = 32;
+
+  KeyPool() = default;
+  ~KeyPool();
+  KeyPool(const KeyPool&) = delete;
+  KeyPool& operator=(const KeyPool&) = delete;
+
+  static KeyPool* GetInstance();
+
+  // Returns a pre-generated key for the parameters identified by `id`, or
+  // an empty pointer if there is none yet. If there is no pool for `id`,
+  // `setup` is called to create the context the pool generates keys with.
+  EVPKeyPointer Take(const std::string& id,
+                     const std::function<EVPKeyCtxPointer()>& setup);
+
+  // Changes the number of keys kept per pool. 0 disables pooling and drops
+  // the keys that have already been generated.
+  void SetSize(size_t size);
+  size_t size();
+  size_t available(const std::string& id);
+
+ private:
+  struct Pool {
+    // Only used by the background thread once the pool has been created.
+    // Reset if generating a key fails, so that the pool stops refilling.
+    EVPKeyCtxPointer ctx;
+    std::deque<EVPKeyPointer> keys;
+  };
+
+  static void ThreadMain(void* data);
+  // Returns a pool that is missing keys, or nullptr. Called with mutex_
+  // held.
+  Pool* NextPoolToFill();
+
+  Mutex mutex_;
+  ConditionVariable wake_;
+  // Pools are never removed, so pointers to them remain valid.
+  std::unordered_map<std::string, Pool> pools_;
+  size_t size_ = kDefaultSize;
+  bool started_ = false;
+  bool stopping_ = false;
+  uv_thread_t thread_;
+};
+
+// Returns the id of the key pool for the key generation arguments
+// args[start] ... args[end - 1] of the job `job_name`, or an empty string if
+// the arguments cannot be pooled.
+std::string GetKeyPoolId(const char* job_name,
+                         const v8::FunctionCallbackInfo<v8::Value>& args,
+                         unsigned int start,
+                         unsigned int end);
+
 // A Base CryptoJob for generating secret keys or key pairs.
 // The KeyGenTraits is largely responsible for the details of
 // the implementation, while KeyGenJob handles the common
@@ -139,10 +207,12 @@ struct KeyPairGenTraits final {
     // functions will update the value of the offset as they successfully
     // process input parameters. This allows each job to have a variable
     // number of input parameters specific to each job type.
+    unsigned int start = *offset;
     if (KeyPairAlgorithmTraits::AdditionalConfig(mode, args, offset, params)
             .IsNothing()) {
       return v8::Just(false);
     }
+    unsigned int end = *offset;
 
     params->public_key_encoding = ManagedEVPPKey::GetPublicKeyEncodingFromJs(
         args,
@@ -158,12 +228,32 @@ struct KeyPairGenTraits final {
     if (!private_key_encoding.IsEmpty())
       params->private_key_encoding = private_key_encoding.Release();
 
+    // An optional last argument asks for a key from the KeyPool. Pooling is
+    // limited to algorithms whose keys do not depend on generated domain
+    // parameters, which would otherwise be shared by all keys of a pool.
+    if constexpr (KeyPairAlgorithmTraits::kPoolable) {
+      if (args[*offset]->IsTrue()) {
+        params->pool_id = GetKeyPoolId(
+            KeyPairAlgorithmTraits::JobName, args, start, end);
+      }
+    }
+
     return v8::Just(true);
   }
 
   static KeyGenJobStatus DoKeyGen(
       Environment* env,
       AdditionalParameters* params) {
+    if (!params->pool_id.empty()) {
+      EVPKeyPointer pkey = KeyPool::GetInstance()->Take(
+          params->pool_id,
+          [params]() { return KeyPairAlgorithmTraits::Setup(params); });
+      if (pkey) {
+        params->key = ManagedEVPPKey(std::move(pkey));
+        return KeyGenJobStatus::OK;
+      }
+    }
+
     EVPKeyCtxPointer ctx = KeyPairAlgorithmTraits::Setup(params);
 
     if (!ctx)
@@ -233,6 +323,8 @@ struct KeyPairGenConfig final : public MemoryRetainer {
   PrivateKeyEncodingConfig private_key_encoding;
   ManagedEVPPKey key;
   AlgorithmParams params;
+  // Set if the key should be taken from the KeyPool.
+  std::string pool_id;
 
   KeyPairGenConfig() = default;
   ~KeyPairGenConfig() {
@@ -245,7 +337,8 @@ struct KeyPairGenConfig final : public MemoryRetainer {
             std::forward<PrivateKeyEncodingConfig>(
                 other.private_key_encoding)),
         key(std::move(other.key)),
-        params(std::move(other.params)) {}
+        params(std::move(other.params)),
+        pool_id(std::move(other.pool_id)) {}
 
   KeyPairGenConfig& operator=(KeyPairGenConfig&& other) noexcept {
     if (&other == this) return *this;
@@ -278,6 +371,7 @@ using NidKeyPairGenConfig = KeyPairGenConfig<NidKeyPairParams>;
 struct NidKeyPairGenTraits final {
   using AdditionalParameters = NidKeyPairGenConfig;
   static constexpr const char* JobName = "NidKeyPairGenJob";
+  static constexpr bool kPoolable = true;
 
   static EVPKeyCtxPointer Setup(NidKeyPairGenConfig* params);
 
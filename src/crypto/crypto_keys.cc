@@ -16,6 +16,8 @@
 #include "util-inl.h"
 #include "v8.h"
 
+#include <algorithm>
+
 namespace node {
 
 using v8::Array;
@@ -686,7 +688,7 @@ ManagedEVPPKey::GetPrivateKeyEncodingFromJs(
     if (context != kKeyContextInput) {
       if (args[*offset]->IsString()) {
         Utf8Value cipher_name(env->isolate(), args[*offset]);
-        result.cipher_ = EVP_get_cipherbyname(*cipher_name);
+        result.cipher_ = GetCipherByName(*cipher_name);
         if (result.cipher_ == nullptr) {
           THROW_ERR_CRYPTO_UNKNOWN_CIPHER(env);
           return NonCopyableMaybe<PrivateKeyEncodingConfig>();
@@ -846,9 +848,15 @@ KeyObjectData::KeyObjectData(KeyType type, const ManagedEVPPKey& pkey)
 
 void KeyObjectData::MemoryInfo(MemoryTracker* tracker) const {
   switch (GetKeyType()) {
-    case kKeyTypeSecret:
+    case kKeyTypeSecret: {
       tracker->TrackFieldWithSize("symmetric_key", symmetric_key_.size());
+      Mutex::ScopedLock lock(prepared_mutex_);
+      tracker->TrackFieldWithSize(
+          "prepared_contexts",
+          prepared_hmacs_.size() * kSizeOf_HMAC_CTX +
+              prepared_ciphers_.size() * kSizeOf_EVP_CIPHER_CTX);
       break;
+    }
     case kKeyTypePrivate:
       // Fall through
     case kKeyTypePublic:
@@ -889,6 +897,92 @@ size_t KeyObjectData::GetSymmetricKeySize() const {
   return symmetric_key_.size();
 }
 
+HMACCtxPointer KeyObjectData::NewHMACContext(const EVP_MD* md) const {
+  CHECK_EQ(key_type_, kKeyTypeSecret);
+  HMACCtxPointer ctx(HMAC_CTX_new());
+  if (!ctx) return ctx;
+
+  {
+    Mutex::ScopedLock lock(prepared_mutex_);
+    for (const auto& [prepared_md, prepared] : prepared_hmacs_) {
+      if (prepared_md != md) continue;
+      if (!HMAC_CTX_copy(ctx.get(), prepared.get())) return HMACCtxPointer();
+      return ctx;
+    }
+  }
+
+  if (!HMAC_Init_ex(ctx.get(),
+                    symmetric_key_.data<char>(),
+                    symmetric_key_.size(),
+                    md,
+                    nullptr)) {
+    return HMACCtxPointer();
+  }
+
+  HMACCtxPointer prepared(HMAC_CTX_new());
+  if (prepared && HMAC_CTX_copy(prepared.get(), ctx.get())) {
+    Mutex::ScopedLock lock(prepared_mutex_);
+    bool exists = std::any_of(
+        prepared_hmacs_.begin(),
+        prepared_hmacs_.end(),
+        [md](const auto& entry) { return entry.first == md; });
+    if (!exists && prepared_hmacs_.size() < kMaxPreparedContexts)
+      prepared_hmacs_.emplace_back(md, std::move(prepared));
+  }
+  return ctx;
+}
+
+CipherCtxPointer KeyObjectData::NewCipherContext(const EVP_CIPHER* cipher,
+                                                 bool encrypt,
+                                                 size_t iv_length) const {
+  CHECK_EQ(key_type_, kKeyTypeSecret);
+  const bool gcm = EVP_CIPHER_mode(cipher) == EVP_CIPH_GCM_MODE;
+  if (!gcm) iv_length = 0;
+  auto matches = [&](const PreparedCipher& prepared) {
+    return prepared.cipher == cipher && prepared.encrypt == encrypt &&
+           prepared.iv_length == iv_length;
+  };
+
+  CipherCtxPointer ctx(EVP_CIPHER_CTX_new());
+  if (!ctx) return ctx;
+
+  {
+    Mutex::ScopedLock lock(prepared_mutex_);
+    for (const PreparedCipher& prepared : prepared_ciphers_) {
+      if (!matches(prepared)) continue;
+      if (!EVP_CIPHER_CTX_copy(ctx.get(), prepared.ctx.get()))
+        return CipherCtxPointer();
+      return ctx;
+    }
+  }
+
+  if (!EVP_CipherInit_ex(
+          ctx.get(), cipher, nullptr, nullptr, nullptr, encrypt) ||
+      (gcm && !EVP_CIPHER_CTX_ctrl(
+                  ctx.get(), EVP_CTRL_AEAD_SET_IVLEN, iv_length, nullptr)) ||
+      !EVP_CIPHER_CTX_set_key_length(ctx.get(), symmetric_key_.size()) ||
+      !EVP_CipherInit_ex(ctx.get(),
+                         nullptr,
+                         nullptr,
+                         symmetric_key_.data<unsigned char>(),
+                         nullptr,
+                         encrypt)) {
+    return CipherCtxPointer();
+  }
+
+  CipherCtxPointer prepared(EVP_CIPHER_CTX_new());
+  if (prepared && EVP_CIPHER_CTX_copy(prepared.get(), ctx.get())) {
+    Mutex::ScopedLock lock(prepared_mutex_);
+    bool exists = std::any_of(
+        prepared_ciphers_.begin(), prepared_ciphers_.end(), matches);
+    if (!exists && prepared_ciphers_.size() < kMaxPreparedContexts) {
+      prepared_ciphers_.push_back(
+          PreparedCipher{cipher, encrypt, iv_length, std::move(prepared)});
+    }
+  }
+  return ctx;
+}
+
 bool KeyObjectHandle::HasInstance(Environment* env, Local<Value> value) {
   Local<FunctionTemplate> t = env->crypto_key_object_handle_constructor();
   return !t.IsEmpty() && t->HasInstance(value);
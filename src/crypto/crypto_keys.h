@@ -8,6 +8,7 @@
 #include "env.h"
 #include "memory_tracker.h"
 #include "node_buffer.h"
+#include "node_mutex.h"
 #include "node_worker.h"
 #include "v8.h"
 
@@ -15,6 +16,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace node {
 namespace crypto {
@@ -145,6 +147,16 @@ class KeyObjectData : public MemoryRetainer {
   const char* GetSymmetricKey() const;
   size_t GetSymmetricKeySize() const;
 
+  // Return new contexts that are set up with the symmetric key. The first
+  // context for a digest or cipher is kept, and later ones are copied from
+  // it instead of processing the key again, so repeated operations with the
+  // same key skip the key setup. For GCM, |iv_length| is set before the key.
+  // Return nullptr on failure.
+  HMACCtxPointer NewHMACContext(const EVP_MD* md) const;
+  CipherCtxPointer NewCipherContext(const EVP_CIPHER* cipher,
+                                    bool encrypt,
+                                    size_t iv_length) const;
+
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_MEMORY_INFO_NAME(KeyObjectData)
   SET_SELF_SIZE(KeyObjectData)
@@ -156,9 +168,27 @@ class KeyObjectData : public MemoryRetainer {
       KeyType type,
       const ManagedEVPPKey& pkey);
 
+  // The number of prepared contexts of each kind that are kept per key.
+  static constexpr size_t kMaxPreparedContexts = 4;
+
+  struct PreparedCipher {
+    const EVP_CIPHER* cipher;
+    bool encrypt;
+    size_t iv_length;
+    CipherCtxPointer ctx;
+  };
+
   const KeyType key_type_;
   const ByteSource symmetric_key_;
   const ManagedEVPPKey asymmetric_key_;
+
+  // The digests and ciphers are the ones returned by GetDigestByName() and
+  // GetCipherByName(), which are never freed, so they cannot be mistaken
+  // for other ones that reuse their address.
+  mutable Mutex prepared_mutex_;
+  mutable std::vector<std::pair<const EVP_MD*, HMACCtxPointer>>
+      prepared_hmacs_;
+  mutable std::vector<PreparedCipher> prepared_ciphers_;
 };
 
 class KeyObjectHandle : public BaseObject {
@@ -9,9 +9,11 @@
 
 namespace node {
 
+using v8::Array;
 using v8::FunctionCallbackInfo;
 using v8::Int32;
 using v8::Just;
+using v8::Local;
 using v8::Maybe;
 using v8::Nothing;
 using v8::Value;
@@ -102,7 +104,7 @@ Maybe<bool> PBKDF2Traits::AdditionalConfig(
   }
 
   Utf8Value name(args.GetIsolate(), args[offset + 4]);
-  params->digest = EVP_get_digestbyname(*name);
+  params->digest = GetDigestByName(*name);
   if (params->digest == nullptr) {
     THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *name);
     return Nothing<bool>();
@@ -135,5 +137,151 @@ bool PBKDF2Traits::DeriveBits(
   return true;
 }
 
+PBKDF2BatchConfig::PBKDF2BatchConfig(PBKDF2BatchConfig&& other) noexcept
+    : mode(other.mode),
+      passes(std::move(other.passes)),
+      salts(std::move(other.salts)),
+      iterations(other.iterations),
+      length(other.length),
+      digest(other.digest) {}
+
+PBKDF2BatchConfig& PBKDF2BatchConfig::operator=(
+    PBKDF2BatchConfig&& other) noexcept {
+  if (&other == this) return *this;
+  this->~PBKDF2BatchConfig();
+  return *new (this) PBKDF2BatchConfig(std::move(other));
+}
+
+void PBKDF2BatchConfig::MemoryInfo(MemoryTracker* tracker) const {
+  size_t size = 0;
+  for (const ByteSource& pass : passes) size += pass.size();
+  for (const ByteSource& salt : salts) size += salt.size();
+  tracker->TrackFieldWithSize("inputs", size);
+}
+
+Maybe<bool> PBKDF2BatchTraits::EncodeOutput(
+    Environment* env,
+    const PBKDF2BatchConfig& params,
+    ByteSource* out,
+    v8::Local<v8::Value>* result) {
+  *result = out->ToArrayBuffer(env);
+  return Just(!result->IsEmpty());
+}
+
+// The input arguments for the job are:
+//   1. CryptoJobMode
+//   2. An array of passwords
+//   3. An array of salts, one for every password
+//   4. The number of iterations
+//   5. The number of bytes to generate for every password
+//   6. The digest algorithm name
+Maybe<bool> PBKDF2BatchTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    PBKDF2BatchConfig* params) {
+  Environment* env = Environment::GetCurrent(args);
+
+  params->mode = mode;
+
+  CHECK(args[offset]->IsArray());  // passes
+  CHECK(args[offset + 1]->IsArray());  // salts
+  CHECK(args[offset + 2]->IsInt32());  // iteration_count
+  CHECK(args[offset + 3]->IsInt32());  // length
+  CHECK(args[offset + 4]->IsString());  // digest_name
+
+  Local<Array> passes = args[offset].As<Array>();
+  Local<Array> salts = args[offset + 1].As<Array>();
+  if (passes->Length() != salts->Length()) {
+    THROW_ERR_INVALID_ARG_VALUE(
+        env, "passes and salts must have the same length");
+    return Nothing<bool>();
+  }
+
+  // The inputs are always copied, even for sync jobs, because the array
+  // elements are not kept alive by anything else while the keys are
+  // derived.
+  params->passes.reserve(passes->Length());
+  params->salts.reserve(salts->Length());
+  for (uint32_t i = 0; i < passes->Length(); i++) {
+    Local<Value> pass_value;
+    Local<Value> salt_value;
+    if (!passes->Get(env->context(), i).ToLocal(&pass_value) ||
+        !salts->Get(env->context(), i).ToLocal(&salt_value)) {
+      return Nothing<bool>();
+    }
+    if (!IsAnyBufferSource(pass_value) || !IsAnyBufferSource(salt_value)) {
+      THROW_ERR_INVALID_ARG_TYPE(
+          env, "passes and salts must only contain buffers");
+      return Nothing<bool>();
+    }
+
+    ArrayBufferOrViewContents<char> pass(pass_value);
+    ArrayBufferOrViewContents<char> salt(salt_value);
+    if (UNLIKELY(!pass.CheckSizeInt32())) {
+      THROW_ERR_OUT_OF_RANGE(env, "pass is too large");
+      return Nothing<bool>();
+    }
+    if (UNLIKELY(!salt.CheckSizeInt32())) {
+      THROW_ERR_OUT_OF_RANGE(env, "salt is too large");
+      return Nothing<bool>();
+    }
+    params->passes.push_back(pass.ToCopy());
+    params->salts.push_back(salt.ToCopy());
+  }
+
+  params->iterations = args[offset + 2].As<Int32>()->Value();
+  if (params->iterations < 0) {
+    THROW_ERR_OUT_OF_RANGE(env, "iterations must be <= %d", INT_MAX);
+    return Nothing<bool>();
+  }
+
+  params->length = args[offset + 3].As<Int32>()->Value();
+  if (params->length < 0) {
+    THROW_ERR_OUT_OF_RANGE(env, "length must be <= %d", INT_MAX);
+    return Nothing<bool>();
+  }
+  if (params->passes.size() > 0 &&
+      static_cast<size_t>(params->length) >
+          Buffer::kMaxLength / params->passes.size()) {
+    THROW_ERR_OUT_OF_RANGE(env, "The total length is too large");
+    return Nothing<bool>();
+  }
+
+  Utf8Value name(args.GetIsolate(), args[offset + 4]);
+  params->digest = GetDigestByName(*name);
+  if (params->digest == nullptr) {
+    THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *name);
+    return Nothing<bool>();
+  }
+
+  return Just(true);
+}
+
+bool PBKDF2BatchTraits::DeriveBits(
+    Environment* env,
+    const PBKDF2BatchConfig& params,
+    ByteSource* out) {
+  const size_t length = params.length;
+  ByteSource::Builder buf(params.passes.size() * length);
+
+  for (size_t i = 0; i < params.passes.size(); i++) {
+    const ByteSource& pass = params.passes[i];
+    const ByteSource& salt = params.salts[i];
+    if (PKCS5_PBKDF2_HMAC(pass.data<char>(),
+                          pass.size(),
+                          salt.data<unsigned char>(),
+                          salt.size(),
+                          params.iterations,
+                          params.digest,
+                          params.length,
+                          buf.data<unsigned char>() + i * length) <= 0) {
+      return false;
+    }
+  }
+  *out = std::move(buf).release();
+  return true;
+}
+
 }  // namespace crypto
 }  // namespace node
@@ -69,6 +69,56 @@ struct PBKDF2Traits final {
 
 using PBKDF2Job = DeriveBitsJob<PBKDF2Traits>;
 
+// Derives one key for every pass and salt pair with the same iterations,
+// length and digest, as a single job. The keys are returned back to back in
+// one ArrayBuffer, which saves the cost of scheduling and completing one job
+// per key when many passwords are checked at the same time. A batch that is
+// to be derived by several threads at once is split into several jobs.
+struct PBKDF2BatchConfig final : public MemoryRetainer {
+  CryptoJobMode mode;
+  std::vector<ByteSource> passes;
+  std::vector<ByteSource> salts;
+  int32_t iterations;
+  int32_t length;
+  const EVP_MD* digest = nullptr;
+
+  PBKDF2BatchConfig() = default;
+
+  explicit PBKDF2BatchConfig(PBKDF2BatchConfig&& other) noexcept;
+
+  PBKDF2BatchConfig& operator=(PBKDF2BatchConfig&& other) noexcept;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(PBKDF2BatchConfig)
+  SET_SELF_SIZE(PBKDF2BatchConfig)
+};
+
+struct PBKDF2BatchTraits final {
+  using AdditionalParameters = PBKDF2BatchConfig;
+  static constexpr const char* JobName = "PBKDF2BatchJob";
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_PBKDF2REQUEST;
+
+  static v8::Maybe<bool> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      PBKDF2BatchConfig* params);
+
+  static bool DeriveBits(
+      Environment* env,
+      const PBKDF2BatchConfig& params,
+      ByteSource* out);
+
+  static v8::Maybe<bool> EncodeOutput(
+      Environment* env,
+      const PBKDF2BatchConfig& params,
+      ByteSource* out,
+      v8::Local<v8::Value>* result);
+};
+
+using PBKDF2BatchJob = DeriveBitsJob<PBKDF2BatchTraits>;
+
 }  // namespace crypto
 }  // namespace node
 
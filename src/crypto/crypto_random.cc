@@ -60,7 +60,7 @@ bool RandomBytesTraits::DeriveBits(
     Environment* env,
     const RandomBytesConfig& params,
     ByteSource* unused) {
-  return CSPRNG(params.buffer, params.size).is_ok();
+  return PooledCSPRNG(params.buffer, params.size).is_ok();
 }
 
 void RandomPrimeConfig::MemoryInfo(MemoryTracker* tracker) const {
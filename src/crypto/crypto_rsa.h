@@ -40,6 +40,7 @@ using RsaKeyPairGenConfig = KeyPairGenConfig<RsaKeyPairParams>;
 struct RsaKeyGenTraits final {
   using AdditionalParameters = RsaKeyPairGenConfig;
   static constexpr const char* JobName = "RsaKeyPairGenJob";
+  static constexpr bool kPoolable = true;
 
   static EVPKeyCtxPointer Setup(RsaKeyPairGenConfig* params);
 
@@ -94,6 +95,8 @@ struct RSACipherConfig final : public MemoryRetainer {
 
 struct RSACipherTraits final {
   static constexpr const char* JobName = "RSACipherJob";
+  // The cost of RSA does not depend much on the size of the input.
+  static constexpr bool kRunsInline = false;
   using AdditionalParameters = RSACipherConfig;
 
   static v8::Maybe<bool> AdditionalConfig(
@@ -0,0 +1,242 @@
+#include "crypto/crypto_session_cache.h"
+#include "node_mutex.h"
+#include "util.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+namespace crypto {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "Slot locks must work across processes");
+
+// The first page of a shared mapping. The slots start at the second page.
+struct TLSSessionCache::Header {
+  static constexpr uint64_t kMagic = 0x3165686361637374;  // "tscache1"
+
+  uint64_t magic;
+  uint32_t slot_size;
+  uint32_t slot_count;
+};
+
+namespace {
+
+uint64_t HashKey(const TLSSessionCache::Key& key) {
+  // FNV-1a. Session ids are random, so this only has to mix the bytes.
+  uint64_t hash = 0xcbf29ce484222325;
+  for (size_t i = 0; i < key.length; i++) {
+    hash ^= key.data[i];
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+}  // anonymous namespace
+
+bool TLSSessionCache::MakeKey(const unsigned char* context,
+                              size_t context_length,
+                              const unsigned char* id,
+                              size_t id_length,
+                              Key* key) {
+  // The length byte keeps (context, id) pairs with the same concatenation
+  // apart.
+  if (context_length > 32 || 1 + context_length + id_length > kMaxKeyLength)
+    return false;
+  key->data[0] = static_cast<unsigned char>(context_length);
+  if (context_length > 0) memcpy(key->data + 1, context, context_length);
+  if (id_length > 0) memcpy(key->data + 1 + context_length, id, id_length);
+  key->length = 1 + context_length + id_length;
+  return true;
+}
+
+TLSSessionCache* TLSSessionCache::GetProcessCache() {
+  // Intentionally leaked, so that it outlives every thread that uses it.
+  static TLSSessionCache* cache = new TLSSessionCache(kDefaultSlotCount);
+  return cache;
+}
+
+TLSSessionCache* TLSSessionCache::GetSharedCache(const std::string& path,
+                                                 int* error) {
+  static Mutex mutex;
+  static auto* caches =
+      new std::unordered_map<std::string, std::unique_ptr<TLSSessionCache>>();
+
+  Mutex::ScopedLock lock(mutex);
+  auto it = caches->find(path);
+  if (it != caches->end()) return it->second.get();
+
+  std::unique_ptr<TLSSessionCache> cache =
+      MapFile(path, kDefaultSlotCount, error);
+  if (!cache) return nullptr;
+  return caches->emplace(path, std::move(cache)).first->second.get();
+}
+
+TLSSessionCache::TLSSessionCache(uint32_t slot_count)
+    : slots_(nullptr),
+      slot_count_(slot_count),
+      owned_slots_(new Slot[slot_count]) {
+  CHECK_GT(slot_count, 0);
+  slots_ = owned_slots_.get();
+}
+
+TLSSessionCache::TLSSessionCache(Slot* slots, uint32_t slot_count)
+    : slots_(slots), slot_count_(slot_count) {}
+
+std::unique_ptr<TLSSessionCache> TLSSessionCache::MapFile(
+    const std::string& path, uint32_t slot_count, int* error) {
+  CHECK_GT(slot_count, 0);
+#ifdef _WIN32
+  *error = ENOSYS;
+  return nullptr;
+#else
+  static_assert(sizeof(Header) <= kSlotSize);
+  static_assert(sizeof(Slot) == kSlotSize);
+  const size_t size = kSlotSize * (size_t{slot_count} + 1);
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd == -1) {
+    *error = errno;
+    return nullptr;
+  }
+  // Only one process gets to set up a new file, and no process looks at the
+  // header before that is done. The lock has to be dropped explicitly,
+  // because the mapping keeps the open file alive after `fd` is closed.
+  auto close_fd = OnScopeLeave([&]() {
+    flock(fd, LOCK_UN);
+    close(fd);
+  });
+  int err;
+  do {
+    err = flock(fd, LOCK_EX);
+  } while (err == -1 && errno == EINTR);
+  struct stat st;
+  if (err == -1 || fstat(fd, &st) == -1) {
+    *error = errno;
+    return nullptr;
+  }
+
+  const bool initialize = st.st_size == 0;
+  if (initialize) {
+    if (ftruncate(fd, size) == -1) {
+      *error = errno;
+      return nullptr;
+    }
+  } else if (static_cast<size_t>(st.st_size) != size) {
+    *error = EINVAL;
+    return nullptr;
+  }
+
+  void* mapping =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    *error = errno;
+    return nullptr;
+  }
+
+  Header* header = static_cast<Header*>(mapping);
+  Slot* slots = reinterpret_cast<Slot*>(static_cast<char*>(mapping) +
+                                        kSlotSize);
+  if (initialize) {
+    for (uint32_t i = 0; i < slot_count; i++) new (&slots[i]) Slot();
+    header->slot_size = kSlotSize;
+    header->slot_count = slot_count;
+    header->magic = Header::kMagic;
+  } else if (header->magic != Header::kMagic ||
+             header->slot_size != kSlotSize ||
+             header->slot_count != slot_count) {
+    munmap(mapping, size);
+    *error = EINVAL;
+    return nullptr;
+  }
+
+  std::unique_ptr<TLSSessionCache> cache(
+      new TLSSessionCache(slots, slot_count));
+  cache->mapping_ = mapping;
+  cache->mapping_size_ = size;
+  return cache;
+#endif  // _WIN32
+}
+
+TLSSessionCache::~TLSSessionCache() {
+#ifndef _WIN32
+  if (mapping_ != nullptr) munmap(mapping_, mapping_size_);
+#endif
+}
+
+TLSSessionCache::Slot* TLSSessionCache::TryLockSlot(const Key& key) {
+  Slot* slot = &slots_[HashKey(key) % slot_count_];
+  uint32_t expected = 0;
+  if (!slot->lock.compare_exchange_strong(
+          expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return slot;
+}
+
+void TLSSessionCache::UnlockSlot(Slot* slot) {
+  slot->lock.store(0, std::memory_order_release);
+}
+
+bool TLSSessionCache::Store(const Key& key,
+                            const unsigned char* data,
+                            size_t data_length,
+                            uint64_t expires_at) {
+  if (data_length > kMaxDataLength || expires_at == 0) return false;
+  Slot* slot = TryLockSlot(key);
+  if (slot == nullptr) return false;
+  slot->key_length = static_cast<uint16_t>(key.length);
+  memcpy(slot->key, key.data, key.length);
+  slot->data_length = static_cast<uint16_t>(data_length);
+  memcpy(slot->data, data, data_length);
+  slot->expires_at = expires_at;
+  UnlockSlot(slot);
+  return true;
+}
+
+bool TLSSessionCache::Lookup(const Key& key,
+                             uint64_t now,
+                             std::vector<unsigned char>* data) {
+  Slot* slot = TryLockSlot(key);
+  if (slot == nullptr) return false;
+  bool found = false;
+  // A shared table can be written to by any process that maps it, so the
+  // lengths in a slot are not trusted any more than the rest of the file.
+  if (slot->key_length > kMaxKeyLength || slot->data_length > kMaxDataLength) {
+    slot->expires_at = 0;
+  } else if (slot->expires_at != 0 && slot->key_length == key.length &&
+             memcmp(slot->key, key.data, key.length) == 0) {
+    if (slot->expires_at > now) {
+      data->assign(slot->data, slot->data + slot->data_length);
+      found = true;
+    } else {
+      slot->expires_at = 0;
+    }
+  }
+  UnlockSlot(slot);
+  return found;
+}
+
+void TLSSessionCache::Remove(const Key& key) {
+  Slot* slot = TryLockSlot(key);
+  if (slot == nullptr) return;
+  if (slot->key_length == key.length &&
+      memcmp(slot->key, key.data, key.length) == 0) {
+    slot->expires_at = 0;
+  }
+  UnlockSlot(slot);
+}
+
+}  // namespace crypto
+}  // namespace node
@@ -0,0 +1,108 @@
+#ifndef SRC_CRYPTO_CRYPTO_SESSION_CACHE_H_
+#define SRC_CRYPTO_CRYPTO_SESSION_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace node {
+namespace crypto {
+
+// A fixed-size table of serialized TLS server sessions, so that a session
+// that was established through one SecureContext can be resumed through any
+// other SecureContext in the process, or, if the table lives in a shared
+// file mapping, in any process that maps the same file.
+//
+// The table is direct-mapped: every key hashes to exactly one slot, and a
+// newer session simply replaces whatever was stored in its slot before.
+// Each slot has its own spin lock, which is only ever tried once. A slot that
+// is busy is treated as a miss, so a lookup never waits for another thread
+// or process. This also means that a process that crashes while it holds a
+// slot lock only costs the table that one slot.
+class TLSSessionCache {
+ public:
+  static constexpr size_t kSlotSize = 4096;
+  // One length byte, then up to 32 bytes each of session id context and
+  // session id.
+  static constexpr size_t kMaxKeyLength = 72;
+  static constexpr size_t kMaxDataLength = kSlotSize - 16 - kMaxKeyLength;
+  static constexpr uint32_t kDefaultSlotCount = 1024;
+
+  struct Key {
+    unsigned char data[kMaxKeyLength];
+    size_t length = 0;
+  };
+
+  // Returns false if the context or the id is too long for a key.
+  static bool MakeKey(const unsigned char* context,
+                      size_t context_length,
+                      const unsigned char* id,
+                      size_t id_length,
+                      Key* key);
+
+  // The table that is shared by all SecureContexts in this process.
+  static TLSSessionCache* GetProcessCache();
+  // The table in the file at `path`, which is created if it does not exist
+  // yet. All callers in a process get the same instance for the same path.
+  // Returns nullptr and sets `*error` to an errno value on failure.
+  static TLSSessionCache* GetSharedCache(const std::string& path, int* error);
+
+  explicit TLSSessionCache(uint32_t slot_count);
+  // Maps a new view of the file at `path`. Not available on Windows.
+  static std::unique_ptr<TLSSessionCache> MapFile(const std::string& path,
+                                                  uint32_t slot_count,
+                                                  int* error);
+  ~TLSSessionCache();
+
+  TLSSessionCache(const TLSSessionCache&) = delete;
+  TLSSessionCache& operator=(const TLSSessionCache&) = delete;
+
+  // `expires_at` and `now` are in seconds since the epoch, so that processes
+  // that share a table agree on them.
+  // Returns false if the session is too large, or if its slot is busy.
+  bool Store(const Key& key,
+             const unsigned char* data,
+             size_t data_length,
+             uint64_t expires_at);
+  // Returns false if there is no live session for `key`, or if its slot is
+  // busy.
+  bool Lookup(const Key& key, uint64_t now, std::vector<unsigned char>* data);
+  void Remove(const Key& key);
+
+  uint32_t slot_count() const { return slot_count_; }
+
+ private:
+  struct Header;
+
+  struct Slot {
+    std::atomic<uint32_t> lock{0};
+    uint16_t key_length = 0;
+    uint16_t data_length = 0;
+    // 0 for an empty slot.
+    uint64_t expires_at = 0;
+    unsigned char key[kMaxKeyLength];
+    unsigned char data[kMaxDataLength];
+  };
+
+  TLSSessionCache(Slot* slots, uint32_t slot_count);
+
+  Slot* TryLockSlot(const Key& key);
+  static void UnlockSlot(Slot* slot);
+
+  Slot* slots_;
+  const uint32_t slot_count_;
+  std::unique_ptr<Slot[]> owned_slots_;
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+};
+
+}  // namespace crypto
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+#endif  // SRC_CRYPTO_CRYPTO_SESSION_CACHE_H_
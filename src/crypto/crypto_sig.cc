@@ -11,6 +11,7 @@
 
 namespace node {
 
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::BackingStore;
 using v8::Boolean;
@@ -299,7 +300,7 @@ SignBase::Error SignBase::Init(const char* sign_type) {
       strcmp(sign_type, "DSS1") == 0) {
     sign_type = "SHA1";
   }
-  const EVP_MD* md = EVP_get_digestbyname(sign_type);
+  const EVP_MD* md = GetDigestByName(sign_type);
   if (md == nullptr)
     return kSignUnknownDigest;
 
@@ -344,6 +345,7 @@ void Sign::Initialize(Environment* env, Local<Object> target) {
   SetConstructorFunction(env->context(), target, "Sign", t);
 
   SignJob::Initialize(env, target);
+  VerifyManyJob::Initialize(env, target);
 
   constexpr int kSignJobModeSign = SignConfiguration::kSign;
   constexpr int kSignJobModeVerify = SignConfiguration::kVerify;
@@ -361,6 +363,7 @@ void Sign::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(SignUpdate);
   registry->Register(SignFinal);
   SignJob::RegisterExternalReferences(registry);
+  VerifyManyJob::RegisterExternalReferences(registry);
 }
 
 void Sign::New(const FunctionCallbackInfo<Value>& args) {
@@ -657,7 +660,7 @@ Maybe<bool> SignTraits::AdditionalConfig(
 
   if (args[offset + 6]->IsString()) {
     Utf8Value digest(env->isolate(), args[offset + 6]);
-    params->digest = EVP_get_digestbyname(*digest);
+    params->digest = GetDigestByName(*digest);
     if (params->digest == nullptr) {
       THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *digest);
       return Nothing<bool>();
@@ -840,5 +843,186 @@ Maybe<bool> SignTraits::EncodeOutput(
   return Just(!result->IsEmpty());
 }
 
+VerifyManyConfig::VerifyManyConfig(VerifyManyConfig&& other) noexcept
+    : job_mode(other.job_mode),
+      keys(std::move(other.keys)),
+      data(std::move(other.data)),
+      signatures(std::move(other.signatures)),
+      digest(other.digest),
+      flags(other.flags),
+      padding(other.padding),
+      salt_length(other.salt_length),
+      dsa_encoding(other.dsa_encoding) {}
+
+VerifyManyConfig& VerifyManyConfig::operator=(
+    VerifyManyConfig&& other) noexcept {
+  if (&other == this) return *this;
+  this->~VerifyManyConfig();
+  return *new (this) VerifyManyConfig(std::move(other));
+}
+
+void VerifyManyConfig::MemoryInfo(MemoryTracker* tracker) const {
+  if (job_mode == kCryptoJobAsync) {
+    size_t size = 0;
+    for (const ByteSource& input : data) size += input.size();
+    for (const ByteSource& input : signatures) size += input.size();
+    tracker->TrackFieldWithSize("data", size);
+  }
+}
+
+Maybe<bool> VerifyManyTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    VerifyManyConfig* params) {
+  ClearErrorOnReturn clear_error_on_return;
+  Environment* env = Environment::GetCurrent(args);
+
+  params->job_mode = mode;
+
+  CHECK(args[offset]->IsArray());      // Keys
+  CHECK(args[offset + 1]->IsArray());  // Data
+  CHECK(args[offset + 2]->IsArray());  // Signatures
+  Local<Array> keys = args[offset].As<Array>();
+  Local<Array> data = args[offset + 1].As<Array>();
+  Local<Array> signatures = args[offset + 2].As<Array>();
+  uint32_t count = keys->Length();
+  CHECK_EQ(data->Length(), count);
+  CHECK_EQ(signatures->Length(), count);
+
+  if (args[offset + 3]->IsString()) {
+    Utf8Value digest(env->isolate(), args[offset + 3]);
+    params->digest = GetDigestByName(*digest);
+    if (params->digest == nullptr) {
+      THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *digest);
+      return Nothing<bool>();
+    }
+  }
+
+  if (args[offset + 4]->IsInt32()) {  // Salt length
+    params->flags |= SignConfiguration::kHasSaltLength;
+    params->salt_length = args[offset + 4].As<Int32>()->Value();
+  }
+  if (args[offset + 5]->IsUint32()) {  // Padding
+    params->flags |= SignConfiguration::kHasPadding;
+    params->padding = args[offset + 5].As<Uint32>()->Value();
+  }
+
+  if (args[offset + 6]->IsUint32()) {  // DSA Encoding
+    params->dsa_encoding =
+        static_cast<DSASigEnc>(args[offset + 6].As<Uint32>()->Value());
+    if (params->dsa_encoding != kSigEncDER &&
+        params->dsa_encoding != kSigEncP1363) {
+      THROW_ERR_OUT_OF_RANGE(env, "invalid signature encoding");
+      return Nothing<bool>();
+    }
+  }
+
+  params->keys.reserve(count);
+  params->data.reserve(count);
+  params->signatures.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> key_value;
+    Local<Value> data_value;
+    Local<Value> signature_value;
+    if (!keys->Get(env->context(), i).ToLocal(&key_value) ||
+        !data->Get(env->context(), i).ToLocal(&data_value) ||
+        !signatures->Get(env->context(), i).ToLocal(&signature_value)) {
+      return Nothing<bool>();
+    }
+
+    if (!KeyObjectHandle::HasInstance(env, key_value)) {
+      THROW_ERR_INVALID_ARG_TYPE(
+          env,
+          "The \"keys[%u]\" argument must be an instance of KeyObject",
+          i);
+      return Nothing<bool>();
+    }
+    KeyObjectHandle* key;
+    ASSIGN_OR_RETURN_UNWRAP(&key, key_value, Nothing<bool>());
+    if (key->Data()->GetKeyType() == kKeyTypeSecret) {
+      THROW_ERR_CRYPTO_INVALID_KEYTYPE(env);
+      return Nothing<bool>();
+    }
+    ManagedEVPPKey m_pkey = key->Data()->GetAsymmetricKey();
+
+    ArrayBufferOrViewContents<char> input(data_value);
+    ArrayBufferOrViewContents<char> signature(signature_value);
+    if (UNLIKELY(!input.CheckSizeInt32())) {
+      THROW_ERR_OUT_OF_RANGE(env, "data is too big");
+      return Nothing<bool>();
+    }
+    if (UNLIKELY(!signature.CheckSizeInt32())) {
+      THROW_ERR_OUT_OF_RANGE(env, "signature is too big");
+      return Nothing<bool>();
+    }
+
+    params->data.emplace_back(mode == kCryptoJobAsync ? input.ToCopy()
+                                                      : input.ToByteSource());
+    {
+      Mutex::ScopedLock lock(*m_pkey.mutex());
+      if (UseP1363Encoding(m_pkey, params->dsa_encoding)) {
+        params->signatures.emplace_back(
+            ConvertSignatureToDER(m_pkey, signature.ToByteSource()));
+      } else {
+        params->signatures.emplace_back(mode == kCryptoJobAsync
+                                            ? signature.ToCopy()
+                                            : signature.ToByteSource());
+      }
+    }
+    params->keys.emplace_back(std::move(m_pkey));
+  }
+
+  return Just(true);
+}
+
+bool VerifyManyTraits::DeriveBits(
+    Environment* env,
+    const VerifyManyConfig& params,
+    ByteSource* out) {
+  ClearErrorOnReturn clear_error_on_return;
+  EVPMDCtxPointer context(EVP_MD_CTX_new());
+  if (UNLIKELY(!context)) return false;
+
+  Maybe<int> salt_length = params.flags & SignConfiguration::kHasSaltLength
+      ? Just<int>(params.salt_length) : Nothing<int>();
+
+  // A triple that cannot be checked at all, e.g. because the key does not
+  // support the digest, simply does not verify.
+  ByteSource::Builder buf(params.keys.size());
+  for (size_t i = 0; i < params.keys.size(); i++) {
+    const ManagedEVPPKey& key = params.keys[i];
+    EVP_PKEY_CTX* ctx = nullptr;
+    int padding = params.flags & SignConfiguration::kHasPadding
+        ? params.padding
+        : GetDefaultSignPadding(key);
+    buf.data<char>()[i] =
+        EVP_MD_CTX_reset(context.get()) == 1 &&
+        EVP_DigestVerifyInit(
+            context.get(), &ctx, params.digest, nullptr, key.get()) == 1 &&
+        ApplyRSAOptions(key, ctx, padding, salt_length) &&
+        EVP_DigestVerify(context.get(),
+                         params.signatures[i].data<unsigned char>(),
+                         params.signatures[i].size(),
+                         params.data[i].data<unsigned char>(),
+                         params.data[i].size()) == 1;
+  }
+
+  *out = std::move(buf).release();
+  return true;
+}
+
+Maybe<bool> VerifyManyTraits::EncodeOutput(
+    Environment* env,
+    const VerifyManyConfig& params,
+    ByteSource* out,
+    Local<Value>* result) {
+  std::vector<Local<Value>> results(out->size());
+  for (size_t i = 0; i < out->size(); i++)
+    results[i] = Boolean::New(env->isolate(), out->data<char>()[i] == 1);
+  *result = Array::New(env->isolate(), results.data(), results.size());
+  return Just(!result->IsEmpty());
+}
+
 }  // namespace crypto
 }  // namespace node
@@ -161,6 +161,58 @@ struct SignTraits final {
 
 using SignJob = DeriveBitsJob<SignTraits>;
 
+struct VerifyManyConfig final : public MemoryRetainer {
+  CryptoJobMode job_mode;
+  std::vector<ManagedEVPPKey> keys;
+  std::vector<ByteSource> data;
+  std::vector<ByteSource> signatures;
+  const EVP_MD* digest = nullptr;
+  int flags = SignConfiguration::kHasNone;
+  int padding = 0;
+  int salt_length = 0;
+  DSASigEnc dsa_encoding = kSigEncDER;
+
+  VerifyManyConfig() = default;
+
+  explicit VerifyManyConfig(VerifyManyConfig&& other) noexcept;
+
+  VerifyManyConfig& operator=(VerifyManyConfig&& other) noexcept;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(VerifyManyConfig)
+  SET_SELF_SIZE(VerifyManyConfig)
+};
+
+// Verifies a list of (key, data, signature) triples with the same digest and
+// options in a single job. The keys are KeyObjectHandles, so that a key that
+// is used for many signatures is only parsed once. The result is an array
+// with one boolean per triple.
+struct VerifyManyTraits final {
+  using AdditionalParameters = VerifyManyConfig;
+  static constexpr const char* JobName = "VerifyManyJob";
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_SIGNREQUEST;
+
+  static v8::Maybe<bool> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      VerifyManyConfig* params);
+
+  static bool DeriveBits(
+      Environment* env,
+      const VerifyManyConfig& params,
+      ByteSource* out);
+
+  static v8::Maybe<bool> EncodeOutput(
+      Environment* env,
+      const VerifyManyConfig& params,
+      ByteSource* out,
+      v8::Local<v8::Value>* result);
+};
+
+using VerifyManyJob = DeriveBitsJob<VerifyManyTraits>;
+
 }  // namespace crypto
 }  // namespace node
 
@@ -22,6 +22,7 @@
 #include "crypto/crypto_tls.h"
 #include "crypto/crypto_context.h"
 #include "crypto/crypto_common.h"
+#include "crypto/crypto_session_cache.h"
 #include "crypto/crypto_util.h"
 #include "crypto/crypto_bio.h"
 #include "crypto/crypto_clienthello-inl.h"
@@ -71,7 +72,64 @@ SSL_SESSION* GetSessionCallback(
     int* copy) {
   TLSWrap* w = static_cast<TLSWrap*>(SSL_get_app_data(s));
   *copy = 0;
-  return w->ReleaseSession();
+  SSL_SESSION* sess = w->ReleaseSession();
+  if (sess != nullptr || !w->is_server())
+    return sess;
+
+  // Nothing was loaded from JS land, so fall back to the native cache,
+  // without a detour through the event loop.
+  SecureContext* sc = static_cast<SecureContext*>(
+      SSL_CTX_get_app_data(SSL_get_SSL_CTX(s)));
+  if (sc == nullptr || sc->session_cache() == nullptr)
+    return nullptr;
+
+  const std::string& sid_ctx = sc->session_id_context();
+  TLSSessionCache::Key cache_key;
+  std::vector<unsigned char> data;
+  if (!TLSSessionCache::MakeKey(
+          reinterpret_cast<const unsigned char*>(sid_ctx.data()),
+          sid_ctx.size(),
+          key,
+          len,
+          &cache_key) ||
+      !sc->session_cache()->Lookup(
+          cache_key, static_cast<uint64_t>(time(nullptr)), &data)) {
+    return nullptr;
+  }
+
+  const unsigned char* p = data.data();
+  return d2i_SSL_SESSION(nullptr, &p, data.size());
+}
+
+void StoreInSessionCache(SSL* s, SSL_SESSION* sess) {
+  SecureContext* sc = static_cast<SecureContext*>(
+      SSL_CTX_get_app_data(SSL_get_SSL_CTX(s)));
+  if (sc == nullptr || sc->session_cache() == nullptr)
+    return;
+
+  unsigned int sid_ctx_length;
+  const unsigned char* sid_ctx =
+      SSL_SESSION_get0_id_context(sess, &sid_ctx_length);
+  unsigned int id_length;
+  const unsigned char* id = SSL_SESSION_get_id(sess, &id_length);
+  TLSSessionCache::Key cache_key;
+  if (!TLSSessionCache::MakeKey(
+          sid_ctx, sid_ctx_length, id, id_length, &cache_key)) {
+    return;
+  }
+
+  int size = i2d_SSL_SESSION(sess, nullptr);
+  if (size <= 0 ||
+      static_cast<size_t>(size) > TLSSessionCache::kMaxDataLength) {
+    return;
+  }
+  unsigned char data[TLSSessionCache::kMaxDataLength];
+  unsigned char* p = data;
+  CHECK_EQ(i2d_SSL_SESSION(sess, &p), size);
+
+  uint64_t expires_at = static_cast<uint64_t>(SSL_SESSION_get_time(sess)) +
+                        static_cast<uint64_t>(SSL_SESSION_get_timeout(sess));
+  sc->session_cache()->Store(cache_key, data, size, expires_at);
 }
 
 void OnClientHello(
@@ -134,6 +192,9 @@ int NewSessionCallback(SSL* s, SSL_SESSION* sess) {
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  if (w->is_server())
+    StoreInSessionCache(s, sess);
+
   if (!w->has_session_callbacks())
     return 0;
 
@@ -378,6 +439,8 @@ TLSWrap::TLSWrap(Environment* env,
   stream->PushStreamListener(this);
 
   env_->isolate()->AdjustAmountOfExternalAllocatedMemory(kExternalSize);
+  env_->native_memory_counters()->Increase(mem::NativeMemoryCounters::kTls,
+                                           kExternalSize);
 
   InitSSL();
   Debug(this, "Created new TLSWrap");
@@ -750,36 +813,41 @@ void TLSWrap::ClearOut() {
 
   MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  char out[kClearOutChunkSize];
   int read;
+  int err = SSL_ERROR_NONE;
   for (;;) {
-    read = SSL_read(ssl_.get(), out, sizeof(out));
-    Debug(this, "Read %d bytes of cleartext output", read);
+    // Decrypt straight into the listener's buffer, so that the cleartext is
+    // not copied again on its way out, e.g. into a user-supplied buffer of
+    // a CustomBufferJSListener. A buffer that SSL_read() does not use is
+    // handed back as an empty read, like libuv does.
+    uv_buf_t buf = EmitAlloc(kClearOutChunkSize);
+    if (buf.base == nullptr || buf.len == 0) {
+      EmitRead(UV_ENOBUFS, buf);
+      return;
+    }
 
-    if (read <= 0)
-      break;
+    read = SSL_read(ssl_.get(),
+                    buf.base,
+                    static_cast<int>(std::min<size_t>(buf.len, INT_MAX)));
+    Debug(this, "Read %d bytes of cleartext output", read);
 
-    char* current = out;
-    while (read > 0) {
-      int avail = read;
-
-      uv_buf_t buf = EmitAlloc(avail);
-      if (static_cast<int>(buf.len) < avail)
-        avail = buf.len;
-      memcpy(buf.base, current, avail);
-      EmitRead(avail, buf);
-
-      // Caveat emptor: OnRead() calls into JS land which can result in
-      // the SSL context object being destroyed.  We have to carefully
-      // check that ssl_ != nullptr afterwards.
-      if (ssl_ == nullptr) {
-        Debug(this, "Returning from read loop, ssl_ == nullptr");
-        return;
-      }
+    if (read <= 0) {
+      err = SSL_get_error(ssl_.get(), read);
+      EmitRead(0, buf);
+    } else {
+      EmitRead(read, buf);
+    }
 
-      read -= avail;
-      current += avail;
+    // Caveat emptor: OnRead() calls into JS land which can result in
+    // the SSL context object being destroyed.  We have to carefully
+    // check that ssl_ != nullptr afterwards.
+    if (ssl_ == nullptr) {
+      Debug(this, "Returning from read loop, ssl_ == nullptr");
+      return;
     }
+
+    if (read <= 0)
+      break;
   }
 
   // We need to check whether an error occurred or the connection was
@@ -787,11 +855,11 @@ void TLSWrap::ClearOut() {
   // See node#1642 and SSL_read(3SSL) for details. SSL_get_error must be
   // called immediately after SSL_read, without calling into JS, which may
   // change OpenSSL's error queue, modify ssl_, or even destroy ssl_
-  // altogether.
+  // altogether. That is why `err` was taken before the empty read above,
+  // which does not call into JS.
   if (read <= 0) {
     HandleScope handle_scope(env()->isolate());
     Local<Value> error;
-    int err = SSL_get_error(ssl_.get(), read);
     switch (err) {
       case SSL_ERROR_ZERO_RETURN:
         if (!eof_) {
@@ -1259,6 +1327,8 @@ void TLSWrap::Destroy() {
   InvokeQueued(UV_ECANCELED, "Canceled because of SSL destruction");
 
   env()->isolate()->AdjustAmountOfExternalAllocatedMemory(-kExternalSize);
+  env()->native_memory_counters()->Decrease(mem::NativeMemoryCounters::kTls,
+                                            kExternalSize);
   ssl_.reset();
 
   enc_in_ = nullptr;
@@ -94,6 +94,46 @@ MUST_USE_RESULT CSPRNGResult CSPRNG(void* buffer, size_t length) {
   return {false};
 }
 
+namespace {
+// Bumped to discard the contents of all pools, e.g. after the default
+// DRBG changed.
+std::atomic<uint64_t> csprng_pool_generation{0};
+
+struct CSPRNGPool {
+  ~CSPRNGPool() { OPENSSL_cleanse(data, sizeof(data)); }
+
+  unsigned char data[kCSPRNGPoolSize];
+  // The unused bytes are the last `available` bytes of `data`.
+  size_t available = 0;
+  uint64_t generation = 0;
+};
+
+thread_local CSPRNGPool csprng_pool;
+}  // anonymous namespace
+
+MUST_USE_RESULT CSPRNGResult PooledCSPRNG(void* buffer, size_t length) {
+  if (length > kMaxPooledCSPRNGRequest) return CSPRNG(buffer, length);
+
+  CSPRNGPool& pool = csprng_pool;
+  uint64_t generation =
+      csprng_pool_generation.load(std::memory_order_relaxed);
+  if (pool.generation != generation || pool.available < length) {
+    if (CSPRNG(pool.data, sizeof(pool.data)).is_err()) {
+      OPENSSL_cleanse(pool.data, sizeof(pool.data));
+      pool.available = 0;
+      return {false};
+    }
+    pool.available = sizeof(pool.data);
+    pool.generation = generation;
+  }
+
+  unsigned char* bytes = pool.data + sizeof(pool.data) - pool.available;
+  memcpy(buffer, bytes, length);
+  OPENSSL_cleanse(bytes, length);
+  pool.available -= length;
+  return {true};
+}
+
 int PasswordCallback(char* buf, int size, int rwflag, void* u) {
   const ByteSource* passphrase = *static_cast<const ByteSource**>(u);
   if (passphrase != nullptr) {
@@ -137,6 +177,88 @@ bool ProcessFipsOptions() {
   return true;
 }
 
+#if OPENSSL_VERSION_MAJOR >= 3
+namespace {
+
+template <typename T>
+struct FetchedAlgorithmCache {
+  RwLock lock;
+  std::unordered_map<std::string, T*> by_name;
+  // Entries that were replaced after the default properties changed. These
+  // are never freed because other threads may still be using them.
+  std::vector<T*> retired;
+};
+
+FetchedAlgorithmCache<EVP_MD> fetched_digests;
+FetchedAlgorithmCache<EVP_CIPHER> fetched_ciphers;
+
+template <typename T,
+          const T* (*get_by_name)(const char*),
+          const char* (*get0_name)(const T*),
+          T* (*fetch)(OSSL_LIB_CTX*, const char*, const char*),
+          void (*free_fn)(T*)>
+const T* GetFetchedAlgorithm(FetchedAlgorithmCache<T>* cache,
+                             const char* name) {
+  {
+    RwLock::ScopedReadLock lock(cache->lock);
+    auto it = cache->by_name.find(name);
+    if (it != cache->by_name.end()) return it->second;
+  }
+
+  const T* implicit = get_by_name(name);
+  if (implicit == nullptr) return nullptr;
+
+  // EVP_*_fetch() does not support alias names, so we need to pass it the
+  // real/original algorithm name. If the algorithm cannot be fetched, e.g.
+  // because it is only used internally by OpenSSL, fall back to the
+  // implicit implementation without caching it.
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+  const char* real_name = get0_name(implicit);
+  T* fetched = real_name != nullptr ? fetch(nullptr, real_name, nullptr)
+                                    : nullptr;
+  if (fetched == nullptr) return implicit;
+
+  RwLock::ScopedWriteLock lock(cache->lock);
+  auto [it, inserted] = cache->by_name.emplace(name, fetched);
+  if (!inserted) free_fn(fetched);
+  return it->second;
+}
+
+template <typename T>
+void RetireFetchedAlgorithms(FetchedAlgorithmCache<T>* cache) {
+  RwLock::ScopedWriteLock lock(cache->lock);
+  for (const auto& [name, algorithm] : cache->by_name)
+    cache->retired.push_back(algorithm);
+  cache->by_name.clear();
+}
+
+}  // anonymous namespace
+#endif  // OPENSSL_VERSION_MAJOR >= 3
+
+const EVP_MD* GetDigestByName(const char* name) {
+#if OPENSSL_VERSION_MAJOR >= 3
+  return GetFetchedAlgorithm<EVP_MD,
+                             EVP_get_digestbyname,
+                             EVP_MD_get0_name,
+                             EVP_MD_fetch,
+                             EVP_MD_free>(&fetched_digests, name);
+#else
+  return EVP_get_digestbyname(name);
+#endif
+}
+
+const EVP_CIPHER* GetCipherByName(const char* name) {
+#if OPENSSL_VERSION_MAJOR >= 3
+  return GetFetchedAlgorithm<EVP_CIPHER,
+                             EVP_get_cipherbyname,
+                             EVP_CIPHER_get0_name,
+                             EVP_CIPHER_fetch,
+                             EVP_CIPHER_free>(&fetched_ciphers, name);
+#else
+  return EVP_get_cipherbyname(name);
+#endif
+}
+
 bool InitCryptoOnce(Isolate* isolate) {
   static uv_once_t init_once = UV_ONCE_INIT;
   TryCatch try_catch{isolate};
@@ -209,6 +331,21 @@ void InitCryptoOnce() {
   ERR_load_ENGINE_strings();
   ENGINE_load_builtin_engines();
 #endif  // !OPENSSL_NO_ENGINE
+
+#if OPENSSL_VERSION_MAJOR >= 3
+  // Fetch the most commonly used algorithms ahead of time.
+  for (const char* name : {"md5", "sha1", "sha256", "sha384", "sha512"})
+    GetDigestByName(name);
+  for (const char* name : {"aes-128-cbc",
+                           "aes-256-cbc",
+                           "aes-128-ctr",
+                           "aes-256-ctr",
+                           "aes-128-gcm",
+                           "aes-256-gcm",
+                           "chacha20-poly1305"}) {
+    GetCipherByName(name);
+  }
+#endif  // OPENSSL_VERSION_MAJOR >= 3
 }
 
 void GetFipsCrypto(const FunctionCallbackInfo<Value>& args) {
@@ -247,6 +384,14 @@ void SetFipsCrypto(const FunctionCallbackInfo<Value>& args) {
     unsigned long err = ERR_get_error();  // NOLINT(runtime/int)
     return ThrowCryptoError(env, err);
   }
+
+#if OPENSSL_VERSION_MAJOR >= 3
+  // Cached implementations were fetched with the old default properties.
+  RetireFetchedAlgorithms(&fetched_digests);
+  RetireFetchedAlgorithms(&fetched_ciphers);
+#endif
+  // Pooled random bytes came from the previous DRBG.
+  csprng_pool_generation.fetch_add(1, std::memory_order_relaxed);
 }
 
 void TestFipsCrypto(const v8::FunctionCallbackInfo<v8::Value>& args) {
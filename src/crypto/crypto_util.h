@@ -97,6 +97,14 @@ void InitCrypto(v8::Local<v8::Object> target);
 
 extern void UseExtraCaCerts(const std::string& file);
 
+// Look up a digest or cipher by name, like EVP_get_digestbyname() and
+// EVP_get_cipherbyname(). With OpenSSL 3, the result is an implementation
+// that has been fetched explicitly and is cached for the lifetime of the
+// process, so that initializing contexts with it does not have to go through
+// the provider lookup every time. The result must not be freed.
+const EVP_MD* GetDigestByName(const char* name);
+const EVP_CIPHER* GetCipherByName(const char* name);
+
 // Forcibly clear OpenSSL's error stack on return. This stops stale errors
 // from popping up later in the lifecycle of crypto operations where they
 // would cause spurious failures. It's a rather blunt method, though.
@@ -125,6 +133,14 @@ struct CSPRNGResult {
 // is properly seeded without consuming entropy.
 MUST_USE_RESULT CSPRNGResult CSPRNG(void* buffer, size_t length);
 
+// Like CSPRNG(), but requests of up to kMaxPooledCSPRNGRequest bytes are
+// served from a per-thread buffer of CSPRNG output that is refilled
+// kCSPRNGPoolSize bytes at a time. Bytes are wiped from the buffer as they
+// are handed out, so no two callers ever get the same bytes.
+constexpr size_t kCSPRNGPoolSize = 4096;
+constexpr size_t kMaxPooledCSPRNGRequest = 256;
+MUST_USE_RESULT CSPRNGResult PooledCSPRNG(void* buffer, size_t length);
+
 int PasswordCallback(char* buf, int size, int rwflag, void* u);
 
 int NoPasswordCallback(char* buf, int size, int rwflag, void* u);
@@ -329,6 +345,17 @@ enum CryptoJobMode {
 
 CryptoJobMode GetCryptoJobMode(v8::Local<v8::Value> args);
 
+// Async jobs with at most this many bytes of input may be done on the main
+// thread instead of in the threadpool, see CryptoJob::RunsInline().
+constexpr size_t kCryptoJobInlineLimit = 1024;
+
+// Whether an async job with the given parameters runs inline. Overloaded for
+// the parameters of the jobs that can.
+template <typename Params>
+inline bool IsInlineCryptoJob(const Params& params) {
+  return false;
+}
+
 template <typename CryptoJobTraits>
 class CryptoJob : public AsyncWrap, public ThreadPoolWork {
  public:
@@ -340,7 +367,7 @@ class CryptoJob : public AsyncWrap, public ThreadPoolWork {
                      CryptoJobMode mode,
                      AdditionalParams&& params)
       : AsyncWrap(env, object, type),
-        ThreadPoolWork(env, "crypto"),
+        ThreadPoolWork(env, "crypto", ThreadPoolWorkKind::kCpu),
         mode_(mode),
         params_(std::move(params)) {
     // If the CryptoJob is async, then the instance will be
@@ -399,6 +426,11 @@ class CryptoJob : public AsyncWrap, public ThreadPoolWork {
 
   AdditionalParams* params() { return &params_; }
 
+  // Whether the work of an async job is done right away on the main thread,
+  // with only the callback being deferred. For small inputs, that is faster
+  // than handing the work to the threadpool and waiting for it to come back.
+  virtual bool RunsInline() const { return IsInlineCryptoJob(params_); }
+
   const char* MemoryInfoName() const override {
     return CryptoJobTraits::JobName;
   }
@@ -413,8 +445,11 @@ class CryptoJob : public AsyncWrap, public ThreadPoolWork {
 
     CryptoJob<CryptoJobTraits>* job;
     ASSIGN_OR_RETURN_UNWRAP(&job, args.Holder());
-    if (job->mode() == kCryptoJobAsync)
+    if (job->mode() == kCryptoJobAsync) {
+      if (job->RunsInline())
+        return job->RunInline();
       return job->ScheduleWork();
+    }
 
     v8::Local<v8::Value> ret[2];
     env->PrintSyncTrace();
@@ -7,8 +7,6 @@
 #include <node_bob-inl.h>
 #include <node_errors.h>
 #include <node_external_reference.h>
-#include <node_file-inl.h>
-#include <stream_base-inl.h>
 #include <util-inl.h>
 #include <uv.h>
 #include <v8.h>
@@ -44,7 +42,15 @@ class DataQueueImpl final : public DataQueue,
       : entries_(std::move(list)),
         idempotent_(true),
         size_(size),
-        capped_size_(0) {}
+        capped_size_(0) {
+    offsets_.reserve(entries_.size());
+    uint64_t offset = 0;
+    for (const auto& entry : entries_) {
+      offset += entry->size().value();
+      offsets_.push_back(offset);
+    }
+    DCHECK_EQ(offset, size);
+  }
 
   // Constructor for a non-idempotent DataQueue. This kind of queue can have
   // entries added to it over time. The size is set to 0 initially. The queue
@@ -76,31 +82,33 @@ class DataQueueImpl final : public DataQueue,
 
     DCHECK_LE(start, end);
 
-    uint64_t len = end - start;
-    uint64_t remaining = end - start;
-    std::vector<std::unique_ptr<Entry>> slices;
-
-    if (remaining > 0) {
-      for (const auto& entry : entries_) {
-        // The size of every entry should be known since this is an
-        // idempotent queue.
-        uint64_t entrySize = entry->size().value();
-        if (start > entrySize) {
-          start -= entrySize;
-          continue;
-        }
+    // Idempotent queues cannot change, so a slice of all of it can share it.
+    if (start == 0 && end == size) return shared_from_this();
 
-        uint64_t chunkStart = start;
-        uint64_t len = std::min(remaining, entrySize - chunkStart);
-        slices.emplace_back(entry->slice(chunkStart, chunkStart + len));
-        remaining -= len;
-        start = 0;
+    std::vector<std::unique_ptr<Entry>> slices;
 
-        if (remaining == 0) break;
+    if (end > start) {
+      // offsets_ holds the end of every entry, so the slice starts in the
+      // first entry that ends after |start|, and ends in the first entry
+      // that ends at or after |end|.
+      size_t first =
+          std::upper_bound(offsets_.begin(), offsets_.end(), start) -
+          offsets_.begin();
+      size_t last =
+          std::lower_bound(offsets_.begin() + first, offsets_.end(), end) -
+          offsets_.begin();
+      DCHECK_LT(last, entries_.size());
+
+      slices.reserve(last - first + 1);
+      for (size_t i = first; i <= last; i++) {
+        uint64_t entry_start = i == 0 ? 0 : offsets_[i - 1];
+        uint64_t chunk_start = std::max(start, entry_start) - entry_start;
+        uint64_t chunk_end = std::min(end, offsets_[i]) - entry_start;
+        slices.emplace_back(entries_[i]->slice(chunk_start, chunk_end));
       }
     }
 
-    return std::make_shared<DataQueueImpl>(std::move(slices), len);
+    return std::make_shared<DataQueueImpl>(std::move(slices), end - start);
   }
 
   std::optional<uint64_t> size() const override { return size_; }
@@ -160,6 +168,7 @@ class DataQueueImpl final : public DataQueue,
   void MemoryInfo(node::MemoryTracker* tracker) const override {
     tracker->TrackField(
         "entries", entries_, "std::vector<std::unique_ptr<Entry>>");
+    tracker->TrackField("offsets", offsets_);
   }
 
   void addBackpressureListener(BackpressureListener* listener) override {
@@ -189,6 +198,9 @@ class DataQueueImpl final : public DataQueue,
 
  private:
   std::vector<std::unique_ptr<Entry>> entries_;
+  // The end offset of every entry of an idempotent queue, so that slices
+  // find their entries with a binary search.
+  std::vector<uint64_t> offsets_;
   bool idempotent_;
   std::optional<uint64_t> size_ = std::nullopt;
   std::optional<uint64_t> capped_size_ = std::nullopt;
@@ -691,9 +703,8 @@ class InMemoryEntry final : public EntryImpl {
       return makeEntry(start, end - start);
     }
 
-    // If no end is given, then the new length is the current length
-    // minus the adjusted start.
-    return makeEntry(start, byte_length_ - start);
+    // If no end is given, then the slice extends to the end of this entry.
+    return makeEntry(start, offset_ + byte_length_ - start);
   }
 
   std::optional<uint64_t> size() const override { return byte_length_; }
@@ -800,21 +811,22 @@ class DataQueueEntry : public EntryImpl {
 
 // ============================================================================
 
-// An FdEntry reads from a file descriptor. A check is made before each read
-// to determine if the fd has changed on disc. This is a best-effort check
-// that only looks at file size, creation, and modification times. The stat
-// check is also async, so there's a natural race condition there where the
-// file could be modified between the stat and actual read calls. That's
-// a tolerable risk here. While FdEntry is considered idempotent, this race
-// means that it is indeed possible for multiple reads to return different
-// results if the file just happens to get modified.
+// An FdEntry reads from a file descriptor. A check is made before each chunk
+// that was read is handed out to determine if the fd has changed on disc.
+// This is a best-effort check that only looks at file size, creation, and
+// modification times. The reads happen ahead of the check, so there's a
+// natural race condition there where the file could be modified between
+// the read and the stat calls. That's a tolerable risk here. While FdEntry is
+// considered idempotent, this race means that it is indeed possible for
+// multiple reads to return different results if the file just happens to get
+// modified.
 class FdEntry final : public EntryImpl {
   // TODO(@jasnell, @flakey5):
   // * This should only allow reading from regular files. No directories, no
   // pipes, etc.
   // * The reader should support accepting the buffer(s) from the pull, if any.
   // It should
-  //   only allocate a managed buffer if the pull doesn't provide any.
+  //   only use a pooled chunk if the pull doesn't provide any.
   // * We might want to consider making the stat on each read sync to eliminate
   // the race
   //   condition described in the comment above.
@@ -895,87 +907,59 @@ class FdEntry final : public EntryImpl {
     return entry->is_modified(req.statbuf);
   }
 
+  // Reads are positional, so the reader keeps a window of up to kWindow
+  // chunks that are read ahead of the consumer, and several of them can be
+  // in flight at once. Pulls are answered synchronously whenever the next
+  // chunk is ready.
+  //
+  // The consumer gets a slice of the chunk a read went into, and the chunk
+  // goes back to the pool once the consumer and the reader are both done
+  // with it. A read in flight keeps its chunk and the file alive on its
+  // own, so that it can complete safely after the reader is gone.
   class ReaderImpl final : public DataQueue::Reader,
-                           public StreamListener,
                            public std::enable_shared_from_this<ReaderImpl> {
+    // Closes the file once the reader and all reads in flight are done.
+    struct File {
+      explicit File(uv_file fd) : fd(fd) {}
+      ~File() {
+        uv_fs_t req;
+        uv_fs_close(nullptr, &req, fd, nullptr);
+        uv_fs_req_cleanup(&req);
+      }
+      File(const File&) = delete;
+      File& operator=(const File&) = delete;
+
+      const uv_file fd;
+    };
+
    public:
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kWindow = 4;
+    static constexpr size_t kPoolSize = 2 * kWindow;
+
     static std::shared_ptr<ReaderImpl> Create(FdEntry* entry) {
       uv_fs_t req;
       auto cleanup = OnScopeLeave([&] { uv_fs_req_cleanup(&req); });
       int file =
           uv_fs_open(nullptr, &req, entry->path_->out(), O_RDONLY, 0, nullptr);
-      if (file < 0 || FdEntry::CheckModified(entry, file)) {
-        uv_fs_close(nullptr, &req, file, nullptr);
-        return nullptr;
-      }
-      Realm* realm = entry->env()->principal_realm();
-      return std::make_shared<ReaderImpl>(
-          BaseObjectPtr<fs::FileHandle>(
-              fs::FileHandle::New(realm->GetBindingData<fs::BindingData>(),
-                                  file,
-                                  Local<Object>(),
-                                  entry->start_,
-                                  entry->end_ - entry->start_)),
-          entry);
+      if (file < 0) return nullptr;
+      auto fd = std::make_shared<File>(file);
+      if (FdEntry::CheckModified(entry, file)) return nullptr;
+      return std::make_shared<ReaderImpl>(std::move(fd), entry);
     }
 
-    explicit ReaderImpl(BaseObjectPtr<fs::FileHandle> handle, FdEntry* entry)
-        : env_(handle->env()), handle_(std::move(handle)), entry_(entry) {
-      handle_->PushStreamListener(this);
-      handle_->env()->AddCleanupHook(cleanup, this);
+    ReaderImpl(std::shared_ptr<File> file, FdEntry* entry)
+        : env_(entry->env()),
+          file_(std::move(file)),
+          entry_(entry),
+          next_offset_(entry->start_),
+          eof_(entry->start_ >= entry->end_) {
+      env_->AddCleanupHook(cleanup, this);
     }
 
     ~ReaderImpl() override {
-      handle_->env()->RemoveCleanupHook(cleanup, this);
+      env_->RemoveCleanupHook(cleanup, this);
       DrainAndClose();
-      handle_->RemoveStreamListener(this);
-    }
-
-    uv_buf_t OnStreamAlloc(size_t suggested_size) override {
-      return env_->allocate_managed_buffer(suggested_size);
-    }
-
-    void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override {
-      std::shared_ptr<v8::BackingStore> store =
-          env_->release_managed_buffer(buf);
-
-      if (ended_) {
-        // If we got here and ended_ is true, it means we ended and drained
-        // while the read was pending. We're just going to do nothing.
-        CHECK(pending_pulls_.empty());
-        return;
-      }
-
-      CHECK(reading_);
-      auto pending = DequeuePendingPull();
-
-      if (CheckModified(entry_, handle_->GetFD())) {
-        DrainAndClose();
-        // The file was modified while the read was pending. We need to error.
-        std::move(pending.next)(UV_EINVAL, nullptr, 0, [](uint64_t) {});
-        return;
-      }
-
-      if (nread < 0) {
-        if (nread == UV_EOF) {
-          std::move(pending.next)(bob::STATUS_EOS, nullptr, 0, [](uint64_t) {});
-        } else {
-          std::move(pending.next)(nread, nullptr, 0, [](uint64_t) {});
-        }
-
-        return DrainAndClose();
-      }
-
-      DataQueue::Vec vec;
-      vec.base = static_cast<uint8_t*>(store->Data());
-      vec.len = static_cast<uint64_t>(nread);
-      std::move(pending.next)(
-          bob::STATUS_CONTINUE, &vec, 1, [store](uint64_t) {});
-
-      if (pending_pulls_.empty()) {
-        reading_ = false;
-        if (handle_->IsAlive()) handle_->ReadStop();
-      }
     }
 
     int Pull(Next next,
@@ -983,22 +967,17 @@ class FdEntry final : public EntryImpl {
              DataQueue::Vec* data,
              size_t count,
              size_t max_count_hint = bob::kMaxCountHint) override {
-      if (ended_ || !handle_->IsAlive()) {
+      if (ended_) {
         std::move(next)(bob::STATUS_EOS, nullptr, 0, [](uint64_t) {});
         return bob::STATUS_EOS;
       }
 
-      if (FdEntry::CheckModified(entry_, handle_->GetFD())) {
-        DrainAndClose();
-        std::move(next)(UV_EINVAL, nullptr, 0, [](uint64_t) {});
-        return UV_EINVAL;
-      }
+      if (pending_pulls_.empty() && IsReady()) return Respond(std::move(next));
 
       pending_pulls_.emplace_back(std::move(next), shared_from_this());
-      if (!reading_) {
-        reading_ = true;
-        handle_->ReadStart();
-      }
+      ReadAhead();
+      // A read that fails right away is ready without a callback.
+      OnChunkRead();
       return bob::STATUS_WAIT;
     }
 
@@ -1007,6 +986,19 @@ class FdEntry final : public EntryImpl {
     SET_SELF_SIZE(ReaderImpl)
 
    private:
+    struct Chunk {
+      uv_fs_t req;
+      std::unique_ptr<char[]> data{new char[kChunkSize]};
+      size_t length = 0;
+      ssize_t result = 0;
+      bool done = false;
+      // Only set while the read is in flight.
+      Environment* env = nullptr;
+      std::shared_ptr<Chunk> self;
+      std::shared_ptr<File> file;
+      std::weak_ptr<ReaderImpl> reader;
+    };
+
     struct PendingPull {
       Next next;
       std::shared_ptr<ReaderImpl> self;
@@ -1015,10 +1007,16 @@ class FdEntry final : public EntryImpl {
     };
 
     Environment* env_;
-    BaseObjectPtr<fs::FileHandle> handle_;
+    std::shared_ptr<File> file_;
     FdEntry* entry_;
+    // Chunks in file order, including the ones that are still being read.
+    std::deque<std::shared_ptr<Chunk>> chunks_;
+    std::vector<std::shared_ptr<Chunk>> pool_;
     std::deque<PendingPull> pending_pulls_;
-    bool reading_ = false;
+    uint64_t next_offset_;
+    // Set once no more reads are going to be issued.
+    bool eof_;
+    int final_status_ = bob::STATUS_EOS;
     bool ended_ = false;
 
     static void cleanup(void* self) {
@@ -1029,22 +1027,119 @@ class FdEntry final : public EntryImpl {
     void DrainAndClose() {
       if (ended_) return;
       ended_ = true;
+      eof_ = true;
       while (!pending_pulls_.empty()) {
         auto pending = DequeuePendingPull();
         std::move(pending.next)(bob::STATUS_EOS, nullptr, 0, [](uint64_t) {});
       }
-      handle_->ReadStop();
-
-      // We fallback to a sync close on the raw fd here because it is the
-      // easiest, simplest thing to do. All of FileHandle's close mechanisms
-      // assume async close and cleanup, while DrainAndClose might be running
-      // in the destructor during GC, for instance. As a todo, FileHandle could
-      // provide a sync mechanism for closing the FD but, for now, this
-      // approach works.
-      int fd = handle_->Release();
-      uv_fs_t req;
-      uv_fs_close(nullptr, &req, fd, nullptr);
-      uv_fs_req_cleanup(&req);
+      chunks_.clear();
+      file_.reset();
+    }
+
+    // Whether Respond() can answer a pull right away.
+    bool IsReady() const {
+      return chunks_.empty() ? eof_ : chunks_.front()->done;
+    }
+
+    std::shared_ptr<Chunk> GetChunk() {
+      // A chunk that is only referenced by the pool is not used anywhere.
+      for (const std::shared_ptr<Chunk>& chunk : pool_) {
+        if (chunk.use_count() == 1) return chunk;
+      }
+      auto chunk = std::make_shared<Chunk>();
+      if (pool_.size() < kPoolSize) pool_.push_back(chunk);
+      return chunk;
+    }
+
+    void ReadAhead() {
+      while (!eof_ && chunks_.size() < kWindow) {
+        std::shared_ptr<Chunk> chunk = GetChunk();
+        chunk->length = static_cast<size_t>(
+            std::min<uint64_t>(kChunkSize, entry_->end_ - next_offset_));
+        chunk->done = false;
+        uv_buf_t buf = uv_buf_init(chunk->data.get(), chunk->length);
+        int err = uv_fs_read(env_->event_loop(),
+                             &chunk->req,
+                             file_->fd,
+                             &buf,
+                             1,
+                             next_offset_,
+                             OnRead);
+        if (err < 0) {
+          uv_fs_req_cleanup(&chunk->req);
+          chunk->result = err;
+          chunk->done = true;
+          eof_ = true;
+        } else {
+          chunk->env = env_;
+          chunk->self = chunk;
+          chunk->file = file_;
+          chunk->reader = weak_from_this();
+          env_->IncreaseWaitingRequestCounter();
+          next_offset_ += chunk->length;
+          eof_ = next_offset_ >= entry_->end_;
+        }
+        chunks_.push_back(std::move(chunk));
+      }
+    }
+
+    static void OnRead(uv_fs_t* req) {
+      Chunk* chunk = ContainerOf(&Chunk::req, req);
+      std::shared_ptr<Chunk> self = std::move(chunk->self);
+      chunk->result = req->result;
+      chunk->done = true;
+      uv_fs_req_cleanup(req);
+      chunk->file.reset();
+      chunk->env->DecreaseWaitingRequestCounter();
+      if (std::shared_ptr<ReaderImpl> reader = chunk->reader.lock())
+        reader->OnChunkRead();
+    }
+
+    void OnChunkRead() {
+      while (!ended_ && !pending_pulls_.empty() && IsReady()) {
+        auto pending = DequeuePendingPull();
+        Respond(std::move(pending.next));
+      }
+    }
+
+    // Hands the next chunk, or the final status, to `next`. Must only be
+    // called if IsReady() is true.
+    int Respond(Next next) {
+      if (chunks_.empty()) {
+        int status = final_status_;
+        std::move(next)(status, nullptr, 0, [](uint64_t) {});
+        DrainAndClose();
+        return status;
+      }
+
+      std::shared_ptr<Chunk> chunk = std::move(chunks_.front());
+      chunks_.pop_front();
+      ssize_t result = chunk->result;
+      // Only the chunks that are handed out have to be checked, which also
+      // keeps this at one fstat() per chunk.
+      if (result >= 0 && CheckModified(entry_, file_->fd)) {
+        // The file was modified while the read was pending.
+        result = UV_EINVAL;
+      }
+      if (result <= 0 || static_cast<size_t>(result) < chunk->length) {
+        // Anything that was read after a short read, or after an error,
+        // starts past the end of the file as it was.
+        eof_ = true;
+        chunks_.clear();
+        if (result < 0) final_status_ = static_cast<int>(result);
+        if (result <= 0) return Respond(std::move(next));
+      }
+
+      ReadAhead();
+
+      DataQueue::Vec vec;
+      vec.base = reinterpret_cast<uint8_t*>(chunk->data.get());
+      vec.len = static_cast<uint64_t>(result);
+      std::move(next)(bob::STATUS_CONTINUE,
+                      &vec,
+                      1,
+                      [chunk = std::move(chunk)](uint64_t) {});
+      return bob::STATUS_CONTINUE;
     }
 
     PendingPull DequeuePendingPull() {
@@ -7,6 +7,7 @@
 #include "string_bytes.h"
 #include "v8.h"
 
+#include <algorithm>
 #include <cstdint>
 
 namespace node {
@@ -14,11 +15,16 @@ namespace encoding_binding {
 
 using v8::ArrayBuffer;
 using v8::BackingStore;
+using v8::CFunction;
 using v8::Context;
+using v8::FastApiTypedArray;
+using v8::FastOneByteString;
 using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
+using v8::NewStringType;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::String;
@@ -82,6 +88,61 @@ void BindingData::Deserialize(Local<Context> context,
   CHECK_NOT_NULL(binding);
 }
 
+// Writes as many whole characters of the Latin-1 string |source| as fit into
+// |dest| as UTF-8. Returns the number of bytes written and stores the number
+// of characters consumed in |*read|.
+static size_t EncodeLatin1Into(const char* source,
+                               size_t length,
+                               char* dest,
+                               size_t dest_length,
+                               size_t* read) {
+  size_t utf8_length = simdutf::utf8_length_from_latin1(source, length);
+  if (utf8_length == length) {
+    // ASCII, which is the same in both encodings.
+    *read = std::min(length, dest_length);
+    memcpy(dest, source, *read);
+    return *read;
+  }
+
+  size_t count = length;
+  if (utf8_length > dest_length) {
+    // Characters above U+007F take two bytes in UTF-8.
+    size_t written = 0;
+    for (count = 0; count < length; count++) {
+      size_t needed = static_cast<uint8_t>(source[count]) < 0x80 ? 1 : 2;
+      if (written + needed > dest_length) break;
+      written += needed;
+    }
+  }
+
+  *read = count;
+  return simdutf::convert_latin1_to_utf8(source, count, dest);
+}
+
+void BindingData::FastEncodeInto(Local<Object> receiver,
+                                 const FastOneByteString& source,
+                                 const FastApiTypedArray<uint8_t>& dest) {
+  // The receiver is whatever encodeInto() was called on, which is not the
+  // binding once the function has been taken off it, so go through the
+  // realm like the slow path does.
+  Realm* realm = Realm::GetCurrent(receiver->GetIsolate());
+  BindingData* binding_data = realm->GetBindingData<BindingData>();
+  uint8_t* dest_data;
+  CHECK(dest.getStorageIfAligned(&dest_data));
+
+  size_t read;
+  size_t written = EncodeLatin1Into(source.data,
+                                    source.length,
+                                    reinterpret_cast<char*>(dest_data),
+                                    dest.length(),
+                                    &read);
+
+  binding_data->encode_into_results_buffer_[0] = read;
+  binding_data->encode_into_results_buffer_[1] = written;
+}
+
+CFunction BindingData::fast_encode_into_(CFunction::Make(FastEncodeInto));
+
 void BindingData::EncodeInto(const FunctionCallbackInfo<Value>& args) {
   CHECK_GE(args.Length(), 2);
   CHECK(args[0]->IsString());
@@ -119,10 +180,40 @@ void BindingData::EncodeUtf8String(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsString());
 
   Local<String> str = args[0].As<String>();
-  size_t length = str->Utf8Length(isolate);
 
   Local<ArrayBuffer> ab;
-  {
+  size_t length;
+  if (str->IsOneByte()) {
+    // Copying the Latin-1 contents out and converting them with simdutf is
+    // cheaper than letting V8 walk the string twice, once to compute the
+    // UTF-8 length and once more to write it.
+    size_t latin1_length = str->Length();
+    MaybeStackBuffer<uint8_t> latin1(latin1_length);
+    str->WriteOneByte(isolate,
+                      latin1.out(),
+                      0,
+                      latin1_length,
+                      String::NO_NULL_TERMINATION);
+    const char* latin1_data = reinterpret_cast<const char*>(latin1.out());
+    length = simdutf::utf8_length_from_latin1(latin1_data, latin1_length);
+
+    NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+    std::unique_ptr<BackingStore> bs =
+        ArrayBuffer::NewBackingStore(isolate, length);
+
+    CHECK(bs);
+
+    if (length == latin1_length) {
+      memcpy(bs->Data(), latin1_data, length);
+    } else {
+      size_t written = simdutf::convert_latin1_to_utf8(
+          latin1_data, latin1_length, static_cast<char*>(bs->Data()));
+      CHECK_EQ(written, length);
+    }
+
+    ab = ArrayBuffer::New(isolate, std::move(bs));
+  } else {
+    length = str->Utf8Length(isolate);
     NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
     std::unique_ptr<BackingStore> bs =
         ArrayBuffer::NewBackingStore(isolate, length);
@@ -218,14 +309,469 @@ void BindingData::ToUnicode(const v8::FunctionCallbackInfo<v8::Value>& args) {
       String::NewFromUtf8(env->isolate(), out.c_str()).ToLocalChecked());
 }
 
+namespace {
+
+// Returns the length of the sequence that |lead| starts, or 0 if it cannot
+// start one.
+inline size_t Utf8SequenceLength(uint8_t lead) {
+  if (lead < 0x80) return 1;
+  if (lead >= 0xc2 && lead <= 0xdf) return 2;
+  if (lead >= 0xe0 && lead <= 0xef) return 3;
+  if (lead >= 0xf0 && lead <= 0xf4) return 4;
+  return 0;
+}
+
+// Whether |byte| can follow the first |index| bytes of |sequence|. The
+// ranges for the second byte rule out overlong forms, surrogates and code
+// points above U+10FFFF, so only prefixes of valid sequences are accepted.
+inline bool IsValidNextByte(const uint8_t* sequence,
+                            size_t index,
+                            uint8_t byte) {
+  if (index > 1) return (byte & 0xc0) == 0x80;
+  switch (sequence[0]) {
+    case 0xe0:
+      return byte >= 0xa0 && byte <= 0xbf;
+    case 0xed:
+      return byte >= 0x80 && byte <= 0x9f;
+    case 0xf0:
+      return byte >= 0x90 && byte <= 0xbf;
+    case 0xf4:
+      return byte >= 0x80 && byte <= 0x8f;
+    default:
+      return byte >= 0x80 && byte <= 0xbf;
+  }
+}
+
+// Returns the length of the valid but incomplete sequence at the end of
+// |data|, if there is one.
+size_t IncompleteSuffixLength(const uint8_t* data, size_t length) {
+  for (size_t k = 1; k <= 3 && k <= length; k++) {
+    const uint8_t* lead = data + length - k;
+    if ((*lead & 0xc0) == 0x80) continue;
+    if (Utf8SequenceLength(*lead) <= k) return 0;
+    for (size_t i = 1; i < k; i++) {
+      if (!IsValidNextByte(lead, i, lead[i])) return 0;
+    }
+    return k;
+  }
+  return 0;
+}
+
+}  // anonymous namespace
+
+UTF8Decoder::UTF8Decoder(Environment* env,
+                         Local<Object> object,
+                         bool ignore_bom,
+                         bool fatal)
+    : BaseObject(env, object), ignore_bom_(ignore_bom), fatal_(fatal) {
+  MakeWeak();
+}
+
+void UTF8Decoder::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  new UTF8Decoder(env, args.This(), args[0]->IsTrue(), args[1]->IsTrue());
+}
+
+void UTF8Decoder::Reset() {
+  bom_seen_ = false;
+  pending_length_ = 0;
+}
+
+MaybeLocal<String> UTF8Decoder::DecodeChunk(const uint8_t* data,
+                                            size_t length,
+                                            bool stream) {
+  Isolate* isolate = env()->isolate();
+  Local<String> head = String::Empty(isolate);
+  size_t offset = 0;
+
+  // Complete the code point left over from the previous chunk first.
+  if (pending_length_ > 0) {
+    size_t needed = Utf8SequenceLength(pending_[0]);
+    while (pending_length_ < needed && offset < length &&
+           IsValidNextByte(pending_, pending_length_, data[offset])) {
+      pending_[pending_length_++] = data[offset++];
+    }
+
+    if (pending_length_ < needed && offset == length && stream) {
+      // Still incomplete, wait for the next chunk.
+      return head;
+    }
+
+    // Unless the sequence is complete, it was either cut short by an invalid
+    // byte or the input ended in the middle of it.
+    char16_t units[2] = {0xfffd};
+    size_t count = 1;
+    if (pending_length_ == needed) {
+      count = simdutf::convert_valid_utf8_to_utf16(
+          reinterpret_cast<const char*>(pending_), needed, units);
+    } else if (fatal_) {
+      Reset();
+      THROW_ERR_ENCODING_INVALID_ENCODED_DATA(
+          isolate, "The encoded data was not valid for encoding utf-8");
+      return MaybeLocal<String>();
+    }
+    pending_length_ = 0;
+
+    if (!bom_seen_) {
+      bom_seen_ = true;
+      if (!ignore_bom_ && count == 1 && units[0] == 0xfeff) count = 0;
+    }
+    head = String::NewFromTwoByte(isolate,
+                                  reinterpret_cast<const uint16_t*>(units),
+                                  NewStringType::kNormal,
+                                  count)
+               .ToLocalChecked();
+  }
+
+  size_t end = length;
+  if (stream) end -= IncompleteSuffixLength(data + offset, length - offset);
+
+  const char* body = reinterpret_cast<const char*>(data) + offset;
+  size_t body_length = end - offset;
+  if (!bom_seen_ && body_length > 0) {
+    bom_seen_ = true;
+    if (!ignore_bom_ && body_length >= 3 &&
+        memcmp(body, "\xEF\xBB\xBF", 3) == 0) {
+      body += 3;
+      body_length -= 3;
+    }
+  }
+
+  if (fatal_ && simdutf::validate_utf8_with_errors(body, body_length).error) {
+    Reset();
+    THROW_ERR_ENCODING_INVALID_ENCODED_DATA(
+        isolate, "The encoded data was not valid for encoding utf-8");
+    return MaybeLocal<String>();
+  }
+
+  Local<String> tail;
+  if (!StringBytes::DecodeUtf8(isolate, body, body_length).ToLocal(&tail)) {
+    Reset();
+    return MaybeLocal<String>();
+  }
+
+  if (stream) {
+    pending_length_ = length - end;
+    if (pending_length_ > 0) memcpy(pending_, data + end, pending_length_);
+  } else {
+    Reset();
+  }
+
+  if (head->Length() == 0) return tail;
+  return String::Concat(isolate, head, tail);
+}
+
+void UTF8Decoder::Decode(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  UTF8Decoder* decoder;
+  ASSIGN_OR_RETURN_UNWRAP(&decoder, args.This());
+
+  ArrayBufferViewContents<uint8_t> buffer;
+  if (!args[0]->IsUndefined()) {
+    if (!(args[0]->IsArrayBuffer() || args[0]->IsSharedArrayBuffer() ||
+          args[0]->IsArrayBufferView())) {
+      return THROW_ERR_INVALID_ARG_TYPE(
+          env->isolate(),
+          "The \"input\" argument must be an instance of SharedArrayBuffer, "
+          "ArrayBuffer or ArrayBufferView.");
+    }
+    buffer.ReadValue(args[0]);
+  }
+
+  Local<String> result;
+  if (decoder->DecodeChunk(buffer.data(), buffer.length(), args[1]->IsTrue())
+          .ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
+}
+
+void UTF8Decoder::CreatePerIsolateProperties(IsolateData* isolate_data,
+                                             Local<ObjectTemplate> target) {
+  Isolate* isolate = isolate_data->isolate();
+  Local<FunctionTemplate> t = NewFunctionTemplate(isolate, New);
+  t->InstanceTemplate()->SetInternalFieldCount(
+      BaseObject::kInternalFieldCount);
+  SetProtoMethod(isolate, t, "decode", Decode);
+  SetConstructorFunction(isolate, target, "UTF8Decoder", t);
+}
+
+void UTF8Decoder::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Decode);
+}
+
+namespace {
+
+// The whitespace that forgiving-base64 skips.
+bool IsBase64Whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\f' || c == '\r';
+}
+
+simdutf::base64_options Base64Options(bool url) {
+  return url ? simdutf::base64_url : simdutf::base64_default;
+}
+
+// Reads the input of Base64Encoder.encode() and Base64Decoder.decode(),
+// which may be left out when flushing.
+bool ReadInput(Environment* env,
+               Local<Value> input,
+               ArrayBufferViewContents<char>* contents) {
+  if (input->IsUndefined()) return true;
+  if (!(input->IsArrayBuffer() || input->IsSharedArrayBuffer() ||
+        input->IsArrayBufferView())) {
+    THROW_ERR_INVALID_ARG_TYPE(
+        env->isolate(),
+        "The \"input\" argument must be an instance of SharedArrayBuffer, "
+        "ArrayBuffer or ArrayBufferView.");
+    return false;
+  }
+  contents->ReadValue(input);
+  return true;
+}
+
+}  // anonymous namespace
+
+size_t Base64StreamEncoder::EncodedLength(size_t length, bool final) const {
+  size_t total = pending_length_ + length;
+  if (!final) total -= total % 3;
+  return simdutf::base64_length_from_binary(total, Base64Options(url_));
+}
+
+size_t Base64StreamEncoder::Encode(const char* data,
+                                   size_t length,
+                                   bool final,
+                                   char* out) {
+  simdutf::base64_options options = Base64Options(url_);
+  size_t offset = 0;
+  size_t written = 0;
+
+  // Complete the group left over from the previous chunk first.
+  if (pending_length_ > 0) {
+    offset = std::min(sizeof(pending_) - pending_length_, length);
+    memcpy(pending_ + pending_length_, data, offset);
+    pending_length_ += offset;
+    if (pending_length_ < sizeof(pending_) && !final) return 0;
+    written =
+        simdutf::binary_to_base64(pending_, pending_length_, out, options);
+    pending_length_ = 0;
+  }
+
+  size_t end = length;
+  if (!final) end -= (length - offset) % 3;
+  written += simdutf::binary_to_base64(
+      data + offset, end - offset, out + written, options);
+  pending_length_ = length - end;
+  memcpy(pending_, data + end, pending_length_);
+  return written;
+}
+
+size_t Base64StreamDecoder::MaxDecodedLength(const char* data,
+                                             size_t length) {
+  // The group left over from the previous chunk decodes to up to 3 bytes.
+  return 3 + simdutf::maximal_binary_length_from_base64(data, length);
+}
+
+bool Base64StreamDecoder::Fail() {
+  ended_ = false;
+  pending_length_ = 0;
+  return false;
+}
+
+bool Base64StreamDecoder::Decode(const char* data,
+                                 size_t length,
+                                 bool final,
+                                 char* out,
+                                 size_t* written) {
+  simdutf::base64_options options = Base64Options(url_);
+  size_t offset = 0;
+  *written = 0;
+
+  // Complete the group left over from the previous chunk first.
+  if (pending_length_ > 0) {
+    while (pending_length_ < sizeof(pending_) && offset < length) {
+      char c = data[offset++];
+      if (!IsBase64Whitespace(c)) pending_[pending_length_++] = c;
+    }
+    if (pending_length_ < sizeof(pending_) && !final) return true;
+
+    size_t outlen = 3;
+    simdutf::result result = simdutf::base64_to_binary_safe(
+        pending_, pending_length_, out, outlen, options);
+    if (result.error != simdutf::SUCCESS) return Fail();
+    ended_ = pending_[pending_length_ - 1] == '=';
+    pending_length_ = 0;
+    *written = outlen;
+  }
+
+  const char* body = data + offset;
+  size_t body_length = length - offset;
+  if (ended_) {
+    for (size_t i = 0; i < body_length; i++) {
+      if (!IsBase64Whitespace(body[i])) return Fail();
+    }
+    if (final) ended_ = false;
+    return true;
+  }
+
+  // Padding at the end of a chunk is kept along with the group it belongs to,
+  // which may continue in the next one.
+  size_t end = body_length;
+  if (!final) {
+    while (end > 0 &&
+           (body[end - 1] == '=' || IsBase64Whitespace(body[end - 1]))) {
+      end--;
+    }
+  }
+
+  size_t outlen = simdutf::maximal_binary_length_from_base64(body, end);
+  simdutf::result result = simdutf::base64_to_binary_safe(
+      body, end, out + *written, outlen, options);
+  // The number of characters of an incomplete last group.
+  size_t incomplete = 0;
+  if (result.error == simdutf::BASE64_INPUT_REMAINDER && !final) {
+    incomplete = 1;
+  } else if (result.error != simdutf::SUCCESS) {
+    return Fail();
+  } else if (!final && outlen % 3 != 0) {
+    incomplete = outlen % 3 + 1;
+    outlen -= outlen % 3;
+  }
+  *written += outlen;
+  if (final) return true;
+
+  // Keep the characters of the incomplete group and the padding after it.
+  size_t start = end;
+  for (size_t count = 0; count < incomplete; start--) {
+    if (!IsBase64Whitespace(body[start - 1])) count++;
+  }
+  for (size_t i = start; i < body_length; i++) {
+    if (IsBase64Whitespace(body[i])) continue;
+    if (pending_length_ == sizeof(pending_)) return Fail();
+    pending_[pending_length_++] = body[i];
+  }
+  return true;
+}
+
+Base64Encoder::Base64Encoder(Environment* env, Local<Object> object, bool url)
+    : BaseObject(env, object), encoder_(url) {
+  MakeWeak();
+}
+
+void Base64Encoder::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  new Base64Encoder(env, args.This(), args[0]->IsTrue());
+}
+
+void Base64Encoder::Encode(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Base64Encoder* encoder;
+  ASSIGN_OR_RETURN_UNWRAP(&encoder, args.This());
+
+  ArrayBufferViewContents<char> input;
+  if (!ReadInput(env, args[0], &input)) return;
+  bool final = args[1]->IsTrue();
+
+  size_t length = encoder->encoder_.EncodedLength(input.length(), final);
+  NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+  std::unique_ptr<BackingStore> bs =
+      ArrayBuffer::NewBackingStore(isolate, length);
+  CHECK(bs);
+  size_t written = encoder->encoder_.Encode(
+      input.data(), input.length(), final, static_cast<char*>(bs->Data()));
+  CHECK_EQ(written, length);
+
+  Local<ArrayBuffer> ab = ArrayBuffer::New(isolate, std::move(bs));
+  args.GetReturnValue().Set(Uint8Array::New(ab, 0, length));
+}
+
+void Base64Encoder::CreatePerIsolateProperties(IsolateData* isolate_data,
+                                               Local<ObjectTemplate> target) {
+  Isolate* isolate = isolate_data->isolate();
+  Local<FunctionTemplate> t = NewFunctionTemplate(isolate, New);
+  t->InstanceTemplate()->SetInternalFieldCount(
+      BaseObject::kInternalFieldCount);
+  SetProtoMethod(isolate, t, "encode", Encode);
+  SetConstructorFunction(isolate, target, "Base64Encoder", t);
+}
+
+void Base64Encoder::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Encode);
+}
+
+Base64Decoder::Base64Decoder(Environment* env, Local<Object> object, bool url)
+    : BaseObject(env, object), decoder_(url) {
+  MakeWeak();
+}
+
+void Base64Decoder::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  new Base64Decoder(env, args.This(), args[0]->IsTrue());
+}
+
+void Base64Decoder::Decode(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Base64Decoder* decoder;
+  ASSIGN_OR_RETURN_UNWRAP(&decoder, args.This());
+
+  ArrayBufferViewContents<char> input;
+  if (!ReadInput(env, args[0], &input)) return;
+
+  size_t capacity =
+      Base64StreamDecoder::MaxDecodedLength(input.data(), input.length());
+  NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+  std::unique_ptr<BackingStore> bs =
+      ArrayBuffer::NewBackingStore(isolate, capacity);
+  CHECK(bs);
+  size_t written;
+  if (!decoder->decoder_.Decode(input.data(),
+                                input.length(),
+                                args[1]->IsTrue(),
+                                static_cast<char*>(bs->Data()),
+                                &written)) {
+    return THROW_ERR_ENCODING_INVALID_ENCODED_DATA(
+        isolate, "The encoded data was not valid for encoding base64");
+  }
+  CHECK_LE(written, capacity);
+
+  Local<ArrayBuffer> ab = ArrayBuffer::New(isolate, std::move(bs));
+  args.GetReturnValue().Set(Uint8Array::New(ab, 0, written));
+}
+
+void Base64Decoder::CreatePerIsolateProperties(IsolateData* isolate_data,
+                                               Local<ObjectTemplate> target) {
+  Isolate* isolate = isolate_data->isolate();
+  Local<FunctionTemplate> t = NewFunctionTemplate(isolate, New);
+  t->InstanceTemplate()->SetInternalFieldCount(
+      BaseObject::kInternalFieldCount);
+  SetProtoMethod(isolate, t, "decode", Decode);
+  SetConstructorFunction(isolate, target, "Base64Decoder", t);
+}
+
+void Base64Decoder::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Decode);
+}
+
 void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
                                              Local<ObjectTemplate> target) {
   Isolate* isolate = isolate_data->isolate();
-  SetMethod(isolate, target, "encodeInto", EncodeInto);
+  SetFastMethod(isolate, target, "encodeInto", EncodeInto, &fast_encode_into_);
   SetMethodNoSideEffect(isolate, target, "encodeUtf8String", EncodeUtf8String);
   SetMethodNoSideEffect(isolate, target, "decodeUTF8", DecodeUTF8);
   SetMethodNoSideEffect(isolate, target, "toASCII", ToASCII);
   SetMethodNoSideEffect(isolate, target, "toUnicode", ToUnicode);
+  UTF8Decoder::CreatePerIsolateProperties(isolate_data, target);
+  Base64Encoder::CreatePerIsolateProperties(isolate_data, target);
+  Base64Decoder::CreatePerIsolateProperties(isolate_data, target);
 }
 
 void BindingData::CreatePerContextProperties(Local<Object> target,
@@ -239,10 +785,15 @@ void BindingData::CreatePerContextProperties(Local<Object> target,
 void BindingData::RegisterTimerExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(EncodeInto);
+  registry->Register(FastEncodeInto);
+  registry->Register(fast_encode_into_.GetTypeInfo());
   registry->Register(EncodeUtf8String);
   registry->Register(DecodeUTF8);
   registry->Register(ToASCII);
   registry->Register(ToUnicode);
+  UTF8Decoder::RegisterExternalReferences(registry);
+  Base64Encoder::RegisterExternalReferences(registry);
+  Base64Decoder::RegisterExternalReferences(registry);
 }
 
 }  // namespace encoding_binding
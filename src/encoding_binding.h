@@ -5,6 +5,7 @@
 
 #include <cinttypes>
 #include "aliased_buffer.h"
+#include "base_object.h"
 #include "node_snapshotable.h"
 #include "v8-fast-api-calls.h"
 
@@ -29,6 +30,9 @@ class BindingData : public SnapshotableObject {
   SET_MEMORY_INFO_NAME(BindingData)
 
   static void EncodeInto(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FastEncodeInto(v8::Local<v8::Object> receiver,
+                             const v8::FastOneByteString& source,
+                             const v8::FastApiTypedArray<uint8_t>& dest);
   static void EncodeUtf8String(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DecodeUTF8(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -46,10 +50,141 @@ class BindingData : public SnapshotableObject {
 
  private:
   static constexpr size_t kEncodeIntoResultsLength = 2;
+  static v8::CFunction fast_encode_into_;
   AliasedUint32Array encode_into_results_buffer_;
   InternalFieldInfo* internal_field_info_ = nullptr;
 };
 
+// Stateful UTF-8 decoder for TextDecoder's streaming mode. A code point that
+// is split across chunks is kept until the next decode() call, so each chunk
+// can be converted by simdutf directly instead of being concatenated with
+// the previous one.
+class UTF8Decoder : public BaseObject {
+ public:
+  UTF8Decoder(Environment* env,
+              v8::Local<v8::Object> object,
+              bool ignore_bom,
+              bool fatal);
+
+  // new UTF8Decoder(ignoreBOM, fatal)
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // decode(input, stream) returns the string for |input|. Unless |stream| is
+  // true, the decoder is flushed and reset to its initial state afterwards.
+  static void Decode(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void CreatePerIsolateProperties(IsolateData* isolate_data,
+                                         v8::Local<v8::ObjectTemplate> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(UTF8Decoder)
+  SET_SELF_SIZE(UTF8Decoder)
+
+ private:
+  v8::MaybeLocal<v8::String> DecodeChunk(const uint8_t* data,
+                                         size_t length,
+                                         bool stream);
+  void Reset();
+
+  const bool ignore_bom_;
+  const bool fatal_;
+  bool bom_seen_ = false;
+  // The valid but incomplete sequence at the end of the previous chunk.
+  uint8_t pending_[4];
+  size_t pending_length_ = 0;
+};
+
+// Incremental base64 encoder. The up to two bytes at the end of a chunk that
+// do not make up a whole group of three are kept for the next call, so all
+// others can be handed to simdutf as they are.
+class Base64StreamEncoder {
+ public:
+  explicit Base64StreamEncoder(bool url) : url_(url) {}
+
+  // The exact size of what Encode() writes for |length| more bytes.
+  size_t EncodedLength(size_t length, bool final) const;
+  // Writes the base64 of all whole groups of |data| to |out|, and the rest
+  // as well, padded unless encoding base64url, if |final| is true. Returns
+  // the number of characters written.
+  size_t Encode(const char* data, size_t length, bool final, char* out);
+
+ private:
+  const bool url_;
+  char pending_[3];
+  size_t pending_length_ = 0;
+};
+
+// Incremental forgiving-base64 decoder. The characters of a group that is
+// not complete at the end of a chunk, including any padding, are kept for
+// the next call, and ASCII whitespace is skipped.
+class Base64StreamDecoder {
+ public:
+  explicit Base64StreamDecoder(bool url) : url_(url) {}
+
+  // An upper bound for what Decode() writes for |data|.
+  static size_t MaxDecodedLength(const char* data, size_t length);
+  // Writes the bytes of all complete groups of |data| to |out|, and those of
+  // the last one as well if |final| is true, storing their number in
+  // |*written|. Returns false and resets the decoder if the input is not
+  // valid base64.
+  bool Decode(const char* data,
+              size_t length,
+              bool final,
+              char* out,
+              size_t* written);
+
+ private:
+  bool Fail();
+
+  const bool url_;
+  // Whether a padded group was decoded, after which only whitespace may
+  // follow.
+  bool ended_ = false;
+  char pending_[4];
+  size_t pending_length_ = 0;
+};
+
+// new Base64Encoder(url) and new Base64Decoder(url), for streams. Their
+// encode(input, final) and decode(input, final) return a Uint8Array with the
+// output for |input|, and reset the object afterwards if |final| is true.
+class Base64Encoder : public BaseObject {
+ public:
+  Base64Encoder(Environment* env, v8::Local<v8::Object> object, bool url);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Encode(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void CreatePerIsolateProperties(IsolateData* isolate_data,
+                                         v8::Local<v8::ObjectTemplate> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(Base64Encoder)
+  SET_SELF_SIZE(Base64Encoder)
+
+ private:
+  Base64StreamEncoder encoder_;
+};
+
+class Base64Decoder : public BaseObject {
+ public:
+  Base64Decoder(Environment* env, v8::Local<v8::Object> object, bool url);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Decode(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void CreatePerIsolateProperties(IsolateData* isolate_data,
+                                         v8::Local<v8::ObjectTemplate> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(Base64Decoder)
+  SET_SELF_SIZE(Base64Decoder)
+
+ private:
+  Base64StreamDecoder decoder_;
+};
+
 }  // namespace encoding_binding
 
 }  // namespace node
@@ -297,6 +297,11 @@ void Environment::DecreaseWaitingRequestCounter() {
   CHECK_GE(request_waiting_, 0);
 }
 
+ThreadPoolWorkQueue* Environment::threadpool_work_queue(
+    ThreadPoolWorkKind kind) {
+  return &threadpool_work_queues_[static_cast<size_t>(kind)];
+}
+
 inline uv_loop_t* Environment::event_loop() const {
   return isolate_data()->event_loop();
 }
@@ -315,6 +320,12 @@ inline AsyncHooks* Environment::async_hooks() {
   return &async_hooks_;
 }
 
+inline bool Environment::is_trace_category_enabled(
+    TraceCategory category) const {
+  return (trace_category_mask_.load(std::memory_order_relaxed) & category) !=
+         0;
+}
+
 inline ImmediateInfo* Environment::immediate_info() {
   return &immediate_info_;
 }
@@ -490,6 +501,24 @@ inline bool Environment::use_compile_cache() const {
   return compile_cache_handler_.get() != nullptr;
 }
 
+inline mem::NativeMemoryCounters* Environment::native_memory_counters() {
+  return &native_memory_counters_;
+}
+
+inline bool Environment::is_udp_batch_buffer(const char* data) const {
+  return udp_batch_buffer_in_use_ && data >= udp_batch_buffer_.get() &&
+         data < udp_batch_buffer_.get() + kUDPBatchBufferSize;
+}
+
+inline void Environment::release_udp_batch_buffer() {
+  udp_batch_buffer_in_use_ = false;
+}
+
+inline Environment::MessageObjectTemplateMap*
+Environment::message_object_templates() {
+  return &message_object_templates_;
+}
+
 #if HAVE_INSPECTOR
 inline void Environment::set_coverage_directory(const char* dir) {
   coverage_directory_ = std::string(dir);
@@ -611,9 +640,10 @@ template <typename Fn>
 void Environment::SetImmediateThreadsafe(Fn&& cb, CallbackFlags::Flags flags) {
   auto callback = native_immediates_threadsafe_.CreateCallback(
       std::move(cb), flags);
-  {
+  // Only the first callback of a batch has to wake up the event loop. The
+  // others are picked up together with it.
+  if (native_immediates_threadsafe_.Push(std::move(callback))) {
     Mutex::ScopedLock lock(native_immediates_threadsafe_mutex_);
-    native_immediates_threadsafe_.Push(std::move(callback));
     if (task_queues_async_initialized_)
       uv_async_send(&task_queues_async_);
   }
@@ -736,6 +766,16 @@ inline void Environment::remove_sub_worker_context(worker::Worker* context) {
   sub_worker_contexts_.erase(context);
 }
 
+inline const std::shared_ptr<worker::WorkerIsolatePool>&
+Environment::worker_isolate_pool() const {
+  return worker_isolate_pool_;
+}
+
+inline void Environment::set_worker_isolate_pool(
+    std::shared_ptr<worker::WorkerIsolatePool> pool) {
+  worker_isolate_pool_ = std::move(pool);
+}
+
 template <typename Fn>
 inline void Environment::ForEachWorker(Fn&& iterator) {
   for (worker::Worker* w : sub_worker_contexts_) iterator(w);
@@ -749,6 +789,14 @@ inline void Environment::set_stopping(bool value) {
   is_stopping_.store(value);
 }
 
+inline bool Environment::is_discarding() const {
+  return discarding_ && started_cleanup_;
+}
+
+inline void Environment::set_discarding(bool value) {
+  discarding_ = value;
+}
+
 inline std::list<node_module>* Environment::extra_linked_bindings() {
   return &extra_linked_bindings_;
 }
@@ -771,6 +819,15 @@ inline performance::PerformanceState* Environment::performance_state() {
   return performance_state_.get();
 }
 
+inline performance::EventLoopHistograms*
+Environment::event_loop_histograms() {
+  return event_loop_histograms_.get();
+}
+
+inline performance::GCHistograms* Environment::gc_histograms() {
+  return gc_histograms_.get();
+}
+
 inline IsolateData* Environment::isolate_data() const {
   return isolate_data_;
 }
@@ -9,11 +9,16 @@
 #include "node_context_data.h"
 #include "node_contextify.h"
 #include "node_errors.h"
+#if defined(NODE_HAVE_I18N_SUPPORT)
+#include "node_i18n.h"
+#endif
 #include "node_internals.h"
 #include "node_options-inl.h"
+#include "node_perf.h"
 #include "node_process-inl.h"
 #include "node_shadow_realm.h"
 #include "node_snapshotable.h"
+#include "node_sockaddr.h"
 #include "node_v8_platform-inl.h"
 #include "node_worker.h"
 #include "req_wrap-inl.h"
@@ -622,13 +627,34 @@ void IsolateData::MemoryInfo(MemoryTracker* tracker) const {
   if (node_allocator_ != nullptr) {
     tracker->TrackFieldWithSize(
         "node_allocator", sizeof(*node_allocator_), "NodeArrayBufferAllocator");
+    if (node_allocator_->pool() != nullptr)
+      tracker->TrackField("array_buffer_pool", node_allocator_->pool());
   }
   tracker->TrackFieldWithSize(
       "platform", sizeof(*platform_), "MultiIsolatePlatform");
   // TODO(joyeecheung): implement MemoryRetainer in the option classes.
 }
 
+void Environment::UpdateTraceCategoryMask() {
+  uint32_t mask = 0;
+  if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(
+          TRACING_CATEGORY_NODE1(async_hooks)) != 0) {
+    mask |= kTraceAsyncHooks;
+  }
+  if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(
+          TRACING_CATEGORY_NODE1(environment)) != 0) {
+    mask |= kTraceEnvironment;
+  }
+  if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(
+          TRACING_CATEGORY_NODE2(perf, event_loop)) != 0) {
+    mask |= kTracePerfEventLoop;
+  }
+  trace_category_mask_.store(mask, std::memory_order_relaxed);
+}
+
 void TrackingTraceStateObserver::UpdateTraceCategoryState() {
+  env_->UpdateTraceCategoryMask();
+
   if (!env_->owns_process_state() || !env_->can_call_into_js()) {
     // Ideally, we’d have a consistent story that treats all threads/Environment
     // instances equally here. However, tracing is essentially global, and this
@@ -746,6 +772,75 @@ std::unique_ptr<v8::BackingStore> Environment::release_managed_buffer(
   return bs;
 }
 
+uv_buf_t Environment::allocate_read_slab_buffer(ReadSlab* slab,
+                                                const size_t suggested_size) {
+  if (slab->in_use || suggested_size > kReadSlabSize)
+    return allocate_managed_buffer(suggested_size);
+
+  if (!slab->store || kReadSlabSize - slab->offset < suggested_size) {
+    // Drop our reference to the exhausted slab. It stays alive for as long
+    // as JS holds on to Buffers that were sliced from it.
+    slab->store.reset();
+    slab->array_buffer.Reset();
+    slab->offset = 0;
+
+    if (retained_read_slab_bytes_->load() + kReadSlabSize >
+        kMaxRetainedReadSlabBytes) {
+      return allocate_managed_buffer(suggested_size);
+    }
+
+    // Zeroed, so that the parts that have not been read into yet do not
+    // expose old heap contents through the ArrayBuffer.
+    char* data = UncheckedCalloc(kReadSlabSize);
+    if (data == nullptr) return allocate_managed_buffer(suggested_size);
+    *retained_read_slab_bytes_ += kReadSlabSize;
+    slab->store = v8::ArrayBuffer::NewBackingStore(
+        data,
+        kReadSlabSize,
+        [](void* data, size_t length, void* deleter_data) {
+          auto* retained =
+              static_cast<std::shared_ptr<std::atomic<size_t>>*>(deleter_data);
+          **retained -= length;
+          delete retained;
+          free(data);
+        },
+        new std::shared_ptr<std::atomic<size_t>>(retained_read_slab_bytes_));
+
+    v8::HandleScope handle_scope(isolate());
+    v8::Local<v8::ArrayBuffer> ab =
+        v8::ArrayBuffer::New(isolate(), slab->store);
+    // Slices of the slab are handed out for every read of the stream, so
+    // the whole ArrayBuffer must never be transferred to another thread.
+    if (ab->SetPrivate(context(),
+                       untransferable_object_private_symbol(),
+                       v8::True(isolate()))
+            .IsNothing()) {
+      slab->store.reset();
+      return allocate_managed_buffer(suggested_size);
+    }
+    slab->array_buffer.Reset(isolate(), ab);
+  }
+
+  slab->in_use = true;
+  return uv_buf_init(static_cast<char*>(slab->store->Data()) + slab->offset,
+                     kReadSlabSize - slab->offset);
+}
+
+v8::Local<v8::ArrayBuffer> Environment::release_read_slab_buffer(
+    ReadSlab* slab, const uv_buf_t& buf, size_t nread, size_t* offset) {
+  if (!slab->in_use || buf.base == nullptr ||
+      buf.base != static_cast<char*>(slab->store->Data()) + slab->offset) {
+    return v8::Local<v8::ArrayBuffer>();
+  }
+  slab->in_use = false;
+  CHECK_LE(nread, kReadSlabSize - slab->offset);
+  *offset = slab->offset;
+  // Keep the next read 8-byte aligned.
+  slab->offset = RoundUp<size_t>(slab->offset + nread, 8);
+  if (slab->offset > kReadSlabSize) slab->offset = kReadSlabSize;
+  return PersistentToLocal::Strong(slab->array_buffer);
+}
+
 std::string Environment::GetExecPath(const std::vector<std::string>& argv) {
   char exec_path_buf[2 * PATH_MAX];
   size_t exec_path_len = sizeof(exec_path_buf);
@@ -823,7 +918,11 @@ Environment::Environment(IsolateData* isolate_data,
     per_process::Debug(DebugCategory::CODE_CACHE,
                        "snapshot contains %zu code cache\n",
                        cache_size);
-    if (cache_size > 0) {
+    if (cache_size > 0 && is_shared_ro_heap) {
+      // All isolates deserialized from the snapshot share the read only
+      // space, so one code cache can be used by all of their Environments.
+      builtin_loader()->UseSharedCodeCache(isolate_data->snapshot_data());
+    } else if (cache_size > 0) {
       builtin_loader()->RefreshCodeCache(
           isolate_data->snapshot_data()->code_cache);
     }
@@ -875,8 +974,13 @@ Environment::Environment(IsolateData* isolate_data,
 
   if (tracing::AgentWriterHandle* writer = GetTracingAgentWriter()) {
     trace_state_observer_ = std::make_unique<TrackingTraceStateObserver>(this);
-    if (TracingController* tracing_controller = writer->GetTracingController())
+    if (TracingController* tracing_controller =
+            writer->GetTracingController()) {
+      // The observer is notified if tracing is already enabled, but not if
+      // it is disabled, so the mask has to be initialized before.
+      UpdateTraceCategoryMask();
       tracing_controller->AddTraceStateObserver(trace_state_observer_.get());
+    }
   }
 
   destroy_async_id_list_.reserve(512);
@@ -886,6 +990,7 @@ Environment::Environment(IsolateData* isolate_data,
       time_origin_,
       time_origin_timestamp_,
       MAYBE_FIELD_PTR(env_info, performance_state));
+  event_loop_histograms_ = std::make_unique<performance::EventLoopHistograms>();
 
   if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(
           TRACING_CATEGORY_NODE1(environment)) != 0) {
@@ -959,6 +1064,12 @@ void Environment::InitializeMainContext(Local<Context> context,
   performance_state_->Mark(performance::NODE_PERFORMANCE_MILESTONE_NODE_START,
                            per_process::node_start_time);
 
+  if (performance::performance_options_parsed != 0) {
+    performance_state_->Mark(
+        performance::NODE_PERFORMANCE_MILESTONE_OPTIONS_PARSED,
+        performance::performance_options_parsed);
+  }
+
   if (per_process::v8_initialized) {
     performance_state_->Mark(performance::NODE_PERFORMANCE_MILESTONE_V8_START,
                             performance::performance_v8_start);
@@ -1036,6 +1147,11 @@ Environment::~Environment() {
   }
 }
 
+void Environment::set_gc_histograms(
+    std::unique_ptr<performance::GCHistograms> value) {
+  gc_histograms_ = std::move(value);
+}
+
 void Environment::InitializeLibuv() {
   HandleScope handle_scope(isolate());
   Context::Scope context_scope(context());
@@ -1071,10 +1187,33 @@ void Environment::InitializeLibuv() {
   uv_unref(reinterpret_cast<uv_handle_t*>(&idle_check_handle_));
   uv_unref(reinterpret_cast<uv_handle_t*>(&task_queues_async_));
 
+  // Time the poll phase of every loop iteration. The check handle is started
+  // after the one for immediates, so libuv runs it first.
+  CHECK_EQ(0, uv_prepare_init(event_loop(), &loop_phase_prepare_handle_));
+  CHECK_EQ(0, uv_check_init(event_loop(), &loop_phase_check_handle_));
+  CHECK_EQ(0, uv_prepare_start(
+      &loop_phase_prepare_handle_,
+      [](uv_prepare_t* handle) {
+        Environment* env = ContainerOf(
+            &Environment::loop_phase_prepare_handle_, handle);
+        env->event_loop_histograms()->BeforePoll(
+            uv_hrtime(), uv_metrics_idle_time(env->event_loop()));
+      }));
+  CHECK_EQ(0, uv_check_start(
+      &loop_phase_check_handle_,
+      [](uv_check_t* handle) {
+        Environment* env = ContainerOf(
+            &Environment::loop_phase_check_handle_, handle);
+        env->event_loop_histograms()->AfterPoll(
+            uv_hrtime(), uv_metrics_idle_time(env->event_loop()));
+      }));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&loop_phase_prepare_handle_));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&loop_phase_check_handle_));
+
   {
     Mutex::ScopedLock lock(native_immediates_threadsafe_mutex_);
     task_queues_async_initialized_ = true;
-    if (native_immediates_threadsafe_.size() > 0 ||
+    if (!native_immediates_threadsafe_.empty() ||
         native_immediates_interrupts_.size() > 0) {
       uv_async_send(&task_queues_async_);
     }
@@ -1107,6 +1246,36 @@ void Environment::InitializeCompileCache() {
   }
 }
 
+fs::ModuleFSCache* Environment::module_fs_cache() {
+  if (!module_fs_cache_) {
+    module_fs_cache_ = std::make_unique<fs::ModuleFSCache>(this);
+  }
+  return module_fs_cache_.get();
+}
+
+contextify::ScriptCache* Environment::script_cache() {
+  if (!script_cache_) {
+    script_cache_ = std::make_unique<contextify::ScriptCache>();
+  }
+  return script_cache_.get();
+}
+
+SocketAddressStringCache* Environment::address_string_cache() {
+  if (!address_string_cache_) {
+    address_string_cache_ = std::make_unique<SocketAddressStringCache>();
+  }
+  return address_string_cache_.get();
+}
+
+#if defined(NODE_HAVE_I18N_SUPPORT)
+i18n::ConverterPool* Environment::converter_pool() {
+  if (!converter_pool_) {
+    converter_pool_ = std::make_unique<i18n::ConverterPool>();
+  }
+  return converter_pool_.get();
+}
+#endif
+
 void Environment::ExitEnv(StopFlags::Flags flags) {
   // Should not access non-thread-safe methods here.
   set_stopping(true);
@@ -1145,6 +1314,8 @@ void Environment::RegisterHandleCleanups() {
   register_handle(reinterpret_cast<uv_handle_t*>(immediate_idle_handle()));
   register_handle(reinterpret_cast<uv_handle_t*>(&idle_prepare_handle_));
   register_handle(reinterpret_cast<uv_handle_t*>(&idle_check_handle_));
+  register_handle(reinterpret_cast<uv_handle_t*>(&loop_phase_prepare_handle_));
+  register_handle(reinterpret_cast<uv_handle_t*>(&loop_phase_check_handle_));
   register_handle(reinterpret_cast<uv_handle_t*>(&task_queues_async_));
 }
 
@@ -1228,7 +1399,7 @@ void Environment::RunCleanup() {
 
   while (!cleanup_queue_.empty() || principal_realm_->HasCleanupHooks() ||
          native_immediates_.size() > 0 ||
-         native_immediates_threadsafe_.size() > 0 ||
+         !native_immediates_threadsafe_.empty() ||
          native_immediates_interrupts_.size() > 0) {
     // TODO(legendecas): cleanup handles in per-realm cleanup hooks as well.
     principal_realm_->RunCleanup();
@@ -1236,6 +1407,8 @@ void Environment::RunCleanup() {
     CleanupHandles();
   }
 
+  while (DestroyParam* param = destroy_param_queue_.PopFront()) delete param;
+
   for (const int fd : unmanaged_fds_) {
     uv_fs_t close_req;
     uv_fs_close(nullptr, &close_req, fd, nullptr);
@@ -1351,18 +1524,14 @@ void Environment::RunAndClearNativeImmediates(bool only_refed) {
   if (immediate_info()->ref_count() == 0)
     ToggleImmediateRef(false);
 
-  // It is safe to check .size() first, because there is a causal relationship
-  // between pushes to the threadsafe immediate list and this function being
-  // called. For the common case, it's worth checking the size first before
-  // establishing a mutex lock.
+  // The threadsafe immediate list is taken over without a lock. Entries that
+  // are pushed after this point wake up the event loop again.
   // This is intentionally placed after the `ref_count` handling, because when
   // refed threadsafe immediates are created, they are not counted towards the
   // count in immediate_info() either.
   NativeImmediateQueue threadsafe_immediates;
-  if (native_immediates_threadsafe_.size() > 0) {
-    Mutex::ScopedLock lock(native_immediates_threadsafe_mutex_);
-    threadsafe_immediates.ConcatMove(std::move(native_immediates_threadsafe_));
-  }
+  if (!native_immediates_threadsafe_.empty())
+    native_immediates_threadsafe_.TakeAll(&threadsafe_immediates);
   while (drain_list(&threadsafe_immediates)) {}
 }
 
@@ -1421,6 +1590,12 @@ void Environment::RunTimers(uv_timer_t* handle) {
   if (!env->can_call_into_js())
     return;
 
+  uint64_t start = uv_hrtime();
+  auto record_duration = OnScopeLeave([&]() {
+    env->event_loop_histograms()->RecordPhase(
+        performance::NODE_PERFORMANCE_LOOP_PHASE_TIMERS, uv_hrtime() - start);
+  });
+
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
@@ -1479,6 +1654,12 @@ void Environment::CheckImmediate(uv_check_t* handle) {
   Environment* env = Environment::from_immediate_check_handle(handle);
   TRACE_EVENT0(TRACING_CATEGORY_NODE1(environment), "CheckImmediate");
 
+  uint64_t start = uv_hrtime();
+  auto record_duration = OnScopeLeave([&]() {
+    env->event_loop_histograms()->RecordPhase(
+        performance::NODE_PERFORMANCE_LOOP_PHASE_CHECK, uv_hrtime() - start);
+  });
+
   HandleScope scope(env->isolate());
   Context::Scope context_scope(env->context());
 
@@ -1511,6 +1692,16 @@ void Environment::ToggleImmediateRef(bool ref) {
   }
 }
 
+void Environment::ScheduleTaskQueueFlush() {
+  if (task_queue_flush_scheduled_) return;
+  task_queue_flush_scheduled_ = true;
+  // The callback itself has nothing to do. Native immediates run inside a
+  // callback scope of their own, and closing that scope runs the queues.
+  SetImmediate([](Environment* env) {
+    env->task_queue_flush_scheduled_ = false;
+  });
+}
+
 uint64_t Environment::GetNowUint64() {
   uv_update_time(event_loop());
   uint64_t now = uv_now(event_loop());
@@ -1803,10 +1994,17 @@ void Environment::stop_sub_worker_contexts() {
   DCHECK_EQ(Isolate::GetCurrent(), isolate());
 
   while (!sub_worker_contexts_.empty()) {
-    Worker* w = *sub_worker_contexts_.begin();
-    remove_sub_worker_context(w);
-    w->Exit(ExitCode::kGenericUserError);
-    w->JoinThread();
+    // Tell all Workers to stop before waiting for any of them, so that they
+    // tear down their Environments and isolates in parallel rather than one
+    // after the other. The Worker objects are deleted from a threadsafe
+    // immediate, which cannot run while we are in here.
+    std::vector<Worker*> workers(sub_worker_contexts_.begin(),
+                                 sub_worker_contexts_.end());
+    for (Worker* w : workers) {
+      remove_sub_worker_context(w);
+      w->Exit(ExitCode::kGenericUserError);
+    }
+    for (Worker* w : workers) w->JoinThread();
   }
 }
 
@@ -1815,6 +2013,17 @@ Environment* Environment::worker_parent_env() const {
   return worker_context()->env();
 }
 
+ThreadPoolWorkQueue* Environment::threadpool_work_pool(const std::string& name,
+                                                      size_t limit) {
+  auto [it, inserted] = threadpool_work_pools_.try_emplace(name);
+  if (inserted) {
+    it->second.limit = limit;
+  } else if (it->second.limit != limit) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
 void Environment::AddUnmanagedFd(int fd) {
   if (!tracks_unmanaged_fds()) return;
   auto result = unmanaged_fds_.insert(fd);
@@ -1844,6 +2053,10 @@ EnvSerializeInfo Environment::Serialize(SnapshotCreator* creator) {
   EnvSerializeInfo info;
   Local<Context> ctx = context();
 
+  // The scripts are not part of the snapshot, and their strong handles
+  // must not outlive the heap they are created from.
+  script_cache_.reset();
+
   info.async_hooks = async_hooks_.Serialize(ctx, creator);
   info.immediate_info = immediate_info_.Serialize(ctx, creator);
   info.timeout_info = timeout_info_.Serialize(ctx, creator);
@@ -2130,6 +2343,7 @@ void Environment::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("tick_info", tick_info_);
   tracker->TrackField("principal_realm", principal_realm_);
   tracker->TrackField("shadow_realms", shadow_realms_);
+  tracker->TrackField("script_cache", script_cache_);
 
   // FIXME(joyeecheung): track other fields in Environment.
   // Currently MemoryTracker is unable to track these
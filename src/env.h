@@ -35,11 +35,13 @@
 #include "debug_utils.h"
 #include "env_properties.h"
 #include "handle_wrap.h"
+#include "module_fs_cache.h"
 #include "node.h"
 #include "node_binding.h"
 #include "node_builtins.h"
 #include "node_exit_code.h"
 #include "node_main_instance.h"
+#include "node_mem.h"
 #include "node_options.h"
 #include "node_perf_common.h"
 #include "node_realm.h"
@@ -57,8 +59,10 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <ostream>
 #include <set>
@@ -79,9 +83,24 @@ class ShadowRealm;
 namespace contextify {
 class ContextifyScript;
 class CompiledFnEntry;
+class ScriptCache;
+}
+
+class SocketAddressStringCache;
+
+#if defined(NODE_HAVE_I18N_SUPPORT)
+namespace i18n {
+class ConverterPool;
+}
+#endif
+
+namespace cares_wrap {
+class GetAddrInfoReqWrap;
 }
 
 namespace performance {
+class EventLoopHistograms;
+class GCHistograms;
 class PerformanceState;
 }
 
@@ -103,6 +122,7 @@ class ParentInspectorHandle;
 
 namespace worker {
 class Worker;
+class WorkerIsolatePool;
 }
 
 namespace loader {
@@ -110,6 +130,31 @@ class ModuleWrap;
 }  // namespace loader
 
 class Environment;
+class ThreadPoolWork;
+
+// The kind of work a ThreadPoolWork submits to the libuv threadpool. Each
+// kind can be given its own concurrency limit so that one of them cannot
+// occupy every threadpool thread.
+enum class ThreadPoolWorkKind : uint8_t {
+  kCpu,    // CPU-bound work such as crypto and zlib.
+  kFs,     // File system work.
+  kOther,  // N-API and everything else.
+};
+constexpr size_t kThreadPoolWorkKindCount = 3;
+
+// ThreadPoolWork of one kind that is currently in the libuv threadpool, and
+// work that is held back on the event loop until fewer of them are. Named
+// pools, see Environment::threadpool_work_pool(), are queues of their own
+// with a fixed limit.
+struct ThreadPoolWorkQueue {
+  // The limit of a named pool. Per-kind queues take theirs from the options.
+  size_t limit = 0;
+  size_t running = 0;
+  std::deque<ThreadPoolWork*> waiting;
+  // Reported by internalBinding('process_methods').getThreadPoolInfo().
+  size_t max_waiting = 0;
+  uint64_t completed = 0;
+};
 class Realm;
 
 // Disables zero-filling for ArrayBuffer allocations in this scope. This is
@@ -550,6 +595,9 @@ struct SnapshotData {
   static const SnapshotIndex kNodeVMContextIndex = 0;
   static const SnapshotIndex kNodeBaseContextIndex = kNodeVMContextIndex + 1;
   static const SnapshotIndex kNodeMainContextIndex = kNodeBaseContextIndex + 1;
+  // A vm context without the interceptors of kNodeVMContextIndex.
+  static const SnapshotIndex kNodeVMVanillaContextIndex =
+      kNodeMainContextIndex + 1;
 
   DataOwnership data_ownership = DataOwnership::kOwned;
 
@@ -569,6 +617,11 @@ struct SnapshotData {
   // read only space. We use builtins::CodeCacheInfo because
   // v8::ScriptCompiler::CachedData is not copyable.
   std::vector<builtins::CodeCacheInfo> code_cache;
+  // The code cache above, indexed once and shared by the builtin loaders
+  // of the Environments deserialized from this snapshot, see
+  // BuiltinLoader::UseSharedCodeCache(). This is not serialized.
+  mutable std::shared_ptr<builtins::BuiltinLoader::BuiltinCodeCache>
+      shared_code_cache;
 
   void ToFile(FILE* out) const;
   std::vector<char> ToBlob() const;
@@ -710,6 +763,16 @@ class Environment : public MemoryRetainer {
 
   inline void IncreaseWaitingRequestCounter();
   inline void DecreaseWaitingRequestCounter();
+  inline ThreadPoolWorkQueue* threadpool_work_queue(ThreadPoolWorkKind kind);
+  // Returns the named pool, creating it with the given concurrency limit if
+  // there is none yet. Returns nullptr if the pool exists with a different
+  // limit. Pools live as long as the Environment.
+  ThreadPoolWorkQueue* threadpool_work_pool(const std::string& name,
+                                            size_t limit);
+  const std::map<std::string, ThreadPoolWorkQueue>& threadpool_work_pools()
+      const {
+    return threadpool_work_pools_;
+  }
 
   inline AsyncHooks* async_hooks();
   inline ImmediateInfo* immediate_info();
@@ -767,6 +830,22 @@ class Environment : public MemoryRetainer {
 
   inline performance::PerformanceState* performance_state();
 
+  // Categories of Node.js' own trace events whose enabled state is cached
+  // here, so that hot paths can skip emitting them with a single load.
+  enum TraceCategory : uint32_t {
+    kTraceAsyncHooks = 1 << 0,
+    kTraceEnvironment = 1 << 1,
+    kTracePerfEventLoop = 1 << 2,
+  };
+  inline bool is_trace_category_enabled(TraceCategory category) const;
+  // Called by the trace state observer whenever tracing starts or stops.
+  // This may run on any thread.
+  void UpdateTraceCategoryMask();
+  inline performance::EventLoopHistograms* event_loop_histograms();
+  // nullptr unless GC histograms have been started.
+  inline performance::GCHistograms* gc_histograms();
+  void set_gc_histograms(std::unique_ptr<performance::GCHistograms> value);
+
   void CollectUVExceptionInfo(v8::Local<v8::Value> context,
                               int errorno,
                               const char* syscall = nullptr,
@@ -810,12 +889,22 @@ class Environment : public MemoryRetainer {
   Environment* worker_parent_env() const;
   inline void add_sub_worker_context(worker::Worker* context);
   inline void remove_sub_worker_context(worker::Worker* context);
+  inline const std::shared_ptr<worker::WorkerIsolatePool>&
+  worker_isolate_pool() const;
+  inline void set_worker_isolate_pool(
+      std::shared_ptr<worker::WorkerIsolatePool> pool);
   void stop_sub_worker_contexts();
   template <typename Fn>
   inline void ForEachWorker(Fn&& iterator);
   // Determine if the environment is stopping. This getter is thread-safe.
   inline bool is_stopping() const;
   inline void set_stopping(bool value);
+  // Set for an Environment whose isolate is disposed right after it is
+  // freed, as that of a Worker is. BaseObjects that are deleted by its
+  // cleanup then leave their JS objects alone rather than clearing the
+  // pointers to them, since no code looks at those objects again.
+  inline bool is_discarding() const;
+  inline void set_discarding(bool value);
   inline std::list<node_module>* extra_linked_bindings();
   inline node_module* extra_linked_bindings_head();
   inline node_module* extra_linked_bindings_tail();
@@ -899,6 +988,12 @@ class Environment : public MemoryRetainer {
   inline HandleWrapQueue* handle_wrap_queue() { return &handle_wrap_queue_; }
   inline ReqWrapQueue* req_wrap_queue() { return &req_wrap_queue_; }
 
+  typedef ListHead<DestroyParam, &DestroyParam::destroy_param_queue_>
+      DestroyParamQueue;
+  inline DestroyParamQueue* destroy_param_queue() {
+    return &destroy_param_queue_;
+  }
+
   // https://w3c.github.io/hr-time/#dfn-time-origin
   inline uint64_t time_origin() {
     return time_origin_;
@@ -938,6 +1033,10 @@ class Environment : public MemoryRetainer {
   inline void RequestInterrupt(Fn&& cb);
   // This needs to be available for the JS-land setImmediate().
   void ToggleImmediateRef(bool ref);
+  // Makes sure that the nextTick and microtask queues are run later in this
+  // event loop iteration, on behalf of callbacks that were allowed to skip
+  // them.
+  void ScheduleTaskQueueFlush();
 
   inline void PushShouldNotAbortOnUncaughtScope();
   inline void PopShouldNotAbortOnUncaughtScope();
@@ -1016,12 +1115,70 @@ class Environment : public MemoryRetainer {
   inline bool use_compile_cache() const;
   void InitializeCompileCache();
 
+  inline mem::NativeMemoryCounters* native_memory_counters();
+
+  // Created on first use.
+  fs::ModuleFSCache* module_fs_cache();
+  contextify::ScriptCache* script_cache();
+  SocketAddressStringCache* address_string_cache();
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  i18n::ConverterPool* converter_pool();
+#endif
+
+  // The getaddrinfo() requests that are in flight, keyed by host, family and
+  // flags, so that concurrent lookups of the same host can share one.
+  std::unordered_map<std::string, cares_wrap::GetAddrInfoReqWrap*>*
+  pending_getaddrinfo() {
+    return &pending_getaddrinfo_;
+  }
+
   void RunAndClearNativeImmediates(bool only_refed = false);
   void RunAndClearInterrupts();
 
   uv_buf_t allocate_managed_buffer(const size_t suggested_size);
   std::unique_ptr<v8::BackingStore> release_managed_buffer(const uv_buf_t& buf);
 
+  // The reads of a stream that are consumed right away can share a slab
+  // instead of allocating a fresh BackingStore per read. JS gets the slab's
+  // ArrayBuffer, so a slab belongs to a single stream and starts out zeroed:
+  // it only ever exposes data that the same stream has already emitted.
+  struct ReadSlab {
+    std::shared_ptr<v8::BackingStore> store;
+    v8::Global<v8::ArrayBuffer> array_buffer;
+    size_t offset = 0;
+    bool in_use = false;
+  };
+
+  // allocate_read_slab_buffer() falls back to allocate_managed_buffer() when
+  // the slab is busy or when too much slab memory is still referenced.
+  // release_read_slab_buffer() returns the slab's ArrayBuffer and the offset
+  // of the `nread` bytes within it, or an empty handle if `buf` was not
+  // carved out of the slab, in which case release_managed_buffer() applies.
+  static constexpr size_t kReadSlabSize = 256 * 1024;
+  static constexpr size_t kMaxRetainedReadSlabBytes = 16 * kReadSlabSize;
+  uv_buf_t allocate_read_slab_buffer(ReadSlab* slab,
+                                     const size_t suggested_size);
+  v8::Local<v8::ArrayBuffer> release_read_slab_buffer(ReadSlab* slab,
+                                                      const uv_buf_t& buf,
+                                                      size_t nread,
+                                                      size_t* offset);
+
+  // Scratch buffer for UDP handles that read with recvmmsg(). libuv fills it
+  // and reports every datagram in it before the read callback batch ends,
+  // so one buffer per Environment is enough. Datagrams must be copied out
+  // before the buffer is released.
+  static constexpr size_t kUDPBatchBufferSize = 16 * 64 * 1024;
+  uv_buf_t allocate_udp_batch_buffer();
+  inline bool is_udp_batch_buffer(const char* data) const;
+  inline void release_udp_batch_buffer();
+
+  // Templates for the plain objects in messages that were encoded by the
+  // fast path of worker::Message::Serialize(), keyed by the encoded list of
+  // property names.
+  using MessageObjectTemplateMap =
+      std::unordered_map<std::string, v8::Global<v8::DictionaryTemplate>>;
+  inline MessageObjectTemplateMap* message_object_templates();
+
   void AddUnmanagedFd(int fd);
   void RemoveUnmanagedFd(int fd);
 
@@ -1068,6 +1225,8 @@ class Environment : public MemoryRetainer {
   uv_idle_t immediate_idle_handle_;
   uv_prepare_t idle_prepare_handle_;
   uv_check_t idle_check_handle_;
+  uv_prepare_t loop_phase_prepare_handle_;
+  uv_check_t loop_phase_check_handle_;
   uv_async_t task_queues_async_;
   int64_t task_queues_async_refs_ = 0;
 
@@ -1091,6 +1250,7 @@ class Environment : public MemoryRetainer {
 
   size_t async_callback_scope_depth_ = 0;
   std::vector<double> destroy_async_id_list_;
+  DestroyParamQueue destroy_param_queue_;
   std::unordered_set<shadow_realm::ShadowRealm*> shadow_realms_;
 
 #if HAVE_INSPECTOR
@@ -1107,6 +1267,15 @@ class Environment : public MemoryRetainer {
 #endif  // HAVE_INSPECTOR
 
   std::unique_ptr<CompileCacheHandler> compile_cache_handler_;
+  std::unique_ptr<fs::ModuleFSCache> module_fs_cache_;
+  std::unique_ptr<contextify::ScriptCache> script_cache_;
+  std::unique_ptr<SocketAddressStringCache> address_string_cache_;
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  std::unique_ptr<i18n::ConverterPool> converter_pool_;
+#endif
+  std::unordered_map<std::string, cares_wrap::GetAddrInfoReqWrap*>
+      pending_getaddrinfo_;
+  mem::NativeMemoryCounters native_memory_counters_;
   std::shared_ptr<EnvironmentOptions> options_;
   // options_ contains debug options parsed from CLI arguments,
   // while inspector_host_port_ stores the actual inspector host
@@ -1136,6 +1305,10 @@ class Environment : public MemoryRetainer {
   int should_not_abort_scope_counter_ = 0;
 
   std::unique_ptr<TrackingTraceStateObserver> trace_state_observer_;
+  // Without an observer, the state of the categories cannot be tracked, so
+  // all of them are assumed to be enabled and the trace event sites check
+  // them on their own.
+  std::atomic<uint32_t> trace_category_mask_{~0u};
 
   AliasedInt32Array stream_base_state_;
 
@@ -1151,12 +1324,16 @@ class Environment : public MemoryRetainer {
   // This is the time when the environment is created.
   const uint64_t environment_start_;
   std::unique_ptr<performance::PerformanceState> performance_state_;
+  std::unique_ptr<performance::EventLoopHistograms> event_loop_histograms_;
+  std::unique_ptr<performance::GCHistograms> gc_histograms_;
 
   bool has_serialized_options_ = false;
 
   uint64_t flags_;
   uint64_t thread_id_;
   std::unordered_set<worker::Worker*> sub_worker_contexts_;
+  // Isolates created ahead of time for Workers started by this Environment.
+  std::shared_ptr<worker::WorkerIsolatePool> worker_isolate_pool_;
 
 #if HAVE_INSPECTOR
   std::unique_ptr<inspector::Agent> inspector_agent_;
@@ -1177,6 +1354,9 @@ class Environment : public MemoryRetainer {
   std::list<HandleCleanup> handle_cleanup_queue_;
   int handle_cleanup_waiting_ = 0;
   int request_waiting_ = 0;
+  std::array<ThreadPoolWorkQueue, kThreadPoolWorkKindCount>
+      threadpool_work_queues_;
+  std::map<std::string, ThreadPoolWorkQueue> threadpool_work_pools_;
 
   EnabledDebugList enabled_debug_list_;
 
@@ -1195,8 +1375,9 @@ class Environment : public MemoryRetainer {
 
   typedef CallbackQueue<void, Environment*> NativeImmediateQueue;
   NativeImmediateQueue native_immediates_;
+  // Pushing to this list does not need a lock.
+  ThreadsafeCallbackQueue<void, Environment*> native_immediates_threadsafe_;
   Mutex native_immediates_threadsafe_mutex_;
-  NativeImmediateQueue native_immediates_threadsafe_;
   NativeImmediateQueue native_immediates_interrupts_;
   // Also guarded by native_immediates_threadsafe_mutex_. This can be used when
   // trying to post tasks from other threads to an Environment, as the libuv
@@ -1210,6 +1391,8 @@ class Environment : public MemoryRetainer {
 
   CleanupQueue cleanup_queue_;
   bool started_cleanup_ = false;
+  bool discarding_ = false;
+  bool task_queue_flush_scheduled_ = false;
 
   std::unordered_set<int> unmanaged_fds_;
 
@@ -1225,6 +1408,17 @@ class Environment : public MemoryRetainer {
   // track of the BackingStore for a given pointer.
   std::unordered_map<char*, std::unique_ptr<v8::BackingStore>>
       released_allocated_buffers_;
+
+  // The memory of all read slabs of this Environment that is still alive.
+  // It is shared with the BackingStore deleters, which may run after the
+  // Environment is gone.
+  std::shared_ptr<std::atomic<size_t>> retained_read_slab_bytes_ =
+      std::make_shared<std::atomic<size_t>>(0);
+
+  std::unique_ptr<char[]> udp_batch_buffer_;
+  bool udp_batch_buffer_in_use_ = false;
+
+  MessageObjectTemplateMap message_object_templates_;
 };
 
 }  // namespace node
@@ -26,9 +26,21 @@
 #include "node_external_reference.h"
 #include "permission/permission.h"
 #include "string_bytes.h"
+#include "threadpoolwork-inl.h"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <filesystem>
+#endif
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::DontDelete;
 using v8::DontEnum;
@@ -39,6 +51,7 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
+using v8::Number;
 using v8::Object;
 using v8::PropertyAttribute;
 using v8::ReadOnly;
@@ -59,21 +72,73 @@ class FSEventWrap: public HandleWrap {
   static void Start(const FunctionCallbackInfo<Value>& args);
   static void GetInitialized(const FunctionCallbackInfo<Value>& args);
 
+  using HandleWrap::Close;
+  void Close(Local<Value> close_callback = Local<Value>()) override;
+
   SET_NO_MEMORY_INFO()
   SET_MEMORY_INFO_NAME(FSEventWrap)
   SET_SELF_SIZE(FSEventWrap)
 
  private:
   static const encoding kDefaultEncoding = UTF8;
+  // A batch is delivered early once it holds this many paths.
+  static constexpr size_t kMaxBatchSize = 16 * 1024;
 
   FSEventWrap(Environment* env, Local<Object> object);
   ~FSEventWrap() override = default;
 
   static void OnEvent(uv_fs_event_t* handle, const char* filename, int events,
     int status);
+  static void OnTimer(uv_timer_t* timer);
+
+  // Delivers the event right away, or adds it to the batch when there is a
+  // debounce window.
+  void Report(const char* filename, int events, int status);
+  void Deliver(const char* filename, int events, int status);
+  void Flush();
+  Local<Value> EncodeFilename(const char* filename, bool* ok);
 
   uv_fs_event_t handle_;
   enum encoding encoding_ = kDefaultEncoding;
+
+  // With a debounce window, the events are coalesced by path until the timer
+  // fires, and then delivered in one callback. The timer, like the watches of
+  // the subdirectories below, is allocated and freed separately from the
+  // wrap, so that the order in which libuv runs the close callbacks does not
+  // matter. Neither is referenced, so that ref() and unref() of the main
+  // handle alone decide whether the watcher keeps the loop alive.
+  uint64_t debounce_ms_ = 0;
+  uv_timer_t* timer_ = nullptr;
+  std::vector<std::pair<std::string, int>> batch_;
+  std::unordered_map<std::string, size_t> batch_index_;
+
+#ifdef __linux__
+  // inotify only watches a single directory, so recursive watching is done
+  // here with one uv_fs_event_t for every subdirectory, keyed by its path
+  // relative to the watched one. They all share the inotify file descriptor
+  // of the loop.
+  struct Subdirectory {
+    uv_fs_event_t handle;
+    FSEventWrap* wrap;
+    std::string relative_path;
+  };
+  class WalkWork;
+
+  static void OnSubdirectoryEvent(uv_fs_event_t* handle,
+                                  const char* filename,
+                                  int events,
+                                  int status);
+  // Reports an event for `relative_path`, and adds or removes watches when
+  // it names a directory that was created or removed.
+  void OnTreeEvent(std::string relative_path, int events, int status);
+  void WatchSubdirectories(const std::string& relative_path);
+  void WatchSubdirectory(const std::string& relative_path);
+  void UnwatchSubdirectories(const std::string& relative_path);
+
+  bool recursive_ = false;
+  std::string root_;
+  std::map<std::string, Subdirectory*> subdirectories_;
+#endif  // __linux__
 };
 
 
@@ -134,7 +199,11 @@ void FSEventWrap::New(const FunctionCallbackInfo<Value>& args) {
   new FSEventWrap(env, args.This());
 }
 
-// wrap.start(filename, persistent, recursive, encoding)
+// wrap.start(filename, persistent, recursive, encoding[, debounceMs])
+//
+// With a debounce window, onchange is called as
+// onchange(0, eventTypes, filenames) with one entry in each array for every
+// path that changed during the window, instead of once for every event.
 void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -151,10 +220,22 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
       env, permission::PermissionScope::kFileSystemRead, *path);
 
   unsigned int flags = 0;
-  if (args[2]->IsTrue())
+  if (args[2]->IsTrue()) {
+#ifdef __linux__
+    wrap->recursive_ = true;
+    wrap->root_ = *path;
+#else
     flags |= UV_FS_EVENT_RECURSIVE;
+#endif
+  }
 
   wrap->encoding_ = ParseEncoding(env->isolate(), args[3], kDefaultEncoding);
+  if (argc > 4 && args[4]->IsNumber()) {
+    double debounce_ms = args[4].As<Number>()->Value();
+    if (debounce_ms > 0) {
+      wrap->debounce_ms_ = static_cast<uint64_t>(debounce_ms);
+    }
+  }
 
   int err = uv_fs_event_init(wrap->env()->event_loop(), &wrap->handle_);
   if (err != 0) {
@@ -174,19 +255,130 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
     uv_unref(reinterpret_cast<uv_handle_t*>(&wrap->handle_));
   }
 
+  if (wrap->debounce_ms_ > 0) {
+    wrap->timer_ = new uv_timer_t();
+    CHECK_EQ(uv_timer_init(env->event_loop(), wrap->timer_), 0);
+    wrap->timer_->data = wrap;
+    uv_unref(reinterpret_cast<uv_handle_t*>(wrap->timer_));
+  }
+
+#ifdef __linux__
+  if (wrap->recursive_) wrap->WatchSubdirectories("");
+#endif
+
   args.GetReturnValue().Set(err);
 }
 
+void FSEventWrap::Close(Local<Value> close_callback) {
+  if (state_ != kInitialized) return;
+
+  // Events that are still waiting for the timer are dropped, as they would
+  // be had they arrived after the close.
+  batch_.clear();
+  batch_index_.clear();
+  if (timer_ != nullptr) {
+    env()->CloseHandle(timer_, [](uv_timer_t* timer) { delete timer; });
+    timer_ = nullptr;
+  }
+#ifdef __linux__
+  UnwatchSubdirectories("");
+#endif
+
+  HandleWrap::Close(close_callback);
+}
+
 
 void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
     int events, int status) {
   FSEventWrap* wrap = static_cast<FSEventWrap*>(handle->data);
-  Environment* env = wrap->env();
+#ifdef __linux__
+  if (wrap->recursive_ && filename != nullptr) {
+    return wrap->OnTreeEvent(filename, events, status);
+  }
+#endif
+  wrap->Report(filename, events, status);
+}
+
+void FSEventWrap::Report(const char* filename, int events, int status) {
+  if (debounce_ms_ == 0 || status != 0 || filename == nullptr) {
+    // Errors are not coalesced, but must not overtake the batch.
+    Flush();
+    if (IsHandleClosing()) return;
+    return Deliver(filename, events, status);
+  }
+
+  auto [it, inserted] = batch_index_.emplace(filename, batch_.size());
+  if (inserted) {
+    batch_.emplace_back(filename, events);
+  } else {
+    batch_[it->second].second |= events;
+  }
+
+  if (batch_.size() >= kMaxBatchSize) {
+    Flush();
+  } else if (!uv_is_active(reinterpret_cast<uv_handle_t*>(timer_))) {
+    CHECK_EQ(uv_timer_start(timer_, OnTimer, debounce_ms_, 0), 0);
+  }
+}
+
+void FSEventWrap::OnTimer(uv_timer_t* timer) {
+  static_cast<FSEventWrap*>(timer->data)->Flush();
+}
+
+// Returns the filename in the encoding of the watcher or, if it cannot be
+// encoded that way, as a Buffer with `ok` set to false.
+Local<Value> FSEventWrap::EncodeFilename(const char* filename, bool* ok) {
+  Isolate* isolate = env()->isolate();
+  Local<Value> error;
+  MaybeLocal<Value> fn =
+      StringBytes::Encode(isolate, filename, encoding_, &error);
+  *ok = !fn.IsEmpty();
+  if (*ok) return fn.ToLocalChecked();
+  return StringBytes::Encode(
+             isolate, filename, strlen(filename), BUFFER, &error)
+      .ToLocalChecked();
+}
+
+void FSEventWrap::Flush() {
+  if (batch_.empty()) return;
+  if (timer_ != nullptr) uv_timer_stop(timer_);
+
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  // Taken out first because the callback may add events or close the wrap.
+  std::vector<std::pair<std::string, int>> batch;
+  batch.swap(batch_);
+  batch_index_.clear();
+
+  std::vector<Local<Value>> event_types;
+  std::vector<Local<Value>> filenames;
+  event_types.reserve(batch.size());
+  filenames.reserve(batch.size());
+  for (const auto& [filename, events] : batch) {
+    // As with single events, a rename implies a change.
+    event_types.push_back(events & UV_RENAME ? env->rename_string()
+                                             : env->change_string());
+    bool ok;
+    filenames.push_back(EncodeFilename(filename.c_str(), &ok));
+  }
+
+  Local<Value> argv[] = {
+      Integer::New(isolate, 0),
+      Array::New(isolate, event_types.data(), event_types.size()),
+      Array::New(isolate, filenames.data(), filenames.size())};
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
+}
+
+void FSEventWrap::Deliver(const char* filename, int events, int status) {
+  Environment* env = this->env();
 
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
-  CHECK_EQ(wrap->persistent().IsEmpty(), false);
+  CHECK_EQ(persistent().IsEmpty(), false);
 
   // We're in a bind here. libuv can set both UV_RENAME and UV_CHANGE but
   // the Node API only lets us pass a single event to JS land.
@@ -217,25 +409,150 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
   };
 
   if (filename != nullptr) {
-    Local<Value> error;
-    MaybeLocal<Value> fn = StringBytes::Encode(env->isolate(),
-                                               filename,
-                                               wrap->encoding_,
-                                               &error);
-    if (fn.IsEmpty()) {
-      argv[0] = Integer::New(env->isolate(), UV_EINVAL);
-      argv[2] = StringBytes::Encode(env->isolate(),
-                                    filename,
-                                    strlen(filename),
-                                    BUFFER,
-                                    &error).ToLocalChecked();
-    } else {
-      argv[2] = fn.ToLocalChecked();
+    bool ok;
+    argv[2] = EncodeFilename(filename, &ok);
+    if (!ok) argv[0] = Integer::New(env->isolate(), UV_EINVAL);
+  }
+
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
+}
+
+#ifdef __linux__
+void FSEventWrap::OnSubdirectoryEvent(uv_fs_event_t* handle,
+                                      const char* filename,
+                                      int events,
+                                      int status) {
+  Subdirectory* subdirectory = static_cast<Subdirectory*>(handle->data);
+  FSEventWrap* wrap = subdirectory->wrap;
+  if (wrap == nullptr) return;
+  if (filename == nullptr) {
+    return wrap->Report(subdirectory->relative_path.c_str(), events, status);
+  }
+
+  // inotify also reports the removal of the directory itself, under its own
+  // name, which the watch of its parent reports properly.
+  std::error_code ec;
+  if (status == 0 &&
+      !std::filesystem::exists(wrap->root_ + "/" + subdirectory->relative_path,
+                               ec)) {
+    return wrap->UnwatchSubdirectories(subdirectory->relative_path);
+  }
+  wrap->OnTreeEvent(subdirectory->relative_path + "/" + filename,
+                    events,
+                    status);
+}
+
+void FSEventWrap::OnTreeEvent(std::string relative_path,
+                              int events,
+                              int status) {
+  if (status == 0 && (events & UV_RENAME)) {
+    std::error_code ec;
+    std::filesystem::file_status s =
+        std::filesystem::symlink_status(root_ + "/" + relative_path, ec);
+    if (ec) {
+      UnwatchSubdirectories(relative_path);
+    } else if (std::filesystem::is_directory(s)) {
+      // The files that are created in it before the watch is added are not
+      // reported, as with the JavaScript implementation.
+      WatchSubdirectory(relative_path);
+      WatchSubdirectories(relative_path);
     }
   }
+  Report(relative_path.c_str(), events, status);
+}
 
-  wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
+// Finds the directories below a path of the watched tree, without following
+// symbolic links, so that large trees do not block the event loop.
+class FSEventWrap::WalkWork final : public ThreadPoolWork {
+ public:
+  WalkWork(FSEventWrap* wrap, const std::string& relative_path)
+      : ThreadPoolWork(wrap->env(), "fseventwalk", ThreadPoolWorkKind::kFs),
+        wrap_(wrap),
+        root_(wrap->root_),
+        relative_path_(relative_path) {}
+
+  void DoThreadPoolWork() override {
+    std::string base = root_;
+    if (!relative_path_.empty()) base += "/" + relative_path_;
+    size_t prefix = root_.size() + (root_.back() == '/' ? 0 : 1);
+
+    std::error_code ec;
+    std::filesystem::recursive_directory_iterator it(
+        base, std::filesystem::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != std::filesystem::recursive_directory_iterator();
+         it.increment(ec)) {
+      std::error_code status_ec;
+      if (it->is_directory(status_ec) && !it->is_symlink(status_ec)) {
+        directories_.push_back(it->path().string().substr(prefix));
+      }
+    }
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<WalkWork> self(this);
+    if (status != 0 || wrap_->IsHandleClosing()) return;
+    for (const std::string& directory : directories_) {
+      wrap_->WatchSubdirectory(directory);
+    }
+  }
+
+ private:
+  BaseObjectPtr<FSEventWrap> wrap_;
+  std::string root_;
+  std::string relative_path_;
+  std::vector<std::string> directories_;
+};
+
+// Adds a watch for every directory below `relative_path` once the threadpool
+// has walked the tree. Changes in the subdirectories that happen before then
+// are not reported, as with directories that are created while watching.
+void FSEventWrap::WatchSubdirectories(const std::string& relative_path) {
+  (new WalkWork(this, relative_path))->ScheduleWork();
+}
+
+void FSEventWrap::WatchSubdirectory(const std::string& relative_path) {
+  if (relative_path.empty() || subdirectories_.count(relative_path) > 0) {
+    return;
+  }
+
+  Subdirectory* subdirectory = new Subdirectory{{}, this, relative_path};
+  uv_fs_event_t* handle = &subdirectory->handle;
+  CHECK_EQ(uv_fs_event_init(env()->event_loop(), handle), 0);
+  handle->data = subdirectory;
+  std::string path = root_ + "/" + relative_path;
+  if (uv_fs_event_start(handle, OnSubdirectoryEvent, path.c_str(), 0) != 0) {
+    // Most likely gone already, or past the inotify limit of the user, in
+    // which case the rest of the tree is still watched.
+    env()->CloseHandle(handle, [](uv_fs_event_t* handle) {
+      delete static_cast<Subdirectory*>(handle->data);
+    });
+    return;
+  }
+  uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+  subdirectories_.emplace(relative_path, subdirectory);
+}
+
+// Removes the watch of `relative_path` and of everything below it, or all of
+// them if it is empty.
+void FSEventWrap::UnwatchSubdirectories(const std::string& relative_path) {
+  auto it = subdirectories_.lower_bound(relative_path);
+  while (it != subdirectories_.end() &&
+         it->first.compare(0, relative_path.size(), relative_path) == 0) {
+    // Siblings such as "a-b" sort between "a" and "a/b".
+    if (!relative_path.empty() && it->first.size() > relative_path.size() &&
+        it->first[relative_path.size()] != '/') {
+      ++it;
+      continue;
+    }
+    Subdirectory* subdirectory = it->second;
+    subdirectory->wrap = nullptr;
+    env()->CloseHandle(&subdirectory->handle, [](uv_fs_event_t* handle) {
+      delete static_cast<Subdirectory*>(handle->data);
+    });
+    it = subdirectories_.erase(it);
+  }
 }
+#endif  // __linux__
 
 }  // anonymous namespace
 }  // namespace node
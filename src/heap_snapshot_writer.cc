@@ -0,0 +1,256 @@
+#include "heap_snapshot_writer.h"
+#include "util.h"
+
+#include <cstring>
+
+namespace node {
+namespace heap {
+
+namespace {
+
+constexpr char kStringsKey[] = "\"strings\":[";
+constexpr size_t kStringsKeyLength = sizeof(kStringsKey) - 1;
+constexpr char kEllipsis[] = "...";
+
+// The number of bytes in the UTF-8 sequence that starts with `byte`.
+size_t Utf8SequenceLength(unsigned char byte) {
+  if (byte < 0xc0) return 1;
+  if (byte < 0xe0) return 2;
+  if (byte < 0xf0) return 3;
+  return 4;
+}
+
+}  // anonymous namespace
+
+void SnapshotStringTruncator::Process(const char* data,
+                                      size_t size,
+                                      std::string* out) {
+  const char* end = data + size;
+  while (data < end) {
+    if (state_ == kAfterStrings) {
+      out->append(data, end - data);
+      return;
+    }
+
+    if (state_ == kBeforeStrings && key_matched_ == 0) {
+      // Skip ahead to the next quote. Most of a snapshot is made of the
+      // numbers in the "nodes" and "edges" arrays, which have none.
+      const char* quote =
+          static_cast<const char*>(memchr(data, '"', end - data));
+      const char* stop = quote != nullptr ? quote : end;
+      out->append(data, stop - data);
+      data = stop;
+      if (data == end) return;
+    }
+
+    const unsigned char c = *data++;
+    switch (state_) {
+      case kBeforeStrings:
+        out->push_back(c);
+        if (c == kStringsKey[key_matched_]) {
+          if (++key_matched_ == kStringsKeyLength) state_ = kBetweenStrings;
+        } else {
+          key_matched_ = c == '"' ? 1 : 0;
+        }
+        break;
+      case kBetweenStrings:
+        out->push_back(c);
+        if (c == '"') {
+          state_ = kInString;
+          length_ = 0;
+          truncated_ = false;
+        } else if (c == ']') {
+          state_ = kAfterStrings;
+        }
+        break;
+      case kInString:
+        if (escape_remaining_ > 0) {
+          // The hex digits of a \u escape.
+          escape_remaining_--;
+          if (!truncated_) out->push_back(c);
+        } else if (c == '"') {
+          if (truncated_) out->append(kEllipsis);
+          out->push_back(c);
+          state_ = kBetweenStrings;
+        } else if (c == '\\') {
+          // Whether the escape is kept depends on how long it is.
+          state_ = kInEscape;
+        } else if ((c & 0xc0) == 0x80) {
+          // Continuation bytes go wherever the start of the sequence went.
+          if (!truncated_) out->push_back(c);
+        } else {
+          size_t length = Utf8SequenceLength(c);
+          if (!truncated_ && length_ + length <= max_length_) {
+            length_ += length;
+            out->push_back(c);
+          } else {
+            truncated_ = true;
+          }
+        }
+        break;
+      case kInEscape: {
+        size_t length = c == 'u' ? 6 : 2;
+        escape_remaining_ = length - 2;
+        if (!truncated_ && length_ + length <= max_length_) {
+          length_ += length;
+          out->push_back('\\');
+          out->push_back(c);
+        } else {
+          truncated_ = true;
+        }
+        state_ = kInString;
+        break;
+      }
+      case kAfterStrings:
+        UNREACHABLE();
+    }
+  }
+}
+
+HeapSnapshotFileWriter::HeapSnapshotFileWriter(int fd,
+                                               Compression compression,
+                                               size_t max_string_length)
+    : fd_(fd),
+      compression_(compression),
+      truncate_strings_(max_string_length > 0),
+      truncator_(max_string_length) {
+  batch_.reserve(kBatchSize + GetChunkSize());
+  if (compression_ == Compression::kGzip) {
+    memset(&zstream_, 0, sizeof(zstream_));
+    // Snapshots are large and compress well even at the fastest level.
+    // The extra 16 window bits select the gzip format.
+    CHECK_EQ(Z_OK,
+             deflateInit2(&zstream_,
+                          Z_BEST_SPEED,
+                          Z_DEFLATED,
+                          15 + 16,
+                          8,
+                          Z_DEFAULT_STRATEGY));
+    zbuffer_.resize(kBatchSize);
+  }
+  thread_started_ = uv_thread_create(&thread_, ThreadMain, this) == 0;
+}
+
+HeapSnapshotFileWriter::~HeapSnapshotFileWriter() {
+  Finish();
+  if (compression_ == Compression::kGzip) deflateEnd(&zstream_);
+}
+
+void HeapSnapshotFileWriter::SetProgressCallback(ProgressCallback callback,
+                                                 uint64_t interval) {
+  progress_callback_ = std::move(callback);
+  progress_interval_ = interval;
+  next_progress_ = interval;
+}
+
+v8::OutputStream::WriteResult HeapSnapshotFileWriter::WriteAsciiChunk(
+    char* data, int size) {
+  if (status_.load(std::memory_order_relaxed) != 0) return kAbort;
+  bytes_serialized_ += size;
+  if (truncate_strings_)
+    truncator_.Process(data, size, &batch_);
+  else
+    batch_.append(data, size);
+  if (batch_.size() >= kBatchSize) Flush();
+
+  if (progress_callback_ && bytes_serialized_ >= next_progress_) {
+    next_progress_ = bytes_serialized_ + progress_interval_;
+    if (!progress_callback_(bytes_serialized_)) return kAbort;
+  }
+  return status_.load(std::memory_order_relaxed) == 0 ? kContinue : kAbort;
+}
+
+void HeapSnapshotFileWriter::Flush() {
+  if (batch_.empty()) return;
+  if (!thread_started_) {
+    Write(batch_, false);
+    batch_.clear();
+    return;
+  }
+
+  {
+    Mutex::ScopedLock lock(mutex_);
+    // Keep the memory that is spent on output that has not been written yet
+    // bounded, in case the file is slower than the serializer.
+    while (queue_.size() >= kMaxQueuedBatches) cond_.Wait(lock);
+    queue_.push_back(std::move(batch_));
+    cond_.Broadcast(lock);
+  }
+  batch_ = std::string();
+  batch_.reserve(kBatchSize + GetChunkSize());
+}
+
+int HeapSnapshotFileWriter::Finish() {
+  if (finished_) return status_.load();
+  finished_ = true;
+  Flush();
+  if (thread_started_) {
+    {
+      Mutex::ScopedLock lock(mutex_);
+      end_of_stream_ = true;
+      cond_.Broadcast(lock);
+    }
+    CHECK_EQ(0, uv_thread_join(&thread_));
+  } else {
+    Write(std::string(), true);
+  }
+  return status_.load();
+}
+
+void HeapSnapshotFileWriter::ThreadMain(void* data) {
+  HeapSnapshotFileWriter* writer = static_cast<HeapSnapshotFileWriter*>(data);
+  Mutex::ScopedLock lock(writer->mutex_);
+  while (true) {
+    while (writer->queue_.empty() && !writer->end_of_stream_)
+      writer->cond_.Wait(lock);
+    if (writer->queue_.empty()) break;
+    std::string batch = std::move(writer->queue_.front());
+    writer->queue_.pop_front();
+    writer->cond_.Broadcast(lock);
+    Mutex::ScopedUnlock unlock(lock);
+    writer->Write(batch, false);
+  }
+  writer->Write(std::string(), true);
+}
+
+void HeapSnapshotFileWriter::Write(const std::string& batch, bool last) {
+  if (status_.load(std::memory_order_relaxed) != 0) return;
+  if (compression_ == Compression::kNone) {
+    WriteToFd(batch.data(), batch.size());
+    return;
+  }
+
+  zstream_.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(batch.data()));
+  zstream_.avail_in = batch.size();
+  do {
+    zstream_.next_out = reinterpret_cast<Bytef*>(zbuffer_.data());
+    zstream_.avail_out = zbuffer_.size();
+    int err = deflate(&zstream_, last ? Z_FINISH : Z_NO_FLUSH);
+    if (err == Z_STREAM_ERROR) {
+      status_.store(UV_EIO);
+      return;
+    }
+    WriteToFd(zbuffer_.data(), zbuffer_.size() - zstream_.avail_out);
+  } while (zstream_.avail_out == 0 &&
+           status_.load(std::memory_order_relaxed) == 0);
+}
+
+void HeapSnapshotFileWriter::WriteToFd(const char* data, size_t size) {
+  uv_fs_t req;
+  size_t offset = 0;
+  while (offset < size) {
+    const uv_buf_t buf =
+        uv_buf_init(const_cast<char*>(data) + offset, size - offset);
+    const int written = uv_fs_write(nullptr, &req, fd_, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (written < 0) {
+      status_.store(written);
+      return;
+    }
+    offset += written;
+  }
+}
+
+}  // namespace heap
+}  // namespace node
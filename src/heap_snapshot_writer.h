@@ -0,0 +1,129 @@
+#ifndef SRC_HEAP_SNAPSHOT_WRITER_H_
+#define SRC_HEAP_SNAPSHOT_WRITER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "node_mutex.h"
+#include "uv.h"
+#include "v8-profiler.h"
+#include "zlib.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+namespace node {
+namespace heap {
+
+// Shortens the entries of the "strings" table of a JSON heap snapshot to at
+// most `max_length` bytes, while the snapshot is being serialized. That
+// table holds the names of all nodes, which for strings are the contents
+// of the strings themselves, and is usually a large part of a snapshot.
+// Escape sequences and UTF-8 sequences are never cut in half, and a
+// shortened string ends in "...".
+class SnapshotStringTruncator {
+ public:
+  explicit SnapshotStringTruncator(size_t max_length)
+      : max_length_(max_length) {}
+
+  // Appends `data` to `out`, with the strings that it contains shortened.
+  void Process(const char* data, size_t size, std::string* out);
+
+ private:
+  enum State {
+    kBeforeStrings,
+    kBetweenStrings,
+    kInString,
+    kInEscape,
+    kAfterStrings,
+  };
+
+  const size_t max_length_;
+  State state_ = kBeforeStrings;
+  // How much of the key that starts the table has been seen.
+  size_t key_matched_ = 0;
+  // The length of the current string, and whether the part of it that has
+  // been seen so far is being dropped.
+  size_t length_ = 0;
+  bool truncated_ = false;
+  // The bytes of the current escape sequence that are still to come.
+  size_t escape_remaining_ = 0;
+};
+
+// Writes a JSON heap snapshot straight to a file descriptor, optionally
+// compressed with gzip. V8 has to serialize the snapshot on the thread that
+// owns the isolate, but compressing and writing the output happens on a
+// separate thread.
+class HeapSnapshotFileWriter final : public v8::OutputStream {
+ public:
+  enum class Compression { kNone, kGzip };
+  // Called with the number of bytes serialized so far. Returning false
+  // aborts the serialization.
+  using ProgressCallback = std::function<bool(uint64_t)>;
+
+  // `max_string_length` is 0 to keep strings as they are.
+  HeapSnapshotFileWriter(int fd,
+                         Compression compression,
+                         size_t max_string_length);
+  ~HeapSnapshotFileWriter() override;
+
+  HeapSnapshotFileWriter(const HeapSnapshotFileWriter&) = delete;
+  HeapSnapshotFileWriter& operator=(const HeapSnapshotFileWriter&) = delete;
+
+  // `callback` runs on the isolate's thread, about every `interval` bytes.
+  void SetProgressCallback(ProgressCallback callback, uint64_t interval);
+
+  int GetChunkSize() override { return 65536; }
+  WriteResult WriteAsciiChunk(char* data, int size) override;
+  void EndOfStream() override {}
+
+  // Waits until all output has been written. Returns 0, or the first libuv
+  // or zlib error that writing the output ran into, as a libuv error code.
+  int Finish();
+
+  uint64_t bytes_serialized() const { return bytes_serialized_; }
+
+ private:
+  static constexpr size_t kBatchSize = 1024 * 1024;
+  static constexpr size_t kMaxQueuedBatches = 4;
+
+  static void ThreadMain(void* data);
+  void Flush();
+  // These run on the writer thread, or on the isolate's thread if it could
+  // not be started.
+  void Write(const std::string& batch, bool last);
+  void WriteToFd(const char* data, size_t size);
+
+  const int fd_;
+  const Compression compression_;
+  const bool truncate_strings_;
+  SnapshotStringTruncator truncator_;
+  std::string batch_;
+  uint64_t bytes_serialized_ = 0;
+  ProgressCallback progress_callback_;
+  uint64_t progress_interval_ = 0;
+  uint64_t next_progress_ = 0;
+  bool finished_ = false;
+
+  Mutex mutex_;
+  ConditionVariable cond_;
+  // Guarded by `mutex_`.
+  std::deque<std::string> queue_;
+  bool end_of_stream_ = false;
+
+  bool thread_started_ = false;
+  uv_thread_t thread_;
+  z_stream zstream_;
+  std::string zbuffer_;
+  std::atomic<int> status_{0};
+};
+
+}  // namespace heap
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_HEAP_SNAPSHOT_WRITER_H_
@@ -1,5 +1,6 @@
 #include "diagnosticfilename-inl.h"
 #include "env-inl.h"
+#include "heap_snapshot_writer.h"
 #include "memory_tracker-inl.h"
 #include "node_external_reference.h"
 #include "permission/permission.h"
@@ -22,12 +23,14 @@ using v8::Boolean;
 using v8::Context;
 using v8::EmbedderGraph;
 using v8::EscapableHandleScope;
+using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Global;
 using v8::HandleScope;
 using v8::HeapProfiler;
 using v8::HeapSnapshot;
+using v8::Int32;
 using v8::Isolate;
 using v8::JustVoid;
 using v8::Local;
@@ -38,7 +41,9 @@ using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::String;
+using v8::Uint32;
 using v8::Uint8Array;
+using v8::Undefined;
 using v8::Value;
 
 namespace node {
@@ -474,6 +479,47 @@ void TriggerHeapSnapshot(const FunctionCallbackInfo<Value>& args) {
   return args.GetReturnValue().Set(filename_v);
 }
 
+// writeHeapSnapshotToFd(fd, options, gzip, maxStringLength, onProgress)
+// serializes a snapshot straight into `fd` and returns the size of the
+// uncompressed snapshot. `onProgress` is optional, and is called with the
+// number of bytes serialized so far.
+void WriteHeapSnapshotToFd(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = args.GetIsolate();
+  CHECK_EQ(args.Length(), 5);
+  CHECK(args[0]->IsInt32());
+  CHECK(args[2]->IsBoolean());
+  CHECK(args[3]->IsUint32());
+  const int fd = args[0].As<Int32>()->Value();
+  auto options = GetHeapSnapshotOptions(args[1]);
+  HeapSnapshotFileWriter writer(
+      fd,
+      args[2]->IsTrue() ? HeapSnapshotFileWriter::Compression::kGzip
+                        : HeapSnapshotFileWriter::Compression::kNone,
+      args[3].As<Uint32>()->Value());
+
+  bool threw = false;
+  if (args[4]->IsFunction()) {
+    Local<Function> on_progress = args[4].As<Function>();
+    writer.SetProgressCallback(
+        [&](uint64_t bytes) {
+          Local<Value> arg = Number::New(isolate, static_cast<double>(bytes));
+          threw = on_progress->Call(env->context(), Undefined(isolate), 1, &arg)
+                      .IsEmpty();
+          return !threw;
+        },
+        16 * 1024 * 1024);
+  }
+
+  TakeSnapshot(env, &writer, options);
+  int err = writer.Finish();
+  // The exception from the progress callback takes precedence.
+  if (threw) return;
+  if (err < 0) return env->ThrowUVException(err, "write");
+  args.GetReturnValue().Set(
+      Number::New(isolate, static_cast<double>(writer.bytes_serialized())));
+}
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context,
@@ -482,12 +528,14 @@ void Initialize(Local<Object> target,
   SetMethod(context, target, "triggerHeapSnapshot", TriggerHeapSnapshot);
   SetMethod(
       context, target, "createHeapSnapshotStream", CreateHeapSnapshotStream);
+  SetMethod(context, target, "writeHeapSnapshotToFd", WriteHeapSnapshotToFd);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(BuildEmbedderGraph);
   registry->Register(TriggerHeapSnapshot);
   registry->Register(CreateHeapSnapshotStream);
+  registry->Register(WriteHeapSnapshotToFd);
 }
 
 }  // namespace heap
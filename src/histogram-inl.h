@@ -9,95 +9,152 @@
 
 namespace node {
 
+template <typename Fn>
+auto Histogram::Read(Fn&& fn) const {
+  hdr_histogram* single = nullptr;
+  size_t stripes = 0;
+  for (const std::atomic<hdr_histogram*>& stripe : stripes_) {
+    hdr_histogram* histogram = stripe.load(std::memory_order_acquire);
+    if (histogram == nullptr) continue;
+    single = histogram;
+    stripes++;
+  }
+  // Only one thread has recorded into this histogram, which is by far the
+  // most common case, so there is nothing to merge.
+  if (stripes == 1) return fn(static_cast<const hdr_histogram*>(single));
+
+  if (!merged_)
+    merged_ = NewStripe();
+  else
+    hdr_reset(merged_.get());
+  for (const std::atomic<hdr_histogram*>& stripe : stripes_) {
+    hdr_histogram* histogram = stripe.load(std::memory_order_acquire);
+    if (histogram != nullptr) hdr_add(merged_.get(), histogram);
+  }
+  return fn(static_cast<const hdr_histogram*>(merged_.get()));
+}
+
 void Histogram::Reset() {
   Mutex::ScopedLock lock(mutex_);
-  hdr_reset(histogram_.get());
-  exceeds_ = 0;
-  count_ = 0;
-  prev_ = 0;
+  for (std::atomic<hdr_histogram*>& stripe : stripes_) {
+    hdr_histogram* histogram = stripe.load(std::memory_order_acquire);
+    if (histogram != nullptr) hdr_reset(histogram);
+  }
+  exceeds_.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+  prev_.store(0, std::memory_order_relaxed);
 }
 
 double Histogram::Add(const Histogram& other) {
-  Mutex::ScopedLock lock(mutex_);
-  count_ += other.count_;
-  exceeds_ += other.exceeds_;
-  if (other.prev_ > prev_)
-    prev_ = other.prev_;
-  return static_cast<double>(hdr_add(histogram_.get(), other.histogram_.get()));
+  count_.fetch_add(other.Count(), std::memory_order_relaxed);
+  exceeds_.fetch_add(other.Exceeds(), std::memory_order_relaxed);
+  uint64_t other_prev = other.prev_.load(std::memory_order_relaxed);
+  uint64_t prev = prev_.load(std::memory_order_relaxed);
+  while (other_prev > prev &&
+         !prev_.compare_exchange_weak(
+             prev, other_prev, std::memory_order_relaxed)) {
+  }
+
+  // hdr_add() is not safe to use while other threads record into the same
+  // stripe, so copy the values over one bucket at a time.
+  hdr_histogram* stripe = GetStripe();
+  Mutex::ScopedLock lock(other.mutex_);
+  return other.Read([&](const hdr_histogram* from) {
+    int64_t dropped = 0;
+    hdr_iter iter;
+    hdr_iter_recorded_init(&iter, from);
+    while (hdr_iter_next(&iter)) {
+      if (!hdr_record_values_atomic(stripe, iter.value, iter.count))
+        dropped += iter.count;
+    }
+    return static_cast<double>(dropped);
+  });
 }
 
 size_t Histogram::Count() const {
-  Mutex::ScopedLock lock(mutex_);
-  return count_;
+  return count_.load(std::memory_order_relaxed);
 }
 
 int64_t Histogram::Min() const {
   Mutex::ScopedLock lock(mutex_);
-  return hdr_min(histogram_.get());
+  return Read([](const hdr_histogram* histogram) {
+    return hdr_min(histogram);
+  });
 }
 
 int64_t Histogram::Max() const {
   Mutex::ScopedLock lock(mutex_);
-  return hdr_max(histogram_.get());
+  return Read([](const hdr_histogram* histogram) {
+    return hdr_max(histogram);
+  });
 }
 
 double Histogram::Mean() const {
   Mutex::ScopedLock lock(mutex_);
-  return hdr_mean(histogram_.get());
+  return Read([](const hdr_histogram* histogram) {
+    return hdr_mean(histogram);
+  });
 }
 
 double Histogram::Stddev() const {
   Mutex::ScopedLock lock(mutex_);
-  return hdr_stddev(histogram_.get());
+  return Read([](const hdr_histogram* histogram) {
+    return hdr_stddev(histogram);
+  });
 }
 
 int64_t Histogram::Percentile(double percentile) const {
-  Mutex::ScopedLock lock(mutex_);
   CHECK_GT(percentile, 0);
   CHECK_LE(percentile, 100);
-  return hdr_value_at_percentile(histogram_.get(), percentile);
+  Mutex::ScopedLock lock(mutex_);
+  return Read([&](const hdr_histogram* histogram) {
+    return hdr_value_at_percentile(histogram, percentile);
+  });
 }
 
 template <typename Iterator>
 void Histogram::Percentiles(Iterator&& fn) {
   Mutex::ScopedLock lock(mutex_);
-  hdr_iter iter;
-  hdr_iter_percentile_init(&iter, histogram_.get(), 1);
-  while (hdr_iter_next(&iter)) {
-    double key = iter.specifics.percentiles.percentile;
-    fn(key, iter.value);
-  }
+  Read([&](const hdr_histogram* histogram) {
+    hdr_iter iter;
+    hdr_iter_percentile_init(&iter, histogram, 1);
+    while (hdr_iter_next(&iter)) {
+      double key = iter.specifics.percentiles.percentile;
+      fn(key, iter.value);
+    }
+  });
 }
 
 bool Histogram::Record(int64_t value) {
-  Mutex::ScopedLock lock(mutex_);
-  bool recorded = hdr_record_value(histogram_.get(), value);
+  bool recorded = hdr_record_value_atomic(GetStripe(), value);
   if (!recorded)
-    exceeds_++;
+    exceeds_.fetch_add(1, std::memory_order_relaxed);
   else
-    count_++;
+    count_.fetch_add(1, std::memory_order_relaxed);
   return recorded;
 }
 
 uint64_t Histogram::RecordDelta() {
-  Mutex::ScopedLock lock(mutex_);
   uint64_t time = uv_hrtime();
+  uint64_t prev = prev_.exchange(time, std::memory_order_relaxed);
   int64_t delta = 0;
-  if (prev_ > 0) {
-    CHECK_GE(time, prev_);
-    delta = time - prev_;
-    if (hdr_record_value(histogram_.get(), delta))
-      count_++;
-    else
-      exceeds_++;
+  // Another thread may have stored a later time in between reading the
+  // clock and swapping it in here.
+  if (prev > 0 && time >= prev) {
+    delta = time - prev;
+    Record(delta);
   }
-  prev_ = time;
   return delta;
 }
 
 size_t Histogram::GetMemorySize() const {
   Mutex::ScopedLock lock(mutex_);
-  return hdr_get_memory_size(histogram_.get());
+  size_t size = merged_ ? hdr_get_memory_size(merged_.get()) : 0;
+  for (const std::atomic<hdr_histogram*>& stripe : stripes_) {
+    hdr_histogram* histogram = stripe.load(std::memory_order_acquire);
+    if (histogram != nullptr) size += hdr_get_memory_size(histogram);
+  }
+  return size;
 }
 
 }  // namespace node
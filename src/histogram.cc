@@ -25,13 +25,41 @@ using v8::String;
 using v8::Uint32;
 using v8::Value;
 
-Histogram::Histogram(const Options& options) {
+Histogram::Histogram(const Options& options) : options_(options) {}
+
+Histogram::~Histogram() {
+  for (std::atomic<hdr_histogram*>& stripe : stripes_) {
+    hdr_histogram* histogram = stripe.load(std::memory_order_relaxed);
+    if (histogram != nullptr) hdr_close(histogram);
+  }
+}
+
+Histogram::HistogramPointer Histogram::NewStripe() const {
   hdr_histogram* histogram;
-  CHECK_EQ(0, hdr_init(options.lowest,
-                       options.highest,
-                       options.figures,
+  CHECK_EQ(0, hdr_init(options_.lowest,
+                       options_.highest,
+                       options_.figures,
                        &histogram));
-  histogram_.reset(histogram);
+  return HistogramPointer(histogram);
+}
+
+hdr_histogram* Histogram::GetStripe() {
+  static std::atomic<size_t> next_thread_index{0};
+  thread_local const size_t thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  std::atomic<hdr_histogram*>& slot = stripes_[thread_index % kStripeCount];
+
+  hdr_histogram* stripe = slot.load(std::memory_order_acquire);
+  if (stripe != nullptr) return stripe;
+  HistogramPointer created = NewStripe();
+  if (slot.compare_exchange_strong(stripe,
+                                   created.get(),
+                                   std::memory_order_acq_rel,
+                                   std::memory_order_acquire)) {
+    return created.release();
+  }
+  // Another thread that shares this stripe got there first.
+  return stripe;
 }
 
 void Histogram::MemoryInfo(MemoryTracker* tracker) const {
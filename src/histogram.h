@@ -11,6 +11,7 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <atomic>
 #include <functional>
 #include <limits>
 #include <map>
@@ -22,6 +23,13 @@ class ExternalReferenceRegistry;
 
 constexpr int kDefaultHistogramFigures = 3;
 
+// A Histogram can be shared between threads, e.g. when it is transferred to
+// a Worker. Recording never takes a lock: every thread records into one of
+// a fixed number of stripes, which are only allocated once a thread maps to
+// them, and the stripes are merged when the histogram is read by more than
+// one thread. Values that
+// are recorded while the histogram is being read or reset may or may not be
+// included in the result.
 class Histogram : public MemoryRetainer {
  public:
   struct Options {
@@ -31,7 +39,7 @@ class Histogram : public MemoryRetainer {
   };
 
   explicit Histogram(const Options& options);
-  virtual ~Histogram() = default;
+  virtual ~Histogram();
 
   inline bool Record(int64_t value);
   inline void Reset();
@@ -40,7 +48,9 @@ class Histogram : public MemoryRetainer {
   inline double Mean() const;
   inline double Stddev() const;
   inline int64_t Percentile(double percentile) const;
-  inline size_t Exceeds() const { return exceeds_; }
+  inline size_t Exceeds() const {
+    return exceeds_.load(std::memory_order_relaxed);
+  }
   inline size_t Count() const;
 
   inline uint64_t RecordDelta();
@@ -59,11 +69,27 @@ class Histogram : public MemoryRetainer {
   SET_SELF_SIZE(Histogram)
 
  private:
+  static constexpr size_t kStripeCount = 16;
+
   using HistogramPointer = DeleteFnPtr<hdr_histogram, hdr_close>;
-  HistogramPointer histogram_;
-  uint64_t prev_ = 0;
-  size_t exceeds_ = 0;
-  size_t count_ = 0;
+
+  HistogramPointer NewStripe() const;
+  // Returns the stripe of the current thread, allocating it if necessary.
+  hdr_histogram* GetStripe();
+
+  // Calls `fn` with a histogram that holds the values of every stripe.
+  template <typename Fn>
+  inline auto Read(Fn&& fn) const;
+
+  const Options options_;
+  std::atomic<hdr_histogram*> stripes_[kStripeCount] = {};
+  // What Read() merges the stripes into, allocated by the first read that
+  // does not find exactly one stripe. Guarded by `mutex_`.
+  mutable HistogramPointer merged_;
+  std::atomic<uint64_t> prev_{0};
+  std::atomic<size_t> exceeds_{0};
+  std::atomic<size_t> count_{0};
+  // Serializes the operations that read or reset all stripes.
   Mutex mutex_;
 };
 
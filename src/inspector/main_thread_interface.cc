@@ -11,6 +11,11 @@ namespace node {
 namespace inspector {
 namespace {
 
+// The longest that DispatchMessages() runs before it yields back to the
+// thread, and picks up the rest of the messages on the next interrupt. A
+// message that takes longer than that is not cut short.
+constexpr uint64_t kDispatchBudgetNs = 10 * 1000 * 1000;
+
 using v8_inspector::StringBuffer;
 using v8_inspector::StringView;
 
@@ -190,6 +195,14 @@ class ThreadSafeDelegate : public InspectorSessionDelegate {
     });
   }
 
+  void TransferMessageToFrontend(
+      std::unique_ptr<StringBuffer> message) override {
+    delegate_.Call([m = std::move(message)](
+                       InspectorSessionDelegate* delegate) mutable {
+      delegate->TransferMessageToFrontend(std::move(m));
+    });
+  }
+
  private:
   std::shared_ptr<MainThreadHandle> thread_;
   AnotherThreadObjectReference<InspectorSessionDelegate> delegate_;
@@ -209,15 +222,17 @@ void MainThreadInterface::Post(std::unique_ptr<Request> request) {
   Mutex::ScopedLock scoped_lock(requests_lock_);
   bool needs_notify = requests_.empty();
   requests_.push_back(std::move(request));
-  if (needs_notify) {
-    std::weak_ptr<MainThreadInterface> weak_self {shared_from_this()};
-    agent_->env()->RequestInterrupt([weak_self](Environment*) {
-      if (auto iface = weak_self.lock()) iface->DispatchMessages();
-    });
-  }
+  if (needs_notify) RequestDispatch();
   incoming_message_cond_.Broadcast(scoped_lock);
 }
 
+void MainThreadInterface::RequestDispatch() {
+  std::weak_ptr<MainThreadInterface> weak_self {shared_from_this()};
+  agent_->env()->RequestInterrupt([weak_self](Environment*) {
+    if (auto iface = weak_self.lock()) iface->DispatchMessages();
+  });
+}
+
 bool MainThreadInterface::WaitForFrontendEvent() {
   // We allow DispatchMessages reentry as we enter the pause. This is important
   // to support debugging the code invoked by an inspector call, such
@@ -243,6 +258,7 @@ void MainThreadInterface::DispatchMessages() {
   if (dispatching_messages_)
     return;
   dispatching_messages_ = true;
+  const uint64_t deadline = uv_hrtime() + kDispatchBudgetNs;
   bool had_messages = false;
   do {
     if (dispatching_message_queue_.empty()) {
@@ -251,6 +267,10 @@ void MainThreadInterface::DispatchMessages() {
     }
     had_messages = !dispatching_message_queue_.empty();
     while (!dispatching_message_queue_.empty()) {
+      if (uv_hrtime() > deadline) {
+        dispatching_messages_ = false;
+        return RequestDispatch();
+      }
       MessageQueue::value_type task;
       std::swap(dispatching_message_queue_.front(), task);
       dispatching_message_queue_.pop_front();
@@ -89,6 +89,8 @@ class MainThreadInterface :
   void RemoveObject(int handle);
 
  private:
+  void RequestDispatch();
+
   MessageQueue requests_;
   Mutex requests_lock_;   // requests_ live across threads
   // This queue is to maintain the order of the messages for the cases
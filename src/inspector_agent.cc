@@ -290,12 +290,12 @@ class ChannelImpl final : public v8_inspector::V8Inspector::Channel,
   void sendResponse(
       int callId,
       std::unique_ptr<v8_inspector::StringBuffer> message) override {
-    sendMessageToFrontend(message->string());
+    sendMessageToFrontend(std::move(message));
   }
 
   void sendNotification(
       std::unique_ptr<v8_inspector::StringBuffer> message) override {
-    sendMessageToFrontend(message->string());
+    sendMessageToFrontend(std::move(message));
   }
 
   void flushProtocolNotifications() override { }
@@ -312,7 +312,15 @@ class ChannelImpl final : public v8_inspector::V8Inspector::Channel,
   }
 
   void sendMessageToFrontend(const std::string& message) {
-    sendMessageToFrontend(Utf8ToStringView(message)->string());
+    sendMessageToFrontend(Utf8ToStringView(message));
+  }
+
+  void sendMessageToFrontend(std::unique_ptr<StringBuffer> message) {
+    if (per_process::enabled_debug_list.enabled(
+            DebugCategory::INSPECTOR_SERVER)) {
+      return sendMessageToFrontend(message->string());
+    }
+    delegate_->TransferMessageToFrontend(std::move(message));
   }
 
   using Serializable = protocol::Serializable;
@@ -397,6 +405,11 @@ void ThrowUninitializedInspectorError(Environment* env) {
 
 }  // namespace
 
+void InspectorSessionDelegate::TransferMessageToFrontend(
+    std::unique_ptr<StringBuffer> message) {
+  SendMessageToFrontend(message->string());
+}
+
 class NodeInspectorClient : public V8InspectorClient {
  public:
   explicit NodeInspectorClient(node::Environment* env, bool is_main)
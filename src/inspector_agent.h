@@ -13,6 +13,7 @@
 #include <memory>
 
 namespace v8_inspector {
+class StringBuffer;
 class StringView;
 }  // namespace v8_inspector
 
@@ -38,6 +39,10 @@ class InspectorSessionDelegate {
   virtual ~InspectorSessionDelegate() = default;
   virtual void SendMessageToFrontend(const v8_inspector::StringView& message)
                                      = 0;
+  // Like SendMessageToFrontend(), but takes over a message that V8 made,
+  // which saves a copy where it is sent to another thread.
+  virtual void TransferMessageToFrontend(
+      std::unique_ptr<v8_inspector::StringBuffer> message);
 };
 
 class Agent {
@@ -13,6 +13,7 @@
 #include "util-inl.h"
 #include "zlib.h"
 
+#include <algorithm>
 #include <deque>
 #include <cstring>
 #include <vector>
@@ -26,6 +27,12 @@ using v8_inspector::StringView;
 // kKill closes connections and stops the server, kStop only stops the server
 enum class TransportAction { kKill, kSendMessage, kStop };
 
+// Messages longer than this, in code units, go out as several WebSocket
+// frames. Each is converted to UTF-8 on its own, so that a big response such
+// as that of Profiler.takePreciseCoverage is never held as a whole in UTF-8
+// on top of the UTF-16 string that V8 made.
+constexpr size_t kMessageFragmentLength = 1 << 20;
+
 std::string ScriptPath(uv_loop_t* loop, const std::string& script_name) {
   std::string script_path;
 
@@ -79,13 +86,39 @@ class RequestToServer {
         server->Stop();
         break;
       case TransportAction::kSendMessage:
-        server->Send(
-            session_id_,
-            protocol::StringUtil::StringViewToUtf8(message_->string()));
+        SendMessage(server);
         break;
     }
   }
 
+  void SendMessage(InspectorSocketServer* server) const {
+    StringView message = message_->string();
+    if (message.length() <= kMessageFragmentLength) {
+      server->Send(session_id_,
+                   protocol::StringUtil::StringViewToUtf8(message));
+      return;
+    }
+    for (size_t start = 0; start < message.length();) {
+      size_t end = std::min(start + kMessageFragmentLength, message.length());
+      StringView fragment;
+      if (message.is8Bit()) {
+        fragment = StringView(message.characters8() + start, end - start);
+      } else {
+        // Do not split a surrogate pair.
+        if (end < message.length() &&
+            (message.characters16()[end - 1] & 0xFC00) == 0xD800) {
+          end--;
+        }
+        fragment = StringView(message.characters16() + start, end - start);
+      }
+      server->SendFragment(session_id_,
+                           protocol::StringUtil::StringViewToUtf8(fragment),
+                           start == 0,
+                           end == message.length());
+      start = end;
+    }
+  }
+
  private:
   TransportAction action_;
   int session_id_;
@@ -197,6 +230,11 @@ class IoSessionDelegate : public InspectorSessionDelegate {
     request_queue_->Post(id_, TransportAction::kSendMessage,
                          StringBuffer::create(message));
   }
+  void TransferMessageToFrontend(
+      std::unique_ptr<StringBuffer> message) override {
+    request_queue_->Post(id_, TransportAction::kSendMessage,
+                         std::move(message));
+  }
 
  private:
   std::shared_ptr<RequestQueue> request_queue_;
@@ -5,12 +5,14 @@
 #include "memory_tracker-inl.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "node_coverage.h"
 #include "node_file.h"
 #include "node_internals.h"
 #include "util-inl.h"
 #include "v8-inspector.h"
 
 #include <cinttypes>
+#include <cstring>
 #include <limits>
 #include <sstream>
 #include "simdutf.h"
@@ -85,6 +87,35 @@ static void WriteResult(Environment* env,
   Debug(env, DebugCategory::INSPECTOR_PROFILER, "Written result to %s\n", path);
 }
 
+static void AppendResult(Environment* env,
+                         const char* path,
+                         std::string_view data) {
+  uv_fs_t req;
+  int fd = uv_fs_open(nullptr,
+                      &req,
+                      path,
+                      O_WRONLY | O_CREAT | O_APPEND,
+                      S_IWUSR | S_IRUSR,
+                      nullptr);
+  uv_fs_req_cleanup(&req);
+  int ret = fd;
+  if (fd >= 0) {
+    uv_buf_t buf = uv_buf_init(const_cast<char*>(data.data()), data.length());
+    ret = uv_fs_write(nullptr, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    uv_fs_close(nullptr, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+  if (ret < 0) {
+    char err_buf[128];
+    uv_err_name_r(ret, err_buf, sizeof(err_buf));
+    fprintf(stderr, "%s: Failed to write file %s\n", err_buf, path);
+    return;
+  }
+  Debug(
+      env, DebugCategory::INSPECTOR_PROFILER, "Appended result to %s\n", path);
+}
+
 bool StringViewToUTF8(const v8_inspector::StringView& source,
                       std::vector<char>* utf8_out,
                       size_t* utf8_length,
@@ -207,10 +238,11 @@ static bool EnsureDirectory(const std::string& directory, const char* type) {
 std::string V8CoverageConnection::GetFilename() const {
   uint64_t timestamp =
       static_cast<uint64_t>(GetCurrentTimeInMicroseconds() / 1000);
-  return SPrintF("coverage-%s-%s-%s.json",
+  return SPrintF("coverage-%s-%s-%s.%s",
       uv_os_getpid(),
       timestamp,
-      env()->thread_id());
+      env()->thread_id(),
+      binary_ ? "nodecov" : "json");
 }
 
 std::optional<std::string_view> V8ProfilerConnection::GetProfile(
@@ -270,6 +302,11 @@ void V8CoverageConnection::WriteProfile(simdjson::ondemand::object* result) {
   Local<Context> context = env_->context();
   Context::Scope context_scope(context);
 
+  if (binary_) {
+    WriteBinaryProfile(result);
+    return;
+  }
+
   // Generate the profile output from the subclass.
   auto profile_opt = GetProfile(result);
   if (!profile_opt.has_value()) {
@@ -279,20 +316,8 @@ void V8CoverageConnection::WriteProfile(simdjson::ondemand::object* result) {
 
   // append source-map cache information to coverage object:
   Local<Value> source_map_cache_v;
-  {
-    TryCatchScope try_catch(env());
-    {
-      Isolate::AllowJavascriptExecutionScope allow_js_here(isolate);
-      Local<Function> source_map_cache_getter = env_->source_map_cache_getter();
-      if (!source_map_cache_getter->Call(
-              context, Undefined(isolate), 0, nullptr)
-              .ToLocal(&source_map_cache_v)) {
-        return;
-      }
-    }
-    if (try_catch.HasCaught() && !try_catch.HasTerminated()) {
-      PrintCaughtException(isolate, context, try_catch);
-    }
+  if (!GetSourceMapCache(&source_map_cache_v)) {
+    return;
   }
 
   // Create the directory if necessary.
@@ -348,6 +373,107 @@ void V8CoverageConnection::WriteProfile(simdjson::ondemand::object* result) {
   }
 }
 
+bool V8CoverageConnection::GetSourceMapCache(Local<Value>* source_map_cache) {
+  Isolate* isolate = env_->isolate();
+  Local<Context> context = env_->context();
+  TryCatchScope try_catch(env());
+  {
+    Isolate::AllowJavascriptExecutionScope allow_js_here(isolate);
+    Local<Function> source_map_cache_getter = env_->source_map_cache_getter();
+    if (!source_map_cache_getter->Call(context, Undefined(isolate), 0, nullptr)
+             .ToLocal(source_map_cache)) {
+      return false;
+    }
+  }
+  if (try_catch.HasCaught() && !try_catch.HasTerminated()) {
+    PrintCaughtException(isolate, context, try_catch);
+  }
+  return true;
+}
+
+void V8CoverageConnection::WriteBinaryProfile(
+    simdjson::ondemand::object* result) {
+  std::vector<coverage::ScriptCoverage> scripts;
+  if (!coverage::ParseCoverage(result, user_scripts_only_, &scripts)) {
+    fprintf(stderr, "Failed to parse %s profile result\n", type());
+    return;
+  }
+
+  std::string directory = GetDirectory();
+  DCHECK(!directory.empty());
+  if (!EnsureDirectory(directory, type())) {
+    return;
+  }
+
+  std::string records;
+  if (counts_filename_.empty()) {
+    counts_filename_ = GetFilename();
+    records = coverage::kCountsMagic;
+  }
+  for (const coverage::ScriptCoverage& script : scripts) {
+    if (written_scripts_.insert(script.hash).second) {
+      WriteScriptFile(directory, script);
+    }
+    coverage::AppendCountsRecord(script, &records);
+  }
+  std::string path = directory + kPathSeparator + counts_filename_;
+  AppendResult(env_, path.c_str(), records);
+
+  // The source map cache only ever grows, so the latest one replaces the
+  // previous one.
+  Local<Value> source_map_cache;
+  if (!GetSourceMapCache(&source_map_cache) ||
+      source_map_cache->IsUndefined()) {
+    return;
+  }
+  Local<String> source_map_cache_str;
+  if (!v8::JSON::Stringify(env_->context(), source_map_cache)
+           .ToLocal(&source_map_cache_str)) {
+    fprintf(stderr, "Failed to stringify %s source map cache\n", type());
+    return;
+  }
+  Utf8Value source_map_cache_utf8(env_->isolate(), source_map_cache_str);
+  std::string source_map_cache_path =
+      path.substr(0, path.size() - strlen(".nodecov")) +
+      "-source-map-cache.json";
+  WriteResult(env_,
+              source_map_cache_path.c_str(),
+              source_map_cache_utf8.ToStringView());
+}
+
+void V8CoverageConnection::WriteScriptFile(
+    const std::string& directory, const coverage::ScriptCoverage& script) {
+  char name[64];
+  snprintf(name, sizeof(name), "script-%016" PRIx64 ".nodecov", script.hash);
+  std::string path = directory + kPathSeparator + name;
+
+  // Another process may have written it already, in which case it is the
+  // same. Otherwise it is renamed into place, so that readers never see a
+  // partial one.
+  uv_fs_t req;
+  int ret = uv_fs_stat(nullptr, &req, path.c_str(), nullptr);
+  uv_fs_req_cleanup(&req);
+  if (ret == 0) {
+    return;
+  }
+
+  std::string temp_path =
+      SPrintF("%s.%s-%s.tmp", path, uv_os_getpid(), env()->thread_id());
+  std::string contents(coverage::kScriptMagic);
+  coverage::AppendScriptRecord(script, &contents);
+  uv_buf_t buf = uv_buf_init(contents.data(), contents.size());
+  ret = WriteFileSync(temp_path.c_str(), buf);
+  if (ret == 0) {
+    ret = uv_fs_rename(nullptr, &req, temp_path.c_str(), path.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+  if (ret != 0) {
+    char err_buf[128];
+    uv_err_name_r(ret, err_buf, sizeof(err_buf));
+    fprintf(stderr, "%s: Failed to write file %s\n", err_buf, path.c_str());
+  }
+}
+
 std::optional<std::string_view> V8CoverageConnection::GetProfile(
     simdjson::ondemand::object* result) {
   std::string_view profile_raw;
@@ -365,6 +491,10 @@ std::string V8CoverageConnection::GetDirectory() const {
 }
 
 void V8CoverageConnection::Start() {
+  binary_ = env()->env_vars()->Get("NODE_V8_COVERAGE_FORMAT").FromMaybe(
+                std::string()) == "binary";
+  user_scripts_only_ = env()->env_vars()->Get("NODE_V8_COVERAGE_SCOPE")
+                           .FromMaybe(std::string()) == "user";
   DispatchMessage("Profiler.enable");
   DispatchMessage("Profiler.startPreciseCoverage",
                   R"({ "callCount": true, "detailed": true })");
@@ -16,6 +16,10 @@ namespace node {
 // Forward declaration to break recursive dependency chain with src/env.h.
 class Environment;
 
+namespace coverage {
+struct ScriptCoverage;
+}  // namespace coverage
+
 namespace profiler {
 
 class V8ProfilerConnection {
@@ -102,8 +106,23 @@ class V8CoverageConnection : public V8ProfilerConnection {
   void StopCoverage();
 
  private:
+  bool GetSourceMapCache(v8::Local<v8::Value>* source_map_cache);
+  // Writes the coverage in the format of node_coverage.h.
+  void WriteBinaryProfile(simdjson::ondemand::object* result);
+  void WriteScriptFile(const std::string& directory,
+                       const coverage::ScriptCoverage& script);
+
   std::unique_ptr<inspector::InspectorSession> session_;
   bool ending_ = false;
+  // Set through NODE_V8_COVERAGE_FORMAT=binary.
+  bool binary_ = false;
+  // Set through NODE_V8_COVERAGE_SCOPE=user, for the binary format only.
+  bool user_scripts_only_ = false;
+  // The file that the binary format appends the counts to, which is
+  // created on the first write.
+  std::string counts_filename_;
+  // The hashes of the scripts whose file this process has written.
+  std::unordered_set<uint64_t> written_scripts_;
 };
 
 class V8CpuProfilerConnection : public V8ProfilerConnection {
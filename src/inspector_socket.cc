@@ -27,7 +27,7 @@ class TcpHolder {
   static Pointer Accept(uv_stream_t* server,
                         InspectorSocket::DelegatePointer delegate);
   void SetHandler(ProtocolHandler* handler);
-  int WriteRaw(const std::vector<char>& buffer, uv_write_cb write_cb);
+  int WriteRaw(std::vector<char> buffer, uv_write_cb write_cb);
   uv_tcp_t* tcp() {
     return &tcp_;
   }
@@ -59,7 +59,12 @@ class ProtocolHandler {
   virtual void AcceptUpgrade(const std::string& accept_key) = 0;
   virtual void OnData(std::vector<char>* data) = 0;
   virtual void OnEof() = 0;
-  virtual void Write(const std::vector<char> data) = 0;
+  virtual void Write(const char* data, size_t length) = 0;
+  // Writes one part of a message that is sent in several.
+  virtual void WriteFragment(const char* data,
+                             size_t length,
+                             bool first,
+                             bool final) = 0;
   virtual void CancelHandshake() = 0;
 
   std::string GetHost() const;
@@ -71,7 +76,7 @@ class ProtocolHandler {
 
  protected:
   virtual ~ProtocolHandler() = default;
-  int WriteRaw(const std::vector<char>& buffer, uv_write_cb write_cb);
+  int WriteRaw(std::vector<char> buffer, uv_write_cb write_cb);
   InspectorSocket::Delegate* delegate();
 
   InspectorSocket* const inspector_;
@@ -108,9 +113,9 @@ static void dump_hex(const char* buf, size_t len) {
 
 class WriteRequest {
  public:
-  WriteRequest(ProtocolHandler* handler, const std::vector<char>& buffer)
+  WriteRequest(ProtocolHandler* handler, std::vector<char>&& buffer)
       : handler(handler)
-      , storage(buffer)
+      , storage(std::move(buffer))
       , req(uv_write_t())
       , buf(uv_buf_init(storage.data(), storage.size())) {}
 
@@ -257,11 +262,14 @@ const size_t kTwoBytePayloadLengthField = 126;
 const size_t kEightBytePayloadLengthField = 127;
 const size_t kMaskingKeyWidthInBytes = 4;
 
-static std::vector<char> encode_frame_hybi17(const std::vector<char>& message) {
+static std::vector<char> encode_frame_hybi17(const char* message,
+                                             size_t data_length,
+                                             OpCode op_code = kOpCodeText,
+                                             bool final = true) {
   std::vector<char> frame;
-  OpCode op_code = kOpCodeText;
-  frame.push_back(kFinalBit | op_code);
-  const size_t data_length = message.size();
+  // The header takes at most 10 bytes.
+  frame.reserve(data_length + 10);
+  frame.push_back((final ? kFinalBit : 0) | op_code);
   if (data_length <= kMaxSingleBytePayloadLength) {
     frame.push_back(static_cast<char>(data_length));
   } else if (data_length <= 0xFFFF) {
@@ -281,7 +289,7 @@ static std::vector<char> encode_frame_hybi17(const std::vector<char>& message) {
                  extended_payload_length + 8);
     CHECK_EQ(0, remaining);
   }
-  frame.insert(frame.end(), message.begin(), message.end());
+  frame.insert(frame.end(), message, message + data_length);
   return frame;
 }
 
@@ -401,9 +409,19 @@ class WsHandler : public ProtocolHandler {
     } while (processed > 0 && !data->empty());
   }
 
-  void Write(const std::vector<char> data) override {
-    std::vector<char> output = encode_frame_hybi17(data);
-    WriteRaw(output, WriteRequest::Cleanup);
+  void Write(const char* data, size_t length) override {
+    WriteRaw(encode_frame_hybi17(data, length), WriteRequest::Cleanup);
+  }
+
+  void WriteFragment(const char* data,
+                     size_t length,
+                     bool first,
+                     bool final) override {
+    WriteRaw(encode_frame_hybi17(data,
+                                 length,
+                                 first ? kOpCodeText : kOpCodeContinuation,
+                                 final),
+             WriteRequest::Cleanup);
   }
 
  protected:
@@ -563,8 +581,15 @@ class HttpHandler : public ProtocolHandler {
     }
   }
 
-  void Write(const std::vector<char> data) override {
-    WriteRaw(data, WriteRequest::Cleanup);
+  void Write(const char* data, size_t length) override {
+    WriteRaw(std::vector<char>(data, data + length), WriteRequest::Cleanup);
+  }
+
+  void WriteFragment(const char* data,
+                     size_t length,
+                     bool first,
+                     bool final) override {
+    Write(data, length);
   }
 
  protected:
@@ -661,9 +686,9 @@ ProtocolHandler::ProtocolHandler(InspectorSocket* inspector,
   tcp_->SetHandler(this);
 }
 
-int ProtocolHandler::WriteRaw(const std::vector<char>& buffer,
+int ProtocolHandler::WriteRaw(std::vector<char> buffer,
                               uv_write_cb write_cb) {
-  return tcp_->WriteRaw(buffer, write_cb);
+  return tcp_->WriteRaw(std::move(buffer), write_cb);
 }
 
 InspectorSocket::Delegate* ProtocolHandler::delegate() {
@@ -722,7 +747,7 @@ void TcpHolder::SetHandler(ProtocolHandler* handler) {
   handler_ = handler;
 }
 
-int TcpHolder::WriteRaw(const std::vector<char>& buffer, uv_write_cb write_cb) {
+int TcpHolder::WriteRaw(std::vector<char> buffer, uv_write_cb write_cb) {
 #if DUMP_WRITES
   printf("%s (%ld bytes):\n", __FUNCTION__, buffer.size());
   dump_hex(buffer.data(), buffer.size());
@@ -730,7 +755,7 @@ int TcpHolder::WriteRaw(const std::vector<char>& buffer, uv_write_cb write_cb) {
 #endif
 
   // Freed in write_request_cleanup
-  WriteRequest* wr = new WriteRequest(handler_, buffer);
+  WriteRequest* wr = new WriteRequest(handler_, std::move(buffer));
   uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&tcp_);
   int err = uv_write(&wr->req, stream, &wr->buf, 1, write_cb);
   if (err < 0)
@@ -816,7 +841,14 @@ void InspectorSocket::SwitchProtocol(ProtocolHandler* handler) {
 }
 
 void InspectorSocket::Write(const char* data, size_t len) {
-  protocol_handler_->Write(std::vector<char>(data, data + len));
+  protocol_handler_->Write(data, len);
+}
+
+void InspectorSocket::WriteFragment(const char* data,
+                                    size_t len,
+                                    bool first,
+                                    bool final) {
+  protocol_handler_->WriteFragment(data, len, first, final);
 }
 
 }  // namespace inspector
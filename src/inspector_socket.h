@@ -38,6 +38,9 @@ class InspectorSocket {
   void AcceptUpgrade(const std::string& accept_key);
   void CancelHandshake();
   void Write(const char* data, size_t len);
+  // Writes a message in parts, as WebSocket continuation frames. The parts
+  // of one message must not be interleaved with other writes.
+  void WriteFragment(const char* data, size_t len, bool first, bool final);
   void SwitchProtocol(ProtocolHandler* handler);
   std::string GetHost();
 
@@ -158,6 +158,7 @@ class SocketSession {
     ws_socket_.reset();
   }
   void Send(const std::string& message);
+  void SendFragment(const std::string& fragment, bool first, bool final);
   void Own(InspectorSocket::Pointer ws_socket) {
     ws_socket_ = std::move(ws_socket);
   }
@@ -486,6 +487,16 @@ void InspectorSocketServer::Send(int session_id, const std::string& message) {
   }
 }
 
+void InspectorSocketServer::SendFragment(int session_id,
+                                         const std::string& fragment,
+                                         bool first,
+                                         bool final) {
+  SocketSession* session = Session(session_id);
+  if (session != nullptr) {
+    session->SendFragment(fragment, first, final);
+  }
+}
+
 void InspectorSocketServer::CloseServerSocket(ServerSocket* server) {
   server->Close();
 }
@@ -499,6 +510,12 @@ void SocketSession::Send(const std::string& message) {
   ws_socket_->Write(message.data(), message.length());
 }
 
+void SocketSession::SendFragment(const std::string& fragment,
+                                 bool first,
+                                 bool final) {
+  ws_socket_->WriteFragment(fragment.data(), fragment.length(), first, final);
+}
+
 void SocketSession::Delegate::OnHttpGet(const std::string& host,
                                         const std::string& path) {
   if (!server_->HandleGetRequest(session_id_, host, path))
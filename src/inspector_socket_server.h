@@ -59,6 +59,11 @@ class InspectorSocketServer {
   void Stop();
   //   kSendMessage
   void Send(int session_id, const std::string& message);
+  // Sends one part of a message, see InspectorSocket::WriteFragment().
+  void SendFragment(int session_id,
+                    const std::string& fragment,
+                    bool first,
+                    bool final);
   //   kKill
   void TerminateConnections();
   int Port() const;
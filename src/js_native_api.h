@@ -70,6 +70,23 @@ NAPI_EXTERN napi_status NAPI_CDECL napi_create_array(napi_env env,
                                                      napi_value* result);
 NAPI_EXTERN napi_status NAPI_CDECL
 napi_create_array_with_length(napi_env env, size_t length, napi_value* result);
+#ifdef NAPI_EXPERIMENTAL
+#define NODE_API_EXPERIMENTAL_HAS_BULK_PROPERTIES
+// Creates an object with the given prototype, an object or null, and data
+// properties in one go.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_object_with_properties(napi_env env,
+                                       napi_value prototype_or_null,
+                                       const napi_value* property_names,
+                                       const napi_value* property_values,
+                                       size_t property_count,
+                                       napi_value* result);
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_array_with_elements(napi_env env,
+                                    const napi_value* elements,
+                                    size_t length,
+                                    napi_value* result);
+#endif  // NAPI_EXPERIMENTAL
 NAPI_EXTERN napi_status NAPI_CDECL napi_create_double(napi_env env,
                                                       double value,
                                                       napi_value* result);
@@ -110,10 +127,27 @@ node_api_create_external_string_utf16(napi_env env,
                                       void* finalize_hint,
                                       napi_value* result,
                                       bool* copied);
+// The string is external if it is ASCII. Otherwise it is copied, and the
+// finalizer is called right away.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_external_string_utf8(napi_env env,
+                                     char* str,
+                                     size_t length,
+                                     node_api_nogc_finalize finalize_callback,
+                                     void* finalize_hint,
+                                     napi_value* result,
+                                     bool* copied);
 #endif  // NAPI_EXPERIMENTAL
 
 #ifdef NAPI_EXPERIMENTAL
 #define NODE_API_EXPERIMENTAL_HAS_PROPERTY_KEYS
+// Property keys are internalized strings, which are faster to look up
+// properties with. Addons that use a key often can also keep it in a
+// napi_ref instead of creating it again.
+NAPI_EXTERN napi_status NAPI_CDECL node_api_create_property_key_latin1(
+    napi_env env, const char* str, size_t length, napi_value* result);
+NAPI_EXTERN napi_status NAPI_CDECL node_api_create_property_key_utf8(
+    napi_env env, const char* str, size_t length, napi_value* result);
 NAPI_EXTERN napi_status NAPI_CDECL node_api_create_property_key_utf16(
     napi_env env, const char16_t* str, size_t length, napi_value* result);
 #endif  // NAPI_EXPERIMENTAL
@@ -134,6 +168,42 @@ NAPI_EXTERN napi_status NAPI_CDECL napi_create_function(napi_env env,
                                                         napi_callback cb,
                                                         void* data,
                                                         napi_value* result);
+#ifdef NAPI_EXPERIMENTAL
+#define NODE_API_EXPERIMENTAL_HAS_FAST_FUNCTIONS
+// Creates a function that V8 calls `fast_cb` for directly from optimized
+// code when the arguments that it is called with have the types of
+// `signature`, and `cb` for otherwise, e.g. before the caller is optimized.
+// Both have to behave the same.
+//
+// `fast_cb` is a C function that returns `signature->return_type`. Its first
+// parameter is a void* that is to be ignored, followed by one parameter per
+// type in `signature->arg_types` and by a node_api_fast_options. It must not
+// call into JavaScript or into any other Node-API function than the
+// node_api_*_fast_* ones below, and it cannot throw. If it cannot handle a
+// call, it calls node_api_request_fast_fallback() and returns any value,
+// after which `cb` is called instead.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_fast_function(napi_env env,
+                              const char* utf8name,
+                              size_t length,
+                              napi_callback cb,
+                              const node_api_fast_signature* signature,
+                              const void* fast_cb,
+                              void* data,
+                              napi_value* result);
+NAPI_EXTERN void NAPI_CDECL
+node_api_request_fast_fallback(node_api_fast_options options);
+// Returns the `data` that the function was created with.
+NAPI_EXTERN void* NAPI_CDECL
+node_api_get_fast_callback_data(node_api_fast_options options);
+// Returns the storage and the number of elements of a typed array argument.
+// The storage of arrays with elements of more than four bytes may not be
+// aligned.
+NAPI_EXTERN void NAPI_CDECL
+node_api_get_fast_typed_array_info(const node_api_fast_typed_array* array,
+                                   void** data,
+                                   size_t* length);
+#endif  // NAPI_EXPERIMENTAL
 NAPI_EXTERN napi_status NAPI_CDECL napi_create_error(napi_env env,
                                                      napi_value code,
                                                      napi_value msg,
@@ -256,6 +326,21 @@ NAPI_EXTERN napi_status NAPI_CDECL napi_delete_element(napi_env env,
                                                        napi_value object,
                                                        uint32_t index,
                                                        bool* result);
+#ifdef NAPI_EXPERIMENTAL
+// Like napi_get_element() and napi_set_element() for the `count` elements
+// from `start` on.
+NAPI_EXTERN napi_status NAPI_CDECL node_api_get_elements(napi_env env,
+                                                         napi_value object,
+                                                         uint32_t start,
+                                                         size_t count,
+                                                         napi_value* result);
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_set_elements(napi_env env,
+                      napi_value object,
+                      uint32_t start,
+                      size_t count,
+                      const napi_value* values);
+#endif  // NAPI_EXPERIMENTAL
 NAPI_EXTERN napi_status NAPI_CDECL
 napi_define_properties(napi_env env,
                        napi_value object,
@@ -378,6 +463,23 @@ NAPI_EXTERN napi_status NAPI_CDECL napi_get_reference_value(napi_env env,
                                                             napi_ref ref,
                                                             napi_value* result);
 
+#ifdef NAPI_EXPERIMENTAL
+#define NODE_API_EXPERIMENTAL_HAS_STRONG_REFERENCES
+// Strong references keep any value alive until they are deleted. They are
+// cheaper than a napi_ref with a reference count above 0, which has to be
+// ready to become weak.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_strong_reference(napi_env env,
+                                 napi_value value,
+                                 node_api_strong_ref* result);
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_delete_strong_reference(napi_env env, node_api_strong_ref ref);
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_get_strong_reference_value(napi_env env,
+                                    node_api_strong_ref ref,
+                                    napi_value* result);
+#endif  // NAPI_EXPERIMENTAL
+
 NAPI_EXTERN napi_status NAPI_CDECL
 napi_open_handle_scope(napi_env env, napi_handle_scope* result);
 NAPI_EXTERN napi_status NAPI_CDECL
@@ -204,4 +204,37 @@ typedef struct {
 } napi_type_tag;
 #endif  // NAPI_VERSION >= 8
 
+#ifdef NAPI_EXPERIMENTAL
+// The types that the fast callbacks of node_api_create_fast_function() can
+// take and return, with the C types that they are passed as.
+typedef enum {
+  node_api_fast_void,     // void, only as the return type
+  node_api_fast_bool,     // bool
+  node_api_fast_int32,    // int32_t
+  node_api_fast_uint32,   // uint32_t
+  node_api_fast_int64,    // int64_t
+  node_api_fast_uint64,   // uint64_t
+  node_api_fast_float32,  // float
+  node_api_fast_float64,  // double
+  // const node_api_fast_typed_array*, see
+  // node_api_get_fast_typed_array_info(). Not as the return type.
+  node_api_fast_uint8_array,
+  node_api_fast_int32_array,
+  node_api_fast_uint32_array,
+  node_api_fast_float32_array,
+  node_api_fast_float64_array,
+} node_api_fast_type;
+
+typedef struct {
+  node_api_fast_type return_type;
+  size_t arg_count;
+  const node_api_fast_type* arg_types;
+} node_api_fast_signature;
+
+typedef struct node_api_fast_typed_array__ node_api_fast_typed_array;
+typedef struct node_api_fast_options__* node_api_fast_options;
+
+typedef struct node_api_strong_ref__* node_api_strong_ref;
+#endif  // NAPI_EXPERIMENTAL
+
 #endif  // SRC_JS_NATIVE_API_TYPES_H_
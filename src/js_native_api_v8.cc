@@ -1,11 +1,15 @@
 #include <algorithm>
 #include <climits>  // INT_MAX
 #include <cmath>
+#include <map>
+#include <vector>
 #define NAPI_EXPERIMENTAL
 #include "env-inl.h"
 #include "js_native_api.h"
 #include "js_native_api_v8.h"
+#include "simdutf.h"
 #include "util-inl.h"
+#include "v8-fast-api-calls.h"
 
 #define CHECK_MAYBE_NOTHING(env, maybe, status)                                \
   RETURN_STATUS_IF_FALSE((env), !((maybe).IsNothing()), (status))
@@ -163,9 +167,11 @@ class TrackedStringResource : public Finalizer, RefTracker {
       finalize_callback_(nullptr, finalize_data_, finalize_hint_);
     } else {
       // The environment is still alive. Let's remove ourselves from its list
-      // of references and call the user's finalizer.
+      // of references and have the user's finalizer called like the ones of
+      // other objects that the GC collects, i.e. with them in batches.
       Unlink();
-      env_->CallFinalizer(finalize_callback_, finalize_data_, finalize_hint_);
+      env_->InvokeFinalizerFromGC(TrackedFinalizer::New(
+          env_, finalize_callback_, finalize_data_, finalize_hint_));
     }
   }
 };
@@ -551,6 +557,106 @@ class FunctionCallbackWrapper : public CallbackWrapperBase {
   }
 };
 
+//=== Fast API calls =================================================
+
+// Optimized code keeps pointers to the type information of the fast
+// callbacks that it calls, which is therefore kept for the lifetime of the
+// process, once per distinct signature.
+class FastSignature {
+ public:
+  // Returns nullptr if `signature` is not valid.
+  static const v8::CFunctionInfo* Get(
+      const node_api_fast_signature* signature) {
+    std::vector<v8::CTypeInfo> types;
+    std::vector<v8::CTypeInfo::Identifier> key;
+    types.reserve(signature->arg_count + 3);
+    v8::CTypeInfo return_info(v8::CTypeInfo::Type::kVoid);
+    if (!ToCTypeInfo(signature->return_type, true, &return_info)) {
+      return nullptr;
+    }
+    key.push_back(return_info.GetId());
+    // The receiver.
+    types.emplace_back(v8::CTypeInfo::Type::kV8Value);
+    for (size_t i = 0; i < signature->arg_count; i++) {
+      v8::CTypeInfo info(v8::CTypeInfo::Type::kVoid);
+      if (!ToCTypeInfo(signature->arg_types[i], false, &info)) return nullptr;
+      types.push_back(info);
+      key.push_back(info.GetId());
+    }
+    types.emplace_back(v8::CTypeInfo::kCallbackOptionsType);
+
+    static node::Mutex mutex;
+    static std::map<std::vector<v8::CTypeInfo::Identifier>, FastSignature>
+        signatures;
+    node::Mutex::ScopedLock lock(mutex);
+    auto it = signatures.find(key);
+    if (it == signatures.end()) {
+      it = signatures.emplace(std::move(key), std::move(types)).first;
+      it->second.info_ = std::make_unique<v8::CFunctionInfo>(
+          return_info, it->second.types_.size(), it->second.types_.data());
+    }
+    return it->second.info_.get();
+  }
+
+  explicit FastSignature(std::vector<v8::CTypeInfo>&& types)
+      : types_(std::move(types)) {}
+
+ private:
+  static bool ToCTypeInfo(node_api_fast_type type,
+                          bool is_return,
+                          v8::CTypeInfo* result) {
+    using Type = v8::CTypeInfo::Type;
+    constexpr v8::CTypeInfo::SequenceType kTypedArray =
+        v8::CTypeInfo::SequenceType::kIsTypedArray;
+    switch (type) {
+      case node_api_fast_void:
+        if (!is_return) return false;
+        *result = v8::CTypeInfo(Type::kVoid);
+        return true;
+      case node_api_fast_bool:
+        *result = v8::CTypeInfo(Type::kBool);
+        return true;
+      case node_api_fast_int32:
+        *result = v8::CTypeInfo(Type::kInt32);
+        return true;
+      case node_api_fast_uint32:
+        *result = v8::CTypeInfo(Type::kUint32);
+        return true;
+      case node_api_fast_int64:
+        *result = v8::CTypeInfo(Type::kInt64);
+        return true;
+      case node_api_fast_uint64:
+        *result = v8::CTypeInfo(Type::kUint64);
+        return true;
+      case node_api_fast_float32:
+        *result = v8::CTypeInfo(Type::kFloat32);
+        return true;
+      case node_api_fast_float64:
+        *result = v8::CTypeInfo(Type::kFloat64);
+        return true;
+      case node_api_fast_uint8_array:
+        *result = v8::CTypeInfo(Type::kUint8, kTypedArray);
+        return !is_return;
+      case node_api_fast_int32_array:
+        *result = v8::CTypeInfo(Type::kInt32, kTypedArray);
+        return !is_return;
+      case node_api_fast_uint32_array:
+        *result = v8::CTypeInfo(Type::kUint32, kTypedArray);
+        return !is_return;
+      case node_api_fast_float32_array:
+        *result = v8::CTypeInfo(Type::kFloat32, kTypedArray);
+        return !is_return;
+      case node_api_fast_float64_array:
+        *result = v8::CTypeInfo(Type::kFloat64, kTypedArray);
+        return !is_return;
+    }
+    return false;
+  }
+
+  std::vector<v8::CTypeInfo> types_;
+  std::unique_ptr<v8::CFunctionInfo> info_;
+};
+
 inline napi_status Wrap(napi_env env,
                         napi_value js_object,
                         void* native_object,
@@ -962,6 +1068,85 @@ napi_status NAPI_CDECL napi_create_function(napi_env env,
   return GET_RETURN_STATUS(env);
 }
 
+napi_status NAPI_CDECL
+node_api_create_fast_function(napi_env env,
+                              const char* utf8name,
+                              size_t length,
+                              napi_callback cb,
+                              const node_api_fast_signature* signature,
+                              const void* fast_cb,
+                              void* data,
+                              napi_value* result) {
+  NAPI_PREAMBLE(env);
+  CHECK_ARG(env, result);
+  CHECK_ARG(env, cb);
+  CHECK_ARG(env, signature);
+  CHECK_ARG(env, fast_cb);
+  if (signature->arg_count > 0) {
+    CHECK_ARG(env, signature->arg_types);
+  }
+
+  const v8::CFunctionInfo* type_info = v8impl::FastSignature::Get(signature);
+  RETURN_STATUS_IF_FALSE(env, type_info != nullptr, napi_invalid_arg);
+  const v8::CFunction c_function(fast_cb, type_info);
+
+  v8::EscapableHandleScope scope(env->isolate);
+  v8::Local<v8::Value> cbdata = v8impl::CallbackBundle::New(env, cb, data);
+  RETURN_STATUS_IF_FALSE(env, !cbdata.IsEmpty(), napi_generic_failure);
+
+  v8::Local<v8::FunctionTemplate> tpl =
+      v8::FunctionTemplate::New(env->isolate,
+                                v8impl::FunctionCallbackWrapper::Invoke,
+                                cbdata,
+                                v8::Local<v8::Signature>(),
+                                0,
+                                v8::ConstructorBehavior::kThrow,
+                                v8::SideEffectType::kHasSideEffect,
+                                &c_function);
+  v8::MaybeLocal<v8::Function> maybe_function =
+      tpl->GetFunction(env->context());
+  CHECK_MAYBE_EMPTY(env, maybe_function, napi_generic_failure);
+  v8::Local<v8::Function> return_value =
+      scope.Escape(maybe_function.ToLocalChecked());
+
+  if (utf8name != nullptr) {
+    v8::Local<v8::String> name_string;
+    CHECK_NEW_FROM_UTF8_LEN(env, name_string, utf8name, length);
+    return_value->SetName(name_string);
+  }
+
+  *result = v8impl::JsValueFromV8LocalValue(return_value);
+
+  return GET_RETURN_STATUS(env);
+}
+
+void NAPI_CDECL node_api_request_fast_fallback(node_api_fast_options options) {
+  reinterpret_cast<v8::FastApiCallbackOptions*>(options)->fallback = true;
+}
+
+void* NAPI_CDECL
+node_api_get_fast_callback_data(node_api_fast_options options) {
+  v8::Local<v8::Value> data =
+      reinterpret_cast<v8::FastApiCallbackOptions*>(options)->data;
+  return reinterpret_cast<v8impl::CallbackBundle*>(
+             data.As<v8::External>()->Value())
+      ->cb_data;
+}
+
+void NAPI_CDECL
+node_api_get_fast_typed_array_info(const node_api_fast_typed_array* array,
+                                   void** data,
+                                   size_t* length) {
+  // All FastApiTypedArray<T> have the same layout, and the storage of a
+  // Uint8Array is always aligned.
+  const v8::FastApiTypedArray<uint8_t>* typed_array =
+      reinterpret_cast<const v8::FastApiTypedArray<uint8_t>*>(array);
+  uint8_t* storage;
+  CHECK(typed_array->getStorageIfAligned(&storage));
+  if (data != nullptr) *data = storage;
+  if (length != nullptr) *length = typed_array->length();
+}
+
 napi_status NAPI_CDECL
 napi_define_class(napi_env env,
                   const char* utf8name,
@@ -1405,6 +1590,58 @@ napi_status NAPI_CDECL napi_delete_element(napi_env env,
   return GET_RETURN_STATUS(env);
 }
 
+napi_status NAPI_CDECL node_api_get_elements(napi_env env,
+                                             napi_value object,
+                                             uint32_t start,
+                                             size_t count,
+                                             napi_value* result) {
+  NAPI_PREAMBLE(env);
+  if (count > 0) {
+    CHECK_ARG(env, result);
+  }
+  RETURN_STATUS_IF_FALSE(env, count <= UINT32_MAX - start, napi_invalid_arg);
+
+  v8::Local<v8::Context> context = env->context();
+  v8::Local<v8::Object> obj;
+
+  CHECK_TO_OBJECT(env, context, obj, object);
+
+  for (size_t i = 0; i < count; i++) {
+    auto get_maybe = obj->Get(context, start + static_cast<uint32_t>(i));
+    CHECK_MAYBE_EMPTY_WITH_PREAMBLE(env, get_maybe, napi_generic_failure);
+    result[i] = v8impl::JsValueFromV8LocalValue(get_maybe.ToLocalChecked());
+  }
+
+  return GET_RETURN_STATUS(env);
+}
+
+napi_status NAPI_CDECL node_api_set_elements(napi_env env,
+                                             napi_value object,
+                                             uint32_t start,
+                                             size_t count,
+                                             const napi_value* values) {
+  NAPI_PREAMBLE(env);
+  if (count > 0) {
+    CHECK_ARG(env, values);
+  }
+  RETURN_STATUS_IF_FALSE(env, count <= UINT32_MAX - start, napi_invalid_arg);
+
+  v8::Local<v8::Context> context = env->context();
+  v8::Local<v8::Object> obj;
+
+  CHECK_TO_OBJECT(env, context, obj, object);
+
+  for (size_t i = 0; i < count; i++) {
+    CHECK_ARG(env, values[i]);
+    v8::Local<v8::Value> val = v8impl::V8LocalValueFromJsValue(values[i]);
+    auto set_maybe = obj->Set(context, start + static_cast<uint32_t>(i), val);
+    RETURN_STATUS_IF_FALSE_WITH_PREAMBLE(
+        env, set_maybe.FromMaybe(false), napi_generic_failure);
+  }
+
+  return GET_RETURN_STATUS(env);
+}
+
 napi_status NAPI_CDECL
 napi_define_properties(napi_env env,
                        napi_value object,
@@ -1614,6 +1851,67 @@ napi_status NAPI_CDECL napi_create_array_with_length(napi_env env,
   return napi_clear_last_error(env);
 }
 
+napi_status NAPI_CDECL
+node_api_create_object_with_properties(napi_env env,
+                                       napi_value prototype_or_null,
+                                       const napi_value* property_names,
+                                       const napi_value* property_values,
+                                       size_t property_count,
+                                       napi_value* result) {
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, prototype_or_null);
+  CHECK_ARG(env, result);
+  if (property_count > 0) {
+    CHECK_ARG(env, property_names);
+    CHECK_ARG(env, property_values);
+  }
+
+  v8::Local<v8::Value> prototype =
+      v8impl::V8LocalValueFromJsValue(prototype_or_null);
+  RETURN_STATUS_IF_FALSE(
+      env, prototype->IsNull() || prototype->IsObject(), napi_invalid_arg);
+
+  node::MaybeStackBuffer<v8::Local<v8::Name>, 16> names(property_count);
+  node::MaybeStackBuffer<v8::Local<v8::Value>, 16> values(property_count);
+  for (size_t i = 0; i < property_count; i++) {
+    CHECK_ARG(env, property_names[i]);
+    CHECK_ARG(env, property_values[i]);
+    v8::Local<v8::Value> name =
+        v8impl::V8LocalValueFromJsValue(property_names[i]);
+    RETURN_STATUS_IF_FALSE(env, name->IsName(), napi_name_expected);
+    names[i] = name.As<v8::Name>();
+    values[i] = v8impl::V8LocalValueFromJsValue(property_values[i]);
+  }
+
+  *result = v8impl::JsValueFromV8LocalValue(v8::Object::New(
+      env->isolate, prototype, names.out(), values.out(), property_count));
+
+  return napi_clear_last_error(env);
+}
+
+napi_status NAPI_CDECL
+node_api_create_array_with_elements(napi_env env,
+                                    const napi_value* elements,
+                                    size_t length,
+                                    napi_value* result) {
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, result);
+  if (length > 0) {
+    CHECK_ARG(env, elements);
+  }
+
+  node::MaybeStackBuffer<v8::Local<v8::Value>, 16> values(length);
+  for (size_t i = 0; i < length; i++) {
+    CHECK_ARG(env, elements[i]);
+    values[i] = v8impl::V8LocalValueFromJsValue(elements[i]);
+  }
+
+  *result = v8impl::JsValueFromV8LocalValue(
+      v8::Array::New(env->isolate, values.out(), length));
+
+  return napi_clear_last_error(env);
+}
+
 napi_status NAPI_CDECL napi_create_string_latin1(napi_env env,
                                                  const char* str,
                                                  size_t length,
@@ -1677,6 +1975,45 @@ napi_status NAPI_CDECL node_api_create_external_string_latin1(
       });
 }
 
+napi_status NAPI_CDECL node_api_create_external_string_utf8(
+    napi_env env,
+    char* str,
+    size_t length,
+    node_api_nogc_finalize nogc_finalize_callback,
+    void* finalize_hint,
+    napi_value* result,
+    bool* copied) {
+  napi_finalize finalize_callback =
+      reinterpret_cast<napi_finalize>(nogc_finalize_callback);
+  CHECK_NEW_STRING_ARGS(env, str, length, result);
+  if (length == NAPI_AUTO_LENGTH) {
+    length = (std::string_view(str)).length();
+  }
+
+  // ASCII text is Latin-1 as well, so it can be external without being
+  // transcoded.
+  if (simdutf::validate_ascii(str, length)) {
+    return node_api_create_external_string_latin1(env,
+                                                  str,
+                                                  length,
+                                                  nogc_finalize_callback,
+                                                  finalize_hint,
+                                                  result,
+                                                  copied);
+  }
+
+  napi_status status = napi_create_string_utf8(env, str, length, result);
+  if (status == napi_ok) {
+    if (copied != nullptr) {
+      *copied = true;
+    }
+    if (finalize_callback != nullptr) {
+      env->CallFinalizer(finalize_callback, str, finalize_hint);
+    }
+  }
+  return status;
+}
+
 napi_status NAPI_CDECL node_api_create_external_string_utf16(
     napi_env env,
     char16_t* str,
@@ -1706,6 +2043,30 @@ napi_status NAPI_CDECL node_api_create_external_string_utf16(
       });
 }
 
+napi_status NAPI_CDECL node_api_create_property_key_latin1(napi_env env,
+                                                           const char* str,
+                                                           size_t length,
+                                                           napi_value* result) {
+  return v8impl::NewString(env, str, length, result, [&](v8::Isolate* isolate) {
+    return v8::String::NewFromOneByte(isolate,
+                                      reinterpret_cast<const uint8_t*>(str),
+                                      v8::NewStringType::kInternalized,
+                                      static_cast<int>(length));
+  });
+}
+
+napi_status NAPI_CDECL node_api_create_property_key_utf8(napi_env env,
+                                                         const char* str,
+                                                         size_t length,
+                                                         napi_value* result) {
+  return v8impl::NewString(env, str, length, result, [&](v8::Isolate* isolate) {
+    return v8::String::NewFromUtf8(isolate,
+                                   str,
+                                   v8::NewStringType::kInternalized,
+                                   static_cast<int>(length));
+  });
+}
+
 napi_status NAPI_CDECL node_api_create_property_key_utf16(napi_env env,
                                                           const char16_t* str,
                                                           size_t length,
@@ -2824,6 +3185,52 @@ napi_status NAPI_CDECL napi_get_reference_value(napi_env env,
   return napi_clear_last_error(env);
 }
 
+napi_status NAPI_CDECL
+node_api_create_strong_reference(napi_env env,
+                                 napi_value value,
+                                 node_api_strong_ref* result) {
+  // Omit NAPI_PREAMBLE and GET_RETURN_STATUS because V8 calls here cannot throw
+  // JS exceptions.
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, value);
+  CHECK_ARG(env, result);
+
+  v8impl::StrongReference* reference = v8impl::StrongReference::New(
+      env, v8impl::V8LocalValueFromJsValue(value));
+
+  *result = reinterpret_cast<node_api_strong_ref>(reference);
+  return napi_clear_last_error(env);
+}
+
+napi_status NAPI_CDECL
+node_api_delete_strong_reference(napi_env env, node_api_strong_ref ref) {
+  // Omit NAPI_PREAMBLE and GET_RETURN_STATUS because V8 calls here cannot throw
+  // JS exceptions.
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, ref);
+
+  delete reinterpret_cast<v8impl::StrongReference*>(ref);
+
+  return napi_clear_last_error(env);
+}
+
+napi_status NAPI_CDECL
+node_api_get_strong_reference_value(napi_env env,
+                                    node_api_strong_ref ref,
+                                    napi_value* result) {
+  // Omit NAPI_PREAMBLE and GET_RETURN_STATUS because V8 calls here cannot throw
+  // JS exceptions.
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, ref);
+  CHECK_ARG(env, result);
+
+  v8impl::StrongReference* reference =
+      reinterpret_cast<v8impl::StrongReference*>(ref);
+  *result = v8impl::JsValueFromV8LocalValue(reference->Get(env->isolate));
+
+  return napi_clear_last_error(env);
+}
+
 napi_status NAPI_CDECL napi_open_handle_scope(napi_env env,
                                               napi_handle_scope* result) {
   // Omit NAPI_PREAMBLE and GET_RETURN_STATUS because V8 calls here cannot throw
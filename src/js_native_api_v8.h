@@ -1,6 +1,9 @@
 #ifndef SRC_JS_NATIVE_API_V8_H_
 #define SRC_JS_NATIVE_API_V8_H_
 
+#include <cstddef>
+#include <memory>
+#include <vector>
 #include "js_native_api_types.h"
 #include "js_native_api_v8_internals.h"
 
@@ -42,9 +45,102 @@ class RefTracker {
     }
   }
 
+  // Whether the tracker is in the pending finalizers of its env, so that
+  // the ones that are not, i.e. most, are deleted without a lookup there.
+  bool pending_finalization() const { return pending_finalization_; }
+  void set_pending_finalization(bool pending) {
+    pending_finalization_ = pending;
+  }
+
  private:
   RefList* next_ = nullptr;
   RefList* prev_ = nullptr;
+  bool pending_finalization_ = false;
+};
+
+// Recycles the memory of objects of one size on the thread that creates
+// and deletes them, which addons can do at high rates for references.
+// Memory is taken from the system in slabs of many objects.
+template <size_t kSize>
+class SlabPool {
+ public:
+  static void* Allocate() {
+    if (destroyed_) return ::operator new(kSize);
+    Pool& pool = GetPool();
+    if (pool.free_list == nullptr) pool.Grow();
+    Block* block = pool.free_list;
+    pool.free_list = block->next;
+    pool.live++;
+    return block;
+  }
+
+  static void Free(void* ptr) {
+    // After the thread's pool is gone, what is left is leaked.
+    if (destroyed_) return;
+    Pool& pool = GetPool();
+    Block* block = static_cast<Block*>(ptr);
+    block->next = pool.free_list;
+    pool.free_list = block;
+    pool.live--;
+  }
+
+ private:
+  static constexpr size_t kBlocksPerSlab = 64;
+
+  union Block {
+    Block* next;
+    alignas(std::max_align_t) char storage[kSize];
+  };
+
+  struct Pool {
+    ~Pool() {
+      // Slabs that objects still live in are leaked rather than freed
+      // under them.
+      if (live != 0) {
+        for (auto& slab : slabs) slab.release();
+      }
+      destroyed_ = true;
+    }
+
+    void Grow() {
+      slabs.emplace_back(new Block[kBlocksPerSlab]);
+      Block* slab = slabs.back().get();
+      for (size_t i = 0; i < kBlocksPerSlab; i++) {
+        slab[i].next = free_list;
+        free_list = &slab[i];
+      }
+    }
+
+    Block* free_list = nullptr;
+    size_t live = 0;
+    std::vector<std::unique_ptr<Block[]>> slabs;
+  };
+
+  static Pool& GetPool() {
+    thread_local Pool pool;
+    return pool;
+  }
+
+  static thread_local bool destroyed_;
+};
+
+template <size_t kSize>
+thread_local bool SlabPool<kSize>::destroyed_ = false;
+
+// Base class of the objects that are allocated from a SlabPool. Objects of
+// derived classes of other sizes are allocated as usual.
+template <typename T>
+class PoolAllocated {
+ public:
+  static void* operator new(size_t size) {
+    if (size != sizeof(T)) return ::operator new(size);
+    return SlabPool<sizeof(T)>::Allocate();
+  }
+
+  static void operator delete(void* ptr, size_t size) {
+    if (size != sizeof(T)) return ::operator delete(ptr);
+    SlabPool<sizeof(T)>::Free(ptr);
+  }
 };
 
 class Finalizer;
@@ -114,12 +210,15 @@ struct napi_env__ {
   // into JavaScript.
   virtual void EnqueueFinalizer(v8impl::RefTracker* finalizer) {
     pending_finalizers.emplace(finalizer);
+    finalizer->set_pending_finalization(true);
   }
 
   // Remove the finalizer from the scheduled second pass weak callback queue.
   // The finalizer can be deleted after this call.
   virtual void DequeueFinalizer(v8impl::RefTracker* finalizer) {
+    if (!finalizer->pending_finalization()) return;
     pending_finalizers.erase(finalizer);
+    finalizer->set_pending_finalization(false);
   }
 
   virtual void DeleteMe() {
@@ -434,7 +533,7 @@ class RefBase : public TrackedFinalizer {
 };
 
 // Wrapper around v8impl::Persistent.
-class Reference : public RefBase {
+class Reference : public RefBase, public PoolAllocated<Reference> {
  protected:
   template <typename... Args>
   Reference(napi_env env, v8::Local<v8::Value> value, Args&&... args);
@@ -465,6 +564,35 @@ class Reference : public RefBase {
   bool can_be_weak_;
 };
 
+// A reference that is always strong, for addons that keep values alive
+// until they delete them. It has no reference count, finalizer or weak
+// callback to maintain.
+class StrongReference : public RefTracker,
+                        public PoolAllocated<StrongReference> {
+ public:
+  static StrongReference* New(napi_env env, v8::Local<v8::Value> value) {
+    return new StrongReference(env, value);
+  }
+
+  ~StrongReference() override { Unlink(); }
+
+  v8::Local<v8::Value> Get(v8::Isolate* isolate) {
+    return v8::Local<v8::Value>::New(isolate, persistent_);
+  }
+
+ protected:
+  // Called when the env is torn down.
+  void Finalize() override { delete this; }
+
+ private:
+  StrongReference(napi_env env, v8::Local<v8::Value> value)
+      : persistent_(env->isolate, value) {
+    Link(&env->reflist);
+  }
+
+  v8impl::Persistent<v8::Value> persistent_;
+};
+
 }  // end of namespace v8impl
 
 #endif  // SRC_JS_NATIVE_API_V8_H_
@@ -1,45 +1,97 @@
 #include "json_utils.h"
 
+#include <cstdint>
+#include <cstring>
+
 namespace node {
 
-std::string EscapeJsonChars(std::string_view str) {
-  // 'static constexpr' is slightly better than static const
-  // since the initialization occurs at compile time.
-  // See https://lemire.me/blog/I3Cah
-  static constexpr std::string_view control_symbols[0x20] = {
-      "\\u0000", "\\u0001", "\\u0002", "\\u0003", "\\u0004", "\\u0005",
-      "\\u0006", "\\u0007", "\\b",     "\\t",     "\\n",     "\\u000b",
-      "\\f",     "\\r",     "\\u000e", "\\u000f", "\\u0010", "\\u0011",
-      "\\u0012", "\\u0013", "\\u0014", "\\u0015", "\\u0016", "\\u0017",
-      "\\u0018", "\\u0019", "\\u001a", "\\u001b", "\\u001c", "\\u001d",
-      "\\u001e", "\\u001f"};
+namespace {
 
-  std::string ret;
-  size_t last_pos = 0;
-  size_t pos = 0;
-  for (; pos < str.size(); ++pos) {
-    std::string replace;
-    char ch = str[pos];
+// 'static constexpr' is slightly better than static const
+// since the initialization occurs at compile time.
+// See https://lemire.me/blog/I3Cah
+constexpr std::string_view control_symbols[0x20] = {
+    "\\u0000", "\\u0001", "\\u0002", "\\u0003", "\\u0004", "\\u0005",
+    "\\u0006", "\\u0007", "\\b",     "\\t",     "\\n",     "\\u000b",
+    "\\f",     "\\r",     "\\u000e", "\\u000f", "\\u0010", "\\u0011",
+    "\\u0012", "\\u0013", "\\u0014", "\\u0015", "\\u0016", "\\u0017",
+    "\\u0018", "\\u0019", "\\u001a", "\\u001b", "\\u001c", "\\u001d",
+    "\\u001e", "\\u001f"};
+
+constexpr uint64_t kOnes = 0x0101010101010101ull;
+constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+// Whether any byte of |word| is zero. Borrows can only make bytes above a
+// zero byte look like zero too, so the answer itself is exact.
+constexpr uint64_t HasZeroByte(uint64_t word) {
+  return (word - kOnes) & ~word & kHighBits;
+}
+
+inline bool NeedsEscape(unsigned char c, bool printable_ascii_only) {
+  return c == '\\' || c == '"' || c < 0x20 ||
+         (printable_ascii_only && c > 0x7e);
+}
+
+// Calls |append| with the runs of |str| that need no escaping and with the
+// escape sequences of the characters between them.
+template <typename Append>
+void ForEachEscapedRun(std::string_view str, Append&& append) {
+  while (!str.empty()) {
+    size_t run = FindJsonEscape(str);
+    if (run > 0) append(str.data(), run);
+    if (run == str.size()) break;
+
+    char ch = str[run];
+    std::string_view replace;
     if (ch == '\\') {
       replace = "\\\\";
     } else if (ch == '\"') {
       replace = "\\\"";
     } else {
-      size_t num = static_cast<size_t>(ch);
-      if (num < 0x20) replace = control_symbols[num];
+      replace = control_symbols[static_cast<unsigned char>(ch)];
     }
-    if (!replace.empty()) {
-      if (pos > last_pos) {
-        ret += str.substr(last_pos, pos - last_pos);
-      }
-      last_pos = pos + 1;
-      ret += replace;
+    append(replace.data(), replace.size());
+    str.remove_prefix(run + 1);
+  }
+}
+
+}  // anonymous namespace
+
+size_t FindJsonEscape(std::string_view str, bool printable_ascii_only) {
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(str.data());
+  size_t pos = 0;
+  for (; pos + sizeof(uint64_t) <= str.size(); pos += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + pos, sizeof(word));
+    // Bytes below 0x20 are the ones with a zero in the upper three bits.
+    uint64_t found = HasZeroByte(word & (0xe0 * kOnes)) |
+                     HasZeroByte(word ^ ('"' * kOnes)) |
+                     HasZeroByte(word ^ ('\\' * kOnes));
+    if (printable_ascii_only) {
+      // 0x7f is the only byte that 0x01 carries into the high bit, and the
+      // carry out of 0xff only happens if that byte is found anyway.
+      found |= (word | (word + kOnes)) & kHighBits;
     }
+    if (found != 0) break;
   }
-  // Append any remaining symbols.
-  if (last_pos < str.size()) {
-    ret += str.substr(last_pos, pos - last_pos);
+  for (; pos < str.size(); pos++) {
+    if (NeedsEscape(data[pos], printable_ascii_only)) break;
   }
+  return pos;
+}
+
+void WriteJsonChars(std::ostream& out, std::string_view str) {
+  ForEachEscapedRun(str, [&](const char* data, size_t length) {
+    out.write(data, length);
+  });
+}
+
+std::string EscapeJsonChars(std::string_view str) {
+  std::string ret;
+  ForEachEscapedRun(str, [&](const char* data, size_t length) {
+    ret.append(data, length);
+  });
   return ret;
 }
 
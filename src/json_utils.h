@@ -18,6 +18,14 @@ constexpr bool NeedsJsonEscape(std::string_view str) {
   return false;
 }
 
+// Returns the length of the longest prefix of |str| that contains no
+// characters that need to be escaped in a JSON string. If
+// |printable_ascii_only| is true, the prefix does not contain bytes outside
+// of the printable ASCII range either. Eight bytes are checked at a time.
+size_t FindJsonEscape(std::string_view str, bool printable_ascii_only = false);
+// Writes |str| to |out| escaped for a JSON string, without the quotes, and
+// without copying the runs of characters that need no escaping.
+void WriteJsonChars(std::ostream& out, std::string_view str);
 std::string EscapeJsonChars(std::string_view str);
 std::string Reindent(const std::string& str, int indentation);
 
@@ -27,6 +35,14 @@ class JSONWriter {
   JSONWriter(std::ostream& out, bool compact)
     : out_(out), compact_(compact) {}
 
+  // A writer whose output can be inserted into that of `parent` with
+  // json_fragment(), at a point where `parent` is in the state it is in now.
+  JSONWriter(std::ostream& out, const JSONWriter& parent)
+      : out_(out),
+        compact_(parent.compact_),
+        indent_(parent.indent_),
+        state_(parent.state_) {}
+
  private:
   inline void indent() { indent_ += 2; }
   inline void deindent() { indent_ -= 2; }
@@ -125,6 +141,12 @@ class JSONWriter {
     state_ = kAfterValue;
   }
 
+  inline void json_fragment(std::string_view fragment) {
+    if (fragment.empty()) return;
+    out_ << fragment;
+    state_ = kAfterValue;
+  }
+
   struct Null {};  // Usable as a JSON value.
 
   struct ForeignJSON {
@@ -151,10 +173,7 @@ class JSONWriter {
 
   inline void write_string(std::string_view str) {
     out_ << '"';
-    if (NeedsJsonEscape(str))  // only create temporary std::string if necessary
-      out_ << EscapeJsonChars(str);
-    else
-      out_ << str;
+    WriteJsonChars(out_, str);
     out_ << '"';
   }
 
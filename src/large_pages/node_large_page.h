@@ -25,9 +25,64 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <cstddef>
+#include <cstdint>
+
+namespace v8 {
+class PageAllocator;
+}  // namespace v8
+
 namespace node {
 int MapStaticCodeToLargePages();
 const char* LargePagesError(int status);
+
+// Large pages for the V8 heap and for ArrayBuffer memory, which is what
+// --use-largepages-heap turns on. Only Linux is supported.
+namespace large_pages {
+
+enum class HeapMode {
+  kOff,
+  // Reservations of the V8 heap and large ArrayBuffers are advised to use
+  // transparent huge pages.
+  kMadvise,
+  // Like kMadvise, but large ArrayBuffers are put into explicit huge pages
+  // from the hugetlbfs pool first.
+  kExplicit,
+};
+
+struct HeapStats {
+  HeapMode mode = HeapMode::kOff;
+  // ArrayBuffer memory that is currently in explicit huge pages, or in
+  // regions that are advised to use transparent huge pages.
+  uint64_t explicit_bytes = 0;
+  uint64_t advised_bytes = 0;
+  // How often there were no explicit huge pages left for an ArrayBuffer.
+  uint64_t explicit_fallbacks = 0;
+  // V8 heap memory that has been advised to use transparent huge pages.
+  uint64_t heap_advised_bytes = 0;
+  // The anonymous memory of the whole process that the kernel backs with
+  // transparent huge pages, or -1 if it is unknown.
+  int64_t transparent_bytes = -1;
+};
+
+// Must be called before the V8 platform is created. Returns 0, or an error
+// for LargePagesError().
+int EnableHeapLargePages(HeapMode mode);
+// The page allocator for the V8 platform, or nullptr to use V8's own.
+v8::PageAllocator* GetHeapPageAllocator();
+
+// ArrayBuffer backing stores of at least this size go into large pages.
+// SIZE_MAX if they do not.
+size_t ArrayBufferThreshold();
+// Returns zero-filled memory, or nullptr if the default allocator should be
+// used instead.
+void* AllocateArrayBuffer(size_t size);
+// Returns false if `data` was not allocated by AllocateArrayBuffer().
+bool FreeArrayBuffer(void* data, size_t size);
+
+HeapStats GetHeapStats();
+
+}  // namespace large_pages
 }  // namespace node
 
 #endif  // NODE_WANT_INTERNALS
@@ -0,0 +1,407 @@
+#include "large_pages/node_large_page.h"
+
+#include "debug_utils-inl.h"
+#include "node_mutex.h"
+#include "util.h"
+#include "v8-platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#define NODE_HEAP_LARGE_PAGES 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+namespace large_pages {
+
+#if defined(NODE_HEAP_LARGE_PAGES)
+namespace {
+
+template <typename... Args>
+inline void Debug(std::string fmt, Args&&... args) {
+  node::Debug(&per_process::enabled_debug_list,
+              DebugCategory::HUGEPAGES,
+              (std::string("Hugepages info: ") + fmt).c_str(),
+              std::forward<Args>(args)...);
+}
+
+HeapMode heap_mode = HeapMode::kOff;
+size_t page_size = 0;
+// The size of a transparent huge page, or 0 if they are disabled.
+size_t transparent_page_size = 0;
+// The size of an explicit huge page, or 0 if they are not used.
+size_t explicit_page_size = 0;
+
+std::atomic<uint64_t> explicit_bytes{0};
+std::atomic<uint64_t> advised_bytes{0};
+std::atomic<uint64_t> explicit_fallbacks{0};
+std::atomic<uint64_t> heap_advised_bytes{0};
+
+struct ArrayBufferRegion {
+  size_t length;
+  bool is_explicit;
+};
+
+// The ArrayBuffer memory that AllocateArrayBuffer() has mapped. Leaked on
+// purpose, because backing stores may be freed during exit.
+struct ArrayBufferRegions {
+  Mutex mutex;
+  std::unordered_map<void*, ArrayBufferRegion> regions;
+};
+
+ArrayBufferRegions* GetArrayBufferRegions() {
+  static ArrayBufferRegions* regions = new ArrayBufferRegions();
+  return regions;
+}
+
+// Returns the value of `key` in a "key: value kB" file such as
+// /proc/meminfo, in bytes, or -1.
+int64_t ReadKilobytes(const char* filename, const std::string& key) {
+  std::ifstream stream(filename, std::ios::in);
+  std::string token;
+  while (stream >> token) {
+    if (token == key) {
+      int64_t kilobytes;
+      if (stream >> kilobytes) return kilobytes * 1024;
+      return -1;
+    }
+  }
+  return -1;
+}
+
+size_t ReadTransparentHugePageSize() {
+  // File format reference:
+  // https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+  std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled",
+                        std::ios::in);
+  std::string token;
+  bool have_thp = false;
+  while (enabled >> token) {
+    if (token == "[always]" || token == "[madvise]") have_thp = true;
+  }
+  if (!have_thp) return 0;
+
+  std::ifstream size_stream(
+      "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", std::ios::in);
+  size_t size = 0;
+  if (!(size_stream >> size) || size == 0 || size % page_size != 0)
+    size = 2 * 1024 * 1024;
+  return size;
+}
+
+// Maps `length` bytes at an address that is a multiple of `alignment`, by
+// mapping more than needed and unmapping what is left over on either side.
+void* MapAligned(void* hint, size_t length, size_t alignment, int prot,
+                 int flags) {
+  alignment = std::max(alignment, page_size);
+  hint = reinterpret_cast<void*>(
+      reinterpret_cast<uintptr_t>(hint) & ~(alignment - 1));
+  size_t request = length + alignment - page_size;
+  void* result = mmap(hint, request, prot, flags, -1, 0);
+  if (result == MAP_FAILED) return nullptr;
+
+  uintptr_t base = reinterpret_cast<uintptr_t>(result);
+  uintptr_t aligned = RoundUp(base, static_cast<uintptr_t>(alignment));
+  if (aligned != base)
+    CHECK_EQ(munmap(result, aligned - base), 0);
+  size_t suffix = base + request - (aligned + length);
+  if (suffix != 0)
+    CHECK_EQ(munmap(reinterpret_cast<void*>(aligned + length), suffix), 0);
+  return reinterpret_cast<void*>(aligned);
+}
+
+// Returns the number of bytes that were advised.
+size_t AdviseHugePages(void* address, size_t length) {
+  if (transparent_page_size == 0) return 0;
+  // This is advisory, so errors are ignored.
+  if (madvise(address, length, MADV_HUGEPAGE) != 0) return 0;
+  return length;
+}
+
+int ToProtection(v8::PageAllocator::Permission permission) {
+  switch (permission) {
+    case v8::PageAllocator::kNoAccess:
+    case v8::PageAllocator::kNoAccessWillJitLater:
+      return PROT_NONE;
+    case v8::PageAllocator::kRead:
+      return PROT_READ;
+    case v8::PageAllocator::kReadWrite:
+      return PROT_READ | PROT_WRITE;
+    case v8::PageAllocator::kReadWriteExecute:
+      return PROT_READ | PROT_WRITE | PROT_EXEC;
+    case v8::PageAllocator::kReadExecute:
+      return PROT_READ | PROT_EXEC;
+  }
+  UNREACHABLE();
+}
+
+// Works like V8's default page allocator on Linux, except that all memory
+// is advised to use transparent huge pages, and that allocations are put
+// next to each other until they fill a huge page. Most of the V8 heap is
+// allocated in chunks smaller than a huge page; the kernel merges adjacent
+// chunks into mappings that are large enough to be backed by huge pages.
+// Each huge page that is started still goes to a random address, so that
+// knowing one address does not give away where the rest of the heap is.
+class HeapPageAllocator final : public v8::PageAllocator {
+ public:
+  HeapPageAllocator() : rng_(std::random_device()()) {}
+
+  size_t AllocatePageSize() override { return page_size; }
+  size_t CommitPageSize() override { return page_size; }
+
+  void SetRandomMmapSeed(int64_t seed) override {
+    if (seed == 0) return;
+    Mutex::ScopedLock lock(mutex_);
+    rng_.seed(seed);
+  }
+
+  void* GetRandomMmapAddr() override {
+    Mutex::ScopedLock lock(mutex_);
+    // Keep filling the huge page that the last random address started.
+    uintptr_t next = next_address_.load(std::memory_order_relaxed);
+    if (next > run_start_ && next < run_start_ + transparent_page_size)
+      return reinterpret_cast<void*>(next);
+    // Like V8, keep to 46 of the 48 bits of virtual address space to give
+    // the kernel a fighting chance of fulfilling the request.
+    run_start_ = rng_() & uint64_t{0x3FFFFFFF0000} &
+                 ~static_cast<uint64_t>(transparent_page_size - 1);
+    return reinterpret_cast<void*>(run_start_);
+  }
+
+  void* AllocatePages(void* hint,
+                      size_t length,
+                      size_t alignment,
+                      Permission permission) override {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (permission == kNoAccess) flags |= MAP_NORESERVE;
+    void* result =
+        MapAligned(hint, length, alignment, ToProtection(permission), flags);
+    if (result == nullptr) return nullptr;
+    heap_advised_bytes.fetch_add(AdviseHugePages(result, length),
+                                 std::memory_order_relaxed);
+    next_address_.store(reinterpret_cast<uintptr_t>(result) + length,
+                        std::memory_order_relaxed);
+    return result;
+  }
+
+  bool FreePages(void* address, size_t length) override {
+    CHECK_EQ(munmap(address, length), 0);
+    return true;
+  }
+
+  bool ReleasePages(void* address, size_t length, size_t new_length) override {
+    CHECK_LT(new_length, length);
+    CHECK_EQ(munmap(static_cast<char*>(address) + new_length,
+                    length - new_length),
+             0);
+    return true;
+  }
+
+  bool SetPermissions(void* address,
+                      size_t length,
+                      Permission permission) override {
+    int ret = mprotect(address, length, ToProtection(permission));
+    // Setting permissions can fail if the limit of mappings is exceeded.
+    // Anything else is a bug in the caller.
+    if (ret != 0) {
+      CHECK_EQ(errno, ENOMEM);
+      return false;
+    }
+    if (permission == kNoAccess) {
+      DiscardSystemPages(address, length);
+    } else {
+      // The advice is lost when pages are decommitted.
+      AdviseHugePages(address, length);
+    }
+    return true;
+  }
+
+  bool RecommitPages(void* address,
+                     size_t length,
+                     Permission permission) override {
+    return SetPermissions(address, length, permission);
+  }
+
+  bool DiscardSystemPages(void* address, size_t size) override {
+    CHECK_EQ(madvise(address, size, MADV_DONTNEED), 0);
+    return true;
+  }
+
+  bool DecommitPages(void* address, size_t size) override {
+    // Replacing the mapping drops the pages, which read as zero when they
+    // are committed again.
+    void* ret = mmap(address,
+                     size,
+                     PROT_NONE,
+                     MAP_FIXED | MAP_ANONYMOUS | MAP_PRIVATE,
+                     -1,
+                     0);
+    if (ret == MAP_FAILED) {
+      CHECK_EQ(errno, ENOMEM);
+      return false;
+    }
+    CHECK_EQ(ret, address);
+    return true;
+  }
+
+ private:
+  Mutex mutex_;
+  std::mt19937_64 rng_;
+  std::atomic<uintptr_t> next_address_{0};
+  // The huge page that allocations are put into one after the other.
+  uintptr_t run_start_ = 0;
+};
+
+}  // anonymous namespace
+
+int EnableHeapLargePages(HeapMode mode) {
+  if (mode == HeapMode::kOff) return 0;
+  CHECK_EQ(heap_mode, HeapMode::kOff);
+
+  page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  transparent_page_size = ReadTransparentHugePageSize();
+  if (mode == HeapMode::kExplicit) {
+    int64_t size = ReadKilobytes("/proc/meminfo", "Hugepagesize:");
+    if (size > 0 && static_cast<size_t>(size) % page_size == 0)
+      explicit_page_size = static_cast<size_t>(size);
+  }
+  Debug("transparent huge pages of %zu bytes, explicit huge pages of %zu "
+        "bytes\n",
+        transparent_page_size,
+        explicit_page_size);
+  if (transparent_page_size == 0 && explicit_page_size == 0)
+    return EACCES;
+
+  heap_mode = mode;
+  return 0;
+}
+
+v8::PageAllocator* GetHeapPageAllocator() {
+  if (heap_mode == HeapMode::kOff || transparent_page_size == 0)
+    return nullptr;
+  static HeapPageAllocator* allocator = new HeapPageAllocator();
+  return allocator;
+}
+
+size_t ArrayBufferThreshold() {
+#if defined(V8_ENABLE_SANDBOX)
+  // Backing stores must be allocated inside of the sandbox.
+  return std::numeric_limits<size_t>::max();
+#else
+  if (heap_mode == HeapMode::kOff)
+    return std::numeric_limits<size_t>::max();
+  return std::max(transparent_page_size, explicit_page_size);
+#endif
+}
+
+void* AllocateArrayBuffer(size_t size) {
+  void* data = nullptr;
+  ArrayBufferRegion region{0, false};
+  if (explicit_page_size != 0) {
+    region.length = RoundUp(size, explicit_page_size);
+    // Do not waste more than an eighth of the memory on rounding up.
+    if (region.length - size <= size / 8) {
+      data = mmap(nullptr,
+                  region.length,
+                  PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                  -1,
+                  0);
+      if (data == MAP_FAILED) {
+        data = nullptr;
+        explicit_fallbacks.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        region.is_explicit = true;
+      }
+    }
+  }
+  if (data == nullptr && transparent_page_size != 0) {
+    region.length = RoundUp(size, page_size);
+    data = MapAligned(nullptr,
+                      region.length,
+                      transparent_page_size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS);
+    if (data != nullptr) AdviseHugePages(data, region.length);
+  }
+  if (data == nullptr) return nullptr;
+
+  (region.is_explicit ? explicit_bytes : advised_bytes)
+      .fetch_add(region.length, std::memory_order_relaxed);
+  ArrayBufferRegions* regions = GetArrayBufferRegions();
+  Mutex::ScopedLock lock(regions->mutex);
+  regions->regions.emplace(data, region);
+  return data;
+}
+
+bool FreeArrayBuffer(void* data, size_t size) {
+  ArrayBufferRegion region;
+  {
+    ArrayBufferRegions* regions = GetArrayBufferRegions();
+    Mutex::ScopedLock lock(regions->mutex);
+    auto it = regions->regions.find(data);
+    if (it == regions->regions.end()) return false;
+    region = it->second;
+    regions->regions.erase(it);
+  }
+  CHECK_LE(size, region.length);
+  CHECK_EQ(munmap(data, region.length), 0);
+  (region.is_explicit ? explicit_bytes : advised_bytes)
+      .fetch_sub(region.length, std::memory_order_relaxed);
+  return true;
+}
+
+HeapStats GetHeapStats() {
+  HeapStats stats;
+  stats.mode = heap_mode;
+  if (heap_mode == HeapMode::kOff) return stats;
+  stats.explicit_bytes = explicit_bytes.load(std::memory_order_relaxed);
+  stats.advised_bytes = advised_bytes.load(std::memory_order_relaxed);
+  stats.explicit_fallbacks =
+      explicit_fallbacks.load(std::memory_order_relaxed);
+  stats.heap_advised_bytes =
+      heap_advised_bytes.load(std::memory_order_relaxed);
+  stats.transparent_bytes =
+      ReadKilobytes("/proc/self/smaps_rollup", "AnonHugePages:");
+  return stats;
+}
+
+#else  // !defined(NODE_HEAP_LARGE_PAGES)
+
+int EnableHeapLargePages(HeapMode mode) {
+  return mode == HeapMode::kOff ? 0 : ENOTSUP;
+}
+
+v8::PageAllocator* GetHeapPageAllocator() {
+  return nullptr;
+}
+
+size_t ArrayBufferThreshold() {
+  return std::numeric_limits<size_t>::max();
+}
+
+void* AllocateArrayBuffer(size_t size) {
+  return nullptr;
+}
+
+bool FreeArrayBuffer(void* data, size_t size) {
+  return false;
+}
+
+HeapStats GetHeapStats() {
+  return HeapStats();
+}
+
+#endif  // defined(NODE_HEAP_LARGE_PAGES)
+
+}  // namespace large_pages
+}  // namespace node
@@ -0,0 +1,170 @@
+#include "module_fs_cache.h"
+
+#include "env-inl.h"
+#include "path.h"
+#include "util-inl.h"
+
+#ifndef S_ISDIR
+# define S_ISDIR(mode)  (((mode) & S_IFMT) == S_IFDIR)
+#endif
+
+namespace node {
+namespace fs {
+
+namespace {
+
+// inotify watches are a limited resource, and a dependency tree has
+// thousands of directories. Paths in directories beyond this many are not
+// cached when the cache relies on watchers.
+constexpr size_t kMaxWatchedDirectories = 1024;
+constexpr size_t kMaxEntries = 64 * 1024;
+
+std::string DirName(std::string_view path) {
+  size_t end = path.size();
+  while (end > 0 && !IsPathSeparator(path[end - 1])) end--;
+  while (end > 1 && IsPathSeparator(path[end - 1])) end--;
+  return std::string(path.substr(0, end));
+}
+
+}  // anonymous namespace
+
+ModuleFSCache::ModuleFSCache(Environment* env) : env_(env) {
+  if (env->options()->experimental_module_fs_cache) {
+    enabled_ = true;
+    watching_ = true;
+  }
+  env->AddCleanupHook(Cleanup, this);
+}
+
+ModuleFSCache::Entry* ModuleFSCache::GetEntry(std::string_view path) {
+  if (!enabled_) return nullptr;
+  auto [it, inserted] = entries_.try_emplace(std::string(path));
+  if (!inserted) return &it->second;
+  if (watching_ &&
+      (entries_.size() > kMaxEntries || !Watch(DirName(path)))) {
+    entries_.erase(it);
+    return nullptr;
+  }
+  return &it->second;
+}
+
+int ModuleFSCache::Stat(const char* path) {
+  Entry* entry = GetEntry(path);
+  if (entry != nullptr && entry->stat.has_value()) return *entry->stat;
+
+  uv_fs_t req;
+  int rc = uv_fs_stat(env_->event_loop(), &req, path, nullptr);
+  if (rc == 0) {
+    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+    rc = S_ISDIR(s->st_mode);
+  }
+  uv_fs_req_cleanup(&req);
+  if (entry != nullptr) entry->stat = rc;
+  return rc;
+}
+
+int ModuleFSCache::RealPath(const char* path, std::string* result) {
+  Entry* entry = GetEntry(path);
+  if (entry != nullptr && entry->realpath_result.has_value()) {
+    if (*entry->realpath_result == 0) *result = entry->realpath;
+    return *entry->realpath_result;
+  }
+
+  uv_fs_t req;
+  int err = uv_fs_realpath(nullptr, &req, path, nullptr);
+  if (err == 0) {
+    *result = static_cast<const char*>(req.ptr);
+  }
+  uv_fs_req_cleanup(&req);
+  if (entry != nullptr) {
+    entry->realpath_result = err;
+    if (err == 0) entry->realpath = *result;
+  }
+  return err;
+}
+
+int ModuleFSCache::ReadDir(const char* path,
+                           std::vector<std::string>* result) {
+  Entry* entry = GetEntry(path);
+  // The entries of a directory change with the directory itself.
+  if (entry != nullptr && watching_ && !Watch(path)) entry = nullptr;
+  if (entry != nullptr && entry->readdir_result.has_value()) {
+    if (*entry->readdir_result == 0) *result = entry->names;
+    return *entry->readdir_result;
+  }
+
+  uv_fs_t req;
+  auto defer_req_cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  int err = uv_fs_scandir(nullptr, &req, path, 0, nullptr);
+  if (err >= 0) {
+    err = 0;
+    result->clear();
+    for (;;) {
+      uv_dirent_t dirent;
+      int r = uv_fs_scandir_next(&req, &dirent);
+      if (r == UV_EOF) break;
+      if (r < 0) {
+        err = r;
+        break;
+      }
+      result->emplace_back(dirent.name);
+    }
+  }
+  if (entry != nullptr) {
+    entry->readdir_result = err;
+    if (err == 0) entry->names = *result;
+  }
+  return err;
+}
+
+void ModuleFSCache::SetEnabled(bool enabled) {
+  if (watching_) return;
+  enabled_ = enabled;
+  if (!enabled) Clear();
+}
+
+void ModuleFSCache::Clear() {
+  entries_.clear();
+}
+
+bool ModuleFSCache::Watch(const std::string& directory) {
+  if (watchers_.contains(directory)) return true;
+  if (watchers_.size() >= kMaxWatchedDirectories) return false;
+
+  uv_fs_event_t* handle = new uv_fs_event_t();
+  CHECK_EQ(uv_fs_event_init(env_->event_loop(), handle), 0);
+  handle->data = this;
+  if (uv_fs_event_start(handle, OnChange, directory.c_str(), 0) != 0) {
+    // E.g. directories that do not exist cannot be watched.
+    env_->CloseHandle(handle, [](uv_fs_event_t* handle) { delete handle; });
+    return false;
+  }
+  // Watching does not keep the process alive.
+  uv_unref(reinterpret_cast<uv_handle_t*>(handle));
+  watchers_.emplace(directory, handle);
+  return true;
+}
+
+void ModuleFSCache::OnChange(uv_fs_event_t* handle,
+                             const char* filename,
+                             int events,
+                             int status) {
+  // Which entries a change affects is not worth working out, e.g. renaming
+  // a directory affects the real paths of everything below it.
+  static_cast<ModuleFSCache*>(handle->data)->Clear();
+}
+
+void ModuleFSCache::Cleanup(void* data) {
+  ModuleFSCache* cache = static_cast<ModuleFSCache*>(data);
+  for (auto& [directory, handle] : cache->watchers_) {
+    cache->env_->CloseHandle(handle,
+                             [](uv_fs_event_t* handle) { delete handle; });
+  }
+  cache->watchers_.clear();
+  cache->entries_.clear();
+  cache->enabled_ = false;
+  cache->watching_ = false;
+}
+
+}  // namespace fs
+}  // namespace node
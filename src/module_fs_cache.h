@@ -0,0 +1,79 @@
+#ifndef SRC_MODULE_FS_CACHE_H_
+#define SRC_MODULE_FS_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "uv.h"
+
+namespace node {
+
+class Environment;
+
+namespace fs {
+
+// Caches the stat(), realpath() and readdir() calls of the module
+// resolvers, which ask about the same paths over and over again while a
+// module graph is loaded. There is one cache per Environment, shared by all
+// of its contexts.
+//
+// By default the cache is only enabled while the loaders load a graph, like
+// the stat cache of the CommonJS loader, and forgotten afterwards. With
+// --experimental-module-fs-cache it is always enabled instead, and cleared
+// when a file system watcher reports a change in one of the directories
+// that it has looked into. Symbolic links that change further up are not
+// noticed.
+class ModuleFSCache {
+ public:
+  explicit ModuleFSCache(Environment* env);
+  ModuleFSCache(const ModuleFSCache&) = delete;
+  ModuleFSCache& operator=(const ModuleFSCache&) = delete;
+
+  // Returns 0 for files, 1 for directories, or a negative libuv error.
+  int Stat(const char* path);
+  // These return 0, or a negative libuv error.
+  int RealPath(const char* path, std::string* result);
+  int ReadDir(const char* path, std::vector<std::string>* result);
+
+  // Disabling the cache clears it, unless it is kept up to date through
+  // watchers.
+  void SetEnabled(bool enabled);
+  bool enabled() const { return enabled_; }
+
+ private:
+  struct Entry {
+    std::optional<int> stat;
+    std::optional<int> realpath_result;
+    std::string realpath;
+    std::optional<int> readdir_result;
+    std::vector<std::string> names;
+  };
+
+  // Returns nullptr if `path` is not to be cached.
+  Entry* GetEntry(std::string_view path);
+  bool Watch(const std::string& directory);
+  void Clear();
+
+  static void OnChange(uv_fs_event_t* handle,
+                       const char* filename,
+                       int events,
+                       int status);
+  static void Cleanup(void* data);
+
+  Environment* env_;
+  bool enabled_ = false;
+  bool watching_ = false;
+  std::unordered_map<std::string, Entry> entries_;
+  std::unordered_map<std::string, uv_fs_event_t*> watchers_;
+};
+
+}  // namespace fs
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_MODULE_FS_CACHE_H_
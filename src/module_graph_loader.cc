@@ -0,0 +1,508 @@
+#include "module_graph_loader.h"
+
+#include "env-inl.h"
+#include "module_wrap.h"
+#include "node_errors.h"
+#include "node_module_pack.h"
+#include "node_modules.h"
+#include "node_mutex.h"
+#include "node_url.h"
+#include "permission/permission.h"
+#include "util-inl.h"
+
+#include <fcntl.h>
+#include <deque>
+#include <filesystem>
+#include <memory>
+
+namespace node {
+namespace loader {
+
+using v8::Context;
+using v8::FixedArray;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Map;
+using v8::MaybeLocal;
+using v8::Module;
+using v8::ModuleRequest;
+using v8::NewStringType;
+using v8::Object;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::String;
+using v8::Symbol;
+using v8::TryCatch;
+using v8::Undefined;
+using v8::Value;
+
+namespace {
+
+constexpr size_t kStreamingChunkSize = 64 * 1024;
+
+bool IsRelativeOrFileSpecifier(std::string_view specifier) {
+  return specifier.starts_with("./") || specifier.starts_with("../") ||
+         specifier.starts_with("/") || specifier.starts_with("file:");
+}
+
+}  // anonymous namespace
+
+// The modules whose sources are ready to be compiled.
+struct ModuleGraphLoader::SourceQueue {
+  Mutex mutex;
+  ConditionVariable cond;
+  std::deque<size_t> ready;
+
+  void Push(size_t index) {
+    Mutex::ScopedLock lock(mutex);
+    ready.push_back(index);
+    cond.Signal(lock);
+  }
+};
+
+// Reads the source of a module, and streams it into V8 if asked to.
+class ModuleGraphLoader::SourceJob {
+ public:
+  explicit SourceJob(const std::string& path) : path_(path) {}
+
+  // Called on the thread that owns the isolate before Run().
+  void StartStreaming(Isolate* isolate) {
+    streamed_source_ = std::make_unique<ScriptCompiler::StreamedSource>(
+        std::make_unique<Stream>(this),
+        ScriptCompiler::StreamedSource::UTF8);
+    streaming_task_.reset(ScriptCompiler::StartStreaming(
+        isolate, streamed_source_.get(), v8::ScriptType::kModule));
+  }
+
+  // Called on a worker thread.
+  void Run() {
+    if (streaming_task_) {
+      streaming_task_->Run();
+      streaming_task_.reset();
+    } else {
+      result_ = module_pack::ReadFileSync(&contents_, path_.c_str());
+    }
+    // V8 skips a byte order mark at the start of a stream, too.
+    if (std::string_view(contents_).starts_with("\xEF\xBB\xBF"))
+      contents_.erase(0, 3);
+  }
+
+  int result() const { return result_; }
+  const std::string& contents() const { return contents_; }
+  // Only set if the source has been streamed in.
+  ScriptCompiler::StreamedSource* streamed_source() const {
+    return streamed_source_.get();
+  }
+
+ private:
+  // Hands the file to V8 in chunks, so that it can parse the start of it
+  // while the rest is read.
+  class Stream : public ScriptCompiler::ExternalSourceStream {
+   public:
+    explicit Stream(SourceJob* job) : job_(job) {}
+
+    ~Stream() override {
+      if (fd_ < 0) return;
+      uv_fs_t req;
+      uv_fs_close(nullptr, &req, fd_, nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+
+    size_t GetMoreData(const uint8_t** src) override {
+      if (done_) return 0;
+      uv_fs_t req;
+      if (fd_ < 0) {
+        fd_ = uv_fs_open(nullptr, &req, job_->path_.c_str(), O_RDONLY, 0,
+                         nullptr);
+        uv_fs_req_cleanup(&req);
+        if (fd_ < 0) return Fail(fd_);
+      }
+      auto chunk = std::make_unique<uint8_t[]>(kStreamingChunkSize);
+      uv_buf_t buf = uv_buf_init(reinterpret_cast<char*>(chunk.get()),
+                                 kStreamingChunkSize);
+      const int read = uv_fs_read(nullptr, &req, fd_, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (read < 0) return Fail(read);
+      if (read == 0) {
+        done_ = true;
+        return 0;
+      }
+      job_->contents_.append(buf.base, read);
+      *src = chunk.release();
+      return read;
+    }
+
+   private:
+    // Ending the stream makes V8 stop parsing.
+    size_t Fail(int err) {
+      job_->result_ = err;
+      done_ = true;
+      return 0;
+    }
+
+    SourceJob* job_;
+    uv_file fd_ = -1;
+    bool done_ = false;
+  };
+
+  const std::string path_;
+  std::string contents_;
+  int result_ = 0;
+  std::unique_ptr<ScriptCompiler::StreamedSource> streamed_source_;
+  std::unique_ptr<ScriptCompiler::ScriptStreamingTask> streaming_task_;
+};
+
+class ModuleGraphLoader::SourceTask : public v8::Task {
+ public:
+  SourceTask(std::shared_ptr<SourceJob> job,
+             std::shared_ptr<SourceQueue> queue,
+             size_t index)
+      : job_(std::move(job)), queue_(std::move(queue)), index_(index) {}
+
+  void Run() override {
+    job_->Run();
+    queue_->Push(index_);
+  }
+
+ private:
+  std::shared_ptr<SourceJob> job_;
+  std::shared_ptr<SourceQueue> queue_;
+  size_t index_;
+};
+
+ModuleGraphLoader::ModuleGraphLoader(Realm* realm, Local<Map> loaded_modules)
+    : realm_(realm),
+      loaded_modules_(loaded_modules),
+      queue_(std::make_shared<SourceQueue>()),
+      // Code from the compile cache is better than what streaming can
+      // produce, but finding it takes the whole source.
+      streaming_(!realm->env()->use_compile_cache()) {}
+
+void ModuleGraphLoader::LoadModuleGraph(
+    const FunctionCallbackInfo<Value>& args) {
+  Realm* realm = Realm::GetCurrent(args);
+  Isolate* isolate = realm->isolate();
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsMap());
+  Utf8Value url(isolate, args[0]);
+
+  // Modules of one graph mostly live in the same few directories.
+  fs::ModuleFSCache* fs_cache = realm->env()->module_fs_cache();
+  const bool fs_cache_was_enabled = fs_cache->enabled();
+  fs_cache->SetEnabled(true);
+  auto restore_fs_cache = OnScopeLeave(
+      [&]() { fs_cache->SetEnabled(fs_cache_was_enabled); });
+
+  ModuleGraphLoader loader(realm, args[1].As<Map>());
+  if (loader.Load(url.ToString()) != Result::kOk) return;
+
+  std::vector<Local<Value>> wraps;
+  wraps.reserve(loader.modules_.size());
+  for (const ModuleRecord& record : loader.modules_)
+    wraps.push_back(record.wrap);
+  args.GetReturnValue().Set(
+      v8::Array::New(isolate, wraps.data(), wraps.size()));
+}
+
+ModuleGraphLoader::Result ModuleGraphLoader::Load(const std::string& url) {
+  auto root = ada::parse<ada::url_aggregator>(url);
+  if (!root || root->type != ada::scheme::FILE) return Result::kFallback;
+  // The root goes through the same checks as its dependencies. It should
+  // already be the URL of its real path, anything else is left to the
+  // JavaScript loader.
+  const ResolvedFile* file = ResolveFile(*root);
+  if (file == nullptr || file->url != url) return Result::kFallback;
+  AddModule(file->url, file->path);
+
+  // Modules are compiled in the order in which their sources become ready.
+  // Compiling one starts reading its dependencies. After a failure, the
+  // sources that are still being read are waited for, but not compiled.
+  Result result = Result::kOk;
+  while (pending_ > 0) {
+    const size_t index = WaitForSource();
+    if (result == Result::kOk) result = Compile(index);
+    modules_[index].source.reset();
+  }
+  if (result != Result::kOk) return result;
+  return Link();
+}
+
+void ModuleGraphLoader::StartReading(size_t index) {
+  const std::string& path = modules_[index].path;
+  auto job = std::make_shared<SourceJob>(path);
+  // Sources in the module pack are already in memory, and come with code
+  // cache.
+  module_pack::Entry entry;
+  if (streaming_ &&
+      (module_pack::Lookup(path, &entry) != module_pack::LookupResult::kFound ||
+       entry.kind != module_pack::EntryKind::kFile)) {
+    job->StartStreaming(realm_->isolate());
+  }
+  modules_[index].source = job;
+  pending_++;
+
+  MultiIsolatePlatform* platform = realm_->env()->isolate_data()->platform();
+  if (platform != nullptr && platform->NumberOfWorkerThreads() > 0) {
+    platform->CallOnWorkerThread(
+        std::make_unique<SourceTask>(std::move(job), queue_, index));
+  } else {
+    job->Run();
+    queue_->Push(index);
+  }
+}
+
+size_t ModuleGraphLoader::WaitForSource() {
+  Mutex::ScopedLock lock(queue_->mutex);
+  while (queue_->ready.empty()) queue_->cond.Wait(lock);
+  const size_t index = queue_->ready.front();
+  queue_->ready.pop_front();
+  pending_--;
+  return index;
+}
+
+ModuleGraphLoader::Result ModuleGraphLoader::Compile(size_t index) {
+  Isolate* isolate = realm_->isolate();
+  Local<Context> context = realm_->context();
+  ModuleRecord& record = modules_[index];
+  const SourceJob& job = *record.source;
+  // Let the JavaScript loader report files that cannot be read.
+  if (job.result() != 0) return Result::kFallback;
+
+  Local<String> url;
+  Local<String> source_text;
+  if (!String::NewFromUtf8(isolate,
+                           record.url.data(),
+                           NewStringType::kNormal,
+                           record.url.size())
+           .ToLocal(&url) ||
+      !String::NewFromUtf8(isolate,
+                           job.contents().data(),
+                           NewStringType::kNormal,
+                           job.contents().size())
+           .ToLocal(&source_text)) {
+    return Result::kException;
+  }
+
+  Local<Symbol> id_symbol =
+      realm_->isolate_data()->source_text_module_default_hdo();
+  if (job.streamed_source() != nullptr) {
+    ScriptOrigin origin(url,
+                        0,               // line offset
+                        0,               // column offset
+                        true,            // is cross origin
+                        -1,              // script id
+                        Local<Value>(),  // source map URL
+                        false,           // is opaque
+                        false,           // is WASM
+                        true,            // is ES Module
+                        ModuleWrap::GetHostDefinedOptions(isolate, id_symbol));
+    Local<Module> module;
+    {
+      errors::TryCatchScope try_catch(realm_->env());
+      if (!ScriptCompiler::CompileModule(
+               context, job.streamed_source(), source_text, origin)
+               .ToLocal(&module)) {
+        // Decorate errors like new ModuleWrap() does.
+        if (try_catch.HasCaught() && !try_catch.HasTerminated()) {
+          AppendExceptionLine(realm_->env(),
+                              try_catch.Exception(),
+                              try_catch.Message(),
+                              ErrorHandlingMode::MODULE_ERROR);
+          try_catch.ReThrow();
+        }
+        return Result::kException;
+      }
+    }
+    if (!ModuleWrap::Create(realm_, module, url, id_symbol)
+             .ToLocal(&record.wrap)) {
+      return Result::kException;
+    }
+  } else {
+    // new ModuleWrap(url, undefined, source, 0, 0, idSymbol), the same as
+    // the JavaScript loader does for the default loader, which also takes
+    // care of the compile cache.
+    Local<Value> argv[] = {
+        url,
+        Undefined(isolate),
+        source_text,
+        Integer::New(isolate, 0),
+        Integer::New(isolate, 0),
+        id_symbol,
+    };
+    Local<Function> constructor;
+    if (!realm_->isolate_data()
+             ->module_wrap_constructor_template()
+             ->GetFunction(context)
+             .ToLocal(&constructor) ||
+        !constructor->NewInstance(context, arraysize(argv), argv)
+             .ToLocal(&record.wrap)) {
+      return Result::kException;
+    }
+  }
+
+  ModuleWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, record.wrap, Result::kException);
+  auto referrer = ada::parse<ada::url_aggregator>(record.url);
+  CHECK(referrer);
+
+  Local<FixedArray> module_requests =
+      wrap->module_.Get(isolate)->GetModuleRequests();
+  std::vector<std::pair<std::string, std::string>> requests;
+  std::vector<ResolvedFile> files;
+  for (int i = 0; i < module_requests->Length(); i++) {
+    Local<ModuleRequest> request =
+        module_requests->Get(context, i).As<ModuleRequest>();
+    if (request->GetImportAttributes()->Length() > 0)
+      return Result::kFallback;
+    Utf8Value specifier(isolate, request->GetSpecifier());
+    const ResolvedFile* file = Resolve(specifier.ToString(), *referrer);
+    if (file == nullptr) return Result::kFallback;
+    requests.emplace_back(specifier.ToString(), file->url);
+    files.push_back(*file);
+  }
+
+  // This adds to modules_, so `record` must not be used after this.
+  for (const ResolvedFile& file : files) AddModule(file.url, file.path);
+  modules_[index].requests = std::move(requests);
+  return Result::kOk;
+}
+
+const ModuleGraphLoader::ResolvedFile* ModuleGraphLoader::Resolve(
+    const std::string& specifier, const ada::url_aggregator& referrer) {
+  if (!IsRelativeOrFileSpecifier(specifier)) return nullptr;
+  auto resolved = ada::parse<ada::url_aggregator>(specifier, &referrer);
+  // Queries and fragments make a separate module of the same file, and
+  // encoded slashes are an error. Both are left to the JavaScript loader.
+  if (!resolved || resolved->type != ada::scheme::FILE ||
+      resolved->has_search() || resolved->has_hash() ||
+      !resolved->get_hostname().empty()) {
+    return nullptr;
+  }
+  const std::string_view pathname = resolved->get_pathname();
+  for (size_t i = 0; i + 2 < pathname.size(); i++) {
+    if (pathname[i] == '%' && pathname[i + 1] == '2' &&
+        ((pathname[i + 2] | 0x20) == 'f' || (pathname[i + 2] | 0x20) == 'c')) {
+      return nullptr;
+    }
+  }
+
+  return ResolveFile(*resolved);
+}
+
+const ModuleGraphLoader::ResolvedFile* ModuleGraphLoader::ResolveFile(
+    const ada::url_aggregator& url) {
+  const std::string href(url.get_href());
+  auto it = resolved_files_.find(href);
+  if (it != resolved_files_.end()) return &it->second;
+
+  std::optional<std::string> path;
+  {
+    TryCatch try_catch(realm_->isolate());
+    path = url::FileURLToPath(realm_->env(), url);
+  }
+  if (!path.has_value()) return nullptr;
+
+  Environment* env = realm_->env();
+  std::string real_path;
+  if (env->module_fs_cache()->RealPath(path->c_str(), &real_path) < 0)
+    return nullptr;
+  // A link must not give access to a file that could not be read through
+  // its real path, nor the other way around.
+  if (env->permission()->enabled() &&
+      (!env->permission()->is_granted(
+           env, permission::PermissionScope::kFileSystemRead, *path) ||
+       !env->permission()->is_granted(
+           env, permission::PermissionScope::kFileSystemRead, real_path))) {
+    return nullptr;
+  }
+
+  ResolvedFile file{href, *path};
+  if (!env->options()->preserve_symlinks) {
+    // Modules are identified by the URLs of their real paths, which is
+    // what the JavaScript loader does, too.
+    file.path = std::move(real_path);
+    file.url = url::FromFilePath(file.path);
+  }
+  if (!IsModuleFile(file.path)) return nullptr;
+  return &resolved_files_.emplace(href, std::move(file)).first->second;
+}
+
+bool ModuleGraphLoader::IsModuleFile(const std::string& path) {
+  if (path.ends_with(".mjs")) return true;
+  if (!path.ends_with(".js")) return false;
+  // Files without a "type" go through syntax detection in JavaScript.
+  const modules::BindingData::PackageConfig* package_config =
+      modules::BindingData::TraverseParent(realm_, std::filesystem::path(path));
+  return package_config != nullptr && package_config->type == "module";
+}
+
+void ModuleGraphLoader::AddModule(const std::string& url,
+                                  const std::string& path) {
+  if (module_indices_.count(url) != 0) return;
+  Local<String> key;
+  if (!String::NewFromUtf8(realm_->isolate(),
+                           url.data(),
+                           NewStringType::kNormal,
+                           url.size())
+           .ToLocal(&key)) {
+    return;
+  }
+  if (loaded_modules_->Has(realm_->context(), key).FromMaybe(false)) return;
+  module_indices_.emplace(url, modules_.size());
+  modules_.push_back(ModuleRecord{url, path, nullptr, Local<Object>(), {}});
+  StartReading(modules_.size() - 1);
+}
+
+MaybeLocal<Object> ModuleGraphLoader::GetModule(const std::string& url) {
+  auto it = module_indices_.find(url);
+  if (it != module_indices_.end()) return modules_[it->second].wrap;
+
+  Local<Context> context = realm_->context();
+  Local<String> key;
+  Local<Value> module;
+  if (!String::NewFromUtf8(realm_->isolate(),
+                           url.data(),
+                           NewStringType::kNormal,
+                           url.size())
+           .ToLocal(&key) ||
+      !loaded_modules_->Get(context, key).ToLocal(&module)) {
+    return MaybeLocal<Object>();
+  }
+  if (!module->IsObject() ||
+      !realm_->isolate_data()->module_wrap_constructor_template()->HasInstance(
+          module)) {
+    return MaybeLocal<Object>();
+  }
+  return module.As<Object>();
+}
+
+ModuleGraphLoader::Result ModuleGraphLoader::Link() {
+  // Resolve everything before touching the new modules, so that they are
+  // left alone if the JavaScript loader has to take over after all.
+  std::vector<std::vector<Local<Object>>> targets(modules_.size());
+  for (size_t i = 0; i < modules_.size(); i++) {
+    for (const auto& request : modules_[i].requests) {
+      Local<Object> target;
+      if (!GetModule(request.second).ToLocal(&target))
+        return Result::kFallback;
+      targets[i].push_back(target);
+    }
+  }
+
+  Isolate* isolate = realm_->isolate();
+  for (size_t i = 0; i < modules_.size(); i++) {
+    ModuleWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, modules_[i].wrap, Result::kException);
+    for (size_t j = 0; j < modules_[i].requests.size(); j++) {
+      wrap->resolve_cache_[modules_[i].requests[j].first].Reset(
+          isolate, targets[i][j]);
+    }
+  }
+  return Result::kOk;
+}
+
+}  // namespace loader
+}  // namespace node
@@ -0,0 +1,101 @@
+#ifndef SRC_MODULE_GRAPH_LOADER_H_
+#define SRC_MODULE_GRAPH_LOADER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ada.h"
+#include "v8.h"
+
+namespace node {
+
+class Realm;
+
+namespace loader {
+
+// Loads the static import graph of an ES module in C++, instead of one
+// resolve, read, compile and link round trip through JavaScript per module.
+// It only handles the common case: relative and file: specifiers without
+// import attributes, that point to .mjs files or to .js files in a
+// "type": "module" package. Sources are read on the platform's worker
+// threads, and, unless the compile cache is in use, streamed into V8's
+// parser while they are read. The calling thread meanwhile compiles the
+// modules whose sources are ready, which discovers the next ones.
+//
+// When the graph contains anything else, e.g. bare specifiers, CommonJS or
+// JSON modules, or files that cannot be read, nothing is returned and the
+// JavaScript loader has to load the graph instead. It has to do so anyway
+// when customization hooks are registered.
+class ModuleGraphLoader {
+ public:
+  // loadModuleGraph(url, loadedModules)
+  // `url` is the resolved file: URL of the root module and `loadedModules` a
+  // Map of the URLs of the modules that the JavaScript loader already has to
+  // their ModuleWraps, which are linked to rather than loaded again.
+  // Returns the ModuleWraps of the new modules, root first, linked and ready
+  // to be instantiated through the root, or undefined to fall back to the
+  // JavaScript loader.
+  static void LoadModuleGraph(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+ private:
+  class SourceJob;
+  struct SourceQueue;
+  class SourceTask;
+
+  struct ModuleRecord {
+    std::string url;
+    std::string path;
+    std::shared_ptr<SourceJob> source;
+    v8::Local<v8::Object> wrap;
+    // Pairs of specifiers and the URLs that they resolve to.
+    std::vector<std::pair<std::string, std::string>> requests;
+  };
+
+  struct ResolvedFile {
+    std::string url;
+    std::string path;
+  };
+
+  enum class Result { kOk, kFallback, kException };
+
+  ModuleGraphLoader(Realm* realm, v8::Local<v8::Map> loaded_modules);
+
+  Result Load(const std::string& url);
+  void StartReading(size_t index);
+  // Returns the index of a module whose source is ready.
+  size_t WaitForSource();
+  Result Compile(size_t index);
+  // Returns nullptr if `specifier` is not handled here.
+  const ResolvedFile* Resolve(const std::string& specifier,
+                              const ada::url_aggregator& referrer);
+  // Returns nullptr if the file at `url` cannot be loaded here, including
+  // when the permission model does not allow it to be read.
+  const ResolvedFile* ResolveFile(const ada::url_aggregator& url);
+  bool IsModuleFile(const std::string& path);
+  // Adds the module at `url`, unless the JavaScript loader or an earlier
+  // request already has it.
+  void AddModule(const std::string& url, const std::string& path);
+  v8::MaybeLocal<v8::Object> GetModule(const std::string& url);
+  Result Link();
+
+  Realm* realm_;
+  v8::Local<v8::Map> loaded_modules_;
+  std::vector<ModuleRecord> modules_;
+  std::unordered_map<std::string, size_t> module_indices_;
+  // Maps the URLs that specifiers resolve to to the files behind them.
+  std::unordered_map<std::string, ResolvedFile> resolved_files_;
+  std::shared_ptr<SourceQueue> queue_;
+  // The number of sources that are being read.
+  size_t pending_ = 0;
+  const bool streaming_;
+};
+
+}  // namespace loader
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_MODULE_GRAPH_LOADER_H_
@@ -2,10 +2,12 @@
 
 #include "env.h"
 #include "memory_tracker-inl.h"
+#include "module_graph_loader.h"
 #include "node_contextify.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_module_pack.h"
 #include "node_process-inl.h"
 #include "node_watchdog.h"
 #include "util-inl.h"
@@ -364,9 +366,12 @@ MaybeLocal<Module> ModuleWrap::CompileSourceTextModule(
   // cached data.
   if (user_cached_data.has_value()) {
     cached_data = user_cached_data.value();
-  } else if (realm->env()->use_compile_cache()) {
-    cache_entry = realm->env()->compile_cache_handler()->GetOrInsert(
-        source_text, url, CachedCodeType::kESM);
+  } else {
+    cached_data = module_pack::GetCodeCacheForURL(realm->env(), url);
+    if (cached_data == nullptr && realm->env()->use_compile_cache()) {
+      cache_entry = realm->env()->compile_cache_handler()->GetOrInsert(
+          source_text, url, CachedCodeType::kESM);
+    }
   }
 
   if (cache_entry != nullptr && cache_entry->cache != nullptr) {
@@ -400,6 +405,49 @@ MaybeLocal<Module> ModuleWrap::CompileSourceTextModule(
   return scope.Escape(module);
 }
 
+MaybeLocal<Object> ModuleWrap::Create(Realm* realm,
+                                      Local<Module> module,
+                                      Local<String> url,
+                                      Local<Symbol> id_symbol) {
+  Isolate* isolate = realm->isolate();
+  Local<Context> context = realm->context();
+  Local<Object> that;
+  if (!realm->isolate_data()
+           ->module_wrap_constructor_template()
+           ->InstanceTemplate()
+           ->NewInstance(context)
+           .ToLocal(&that)) {
+    return MaybeLocal<Object>();
+  }
+
+  // The same properties as New() sets up for source text modules.
+  if (that->SetPrivate(context,
+                       realm->isolate_data()->host_defined_option_symbol(),
+                       id_symbol)
+          .IsNothing() ||
+      that->Set(context,
+                realm->env()->source_map_url_string(),
+                module->GetUnboundModuleScript()->GetSourceMappingURL())
+          .IsNothing() ||
+      that->Set(context, realm->isolate_data()->url_string(), url)
+          .IsNothing() ||
+      that->SetPrivate(context,
+                       realm->isolate_data()->source_map_data_private_symbol(),
+                       Undefined(isolate))
+          .IsNothing()) {
+    return MaybeLocal<Object>();
+  }
+
+  new ModuleWrap(realm,
+                 that,
+                 module,
+                 url,
+                 context->GetExtrasBindingObject(),
+                 Undefined(isolate));
+  that->SetIntegrityLevel(context, IntegrityLevel::kFrozen);
+  return that;
+}
+
 static Local<Object> createImportAttributesContainer(
     Realm* realm,
     Isolate* isolate,
@@ -1051,6 +1099,8 @@ void ModuleWrap::CreatePerIsolateProperties(IsolateData* isolate_data,
             target,
             "setInitializeImportMetaObjectCallback",
             SetInitializeImportMetaObjectCallback);
+  SetMethod(
+      isolate, target, "loadModuleGraph", ModuleGraphLoader::LoadModuleGraph);
 }
 
 void ModuleWrap::CreatePerContextProperties(Local<Object> target,
@@ -1093,6 +1143,7 @@ void ModuleWrap::RegisterExternalReferences(
 
   registry->Register(SetImportModuleDynamicallyCallback);
   registry->Register(SetInitializeImportMetaObjectCallback);
+  registry->Register(ModuleGraphLoader::LoadModuleGraph);
 }
 }  // namespace loader
 }  // namespace node
@@ -88,6 +88,14 @@ class ModuleWrap : public BaseObject {
       std::optional<v8::ScriptCompiler::CachedData*> user_cached_data,
       bool* cache_rejected);
 
+  // Wraps a source text module that has been compiled in the main context
+  // already, for example by streaming it in, into the same kind of object
+  // that new ModuleWrap(url, undefined, source, 0, 0, idSymbol) returns.
+  static v8::MaybeLocal<v8::Object> Create(Realm* realm,
+                                           v8::Local<v8::Module> module,
+                                           v8::Local<v8::String> url,
+                                           v8::Local<v8::Symbol> id_symbol);
+
  private:
   ModuleWrap(Realm* realm,
              v8::Local<v8::Object> object,
@@ -128,6 +136,8 @@ class ModuleWrap : public BaseObject {
       v8::Local<v8::Module> referrer);
   static ModuleWrap* GetFromModule(node::Environment*, v8::Local<v8::Module>);
 
+  friend class ModuleGraphLoader;
+
   v8::Global<v8::Module> module_;
   std::unordered_map<std::string, v8::Global<v8::Object>> resolve_cache_;
   contextify::ContextifyContext* contextify_context_ = nullptr;
@@ -0,0 +1,97 @@
+#ifndef SRC_MPSC_QUEUE_H_
+#define SRC_MPSC_QUEUE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace node {
+
+// An unbounded FIFO queue for any number of producer threads and exactly one
+// consumer thread, after Dmitry Vyukov's intrusive MPSC node queue. Push()
+// is wait-free: it allocates a node, swaps it in as the new head and links
+// the previous head to it. Pop() never blocks and never takes a lock.
+//
+// A producer that has swapped in its node but not yet linked it makes the
+// queue look empty to the consumer until it is done, so the consumer must
+// not take a failed Pop() as proof that every Push() that has started is
+// visible yet. Producers that notify the consumer after Push() returns,
+// e.g. through uv_async_send(), are always seen once the notification is.
+template <typename T>
+class MPSCQueue {
+ public:
+  MPSCQueue() : head_(&stub_), tail_(&stub_) {}
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  ~MPSCQueue() {
+    T value;
+    while (Pop(&value)) {
+    }
+  }
+
+  // Producer side. This may be called from any thread.
+  void Push(T value) { PushNode(new Node(std::move(value))); }
+
+  // Consumer side. Returns false if the queue is empty.
+  bool Pop(T* value) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) return false;
+      tail_ = tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next == nullptr) {
+      // `tail` is the last node. It can only be taken out once there is
+      // a node behind it, so put the stub back there.
+      if (tail != head_.load(std::memory_order_acquire)) return false;
+      PushNode(&stub_);
+      next = tail->next.load(std::memory_order_acquire);
+      if (next == nullptr) return false;
+    }
+    tail_ = next;
+    *value = std::move(tail->value);
+    delete tail;
+    return true;
+  }
+
+  // Consumer side. The result is only a snapshot.
+  bool IsEmpty() const {
+    return tail_ == &stub_ &&
+           stub_.next.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  struct Node {
+    Node() = default;
+    explicit Node(T&& value) : value(std::move(value)) {}
+
+    std::atomic<Node*> next{nullptr};
+    T value{};
+  };
+
+  void PushNode(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // Written by the producers.
+  alignas(kCacheLineSize) std::atomic<Node*> head_;
+
+  // Written by the consumer.
+  alignas(kCacheLineSize) Node* tail_;
+  Node stub_;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_MPSC_QUEUE_H_
@@ -45,6 +45,7 @@
 #include "node_snapshot_builder.h"
 #include "node_v8_platform-inl.h"
 #include "node_version.h"
+#include "node_zygote.h"
 
 #if HAVE_OPENSSL
 #include "node_crypto.h"
@@ -312,7 +313,11 @@ MaybeLocal<Value> StartExecution(Environment* env, StartExecutionCallback cb) {
 #endif
 
   if (env->options()->has_env_file_string) {
-    per_process::dotenv_file.SetEnvironment(env);
+    if (env->options()->experimental_lazy_env_file) {
+      per_process::dotenv_file.LayerOverEnvironment(env);
+    } else {
+      per_process::dotenv_file.SetEnvironment(env);
+    }
   }
 
   // TODO(joyeecheung): move these conditions into JS land and let the
@@ -890,6 +895,28 @@ static ExitCode InitializeNodeWithArgsInternal(
     if (exit_code != ExitCode::kNoFailure) return exit_code;
   }
 
+#ifdef __linux__
+  // libuv decides whether to set up an io_uring instance once, when the first
+  // event loop is initialized, based on UV_USE_IO_URING. It is off by default
+  // because of CVE-2024-22017. FileHandle reads, writes and fsyncs then bypass
+  // the threadpool and complete through the regular FSReqBase callbacks.
+  // The variable is only set for as long as it takes to initialize the
+  // default loop, so that child processes do not inherit it.
+  if (per_process::cli_options->experimental_io_uring) {
+    char previous[256];
+    size_t size = sizeof(previous);
+    int err = uv_os_getenv("UV_USE_IO_URING", previous, &size);
+    if (err == 0 || err == UV_ENOENT) {
+      uv_os_setenv("UV_USE_IO_URING", "1");
+      CHECK_NOT_NULL(uv_default_loop());
+      if (err == 0)
+        uv_os_setenv("UV_USE_IO_URING", previous);
+      else
+        uv_os_unsetenv("UV_USE_IO_URING");
+    }
+  }
+#endif
+
   // Set the process.title immediately after processing argv if --title is set.
   if (!per_process::cli_options->title.empty())
     uv_set_process_title(per_process::cli_options->title.c_str());
@@ -981,6 +1008,7 @@ InitializeOncePerProcessInternal(const std::vector<std::string>& args,
       result->early_return_ = true;
       return result;
     }
+    performance::performance_options_parsed = PERFORMANCE_NOW();
   }
 
   if (!(flags & ProcessInitializationFlags::kNoUseLargePages) &&
@@ -992,6 +1020,20 @@ InitializeOncePerProcessInternal(const std::vector<std::string>& args,
     }
   }
 
+  if (!(flags & ProcessInitializationFlags::kNoUseLargePages) &&
+      per_process::cli_options->use_largepages_heap != "off") {
+    // This has to happen before the V8 platform is created, which takes
+    // the page allocator.
+    large_pages::HeapMode mode =
+        per_process::cli_options->use_largepages_heap == "explicit"
+            ? large_pages::HeapMode::kExplicit
+            : large_pages::HeapMode::kMadvise;
+    int lp_result = large_pages::EnableHeapLargePages(mode);
+    if (lp_result != 0) {
+      result->errors_.emplace_back(node::LargePagesError(lp_result));
+    }
+  }
+
   if (!per_process::cli_options->run.empty()) {
     // TODO(@anonrig): Handle NODE_NO_WARNINGS, NODE_REDIRECT_WARNINGS,
     //  --disable-warning and --redirect-warnings.
@@ -1462,6 +1504,7 @@ static ExitCode StartInternal(int argc, char** argv) {
 }
 
 int Start(int argc, char** argv) {
+  zygote::MaybeRunServer(&argc, &argv);
 #ifndef DISABLE_SINGLE_EXECUTABLE_APPLICATION
   std::tie(argc, argv) = sea::FixupArgsForSEA(argc, argv);
 #endif
@@ -491,6 +491,12 @@ struct IsolateSettings {
       allow_wasm_code_generation_callback = nullptr;
   v8::ModifyCodeGenerationFromStringsCallback2
       modify_code_generation_from_strings_callback = nullptr;
+
+  // Heap limits for isolates created by NewIsolate(), e.g. when an embedder
+  // runs many isolates in one process. If 0, the limit is derived from the
+  // memory that is available to the process instead.
+  size_t max_young_generation_size_in_bytes = 0;
+  size_t max_old_generation_size_in_bytes = 0;
 };
 
 // Represents a startup snapshot blob, e.g. created by passing
@@ -511,6 +517,10 @@ struct IsolateSettings {
 // This option *must* be unset by embedders who wish to use the startup
 // feature during the build step by passing the --disable-shared-readonly-heap
 // flag to the configure script.
+// In that configuration, the Environments of all isolates created from the
+// same snapshot also share one index of the code cache of the builtins in
+// it, so an embedder that runs many isolates, e.g. one per tenant, pays for
+// it only once. Their heap limits can be set through `IsolateSettings`.
 //
 // The snapshot *must* be kept alive during the execution of the Isolate
 // that was created using it.
@@ -876,6 +886,22 @@ NODE_EXTERN struct uv_loop_s* GetCurrentEventLoop(v8::Isolate* isolate);
 // This function only works if `env` has an associated `MultiIsolatePlatform`.
 NODE_EXTERN v8::Maybe<int> SpinEventLoop(Environment* env);
 
+// For embedders that integrate the event loop of `env` into a reactor of
+// their own, e.g. an epoll or io_uring loop, instead of giving a thread to
+// SpinEventLoop(). The embedder waits until the file descriptor returned by
+// GetEventLoopBackendFd() is readable or GetEventLoopTimeout() milliseconds
+// have passed, and then calls RunEventLoopOnce() on the thread that `env`
+// runs on. RunEventLoopOnce() runs the callbacks that are ready without
+// blocking, and returns whether the event loop is still alive; once it is
+// not, SpinEventLoop() emits the 'beforeExit' and 'exit' events and returns
+// right away, unless 'beforeExit' listeners schedule more work.
+// GetEventLoopBackendFd() returns -1 on platforms without a pollable event
+// loop backend, e.g. Windows. GetEventLoopTimeout() returns -1 if the loop
+// does not need to be run again until the file descriptor is readable.
+NODE_EXTERN int GetEventLoopBackendFd(Environment* env);
+NODE_EXTERN int GetEventLoopTimeout(Environment* env);
+NODE_EXTERN v8::Maybe<bool> RunEventLoopOnce(Environment* env);
+
 NODE_EXTERN std::string GetAnonymousMainPath();
 
 class NODE_EXTERN CommonEnvironmentSetup {
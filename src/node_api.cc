@@ -3,6 +3,7 @@
 #define NAPI_EXPERIMENTAL
 #include "js_native_api_v8.h"
 #include "memory_tracker-inl.h"
+#include "mpsc_queue.h"
 #include "node_api.h"
 #include "node_api_internals.h"
 #include "node_binding.h"
@@ -18,6 +19,7 @@
 #include <atomic>
 #include <cstring>
 #include <memory>
+#include <thread>
 
 node_napi_env__::node_napi_env__(v8::Local<v8::Context> context,
                                  const std::string& module_filename,
@@ -55,23 +57,40 @@ void node_napi_env__::EnqueueFinalizer(v8impl::RefTracker* finalizer) {
   // When the env is being destructed, queued finalizers are drained in the
   // loop of `node_napi_env__::DrainFinalizerQueue`.
   if (!finalization_scheduled && !destructing) {
-    finalization_scheduled = true;
-    Ref();
-    node_env()->SetImmediate([this](node::Environment* node_env) {
-      finalization_scheduled = false;
-      Unref();
-      DrainFinalizerQueue();
-    });
+    ScheduleFinalization();
   }
 }
 
-void node_napi_env__::DrainFinalizerQueue() {
+void node_napi_env__::ScheduleFinalization() {
+  finalization_scheduled = true;
+  Ref();
+  node_env()->SetImmediate([this](node::Environment* node_env) {
+    finalization_scheduled = false;
+    Unref();
+    DrainFinalizerQueue(node_env->options()->node_api_finalizer_budget);
+  });
+}
+
+void node_napi_env__::DrainFinalizerQueue(uint64_t budget) {
+  if (pending_finalizers.empty()) return;
+  // The finalizers of a batch share the scopes.
+  v8::HandleScope handle_scope(isolate);
+  v8::Context::Scope context_scope(context());
   // As userland code can delete additional references in one finalizer,
   // the list of pending finalizers may be mutated as we execute them, so
   // we keep iterating it until it is empty.
-  while (!pending_finalizers.empty()) {
+  for (uint64_t count = 0; !pending_finalizers.empty(); count++) {
+    if (budget != 0 && count == budget) {
+      // Leave the rest to the next iteration of the event loop, so that a
+      // GC that collects many objects at once does not stall it.
+      if (!finalization_scheduled && !destructing) {
+        ScheduleFinalization();
+      }
+      return;
+    }
     v8impl::RefTracker* ref_tracker = *pending_finalizers.begin();
     pending_finalizers.erase(ref_tracker);
+    ref_tracker->set_pending_finalization(false);
     ref_tracker->Finalize();
   }
 }
@@ -211,7 +230,10 @@ class ThreadSafeFunction : public node::AsyncResource {
                      node_napi_env env_,
                      void* finalize_data_,
                      napi_finalize finalize_cb_,
-                     napi_threadsafe_function_call_js call_js_cb_)
+                     napi_threadsafe_function_call_js call_js_cb_,
+                     node_api_threadsafe_function_call_js_batch
+                         call_js_batch_cb_ = nullptr,
+                     size_t max_batch_size_ = 1)
       : AsyncResource(env_->isolate,
                       resource,
                       *v8::String::Utf8Value(env_->isolate, name)),
@@ -224,6 +246,8 @@ class ThreadSafeFunction : public node::AsyncResource {
         finalize_data(finalize_data_),
         finalize_cb(finalize_cb_),
         call_js_cb(call_js_cb_ == nullptr ? CallJs : call_js_cb_),
+        call_js_batch_cb(call_js_batch_cb_),
+        max_batch_size(max_batch_size_),
         handles_closing(false) {
     ref.Reset(env->isolate, func);
     node::AddEnvironmentCleanupHook(env->isolate, Cleanup, this);
@@ -238,9 +262,22 @@ class ThreadSafeFunction : public node::AsyncResource {
   // These methods can be called from any thread.
 
   napi_status Push(void* data, napi_threadsafe_function_call_mode mode) {
+    // Finalize() waits for the calls that are in here, so that it does not
+    // delete the function under a call that saw it open.
+    pushing++;
+    auto decrement_pushing = node::OnScopeLeave([&]() { pushing--; });
+
+    if (max_queue_size == 0 && !is_closing) {
+      // Unbounded queues never block, so the mutex is not needed unless the
+      // function is closing.
+      queue.Push(data);
+      SendUnlocked();
+      return napi_ok;
+    }
+
     node::Mutex::ScopedLock lock(this->mutex);
 
-    while (queue.size() >= max_queue_size && max_queue_size > 0 &&
+    while (queue_size >= max_queue_size && max_queue_size > 0 &&
            !is_closing) {
       if (mode == napi_tsfn_nonblocking) {
         return napi_queue_full;
@@ -256,7 +293,8 @@ class ThreadSafeFunction : public node::AsyncResource {
         return napi_closing;
       }
     } else {
-      queue.push(data);
+      queue.Push(data);
+      queue_size++;
       Send();
       return napi_ok;
     }
@@ -287,7 +325,7 @@ class ThreadSafeFunction : public node::AsyncResource {
       if (!is_closing) {
         is_closing = (mode == napi_tsfn_abort);
         if (is_closing && max_queue_size > 0) {
-          cond->Signal(lock);
+          cond->Broadcast(lock);
         }
         Send();
       }
@@ -297,8 +335,16 @@ class ThreadSafeFunction : public node::AsyncResource {
   }
 
   void EmptyQueueAndDelete() {
-    for (; !queue.empty(); queue.pop()) {
-      call_js_cb(nullptr, nullptr, context, queue.front());
+    batch.clear();
+    for (void* data; queue.Pop(&data);) {
+      if (call_js_batch_cb == nullptr) {
+        call_js_cb(nullptr, nullptr, context, data);
+      } else {
+        batch.push_back(data);
+      }
+    }
+    if (!batch.empty()) {
+      call_js_batch_cb(nullptr, nullptr, context, batch.data(), batch.size());
     }
     delete this;
   }
@@ -355,9 +401,11 @@ class ThreadSafeFunction : public node::AsyncResource {
     bool has_more = true;
 
     // Limit maximum synchronous iteration count to prevent event loop
-    // starvation. See `src/node_messaging.cc` for an inspiration.
-    unsigned int iterations_left = kMaxIterationCount;
-    while (has_more && --iterations_left != 0) {
+    // starvation. See `src/node_messaging.cc` for an inspiration. Batched
+    // functions hand over at most one batch per tick.
+    unsigned int iterations_left =
+        call_js_batch_cb == nullptr ? kMaxIterationCount - 1 : 1;
+    while (has_more && iterations_left-- != 0) {
       dispatch_state = kDispatchRunning;
       has_more = DispatchOne();
 
@@ -373,41 +421,37 @@ class ThreadSafeFunction : public node::AsyncResource {
   }
 
   bool DispatchOne() {
-    void* data = nullptr;
-    bool popped_value = false;
     bool has_more = false;
+    batch.clear();
 
-    {
+    if (max_queue_size == 0) {
+      // The producers of unbounded queues do not take the mutex, see Push(),
+      // so it is only needed to find out whether the function has to close.
+      if (!is_closing) {
+        PopBatch();
+        has_more = !queue.IsEmpty();
+      }
+      if (!has_more) {
+        node::Mutex::ScopedLock lock(this->mutex);
+        MaybeClose(lock);
+      }
+    } else {
       node::Mutex::ScopedLock lock(this->mutex);
-      if (is_closing) {
-        CloseHandlesAndMaybeDelete();
-      } else {
-        size_t size = queue.size();
-        if (size > 0) {
-          data = queue.front();
-          queue.pop();
-          popped_value = true;
-          if (size == max_queue_size && max_queue_size > 0) {
-            cond->Signal(lock);
-          }
-          size--;
-        }
-
-        if (size == 0) {
-          if (thread_count == 0) {
-            is_closing = true;
-            if (max_queue_size > 0) {
-              cond->Signal(lock);
-            }
-            CloseHandlesAndMaybeDelete();
-          }
-        } else {
-          has_more = true;
+      if (!is_closing) {
+        bool was_full = queue_size == max_queue_size;
+        PopBatch();
+        queue_size -= batch.size();
+        if (was_full && !batch.empty()) {
+          cond->Broadcast(lock);
         }
+        has_more = queue_size > 0;
+      }
+      if (!has_more) {
+        MaybeClose(lock);
       }
     }
 
-    if (popped_value) {
+    if (!batch.empty()) {
       v8::HandleScope scope(env->isolate);
       CallbackScope cb_scope(this);
       napi_value js_callback = nullptr;
@@ -416,14 +460,47 @@ class ThreadSafeFunction : public node::AsyncResource {
             v8::Local<v8::Function>::New(env->isolate, ref);
         js_callback = v8impl::JsValueFromV8LocalValue(js_cb);
       }
-      env->CallbackIntoModule<false>(
-          [&](napi_env env) { call_js_cb(env, js_callback, context, data); });
+      env->CallbackIntoModule<false>([&](napi_env env) {
+        if (call_js_batch_cb == nullptr) {
+          call_js_cb(env, js_callback, context, batch[0]);
+        } else {
+          call_js_batch_cb(
+              env, js_callback, context, batch.data(), batch.size());
+        }
+      });
     }
 
     return has_more;
   }
 
+  void PopBatch() {
+    size_t max_items = call_js_batch_cb == nullptr ? 1 : max_batch_size;
+    for (void* data; batch.size() < max_items && queue.Pop(&data);) {
+      batch.push_back(data);
+    }
+  }
+
+  // Closes the function if it is closing already, or if no thread holds it
+  // any longer and there is nothing left to call.
+  void MaybeClose(const node::Mutex::ScopedLock& lock) {
+    if (!is_closing) {
+      if (thread_count != 0 || !queue.IsEmpty()) {
+        return;
+      }
+      is_closing = true;
+      if (max_queue_size > 0) {
+        cond->Broadcast(lock);
+      }
+    }
+    CloseHandlesAndMaybeDelete();
+  }
+
   void Finalize() {
+    // Calls that saw the function open before it started closing may not
+    // have pushed their data yet.
+    while (pushing != 0) {
+      std::this_thread::yield();
+    }
     v8::HandleScope scope(env->isolate);
     if (finalize_cb) {
       CallbackScope cb_scope(this);
@@ -438,7 +515,7 @@ class ThreadSafeFunction : public node::AsyncResource {
       node::Mutex::ScopedLock lock(this->mutex);
       is_closing = true;
       if (max_queue_size > 0) {
-        cond->Signal(lock);
+        cond->Broadcast(lock);
       }
     }
     if (handles_closing) {
@@ -465,6 +542,23 @@ class ThreadSafeFunction : public node::AsyncResource {
     CHECK_EQ(0, uv_async_send(&async));
   }
 
+  // Like Send(), for callers that do not hold the mutex. The function may
+  // have started closing since they checked, and its handle must not be
+  // sent to once uv_close() was called on it. That happens only after
+  // `is_closing` was set under the mutex, so the mutex is taken to check it
+  // again. This is only needed when no dispatch is running or on its way,
+  // because either one picks up the data that was pushed.
+  void SendUnlocked() {
+    if (dispatch_state.fetch_or(kDispatchPending) != kDispatchIdle) {
+      return;
+    }
+
+    node::Mutex::ScopedLock lock(this->mutex);
+    if (!is_closing) {
+      CHECK_EQ(0, uv_async_send(&async));
+    }
+  }
+
   // Default way of calling into JavaScript. Used when ThreadSafeFunction is
   //  without a call_js_cb_.
   static void CallJs(napi_env env, napi_value cb, void* context, void* data) {
@@ -507,14 +601,18 @@ class ThreadSafeFunction : public node::AsyncResource {
 
   static const unsigned int kMaxIterationCount = 1000;
 
-  // These are variables protected by the mutex.
+  // These are variables protected by the mutex. Unbounded queues are not,
+  // see Push(). `is_closing` is only written under the mutex, but read
+  // without it on the way there.
   node::Mutex mutex;
   std::unique_ptr<node::ConditionVariable> cond;
-  std::queue<void*> queue;
+  node::MPSCQueue<void*> queue;
+  size_t queue_size = 0;
   uv_async_t async;
   size_t thread_count;
-  bool is_closing;
+  std::atomic_bool is_closing;
   std::atomic_uchar dispatch_state;
+  std::atomic_size_t pushing{0};
 
   // These are variables set once, upon creation, and then never again, which
   // means we don't need the mutex to read them.
@@ -527,6 +625,9 @@ class ThreadSafeFunction : public node::AsyncResource {
   void* finalize_data;
   napi_finalize finalize_cb;
   napi_threadsafe_function_call_js call_js_cb;
+  node_api_threadsafe_function_call_js_batch call_js_batch_cb;
+  size_t max_batch_size;
+  std::vector<void*> batch;
   bool handles_closing;
 };
 
@@ -635,6 +736,75 @@ class AsyncContext {
   bool lost_reference_;
 };
 
+napi_status CreateThreadSafeFunction(
+    napi_env env,
+    napi_value func,
+    napi_value async_resource,
+    napi_value async_resource_name,
+    size_t max_queue_size,
+    size_t initial_thread_count,
+    void* thread_finalize_data,
+    napi_finalize thread_finalize_cb,
+    void* context,
+    napi_threadsafe_function_call_js call_js_cb,
+    node_api_threadsafe_function_call_js_batch call_js_batch_cb,
+    size_t max_batch_size,
+    napi_threadsafe_function* result) {
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, async_resource_name);
+  RETURN_STATUS_IF_FALSE(env, initial_thread_count > 0, napi_invalid_arg);
+  CHECK_ARG(env, result);
+
+  napi_status status = napi_ok;
+
+  v8::Local<v8::Function> v8_func;
+  if (func == nullptr) {
+    RETURN_STATUS_IF_FALSE(
+        env, call_js_cb != nullptr || call_js_batch_cb != nullptr,
+        napi_invalid_arg);
+  } else {
+    CHECK_TO_FUNCTION(env, v8_func, func);
+  }
+
+  v8::Local<v8::Context> v8_context = env->context();
+
+  v8::Local<v8::Object> v8_resource;
+  if (async_resource == nullptr) {
+    v8_resource = v8::Object::New(env->isolate);
+  } else {
+    CHECK_TO_OBJECT(env, v8_context, v8_resource, async_resource);
+  }
+
+  v8::Local<v8::String> v8_name;
+  CHECK_TO_STRING(env, v8_context, v8_name, async_resource_name);
+
+  ThreadSafeFunction* ts_fn =
+      new ThreadSafeFunction(v8_func,
+                             v8_resource,
+                             v8_name,
+                             initial_thread_count,
+                             context,
+                             max_queue_size,
+                             reinterpret_cast<node_napi_env>(env),
+                             thread_finalize_data,
+                             thread_finalize_cb,
+                             call_js_cb,
+                             call_js_batch_cb,
+                             max_batch_size);
+
+  if (ts_fn == nullptr) {
+    status = napi_generic_failure;
+  } else {
+    // Init deletes ts_fn upon failure.
+    status = ts_fn->Init();
+    if (status == napi_ok) {
+      *result = reinterpret_cast<napi_threadsafe_function>(ts_fn);
+    }
+  }
+
+  return napi_set_last_error(env, status);
+}
+
 }  // end of anonymous namespace
 
 }  // end of namespace v8impl
@@ -1294,11 +1464,67 @@ napi_status NAPI_CDECL napi_queue_async_work(node_api_nogc_env env,
 
   uvimpl::Work* w = reinterpret_cast<uvimpl::Work*>(work);
 
+  w->set_pool(nullptr);
+  w->ScheduleWork();
+
+  return napi_clear_last_error(env);
+}
+
+napi_status NAPI_CDECL
+node_api_create_async_work_pool(node_api_nogc_env nogc_env,
+                                const char* name,
+                                size_t size,
+                                node_api_async_work_pool* result) {
+  napi_env env = const_cast<napi_env>(nogc_env);
+  CHECK_ENV(env);
+  CHECK_ARG(env, name);
+  CHECK_ARG(env, result);
+  RETURN_STATUS_IF_FALSE(env, size > 0, napi_invalid_arg);
+
+  node::ThreadPoolWorkQueue* pool =
+      reinterpret_cast<node_napi_env>(env)->node_env()->threadpool_work_pool(
+          name, size);
+  RETURN_STATUS_IF_FALSE(env, pool != nullptr, napi_invalid_arg);
+
+  *result = reinterpret_cast<node_api_async_work_pool>(pool);
+  return napi_clear_last_error(env);
+}
+
+napi_status NAPI_CDECL
+node_api_queue_async_work_in_pool(node_api_nogc_env env,
+                                  napi_async_work work,
+                                  node_api_async_work_pool pool) {
+  CHECK_ENV(env);
+  CHECK_ARG(env, work);
+  CHECK_ARG(env, pool);
+
+  uvimpl::Work* w = reinterpret_cast<uvimpl::Work*>(work);
+
+  w->set_pool(reinterpret_cast<node::ThreadPoolWorkQueue*>(pool));
   w->ScheduleWork();
 
   return napi_clear_last_error(env);
 }
 
+napi_status NAPI_CDECL
+node_api_get_async_work_pool_info(node_api_nogc_env env,
+                                  node_api_async_work_pool pool,
+                                  node_api_async_work_pool_info* result) {
+  CHECK_ENV(env);
+  CHECK_ARG(env, pool);
+  CHECK_ARG(env, result);
+
+  const node::ThreadPoolWorkQueue* queue =
+      reinterpret_cast<node::ThreadPoolWorkQueue*>(pool);
+  result->size = queue->limit;
+  result->running = queue->running;
+  result->waiting = queue->waiting.size();
+  result->max_waiting = queue->max_waiting;
+  result->completed = queue->completed;
+
+  return napi_clear_last_error(env);
+}
+
 napi_status NAPI_CDECL napi_cancel_async_work(node_api_nogc_env env,
                                               napi_async_work work) {
   CHECK_ENV(env);
@@ -1323,57 +1549,20 @@ napi_create_threadsafe_function(napi_env env,
                                 void* context,
                                 napi_threadsafe_function_call_js call_js_cb,
                                 napi_threadsafe_function* result) {
-  CHECK_ENV_NOT_IN_GC(env);
-  CHECK_ARG(env, async_resource_name);
-  RETURN_STATUS_IF_FALSE(env, initial_thread_count > 0, napi_invalid_arg);
-  CHECK_ARG(env, result);
-
-  napi_status status = napi_ok;
-
-  v8::Local<v8::Function> v8_func;
-  if (func == nullptr) {
-    CHECK_ARG(env, call_js_cb);
-  } else {
-    CHECK_TO_FUNCTION(env, v8_func, func);
-  }
-
-  v8::Local<v8::Context> v8_context = env->context();
-
-  v8::Local<v8::Object> v8_resource;
-  if (async_resource == nullptr) {
-    v8_resource = v8::Object::New(env->isolate);
-  } else {
-    CHECK_TO_OBJECT(env, v8_context, v8_resource, async_resource);
-  }
-
-  v8::Local<v8::String> v8_name;
-  CHECK_TO_STRING(env, v8_context, v8_name, async_resource_name);
-
-  v8impl::ThreadSafeFunction* ts_fn =
-      new v8impl::ThreadSafeFunction(v8_func,
-                                     v8_resource,
-                                     v8_name,
-                                     initial_thread_count,
-                                     context,
-                                     max_queue_size,
-                                     reinterpret_cast<node_napi_env>(env),
-                                     thread_finalize_data,
-                                     thread_finalize_cb,
-                                     call_js_cb);
-
-  if (ts_fn == nullptr) {
-    status = napi_generic_failure;
-  } else {
-    // Init deletes ts_fn upon failure.
-    status = ts_fn->Init();
-    if (status == napi_ok) {
-      *result = reinterpret_cast<napi_threadsafe_function>(ts_fn);
-    }
-  }
-
-  return napi_set_last_error(env, status);
+  return v8impl::CreateThreadSafeFunction(env,
+                                          func,
+                                          async_resource,
+                                          async_resource_name,
+                                          max_queue_size,
+                                          initial_thread_count,
+                                          thread_finalize_data,
+                                          thread_finalize_cb,
+                                          context,
+                                          call_js_cb,
+                                          nullptr,
+                                          1,
+                                          result);
 }
-
 napi_status NAPI_CDECL napi_get_threadsafe_function_context(
     napi_threadsafe_function func, void** result) {
   CHECK_NOT_NULL(func);
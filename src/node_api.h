@@ -256,6 +256,51 @@ node_api_get_module_file_name(node_api_nogc_env env, const char** result);
 
 #endif  // NAPI_VERSION >= 9
 
+#ifdef NAPI_EXPERIMENTAL
+
+#define NODE_API_EXPERIMENTAL_HAS_ASYNC_WORK_POOLS
+
+// Named pools cap how much of the libuv threadpool the async work queued
+// into them may occupy at the same time. A pool is shared by every addon of
+// the same Node.js environment that uses its name, and lives as long as the
+// environment. Creating a pool that exists already returns it, unless its
+// size is a different one.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_async_work_pool(node_api_nogc_env env,
+                                const char* name,
+                                size_t size,
+                                node_api_async_work_pool* result);
+
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_queue_async_work_in_pool(node_api_nogc_env env,
+                                  napi_async_work work,
+                                  node_api_async_work_pool pool);
+
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_get_async_work_pool_info(node_api_nogc_env env,
+                                  node_api_async_work_pool pool,
+                                  node_api_async_work_pool_info* result);
+
+#define NODE_API_EXPERIMENTAL_HAS_BATCHED_THREADSAFE_FUNCTION
+
+// Like napi_create_threadsafe_function(), but call_js_cb receives the queued
+// data in batches of up to max_batch_size items, once per loop iteration.
+NAPI_EXTERN napi_status NAPI_CDECL node_api_create_batched_threadsafe_function(
+    napi_env env,
+    napi_value func,
+    napi_value async_resource,
+    napi_value async_resource_name,
+    size_t max_queue_size,
+    size_t initial_thread_count,
+    void* thread_finalize_data,
+    napi_finalize thread_finalize_cb,
+    void* context,
+    size_t max_batch_size,
+    node_api_threadsafe_function_call_js_batch call_js_cb,
+    napi_threadsafe_function* result);
+
+#endif  // NAPI_EXPERIMENTAL
+
 EXTERN_C_END
 
 #endif  // SRC_NODE_API_H_
@@ -19,7 +19,10 @@ struct node_napi_env__ : public napi_env__ {
   void CallFinalizer(napi_finalize cb, void* data, void* hint);
 
   void EnqueueFinalizer(v8impl::RefTracker* finalizer) override;
-  void DrainFinalizerQueue();
+  // Runs at most `budget` of the pending finalizers, or all of them if
+  // `budget` is 0, and schedules the rest for the next iteration.
+  void DrainFinalizerQueue(uint64_t budget = 0);
+  void ScheduleFinalization();
 
   void trigger_fatal_exception(v8::Local<v8::Value> local_err);
   template <bool enforceUncaughtExceptionPolicy, typename T>
@@ -0,0 +1,349 @@
+#include "node_array_buffer_pool.h"
+
+#include "memory_tracker-inl.h"
+#include "node_mutex.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+#if !defined(_WIN32) && !defined(V8_ENABLE_SANDBOX)
+#define NODE_ARRAY_BUFFER_POOL 1
+#include <sys/mman.h>
+#endif
+
+namespace node {
+
+namespace {
+
+// The free objects of each size class that a thread keeps.
+constexpr size_t kThreadCacheBytes = 32 * 1024;
+constexpr size_t kMinThreadCacheObjects = 2;
+constexpr size_t kMaxThreadCacheObjects = 32;
+
+// Empty slabs are kept around for a while, so that a size class that is
+// busy does not map and unmap a slab over and over.
+constexpr size_t kRetainedEmptySlabs = 1;
+constexpr uint64_t kReleaseDelayNs = 5 * 1000 * 1000 * 1000ull;
+
+constexpr size_t kMinShift = 9;  // log2(kMinSize)
+static_assert(size_t{1} << kMinShift == ArrayBufferPool::kMinSize);
+
+size_t ThreadCacheCapacity(size_t size_class) {
+  return std::clamp(kThreadCacheBytes / ArrayBufferPool::ClassSize(size_class),
+                    kMinThreadCacheObjects,
+                    kMaxThreadCacheObjects);
+}
+
+#if defined(NODE_ARRAY_BUFFER_POOL)
+void* MapSlab() {
+  constexpr size_t kSize = ArrayBufferPool::kSlabSize;
+  // Slabs are aligned to their size, which is how a freed object finds its
+  // slab.
+  void* result = mmap(nullptr,
+                      2 * kSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1,
+                      0);
+  if (result == MAP_FAILED) return nullptr;
+  uintptr_t base = reinterpret_cast<uintptr_t>(result);
+  uintptr_t aligned = RoundUp(base, static_cast<uintptr_t>(kSize));
+  if (aligned != base) CHECK_EQ(munmap(result, aligned - base), 0);
+  size_t suffix = base + kSize - aligned;
+  if (suffix != 0)
+    CHECK_EQ(munmap(reinterpret_cast<void*>(aligned + kSize), suffix), 0);
+  return reinterpret_cast<void*>(aligned);
+}
+
+void UnmapSlab(void* base) {
+  CHECK_EQ(munmap(base, ArrayBufferPool::kSlabSize), 0);
+}
+#else
+void* MapSlab() {
+  return nullptr;
+}
+
+void UnmapSlab(void* base) {
+  UNREACHABLE();
+}
+#endif  // defined(NODE_ARRAY_BUFFER_POOL)
+
+}  // anonymous namespace
+
+struct ArrayBufferPool::Slab {
+  char* base;
+  uint32_t capacity;
+  // Objects that are handed out, including those in thread caches.
+  uint32_t used = 0;
+  // Objects past this index have never been handed out, so that a new slab
+  // is only touched as it fills up.
+  uint32_t fresh = 0;
+  FreeObject* free_list = nullptr;
+  uint64_t empty_since = 0;
+  ListNode<Slab> list_node;
+
+  bool HasFreeObjects() const {
+    return free_list != nullptr || fresh < capacity;
+  }
+};
+
+struct ArrayBufferPool::SizeClass {
+  Mutex mutex;
+  size_t object_size = 0;
+  std::unordered_map<uintptr_t, Slab*> slabs;
+  // Slabs that have free objects and are not empty. Full slabs are in no
+  // list.
+  ListHead<Slab, &Slab::list_node> partial;
+  // Empty slabs, the one that became empty first at the front.
+  ListHead<Slab, &Slab::list_node> empty;
+  size_t empty_count = 0;
+};
+
+class ArrayBufferPool::ThreadCache {
+ public:
+  ~ThreadCache() {
+    Flush();
+    destroyed_ = true;
+  }
+
+  // Returns nullptr while the thread exits, after its cache is gone.
+  static ThreadCache* Get() {
+    if (UNLIKELY(destroyed_)) return nullptr;
+    thread_local ThreadCache cache;
+    return &cache;
+  }
+
+  void* Allocate(ArrayBufferPool* pool, size_t size_class) {
+    Bin* bin = &bins_[size_class];
+    if (bin->head == nullptr) {
+      size_t batch = std::max<size_t>(ThreadCacheCapacity(size_class) / 2, 1);
+      bin->count = pool->Refill(size_class, batch, &bin->head);
+      if (bin->head == nullptr) return nullptr;
+      pool_ = pool;
+    }
+    FreeObject* object = bin->head;
+    bin->head = object->next;
+    bin->count--;
+    return object;
+  }
+
+  void Free(ArrayBufferPool* pool, size_t size_class, void* data) {
+    Bin* bin = &bins_[size_class];
+    FreeObject* object = static_cast<FreeObject*>(data);
+    object->next = bin->head;
+    bin->head = object;
+    pool_ = pool;
+    size_t capacity = ThreadCacheCapacity(size_class);
+    if (++bin->count <= capacity) return;
+
+    // Keep the objects that were freed last, since they are the most
+    // likely to still be in the CPU cache.
+    FreeObject* last = bin->head;
+    for (size_t i = 1; i < capacity / 2; i++) last = last->next;
+    FreeObject* rest = last->next;
+    last->next = nullptr;
+    bin->count = capacity / 2;
+    pool->Release(size_class, rest);
+  }
+
+  void Flush() {
+    if (pool_ == nullptr) return;
+    for (size_t i = 0; i < kNumClasses; i++) {
+      if (bins_[i].head == nullptr) continue;
+      pool_->Release(i, bins_[i].head);
+      bins_[i].head = nullptr;
+      bins_[i].count = 0;
+    }
+  }
+
+ private:
+  struct Bin {
+    FreeObject* head = nullptr;
+    size_t count = 0;
+  };
+
+  static thread_local bool destroyed_;
+
+  ArrayBufferPool* pool_ = nullptr;
+  Bin bins_[kNumClasses];
+};
+
+thread_local bool ArrayBufferPool::ThreadCache::destroyed_ = false;
+
+ArrayBufferPool::ArrayBufferPool() : size_classes_(new SizeClass[kNumClasses]) {
+  for (size_t i = 0; i < kNumClasses; i++) {
+    size_classes_[i].object_size = ClassSize(i);
+  }
+}
+
+ArrayBufferPool* ArrayBufferPool::Get() {
+#if defined(NODE_ARRAY_BUFFER_POOL)
+  // Leaked on purpose, since backing stores can be freed during exit.
+  static ArrayBufferPool* pool = new ArrayBufferPool();
+  return pool;
+#else
+  return nullptr;
+#endif
+}
+
+// The classes are kMinSize, then four evenly spaced sizes up to and
+// including each following power of two.
+size_t ArrayBufferPool::SizeClassOf(size_t size) {
+  DCHECK(IsPooledSize(size));
+  if (size <= kMinSize) return 0;
+  size_t shift = std::bit_width(size - 1) - 1;
+  size_t step = size_t{1} << (shift - 2);
+  size_t index = (size - (size_t{1} << shift) + step - 1) / step;
+  return 1 + (shift - kMinShift) * 4 + (index - 1);
+}
+
+size_t ArrayBufferPool::ClassSize(size_t size_class) {
+  DCHECK_LT(size_class, kNumClasses);
+  if (size_class == 0) return kMinSize;
+  size_t shift = kMinShift + (size_class - 1) / 4;
+  size_t index = (size_class - 1) % 4 + 1;
+  return (size_t{1} << shift) + index * (size_t{1} << (shift - 2));
+}
+
+void* ArrayBufferPool::Allocate(size_t size) {
+  size_t size_class = SizeClassOf(size);
+  void* data = nullptr;
+  if (ThreadCache* cache = ThreadCache::Get(); LIKELY(cache != nullptr)) {
+    data = cache->Allocate(this, size_class);
+  } else {
+    FreeObject* list = nullptr;
+    if (Refill(size_class, 1, &list) == 1) data = list;
+  }
+  if (data != nullptr)
+    used_bytes_.fetch_add(ClassSize(size_class), std::memory_order_relaxed);
+  return data;
+}
+
+void ArrayBufferPool::Free(void* data, size_t size) {
+  size_t size_class = SizeClassOf(size);
+  used_bytes_.fetch_sub(ClassSize(size_class), std::memory_order_relaxed);
+  if (ThreadCache* cache = ThreadCache::Get(); LIKELY(cache != nullptr)) {
+    cache->Free(this, size_class, data);
+  } else {
+    FreeObject* object = static_cast<FreeObject*>(data);
+    object->next = nullptr;
+    Release(size_class, object);
+  }
+}
+
+size_t ArrayBufferPool::Refill(size_t size_class,
+                               size_t count,
+                               FreeObject** list) {
+  SizeClass* sc = &size_classes_[size_class];
+  Mutex::ScopedLock lock(sc->mutex);
+  size_t moved = 0;
+  while (moved < count) {
+    Slab* slab;
+    if (!sc->partial.IsEmpty()) {
+      slab = *sc->partial.begin();
+    } else if (!sc->empty.IsEmpty()) {
+      slab = sc->empty.PopFront();
+      sc->empty_count--;
+      sc->partial.PushBack(slab);
+    } else {
+      void* base = MapSlab();
+      if (base == nullptr) break;
+      slab = new Slab();
+      slab->base = static_cast<char*>(base);
+      slab->capacity = kSlabSize / sc->object_size;
+      sc->slabs.emplace(reinterpret_cast<uintptr_t>(base), slab);
+      sc->partial.PushBack(slab);
+      mapped_bytes_.fetch_add(kSlabSize, std::memory_order_relaxed);
+    }
+
+    while (moved < count && slab->HasFreeObjects()) {
+      FreeObject* object = slab->free_list;
+      if (object != nullptr) {
+        slab->free_list = object->next;
+      } else {
+        object = reinterpret_cast<FreeObject*>(
+            slab->base + slab->fresh++ * sc->object_size);
+      }
+      object->next = *list;
+      *list = object;
+      slab->used++;
+      moved++;
+    }
+    if (!slab->HasFreeObjects()) slab->list_node.Remove();
+  }
+  return moved;
+}
+
+void ArrayBufferPool::Release(size_t size_class, FreeObject* list) {
+  SizeClass* sc = &size_classes_[size_class];
+  uint64_t now = uv_hrtime();
+  Mutex::ScopedLock lock(sc->mutex);
+  while (list != nullptr) {
+    FreeObject* object = list;
+    list = list->next;
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(object) & ~(kSlabSize - 1);
+    auto it = sc->slabs.find(base);
+    CHECK_NE(it, sc->slabs.end());
+    Slab* slab = it->second;
+    if (!slab->HasFreeObjects()) sc->partial.PushBack(slab);
+    object->next = slab->free_list;
+    slab->free_list = object;
+    if (--slab->used == 0) {
+      slab->list_node.Remove();
+      slab->empty_since = now;
+      sc->empty.PushBack(slab);
+      sc->empty_count++;
+    }
+  }
+  ReleaseEmptySlabs(sc, now, false);
+}
+
+void ArrayBufferPool::ReleaseEmptySlabs(SizeClass* sc, uint64_t now, bool all) {
+  while (!sc->empty.IsEmpty()) {
+    Slab* slab = *sc->empty.begin();
+    if (!all && sc->empty_count <= kRetainedEmptySlabs &&
+        now - slab->empty_since < kReleaseDelayNs) {
+      break;
+    }
+    sc->empty.PopFront();
+    sc->empty_count--;
+    sc->slabs.erase(reinterpret_cast<uintptr_t>(slab->base));
+    UnmapSlab(slab->base);
+    delete slab;
+    mapped_bytes_.fetch_sub(kSlabSize, std::memory_order_relaxed);
+    released_slabs_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void ArrayBufferPool::Trim() {
+  if (ThreadCache* cache = ThreadCache::Get()) cache->Flush();
+  for (size_t i = 0; i < kNumClasses; i++) {
+    Mutex::ScopedLock lock(size_classes_[i].mutex);
+    ReleaseEmptySlabs(&size_classes_[i], 0, true);
+  }
+}
+
+ArrayBufferPool::Stats ArrayBufferPool::GetStats() const {
+  Stats stats;
+  stats.mapped_bytes = mapped_bytes_.load(std::memory_order_relaxed);
+  stats.used_bytes = used_bytes_.load(std::memory_order_relaxed);
+  stats.released_slabs = released_slabs_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ArrayBufferPool::MemoryInfo(MemoryTracker* tracker) const {
+  // The objects that are handed out belong to their ArrayBuffers, so only
+  // the memory that is mapped but free is the pool's own.
+  Stats stats = GetStats();
+  // The counters are read one by one, while other threads may change them.
+  uint64_t free_bytes = stats.mapped_bytes > stats.used_bytes
+                            ? stats.mapped_bytes - stats.used_bytes
+                            : 0;
+  tracker->TrackFieldWithSize("free_objects", free_bytes);
+}
+
+}  // namespace node
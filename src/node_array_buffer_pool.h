@@ -0,0 +1,95 @@
+#ifndef SRC_NODE_ARRAY_BUFFER_POOL_H_
+#define SRC_NODE_ARRAY_BUFFER_POOL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "memory_tracker.h"
+#include "util.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace node {
+
+// A slab allocator for ArrayBuffer backing stores of kMinSize to kMaxSize
+// bytes, enabled with --array-buffer-pool. Workloads that create many
+// buffers of a few kilobytes fragment the malloc heap, which then stays
+// large long after the buffers are gone. Here each size class carves its
+// objects out of slabs of kSlabSize bytes that are mapped directly, so
+// that slabs which become empty can be returned to the operating system.
+//
+// There are four size classes per power of two, so that no more than a
+// quarter of an object is wasted. Every thread keeps a few free objects of
+// each class, so that allocating and freeing usually takes no lock. The
+// pool is shared by all isolates of the process, because backing stores
+// may be freed on a different thread than the one that allocated them.
+class ArrayBufferPool final : public MemoryRetainer {
+ public:
+  static constexpr size_t kMinSize = 512;
+  static constexpr size_t kMaxSize = 64 * 1024;
+  static constexpr size_t kSlabSize = 256 * 1024;
+  static constexpr size_t kNumClasses = 29;
+
+  struct Stats {
+    // Memory that is mapped for slabs.
+    uint64_t mapped_bytes = 0;
+    // Memory of the objects that are handed out, rounded up to their size
+    // class.
+    uint64_t used_bytes = 0;
+    // Slabs that were returned to the operating system.
+    uint64_t released_slabs = 0;
+  };
+
+  // Returns nullptr on platforms without support, and in builds with the
+  // V8 sandbox, where backing stores must live inside the sandbox.
+  static ArrayBufferPool* Get();
+
+  static inline bool IsPooledSize(size_t size) {
+    return size >= kMinSize && size <= kMaxSize;
+  }
+  static size_t SizeClassOf(size_t size);
+  static size_t ClassSize(size_t size_class);
+
+  // The memory is not initialized. Returns nullptr if no slab could be
+  // mapped.
+  void* Allocate(size_t size);
+  void Free(void* data, size_t size);
+
+  // Returns the free objects that the calling thread keeps to the shared
+  // pool, and all empty slabs to the operating system.
+  void Trim();
+
+  Stats GetStats() const;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(ArrayBufferPool)
+  SET_SELF_SIZE(ArrayBufferPool)
+
+ private:
+  struct FreeObject {
+    FreeObject* next;
+  };
+  struct Slab;
+  struct SizeClass;
+  class ThreadCache;
+
+  ArrayBufferPool();
+
+  // Move up to `count` objects between the shared pool and a linked list.
+  // They return the number of objects that were moved.
+  size_t Refill(size_t size_class, size_t count, FreeObject** list);
+  void Release(size_t size_class, FreeObject* list);
+  void ReleaseEmptySlabs(SizeClass* size_class, uint64_t now, bool all);
+
+  SizeClass* size_classes_;
+  std::atomic<uint64_t> mapped_bytes_{0};
+  std::atomic<uint64_t> used_bytes_{0};
+  std::atomic<uint64_t> released_slabs_{0};
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_ARRAY_BUFFER_POOL_H_
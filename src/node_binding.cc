@@ -29,6 +29,7 @@
 // The binding IDs that start with 'internal_only' are not exposed to the user
 // land even from internal/test/binding module under --expose-internals.
 #define NODE_BUILTIN_STANDARD_BINDINGS(V)                                      \
+  V(async_context_frame)                                                       \
   V(async_wrap)                                                                \
   V(blob)                                                                      \
   V(block_list)                                                                \
@@ -51,20 +52,26 @@
   V(internal_only_v8)                                                          \
   V(js_stream)                                                                 \
   V(js_udp_wrap)                                                               \
+  V(log_sink)                                                                  \
   V(messaging)                                                                 \
+  V(metrics)                                                                   \
   V(modules)                                                                   \
+  V(module_pack)                                                               \
   V(module_wrap)                                                               \
   V(mksnapshot)                                                                \
   V(options)                                                                   \
   V(os)                                                                        \
+  V(path)                                                                      \
   V(performance)                                                               \
   V(permission)                                                                \
   V(pipe_wrap)                                                                 \
+  V(pprof)                                                                     \
   V(process_wrap)                                                              \
   V(process_methods)                                                           \
   V(report)                                                                    \
   V(sea)                                                                       \
   V(serdes)                                                                    \
+  V(shm_channel)                                                               \
   V(signal_wrap)                                                               \
   V(spawn_sync)                                                                \
   V(stream_pipe)                                                               \
@@ -9,10 +9,12 @@
 #include "node_external_reference.h"
 #include "node_file.h"
 #include "permission/permission.h"
+#include "stream_base-inl.h"
 #include "util.h"
 #include "v8.h"
 
 #include <algorithm>
+#include <cstring>
 
 namespace node {
 
@@ -29,6 +31,7 @@ using v8::HandleScope;
 using v8::Int32;
 using v8::Isolate;
 using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::String;
@@ -119,6 +122,43 @@ void BlobFromFilePath(const FunctionCallbackInfo<Value>& args) {
     args.GetReturnValue().Set(array);
   }
 }
+
+// Unlike createBlobFromFilePath, the contents are captured when the Blob is
+// created, and slices share the mapping instead of reading the file again.
+// Blob readers copy out of the entry, so the mapping can stay read-only.
+void BlobFromMappedFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  BufferValue path(env->isolate(), args[0]);
+  CHECK_NOT_NULL(*path);
+  CHECK(args[1]->IsInt32());  // flags
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+
+  int flags = args[1].As<Int32>()->Value() | fs::kMapReadOnly;
+  int err = 0;
+  std::shared_ptr<BackingStore> store =
+      fs::MapFile(*path, 0, -1, flags, &err);
+  if (!store) return env->ThrowUVException(err, "mmap", nullptr, *path);
+
+  size_t length = store->ByteLength();
+  std::vector<std::unique_ptr<DataQueue::Entry>> entries;
+  entries.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(
+      std::move(store), 0, length));
+
+  auto blob =
+      Blob::Create(env, DataQueue::CreateIdempotent(std::move(entries)));
+
+  if (blob) {
+    auto array = Array::New(env->isolate(), 2);
+    USE(array->Set(env->context(), 0, blob->object()));
+    USE(array->Set(env->context(),
+                   1,
+                   Number::New(env->isolate(),
+                               static_cast<double>(blob->length()))));
+
+    args.GetReturnValue().Set(array);
+  }
+}
 }  // namespace
 
 void Blob::CreatePerIsolateProperties(IsolateData* isolate_data,
@@ -131,6 +171,7 @@ void Blob::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "revokeObjectURL", RevokeObjectURL);
   SetMethod(isolate, target, "concat", Concat);
   SetMethod(isolate, target, "createBlobFromFilePath", BlobFromFilePath);
+  SetMethod(isolate, target, "createBlobFromMappedFile", BlobFromMappedFile);
 }
 
 void Blob::CreatePerContextProperties(Local<Object> target,
@@ -287,9 +328,118 @@ Blob::Reader::Reader(Environment* env,
                      v8::Local<v8::Object> obj,
                      BaseObjectPtr<Blob> strong_ptr)
     : AsyncWrap(env, obj, AsyncWrap::PROVIDER_BLOBREADER),
+      StreamBase(env),
       inner_(strong_ptr->data_queue_->get_reader()),
       strong_ptr_(std::move(strong_ptr)) {
   MakeWeak();
+  StreamBase::AttachToObject(GetObject());
+}
+
+int Blob::Reader::ReadStart() {
+  if (stream_ended_) return UV_EOF;
+  if (!inner_) return UV_EINVAL;
+  reading_ = true;
+  PullForStream();
+  return 0;
+}
+
+int Blob::Reader::ReadStop() {
+  reading_ = false;
+  return 0;
+}
+
+int Blob::Reader::DoShutdown(ShutdownWrap* req_wrap) {
+  req_wrap->Done(0);
+  return 1;
+}
+
+int Blob::Reader::DoWrite(WriteWrap* w,
+                          uv_buf_t* bufs,
+                          size_t count,
+                          uv_stream_t* send_handle) {
+  return UV_ENOSYS;
+}
+
+bool Blob::Reader::EmitPulledData() {
+  // The listener allocates the buffers, so the data has to be copied once.
+  // For a StreamPipe, that is the only copy on the way to the sink.
+  while (pulled_index_ < pulled_.size()) {
+    if (!reading_) return false;
+    const DataQueue::Vec& vec = pulled_[pulled_index_];
+    size_t left = static_cast<size_t>(vec.len - pulled_offset_);
+    if (left == 0) {
+      pulled_index_++;
+      pulled_offset_ = 0;
+      continue;
+    }
+    uv_buf_t buf = EmitAlloc(left);
+    size_t length = std::min(left, buf.len);
+    memcpy(buf.base, vec.base + pulled_offset_, length);
+    pulled_offset_ += length;
+    EmitRead(length, buf);
+  }
+
+  pulled_.clear();
+  pulled_index_ = 0;
+  pulled_offset_ = 0;
+  if (pulled_done_) {
+    std::move(pulled_done_)(0);
+    pulled_done_ = nullptr;
+  }
+
+  int status = pulled_status_;
+  pulled_status_ = bob::STATUS_CONTINUE;
+  if (status == bob::STATUS_EOS || status < 0) {
+    stream_ended_ = true;
+    reading_ = false;
+    EmitRead(status == bob::STATUS_EOS ? UV_EOF : status);
+    return false;
+  }
+  if (status == bob::STATUS_BLOCK) {
+    // Nothing to read right now, so try again later instead of spinning.
+    BaseObjectPtr<Reader> self(this);
+    env()->SetImmediate([self](Environment* env) {
+      HandleScope handle_scope(env->isolate());
+      InternalCallbackScope callback_scope(
+          self.get(), InternalCallbackScope::kSkipTaskQueues);
+      self->PullForStream();
+    });
+    return false;
+  }
+  return true;
+}
+
+void Blob::Reader::PullForStream() {
+  if (!EmitPulledData()) return;
+
+  while (reading_ && !pulling_ && !stream_ended_) {
+    pulling_ = true;
+    in_pull_ = true;
+    BaseObjectPtr<Reader> self(this);
+    inner_->Pull(
+        [self](int status,
+               const DataQueue::Vec* vecs,
+               size_t count,
+               bob::Done done) {
+          Reader* reader = self.get();
+          reader->pulling_ = false;
+          reader->pulled_.assign(vecs, vecs + count);
+          reader->pulled_done_ = std::move(done);
+          reader->pulled_status_ = status;
+          // A synchronous answer is handled by the loop below.
+          if (reader->in_pull_) return;
+          Environment* env = reader->env();
+          HandleScope handle_scope(env->isolate());
+          InternalCallbackScope callback_scope(
+              reader, InternalCallbackScope::kSkipTaskQueues);
+          reader->PullForStream();
+        },
+        bob::OPTIONS_END,
+        nullptr,
+        0);
+    in_pull_ = false;
+    if (pulling_ || !EmitPulledData()) return;
+  }
 }
 
 bool Blob::Reader::HasInstance(Environment* env, v8::Local<v8::Value> value) {
@@ -302,9 +452,10 @@ Local<FunctionTemplate> Blob::Reader::GetConstructorTemplate(Environment* env) {
     Isolate* isolate = env->isolate();
     tmpl = NewFunctionTemplate(isolate, nullptr);
     tmpl->InstanceTemplate()->SetInternalFieldCount(
-        BaseObject::kInternalFieldCount);
+        StreamBase::kInternalFieldCount);
     tmpl->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "BlobReader"));
     SetProtoMethod(env->isolate(), tmpl, "pull", Pull);
+    StreamBase::AddMethods(env, tmpl);
     env->set_blob_reader_constructor_template(tmpl);
   }
   return tmpl;
@@ -521,13 +672,21 @@ void BlobBindingData::MemoryInfo(MemoryTracker* tracker) const {
 void BlobBindingData::store_data_object(
     const std::string& uuid,
     const BlobBindingData::StoredDataObject& object) {
+  mem::NativeMemoryCounters* counters = env()->native_memory_counters();
+  auto it = data_objects_.find(uuid);
+  if (it != data_objects_.end())
+    counters->Decrease(mem::NativeMemoryCounters::kBlob, it->second.length);
+  counters->Increase(mem::NativeMemoryCounters::kBlob, object.length);
   data_objects_[uuid] = object;
 }
 
 void BlobBindingData::revoke_data_object(const std::string& uuid) {
-  if (data_objects_.find(uuid) == data_objects_.end()) {
+  auto it = data_objects_.find(uuid);
+  if (it == data_objects_.end()) {
     return;
   }
+  env()->native_memory_counters()->Decrease(mem::NativeMemoryCounters::kBlob,
+                                            it->second.length);
   data_objects_.erase(uuid);
   CHECK_EQ(data_objects_.find(uuid), data_objects_.end());
 }
@@ -576,6 +735,7 @@ void Blob::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Blob::Reader::Pull);
   registry->Register(Concat);
   registry->Register(BlobFromFilePath);
+  registry->Register(BlobFromMappedFile);
 }
 
 }  // namespace node
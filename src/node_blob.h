@@ -13,6 +13,7 @@
 #include "node_internals.h"
 #include "node_snapshotable.h"
 #include "node_worker.h"
+#include "stream_base.h"
 #include "v8.h"
 
 #include <string>
@@ -74,7 +75,9 @@ class Blob : public BaseObject {
     std::shared_ptr<DataQueue> data_queue;
   };
 
-  class Reader final : public AsyncWrap {
+  // Besides pull(), a Reader can be read from as a stream, so that a
+  // StreamPipe can move the contents to a sink without going through JS.
+  class Reader final : public AsyncWrap, public StreamBase {
    public:
     static bool HasInstance(Environment* env, v8::Local<v8::Value> value);
     static v8::Local<v8::FunctionTemplate> GetConstructorTemplate(
@@ -87,14 +90,44 @@ class Blob : public BaseObject {
                     v8::Local<v8::Object> obj,
                     BaseObjectPtr<Blob> strong_ptr);
 
+    // StreamBase interface. Writing is not supported.
+    int ReadStart() override;
+    int ReadStop() override;
+    int DoShutdown(ShutdownWrap* req_wrap) override;
+    int DoWrite(WriteWrap* w,
+                uv_buf_t* bufs,
+                size_t count,
+                uv_stream_t* send_handle) override;
+    bool IsAlive() override { return !stream_ended_; }
+    bool IsClosing() override { return false; }
+    AsyncWrap* GetAsyncWrap() override { return this; }
+
     SET_NO_MEMORY_INFO()
     SET_MEMORY_INFO_NAME(Blob::Reader)
     SET_SELF_SIZE(Reader)
 
    private:
+    // Pulls and emits data for as long as the stream is being read from.
+    void PullForStream();
+    // Emits what is left of the last pull. Returns false if the listener
+    // stopped reading before all of it was emitted.
+    bool EmitPulledData();
+
     std::shared_ptr<DataQueue::Reader> inner_;
     BaseObjectPtr<Blob> strong_ptr_;
     bool eos_ = false;
+
+    bool reading_ = false;
+    bool pulling_ = false;
+    bool in_pull_ = false;
+    bool stream_ended_ = false;
+    // The data of the last pull that has not been emitted yet, and what to
+    // emit after it.
+    std::vector<DataQueue::Vec> pulled_;
+    size_t pulled_index_ = 0;
+    size_t pulled_offset_ = 0;
+    bob::Done pulled_done_;
+    int pulled_status_ = bob::STATUS_CONTINUE;
   };
 
   BaseObject::TransferMode GetTransferMode() const override;
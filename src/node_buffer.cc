@@ -52,11 +52,13 @@
 namespace node {
 namespace Buffer {
 
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::ArrayBufferView;
 using v8::BackingStore;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::FastApiCallbackOptions;
 using v8::FastApiTypedArray;
 using v8::FunctionCallbackInfo;
 using v8::Global;
@@ -540,6 +542,9 @@ void CreateFromString(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// buffer.<encoding>Slice(start, end[, share]), where |share| allows latin1
+// and ascii slices to be backed by the buffer's memory, see
+// StringBytes::EncodeShared().
 template <encoding encoding>
 void StringSlice(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -560,12 +565,21 @@ void StringSlice(const FunctionCallbackInfo<Value>& args) {
   size_t length = end - start;
 
   Local<Value> error;
-  MaybeLocal<Value> maybe_ret =
-      StringBytes::Encode(isolate,
-                          buffer.data() + start,
-                          length,
-                          encoding,
-                          &error);
+  MaybeLocal<Value> maybe_ret;
+  if ((encoding == LATIN1 || encoding == ASCII) && args[2]->IsTrue()) {
+    // The caller promises that the buffer is not going to be modified, so
+    // the string can share its memory.
+    maybe_ret = StringBytes::EncodeShared(
+        isolate,
+        args.This().As<ArrayBufferView>()->Buffer()->GetBackingStore(),
+        buffer.data() + start,
+        length,
+        encoding,
+        &error);
+  } else {
+    maybe_ret = StringBytes::Encode(
+        isolate, buffer.data() + start, length, encoding, &error);
+  }
   Local<Value> ret;
   if (!maybe_ret.ToLocal(&ret)) {
     CHECK(!error.IsEmpty());
@@ -707,6 +721,30 @@ start_fill:
 }
 
 
+// Fast path for filling with a single byte value, which is what
+// Buffer.alloc(size, number) and buf.fill(number) end up doing. String and
+// Buffer fill values don't match this signature and take the slow path.
+void FastFill(Local<Value> receiver,
+              const FastApiTypedArray<uint8_t>& target,
+              uint32_t value,
+              uint32_t start,
+              uint32_t end,
+              Local<Value> encoding,
+              FastApiCallbackOptions& options) {
+  uint8_t* data;
+  CHECK(target.getStorageIfAligned(&data));
+
+  // Let the slow path report out of bounds ranges.
+  if (start > end || end > target.length()) {
+    options.fallback = true;
+    return;
+  }
+
+  memset(data + start, value & 255, end - start);
+}
+
+static v8::CFunction fast_fill(v8::CFunction::Make(FastFill));
+
 template <encoding encoding>
 void StringWrite(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -828,6 +866,97 @@ void CompareOffset(const FunctionCallbackInfo<Value> &args) {
   args.GetReturnValue().Set(val);
 }
 
+int32_t FastCompareOffset(Local<Value> receiver,
+                          const FastApiTypedArray<uint8_t>& source,
+                          const FastApiTypedArray<uint8_t>& target,
+                          uint32_t target_start,
+                          uint32_t source_start,
+                          uint32_t target_end,
+                          uint32_t source_end,
+                          FastApiCallbackOptions& options) {
+  uint8_t* source_data;
+  uint8_t* target_data;
+  CHECK(source.getStorageIfAligned(&source_data));
+  CHECK(target.getStorageIfAligned(&target_data));
+
+  // Let the slow path report invalid ranges.
+  if (source_start > source.length() || target_start > target.length() ||
+      source_start > source_end || target_start > target_end) {
+    options.fallback = true;
+    return 0;
+  }
+
+  size_t to_cmp =
+      std::min(std::min(source_end - source_start, target_end - target_start),
+               static_cast<uint32_t>(source.length()) - source_start);
+
+  return normalizeCompareVal(to_cmp > 0 ?
+                               memcmp(source_data + source_start,
+                                      target_data + target_start,
+                                      to_cmp) : 0,
+                             source_end - source_start,
+                             target_end - target_start);
+}
+
+static v8::CFunction fast_compare_offset(
+    v8::CFunction::Make(FastCompareOffset));
+
+// Checks two byte ranges of the same length for equality. The short lengths
+// typical for hashes, ids and ETags are compared eight bytes at a time, with
+// the last load overlapping the previous ones, instead of calling memcmp().
+static inline bool BytesEqual(const uint8_t* a,
+                              const uint8_t* b,
+                              size_t length) {
+  if (length < sizeof(uint64_t)) {
+    for (size_t i = 0; i < length; i++) {
+      if (a[i] != b[i])
+        return false;
+    }
+    return true;
+  }
+
+  if (length > 64)
+    return memcmp(a, b, length) == 0;
+
+  auto load = [](const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  };
+  uint64_t diff = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) < length; i += sizeof(uint64_t))
+    diff |= load(a + i) ^ load(b + i);
+  const size_t last = length - sizeof(uint64_t);
+  diff |= load(a + last) ^ load(b + last);
+  return diff == 0;
+}
+
+void Equals(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[1]);
+  ArrayBufferViewContents<uint8_t> a(args[0]);
+  ArrayBufferViewContents<uint8_t> b(args[1]);
+
+  args.GetReturnValue().Set(a.length() == b.length() &&
+                            BytesEqual(a.data(), b.data(), a.length()));
+}
+
+bool FastEquals(Local<Value> receiver,
+                const FastApiTypedArray<uint8_t>& a,
+                const FastApiTypedArray<uint8_t>& b) {
+  uint8_t* data_a;
+  uint8_t* data_b;
+  CHECK(a.getStorageIfAligned(&data_a));
+  CHECK(b.getStorageIfAligned(&data_b));
+
+  return a.length() == b.length() && BytesEqual(data_a, data_b, a.length());
+}
+
+static v8::CFunction fast_equals(v8::CFunction::Make(FastEquals));
+
 void Compare(const FunctionCallbackInfo<Value> &args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1089,6 +1218,80 @@ void IndexOfBuffer(const FunctionCallbackInfo<Value>& args) {
       result == haystack_length ? -1 : static_cast<int>(result));
 }
 
+// Finds the first occurrence of any of several needles, e.g. a set of
+// delimiters, in a single forward pass over the buffer.
+// args: buffer, needles (an Array of ArrayBufferViews), byteOffset and
+// whether to return the index of the matching needle as well, as an
+// [offset, needle] pair. It returns rather than stores that index, so that
+// the binding is free of side effects like the other indexOf*() ones.
+void IndexOfAny(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsNumber());
+  CHECK(args[3]->IsBoolean());
+
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+  ArrayBufferViewContents<uint8_t> haystack(args[0]);
+  Local<Array> needle_list = args[1].As<Array>();
+  const size_t count = needle_list->Length();
+  int64_t offset_i64 = args[2].As<Integer>()->Value();
+
+  MaybeStackBuffer<const uint8_t*, 16> needles(count);
+  MaybeStackBuffer<size_t, 16> needle_lengths(count);
+  size_t min_needle = count;
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> needle;
+    if (!needle_list->Get(env->context(), i).ToLocal(&needle)) return;
+    THROW_AND_RETURN_UNLESS_BUFFER(env, needle);
+    needles[i] = reinterpret_cast<const uint8_t*>(Data(needle));
+    needle_lengths[i] = Length(needle);
+    if (min_needle == count || needle_lengths[i] < needle_lengths[min_needle])
+      min_needle = i;
+  }
+
+  const bool return_which = args[3]->IsTrue();
+  auto set_result = [&](double offset, size_t which) {
+    if (!return_which) return args.GetReturnValue().Set(offset);
+    Local<Value> pair[] = {
+        Number::New(env->isolate(), offset),
+        Integer::NewFromUnsigned(env->isolate(), static_cast<uint32_t>(which)),
+    };
+    args.GetReturnValue().Set(
+        Array::New(env->isolate(), pair, arraysize(pair)));
+  };
+
+  if (count == 0)
+    return set_result(-1, 0);
+
+  int64_t opt_offset = IndexOfOffset(haystack.length(),
+                                     offset_i64,
+                                     needle_lengths[min_needle],
+                                     true);
+
+  if (needle_lengths[min_needle] == 0) {
+    // Like indexOf(), an empty needle matches at the start offset. Of
+    // several needles, the shortest one is reported then.
+    return set_result(static_cast<double>(opt_offset), min_needle);
+  }
+
+  if (haystack.length() == 0 || opt_offset <= -1)
+    return set_result(-1, 0);
+
+  size_t which;
+  size_t result = stringsearch::SearchAny(haystack.data(),
+                                          haystack.length(),
+                                          needles.out(),
+                                          needle_lengths.out(),
+                                          count,
+                                          static_cast<size_t>(opt_offset),
+                                          &which);
+  if (result == haystack.length())
+    return set_result(-1, 0);
+
+  set_result(static_cast<double>(result), which);
+}
+
 void IndexOfNumber(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[1]->IsUint32());
   CHECK(args[2]->IsNumber());
@@ -1428,8 +1631,14 @@ void Initialize(Local<Object> target,
                             &fast_byte_length_utf8);
   SetMethod(context, target, "copy", Copy);
   SetFastMethodNoSideEffect(context, target, "compare", Compare, &fast_compare);
-  SetMethodNoSideEffect(context, target, "compareOffset", CompareOffset);
-  SetMethod(context, target, "fill", Fill);
+  SetFastMethodNoSideEffect(context,
+                            target,
+                            "compareOffset",
+                            CompareOffset,
+                            &fast_compare_offset);
+  SetFastMethodNoSideEffect(context, target, "equals", Equals, &fast_equals);
+  SetFastMethod(context, target, "fill", Fill, &fast_fill);
+  SetMethodNoSideEffect(context, target, "indexOfAny", IndexOfAny);
   SetMethodNoSideEffect(context, target, "indexOfBuffer", IndexOfBuffer);
   SetMethodNoSideEffect(context, target, "indexOfNumber", IndexOfNumber);
   SetMethodNoSideEffect(context, target, "indexOfString", IndexOfString);
@@ -1490,7 +1699,15 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(FastCompare);
   registry->Register(fast_compare.GetTypeInfo());
   registry->Register(CompareOffset);
+  registry->Register(FastCompareOffset);
+  registry->Register(fast_compare_offset.GetTypeInfo());
+  registry->Register(Equals);
+  registry->Register(FastEquals);
+  registry->Register(fast_equals.GetTypeInfo());
   registry->Register(Fill);
+  registry->Register(FastFill);
+  registry->Register(fast_fill.GetTypeInfo());
+  registry->Register(IndexOfAny);
   registry->Register(IndexOfBuffer);
   registry->Register(IndexOfNumber);
   registry->Register(IndexOfString);
@@ -3,6 +3,7 @@
 #include "env-inl.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_perf.h"
 #include "node_threadsafe_cow-inl.h"
 #include "simdutf.h"
 #include "util-inl.h"
@@ -14,6 +15,8 @@ using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Function;
 using v8::FunctionCallbackInfo;
+using v8::Global;
+using v8::HandleScope;
 using v8::IntegrityLevel;
 using v8::Isolate;
 using v8::Local;
@@ -303,6 +306,7 @@ MaybeLocal<Function> BuiltinLoader::LookupAndCompileInternal(
       has_cache ? "with" : "without",
       options == ScriptCompiler::kEagerCompile ? "eagerly" : "lazily");
 
+  const uint64_t compile_start = uv_hrtime();
   MaybeLocal<Function> maybe_fun =
       ScriptCompiler::CompileFunction(context,
                                       &script_source,
@@ -330,6 +334,8 @@ MaybeLocal<Function> BuiltinLoader::LookupAndCompileInternal(
   Result result = (has_cache && !script_source.GetCachedData()->rejected)
                       ? Result::kWithCache
                       : Result::kWithoutCache;
+  performance::RecordBuiltinCompilation(
+      id, compile_start, uv_hrtime(), result == Result::kWithCache);
   if (optional_realm != nullptr) {
     DCHECK_EQ(this, optional_realm->env()->builtin_loader());
     RecordResult(id, result, optional_realm);
@@ -355,7 +361,7 @@ MaybeLocal<Function> BuiltinLoader::LookupAndCompileInternal(
     // This is only done when the isolate is not being serialized because
     // V8 does not support serializing code cache with an unfinalized read-only
     // space (which is what isolates pending to be serialized have).
-    SaveCodeCache(id, fun);
+    SaveCodeCacheAfterExecution(optional_realm->env(), id, fun);
   }
 
   return scope.Escape(fun);
@@ -373,6 +379,28 @@ void BuiltinLoader::SaveCodeCache(const char* id, Local<Function> fun) {
   }
 }
 
+// Builtins that are not part of the snapshot are compiled lazily, so a code
+// cache created right after compilation only contains the top-level
+// function. Wait until the builtin has been run for the current tick instead,
+// so that the cache also covers the inner functions that were compiled
+// while loading it, which is what other environments (e.g. workers) reusing
+// the cache are going to need as well.
+void BuiltinLoader::SaveCodeCacheAfterExecution(Environment* env,
+                                                const char* id,
+                                                Local<Function> fun) {
+  env->SetImmediate(
+      [id = std::string(id),
+       fun = Global<Function>(env->isolate(), fun)](Environment* env) {
+        HandleScope handle_scope(env->isolate());
+        per_process::Debug(DebugCategory::CODE_CACHE,
+                           "Saving code cache of %s after execution\n",
+                           id);
+        env->builtin_loader()->SaveCodeCache(id.c_str(),
+                                             fun.Get(env->isolate()));
+      },
+      CallbackFlags::kUnrefed);
+}
+
 MaybeLocal<Function> BuiltinLoader::LookupAndCompile(Local<Context> context,
                                                      const char* id,
                                                      Realm* optional_realm) {
@@ -492,7 +520,15 @@ bool BuiltinLoader::CompileAllBuiltinsAndCopyCodeCache(
     Local<Context> context,
     const std::vector<std::string>& eager_builtins,
     std::vector<CodeCacheInfo>* out) {
-  std::vector<std::string_view> ids = GetBuiltinIds();
+  return CompileBuiltinsAndCopyCodeCache(
+      context, eager_builtins, GetBuiltinIds(), out);
+}
+
+bool BuiltinLoader::CompileBuiltinsAndCopyCodeCache(
+    Local<Context> context,
+    const std::vector<std::string>& eager_builtins,
+    const std::vector<std::string_view>& ids,
+    std::vector<CodeCacheInfo>* out) {
   bool all_succeeded = true;
   std::string v8_tools_prefix = "internal/deps/v8/tools/";
   std::string primordial_prefix = "internal/per_context/";
@@ -549,6 +585,18 @@ void BuiltinLoader::RefreshCodeCache(const std::vector<CodeCacheInfo>& in) {
   code_cache_->has_code_cache = true;
 }
 
+static Mutex shared_code_cache_mutex;
+
+void BuiltinLoader::UseSharedCodeCache(const SnapshotData* snapshot_data) {
+  Mutex::ScopedLock lock(shared_code_cache_mutex);
+  if (snapshot_data->shared_code_cache) {
+    code_cache_ = snapshot_data->shared_code_cache;
+    return;
+  }
+  RefreshCodeCache(snapshot_data->code_cache);
+  snapshot_data->shared_code_cache = code_cache_;
+}
+
 void BuiltinLoader::GetBuiltinCategories(
     Local<Name> property, const PropertyCallbackInfo<Value>& info) {
   Environment* env = Environment::GetCurrent(info);
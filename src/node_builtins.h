@@ -21,8 +21,10 @@ class PerProcessTest;
 
 namespace node {
 class SnapshotBuilder;
+class Environment;
 class ExternalReferenceRegistry;
 class Realm;
+struct SnapshotData;
 
 namespace builtins {
 
@@ -116,7 +118,19 @@ class NODE_EXTERN_PRIVATE BuiltinLoader {
       v8::Local<v8::Context> context,
       const std::vector<std::string>& lazy_builtins,
       std::vector<CodeCacheInfo>* out);
+  // Like CompileAllBuiltinsAndCopyCodeCache(), but only compiles the given
+  // builtins, so that the work can be split between several isolates.
+  bool CompileBuiltinsAndCopyCodeCache(
+      v8::Local<v8::Context> context,
+      const std::vector<std::string>& lazy_builtins,
+      const std::vector<std::string_view>& ids,
+      std::vector<CodeCacheInfo>* out);
   void RefreshCodeCache(const std::vector<CodeCacheInfo>& in);
+  // Like RefreshCodeCache(), but the code cache of the snapshot is only
+  // indexed by the first loader that uses it, and shared by the loaders of
+  // all other Environments that are deserialized from the same snapshot.
+  // This is only safe if every isolate shares the same read only space.
+  void UseSharedCodeCache(const SnapshotData* snapshot_data);
 
   void CopySourceAndCodeCacheReferenceFrom(const BuiltinLoader* other);
 
@@ -124,6 +138,12 @@ class NODE_EXTERN_PRIVATE BuiltinLoader {
 
   void SetEagerCompile() { should_eager_compile_ = true; }
 
+  struct BuiltinCodeCache {
+    RwLock mutex;
+    BuiltinCodeCacheMap map;
+    bool has_code_cache = false;
+  };
+
  private:
   // Only allow access from friends.
   friend class CodeCacheBuilder;
@@ -153,6 +173,9 @@ class NODE_EXTERN_PRIVATE BuiltinLoader {
       std::vector<v8::Local<v8::String>>* parameters,
       Realm* optional_realm);
   void SaveCodeCache(const char* id, v8::Local<v8::Function> fn);
+  void SaveCodeCacheAfterExecution(Environment* env,
+                                   const char* id,
+                                   v8::Local<v8::Function> fn);
 
   static void RecordResult(const char* id,
                            BuiltinLoader::Result result,
@@ -195,11 +218,6 @@ class NODE_EXTERN_PRIVATE BuiltinLoader {
   bool should_eager_compile_ = false;
   std::unordered_set<std::string> to_eager_compile_;
 
-  struct BuiltinCodeCache {
-    RwLock mutex;
-    BuiltinCodeCacheMap map;
-    bool has_code_cache = false;
-  };
   std::shared_ptr<BuiltinCodeCache> code_cache_;
 
   friend class ::PerProcessTest;
@@ -0,0 +1,365 @@
+#include "node_checksum.h"
+#include "util.h"
+#include "zlib.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NODE_CHECKSUM_X64 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__)) &&    \
+    (defined(__linux__) || defined(__APPLE__))
+#define NODE_CHECKSUM_ARM64 1
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+namespace node {
+namespace checksum {
+
+namespace {
+
+template <typename T>
+inline T LoadLE(const uint8_t* data) {
+  T value = 0;
+  if constexpr (IsBigEndian()) {
+    for (size_t i = 0; i < sizeof(value); i++)
+      value |= static_cast<T>(data[i]) << (8 * i);
+  } else {
+    memcpy(&value, data, sizeof(value));
+  }
+  return value;
+}
+
+// Slicing-by-8 tables for the reflected Castagnoli polynomial, used when the
+// CPU has no CRC-32C instruction.
+constexpr uint32_t kCrc32cPolynomial = 0x82f63b78;
+
+constexpr std::array<std::array<uint32_t, 256>, 8> MakeCrc32cTables() {
+  std::array<std::array<uint32_t, 256>, 8> tables{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++)
+      crc = (crc >> 1) ^ (kCrc32cPolynomial & (0 - (crc & 1)));
+    tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    for (size_t t = 1; t < tables.size(); t++)
+      tables[t][i] =
+          (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xff];
+  }
+  return tables;
+}
+
+constexpr auto kCrc32cTables = MakeCrc32cTables();
+
+// Operates on the inverted CRC, like all of the kernels below.
+uint32_t Crc32cPortable(uint32_t crc, const uint8_t* data, size_t length) {
+  const auto& t = kCrc32cTables;
+  while (length >= 8) {
+    uint32_t low = LoadLE<uint32_t>(data) ^ crc;
+    uint32_t high = LoadLE<uint32_t>(data + 4);
+    crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^
+          t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^
+          t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^
+          t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+    data += 8;
+    length -= 8;
+  }
+  while (length-- > 0) crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xff];
+  return crc;
+}
+
+#if NODE_CHECKSUM_X64
+
+bool HasPclmul() {
+  static const bool result =
+      __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul");
+  return result;
+}
+
+bool HasSse42() {
+  static const bool result = __builtin_cpu_supports("sse4.2");
+  return result;
+}
+
+constexpr size_t kCrc32FoldMinLength = 64;
+
+inline __m128i Load128(const uint8_t* data) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+// Folds |x| forward by the distance encoded in |k| and adds in |next|.
+__attribute__((target("pclmul"))) inline __m128i Fold128(__m128i x,
+                                                         __m128i k,
+                                                         __m128i next) {
+  __m128i low = _mm_clmulepi64_si128(x, k, 0x00);
+  __m128i high = _mm_clmulepi64_si128(x, k, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(high, low), next);
+}
+
+// CRC-32 by folding 64 bytes at a time with carry-less multiplication, then
+// a Barrett reduction. See Intel's "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ Instruction". |length| must be at least
+// kCrc32FoldMinLength and a multiple of 16.
+__attribute__((target("sse4.2,pclmul"))) uint32_t Crc32Pclmul(
+    uint32_t crc, const uint8_t* data, size_t length) {
+  alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+  alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+  alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+  alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+  __m128i x1 = _mm_xor_si128(Load128(data), _mm_cvtsi32_si128(crc));
+  __m128i x2 = Load128(data + 16);
+  __m128i x3 = Load128(data + 32);
+  __m128i x4 = Load128(data + 48);
+  data += 64;
+  length -= 64;
+
+  __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+  while (length >= 64) {
+    x1 = Fold128(x1, k, Load128(data));
+    x2 = Fold128(x2, k, Load128(data + 16));
+    x3 = Fold128(x3, k, Load128(data + 32));
+    x4 = Fold128(x4, k, Load128(data + 48));
+    data += 64;
+    length -= 64;
+  }
+
+  // Fold the four lanes into one, then any remaining 16-byte blocks.
+  k = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+  x1 = Fold128(x1, k, x2);
+  x1 = Fold128(x1, k, x3);
+  x1 = Fold128(x1, k, x4);
+  while (length >= 16) {
+    x1 = Fold128(x1, k, Load128(data));
+    data += 16;
+    length -= 16;
+  }
+
+  // Fold 128 bits down to 64.
+  __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+  x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits.
+  k = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x10);
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), k, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  return _mm_extract_epi32(x1, 1);
+}
+
+__attribute__((target("sse4.2"))) uint32_t Crc32cHardware(
+    uint32_t crc, const uint8_t* data, size_t length) {
+  uint64_t crc64 = crc;
+  while (length >= 8) {
+    crc64 = _mm_crc32_u64(crc64, LoadLE<uint64_t>(data));
+    data += 8;
+    length -= 8;
+  }
+  crc = static_cast<uint32_t>(crc64);
+  while (length-- > 0) crc = _mm_crc32_u8(crc, *data++);
+  return crc;
+}
+
+#elif NODE_CHECKSUM_ARM64
+
+bool HasCrc32Instructions() {
+#if defined(__APPLE__)
+  return true;
+#else
+  static const bool result = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+  return result;
+#endif
+}
+
+#if defined(__clang__)
+#define NODE_TARGET_CRC __attribute__((target("crc")))
+#else
+#define NODE_TARGET_CRC __attribute__((target("+crc")))
+#endif
+
+NODE_TARGET_CRC uint32_t Crc32cHardware(uint32_t crc,
+                                        const uint8_t* data,
+                                        size_t length) {
+  while (length >= 8) {
+    crc = __crc32cd(crc, LoadLE<uint64_t>(data));
+    data += 8;
+    length -= 8;
+  }
+  while (length-- > 0) crc = __crc32cb(crc, *data++);
+  return crc;
+}
+
+#undef NODE_TARGET_CRC
+
+#endif  // NODE_CHECKSUM_ARM64
+
+constexpr uint64_t kXXPrime1 = 0x9e3779b185ebca87;
+constexpr uint64_t kXXPrime2 = 0xc2b2ae3d27d4eb4f;
+constexpr uint64_t kXXPrime3 = 0x165667b19e3779f9;
+constexpr uint64_t kXXPrime4 = 0x85ebca77c2b2ae63;
+constexpr uint64_t kXXPrime5 = 0x27d4eb2f165667c5;
+
+inline uint64_t XXRound(uint64_t accumulator, uint64_t input) {
+  accumulator += input * kXXPrime2;
+  return std::rotl(accumulator, 31) * kXXPrime1;
+}
+
+inline uint64_t XXMerge(uint64_t hash, uint64_t accumulator) {
+  hash ^= XXRound(0, accumulator);
+  return hash * kXXPrime1 + kXXPrime4;
+}
+
+// Consumes as many whole 32-byte stripes of |data| as possible and returns
+// the number of bytes consumed.
+size_t XXConsumeStripes(uint64_t accumulators[4],
+                        const uint8_t* data,
+                        size_t length) {
+  size_t offset = 0;
+  for (; offset + 32 <= length; offset += 32) {
+    accumulators[0] =
+        XXRound(accumulators[0], LoadLE<uint64_t>(data + offset));
+    accumulators[1] =
+        XXRound(accumulators[1], LoadLE<uint64_t>(data + offset + 8));
+    accumulators[2] =
+        XXRound(accumulators[2], LoadLE<uint64_t>(data + offset + 16));
+    accumulators[3] =
+        XXRound(accumulators[3], LoadLE<uint64_t>(data + offset + 24));
+  }
+  return offset;
+}
+
+void XXInitAccumulators(uint64_t accumulators[4], uint64_t seed) {
+  accumulators[0] = seed + kXXPrime1 + kXXPrime2;
+  accumulators[1] = seed + kXXPrime2;
+  accumulators[2] = seed;
+  accumulators[3] = seed - kXXPrime1;
+}
+
+// Mixes the tail (fewer than 32 bytes) into |hash| and finalizes it.
+uint64_t XXFinalize(uint64_t hash, const uint8_t* data, size_t length) {
+  while (length >= 8) {
+    hash ^= XXRound(0, LoadLE<uint64_t>(data));
+    hash = std::rotl(hash, 27) * kXXPrime1 + kXXPrime4;
+    data += 8;
+    length -= 8;
+  }
+  if (length >= 4) {
+    hash ^= static_cast<uint64_t>(LoadLE<uint32_t>(data)) * kXXPrime1;
+    hash = std::rotl(hash, 23) * kXXPrime2 + kXXPrime3;
+    data += 4;
+    length -= 4;
+  }
+  while (length-- > 0) {
+    hash ^= *data++ * kXXPrime5;
+    hash = std::rotl(hash, 11) * kXXPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kXXPrime2;
+  hash ^= hash >> 29;
+  hash *= kXXPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+uint64_t XXConverge(const uint64_t accumulators[4]) {
+  uint64_t hash = std::rotl(accumulators[0], 1) +
+                  std::rotl(accumulators[1], 7) +
+                  std::rotl(accumulators[2], 12) +
+                  std::rotl(accumulators[3], 18);
+  for (int i = 0; i < 4; i++) hash = XXMerge(hash, accumulators[i]);
+  return hash;
+}
+
+}  // anonymous namespace
+
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t length) {
+#if NODE_CHECKSUM_X64
+  // The PCLMULQDQ kernel bundled with zlib is disabled in our build (see
+  // deps/zlib/zlib.gyp), so fold the bulk of larger inputs here and leave
+  // the tail to zlib, which also handles ARM's CRC instructions.
+  if (length >= kCrc32FoldMinLength && HasPclmul()) {
+    size_t bulk = length & ~static_cast<size_t>(15);
+    crc = ~Crc32Pclmul(~crc, data, bulk);
+    data += bulk;
+    length -= bulk;
+  }
+#endif
+  // zlib takes a size_t-sized length only through crc32_z().
+  return crc32_z(crc, data, length);
+}
+
+uint32_t Crc32c(uint32_t crc, const uint8_t* data, size_t length) {
+  crc = ~crc;
+#if NODE_CHECKSUM_X64
+  if (HasSse42()) return ~Crc32cHardware(crc, data, length);
+#elif NODE_CHECKSUM_ARM64
+  if (HasCrc32Instructions()) return ~Crc32cHardware(crc, data, length);
+#endif
+  return ~Crc32cPortable(crc, data, length);
+}
+
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t length) {
+  return adler32_z(adler, data, length);
+}
+
+uint64_t XXHash64(uint64_t seed, const uint8_t* data, size_t length) {
+  uint64_t hash;
+  size_t consumed = 0;
+  if (length >= 32) {
+    uint64_t accumulators[4];
+    XXInitAccumulators(accumulators, seed);
+    consumed = XXConsumeStripes(accumulators, data, length);
+    hash = XXConverge(accumulators);
+  } else {
+    hash = seed + kXXPrime5;
+  }
+  hash += length;
+  return XXFinalize(hash, data + consumed, length - consumed);
+}
+
+XXHash64State::XXHash64State(uint64_t seed) : seed_(seed) {
+  XXInitAccumulators(accumulators_, seed);
+}
+
+void XXHash64State::Update(const uint8_t* data, size_t length) {
+  total_length_ += length;
+
+  if (buffered_ > 0) {
+    size_t take = std::min(length, kStripeLength - buffered_);
+    memcpy(buffer_ + buffered_, data, take);
+    buffered_ += take;
+    data += take;
+    length -= take;
+    if (buffered_ < kStripeLength) return;
+    XXConsumeStripes(accumulators_, buffer_, kStripeLength);
+    buffered_ = 0;
+  }
+
+  size_t consumed = XXConsumeStripes(accumulators_, data, length);
+  buffered_ = length - consumed;
+  memcpy(buffer_, data + consumed, buffered_);
+}
+
+uint64_t XXHash64State::Digest() const {
+  uint64_t hash = total_length_ >= kStripeLength ? XXConverge(accumulators_)
+                                                 : seed_ + kXXPrime5;
+  hash += total_length_;
+  return XXFinalize(hash, buffer_, buffered_);
+}
+
+}  // namespace checksum
+}  // namespace node
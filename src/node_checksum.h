@@ -0,0 +1,49 @@
+#ifndef SRC_NODE_CHECKSUM_H_
+#define SRC_NODE_CHECKSUM_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace node {
+namespace checksum {
+
+// The CRC and Adler functions follow zlib's conventions: they take the value
+// returned for the previous chunk of a stream, so large inputs can be
+// checksummed incrementally. A new stream starts from 0 for the CRCs and
+// from 1 for Adler-32.
+
+// CRC-32 with the ISO-HDLC polynomial, as used by gzip, zip and PNG.
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t length);
+// CRC-32C with the Castagnoli polynomial, as used by iSCSI, ext4 and SCTP.
+uint32_t Crc32c(uint32_t crc, const uint8_t* data, size_t length);
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t length);
+
+uint64_t XXHash64(uint64_t seed, const uint8_t* data, size_t length);
+
+// Incremental XXH64. Feeding the input through any number of Update() calls
+// produces the same digest as a single XXHash64() call over all of it.
+class XXHash64State {
+ public:
+  explicit XXHash64State(uint64_t seed = 0);
+
+  void Update(const uint8_t* data, size_t length);
+  uint64_t Digest() const;
+
+ private:
+  static constexpr size_t kStripeLength = 32;
+
+  uint64_t seed_;
+  uint64_t total_length_ = 0;
+  uint64_t accumulators_[4];
+  uint8_t buffer_[kStripeLength];
+  size_t buffered_ = 0;
+};
+
+}  // namespace checksum
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CHECKSUM_H_
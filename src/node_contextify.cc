@@ -22,12 +22,14 @@
 #include "node_contextify.h"
 
 #include "base_object-inl.h"
+#include "cppgc/allocation.h"
 #include "memory_tracker-inl.h"
 #include "module_wrap.h"
 #include "node_context_data.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_module_pack.h"
 #include "node_process.h"
 #include "node_sea.h"
 #include "node_snapshot_builder.h"
@@ -116,8 +118,13 @@ Local<Name> Uint32ToName(Local<Context> context, uint32_t index) {
 BaseObjectPtr<ContextifyContext> ContextifyContext::New(
     Environment* env, Local<Object> sandbox_obj, ContextOptions* options) {
   HandleScope scope(env->isolate());
-  Local<ObjectTemplate> object_template = env->contextify_global_template();
-  DCHECK(!object_template.IsEmpty());
+  // Without a sandbox, the global object is used as it is, so it does not
+  // need the interceptors.
+  Local<ObjectTemplate> object_template;
+  if (!sandbox_obj.IsEmpty()) {
+    object_template = env->contextify_global_template();
+    DCHECK(!object_template.IsEmpty());
+  }
   const SnapshotData* snapshot_data = env->isolate_data()->snapshot_data();
 
   MicrotaskQueue* queue =
@@ -225,7 +232,9 @@ MaybeLocal<Context> ContextifyContext::CreateV8Context(
     }
   } else if (!Context::FromSnapshot(
                   isolate,
-                  SnapshotData::kNodeVMContextIndex,
+                  object_template.IsEmpty()
+                      ? SnapshotData::kNodeVMVanillaContextIndex
+                      : SnapshotData::kNodeVMContextIndex,
                   v8::DeserializeInternalFieldsCallback(),  // deserialization
                                                             // callback
                   nullptr,                                  // extensions
@@ -255,6 +264,10 @@ BaseObjectPtr<ContextifyContext> ContextifyContext::New(
   Local<Context> main_context = env->context();
   Local<Object> new_context_global = v8_context->Global();
   v8_context->SetSecurityToken(main_context->GetSecurityToken());
+  const bool vanilla = sandbox_obj.IsEmpty();
+  if (vanilla) {
+    sandbox_obj = new_context_global;
+  }
 
   // We need to tie the lifetime of the sandbox object with the lifetime of
   // newly created context. We do this by making them hold references to each
@@ -286,7 +299,8 @@ BaseObjectPtr<ContextifyContext> ContextifyContext::New(
   {
     Context::Scope context_scope(v8_context);
     Local<String> ctor_name = sandbox_obj->GetConstructorName();
-    if (!ctor_name->Equals(v8_context, env->object_string()).FromMaybe(false) &&
+    if (!vanilla &&
+        !ctor_name->Equals(v8_context, env->object_string()).FromMaybe(false) &&
         new_context_global
             ->DefineOwnProperty(
                 v8_context,
@@ -367,19 +381,27 @@ void ContextifyContext::RegisterExternalReferences(
   registry->Register(IndexedPropertyDefinerCallback);
 }
 
-// makeContext(sandbox, name, origin, strings, wasm);
+// makeContext(sandbox, name, origin, strings, wasm, microtaskQueue,
+//             hostDefinedOptionId);
+// If the sandbox is a symbol instead of an object, the context is not
+// contextified: its global object is an ordinary one, without the
+// interceptors that forward property accesses to a sandbox, and it is
+// returned for JS to use in place of the sandbox.
 void ContextifyContext::MakeContext(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   CHECK_EQ(args.Length(), 7);
-  CHECK(args[0]->IsObject());
-  Local<Object> sandbox = args[0].As<Object>();
+  Local<Object> sandbox;
+  if (!args[0]->IsSymbol()) {
+    CHECK(args[0]->IsObject());
+    sandbox = args[0].As<Object>();
 
-  // Don't allow contextifying a sandbox multiple times.
-  CHECK(
-      !sandbox->HasPrivate(
-          env->context(),
-          env->contextify_context_private_symbol()).FromJust());
+    // Don't allow contextifying a sandbox multiple times.
+    CHECK(!sandbox
+               ->HasPrivate(env->context(),
+                            env->contextify_context_private_symbol())
+               .FromJust());
+  }
 
   ContextOptions options;
 
@@ -414,6 +436,10 @@ void ContextifyContext::MakeContext(const FunctionCallbackInfo<Value>& args) {
       try_catch.ReThrow();
     return;
   }
+
+  if (sandbox.IsEmpty() && context_ptr) {
+    args.GetReturnValue().Set(context_ptr->global_proxy());
+  }
 }
 
 void ContextifyContext::WeakCallback(
@@ -812,6 +838,18 @@ void ContextifyScript::RegisterExternalReferences(
   registry->Register(RunInContext);
 }
 
+namespace {
+
+template <typename T>
+bool SameValue(Isolate* isolate, const v8::Global<T>& global, Local<T> local) {
+  if (global.IsEmpty() || local.IsEmpty()) {
+    return global.IsEmpty() && local.IsEmpty();
+  }
+  return global.Get(isolate)->StrictEquals(local);
+}
+
+}  // anonymous namespace
+
 void ContextifyScript::New(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   Isolate* isolate = env->isolate();
@@ -862,8 +900,10 @@ void ContextifyScript::New(const FunctionCallbackInfo<Value>& args) {
     id_symbol = args[7].As<Symbol>();
   }
 
-  ContextifyScript* contextify_script =
-      new ContextifyScript(env, args.This());
+  ContextifyScript* contextify_script = cppgc::MakeGarbageCollected<
+      ContextifyScript>(isolate->GetCppHeap()->GetAllocationHandle(),
+                        env,
+                        args.This());
 
   if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(
           TRACING_CATEGORY_NODE2(vm, script)) != 0) {
@@ -896,6 +936,28 @@ void ContextifyScript::New(const FunctionCallbackInfo<Value>& args) {
                       false,           // is WASM
                       false,           // is ES Module
                       host_defined_options);
+  // Unless the caller manages the code cache itself, try the scripts
+  // compiled before in this environment, and then the compile cache.
+  ScriptCache* script_cache = env->script_cache();
+  Local<UnboundScript> v8_script;
+  bool from_script_cache =
+      cached_data == nullptr &&
+      script_cache
+          ->Get(isolate, code, filename, line_offset, column_offset, id_symbol)
+          .ToLocal(&v8_script);
+  CompileCacheEntry* cache_entry = nullptr;
+  if (!from_script_cache && cached_data == nullptr &&
+      env->use_compile_cache() &&
+      IsPersistentScriptFilename(
+          Utf8Value(isolate, filename).ToStringView())) {
+    cache_entry = env->compile_cache_handler()->GetOrInsert(
+        code, filename, CachedCodeType::kScript);
+    if (cache_entry->cache != nullptr) {
+      // source will take ownership of cached_data.
+      cached_data = cache_entry->CopyCache();
+    }
+  }
+
   ScriptCompiler::Source source(code, origin, cached_data);
   ScriptCompiler::CompileOptions compile_options =
       ScriptCompiler::kNoCompileOptions;
@@ -907,22 +969,37 @@ void ContextifyScript::New(const FunctionCallbackInfo<Value>& args) {
   ShouldNotAbortOnUncaughtScope no_abort_scope(env);
   Context::Scope scope(parsing_context);
 
-  MaybeLocal<UnboundScript> maybe_v8_script =
-      ScriptCompiler::CompileUnboundScript(isolate, &source, compile_options);
+  if (!from_script_cache) {
+    MaybeLocal<UnboundScript> maybe_v8_script =
+        ScriptCompiler::CompileUnboundScript(isolate, &source, compile_options);
 
-  Local<UnboundScript> v8_script;
-  if (!maybe_v8_script.ToLocal(&v8_script)) {
-    errors::DecorateErrorStack(env, try_catch);
-    no_abort_scope.Close();
-    if (!try_catch.HasTerminated())
-      try_catch.ReThrow();
-    TRACE_EVENT_END0(TRACING_CATEGORY_NODE2(vm, script),
-                     "ContextifyScript::New");
-    return;
+    if (!maybe_v8_script.ToLocal(&v8_script)) {
+      errors::DecorateErrorStack(env, try_catch);
+      no_abort_scope.Close();
+      if (!try_catch.HasTerminated())
+        try_catch.ReThrow();
+      TRACE_EVENT_END0(TRACING_CATEGORY_NODE2(vm, script),
+                       "ContextifyScript::New");
+      return;
+    }
+
+    script_cache->Put(isolate,
+                      code,
+                      filename,
+                      line_offset,
+                      column_offset,
+                      id_symbol,
+                      v8_script);
+    if (cache_entry != nullptr) {
+      bool rejected = compile_options == ScriptCompiler::kConsumeCodeCache &&
+                      source.GetCachedData()->rejected;
+      env->compile_cache_handler()->MaybeSave(cache_entry, v8_script, rejected);
+      // Whether it was accepted is none of the caller's business.
+      compile_options = ScriptCompiler::kNoCompileOptions;
+    }
   }
 
   contextify_script->script_.Reset(isolate, v8_script);
-  contextify_script->script_.SetWeak();
   contextify_script->object()->SetInternalField(kUnboundScriptSlot, v8_script);
 
   std::unique_ptr<ScriptCompiler::CachedData> new_cached_data;
@@ -956,6 +1033,72 @@ void ContextifyScript::New(const FunctionCallbackInfo<Value>& args) {
   TRACE_EVENT_END0(TRACING_CATEGORY_NODE2(vm, script), "ContextifyScript::New");
 }
 
+MaybeLocal<UnboundScript> ScriptCache::Get(Isolate* isolate,
+                                           Local<String> code,
+                                           Local<String> filename,
+                                           int line_offset,
+                                           int column_offset,
+                                           Local<Symbol> id_symbol) {
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->code_length != code->Length() ||
+        it->line_offset != line_offset ||
+        it->column_offset != column_offset ||
+        !SameValue(isolate, it->id_symbol, id_symbol) ||
+        !SameValue(isolate, it->filename, filename) ||
+        !SameValue(isolate, it->code, code)) {
+      continue;
+    }
+    entries_.splice(entries_.begin(), entries_, it);
+    return entries_.front().script.Get(isolate);
+  }
+  return MaybeLocal<UnboundScript>();
+}
+
+void ScriptCache::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("entries", entries_.size() * sizeof(Entry));
+  for (const Entry& entry : entries_) {
+    tracker->TrackField("code", entry.code);
+    tracker->TrackField("filename", entry.filename);
+    tracker->TrackField("id_symbol", entry.id_symbol);
+    tracker->TrackField("script", entry.script);
+  }
+}
+
+bool IsPersistentScriptFilename(std::string_view filename) {
+  // Absolute paths and file: URLs, as used by the CommonJS loader and by
+  // most callers that pass a filename of their own.
+  if (filename.starts_with("/") || filename.starts_with("file://"))
+    return true;
+#ifdef _WIN32
+  if (filename.starts_with("\\\\")) return true;
+  if (filename.size() > 2 && filename[1] == ':' &&
+      (filename[2] == '\\' || filename[2] == '/')) {
+    return true;
+  }
+#endif
+  return false;
+}
+
+void ScriptCache::Put(Isolate* isolate,
+                      Local<String> code,
+                      Local<String> filename,
+                      int line_offset,
+                      int column_offset,
+                      Local<Symbol> id_symbol,
+                      Local<UnboundScript> script) {
+  if (entries_.size() == kMaxEntries) {
+    entries_.pop_back();
+  }
+  Entry& entry = entries_.emplace_front();
+  entry.code_length = code->Length();
+  entry.line_offset = line_offset;
+  entry.column_offset = column_offset;
+  entry.code.Reset(isolate, code);
+  entry.filename.Reset(isolate, filename);
+  entry.id_symbol.Reset(isolate, id_symbol);
+  entry.script.Reset(isolate, script);
+}
+
 Maybe<bool> StoreCodeCacheResult(
     Environment* env,
     Local<Object> target,
@@ -1026,9 +1169,9 @@ void ContextifyScript::CreateCachedData(
     const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   ContextifyScript* wrapped_script;
-  ASSIGN_OR_RETURN_UNWRAP(&wrapped_script, args.Holder());
+  ASSIGN_OR_RETURN_UNWRAP_CPPGC(&wrapped_script, args.Holder());
   Local<UnboundScript> unbound_script =
-      PersistentToLocal::Default(env->isolate(), wrapped_script->script_);
+      wrapped_script->script_.Get(env->isolate());
   std::unique_ptr<ScriptCompiler::CachedData> cached_data(
       ScriptCompiler::CreateCodeCache(unbound_script));
   if (!cached_data) {
@@ -1046,7 +1189,7 @@ void ContextifyScript::RunInContext(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
   ContextifyScript* wrapped_script;
-  ASSIGN_OR_RETURN_UNWRAP(&wrapped_script, args.Holder());
+  ASSIGN_OR_RETURN_UNWRAP_CPPGC(&wrapped_script, args.Holder());
 
   CHECK_EQ(args.Length(), 5);
   CHECK(args[0]->IsObject() || args[0]->IsNull());
@@ -1116,9 +1259,9 @@ bool ContextifyScript::EvalMachine(Local<Context> context,
 
   TryCatchScope try_catch(env);
   ContextifyScript* wrapped_script;
-  ASSIGN_OR_RETURN_UNWRAP(&wrapped_script, args.Holder(), false);
+  ASSIGN_OR_RETURN_UNWRAP_CPPGC(&wrapped_script, args.Holder(), false);
   Local<UnboundScript> unbound_script =
-      PersistentToLocal::Default(env->isolate(), wrapped_script->script_);
+      wrapped_script->script_.Get(env->isolate());
   Local<Script> script = unbound_script->BindToCurrentContext();
 
 #if HAVE_INSPECTOR
@@ -1186,12 +1329,14 @@ bool ContextifyScript::EvalMachine(Local<Context> context,
   return true;
 }
 
-ContextifyScript::ContextifyScript(Environment* env, Local<Object> object)
-    : BaseObject(env, object) {
-  MakeWeak();
+ContextifyScript::ContextifyScript(Environment* env, Local<Object> object) {
+  CppgcMixin::Wrap(this, env, object);
 }
 
-ContextifyScript::~ContextifyScript() {}
+void ContextifyScript::Trace(cppgc::Visitor* visitor) const {
+  CppgcMixin::Trace(visitor);
+  visitor->Trace(script_);
+}
 
 void ContextifyContext::CompileFunction(
     const FunctionCallbackInfo<Value>& args) {
@@ -1333,7 +1478,7 @@ void ContextifyContext::CompileFunction(
   args.GetReturnValue().Set(result);
 }
 
-static std::vector<Local<String>> GetCJSParameters(IsolateData* data) {
+std::vector<Local<String>> GetCJSParameters(IsolateData* data) {
   return {
       data->exports_string(),
       data->require_string(),
@@ -1477,8 +1622,12 @@ static MaybeLocal<Function> CompileFunctionForCJSLoader(Environment* env,
   }
 #endif
 
+  if (!used_cache_from_sea) {
+    cached_data = module_pack::GetCodeCache(isolate, filename);
+  }
+
   CompileCacheEntry* cache_entry = nullptr;
-  if (!used_cache_from_sea && env->use_compile_cache()) {
+  if (cached_data == nullptr && env->use_compile_cache()) {
     cache_entry = env->compile_cache_handler()->GetOrInsert(
         code, filename, CachedCodeType::kCommonJS);
   }
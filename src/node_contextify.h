@@ -3,7 +3,9 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <list>
 #include "base_object-inl.h"
+#include "cppgc_helpers.h"
 #include "node_context_data.h"
 #include "node_errors.h"
 
@@ -33,6 +35,7 @@ class ContextifyContext : public BaseObject {
   SET_MEMORY_INFO_NAME(ContextifyContext)
   SET_SELF_SIZE(ContextifyContext)
 
+  // Without an object_template, the context has an ordinary global object.
   static v8::MaybeLocal<v8::Context> CreateV8Context(
       v8::Isolate* isolate,
       v8::Local<v8::ObjectTemplate> object_template,
@@ -134,19 +137,21 @@ class ContextifyContext : public BaseObject {
   std::unique_ptr<v8::MicrotaskQueue> microtask_queue_;
 };
 
-class ContextifyScript : public BaseObject {
+// Scripts are created for every vm.Script and often in large numbers, so
+// they are managed by cppgc instead of being BaseObjects.
+class ContextifyScript final : public cppgc::GarbageCollected<ContextifyScript>,
+                               public cppgc::NameProvider,
+                               public CppgcMixin {
  public:
   enum InternalFields {
-    kUnboundScriptSlot = BaseObject::kInternalFieldCount,
+    kUnboundScriptSlot = CppgcMixin::kInternalFieldCount,
     kInternalFieldCount
   };
 
-  SET_NO_MEMORY_INFO()
-  SET_MEMORY_INFO_NAME(ContextifyScript)
-  SET_SELF_SIZE(ContextifyScript)
+  SET_CPPGC_NAME(ContextifyScript)
+  void Trace(cppgc::Visitor* visitor) const final;
 
   ContextifyScript(Environment* env, v8::Local<v8::Object> object);
-  ~ContextifyScript() override;
 
   static void CreatePerIsolateProperties(IsolateData* isolate_data,
                                          v8::Local<v8::ObjectTemplate> target);
@@ -165,9 +170,55 @@ class ContextifyScript : public BaseObject {
                           const v8::FunctionCallbackInfo<v8::Value>& args);
 
  private:
-  v8::Global<v8::UnboundScript> script_;
+  v8::TracedReference<v8::UnboundScript> script_;
 };
 
+// The scripts last compiled by vm.Script, so that the same code compiled
+// again, typically to be run in another context, reuses the UnboundScript
+// instead of being compiled once per context. A script is only reused for
+// the same code, origin and host-defined options, which is all that goes
+// into an UnboundScript.
+class ScriptCache : public MemoryRetainer {
+ public:
+  static constexpr size_t kMaxEntries = 128;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(ScriptCache)
+  SET_SELF_SIZE(ScriptCache)
+
+  v8::MaybeLocal<v8::UnboundScript> Get(v8::Isolate* isolate,
+                                        v8::Local<v8::String> code,
+                                        v8::Local<v8::String> filename,
+                                        int line_offset,
+                                        int column_offset,
+                                        v8::Local<v8::Symbol> id_symbol);
+  void Put(v8::Isolate* isolate,
+           v8::Local<v8::String> code,
+           v8::Local<v8::String> filename,
+           int line_offset,
+           int column_offset,
+           v8::Local<v8::Symbol> id_symbol,
+           v8::Local<v8::UnboundScript> script);
+
+ private:
+  struct Entry {
+    int code_length;
+    int line_offset;
+    int column_offset;
+    v8::Global<v8::String> code;
+    v8::Global<v8::String> filename;
+    v8::Global<v8::Symbol> id_symbol;
+    v8::Global<v8::UnboundScript> script;
+  };
+  // Most recently used first.
+  std::list<Entry> entries_;
+};
+
+// Whether scripts compiled under `filename` go into the compile cache. Only
+// those with a file of their own do. Those of the REPL, of eval and of vm
+// without a filename would only push each other out.
+bool IsPersistentScriptFilename(std::string_view filename);
+
 v8::Maybe<bool> StoreCodeCacheResult(
     Environment* env,
     v8::Local<v8::Object> target,
@@ -176,6 +227,9 @@ v8::Maybe<bool> StoreCodeCacheResult(
     bool produce_cached_data,
     std::unique_ptr<v8::ScriptCompiler::CachedData> new_cached_data);
 
+// The parameters of the function that CommonJS modules are compiled into.
+std::vector<v8::Local<v8::String>> GetCJSParameters(IsolateData* data);
+
 v8::MaybeLocal<v8::Function> CompileFunction(
     v8::Local<v8::Context> context,
     v8::Local<v8::String> filename,
@@ -0,0 +1,168 @@
+#include "node_coverage.h"
+#include "node_checksum.h"
+
+namespace node {
+namespace coverage {
+
+namespace {
+
+void AppendVarint(std::string* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendString(std::string* out, std::string_view value) {
+  AppendVarint(out, value.size());
+  out->append(value);
+}
+
+bool ReadVarint(std::string_view* in, uint64_t* value) {
+  *value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (in->empty()) return false;
+    uint8_t byte = static_cast<uint8_t>(in->front());
+    in->remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+bool ParseFunction(simdjson::ondemand::object function,
+                   FunctionCoverage* coverage) {
+  std::string_view name;
+  simdjson::ondemand::array ranges;
+  if (function["functionName"].get_string().get(name) ||
+      function["ranges"].get_array().get(ranges)) {
+    return false;
+  }
+  coverage->name = name;
+
+  for (auto range_value : ranges) {
+    simdjson::ondemand::object range;
+    RangeCoverage range_coverage;
+    if (range_value.get_object().get(range) ||
+        range["startOffset"].get_uint64().get(range_coverage.start) ||
+        range["endOffset"].get_uint64().get(range_coverage.end) ||
+        range["count"].get_uint64().get(range_coverage.count)) {
+      return false;
+    }
+    coverage->ranges.push_back(range_coverage);
+  }
+
+  return !function["isBlockCoverage"].get_bool().get(
+      coverage->is_block_coverage);
+}
+
+}  // anonymous namespace
+
+bool IsUserScript(std::string_view url) {
+  return !url.empty() && !url.starts_with("node:");
+}
+
+bool ParseCoverage(simdjson::ondemand::object* result,
+                   bool user_scripts_only,
+                   std::vector<ScriptCoverage>* scripts) {
+  simdjson::ondemand::array script_values;
+  if ((*result)["result"].get_array().get(script_values)) return false;
+
+  for (auto script_value : script_values) {
+    simdjson::ondemand::object script;
+    std::string_view url;
+    if (script_value.get_object().get(script) ||
+        script["url"].get_string().get(url)) {
+      return false;
+    }
+    if (user_scripts_only && !IsUserScript(url)) continue;
+
+    ScriptCoverage coverage;
+    coverage.url = url;
+
+    simdjson::ondemand::array functions;
+    if (script["functions"].get_array().get(functions)) return false;
+    bool executed = false;
+    for (auto function_value : functions) {
+      simdjson::ondemand::object function;
+      FunctionCoverage& function_coverage = coverage.functions.emplace_back();
+      if (function_value.get_object().get(function) ||
+          !ParseFunction(function, &function_coverage)) {
+        return false;
+      }
+      for (const RangeCoverage& range : function_coverage.ranges) {
+        executed = executed || range.count != 0;
+      }
+    }
+    if (!executed) continue;
+
+    // Only the URL identifies the script, as the ranges that V8 reports
+    // for it depend on how it ran.
+    coverage.hash = checksum::XXHash64(
+        0,
+        reinterpret_cast<const uint8_t*>(coverage.url.data()),
+        coverage.url.size());
+    scripts->push_back(std::move(coverage));
+  }
+  return true;
+}
+
+void AppendScriptRecord(const ScriptCoverage& script, std::string* out) {
+  AppendString(out, script.url);
+}
+
+void AppendCountsRecord(const ScriptCoverage& script, std::string* out) {
+  for (int i = 0; i < 8; i++) {
+    out->push_back(static_cast<char>(script.hash >> (i * 8)));
+  }
+  AppendVarint(out, script.functions.size());
+  for (const FunctionCoverage& function : script.functions) {
+    AppendString(out, function.name);
+    out->push_back(function.is_block_coverage ? 1 : 0);
+    AppendVarint(out, function.ranges.size());
+    for (const RangeCoverage& range : function.ranges) {
+      AppendVarint(out, range.start);
+      AppendVarint(out, range.end);
+      AppendVarint(out, range.count);
+    }
+  }
+}
+
+bool ReadCountsRecord(std::string_view* in, ScriptCoverage* script) {
+  if (in->size() < 8) return false;
+  script->hash = 0;
+  for (int i = 0; i < 8; i++) {
+    script->hash |= static_cast<uint64_t>(static_cast<uint8_t>((*in)[i]))
+                    << (i * 8);
+  }
+  in->remove_prefix(8);
+
+  uint64_t function_count;
+  // Every function takes up at least three bytes, and every range at least
+  // three more.
+  if (!ReadVarint(in, &function_count) || function_count > in->size() / 3) {
+    return false;
+  }
+  script->functions.resize(function_count);
+  for (FunctionCoverage& function : script->functions) {
+    uint64_t size;
+    if (!ReadVarint(in, &size) || size >= in->size()) return false;
+    function.name = in->substr(0, size);
+    function.is_block_coverage = (*in)[size] != 0;
+    in->remove_prefix(size + 1);
+
+    if (!ReadVarint(in, &size) || size > in->size() / 3) return false;
+    function.ranges.resize(size);
+    for (RangeCoverage& range : function.ranges) {
+      if (!ReadVarint(in, &range.start) || !ReadVarint(in, &range.end) ||
+          !ReadVarint(in, &range.count)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace coverage
+}  // namespace node
@@ -0,0 +1,89 @@
+#ifndef SRC_NODE_COVERAGE_H_
+#define SRC_NODE_COVERAGE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "simdjson.h"
+
+namespace node {
+namespace coverage {
+
+// A compact alternative to the JSON that NODE_V8_COVERAGE writes, selected
+// with NODE_V8_COVERAGE_FORMAT=binary. The URL of a script is written once
+// per coverage directory, to script-<hash>.nodecov, where the hash is that
+// of the URL, so processes that load the same script share it. Each process
+// then appends the coverage of the script, keyed by that hash, to its own
+// coverage-<pid>-<timestamp>-<thread id>.nodecov on every
+// takePreciseCoverage. That record carries the offsets of its ranges along
+// with their counts: V8 merges a block range into its parent when their
+// counts are equal and leaves out functions that were never compiled, so
+// the ranges reported for a script are not the same from one run to the
+// next. As V8 resets the counts each time they are taken, a reader merges
+// any number of records and processes by adding up the counts of each range
+// of each hash, and a script without a record in a file was not run.
+//
+// Integers are unsigned LEB128 and strings are an integer with their length
+// followed by their UTF-8 bytes, except for the hash, which is 8 bytes in
+// little-endian order.
+//
+//   Script file: kScriptMagic and the url.
+//   Counts file: kCountsMagic, then any number of records, each being the
+//                hash, the function count, and for every function its
+//                name, a byte that is 1 for block coverage, the range
+//                count, and the start offset, end offset and count of
+//                every range.
+static constexpr std::string_view kScriptMagic{"NODECOVS\x02", 9};
+static constexpr std::string_view kCountsMagic{"NODECOVC\x02", 9};
+
+struct RangeCoverage {
+  uint64_t start;
+  uint64_t end;
+  uint64_t count;
+
+  bool operator==(const RangeCoverage&) const = default;
+};
+
+struct FunctionCoverage {
+  std::string name;
+  bool is_block_coverage;
+  std::vector<RangeCoverage> ranges;
+
+  bool operator==(const FunctionCoverage&) const = default;
+};
+
+struct ScriptCoverage {
+  uint64_t hash;
+  std::string url;
+  std::vector<FunctionCoverage> functions;
+};
+
+// Whether `url` is that of a script loaded by the user, as opposed to a
+// built-in module or code without a URL, such as that passed to eval().
+bool IsUserScript(std::string_view url);
+
+// Splits the `result` of Profiler.takePreciseCoverage into one entry per
+// script, leaving out scripts without any execution counts and, if
+// `user_scripts_only` is true, those that are not user scripts. Returns
+// false if the result does not have the expected shape.
+bool ParseCoverage(simdjson::ondemand::object* result,
+                   bool user_scripts_only,
+                   std::vector<ScriptCoverage>* scripts);
+
+// Appends the script file of `script`, without the magic, to `out`.
+void AppendScriptRecord(const ScriptCoverage& script, std::string* out);
+// Appends the counts record of `script` to `out`.
+void AppendCountsRecord(const ScriptCoverage& script, std::string* out);
+// Reads a counts record from the start of `in` into the hash and functions
+// of `script`, and removes it from there.
+bool ReadCountsRecord(std::string_view* in, ScriptCoverage* script);
+
+}  // namespace coverage
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_COVERAGE_H_
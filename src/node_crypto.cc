@@ -37,6 +37,7 @@ using v8::Value;
 namespace crypto {
 
 #define CRYPTO_NAMESPACE_LIST_BASE(V)                                          \
+  V(AEAD)                                                                      \
   V(AES)                                                                       \
   V(CipherBase)                                                                \
   V(DiffieHellman)                                                             \
@@ -48,6 +49,7 @@ namespace crypto {
   V(Keygen)                                                                    \
   V(Keys)                                                                      \
   V(NativeKeyObject)                                                           \
+  V(PBKDF2BatchJob)                                                            \
   V(PBKDF2Job)                                                                 \
   V(Random)                                                                    \
   V(RSAAlg)                                                                    \
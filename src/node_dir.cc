@@ -1,14 +1,18 @@
 #include "node_dir.h"
 #include "memory_tracker-inl.h"
+#include "node_errors.h"
 #include "node_external_reference.h"
 #include "node_file-inl.h"
+#include "node_internals.h"
 #include "node_process-inl.h"
+#include "path.h"
 #include "permission/permission.h"
 #include "util.h"
 
 #include "tracing/trace_event.h"
 
 #include "string_bytes.h"
+#include "threadpoolwork-inl.h"
 
 #include <fcntl.h>
 #include <sys/types.h>
@@ -17,8 +21,15 @@
 #include <cerrno>
 #include <climits>
 
+#include <algorithm>
 #include <memory>
 
+#ifdef __linux__
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace node {
 
 namespace fs_dir {
@@ -41,6 +52,8 @@ using v8::Null;
 using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
+using v8::Uint32;
+using v8::Undefined;
 using v8::Value;
 
 static const char* get_dir_func_name_by_type(uv_fs_type req_type) {
@@ -428,6 +441,700 @@ static void OpenDirSync(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(handle->object().As<Value>());
 }
 
+namespace {
+
+std::string JoinPath(const std::string& dir, const char* name) {
+  std::string path = dir;
+#ifdef _WIN32
+  if (!path.empty() && path.back() != '/' && path.back() != '\\')
+    path += '\\';
+#else
+  if (!path.empty() && path.back() != '/') path += '/';
+#endif
+  path += name;
+  return path;
+}
+
+int DirentTypeFromMode(uint64_t mode) {
+  switch (mode & S_IFMT) {
+    case S_IFREG:
+      return UV_DIRENT_FILE;
+    case S_IFDIR:
+      return UV_DIRENT_DIR;
+#ifdef S_IFLNK
+    case S_IFLNK:
+      return UV_DIRENT_LINK;
+#endif
+#ifdef S_IFIFO
+    case S_IFIFO:
+      return UV_DIRENT_FIFO;
+#endif
+#ifdef S_IFSOCK
+    case S_IFSOCK:
+      return UV_DIRENT_SOCKET;
+#endif
+    case S_IFCHR:
+      return UV_DIRENT_CHAR;
+#ifdef S_IFBLK
+    case S_IFBLK:
+      return UV_DIRENT_BLOCK;
+#endif
+    default:
+      return UV_DIRENT_UNKNOWN;
+  }
+}
+
+int LStat(const std::string& path, uv_stat_t* stat) {
+  uv_fs_t req;
+  int err = uv_fs_lstat(nullptr, &req, path.c_str(), nullptr);
+  if (err == 0) *stat = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  return err;
+}
+
+std::string DirName(const std::string& path) {
+  size_t end = path.size();
+  while (end > 1 && IsPathSeparator(path[end - 1])) end--;
+  while (end > 0 && !IsPathSeparator(path[end - 1])) end--;
+  // Keep the separator of the root.
+  while (end > 1 && IsPathSeparator(path[end - 1])) end--;
+  return end == 0 ? "." : path.substr(0, end);
+}
+
+bool IsAbsolutePath(const std::string& path) {
+#ifdef _WIN32
+  return (!path.empty() && IsPathSeparator(path[0])) ||
+         (path.size() > 2 && path[1] == ':' && IsPathSeparator(path[2]));
+#else
+  return !path.empty() && path[0] == '/';
+#endif
+}
+
+// Creates a directory for a copy of one with `mode`. Its owner must be able
+// to copy the contents in, regardless of `mode`, so the caller applies the
+// mode once the contents are in place if `*created` is set. An existing
+// directory is used as it is.
+int MakeDirectory(const std::string& path, uint64_t mode, bool* created) {
+  uv_fs_t req;
+  int err = uv_fs_mkdir(nullptr,
+                        &req,
+                        path.c_str(),
+                        static_cast<int>((mode & 0777) | 0700),
+                        nullptr);
+  uv_fs_req_cleanup(&req);
+  *created = err == 0;
+  if (err == UV_EEXIST) {
+    uv_stat_t stat;
+    if (LStat(path, &stat) == 0 &&
+        DirentTypeFromMode(stat.st_mode) == UV_DIRENT_DIR) {
+      return 0;
+    }
+  }
+  return err;
+}
+
+#ifdef __linux__
+// The record layout of getdents64(2), which glibc only exposes in recent
+// versions.
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  uint16_t d_reclen;
+  uint8_t d_type;
+  char d_name[1];
+};
+
+int DirentTypeFromDType(uint8_t d_type) {
+  switch (d_type) {
+    case DT_REG:
+      return UV_DIRENT_FILE;
+    case DT_DIR:
+      return UV_DIRENT_DIR;
+    case DT_LNK:
+      return UV_DIRENT_LINK;
+    case DT_FIFO:
+      return UV_DIRENT_FIFO;
+    case DT_SOCK:
+      return UV_DIRENT_SOCKET;
+    case DT_CHR:
+      return UV_DIRENT_CHAR;
+    case DT_BLK:
+      return UV_DIRENT_BLOCK;
+    default:
+      return UV_DIRENT_UNKNOWN;
+  }
+}
+#endif  // __linux__
+
+// Appends the entries of `dir` to `entries`. Entries are lstat()ed if their
+// type is not known otherwise, or if `with_stats` is set.
+int ReadDirectory(const std::string& dir,
+                  bool with_stats,
+                  std::vector<DirEntry>* entries) {
+  auto add_entry = [&](const char* name, int type) {
+    DirEntry entry{JoinPath(dir, name), type, {}};
+    if (with_stats || type == UV_DIRENT_UNKNOWN) {
+      int err = LStat(entry.path, &entry.stat);
+      // The entry was removed after it was read.
+      if (err == UV_ENOENT) return 0;
+      if (err != 0) return err;
+      entry.type = DirentTypeFromMode(entry.stat.st_mode);
+    }
+    entries->push_back(std::move(entry));
+    return 0;
+  };
+
+#ifdef __linux__
+  // getdents64() returns the entries together with their types, in buffers
+  // that are much larger than what readdir() fetches at a time.
+  int fd;
+  do {
+    fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  } while (fd == -1 && errno == EINTR);
+  if (fd == -1) return uv_translate_sys_error(errno);
+  auto close_fd = OnScopeLeave([fd]() { close(fd); });
+
+  alignas(LinuxDirent64) char buf[32 * 1024];
+  while (true) {
+    ssize_t nread = syscall(SYS_getdents64, fd, buf, sizeof(buf));
+    if (nread == -1 && errno == EINTR) continue;
+    if (nread == -1) return uv_translate_sys_error(errno);
+    if (nread == 0) return 0;
+    for (ssize_t offset = 0; offset < nread;) {
+      const LinuxDirent64* dirent =
+          reinterpret_cast<const LinuxDirent64*>(buf + offset);
+      offset += dirent->d_reclen;
+      const char* name = dirent->d_name;
+      if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+      int err = add_entry(name, DirentTypeFromDType(dirent->d_type));
+      if (err != 0) return err;
+    }
+  }
+#else
+  uv_fs_t req;
+  int err = uv_fs_scandir(nullptr, &req, dir.c_str(), 0, nullptr);
+  auto cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  if (err < 0) return err;
+  uv_dirent_t dirent;
+  while ((err = uv_fs_scandir_next(&req, &dirent)) != UV_EOF) {
+    if (err < 0) return err;
+    err = add_entry(dirent.name, dirent.type);
+    if (err != 0) return err;
+  }
+  return 0;
+#endif  // __linux__
+}
+
+}  // anonymous namespace
+
+template <typename Owner>
+class DirJob final : public ThreadPoolWork {
+ public:
+  DirJob(Owner* owner, const char* type)
+      : ThreadPoolWork(owner->env(), type, ThreadPoolWorkKind::kFs),
+        owner_(owner) {}
+
+  void DoThreadPoolWork() override { owner_->RunJob(); }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<DirJob> self(this);
+    owner_->AfterJob();
+  }
+
+ private:
+  // Keeps the owner alive while its jobs run.
+  BaseObjectPtr<Owner> owner_;
+};
+
+DirWalk::DirWalk(Environment* env, Local<Object> obj)
+    : AsyncWrap(env, obj, AsyncWrap::PROVIDER_DIRWALK) {
+  MakeWeak();
+}
+
+void DirWalk::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  new DirWalk(env, args.This());
+}
+
+void DirWalk::RunJob() {
+  std::vector<DirEntry> entries;
+  while (!stopped_ && entries.size() < kBatchSize) {
+    std::string dir;
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (pending_dirs_.empty() || error_ != 0) break;
+      dir = std::move(pending_dirs_.front());
+      pending_dirs_.pop_front();
+    }
+
+    size_t first = entries.size();
+    int err = ReadDirectory(dir, with_stats_, &entries);
+
+    Mutex::ScopedLock lock(mutex_);
+    if (err != 0) {
+      if (error_ == 0) {
+        error_ = err;
+        error_path_ = std::move(dir);
+      }
+      break;
+    }
+    // Symbolic links are not followed.
+    for (size_t i = first; i < entries.size(); i++) {
+      if (entries[i].type == UV_DIRENT_DIR)
+        pending_dirs_.push_back(entries[i].path);
+    }
+  }
+
+  Mutex::ScopedLock lock(mutex_);
+  entries_.insert(entries_.end(),
+                  std::make_move_iterator(entries.begin()),
+                  std::make_move_iterator(entries.end()));
+}
+
+void DirWalk::ScheduleWork() {
+  size_t pending;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    pending = error_ == 0 ? pending_dirs_.size() : 0;
+  }
+  if (stopped_) pending = 0;
+  // Jobs that are still running take directories from the queue, too.
+  while (running_ < concurrency_ && running_ < pending) {
+    running_++;
+    (new DirJob<DirWalk>(this, "walk"))->ScheduleWork();
+  }
+}
+
+void DirWalk::EmitEntries() {
+  std::vector<DirEntry> entries;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    entries.swap(entries_);
+  }
+  if (entries.empty() || stopped_) return;
+
+  Isolate* isolate = env()->isolate();
+  MaybeStackBuffer<Local<Value>, 64> values(entries.size() * 2);
+  for (size_t i = 0; i < entries.size(); i++) {
+    Local<Value> error;
+    if (!StringBytes::Encode(isolate,
+                             entries[i].path.data(),
+                             entries[i].path.size(),
+                             encoding_,
+                             &error)
+             .ToLocal(&values[i * 2])) {
+      // Only paths that are too long for a string end up here.
+      Mutex::ScopedLock lock(mutex_);
+      if (error_ == 0) {
+        error_ = UV_ENAMETOOLONG;
+        error_path_ = entries[i].path;
+      }
+      return;
+    }
+    values[i * 2 + 1] = Integer::New(isolate, entries[i].type);
+  }
+
+  Local<Value> argv[] = {Array::New(isolate, values.out(), values.length()),
+                         Undefined(isolate)};
+  if (with_stats_) {
+    constexpr size_t kFields =
+        static_cast<size_t>(fs::FsStatsOffset::kFsStatsFieldsNumber);
+    AliasedFloat64Array stats(isolate, entries.size() * kFields);
+    for (size_t i = 0; i < entries.size(); i++)
+      fs::FillStatsArray(&stats, &entries[i].stat, i * kFields);
+    argv[1] = stats.GetJSArray();
+  }
+  MakeCallback(env()->onentries_string(), arraysize(argv), argv);
+}
+
+void DirWalk::AfterJob() {
+  running_--;
+  Environment* env = this->env();
+  if (!env->can_call_into_js()) return;
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  EmitEntries();
+  ScheduleWork();
+  if (running_ > 0) return;
+
+  // Every directory has been read, or reading stopped early. The entries
+  // that the last job collected have been emitted above.
+  walking_ = false;
+  Local<Value> error = Undefined(env->isolate());
+  {
+    Mutex::ScopedLock lock(mutex_);
+    if (error_ != 0 && !stopped_) {
+      error = UVException(
+          env->isolate(), error_, "scandir", nullptr, error_path_.c_str());
+    }
+    pending_dirs_.clear();
+  }
+  MakeCallback(env->oncomplete_string(), 1, &error);
+}
+
+// walk.start(path, encoding, concurrency, withStats)
+void DirWalk::Start(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  DirWalk* walk;
+  ASSIGN_OR_RETURN_UNWRAP(&walk, args.This());
+  CHECK(!walk->walking_);
+
+  CHECK_GE(args.Length(), 4);
+  BufferValue path(isolate, args[0]);
+  CHECK_NOT_NULL(*path);
+  CHECK(args[2]->IsUint32());
+  // Only the root is checked, like for a recursive readdir().
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+
+  walk->encoding_ = ParseEncoding(isolate, args[1], UTF8);
+  walk->concurrency_ =
+      std::clamp(args[2].As<Uint32>()->Value(), 1u, kMaxConcurrency);
+  walk->with_stats_ = args[3]->IsTrue();
+  walk->walking_ = true;
+  walk->stopped_ = false;
+  walk->error_ = 0;
+  walk->error_path_.clear();
+  walk->pending_dirs_.emplace_back(path.ToStringView());
+  walk->ScheduleWork();
+}
+
+// Jobs that are running finish the directory they are reading, but nothing
+// is emitted anymore except for `oncomplete()`.
+void DirWalk::Stop(const FunctionCallbackInfo<Value>& args) {
+  DirWalk* walk;
+  ASSIGN_OR_RETURN_UNWRAP(&walk, args.This());
+  walk->stopped_ = true;
+}
+
+DirCopy::DirCopy(Environment* env, Local<Object> obj)
+    : AsyncWrap(env, obj, AsyncWrap::PROVIDER_DIRCOPY) {
+  MakeWeak();
+}
+
+void DirCopy::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  new DirCopy(env, args.This());
+}
+
+bool DirCopy::SetError(int err, const char* syscall, const std::string& path) {
+  Mutex::ScopedLock lock(mutex_);
+  if (error_ == 0) {
+    error_ = err;
+    error_syscall_ = syscall;
+    error_path_ = path;
+  }
+  return false;
+}
+
+bool DirCopy::CopyDirectory(const Task& task, std::vector<Task>* tasks) {
+  std::vector<DirEntry> entries;
+  int err = ReadDirectory(task.src, true, &entries);
+  if (err != 0) return SetError(err, "scandir", task.src);
+
+  const size_t prefix_length = JoinPath(task.src, "").size();
+  for (DirEntry& entry : entries) {
+    std::string dest =
+        JoinPath(task.dest, entry.path.c_str() + prefix_length);
+    if (entry.type == UV_DIRENT_DIR &&
+        !CreateDirectory(dest, entry.stat.st_mode)) {
+      return false;
+    }
+    tasks->push_back(Task{
+        std::move(entry.path), std::move(dest), entry.type, entry.stat, true});
+  }
+  return true;
+}
+
+bool DirCopy::CreateDirectory(const std::string& path, uint64_t mode) {
+  bool created;
+  int err = MakeDirectory(path, mode, &created);
+  if (err != 0) return SetError(err, "mkdir", path);
+  if (created) {
+    // What mkdir() would have made of the mode, had it been used as it is.
+    Mutex::ScopedLock lock(mutex_);
+    created_dirs_.emplace_back(path, static_cast<int>(mode & 07777 & ~umask_));
+  }
+  return true;
+}
+
+void DirCopy::SetDirectoryModes() {
+  // Children first, as their parent may end up without search permission.
+  std::vector<std::pair<std::string, int>> dirs;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    dirs.swap(created_dirs_);
+  }
+  std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) {
+    return a.first.size() > b.first.size();
+  });
+  for (const auto& [path, mode] : dirs) {
+    uv_fs_t req;
+    int err = uv_fs_chmod(nullptr, &req, path.c_str(), mode, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err != 0) {
+      SetError(err, "chmod", path);
+      return;
+    }
+  }
+}
+
+bool DirCopy::CopySymlink(const Task& task) {
+  uv_fs_t req;
+  int err = uv_fs_readlink(nullptr, &req, task.src.c_str(), nullptr);
+  if (err < 0) {
+    uv_fs_req_cleanup(&req);
+    return SetError(err, "readlink", task.src);
+  }
+  std::string target = static_cast<const char*>(req.ptr);
+  uv_fs_req_cleanup(&req);
+
+  // Like fs.cp(), a relative link is made to point to what the original
+  // points to, unless it is to be copied verbatim. The source is resolved
+  // already, so PathResolve() does not need the cwd of the Environment.
+  std::string resolved = target;
+  if (!IsAbsolutePath(target)) {
+    resolved = PathResolve(env(), {DirName(task.src), target});
+    if (!verbatim_symlinks_) target = resolved;
+  }
+
+  int symlink_flags = 0;
+#ifdef _WIN32
+  // Windows needs to know whether the link points to a directory.
+  uv_stat_t stat;
+  err = uv_fs_stat(nullptr, &req, resolved.c_str(), nullptr);
+  if (err == 0) stat = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  if (err == 0 && DirentTypeFromMode(stat.st_mode) == UV_DIRENT_DIR)
+    symlink_flags = UV_FS_SYMLINK_DIR;
+#endif
+
+  err = uv_fs_symlink(nullptr,
+                      &req,
+                      target.c_str(),
+                      task.dest.c_str(),
+                      symlink_flags,
+                      nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err == UV_EEXIST && !(flags_ & UV_FS_COPYFILE_EXCL)) {
+    err = uv_fs_unlink(nullptr, &req, task.dest.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err == 0) {
+      err = uv_fs_symlink(nullptr,
+                          &req,
+                          target.c_str(),
+                          task.dest.c_str(),
+                          symlink_flags,
+                          nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+  }
+  if (err < 0) return SetError(err, "symlink", task.dest);
+  return true;
+}
+
+bool DirCopy::RunTask(Task* task, std::vector<Task>* tasks, uint64_t* bytes) {
+  if (task->type == UV_DIRENT_UNKNOWN) {
+    int err = LStat(task->src, &task->stat);
+    if (err != 0) return SetError(err, "lstat", task->src);
+    task->type = DirentTypeFromMode(task->stat.st_mode);
+  }
+
+  switch (task->type) {
+    case UV_DIRENT_DIR:
+      if (!task->created && !CreateDirectory(task->dest, task->stat.st_mode))
+        return false;
+      return CopyDirectory(*task, tasks);
+    case UV_DIRENT_FILE: {
+      uv_fs_t req;
+      int err = uv_fs_copyfile(nullptr,
+                               &req,
+                               task->src.c_str(),
+                               task->dest.c_str(),
+                               flags_,
+                               nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err < 0) return SetError(err, "copyfile", task->src);
+      *bytes += task->stat.st_size;
+      return true;
+    }
+    case UV_DIRENT_LINK:
+      return CopySymlink(*task);
+    default:
+      // Like fs.cp(), which does not copy sockets, FIFOs or devices.
+      return SetError(UV_EINVAL, "copyfile", task->src);
+  }
+}
+
+void DirCopy::RunJob() {
+  if (setting_modes_) return SetDirectoryModes();
+
+  std::vector<std::string> copied;
+  uint64_t bytes = 0;
+  while (!stopped_ && copied.size() < kBatchSize) {
+    Task task;
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (pending_tasks_.empty() || error_ != 0) break;
+      task = std::move(pending_tasks_.front());
+      pending_tasks_.pop_front();
+    }
+
+    std::vector<Task> tasks;
+    if (!RunTask(&task, &tasks, &bytes)) break;
+    copied.push_back(std::move(task.src));
+
+    if (!tasks.empty()) {
+      Mutex::ScopedLock lock(mutex_);
+      for (Task& child : tasks) pending_tasks_.push_back(std::move(child));
+    }
+  }
+
+  Mutex::ScopedLock lock(mutex_);
+  copied_.insert(copied_.end(),
+                 std::make_move_iterator(copied.begin()),
+                 std::make_move_iterator(copied.end()));
+  copied_bytes_ += bytes;
+}
+
+void DirCopy::ScheduleWork() {
+  size_t pending;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    pending = error_ == 0 ? pending_tasks_.size() : 0;
+  }
+  if (stopped_) pending = 0;
+  while (running_ < concurrency_ && running_ < pending) {
+    running_++;
+    (new DirJob<DirCopy>(this, "cp"))->ScheduleWork();
+  }
+}
+
+void DirCopy::EmitProgress() {
+  std::vector<std::string> copied;
+  uint64_t bytes;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    copied.swap(copied_);
+    bytes = copied_bytes_;
+    copied_bytes_ = 0;
+  }
+  if (copied.empty() || stopped_) return;
+
+  Local<Value> argv[2];
+  if (!ToV8Value(env()->context(), copied).ToLocal(&argv[0])) return;
+  argv[1] = Number::New(env()->isolate(), static_cast<double>(bytes));
+  MakeCallback(env()->onprogress_string(), arraysize(argv), argv);
+}
+
+void DirCopy::AfterJob() {
+  running_--;
+  Environment* env = this->env();
+  if (!env->can_call_into_js()) return;
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  EmitProgress();
+  ScheduleWork();
+  if (running_ > 0) return;
+
+  // Once everything is copied, the directories that were created get their
+  // mode, in one more job.
+  if (!setting_modes_ && !stopped_) {
+    bool has_created_dirs;
+    {
+      Mutex::ScopedLock lock(mutex_);
+      has_created_dirs = error_ == 0 && !created_dirs_.empty();
+    }
+    if (has_created_dirs) {
+      setting_modes_ = true;
+      running_++;
+      (new DirJob<DirCopy>(this, "cp"))->ScheduleWork();
+      return;
+    }
+  }
+
+  copying_ = false;
+  setting_modes_ = false;
+  Local<Value> error = Undefined(env->isolate());
+  {
+    Mutex::ScopedLock lock(mutex_);
+    created_dirs_.clear();
+    if (error_ != 0 && !stopped_) {
+      error = UVException(
+          env->isolate(), error_, error_syscall_, nullptr, error_path_.c_str());
+    }
+    pending_tasks_.clear();
+  }
+  MakeCallback(env->oncomplete_string(), 1, &error);
+}
+
+// cp.start(src, dest, concurrency, mode, verbatimSymlinks)
+void DirCopy::Start(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  DirCopy* copy;
+  ASSIGN_OR_RETURN_UNWRAP(&copy, args.This());
+  CHECK(!copy->copying_);
+
+  CHECK_GE(args.Length(), 4);
+  BufferValue src(isolate, args[0]);
+  CHECK_NOT_NULL(*src);
+  BufferValue dest(isolate, args[1]);
+  CHECK_NOT_NULL(*dest);
+  CHECK(args[2]->IsUint32());
+  int flags;
+  if (!GetValidFileMode(env, args[3], UV_FS_COPYFILE).To(&flags)) return;
+  // The paths are expected to be resolved already, which makes a copy into
+  // the source tree easy to spot.
+  std::string src_prefix = JoinPath(std::string(src.ToStringView()), "");
+  if (src.ToStringView() == dest.ToStringView() ||
+      dest.ToStringView().substr(0, src_prefix.size()) == src_prefix) {
+    return THROW_ERR_INVALID_ARG_VALUE(
+        env, "Cannot copy %s to a subdirectory of itself", *src);
+  }
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, src.ToStringView());
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemWrite, dest.ToStringView());
+
+  copy->flags_ = flags;
+  copy->verbatim_symlinks_ = args[4]->IsTrue();
+#ifndef _WIN32
+  {
+    Mutex::ScopedLock lock(per_process::umask_mutex);
+    copy->umask_ = umask(0);
+    umask(copy->umask_);
+  }
+#endif
+  copy->concurrency_ =
+      std::clamp(args[2].As<Uint32>()->Value(), 1u, DirWalk::kMaxConcurrency);
+  copy->copying_ = true;
+  copy->stopped_ = false;
+  copy->error_ = 0;
+  copy->error_path_.clear();
+  copy->pending_tasks_.push_back(Task{std::string(src.ToStringView()),
+                                      std::string(dest.ToStringView()),
+                                      UV_DIRENT_UNKNOWN,
+                                      {},
+                                      false});
+  copy->ScheduleWork();
+}
+
+// Jobs that are running finish the task they are working on. Everything
+// that has been copied so far is left in place.
+void DirCopy::Stop(const FunctionCallbackInfo<Value>& args) {
+  DirCopy* copy;
+  ASSIGN_OR_RETURN_UNWRAP(&copy, args.This());
+  copy->stopped_ = true;
+}
+
 void CreatePerIsolateProperties(IsolateData* isolate_data,
                                 Local<ObjectTemplate> target) {
   Isolate* isolate = isolate_data->isolate();
@@ -444,6 +1151,22 @@ void CreatePerIsolateProperties(IsolateData* isolate_data,
   dirt->SetInternalFieldCount(DirHandle::kInternalFieldCount);
   SetConstructorFunction(isolate, target, "DirHandle", dir);
   isolate_data->set_dir_instance_template(dirt);
+
+  Local<FunctionTemplate> walk = NewFunctionTemplate(isolate, DirWalk::New);
+  walk->Inherit(AsyncWrap::GetConstructorTemplate(isolate_data));
+  SetProtoMethod(isolate, walk, "start", DirWalk::Start);
+  SetProtoMethod(isolate, walk, "stop", DirWalk::Stop);
+  walk->InstanceTemplate()->SetInternalFieldCount(
+      DirWalk::kInternalFieldCount);
+  SetConstructorFunction(isolate, target, "DirWalk", walk);
+
+  Local<FunctionTemplate> copy = NewFunctionTemplate(isolate, DirCopy::New);
+  copy->Inherit(AsyncWrap::GetConstructorTemplate(isolate_data));
+  SetProtoMethod(isolate, copy, "start", DirCopy::Start);
+  SetProtoMethod(isolate, copy, "stop", DirCopy::Stop);
+  copy->InstanceTemplate()->SetInternalFieldCount(
+      DirCopy::kInternalFieldCount);
+  SetConstructorFunction(isolate, target, "DirCopy", copy);
 }
 
 void CreatePerContextProperties(Local<Object> target,
@@ -457,6 +1180,12 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(DirHandle::New);
   registry->Register(DirHandle::Read);
   registry->Register(DirHandle::Close);
+  registry->Register(DirWalk::New);
+  registry->Register(DirWalk::Start);
+  registry->Register(DirWalk::Stop);
+  registry->Register(DirCopy::New);
+  registry->Register(DirCopy::Start);
+  registry->Register(DirCopy::Stop);
 }
 
 }  // namespace fs_dir
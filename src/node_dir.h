@@ -4,6 +4,13 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include "node_file.h"
+#include "node_mutex.h"
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace node {
 
@@ -43,6 +50,134 @@ class DirHandle : public AsyncWrap {
   bool closed_ = false;
 };
 
+struct DirEntry {
+  std::string path;
+  int type;  // UV_DIRENT_*
+  uv_stat_t stat;
+};
+
+// A threadpool job of a DirWalk or a DirCopy, see ScheduleWork() there.
+template <typename Owner>
+class DirJob;
+
+// Walks a directory tree on several threadpool threads. Every job reads
+// directories from a shared queue, until it has collected a batch of
+// entries, which are then passed to `onentries(entries, stats)` on the main
+// thread while the other jobs keep going. `entries` alternates paths and
+// UV_DIRENT_* types, like DirHandle::Read(). `oncomplete(err)` is called
+// once the whole tree has been read, after the first error, or after
+// stop().
+class DirWalk final : public AsyncWrap {
+ public:
+  static constexpr size_t kBatchSize = 1024;
+  static constexpr uint32_t kMaxConcurrency = 16;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Stop(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(DirWalk)
+  SET_SELF_SIZE(DirWalk)
+
+ private:
+  friend class DirJob<DirWalk>;
+
+  DirWalk(Environment* env, v8::Local<v8::Object> obj);
+
+  // Called on the threadpool.
+  void RunJob();
+
+  // Called on the main thread.
+  void AfterJob();
+  void ScheduleWork();
+  void EmitEntries();
+
+  enum encoding encoding_ = UTF8;
+  uint32_t concurrency_ = 1;
+  bool with_stats_ = false;
+  bool walking_ = false;
+  uint32_t running_ = 0;
+  std::atomic<bool> stopped_{false};
+
+  Mutex mutex_;
+  std::deque<std::string> pending_dirs_;
+  std::vector<DirEntry> entries_;
+  int error_ = 0;
+  std::string error_path_;
+};
+
+// Copies a file or a directory tree like a recursive fs.cp(), on several
+// threadpool threads. Files are copied with uv_fs_copyfile(), which clones
+// them with FICLONE or clonefile(), or uses copy_file_range(), where that is
+// possible. Symbolic links are copied as links. Every job creates all
+// subdirectories of a directory that it reads at once, and queues their
+// contents as separate tasks. Copied paths are passed to
+// `onprogress(paths, bytes)` in batches, and `oncomplete(err)` is called at
+// the end, like for DirWalk.
+class DirCopy final : public AsyncWrap {
+ public:
+  static constexpr size_t kBatchSize = 256;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Stop(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(DirCopy)
+  SET_SELF_SIZE(DirCopy)
+
+ private:
+  friend class DirJob<DirCopy>;
+
+  struct Task {
+    std::string src;
+    std::string dest;
+    int type;  // UV_DIRENT_*, or UV_DIRENT_UNKNOWN for the root
+    uv_stat_t stat;
+    // Directories are created by the task that reads their parent.
+    bool created;
+  };
+
+  DirCopy(Environment* env, v8::Local<v8::Object> obj);
+
+  // Called on the threadpool. The methods that return bool record the
+  // error and return false on failure.
+  void RunJob();
+  bool RunTask(Task* task, std::vector<Task>* tasks, uint64_t* bytes);
+  bool CopyDirectory(const Task& task, std::vector<Task>* tasks);
+  bool CopySymlink(const Task& task);
+  // Creates a directory, and remembers to apply `mode` to it at the end.
+  bool CreateDirectory(const std::string& path, uint64_t mode);
+  void SetDirectoryModes();
+  bool SetError(int err, const char* syscall, const std::string& path);
+
+  // Called on the main thread.
+  void AfterJob();
+  void ScheduleWork();
+  void EmitProgress();
+
+  int flags_ = 0;
+  bool verbatim_symlinks_ = false;
+  int umask_ = 0;
+  uint32_t concurrency_ = 1;
+  bool copying_ = false;
+  // Set for the last job, which applies the modes of the directories.
+  bool setting_modes_ = false;
+  uint32_t running_ = 0;
+  std::atomic<bool> stopped_{false};
+
+  Mutex mutex_;
+  std::deque<Task> pending_tasks_;
+  // The directories that were created, and their final mode.
+  std::vector<std::pair<std::string, int>> created_dirs_;
+  std::vector<std::string> copied_;
+  uint64_t copied_bytes_ = 0;
+  int error_ = 0;
+  const char* error_syscall_ = nullptr;
+  std::string error_path_;
+};
+
 }  // namespace fs_dir
 
 }  // namespace node
@@ -6,6 +6,7 @@
 
 namespace node {
 
+using v8::Isolate;
 using v8::Local;
 using v8::NewStringType;
 using v8::Object;
@@ -44,10 +45,7 @@ std::vector<std::string> Dotenv::GetPathFromArgs(
 void Dotenv::SetEnvironment(node::Environment* env) {
   auto isolate = env->isolate();
 
-  for (const auto& entry : store_) {
-    auto key = entry.first;
-    auto value = entry.second;
-
+  for (const auto& [key, value] : store_) {
     auto existing = env->env_vars()->Get(key.data());
 
     if (existing.IsNothing()) {
@@ -63,13 +61,28 @@ void Dotenv::SetEnvironment(node::Environment* env) {
   }
 }
 
+void Dotenv::LayerOverEnvironment(Environment* env) {
+  // The time zone is picked up from the real environment, and libuv has to
+  // be told about changes to it, which Set() takes care of.
+  auto tz = store_.find("TZ");
+  if (tz != store_.end() && env->env_vars()->Get("TZ").IsNothing()) {
+    Isolate* isolate = env->isolate();
+    env->env_vars()->Set(isolate,
+                         FIXED_ONE_BYTE_STRING(isolate, "TZ"),
+                         ToV8Value(env->context(), tz->second, isolate)
+                             .ToLocalChecked()
+                             .As<String>());
+  }
+  env->set_env_vars(KVStore::CreateLayeredKVStore(
+      env->env_vars(),
+      std::unordered_map<std::string, std::string>(store_.begin(),
+                                                   store_.end())));
+}
+
 Local<Object> Dotenv::ToObject(Environment* env) const {
   Local<Object> result = Object::New(env->isolate());
 
-  for (const auto& entry : store_) {
-    auto key = entry.first;
-    auto value = entry.second;
-
+  for (const auto& [key, value] : store_) {
     result
         ->Set(
             env->context(),
@@ -99,12 +112,23 @@ std::string_view trim_spaces(std::string_view input) {
 }
 
 void Dotenv::ParseContent(const std::string_view input) {
+  // Most files do not have any "\r", and can be parsed in place.
+  if (input.find('\r') == std::string_view::npos) {
+    return ParseLines(input);
+  }
+
   std::string lines(input);
 
   // Handle windows newlines "\r\n": remove "\r" and keep only "\n"
   lines.erase(std::remove(lines.begin(), lines.end(), '\r'), lines.end());
 
-  std::string_view content = lines;
+  ParseLines(lines);
+}
+
+// The parser only ever copies the keys and values that it stores. The
+// searches for newlines and quotes go through std::string_view::find(),
+// i.e. memchr(), which the C library vectorizes.
+void Dotenv::ParseLines(std::string_view content) {
   content = trim_spaces(content);
 
   std::string_view key;
@@ -154,17 +178,23 @@ void Dotenv::ParseContent(const std::string_view input) {
       auto closing_quote = content.find(content.front(), 1);
       if (closing_quote != std::string_view::npos) {
         value = content.substr(1, closing_quote - 1);
-        std::string multi_line_value = std::string(value);
+        std::string multi_line_value;
+        multi_line_value.reserve(value.size());
 
         size_t pos = 0;
-        while ((pos = multi_line_value.find("\\n", pos)) !=
-               std::string_view::npos) {
-          multi_line_value.replace(pos, 2, "\n");
-          pos += 1;
+        size_t escape;
+        while ((escape = value.find("\\n", pos)) != std::string_view::npos) {
+          multi_line_value.append(value, pos, escape - pos);
+          multi_line_value += '\n';
+          pos = escape + 2;
         }
+        multi_line_value.append(value, pos);
 
-        store_.insert_or_assign(std::string(key), multi_line_value);
-        content.remove_prefix(content.find('\n', closing_quote + 1));
+        store_.insert_or_assign(std::string(key), std::move(multi_line_value));
+        auto newline = content.find('\n', closing_quote + 1);
+        // The value was on the last line.
+        if (newline == std::string_view::npos) break;
+        content.remove_prefix(newline);
         continue;
       }
     }
@@ -192,7 +222,9 @@ void Dotenv::ParseContent(const std::string_view input) {
         store_.insert_or_assign(std::string(key), value);
         // Select the first newline after the closing quotation mark
         // since there could be newline characters inside the value.
-        content.remove_prefix(content.find('\n', closing_quote + 1));
+        auto newline = content.find('\n', closing_quote + 1);
+        if (newline == std::string_view::npos) break;
+        content.remove_prefix(newline);
       }
     } else {
       // Regular key value pair.
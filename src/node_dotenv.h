@@ -25,12 +25,18 @@ class Dotenv {
   ParseResult ParsePath(const std::string_view path);
   void AssignNodeOptionsIfAvailable(std::string* node_options) const;
   void SetEnvironment(Environment* env);
+  // Like SetEnvironment(), but instead of writing the variables into the
+  // environment of the process, makes process.env fall back to them. They
+  // are not seen by native code that reads the environment directly.
+  void LayerOverEnvironment(Environment* env);
   v8::Local<v8::Object> ToObject(Environment* env) const;
 
   static std::vector<std::string> GetPathFromArgs(
       const std::vector<std::string>& args);
 
  private:
+  void ParseLines(std::string_view content);
+
   std::map<std::string, std::string> store_;
 };
 
@@ -4,6 +4,7 @@
 #include "node_external_reference.h"
 #include "node_i18n.h"
 #include "node_process-inl.h"
+#include "node_threadsafe_cow-inl.h"
 
 #include <time.h>  // tzset(), _tzset()
 
@@ -44,6 +45,25 @@ class RealEnvStore final : public KVStore {
   int32_t Query(const char* key) const override;
   void Delete(Isolate* isolate, Local<String> key) override;
   Local<Array> Enumerate(Isolate* isolate) const override;
+
+ private:
+  // With --experimental-process-env-cache, the environment is copied on
+  // first use, and reads are served from the copy instead of going through
+  // uv_os_getenv() and uv_os_environ() under per_process::env_var_mutex.
+  // The copy is kept up to date by Set() and Delete(), but changes that are
+  // made to the environment in other ways, e.g. by addons, are not seen.
+  struct Snapshot {
+    bool initialized = false;
+    // In the order of the environment, for Enumerate().
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::string> values;
+  };
+
+  // Returns false if the snapshot is not in use.
+  bool LoadSnapshot() const;
+
+  // Locked before per_process::env_var_mutex when both are needed.
+  mutable ThreadsafeCopyOnWrite<Snapshot> snapshot_;
 };
 
 class MapKVStore final : public KVStore {
@@ -66,6 +86,28 @@ class MapKVStore final : public KVStore {
   std::unordered_map<std::string, std::string> map_;
 };
 
+class LayeredKVStore final : public KVStore {
+ public:
+  MaybeLocal<String> Get(Isolate* isolate, Local<String> key) const override;
+  Maybe<std::string> Get(const char* key) const override;
+  void Set(Isolate* isolate, Local<String> key, Local<String> value) override;
+  int32_t Query(Isolate* isolate, Local<String> key) const override;
+  int32_t Query(const char* key) const override;
+  void Delete(Isolate* isolate, Local<String> key) override;
+  Local<Array> Enumerate(Isolate* isolate) const override;
+
+  LayeredKVStore(std::shared_ptr<KVStore> base,
+                 std::unordered_map<std::string, std::string> defaults)
+      : base_(std::move(base)), defaults_(std::move(defaults)) {}
+
+ private:
+  std::shared_ptr<KVStore> base_;
+  mutable Mutex mutex_;
+  // Keys are removed once they are set or deleted through this store, so
+  // that deleting a key does not uncover its default.
+  std::unordered_map<std::string, std::string> defaults_;
+};
+
 namespace per_process {
 Mutex env_var_mutex;
 std::shared_ptr<KVStore> system_environment = std::make_shared<RealEnvStore>();
@@ -101,7 +143,41 @@ void DateTimeConfigurationChangeNotification(
   }
 }
 
+bool RealEnvStore::LoadSnapshot() const {
+#ifdef _WIN32
+  // Variable names are case-insensitive on Windows.
+  return false;
+#else
+  if (!per_process::cli_options->experimental_process_env_cache) return false;
+  if (snapshot_.read()->initialized) return true;
+
+  auto snapshot = snapshot_.write();
+  if (snapshot->initialized) return true;
+  Mutex::ScopedLock lock(per_process::env_var_mutex);
+  uv_env_item_t* items;
+  int count;
+  CHECK_EQ(uv_os_environ(&items, &count), 0);
+  snapshot->names.reserve(count);
+  for (int i = 0; i < count; i++) {
+    // getenv() returns the first one of duplicate names.
+    auto [it, inserted] =
+        snapshot->values.emplace(items[i].name, items[i].value);
+    if (inserted) snapshot->names.push_back(it->first);
+  }
+  uv_os_free_environ(items, count);
+  snapshot->initialized = true;
+  return true;
+#endif  // _WIN32
+}
+
 Maybe<std::string> RealEnvStore::Get(const char* key) const {
+  if (LoadSnapshot()) {
+    auto snapshot = snapshot_.read();
+    auto it = snapshot->values.find(key);
+    if (it == snapshot->values.end()) return Nothing<std::string>();
+    return Just(it->second);
+  }
+
   Mutex::ScopedLock lock(per_process::env_var_mutex);
 
   size_t init_sz = 256;
@@ -139,19 +215,33 @@ MaybeLocal<String> RealEnvStore::Get(Isolate* isolate,
 void RealEnvStore::Set(Isolate* isolate,
                        Local<String> property,
                        Local<String> value) {
-  Mutex::ScopedLock lock(per_process::env_var_mutex);
-
   node::Utf8Value key(isolate, property);
   node::Utf8Value val(isolate, value);
 
 #ifdef _WIN32
   if (key.length() > 0 && key[0] == '=') return;
 #endif
-  uv_os_setenv(*key, *val);
+  if (LoadSnapshot()) {
+    auto snapshot = snapshot_.write();
+    Mutex::ScopedLock lock(per_process::env_var_mutex);
+    if (uv_os_setenv(*key, *val) == 0) {
+      auto [it, inserted] =
+          snapshot->values.insert_or_assign(key.ToString(), val.ToString());
+      if (inserted) snapshot->names.push_back(it->first);
+    }
+  } else {
+    Mutex::ScopedLock lock(per_process::env_var_mutex);
+    uv_os_setenv(*key, *val);
+  }
   DateTimeConfigurationChangeNotification(isolate, key, *val);
 }
 
 int32_t RealEnvStore::Query(const char* key) const {
+  if (LoadSnapshot()) {
+    auto snapshot = snapshot_.read();
+    return snapshot->values.contains(key) ? 0 : -1;
+  }
+
   Mutex::ScopedLock lock(per_process::env_var_mutex);
 
   char val[2];
@@ -179,14 +269,38 @@ int32_t RealEnvStore::Query(Isolate* isolate, Local<String> property) const {
 }
 
 void RealEnvStore::Delete(Isolate* isolate, Local<String> property) {
-  Mutex::ScopedLock lock(per_process::env_var_mutex);
-
   node::Utf8Value key(isolate, property);
-  uv_os_unsetenv(*key);
+  if (LoadSnapshot()) {
+    auto snapshot = snapshot_.write();
+    Mutex::ScopedLock lock(per_process::env_var_mutex);
+    if (uv_os_unsetenv(*key) == 0 && snapshot->values.erase(*key) != 0) {
+      auto& names = snapshot->names;
+      names.erase(std::find(names.begin(), names.end(), *key));
+    }
+  } else {
+    Mutex::ScopedLock lock(per_process::env_var_mutex);
+    uv_os_unsetenv(*key);
+  }
   DateTimeConfigurationChangeNotification(isolate, key);
 }
 
 Local<Array> RealEnvStore::Enumerate(Isolate* isolate) const {
+  if (LoadSnapshot()) {
+    auto snapshot = snapshot_.read();
+    MaybeStackBuffer<Local<Value>, 256> env_v(snapshot->names.size());
+    for (size_t i = 0; i < snapshot->names.size(); i++) {
+      const std::string& name = snapshot->names[i];
+      MaybeLocal<String> str = String::NewFromUtf8(
+          isolate, name.data(), NewStringType::kNormal, name.size());
+      if (str.IsEmpty()) {
+        isolate->ThrowException(ERR_STRING_TOO_LONG(isolate));
+        return Local<Array>();
+      }
+      env_v[i] = str.ToLocalChecked();
+    }
+    return Array::New(isolate, env_v.out(), snapshot->names.size());
+  }
+
   Mutex::ScopedLock lock(per_process::env_var_mutex);
   uv_env_item_t* items;
   int count;
@@ -291,6 +405,87 @@ std::shared_ptr<KVStore> KVStore::CreateMapKVStore() {
   return std::make_shared<MapKVStore>();
 }
 
+Maybe<std::string> LayeredKVStore::Get(const char* key) const {
+  Maybe<std::string> value = base_->Get(key);
+  if (value.IsJust()) return value;
+  Mutex::ScopedLock lock(mutex_);
+  auto it = defaults_.find(key);
+  return it == defaults_.end() ? Nothing<std::string>() : Just(it->second);
+}
+
+MaybeLocal<String> LayeredKVStore::Get(Isolate* isolate,
+                                       Local<String> key) const {
+  MaybeLocal<String> value = base_->Get(isolate, key);
+  if (!value.IsEmpty()) return value;
+  Utf8Value str(isolate, key);
+  Mutex::ScopedLock lock(mutex_);
+  auto it = defaults_.find(*str);
+  if (it == defaults_.end()) return Local<String>();
+  return String::NewFromUtf8(
+      isolate, it->second.data(), NewStringType::kNormal, it->second.size());
+}
+
+void LayeredKVStore::Set(Isolate* isolate,
+                         Local<String> key,
+                         Local<String> value) {
+  base_->Set(isolate, key, value);
+  Utf8Value str(isolate, key);
+  Mutex::ScopedLock lock(mutex_);
+  defaults_.erase(std::string(*str, str.length()));
+}
+
+int32_t LayeredKVStore::Query(const char* key) const {
+  int32_t attributes = base_->Query(key);
+  if (attributes != -1) return attributes;
+  Mutex::ScopedLock lock(mutex_);
+  return defaults_.find(key) == defaults_.end() ? -1 : 0;
+}
+
+int32_t LayeredKVStore::Query(Isolate* isolate, Local<String> key) const {
+  Utf8Value str(isolate, key);
+  return Query(*str);
+}
+
+void LayeredKVStore::Delete(Isolate* isolate, Local<String> key) {
+  base_->Delete(isolate, key);
+  Utf8Value str(isolate, key);
+  Mutex::ScopedLock lock(mutex_);
+  defaults_.erase(std::string(*str, str.length()));
+}
+
+Local<Array> LayeredKVStore::Enumerate(Isolate* isolate) const {
+  Local<Array> keys = base_->Enumerate(isolate);
+  if (keys.IsEmpty()) return keys;
+  Mutex::ScopedLock lock(mutex_);
+  if (defaults_.empty()) return keys;
+
+  Local<Context> context = isolate->GetCurrentContext();
+  const uint32_t keys_length = keys->Length();
+  std::vector<Local<Value>> values;
+  values.reserve(keys_length + defaults_.size());
+  for (uint32_t i = 0; i < keys_length; i++) {
+    values.push_back(keys->Get(context, i).ToLocalChecked());
+  }
+  for (const auto& [key, value] : defaults_) {
+    if (base_->Query(key.c_str()) != -1) continue;
+    Local<String> str;
+    if (!String::NewFromUtf8(
+             isolate, key.data(), NewStringType::kNormal, key.size())
+             .ToLocal(&str)) {
+      return Local<Array>();
+    }
+    values.push_back(str);
+  }
+  return Array::New(isolate, values.data(), values.size());
+}
+
+std::shared_ptr<KVStore> KVStore::CreateLayeredKVStore(
+    std::shared_ptr<KVStore> base,
+    std::unordered_map<std::string, std::string> defaults) {
+  return std::make_shared<LayeredKVStore>(std::move(base),
+                                          std::move(defaults));
+}
+
 Maybe<bool> KVStore::AssignFromObject(Local<Context> context,
                                       Local<Object> entries) {
   Isolate* isolate = context->GetIsolate();
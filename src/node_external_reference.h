@@ -17,6 +17,8 @@ using CFunctionCallbackReturnDouble =
     double (*)(v8::Local<v8::Object> receiver);
 using CFunctionCallbackValueReturnDouble =
     double (*)(v8::Local<v8::Value> receiver);
+using CFunctionCallbackValueReturnBool =
+    bool (*)(v8::Local<v8::Value> receiver, v8::Local<v8::Value> value);
 using CFunctionCallbackWithInt64 = void (*)(v8::Local<v8::Object> receiver,
                                             int64_t);
 using CFunctionCallbackWithBool = void (*)(v8::Local<v8::Object> receiver,
@@ -36,6 +38,26 @@ using CFunctionCallbackWithTwoUint8ArraysFallback =
              const v8::FastApiTypedArray<uint8_t>&,
              const v8::FastApiTypedArray<uint8_t>&,
              v8::FastApiCallbackOptions&);
+using CFunctionCallbackWithTwoUint8ArraysReturnBool =
+    bool (*)(v8::Local<v8::Value>,
+             const v8::FastApiTypedArray<uint8_t>&,
+             const v8::FastApiTypedArray<uint8_t>&);
+using CFunctionCallbackCompareOffset =
+    int32_t (*)(v8::Local<v8::Value>,
+                const v8::FastApiTypedArray<uint8_t>&,
+                const v8::FastApiTypedArray<uint8_t>&,
+                uint32_t,
+                uint32_t,
+                uint32_t,
+                uint32_t,
+                v8::FastApiCallbackOptions&);
+using CFunctionCallbackFill = void (*)(v8::Local<v8::Value>,
+                                       const v8::FastApiTypedArray<uint8_t>&,
+                                       uint32_t,
+                                       uint32_t,
+                                       uint32_t,
+                                       v8::Local<v8::Value>,
+                                       v8::FastApiCallbackOptions&);
 using CFunctionWithUint32 = uint32_t (*)(v8::Local<v8::Value>,
                                          const uint32_t input);
 using CFunctionWithDoubleReturnDouble = double (*)(v8::Local<v8::Value>,
@@ -44,6 +66,14 @@ using CFunctionWithInt64Fallback = void (*)(v8::Local<v8::Value>,
                                             const int64_t,
                                             v8::FastApiCallbackOptions&);
 using CFunctionWithBool = void (*)(v8::Local<v8::Value>, bool);
+using CFunctionWithOneByteStringUint8Array =
+    void (*)(v8::Local<v8::Object>,
+             const v8::FastOneByteString&,
+             const v8::FastApiTypedArray<uint8_t>&);
+using CFunctionWithUint8ArrayUint32ReturnUint32 =
+    uint32_t (*)(v8::Local<v8::Value>,
+                 const v8::FastApiTypedArray<uint8_t>&,
+                 uint32_t);
 
 // This class manages the external references from the V8 heap
 // to the C++ addresses in Node.js.
@@ -56,16 +86,22 @@ class ExternalReferenceRegistry {
   V(CFunctionCallbackWithOneByteString)                                        \
   V(CFunctionCallbackReturnDouble)                                             \
   V(CFunctionCallbackValueReturnDouble)                                        \
+  V(CFunctionCallbackValueReturnBool)                                          \
   V(CFunctionCallbackWithInt64)                                                \
   V(CFunctionCallbackWithBool)                                                 \
   V(CFunctionCallbackWithString)                                               \
   V(CFunctionCallbackWithStrings)                                              \
   V(CFunctionCallbackWithTwoUint8Arrays)                                       \
   V(CFunctionCallbackWithTwoUint8ArraysFallback)                               \
+  V(CFunctionCallbackWithTwoUint8ArraysReturnBool)                             \
+  V(CFunctionCallbackCompareOffset)                                            \
+  V(CFunctionCallbackFill)                                                     \
   V(CFunctionWithUint32)                                                       \
   V(CFunctionWithDoubleReturnDouble)                                           \
   V(CFunctionWithInt64Fallback)                                                \
   V(CFunctionWithBool)                                                         \
+  V(CFunctionWithOneByteStringUint8Array)                                      \
+  V(CFunctionWithUint8ArrayUint32ReturnUint32)                                 \
   V(const v8::CFunctionInfo*)                                                  \
   V(v8::FunctionCallback)                                                      \
   V(v8::AccessorNameGetterCallback)                                            \
@@ -103,6 +139,7 @@ class ExternalReferenceRegistry {
 };
 
 #define EXTERNAL_REFERENCE_BINDING_LIST_BASE(V)                                \
+  V(async_context_frame)                                                       \
   V(async_wrap)                                                                \
   V(binding)                                                                   \
   V(blob)                                                                      \
@@ -120,14 +157,19 @@ class ExternalReferenceRegistry {
   V(handle_wrap)                                                               \
   V(heap_utils)                                                                \
   V(internal_only_v8)                                                          \
+  V(log_sink)                                                                  \
   V(messaging)                                                                 \
+  V(metrics)                                                                   \
   V(mksnapshot)                                                                \
+  V(module_pack)                                                               \
   V(module_wrap)                                                               \
   V(modules)                                                                   \
   V(options)                                                                   \
   V(os)                                                                        \
+  V(path)                                                                      \
   V(performance)                                                               \
   V(permission)                                                                \
+  V(pprof)                                                                     \
   V(process_methods)                                                           \
   V(process_object)                                                            \
   V(process_wrap)                                                              \
@@ -141,6 +183,7 @@ class ExternalReferenceRegistry {
   V(pipe_wrap)                                                                 \
   V(sea)                                                                       \
   V(serdes)                                                                    \
+  V(shm_channel)                                                               \
   V(string_decoder)                                                            \
   V(stream_wrap)                                                               \
   V(signal_wrap)                                                               \
@@ -188,10 +188,12 @@ FSReqPromise<AliasedBufferT>::New(BindingData* binding_data,
     return nullptr;
   }
   v8::Local<v8::Promise::Resolver> resolver;
-  if (!v8::Promise::Resolver::New(env->context()).ToLocal(&resolver) ||
-      obj->Set(env->context(), env->promise_string(), resolver).IsNothing()) {
+  if (!v8::Promise::Resolver::New(env->context()).ToLocal(&resolver)) {
     return nullptr;
   }
+  // An internal field is cheaper to set and to look up again than a named
+  // property on every request.
+  obj->SetInternalField(kResolverField, resolver);
   return new FSReqPromise(binding_data, obj, use_bigint);
 }
 
@@ -208,24 +210,22 @@ FSReqPromise<AliasedBufferT>::FSReqPromise(BindingData* binding_data,
                                            v8::Local<v8::Object> obj,
                                            bool use_bigint)
     : FSReqBase(
-          binding_data, obj, AsyncWrap::PROVIDER_FSREQPROMISE, use_bigint),
-      stats_field_array_(
-          env()->isolate(),
-          static_cast<size_t>(FsStatsOffset::kFsStatsFieldsNumber)),
-      statfs_field_array_(
-          env()->isolate(),
-          static_cast<size_t>(FsStatFsOffset::kFsStatFsFieldsNumber)) {}
+          binding_data, obj, AsyncWrap::PROVIDER_FSREQPROMISE, use_bigint) {}
+
+template <typename AliasedBufferT>
+v8::Local<v8::Promise::Resolver> FSReqPromise<AliasedBufferT>::resolver() {
+  return object()
+      ->GetInternalField(kResolverField)
+      .template As<v8::Value>()
+      .template As<v8::Promise::Resolver>();
+}
 
 template <typename AliasedBufferT>
 void FSReqPromise<AliasedBufferT>::Reject(v8::Local<v8::Value> reject) {
   finished_ = true;
   v8::HandleScope scope(env()->isolate());
   InternalCallbackScope callback_scope(this);
-  v8::Local<v8::Value> value =
-      object()->Get(env()->context(),
-                    env()->promise_string()).ToLocalChecked();
-  v8::Local<v8::Promise::Resolver> resolver = value.As<v8::Promise::Resolver>();
-  USE(resolver->Reject(env()->context(), reject).FromJust());
+  USE(resolver()->Reject(env()->context(), reject).FromJust());
 }
 
 template <typename AliasedBufferT>
@@ -233,40 +233,46 @@ void FSReqPromise<AliasedBufferT>::Resolve(v8::Local<v8::Value> value) {
   finished_ = true;
   v8::HandleScope scope(env()->isolate());
   InternalCallbackScope callback_scope(this);
-  v8::Local<v8::Value> val =
-      object()->Get(env()->context(),
-                    env()->promise_string()).ToLocalChecked();
-  v8::Local<v8::Promise::Resolver> resolver = val.As<v8::Promise::Resolver>();
-  USE(resolver->Resolve(env()->context(), value).FromJust());
+  USE(resolver()->Resolve(env()->context(), value).FromJust());
 }
 
 template <typename AliasedBufferT>
 void FSReqPromise<AliasedBufferT>::ResolveStat(const uv_stat_t* stat) {
-  FillStatsArray(&stats_field_array_, stat);
-  Resolve(stats_field_array_.GetJSArray());
+  // Every request needs its own array, because JS reads it only once the
+  // promise continuation runs, which may be after other requests completed.
+  if (!stats_field_array_) {
+    stats_field_array_.emplace(
+        env()->isolate(),
+        static_cast<size_t>(FsStatsOffset::kFsStatsFieldsNumber));
+  }
+  FillStatsArray(&*stats_field_array_, stat);
+  Resolve(stats_field_array_->GetJSArray());
 }
 
 template <typename AliasedBufferT>
 void FSReqPromise<AliasedBufferT>::ResolveStatFs(const uv_statfs_t* stat) {
-  FillStatFsArray(&statfs_field_array_, stat);
-  Resolve(statfs_field_array_.GetJSArray());
+  if (!statfs_field_array_) {
+    statfs_field_array_.emplace(
+        env()->isolate(),
+        static_cast<size_t>(FsStatFsOffset::kFsStatFsFieldsNumber));
+  }
+  FillStatFsArray(&*statfs_field_array_, stat);
+  Resolve(statfs_field_array_->GetJSArray());
 }
 
 template <typename AliasedBufferT>
 void FSReqPromise<AliasedBufferT>::SetReturnValue(
     const v8::FunctionCallbackInfo<v8::Value>& args) {
-  v8::Local<v8::Value> val =
-      object()->Get(env()->context(),
-                    env()->promise_string()).ToLocalChecked();
-  v8::Local<v8::Promise::Resolver> resolver = val.As<v8::Promise::Resolver>();
-  args.GetReturnValue().Set(resolver->GetPromise());
+  args.GetReturnValue().Set(resolver()->GetPromise());
 }
 
 template <typename AliasedBufferT>
 void FSReqPromise<AliasedBufferT>::MemoryInfo(MemoryTracker* tracker) const {
   FSReqBase::MemoryInfo(tracker);
-  tracker->TrackField("stats_field_array", stats_field_array_);
-  tracker->TrackField("statfs_field_array", statfs_field_array_);
+  if (stats_field_array_)
+    tracker->TrackField("stats_field_array", *stats_field_array_);
+  if (statfs_field_array_)
+    tracker->TrackField("statfs_field_array", *statfs_field_array_);
 }
 
 FSReqBase* GetReqWrap(const v8::FunctionCallbackInfo<v8::Value>& args,
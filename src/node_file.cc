@@ -27,6 +27,7 @@
 #include "node_external_reference.h"
 #include "node_file-inl.h"
 #include "node_metadata.h"
+#include "node_module_pack.h"
 #include "node_process-inl.h"
 #include "node_stat_watcher.h"
 #include "node_url.h"
@@ -37,11 +38,19 @@
 
 #include "req_wrap-inl.h"
 #include "stream_base-inl.h"
+#include "simdjson.h"
+#include "simdutf.h"
 #include "string_bytes.h"
+#include "threadpoolwork-inl.h"
 #include "uv.h"
 
 #if defined(__MINGW32__) || defined(_MSC_VER)
 # include <io.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
 #endif
 
 namespace node {
@@ -49,26 +58,36 @@ namespace node {
 namespace fs {
 
 using v8::Array;
+using v8::ArrayBuffer;
+using v8::BackingStore;
 using v8::BigInt;
+using v8::BigInt64Array;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Int32;
+using v8::Int32Array;
 using v8::Integer;
 using v8::Isolate;
 using v8::JustVoid;
 using v8::Local;
+using v8::LocalVector;
 using v8::Maybe;
 using v8::MaybeLocal;
+using v8::Name;
 using v8::Nothing;
 using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::Promise;
+using v8::PropertyCallbackInfo;
 using v8::String;
+using v8::Uint32;
+using v8::Uint8Array;
 using v8::Undefined;
 using v8::Value;
 
@@ -76,6 +95,10 @@ using v8::Value;
 # define S_ISDIR(mode)  (((mode) & S_IFMT) == S_IFDIR)
 #endif
 
+#ifndef S_ISREG
+# define S_ISREG(mode)  (((mode) & S_IFMT) == S_IFREG)
+#endif
+
 #ifdef __POSIX__
 constexpr char kPathSeparator = '/';
 #else
@@ -449,6 +472,28 @@ MaybeLocal<Promise> FileHandle::ClosePromise() {
   object()->SetInternalField(FileHandle::kClosingPromiseSlot, promise);
 
   CloseReq* req = new CloseReq(env(), close_req_obj, promise, object());
+  // Reads ahead that are still in flight use the fd, so it is only closed
+  // once they are done. Those that have not started yet are cancelled.
+  if (HasReadaheadInFlight()) {
+    for (const auto& read_wrap : readahead_queue_) {
+      if (!read_wrap->done_) read_wrap->Cancel();
+    }
+    pending_close_ = req;
+    return scope.Escape(promise);
+  }
+  DispatchClose(req);
+
+  return scope.Escape(promise);
+}
+
+bool FileHandle::HasReadaheadInFlight() const {
+  for (const auto& read_wrap : readahead_queue_) {
+    if (!read_wrap->done_) return true;
+  }
+  return false;
+}
+
+void FileHandle::DispatchClose(CloseReq* req) {
   auto AfterClose = uv_fs_callback_t{[](uv_fs_t* req) {
     CloseReq* req_wrap = CloseReq::from_req(req);
     FS_ASYNC_TRACE_END1(
@@ -470,11 +515,10 @@ MaybeLocal<Promise> FileHandle::ClosePromise() {
   FS_ASYNC_TRACE_BEGIN0(UV_FS_CLOSE, req)
   int ret = req->Dispatch(uv_fs_close, fd_, AfterClose);
   if (ret < 0) {
-    req->Reject(UVException(isolate, ret, "close"));
+    HandleScope handle_scope(env()->isolate());
+    req->Reject(UVException(env()->isolate(), ret, "close"));
     delete req;
   }
-
-  return scope.Escape(promise);
 }
 
 void FileHandle::Close(const FunctionCallbackInfo<Value>& args) {
@@ -505,6 +549,9 @@ void FileHandle::AfterClose() {
   fd_ = -1;
   if (reading_ && !persistent().IsEmpty())
     EmitRead(UV_EOF);
+  // Returns the buffers of chunks that have been read ahead.
+  if (!persistent().IsEmpty())
+    DeliverReadahead();
 }
 
 void FileHandleReadWrap::MemoryInfo(MemoryTracker* tracker) const {
@@ -516,6 +563,51 @@ FileHandleReadWrap::FileHandleReadWrap(FileHandle* handle, Local<Object> obj)
   : ReqWrap(handle->env(), obj, AsyncWrap::PROVIDER_FSREQCALLBACK),
     file_handle_(handle) {}
 
+BaseObjectPtr<FileHandleReadWrap> FileHandle::GetReadWrap() {
+  BaseObjectPtr<FileHandleReadWrap> read_wrap;
+  // Either way, we need these two scopes for AsyncReset() or otherwise
+  // for creating the new instance.
+  HandleScope handle_scope(env()->isolate());
+  AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(this);
+
+  auto& freelist = binding_data_->file_handle_read_wrap_freelist;
+  if (freelist.size() > 0) {
+    read_wrap = std::move(freelist.back());
+    freelist.pop_back();
+    // Use a fresh async resource.
+    // Lifetime is ensured via AsyncWrap::resource_.
+    Local<Object> resource = Object::New(env()->isolate());
+    USE(resource->Set(
+        env()->context(), env()->handle_string(), read_wrap->object()));
+    read_wrap->AsyncReset(resource);
+    read_wrap->file_handle_ = this;
+  } else {
+    Local<Object> wrap_obj;
+    if (!env()
+             ->filehandlereadwrap_template()
+             ->NewInstance(env()->context())
+             .ToLocal(&wrap_obj)) {
+      return read_wrap;
+    }
+    read_wrap = MakeDetachedBaseObject<FileHandleReadWrap>(this, wrap_obj);
+  }
+  return read_wrap;
+}
+
+void FileHandle::RecycleReadWrap(
+    BaseObjectPtr<FileHandleReadWrap>&& read_wrap) {
+  // Push the read wrap back to the freelist, or let it be destroyed
+  // once we’re exiting the current scope.
+  constexpr size_t kWantedFreelistFill = 100;
+  auto& freelist = binding_data_->file_handle_read_wrap_freelist;
+  if (freelist.size() < kWantedFreelistFill) {
+    read_wrap->Reset();
+    freelist.emplace_back(std::move(read_wrap));
+  }
+}
+
+static constexpr int64_t kFileHandleReadSize = 65536;
+
 int FileHandle::ReadStart() {
   if (!IsAlive() || IsClosing())
     return UV_EOF;
@@ -525,56 +617,38 @@ int FileHandle::ReadStart() {
   if (current_read_)
     return 0;
 
-  BaseObjectPtr<FileHandleReadWrap> read_wrap;
-
-  if (read_length_ == 0) {
+  if (read_length_ == 0 || (readahead_eof_ && UsesReadahead())) {
     EmitRead(UV_EOF);
     return 0;
   }
 
-  {
-    // Create a new FileHandleReadWrap or re-use one.
-    // Either way, we need these two scopes for AsyncReset() or otherwise
-    // for creating the new instance.
-    HandleScope handle_scope(env()->isolate());
-    AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(this);
-
-    auto& freelist = binding_data_->file_handle_read_wrap_freelist;
-    if (freelist.size() > 0) {
-      read_wrap = std::move(freelist.back());
-      freelist.pop_back();
-      // Use a fresh async resource.
-      // Lifetime is ensured via AsyncWrap::resource_.
-      Local<Object> resource = Object::New(env()->isolate());
-      USE(resource->Set(
-          env()->context(), env()->handle_string(), read_wrap->object()));
-      read_wrap->AsyncReset(resource);
-      read_wrap->file_handle_ = this;
-    } else {
-      Local<Object> wrap_obj;
-      if (!env()
-               ->filehandlereadwrap_template()
-               ->NewInstance(env()->context())
-               .ToLocal(&wrap_obj)) {
-        return UV_EBUSY;
-      }
-      read_wrap = MakeDetachedBaseObject<FileHandleReadWrap>(this, wrap_obj);
-    }
+  if (UsesReadahead()) {
+    DeliverReadahead();
+    return 0;
   }
-  int64_t recommended_read = 65536;
+
+  // Create a new FileHandleReadWrap or re-use one.
+  BaseObjectPtr<FileHandleReadWrap> read_wrap = GetReadWrap();
+  if (!read_wrap)
+    return UV_EBUSY;
+
+  int64_t recommended_read = kFileHandleReadSize;
   if (read_length_ >= 0 && read_length_ <= recommended_read)
     recommended_read = read_length_;
 
-  read_wrap->buffer_ = EmitAlloc(recommended_read);
+  int target_fd = -1;
+#ifndef _WIN32
+  if (direct_read_target_ != nullptr && !direct_read_blocked_) {
+    target_fd = direct_read_target_->GetDirectWriteFD();
+    if (target_fd != -1) target_fd = sendfile_fd_ = dup(target_fd);
+  }
+#endif
+  const bool direct = target_fd != -1;
+  read_wrap->buffer_ =
+      direct ? uv_buf_init(nullptr, 0) : EmitAlloc(recommended_read);
 
   current_read_ = std::move(read_wrap);
-  FS_ASYNC_TRACE_BEGIN0(UV_FS_READ, current_read_.get())
-  current_read_->Dispatch(uv_fs_read,
-                          fd_,
-                          &current_read_->buffer_,
-                          1,
-                          read_offset_,
-                          uv_fs_callback_t{[](uv_fs_t* req) {
+  uv_fs_callback_t after_read{[](uv_fs_t* req) {
     FileHandle* handle;
     {
       FileHandleReadWrap* req_wrap = FileHandleReadWrap::from_req(req);
@@ -592,17 +666,30 @@ int FileHandle::ReadStart() {
 
     ssize_t result = req->result;
     uv_buf_t buffer = read_wrap->buffer_;
+    const bool was_direct = req->fs_type == UV_FS_SENDFILE;
 
     uv_fs_req_cleanup(req);
 
-    // Push the read wrap back to the freelist, or let it be destroyed
-    // once we’re exiting the current scope.
-    constexpr size_t kWantedFreelistFill = 100;
-    auto& freelist = handle->binding_data_->file_handle_read_wrap_freelist;
-    if (freelist.size() < kWantedFreelistFill) {
-      read_wrap->Reset();
-      freelist.emplace_back(std::move(read_wrap));
+    handle->RecycleReadWrap(std::move(read_wrap));
+
+#ifndef _WIN32
+    if (was_direct) {
+      close(handle->sendfile_fd_);
+      handle->sendfile_fd_ = -1;
     }
+#endif
+
+    if (was_direct && result < 0) {
+      // The target cannot take data right now, or it failed. Read the next
+      // chunk into a buffer instead, so that the listener writes it through
+      // the regular path, which waits for the target or reports its error.
+      handle->direct_read_blocked_ = true;
+      if (handle->reading_)
+        handle->ReadStart();
+      return;
+    }
+    if (!was_direct)
+      handle->direct_read_blocked_ = false;
 
     if (result >= 0) {
       // Read at most as many bytes as we originally planned to.
@@ -629,7 +716,25 @@ int FileHandle::ReadStart() {
     // Start over, if EmitRead() didn’t tell us to stop.
     if (handle->reading_)
       handle->ReadStart();
-  }});
+  }};
+
+  if (direct) {
+    FS_ASYNC_TRACE_BEGIN0(UV_FS_SENDFILE, current_read_.get())
+    current_read_->Dispatch(uv_fs_sendfile,
+                            target_fd,
+                            fd_,
+                            read_offset_,
+                            static_cast<size_t>(recommended_read),
+                            after_read);
+  } else {
+    FS_ASYNC_TRACE_BEGIN0(UV_FS_READ, current_read_.get())
+    current_read_->Dispatch(uv_fs_read,
+                            fd_,
+                            &current_read_->buffer_,
+                            1,
+                            read_offset_,
+                            after_read);
+  }
 
   return 0;
 }
@@ -639,6 +744,138 @@ int FileHandle::ReadStop() {
   return 0;
 }
 
+void FileHandle::FillReadahead() {
+  if (readahead_queue_.empty()) {
+    readahead_offset_ = read_offset_;
+    readahead_length_ = read_length_;
+  }
+
+  uv_fs_callback_t after_read{[](uv_fs_t* req) {
+    FileHandleReadWrap* req_wrap = FileHandleReadWrap::from_req(req);
+    FS_ASYNC_TRACE_END1(
+        req->fs_type, req_wrap, "result", static_cast<int>(req->result))
+    req_wrap->result_ = req->result;
+    req_wrap->done_ = true;
+    uv_fs_req_cleanup(req);
+    req_wrap->file_handle_->DeliverReadahead();
+  }};
+
+  // Reads keep going while the consumer is paused, e.g. by a StreamPipe
+  // that waits for its sink, so that the next chunks are ready when it
+  // resumes.
+  while (IsAlive() && !IsClosing() && !readahead_eof_ &&
+         readahead_length_ != 0 && readahead_queue_.size() < readahead_) {
+    BaseObjectPtr<FileHandleReadWrap> read_wrap = GetReadWrap();
+    if (!read_wrap) return;
+
+    int64_t length = kFileHandleReadSize;
+    if (readahead_length_ >= 0 && readahead_length_ < length)
+      length = readahead_length_;
+    // The chunk covers exactly its buffer, which the listener may make
+    // smaller or larger than asked for.
+    read_wrap->buffer_ = EmitAlloc(length);
+    if (read_wrap->buffer_.len > static_cast<size_t>(length))
+      read_wrap->buffer_.len = length;
+    length = read_wrap->buffer_.len;
+    read_wrap->done_ = false;
+
+    FS_ASYNC_TRACE_BEGIN0(UV_FS_READ, read_wrap.get())
+    read_wrap->Dispatch(uv_fs_read,
+                        fd_,
+                        &read_wrap->buffer_,
+                        1,
+                        readahead_offset_,
+                        after_read);
+
+    readahead_offset_ += length;
+    if (readahead_length_ >= 0)
+      readahead_length_ -= length;
+    readahead_queue_.emplace_back(std::move(read_wrap));
+  }
+}
+
+void FileHandle::DeliverReadahead() {
+  while (!readahead_queue_.empty() && readahead_queue_.front()->done_) {
+    if (!reading_ && !closed_)
+      break;
+
+    BaseObjectPtr<FileHandleReadWrap> read_wrap =
+        std::move(readahead_queue_.front());
+    readahead_queue_.pop_front();
+    ssize_t result = read_wrap->result_;
+    uv_buf_t buffer = read_wrap->buffer_;
+    RecycleReadWrap(std::move(read_wrap));
+
+    // Chunks after the end of the file, or after an error, only return
+    // their buffers to the listener.
+    if (closed_ || readahead_eof_) {
+      EmitRead(0, buffer);
+      continue;
+    }
+
+    if (result <= 0) {
+      readahead_eof_ = true;
+      EmitRead(result == 0 ? static_cast<ssize_t>(UV_EOF) : result, buffer);
+      continue;
+    }
+
+    if (read_length_ >= 0)
+      read_length_ -= result;
+    read_offset_ += result;
+    // A short read means that the following chunks start past the end of
+    // the file as it was when they were read.
+    if (static_cast<size_t>(result) < buffer.len)
+      readahead_eof_ = true;
+
+    EmitRead(result, buffer);
+
+    if ((readahead_eof_ || read_length_ == 0) && reading_)
+      EmitRead(UV_EOF);
+  }
+
+  if (pending_close_ != nullptr && !HasReadaheadInFlight()) {
+    CloseReq* req = pending_close_;
+    pending_close_ = nullptr;
+    DispatchClose(req);
+    return;
+  }
+
+  FillReadahead();
+}
+
+void FileHandle::SetReadahead(const FunctionCallbackInfo<Value>& args) {
+  FileHandle* handle;
+  ASSIGN_OR_RETURN_UNWRAP(&handle, args.This());
+  CHECK(args[0]->IsUint32());  // chunks
+  handle->readahead_ = std::min(args[0].As<Uint32>()->Value(), 64u);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+  // Let the kernel read ahead more aggressively, too.
+  if (handle->readahead_ > 0 && handle->IsAlive()) {
+    posix_fadvise(handle->fd_,
+                  std::max<int64_t>(handle->read_offset_, 0),
+                  std::max<int64_t>(handle->read_length_, 0),
+                  POSIX_FADV_SEQUENTIAL);
+  }
+#endif
+}
+
+bool FileHandle::SetDirectReadTarget(StreamBase* target) {
+#ifdef _WIN32
+  // uv_fs_sendfile() cannot write to sockets there.
+  if (target != nullptr) return false;
+#else
+  // Chunks that have already been read ahead have to be emitted first.
+  if (target != nullptr &&
+      (read_offset_ < 0 || !readahead_queue_.empty())) {
+    return false;
+  }
+#endif
+  direct_read_target_ = target;
+  if (target == nullptr) direct_read_blocked_ = false;
+  return true;
+}
+
 typedef SimpleShutdownWrap<ReqWrap<uv_fs_t>> FileHandleCloseWrap;
 
 ShutdownWrap* FileHandle::CreateShutdownWrap(Local<Object> object) {
@@ -1027,15 +1264,68 @@ static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
   THROW_IF_INSUFFICIENT_PERMISSIONS(
       env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
 
-  uv_fs_t req;
-  int rc = uv_fs_stat(env->event_loop(), &req, *path, nullptr);
-  if (rc == 0) {
-    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
-    rc = S_ISDIR(s->st_mode);
+  module_pack::Entry entry;
+  if (module_pack::Lookup(path.ToStringView(), &entry) ==
+      module_pack::LookupResult::kFound) {
+    return args.GetReturnValue().Set(
+        entry.kind == module_pack::EntryKind::kDirectory ? 1 : 0);
   }
-  uv_fs_req_cleanup(&req);
 
-  args.GetReturnValue().Set(rc);
+  args.GetReturnValue().Set(env->module_fs_cache()->Stat(*path));
+}
+
+// The realpath() and readdir() counterparts of internalModuleStat(), which
+// share its cache. They throw on error.
+static void InternalModuleRealPath(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+
+  // Packed files are never symbolic links.
+  module_pack::Entry entry;
+  if (module_pack::Lookup(path.ToStringView(), &entry) ==
+      module_pack::LookupResult::kFound) {
+    return args.GetReturnValue().Set(args[0]);
+  }
+
+  std::string result;
+  int err = env->module_fs_cache()->RealPath(*path, &result);
+  if (err < 0) {
+    return env->ThrowUVException(err, "realpath", nullptr, *path);
+  }
+  Local<Value> ret;
+  if (ToV8Value(env->context(), result, env->isolate()).ToLocal(&ret)) {
+    args.GetReturnValue().Set(ret);
+  }
+}
+
+static void InternalModuleReadDir(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+
+  std::vector<std::string> names;
+  int err = env->module_fs_cache()->ReadDir(*path, &names);
+  if (err < 0) {
+    return env->ThrowUVException(err, "scandir", nullptr, *path);
+  }
+  Local<Value> ret;
+  if (ToV8Value(env->context(), names, env->isolate()).ToLocal(&ret)) {
+    args.GetReturnValue().Set(ret);
+  }
+}
+
+// The resolvers enable the cache while they load a module graph.
+static void SetModuleFSCacheEnabled(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsBoolean());
+  env->module_fs_cache()->SetEnabled(args[0]->IsTrue());
 }
 
 constexpr bool is_uv_error_except_no_entry(int result) {
@@ -1168,6 +1458,154 @@ static void FStat(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+static int StatManyEntry(const std::string& path, uv_stat_t* out) {
+  uv_fs_t req;
+  int err = uv_fs_stat(nullptr, &req, path.c_str(), nullptr);
+  if (err == 0) *out = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  return err;
+}
+
+// Packs the result of a statMany() call into a two-element array. The first
+// element is a Float64Array (or BigInt64Array) holding one statValues-shaped
+// record per path, the second an Int32Array holding 0 or a negative error
+// code per path. Records of paths that could not be stat'ed are zero-filled.
+static Local<Value> PackStatManyResults(Isolate* isolate,
+                                        bool use_bigint,
+                                        const std::vector<uv_stat_t>& stats,
+                                        const std::vector<int>& results) {
+  EscapableHandleScope scope(isolate);
+  constexpr size_t kFields =
+      static_cast<size_t>(FsStatsOffset::kFsStatsFieldsNumber);
+  const size_t count = stats.size();
+
+  Local<Value> packed;
+  if (count == 0) {
+    // AliasedBuffers cannot be empty.
+    Local<ArrayBuffer> empty = ArrayBuffer::New(isolate, 0);
+    Local<Value> values[] = {
+        use_bigint ? BigInt64Array::New(empty, 0, 0).As<Value>()
+                   : Float64Array::New(empty, 0, 0).As<Value>(),
+        Int32Array::New(empty, 0, 0)};
+    return scope.Escape(Array::New(isolate, values, arraysize(values)));
+  }
+  if (use_bigint) {
+    AliasedBigInt64Array arr(isolate, count * kFields);
+    for (size_t i = 0; i < count; i++) {
+      if (results[i] == 0) FillStatsArray(&arr, &stats[i], i * kFields);
+    }
+    packed = arr.GetJSArray();
+  } else {
+    AliasedFloat64Array arr(isolate, count * kFields);
+    for (size_t i = 0; i < count; i++) {
+      if (results[i] == 0) FillStatsArray(&arr, &stats[i], i * kFields);
+    }
+    packed = arr.GetJSArray();
+  }
+
+  Local<ArrayBuffer> ab = ArrayBuffer::New(isolate, count * sizeof(int32_t));
+  memcpy(ab->Data(), results.data(), count * sizeof(int32_t));
+  Local<Value> values[] = {packed, Int32Array::New(ab, 0, count)};
+  return scope.Escape(Array::New(isolate, values, arraysize(values)));
+}
+
+// Runs all the stat() calls of an asynchronous statMany() as one threadpool
+// job, so that the cost of dispatching to the threadpool and of calling back
+// into JS is paid once per batch instead of once per path.
+class StatManyWork final : public ThreadPoolWork {
+ public:
+  StatManyWork(Environment* env,
+               FSReqBase* req_wrap,
+               std::vector<std::string>&& paths)
+      : ThreadPoolWork(env, "statMany", ThreadPoolWorkKind::kFs),
+        req_wrap_(req_wrap),
+        paths_(std::move(paths)),
+        stats_(paths_.size()),
+        results_(paths_.size()) {}
+
+  void DoThreadPoolWork() override {
+    for (size_t i = 0; i < paths_.size(); i++)
+      results_[i] = StatManyEntry(paths_[i], &stats_[i]);
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<StatManyWork> self(this);
+    BaseObjectPtr<FSReqBase> req_wrap = std::move(req_wrap_);
+    req_wrap->Detach();
+
+    Environment* env = this->env();
+    if (!env->can_call_into_js()) return;
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    if (status == UV_ECANCELED) {
+      req_wrap->Reject(UVException(env->isolate(), status, "stat"));
+      return;
+    }
+    CHECK_EQ(status, 0);
+    req_wrap->Resolve(PackStatManyResults(
+        env->isolate(), req_wrap->use_bigint(), stats_, results_));
+  }
+
+ private:
+  BaseObjectPtr<FSReqBase> req_wrap_;
+  std::vector<std::string> paths_;
+  std::vector<uv_stat_t> stats_;
+  std::vector<int> results_;
+};
+
+// statMany(paths, use_bigint, req)
+static void StatMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  const int argc = args.Length();
+  CHECK_GE(argc, 3);
+  CHECK(args[0]->IsArray());
+
+  Local<Array> array = args[0].As<Array>();
+  std::vector<std::string> paths;
+  paths.reserve(array->Length());
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> value;
+    if (!array->Get(context, i).ToLocal(&value)) return;
+    BufferValue path(isolate, value);
+    CHECK_NOT_NULL(*path);
+    paths.emplace_back(path.ToStringView());
+  }
+
+  bool use_bigint = args[1]->IsTrue();
+  if (!args[2]->IsUndefined()) {  // statMany(paths, use_bigint, req)
+    FSReqBase* req_wrap_async = GetReqWrap(args, 2, use_bigint);
+    CHECK_NOT_NULL(req_wrap_async);
+    for (const std::string& path : paths) {
+      ASYNC_THROW_IF_INSUFFICIENT_PERMISSIONS(
+          env,
+          req_wrap_async,
+          permission::PermissionScope::kFileSystemRead,
+          path);
+    }
+    req_wrap_async->Init("stat", nullptr, 0, UTF8);
+    auto* work = new StatManyWork(env, req_wrap_async, std::move(paths));
+    work->ScheduleWork();
+    req_wrap_async->SetReturnValue(args);
+  } else {  // statMany(paths, use_bigint)
+    for (const std::string& path : paths) {
+      THROW_IF_INSUFFICIENT_PERMISSIONS(
+          env, permission::PermissionScope::kFileSystemRead, path);
+    }
+    std::vector<uv_stat_t> stats(paths.size());
+    std::vector<int> results(paths.size());
+    FS_SYNC_TRACE_BEGIN(stat);
+    for (size_t i = 0; i < paths.size(); i++)
+      results[i] = StatManyEntry(paths[i], &stats[i]);
+    FS_SYNC_TRACE_END(stat);
+    args.GetReturnValue().Set(
+        PackStatManyResults(isolate, use_bigint, stats, results));
+  }
+}
+
 static void StatFs(const FunctionCallbackInfo<Value>& args) {
   Realm* realm = Realm::GetCurrent(args);
   BindingData* binding_data = realm->GetBindingData<BindingData>();
@@ -2486,6 +2924,27 @@ static void ReadFileUtf8(const FunctionCallbackInfo<Value>& args) {
     CHECK_NOT_NULL(*path);
     if (CheckOpenPermissions(env, path, flags).IsNothing()) return;
 
+    // Files in the module pack are decoded straight from it.
+    module_pack::Entry entry;
+    if ((flags & (O_WRONLY | O_RDWR)) == 0 &&
+        module_pack::Lookup(path.ToStringView(), &entry) ==
+            module_pack::LookupResult::kFound &&
+        entry.kind == module_pack::EntryKind::kFile) {
+      Local<Value> error;
+      Local<Value> str;
+      if (!StringBytes::Encode(isolate,
+                               entry.contents.data(),
+                               entry.contents.size(),
+                               UTF8,
+                               &error)
+               .ToLocal(&str)) {
+        CHECK(!error.IsEmpty());
+        isolate->ThrowException(error);
+        return;
+      }
+      return args.GetReturnValue().Set(str);
+    }
+
     FS_SYNC_TRACE_BEGIN(open);
     file = uv_fs_open(nullptr, &req, *path, flags, 0666, nullptr);
     FS_SYNC_TRACE_END(open);
@@ -2505,12 +2964,38 @@ static void ReadFileUtf8(const FunctionCallbackInfo<Value>& args) {
     uv_fs_req_cleanup(&req);
   });
 
+  // For regular files, read straight into a buffer of the expected size.
+  // Files that report no size, or that grew in the meantime, continue in
+  // `result`.
+  std::shared_ptr<BackingStore> store;
+  size_t total = 0;
+  {
+    uv_fs_t stat_req;
+    int err = uv_fs_fstat(nullptr, &stat_req, file, nullptr);
+    if (err == 0 && S_ISREG(stat_req.statbuf.st_mode) &&
+        stat_req.statbuf.st_size > 0 &&
+        stat_req.statbuf.st_size <= static_cast<uint64_t>(
+            v8::String::kMaxLength)) {
+      NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+      store = ArrayBuffer::NewBackingStore(
+          isolate, static_cast<size_t>(stat_req.statbuf.st_size));
+    }
+    uv_fs_req_cleanup(&stat_req);
+  }
+
   std::string result{};
   char buffer[8192];
   uv_buf_t buf = uv_buf_init(buffer, sizeof(buffer));
 
   FS_SYNC_TRACE_BEGIN(read);
   while (true) {
+    bool into_store = store && total < store->ByteLength();
+    if (into_store) {
+      buf = uv_buf_init(static_cast<char*>(store->Data()) + total,
+                        store->ByteLength() - total);
+    } else {
+      buf = uv_buf_init(buffer, sizeof(buffer));
+    }
     auto r = uv_fs_read(nullptr, &req, file, &buf, 1, -1, nullptr);
     if (req.result < 0) {
       FS_SYNC_TRACE_END(read);
@@ -2520,12 +3005,480 @@ static void ReadFileUtf8(const FunctionCallbackInfo<Value>& args) {
     if (r <= 0) {
       break;
     }
+    if (into_store) {
+      total += r;
+      continue;
+    }
+    if (store && result.empty())
+      result.assign(static_cast<const char*>(store->Data()), total);
     result.append(buf.base, r);
   }
   FS_SYNC_TRACE_END(read);
 
+  const char* data = result.data();
+  size_t length = result.size();
+  if (store && result.empty()) {
+    data = static_cast<const char*>(store->Data());
+    length = total;
+  }
+
+  // ASCII is also valid Latin-1, so pure ASCII content can become a
+  // one-byte string without decoding. Large ones are external strings that
+  // keep the buffer alive instead of copying it.
+  Local<Value> error;
+  MaybeLocal<Value> maybe_str;
+  if (store && result.empty() && simdutf::validate_ascii(data, length)) {
+    maybe_str = StringBytes::EncodeShared(
+        isolate, std::move(store), data, length, LATIN1, &error);
+  } else {
+    maybe_str = StringBytes::Encode(isolate, data, length, UTF8, &error);
+  }
+  Local<Value> str;
+  if (!maybe_str.ToLocal(&str)) {
+    CHECK(!error.IsEmpty());
+    isolate->ThrowException(error);
+    return;
+  }
+  args.GetReturnValue().Set(str);
+}
+
+std::unique_ptr<BackingStore> MapFile(const char* path,
+                                      int64_t offset,
+                                      int64_t length,
+                                      int flags,
+                                      int* err) {
+  CHECK_GE(offset, 0);
+#if defined(_WIN32) || defined(V8_ENABLE_SANDBOX)
+  // With the sandbox, ArrayBuffer memory has to come from the sandbox.
+  *err = UV_ENOSYS;
+  return nullptr;
+#else
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    *err = -errno;
+    return nullptr;
+  }
+  // The mapping keeps the file open on its own.
+  auto close_fd = OnScopeLeave([fd]() { close(fd); });
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    *err = -errno;
+    return nullptr;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    *err = S_ISDIR(st.st_mode) ? UV_EISDIR : UV_EINVAL;
+    return nullptr;
+  }
+  if (offset > st.st_size) {
+    *err = UV_EINVAL;
+    return nullptr;
+  }
+  uint64_t available = static_cast<uint64_t>(st.st_size - offset);
+  uint64_t byte_length = length < 0 ? available
+                                    : std::min(static_cast<uint64_t>(length),
+                                               available);
+  if (byte_length == 0) {
+    return ArrayBuffer::NewBackingStore(
+        nullptr, 0, [](void*, size_t, void*) {}, nullptr);
+  }
+
+  // mmap() wants a page aligned offset, so map from the start of the page and
+  // hide the bytes in front of `offset`. The deleter gets the size of that
+  // gap, so that it can find the start of the mapping again.
+  const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  const uint64_t delta = static_cast<uint64_t>(offset) % page_size;
+  if (static_cast<size_t>(byte_length + delta) != byte_length + delta) {
+    *err = UV_ENOMEM;
+    return nullptr;
+  }
+  const size_t map_length = static_cast<size_t>(byte_length + delta);
+
+  int prot = PROT_READ;
+  if (!(flags & kMapReadOnly)) prot |= PROT_WRITE;
+  int map_flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+  if (flags & kMapPopulate) map_flags |= MAP_POPULATE;
+#endif
+  void* mapping =
+      mmap(nullptr, map_length, prot, map_flags, fd, offset - delta);
+  if (mapping == MAP_FAILED) {
+    *err = -errno;
+    return nullptr;
+  }
+
+  // The hints are only hints, so a failure is not an error.
+  if (flags & kMapSequential)
+    posix_madvise(mapping, map_length, POSIX_MADV_SEQUENTIAL);
+  if (flags & kMapRandom)
+    posix_madvise(mapping, map_length, POSIX_MADV_RANDOM);
+  if (flags & kMapWillNeed)
+    posix_madvise(mapping, map_length, POSIX_MADV_WILLNEED);
+
+  return ArrayBuffer::NewBackingStore(
+      static_cast<char*>(mapping) + delta,
+      static_cast<size_t>(byte_length),
+      [](void* data, size_t length, void* deleter_data) {
+        size_t delta = reinterpret_cast<uintptr_t>(deleter_data);
+        munmap(static_cast<char*>(data) - delta, length + delta);
+      },
+      reinterpret_cast<void*>(static_cast<uintptr_t>(delta)));
+#endif  // defined(_WIN32) || defined(V8_ENABLE_SANDBOX)
+}
+
+// Maps a file into a new ArrayBuffer.
+//
+// arrayBuffer = fs.mmapFile(path, offset, length, flags)
+// 0 path      string. the file to map
+// 1 offset    integer. where the mapping starts in the file
+// 2 length    integer. how many bytes to map, or -1 for the rest of the file
+// 3 flags     integer. a combination of the kMap* constants
+static void MmapFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK_GE(args.Length(), 4);
+
+  BufferValue path(env->isolate(), args[0]);
+  CHECK_NOT_NULL(*path);
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+
+  CHECK(IsSafeJsInt(args[1]));
+  const int64_t offset = args[1].As<Integer>()->Value();
+  CHECK_GE(offset, 0);
+  CHECK(IsSafeJsInt(args[2]));
+  const int64_t length = args[2].As<Integer>()->Value();
+  CHECK(args[3]->IsInt32());
+  // JS can write to any ArrayBuffer, so it always gets copy-on-write pages.
+  const int flags = args[3].As<Int32>()->Value() & ~kMapReadOnly;
+
+  int err = 0;
+  std::unique_ptr<BackingStore> store;
+  {
+    FS_SYNC_TRACE_BEGIN(mmap);
+    store = MapFile(*path, offset, length, flags, &err);
+    FS_SYNC_TRACE_END(mmap);
+  }
+  if (!store) return env->ThrowUVException(err, "mmap", nullptr, *path);
+
   args.GetReturnValue().Set(
-      ToV8Value(env->context(), result, isolate).ToLocalChecked());
+      ArrayBuffer::New(env->isolate(), std::move(store)));
+}
+
+namespace {
+
+void JSONLazyGetter(Local<Name> property,
+                    const PropertyCallbackInfo<Value>& info);
+
+// Builds V8 values with simdjson's on-demand API, without going through an
+// intermediate tree. In lazy mode, the fields of objects become lazy data
+// properties that keep a view of their raw JSON text, and are only parsed
+// when they are first read. Syntax errors inside of such a field are only
+// reported then, too.
+class JSONBuilder {
+ public:
+  JSONBuilder(Environment* env, Local<ArrayBuffer> source, bool lazy)
+      : env_(env),
+        isolate_(env->isolate()),
+        source_(source),
+        base_(static_cast<const char*>(source->Data())),
+        lazy_(lazy) {}
+
+  // Returns an empty handle on failure, with error() set unless an
+  // exception is pending.
+  template <typename T>
+  MaybeLocal<Value> Build(T& value) {
+    simdjson::ondemand::json_type type;
+    if (Fail(value.type().get(type))) return {};
+    switch (type) {
+      case simdjson::ondemand::json_type::object:
+        return BuildObject(value);
+      case simdjson::ondemand::json_type::array:
+        return BuildArray(value);
+      case simdjson::ondemand::json_type::string: {
+        std::string_view str;
+        if (Fail(value.get_string().get(str))) return {};
+        return NewString(str);
+      }
+      case simdjson::ondemand::json_type::number: {
+        double number;
+        if (Fail(value.get_double().get(number))) return {};
+        return Number::New(isolate_, number);
+      }
+      case simdjson::ondemand::json_type::boolean: {
+        bool boolean;
+        if (Fail(value.get_bool().get(boolean))) return {};
+        return v8::Boolean::New(isolate_, boolean);
+      }
+      case simdjson::ondemand::json_type::null: {
+        bool is_null;
+        if (Fail(value.is_null().get(is_null))) return {};
+        if (!is_null) {
+          error_ = simdjson::INCORRECT_TYPE;
+          return {};
+        }
+        return v8::Null(isolate_);
+      }
+    }
+    UNREACHABLE();
+  }
+
+  simdjson::error_code error() const { return error_; }
+
+ private:
+  bool Fail(simdjson::error_code error) {
+    if (error == simdjson::SUCCESS) return false;
+    error_ = error;
+    return true;
+  }
+
+  MaybeLocal<Value> NewString(std::string_view str) {
+    Local<String> result;
+    if (str.size() > static_cast<size_t>(String::kMaxLength) ||
+        !String::NewFromUtf8(isolate_,
+                             str.data(),
+                             v8::NewStringType::kNormal,
+                             static_cast<int>(str.size()))
+             .ToLocal(&result)) {
+      isolate_->ThrowException(ERR_STRING_TOO_LONG(isolate_));
+      return {};
+    }
+    return result;
+  }
+
+  template <typename T>
+  MaybeLocal<Value> BuildObject(T& value) {
+    EscapableHandleScope scope(isolate_);
+    Local<Context> context = env_->context();
+    simdjson::ondemand::object object;
+    if (Fail(value.get_object().get(object))) return {};
+    Local<Object> result = Object::New(isolate_);
+    for (auto field : object) {
+      std::string_view key;
+      simdjson::ondemand::value child;
+      if (Fail(field.unescaped_key().get(key)) ||
+          Fail(field.value().get(child))) {
+        return {};
+      }
+      Local<Value> name;
+      if (!NewString(key).ToLocal(&name)) return {};
+
+      if (lazy_) {
+        std::string_view raw;
+        if (Fail(child.raw_json().get(raw))) return {};
+        Local<Uint8Array> slice =
+            Uint8Array::New(source_, raw.data() - base_, raw.size());
+        if (result
+                ->SetLazyDataProperty(
+                    context, name.As<String>(), JSONLazyGetter, slice)
+                .IsNothing()) {
+          return {};
+        }
+        continue;
+      }
+
+      Local<Value> child_value;
+      if (!Build(child).ToLocal(&child_value) ||
+          result->CreateDataProperty(context, name.As<String>(), child_value)
+              .IsNothing()) {
+        return {};
+      }
+    }
+    return scope.Escape(result);
+  }
+
+  template <typename T>
+  MaybeLocal<Value> BuildArray(T& value) {
+    EscapableHandleScope scope(isolate_);
+    simdjson::ondemand::array array;
+    if (Fail(value.get_array().get(array))) return {};
+    LocalVector<Value> elements(isolate_);
+    for (auto element : array) {
+      simdjson::ondemand::value child;
+      Local<Value> child_value;
+      if (Fail(element.get(child)) || !Build(child).ToLocal(&child_value))
+        return {};
+      elements.push_back(child_value);
+    }
+    return scope.Escape(
+        Array::New(isolate_, elements.data(), elements.size()));
+  }
+
+  Environment* env_;
+  Isolate* isolate_;
+  Local<ArrayBuffer> source_;
+  const char* base_;
+  bool lazy_;
+  simdjson::error_code error_ = simdjson::SUCCESS;
+};
+
+// Parses `length` bytes of `source`, starting at `offset`. The buffer has to
+// have at least simdjson::SIMDJSON_PADDING bytes after them.
+MaybeLocal<Value> ParseJSON(Environment* env,
+                            Local<ArrayBuffer> source,
+                            size_t offset,
+                            size_t length,
+                            bool lazy) {
+  CHECK_GE(source->ByteLength() - offset,
+           length + simdjson::SIMDJSON_PADDING);
+  const char* data = static_cast<const char*>(source->Data()) + offset;
+
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document document;
+  JSONBuilder builder(env, source, lazy);
+  simdjson::error_code error =
+      parser
+          .iterate(simdjson::padded_string_view(
+              data, length, source->ByteLength() - offset))
+          .get(document);
+  MaybeLocal<Value> result;
+  if (error == simdjson::SUCCESS) {
+    result = builder.Build(document);
+    error = builder.error();
+    if (!result.IsEmpty() && !document.at_end())
+      error = simdjson::TRAILING_CONTENT;
+  }
+  if (error != simdjson::SUCCESS) {
+    Isolate* isolate = env->isolate();
+    isolate->ThrowException(v8::Exception::SyntaxError(
+        OneByteString(isolate, simdjson::error_message(error))));
+    return {};
+  }
+  return result;
+}
+
+void JSONLazyGetter(Local<Name> property,
+                    const PropertyCallbackInfo<Value>& info) {
+  Environment* env = Environment::GetCurrent(info);
+  Local<Uint8Array> slice = info.Data().As<Uint8Array>();
+  Local<Value> value;
+  if (ParseJSON(env,
+                slice->Buffer(),
+                slice->ByteOffset(),
+                slice->ByteLength(),
+                true)
+          .ToLocal(&value)) {
+    info.GetReturnValue().Set(value);
+  }
+}
+
+// Reads the rest of `file` into a buffer with simdjson's padding after the
+// data. Returns a libuv error code on failure.
+int ReadPadded(Environment* env,
+               uv_file file,
+               std::shared_ptr<BackingStore>* store,
+               size_t* length) {
+  uv_fs_t req;
+  auto cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+
+  // Regular files are read into a buffer of the right size directly. More
+  // than fits into an ArrayBuffer cannot be parsed, and allocating it would
+  // abort the process.
+  constexpr size_t kMaxLength =
+      v8::TypedArray::kMaxByteLength - simdjson::SIMDJSON_PADDING;
+  size_t capacity = 8192;
+  int err = uv_fs_fstat(nullptr, &req, file, nullptr);
+  if (err < 0) return err;
+  if (S_ISREG(req.statbuf.st_mode) && req.statbuf.st_size > 0) {
+    if (req.statbuf.st_size > kMaxLength) return UV_EFBIG;
+    capacity = static_cast<size_t>(req.statbuf.st_size);
+  }
+  uv_fs_req_cleanup(&req);
+
+  auto allocate = [&](size_t size) {
+    NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+    return std::shared_ptr<BackingStore>(ArrayBuffer::NewBackingStore(
+        env->isolate(), size + simdjson::SIMDJSON_PADDING));
+  };
+  *store = allocate(capacity);
+  *length = 0;
+
+  char probe[8192];
+  while (true) {
+    char* data = static_cast<char*>((*store)->Data());
+    // Check for the end of the file before growing a full buffer.
+    bool full = *length == capacity;
+    uv_buf_t buf = full ? uv_buf_init(probe, sizeof(probe))
+                        : uv_buf_init(data + *length, capacity - *length);
+    int r = uv_fs_read(nullptr, &req, file, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (r < 0) return r;
+    if (r == 0) break;
+    if (full) {
+      if (*length + r > kMaxLength) return UV_EFBIG;
+      capacity = std::min(capacity * 2, kMaxLength);
+      std::shared_ptr<BackingStore> grown = allocate(capacity);
+      memcpy(grown->Data(), data, *length);
+      memcpy(static_cast<char*>(grown->Data()) + *length, probe, r);
+      *store = std::move(grown);
+    }
+    *length += r;
+  }
+  return 0;
+}
+
+}  // namespace
+
+// Parses a JSON file or buffer into V8 values.
+//
+// value = fs.readJSON(source, lazy)
+// 0 source    string|ArrayBufferView. the path of the file, or its contents
+// 1 lazy      boolean. whether object fields are parsed on first access
+static void ReadJSON(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK_GE(args.Length(), 2);
+  const bool lazy = args[1]->IsTrue();
+
+  // The text always ends up in a padded buffer of its own. Lazy fields keep
+  // views of it, so it must not be changed afterwards.
+  std::shared_ptr<BackingStore> store;
+  size_t length = 0;
+  if (args[0]->IsArrayBufferView()) {
+    ArrayBufferViewContents<char> contents(args[0]);
+    length = contents.length();
+    NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+    store = ArrayBuffer::NewBackingStore(
+        isolate, length + simdjson::SIMDJSON_PADDING);
+    memcpy(store->Data(), contents.data(), length);
+  } else {
+    BufferValue path(isolate, args[0]);
+    CHECK_NOT_NULL(*path);
+    THROW_IF_INSUFFICIENT_PERMISSIONS(
+        env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+
+    uv_fs_t req;
+    FS_SYNC_TRACE_BEGIN(open);
+    uv_file file = uv_fs_open(nullptr, &req, *path, O_RDONLY, 0, nullptr);
+    FS_SYNC_TRACE_END(open);
+    uv_fs_req_cleanup(&req);
+    if (file < 0)
+      return env->ThrowUVException(file, "open", nullptr, path.out());
+    auto defer_close = OnScopeLeave([file]() {
+      uv_fs_t close_req;
+      FS_SYNC_TRACE_BEGIN(close);
+      CHECK_EQ(0, uv_fs_close(nullptr, &close_req, file, nullptr));
+      FS_SYNC_TRACE_END(close);
+      uv_fs_req_cleanup(&close_req);
+    });
+
+    FS_SYNC_TRACE_BEGIN(read);
+    int err = ReadPadded(env, file, &store, &length);
+    FS_SYNC_TRACE_END(read);
+    if (err < 0) return env->ThrowUVException(err, "read", nullptr, path.out());
+  }
+  // simdjson only needs the padding to be readable, but keep it defined.
+  memset(static_cast<char*>(store->Data()) + length,
+         0,
+         simdjson::SIMDJSON_PADDING);
+
+  Local<Value> value;
+  if (ParseJSON(env, ArrayBuffer::New(isolate, std::move(store)), 0, length,
+                lazy)
+          .ToLocal(&value)) {
+    args.GetReturnValue().Set(value);
+  }
 }
 
 // Wrapper for readv(2).
@@ -3253,6 +4206,8 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "openFileHandle", OpenFileHandle);
   SetMethod(isolate, target, "read", Read);
   SetMethod(isolate, target, "readFileUtf8", ReadFileUtf8);
+  SetMethod(isolate, target, "mmapFile", MmapFile);
+  SetMethod(isolate, target, "readJSON", ReadJSON);
   SetMethod(isolate, target, "readBuffers", ReadBuffers);
   SetMethod(isolate, target, "fdatasync", Fdatasync);
   SetMethod(isolate, target, "fsync", Fsync);
@@ -3262,9 +4217,14 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "mkdir", MKDir);
   SetMethod(isolate, target, "readdir", ReadDir);
   SetMethod(isolate, target, "internalModuleStat", InternalModuleStat);
+  SetMethod(isolate, target, "internalModuleRealPath", InternalModuleRealPath);
+  SetMethod(isolate, target, "internalModuleReadDir", InternalModuleReadDir);
+  SetMethod(
+      isolate, target, "setModuleFSCacheEnabled", SetModuleFSCacheEnabled);
   SetMethod(isolate, target, "stat", Stat);
   SetMethod(isolate, target, "lstat", LStat);
   SetMethod(isolate, target, "fstat", FStat);
+  SetMethod(isolate, target, "statMany", StatMany);
   SetMethod(isolate, target, "statfs", StatFs);
   SetMethod(isolate, target, "link", Link);
   SetMethod(isolate, target, "symlink", Symlink);
@@ -3298,6 +4258,15 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
       Integer::New(isolate,
                    static_cast<int32_t>(FsStatsOffset::kFsStatsFieldsNumber)));
 
+#define V(name)                                                                \
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, #name),                           \
+              Integer::New(isolate, name));
+  V(kMapPopulate)
+  V(kMapSequential)
+  V(kMapRandom)
+  V(kMapWillNeed)
+#undef V
+
   // Create FunctionTemplate for FSReqCallback
   Local<FunctionTemplate> fst = NewFunctionTemplate(isolate, NewFSReqCallback);
   fst->InstanceTemplate()->SetInternalFieldCount(
@@ -3323,7 +4292,8 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
       FIXED_ONE_BYTE_STRING(isolate, "FSReqPromise");
   fpt->SetClassName(promiseString);
   Local<ObjectTemplate> fpo = fpt->InstanceTemplate();
-  fpo->SetInternalFieldCount(FSReqBase::kInternalFieldCount);
+  fpo->SetInternalFieldCount(
+      FSReqPromise<AliasedFloat64Array>::kInternalFieldCount);
   isolate_data->set_fsreqpromise_constructor_template(fpo);
 
   // Create FunctionTemplate for FileHandle
@@ -3331,6 +4301,7 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   fd->Inherit(AsyncWrap::GetConstructorTemplate(isolate_data));
   SetProtoMethod(isolate, fd, "close", FileHandle::Close);
   SetProtoMethod(isolate, fd, "releaseFD", FileHandle::ReleaseFD);
+  SetProtoMethod(isolate, fd, "setReadahead", FileHandle::SetReadahead);
   Local<ObjectTemplate> fdt = fd->InstanceTemplate();
   fdt->SetInternalFieldCount(FileHandle::kInternalFieldCount);
   StreamBase::AddMethods(isolate_data, fd);
@@ -3373,6 +4344,9 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(OpenFileHandle);
   registry->Register(Read);
   registry->Register(ReadFileUtf8);
+  registry->Register(MmapFile);
+  registry->Register(ReadJSON);
+  registry->Register(JSONLazyGetter);
   registry->Register(ReadBuffers);
   registry->Register(Fdatasync);
   registry->Register(Fsync);
@@ -3382,9 +4356,13 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(MKDir);
   registry->Register(ReadDir);
   registry->Register(InternalModuleStat);
+  registry->Register(InternalModuleRealPath);
+  registry->Register(InternalModuleReadDir);
+  registry->Register(SetModuleFSCacheEnabled);
   registry->Register(Stat);
   registry->Register(LStat);
   registry->Register(FStat);
+  registry->Register(StatMany);
   registry->Register(StatFs);
   registry->Register(Link);
   registry->Register(Symlink);
@@ -3414,6 +4392,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(FileHandle::New);
   registry->Register(FileHandle::Close);
   registry->Register(FileHandle::ReleaseFD);
+  registry->Register(FileHandle::SetReadahead);
   StreamBase::RegisterExternalReferences(registry);
 }
 
@@ -3,6 +3,7 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <deque>
 #include <optional>
 #include "aliased_buffer.h"
 #include "node_messaging.h"
@@ -10,6 +11,9 @@
 #include "stream_base.h"
 
 namespace node {
+
+class StatPoller;
+
 namespace fs {
 
 class FileHandleReadWrap;
@@ -83,6 +87,9 @@ class BindingData : public SnapshotableObject {
   std::vector<BaseObjectPtr<FileHandleReadWrap>>
       file_handle_read_wrap_freelist;
 
+  // Shared by the fs.watchFile() watchers of the realm, see StatWatcher.
+  StatPoller* stat_poller = nullptr;
+
   SERIALIZABLE_OBJECT_METHODS()
   SET_BINDING_ID(fs_binding_data)
 
@@ -240,6 +247,11 @@ inline v8::Local<v8::Value> FillGlobalStatFsArray(BindingData* binding_data,
 template <typename AliasedBufferT>
 class FSReqPromise final : public FSReqBase {
  public:
+  enum InternalFields {
+    kResolverField = FSReqBase::kInternalFieldCount,
+    kInternalFieldCount
+  };
+
   static inline FSReqPromise* New(BindingData* binding_data,
                                   bool use_bigint);
   inline ~FSReqPromise() override;
@@ -265,9 +277,13 @@ class FSReqPromise final : public FSReqBase {
                       v8::Local<v8::Object> obj,
                       bool use_bigint);
 
+  inline v8::Local<v8::Promise::Resolver> resolver();
+
   bool finished_ = false;
-  AliasedBufferT stats_field_array_;
-  AliasedBufferT statfs_field_array_;
+  // Most requests resolve with something other than stats, so these are
+  // only created when they are needed.
+  std::optional<AliasedBufferT> stats_field_array_;
+  std::optional<AliasedBufferT> statfs_field_array_;
 };
 
 class FSReqAfterScope final {
@@ -312,6 +328,9 @@ class FileHandleReadWrap final : public ReqWrap<uv_fs_t> {
  private:
   FileHandle* file_handle_;
   uv_buf_t buffer_;
+  // Used for reads ahead, see FileHandle::FillReadahead().
+  ssize_t result_ = 0;
+  bool done_ = false;
 
   friend class FileHandle;
 };
@@ -346,9 +365,15 @@ class FileHandle final : public AsyncWrap, public StreamBase {
   // Releases ownership of the FD.
   static void ReleaseFD(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Sets how many chunks are read ahead of the consumer when reading from a
+  // known offset, so that several reads can be in flight at once.
+  static void SetReadahead(const v8::FunctionCallbackInfo<v8::Value>& args);
+
   // StreamBase interface:
   int ReadStart() override;
   int ReadStop() override;
+  // Uses uv_fs_sendfile(), which needs a read offset.
+  bool SetDirectReadTarget(StreamBase* target) override;
 
   bool IsAlive() override { return !closed_; }
   bool IsClosing() override { return closing_; }
@@ -436,6 +461,21 @@ class FileHandle final : public AsyncWrap, public StreamBase {
 
   // Asynchronous close
   v8::MaybeLocal<v8::Promise> ClosePromise();
+  void DispatchClose(CloseReq* req);
+
+  // Takes a FileHandleReadWrap from the freelist, or creates a new one.
+  BaseObjectPtr<FileHandleReadWrap> GetReadWrap();
+  void RecycleReadWrap(BaseObjectPtr<FileHandleReadWrap>&& read_wrap);
+
+  bool UsesReadahead() const {
+    return (readahead_ > 0 || !readahead_queue_.empty()) &&
+           read_offset_ >= 0 && direct_read_target_ == nullptr;
+  }
+  // Issues reads until `readahead_` chunks are queued.
+  void FillReadahead();
+  // Emits the chunks at the head of the queue that have been read.
+  void DeliverReadahead();
+  bool HasReadaheadInFlight() const;
 
   int fd_;
   bool closing_ = false;
@@ -443,9 +483,28 @@ class FileHandle final : public AsyncWrap, public StreamBase {
   bool reading_ = false;
   int64_t read_offset_ = -1;
   int64_t read_length_ = -1;
+  StreamBase* direct_read_target_ = nullptr;
+  // Set when the direct read target was full, until a regular read took
+  // its place.
+  bool direct_read_blocked_ = false;
+  // A duplicate of the target's descriptor for the sendfile() in flight, so
+  // that closing the target in the meantime cannot hand its number to an
+  // unrelated file.
+  int sendfile_fd_ = -1;
 
   BaseObjectPtr<FileHandleReadWrap> current_read_;
 
+  uint32_t readahead_ = 0;
+  // Where the next read ahead starts, and how much is left to read ahead of
+  // the requested range, or -1. Synced with read_offset_ and read_length_
+  // whenever the queue is empty.
+  int64_t readahead_offset_ = -1;
+  int64_t readahead_length_ = -1;
+  bool readahead_eof_ = false;
+  std::deque<BaseObjectPtr<FileHandleReadWrap>> readahead_queue_;
+  // Set by ClosePromise() while it waits for reads ahead to finish.
+  CloseReq* pending_close_ = nullptr;
+
   BaseObjectPtr<BindingData> binding_data_;
 };
 
@@ -455,6 +514,31 @@ int MKDirpSync(uv_loop_t* loop,
                int mode,
                uv_fs_cb cb = nullptr);
 
+enum MapFileFlags : int {
+  // Pre-fault the whole mapping. Only has an effect on Linux.
+  kMapPopulate = 1 << 0,
+  // Map the pages without write access. Writing to the memory then kills
+  // the process, so this is only safe if no JS code can see the memory, and
+  // it is not exported to JS.
+  kMapReadOnly = 1 << 1,
+  kMapSequential = 1 << 2,
+  kMapRandom = 1 << 3,
+  kMapWillNeed = 1 << 4,
+};
+
+// Maps up to `length` bytes of the file at `path`, starting at `offset`, into
+// a private mapping, and returns a BackingStore that unmaps the memory when it
+// is freed. A negative `length` maps everything up to the end of the file.
+// Writes to the memory are not written back to the file, but a file that is
+// truncated while it is mapped can still make accesses fault.
+// Returns nullptr and sets `*err` to a libuv error code on failure. Not
+// available on Windows, or when V8 is built with the sandbox enabled.
+std::unique_ptr<v8::BackingStore> MapFile(const char* path,
+                                          int64_t offset,
+                                          int64_t length,
+                                          int flags,
+                                          int* err);
+
 class FSReqWrapSync {
  public:
   FSReqWrapSync(const char* syscall = nullptr,
@@ -206,6 +206,11 @@ Http2Options::Http2Options(Http2State* http2_state, SessionType type) {
         option,
         static_cast<size_t>(buffer[IDX_OPTIONS_MAX_SETTINGS]));
   }
+
+  // Receive windows are grown from the measured bandwidth-delay product up
+  // to this size in bytes, instead of staying at the initial window size.
+  if (flags & (1 << IDX_OPTIONS_MAX_AUTO_WINDOW_SIZE))
+    set_max_auto_window_size(buffer[IDX_OPTIONS_MAX_AUTO_WINDOW_SIZE]);
 }
 
 #define GRABSETTING(entries, count, name)                                      \
@@ -533,10 +538,14 @@ void Http2Session::CheckAllocatedSize(size_t previous_size) const {
 
 void Http2Session::IncreaseAllocatedSize(size_t size) {
   current_nghttp2_memory_ += size;
+  env()->native_memory_counters()->Increase(
+      mem::NativeMemoryCounters::kHttp2, size);
 }
 
 void Http2Session::DecreaseAllocatedSize(size_t size) {
   current_nghttp2_memory_ -= size;
+  env()->native_memory_counters()->Decrease(
+      mem::NativeMemoryCounters::kHttp2, size);
 }
 
 Http2Session::Http2Session(Http2State* http2_state,
@@ -544,6 +553,8 @@ Http2Session::Http2Session(Http2State* http2_state,
                            SessionType type)
     : AsyncWrap(http2_state->env(), wrap, AsyncWrap::PROVIDER_HTTP2SESSION),
       js_fields_(http2_state->env()->isolate()),
+      stream_batch_(http2_state->env()->isolate(),
+                    kStreamBatchMaxEntries * IDX_STREAM_BATCH_FIELD_COUNT),
       session_type_(type),
       http2_state_(http2_state) {
   MakeWeak();
@@ -563,6 +574,12 @@ Http2Session::Http2Session(Http2State* http2_state,
 
   max_outstanding_pings_ = opts.max_outstanding_pings();
   max_outstanding_settings_ = opts.max_outstanding_settings();
+  if (opts.max_auto_window_size() > 0) {
+    bdp_ = std::make_unique<BdpEstimator>(
+        std::min<uint64_t>({opts.max_auto_window_size(),
+                            max_session_memory_ / 2,
+                            NGHTTP2_MAX_WINDOW_SIZE}));
+  }
 
   local_custom_settings_.number = 0;
   remote_custom_settings_.number = 0;
@@ -600,6 +617,9 @@ Http2Session::Http2Session(Http2State* http2_state,
   Local<Uint8Array> uint8_arr =
       Uint8Array::New(js_fields_.GetArrayBuffer(), 0, kSessionUint8FieldCount);
   USE(wrap->Set(env()->context(), env()->fields_string(), uint8_arr));
+  USE(wrap->Set(env()->context(),
+                FIXED_ONE_BYTE_STRING(env()->isolate(), "streamBatch"),
+                stream_batch_.GetJSArray()));
 }
 
 Http2Session::~Http2Session() {
@@ -637,10 +657,14 @@ void Http2Session::FetchAllowedRemoteCustomSettings() {
 
 void Http2Session::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("streams", streams_);
+  tracker->TrackFieldWithSize("recycled_headers",
+                              recycled_headers_.memory_size());
   tracker->TrackField("outstanding_pings", outstanding_pings_);
   tracker->TrackField("outstanding_settings", outstanding_settings_);
   tracker->TrackField("outgoing_buffers", outgoing_buffers_);
   tracker->TrackFieldWithSize("stream_buf", stream_buf_.len);
+  tracker->TrackField("stream_batch", stream_batch_);
+  tracker->TrackField("stream_batch_streams", stream_batch_streams_);
   tracker->TrackFieldWithSize("outgoing_storage", outgoing_storage_.size());
   tracker->TrackFieldWithSize("pending_rst_streams",
                               pending_rst_streams_.size() * sizeof(int32_t));
@@ -852,6 +876,24 @@ void Http2Session::AddStream(Http2Stream* stream) {
   IncrementCurrentSessionMemory(sizeof(*stream));
 }
 
+bool RecycledHeaders::Take(std::vector<Http2Header>* headers) {
+  if (buffers_.empty())
+    return false;
+  *headers = std::move(buffers_.back());
+  buffers_.pop_back();
+  return true;
+}
+
+void RecycledHeaders::Recycle(std::vector<Http2Header> headers) {
+  if (buffers_.size() >= kMaxRecycledStreamHeaders ||
+      headers.capacity() == 0 ||
+      headers.capacity() > kMaxRecycledStreamHeadersCapacity) {
+    return;
+  }
+  headers.clear();
+  buffers_.emplace_back(std::move(headers));
+}
+
 
 BaseObjectPtr<Http2Stream> Http2Session::RemoveStream(int32_t id) {
   BaseObjectPtr<Http2Stream> stream;
@@ -908,12 +950,27 @@ void Http2Session::ConsumeHTTP2Data() {
         nghttp2_session_want_read(session_.get()));
   set_receive_paused(false);
   custom_recv_error_code_ = nullptr;
+
+  // Only the outermost call gathers stream events; they have to be flushed
+  // before stream_buf_ab_, which DATA entries refer to, is released below.
+  const bool batch_stream_events =
+      (js_fields_->bitfield & (1 << kSessionBatchStreamEvents)) &&
+      !(flags_ & kSessionStateBatchingStreamEvents) &&
+      !env()->http2session_on_stream_batch_function().IsEmpty();
+  if (batch_stream_events)
+    flags_ |= kSessionStateBatchingStreamEvents;
+
   ssize_t ret =
     nghttp2_session_mem_recv(session_.get(),
                              reinterpret_cast<uint8_t*>(stream_buf_.base) +
                                  stream_buf_offset_,
                              read_len);
   CHECK_NE(ret, NGHTTP2_ERR_NOMEM);
+
+  if (batch_stream_events) {
+    FlushStreamBatch();
+    flags_ &= ~kSessionStateBatchingStreamEvents;
+  }
   CHECK_IMPLIES(custom_recv_error_code_ != nullptr, ret < 0);
 
   if (is_receive_paused()) {
@@ -1224,6 +1281,7 @@ int Http2Session::OnStreamClose(nghttp2_session* handle,
   // ever passed on to the javascript side. If that happens, the callback
   // will return false.
   if (env->can_call_into_js()) {
+    session->FlushStreamBatch();
     Local<Value> arg = Integer::NewFromUnsigned(isolate, code);
     MaybeLocal<Value> answer = stream->MakeCallback(
         env->http2session_on_stream_close_function(), 1, &arg);
@@ -1274,12 +1332,17 @@ int Http2Session::OnDataChunkReceived(nghttp2_session* handle,
   // so that it can send a WINDOW_UPDATE frame. This is a critical part of
   // the flow control process in http2
   CHECK_EQ(nghttp2_session_consume_connection(handle, len), 0);
+  if (session->is_auto_tuning_window())
+    session->SampleBdp(len);
   BaseObjectPtr<Http2Stream> stream = session->FindStream(id);
 
   // If the stream has been destroyed, ignore this chunk
   if (!stream || stream->is_destroyed())
     return 0;
 
+  if (session->is_auto_tuning_window())
+    session->GrowStreamWindow(id);
+
   stream->statistics_.received_bytes += len;
 
   // Repeatedly ask the stream's owner for memory, and copy the read data
@@ -1393,6 +1456,10 @@ void Http2StreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
   Context::Scope context_scope(env->context());
 
   if (nread < 0) {
+    if (nread == UV_EOF && session->is_batching_stream_events()) {
+      session->AddStreamBatchEntry(stream, STREAM_BATCH_EOF);
+      return;
+    }
     PassReadErrorToPreviousListener(nread);
     return;
   }
@@ -1416,9 +1483,104 @@ void Http2StreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
   CHECK_LE(offset, session->stream_buf_.len);
   CHECK_LE(offset + buf.len, session->stream_buf_.len);
 
+  if (session->is_batching_stream_events()) {
+    session->AddStreamBatchEntry(stream,
+                                 STREAM_BATCH_DATA,
+                                 static_cast<uint32_t>(offset),
+                                 static_cast<uint32_t>(nread));
+    return;
+  }
+
   stream->CallJSOnreadMethod(nread, ab, offset);
 }
 
+void Http2Session::AddStreamBatchEntry(Http2Stream* stream,
+                                       uint32_t type,
+                                       uint32_t arg0,
+                                       uint32_t arg1,
+                                       uint32_t arg2) {
+  DCHECK(is_batching_stream_events());
+  if (stream_batch_count_ == kStreamBatchMaxEntries)
+    FlushStreamBatch();
+
+  // Consecutive events commonly belong to the same stream, so only add the
+  // stream to the list when it differs from the previous entry's.
+  if (stream_batch_streams_.empty() ||
+      stream_batch_streams_.back().get() != stream) {
+    stream_batch_streams_.emplace_back(stream);
+  }
+
+  size_t base = stream_batch_count_++ * IDX_STREAM_BATCH_FIELD_COUNT;
+  stream_batch_[base + IDX_STREAM_BATCH_TYPE] = type;
+  stream_batch_[base + IDX_STREAM_BATCH_STREAM] =
+      static_cast<uint32_t>(stream_batch_streams_.size() - 1);
+  stream_batch_[base + IDX_STREAM_BATCH_ARG0] = arg0;
+  stream_batch_[base + IDX_STREAM_BATCH_ARG1] = arg1;
+  stream_batch_[base + IDX_STREAM_BATCH_ARG2] = arg2;
+}
+
+uint32_t Http2Session::AddStreamBatchValue(Local<Value> value) {
+  // Values are added before the entry that refers to them, so make room for
+  // that entry now; a flush afterwards would invalidate the index.
+  if (stream_batch_count_ == kStreamBatchMaxEntries)
+    FlushStreamBatch();
+  stream_batch_values_.emplace_back(env()->isolate(), value);
+  return static_cast<uint32_t>(stream_batch_values_.size() - 1);
+}
+
+// Passes all pending stream events to JS as
+// onStreamBatch(count, streams, values, buffer), where the first count
+// entries of the session's streamBatch array describe the events.
+void Http2Session::FlushStreamBatch() {
+  if (stream_batch_count_ == 0 || is_flushing_stream_batch())
+    return;
+
+  Isolate* isolate = env()->isolate();
+  HandleScope scope(isolate);
+  Local<Context> context = env()->context();
+  Context::Scope context_scope(context);
+
+  MaybeStackBuffer<Local<Value>, 32> streams(stream_batch_streams_.size());
+  for (size_t i = 0; i < stream_batch_streams_.size(); i++)
+    streams[i] = stream_batch_streams_[i]->object();
+  MaybeStackBuffer<Local<Value>, 32> values(stream_batch_values_.size());
+  for (size_t i = 0; i < stream_batch_values_.size(); i++)
+    values[i] = stream_batch_values_[i].Get(isolate);
+
+  Local<Value> buffer;
+  if (!stream_buf_ab_.IsEmpty())
+    buffer = PersistentToLocal::Strong(stream_buf_ab_);
+  else
+    buffer = Undefined(isolate);
+
+  Local<Value> args[] = {
+    Integer::NewFromUnsigned(isolate, stream_batch_count_),
+    Array::New(isolate, streams.out(), streams.length()),
+    Array::New(isolate, values.out(), values.length()),
+    buffer,
+  };
+
+  // Keep the streams alive until JS has seen them, but start a new batch
+  // right away so anything nghttp2 produces from now on is not lost.
+  std::vector<BaseObjectPtr<Http2Stream>> batch_streams;
+  batch_streams.swap(stream_batch_streams_);
+  stream_batch_values_.clear();
+  stream_batch_count_ = 0;
+
+  // Events that occur while JS is reading the table are delivered directly.
+  set_flushing_stream_batch();
+  AsyncWrap::MakeCallback(env()->http2session_on_stream_batch_function(),
+                          arraysize(args), args);
+  set_flushing_stream_batch(false);
+}
+
+MaybeLocal<Value> Http2Session::MakeCallback(const Local<Function> cb,
+                                             int argc,
+                                             Local<Value>* argv) {
+  FlushStreamBatch();
+  return AsyncWrap::MakeCallback(cb, argc, argv);
+}
+
 
 // Called by OnFrameReceived to notify JavaScript land that a complete
 // HEADERS frame has been received and processed. This method converts the
@@ -1460,6 +1622,19 @@ void Http2Session::HandleHeadersFrame(const nghttp2_frame* frame) {
   DecrementCurrentSessionMemory(stream->current_headers_length_);
   stream->current_headers_length_ = 0;
 
+  if (is_batching_stream_events()) {
+    uint32_t index = AddStreamBatchValue(
+        Array::New(isolate, headers_v.out(), headers_v.length()));
+    AddStreamBatchValue(
+        Array::New(isolate, sensitive_v.out(), sensitive_count));
+    AddStreamBatchEntry(stream.get(),
+                        STREAM_BATCH_HEADERS,
+                        stream->headers_category(),
+                        frame->hd.flags,
+                        index);
+    return;
+  }
+
   Local<Value> args[] = {
     stream->object(),
     Integer::New(isolate, id),
@@ -1610,6 +1785,9 @@ void Http2Session::HandlePingFrame(const nghttp2_frame* frame) {
   Local<Value> arg;
   bool ack = frame->hd.flags & NGHTTP2_FLAG_ACK;
   if (ack) {
+    if (is_auto_tuning_window() && HandleBdpPingAck(frame))
+      return;
+
     BaseObjectPtr<Http2Ping> ping = PopPing();
 
     if (!ping) {
@@ -1636,6 +1814,124 @@ void Http2Session::HandlePingFrame(const nghttp2_frame* frame) {
   MakeCallback(env()->http2session_on_ping_function(), 1, &arg);
 }
 
+size_t GatherOutgoingBuffers(const std::vector<NgHttp2StreamWrite>& writes,
+                             uint8_t* storage,
+                             uv_buf_t* bufs) {
+  size_t offset = 0;
+  size_t count = 0;
+  bool last_was_copied = false;
+  for (const NgHttp2StreamWrite& write : writes) {
+    if (write.buf.base == nullptr) {
+      if (write.buf.len == 0) continue;
+      if (last_was_copied) {
+        bufs[count - 1].len += write.buf.len;
+      } else {
+        bufs[count++] = uv_buf_init(reinterpret_cast<char*>(storage + offset),
+                                    write.buf.len);
+      }
+      offset += write.buf.len;
+      last_was_copied = true;
+    } else {
+      bufs[count++] = write.buf;
+      last_was_copied = false;
+    }
+  }
+  return count;
+}
+
+bool BdpEstimator::OnData(size_t length, uint64_t now) {
+  if (ping_outstanding_) {
+    bytes_ += length;
+    return false;
+  }
+  return now >= next_ping_;
+}
+
+void BdpEstimator::PingSent(size_t length, uint64_t now, size_t pings_ahead) {
+  ping_outstanding_ = true;
+  ping_start_ = now;
+  bytes_ = length;
+  pings_ahead_ = pings_ahead;
+}
+
+bool BdpEstimator::OnPingAck(const uint8_t* payload,
+                             uint64_t now,
+                             bool* grown) {
+  *grown = false;
+  if (!ping_outstanding_) return false;
+  if (pings_ahead_ > 0) {
+    pings_ahead_--;
+    return false;
+  }
+  if (memcmp(payload, kBdpPingPayload, sizeof(kBdpPingPayload)) != 0)
+    return false;
+  ping_outstanding_ = false;
+
+  // The window is only assumed to be the bottleneck if the peer filled most
+  // of it within one round trip, and only as long as growing it still
+  // raises the bandwidth.
+  uint64_t rtt = std::max<uint64_t>(now - ping_start_, 1);
+  double bandwidth = static_cast<double>(bytes_) / rtt;
+  if (bytes_ * 3 >= uint64_t{estimate_} * 2 && bandwidth > max_bandwidth_) {
+    max_bandwidth_ = bandwidth;
+    uint64_t target = std::min(bytes_ * 2, max_window_);
+    if (target > estimate_) {
+      estimate_ = static_cast<uint32_t>(target);
+      *grown = true;
+    }
+  }
+
+  if (*grown) {
+    backoff_ = 0;
+  } else {
+    // The estimate is stable, so measure less often.
+    backoff_ =
+        std::clamp(backoff_ * 2, kBdpPingMinBackoffNs, kBdpPingMaxBackoffNs);
+  }
+  next_ping_ = now + backoff_;
+  return true;
+}
+
+// Called for every chunk of DATA received while windows are auto-tuned.
+void Http2Session::SampleBdp(size_t length) {
+  uint64_t now = uv_hrtime();
+  if (!bdp_->OnData(length, now))
+    return;
+  if (nghttp2_submit_ping(session_.get(), NGHTTP2_FLAG_NONE, kBdpPingPayload))
+    return;
+  Debug(this, "sending BDP ping");
+  bdp_->PingSent(length, now, outstanding_pings_.size());
+}
+
+bool Http2Session::HandleBdpPingAck(const nghttp2_frame* frame) {
+  bool grown;
+  if (!bdp_->OnPingAck(frame->ping.opaque_data, uv_hrtime(), &grown))
+    return false;
+  uint32_t estimate = bdp_->estimate();
+  Debug(this, "BDP ping acknowledged, window estimate %u", estimate);
+  nghttp2_session* session = session_.get();
+  if (grown &&
+      nghttp2_session_get_effective_local_window_size(session) <
+          static_cast<int32_t>(estimate)) {
+    nghttp2_session_set_local_window_size(
+        session, NGHTTP2_FLAG_NONE, 0, estimate);
+  }
+  return true;
+}
+
+void Http2Session::GrowStreamWindow(int32_t id) {
+  nghttp2_session* session = session_.get();
+  int32_t window =
+      nghttp2_session_get_stream_effective_local_window_size(session, id);
+  uint32_t estimate = bdp_->estimate();
+  if (window < 0 || window >= static_cast<int32_t>(estimate) ||
+      !has_available_session_memory(estimate - window)) {
+    return;
+  }
+  nghttp2_session_set_local_window_size(
+      session, NGHTTP2_FLAG_NONE, id, estimate);
+}
+
 // Called by OnFrameReceived when a complete SETTINGS frame has been received.
 void Http2Session::HandleSettingsFrame(const nghttp2_frame* frame) {
   bool ack = frame->hd.flags & NGHTTP2_FLAG_ACK;
@@ -1883,29 +2179,22 @@ uint8_t Http2Session::SendPendingData() {
 
   // Part Two: Pass Data to the underlying stream
 
-  size_t count = outgoing_buffers_.size();
-  if (count == 0) {
+  if (outgoing_buffers_.empty()) {
     ClearOutgoing(0);
     return 0;
   }
   MaybeStackBuffer<uv_buf_t, 32> bufs;
-  bufs.AllocateSufficientStorage(count);
+  bufs.AllocateSufficientStorage(outgoing_buffers_.size());
 
   // Set the buffer base pointers for copied data that ended up in the
   // sessions's own storage since it might have shifted around during gathering.
-  // (Those are marked by having .base == nullptr.)
-  size_t offset = 0;
-  size_t i = 0;
-  for (const NgHttp2StreamWrite& write : outgoing_buffers_) {
+  for (const NgHttp2StreamWrite& write : outgoing_buffers_)
     statistics_.data_sent += write.buf.len;
-    if (write.buf.base == nullptr) {
-      bufs[i++] = uv_buf_init(
-          reinterpret_cast<char*>(outgoing_storage_.data() + offset),
-          write.buf.len);
-      offset += write.buf.len;
-    } else {
-      bufs[i++] = write.buf;
-    }
+  size_t count = GatherOutgoingBuffers(
+      outgoing_buffers_, outgoing_storage_.data(), *bufs);
+  if (count == 0) {
+    ClearOutgoing(0);
+    return 0;
   }
 
   chunks_sent_since_last_write_++;
@@ -1957,15 +2246,30 @@ int Http2Session::OnSendData(
     if (write.buf.len <= length) {
       // This write does not suffice by itself, so we can consume it completely.
       length -= write.buf.len;
-      session->PushOutgoingBuffer(std::move(write));
+      if (write.buf.len <= kMaxCopiedDataLength) {
+        // Keep the write request, but with no data of its own, so that it
+        // is still completed once the copy has been written.
+        session->CopyDataIntoOutgoing(
+            reinterpret_cast<const uint8_t*>(write.buf.base), write.buf.len);
+        session->PushOutgoingBuffer(NgHttp2StreamWrite {
+          std::move(write.req_wrap), uv_buf_init(nullptr, 0)
+        });
+      } else {
+        session->PushOutgoingBuffer(std::move(write));
+      }
       stream->queue_.pop();
       continue;
     }
 
     // Slice off `length` bytes of the first write in the queue.
-    session->PushOutgoingBuffer(NgHttp2StreamWrite {
-      uv_buf_init(write.buf.base, length)
-    });
+    if (length <= kMaxCopiedDataLength) {
+      session->CopyDataIntoOutgoing(
+          reinterpret_cast<const uint8_t*>(write.buf.base), length);
+    } else {
+      session->PushOutgoingBuffer(NgHttp2StreamWrite {
+        uv_buf_init(write.buf.base, length)
+      });
+    }
     write.buf.base += length;
     write.buf.len -= length;
     break;
@@ -2031,12 +2335,9 @@ void Http2Session::OnStreamRead(ssize_t nread, const uv_buf_t& buf_) {
 
   if (LIKELY(stream_buf_offset_ == 0 &&
              static_cast<size_t>(nread) != bs->ByteLength())) {
-    // Shrink to the actual amount of used data.
-    std::unique_ptr<BackingStore> old_bs = std::move(bs);
-    bs = ArrayBuffer::NewBackingStore(env()->isolate(), nread);
-    memcpy(static_cast<char*>(bs->Data()),
-           static_cast<char*>(old_bs->Data()),
-           nread);
+    // Shrink to the actual amount of used data. The allocator can usually
+    // do that in place, without copying what was read.
+    bs = BackingStore::Reallocate(env()->isolate(), std::move(bs), nread);
   } else {
     // This is a very unlikely case, and should only happen if the ReadStart()
     // call in OnStreamAfterWrite() immediately provides data. If that does
@@ -2162,7 +2463,8 @@ Http2Stream::Http2Stream(Http2Session* session,
   if (max_header_pairs_ == 0) {
     max_header_pairs_ = DEFAULT_MAX_HEADER_LIST_PAIRS;
   }
-  current_headers_.reserve(std::min(max_header_pairs_, 12u));
+  if (!session->TakeRecycledHeaders(&current_headers_))
+    current_headers_.reserve(std::min(max_header_pairs_, 12u));
 
   // Limit the number of header octets
   max_header_length_ =
@@ -2258,6 +2560,12 @@ void Http2Stream::Destroy() {
 
   Debug(this, "destroying stream");
 
+  // Destroyed streams do not take headers anymore, so their buffer can be
+  // used by the next stream of the session.
+  session_->DecrementCurrentSessionMemory(current_headers_length_);
+  current_headers_length_ = 0;
+  session_->RecycleHeaders(std::move(current_headers_));
+
   // Wait until the start of the next loop to delete because there
   // may still be some pending operations queued for this stream.
   BaseObjectPtr<Http2Stream> strong_ref = session_->RemoveStream(id_);
@@ -2342,6 +2650,7 @@ void Http2Stream::OnTrailers() {
   Local<Context> context = env()->context();
   Context::Scope context_scope(context);
   set_has_trailers(false);
+  session()->FlushStreamBatch();
   MakeCallback(env()->http2session_on_stream_trailers_function(), 0, nullptr);
 }
 
@@ -3264,7 +3573,7 @@ void NgHttp2StreamWrite::MemoryInfo(MemoryTracker* tracker) const {
 
 void SetCallbackFunctions(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
-  CHECK_EQ(args.Length(), 11);
+  CHECK(args.Length() == 11 || args.Length() == 12);
 
 #define SET_FUNCTION(arg, name)                                               \
   CHECK(args[arg]->IsFunction());                                             \
@@ -3282,6 +3591,10 @@ void SetCallbackFunctions(const FunctionCallbackInfo<Value>& args) {
   SET_FUNCTION(9, stream_trailers)
   SET_FUNCTION(10, stream_close)
 
+  // Batched stream event delivery is optional; see kSessionBatchStreamEvents.
+  if (args.Length() > 11)
+    SET_FUNCTION(11, stream_batch)
+
 #undef SET_FUNCTION
 }
 
@@ -3340,6 +3653,17 @@ void Initialize(Local<Object> target,
   NODE_DEFINE_CONSTANT(target, kSessionRemoteSettingsIsUpToDate);
   NODE_DEFINE_CONSTANT(target, kSessionHasPingListeners);
   NODE_DEFINE_CONSTANT(target, kSessionHasAltsvcListeners);
+  NODE_DEFINE_CONSTANT(target, kSessionBatchStreamEvents);
+
+  NODE_DEFINE_CONSTANT(target, IDX_STREAM_BATCH_TYPE);
+  NODE_DEFINE_CONSTANT(target, IDX_STREAM_BATCH_STREAM);
+  NODE_DEFINE_CONSTANT(target, IDX_STREAM_BATCH_ARG0);
+  NODE_DEFINE_CONSTANT(target, IDX_STREAM_BATCH_ARG1);
+  NODE_DEFINE_CONSTANT(target, IDX_STREAM_BATCH_ARG2);
+  NODE_DEFINE_CONSTANT(target, IDX_STREAM_BATCH_FIELD_COUNT);
+  NODE_DEFINE_CONSTANT(target, STREAM_BATCH_DATA);
+  NODE_DEFINE_CONSTANT(target, STREAM_BATCH_EOF);
+  NODE_DEFINE_CONSTANT(target, STREAM_BATCH_HEADERS);
 
   // Method to fetch the nghttp2 string description of an nghttp2 error code
   SetMethod(context, target, "nghttp2ErrorString", HttpErrorString);
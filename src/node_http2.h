@@ -39,6 +39,17 @@ constexpr size_t kDefaultMaxSettings = 10;
 // Default maximum total memory cap for Http2Session.
 constexpr uint64_t kDefaultMaxSessionMemory = 10000000;
 
+// DATA payloads up to this size are copied next to their frame header rather
+// than written from the stream's buffers, so that the small frames of many
+// streams go out to the socket as one buffer.
+constexpr size_t kMaxCopiedDataLength = 1024;
+
+// The opaque data of the PINGs that measure the bandwidth-delay product when
+// receive windows are auto-tuned, and the bounds of the delay between them.
+constexpr uint8_t kBdpPingPayload[8] = {'n', 'o', 'd', 'e', '-', 'b', 'd', 'p'};
+constexpr uint64_t kBdpPingMinBackoffNs = 100 * 1000 * 1000;
+constexpr uint64_t kBdpPingMaxBackoffNs = 10ull * 1000 * 1000 * 1000;
+
 // These are the standard HTTP/2 defaults as specified by the RFC
 constexpr uint32_t DEFAULT_SETTINGS_HEADER_TABLE_SIZE = 4096;
 constexpr uint32_t DEFAULT_SETTINGS_ENABLE_PUSH = 1;
@@ -76,6 +87,17 @@ constexpr int kSessionStateSending = 0x10;
 constexpr int kSessionStateWriteInProgress = 0x20;
 constexpr int kSessionStateReadingStopped = 0x40;
 constexpr int kSessionStateReceivePaused = 0x80;
+constexpr int kSessionStateBatchingStreamEvents = 0x100;
+constexpr int kSessionStateFlushingStreamBatch = 0x200;
+
+// The maximum number of stream events that are gathered before they are
+// flushed out to JS.
+constexpr size_t kStreamBatchMaxEntries = 256;
+
+// The maximum number of header buffers of destroyed streams that a session
+// keeps for the streams it opens next, and the largest of them it keeps.
+constexpr size_t kMaxRecycledStreamHeaders = 64;
+constexpr size_t kMaxRecycledStreamHeadersCapacity = 128;
 
 // The Padding Strategy determines the method by which extra padding is
 // selected for HEADERS and DATA frames. These are configurable via the
@@ -234,15 +256,72 @@ class Http2Options {
     return max_session_memory_;
   }
 
+  void set_max_auto_window_size(uint32_t max) {
+    max_auto_window_size_ = max;
+  }
+
+  uint32_t max_auto_window_size() const {
+    return max_auto_window_size_;
+  }
+
  private:
   Nghttp2OptionPointer options_;
   uint64_t max_session_memory_ = kDefaultMaxSessionMemory;
+  uint32_t max_auto_window_size_ = 0;
   uint32_t max_header_pairs_ = DEFAULT_MAX_HEADER_LIST_PAIRS;
   PaddingStrategy padding_strategy_ = PADDING_STRATEGY_NONE;
   size_t max_outstanding_pings_ = kDefaultMaxPings;
   size_t max_outstanding_settings_ = kDefaultMaxSettings;
 };
 
+// Fills `bufs` with the buffers to write for `writes`, and returns how many
+// there are, at most one for each write. Writes with a nullptr base were
+// copied into `storage`, one after the other. Consecutive copies are written
+// as a single buffer, so that e.g. the HEADERS, WINDOW_UPDATE and small DATA
+// frames of many streams do not need one buffer each. Writes without data
+// only carry a write request and get no buffer.
+size_t GatherOutgoingBuffers(const std::vector<NgHttp2StreamWrite>& writes,
+                             uint8_t* storage,
+                             uv_buf_t* bufs);
+
+// Estimates the bandwidth-delay product of a session to auto-tune its
+// receive windows, the way gRPC does. While DATA is received, a PING is sent
+// and the bytes that arrive until its ACK are counted. If the peer filled
+// at least two thirds of the current estimate in that round trip, and
+// bandwidth went up, the estimate becomes twice the sample, up to
+// `max_window`. While the estimate is stable, the delay between PINGs backs
+// off from 100ms to 10s.
+class BdpEstimator {
+ public:
+  explicit BdpEstimator(uint64_t max_window) : max_window_(max_window) {}
+
+  uint32_t estimate() const { return estimate_; }
+
+  // Called for every chunk of DATA that is received. Returns true if a PING
+  // should be sent, in which case PingSent() is called once it is.
+  bool OnData(size_t length, uint64_t now);
+  // `pings_ahead` is the number of other PINGs that were sent before and
+  // still wait for their ACK.
+  void PingSent(size_t length, uint64_t now, size_t pings_ahead);
+  // Called for every PING ACK, before it is matched against the other
+  // PINGs. ACKs come in the order of the PINGs, so an ACK is only the one
+  // of the BDP PING once the PINGs sent before it are acknowledged, even if
+  // they carry the same payload. Returns whether it is, and sets `*grown` to
+  // whether the estimate grew.
+  bool OnPingAck(const uint8_t* payload, uint64_t now, bool* grown);
+
+ private:
+  const uint64_t max_window_;
+  uint32_t estimate_ = NGHTTP2_INITIAL_WINDOW_SIZE;
+  uint64_t bytes_ = 0;
+  uint64_t ping_start_ = 0;
+  uint64_t next_ping_ = 0;
+  uint64_t backoff_ = 0;
+  double max_bandwidth_ = 0;
+  size_t pings_ahead_ = 0;
+  bool ping_outstanding_ = false;
+};
+
 struct Http2Priority : public nghttp2_priority_spec {
   Http2Priority(Environment* env,
                 v8::Local<v8::Value> parent,
@@ -267,6 +346,28 @@ struct Http2HeaderTraits {
 
 using Http2Header = NgHeader<Http2HeaderTraits>;
 
+// The header buffers of the destroyed streams of a session, which the
+// streams it opens next reuse rather than allocate their own. At most
+// kMaxRecycledStreamHeaders are kept, and only those that did not grow past
+// kMaxRecycledStreamHeadersCapacity, so that the pool does not hold on to
+// the buffers of unusually large header blocks.
+class RecycledHeaders {
+ public:
+  // Moves a buffer into `headers` and returns true, or returns false if
+  // there is none.
+  bool Take(std::vector<Http2Header>* headers);
+  void Recycle(std::vector<Http2Header> headers);
+
+  size_t size() const { return buffers_.size(); }
+  size_t memory_size() const {
+    return buffers_.size() * kMaxRecycledStreamHeadersCapacity *
+           sizeof(Http2Header);
+  }
+
+ private:
+  std::vector<std::vector<Http2Header>> buffers_;
+};
+
 class Http2Stream : public AsyncWrap,
                     public StreamBase {
  public:
@@ -566,7 +667,8 @@ enum SessionBitfieldFlags {
   kSessionHasRemoteSettingsListeners,
   kSessionRemoteSettingsIsUpToDate,
   kSessionHasPingListeners,
-  kSessionHasAltsvcListeners
+  kSessionHasAltsvcListeners,
+  kSessionBatchStreamEvents
 };
 
 class Http2Session : public AsyncWrap,
@@ -652,9 +754,33 @@ class Http2Session : public AsyncWrap,
   IS_FLAG(write_in_progress, kSessionStateWriteInProgress)
   IS_FLAG(reading_stopped, kSessionStateReadingStopped)
   IS_FLAG(receive_paused, kSessionStateReceivePaused)
+  IS_FLAG(flushing_stream_batch, kSessionStateFlushingStreamBatch)
 
 #undef IS_FLAG
 
+  // When JS sets kSessionBatchStreamEvents, the DATA, end-of-stream and
+  // HEADERS events produced while consuming one chunk of input are recorded
+  // in the session's stream batch table and delivered to JS with a single
+  // http2session_on_stream_batch_function call instead of one call each.
+  bool is_batching_stream_events() const {
+    return (flags_ & kSessionStateBatchingStreamEvents) &&
+           !is_flushing_stream_batch();
+  }
+  void AddStreamBatchEntry(Http2Stream* stream,
+                           uint32_t type,
+                           uint32_t arg0 = 0,
+                           uint32_t arg1 = 0,
+                           uint32_t arg2 = 0);
+  uint32_t AddStreamBatchValue(v8::Local<v8::Value> value);
+  void FlushStreamBatch();
+
+  // All other callbacks into JS flush the pending stream batch first so that
+  // JS observes events in the order in which nghttp2 produced them.
+  using AsyncWrap::MakeCallback;
+  v8::MaybeLocal<v8::Value> MakeCallback(const v8::Local<v8::Function> cb,
+                                         int argc,
+                                         v8::Local<v8::Value>* argv);
+
   // Schedule a write if nghttp2 indicates it wants to write to the socket.
   void MaybeScheduleWrite();
 
@@ -669,6 +795,15 @@ class Http2Session : public AsyncWrap,
   // Adds a stream instance to this session
   void AddStream(Http2Stream* stream);
 
+  // Lets short-lived streams reuse the header buffers of the streams that
+  // were destroyed before them rather than allocate their own.
+  bool TakeRecycledHeaders(std::vector<Http2Header>* headers) {
+    return recycled_headers_.Take(headers);
+  }
+  void RecycleHeaders(std::vector<Http2Header> headers) {
+    recycled_headers_.Recycle(std::move(headers));
+  }
+
   // Removes a stream instance from this session
   BaseObjectPtr<Http2Stream> RemoveStream(int32_t id);
 
@@ -739,6 +874,16 @@ class Http2Session : public AsyncWrap,
   BaseObjectPtr<Http2Settings> PopSettings();
   bool AddSettings(v8::Local<v8::Function> callback);
 
+  // Receive window auto-tuning, see BdpEstimator. The connection window and
+  // the windows of the streams that receive data are grown to the estimate,
+  // which is capped by the maxAutoWindowSize option and half of the session
+  // memory. Idle streams keep the window they were opened with.
+  bool is_auto_tuning_window() const { return bdp_ != nullptr; }
+  void SampleBdp(size_t length);
+  // Returns true if the ACK was the one of the BDP PING.
+  bool HandleBdpPingAck(const nghttp2_frame* frame);
+  void GrowStreamWindow(int32_t id);
+
   void IncrementCurrentSessionMemory(uint64_t amount) {
     current_session_memory_ += amount;
   }
@@ -890,6 +1035,12 @@ class Http2Session : public AsyncWrap,
   // JS-accessible numeric fields, as indexed by SessionUint8Fields.
   AliasedStruct<SessionJSFields> js_fields_;
 
+  // The pending stream event batch, as indexed by Http2StreamBatchIndex.
+  AliasedUint32Array stream_batch_;
+  size_t stream_batch_count_ = 0;
+  std::vector<BaseObjectPtr<Http2Stream>> stream_batch_streams_;
+  std::vector<v8::Global<v8::Value>> stream_batch_values_;
+
   // The session type: client or server
   SessionType session_type_;
 
@@ -904,6 +1055,7 @@ class Http2Session : public AsyncWrap,
 
   // The collection of active Http2Streams associated with this session
   std::unordered_map<int32_t, BaseObjectPtr<Http2Stream>> streams_;
+  RecycledHeaders recycled_headers_;
 
   int flags_ = kSessionStateNone;
 
@@ -926,6 +1078,9 @@ class Http2Session : public AsyncWrap,
   size_t max_outstanding_pings_ = kDefaultMaxPings;
   std::queue<BaseObjectPtr<Http2Ping>> outstanding_pings_;
 
+  // Only set if receive windows are auto-tuned.
+  std::unique_ptr<BdpEstimator> bdp_;
+
   size_t max_outstanding_settings_ = kDefaultMaxSettings;
   std::queue<BaseObjectPtr<Http2Settings>> outstanding_settings_;
 
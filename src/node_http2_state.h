@@ -47,6 +47,26 @@ namespace http2 {
     IDX_STREAM_STATE_COUNT
   };
 
+  // Layout of a single entry in an Http2Session's stream event batch table.
+  // For STREAM_BATCH_DATA, ARG0 and ARG1 are the offset and length of the
+  // data in the session's current read buffer. For STREAM_BATCH_HEADERS,
+  // ARG0 is the headers category, ARG1 the frame flags and ARG2 the index
+  // of the [headers, sensitive headers] pair in the batch's value list.
+  enum Http2StreamBatchIndex {
+    IDX_STREAM_BATCH_TYPE,
+    IDX_STREAM_BATCH_STREAM,
+    IDX_STREAM_BATCH_ARG0,
+    IDX_STREAM_BATCH_ARG1,
+    IDX_STREAM_BATCH_ARG2,
+    IDX_STREAM_BATCH_FIELD_COUNT
+  };
+
+  enum Http2StreamBatchType {
+    STREAM_BATCH_DATA,
+    STREAM_BATCH_EOF,
+    STREAM_BATCH_HEADERS
+  };
+
   enum Http2OptionsIndex {
     IDX_OPTIONS_MAX_DEFLATE_DYNAMIC_TABLE_SIZE,
     IDX_OPTIONS_MAX_RESERVED_REMOTE_STREAMS,
@@ -58,7 +78,9 @@ namespace http2 {
     IDX_OPTIONS_MAX_OUTSTANDING_SETTINGS,
     IDX_OPTIONS_MAX_SESSION_MEMORY,
     IDX_OPTIONS_MAX_SETTINGS,
-    IDX_OPTIONS_FLAGS
+    IDX_OPTIONS_FLAGS,
+    IDX_OPTIONS_MAX_AUTO_WINDOW_SIZE,
+    IDX_OPTIONS_COUNT
   };
 
   enum Http2StreamStatisticsIndex {
@@ -109,7 +131,7 @@ class Http2State : public BaseObject {
             root_buffer),
         options_buffer(realm->isolate(),
                        offsetof(http2_state_internal, options_buffer),
-                       IDX_OPTIONS_FLAGS + 1,
+                       IDX_OPTIONS_COUNT,
                        root_buffer),
         settings_buffer(
             realm->isolate(),
@@ -138,7 +160,7 @@ class Http2State : public BaseObject {
     double stream_state_buffer[IDX_STREAM_STATE_COUNT];
     double stream_stats_buffer[IDX_STREAM_STATS_COUNT];
     double session_stats_buffer[IDX_SESSION_STATS_COUNT];
-    uint32_t options_buffer[IDX_OPTIONS_FLAGS + 1];
+    uint32_t options_buffer[IDX_OPTIONS_COUNT];
     // first + 1: number of actual nghttp2 supported settings
     // second + 1: number of additional settings not supported by nghttp2
     // 2 * MAX_ADDITIONAL_SETTINGS: settings id and value for each
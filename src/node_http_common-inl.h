@@ -8,9 +8,81 @@
 #include "v8.h"
 
 #include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
 
 namespace node {
 
+v8::MaybeLocal<v8::String> GetCommonHttpHeaderString(
+    Environment* env, const uint8_t* data, size_t len) {
+  // HTTP/1 peers mostly spell header names in Title-Case rather than in
+  // the lower case used by HTTP/2 and HTTP/3, so keep that spelling of each
+  // known name around as well.
+  static const std::vector<std::string> title_case_names = [] {
+    std::vector<std::string> names = {
+#define V(name, value) value,
+      HTTP_KNOWN_HEADERS(V)
+#undef V
+    };
+    for (std::string& name : names) {
+      bool upper = true;
+      for (char& c : name) {
+        if (upper) c = ToUpper(c);
+        upper = c == '-';
+      }
+    }
+    return names;
+  }();
+
+  // Keys point at the string literals and at title_case_names, which are
+  // never modified, so the data() of a match is stable and can be used as
+  // the key into the per-isolate string map.
+  static const std::unordered_set<std::string_view> common_strings = [] {
+    std::unordered_set<std::string_view> strings = {
+#define V(name, value) value,
+      HTTP_KNOWN_HEADERS(V)
+#undef V
+#define V(value) value,
+      HTTP_COMMON_HEADER_STRINGS(V)
+#undef V
+    };
+    for (const std::string& name : title_case_names)
+      strings.emplace(name);
+    return strings;
+  }();
+  // The length of the longest entry, which makes it cheap to rule out most
+  // header values without hashing them. It is taken from the set itself,
+  // so that adding a longer entry does not silently make it unreachable.
+  static const size_t max_common_string_length = [] {
+    size_t max_length = 0;
+    for (std::string_view string : common_strings)
+      max_length = std::max(max_length, string.size());
+    return max_length;
+  }();
+
+  if (len == 0 || len > max_common_string_length) return {};
+  auto it = common_strings.find(
+      std::string_view(reinterpret_cast<const char*>(data), len));
+  if (it == common_strings.end()) return {};
+
+  v8::Eternal<v8::String>& eternal =
+      env->isolate_data()->static_str_map[it->data()];
+  if (eternal.IsEmpty()) {
+    v8::Local<v8::String> str;
+    if (!v8::String::NewFromOneByte(env->isolate(),
+                                    data,
+                                    v8::NewStringType::kInternalized,
+                                    len).ToLocal(&str)) {
+      return {};
+    }
+    eternal.Set(env->isolate(), str);
+    return str;
+  }
+  return eternal.Get(env->isolate());
+}
+
 template <typename T>
 NgHeaders<T>::NgHeaders(Environment* env, v8::Local<v8::Array> headers) {
   v8::Local<v8::Value> header_string =
@@ -100,8 +172,9 @@ bool NgHeader<T>::IsZeroLength(
   if (NgHeader<T>::rcbufferpointer_t::IsZeroLength(value))
     return true;
 
+  // A header that is known by its token always has a name.
   const char* header_name = T::ToHttpHeaderName(token);
-  return header_name != nullptr ||
+  return header_name == nullptr &&
       NgHeader<T>::rcbufferpointer_t::IsZeroLength(name);
 }
 
@@ -156,12 +229,18 @@ v8::MaybeLocal<v8::String> NgHeader<T>::GetName(
   const char* header_name = T::ToHttpHeaderName(token_);
 
   // If header_name is not nullptr, then it is a known header with
-  // a statically defined name. We can safely internalize it here.
+  // a statically defined name. We can safely internalize it here, which
+  // also makes it the same string as the one HTTP/2 gets for that name.
   if (header_name != nullptr) {
     auto& static_str_map = env_->isolate_data()->static_str_map;
-    v8::Eternal<v8::String> eternal = static_str_map[header_name];
+    v8::Eternal<v8::String>& eternal = static_str_map[header_name];
     if (eternal.IsEmpty()) {
-      v8::Local<v8::String> str = OneByteString(env_->isolate(), header_name);
+      v8::Local<v8::String> str =
+          v8::String::NewFromOneByte(
+              env_->isolate(),
+              reinterpret_cast<const uint8_t*>(header_name),
+              v8::NewStringType::kInternalized)
+              .ToLocalChecked();
       eternal.Set(env_->isolate(), str);
       return str;
     }
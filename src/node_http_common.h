@@ -115,6 +115,59 @@ class Environment;
   HTTP_REGULAR_HEADERS(V)                                                     \
   HTTP_ADDITIONAL_HEADERS(V)
 
+// Header names and values that are not part of the HPACK/QPACK static
+// tables (or are only there as names) but that show up on nearly every
+// request or response of common workloads, gRPC in particular. Rather than
+// creating a new external string for each occurrence, a single internalized
+// copy of each is kept per isolate.
+#define HTTP_COMMON_HEADER_STRINGS(V)                                         \
+  V("grpc-accept-encoding")                                                   \
+  V("grpc-encoding")                                                          \
+  V("grpc-message")                                                           \
+  V("grpc-status")                                                            \
+  V("grpc-timeout")                                                           \
+  V("0")                                                                      \
+  V("200")                                                                    \
+  V("204")                                                                    \
+  V("304")                                                                    \
+  V("400")                                                                    \
+  V("404")                                                                    \
+  V("500")                                                                    \
+  V("GET")                                                                    \
+  V("POST")                                                                   \
+  V("http")                                                                   \
+  V("https")                                                                  \
+  V("/")                                                                      \
+  V("*/*")                                                                    \
+  V("trailers")                                                               \
+  V("identity")                                                               \
+  V("gzip")                                                                   \
+  V("deflate")                                                                \
+  V("gzip, deflate")                                                          \
+  V("gzip, deflate, br")                                                      \
+  V("no-cache")                                                               \
+  V("no-store")                                                               \
+  V("keep-alive")                                                             \
+  V("close")                                                                  \
+  V("chunked")                                                                \
+  V("text/html")                                                              \
+  V("text/html; charset=utf-8")                                               \
+  V("text/plain")                                                             \
+  V("text/plain; charset=utf-8")                                              \
+  V("application/json")                                                       \
+  V("application/json; charset=utf-8")                                        \
+  V("application/octet-stream")                                               \
+  V("application/grpc")                                                       \
+  V("application/grpc+proto")                                                 \
+  V("application/grpc-web")                                                   \
+  V("application/grpc-web+proto")
+
+// Returns the per-isolate internalized copy of the given header name or value
+// if it is one of HTTP_KNOWN_HEADERS (in lower or Title-Case) or
+// HTTP_COMMON_HEADER_STRINGS, or an empty handle if it is not.
+inline v8::MaybeLocal<v8::String> GetCommonHttpHeaderString(
+    Environment* env, const uint8_t* data, size_t len);
+
 enum http_known_headers {
   HTTP_KNOWN_HEADER_MIN,
 #define V(name, value) HTTP_HEADER_##name,
@@ -429,6 +482,12 @@ class NgRcBufPointer : public MemoryRetainer {
         return v8::String::Empty(env->isolate());
       }
 
+      v8::Local<v8::String> common;
+      if (GetCommonHttpHeaderString(env, ptr.data(), len).ToLocal(&common)) {
+        ptr.reset();
+        return common;
+      }
+
       if (ptr.IsInternalizable() && len < 64) {
         v8::MaybeLocal<v8::String> ret = GetInternalizedString(env, ptr);
         ptr.reset();
@@ -508,6 +567,8 @@ class NgHeader final : public NgHeaderBase<typename T::allocator_t> {
   inline std::string value() const override;
   inline size_t length() const override;
   inline uint8_t flags() const override;
+  // -1 unless the header was identified by a token.
+  int32_t token() const { return token_; }
 
   void MemoryInfo(MemoryTracker* tracker) const override;
 
@@ -26,6 +26,7 @@
 #include "async_wrap-inl.h"
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
+#include "node_http_common-inl.h"
 #include "stream_base-inl.h"
 #include "v8.h"
 #include "llhttp.h"
@@ -50,6 +51,8 @@ namespace node {
 namespace {  // NOLINT(build/namespaces)
 
 using v8::Array;
+using v8::ArrayBuffer;
+using v8::BackingStore;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
@@ -57,6 +60,7 @@ using v8::Exception;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Global;
 using v8::HandleScope;
 using v8::Int32;
 using v8::Integer;
@@ -67,6 +71,7 @@ using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Uint32;
+using v8::Uint32Array;
 using v8::Undefined;
 using v8::Value;
 
@@ -77,10 +82,14 @@ const uint32_t kOnBody = 3;
 const uint32_t kOnMessageComplete = 4;
 const uint32_t kOnExecute = 5;
 const uint32_t kOnTimeout = 6;
+const uint32_t kOnBatch = 7;
 // Any more fields than this will be flushed into JS
 const size_t kMaxHeaderFieldsCount = 32;
 // Maximum size of chunk extensions
 const size_t kMaxChunkExtensionsSize = 16384;
+// Header strings at least this long that already live on the heap are
+// handed to V8 as external strings instead of being copied again
+const size_t kMinExternalHeaderLength = 256;
 
 const uint32_t kLenientNone = 0;
 const uint32_t kLenientHeaders = 1 << 0;
@@ -119,6 +128,26 @@ class BindingData : public BaseObject {
   SET_MEMORY_INFO_NAME(BindingData)
 };
 
+// Owns a heap copy made by StringPtr::Save() once it has been turned into a
+// JS string.
+class ExternalHeaderString : public String::ExternalOneByteStringResource {
+ public:
+  ExternalHeaderString(const char* data, size_t length)
+      : data_(data), length_(length) {}
+
+  ~ExternalHeaderString() override { delete[] data_; }
+
+  // Gives up ownership of the data again, e.g. if V8 rejected the string.
+  void Disown() { data_ = nullptr; }
+
+  const char* data() const override { return data_; }
+  size_t length() const override { return length_; }
+
+ private:
+  const char* data_;
+  size_t length_;
+};
+
 // helper class for the Parser
 struct StringPtr {
   StringPtr() {
@@ -177,19 +206,46 @@ struct StringPtr {
   }
 
 
-  Local<String> ToString(Environment* env) const {
-    if (size_ != 0)
-      return OneByteString(env->isolate(), str_, size_);
-    else
+  // Common header names and values are shared per isolate. Otherwise, a
+  // long string that has already been copied to the heap is given to V8
+  // as is, which also resets this StringPtr.
+  Local<String> ToString(Environment* env) {
+    if (size_ == 0)
       return String::Empty(env->isolate());
+
+    Local<String> str;
+    if (GetCommonHttpHeaderString(
+            env, reinterpret_cast<const uint8_t*>(str_), size_)
+            .ToLocal(&str)) {
+      return str;
+    }
+
+    if (on_heap_ && size_ >= kMinExternalHeaderLength) {
+      ExternalHeaderString* resource = new ExternalHeaderString(str_, size_);
+      if (String::NewExternalOneByte(env->isolate(), resource).ToLocal(&str)) {
+        on_heap_ = false;
+        str_ = nullptr;
+        size_ = 0;
+        return str;
+      }
+      resource->Disown();
+      delete resource;
+    }
+
+    return OneByteString(env->isolate(), str_, size_);
   }
 
 
   // Strip trailing OWS (SPC or HTAB) from string.
-  Local<String> ToTrimmedString(Environment* env) {
+  void Trim() {
     while (size_ > 0 && IsOWS(str_[size_ - 1])) {
       size_--;
     }
+  }
+
+
+  Local<String> ToTrimmedString(Environment* env) {
+    Trim();
     return ToString(env);
   }
 
@@ -283,6 +339,11 @@ class Parser : public AsyncWrap, public StreamListener {
       connectionsList_->PushActive(this);
     }
 
+    if (is_batching()) {
+      AddBatchEvent(kOnMessageBegin, Undefined(env()->isolate()));
+      return 0;
+    }
+
     Local<Value> cb = object()->Get(env()->context(), kOnMessageBegin)
                               .ToLocalChecked();
     if (cb->IsFunction()) {
@@ -439,6 +500,20 @@ class Parser : public AsyncWrap, public StreamListener {
 
     argv[A_UPGRADE] = Boolean::New(env()->isolate(), parser_.upgrade);
 
+    // An upgrade or CONNECT stops parsing depending on what JS returns, so
+    // everything gathered up to here is delivered and the rest of the call
+    // goes to JS directly.
+    if (is_batching()) {
+      if (!parser_.upgrade) {
+        AddBatchEvent(kOnHeadersComplete,
+                      Array::New(env()->isolate(), argv, arraysize(argv)));
+        return 0;
+      }
+      FlushBatch();
+      if (got_exception_)
+        return -1;
+    }
+
     MaybeLocal<Value> head_response;
     {
       InternalCallbackScope callback_scope(
@@ -468,6 +543,11 @@ class Parser : public AsyncWrap, public StreamListener {
     Environment* env = this->env();
     HandleScope handle_scope(env->isolate());
 
+    if (is_batching()) {
+      AddBatchEvent(kOnBody, Buffer::Copy(env, at, length).ToLocalChecked());
+      return 0;
+    }
+
     Local<Value> cb = object()->Get(env->context(), kOnBody).ToLocalChecked();
 
     if (!cb->IsFunction())
@@ -506,6 +586,11 @@ class Parser : public AsyncWrap, public StreamListener {
     if (num_fields_)
       Flush();  // Flush trailing HTTP headers.
 
+    if (is_batching()) {
+      AddBatchEvent(kOnMessageComplete, Undefined(env()->isolate()));
+      return 0;
+    }
+
     Local<Object> obj = object();
     Local<Value> cb = obj->Get(env()->context(),
                                kOnMessageComplete).ToLocalChecked();
@@ -633,6 +718,7 @@ class Parser : public AsyncWrap, public StreamListener {
     uint64_t max_http_header_size = 0;
     uint32_t lenient_flags = kLenientNone;
     ConnectionsList* connectionsList = nullptr;
+    bool raw_headers = false;
 
     CHECK(args[0]->IsInt32());
     CHECK(args[1]->IsObject());
@@ -656,6 +742,11 @@ class Parser : public AsyncWrap, public StreamListener {
       ASSIGN_OR_RETURN_UNWRAP(&connectionsList, args[4]);
     }
 
+    if (args.Length() > 5) {
+      CHECK(args[5]->IsBoolean());
+      raw_headers = args[5]->IsTrue();
+    }
+
     llhttp_type_t type =
         static_cast<llhttp_type_t>(args[0].As<Int32>()->Value());
 
@@ -673,6 +764,7 @@ class Parser : public AsyncWrap, public StreamListener {
     parser->set_provider_type(provider);
     parser->AsyncReset(args[1].As<Object>());
     parser->Init(type, max_http_header_size, lenient_flags);
+    parser->raw_headers_ = raw_headers;
 
     if (connectionsList != nullptr) {
       parser->connectionsList_ = connectionsList;
@@ -816,7 +908,10 @@ class Parser : public AsyncWrap, public StreamListener {
     current_buffer_len_ = nread;
     current_buffer_data_ = buf.base;
 
-    MakeCallback(cb.As<Function>(), 1, &ret);
+    {
+      BatchTaskQueuesScope batch_scope(this);
+      MakeCallback(cb.As<Function>(), 1, &ret);
+    }
 
     current_buffer_len_ = 0;
     current_buffer_data_ = nullptr;
@@ -830,6 +925,16 @@ class Parser : public AsyncWrap, public StreamListener {
     current_buffer_data_ = data;
     got_exception_ = false;
 
+    // batch_ only lives as long as the outermost Execute() call.
+    const bool batch =
+        !is_batching() && parser_.type == HTTP_REQUEST &&
+        object()->Get(env()->context(), kOnBatch).ToLocalChecked()
+            ->IsFunction();
+    if (batch) {
+      batch_.Reset(env()->isolate(), Array::New(env()->isolate()));
+      batch_length_ = 0;
+    }
+
     llhttp_errno_t err;
 
     if (data == nullptr) {
@@ -839,6 +944,13 @@ class Parser : public AsyncWrap, public StreamListener {
       Save();
     }
 
+    if (batch) {
+      if (!got_exception_)
+        FlushBatch();
+      batch_.Reset();
+      batch_length_ = 0;
+    }
+
     // Calculate bytes read and resume after Upgrade/CONNECT pause
     size_t nread = len;
     if (err != HPE_OK) {
@@ -903,7 +1015,10 @@ class Parser : public AsyncWrap, public StreamListener {
     return scope.Escape(nread_obj);
   }
 
-  Local<Array> CreateHeaders() {
+  Local<Value> CreateHeaders() {
+    if (raw_headers_)
+      return CreateRawHeaders();
+
     // There could be extra entries but the max size should be fixed
     Local<Value> headers_v[kMaxHeaderFieldsCount * 2];
 
@@ -915,11 +1030,67 @@ class Parser : public AsyncWrap, public StreamListener {
     return Array::New(env()->isolate(), headers_v, num_values_ * 2);
   }
 
+  // In raw headers mode JS receives [offsets, data] instead of an array of
+  // strings, and only creates strings for the headers it actually looks at.
+  // offsets is a Uint32Array holding the name offset, name length, value
+  // offset and value length of each header within the data Buffer. Both
+  // share a single ArrayBuffer.
+  Local<Array> CreateRawHeaders() {
+    Isolate* isolate = env()->isolate();
+    const size_t offsets_length = num_values_ * 4;
+    const size_t offsets_size = offsets_length * sizeof(uint32_t);
+    size_t data_size = 0;
+    for (size_t i = 0; i < num_values_; ++i) {
+      values_[i].Trim();
+      data_size += fields_[i].size_ + values_[i].size_;
+    }
+
+    std::unique_ptr<BackingStore> bs;
+    {
+      NoArrayBufferZeroFillScope no_zero_fill_scope(env()->isolate_data());
+      bs = ArrayBuffer::NewBackingStore(isolate, offsets_size + data_size);
+    }
+    uint32_t* offsets = static_cast<uint32_t*>(bs->Data());
+    char* data = static_cast<char*>(bs->Data()) + offsets_size;
+
+    size_t pos = 0;
+    auto append = [&](const StringPtr& str, uint32_t* slot) {
+      slot[0] = static_cast<uint32_t>(pos);
+      slot[1] = static_cast<uint32_t>(str.size_);
+      if (str.size_ > 0)
+        memcpy(data + pos, str.str_, str.size_);
+      pos += str.size_;
+    };
+    for (size_t i = 0; i < num_values_; ++i) {
+      append(fields_[i], offsets + i * 4);
+      append(values_[i], offsets + i * 4 + 2);
+    }
+
+    Local<ArrayBuffer> ab = ArrayBuffer::New(isolate, std::move(bs));
+    Local<Value> parts[] = {
+      Uint32Array::New(ab, 0, offsets_length),
+      Buffer::New(env(), ab, offsets_size, data_size).ToLocalChecked(),
+    };
+    return Array::New(isolate, parts, arraysize(parts));
+  }
+
 
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope(env()->isolate());
 
+    if (is_batching()) {
+      Local<Value> argv[2] = {
+        CreateHeaders(),
+        url_.ToString(env())
+      };
+      AddBatchEvent(kOnHeaders,
+                    Array::New(env()->isolate(), argv, arraysize(argv)));
+      url_.Reset();
+      have_flushed_ = true;
+      return;
+    }
+
     Local<Object> obj = object();
     Local<Value> cb = obj->Get(env()->context(), kOnHeaders).ToLocalChecked();
 
@@ -942,6 +1113,45 @@ class Parser : public AsyncWrap, public StreamListener {
     have_flushed_ = true;
   }
 
+  // When JS installs a kOnBatch callback on a request parser, the message
+  // callbacks for everything parsed by one Execute() call are not made one
+  // by one. Instead, the callback receives a single flat array of
+  // [kOnMessageBegin, undefined, kOnHeadersComplete, argv, kOnBody, buffer,
+  // kOnMessageComplete, undefined, ...] to replay, so deeply pipelined
+  // requests cost one call into JS per read. Response parsers are never
+  // batched because JS decides whether a response has a body.
+  bool is_batching() const { return !batch_.IsEmpty(); }
+
+  void AddBatchEvent(uint32_t kind, Local<Value> value) {
+    Local<Context> context = env()->context();
+    Isolate* isolate = env()->isolate();
+    Local<Array> batch = batch_.Get(isolate);
+    // Array::Set() only fails when an exception is pending.
+    if (batch->Set(context,
+                   batch_length_++,
+                   Integer::NewFromUnsigned(isolate, kind)).IsNothing() ||
+        batch->Set(context, batch_length_++, value).IsNothing()) {
+      got_exception_ = true;
+    }
+  }
+
+  void FlushBatch() {
+    if (batch_length_ == 0)
+      return;
+
+    Local<Value> cb =
+        object()->Get(env()->context(), kOnBatch).ToLocalChecked();
+    Local<Value> events = batch_.Get(env()->isolate());
+    batch_.Reset(env()->isolate(), Array::New(env()->isolate()));
+    batch_length_ = 0;
+
+    if (!cb->IsFunction())
+      return;
+
+    if (MakeCallback(cb.As<Function>(), 1, &events).IsEmpty())
+      got_exception_ = true;
+  }
+
 
   void Init(llhttp_type_t type, uint64_t max_http_header_size,
             uint32_t lenient_flags) {
@@ -1032,6 +1242,12 @@ class Parser : public AsyncWrap, public StreamListener {
   const char* current_buffer_data_;
   bool headers_completed_ = false;
   bool pending_pause_ = false;
+  bool raw_headers_ = false;
+  // Only set while the Execute() call that created it is on the stack. It
+  // is a Global because it is replaced from within the callbacks, whose
+  // HandleScopes are gone by the time the next event is added.
+  Global<Array> batch_;
+  uint32_t batch_length_ = 0;
   uint64_t header_nread_ = 0;
   uint64_t chunk_extensions_nread_ = 0;
   uint64_t max_http_header_size_;
@@ -1171,13 +1387,21 @@ void ConnectionsList::Expired(const FunctionCallbackInfo<Value>& args) {
     return args.GetReturnValue().Set(Array::New(isolate, 0));
   }
 
+  // active_connections_ is ordered by last_message_start_, so once a parser
+  // started its message after both deadlines, none of the ones after it can
+  // have expired either. Each call therefore only looks at the connections
+  // that are at least as old as the headers timeout, instead of all of them.
+  const uint64_t newest_deadline = std::max(headers_deadline,
+                                            request_deadline);
+
   auto iter = list->active_connections_.begin();
   auto end = list->active_connections_.end();
 
   std::vector<Local<Value>> result;
-  result.reserve(list->active_connections_.size());
   while (iter != end) {
     Parser* parser = *iter;
+    if (parser->last_message_start_ >= newest_deadline)
+      break;
     iter++;
 
     // Check for expiration.
@@ -1274,6 +1498,8 @@ void InitializeHttpParser(Local<Object> target,
          Integer::NewFromUnsigned(env->isolate(), kOnExecute));
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnTimeout"),
          Integer::NewFromUnsigned(env->isolate(), kOnTimeout));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnBatch"),
+         Integer::NewFromUnsigned(env->isolate(), kOnBatch));
 
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kLenientNone"),
          Integer::NewFromUnsigned(env->isolate(), kLenientNone));
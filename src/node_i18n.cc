@@ -70,6 +70,8 @@
 #include <unicode/uvernum.h>
 #include <unicode/uversion.h>
 
+#include <algorithm>
+
 #ifdef NODE_HAVE_SMALL_ICU
 /* if this is defined, we have a 'secondary' entry point.
    compare following to utypes.h defs for U_ICUDATA_ENTRY_POINT */
@@ -344,6 +346,26 @@ void Transcode(const FunctionCallbackInfo<Value>&args) {
   return args.GetReturnValue().Set(result.ToLocalChecked());
 }
 
+// The code points of the bytes 0x80 to 0x9F in windows-1252, as defined by
+// the WHATWG Encoding Standard. All other bytes decode as in Latin-1.
+constexpr uint16_t kWindows1252C1[] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178};
+
+inline bool IsWindows1252C1(unsigned char c) {
+  return c >= 0x80 && c < 0xA0;
+}
+
+// TextDecoders for "latin1", "ascii" and the other labels of windows-1252
+// all ask for the "windows-1252" converter. Every byte is a character in
+// that encoding, so decoding it cannot fail and leaves no state behind
+// between chunks, and it does not need ICU.
+bool IsWindows1252(const char* name) {
+  return StringEqualNoCase(name, "windows-1252");
+}
+
 void ICUErrorName(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   CHECK(args[0]->IsInt32());
@@ -355,6 +377,27 @@ void ICUErrorName(const FunctionCallbackInfo<Value>& args) {
 
 }  // anonymous namespace
 
+MaybeLocal<Value> DecodeWindows1252(Isolate* isolate,
+                                    const char* data,
+                                    size_t length,
+                                    Local<Value>* error) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  if (std::none_of(bytes, bytes + length, IsWindows1252C1))
+    return StringBytes::Encode(isolate, data, length, LATIN1, error);
+
+  MaybeStackBuffer<uint16_t> result(length);
+  for (size_t i = 0; i < length; i++) {
+    result[i] = IsWindows1252C1(bytes[i]) ? kWindows1252C1[bytes[i] - 0x80]
+                                          : bytes[i];
+  }
+  char* value = reinterpret_cast<char*>(result.out());
+  if constexpr (IsBigEndian()) {
+    SwapBytes16(value, length * sizeof(uint16_t));
+  }
+  return StringBytes::Encode(
+      isolate, value, length * sizeof(uint16_t), UCS2, error);
+}
+
 Converter::Converter(const char* name, const char* sub) {
   UErrorCode status = U_ZERO_ERROR;
   UConverter* conv = ucnv_open(name, &status);
@@ -368,10 +411,26 @@ Converter::Converter(UConverter* converter, const char* sub)
   set_subst_chars(sub);
 }
 
+ConverterPointer ConverterPool::Open(const char* name, UErrorCode* status) {
+  auto it = converters_.find(name);
+  if (it != converters_.end())
+    return ConverterPointer(ucnv_clone(it->second.get(), status));
+
+  ConverterPointer conv(ucnv_open(name, status));
+  if (U_FAILURE(*status) || converters_.size() >= kMaxConverters)
+    return conv;
+
+  UErrorCode clone_status = U_ZERO_ERROR;
+  ConverterPointer pooled(ucnv_clone(conv.get(), &clone_status));
+  if (U_SUCCESS(clone_status))
+    converters_.emplace(name, std::move(pooled));
+  return conv;
+}
+
 void Converter::set_subst_chars(const char* sub) {
-  CHECK(conv_);
   UErrorCode status = U_ZERO_ERROR;
   if (sub != nullptr) {
+    CHECK(conv_);
     ucnv_setSubstChars(conv_.get(), sub, strlen(sub), &status);
     CHECK(U_SUCCESS(status));
   }
@@ -398,7 +457,7 @@ void ConverterObject::Has(const FunctionCallbackInfo<Value>& args) {
   Utf8Value label(env->isolate(), args[0]);
 
   UErrorCode status = U_ZERO_ERROR;
-  ConverterPointer conv(ucnv_open(*label, &status));
+  ConverterPointer conv = env->converter_pool()->Open(*label, &status);
   args.GetReturnValue().Set(!!U_SUCCESS(status));
 }
 
@@ -415,8 +474,14 @@ void ConverterObject::Create(const FunctionCallbackInfo<Value>& args) {
   bool fatal =
       (flags & CONVERTER_FLAGS_FATAL) == CONVERTER_FLAGS_FATAL;
 
+  if (IsWindows1252(*label)) {
+    flags |= CONVERTER_FLAGS_WINDOWS_1252;
+    new ConverterObject(env, obj, nullptr, flags);
+    return args.GetReturnValue().Set(obj);
+  }
+
   UErrorCode status = U_ZERO_ERROR;
-  UConverter* conv = ucnv_open(*label, &status);
+  UConverter* conv = env->converter_pool()->Open(*label, &status).release();
   if (U_FAILURE(status))
     return;
 
@@ -456,6 +521,19 @@ void ConverterObject::Decode(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[3]->IsString());
   Local<String> from_encoding = args[3].As<String>();
 
+  if (converter->windows_1252()) {
+    Local<Value> error;
+    Local<Value> ret;
+    if (DecodeWindows1252(env->isolate(), input.data(), input.length(), &error)
+            .ToLocal(&ret)) {
+      return args.GetReturnValue().Set(ret);
+    }
+    return node::THROW_ERR_ENCODING_INVALID_ENCODED_DATA(
+        env->isolate(),
+        "The encoded data was not valid for encoding %s",
+        *node::Utf8Value(env->isolate(), from_encoding));
+  }
+
   UErrorCode status = U_ZERO_ERROR;
   MaybeStackBuffer<UChar> result;
 
@@ -558,6 +636,11 @@ ConverterObject::ConverterObject(
       flags_(flags) {
   MakeWeak();
 
+  if (converter == nullptr) {
+    CHECK(windows_1252());
+    return;
+  }
+
   switch (ucnv_getType(converter)) {
     case UCNV_UTF8:
     case UCNV_UTF16_BigEndian:
@@ -34,6 +34,7 @@
 #include <unicode/ucnv.h>
 
 #include <string>
+#include <unordered_map>
 
 namespace node {
 namespace i18n {
@@ -71,6 +72,29 @@ struct ConverterDeleter {
 };
 using ConverterPointer = std::unique_ptr<UConverter, ConverterDeleter>;
 
+// The converters that were opened in an Environment, by name. Opening a
+// converter resolves the name and sets up the tables for it, which is much
+// slower than cloning a converter that is already open.
+class ConverterPool {
+ public:
+  // Like ucnv_open(), but returns a clone of the converter that was opened
+  // for |name| before, if there is one.
+  ConverterPointer Open(const char* name, UErrorCode* status);
+
+ private:
+  static constexpr size_t kMaxConverters = 16;
+
+  // Converters that have not been used to convert anything, so that their
+  // clones start in the initial state.
+  std::unordered_map<std::string, ConverterPointer> converters_;
+};
+
+// Decodes windows-1252 without ICU. Every byte is a character of its own.
+v8::MaybeLocal<v8::Value> DecodeWindows1252(v8::Isolate* isolate,
+                                            const char* data,
+                                            size_t length,
+                                            v8::Local<v8::Value>* error);
+
 class Converter {
  public:
   explicit Converter(const char* name, const char* sub = nullptr);
@@ -95,6 +119,8 @@ class ConverterObject : public BaseObject, Converter {
     CONVERTER_FLAGS_IGNORE_BOM = 0x4,
     CONVERTER_FLAGS_UNICODE    = 0x8,
     CONVERTER_FLAGS_BOM_SEEN   = 0x10,
+    // Decoded without ICU, see DecodeWindows1252().
+    CONVERTER_FLAGS_WINDOWS_1252 = 0x20,
   };
 
   static void Create(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -131,6 +157,11 @@ class ConverterObject : public BaseObject, Converter {
     return (flags_ & CONVERTER_FLAGS_IGNORE_BOM) == CONVERTER_FLAGS_IGNORE_BOM;
   }
 
+  bool windows_1252() const {
+    return (flags_ & CONVERTER_FLAGS_WINDOWS_1252) ==
+           CONVERTER_FLAGS_WINDOWS_1252;
+  }
+
  private:
   int flags_ = 0;
 };
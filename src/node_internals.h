@@ -25,7 +25,9 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include "env.h"
+#include "large_pages/node_large_page.h"
 #include "node.h"
+#include "node_array_buffer_pool.h"
 #include "node_binding.h"
 #include "node_mutex.h"
 #include "tracing/trace_event.h"
@@ -36,6 +38,7 @@
 #include <cstdint>
 #include <cstdlib>
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -50,6 +53,9 @@ class BuiltinLoader;
 namespace per_process {
 extern Mutex env_var_mutex;
 extern uint64_t node_start_time;
+// Serializes the calls to umask(), which cannot read the mask without
+// setting it.
+extern Mutex umask_mutex;
 }  // namespace per_process
 
 // Forward declaration
@@ -118,6 +124,8 @@ v8::Maybe<bool> InitializePrimordials(v8::Local<v8::Context> context);
 
 class NodeArrayBufferAllocator : public ArrayBufferAllocator {
  public:
+  NodeArrayBufferAllocator();
+
   inline uint32_t* zero_fill_field() { return &zero_fill_field_; }
 
   void* Allocate(size_t size) override;  // Defined in src/node.cc
@@ -135,10 +143,21 @@ class NodeArrayBufferAllocator : public ArrayBufferAllocator {
   inline uint64_t total_mem_usage() const {
     return total_mem_usage_.load(std::memory_order_relaxed);
   }
+  // The pool from which mid-sized backing stores are allocated, or nullptr.
+  inline ArrayBufferPool* pool() const { return pool_; }
 
  private:
+  inline bool IsPooled(size_t size) const {
+    return pool_ != nullptr && ArrayBufferPool::IsPooledSize(size);
+  }
+
   uint32_t zero_fill_field_ = 1;  // Boolean but exposed as uint32 to JS land.
   std::atomic<size_t> total_mem_usage_ {0};
+  // Backing stores of at least this size go into large pages, see
+  // --use-largepages-heap.
+  const size_t large_page_threshold_ = large_pages::ArrayBufferThreshold();
+  // See --array-buffer-pool.
+  ArrayBufferPool* const pool_;
 
   // Delegate to V8's allocator for compatibility with the V8 memory cage.
   std::unique_ptr<v8::ArrayBuffer::Allocator> allocator_{
@@ -215,7 +234,8 @@ v8::MaybeLocal<v8::Value> InternalMakeCallback(
     const v8::Local<v8::Function> callback,
     int argc,
     v8::Local<v8::Value> argv[],
-    async_context asyncContext);
+    async_context asyncContext,
+    v8::Local<v8::Value> context_frame = v8::Local<v8::Value>());
 
 v8::MaybeLocal<v8::Value> MakeSyncCallback(v8::Isolate* isolate,
                                            v8::Local<v8::Object> recv,
@@ -233,12 +253,21 @@ class InternalCallbackScope {
     // This should only be used when there is no call into JS in this scope.
     // (The HTTP parser also uses it for some weird backwards
     // compatibility issues, but it shouldn't.)
-    kSkipTaskQueues = 2
+    kSkipTaskQueues = 2,
+    // With --experimental-batch-io-callbacks, run the nextTick and microtask
+    // queues once later in this event loop iteration rather than when this
+    // scope closes, so that a burst of I/O callbacks pays for them only once.
+    // Each callback still runs in its own async context.
+    kBatchTaskQueues = 4
   };
+  // If `context_frame` is not empty, it is the current async context frame
+  // until the scope is closed.
   InternalCallbackScope(Environment* env,
                         v8::Local<v8::Object> object,
                         const async_context& asyncContext,
-                        int flags = kNoFlags);
+                        int flags = kNoFlags,
+                        v8::Local<v8::Value> context_frame =
+                            v8::Local<v8::Value>());
   // Utility that can be used by AsyncWrap classes.
   explicit InternalCallbackScope(AsyncWrap* async_wrap, int flags = 0);
   ~InternalCallbackScope();
@@ -251,13 +280,26 @@ class InternalCallbackScope {
   Environment* env_;
   async_context async_context_;
   v8::Local<v8::Object> object_;
+  v8::Local<v8::Value> prior_context_frame_;
   bool skip_hooks_;
   bool skip_task_queues_;
+  bool batch_task_queues_;
   bool failed_ = false;
   bool pushed_ids_ = false;
   bool closed_ = false;
 };
 
+// Wraps one of a burst of I/O callbacks into a kBatchTaskQueues scope when
+// --experimental-batch-io-callbacks is set, and does nothing otherwise, so
+// that the callback takes the usual path.
+class BatchTaskQueuesScope {
+ public:
+  explicit BatchTaskQueuesScope(AsyncWrap* async_wrap);
+
+ private:
+  std::optional<InternalCallbackScope> scope_;
+};
+
 class DebugSealHandleScope {
  public:
   explicit inline DebugSealHandleScope(v8::Isolate* isolate = nullptr)
@@ -274,13 +316,21 @@ class DebugSealHandleScope {
 
 class ThreadPoolWork {
  public:
-  explicit inline ThreadPoolWork(Environment* env, const char* type)
-      : env_(env), type_(type) {
+  explicit inline ThreadPoolWork(
+      Environment* env,
+      const char* type,
+      ThreadPoolWorkKind kind = ThreadPoolWorkKind::kOther)
+      : env_(env), type_(type), kind_(kind) {
     CHECK_NOT_NULL(env);
   }
   inline virtual ~ThreadPoolWork() = default;
 
   inline void ScheduleWork();
+  // Does the work on the calling thread and finishes it from the next
+  // iteration of the event loop, as if it had been scheduled. This is for
+  // work that takes less time than a round trip through the threadpool.
+  // Work that is run inline cannot be canceled.
+  inline void RunInline();
   inline int CancelWork();
 
   virtual void DoThreadPoolWork() = 0;
@@ -288,10 +338,27 @@ class ThreadPoolWork {
 
   Environment* env() const { return env_; }
 
+  // Makes the next ScheduleWork() call submit the work through a named pool
+  // of the Environment instead of the queue of its kind, see
+  // Environment::threadpool_work_pool(). Must not be called while the work
+  // is scheduled.
+  void set_pool(ThreadPoolWorkQueue* pool) { pool_ = pool; }
+
+  // The maximum number of ThreadPoolWorks of |kind| an Environment has in the
+  // libuv threadpool at the same time, or 0 if there is no limit.
+  static inline size_t ConcurrencyLimit(ThreadPoolWorkKind kind);
+
  private:
+  inline ThreadPoolWorkQueue* queue() const;
+  inline void QueueWork();
+  inline void FinishWork(int status);
+
   Environment* env_;
   uv_work_t work_req_;
   const char* type_;
+  ThreadPoolWorkKind kind_;
+  ThreadPoolWorkQueue* pool_ = nullptr;
+  bool waiting_ = false;
 };
 
 #define TRACING_CATEGORY_NODE "node"
@@ -315,6 +382,34 @@ bool SafeGetenv(const char* key,
                 std::shared_ptr<KVStore> env_vars = nullptr);
 }  // namespace credentials
 
+namespace os {
+// Like uv_available_parallelism(), but also respects the CPU quota of the
+// cgroup of the process, which is how containers usually limit CPU usage.
+unsigned int GetAvailableParallelism();
+
+struct CPUTopology {
+  int cpu = -1;
+  // The lowest CPU that shares the core, i.e. the same for SMT siblings.
+  int core = -1;
+  int package = -1;
+  int numa_node = -1;
+  // The lowest CPU that shares the L3 cache.
+  int l3_cache = -1;
+};
+// Returns the online CPUs. Only Linux reports more than their numbers,
+// unknown fields are -1.
+std::vector<CPUTopology> GetCPUTopology();
+// Parses a list such as "0-3,8,10-11", as used by sysfs. Only numbers that
+// fit into a CPU affinity mask are accepted.
+bool ParseCPUList(std::string_view list, std::vector<int>* out);
+// These return 0 or a libuv error code.
+int SetThreadAffinity(uv_thread_t* thread, const std::vector<int>& cpus);
+int GetThreadAffinity(uv_thread_t* thread, std::vector<int>* cpus);
+// Makes the kernel prefer NUMA node |node| for the memory that the calling
+// thread touches first from now on. Only supported on Linux.
+int SetCurrentThreadMemoryNode(int node);
+}  // namespace os
+
 void DefineZlibConstants(v8::Local<v8::Object> target);
 v8::Isolate* NewIsolate(v8::Isolate::CreateParams* params,
                         uv_loop_t* event_loop,
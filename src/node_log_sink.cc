@@ -0,0 +1,354 @@
+#include "node_log_sink.h"
+
+#include "env-inl.h"
+#include "memory_tracker-inl.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "util-inl.h"
+
+#include <unordered_set>
+
+namespace node {
+namespace log_sink {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Int32;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Uint32;
+using v8::Value;
+
+namespace {
+
+constexpr uint32_t kMaxCapacity = 1 << 20;
+
+// The sinks that FlushAll() writes out. They are leaked on purpose, so that
+// a crash during exit can still use them.
+struct OpenSinks {
+  Mutex mutex;
+  std::unordered_set<LogSink*> sinks;
+};
+
+OpenSinks* GetOpenSinks() {
+  static OpenSinks* open_sinks = new OpenSinks();
+  return open_sinks;
+}
+
+}  // anonymous namespace
+
+LogSink::LogSink(int fd, size_t capacity, Policy policy)
+    : fd_(fd), policy_(policy), ring_(capacity) {}
+
+LogSink::~LogSink() {
+  Close();
+}
+
+bool LogSink::Start() {
+  CHECK(!started_);
+  if (uv_thread_create(&thread_, ThreadMain, this) != 0) return false;
+  started_ = true;
+  OpenSinks* open_sinks = GetOpenSinks();
+  Mutex::ScopedLock lock(open_sinks->mutex);
+  open_sinks->sinks.insert(this);
+  return true;
+}
+
+bool LogSink::Write(std::string record) {
+  if (closed_ || !started_ || error() != 0) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (record.empty()) return true;
+
+  if (!ring_.Push(std::move(record))) {
+    if (policy_ == kDrop) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    blocked_.fetch_add(1, std::memory_order_relaxed);
+    Mutex::ScopedLock lock(mutex_);
+    writer_blocked_.store(true, std::memory_order_relaxed);
+    // Pairs with the fence in Drain(): either the background thread sees
+    // `writer_blocked_`, or the retry sees the room that it has made.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!ring_.Push(std::move(record))) {
+      wake_.Signal(lock);
+      not_full_.Wait(lock);
+    }
+    writer_blocked_.store(false, std::memory_order_relaxed);
+  }
+
+  WakeThread();
+  return true;
+}
+
+void LogSink::WakeThread() {
+  // Pairs with the fence in ThreadMain(): either this sees that the thread
+  // is about to wait, or the thread sees the record that was just pushed.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!thread_idle_.load(std::memory_order_relaxed)) return;
+  Mutex::ScopedLock lock(mutex_);
+  wake_.Signal(lock);
+}
+
+void LogSink::Flush() {
+  Mutex::ScopedLock lock(drain_mutex_);
+  Drain();
+}
+
+void LogSink::Close() {
+  if (closed_) return;
+  closed_ = true;
+  if (!started_) return;
+
+  {
+    OpenSinks* open_sinks = GetOpenSinks();
+    Mutex::ScopedLock lock(open_sinks->mutex);
+    open_sinks->sinks.erase(this);
+  }
+  {
+    Mutex::ScopedLock lock(mutex_);
+    closing_ = true;
+    wake_.Signal(lock);
+  }
+  CHECK_EQ(uv_thread_join(&thread_), 0);
+  Flush();
+}
+
+LogSink::Stats LogSink::stats() const {
+  Stats stats;
+  stats.written = written_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.blocked = blocked_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void LogSink::FlushAll() {
+  OpenSinks* open_sinks = GetOpenSinks();
+  Mutex::ScopedLock lock(open_sinks->mutex);
+  for (LogSink* sink : open_sinks->sinks) sink->Flush();
+}
+
+void LogSink::ThreadMain(void* data) {
+  LogSink* sink = static_cast<LogSink*>(data);
+  while (true) {
+    {
+      Mutex::ScopedLock lock(sink->drain_mutex_);
+      sink->Drain();
+    }
+
+    Mutex::ScopedLock lock(sink->mutex_);
+    sink->thread_idle_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (sink->ring_.IsEmpty() && !sink->closing_) sink->wake_.Wait(lock);
+    sink->thread_idle_.store(false, std::memory_order_relaxed);
+    if (sink->closing_) break;
+  }
+}
+
+void LogSink::Drain() {
+  std::vector<std::string> batch;
+  batch.reserve(kMaxBatchRecords);
+  while (true) {
+    std::string record;
+    while (batch.size() < kMaxBatchRecords && ring_.Pop(&record))
+      batch.push_back(std::move(record));
+    if (batch.empty()) return;
+
+    // There is room in the buffer again.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writer_blocked_.load(std::memory_order_relaxed)) {
+      Mutex::ScopedLock lock(mutex_);
+      not_full_.Signal(lock);
+    }
+
+    WriteBatch(&batch);
+    batch.clear();
+  }
+}
+
+void LogSink::WriteBatch(std::vector<std::string>* batch) {
+  if (error() != 0) {
+    dropped_.fetch_add(batch->size(), std::memory_order_relaxed);
+    return;
+  }
+
+  std::vector<uv_buf_t> bufs;
+  bufs.reserve(batch->size());
+  for (std::string& record : *batch)
+    bufs.push_back(uv_buf_init(record.data(), record.size()));
+
+  size_t index = 0;
+  while (index < bufs.size()) {
+    uv_fs_t req;
+    int written = uv_fs_write(
+        nullptr, &req, fd_, &bufs[index], bufs.size() - index, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (written == UV_EAGAIN) {
+      // stdio pipes and TTYs may be non-blocking.
+      uv_sleep(1);
+      continue;
+    }
+    if (written < 0) {
+      error_.store(written, std::memory_order_relaxed);
+      dropped_.fetch_add(bufs.size() - index, std::memory_order_relaxed);
+      written_.fetch_add(index, std::memory_order_relaxed);
+      return;
+    }
+
+    // Skip what was written, which may end in the middle of a record.
+    size_t remaining = written;
+    while (index < bufs.size() && remaining >= bufs[index].len) {
+      remaining -= bufs[index].len;
+      index++;
+    }
+    if (remaining > 0) {
+      bufs[index].base += remaining;
+      bufs[index].len -= remaining;
+    }
+  }
+  written_.fetch_add(batch->size(), std::memory_order_relaxed);
+}
+
+LogSinkWrap::LogSinkWrap(Environment* env,
+                         Local<Object> wrap,
+                         std::unique_ptr<LogSink> sink)
+    : BaseObject(env, wrap), sink_(std::move(sink)) {
+  MakeWeak();
+}
+
+void LogSinkWrap::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("sink", sizeof(LogSink));
+}
+
+void LogSinkWrap::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsInt32());   // fd
+  CHECK(args[1]->IsUint32());  // capacity
+  CHECK(args[2]->IsInt32());   // policy
+
+  int fd = args[0].As<Int32>()->Value();
+  uint32_t capacity = args[1].As<Uint32>()->Value();
+  int policy = args[2].As<Int32>()->Value();
+  CHECK_GE(fd, 0);
+  CHECK(policy == LogSink::kDrop || policy == LogSink::kBlock);
+  if (capacity == 0 || capacity > kMaxCapacity) {
+    return THROW_ERR_OUT_OF_RANGE(
+        env, "The capacity must be between 1 and 1048576 records");
+  }
+
+  auto sink = std::make_unique<LogSink>(
+      fd, capacity, static_cast<LogSink::Policy>(policy));
+  if (!sink->Start()) {
+    return THROW_ERR_INVALID_STATE(env,
+                                   "Failed to start the log sink thread");
+  }
+  new LogSinkWrap(env, args.This(), std::move(sink));
+}
+
+void LogSinkWrap::Write(const FunctionCallbackInfo<Value>& args) {
+  LogSinkWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  Isolate* isolate = args.GetIsolate();
+
+  std::string record;
+  if (args[0]->IsString()) {
+    Local<String> string = args[0].As<String>();
+    record.resize(string->Utf8Length(isolate));
+    string->WriteUtf8(isolate,
+                      record.data(),
+                      record.size(),
+                      nullptr,
+                      String::NO_NULL_TERMINATION |
+                          String::REPLACE_INVALID_UTF8);
+  } else {
+    CHECK(args[0]->IsArrayBufferView());
+    ArrayBufferViewContents<char> contents(args[0]);
+    record.assign(contents.data(), contents.length());
+  }
+  args.GetReturnValue().Set(wrap->sink_->Write(std::move(record)));
+}
+
+void LogSinkWrap::Flush(const FunctionCallbackInfo<Value>& args) {
+  LogSinkWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  wrap->sink_->Flush();
+  // Returns the libuv error of the first write that failed, or 0.
+  args.GetReturnValue().Set(wrap->sink_->error());
+}
+
+void LogSinkWrap::Close(const FunctionCallbackInfo<Value>& args) {
+  LogSinkWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  wrap->sink_->Close();
+  args.GetReturnValue().Set(wrap->sink_->error());
+}
+
+void LogSinkWrap::GetStats(const FunctionCallbackInfo<Value>& args) {
+  LogSinkWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  Isolate* isolate = args.GetIsolate();
+  LogSink::Stats stats = wrap->sink_->stats();
+  Local<Value> ret[] = {
+      Number::New(isolate, static_cast<double>(stats.written)),
+      Number::New(isolate, static_cast<double>(stats.dropped)),
+      Number::New(isolate, static_cast<double>(stats.blocked)),
+      Integer::New(isolate, wrap->sink_->error()),
+  };
+  args.GetReturnValue().Set(Array::New(isolate, ret, arraysize(ret)));
+}
+
+void LogSinkWrap::Initialize(Local<Object> target,
+                             Local<Value> unused,
+                             Local<Context> context,
+                             void* priv) {
+  Isolate* isolate = context->GetIsolate();
+  Local<FunctionTemplate> tmpl = NewFunctionTemplate(isolate, New);
+  tmpl->InstanceTemplate()->SetInternalFieldCount(
+      LogSinkWrap::kInternalFieldCount);
+  SetProtoMethod(isolate, tmpl, "write", Write);
+  SetProtoMethod(isolate, tmpl, "flush", Flush);
+  SetProtoMethod(isolate, tmpl, "close", Close);
+  SetProtoMethodNoSideEffect(isolate, tmpl, "getStats", GetStats);
+  SetConstructorFunction(context, target, "LogSink", tmpl);
+
+  Local<Object> constants = Object::New(isolate);
+  constants
+      ->Set(context,
+            FIXED_ONE_BYTE_STRING(isolate, "kDrop"),
+            Integer::New(isolate, LogSink::kDrop))
+      .Check();
+  constants
+      ->Set(context,
+            FIXED_ONE_BYTE_STRING(isolate, "kBlock"),
+            Integer::New(isolate, LogSink::kBlock))
+      .Check();
+  target
+      ->Set(context, FIXED_ONE_BYTE_STRING(isolate, "constants"), constants)
+      .Check();
+}
+
+void LogSinkWrap::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Write);
+  registry->Register(Flush);
+  registry->Register(Close);
+  registry->Register(GetStats);
+}
+
+}  // namespace log_sink
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(log_sink,
+                                    node::log_sink::LogSinkWrap::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(
+    log_sink, node::log_sink::LogSinkWrap::RegisterExternalReferences)
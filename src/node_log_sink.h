@@ -0,0 +1,142 @@
+#ifndef SRC_NODE_LOG_SINK_H_
+#define SRC_NODE_LOG_SINK_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "base_object.h"
+#include "node_mutex.h"
+#include "spsc_ring_buffer.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace node {
+
+class ExternalReferenceRegistry;
+
+namespace log_sink {
+
+// Writes log records to a file descriptor from a background thread. One
+// writer thread queues formatted records in a lock-free ring buffer, and the
+// background thread writes everything that has piled up in the meantime
+// with a single vectored write, so that the writer never waits for the
+// file descriptor and a burst of records costs one system call.
+//
+// When the buffer is full, records are either dropped or the writer waits
+// for room, depending on the policy. Once a write fails, all records that
+// follow are dropped.
+class LogSink {
+ public:
+  enum Policy : int { kDrop, kBlock };
+
+  struct Stats {
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    // How often Write() had to wait for room in the buffer.
+    uint64_t blocked = 0;
+  };
+
+  // `capacity` is the number of records that the buffer holds, and is
+  // rounded up to the next power of two. The file descriptor is not closed
+  // by the sink.
+  LogSink(int fd, size_t capacity, Policy policy);
+  ~LogSink();
+
+  LogSink(const LogSink&) = delete;
+  LogSink& operator=(const LogSink&) = delete;
+
+  // Returns false if the background thread could not be started.
+  bool Start();
+
+  // Writer side. Returns false if the record was dropped.
+  bool Write(std::string record);
+  // Writer side. Returns once all records queued so far are written.
+  void Flush();
+  // Writer side. Writes what is left and stops the background thread.
+  void Close();
+
+  Stats stats() const;
+  // The libuv error of the first write that failed, or 0.
+  int error() const { return error_.load(std::memory_order_relaxed); }
+
+  // Writes the queued records of every open sink, from any thread. This is
+  // called before a diagnostic report is written, so that the records that
+  // led up to a crash are not lost.
+  static void FlushAll();
+
+ private:
+  static constexpr size_t kMaxBatchRecords = 256;
+
+  static void ThreadMain(void* data);
+  // The caller must hold `drain_mutex_`.
+  void Drain();
+  void WriteBatch(std::vector<std::string>* batch);
+  void WakeThread();
+
+  const int fd_;
+  const Policy policy_;
+  SPSCRingBuffer<std::string> ring_;
+
+  uv_thread_t thread_;
+  bool started_ = false;
+  bool closed_ = false;
+
+  // Only one thread at a time takes records out of `ring_`: the background
+  // thread, or whoever flushes.
+  Mutex drain_mutex_;
+  // Protects `closing_`, and is what the condition variables wait on.
+  Mutex mutex_;
+  ConditionVariable wake_;
+  ConditionVariable not_full_;
+  bool closing_ = false;
+  // Set while the background thread waits for records, and while the writer
+  // waits for room. They are checked without holding `mutex_` on the hot
+  // paths, so that neither side takes the lock when the other side is busy.
+  std::atomic_bool thread_idle_{false};
+  std::atomic_bool writer_blocked_{false};
+
+  std::atomic_int error_{0};
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> blocked_{0};
+};
+
+// The JS side of a LogSink, which belongs to the thread that creates it.
+class LogSinkWrap : public BaseObject {
+ public:
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context,
+                         void* priv);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Write(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Flush(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  LogSinkWrap(Environment* env,
+              v8::Local<v8::Object> wrap,
+              std::unique_ptr<LogSink> sink);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(LogSinkWrap)
+  SET_SELF_SIZE(LogSinkWrap)
+
+ private:
+  std::unique_ptr<LogSink> sink_;
+};
+
+}  // namespace log_sink
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_LOG_SINK_H_
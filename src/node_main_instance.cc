@@ -8,6 +8,7 @@
 #include "node_external_reference.h"
 #include "node_internals.h"
 #include "node_options-inl.h"
+#include "node_perf.h"
 #include "node_realm.h"
 #include "node_sea.h"
 #include "node_snapshot_builder.h"
@@ -48,6 +49,7 @@ NodeMainInstance::NodeMainInstance(const SnapshotData* snapshot_data,
   isolate_ =
       NewIsolate(isolate_params_.get(), event_loop, platform, snapshot_data);
   CHECK_NOT_NULL(isolate_);
+  isolate_created_ = PERFORMANCE_NOW();
 
   // If the indexes are not nullptr, we are not deserializing
   isolate_data_.reset(
@@ -103,6 +105,8 @@ ExitCode NodeMainInstance::Run() {
 
 void NodeMainInstance::Run(ExitCode* exit_code, Environment* env) {
   if (*exit_code == ExitCode::kNoFailure) {
+    env->performance_state()->Mark(
+        performance::NODE_PERFORMANCE_MILESTONE_MAIN_START);
     bool runs_sea_code = false;
 #ifndef DISABLE_SINGLE_EXECUTABLE_APPLICATION
     if (sea::IsSingleExecutable()) {
@@ -120,8 +124,11 @@ void NodeMainInstance::Run(ExitCode* exit_code, Environment* env) {
       LoadEnvironment(env, StartExecutionCallback{});
     }
 
+    performance::ScheduleStartupProfile(env);
     *exit_code =
         SpinEventLoopInternal(env).FromMaybe(ExitCode::kGenericUserError);
+    // An entry point with a top-level await that never settles.
+    performance::WriteStartupProfile(env);
   }
 
 #if defined(LEAK_SANITIZER)
@@ -160,6 +167,11 @@ NodeMainInstance::CreateMainEnvironment(ExitCode* exit_code) {
         CreateEnvironment(isolate_data_.get(), context, args_, exec_args_));
   }
 
+  if (env) {
+    env->performance_state()->Mark(
+        performance::NODE_PERFORMANCE_MILESTONE_ISOLATE_CREATED,
+        isolate_created_);
+  }
   return env;
 }
 
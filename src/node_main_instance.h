@@ -59,6 +59,7 @@ class NodeMainInstance {
   std::unique_ptr<IsolateData> isolate_data_;
   std::unique_ptr<v8::Isolate::CreateParams> isolate_params_;
   const SnapshotData* snapshot_data_ = nullptr;
+  uint64_t isolate_created_ = 0;
 };
 
 }  // namespace node
@@ -3,7 +3,9 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 
 namespace node {
 namespace mem {
@@ -37,6 +39,45 @@ class NgLibMemoryManager : public NgLibMemoryManagerBase {
   static void* CallocImpl(size_t nmemb, size_t size, void* user_data);
 };
 
+#define NATIVE_MEMORY_COUNTERS(V)                                              \
+  V(kHttp2, "http2")                                                           \
+  V(kZlib, "zlib")                                                             \
+  V(kTls, "tls")                                                               \
+  V(kQuic, "quic")                                                             \
+  V(kBlob, "blob")
+
+// Live counters of the native memory that the subsystems of an Environment
+// hold, for process.memoryUsage.native(). MemoryTracker only finds these
+// when a heap snapshot walks every object, so the subsystems also update
+// a counter wherever they report external memory to V8. They may do so
+// from any thread.
+class NativeMemoryCounters {
+ public:
+  enum Counter {
+#define V(name, _) name,
+    NATIVE_MEMORY_COUNTERS(V)
+#undef V
+    kCounterCount
+  };
+
+  inline void Increase(Counter counter, size_t size) {
+    counters_[counter].fetch_add(size, std::memory_order_relaxed);
+  }
+  inline void Decrease(Counter counter, size_t size) {
+    counters_[counter].fetch_sub(size, std::memory_order_relaxed);
+  }
+  inline void Adjust(Counter counter, int64_t change_in_bytes) {
+    counters_[counter].fetch_add(static_cast<uint64_t>(change_in_bytes),
+                                 std::memory_order_relaxed);
+  }
+  inline uint64_t Get(Counter counter) const {
+    return counters_[counter].load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint64_t> counters_[kCounterCount] = {};
+};
+
 }  // namespace mem
 }  // namespace node
 
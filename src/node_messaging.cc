@@ -10,6 +10,14 @@
 #include "node_process-inl.h"
 #include "util-inl.h"
 
+#include <climits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using node::contextify::ContextifyContext;
 using node::errors::TryCatchScope;
 using v8::Array;
@@ -17,24 +25,37 @@ using v8::ArrayBuffer;
 using v8::BackingStore;
 using v8::CompiledWasmModule;
 using v8::Context;
+using v8::DictionaryTemplate;
 using v8::EscapableHandleScope;
+using v8::False;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Global;
 using v8::HandleScope;
+using v8::Int32;
+using v8::Integer;
 using v8::Isolate;
 using v8::Just;
+using v8::KeyConversionMode;
 using v8::Local;
 using v8::Maybe;
 using v8::MaybeLocal;
+using v8::NewStringType;
 using v8::Nothing;
+using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
+using v8::PropertyFilter;
 using v8::SharedArrayBuffer;
 using v8::SharedValueConveyor;
 using v8::String;
 using v8::Symbol;
+using v8::True;
+using v8::TypedArray;
+using v8::Uint32;
+using v8::Undefined;
 using v8::Value;
 using v8::ValueDeserializer;
 using v8::ValueSerializer;
@@ -135,6 +156,444 @@ class DeserializerDelegate : public ValueDeserializer::Delegate {
 
 }  // anonymous namespace
 
+namespace {
+
+// Messages are frequently small records of primitives and typed arrays, like
+// the `{ id, op, payload }` objects that thread pools pass around. Those are
+// encoded in a compact format that is cheaper to produce and to read than the
+// ValueSerializer wire format, and the receiving side creates the objects
+// from templates that are cached per Environment and property name list.
+// Anything else, including repeated references to the same object, goes
+// through the ValueSerializer.
+enum class SimpleTag : uint8_t {
+  kUndefined,
+  kNull,
+  kTrue,
+  kFalse,
+  kInt32,
+  kDouble,
+  kOneByteString,
+  kTwoByteString,
+  kObject,
+  kTypedArray,
+};
+
+#define SIMPLE_MESSAGE_TYPED_ARRAYS(V)                                         \
+  V(Uint8Array)                                                                \
+  V(Uint8ClampedArray)                                                         \
+  V(Int8Array)                                                                 \
+  V(Uint16Array)                                                               \
+  V(Int16Array)                                                                \
+  V(Uint32Array)                                                               \
+  V(Int32Array)                                                                \
+  V(Float32Array)                                                              \
+  V(Float64Array)                                                              \
+  V(BigInt64Array)                                                             \
+  V(BigUint64Array)
+
+enum class SimpleTypedArrayType : uint8_t {
+#define V(Type) k##Type,
+  SIMPLE_MESSAGE_TYPED_ARRAYS(V)
+#undef V
+};
+
+bool GetSimpleTypedArrayType(Local<TypedArray> view,
+                             SimpleTypedArrayType* type) {
+#define V(Type)                                                                \
+  if (view->Is##Type()) {                                                      \
+    *type = SimpleTypedArrayType::k##Type;                                     \
+    return true;                                                               \
+  }
+  SIMPLE_MESSAGE_TYPED_ARRAYS(V)
+#undef V
+  return false;
+}
+
+constexpr int kSimpleMessageMaxDepth = 8;
+constexpr size_t kSimpleMessageMaxObjects = 64;
+constexpr uint32_t kSimpleMessageMaxProperties = 32;
+constexpr int kSimpleMessageMaxKeyLength = 64;
+constexpr size_t kMaxMessageObjectTemplates = 64;
+
+class SimpleMessageWriter {
+ public:
+  SimpleMessageWriter(Environment* env, Local<Context> context)
+      : env_(env), context_(context) {}
+
+  // Returns Just(false) if `value` cannot be encoded. The only JS-visible
+  // operations performed before that decision are reads of own data
+  // properties, so the caller may retry with a ValueSerializer.
+  Maybe<bool> WriteValue(Local<Value> value, int depth = 0) {
+    if (value->IsUndefined()) {
+      WriteTag(SimpleTag::kUndefined);
+    } else if (value->IsNull()) {
+      WriteTag(SimpleTag::kNull);
+    } else if (value->IsTrue()) {
+      WriteTag(SimpleTag::kTrue);
+    } else if (value->IsFalse()) {
+      WriteTag(SimpleTag::kFalse);
+    } else if (value->IsInt32()) {
+      WriteTag(SimpleTag::kInt32);
+      WriteRaw(value.As<Int32>()->Value());
+    } else if (value->IsNumber()) {
+      WriteTag(SimpleTag::kDouble);
+      WriteRaw(value.As<Number>()->Value());
+    } else if (value->IsString()) {
+      WriteString(value.As<String>());
+    } else if (value->IsTypedArray()) {
+      return Just(WriteTypedArray(value.As<TypedArray>()));
+    } else if (value->IsObject()) {
+      return WriteObject(value.As<Object>(), depth);
+    } else {
+      return Just(false);
+    }
+    return Just(true);
+  }
+
+  MallocedBuffer<char> Release() {
+    MallocedBuffer<char> buffer(data_.size());
+    memcpy(buffer.data, data_.data(), data_.size());
+    return buffer;
+  }
+
+ private:
+  template <typename T>
+  void WriteRaw(T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    data_.insert(data_.end(), bytes, bytes + sizeof(value));
+  }
+
+  void WriteTag(SimpleTag tag) { data_.push_back(static_cast<char>(tag)); }
+
+  char* Grow(size_t length) {
+    size_t offset = data_.size();
+    data_.resize(offset + length);
+    return data_.data() + offset;
+  }
+
+  void WriteString(Local<String> string) {
+    Isolate* isolate = env_->isolate();
+    int length = string->Length();
+    if (string->IsOneByte()) {
+      WriteTag(SimpleTag::kOneByteString);
+      WriteRaw<uint32_t>(length);
+      string->WriteOneByte(isolate,
+                           reinterpret_cast<uint8_t*>(Grow(length)),
+                           0,
+                           length,
+                           String::NO_NULL_TERMINATION);
+      return;
+    }
+    WriteTag(SimpleTag::kTwoByteString);
+    WriteRaw<uint32_t>(length);
+    // Keep the UTF-16 data aligned so that the reader can use it in place.
+    if (data_.size() % sizeof(uint16_t) != 0) data_.push_back(0);
+    string->Write(isolate,
+                  reinterpret_cast<uint16_t*>(Grow(length * sizeof(uint16_t))),
+                  0,
+                  length,
+                  String::NO_NULL_TERMINATION);
+  }
+
+  // Returns false if `object` has been encountered before, because the
+  // compact encoding does not preserve object identity.
+  bool Remember(Local<Object> object) {
+    if (seen_.size() >= kSimpleMessageMaxObjects ||
+        std::find(seen_.begin(), seen_.end(), object) != seen_.end()) {
+      return false;
+    }
+    seen_.push_back(object);
+    return true;
+  }
+
+  bool WriteTypedArray(Local<TypedArray> view) {
+    // Like the ValueSerializer, copy the whole underlying ArrayBuffer along
+    // with the view, so that `.buffer` and `.byteOffset` match.
+    Local<ArrayBuffer> buffer = view->Buffer();
+    if (buffer->IsSharedArrayBuffer() || buffer->WasDetached() ||
+        buffer->IsResizableByUserJavaScript() ||
+        buffer->ByteLength() > std::numeric_limits<uint32_t>::max() ||
+        !Remember(buffer)) {
+      return false;
+    }
+
+    SimpleTypedArrayType type;
+    if (!GetSimpleTypedArrayType(view, &type)) return false;
+
+    WriteTag(SimpleTag::kTypedArray);
+    WriteRaw(type);
+    WriteRaw<uint32_t>(view->ByteOffset());
+    WriteRaw<uint32_t>(view->Length());
+    WriteRaw<uint32_t>(buffer->ByteLength());
+    if (buffer->ByteLength() > 0)
+      memcpy(Grow(buffer->ByteLength()), buffer->Data(), buffer->ByteLength());
+    return true;
+  }
+
+  // Returns true if `object` is an ordinary object, i.e. not a function,
+  // an array, a host object or any other object with internal slots that
+  // the ValueSerializer or the SerializerDelegate clones, or refuses to
+  // clone, in a way of its own. Their prototype can be replaced, so it does
+  // not tell. The constructor name comes from the map of the object, and
+  // catches the exotic objects that have no predicate of their own, such
+  // as Intl objects or iterators.
+  bool IsOrdinaryObject(Local<Object> object) {
+    if (object->IsFunction() || object->IsArray() || object->IsProxy() ||
+        object->IsApiWrapper() || object->InternalFieldCount() > 0 ||
+        object->IsArgumentsObject() || object->IsModuleNamespaceObject() ||
+        object->IsDate() || object->IsRegExp() || object->IsNativeError() ||
+        object->IsMap() || object->IsSet() || object->IsWeakMap() ||
+        object->IsWeakSet() || object->IsWeakRef() || object->IsPromise() ||
+        object->IsMapIterator() || object->IsSetIterator() ||
+        object->IsGeneratorObject() || object->IsArrayBuffer() ||
+        object->IsSharedArrayBuffer() || object->IsArrayBufferView() ||
+        object->IsBigIntObject() || object->IsBooleanObject() ||
+        object->IsNumberObject() || object->IsStringObject() ||
+        object->IsSymbolObject() || object->IsWasmMemoryObject() ||
+        object->IsWasmModuleObject() || object->IsExternal()) {
+      return false;
+    }
+    return object->GetConstructorName()->StringEquals(env_->object_string());
+  }
+
+  Maybe<bool> WriteObject(Local<Object> object, int depth) {
+    // Only ordinary objects are cloned as plain objects, and only if they
+    // inherit from nothing but Object.prototype.
+    if (depth >= kSimpleMessageMaxDepth || !IsOrdinaryObject(object))
+      return Just(false);
+    Local<Value> prototype = object->GetPrototype();
+    if (!prototype->IsNull()) {
+      if (object_prototype_.IsEmpty())
+        object_prototype_ = Object::New(env_->isolate())->GetPrototype();
+      if (prototype != object_prototype_) return Just(false);
+    }
+    if (JSTransferable::IsJSTransferable(env_, context_, object) ||
+        !Remember(object)) {
+      return Just(false);
+    }
+
+    Local<Array> keys;
+    if (!object
+             ->GetOwnPropertyNames(
+                 context_,
+                 static_cast<PropertyFilter>(v8::ONLY_ENUMERABLE |
+                                             v8::SKIP_SYMBOLS),
+                 KeyConversionMode::kKeepNumbers)
+             .ToLocal(&keys)) {
+      return Nothing<bool>();
+    }
+    uint32_t count = keys->Length();
+    if (count > kSimpleMessageMaxProperties) return Just(false);
+
+    // The property names, each prefixed with its length. Integer-indexed
+    // properties and accessors, whose getters must not run twice, are
+    // left to the ValueSerializer.
+    std::string shape;
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> key;
+      if (!keys->Get(context_, i).ToLocal(&key)) return Nothing<bool>();
+      if (!key->IsString()) return Just(false);
+      Local<String> name = key.As<String>();
+      int length = name->Length();
+      if (!name->IsOneByte() || length > kSimpleMessageMaxKeyLength)
+        return Just(false);
+      char chars[kSimpleMessageMaxKeyLength];
+      name->WriteOneByte(env_->isolate(),
+                         reinterpret_cast<uint8_t*>(chars),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+      std::string_view view(chars, length);
+      if (view == "__proto__" ||
+          !std::all_of(view.begin(), view.end(), [](char c) {
+            return static_cast<unsigned char>(c) < 0x80;
+          })) {
+        return Just(false);
+      }
+      bool is_accessor;
+      if (!object->HasRealNamedCallbackProperty(context_, name)
+               .To(&is_accessor)) {
+        return Nothing<bool>();
+      }
+      if (is_accessor) return Just(false);
+      shape += static_cast<char>(length);
+      shape += view;
+    }
+
+    WriteTag(SimpleTag::kObject);
+    WriteRaw(count);
+    WriteRaw<uint32_t>(shape.size());
+    data_.insert(data_.end(), shape.begin(), shape.end());
+
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> key;
+      Local<Value> value;
+      if (!keys->Get(context_, i).ToLocal(&key) ||
+          !object->Get(context_, key).ToLocal(&value)) {
+        return Nothing<bool>();
+      }
+      bool written;
+      if (!WriteValue(value, depth + 1).To(&written) || !written)
+        return Just(written);
+    }
+    return Just(true);
+  }
+
+  Environment* env_;
+  Local<Context> context_;
+  Local<Value> object_prototype_;
+  std::vector<char> data_;
+  std::vector<Local<Object>> seen_;
+};
+
+class SimpleMessageReader {
+ public:
+  SimpleMessageReader(Environment* env,
+                      Local<Context> context,
+                      const MallocedBuffer<char>& buffer)
+      : env_(env),
+        context_(context),
+        start_(buffer.data),
+        position_(buffer.data),
+        end_(buffer.data + buffer.size) {}
+
+  MaybeLocal<Value> ReadValue() {
+    Isolate* isolate = env_->isolate();
+    switch (Read<SimpleTag>()) {
+      case SimpleTag::kUndefined:
+        return Undefined(isolate);
+      case SimpleTag::kNull:
+        return Null(isolate);
+      case SimpleTag::kTrue:
+        return True(isolate);
+      case SimpleTag::kFalse:
+        return False(isolate);
+      case SimpleTag::kInt32:
+        return Integer::New(isolate, Read<int32_t>());
+      case SimpleTag::kDouble:
+        return Number::New(isolate, Read<double>());
+      case SimpleTag::kOneByteString: {
+        uint32_t length = Read<uint32_t>();
+        Local<String> string;
+        if (!String::NewFromOneByte(
+                 isolate,
+                 reinterpret_cast<const uint8_t*>(ReadBytes(length)),
+                 NewStringType::kNormal,
+                 length)
+                 .ToLocal(&string)) {
+          return {};
+        }
+        return string;
+      }
+      case SimpleTag::kTwoByteString: {
+        uint32_t length = Read<uint32_t>();
+        if ((position_ - start_) % sizeof(uint16_t) != 0) ReadBytes(1);
+        Local<String> string;
+        if (!String::NewFromTwoByte(isolate,
+                                    reinterpret_cast<const uint16_t*>(
+                                        ReadBytes(length * sizeof(uint16_t))),
+                                    NewStringType::kNormal,
+                                    length)
+                 .ToLocal(&string)) {
+          return {};
+        }
+        return string;
+      }
+      case SimpleTag::kObject:
+        return ReadObject();
+      case SimpleTag::kTypedArray:
+        return ReadTypedArray();
+    }
+    UNREACHABLE();
+  }
+
+ private:
+  template <typename T>
+  T Read() {
+    T value;
+    memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  const char* ReadBytes(size_t length) {
+    CHECK_LE(length, static_cast<size_t>(end_ - position_));
+    const char* bytes = position_;
+    position_ += length;
+    return bytes;
+  }
+
+  MaybeLocal<Value> ReadObject() {
+    Isolate* isolate = env_->isolate();
+    uint32_t count = Read<uint32_t>();
+    uint32_t shape_size = Read<uint32_t>();
+    std::string shape(ReadBytes(shape_size), shape_size);
+
+    Environment::MessageObjectTemplateMap* templates =
+        env_->message_object_templates();
+    Local<DictionaryTemplate> tmpl;
+    auto it = templates->find(shape);
+    if (it != templates->end()) {
+      tmpl = it->second.Get(isolate);
+    } else {
+      std::vector<std::string_view> names;
+      names.reserve(count);
+      for (size_t offset = 0; offset < shape.size();) {
+        size_t length = static_cast<uint8_t>(shape[offset]);
+        names.emplace_back(shape.data() + offset + 1, length);
+        offset += 1 + length;
+      }
+      CHECK_EQ(names.size(), count);
+      tmpl = DictionaryTemplate::New(isolate, {names.data(), names.size()});
+      if (templates->size() >= kMaxMessageObjectTemplates) templates->clear();
+      templates->emplace(std::move(shape),
+                         Global<DictionaryTemplate>(isolate, tmpl));
+    }
+
+    std::vector<MaybeLocal<Value>> values(count);
+    for (uint32_t i = 0; i < count; i++) {
+      values[i] = ReadValue();
+      if (values[i].IsEmpty()) return {};
+    }
+    return tmpl->NewInstance(context_, {values.data(), values.size()});
+  }
+
+  MaybeLocal<Value> ReadTypedArray() {
+    Isolate* isolate = env_->isolate();
+    SimpleTypedArrayType type = Read<SimpleTypedArrayType>();
+    uint32_t byte_offset = Read<uint32_t>();
+    uint32_t length = Read<uint32_t>();
+    uint32_t byte_length = Read<uint32_t>();
+    const char* data = ReadBytes(byte_length);
+
+    std::unique_ptr<BackingStore> store;
+    {
+      NoArrayBufferZeroFillScope no_zero_fill_scope(env_->isolate_data());
+      store = ArrayBuffer::NewBackingStore(isolate, byte_length);
+    }
+    if (byte_length > 0) memcpy(store->Data(), data, byte_length);
+    Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, std::move(store));
+
+    switch (type) {
+#define V(Type)                                                                \
+  case SimpleTypedArrayType::k##Type:                                          \
+    return v8::Type::New(buffer, byte_offset, length);
+      SIMPLE_MESSAGE_TYPED_ARRAYS(V)
+#undef V
+    }
+    UNREACHABLE();
+  }
+
+  Environment* env_;
+  Local<Context> context_;
+  const char* start_;
+  const char* position_;
+  const char* end_;
+};
+
+#undef SIMPLE_MESSAGE_TYPED_ARRAYS
+
+}  // anonymous namespace
+
 MaybeLocal<Value> Message::Deserialize(Environment* env,
                                        Local<Context> context,
                                        Local<Value>* port_list) {
@@ -149,6 +608,13 @@ MaybeLocal<Value> Message::Deserialize(Environment* env,
 
   EscapableHandleScope handle_scope(env->isolate());
 
+  if (is_simple_message_) {
+    SimpleMessageReader reader(env, context, main_message_buf_);
+    Local<Value> return_value;
+    if (!reader.ReadValue().ToLocal(&return_value)) return {};
+    return handle_scope.Escape(return_value);
+  }
+
   // Create all necessary objects for transferables, e.g. MessagePort handles.
   std::vector<BaseObjectPtr<BaseObject>> host_objects(transferables_.size());
   auto cleanup = OnScopeLeave([&]() {
@@ -468,6 +934,17 @@ Maybe<bool> Message::Serialize(Environment* env,
   // Verify that we're not silently overwriting an existing message.
   CHECK(main_message_buf_.is_empty());
 
+  if (transfer_list_v.length() == 0) {
+    SimpleMessageWriter writer(env, context);
+    bool written;
+    if (!writer.WriteValue(input).To(&written)) return Nothing<bool>();
+    if (written) {
+      main_message_buf_ = writer.Release();
+      is_simple_message_ = true;
+      return Just(true);
+    }
+  }
+
   SerializerDelegate delegate(env, context, this);
   ValueSerializer serializer(env->isolate(), &delegate);
   delegate.serializer = &serializer;
@@ -602,6 +1079,10 @@ void Message::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("transferables", transferables_);
 }
 
+// The number of messages that the sibling of a single-producer port can
+// queue up before they spill over into the regular, mutex-protected queue.
+static constexpr size_t kSingleProducerQueueSize = 1024;
+
 MessagePortData::MessagePortData(MessagePort* owner)
     : owner_(owner) {
 }
@@ -618,13 +1099,88 @@ void MessagePortData::MemoryInfo(MemoryTracker* tracker) const {
 
 void MessagePortData::AddToIncomingQueue(std::shared_ptr<Message> message) {
   // This function will be called by other threads.
-  Mutex::ScopedLock lock(mutex_);
-  incoming_messages_.emplace_back(std::move(message));
+  {
+    Mutex::ScopedLock lock(mutex_);
+    incoming_messages_.emplace_back(std::move(message));
+    if (incoming_ring_) ring_overflowed_.store(true, std::memory_order_relaxed);
 
-  if (owner_ != nullptr) {
-    Debug(owner_, "Adding message to incoming queue");
-    owner_->TriggerAsync();
+    if (owner_ != nullptr) {
+      Debug(owner_, "Adding message to incoming queue");
+      owner_->TriggerAsync();
+    }
+  }
+  NotifyWaiters();
+}
+
+void MessagePortData::AddToIncomingQueueFromSibling(
+    std::shared_ptr<Message> message) {
+  if (!incoming_ring_ || ring_overflowed_.load(std::memory_order_acquire) ||
+      !incoming_ring_->Push(std::move(message))) {
+    return AddToIncomingQueue(std::move(message));
+  }
+  NotifyWaiters();
+
+  if (!wakeup_pending_.exchange(true)) {
+    Mutex::ScopedLock lock(mutex_);
+    if (owner_ != nullptr) owner_->TriggerAsync();
+  }
+}
+
+void MessagePortData::EnableSingleProducerQueue() {
+  CHECK(!group_);
+  incoming_ring_ = std::make_unique<SPSCRingBuffer<std::shared_ptr<Message>>>(
+      kSingleProducerQueueSize);
+}
+
+void MessagePortData::NotifyWaiters() {
+  incoming_sequence_.fetch_add(1);
+  if (waiters_.load() == 0) return;
+#ifdef __linux__
+  syscall(SYS_futex,
+          reinterpret_cast<uint32_t*>(&incoming_sequence_),
+          FUTEX_WAKE_PRIVATE,
+          INT_MAX,
+          nullptr,
+          nullptr,
+          0);
+#else
+  Mutex::ScopedLock lock(wait_mutex_);
+  wait_cond_.Broadcast(lock);
+#endif
+}
+
+void MessagePortData::WaitForIncomingMessage(uint32_t sequence,
+                                             uint64_t timeout) {
+  // Announcing the waiter before looking at incoming_sequence_ guarantees
+  // that NotifyWaiters() either sees the waiter or has already changed the
+  // sequence number.
+  waiters_.fetch_add(1);
+#ifdef __linux__
+  if (incoming_sequence_.load() == sequence) {
+    timespec ts;
+    ts.tv_sec = timeout / 1000000000;
+    ts.tv_nsec = timeout % 1000000000;
+    // The kernel only sleeps if the sequence number is still unchanged.
+    syscall(SYS_futex,
+            reinterpret_cast<uint32_t*>(&incoming_sequence_),
+            FUTEX_WAIT_PRIVATE,
+            sequence,
+            timeout == UINT64_MAX ? nullptr : &ts,
+            nullptr,
+            0);
+  }
+#else
+  {
+    Mutex::ScopedLock lock(wait_mutex_);
+    if (incoming_sequence_.load() == sequence) {
+      if (timeout == UINT64_MAX)
+        wait_cond_.Wait(lock);
+      else
+        wait_cond_.TimedWait(lock, timeout);
+    }
   }
+#endif
+  waiters_.fetch_sub(1);
 }
 
 void MessagePortData::Entangle(MessagePortData* a, MessagePortData* b) {
@@ -754,29 +1310,41 @@ MessagePort* MessagePort::New(
 
 MaybeLocal<Value> MessagePort::ReceiveMessage(Local<Context> context,
                                               MessageProcessingMode mode,
-                                              Local<Value>* port_list) {
+                                              Local<Value>* port_list,
+                                              size_t* payload_size) {
   std::shared_ptr<Message> received;
-  {
+  bool wants_message =
+      receiving_messages_ ||
+      mode == MessageProcessingMode::kForceReadMessages;
+  // Messages in the single-producer queue precede those in
+  // incoming_messages_, and are never "close" messages.
+  auto* ring = data_->incoming_ring_.get();
+  if (ring == nullptr || !wants_message || !ring->Pop(&received)) {
     // Get the head of the message queue.
     Mutex::ScopedLock lock(data_->mutex_);
 
     Debug(this, "MessagePort has message");
 
-    bool wants_message =
-        receiving_messages_ ||
-        mode == MessageProcessingMode::kForceReadMessages;
-    // We have nothing to do if:
-    // - There are no pending messages
-    // - We are not intending to receive messages, and the message we would
-    //   receive is not the final "close" message.
-    if (data_->incoming_messages_.empty() ||
-        (!wants_message &&
-         !data_->incoming_messages_.front()->IsCloseMessage())) {
+    if (ring != nullptr && !ring->IsEmpty()) {
+      // The sibling may have added more messages to the ring buffer before
+      // a "close" message in incoming_messages_ became visible to us.
+      if (!wants_message) return env()->no_message_symbol();
+      CHECK(ring->Pop(&received));
+    } else if (data_->incoming_messages_.empty() ||
+               (!wants_message &&
+                !data_->incoming_messages_.front()->IsCloseMessage())) {
+      // We have nothing to do if:
+      // - There are no pending messages
+      // - We are not intending to receive messages, and the message we would
+      //   receive is not the final "close" message.
       return env()->no_message_symbol();
+    } else {
+      received = data_->incoming_messages_.front();
+      data_->incoming_messages_.pop_front();
+      // The ring buffer is empty, so the sibling may use it again.
+      if (ring != nullptr && data_->incoming_messages_.empty())
+        data_->ring_overflowed_.store(false, std::memory_order_release);
     }
-
-    received = data_->incoming_messages_.front();
-    data_->incoming_messages_.pop_front();
   }
 
   if (received->IsCloseMessage()) {
@@ -786,6 +1354,7 @@ MaybeLocal<Value> MessagePort::ReceiveMessage(Local<Context> context,
 
   if (!env()->can_call_into_js()) return MaybeLocal<Value>();
 
+  if (payload_size != nullptr) *payload_size = received->main_message_buf_.size;
   return received->Deserialize(env(), context, port_list);
 }
 
@@ -798,15 +1367,26 @@ void MessagePort::OnMessage(MessageProcessingMode mode) {
   // Because all data was sent from the preivous context.
   if (IsDetached()) return;
 
+  // Messages that the sibling adds to the single-producer queue from now on
+  // need another wakeup.
+  data_->wakeup_pending_.store(false);
+
   HandleScope handle_scope(env()->isolate());
   Local<Context> context =
       object(env()->isolate())->GetCreationContextChecked();
 
+  if (batch_max_messages_ > 0 &&
+      mode == MessageProcessingMode::kNormalOperation &&
+      env()->can_call_into_js()) {
+    return OnMessageBatch(context);
+  }
+
   size_t processing_limit;
   if (mode == MessageProcessingMode::kNormalOperation) {
     Mutex::ScopedLock lock(data_->mutex_);
-    processing_limit = std::max(data_->incoming_messages_.size(),
-                                static_cast<size_t>(1000));
+    size_t queued = data_->incoming_messages_.size();
+    if (data_->incoming_ring_) queued += data_->incoming_ring_->Size();
+    processing_limit = std::max(queued, static_cast<size_t>(1000));
   } else {
     processing_limit = std::numeric_limits<size_t>::max();
   }
@@ -876,6 +1456,76 @@ void MessagePort::OnMessage(MessageProcessingMode mode) {
   }
 }
 
+void MessagePort::OnMessageBatch(Local<Context> context) {
+  Isolate* isolate = env()->isolate();
+  Context::Scope context_scope(context);
+  Local<Function> emit_message = PersistentToLocal::Strong(emit_message_fn_);
+
+  std::vector<Local<Value>> batch;
+  size_t batch_size = 0;
+  // A message that transfers MessagePorts is emitted on its own as a regular
+  // "message" event after the batch, so that it keeps its `ports` list.
+  Local<Value> with_ports;
+  Local<Value> port_list = Undefined(isolate);
+  Local<Value> message_error;
+  bool drained = false;
+
+  while (data_ && batch.size() < batch_max_messages_ &&
+         (batch_max_bytes_ == 0 || batch_size < batch_max_bytes_)) {
+    Local<Value> payload;
+    size_t payload_size = 0;
+    {
+      // Catch any exceptions from parsing the message itself (not from
+      // emitting it) as 'messageerror' events.
+      TryCatchScope try_catch(env());
+      if (!ReceiveMessage(context,
+                          MessageProcessingMode::kNormalOperation,
+                          &port_list,
+                          &payload_size)
+               .ToLocal(&payload)) {
+        if (try_catch.HasCaught() && !try_catch.HasTerminated())
+          message_error = try_catch.Exception();
+        break;
+      }
+    }
+    if (payload == env()->no_message_symbol()) {
+      drained = true;
+      break;
+    }
+    if (port_list->IsArray() && port_list.As<Array>()->Length() > 0) {
+      with_ports = payload;
+      break;
+    }
+    port_list = Undefined(isolate);
+    batch.push_back(payload);
+    batch_size += payload_size;
+  }
+
+  Local<Value> argv[3];
+  if (!batch.empty()) {
+    argv[0] = Array::New(isolate, batch.data(), batch.size());
+    argv[1] = Undefined(isolate);
+    argv[2] = env()->messagebatch_string();
+    if (MakeCallback(emit_message, arraysize(argv), argv).IsEmpty())
+      drained = false;
+  }
+  if (!with_ports.IsEmpty()) {
+    argv[0] = with_ports;
+    argv[1] = port_list;
+    argv[2] = env()->message_string();
+    USE(MakeCallback(emit_message, arraysize(argv), argv));
+  }
+  if (!message_error.IsEmpty()) {
+    argv[0] = message_error;
+    argv[1] = Undefined(isolate);
+    argv[2] = env()->messageerror_string();
+    USE(MakeCallback(emit_message, arraysize(argv), argv));
+  }
+
+  // Give the event loop a chance to run before the next batch.
+  if (data_ && !drained) TriggerAsync();
+}
+
 void MessagePort::OnClose() {
   Debug(this, "MessagePort::OnClose()");
   if (data_) {
@@ -1091,8 +1741,10 @@ void MessagePort::Start() {
   Debug(this, "Start receiving messages");
   receiving_messages_ = true;
   Mutex::ScopedLock lock(data_->mutex_);
-  if (!data_->incoming_messages_.empty())
+  if (!data_->incoming_messages_.empty() ||
+      (data_->incoming_ring_ && !data_->incoming_ring_->IsEmpty())) {
     TriggerAsync();
+  }
 }
 
 void MessagePort::Stop() {
@@ -1147,13 +1799,51 @@ void MessagePort::ReceiveMessage(const FunctionCallbackInfo<Value>& args) {
     return;
   }
 
-  MaybeLocal<Value> payload =
-      port->ReceiveMessage(port->object()->GetCreationContextChecked(),
-                           MessageProcessingMode::kForceReadMessages);
+  // An optional timeout in milliseconds makes this wait for a message to
+  // arrive, blocking the thread like Atomics.wait() does.
+  uint64_t timeout = 0;
+  if (args[1]->IsNumber()) {
+    double timeout_ms = args[1].As<Number>()->Value();
+    if (timeout_ms >= static_cast<double>(UINT64_MAX / 1000000))
+      timeout = UINT64_MAX;
+    else if (timeout_ms > 0)
+      timeout = static_cast<uint64_t>(timeout_ms * 1000000);
+  }
+
+  Local<Context> context = port->object()->GetCreationContextChecked();
+  uint64_t start = timeout == 0 ? 0 : uv_hrtime();
+  MaybeLocal<Value> payload;
+  while (true) {
+    uint32_t sequence = port->data_ ? port->data_->incoming_sequence() : 0;
+    payload = port->ReceiveMessage(context,
+                                   MessageProcessingMode::kForceReadMessages);
+    if (timeout == 0 || payload.IsEmpty() ||
+        payload.ToLocalChecked() != env->no_message_symbol() ||
+        port->IsDetached()) {
+      break;
+    }
+    uint64_t remaining = UINT64_MAX;
+    if (timeout != UINT64_MAX) {
+      uint64_t elapsed = uv_hrtime() - start;
+      if (elapsed >= timeout) break;
+      remaining = timeout - elapsed;
+    }
+    port->data_->WaitForIncomingMessage(sequence, remaining);
+  }
   if (!payload.IsEmpty())
     args.GetReturnValue().Set(payload.ToLocalChecked());
 }
 
+void MessagePort::SetBatchLimits(const FunctionCallbackInfo<Value>& args) {
+  MessagePort* port;
+  CHECK(args[0]->IsObject());
+  ASSIGN_OR_RETURN_UNWRAP(&port, args[0].As<Object>());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsUint32());
+  port->batch_max_messages_ = args[1].As<Uint32>()->Value();
+  port->batch_max_bytes_ = args[2].As<Uint32>()->Value();
+}
+
 void MessagePort::MoveToContext(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   if (!args[0]->IsObject() ||
@@ -1187,7 +1877,13 @@ void MessagePort::MoveToContext(const FunctionCallbackInfo<Value>& args) {
     args.GetReturnValue().Set(target->object());
 }
 
-void MessagePort::Entangle(MessagePort* a, MessagePort* b) {
+void MessagePort::Entangle(MessagePort* a,
+                           MessagePort* b,
+                           bool single_producer) {
+  if (single_producer) {
+    a->data_->EnableSingleProducerQueue();
+    b->data_->EnableSingleProducerQueue();
+  }
   MessagePortData::Entangle(a->data_.get(), b->data_.get());
 }
 
@@ -1522,7 +2218,7 @@ Maybe<bool> SiblingGroup::Dispatch(
         return Just(true);
       }
     }
-    port->AddToIncomingQueue(message);
+    port->AddToIncomingQueueFromSibling(message);
   }
 
   return Just(true);
@@ -1625,7 +2321,10 @@ static void MessageChannel(const FunctionCallbackInfo<Value>& args) {
     return;
   }
 
-  MessagePort::Entangle(port1, port2);
+  // `new MessageChannel(true)` creates a channel for pipelines in which each
+  // port stays with a single thread, e.g. one-to-one worker pairs. Messages
+  // are then passed through lock-free queues.
+  MessagePort::Entangle(port1, port2, args[0]->IsTrue());
 
   args.This()->Set(context, env->port1_string(), port1->object())
       .Check();
@@ -1678,6 +2377,10 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
       isolate, target, "receiveMessageOnPort", MessagePort::ReceiveMessage);
   SetMethod(
       isolate, target, "moveMessagePortToContext", MessagePort::MoveToContext);
+  SetMethod(isolate,
+            target,
+            "setMessagePortBatchLimits",
+            MessagePort::SetBatchLimits);
   SetMethod(isolate,
             target,
             "setDeserializerCreateObjectFunction",
@@ -1712,6 +2415,7 @@ static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(MessagePort::Drain);
   registry->Register(MessagePort::ReceiveMessage);
   registry->Register(MessagePort::MoveToContext);
+  registry->Register(MessagePort::SetBatchLimits);
   registry->Register(SetDeserializerCreateObjectFunction);
   registry->Register(StructuredClone);
 }
@@ -5,7 +5,9 @@
 
 #include "env.h"
 #include "node_mutex.h"
+#include "spsc_ring_buffer.h"
 #include "v8.h"
+#include <atomic>
 #include <deque>
 #include <string>
 #include <unordered_map>
@@ -118,6 +120,10 @@ class Message : public MemoryRetainer {
   std::vector<std::unique_ptr<TransferData>> transferables_;
   std::vector<v8::CompiledWasmModule> wasm_modules_;
   std::optional<v8::SharedValueConveyor> shared_value_conveyor_;
+  // Whether main_message_buf_ holds the compact encoding that Serialize()
+  // uses for messages made up of primitives, typed arrays and plain objects,
+  // rather than ValueSerializer output.
+  bool is_simple_message_ = false;
 
   friend class MessagePort;
 };
@@ -182,6 +188,11 @@ class MessagePortData : public TransferData {
   // Add a message to the incoming queue and notify the receiver.
   // This may be called from any thread.
   void AddToIncomingQueue(std::shared_ptr<Message> message);
+  // Like AddToIncomingQueue(), but only called by the sibling port that
+  // sends messages to this one. With a single-producer queue, the message
+  // is handed over without taking a lock, and the receiver is only woken up
+  // if it has drained all earlier messages.
+  void AddToIncomingQueueFromSibling(std::shared_ptr<Message> message);
   v8::Maybe<bool> Dispatch(
       std::shared_ptr<Message> message,
       std::string* error = nullptr);
@@ -196,6 +207,18 @@ class MessagePortData : public TransferData {
   // which can happen on either side of a worker.
   void Disentangle();
 
+  // Lets the sibling port deliver messages through a lock-free ring buffer.
+  // This must be called before the port is entangled, and only for ports
+  // that have exactly one sibling, i.e. those created by a MessageChannel.
+  void EnableSingleProducerQueue();
+
+  // The number of messages added to the incoming queue so far, modulo 2^32.
+  uint32_t incoming_sequence() const { return incoming_sequence_.load(); }
+  // Blocks the calling thread until incoming_sequence() differs from
+  // `sequence`, or until `timeout` nanoseconds have passed. A timeout of
+  // UINT64_MAX waits indefinitely. Spurious wakeups are possible.
+  void WaitForIncomingMessage(uint32_t sequence, uint64_t timeout);
+
   void MemoryInfo(MemoryTracker* tracker) const override;
   BaseObjectPtr<BaseObject> Deserialize(
       Environment* env,
@@ -215,6 +238,27 @@ class MessagePortData : public TransferData {
   std::deque<std::shared_ptr<Message>> incoming_messages_;
   MessagePort* owner_ = nullptr;
   std::shared_ptr<SiblingGroup> group_;
+
+  void NotifyWaiters();
+
+  // The single-producer queue, if enabled. Messages that do not fit into it
+  // go to incoming_messages_, and keep going there until the receiver has
+  // emptied it, so that the receiver always gets the ring buffer's messages
+  // first without reordering anything.
+  std::unique_ptr<SPSCRingBuffer<std::shared_ptr<Message>>> incoming_ring_;
+  std::atomic<bool> ring_overflowed_{false};
+  // Set when the owner's uv_async_t has been triggered for messages in
+  // incoming_ring_, and cleared when the owner starts processing them.
+  std::atomic<bool> wakeup_pending_{false};
+
+  std::atomic<uint32_t> incoming_sequence_{0};
+  std::atomic<uint32_t> waiters_{0};
+#ifndef __linux__
+  // Linux uses a futex on incoming_sequence_ instead.
+  Mutex wait_mutex_;
+  ConditionVariable wait_cond_;
+#endif
+
   friend class MessagePort;
   friend class SiblingGroup;
 };
@@ -264,13 +308,18 @@ class MessagePort : public HandleWrap {
   static void CheckType(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Drain(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void ReceiveMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetBatchLimits(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   /* static */
   static void MoveToContext(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Turns `a` and `b` into siblings, i.e. connects the sending side of one
   // to the receiving side of the other. This is not thread-safe.
-  static void Entangle(MessagePort* a, MessagePort* b);
+  // With `single_producer`, each side uses MessagePortData's single-producer
+  // queue for the messages it receives from the other.
+  static void Entangle(MessagePort* a,
+                       MessagePort* b,
+                       bool single_producer = false);
   static void Entangle(MessagePort* a, MessagePortData* b);
 
   // Detach this port's data for transferring. After this, the MessagePortData
@@ -305,14 +354,23 @@ class MessagePort : public HandleWrap {
 
   void OnClose() override;
   void OnMessage(MessageProcessingMode mode);
+  // Emits up to batch_max_messages_ messages, or about batch_max_bytes_
+  // worth of serialized data, as one "messagebatch" event, and leaves the
+  // remaining messages for the next event loop iteration.
+  void OnMessageBatch(v8::Local<v8::Context> context);
   void TriggerAsync();
   v8::MaybeLocal<v8::Value> ReceiveMessage(
       v8::Local<v8::Context> context,
       MessageProcessingMode mode,
-      v8::Local<v8::Value>* port_list = nullptr);
+      v8::Local<v8::Value>* port_list = nullptr,
+      size_t* payload_size = nullptr);
 
   std::unique_ptr<MessagePortData> data_ = nullptr;
   bool receiving_messages_ = false;
+  // Batching is disabled while batch_max_messages_ is 0. A byte limit of 0
+  // means that only the message count limits a batch.
+  uint32_t batch_max_messages_ = 0;
+  uint32_t batch_max_bytes_ = 0;
   uv_async_t async_;
   v8::Global<v8::Function> emit_message_fn_;
 
@@ -0,0 +1,481 @@
+#include "node_metrics.h"
+
+#include "env-inl.h"
+#include "histogram-inl.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "node_sockaddr-inl.h"
+#include "util-inl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace node {
+namespace metrics {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Int32;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Uint32;
+using v8::Value;
+
+namespace {
+
+// The flusher of the process, if there is one.
+Mutex flusher_mutex;
+StatsDFlusher* flusher = nullptr;
+
+constexpr double kPercentiles[] = {50, 90, 99};
+
+std::string FormatNumber(double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.15g", value);
+  return buffer;
+}
+
+std::string PrometheusName(const std::string& name) {
+  std::string result = name;
+  for (char& c : result) {
+    if (c == '.') c = '_';
+  }
+  return result;
+}
+
+// Converts `value` to an int64_t, unless it is not finite or out of range,
+// where the conversion would be undefined.
+bool ToInt64(double value, int64_t* result) {
+  constexpr double kMin =
+      static_cast<double>(std::numeric_limits<int64_t>::min());
+  if (!std::isfinite(value) || value < kMin || value >= -kMin) return false;
+  *result = static_cast<int64_t>(value);
+  return true;
+}
+
+}  // anonymous namespace
+
+size_t Counter::GetStripeIndex() {
+  static std::atomic<size_t> next_thread_index{0};
+  thread_local const size_t thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return thread_index % kStripeCount;
+}
+
+int64_t Counter::Value() const {
+  int64_t value = 0;
+  for (const Stripe& stripe : stripes_)
+    value += stripe.value.load(std::memory_order_relaxed);
+  return value;
+}
+
+SwappableHistogram::SwappableHistogram() {
+  for (std::unique_ptr<Histogram>& histogram : histograms_)
+    histogram = std::make_unique<Histogram>(Histogram::Options{});
+}
+
+bool SwappableHistogram::Record(int64_t value) {
+  int index = Acquire();
+  bool recorded = histograms_[index]->Record(value);
+  Release(index);
+  return recorded;
+}
+
+int SwappableHistogram::Acquire() const {
+  // Swap() changes current_ before it waits for the users of the previous
+  // histogram, so a thread that registers as a user of a histogram after
+  // Swap() has stopped waiting sees the change and tries again.
+  while (true) {
+    int index = current_.load();
+    users_[index].fetch_add(1);
+    if (current_.load() == index) return index;
+    users_[index].fetch_sub(1);
+  }
+}
+
+void SwappableHistogram::WaitForUsers(int index) const {
+  // Users only hold a histogram for a single Record() or read, so this
+  // does not take long unless one of them is preempted.
+  while (users_[index].load() != 0) uv_sleep(0);
+}
+
+Metric::Metric(std::string name, Type type)
+    : name(std::move(name)), type(type) {
+  if (type == kHistogram) histogram = std::make_unique<SwappableHistogram>();
+}
+
+Registry* Registry::GetProcessRegistry() {
+  // Leaked on purpose, so that Workers and the flusher can still use it
+  // while the process exits.
+  static Registry* registry = new Registry();
+  return registry;
+}
+
+Registry::~Registry() {
+  for (std::atomic<Metric*>& metric : metrics_)
+    delete metric.load(std::memory_order_relaxed);
+}
+
+bool Registry::IsValidName(std::string_view name) {
+  if (name.empty() || (name[0] >= '0' && name[0] <= '9') || name[0] == '.')
+    return false;
+  for (char c : name) {
+    if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+          (c >= '0' && c <= '9') || c == '_' || c == '.')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int Registry::Get(std::string_view name, Metric::Type type) {
+  if (!IsValidName(name)) return -1;
+
+  Mutex::ScopedLock lock(mutex_);
+  std::string key = PrometheusName(std::string(name));
+  auto it = ids_.find(key);
+  if (it != ids_.end()) {
+    const Metric* existing = metric(it->second);
+    return existing->name == name && existing->type == type ? it->second : -1;
+  }
+
+  size_t id = size_.load(std::memory_order_relaxed);
+  if (id == kMaxMetrics) return -1;
+  metrics_[id].store(new Metric(std::string(name), type),
+                     std::memory_order_release);
+  size_.store(id + 1, std::memory_order_release);
+  ids_.emplace(std::move(key), static_cast<int>(id));
+  return static_cast<int>(id);
+}
+
+std::string EncodePrometheus(const Registry& registry) {
+  std::string out;
+  size_t size = registry.size();
+  for (size_t id = 0; id < size; id++) {
+    const Metric* metric = registry.metric(static_cast<int>(id));
+    std::string name = PrometheusName(metric->name);
+    switch (metric->type) {
+      case Metric::kCounter:
+        out += "# TYPE " + name + " counter\n";
+        out += name + " " + std::to_string(metric->counter.Value()) + "\n";
+        break;
+      case Metric::kGauge:
+        out += "# TYPE " + name + " gauge\n";
+        out += name + " " +
+               FormatNumber(metric->gauge.load(std::memory_order_relaxed)) +
+               "\n";
+        break;
+      case Metric::kHistogram: {
+        out += "# TYPE " + name + " summary\n";
+        metric->histogram->Read([&](const Histogram& histogram) {
+          size_t count = histogram.Count();
+          if (count > 0) {
+            for (double percentile : kPercentiles) {
+              out += name + "{quantile=\"" + FormatNumber(percentile / 100) +
+                     "\"} " +
+                     std::to_string(histogram.Percentile(percentile)) + "\n";
+            }
+          }
+          out += name + "_count " + std::to_string(count) + "\n";
+        });
+        break;
+      }
+    }
+  }
+  return out;
+}
+
+StatsDEncoder::StatsDEncoder(std::string prefix, size_t max_packet_size)
+    : prefix_(std::move(prefix)), max_packet_size_(max_packet_size) {}
+
+void StatsDEncoder::AppendLine(const std::string& line,
+                               std::vector<std::string>* packets) {
+  if (packets->empty() ||
+      packets->back().size() + 1 + line.size() > max_packet_size_) {
+    packets->push_back(line);
+  } else {
+    packets->back() += '\n';
+    packets->back() += line;
+  }
+}
+
+void StatsDEncoder::Encode(Registry* registry,
+                           std::vector<std::string>* packets) {
+  size_t size = registry->size();
+  last_counts_.resize(size);
+  for (size_t id = 0; id < size; id++) {
+    Metric* metric = registry->metric(static_cast<int>(id));
+    std::string name = prefix_ + metric->name;
+    switch (metric->type) {
+      case Metric::kCounter: {
+        int64_t value = metric->counter.Value();
+        int64_t delta = value - last_counts_[id];
+        last_counts_[id] = value;
+        if (delta != 0)
+          AppendLine(name + ":" + std::to_string(delta) + "|c", packets);
+        break;
+      }
+      case Metric::kGauge: {
+        double value = metric->gauge.load(std::memory_order_relaxed);
+        // A gauge with a sign is a change of the previous value in StatsD,
+        // so a negative value has to be set from zero.
+        if (value < 0) AppendLine(name + ":0|g", packets);
+        AppendLine(name + ":" + FormatNumber(value) + "|g", packets);
+        break;
+      }
+      case Metric::kHistogram: {
+        metric->histogram->Swap([&](const Histogram& histogram) {
+          size_t count = histogram.Count();
+          if (count == 0) return;
+          AppendLine(name + ".count:" + std::to_string(count) + "|g",
+                     packets);
+          AppendLine(name + ".min:" + std::to_string(histogram.Min()) + "|g",
+                     packets);
+          AppendLine(name + ".max:" + std::to_string(histogram.Max()) + "|g",
+                     packets);
+          AppendLine(name + ".mean:" + FormatNumber(histogram.Mean()) + "|g",
+                     packets);
+          for (double percentile : kPercentiles) {
+            AppendLine(name + ".p" + FormatNumber(percentile) + ":" +
+                           std::to_string(histogram.Percentile(percentile)) +
+                           "|g",
+                       packets);
+          }
+        });
+        break;
+      }
+    }
+  }
+}
+
+StatsDFlusher::StatsDFlusher(const SocketAddress& address,
+                             uint64_t interval_ms,
+                             std::string prefix)
+    : address_(address),
+      interval_ms_(interval_ms),
+      encoder_(std::move(prefix)) {}
+
+int StatsDFlusher::Start(const SocketAddress& address,
+                         uint64_t interval_ms,
+                         std::string prefix) {
+  Mutex::ScopedLock lock(flusher_mutex);
+  if (flusher != nullptr) return UV_EBUSY;
+
+  // The loop is never run while the flusher is active. It only exists
+  // because libuv sockets need one.
+  auto created = std::unique_ptr<StatsDFlusher>(
+      new StatsDFlusher(address, interval_ms, std::move(prefix)));
+  int err = uv_loop_init(&created->loop_);
+  if (err != 0) return err;
+  err = uv_udp_init(&created->loop_, &created->socket_);
+  if (err == 0) {
+    err = uv_thread_create(&created->thread_, ThreadMain, created.get());
+    if (err != 0) {
+      uv_close(reinterpret_cast<uv_handle_t*>(&created->socket_), nullptr);
+      uv_run(&created->loop_, UV_RUN_DEFAULT);
+    }
+  }
+  if (err != 0) {
+    CHECK_EQ(uv_loop_close(&created->loop_), 0);
+    return err;
+  }
+  flusher = created.release();
+  return 0;
+}
+
+void StatsDFlusher::Stop() {
+  Mutex::ScopedLock lock(flusher_mutex);
+  if (flusher == nullptr) return;
+  {
+    Mutex::ScopedLock lock(flusher->mutex_);
+    flusher->stopping_ = true;
+    flusher->wake_.Signal(lock);
+  }
+  CHECK_EQ(uv_thread_join(&flusher->thread_), 0);
+  uv_close(reinterpret_cast<uv_handle_t*>(&flusher->socket_), nullptr);
+  uv_run(&flusher->loop_, UV_RUN_DEFAULT);
+  CHECK_EQ(uv_loop_close(&flusher->loop_), 0);
+  delete flusher;
+  flusher = nullptr;
+}
+
+void StatsDFlusher::ThreadMain(void* data) {
+  StatsDFlusher* self = static_cast<StatsDFlusher*>(data);
+  const uint64_t interval = self->interval_ms_ * 1000000;
+  uint64_t next_flush = uv_hrtime() + interval;
+
+  Mutex::ScopedLock lock(self->mutex_);
+  while (true) {
+    uint64_t now = uv_hrtime();
+    if (!self->stopping_ && now < next_flush) {
+      self->wake_.TimedWait(lock, next_flush - now);
+      continue;
+    }
+    self->Flush();
+    if (self->stopping_) break;
+    next_flush = std::max(next_flush + interval, now);
+  }
+}
+
+void StatsDFlusher::Flush() {
+  std::vector<std::string> packets;
+  encoder_.Encode(Registry::GetProcessRegistry(), &packets);
+  for (std::string& packet : packets) {
+    uv_buf_t buf = uv_buf_init(packet.data(), packet.size());
+    // StatsD is lossy anyway, so a datagram that the socket does not take
+    // right away is dropped.
+    uv_udp_try_send(&socket_, &buf, 1, address_.data());
+  }
+}
+
+namespace {
+
+void Create(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());   // type
+  CHECK(args[1]->IsString());  // name
+  int type = args[0].As<Int32>()->Value();
+  CHECK(type == Metric::kCounter || type == Metric::kGauge ||
+        type == Metric::kHistogram);
+
+  Utf8Value name(env->isolate(), args[1]);
+  int id = Registry::GetProcessRegistry()->Get(
+      name.ToStringView(), static_cast<Metric::Type>(type));
+  if (id == -1) {
+    return THROW_ERR_INVALID_ARG_VALUE(
+        env, "Invalid, conflicting or too many metric names: %s", *name);
+  }
+  args.GetReturnValue().Set(id);
+}
+
+Metric* GetMetric(const FunctionCallbackInfo<Value>& args,
+                  Metric::Type type) {
+  CHECK(args[0]->IsInt32());
+  Metric* metric =
+      Registry::GetProcessRegistry()->metric(args[0].As<Int32>()->Value());
+  CHECK_NOT_NULL(metric);
+  CHECK_EQ(metric->type, type);
+  return metric;
+}
+
+void Add(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[1]->IsNumber());
+  Metric* metric = GetMetric(args, Metric::kCounter);
+  int64_t value;
+  bool added = ToInt64(args[1].As<Number>()->Value(), &value);
+  if (added) metric->counter.Add(value);
+  args.GetReturnValue().Set(added);
+}
+
+void Set(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[1]->IsNumber());
+  GetMetric(args, Metric::kGauge)
+      ->gauge.store(args[1].As<Number>()->Value(), std::memory_order_relaxed);
+}
+
+void Record(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[1]->IsNumber());
+  Metric* metric = GetMetric(args, Metric::kHistogram);
+  int64_t value;
+  // Histograms only take positive values.
+  args.GetReturnValue().Set(ToInt64(args[1].As<Number>()->Value(), &value) &&
+                            value >= 1 && metric->histogram->Record(value));
+}
+
+void GetPrometheusText(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  std::string text = EncodePrometheus(*Registry::GetProcessRegistry());
+  Local<String> result;
+  if (String::NewFromUtf8(env->isolate(),
+                          text.data(),
+                          v8::NewStringType::kNormal,
+                          static_cast<int>(text.size()))
+          .ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
+}
+
+void StartStatsD(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  // startStatsD(address, port, intervalMs, prefix)
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsUint32());
+  CHECK(args[3]->IsString());
+
+  Utf8Value host(env->isolate(), args[0]);
+  SocketAddress address;
+  if (!SocketAddress::New(*host, args[1].As<Uint32>()->Value(), &address))
+    return args.GetReturnValue().Set(UV_EINVAL);
+  uint32_t interval_ms = args[2].As<Uint32>()->Value();
+  if (interval_ms == 0) return args.GetReturnValue().Set(UV_EINVAL);
+
+  Utf8Value prefix(env->isolate(), args[3]);
+  if (prefix.length() > 0 && !Registry::IsValidName(prefix.ToStringView()))
+    return args.GetReturnValue().Set(UV_EINVAL);
+  args.GetReturnValue().Set(
+      StatsDFlusher::Start(address, interval_ms, prefix.ToString()));
+}
+
+void StopStatsD(const FunctionCallbackInfo<Value>& args) {
+  StatsDFlusher::Stop();
+}
+
+}  // anonymous namespace
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context,
+                void* priv) {
+  SetMethod(context, target, "create", Create);
+  SetMethod(context, target, "add", Add);
+  SetMethod(context, target, "set", Set);
+  SetMethod(context, target, "record", Record);
+  SetMethodNoSideEffect(context, target, "getPrometheusText",
+                        GetPrometheusText);
+  SetMethod(context, target, "startStatsD", StartStatsD);
+  SetMethod(context, target, "stopStatsD", StopStatsD);
+
+  Isolate* isolate = context->GetIsolate();
+  Local<Object> constants = Object::New(isolate);
+  constants
+      ->Set(context,
+            FIXED_ONE_BYTE_STRING(isolate, "kCounter"),
+            Integer::New(isolate, Metric::kCounter))
+      .Check();
+  constants
+      ->Set(context,
+            FIXED_ONE_BYTE_STRING(isolate, "kGauge"),
+            Integer::New(isolate, Metric::kGauge))
+      .Check();
+  constants
+      ->Set(context,
+            FIXED_ONE_BYTE_STRING(isolate, "kHistogram"),
+            Integer::New(isolate, Metric::kHistogram))
+      .Check();
+  Environment* env = Environment::GetCurrent(context);
+  target->Set(context, env->constants_string(), constants).Check();
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Create);
+  registry->Register(Add);
+  registry->Register(Set);
+  registry->Register(Record);
+  registry->Register(GetPrometheusText);
+  registry->Register(StartStatsD);
+  registry->Register(StopStatsD);
+}
+
+}  // namespace metrics
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(metrics, node::metrics::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(metrics,
+                                node::metrics::RegisterExternalReferences)
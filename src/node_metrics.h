@@ -0,0 +1,216 @@
+#ifndef SRC_NODE_METRICS_H_
+#define SRC_NODE_METRICS_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "histogram.h"
+#include "node_mutex.h"
+#include "node_sockaddr.h"
+#include "uv.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+
+class ExternalReferenceRegistry;
+
+namespace metrics {
+
+// A counter that many threads can add to without fighting over a cache line.
+// Like Histogram, every thread adds to one of a fixed number of stripes, and
+// the stripes are summed when the counter is read.
+class Counter {
+ public:
+  void Add(int64_t value) {
+    stripes_[GetStripeIndex()].value.fetch_add(value,
+                                               std::memory_order_relaxed);
+  }
+  int64_t Value() const;
+
+ private:
+  static constexpr size_t kStripeCount = 16;
+
+  struct alignas(64) Stripe {
+    std::atomic<int64_t> value{0};
+  };
+
+  static size_t GetStripeIndex();
+
+  Stripe stripes_[kStripeCount];
+};
+
+// A histogram that can be read and reset while other threads record into
+// it. Values go to one of two histograms, and Swap() makes the other one
+// current before it reads and resets the previous one, once no thread uses
+// it anymore, so that resetting never races with recording.
+class SwappableHistogram {
+ public:
+  SwappableHistogram();
+
+  bool Record(int64_t value);
+  // Calls `fn` with the histogram of the values recorded since the last
+  // Swap().
+  template <typename Fn>
+  void Read(Fn&& fn) const {
+    int index = Acquire();
+    fn(*histograms_[index]);
+    Release(index);
+  }
+  // Like Read(), but the values are gone afterwards.
+  template <typename Fn>
+  void Swap(Fn&& fn) {
+    Mutex::ScopedLock lock(swap_mutex_);
+    int previous = current_.load();
+    current_.store(1 - previous);
+    WaitForUsers(previous);
+    fn(*histograms_[previous]);
+    histograms_[previous]->Reset();
+  }
+
+ private:
+  // Returns the index of the current histogram, which is not reset until
+  // Release() is called.
+  int Acquire() const;
+  void Release(int index) const { users_[index].fetch_sub(1); }
+  void WaitForUsers(int index) const;
+
+  std::unique_ptr<Histogram> histograms_[2];
+  std::atomic<int> current_{0};
+  // The number of threads that use each histogram.
+  mutable std::atomic<int> users_[2] = {};
+  // Serializes the calls to Swap().
+  Mutex swap_mutex_;
+};
+
+struct Metric {
+  enum Type : int { kCounter, kGauge, kHistogram };
+
+  Metric(std::string name, Type type);
+
+  const std::string name;
+  const Type type;
+  Counter counter;
+  std::atomic<double> gauge{0};
+  // Only set for kHistogram. Histograms hold the values that were recorded
+  // since the last StatsD flush.
+  std::unique_ptr<SwappableHistogram> histogram;
+};
+
+// The metrics of the process. They are shared by the main thread and all
+// Workers, and updating them never takes a lock.
+class Registry {
+ public:
+  static constexpr size_t kMaxMetrics = 4096;
+
+  Registry() = default;
+  ~Registry();
+  Registry(const Registry&) = delete;
+  Registry& operator=(const Registry&) = delete;
+
+  static Registry* GetProcessRegistry();
+
+  // Metric names are made of ASCII letters, digits, '_' and '.', and do not
+  // start with a digit or a '.', so that they are valid in both StatsD and,
+  // with '.' replaced by '_', Prometheus.
+  static bool IsValidName(std::string_view name);
+
+  // Returns the id of the metric called `name`, creating it if necessary, or
+  // -1 if the name is not valid, a metric of another type has that name,
+  // another metric has the same Prometheus name (e.g. "a.b" and "a_b"), or
+  // there are too many metrics.
+  int Get(std::string_view name, Metric::Type type);
+  // Returns the metric with the given id, or nullptr.
+  Metric* metric(int id) const {
+    if (id < 0 || static_cast<size_t>(id) >= kMaxMetrics) return nullptr;
+    return metrics_[id].load(std::memory_order_acquire);
+  }
+  size_t size() const { return size_.load(std::memory_order_acquire); }
+
+ private:
+  std::atomic<Metric*> metrics_[kMaxMetrics] = {};
+  std::atomic<size_t> size_{0};
+  // Serializes the creation of metrics.
+  Mutex mutex_;
+  // Keyed by Prometheus name.
+  std::unordered_map<std::string, int> ids_;
+};
+
+// Writes the metrics in the Prometheus text exposition format. Histograms
+// become summaries of the values recorded since the last StatsD flush, with
+// a _count but without a _sum, which Histogram does not keep.
+std::string EncodePrometheus(const Registry& registry);
+
+// Turns the metrics into StatsD lines, as datagrams of at most
+// `max_packet_size` bytes. Counters are sent as the change since the last
+// call, gauges as they are, and histograms as gauges for count, min, max,
+// mean and the 50th, 90th and 99th percentile of the values recorded since
+// the last call, after which they are reset.
+class StatsDEncoder {
+ public:
+  static constexpr size_t kDefaultPacketSize = 1432;
+
+  explicit StatsDEncoder(std::string prefix,
+                         size_t max_packet_size = kDefaultPacketSize);
+
+  void Encode(Registry* registry, std::vector<std::string>* packets);
+
+ private:
+  void AppendLine(const std::string& line, std::vector<std::string>* packets);
+
+  const std::string prefix_;
+  const size_t max_packet_size_;
+  std::vector<int64_t> last_counts_;
+};
+
+// Sends the metrics of the process to a StatsD agent every `interval_ms`
+// milliseconds, from a background thread. There is at most one flusher per
+// process, so that Workers do not send the same metrics more than once.
+class StatsDFlusher {
+ public:
+  // Returns UV_EBUSY if a flusher is already running.
+  static int Start(const SocketAddress& address,
+                   uint64_t interval_ms,
+                   std::string prefix);
+  // Sends the metrics one last time and stops the flusher, if one is
+  // running.
+  static void Stop();
+
+ private:
+  StatsDFlusher(const SocketAddress& address,
+                uint64_t interval_ms,
+                std::string prefix);
+
+  static void ThreadMain(void* data);
+  void Flush();
+
+  uv_thread_t thread_;
+  const SocketAddress address_;
+  const uint64_t interval_ms_;
+  StatsDEncoder encoder_;
+  uv_loop_t loop_;
+  uv_udp_t socket_;
+
+  Mutex mutex_;
+  ConditionVariable wake_;
+  bool stopping_ = false;
+};
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> unused,
+                v8::Local<v8::Context> context,
+                void* priv);
+void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+}  // namespace metrics
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_METRICS_H_
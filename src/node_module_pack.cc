@@ -0,0 +1,691 @@
+#include "node_module_pack.h"
+
+#include "ada.h"
+#include "debug_utils-inl.h"
+#include "env-inl.h"
+#include "node_contextify.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "node_internals.h"
+#include "node_modules.h"
+#include "node_options.h"
+#include "node_sea.h"
+#include "node_url.h"
+#include "path.h"
+#include "permission/permission.h"
+#include "util-inl.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#ifndef S_ISDIR
+#define S_ISDIR(mode) (((mode) & S_IFMT) == S_IFDIR)
+#endif
+
+#ifndef S_ISREG
+#define S_ISREG(mode) (((mode) & S_IFMT) == S_IFREG)
+#endif
+
+namespace node {
+namespace module_pack {
+
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::Module;
+using v8::NewStringType;
+using v8::Object;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::String;
+using v8::TryCatch;
+using v8::Value;
+
+namespace {
+
+constexpr size_t kHeaderSize = 4 * sizeof(uint32_t);
+// V8 copies code cache that is not aligned to a pointer.
+constexpr size_t kCodeCacheAlignment = 8;
+constexpr char kSeaAssetName[] = "node:module-pack";
+// Guards against directory links that point to their parents.
+constexpr int kMaxDepth = 64;
+
+struct EntryRecord {
+  uint32_t path_offset;
+  uint32_t path_length;
+  uint32_t kind;
+  uint32_t reserved;
+  uint64_t data_offset;
+  uint64_t data_size;
+  uint64_t cache_offset;
+  uint64_t cache_size;
+  uint64_t mtime_ns;
+};
+
+static_assert(sizeof(EntryRecord) == 56);
+
+uint64_t MTime(const uv_stat_t& stat) {
+  return static_cast<uint64_t>(stat.st_mtim.tv_sec) * 1000000000 +
+         stat.st_mtim.tv_nsec;
+}
+
+EntryRecord ReadRecord(std::string_view data, size_t index) {
+  EntryRecord record;
+  memcpy(&record,
+         data.data() + kHeaderSize + index * sizeof(record),
+         sizeof(record));
+  return record;
+}
+
+bool InBounds(std::string_view data, uint64_t offset, uint64_t size) {
+  return offset <= data.size() && size <= data.size() - offset;
+}
+
+// Paths with empty, "." or ".." segments are left to the file system.
+bool IsNormalized(std::string_view path) {
+  size_t start = 0;
+  while (true) {
+    const size_t end = path.find('/', start);
+    std::string_view segment = path.substr(start, end - start);
+    if (segment.empty() || segment == "." || segment == "..") return false;
+    if (end == std::string_view::npos) return true;
+    start = end + 1;
+  }
+}
+
+bool IsAbsolute(std::string_view path) {
+#ifdef _WIN32
+  if (path.size() > 2 && path[1] == ':' && IsPathSeparator(path[2]))
+    return true;
+  return path.size() > 1 && IsPathSeparator(path[0]) &&
+         IsPathSeparator(path[1]);
+#else
+  return path.starts_with('/');
+#endif
+}
+
+std::string DirName(const std::string& path) {
+  size_t end = path.size();
+  while (end > 0 && !IsPathSeparator(path[end - 1])) end--;
+  while (end > 1 && IsPathSeparator(path[end - 1])) end--;
+  return path.substr(0, end);
+}
+
+std::unique_ptr<ModulePack> LoadFile(const std::string& filename) {
+  std::string path = filename;
+  if (!IsAbsolute(path)) {
+    char cwd[PATH_MAX_BYTES];
+    size_t size = sizeof(cwd);
+    if (uv_cwd(cwd, &size) == 0)
+      path = std::string(cwd, size) + kPathSeparator + path;
+  }
+
+  std::string_view data;
+#ifdef _WIN32
+  // Entries point into the contents until the process exits.
+  std::string* contents = new std::string();
+  int err = node::ReadFileSync(contents, path.c_str());
+  if (err < 0) {
+    FPrintF(stderr,
+            "Warning: could not read module pack %s: %s\n",
+            path,
+            uv_strerror(err));
+    return nullptr;
+  }
+  data = *contents;
+#else
+  uv_fs_t req;
+  auto defer_req_cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  uv_file file = uv_fs_open(nullptr, &req, path.c_str(), O_RDONLY, 0, nullptr);
+  if (req.result < 0) {
+    FPrintF(stderr,
+            "Warning: could not open module pack %s: %s\n",
+            path,
+            uv_strerror(req.result));
+    return nullptr;
+  }
+  uv_fs_req_cleanup(&req);
+
+  // The mapping stays valid after the file is closed, and is never unmapped.
+  auto defer_close = OnScopeLeave([file]() {
+    uv_fs_t close_req;
+    CHECK_EQ(0, uv_fs_close(nullptr, &close_req, file, nullptr));
+    uv_fs_req_cleanup(&close_req);
+  });
+  if (uv_fs_fstat(nullptr, &req, file, nullptr) < 0) {
+    FPrintF(stderr,
+            "Warning: could not open module pack %s: %s\n",
+            path,
+            uv_strerror(req.result));
+    return nullptr;
+  }
+  const size_t size = req.statbuf.st_size;
+  if (size > 0) {
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (mapping == MAP_FAILED) {
+      FPrintF(stderr,
+              "Warning: could not map module pack %s: %s\n",
+              path,
+              uv_strerror(uv_translate_sys_error(errno)));
+      return nullptr;
+    }
+    data = std::string_view(static_cast<const char*>(mapping), size);
+  }
+#endif
+
+  std::unique_ptr<ModulePack> pack = ModulePack::Parse(DirName(path), data);
+  if (!pack) {
+    FPrintF(stderr, "Warning: %s is not a valid module pack\n", path);
+    return nullptr;
+  }
+  // The pack sits next to the tree that it was built from, which can still
+  // change. A single executable application carries the only copy.
+  pack->CheckAgainstDisk();
+  return pack;
+}
+
+std::unique_ptr<ModulePack> Load() {
+  const std::string& filename =
+      per_process::cli_options->experimental_module_pack;
+  if (!filename.empty()) return LoadFile(filename);
+
+#ifndef DISABLE_SINGLE_EXECUTABLE_APPLICATION
+  if (sea::IsSingleExecutable()) {
+    sea::SeaResource sea = sea::FindSingleExecutableResource();
+    auto it = sea.assets.find(kSeaAssetName);
+    if (it == sea.assets.end()) return nullptr;
+    // The pack is mounted where the executable is.
+    char exec_path[PATH_MAX_BYTES];
+    size_t size = sizeof(exec_path);
+    if (uv_exepath(exec_path, &size) != 0) return nullptr;
+    std::unique_ptr<ModulePack> pack =
+        ModulePack::Parse(DirName(std::string(exec_path, size)), it->second);
+    if (!pack) {
+      FPrintF(stderr,
+              "Warning: the %s asset is not a valid module pack\n",
+              kSeaAssetName);
+    }
+    return pack;
+  }
+#endif
+
+  return nullptr;
+}
+
+ScriptCompiler::CachedData* NewCachedData(std::string_view path) {
+  Entry entry;
+  if (Lookup(path, &entry) != LookupResult::kFound ||
+      entry.code_cache.empty()) {
+    return nullptr;
+  }
+  return new ScriptCompiler::CachedData(
+      reinterpret_cast<const uint8_t*>(entry.code_cache.data()),
+      static_cast<int>(entry.code_cache.size()),
+      ScriptCompiler::CachedData::BufferNotOwned);
+}
+
+// Walks a directory tree for buildModulePack().
+class PackWalker {
+ public:
+  PackWalker(Realm* realm, bool with_code_cache, std::string output)
+      : realm_(realm),
+        with_code_cache_(with_code_cache),
+        output_(std::move(output)) {}
+
+  // Returns 0, or the libuv error that stopped the walk.
+  int Walk(const std::string& directory,
+           const std::string& relative,
+           int depth);
+
+  ModulePackBuilder* builder() { return &builder_; }
+  const char* error_syscall() const { return error_syscall_; }
+  const std::string& error_path() const { return error_path_; }
+
+ private:
+  int AddFile(const std::string& path, const std::string& relative);
+  std::string CreateCodeCache(const std::string& path,
+                              const std::string& contents);
+  bool IsESM(const std::string& path);
+
+  int Fail(int err, const char* syscall, const std::string& path) {
+    error_syscall_ = syscall;
+    error_path_ = path;
+    return err;
+  }
+
+  Realm* realm_;
+  const bool with_code_cache_;
+  const std::string output_;
+  ModulePackBuilder builder_;
+  const char* error_syscall_ = nullptr;
+  std::string error_path_;
+};
+
+int PackWalker::Walk(const std::string& directory,
+                     const std::string& relative,
+                     int depth) {
+  if (depth > kMaxDepth) return Fail(UV_ELOOP, "scandir", directory);
+
+  uv_fs_t req;
+  auto defer_req_cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  int err = uv_fs_scandir(nullptr, &req, directory.c_str(), 0, nullptr);
+  if (err < 0) return Fail(err, "scandir", directory);
+
+  uv_dirent_t dirent;
+  while (uv_fs_scandir_next(&req, &dirent) != UV_EOF) {
+    const std::string path = directory + kPathSeparator + dirent.name;
+    const std::string child =
+        relative.empty() ? dirent.name : relative + '/' + dirent.name;
+    uv_dirent_type_t type = dirent.type;
+    if (type == UV_DIRENT_LINK || type == UV_DIRENT_UNKNOWN) {
+      // Links are packed as what they point to.
+      uv_fs_t stat_req;
+      err = uv_fs_stat(nullptr, &stat_req, path.c_str(), nullptr);
+      const bool is_directory = S_ISDIR(stat_req.statbuf.st_mode);
+      const bool is_file = S_ISREG(stat_req.statbuf.st_mode);
+      uv_fs_req_cleanup(&stat_req);
+      if (err == UV_ENOENT) continue;
+      if (err < 0) return Fail(err, "stat", path);
+      type = is_directory ? UV_DIRENT_DIR
+                          : (is_file ? UV_DIRENT_FILE : UV_DIRENT_UNKNOWN);
+    }
+
+    if (type == UV_DIRENT_DIR) {
+      builder_.AddDirectory(child);
+      err = Walk(path, child, depth + 1);
+    } else if (type == UV_DIRENT_FILE && path != output_) {
+      err = AddFile(path, child);
+    }
+    if (err < 0) return err;
+  }
+  return 0;
+}
+
+int PackWalker::AddFile(const std::string& path, const std::string& relative) {
+  if (!path.ends_with(".js") && !path.ends_with(".cjs") &&
+      !path.ends_with(".mjs") && !path.ends_with(".json")) {
+    builder_.AddExternal(relative);
+    return 0;
+  }
+
+  // Stat first, so that a change while the file is read makes the packed
+  // copy out of date rather than record the time of the new contents.
+  uv_fs_t req;
+  int err = uv_fs_stat(nullptr, &req, path.c_str(), nullptr);
+  const uint64_t mtime_ns = MTime(req.statbuf);
+  uv_fs_req_cleanup(&req);
+  if (err < 0) return Fail(err, "stat", path);
+
+  std::string contents;
+  err = node::ReadFileSync(&contents, path.c_str());
+  if (err < 0) return Fail(err, "open", path);
+  std::string code_cache;
+  if (with_code_cache_ && !path.ends_with(".json"))
+    code_cache = CreateCodeCache(path, contents);
+  builder_.AddFile(
+      relative, std::move(contents), std::move(code_cache), mtime_ns);
+  return 0;
+}
+
+bool PackWalker::IsESM(const std::string& path) {
+  if (path.ends_with(".mjs")) return true;
+  if (path.ends_with(".cjs")) return false;
+  const modules::BindingData::PackageConfig* package_config =
+      modules::BindingData::TraverseParent(realm_, std::filesystem::path(path));
+  return package_config != nullptr && package_config->type == "module";
+}
+
+// Files that do not compile, e.g. ES modules that rely on syntax detection,
+// are packed without code cache.
+std::string PackWalker::CreateCodeCache(const std::string& path,
+                                        const std::string& contents) {
+  Isolate* isolate = realm_->isolate();
+  HandleScope handle_scope(isolate);
+  TryCatch try_catch(isolate);
+  Local<Context> context = realm_->context();
+
+  Local<String> source;
+  Local<String> filename;
+  if (!String::NewFromUtf8(isolate,
+                           contents.data(),
+                           NewStringType::kNormal,
+                           contents.size())
+           .ToLocal(&source) ||
+      !String::NewFromUtf8(
+           isolate, path.data(), NewStringType::kNormal, path.size())
+           .ToLocal(&filename)) {
+    return {};
+  }
+
+  std::unique_ptr<ScriptCompiler::CachedData> cache;
+  if (IsESM(path)) {
+    ScriptOrigin origin(filename,
+                        0,               // line offset
+                        0,               // column offset
+                        true,            // is cross origin
+                        -1,              // script id
+                        Local<Value>(),  // source map URL
+                        false,           // is opaque
+                        false,           // is WASM
+                        true);           // is ES Module
+    ScriptCompiler::Source module_source(source, origin);
+    Local<Module> module;
+    if (!ScriptCompiler::CompileModule(isolate, &module_source)
+             .ToLocal(&module)) {
+      return {};
+    }
+    cache.reset(
+        ScriptCompiler::CreateCodeCache(module->GetUnboundModuleScript()));
+  } else {
+    std::vector<Local<String>> params =
+        contextify::GetCJSParameters(realm_->isolate_data());
+    Local<Function> fn;
+    if (!contextify::CompileFunction(context, filename, source, &params)
+             .ToLocal(&fn)) {
+      return {};
+    }
+    cache.reset(ScriptCompiler::CreateCodeCacheForFunction(fn));
+  }
+  if (!cache) return {};
+  return std::string(reinterpret_cast<const char*>(cache->data),
+                     cache->length);
+}
+
+// buildModulePack(root, output, withCodeCache)
+// Packs the directory tree at `root` into the file `output`, and returns the
+// number of entries.
+void BuildModulePack(const FunctionCallbackInfo<Value>& args) {
+  Realm* realm = Realm::GetCurrent(args);
+  Environment* env = realm->env();
+  Isolate* isolate = realm->isolate();
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  Utf8Value root(isolate, args[0]);
+  Utf8Value output(isolate, args[1]);
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, root.ToStringView());
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env,
+      permission::PermissionScope::kFileSystemWrite,
+      output.ToStringView());
+
+  std::string directory = root.ToString();
+  while (directory.size() > 1 && IsPathSeparator(directory.back()))
+    directory.pop_back();
+  PackWalker walker(realm, args[2]->IsTrue(), output.ToString());
+  int err = walker.Walk(directory, "", 0);
+  if (err < 0) {
+    return env->ThrowUVException(
+        err, walker.error_syscall(), nullptr, walker.error_path().c_str());
+  }
+
+  std::string pack = walker.builder()->Finish();
+  err = WriteFileSync(*output, uv_buf_init(pack.data(), pack.size()));
+  if (err < 0) return env->ThrowUVException(err, "open", nullptr, *output);
+  args.GetReturnValue().Set(
+      static_cast<double>(walker.builder()->entry_count()));
+}
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context,
+                void* priv) {
+  SetMethod(context, target, "buildModulePack", BuildModulePack);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(BuildModulePack);
+}
+
+}  // anonymous namespace
+
+ModulePack::ModulePack(std::string root,
+                       std::string_view data,
+                       size_t entry_count)
+    : root_(std::move(root)),
+      data_(data),
+      entry_count_(entry_count),
+      freshness_(new std::atomic<uint8_t>[entry_count]) {
+  for (size_t i = 0; i < entry_count; i++) freshness_[i] = kUnchecked;
+}
+
+const ModulePack* ModulePack::Get() {
+  // Never freed, the entries that it hands out point into it.
+  static const ModulePack* pack = Load().release();
+  return pack;
+}
+
+std::unique_ptr<ModulePack> ModulePack::Parse(std::string root,
+                                              std::string_view data) {
+  CHECK(!root.empty());
+  if (data.size() < kHeaderSize) return nullptr;
+  uint32_t header[4];
+  memcpy(header, data.data(), sizeof(header));
+  if (header[0] != kMagic || header[1] != kVersion) return nullptr;
+  const size_t entry_count = header[2];
+  if (entry_count > (data.size() - kHeaderSize) / sizeof(EntryRecord))
+    return nullptr;
+
+  // Only the index is touched here, the contents are paged in when (and if)
+  // they are used.
+  std::string_view previous;
+  for (size_t i = 0; i < entry_count; i++) {
+    const EntryRecord record = ReadRecord(data, i);
+    if (record.kind > static_cast<uint32_t>(EntryKind::kExternal) ||
+        !InBounds(data, record.path_offset, record.path_length) ||
+        !InBounds(data, record.data_offset, record.data_size) ||
+        !InBounds(data, record.cache_offset, record.cache_size)) {
+      return nullptr;
+    }
+    // Lookups are binary searches.
+    std::string_view path = data.substr(record.path_offset,
+                                        record.path_length);
+    if (i > 0 && path <= previous) return nullptr;
+    previous = path;
+  }
+
+  return std::unique_ptr<ModulePack>(
+      new ModulePack(std::move(root), data, entry_count));
+}
+
+std::string_view ModulePack::Path(size_t index) const {
+  const EntryRecord record = ReadRecord(data_, index);
+  return data_.substr(record.path_offset, record.path_length);
+}
+
+Entry ModulePack::GetEntry(size_t index) const {
+  const EntryRecord record = ReadRecord(data_, index);
+  Entry entry{static_cast<EntryKind>(record.kind), {}, {}};
+  if (entry.kind == EntryKind::kFile) {
+    entry.contents = data_.substr(record.data_offset, record.data_size);
+    entry.code_cache = data_.substr(record.cache_offset, record.cache_size);
+  }
+  return entry;
+}
+
+LookupResult ModulePack::Lookup(std::string_view path, Entry* entry) const {
+#ifdef _WIN32
+  if (path.starts_with("\\\\?\\")) path.remove_prefix(4);
+#endif
+  if (!path.starts_with(root_)) return LookupResult::kOutside;
+  std::string_view relative = path.substr(root_.size());
+  if (!relative.empty() && !IsPathSeparator(root_.back())) {
+    if (!IsPathSeparator(relative[0])) return LookupResult::kOutside;
+    relative.remove_prefix(1);
+  }
+  if (relative.empty()) {
+    *entry = {EntryKind::kDirectory, {}, {}};
+    return LookupResult::kFound;
+  }
+
+#ifdef _WIN32
+  std::string key(relative);
+  std::replace(key.begin(), key.end(), '\\', '/');
+#else
+  std::string_view key = relative;
+#endif
+  if (!IsNormalized(key)) return LookupResult::kOutside;
+
+  size_t low = 0;
+  size_t high = entry_count_;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    const int comparison = Path(middle).compare(key);
+    if (comparison == 0) {
+      *entry = GetEntry(middle);
+      if (entry->kind == EntryKind::kFile && !IsUpToDate(middle, path))
+        return LookupResult::kNotFound;
+      return LookupResult::kFound;
+    }
+    if (comparison < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return LookupResult::kNotFound;
+}
+
+bool ModulePack::IsUpToDate(size_t index, std::string_view path) const {
+  if (!check_disk_) return true;
+  const EntryRecord record = ReadRecord(data_, index);
+  if (record.mtime_ns == 0) return true;
+
+  // A file is only checked once. Racing threads stat it both, and agree.
+  uint8_t freshness = freshness_[index].load(std::memory_order_relaxed);
+  if (freshness == kUnchecked) {
+    uv_fs_t req;
+    const int err =
+        uv_fs_stat(nullptr, &req, std::string(path).c_str(), nullptr);
+    const bool up_to_date = err == 0 &&
+                            req.statbuf.st_size == record.data_size &&
+                            MTime(req.statbuf) == record.mtime_ns;
+    uv_fs_req_cleanup(&req);
+    freshness = up_to_date ? kUpToDate : kOutOfDate;
+    freshness_[index].store(freshness, std::memory_order_relaxed);
+  }
+  return freshness == kUpToDate;
+}
+
+void ModulePackBuilder::AddDirectory(const std::string& path) {
+  entries_[path] = {EntryKind::kDirectory, {}, {}, 0};
+}
+
+void ModulePackBuilder::AddFile(const std::string& path,
+                                std::string contents,
+                                std::string code_cache,
+                                uint64_t mtime_ns) {
+  entries_[path] = {
+      EntryKind::kFile, std::move(contents), std::move(code_cache), mtime_ns};
+}
+
+void ModulePackBuilder::AddExternal(const std::string& path) {
+  entries_[path] = {EntryKind::kExternal, {}, {}, 0};
+}
+
+std::string ModulePackBuilder::Finish() const {
+  const size_t entry_count = entries_.size();
+  CHECK_LE(entry_count, UINT32_MAX);
+  const size_t base = kHeaderSize + entry_count * sizeof(EntryRecord);
+  std::vector<EntryRecord> records(entry_count, EntryRecord{});
+  std::string blob;
+
+  // The paths come first, so that the index and the paths that lookups
+  // compare with are close together.
+  size_t i = 0;
+  for (const auto& [path, entry] : entries_) {
+    CHECK_LE(base + blob.size() + path.size(), UINT32_MAX);
+    records[i].path_offset = base + blob.size();
+    records[i].path_length = path.size();
+    records[i].kind = static_cast<uint32_t>(entry.kind);
+    blob += path;
+    i++;
+  }
+  i = 0;
+  for (const auto& [path, entry] : entries_) {
+    records[i].data_offset = base + blob.size();
+    records[i].data_size = entry.contents.size();
+    records[i].mtime_ns = entry.mtime_ns;
+    blob += entry.contents;
+    i++;
+  }
+  i = 0;
+  for (const auto& [path, entry] : entries_) {
+    if (!entry.code_cache.empty()) {
+      blob.resize(RoundUp(base + blob.size(), kCodeCacheAlignment) - base);
+      records[i].cache_offset = base + blob.size();
+      records[i].cache_size = entry.code_cache.size();
+      blob += entry.code_cache;
+    }
+    i++;
+  }
+
+  std::string result(base, '\0');
+  const uint32_t header[4] = {
+      ModulePack::kMagic,
+      ModulePack::kVersion,
+      static_cast<uint32_t>(entry_count),
+      0};
+  memcpy(result.data(), header, sizeof(header));
+  if (entry_count > 0) {
+    memcpy(result.data() + kHeaderSize,
+           records.data(),
+           entry_count * sizeof(EntryRecord));
+  }
+  return result + blob;
+}
+
+LookupResult Lookup(std::string_view path, Entry* entry) {
+  const ModulePack* pack = ModulePack::Get();
+  if (pack == nullptr) return LookupResult::kOutside;
+  return pack->Lookup(path, entry);
+}
+
+int ReadFileSync(std::string* result, const char* path) {
+  Entry entry;
+  if (Lookup(path, &entry) == LookupResult::kFound &&
+      entry.kind == EntryKind::kFile) {
+    result->assign(entry.contents);
+    return 0;
+  }
+  return node::ReadFileSync(result, path);
+}
+
+ScriptCompiler::CachedData* GetCodeCache(Isolate* isolate,
+                                         Local<String> filename) {
+  if (ModulePack::Get() == nullptr) return nullptr;
+  Utf8Value path(isolate, filename);
+  return NewCachedData(path.ToStringView());
+}
+
+ScriptCompiler::CachedData* GetCodeCacheForURL(Environment* env,
+                                               Local<String> url) {
+  if (ModulePack::Get() == nullptr) return nullptr;
+  Utf8Value href(env->isolate(), url);
+  auto file_url = ada::parse<ada::url_aggregator>(href.ToStringView());
+  if (!file_url || file_url->type != ada::scheme::FILE) return nullptr;
+  std::optional<std::string> path;
+  {
+    TryCatch try_catch(env->isolate());
+    path = url::FileURLToPath(env, *file_url);
+  }
+  if (!path.has_value()) return nullptr;
+  return NewCachedData(*path);
+}
+
+}  // namespace module_pack
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(module_pack,
+                                    node::module_pack::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(module_pack,
+                                node::module_pack::RegisterExternalReferences)
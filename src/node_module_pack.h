@@ -0,0 +1,153 @@
+#ifndef SRC_NODE_MODULE_PACK_H_
+#define SRC_NODE_MODULE_PACK_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "v8.h"
+
+namespace node {
+
+class Environment;
+
+namespace module_pack {
+
+// A module pack is a single file with the sources, package.json files and
+// code cache of a directory tree, typically an application together with
+// its node_modules. It is mounted at a directory, usually the one that it
+// was built from, and for the paths below that directory the loaders take
+// what they stat and read from the pack instead of the file system.
+//
+// Paths that are not in the pack are left to the file system. A pack that
+// is mounted from a file also checks each packed file against the file
+// system the first time that it is looked up, and leaves files that have
+// changed since they were packed to it as well. Files that were not worth
+// packing, e.g. native addons, are listed as external and are still read
+// from disk.
+//
+// The file is laid out as follows, in native byte order:
+//
+//   uint32_t magic, version, entry count, reserved
+//   entry count * {
+//     uint32_t path offset, path length, kind, reserved
+//     uint64_t data offset, data size, code cache offset, code cache size
+//     uint64_t modification time in nanoseconds, or 0 if it is unknown
+//   }
+//   the paths, contents and code caches that the entries point to
+//
+// The paths are relative to the mount point, use '/' as the separator, and
+// the entries are sorted by them.
+enum class EntryKind : uint32_t {
+  kDirectory = 0,
+  kFile = 1,
+  kExternal = 2,
+};
+
+struct Entry {
+  EntryKind kind;
+  // Empty unless `kind` is kFile. These point into the pack, which lives
+  // as long as the process.
+  std::string_view contents;
+  std::string_view code_cache;
+};
+
+enum class LookupResult {
+  // The path is outside of the pack's directory.
+  kOutside,
+  // The pack does not have the path, or its copy of it is out of date.
+  kNotFound,
+  kFound,
+};
+
+class ModulePack {
+ public:
+  static constexpr uint32_t kMagic = 0x4b41504e;  // "NPAK"
+  static constexpr uint32_t kVersion = 2;
+
+  // Returns the pack of the process, from
+  // --experimental-module-pack=<file> or from the "node:module-pack" asset
+  // of a single executable application, or nullptr if there is none.
+  static const ModulePack* Get();
+
+  // Returns nullptr if `data` is not a valid pack. `data` has to outlive
+  // the pack.
+  static std::unique_ptr<ModulePack> Parse(std::string root,
+                                           std::string_view data);
+
+  LookupResult Lookup(std::string_view path, Entry* entry) const;
+
+  // Makes Lookup() compare the size and modification time of packed files
+  // with those on disk.
+  void CheckAgainstDisk() { check_disk_ = true; }
+
+  const std::string& root() const { return root_; }
+  size_t entry_count() const { return entry_count_; }
+
+ private:
+  ModulePack(std::string root, std::string_view data, size_t entry_count);
+
+  std::string_view Path(size_t index) const;
+  Entry GetEntry(size_t index) const;
+  bool IsUpToDate(size_t index, std::string_view path) const;
+
+  enum Freshness : uint8_t { kUnchecked, kUpToDate, kOutOfDate };
+
+  std::string root_;
+  std::string_view data_;
+  size_t entry_count_;
+  bool check_disk_ = false;
+  // Lookups can happen on any thread.
+  std::unique_ptr<std::atomic<uint8_t>[]> freshness_;
+};
+
+// Serializes a pack.
+class ModulePackBuilder {
+ public:
+  void AddDirectory(const std::string& path);
+  void AddFile(const std::string& path,
+               std::string contents,
+               std::string code_cache = {},
+               uint64_t mtime_ns = 0);
+  void AddExternal(const std::string& path);
+
+  size_t entry_count() const { return entries_.size(); }
+  std::string Finish() const;
+
+ private:
+  struct PendingEntry {
+    EntryKind kind;
+    std::string contents;
+    std::string code_cache;
+    uint64_t mtime_ns;
+  };
+
+  std::map<std::string, PendingEntry> entries_;
+};
+
+// Looks `path` up in the pack of the process, see ModulePack::Get().
+LookupResult Lookup(std::string_view path, Entry* entry);
+
+// Like node::ReadFileSync(), but takes the files in the pack of the process
+// from it, and the others from disk.
+int ReadFileSync(std::string* result, const char* path);
+
+// Return the code cache that the pack of the process has for a CommonJS
+// module with the given filename, or for an ES module with the given URL,
+// or nullptr. The CachedData does not own its buffer.
+v8::ScriptCompiler::CachedData* GetCodeCache(v8::Isolate* isolate,
+                                             v8::Local<v8::String> filename);
+v8::ScriptCompiler::CachedData* GetCodeCacheForURL(Environment* env,
+                                                   v8::Local<v8::String> url);
+
+}  // namespace module_pack
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_MODULE_PACK_H_
@@ -1,8 +1,10 @@
 #include "node_modules.h"
 #include <cstdio>
 #include "base_object-inl.h"
+#include "compile_cache.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "node_module_pack.h"
 #include "node_url.h"
 #include "permission/permission.h"
 #include "permission/permission_base.h"
@@ -84,6 +86,47 @@ Local<Array> BindingData::PackageConfig::Serialize(Realm* realm) const {
   return Array::New(isolate, values, 6);
 }
 
+// Layout of a cache record: the type, followed by a presence byte and (if
+// present) the value of name, main, exports, imports and scripts, where
+// strings are encoded as a uint32_t length followed by the content.
+std::string BindingData::PackageConfig::ToCacheRecord() const {
+  std::string record;
+  const auto append_string = [&record](std::string_view str) {
+    uint32_t size = static_cast<uint32_t>(str.size());
+    record.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    record.append(str);
+  };
+  append_string(type);
+  for (const auto* field : {&name, &main, &exports, &imports, &scripts}) {
+    record.push_back(field->has_value() ? 1 : 0);
+    if (field->has_value()) append_string(field->value());
+  }
+  return record;
+}
+
+bool BindingData::PackageConfig::FromCacheRecord(std::string_view record,
+                                                 PackageConfig* out) {
+  const auto read_string = [&record](std::string* str) {
+    uint32_t size;
+    if (record.size() < sizeof(size)) return false;
+    memcpy(&size, record.data(), sizeof(size));
+    record.remove_prefix(sizeof(size));
+    if (record.size() < size) return false;
+    str->assign(record.data(), size);
+    record.remove_prefix(size);
+    return true;
+  };
+  if (!read_string(&out->type)) return false;
+  for (auto* field :
+       {&out->name, &out->main, &out->exports, &out->imports, &out->scripts}) {
+    if (record.empty()) return false;
+    bool present = record[0] != 0;
+    record.remove_prefix(1);
+    if (present && !read_string(&field->emplace())) return false;
+  }
+  return record.empty();
+}
+
 const BindingData::PackageConfig* BindingData::GetPackageJSON(
     Realm* realm, std::string_view path, ErrorContext* error_context) {
   auto binding_data = realm->GetBindingData<BindingData>();
@@ -95,8 +138,41 @@ const BindingData::PackageConfig* BindingData::GetPackageJSON(
 
   PackageConfig package_config{};
   package_config.file_path = path;
+
+  // When the compile cache is enabled, a stat() is usually enough to reuse
+  // what a previous process has parsed.
+  Environment* env = realm->env();
+  module_pack::Entry entry;
+  const bool from_pack =
+      module_pack::Lookup(path, &entry) == module_pack::LookupResult::kFound &&
+      entry.kind == module_pack::EntryKind::kFile;
+  const bool use_disk_cache = env->use_compile_cache() && !from_pack;
+  uv_stat_t stat{};
+  if (use_disk_cache) {
+    uv_fs_t req;
+    int err = uv_fs_stat(nullptr, &req, package_config.file_path.c_str(),
+                         nullptr);
+    stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+      return nullptr;
+    }
+    const std::string* record = env->compile_cache_handler()->GetPackageJSON(
+        package_config.file_path, &stat);
+    if (record != nullptr &&
+        PackageConfig::FromCacheRecord(*record, &package_config)) {
+      auto cached = binding_data->package_configs_.insert(
+          {std::string(path), std::move(package_config)});
+      return &cached.first->second;
+    }
+    package_config = PackageConfig{};
+    package_config.file_path = path;
+  }
+
   // No need to exclude BOM since simdjson will skip it.
-  if (ReadFileSync(&package_config.raw_json, path.data()) < 0) {
+  if (from_pack) {
+    package_config.raw_json = entry.contents;
+  } else if (ReadFileSync(&package_config.raw_json, path.data()) < 0) {
     return nullptr;
   }
 
@@ -226,6 +302,11 @@ const BindingData::PackageConfig* BindingData::GetPackageJSON(
       }
     }
   }
+  if (use_disk_cache) {
+    env->compile_cache_handler()->SavePackageJSON(
+        package_config.file_path, &stat, package_config.ToCacheRecord());
+  }
+
   // package_config could be quite large, so we should move it instead of
   // copying it.
   auto cached = binding_data->package_configs_.insert(
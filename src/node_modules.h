@@ -36,6 +36,11 @@ class BindingData : public SnapshotableObject {
     std::string raw_json;
 
     v8::Local<v8::Array> Serialize(Realm* realm) const;
+
+    // Conversion from and to the records stored in the on-disk package.json
+    // cache of the CompileCacheHandler. raw_json is not part of the record.
+    std::string ToCacheRecord() const;
+    static bool FromCacheRecord(std::string_view record, PackageConfig* out);
   };
 
   struct ErrorContext {
@@ -72,6 +77,11 @@ class BindingData : public SnapshotableObject {
                                          void* priv);
   static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
 
+  // Returns the nearest package.json above `check_path`, from the cache if
+  // it has been read before, or nullptr if there is none.
+  static const PackageConfig* TraverseParent(
+      Realm* realm, const std::filesystem::path& check_path);
+
  private:
   std::unordered_map<std::string, PackageConfig> package_configs_;
   simdjson::ondemand::parser json_parser;
@@ -80,8 +90,6 @@ class BindingData : public SnapshotableObject {
       Realm* realm,
       std::string_view path,
       ErrorContext* error_context = nullptr);
-  static const PackageConfig* TraverseParent(
-      Realm* realm, const std::filesystem::path& check_path);
 };
 
 }  // namespace modules
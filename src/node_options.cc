@@ -5,6 +5,7 @@
 #include "node_binding.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_report.h"
 #include "node_sea.h"
 #if HAVE_OPENSSL
 #include "openssl/opensslv.h"
@@ -92,11 +93,23 @@ void PerProcessOptions::CheckOptions(std::vector<std::string>* errors,
   }
 #endif  // HAVE_OPENSSL
 
+  if (worker_heap_budget > 100)
+    errors->push_back("--worker-heap-budget must not be greater than 100");
+
   if (use_largepages != "off" &&
       use_largepages != "on" &&
       use_largepages != "silent") {
     errors->push_back("invalid value for --use-largepages");
   }
+
+  if (use_largepages_heap != "off" &&
+      use_largepages_heap != "madvise" &&
+      use_largepages_heap != "explicit") {
+    errors->push_back("invalid value for --use-largepages-heap");
+  }
+
+  if (trace_event_format != "json" && trace_event_format != "perfetto")
+    errors->push_back("invalid value for --trace-event-format");
   per_isolate->CheckOptions(errors, argv);
 }
 
@@ -133,6 +146,11 @@ void EnvironmentOptions::CheckOptions(std::vector<std::string>* errors,
     errors->push_back("invalid value for --unhandled-rejections");
   }
 
+  uint32_t report_sections_mask;
+  if (!report::ParseSections(report_sections, &report_sections_mask)) {
+    errors->push_back("invalid value for --report-sections");
+  }
+
   if (tls_min_v1_3 && tls_max_v1_2) {
     errors->push_back("either --tls-min-v1.3 or --tls-max-v1.2 can be "
                       "used, not both");
@@ -398,6 +416,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             &EnvironmentOptions::enable_source_maps,
             kAllowedInEnvvar);
   AddOption("--experimental-abortcontroller", "", NoOp{}, kAllowedInEnvvar);
+  AddOption("--experimental-batch-io-callbacks",
+            "run the nextTick and microtask queues once per event loop "
+            "iteration after stream, UDP and HTTP parser callbacks",
+            &EnvironmentOptions::experimental_batch_io_callbacks,
+            kAllowedInEnvvar);
   AddOption("--experimental-eventsource",
             "experimental EventSource API",
             &EnvironmentOptions::experimental_eventsource,
@@ -517,6 +540,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
       &EnvironmentOptions::force_node_api_uncaught_exceptions_policy,
       kAllowedInEnvvar,
       false);
+  AddOption("--node-api-finalizer-budget",
+            "maximum number of Node API finalizers to run per event loop "
+            "iteration, 0 for no limit (default: 0)",
+            &EnvironmentOptions::node_api_finalizer_budget,
+            kAllowedInEnvvar);
   AddOption("--addons",
             "disable loading native addons",
             &EnvironmentOptions::allow_native_addons,
@@ -552,6 +580,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "preserve symbolic links when resolving the main module",
             &EnvironmentOptions::preserve_symlinks_main,
             kAllowedInEnvvar);
+  AddOption("--experimental-module-fs-cache",
+            "keep the file system lookups of the module resolvers cached "
+            "across loads, invalidated by file system watchers",
+            &EnvironmentOptions::experimental_module_fs_cache,
+            kAllowedInEnvvar);
   AddOption("--prof",
             "Generate V8 profiler output.",
             V8Option{});
@@ -611,6 +644,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "set environment variables from supplied file",
             &EnvironmentOptions::env_file);
   Implies("--env-file", "[has_env_file_string]");
+  AddOption("--experimental-lazy-env-file",
+            "make process.env fall back to the variables from --env-file "
+            "instead of setting them in the environment of the process",
+            &EnvironmentOptions::experimental_lazy_env_file,
+            kAllowedInEnvvar);
   AddOption("--test",
             "launch test runner on startup",
             &EnvironmentOptions::test_runner);
@@ -659,6 +697,8 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             &EnvironmentOptions::test_skip_pattern);
   AddOption("--test-udp-no-try-send", "",  // For testing only.
             &EnvironmentOptions::test_udp_no_try_send);
+  AddOption("--test-udp-no-recvmmsg", "",  // For testing only.
+            &EnvironmentOptions::test_udp_no_recvmmsg);
   AddOption("--throw-deprecation",
             "throw an exception on deprecations",
             &EnvironmentOptions::throw_deprecation,
@@ -803,6 +843,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             " (default: false)",
             &EnvironmentOptions::report_exclude_network,
             kAllowedInEnvvar);
+  AddOption("--report-sections",
+            "comma-separated list of the sections to include in diagnostic "
+            "reports, such as javascriptStack,libuv (default: all)",
+            &EnvironmentOptions::report_sections,
+            kAllowedInEnvvar);
 }
 
 PerIsolateOptionsParser::PerIsolateOptionsParser(
@@ -901,8 +946,22 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "data, it supports ${rotation} and ${pid}.",
             &PerProcessOptions::trace_event_file_pattern,
             kAllowedInEnvvar);
+  AddOption("--trace-event-format",
+            "format of the trace-events data, 'json' (default) or 'perfetto'",
+            &PerProcessOptions::trace_event_format,
+            kAllowedInEnvvar);
   AddAlias("--trace-events-enabled", {
     "--trace-event-categories", "v8,node,node.async_hooks" });
+  AddOption("--threadpool-cpu-limit",
+            "maximum number of CPU-bound tasks (crypto, zlib) that each "
+            "thread may have in the libuv threadpool at once, 0 for no limit",
+            &PerProcessOptions::threadpool_cpu_limit,
+            kAllowedInEnvvar);
+  AddOption("--worker-heap-budget",
+            "percentage of the memory available to the process that the "
+            "heaps of all worker threads may use combined, 0 for no limit",
+            &PerProcessOptions::worker_heap_budget,
+            kAllowedInEnvvar);
   AddOption("--v8-pool-size",
             "set V8's thread pool size",
             &PerProcessOptions::v8_thread_pool_size,
@@ -916,6 +975,11 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "", /* undocumented, only for debugging */
             &PerProcessOptions::debug_arraybuffer_allocations,
             kAllowedInEnvvar);
+  AddOption("--array-buffer-pool",
+            "allocate ArrayBuffer backing stores of 512 bytes to 64 KB from "
+            "pooled size classes instead of malloc",
+            &PerProcessOptions::array_buffer_pool,
+            kAllowedInEnvvar);
   AddOption("--disable-proto",
             "disable Object.prototype.__proto__",
             &PerProcessOptions::disable_proto,
@@ -1049,6 +1113,14 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "or 'silent' (map and silently ignore failure)",
             &PerProcessOptions::use_largepages,
             kAllowedInEnvvar);
+  AddOption("--use-largepages-heap",
+            "Back the V8 heap and large ArrayBuffers with large pages on "
+            "Linux. Options are 'off' (the default value), 'madvise' (ask "
+            "for transparent huge pages), or 'explicit' (put large "
+            "ArrayBuffers into explicit huge pages first, falling back to "
+            "'madvise')",
+            &PerProcessOptions::use_largepages_heap,
+            kAllowedInEnvvar);
 
   AddOption("--trace-sigint",
             "enable printing JavaScript stacktrace on SIGINT",
@@ -1068,10 +1140,34 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "Generate a blob that can be embedded into the single executable "
             "application",
             &PerProcessOptions::experimental_sea_config);
+  AddOption("--experimental-module-pack",
+            "serve the modules below the directory of a module pack file "
+            "from it",
+            &PerProcessOptions::experimental_module_pack,
+            kAllowedInEnvvar);
+  AddOption("--experimental-process-env-cache",
+            "serve process.env from a copy of the environment that is only "
+            "updated through process.env",
+            &PerProcessOptions::experimental_process_env_cache,
+            kAllowedInEnvvar);
+  AddOption("--startup-profile",
+            "write a trace of the startup phases and of the builtins "
+            "compiled during startup to the given file",
+            &PerProcessOptions::startup_profile,
+            kAllowedInEnvvar);
 
   AddOption("--run",
-            "Run a script specified in package.json",
+            "Run a script specified in package.json. When given more than "
+            "once, the scripts run in parallel",
             &PerProcessOptions::run);
+  AddOption("--run-workspaces",
+            "run the --run scripts in the workspaces of package.json "
+            "instead of in its own package",
+            &PerProcessOptions::run_workspaces);
+  AddOption("--run-concurrency",
+            "the number of --run scripts that run at the same time "
+            "(default: the number of CPUs)",
+            &PerProcessOptions::run_concurrency);
   AddOption(
       "--disable-wasm-trap-handler",
       "Disable trap-handler-based WebAssembly bound checks. V8 will insert "
@@ -1079,6 +1175,11 @@ PerProcessOptionsParser::PerProcessOptionsParser(
       "performance.",
       &PerProcessOptions::disable_wasm_trap_handler,
       kAllowedInEnvvar);
+  AddOption("--experimental-io-uring",
+            "submit file system operations through io_uring instead of the "
+            "libuv threadpool on Linux, where supported by the kernel",
+            &PerProcessOptions::experimental_io_uring,
+            kAllowedInEnvvar);
 }
 
 inline std::string RemoveBrackets(const std::string& host) {
@@ -115,6 +115,7 @@ class EnvironmentOptions : public Options {
   bool require_module = false;
   std::string dns_result_order;
   bool enable_source_maps = false;
+  bool experimental_batch_io_callbacks = false;
   bool experimental_eventsource = false;
   bool experimental_fetch = true;
   bool experimental_websocket = true;
@@ -135,6 +136,7 @@ class EnvironmentOptions : public Options {
   bool experimental_vm_modules = false;
   bool expose_internals = false;
   bool force_node_api_uncaught_exceptions_policy = false;
+  uint64_t node_api_finalizer_budget = 0;
   bool frozen_intrinsics = false;
   int64_t heap_snapshot_near_heap_limit = 0;
   std::string heap_snapshot_signal;
@@ -150,6 +152,7 @@ class EnvironmentOptions : public Options {
   bool force_context_aware = false;
   bool pending_deprecation = false;
   bool preserve_symlinks = false;
+  bool experimental_module_fs_cache = false;
   bool preserve_symlinks_main = false;
   bool prof_process = false;
 #if HAVE_INSPECTOR
@@ -168,6 +171,7 @@ class EnvironmentOptions : public Options {
   std::string diagnostic_dir;
   std::string env_file;
   bool has_env_file_string = false;
+  bool experimental_lazy_env_file = false;
   bool test_runner = false;
   uint64_t test_runner_concurrency = 0;
   uint64_t test_runner_timeout = 0;
@@ -181,6 +185,7 @@ class EnvironmentOptions : public Options {
   std::vector<std::string> test_reporter_destination;
   bool test_only = false;
   bool test_udp_no_try_send = false;
+  bool test_udp_no_recvmmsg = false;
   std::string test_shard;
   std::vector<std::string> test_skip_pattern;
   bool throw_deprecation = false;
@@ -229,6 +234,7 @@ class EnvironmentOptions : public Options {
   std::vector<std::string> user_argv;
 
   bool report_exclude_network = false;
+  std::string report_sections;
 
   inline DebugOptions* get_debug_options() { return &debug_options_; }
   inline const DebugOptions& debug_options() const { return debug_options_; }
@@ -270,9 +276,13 @@ class PerProcessOptions : public Options {
   std::string title;
   std::string trace_event_categories;
   std::string trace_event_file_pattern = "node_trace.${rotation}.log";
+  std::string trace_event_format = "json";
   int64_t v8_thread_pool_size = 4;
+  uint64_t threadpool_cpu_limit = 0;
+  uint64_t worker_heap_budget = 0;
   bool zero_fill_all_buffers = false;
   bool debug_arraybuffer_allocations = false;
+  bool array_buffer_pool = false;
   std::string disable_proto;
   // We enable the shared read-only heap which currently requires that the
   // snapshot used in different isolates in the same process to be the same.
@@ -286,7 +296,12 @@ class PerProcessOptions : public Options {
   bool print_v8_help = false;
   bool print_version = false;
   std::string experimental_sea_config;
-  std::string run;
+  std::string experimental_module_pack;
+  bool experimental_process_env_cache = false;
+  std::string startup_profile;
+  std::vector<std::string> run;
+  bool run_workspaces = false;
+  uint64_t run_concurrency = 0;
 
 #ifdef NODE_HAVE_I18N_SUPPORT
   std::string icu_data_dir;
@@ -315,6 +330,7 @@ class PerProcessOptions : public Options {
 #endif
 
   bool disable_wasm_trap_handler = false;
+  bool experimental_io_uring = false;
 
   // Per-process because reports can be triggered outside a known V8 context.
   bool report_on_fatalerror = false;
@@ -324,6 +340,7 @@ class PerProcessOptions : public Options {
 
   // TODO(addaleax): Some of these could probably be per-Environment.
   std::string use_largepages = "off";
+  std::string use_largepages_heap = "off";
   bool trace_sigint = false;
   std::vector<std::string> cmdline;
 
@@ -21,6 +21,7 @@
 
 #include "env-inl.h"
 #include "node_external_reference.h"
+#include "node_internals.h"
 #include "string_bytes.h"
 
 #ifdef __MINGW32__
@@ -31,9 +32,19 @@
 # include <climits>         // PATH_MAX on Solaris.
 #endif  // __POSIX__
 
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <algorithm>
 #include <array>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <vector>
 
 namespace node {
 namespace os {
@@ -380,9 +391,284 @@ static void GetPriority(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(priority);
 }
 
-static void GetAvailableParallelism(const FunctionCallbackInfo<Value>& args) {
+// Returns the number of CPUs the cgroup CPU quota allows this process to
+// use, rounded up, or 0 if there is no quota. uv_available_parallelism()
+// only looks at the affinity mask, which containers usually leave alone.
+static unsigned int GetCgroupCpuLimit() {
+#ifdef __linux__
+  std::string contents;
+  long long quota = -1;  // NOLINT(runtime/int)
+  long long period = 0;  // NOLINT(runtime/int)
+  if (ReadFileSync(&contents, "/sys/fs/cgroup/cpu.max") == 0) {
+    // cgroup v2: "<quota> <period>" or "max <period>".
+    if (sscanf(contents.c_str(), "%lld %lld", &quota, &period) != 2)
+      return 0;
+  } else {
+    std::string period_contents;
+    if (ReadFileSync(&contents, "/sys/fs/cgroup/cpu/cpu.cfs_quota_us") != 0 ||
+        ReadFileSync(&period_contents,
+                     "/sys/fs/cgroup/cpu/cpu.cfs_period_us") != 0 ||
+        sscanf(contents.c_str(), "%lld", &quota) != 1 ||
+        sscanf(period_contents.c_str(), "%lld", &period) != 1) {
+      return 0;
+    }
+  }
+  if (quota <= 0 || period <= 0)
+    return 0;
+  return static_cast<unsigned int>((quota + period - 1) / period);
+#else
+  return 0;
+#endif
+}
+
+unsigned int GetAvailableParallelism() {
+  // The quota does not change without a restart of the container.
+  static const unsigned int cgroup_limit = GetCgroupCpuLimit();
   unsigned int parallelism = uv_available_parallelism();
-  args.GetReturnValue().Set(parallelism);
+  if (cgroup_limit > 0) parallelism = std::min(parallelism, cgroup_limit);
+  return parallelism;
+}
+
+// Parses the number at the start of `list` and removes it, or returns -1 if
+// there is none or it is not below `limit`.
+static int ParseCPUNumber(std::string_view* list, int limit) {
+  size_t length = 0;
+  int number = 0;
+  while (length < list->size() && (*list)[length] >= '0' &&
+         (*list)[length] <= '9') {
+    number = number * 10 + ((*list)[length] - '0');
+    if (number >= limit) return -1;
+    length++;
+  }
+  if (length == 0) return -1;
+  list->remove_prefix(length);
+  return number;
+}
+
+bool ParseCPUList(std::string_view list, std::vector<int>* out) {
+  // Nothing can name a CPU that does not fit into an affinity mask. Where
+  // libuv does not support those, use the default size of a Linux cpu_set_t.
+  int limit = uv_cpumask_size();
+  if (limit <= 0) limit = 1024;
+
+  while (!list.empty() && (list.back() == '\n' || list.back() == ' '))
+    list.remove_suffix(1);
+  while (!list.empty()) {
+    int first = ParseCPUNumber(&list, limit);
+    if (first < 0) return false;
+    int last = first;
+    if (!list.empty() && list.front() == '-') {
+      list.remove_prefix(1);
+      last = ParseCPUNumber(&list, limit);
+      if (last < first) return false;
+    }
+    if (!list.empty()) {
+      if (list.front() != ',' || list.size() == 1) return false;
+      list.remove_prefix(1);
+    }
+    for (int cpu = first; cpu <= last; cpu++) out->push_back(cpu);
+  }
+  return true;
+}
+
+#ifdef __linux__
+static int ReadSysfsInt(const std::string& path) {
+  std::string contents;
+  int value;
+  if (ReadFileSync(&contents, path.c_str()) != 0 ||
+      sscanf(contents.c_str(), "%d", &value) != 1) {
+    return -1;
+  }
+  return value;
+}
+
+// Returns the lowest CPU in a sysfs CPU list, which identifies the group of
+// CPUs that share e.g. a core or a cache, or -1.
+static int ReadSysfsCPUListFirst(const std::string& path) {
+  std::string contents;
+  std::vector<int> cpus;
+  if (ReadFileSync(&contents, path.c_str()) != 0 ||
+      !ParseCPUList(contents, &cpus) || cpus.empty()) {
+    return -1;
+  }
+  return *std::min_element(cpus.begin(), cpus.end());
+}
+#endif  // __linux__
+
+std::vector<CPUTopology> GetCPUTopology() {
+  std::vector<CPUTopology> result;
+#ifdef __linux__
+  std::string contents;
+  std::vector<int> cpus;
+  if (ReadFileSync(&contents, "/sys/devices/system/cpu/online") == 0 &&
+      ParseCPUList(contents, &cpus)) {
+    for (int cpu : cpus) {
+      std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+      CPUTopology info;
+      info.cpu = cpu;
+      info.core = ReadSysfsCPUListFirst(dir + "/topology/thread_siblings_list");
+      info.package = ReadSysfsInt(dir + "/topology/physical_package_id");
+      // The index of the L3 cache differs between CPU models.
+      for (int index = 0; index < 8; index++) {
+        std::string cache = dir + "/cache/index" + std::to_string(index);
+        int level = ReadSysfsInt(cache + "/level");
+        if (level == -1) break;
+        if (level == 3) {
+          info.l3_cache = ReadSysfsCPUListFirst(cache + "/shared_cpu_list");
+          break;
+        }
+      }
+      result.push_back(info);
+    }
+
+    std::vector<int> nodes;
+    if (ReadFileSync(&contents, "/sys/devices/system/node/online") == 0 &&
+        ParseCPUList(contents, &nodes)) {
+      for (int node : nodes) {
+        std::vector<int> node_cpus;
+        std::string path = "/sys/devices/system/node/node" +
+                           std::to_string(node) + "/cpulist";
+        if (ReadFileSync(&contents, path.c_str()) != 0 ||
+            !ParseCPUList(contents, &node_cpus)) {
+          continue;
+        }
+        for (CPUTopology& info : result) {
+          if (std::find(node_cpus.begin(), node_cpus.end(), info.cpu) !=
+              node_cpus.end()) {
+            info.numa_node = node;
+          }
+        }
+      }
+    }
+    if (!result.empty()) return result;
+  }
+#endif  // __linux__
+  uv_cpu_info_t* cpu_infos;
+  int count;
+  if (uv_cpu_info(&cpu_infos, &count) != 0) return result;
+  uv_free_cpu_info(cpu_infos, count);
+  for (int i = 0; i < count; i++) {
+    CPUTopology info;
+    info.cpu = i;
+    result.push_back(info);
+  }
+  return result;
+}
+
+int SetThreadAffinity(uv_thread_t* thread, const std::vector<int>& cpus) {
+  int mask_size = uv_cpumask_size();
+  if (mask_size < 0) return mask_size;
+  std::vector<char> mask(mask_size, 0);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= mask_size) return UV_EINVAL;
+    mask[cpu] = 1;
+  }
+  return uv_thread_setaffinity(thread, mask.data(), nullptr, mask.size());
+}
+
+int GetThreadAffinity(uv_thread_t* thread, std::vector<int>* cpus) {
+  int mask_size = uv_cpumask_size();
+  if (mask_size < 0) return mask_size;
+  std::vector<char> mask(mask_size, 0);
+  int err = uv_thread_getaffinity(thread, mask.data(), mask.size());
+  if (err != 0) return err;
+  for (int cpu = 0; cpu < mask_size; cpu++) {
+    if (mask[cpu]) cpus->push_back(cpu);
+  }
+  return 0;
+}
+
+int SetCurrentThreadMemoryNode(int node) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  // glibc has no wrapper, and linking libnuma only for this is not worth it.
+  constexpr int kBitsPerWord = 8 * sizeof(unsigned long);  // NOLINT
+  if (node < 0 || node >= 64 * kBitsPerWord) return UV_EINVAL;
+  std::vector<unsigned long> mask(node / kBitsPerWord + 1, 0);  // NOLINT
+  mask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+  // MPOL_PREFERRED rather than MPOL_BIND, so that allocations fall back to
+  // other nodes instead of failing when the node runs out of memory. Like
+  // libnuma, pass one more bit than the mask has, as the kernel ignores the
+  // last one.
+  if (syscall(SYS_set_mempolicy,
+              MPOL_PREFERRED,
+              mask.data(),
+              mask.size() * kBitsPerWord + 1) != 0) {
+    return uv_translate_sys_error(errno);
+  }
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+static void GetAvailableParallelism(const FunctionCallbackInfo<Value>& args) {
+  args.GetReturnValue().Set(os::GetAvailableParallelism());
+}
+
+static void GetCPUTopologyInfo(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  std::vector<CPUTopology> topology = GetCPUTopology();
+
+  // The array is in the format
+  // [cpu, core, package, numaNode, l3Cache, cpu2, core2, ...]
+  // where unknown values are -1.
+  std::vector<Local<Value>> result;
+  result.reserve(topology.size() * 5);
+  for (const CPUTopology& info : topology) {
+    result.emplace_back(Integer::New(isolate, info.cpu));
+    result.emplace_back(Integer::New(isolate, info.core));
+    result.emplace_back(Integer::New(isolate, info.package));
+    result.emplace_back(Integer::New(isolate, info.numa_node));
+    result.emplace_back(Integer::New(isolate, info.l3_cache));
+  }
+  args.GetReturnValue().Set(Array::New(isolate, result.data(), result.size()));
+}
+
+// Sets the CPUs that the calling thread, e.g. that of a Worker, may run on.
+static void SetCurrentThreadAffinity(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK_EQ(args.Length(), 2);
+  CHECK(args[0]->IsArray());
+
+  Local<Array> array = args[0].As<Array>();
+  std::vector<int> cpus;
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> cpu;
+    if (!array->Get(env->context(), i).ToLocal(&cpu)) return;
+    CHECK(cpu->IsInt32());
+    cpus.push_back(cpu.As<Int32>()->Value());
+  }
+
+  uv_thread_t thread = uv_thread_self();
+  const int err = SetThreadAffinity(&thread, cpus);
+  if (err) {
+    CHECK(args[1]->IsObject());
+    env->CollectUVExceptionInfo(args[1], err, "uv_thread_setaffinity");
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+static void GetCurrentThreadAffinity(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK_EQ(args.Length(), 1);
+
+  uv_thread_t thread = uv_thread_self();
+  std::vector<int> cpus;
+  const int err = GetThreadAffinity(&thread, &cpus);
+  if (err) {
+    CHECK(args[0]->IsObject());
+    env->CollectUVExceptionInfo(args[0], err, "uv_thread_getaffinity");
+    return;
+  }
+
+  std::vector<Local<Value>> result;
+  result.reserve(cpus.size());
+  for (int cpu : cpus) result.emplace_back(Integer::New(isolate, cpu));
+  args.GetReturnValue().Set(Array::New(isolate, result.data(), result.size()));
 }
 
 void Initialize(Local<Object> target,
@@ -404,6 +690,11 @@ void Initialize(Local<Object> target,
   SetMethod(
       context, target, "getAvailableParallelism", GetAvailableParallelism);
   SetMethod(context, target, "getOSInformation", GetOSInformation);
+  SetMethod(context, target, "getCPUTopology", GetCPUTopologyInfo);
+  SetMethod(
+      context, target, "setThreadAffinity", SetCurrentThreadAffinity);
+  SetMethod(
+      context, target, "getThreadAffinity", GetCurrentThreadAffinity);
   target
       ->Set(context,
             FIXED_ONE_BYTE_STRING(env->isolate(), "isBigEndian"),
@@ -425,6 +716,9 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetPriority);
   registry->Register(GetAvailableParallelism);
   registry->Register(GetOSInformation);
+  registry->Register(GetCPUTopologyInfo);
+  registry->Register(SetCurrentThreadAffinity);
+  registry->Register(GetCurrentThreadAffinity);
 }
 
 }  // namespace os
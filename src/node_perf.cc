@@ -2,6 +2,7 @@
 #include "aliased_buffer-inl.h"
 #include "env-inl.h"
 #include "histogram-inl.h"
+#include "json_utils.h"
 #include "memory_tracker-inl.h"
 #include "node_buffer.h"
 #include "node_external_reference.h"
@@ -9,7 +10,10 @@
 #include "node_process-inl.h"
 #include "util-inl.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
+#include <sstream>
 
 namespace node {
 namespace performance {
@@ -20,12 +24,17 @@ using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::GCCallbackFlags;
 using v8::GCType;
+using v8::Global;
+using v8::HandleScope;
+using v8::HeapSpaceStatistics;
+using v8::Int32;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
 using v8::Object;
 using v8::ObjectTemplate;
+using v8::Promise;
 using v8::PropertyAttribute;
 using v8::ReadOnly;
 using v8::Value;
@@ -39,6 +48,22 @@ const uint64_t performance_process_start = PERFORMANCE_NOW();
 const double performance_process_start_timestamp =
     GetCurrentTimeInMicroseconds();
 uint64_t performance_v8_start;
+uint64_t performance_options_parsed;
+
+namespace {
+
+struct BuiltinCompilation {
+  std::string id;
+  uint64_t start;
+  uint64_t end;
+  bool with_cache;
+};
+
+Mutex startup_profile_mutex;
+std::vector<BuiltinCompilation> builtin_compilations;
+bool startup_profile_written = false;
+
+}  // anonymous namespace
 
 PerformanceState::PerformanceState(Isolate* isolate,
                                    uint64_t time_origin,
@@ -127,6 +152,145 @@ void PerformanceState::Mark(PerformanceMilestone milestone, uint64_t ts) {
       TRACE_EVENT_SCOPE_THREAD, ts / 1000);
 }
 
+void RecordBuiltinCompilation(const char* id,
+                              uint64_t start,
+                              uint64_t end,
+                              bool with_cache) {
+  if (per_process::cli_options->startup_profile.empty()) return;
+  Mutex::ScopedLock lock(startup_profile_mutex);
+  if (startup_profile_written) return;
+  builtin_compilations.push_back({id, start, end, with_cache});
+}
+
+void WriteStartupProfile(Environment* env) {
+  const std::string& path = per_process::cli_options->startup_profile;
+  if (path.empty()) return;
+  const uint64_t now = PERFORMANCE_NOW();
+
+  Mutex::ScopedLock lock(startup_profile_mutex);
+  if (startup_profile_written) return;
+  startup_profile_written = true;
+
+  // The phases end where the next one starts, milestones that were not
+  // reached are skipped.
+  static constexpr std::pair<const char*, PerformanceMilestone> kPhases[] = {
+      // Option parsing and per-process state, including --env-file.
+      {"processInit", NODE_PERFORMANCE_MILESTONE_NODE_START},
+      // OpenSSL, the V8 platform and V8 itself.
+      {"platformInit", NODE_PERFORMANCE_MILESTONE_OPTIONS_PARSED},
+      // Includes the deserialization of the isolate from the snapshot.
+      {"isolateCreation", NODE_PERFORMANCE_MILESTONE_V8_START},
+      // The deserialization of the context from the snapshot, or the
+      // bootstrap without one.
+      {"environmentCreation", NODE_PERFORMANCE_MILESTONE_ISOLATE_CREATED},
+      // prepareMainThreadExecution() and friends.
+      {"preExecution", NODE_PERFORMANCE_MILESTONE_MAIN_START},
+      // Loading and running the entry point, up to the event loop.
+      {"mainScript", NODE_PERFORMANCE_MILESTONE_BOOTSTRAP_COMPLETE},
+  };
+
+  AliasedFloat64Array& milestones = env->performance_state()->milestones;
+  const uint64_t pid = uv_os_getpid();
+  std::ostringstream out;
+  JSONWriter writer(out, true);
+  writer.json_start();
+  writer.json_arraystart("traceEvents");
+  auto write_event = [&](const char* category,
+                         std::string_view name,
+                         uint64_t start,
+                         uint64_t end) {
+    writer.json_start();
+    writer.json_keyvalue("name", name);
+    writer.json_keyvalue("cat", category);
+    writer.json_keyvalue("ph", "X");
+    writer.json_keyvalue("pid", pid);
+    writer.json_keyvalue("tid", 0);
+    // Trace event timestamps are in microseconds.
+    writer.json_keyvalue("ts", start / 1000);
+    writer.json_keyvalue("dur", (end - start) / 1000);
+  };
+  for (size_t i = 0; i < arraysize(kPhases); i++) {
+    if (milestones[kPhases[i].second] < 0) continue;
+    const uint64_t start = milestones[kPhases[i].second];
+    uint64_t end = now;
+    for (size_t j = i + 1; j < arraysize(kPhases); j++) {
+      if (milestones[kPhases[j].second] >= 0) {
+        end = milestones[kPhases[j].second];
+        break;
+      }
+    }
+    write_event("node.startup", kPhases[i].first, start, end);
+    writer.json_end();
+  }
+  for (const BuiltinCompilation& compilation : builtin_compilations) {
+    write_event("node.startup.builtins",
+                compilation.id,
+                compilation.start,
+                compilation.end);
+    writer.json_objectstart("args");
+    writer.json_keyvalue("codeCache", compilation.with_cache);
+    writer.json_objectend();
+    writer.json_end();
+  }
+  writer.json_arrayend();
+  writer.json_arraystart("builtinsWithoutCache");
+  for (const BuiltinCompilation& compilation : builtin_compilations) {
+    if (!compilation.with_cache) writer.json_element(compilation.id);
+  }
+  writer.json_arrayend();
+  writer.json_end();
+  builtin_compilations.clear();
+
+  const std::string profile = out.str();
+  uv_buf_t buf =
+      uv_buf_init(const_cast<char*>(profile.data()), profile.length());
+  int ret = WriteFileSync(path.c_str(), buf);
+  if (ret != 0) {
+    char err_buf[128];
+    uv_err_name_r(ret, err_buf, sizeof(err_buf));
+    fprintf(stderr, "%s: Failed to write file %s\n", err_buf, path.c_str());
+  }
+}
+
+namespace {
+
+// Checks once per event loop iteration whether `entry_point` has settled.
+// This polls rather than attaching a reaction, which would mark a rejected
+// entry point as handled.
+void WriteStartupProfileOnceSettled(Environment* env,
+                                    Global<Promise> entry_point) {
+  HandleScope handle_scope(env->isolate());
+  if (entry_point.Get(env->isolate())->State() !=
+      Promise::PromiseState::kPending) {
+    return WriteStartupProfile(env);
+  }
+  env->SetImmediate(
+      [entry_point = std::move(entry_point)](Environment* env) mutable {
+        WriteStartupProfileOnceSettled(env, std::move(entry_point));
+      },
+      CallbackFlags::kUnrefed);
+}
+
+}  // anonymous namespace
+
+void ScheduleStartupProfile(Environment* env) {
+  if (per_process::cli_options->startup_profile.empty()) return;
+
+  // An ES module entry point is loaded and evaluated asynchronously, and
+  // only done once the promise that lib/ stores for it has settled.
+  HandleScope handle_scope(env->isolate());
+  Local<Context> context = env->context();
+  Local<Value> entry_point;
+  if (context->Global()
+          ->GetPrivate(context, env->entry_point_promise_private_symbol())
+          .ToLocal(&entry_point) &&
+      entry_point->IsPromise()) {
+    return WriteStartupProfileOnceSettled(
+        env, Global<Promise>(env->isolate(), entry_point.As<Promise>()));
+  }
+  WriteStartupProfile(env);
+}
+
 void SetupPerformanceObservers(const FunctionCallbackInfo<Value>& args) {
   Realm* realm = Realm::GetCurrent(args);
   // TODO(legendecas): Remove this check once the sub-realms are supported.
@@ -266,8 +430,12 @@ void CreateELDHistogram(const FunctionCallbackInfo<Value>& args) {
   int64_t interval = args[0].As<Integer>()->Value();
   CHECK_GT(interval, 0);
   BaseObjectPtr<IntervalHistogram> histogram =
-      IntervalHistogram::Create(env, interval, [](Histogram& histogram) {
+      IntervalHistogram::Create(env, interval, [env](Histogram& histogram) {
         uint64_t delta = histogram.RecordDelta();
+        if (!env->is_trace_category_enabled(
+                Environment::kTracePerfEventLoop)) {
+          return;
+        }
         TRACE_COUNTER1(TRACING_CATEGORY_NODE2(perf, event_loop),
                         "delay", delta);
         TRACE_COUNTER1(TRACING_CATEGORY_NODE2(perf, event_loop),
@@ -282,6 +450,237 @@ void CreateELDHistogram(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(histogram->object());
 }
 
+EventLoopHistograms::EventLoopHistograms() {
+  for (std::shared_ptr<Histogram>& histogram : phases_) histogram = New();
+}
+
+std::shared_ptr<Histogram> EventLoopHistograms::New() {
+  // Up to an hour, with a resolution of a microsecond.
+  return std::make_shared<Histogram>(Histogram::Options{
+      1000, int64_t{3600} * 1000 * 1000 * 1000, 2});
+}
+
+void EventLoopHistograms::RecordPhase(PerformanceLoopPhase phase,
+                                      uint64_t duration) {
+  phases_[phase]->Record(duration);
+  if (poll_end_ != 0) measured_since_poll_ += duration;
+}
+
+void EventLoopHistograms::RecordCallback(int provider, uint64_t duration) {
+  DCHECK_GE(provider, 0);
+  if (static_cast<size_t>(provider) >= callbacks_.size())
+    callbacks_.resize(provider + 1);
+  std::shared_ptr<Histogram>& histogram = callbacks_[provider];
+  if (!histogram) histogram = New();
+  histogram->Record(duration);
+}
+
+std::shared_ptr<Histogram> EventLoopHistograms::callback(int provider) const {
+  if (provider < 0 || static_cast<size_t>(provider) >= callbacks_.size())
+    return nullptr;
+  return callbacks_[provider];
+}
+
+void EventLoopHistograms::BeforePoll(uint64_t now, uint64_t idle_time) {
+  if (poll_end_ != 0) {
+    uint64_t elapsed = now - poll_end_;
+    if (elapsed > measured_since_poll_) {
+      phases_[NODE_PERFORMANCE_LOOP_PHASE_PENDING_AND_CLOSE]->Record(
+          elapsed - measured_since_poll_);
+    }
+  }
+  poll_start_ = now;
+  poll_start_idle_time_ = idle_time;
+}
+
+void EventLoopHistograms::AfterPoll(uint64_t now, uint64_t idle_time) {
+  if (poll_start_ != 0) {
+    uint64_t total = now - poll_start_;
+    uint64_t wait = std::min(idle_time - poll_start_idle_time_, total);
+    phases_[NODE_PERFORMANCE_LOOP_PHASE_POLL_WAIT]->Record(wait);
+    phases_[NODE_PERFORMANCE_LOOP_PHASE_POLL_IO]->Record(total - wait);
+  }
+  poll_end_ = now;
+  measured_since_poll_ = 0;
+}
+
+namespace {
+
+PerformanceHeapSpace GetHeapSpaceGroup(const char* name) {
+  static constexpr struct {
+    const char* name;
+    PerformanceHeapSpace group;
+  } kGroups[] = {
+      {"new_space", NODE_PERFORMANCE_HEAP_SPACE_YOUNG},
+      {"old_space", NODE_PERFORMANCE_HEAP_SPACE_OLD},
+      {"trusted_space", NODE_PERFORMANCE_HEAP_SPACE_OLD},
+      {"code_space", NODE_PERFORMANCE_HEAP_SPACE_CODE},
+      {"code_large_object_space", NODE_PERFORMANCE_HEAP_SPACE_CODE},
+      {"new_large_object_space", NODE_PERFORMANCE_HEAP_SPACE_LARGE_OBJECT},
+      {"large_object_space", NODE_PERFORMANCE_HEAP_SPACE_LARGE_OBJECT},
+      {"trusted_large_object_space", NODE_PERFORMANCE_HEAP_SPACE_LARGE_OBJECT},
+  };
+  for (const auto& entry : kGroups) {
+    if (strcmp(name, entry.name) == 0) return entry.group;
+  }
+  return NODE_PERFORMANCE_HEAP_SPACE_INVALID;
+}
+
+PerformanceGCType ToPerformanceGCType(GCType type) {
+  switch (type) {
+    case GCType::kGCTypeScavenge:
+      return NODE_PERFORMANCE_GC_TYPE_SCAVENGE;
+    case GCType::kGCTypeMinorMarkSweep:
+      return NODE_PERFORMANCE_GC_TYPE_MINOR_MARK_SWEEP;
+    case GCType::kGCTypeMarkSweepCompact:
+      return NODE_PERFORMANCE_GC_TYPE_MARK_SWEEP_COMPACT;
+    case GCType::kGCTypeIncrementalMarking:
+      return NODE_PERFORMANCE_GC_TYPE_INCREMENTAL_MARKING;
+    case GCType::kGCTypeProcessWeakCallbacks:
+      return NODE_PERFORMANCE_GC_TYPE_PROCESS_WEAK_CALLBACKS;
+    default:
+      return NODE_PERFORMANCE_GC_TYPE_INVALID;
+  }
+}
+
+}  // anonymous namespace
+
+GCHistograms::GCHistograms(Isolate* isolate) : isolate_(isolate) {
+  // Up to a minute, with a resolution of a microsecond.
+  for (std::shared_ptr<Histogram>& histogram : pauses_) {
+    histogram = std::make_shared<Histogram>(
+        Histogram::Options{1000, int64_t{60} * 1000 * 1000 * 1000, 2});
+  }
+  Histogram::Options freed_options;
+  freed_options.figures = 2;
+  for (std::shared_ptr<Histogram>& histogram : freed_)
+    histogram = std::make_shared<Histogram>(freed_options);
+
+  size_t space_count = isolate->NumberOfHeapSpaces();
+  space_groups_.resize(space_count, NODE_PERFORMANCE_HEAP_SPACE_INVALID);
+  for (size_t i = 0; i < space_count; i++) {
+    HeapSpaceStatistics stats;
+    if (isolate->GetHeapSpaceStatistics(&stats, i))
+      space_groups_[i] = GetHeapSpaceGroup(stats.space_name());
+  }
+
+  isolate->AddGCPrologueCallback(OnGCStart, this);
+  isolate->AddGCEpilogueCallback(OnGCEnd, this);
+}
+
+GCHistograms::~GCHistograms() {
+  isolate_->RemoveGCPrologueCallback(OnGCStart, this);
+  isolate_->RemoveGCEpilogueCallback(OnGCEnd, this);
+}
+
+void GCHistograms::SampleSpaces(
+    size_t used[NODE_PERFORMANCE_HEAP_SPACE_INVALID]) const {
+  std::fill_n(used, NODE_PERFORMANCE_HEAP_SPACE_INVALID, 0);
+  for (size_t i = 0; i < space_groups_.size(); i++) {
+    if (space_groups_[i] == NODE_PERFORMANCE_HEAP_SPACE_INVALID) continue;
+    HeapSpaceStatistics stats;
+    if (isolate_->GetHeapSpaceStatistics(&stats, i))
+      used[space_groups_[i]] += stats.space_used_size();
+  }
+}
+
+void GCHistograms::OnGCStart(Isolate* isolate,
+                             GCType type,
+                             GCCallbackFlags flags,
+                             void* data) {
+  GCHistograms* self = static_cast<GCHistograms*>(data);
+  PerformanceGCType index = ToPerformanceGCType(type);
+  if (index == NODE_PERFORMANCE_GC_TYPE_INVALID) return;
+  self->start_times_[index] = uv_hrtime();
+  if (self->depth_++ == 0) self->SampleSpaces(self->used_before_);
+}
+
+void GCHistograms::OnGCEnd(Isolate* isolate,
+                           GCType type,
+                           GCCallbackFlags flags,
+                           void* data) {
+  GCHistograms* self = static_cast<GCHistograms*>(data);
+  PerformanceGCType index = ToPerformanceGCType(type);
+  // Ignore the end of a GC that started before the histograms did.
+  if (index == NODE_PERFORMANCE_GC_TYPE_INVALID ||
+      self->start_times_[index] == 0) {
+    return;
+  }
+  self->pauses_[index]->Record(uv_hrtime() - self->start_times_[index]);
+  self->start_times_[index] = 0;
+  if (--self->depth_ != 0) return;
+
+  // Objects that are promoted or allocated during the GC can make a group
+  // grow, which counts as nothing freed.
+  size_t used_after[NODE_PERFORMANCE_HEAP_SPACE_INVALID];
+  self->SampleSpaces(used_after);
+  for (int i = 0; i < NODE_PERFORMANCE_HEAP_SPACE_INVALID; i++) {
+    size_t before = self->used_before_[i];
+    self->freed_[i]->Record(before > used_after[i] ? before - used_after[i]
+                                                   : 0);
+  }
+}
+
+static void GetLoopPhaseHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  int32_t phase = args[0].As<Int32>()->Value();
+  CHECK(phase >= 0 && phase < NODE_PERFORMANCE_LOOP_PHASE_INVALID);
+  BaseObjectPtr<HistogramBase> histogram = HistogramBase::Create(
+      env,
+      env->event_loop_histograms()->phase(
+          static_cast<PerformanceLoopPhase>(phase)));
+  if (histogram) args.GetReturnValue().Set(histogram->object());
+}
+
+// Returns undefined if no callback of the given provider has run yet.
+static void GetCallbackHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  std::shared_ptr<Histogram> callback =
+      env->event_loop_histograms()->callback(args[0].As<Int32>()->Value());
+  if (!callback) return;
+  BaseObjectPtr<HistogramBase> histogram =
+      HistogramBase::Create(env, std::move(callback));
+  if (histogram) args.GetReturnValue().Set(histogram->object());
+}
+
+static void StartGCHistograms(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (env->gc_histograms() == nullptr)
+    env->set_gc_histograms(std::make_unique<GCHistograms>(env->isolate()));
+}
+
+// The histograms that were handed out keep their values.
+static void StopGCHistograms(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->set_gc_histograms(nullptr);
+}
+
+// Both return undefined if the GC histograms are not started.
+static void GetGCPauseHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  int32_t type = args[0].As<Int32>()->Value();
+  CHECK(type >= 0 && type < NODE_PERFORMANCE_GC_TYPE_INVALID);
+  GCHistograms* histograms = env->gc_histograms();
+  if (histograms == nullptr) return;
+  BaseObjectPtr<HistogramBase> histogram = HistogramBase::Create(
+      env, histograms->pause(static_cast<PerformanceGCType>(type)));
+  if (histogram) args.GetReturnValue().Set(histogram->object());
+}
+
+static void GetGCFreedHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  int32_t space = args[0].As<Int32>()->Value();
+  CHECK(space >= 0 && space < NODE_PERFORMANCE_HEAP_SPACE_INVALID);
+  GCHistograms* histograms = env->gc_histograms();
+  if (histograms == nullptr) return;
+  BaseObjectPtr<HistogramBase> histogram = HistogramBase::Create(
+      env, histograms->freed(static_cast<PerformanceHeapSpace>(space)));
+  if (histogram) args.GetReturnValue().Set(histogram->object());
+}
+
 void MarkBootstrapComplete(const FunctionCallbackInfo<Value>& args) {
   Realm* realm = Realm::GetCurrent(args);
   CHECK_EQ(realm->kind(), Realm::Kind::kPrincipal);
@@ -324,6 +723,12 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "loopIdleTime", LoopIdleTime);
   SetMethod(isolate, target, "createELDHistogram", CreateELDHistogram);
   SetMethod(isolate, target, "markBootstrapComplete", MarkBootstrapComplete);
+  SetMethod(isolate, target, "getLoopPhaseHistogram", GetLoopPhaseHistogram);
+  SetMethod(isolate, target, "getCallbackHistogram", GetCallbackHistogram);
+  SetMethod(isolate, target, "startGCHistograms", StartGCHistograms);
+  SetMethod(isolate, target, "stopGCHistograms", StopGCHistograms);
+  SetMethod(isolate, target, "getGCPauseHistogram", GetGCPauseHistogram);
+  SetMethod(isolate, target, "getGCFreedHistogram", GetGCFreedHistogram);
   SetFastMethodNoSideEffect(
       isolate, target, "now", SlowPerformanceNow, &fast_performance_now);
 }
@@ -375,6 +780,21 @@ void CreatePerContextProperties(Local<Object> target,
   NODE_PERFORMANCE_MILESTONES(V)
 #undef V
 
+#define V(name, _)                                                            \
+  NODE_DEFINE_CONSTANT(constants, NODE_PERFORMANCE_LOOP_PHASE_##name);
+  NODE_PERFORMANCE_LOOP_PHASES(V)
+#undef V
+
+#define V(name, _)                                                            \
+  NODE_DEFINE_CONSTANT(constants, NODE_PERFORMANCE_GC_TYPE_##name);
+  NODE_PERFORMANCE_GC_TYPES(V)
+#undef V
+
+#define V(name, _)                                                            \
+  NODE_DEFINE_CONSTANT(constants, NODE_PERFORMANCE_HEAP_SPACE_##name);
+  NODE_PERFORMANCE_HEAP_SPACES(V)
+#undef V
+
   PropertyAttribute attr =
       static_cast<PropertyAttribute>(ReadOnly | DontDelete);
 
@@ -390,6 +810,12 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(LoopIdleTime);
   registry->Register(CreateELDHistogram);
   registry->Register(MarkBootstrapComplete);
+  registry->Register(GetLoopPhaseHistogram);
+  registry->Register(GetCallbackHistogram);
+  registry->Register(StartGCHistograms);
+  registry->Register(StopGCHistograms);
+  registry->Register(GetGCPauseHistogram);
+  registry->Register(GetGCFreedHistogram);
   registry->Register(SlowPerformanceNow);
   registry->Register(FastPerformanceNow);
   registry->Register(fast_performance_now.GetTypeInfo());
@@ -12,7 +12,9 @@
 #include "v8.h"
 #include "uv.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace node {
 
@@ -60,6 +62,93 @@ inline PerformanceEntryType ToPerformanceEntryTypeEnum(
   return NODE_PERFORMANCE_ENTRY_TYPE_INVALID;
 }
 
+// Always-on histograms of how long, in nanoseconds, each phase of an event
+// loop iteration takes, and of how long the callbacks into JS take for each
+// AsyncWrap provider. The histograms only have a precision of two figures to
+// keep them small.
+class EventLoopHistograms {
+ public:
+  EventLoopHistograms();
+
+  void RecordPhase(PerformanceLoopPhase phase, uint64_t duration);
+  void RecordCallback(int provider, uint64_t duration);
+
+  // Called right before and right after the loop polls for I/O. Both take
+  // the current time and the idle time of the loop.
+  void BeforePoll(uint64_t now, uint64_t idle_time);
+  void AfterPoll(uint64_t now, uint64_t idle_time);
+
+  const std::shared_ptr<Histogram>& phase(PerformanceLoopPhase phase) const {
+    return phases_[phase];
+  }
+  // Returns nullptr if no callback has been recorded for `provider` yet.
+  std::shared_ptr<Histogram> callback(int provider) const;
+
+ private:
+  static std::shared_ptr<Histogram> New();
+
+  std::shared_ptr<Histogram> phases_[NODE_PERFORMANCE_LOOP_PHASE_INVALID];
+  // Indexed by provider type, and only grown when a provider first shows up.
+  std::vector<std::shared_ptr<Histogram>> callbacks_;
+  uint64_t poll_start_ = 0;
+  uint64_t poll_start_idle_time_ = 0;
+  // The end of the last poll, and how much of the time since then has been
+  // spent in phases that are measured on their own. The rest of the time
+  // until the next poll is spent in the pending and close phases.
+  uint64_t poll_end_ = 0;
+  uint64_t measured_since_poll_ = 0;
+};
+
+// Histograms of the pause of each type of GC in nanoseconds, and of how many
+// bytes each GC frees in each group of heap spaces, as sampled from
+// v8::HeapSpaceStatistics before and after it. This is meant for continuous
+// GC telemetry: unlike the "gc" performance entries, nothing is allocated
+// and nothing calls into JS for a GC, and the histograms are only read on
+// demand. The GC callbacks are installed for as long as the object exists.
+class GCHistograms {
+ public:
+  explicit GCHistograms(v8::Isolate* isolate);
+  ~GCHistograms();
+
+  GCHistograms(const GCHistograms&) = delete;
+  GCHistograms& operator=(const GCHistograms&) = delete;
+
+  const std::shared_ptr<Histogram>& pause(PerformanceGCType type) const {
+    return pauses_[type];
+  }
+  const std::shared_ptr<Histogram>& freed(PerformanceHeapSpace space) const {
+    return freed_[space];
+  }
+
+ private:
+  static void OnGCStart(v8::Isolate* isolate,
+                        v8::GCType type,
+                        v8::GCCallbackFlags flags,
+                        void* data);
+  static void OnGCEnd(v8::Isolate* isolate,
+                      v8::GCType type,
+                      v8::GCCallbackFlags flags,
+                      void* data);
+
+  // Adds up the used size of the heap spaces of each group.
+  void SampleSpaces(size_t used[NODE_PERFORMANCE_HEAP_SPACE_INVALID]) const;
+
+  v8::Isolate* const isolate_;
+  // The group of each V8 heap space by index, or
+  // NODE_PERFORMANCE_HEAP_SPACE_INVALID for spaces that are not collected,
+  // such as the read-only space.
+  std::vector<PerformanceHeapSpace> space_groups_;
+  std::shared_ptr<Histogram> pauses_[NODE_PERFORMANCE_GC_TYPE_INVALID];
+  std::shared_ptr<Histogram> freed_[NODE_PERFORMANCE_HEAP_SPACE_INVALID];
+
+  // GCs of some types start while one of another type is in progress, so
+  // the start of each type is kept separately, and the spaces are only
+  // sampled around the outermost one.
+  uint64_t start_times_[NODE_PERFORMANCE_GC_TYPE_INVALID] = {};
+  size_t used_before_[NODE_PERFORMANCE_HEAP_SPACE_INVALID] = {};
+  int depth_ = 0;
+};
+
 enum PerformanceGCKind {
   NODE_PERFORMANCE_GC_MAJOR = v8::GCType::kGCTypeMarkSweepCompact,
   NODE_PERFORMANCE_GC_MINOR = v8::GCType::kGCTypeScavenge,
@@ -158,6 +247,20 @@ struct GCPerformanceEntryTraits {
 
 using GCPerformanceEntry = PerformanceEntry<GCPerformanceEntryTraits>;
 
+// For --startup-profile=<file>: records the compilation of a builtin, and
+// writes the startup phases of the main thread together with the builtins
+// that were compiled up to this point. ScheduleStartupProfile() is called
+// right before the main event loop starts. It writes the profile once the
+// main script is done, which for an ES module is when its evaluation has
+// settled. WriteStartupProfile() writes it right away, unless it was
+// written already.
+void RecordBuiltinCompilation(const char* id,
+                              uint64_t start,
+                              uint64_t end,
+                              bool with_cache);
+void ScheduleStartupProfile(Environment* env);
+void WriteStartupProfile(Environment* env);
+
 }  // namespace performance
 }  // namespace node
 
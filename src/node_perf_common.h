@@ -23,7 +23,10 @@ namespace performance {
 extern const uint64_t performance_process_start;
 extern const double performance_process_start_timestamp;
 extern uint64_t performance_v8_start;
+extern uint64_t performance_options_parsed;
 
+// OPTIONS_PARSED, ISOLATE_CREATED and MAIN_START break the startup of the
+// main thread down further, see WriteStartupProfile() in node_perf.cc.
 #define NODE_PERFORMANCE_MILESTONES(V)                                         \
   V(TIME_ORIGIN_TIMESTAMP, "timeOriginTimestamp")                              \
   V(TIME_ORIGIN, "timeOrigin")                                                 \
@@ -32,7 +35,34 @@ extern uint64_t performance_v8_start;
   V(V8_START, "v8Start")                                                       \
   V(LOOP_START, "loopStart")                                                   \
   V(LOOP_EXIT, "loopExit")                                                     \
-  V(BOOTSTRAP_COMPLETE, "bootstrapComplete")
+  V(BOOTSTRAP_COMPLETE, "bootstrapComplete")                                   \
+  V(OPTIONS_PARSED, "optionsParsed")                                           \
+  V(ISOLATE_CREATED, "isolateCreated")                                         \
+  V(MAIN_START, "mainStart")
+
+// The pending and close phases cannot be told apart from outside of libuv,
+// so they are measured together.
+#define NODE_PERFORMANCE_LOOP_PHASES(V)                                       \
+  V(TIMERS, "timers")                                                         \
+  V(POLL_WAIT, "pollWait")                                                    \
+  V(POLL_IO, "pollIO")                                                        \
+  V(CHECK, "check")                                                           \
+  V(PENDING_AND_CLOSE, "pendingAndClose")
+
+// The GC types that GCHistograms records pauses for.
+#define NODE_PERFORMANCE_GC_TYPES(V)                                          \
+  V(SCAVENGE, "scavenge")                                                     \
+  V(MINOR_MARK_SWEEP, "minorMarkSweep")                                       \
+  V(MARK_SWEEP_COMPACT, "markSweepCompact")                                   \
+  V(INCREMENTAL_MARKING, "incrementalMarking")                                \
+  V(PROCESS_WEAK_CALLBACKS, "processWeakCallbacks")
+
+// The groups of V8 heap spaces that GCHistograms records freed bytes for.
+#define NODE_PERFORMANCE_HEAP_SPACES(V)                                       \
+  V(YOUNG, "young")                                                           \
+  V(OLD, "old")                                                               \
+  V(CODE, "code")                                                             \
+  V(LARGE_OBJECT, "largeObject")
 
 #define NODE_PERFORMANCE_ENTRY_TYPES(V)                                       \
   V(GC, "gc")                                                                 \
@@ -48,6 +78,27 @@ enum PerformanceMilestone {
   NODE_PERFORMANCE_MILESTONE_INVALID
 };
 
+enum PerformanceLoopPhase {
+#define V(name, _) NODE_PERFORMANCE_LOOP_PHASE_##name,
+  NODE_PERFORMANCE_LOOP_PHASES(V)
+#undef V
+  NODE_PERFORMANCE_LOOP_PHASE_INVALID
+};
+
+enum PerformanceGCType {
+#define V(name, _) NODE_PERFORMANCE_GC_TYPE_##name,
+  NODE_PERFORMANCE_GC_TYPES(V)
+#undef V
+  NODE_PERFORMANCE_GC_TYPE_INVALID
+};
+
+enum PerformanceHeapSpace {
+#define V(name, _) NODE_PERFORMANCE_HEAP_SPACE_##name,
+  NODE_PERFORMANCE_HEAP_SPACES(V)
+#undef V
+  NODE_PERFORMANCE_HEAP_SPACE_INVALID
+};
+
 enum PerformanceEntryType {
 #define V(name, _) NODE_PERFORMANCE_ENTRY_TYPE_##name,
   NODE_PERFORMANCE_ENTRY_TYPES(V)
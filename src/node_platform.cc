@@ -5,6 +5,7 @@
 #include "debug_utils-inl.h"
 #include <algorithm>  // find_if(), find(), move()
 #include <cmath>  // llround()
+#include <map>  // multimap()
 #include <memory>  // unique_ptr(), shared_ptr(), make_shared()
 
 namespace node {
@@ -16,8 +17,13 @@ using v8::Task;
 
 namespace {
 
+// The queue and lane served by the current thread, if it is a platform
+// worker. Tasks that workers post for themselves stay in their own lane.
+thread_local WorkerTaskQueue* current_worker_queue = nullptr;
+thread_local int current_worker_lane = -1;
+
 struct PlatformWorkerData {
-  TaskQueue<Task>* task_queue;
+  WorkerTaskQueue* task_queue;
   Mutex* platform_workers_mutex;
   ConditionVariable* platform_workers_ready;
   int* pending_platform_workers;
@@ -28,7 +34,10 @@ static void PlatformWorkerThread(void* data) {
   std::unique_ptr<PlatformWorkerData>
       worker_data(static_cast<PlatformWorkerData*>(data));
 
-  TaskQueue<Task>* pending_worker_tasks = worker_data->task_queue;
+  WorkerTaskQueue* pending_worker_tasks = worker_data->task_queue;
+  const int lane = worker_data->id;
+  current_worker_queue = pending_worker_tasks;
+  current_worker_lane = lane;
   TRACE_EVENT_METADATA1("__metadata", "thread_name", "name",
                         "PlatformWorkerThread");
 
@@ -39,7 +48,7 @@ static void PlatformWorkerThread(void* data) {
     worker_data->platform_workers_ready->Signal(lock);
   }
 
-  while (std::unique_ptr<Task> task = pending_worker_tasks->BlockingPop()) {
+  while (std::unique_ptr<Task> task = pending_worker_tasks->BlockingPop(lane)) {
     task->Run();
     pending_worker_tasks->NotifyOfCompletion();
   }
@@ -47,16 +56,22 @@ static void PlatformWorkerThread(void* data) {
 
 static int GetActualThreadPoolSize(int thread_pool_size) {
   if (thread_pool_size < 1) {
-    thread_pool_size = uv_available_parallelism() - 1;
+    thread_pool_size =
+        static_cast<int>(os::GetAvailableParallelism()) - 1;
   }
   return std::max(thread_pool_size, 1);
 }
 
 }  // namespace
 
+// Delayed worker tasks are kept in a single deadline-ordered map that is
+// served by one uv timer, instead of a timer per task. When the timer fires,
+// every task whose deadline falls within its priority's slack is moved to
+// the worker queue at once, so tasks posted with close delays share a single
+// wakeup of the scheduler thread.
 class WorkerThreadsTaskRunner::DelayedTaskScheduler {
  public:
-  explicit DelayedTaskScheduler(TaskQueue<Task>* tasks)
+  explicit DelayedTaskScheduler(WorkerTaskQueue* tasks)
     : pending_worker_tasks_(tasks) {}
 
   std::unique_ptr<uv_thread_t> Start() {
@@ -71,9 +86,11 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
     return t;
   }
 
-  void PostDelayedTask(std::unique_ptr<Task> task, double delay_in_seconds) {
+  void PostDelayedTask(std::unique_ptr<Task> task,
+                       double delay_in_seconds,
+                       v8::TaskPriority priority) {
     tasks_.Push(std::make_unique<ScheduleTask>(this, std::move(task),
-                                               delay_in_seconds));
+                                               delay_in_seconds, priority));
     uv_async_send(&flush_tasks_);
   }
 
@@ -83,6 +100,26 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
   }
 
  private:
+  struct ScheduledTask {
+    std::unique_ptr<Task> task;
+    v8::TaskPriority priority;
+  };
+
+  // How much earlier than its deadline a task may be run to share a wakeup
+  // with an earlier one.
+  static uint64_t SlackMillis(v8::TaskPriority priority) {
+    switch (priority) {
+      case v8::TaskPriority::kUserBlocking:
+        return 0;
+      case v8::TaskPriority::kUserVisible:
+        return 4;
+      case v8::TaskPriority::kBestEffort:
+        return kMaxSlackMillis;
+    }
+    return 0;
+  }
+  static constexpr uint64_t kMaxSlackMillis = 16;
+
   void Run() {
     TRACE_EVENT_METADATA1("__metadata", "thread_name", "name",
                           "WorkerThreadsTaskRunner::DelayedTaskScheduler");
@@ -90,6 +127,7 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
     CHECK_EQ(0, uv_loop_init(&loop_));
     flush_tasks_.data = this;
     CHECK_EQ(0, uv_async_init(&loop_, &flush_tasks_, FlushTasks));
+    CHECK_EQ(0, uv_timer_init(&loop_, &timer_));
     uv_sem_post(&ready_);
 
     uv_run(&loop_, UV_RUN_DEFAULT);
@@ -108,11 +146,9 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
     explicit StopTask(DelayedTaskScheduler* scheduler): scheduler_(scheduler) {}
 
     void Run() override {
-      std::vector<uv_timer_t*> timers;
-      for (uv_timer_t* timer : scheduler_->timers_)
-        timers.push_back(timer);
-      for (uv_timer_t* timer : timers)
-        scheduler_->TakeTimerTask(timer);
+      scheduler_->scheduled_tasks_.clear();
+      uv_close(reinterpret_cast<uv_handle_t*>(&scheduler_->timer_),
+               [](uv_handle_t* handle) {});
       uv_close(reinterpret_cast<uv_handle_t*>(&scheduler_->flush_tasks_),
                [](uv_handle_t* handle) {});
     }
@@ -125,52 +161,76 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
    public:
     ScheduleTask(DelayedTaskScheduler* scheduler,
                  std::unique_ptr<Task> task,
-                 double delay_in_seconds)
+                 double delay_in_seconds,
+                 v8::TaskPriority priority)
       : scheduler_(scheduler),
         task_(std::move(task)),
-        delay_in_seconds_(delay_in_seconds) {}
+        delay_in_seconds_(delay_in_seconds),
+        priority_(priority) {}
 
     void Run() override {
       uint64_t delay_millis = llround(delay_in_seconds_ * 1000);
-      std::unique_ptr<uv_timer_t> timer(new uv_timer_t());
-      CHECK_EQ(0, uv_timer_init(&scheduler_->loop_, timer.get()));
-      timer->data = task_.release();
-      CHECK_EQ(0, uv_timer_start(timer.get(), RunTask, delay_millis, 0));
-      scheduler_->timers_.insert(timer.release());
+      uint64_t deadline = uv_now(&scheduler_->loop_) + delay_millis;
+      scheduler_->scheduled_tasks_.emplace(
+          deadline, ScheduledTask { std::move(task_), priority_ });
+      scheduler_->RescheduleTimer();
     }
 
    private:
     DelayedTaskScheduler* scheduler_;
     std::unique_ptr<Task> task_;
     double delay_in_seconds_;
+    v8::TaskPriority priority_;
   };
 
-  static void RunTask(uv_timer_t* timer) {
-    DelayedTaskScheduler* scheduler =
-        ContainerOf(&DelayedTaskScheduler::loop_, timer->loop);
-    scheduler->pending_worker_tasks_->Push(scheduler->TakeTimerTask(timer));
+  // Arms the timer for the earliest deadline, unless it already is.
+  void RescheduleTimer() {
+    if (scheduled_tasks_.empty()) {
+      uv_timer_stop(&timer_);
+      return;
+    }
+    uint64_t deadline = scheduled_tasks_.begin()->first;
+    if (uv_is_active(reinterpret_cast<uv_handle_t*>(&timer_)) &&
+        timer_deadline_ == deadline) {
+      return;
+    }
+    uint64_t now = uv_now(&loop_);
+    timer_deadline_ = deadline;
+    CHECK_EQ(0, uv_timer_start(&timer_, RunTasks,
+                               deadline > now ? deadline - now : 0, 0));
   }
 
-  std::unique_ptr<Task> TakeTimerTask(uv_timer_t* timer) {
-    std::unique_ptr<Task> task(static_cast<Task*>(timer->data));
-    uv_timer_stop(timer);
-    uv_close(reinterpret_cast<uv_handle_t*>(timer), [](uv_handle_t* handle) {
-      delete reinterpret_cast<uv_timer_t*>(handle);
-    });
-    timers_.erase(timer);
-    return task;
+  static void RunTasks(uv_timer_t* timer) {
+    DelayedTaskScheduler* scheduler =
+        ContainerOf(&DelayedTaskScheduler::timer_, timer);
+    uint64_t now = uv_now(&scheduler->loop_);
+    auto& scheduled = scheduler->scheduled_tasks_;
+    for (auto it = scheduled.begin();
+         it != scheduled.end() && it->first <= now + kMaxSlackMillis;) {
+      if (it->first > now + SlackMillis(it->second.priority)) {
+        ++it;
+        continue;
+      }
+      scheduler->pending_worker_tasks_->Push(std::move(it->second.task),
+                                             it->second.priority);
+      it = scheduled.erase(it);
+    }
+    scheduler->RescheduleTimer();
   }
 
   uv_sem_t ready_;
-  TaskQueue<Task>* pending_worker_tasks_;
+  WorkerTaskQueue* pending_worker_tasks_;
 
   TaskQueue<Task> tasks_;
   uv_loop_t loop_;
   uv_async_t flush_tasks_;
-  std::unordered_set<uv_timer_t*> timers_;
+  uv_timer_t timer_;
+  uint64_t timer_deadline_ = 0;
+  std::multimap<uint64_t, ScheduledTask> scheduled_tasks_;
 };
 
-WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size) {
+WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size)
+    : pending_worker_tasks_(thread_pool_size) {
   Mutex platform_workers_mutex;
   ConditionVariable platform_workers_ready;
 
@@ -201,13 +261,16 @@ WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(int thread_pool_size) {
   }
 }
 
-void WorkerThreadsTaskRunner::PostTask(std::unique_ptr<Task> task) {
-  pending_worker_tasks_.Push(std::move(task));
+void WorkerThreadsTaskRunner::PostTask(std::unique_ptr<Task> task,
+                                       v8::TaskPriority priority) {
+  pending_worker_tasks_.Push(std::move(task), priority);
 }
 
 void WorkerThreadsTaskRunner::PostDelayedTask(std::unique_ptr<Task> task,
-                                              double delay_in_seconds) {
-  delayed_task_scheduler_->PostDelayedTask(std::move(task), delay_in_seconds);
+                                              double delay_in_seconds,
+                                              v8::TaskPriority priority) {
+  delayed_task_scheduler_->PostDelayedTask(
+      std::move(task), delay_in_seconds, priority);
 }
 
 void WorkerThreadsTaskRunner::BlockingDrain() {
@@ -505,7 +568,7 @@ void NodePlatform::PostTaskOnWorkerThreadImpl(
     v8::TaskPriority priority,
     std::unique_ptr<v8::Task> task,
     const v8::SourceLocation& location) {
-  worker_thread_task_runner_->PostTask(std::move(task));
+  worker_thread_task_runner_->PostTask(std::move(task), priority);
 }
 
 void NodePlatform::PostDelayedTaskOnWorkerThreadImpl(
@@ -514,7 +577,8 @@ void NodePlatform::PostDelayedTaskOnWorkerThreadImpl(
     double delay_in_seconds,
     const v8::SourceLocation& location) {
   worker_thread_task_runner_->PostDelayedTask(std::move(task),
-                                              delay_in_seconds);
+                                              delay_in_seconds,
+                                              priority);
 }
 
 IsolatePlatformDelegate* NodePlatform::ForIsolate(Isolate* isolate) {
@@ -581,6 +645,96 @@ v8::PageAllocator* NodePlatform::GetPageAllocator() {
   return page_allocator_;
 }
 
+WorkerTaskQueue::WorkerTaskQueue(int lane_count)
+    : lane_count_(std::max(lane_count, 1)),
+      lanes_(new Lane[lane_count_]) {}
+
+void WorkerTaskQueue::PushToLane(Lane* lane, std::unique_ptr<Task> task) {
+  Mutex::ScopedLock scoped_lock(lane->lock);
+  lane->tasks.push_back(std::move(task));
+  lane->size.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::unique_ptr<Task> WorkerTaskQueue::PopFromLane(Lane* lane) {
+  if (lane->size.load(std::memory_order_relaxed) == 0)
+    return nullptr;
+  Mutex::ScopedLock scoped_lock(lane->lock);
+  if (lane->tasks.empty())
+    return nullptr;
+  std::unique_ptr<Task> result = std::move(lane->tasks.front());
+  lane->tasks.pop_front();
+  lane->size.fetch_sub(1, std::memory_order_relaxed);
+  return result;
+}
+
+void WorkerTaskQueue::Push(std::unique_ptr<Task> task,
+                           v8::TaskPriority priority) {
+  outstanding_tasks_++;
+  Lane* lane;
+  if (priority == v8::TaskPriority::kUserBlocking) {
+    lane = &user_blocking_lane_;
+  } else if (current_worker_queue == this) {
+    lane = &lanes_[current_worker_lane];
+  } else {
+    lane = &lanes_[next_lane_.fetch_add(1, std::memory_order_relaxed) %
+                   lane_count_];
+  }
+  PushToLane(lane, std::move(task));
+
+  // Pairs with the check in BlockingPop(): either the worker sees the new
+  // task before going to sleep or we see the idle worker and wake it up.
+  pending_tasks_++;
+  if (idle_workers_ > 0) {
+    Mutex::ScopedLock scoped_lock(idle_lock_);
+    tasks_available_.Signal(scoped_lock);
+  }
+}
+
+std::unique_ptr<Task> WorkerTaskQueue::TryPop(int lane) {
+  std::unique_ptr<Task> result = PopFromLane(&user_blocking_lane_);
+  // Start with our own lane, then steal from the following ones.
+  for (int i = 0; !result && i < lane_count_; i++)
+    result = PopFromLane(&lanes_[(lane + i) % lane_count_]);
+  if (result)
+    pending_tasks_--;
+  return result;
+}
+
+std::unique_ptr<Task> WorkerTaskQueue::BlockingPop(int lane) {
+  for (;;) {
+    if (stopped_)
+      return nullptr;
+    if (std::unique_ptr<Task> result = TryPop(lane))
+      return result;
+
+    Mutex::ScopedLock scoped_lock(idle_lock_);
+    idle_workers_++;
+    while (pending_tasks_ <= 0 && !stopped_)
+      tasks_available_.Wait(scoped_lock);
+    idle_workers_--;
+  }
+}
+
+void WorkerTaskQueue::NotifyOfCompletion() {
+  if (--outstanding_tasks_ == 0) {
+    Mutex::ScopedLock scoped_lock(drain_lock_);
+    tasks_drained_.Broadcast(scoped_lock);
+  }
+}
+
+void WorkerTaskQueue::BlockingDrain() {
+  Mutex::ScopedLock scoped_lock(drain_lock_);
+  while (outstanding_tasks_ > 0) {
+    tasks_drained_.Wait(scoped_lock);
+  }
+}
+
+void WorkerTaskQueue::Stop() {
+  Mutex::ScopedLock scoped_lock(idle_lock_);
+  stopped_ = true;
+  tasks_available_.Broadcast(scoped_lock);
+}
+
 template <class T>
 TaskQueue<T>::TaskQueue()
     : lock_(), tasks_available_(), tasks_drained_(),
@@ -3,6 +3,8 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <atomic>
+#include <deque>
 #include <queue>
 #include <unordered_map>
 #include <vector>
@@ -42,6 +44,55 @@ class TaskQueue {
   std::queue<std::unique_ptr<T>> task_queue_;
 };
 
+// The queue shared by all platform worker threads. Each worker owns a lane
+// that it takes tasks from first; tasks posted from outside the pool are
+// spread over the lanes and idle workers steal from their neighbours, so
+// posting and running background tasks does not serialize on a single lock.
+// kUserBlocking tasks go to a separate lane that every worker checks first.
+class WorkerTaskQueue {
+ public:
+  explicit WorkerTaskQueue(int lane_count);
+  ~WorkerTaskQueue() = default;
+
+  void Push(std::unique_ptr<v8::Task> task,
+            v8::TaskPriority priority = v8::TaskPriority::kUserVisible);
+  // Blocks until a task is available for the worker that owns |lane|, or
+  // returns nullptr once the queue has been stopped.
+  std::unique_ptr<v8::Task> BlockingPop(int lane);
+  void NotifyOfCompletion();
+  void BlockingDrain();
+  void Stop();
+
+ private:
+  struct Lane {
+    Mutex lock;
+    std::deque<std::unique_ptr<v8::Task>> tasks;
+    // Lets other workers skip empty lanes without taking the lock.
+    std::atomic<size_t> size{0};
+  };
+
+  static void PushToLane(Lane* lane, std::unique_ptr<v8::Task> task);
+  static std::unique_ptr<v8::Task> PopFromLane(Lane* lane);
+  std::unique_ptr<v8::Task> TryPop(int lane);
+
+  const int lane_count_;
+  std::unique_ptr<Lane[]> lanes_;
+  Lane user_blocking_lane_;
+  std::atomic<unsigned int> next_lane_{0};
+
+  // Number of tasks that have been pushed but not yet popped. This may be
+  // briefly negative when a task is taken before its Push() has returned.
+  std::atomic<int> pending_tasks_{0};
+  std::atomic<int> idle_workers_{0};
+  std::atomic<bool> stopped_{false};
+  Mutex idle_lock_;
+  ConditionVariable tasks_available_;
+
+  std::atomic<int> outstanding_tasks_{0};
+  Mutex drain_lock_;
+  ConditionVariable tasks_drained_;
+};
+
 struct DelayedTask {
   std::unique_ptr<v8::Task> task;
   uv_timer_t timer;
@@ -117,9 +168,12 @@ class WorkerThreadsTaskRunner {
  public:
   explicit WorkerThreadsTaskRunner(int thread_pool_size);
 
-  void PostTask(std::unique_ptr<v8::Task> task);
-  void PostDelayedTask(std::unique_ptr<v8::Task> task,
-                       double delay_in_seconds);
+  void PostTask(std::unique_ptr<v8::Task> task,
+                v8::TaskPriority priority = v8::TaskPriority::kUserVisible);
+  void PostDelayedTask(
+      std::unique_ptr<v8::Task> task,
+      double delay_in_seconds,
+      v8::TaskPriority priority = v8::TaskPriority::kUserVisible);
 
   void BlockingDrain();
   void Shutdown();
@@ -127,7 +181,7 @@ class WorkerThreadsTaskRunner {
   int NumberOfWorkerThreads() const;
 
  private:
-  TaskQueue<v8::Task> pending_worker_tasks_;
+  WorkerTaskQueue pending_worker_tasks_;
 
   class DelayedTaskScheduler;
   std::unique_ptr<DelayedTaskScheduler> delayed_task_scheduler_;
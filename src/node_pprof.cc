@@ -0,0 +1,468 @@
+#include "node_pprof.h"
+#include "base_object-inl.h"
+#include "env-inl.h"
+#include "memory_tracker-inl.h"
+#include "node_buffer.h"
+#include "node_external_reference.h"
+#include "protobuf_writer.h"
+#include "util-inl.h"
+
+#include "v8-profiler.h"
+
+#include <algorithm>
+
+namespace node {
+namespace pprof {
+
+using v8::AllocationProfile;
+using v8::Context;
+using v8::CpuProfile;
+using v8::CpuProfileNode;
+using v8::CpuProfiler;
+using v8::CpuProfilingOptions;
+using v8::CpuProfilingStatus;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Int32;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::ProfilerId;
+using v8::Uint32;
+using v8::Value;
+
+using protobuf::WriteBytes;
+using protobuf::WriteNonZeroInt;
+using protobuf::WriteVarint;
+
+namespace {
+
+void WriteValueType(std::string* out,
+                    uint32_t field,
+                    const std::pair<int64_t, int64_t>& value_type) {
+  std::string message;
+  WriteNonZeroInt(&message, 1, value_type.first);
+  WriteNonZeroInt(&message, 2, value_type.second);
+  WriteBytes(out, field, message);
+}
+
+// Field numbers of perftools.profiles.Profile.
+enum ProfileField {
+  kSampleType = 1,
+  kSample = 2,
+  kLocation = 4,
+  kFunction = 5,
+  kStringTable = 6,
+  kTimeNanos = 9,
+  kDurationNanos = 10,
+  kPeriodType = 11,
+  kPeriod = 12,
+};
+
+}  // anonymous namespace
+
+ProfileBuilder::ProfileBuilder(std::initializer_list<ValueType> sample_types,
+                               ValueType period_type,
+                               int64_t period)
+    : period_(period) {
+  // The string table has to start with the empty string.
+  AddString("");
+  for (const ValueType& sample_type : sample_types) {
+    int64_t type = AddString(sample_type.type);
+    sample_types_.emplace_back(type, AddString(sample_type.unit));
+  }
+  period_type_.first = AddString(period_type.type);
+  period_type_.second = AddString(period_type.unit);
+}
+
+int64_t ProfileBuilder::AddString(std::string_view str) {
+  auto [it, inserted] =
+      string_ids_.emplace(std::string(str), static_cast<int64_t>(0));
+  if (inserted) {
+    it->second = strings_.size();
+    strings_.emplace_back(str);
+  }
+  return it->second;
+}
+
+uint64_t ProfileBuilder::AddLocation(std::string_view name,
+                                     std::string_view filename,
+                                     int64_t start_line,
+                                     int64_t line) {
+  std::string key;
+  key.reserve(name.size() + filename.size() + 24);
+  key.append(name).push_back('\0');
+  key.append(filename).push_back('\0');
+  key.append(std::to_string(start_line));
+  auto [function, new_function] = function_ids_.emplace(key, 0);
+  if (new_function) {
+    functions_.push_back({AddString(name), AddString(filename), start_line});
+    // Ids have to be non-zero.
+    function->second = functions_.size();
+  }
+
+  key.push_back('\0');
+  key.append(std::to_string(line));
+  auto [location, new_location] = location_ids_.emplace(std::move(key), 0);
+  if (new_location) {
+    locations_.push_back({function->second, line});
+    location->second = locations_.size();
+  }
+  return location->second;
+}
+
+void ProfileBuilder::AddSample(const std::vector<uint64_t>& locations,
+                               std::initializer_list<int64_t> values) {
+  CHECK_EQ(values.size(), sample_types_.size());
+  std::string message;
+  std::string packed;
+  for (uint64_t location : locations) WriteVarint(&packed, location);
+  WriteBytes(&message, 1, packed);
+  packed.clear();
+  for (int64_t value : values)
+    WriteVarint(&packed, static_cast<uint64_t>(value));
+  WriteBytes(&message, 2, packed);
+  WriteBytes(&samples_, kSample, message);
+}
+
+std::string ProfileBuilder::Serialize() const {
+  std::string out;
+  for (const auto& sample_type : sample_types_)
+    WriteValueType(&out, kSampleType, sample_type);
+  out.append(samples_);
+
+  std::string message;
+  for (size_t i = 0; i < locations_.size(); i++) {
+    std::string line;
+    WriteNonZeroInt(&line, 1, locations_[i].function_id);
+    WriteNonZeroInt(&line, 2, locations_[i].line);
+    message.clear();
+    WriteNonZeroInt(&message, 1, i + 1);
+    WriteBytes(&message, 4, line);
+    WriteBytes(&out, kLocation, message);
+  }
+  for (size_t i = 0; i < functions_.size(); i++) {
+    message.clear();
+    WriteNonZeroInt(&message, 1, i + 1);
+    WriteNonZeroInt(&message, 2, functions_[i].name);
+    WriteNonZeroInt(&message, 3, functions_[i].name);
+    WriteNonZeroInt(&message, 4, functions_[i].filename);
+    WriteNonZeroInt(&message, 5, functions_[i].start_line);
+    WriteBytes(&out, kFunction, message);
+  }
+  for (const std::string& str : strings_) WriteBytes(&out, kStringTable, str);
+
+  WriteNonZeroInt(&out, kTimeNanos, time_nanos_);
+  WriteNonZeroInt(&out, kDurationNanos, duration_nanos_);
+  WriteValueType(&out, kPeriodType, period_type_);
+  WriteNonZeroInt(&out, kPeriod, period_);
+  return out;
+}
+
+namespace {
+
+int64_t NowInNanoseconds() {
+  return static_cast<int64_t>(GetCurrentTimeInMicroseconds()) * 1000;
+}
+
+std::string_view FunctionName(std::string_view name) {
+  return name.empty() ? "(anonymous)" : name;
+}
+
+void ReturnProfile(const FunctionCallbackInfo<Value>& args,
+                   const ProfileBuilder& builder) {
+  std::string profile = builder.Serialize();
+  Local<Object> buffer;
+  if (Buffer::Copy(args.GetIsolate(), profile.data(), profile.size())
+          .ToLocal(&buffer)) {
+    args.GetReturnValue().Set(buffer);
+  }
+}
+
+// Exposes a v8::CpuProfiler. Only the hit counts of the profile tree are
+// used, so the profiler does not have to keep every single sample around.
+class CpuProfilerWrap : public BaseObject {
+ public:
+  static void New(const FunctionCallbackInfo<Value>& args);
+  // start() returns false if the profiler is already running, or if V8
+  // could not start it.
+  static void Start(const FunctionCallbackInfo<Value>& args);
+  // stop() returns the profile, or undefined if the profiler was not
+  // running.
+  static void Stop(const FunctionCallbackInfo<Value>& args);
+
+  CpuProfilerWrap(Environment* env, Local<Object> object, int interval_us)
+      : BaseObject(env, object),
+        profiler_(CpuProfiler::New(env->isolate())),
+        interval_us_(interval_us) {
+    MakeWeak();
+  }
+
+  ~CpuProfilerWrap() override {
+    if (running_) {
+      CpuProfile* profile = profiler_->Stop(id_);
+      if (profile != nullptr) profile->Delete();
+    }
+    profiler_->Dispose();
+  }
+
+  void MemoryInfo(MemoryTracker* tracker) const override {}
+  SET_MEMORY_INFO_NAME(CpuProfilerWrap)
+  SET_SELF_SIZE(CpuProfilerWrap)
+
+ private:
+  CpuProfiler* const profiler_;
+  const int interval_us_;
+  ProfilerId id_ = 0;
+  bool running_ = false;
+  int64_t start_time_nanos_ = 0;
+};
+
+void CpuProfilerWrap::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsInt32());
+  int interval_us = args[0].As<Int32>()->Value();
+  CHECK_GT(interval_us, 0);
+  new CpuProfilerWrap(Environment::GetCurrent(args), args.This(), interval_us);
+}
+
+void CpuProfilerWrap::Start(const FunctionCallbackInfo<Value>& args) {
+  CpuProfilerWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  if (wrap->running_) return args.GetReturnValue().Set(false);
+  auto result = wrap->profiler_->Start(CpuProfilingOptions(
+      v8::kLeafNodeLineNumbers, 0, wrap->interval_us_));
+  if (result.status == CpuProfilingStatus::kErrorTooManyProfilers)
+    return args.GetReturnValue().Set(false);
+  wrap->id_ = result.id;
+  wrap->running_ = true;
+  wrap->start_time_nanos_ = NowInNanoseconds();
+  args.GetReturnValue().Set(true);
+}
+
+void CpuProfilerWrap::Stop(const FunctionCallbackInfo<Value>& args) {
+  CpuProfilerWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  if (!wrap->running_) return;
+  wrap->running_ = false;
+  CpuProfile* profile = wrap->profiler_->Stop(wrap->id_);
+  if (profile == nullptr) return;
+  auto delete_profile = OnScopeLeave([&]() { profile->Delete(); });
+
+  const int64_t interval_ns = int64_t{wrap->interval_us_} * 1000;
+  ProfileBuilder builder({{"samples", "count"}, {"cpu", "nanoseconds"}},
+                         {"cpu", "nanoseconds"},
+                         interval_ns);
+  builder.set_time_nanos(wrap->start_time_nanos_);
+  builder.set_duration_nanos(
+      (profile->GetEndTime() - profile->GetStartTime()) * 1000);
+
+  // Walk the tree depth first. `stack` holds the locations from the root
+  // down to the current node.
+  struct Entry {
+    const CpuProfileNode* node;
+    int next_child;
+  };
+  std::vector<Entry> pending;
+  std::vector<uint64_t> stack;
+  std::vector<uint64_t> sample;
+  const CpuProfileNode* root = profile->GetTopDownRoot();
+  for (int i = 0; i < root->GetChildrenCount(); i++) {
+    pending.push_back({root->GetChild(i), -1});
+    while (!pending.empty()) {
+      Entry& entry = pending.back();
+      const CpuProfileNode* node = entry.node;
+      if (entry.next_child == -1) {
+        int line = std::max(node->GetLineNumber(), 0);
+        stack.push_back(builder.AddLocation(
+            FunctionName(node->GetFunctionNameStr()),
+            node->GetScriptResourceNameStr(),
+            line,
+            line));
+        if (unsigned hits = node->GetHitCount()) {
+          sample.assign(stack.rbegin(), stack.rend());
+          builder.AddSample(sample,
+                            {static_cast<int64_t>(hits), hits * interval_ns});
+        }
+        entry.next_child = 0;
+      }
+      if (entry.next_child < node->GetChildrenCount()) {
+        // `entry` is invalidated by the push_back().
+        const CpuProfileNode* child = node->GetChild(entry.next_child++);
+        pending.push_back({child, -1});
+      } else {
+        pending.pop_back();
+        stack.pop_back();
+      }
+    }
+  }
+  ReturnProfile(args, builder);
+}
+
+// Exposes V8's sampling heap profiler, of which there is one per isolate.
+class HeapProfilerWrap : public BaseObject {
+ public:
+  static void New(const FunctionCallbackInfo<Value>& args);
+  // start(interval, depth) returns false if the sampling heap profiler of
+  // the isolate is already running.
+  static void Start(const FunctionCallbackInfo<Value>& args);
+  // profile() returns the allocations that are still live, or undefined if
+  // the profiler is not running. The profiler keeps running.
+  static void GetProfile(const FunctionCallbackInfo<Value>& args);
+  static void Stop(const FunctionCallbackInfo<Value>& args);
+
+  HeapProfilerWrap(Environment* env, Local<Object> object)
+      : BaseObject(env, object) {
+    MakeWeak();
+  }
+
+  ~HeapProfilerWrap() override {
+    if (running_)
+      env()->isolate()->GetHeapProfiler()->StopSamplingHeapProfiler();
+  }
+
+  void MemoryInfo(MemoryTracker* tracker) const override {}
+  SET_MEMORY_INFO_NAME(HeapProfilerWrap)
+  SET_SELF_SIZE(HeapProfilerWrap)
+
+ private:
+  uint64_t interval_ = 0;
+  bool running_ = false;
+};
+
+void HeapProfilerWrap::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  new HeapProfilerWrap(Environment::GetCurrent(args), args.This());
+}
+
+void HeapProfilerWrap::Start(const FunctionCallbackInfo<Value>& args) {
+  HeapProfilerWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsUint32());
+  uint64_t interval = args[0].As<Uint32>()->Value();
+  int depth = static_cast<int>(args[1].As<Uint32>()->Value());
+  CHECK_GT(interval, 0);
+  if (wrap->running_ ||
+      !args.GetIsolate()->GetHeapProfiler()->StartSamplingHeapProfiler(
+          interval, depth)) {
+    return args.GetReturnValue().Set(false);
+  }
+  wrap->interval_ = interval;
+  wrap->running_ = true;
+  args.GetReturnValue().Set(true);
+}
+
+void HeapProfilerWrap::GetProfile(const FunctionCallbackInfo<Value>& args) {
+  HeapProfilerWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  if (!wrap->running_) return;
+  Isolate* isolate = args.GetIsolate();
+  HandleScope handle_scope(isolate);
+  std::unique_ptr<AllocationProfile> profile(
+      isolate->GetHeapProfiler()->GetAllocationProfile());
+  if (!profile) return;
+
+  ProfileBuilder builder({{"objects", "count"}, {"space", "bytes"}},
+                         {"space", "bytes"},
+                         wrap->interval_);
+  builder.set_time_nanos(NowInNanoseconds());
+
+  struct Entry {
+    AllocationProfile::Node* node;
+    size_t next_child;
+    bool visited;
+  };
+  std::vector<Entry> pending;
+  std::vector<uint64_t> stack;
+  std::vector<uint64_t> sample;
+  AllocationProfile::Node* root = profile->GetRootNode();
+  for (AllocationProfile::Node* top : root->children) {
+    pending.push_back({top, 0, false});
+    while (!pending.empty()) {
+      Entry& entry = pending.back();
+      AllocationProfile::Node* node = entry.node;
+      if (!entry.visited) {
+        Utf8Value name(isolate, node->name);
+        Utf8Value script_name(isolate, node->script_name);
+        int line = std::max(node->line_number, 0);
+        stack.push_back(builder.AddLocation(
+            FunctionName(name.ToStringView()),
+            script_name.ToStringView(),
+            line,
+            line));
+        int64_t count = 0;
+        int64_t size = 0;
+        for (const AllocationProfile::Allocation& allocation :
+             node->allocations) {
+          count += allocation.count;
+          size += static_cast<int64_t>(allocation.size) * allocation.count;
+        }
+        if (count > 0) {
+          sample.assign(stack.rbegin(), stack.rend());
+          builder.AddSample(sample, {count, size});
+        }
+        entry.visited = true;
+      }
+      if (entry.next_child < node->children.size()) {
+        AllocationProfile::Node* child = node->children[entry.next_child++];
+        pending.push_back({child, 0, false});
+      } else {
+        pending.pop_back();
+        stack.pop_back();
+      }
+    }
+  }
+  ReturnProfile(args, builder);
+}
+
+void HeapProfilerWrap::Stop(const FunctionCallbackInfo<Value>& args) {
+  HeapProfilerWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  if (!wrap->running_) return;
+  wrap->running_ = false;
+  args.GetIsolate()->GetHeapProfiler()->StopSamplingHeapProfiler();
+}
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context,
+                void* priv) {
+  Isolate* isolate = context->GetIsolate();
+
+  Local<FunctionTemplate> cpu =
+      NewFunctionTemplate(isolate, CpuProfilerWrap::New);
+  cpu->InstanceTemplate()->SetInternalFieldCount(
+      CpuProfilerWrap::kInternalFieldCount);
+  SetProtoMethod(isolate, cpu, "start", CpuProfilerWrap::Start);
+  SetProtoMethod(isolate, cpu, "stop", CpuProfilerWrap::Stop);
+  SetConstructorFunction(context, target, "CpuProfiler", cpu);
+
+  Local<FunctionTemplate> heap =
+      NewFunctionTemplate(isolate, HeapProfilerWrap::New);
+  heap->InstanceTemplate()->SetInternalFieldCount(
+      HeapProfilerWrap::kInternalFieldCount);
+  SetProtoMethod(isolate, heap, "start", HeapProfilerWrap::Start);
+  SetProtoMethod(isolate, heap, "profile", HeapProfilerWrap::GetProfile);
+  SetProtoMethod(isolate, heap, "stop", HeapProfilerWrap::Stop);
+  SetConstructorFunction(context, target, "HeapProfiler", heap);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(CpuProfilerWrap::New);
+  registry->Register(CpuProfilerWrap::Start);
+  registry->Register(CpuProfilerWrap::Stop);
+  registry->Register(HeapProfilerWrap::New);
+  registry->Register(HeapProfilerWrap::Start);
+  registry->Register(HeapProfilerWrap::GetProfile);
+  registry->Register(HeapProfilerWrap::Stop);
+}
+
+}  // anonymous namespace
+
+}  // namespace pprof
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(pprof, node::pprof::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(pprof, node::pprof::RegisterExternalReferences)
@@ -0,0 +1,86 @@
+#ifndef SRC_NODE_PPROF_H_
+#define SRC_NODE_PPROF_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+namespace pprof {
+
+// Builds a profile in the pprof format, i.e. a serialized
+// perftools.profiles.Profile protocol buffer, see
+// https://github.com/google/pprof/blob/main/proto/profile.proto.
+// Strings, functions and locations are deduplicated as they are added.
+// The output is not gzipped; pprof consumers accept both.
+class ProfileBuilder {
+ public:
+  struct ValueType {
+    std::string_view type;
+    std::string_view unit;
+  };
+
+  ProfileBuilder(std::initializer_list<ValueType> sample_types,
+                 ValueType period_type,
+                 int64_t period);
+
+  ProfileBuilder(const ProfileBuilder&) = delete;
+  ProfileBuilder& operator=(const ProfileBuilder&) = delete;
+
+  // Returns the id of the location for `line` in the function `name` that
+  // starts at `start_line` in `filename`.
+  uint64_t AddLocation(std::string_view name,
+                       std::string_view filename,
+                       int64_t start_line,
+                       int64_t line);
+  // `locations` lists the stack of the sample, leaf first. There has to be
+  // one value per sample type.
+  void AddSample(const std::vector<uint64_t>& locations,
+                 std::initializer_list<int64_t> values);
+
+  void set_time_nanos(int64_t time_nanos) { time_nanos_ = time_nanos; }
+  void set_duration_nanos(int64_t duration_nanos) {
+    duration_nanos_ = duration_nanos;
+  }
+
+  std::string Serialize() const;
+
+ private:
+  struct Location {
+    uint64_t function_id;
+    int64_t line;
+  };
+  struct Function {
+    int64_t name;
+    int64_t filename;
+    int64_t start_line;
+  };
+
+  int64_t AddString(std::string_view str);
+
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, int64_t> string_ids_;
+  std::vector<Function> functions_;
+  std::unordered_map<std::string, uint64_t> function_ids_;
+  std::vector<Location> locations_;
+  std::unordered_map<std::string, uint64_t> location_ids_;
+  // Samples are encoded as they are added.
+  std::string samples_;
+  std::vector<std::pair<int64_t, int64_t>> sample_types_;
+  std::pair<int64_t, int64_t> period_type_;
+  const int64_t period_;
+  int64_t time_nanos_ = 0;
+  int64_t duration_nanos_ = 0;
+};
+
+}  // namespace pprof
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_PPROF_H_
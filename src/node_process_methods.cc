@@ -9,6 +9,7 @@
 #include "node_external_reference.h"
 #include "node_internals.h"
 #include "node_process-inl.h"
+#include "threadpoolwork-inl.h"
 #include "util-inl.h"
 #include "uv.h"
 #include "v8-fast-api-calls.h"
@@ -48,7 +49,9 @@ using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::Maybe;
+using v8::Name;
 using v8::NewStringType;
+using v8::Null;
 using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
@@ -210,6 +213,34 @@ static void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
           : static_cast<double>(array_buffer_allocator->total_mem_usage());
 }
 
+// The fields are the counters of NATIVE_MEMORY_COUNTERS, followed by the
+// memory of the ArrayBuffer allocator and of the compile cache.
+static void NativeMemoryUsage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  constexpr size_t kCounterCount = mem::NativeMemoryCounters::kCounterCount;
+
+  Local<ArrayBuffer> ab = get_fields_array_buffer(args, 0, kCounterCount + 2);
+  double* fields = static_cast<double*>(ab->Data());
+
+  mem::NativeMemoryCounters* counters = env->native_memory_counters();
+  for (size_t i = 0; i < kCounterCount; i++) {
+    fields[i] = static_cast<double>(
+        counters->Get(static_cast<mem::NativeMemoryCounters::Counter>(i)));
+  }
+
+  NodeArrayBufferAllocator* array_buffer_allocator =
+      env->isolate_data()->node_allocator();
+  fields[kCounterCount] =
+      array_buffer_allocator == nullptr
+          ? 0
+          : static_cast<double>(array_buffer_allocator->total_mem_usage());
+  fields[kCounterCount + 1] = 0;
+  if (env->use_compile_cache()) {
+    fields[kCounterCount + 1] =
+        static_cast<double>(env->compile_cache_handler()->NativeMemorySize());
+  }
+}
+
 static void GetConstrainedMemory(const FunctionCallbackInfo<Value>& args) {
   uint64_t value = uv_get_constrained_memory();
   args.GetReturnValue().Set(static_cast<double>(value));
@@ -287,6 +318,91 @@ void GetActiveHandles(const FunctionCallbackInfo<Value>& args) {
       Array::New(env->isolate(), handle_v.data(), handle_v.size()));
 }
 
+// Reports, per kind of libuv threadpool work, how much of it is running,
+// how much is held back by its concurrency limit and how many libuv requests
+// of that kind are in flight. The latter are submitted to libuv directly and
+// are queued inside of it, so only their total is known. The named pools of
+// Node-API addons are reported the same way, by name.
+static void GetThreadPoolInfo(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  double fs_requests = 0;
+  double dns_requests = 0;
+  for (ReqWrapBase* req_wrap : *env->req_wrap_queue()) {
+    switch (req_wrap->GetAsyncWrap()->provider_type()) {
+      case AsyncWrap::PROVIDER_FSREQCALLBACK:
+      case AsyncWrap::PROVIDER_FSREQPROMISE:
+        fs_requests++;
+        break;
+      case AsyncWrap::PROVIDER_GETADDRINFOREQWRAP:
+      case AsyncWrap::PROVIDER_GETNAMEINFOREQWRAP:
+        dns_requests++;
+        break;
+      default:
+        break;
+    }
+  }
+
+  auto queue_info = [&](const ThreadPoolWorkQueue* queue,
+                        size_t limit,
+                        double requests) {
+    Local<Name> names[] = {
+        FIXED_ONE_BYTE_STRING(isolate, "running"),
+        FIXED_ONE_BYTE_STRING(isolate, "waiting"),
+        FIXED_ONE_BYTE_STRING(isolate, "maxWaiting"),
+        FIXED_ONE_BYTE_STRING(isolate, "completed"),
+        FIXED_ONE_BYTE_STRING(isolate, "limit"),
+        FIXED_ONE_BYTE_STRING(isolate, "requests"),
+    };
+    Local<Value> values[] = {
+        Number::New(isolate, queue->running),
+        Number::New(isolate, queue->waiting.size()),
+        Number::New(isolate, queue->max_waiting),
+        Number::New(isolate, static_cast<double>(queue->completed)),
+        Number::New(isolate, limit),
+        Number::New(isolate, requests),
+    };
+    static_assert(arraysize(names) == arraysize(values));
+    return Object::New(isolate, Null(isolate), names, values, arraysize(names));
+  };
+  auto lane_info = [&](ThreadPoolWorkKind kind, double requests) {
+    return queue_info(env->threadpool_work_queue(kind),
+                      ThreadPoolWork::ConcurrencyLimit(kind),
+                      requests);
+  };
+
+  Local<Object> pools =
+      Object::New(isolate, Null(isolate), nullptr, nullptr, 0);
+  for (const auto& [name, pool] : env->threadpool_work_pools()) {
+    Local<Value> key;
+    if (!ToV8Value(env->context(), name, isolate).ToLocal(&key) ||
+        pools->Set(env->context(), key, queue_info(&pool, pool.limit, 0))
+            .IsNothing()) {
+      return;
+    }
+  }
+
+  Local<Value> dns_values[] = {Number::New(isolate, dns_requests)};
+  Local<Name> dns_names[] = {FIXED_ONE_BYTE_STRING(isolate, "requests")};
+  Local<Name> names[] = {
+      FIXED_ONE_BYTE_STRING(isolate, "cpu"),
+      FIXED_ONE_BYTE_STRING(isolate, "fs"),
+      FIXED_ONE_BYTE_STRING(isolate, "dns"),
+      FIXED_ONE_BYTE_STRING(isolate, "other"),
+      FIXED_ONE_BYTE_STRING(isolate, "pools"),
+  };
+  Local<Value> values[] = {
+      lane_info(ThreadPoolWorkKind::kCpu, 0),
+      lane_info(ThreadPoolWorkKind::kFs, fs_requests),
+      Object::New(isolate, Null(isolate), dns_names, dns_values, 1),
+      lane_info(ThreadPoolWorkKind::kOther, 0),
+      pools,
+  };
+  args.GetReturnValue().Set(
+      Object::New(isolate, Null(isolate), names, values, arraysize(names)));
+}
+
 static void GetActiveResourcesInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   std::vector<Local<Value>> resources_info;
@@ -642,6 +758,7 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
 
   SetMethod(isolate, target, "umask", Umask);
   SetMethod(isolate, target, "memoryUsage", MemoryUsage);
+  SetMethod(isolate, target, "nativeMemoryUsage", NativeMemoryUsage);
   SetMethod(isolate, target, "constrainedMemory", GetConstrainedMemory);
   SetMethod(isolate, target, "availableMemory", GetAvailableMemory);
   SetMethod(isolate, target, "rss", Rss);
@@ -652,6 +769,7 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "_getActiveRequests", GetActiveRequests);
   SetMethod(isolate, target, "_getActiveHandles", GetActiveHandles);
   SetMethod(isolate, target, "getActiveResourcesInfo", GetActiveResourcesInfo);
+  SetMethod(isolate, target, "getThreadPoolInfo", GetThreadPoolInfo);
   SetMethod(isolate, target, "_kill", Kill);
   SetMethod(isolate, target, "_rawDebug", RawDebug);
 
@@ -686,6 +804,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Umask);
   registry->Register(RawDebug);
   registry->Register(MemoryUsage);
+  registry->Register(NativeMemoryUsage);
   registry->Register(GetConstrainedMemory);
   registry->Register(GetAvailableMemory);
   registry->Register(Rss);
@@ -695,6 +814,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetActiveRequests);
   registry->Register(GetActiveHandles);
   registry->Register(GetActiveResourcesInfo);
+  registry->Register(GetThreadPoolInfo);
   registry->Register(Kill);
 
   registry->Register(Cwd);
@@ -128,6 +128,14 @@ void Realm::RemoveCleanupHook(CleanupQueue::Callback fn, void* arg) {
   cleanup_queue_.Remove(fn, arg);
 }
 
+void Realm::AddCleanupHook(CleanupQueue::CleanupHook* hook) {
+  cleanup_queue_.Add(hook);
+}
+
+void Realm::RemoveCleanupHook(CleanupQueue::CleanupHook* hook) {
+  cleanup_queue_.Remove(hook);
+}
+
 bool Realm::HasCleanupHooks() const {
   return !cleanup_queue_.empty();
 }
@@ -73,6 +73,8 @@ class Realm : public MemoryRetainer {
 
   inline void AddCleanupHook(CleanupQueue::Callback cb, void* arg);
   inline void RemoveCleanupHook(CleanupQueue::Callback cb, void* arg);
+  inline void AddCleanupHook(CleanupQueue::CleanupHook* hook);
+  inline void RemoveCleanupHook(CleanupQueue::CleanupHook* hook);
   inline bool HasCleanupHooks() const;
   void RunCleanup();
 
@@ -3,6 +3,7 @@
 #include "diagnosticfilename-inl.h"
 #include "env-inl.h"
 #include "json_utils.h"
+#include "node_log_sink.h"
 #include "node_internals.h"
 #include "node_metadata.h"
 #include "node_mutex.h"
@@ -18,6 +19,7 @@
 #include <dlfcn.h>
 #endif
 
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <ctime>
@@ -62,7 +64,8 @@ static void WriteNodeReport(Isolate* isolate,
                             std::ostream& out,
                             Local<Value> error,
                             bool compact,
-                            bool exclude_network = false);
+                            bool exclude_network = false,
+                            uint32_t sections = kAllSections);
 static void PrintVersionInformation(JSONWriter* writer,
                                     bool exclude_network = false);
 static void PrintJavaScriptErrorStack(JSONWriter* writer,
@@ -78,14 +81,68 @@ static void PrintJavaScriptErrorProperties(JSONWriter* writer,
                                            Local<Value> error);
 static void PrintNativeStack(JSONWriter* writer);
 static void PrintResourceUsage(JSONWriter* writer);
+static void PrintLargePages(JSONWriter* writer);
 static void PrintGCStatistics(JSONWriter* writer, Isolate* isolate);
-static void PrintSystemInformation(JSONWriter* writer);
+static void PrintSystemInformation(JSONWriter* writer, uint32_t sections);
 static void PrintLoadedLibraries(JSONWriter* writer);
 static void PrintComponentVersions(JSONWriter* writer);
 static void PrintRelease(JSONWriter* writer);
 static void PrintCpuInfo(JSONWriter* writer);
 static void PrintNetworkInterfaceInfo(JSONWriter* writer);
 
+bool ParseSections(std::string_view list, uint32_t* sections) {
+  static constexpr std::pair<std::string_view, ReportSection> kNames[] = {
+      {"javascriptStack", kJavaScriptStack},
+      {"javascriptHeap", kJavaScriptHeap},
+      {"nativeStack", kNativeStack},
+      {"resourceUsage", kResourceUsage},
+      {"largePages", kLargePages},
+      {"libuv", kLibuv},
+      {"workers", kWorkers},
+      {"environmentVariables", kEnvironmentVariables},
+      {"userLimits", kUserLimits},
+      {"sharedObjects", kSharedObjects},
+  };
+
+  if (list.empty()) {
+    *sections = kAllSections;
+    return true;
+  }
+  *sections = 0;
+  while (true) {
+    size_t comma = list.find(',');
+    std::string_view name = list.substr(0, comma);
+    const auto* it =
+        std::find_if(std::begin(kNames), std::end(kNames), [&](const auto& n) {
+          return n.first == name;
+        });
+    if (it == std::end(kNames)) return false;
+    *sections |= it->second;
+    if (comma == std::string_view::npos) return true;
+    list.remove_prefix(comma + 1);
+  }
+}
+
+static uint32_t GetSections(Environment* env) {
+  const std::string& list =
+      env != nullptr
+          ? env->options()->report_sections
+          : per_process::cli_options->per_isolate->per_env->report_sections;
+  uint32_t sections;
+  // Validated along with the other options, but not if set at runtime.
+  if (!ParseSections(list, &sections)) return kAllSections;
+  return sections;
+}
+
+namespace {
+
+struct SystemInformationTask {
+  JSONWriter* writer;
+  uint32_t sections;
+};
+
+}  // anonymous namespace
+
 // Internal function to coordinate and write the various
 // sections of the report to the supplied stream
 static void WriteNodeReport(Isolate* isolate,
@@ -96,7 +153,8 @@ static void WriteNodeReport(Isolate* isolate,
                             std::ostream& out,
                             Local<Value> error,
                             bool compact,
-                            bool exclude_network) {
+                            bool exclude_network,
+                            uint32_t sections) {
   // Obtain the current time and the pid.
   TIME_TYPE tm_struct;
   DiagnosticFilename::LocalTime(&tm_struct);
@@ -180,77 +238,114 @@ static void WriteNodeReport(Isolate* isolate,
   PrintVersionInformation(&writer, exclude_network);
   writer.json_objectend();
 
-  if (isolate != nullptr) {
-    writer.json_objectstart("javascriptStack");
-    // Report summary JavaScript error stack backtrace
-    PrintJavaScriptErrorStack(&writer, isolate, error, trigger);
-
-    writer.json_objectend();  // the end of 'javascriptStack'
+  // The environment variables, the resource limits and the shared objects
+  // come last, and do not have to be read on this thread, which the report
+  // stalls. They are read on a thread of their own while this one collects
+  // the rest, except on fatal errors, where the process may not be in a
+  // state to start one.
+  const uint32_t system_sections =
+      sections & (kEnvironmentVariables | kUserLimits | kSharedObjects);
+  std::ostringstream system_out;
+  JSONWriter system_writer(system_out, writer);
+  SystemInformationTask system_task{&system_writer, system_sections};
+  uv_thread_t system_thread;
+  bool system_thread_started = false;
+  if (system_sections != 0 && strcmp(trigger, "FatalError") != 0 &&
+      strcmp(trigger, "OOMError") != 0) {
+    system_thread_started =
+        uv_thread_create(
+            &system_thread,
+            [](void* arg) {
+              SystemInformationTask* task =
+                  static_cast<SystemInformationTask*>(arg);
+              PrintSystemInformation(task->writer, task->sections);
+            },
+            &system_task) == 0;
+  }
 
-    // Report V8 Heap and Garbage Collector information
-    PrintGCStatistics(&writer, isolate);
-  } else {
+  if (sections & kJavaScriptStack) {
     writer.json_objectstart("javascriptStack");
-    PrintEmptyJavaScriptStack(&writer);
+    if (isolate != nullptr) {
+      // Report summary JavaScript error stack backtrace
+      PrintJavaScriptErrorStack(&writer, isolate, error, trigger);
+    } else {
+      PrintEmptyJavaScriptStack(&writer);
+    }
     writer.json_objectend();  // the end of 'javascriptStack'
   }
 
+  // Report V8 Heap and Garbage Collector information
+  if (isolate != nullptr && (sections & kJavaScriptHeap))
+    PrintGCStatistics(&writer, isolate);
+
   // Report native stack backtrace
-  PrintNativeStack(&writer);
+  if (sections & kNativeStack) PrintNativeStack(&writer);
 
   // Report OS and current thread resource usage
-  PrintResourceUsage(&writer);
+  if (sections & kResourceUsage) PrintResourceUsage(&writer);
 
-  writer.json_arraystart("libuv");
-  if (env != nullptr) {
-    uv_walk(env->event_loop(), WalkHandle, static_cast<void*>(&writer));
+  // Report large page usage of the V8 heap and ArrayBuffers, if enabled
+  if (sections & kLargePages) PrintLargePages(&writer);
 
-    writer.json_start();
-    writer.json_keyvalue("type", "loop");
-    writer.json_keyvalue("is_active",
-        static_cast<bool>(uv_loop_alive(env->event_loop())));
-    writer.json_keyvalue("address",
-        ValueToHexString(reinterpret_cast<int64_t>(env->event_loop())));
+  if (sections & kLibuv) {
+    writer.json_arraystart("libuv");
+    if (env != nullptr) {
+      uv_walk(env->event_loop(), WalkHandle, static_cast<void*>(&writer));
+
+      writer.json_start();
+      writer.json_keyvalue("type", "loop");
+      writer.json_keyvalue("is_active",
+          static_cast<bool>(uv_loop_alive(env->event_loop())));
+      writer.json_keyvalue("address",
+          ValueToHexString(reinterpret_cast<int64_t>(env->event_loop())));
+
+      // Report Event loop idle time
+      uint64_t idle_time = uv_metrics_idle_time(env->event_loop());
+      writer.json_keyvalue("loopIdleTimeSeconds", 1.0 * idle_time / 1e9);
+      writer.json_end();
+    }
 
-    // Report Event loop idle time
-    uint64_t idle_time = uv_metrics_idle_time(env->event_loop());
-    writer.json_keyvalue("loopIdleTimeSeconds", 1.0 * idle_time / 1e9);
-    writer.json_end();
+    writer.json_arrayend();
   }
 
-  writer.json_arrayend();
-
-  writer.json_arraystart("workers");
-  if (env != nullptr) {
-    Mutex workers_mutex;
-    ConditionVariable notify;
-    std::vector<std::string> worker_infos;
-    size_t expected_results = 0;
-
-    env->ForEachWorker([&](Worker* w) {
-      expected_results += w->RequestInterrupt([&](Environment* env) {
-        std::ostringstream os;
-
-        GetNodeReport(
-            env, "Worker thread subreport", trigger, Local<Value>(), os);
-
-        Mutex::ScopedLock lock(workers_mutex);
-        worker_infos.emplace_back(os.str());
-        notify.Signal(lock);
+  if (sections & kWorkers) {
+    writer.json_arraystart("workers");
+    if (env != nullptr) {
+      Mutex workers_mutex;
+      ConditionVariable notify;
+      std::vector<std::string> worker_infos;
+      size_t expected_results = 0;
+
+      env->ForEachWorker([&](Worker* w) {
+        expected_results += w->RequestInterrupt([&](Environment* env) {
+          std::ostringstream os;
+
+          GetNodeReport(
+              env, "Worker thread subreport", trigger, Local<Value>(), os);
+
+          Mutex::ScopedLock lock(workers_mutex);
+          worker_infos.emplace_back(os.str());
+          notify.Signal(lock);
+        });
       });
-    });
 
-    Mutex::ScopedLock lock(workers_mutex);
-    worker_infos.reserve(expected_results);
-    while (worker_infos.size() < expected_results)
-      notify.Wait(lock);
-    for (const std::string& worker_info : worker_infos)
-      writer.json_element(JSONWriter::ForeignJSON { worker_info });
+      Mutex::ScopedLock lock(workers_mutex);
+      worker_infos.reserve(expected_results);
+      while (worker_infos.size() < expected_results)
+        notify.Wait(lock);
+      for (const std::string& worker_info : worker_infos)
+        writer.json_element(JSONWriter::ForeignJSON { worker_info });
+    }
+    writer.json_arrayend();
   }
-  writer.json_arrayend();
 
   // Report operating system information
-  PrintSystemInformation(&writer);
+  if (system_thread_started) {
+    CHECK_EQ(uv_thread_join(&system_thread), 0);
+    writer.json_fragment(system_out.str());
+  } else {
+    PrintSystemInformation(&writer, system_sections);
+  }
 
   writer.json_objectend();
 
@@ -695,78 +790,99 @@ static void PrintResourceUsage(JSONWriter* writer) {
 #endif  // RUSAGE_THREAD
 }
 
+static void PrintLargePages(JSONWriter* writer) {
+  large_pages::HeapStats stats = large_pages::GetHeapStats();
+  if (stats.mode == large_pages::HeapMode::kOff) return;
+
+  writer->json_objectstart("largePages");
+  writer->json_keyvalue(
+      "mode", stats.mode == large_pages::HeapMode::kExplicit ? "explicit"
+                                                             : "madvise");
+  writer->json_keyvalue("explicitBytes", stats.explicit_bytes);
+  writer->json_keyvalue("advisedBytes", stats.advised_bytes);
+  writer->json_keyvalue("explicitFallbacks", stats.explicit_fallbacks);
+  writer->json_keyvalue("heapAdvisedBytes", stats.heap_advised_bytes);
+  if (stats.transparent_bytes >= 0)
+    writer->json_keyvalue("transparentBytes", stats.transparent_bytes);
+  writer->json_objectend();
+}
+
 // Report operating system information.
-static void PrintSystemInformation(JSONWriter* writer) {
-  uv_env_item_t* envitems;
-  int envcount;
-  int r;
+static void PrintSystemInformation(JSONWriter* writer, uint32_t sections) {
+  if (sections & kEnvironmentVariables) {
+    uv_env_item_t* envitems;
+    int envcount;
+    int r;
 
-  writer->json_objectstart("environmentVariables");
+    writer->json_objectstart("environmentVariables");
 
-  {
-    Mutex::ScopedLock lock(per_process::env_var_mutex);
-    r = uv_os_environ(&envitems, &envcount);
-  }
+    {
+      Mutex::ScopedLock lock(per_process::env_var_mutex);
+      r = uv_os_environ(&envitems, &envcount);
+    }
 
-  if (r == 0) {
-    for (int i = 0; i < envcount; i++)
-      writer->json_keyvalue(envitems[i].name, envitems[i].value);
+    if (r == 0) {
+      for (int i = 0; i < envcount; i++)
+        writer->json_keyvalue(envitems[i].name, envitems[i].value);
 
-    uv_os_free_environ(envitems, envcount);
-  }
+      uv_os_free_environ(envitems, envcount);
+    }
 
-  writer->json_objectend();
+    writer->json_objectend();
+  }
 
 #ifndef _WIN32
-  static struct {
-    const char* description;
-    int id;
-  } rlimit_strings[] = {
-    {"core_file_size_blocks", RLIMIT_CORE},
-    {"data_seg_size_kbytes", RLIMIT_DATA},
-    {"file_size_blocks", RLIMIT_FSIZE},
+  if (sections & kUserLimits) {
+    static struct {
+      const char* description;
+      int id;
+    } rlimit_strings[] = {
+      {"core_file_size_blocks", RLIMIT_CORE},
+      {"data_seg_size_kbytes", RLIMIT_DATA},
+      {"file_size_blocks", RLIMIT_FSIZE},
 #if !(defined(_AIX) || defined(__sun))
-    {"max_locked_memory_bytes", RLIMIT_MEMLOCK},
+      {"max_locked_memory_bytes", RLIMIT_MEMLOCK},
 #endif
 #ifndef __sun
-    {"max_memory_size_kbytes", RLIMIT_RSS},
+      {"max_memory_size_kbytes", RLIMIT_RSS},
 #endif
-    {"open_files", RLIMIT_NOFILE},
-    {"stack_size_bytes", RLIMIT_STACK},
-    {"cpu_time_seconds", RLIMIT_CPU},
+      {"open_files", RLIMIT_NOFILE},
+      {"stack_size_bytes", RLIMIT_STACK},
+      {"cpu_time_seconds", RLIMIT_CPU},
 #ifndef __sun
-    {"max_user_processes", RLIMIT_NPROC},
+      {"max_user_processes", RLIMIT_NPROC},
 #endif
 #ifndef __OpenBSD__
-    {"virtual_memory_kbytes", RLIMIT_AS}
+      {"virtual_memory_kbytes", RLIMIT_AS}
 #endif
-  };
+    };
 
-  writer->json_objectstart("userLimits");
-  struct rlimit limit;
-  std::string soft, hard;
+    writer->json_objectstart("userLimits");
+    struct rlimit limit;
+    std::string soft, hard;
 
-  for (size_t i = 0; i < arraysize(rlimit_strings); i++) {
-    if (getrlimit(rlimit_strings[i].id, &limit) == 0) {
-      writer->json_objectstart(rlimit_strings[i].description);
+    for (size_t i = 0; i < arraysize(rlimit_strings); i++) {
+      if (getrlimit(rlimit_strings[i].id, &limit) == 0) {
+        writer->json_objectstart(rlimit_strings[i].description);
 
-      if (limit.rlim_cur == RLIM_INFINITY)
-        writer->json_keyvalue("soft", "unlimited");
-      else
-        writer->json_keyvalue("soft", limit.rlim_cur);
+        if (limit.rlim_cur == RLIM_INFINITY)
+          writer->json_keyvalue("soft", "unlimited");
+        else
+          writer->json_keyvalue("soft", limit.rlim_cur);
 
-      if (limit.rlim_max == RLIM_INFINITY)
-        writer->json_keyvalue("hard", "unlimited");
-      else
-        writer->json_keyvalue("hard", limit.rlim_max);
+        if (limit.rlim_max == RLIM_INFINITY)
+          writer->json_keyvalue("hard", "unlimited");
+        else
+          writer->json_keyvalue("hard", limit.rlim_max);
 
-      writer->json_objectend();
+        writer->json_objectend();
+      }
     }
+    writer->json_objectend();
   }
-  writer->json_objectend();
 #endif  // _WIN32
 
-  PrintLoadedLibraries(writer);
+  if (sections & kSharedObjects) PrintLoadedLibraries(writer);
 }
 
 // Report a list of loaded native libraries.
@@ -837,6 +953,10 @@ std::string TriggerNodeReport(Isolate* isolate,
                               const char* trigger,
                               const std::string& name,
                               Local<Value> error) {
+  // Get the records that led up to the report out of the log sinks first,
+  // in case the process is about to go down.
+  log_sink::LogSink::FlushAll();
+
   std::string filename;
 
   // Determine the required report filename. In order of priority:
@@ -927,7 +1047,8 @@ std::string TriggerNodeReport(Isolate* isolate,
                           *outstream,
                           error,
                           compact,
-                          exclude_network);
+                          exclude_network,
+                          report::GetSections(env));
 
   // Do not close stdout/stderr, only close files we opened.
   if (outfile.is_open()) {
@@ -978,11 +1099,24 @@ void GetNodeReport(Isolate* isolate,
   if (isolate != nullptr) {
     env = Environment::GetCurrent(isolate);
   }
+  bool compact;
+  {
+    Mutex::ScopedLock lock(per_process::cli_options_mutex);
+    compact = per_process::cli_options->report_compact;
+  }
   bool exclude_network = env != nullptr ? env->options()->report_exclude_network
                                         : per_process::cli_options->per_isolate
                                               ->per_env->report_exclude_network;
-  report::WriteNodeReport(
-      isolate, env, message, trigger, "", out, error, false, exclude_network);
+  report::WriteNodeReport(isolate,
+                          env,
+                          message,
+                          trigger,
+                          "",
+                          out,
+                          error,
+                          compact,
+                          exclude_network,
+                          report::GetSections(env));
 }
 
 // External function to trigger a report, writing to a supplied stream.
@@ -995,11 +1129,24 @@ void GetNodeReport(Environment* env,
   if (env != nullptr) {
     isolate = env->isolate();
   }
+  bool compact;
+  {
+    Mutex::ScopedLock lock(per_process::cli_options_mutex);
+    compact = per_process::cli_options->report_compact;
+  }
   bool exclude_network = env != nullptr ? env->options()->report_exclude_network
                                         : per_process::cli_options->per_isolate
                                               ->per_env->report_exclude_network;
-  report::WriteNodeReport(
-      isolate, env, message, trigger, "", out, error, false, exclude_network);
+  report::WriteNodeReport(isolate,
+                          env,
+                          message,
+                          trigger,
+                          "",
+                          out,
+                          error,
+                          compact,
+                          exclude_network,
+                          report::GetSections(env));
 }
 
 }  // namespace node
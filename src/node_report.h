@@ -15,9 +15,30 @@
 
 #include <iomanip>
 #include <sstream>
+#include <string_view>
 
 namespace node {
 namespace report {
+// The sections of a report that can be left out of it with
+// --report-sections. The header is always included.
+enum ReportSection : uint32_t {
+  kJavaScriptStack = 1 << 0,
+  kJavaScriptHeap = 1 << 1,
+  kNativeStack = 1 << 2,
+  kResourceUsage = 1 << 3,
+  kLargePages = 1 << 4,
+  kLibuv = 1 << 5,
+  kWorkers = 1 << 6,
+  kEnvironmentVariables = 1 << 7,
+  kUserLimits = 1 << 8,
+  kSharedObjects = 1 << 9,
+  kAllSections = (1 << 10) - 1,
+};
+
+// Parses a comma-separated list of the names that the sections have in the
+// report, such as "javascriptStack,libuv". An empty list selects everything.
+bool ParseSections(std::string_view list, uint32_t* sections);
+
 // Function declarations - utility functions in src/node_report_utils.cc
 void WalkHandle(uv_handle_t* h, void* arg);
 
@@ -95,6 +95,26 @@ static void SetExcludeNetwork(const FunctionCallbackInfo<Value>& info) {
   env->options()->report_exclude_network = info[0]->IsTrue();
 }
 
+static void GetSections(const FunctionCallbackInfo<Value>& info) {
+  Environment* env = Environment::GetCurrent(info);
+  const std::string& sections = env->options()->report_sections;
+  info.GetReturnValue().Set(
+      String::NewFromUtf8(env->isolate(), sections.c_str()).ToLocalChecked());
+}
+
+// Returns false, and changes nothing, if the list is not valid.
+static void SetSections(const FunctionCallbackInfo<Value>& info) {
+  Environment* env = Environment::GetCurrent(info);
+  CHECK(info[0]->IsString());
+  Utf8Value sections(env->isolate(), info[0].As<String>());
+  uint32_t mask;
+  if (!ParseSections(sections.ToStringView(), &mask)) {
+    return info.GetReturnValue().Set(false);
+  }
+  env->options()->report_sections = *sections;
+  info.GetReturnValue().Set(true);
+}
+
 static void GetDirectory(const FunctionCallbackInfo<Value>& info) {
   Mutex::ScopedLock lock(per_process::cli_options_mutex);
   Environment* env = Environment::GetCurrent(info);
@@ -187,6 +207,8 @@ static void Initialize(Local<Object> exports,
   SetMethod(context, exports, "setCompact", SetCompact);
   SetMethod(context, exports, "getExcludeNetwork", GetExcludeNetwork);
   SetMethod(context, exports, "setExcludeNetwork", SetExcludeNetwork);
+  SetMethod(context, exports, "getSections", GetSections);
+  SetMethod(context, exports, "setSections", SetSections);
   SetMethod(context, exports, "getDirectory", GetDirectory);
   SetMethod(context, exports, "setDirectory", SetDirectory);
   SetMethod(context, exports, "getFilename", GetFilename);
@@ -215,6 +237,8 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(SetCompact);
   registry->Register(GetExcludeNetwork);
   registry->Register(SetExcludeNetwork);
+  registry->Register(GetSections);
+  registry->Register(SetSections);
   registry->Register(GetDirectory);
   registry->Register(SetDirectory);
   registry->Register(GetFilename);
@@ -10,6 +10,7 @@
 #include "node_internals.h"
 #include "node_snapshot_builder.h"
 #include "node_union_bytes.h"
+#include "node_url.h"
 #include "node_v8_platform-inl.h"
 #include "util-inl.h"
 
@@ -22,6 +23,10 @@
 #include "postject-api.h"
 #undef POSTJECT_SENTINEL_FUSE
 
+#include "simdjson.h"
+
+#include <algorithm>
+#include <filesystem>
 #include <memory>
 #include <string_view>
 #include <tuple>
@@ -31,14 +36,18 @@ using node::ExitCode;
 using v8::ArrayBuffer;
 using v8::BackingStore;
 using v8::Context;
+using v8::Data;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Isolate;
 using v8::Local;
+using v8::MaybeLocal;
+using v8::Module;
 using v8::NewStringType;
 using v8::Object;
 using v8::ScriptCompiler;
+using v8::ScriptOrigin;
 using v8::String;
 using v8::Value;
 
@@ -120,6 +129,20 @@ size_t SeaSerializer::Write(const SeaResource& sea) {
       written_total += WriteStringView(content, StringLogMode::kAddressOnly);
     }
   }
+
+  if (!sea.asset_code_caches.empty()) {
+    Debug("Write SEA resource asset code caches size %zu\n",
+          sea.asset_code_caches.size());
+    written_total += WriteArithmetic<size_t>(sea.asset_code_caches.size());
+    for (auto const& [key, code_cache] : sea.asset_code_caches) {
+      Debug("Write SEA resource asset code cache %s at %p, size=%zu\n",
+            key,
+            code_cache.data(),
+            code_cache.size());
+      written_total += WriteStringView(key, StringLogMode::kAddressAndContent);
+      written_total += WriteStringView(code_cache, StringLogMode::kAddressOnly);
+    }
+  }
   return written_total;
 }
 
@@ -182,7 +205,22 @@ SeaResource SeaDeserializer::Read() {
       assets.emplace(key, content);
     }
   }
-  return {flags, code_path, code, code_cache, assets};
+
+  std::unordered_map<std::string_view, std::string_view> asset_code_caches;
+  if (static_cast<bool>(flags & SeaFlags::kIncludeAssetCodeCaches)) {
+    size_t code_caches_size = ReadArithmetic<size_t>();
+    Debug("Read SEA resource asset code caches size %zu\n", code_caches_size);
+    for (size_t i = 0; i < code_caches_size; ++i) {
+      std::string_view key = ReadStringView(StringLogMode::kAddressAndContent);
+      std::string_view code_cache = ReadStringView(StringLogMode::kAddressOnly);
+      Debug("Read SEA resource asset code cache %s at %p, size=%zu\n",
+            key,
+            code_cache.data(),
+            code_cache.size());
+      asset_code_caches.emplace(key, code_cache);
+    }
+  }
+  return {flags, code_path, code, code_cache, assets, asset_code_caches};
 }
 
 std::string_view FindSingleExecutableBlob() {
@@ -214,6 +252,34 @@ std::string_view FindSingleExecutableBlob() {
 
 }  // anonymous namespace
 
+std::vector<int> GetFunctionPositions(
+    std::string_view source, const std::vector<std::pair<int, int>>& lines) {
+  std::vector<int> line_starts = {0};
+  int offset = 0;
+  for (size_t i = 0; i < source.size(); i++) {
+    const uint8_t c = source[i];
+    // Skip continuation bytes, code points beyond the BMP take two units.
+    if ((c & 0xc0) == 0x80) continue;
+    offset += c >= 0xf0 ? 2 : 1;
+    // JavaScript line terminators are LF, CR, CRLF, U+2028 and U+2029.
+    if (c == '\n' || (c == '\r' && source.substr(i + 1, 1) != "\n") ||
+        source.substr(i, 3) == "\xE2\x80\xA8" ||
+        source.substr(i, 3) == "\xE2\x80\xA9") {
+      line_starts.push_back(offset);
+    }
+  }
+
+  std::vector<int> positions;
+  for (const auto& [line, column] : lines) {
+    if (static_cast<size_t>(line) < line_starts.size())
+      positions.push_back(line_starts[line] + column);
+  }
+  std::sort(positions.begin(), positions.end());
+  positions.erase(std::unique(positions.begin(), positions.end()),
+                  positions.end());
+  return positions;
+}
+
 bool SeaResource::use_snapshot() const {
   return static_cast<bool>(flags & SeaFlags::kUseSnapshot);
 }
@@ -303,6 +369,7 @@ struct SeaConfig {
   std::string output_path;
   SeaFlags flags = SeaFlags::kDefault;
   std::unordered_map<std::string, std::string> assets;
+  std::string startup_profile_path;
 };
 
 std::optional<SeaConfig> ParseSingleExecutableConfig(
@@ -376,6 +443,15 @@ std::optional<SeaConfig> ParseSingleExecutableConfig(
     result.flags |= SeaFlags::kUseCodeCache;
   }
 
+  result.startup_profile_path =
+      parser.GetTopLevelStringField("startupProfile").value_or(std::string());
+  if (!result.startup_profile_path.empty() && !use_code_cache.value()) {
+    FPrintF(stderr,
+            "\"startupProfile\" field of %s requires \"useCodeCache\"\n",
+            config_path);
+    return std::nullopt;
+  }
+
   auto assets_opt = parser.GetTopLevelStringDict("assets");
   if (!assets_opt.has_value()) {
     FPrintF(stderr,
@@ -429,36 +505,129 @@ ExitCode GenerateSnapshotForSEA(const SeaConfig& config,
   return ExitCode::kNoFailure;
 }
 
-std::optional<std::string> GenerateCodeCache(std::string_view main_path,
-                                             std::string_view main_script) {
-  RAIIIsolate raii_isolate(SnapshotBuilder::GetEmbeddedSnapshotData());
-  Isolate* isolate = raii_isolate.get();
+// A script for which code cache is generated.
+struct CachedScript {
+  std::string_view path;
+  std::string_view source;
+  bool is_module;
+  // Source positions of the functions that ran during startup, according to
+  // the startup profile. These are compiled eagerly, so that their code ends
+  // up in the code cache.
+  std::vector<int> hot_functions;
+  std::optional<std::string> code_cache;
+};
 
-  v8::Isolate::Scope isolate_scope(isolate);
-  HandleScope handle_scope(isolate);
+bool IsHotFunction(int position, void* data) {
+  const std::vector<int>* hot_functions =
+      static_cast<const std::vector<int>*>(data);
+  return std::binary_search(
+      hot_functions->begin(), hot_functions->end(), position);
+}
 
-  Local<Context> context = Context::New(isolate);
-  Context::Scope context_scope(context);
+// The (line, column) pairs of the functions that ran, by script URL.
+using StartupProfile =
+    std::unordered_map<std::string, std::vector<std::pair<int, int>>>;
 
-  errors::PrinterTryCatch bootstrapCatch(
-      isolate, errors::PrinterTryCatch::kPrintSourceLine);
+// Reads a CPU profile, e.g. one written by --cpu-prof.
+std::optional<StartupProfile> ReadStartupProfile(
+    const std::string& profile_path) {
+  std::string contents;
+  int r = ReadFileSync(&contents, profile_path.c_str());
+  if (r != 0) {
+    const char* err = uv_strerror(r);
+    FPrintF(stderr, "Cannot read startup profile %s: %s\n", profile_path, err);
+    return std::nullopt;
+  }
 
-  Local<String> filename;
-  if (!String::NewFromUtf8(isolate,
-                           main_path.data(),
-                           NewStringType::kNormal,
-                           main_path.length())
-           .ToLocal(&filename)) {
+  StartupProfile functions;
+  simdjson::ondemand::parser parser;
+  simdjson::ondemand::document document;
+  simdjson::ondemand::array nodes;
+  if (parser.iterate(contents).get(document) ||
+      document["nodes"].get_array().get(nodes)) {
+    FPrintF(stderr, "Cannot parse startup profile %s\n", profile_path);
     return std::nullopt;
   }
+  for (auto node : nodes) {
+    simdjson::ondemand::object call_frame;
+    std::string_view url;
+    int64_t line;
+    int64_t column;
+    if (node["callFrame"].get_object().get(call_frame) ||
+        call_frame["url"].get_string().get(url) ||
+        call_frame["lineNumber"].get_int64().get(line) ||
+        call_frame["columnNumber"].get_int64().get(column)) {
+      FPrintF(stderr, "Cannot parse startup profile %s\n", profile_path);
+      return std::nullopt;
+    }
+    // Native and internal frames have no position.
+    if (url.empty() || line < 0 || column < 0) continue;
+    functions[std::string(url)].emplace_back(static_cast<int>(line),
+                                             static_cast<int>(column));
+  }
+  return functions;
+}
+
+// Finds the functions of `path` in the startup profile. Profiles name
+// scripts by their absolute paths or file: URLs.
+std::vector<int> GetHotFunctions(const StartupProfile& profile,
+                                 const std::string& path,
+                                 std::string_view source) {
+  std::error_code error;
+  const std::string absolute_path =
+      std::filesystem::absolute(path, error).lexically_normal().string();
+  std::vector<std::pair<int, int>> lines;
+  for (const std::string& url :
+       {path, absolute_path, url::FromFilePath(absolute_path)}) {
+    auto it = profile.find(url);
+    if (it != profile.end()) {
+      lines.insert(lines.end(), it->second.begin(), it->second.end());
+    }
+  }
+  return GetFunctionPositions(source, lines);
+}
 
+MaybeLocal<Data> CompileForCodeCache(Local<Context> context,
+                                     CachedScript* script) {
+  Isolate* isolate = context->GetIsolate();
+  Local<String> filename;
   Local<String> content;
   if (!String::NewFromUtf8(isolate,
-                           main_script.data(),
+                           script->path.data(),
+                           NewStringType::kNormal,
+                           script->path.length())
+           .ToLocal(&filename) ||
+      !String::NewFromUtf8(isolate,
+                           script->source.data(),
                            NewStringType::kNormal,
-                           main_script.length())
+                           script->source.length())
            .ToLocal(&content)) {
-    return std::nullopt;
+    return MaybeLocal<Data>();
+  }
+
+  if (script->is_module) {
+    ScriptOrigin origin(filename,
+                        0,               // line offset
+                        0,               // column offset
+                        true,            // is cross origin
+                        -1,              // script id
+                        Local<Value>(),  // source map URL
+                        false,           // is opaque
+                        false,           // is WASM
+                        true);           // is ES Module
+    ScriptCompiler::Source source(
+        content, origin, IsHotFunction, &script->hot_functions);
+    Local<Module> module;
+    if (!ScriptCompiler::CompileModule(
+             isolate,
+             &source,
+             script->hot_functions.empty()
+                 ? ScriptCompiler::kNoCompileOptions
+                 : ScriptCompiler::kConsumeCompileHints)
+             .ToLocal(&module)) {
+      return MaybeLocal<Data>();
+    }
+    return module->GetUnboundModuleScript();
   }
 
   std::vector<Local<String>> parameters = {
@@ -468,20 +637,69 @@ std::optional<std::string> GenerateCodeCache(std::string_view main_path,
       FIXED_ONE_BYTE_STRING(isolate, "__filename"),
       FIXED_ONE_BYTE_STRING(isolate, "__dirname"),
   };
+  // V8 only takes compile hints for scripts and modules, so CommonJS modules
+  // that ran during startup are compiled eagerly as a whole.
+  ScriptOrigin origin(filename, 0, 0, true);
+  ScriptCompiler::Source source(content, origin);
+  Local<Function> fn;
+  if (!ScriptCompiler::CompileFunction(
+           context,
+           &source,
+           parameters.size(),
+           parameters.data(),
+           0,
+           nullptr,
+           script->hot_functions.empty() ? ScriptCompiler::kNoCompileOptions
+                                         : ScriptCompiler::kEagerCompile)
+           .ToLocal(&fn)) {
+    return MaybeLocal<Data>();
+  }
+  return fn;
+}
+
+// Generates code cache for `main` and `assets`. Failing to compile the main
+// script is an error, assets that do not compile are left without code
+// cache.
+bool GenerateCodeCache(CachedScript* main, std::vector<CachedScript>* assets) {
+  RAIIIsolate raii_isolate(SnapshotBuilder::GetEmbeddedSnapshotData());
+  Isolate* isolate = raii_isolate.get();
+
+  v8::Isolate::Scope isolate_scope(isolate);
+  HandleScope handle_scope(isolate);
+
+  Local<Context> context = Context::New(isolate);
+  Context::Scope context_scope(context);
+
+  errors::PrinterTryCatch bootstrapCatch(
+      isolate, errors::PrinterTryCatch::kPrintSourceLine);
 
   // TODO(RaisinTen): Using the V8 code cache prevents us from using `import()`
   // in the SEA code. Support it.
   // Refs: https://github.com/nodejs/node/pull/48191#discussion_r1213271430
-  Local<Function> fn;
-  if (!contextify::CompileFunction(context, filename, content, &parameters)
-           .ToLocal(&fn)) {
-    return std::nullopt;
+  Local<Data> compiled;
+  if (!CompileForCodeCache(context, main).ToLocal(&compiled)) {
+    return false;
   }
-
   std::unique_ptr<ScriptCompiler::CachedData> cache{
-      ScriptCompiler::CreateCodeCacheForFunction(fn)};
-  std::string code_cache(cache->data, cache->data + cache->length);
-  return code_cache;
+      ScriptCompiler::CreateCodeCacheForFunction(compiled.As<Function>())};
+  main->code_cache.emplace(cache->data, cache->data + cache->length);
+
+  for (CachedScript& asset : *assets) {
+    HandleScope asset_scope(isolate);
+    v8::TryCatch try_catch(isolate);
+    if (!CompileForCodeCache(context, &asset).ToLocal(&compiled)) {
+      continue;
+    }
+    if (asset.is_module) {
+      cache.reset(ScriptCompiler::CreateCodeCache(
+          compiled.As<v8::UnboundModuleScript>()));
+    } else {
+      cache.reset(
+          ScriptCompiler::CreateCodeCacheForFunction(compiled.As<Function>()));
+    }
+    asset.code_cache.emplace(cache->data, cache->data + cache->length);
+  }
+  return true;
 }
 
 int BuildAssets(const std::unordered_map<std::string, std::string>& config,
@@ -526,40 +744,76 @@ ExitCode GenerateSingleExecutableBlob(
     }
   }
 
+  std::unordered_map<std::string, std::string> assets;
+  if (!config.assets.empty() && BuildAssets(config.assets, &assets) != 0) {
+    return ExitCode::kGenericUserError;
+  }
+  std::unordered_map<std::string_view, std::string_view> assets_view;
+  for (auto const& [key, content] : assets) {
+    assets_view.emplace(key, content);
+  }
+
+  SeaFlags flags = config.flags;
   std::optional<std::string_view> optional_sv_code_cache;
-  std::string code_cache;
-  if (static_cast<bool>(config.flags & SeaFlags::kUseCodeCache)) {
+  CachedScript main{config.main_path, main_script, false, {}, std::nullopt};
+  // The assets that are scripts get code cache, too.
+  std::vector<std::string_view> script_asset_keys;
+  std::vector<CachedScript> script_assets;
+  if (static_cast<bool>(flags & SeaFlags::kUseCodeCache)) {
     if (builds_snapshot_from_main) {
       FPrintF(stderr,
               "\"useCodeCache\" is redundant when \"useSnapshot\" is true\n");
     } else {
-      std::optional<std::string> optional_code_cache =
-          GenerateCodeCache(config.main_path, main_script);
-      if (!optional_code_cache.has_value()) {
+      for (auto const& [key, path] : config.assets) {
+        const bool is_module = path.ends_with(".mjs");
+        if (!is_module && !path.ends_with(".js") && !path.ends_with(".cjs"))
+          continue;
+        script_asset_keys.push_back(key);
+        script_assets.push_back(
+            {path, assets_view[key], is_module, {}, std::nullopt});
+      }
+
+      if (!config.startup_profile_path.empty()) {
+        auto profile = ReadStartupProfile(config.startup_profile_path);
+        if (!profile.has_value()) {
+          return ExitCode::kGenericUserError;
+        }
+        main.hot_functions =
+            GetHotFunctions(*profile, config.main_path, main_script);
+        for (CachedScript& asset : script_assets) {
+          asset.hot_functions = GetHotFunctions(
+              *profile, std::string(asset.path), asset.source);
+        }
+      }
+
+      if (!GenerateCodeCache(&main, &script_assets)) {
         FPrintF(stderr, "Cannot generate V8 code cache\n");
         return ExitCode::kGenericUserError;
       }
-      code_cache = optional_code_cache.value();
-      optional_sv_code_cache = code_cache;
+      optional_sv_code_cache = *main.code_cache;
     }
   }
 
-  std::unordered_map<std::string, std::string> assets;
-  if (!config.assets.empty() && BuildAssets(config.assets, &assets) != 0) {
-    return ExitCode::kGenericUserError;
+  std::unordered_map<std::string_view, std::string_view> asset_code_caches;
+  for (size_t i = 0; i < script_assets.size(); i++) {
+    if (script_assets[i].code_cache.has_value()) {
+      asset_code_caches.emplace(script_asset_keys[i],
+                                *script_assets[i].code_cache);
+    }
   }
-  std::unordered_map<std::string_view, std::string_view> assets_view;
-  for (auto const& [key, content] : assets) {
-    assets_view.emplace(key, content);
+  if (!asset_code_caches.empty()) {
+    flags |= SeaFlags::kIncludeAssetCodeCaches;
   }
+
   SeaResource sea{
-      config.flags,
+      flags,
       config.main_path,
       builds_snapshot_from_main
           ? std::string_view{snapshot_blob.data(), snapshot_blob.size()}
           : std::string_view{main_script.data(), main_script.size()},
       optional_sv_code_cache,
-      assets_view};
+      assets_view,
+      asset_code_caches};
 
   SeaSerializer serializer;
   serializer.Write(sea);
@@ -617,6 +871,25 @@ void GetAsset(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(ab);
 }
 
+void GetAssetCodeCache(const FunctionCallbackInfo<Value>& args) {
+  CHECK_EQ(args.Length(), 1);
+  CHECK(args[0]->IsString());
+  Utf8Value key(args.GetIsolate(), args[0]);
+  SeaResource sea_resource = FindSingleExecutableResource();
+  auto it = sea_resource.asset_code_caches.find(*key);
+  if (it == sea_resource.asset_code_caches.end()) {
+    return;
+  }
+  // Like the assets, code cache is handed out without a copy.
+  std::unique_ptr<v8::BackingStore> store = ArrayBuffer::NewBackingStore(
+      const_cast<char*>(it->second.data()),
+      it->second.size(),
+      [](void*, size_t, void*) {},
+      nullptr);
+  Local<ArrayBuffer> ab = ArrayBuffer::New(args.GetIsolate(), std::move(store));
+  args.GetReturnValue().Set(ab);
+}
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context,
@@ -628,6 +901,7 @@ void Initialize(Local<Object> target,
             IsExperimentalSeaWarningNeeded);
   SetMethod(context, target, "getCodePath", GetCodePath);
   SetMethod(context, target, "getAsset", GetAsset);
+  SetMethod(context, target, "getAssetCodeCache", GetAssetCodeCache);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
@@ -635,6 +909,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(IsExperimentalSeaWarningNeeded);
   registry->Register(GetCodePath);
   registry->Register(GetAsset);
+  registry->Register(GetAssetCodeCache);
 }
 
 }  // namespace sea
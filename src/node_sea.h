@@ -9,6 +9,7 @@
 #include <string_view>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "node_exit_code.h"
@@ -27,6 +28,7 @@ enum class SeaFlags : uint32_t {
   kUseSnapshot = 1 << 1,
   kUseCodeCache = 1 << 2,
   kIncludeAssets = 1 << 3,
+  kIncludeAssetCodeCaches = 1 << 4,
 };
 
 struct SeaResource {
@@ -35,6 +37,8 @@ struct SeaResource {
   std::string_view main_code_or_snapshot;
   std::optional<std::string_view> code_cache;
   std::unordered_map<std::string_view, std::string_view> assets;
+  // Code cache for the assets that are scripts, by asset key.
+  std::unordered_map<std::string_view, std::string_view> asset_code_caches;
 
   bool use_snapshot() const;
   bool use_code_cache() const;
@@ -44,6 +48,11 @@ struct SeaResource {
 
 bool IsSingleExecutable();
 SeaResource FindSingleExecutableResource();
+// Maps the (line, column) pairs of the functions in `source`, e.g. from a
+// CPU profile, to the source positions that V8 uses, i.e. offsets in UTF-16
+// code units. The result is sorted and has no duplicates.
+std::vector<int> GetFunctionPositions(
+    std::string_view source, const std::vector<std::pair<int, int>>& lines);
 std::tuple<int, char**> FixupArgsForSEA(int argc, char** argv);
 node::ExitCode BuildSingleExecutableBlob(
     const std::string& config_path,
@@ -5,14 +5,27 @@
 #include "node_internals.h"
 #include "util-inl.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 namespace node {
 
 using v8::Array;
 using v8::ArrayBuffer;
+using v8::ArrayBufferView;
+using v8::BackingStore;
+using v8::BigInt64Array;
+using v8::BigUint64Array;
 using v8::Context;
+using v8::DataView;
+using v8::Float32Array;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Int16Array;
+using v8::Int32Array;
+using v8::Int8Array;
 using v8::Integer;
 using v8::Isolate;
 using v8::Just;
@@ -23,12 +36,41 @@ using v8::Nothing;
 using v8::Object;
 using v8::SharedArrayBuffer;
 using v8::String;
+using v8::Uint16Array;
+using v8::Uint32Array;
+using v8::Uint8Array;
+using v8::Uint8ClampedArray;
 using v8::Value;
 using v8::ValueDeserializer;
 using v8::ValueSerializer;
 
 namespace serdes {
 
+// The ArrayBufferView types that the default (de)serializer handles as host
+// objects, with their element sizes, in the order of arrayBufferViewTypes in
+// lib/v8.js. Host objects are written as the index of their type, followed
+// by their byte length and their bytes, and Buffers come last.
+#define ARRAY_BUFFER_VIEW_TYPES(V)                                             \
+  V(Int8Array, 1)                                                              \
+  V(Uint8Array, 1)                                                             \
+  V(Uint8ClampedArray, 1)                                                      \
+  V(Int16Array, 2)                                                             \
+  V(Uint16Array, 2)                                                            \
+  V(Int32Array, 4)                                                             \
+  V(Uint32Array, 4)                                                            \
+  V(Float32Array, 4)                                                           \
+  V(Float64Array, 8)                                                           \
+  V(DataView, 1)                                                               \
+  V(BigInt64Array, 8)                                                          \
+  V(BigUint64Array, 8)
+
+enum ArrayBufferViewTag : uint32_t {
+#define V(type, size) k##type,
+  ARRAY_BUFFER_VIEW_TYPES(V)
+#undef V
+  kBuffer,
+};
+
 class SerializerContext : public BaseObject,
                           public ValueSerializer::Delegate {
  public:
@@ -41,9 +83,15 @@ class SerializerContext : public BaseObject,
   Maybe<bool> WriteHostObject(Isolate* isolate, Local<Object> object) override;
   Maybe<uint32_t> GetSharedArrayBufferId(
       Isolate* isolate, Local<SharedArrayBuffer> shared_array_buffer) override;
+  void* ReallocateBufferMemory(void* old_buffer,
+                               size_t size,
+                               size_t* actual_size) override;
+  void FreeBufferMemory(void* buffer) override;
 
   static void SetTreatArrayBufferViewsAsHostObjects(
       const FunctionCallbackInfo<Value>& args);
+  static void SetNativeArrayBufferViews(
+      const FunctionCallbackInfo<Value>& args);
 
   static void New(const FunctionCallbackInfo<Value>& args);
   static void WriteHeader(const FunctionCallbackInfo<Value>& args);
@@ -54,13 +102,28 @@ class SerializerContext : public BaseObject,
   static void WriteUint64(const FunctionCallbackInfo<Value>& args);
   static void WriteDouble(const FunctionCallbackInfo<Value>& args);
   static void WriteRawBytes(const FunctionCallbackInfo<Value>& args);
+  static void SerializeInto(const FunctionCallbackInfo<Value>& args);
 
   SET_NO_MEMORY_INFO()
   SET_MEMORY_INFO_NAME(SerializerContext)
   SET_SELF_SIZE(SerializerContext)
 
  private:
+  Maybe<bool> WriteArrayBufferView(Local<ArrayBufferView> view);
+
   ValueSerializer serializer_;
+  // Whether ArrayBufferViews are written here instead of by the
+  // _writeHostObject() of the JS side.
+  bool native_array_buffer_views_ = false;
+  // Whether the serializer holds a buffer that has not been released yet.
+  bool holds_buffer_ = false;
+  // The least size of the next buffer the serializer asks for.
+  size_t size_hint_ = 0;
+  // The memory serializeInto() writes to, and the backing store it is in,
+  // which is held on to in case the JS side detaches the buffer meanwhile.
+  uint8_t* output_ = nullptr;
+  size_t output_capacity_ = 0;
+  std::shared_ptr<BackingStore> output_store_;
 };
 
 class DeserializerContext : public BaseObject,
@@ -74,6 +137,9 @@ class DeserializerContext : public BaseObject,
 
   MaybeLocal<Object> ReadHostObject(Isolate* isolate) override;
 
+  static void SetNativeArrayBufferViews(
+      const FunctionCallbackInfo<Value>& args);
+
   static void New(const FunctionCallbackInfo<Value>& args);
   static void ReadHeader(const FunctionCallbackInfo<Value>& args);
   static void ReadValue(const FunctionCallbackInfo<Value>& args);
@@ -89,8 +155,15 @@ class DeserializerContext : public BaseObject,
   SET_SELF_SIZE(DeserializerContext)
 
  private:
+  MaybeLocal<Object> ReadArrayBufferView();
+
   const uint8_t* data_;
   const size_t length_;
+  // The ArrayBuffer that data_ is in, and where, for the views that
+  // ReadArrayBufferView() creates on top of it.
+  v8::Global<ArrayBuffer> array_buffer_;
+  size_t array_buffer_offset_;
+  bool native_array_buffer_views_ = false;
 
   ValueDeserializer deserializer_;
 };
@@ -144,8 +217,70 @@ Maybe<uint32_t> SerializerContext::GetSharedArrayBufferId(
   return id.ToLocalChecked()->Uint32Value(env()->context());
 }
 
+void* SerializerContext::ReallocateBufferMemory(void* old_buffer,
+                                               size_t size,
+                                               size_t* actual_size) {
+  size = std::max(size, size_hint_);
+  size_hint_ = 0;
+  if (output_ != nullptr) {
+    if (old_buffer == nullptr && size <= output_capacity_) {
+      holds_buffer_ = true;
+      *actual_size = output_capacity_;
+      return output_;
+    }
+    if (old_buffer == output_) {
+      // The value does not fit. Carry on in memory of our own, so that the
+      // caller learns how much it does need.
+      void* buffer = malloc(size);
+      if (buffer == nullptr) return nullptr;
+      memcpy(buffer, output_, output_capacity_);
+      *actual_size = size;
+      return buffer;
+    }
+  }
+  void* buffer = realloc(old_buffer, size);
+  if (buffer == nullptr) return nullptr;
+  holds_buffer_ = true;
+  *actual_size = size;
+  return buffer;
+}
+
+void SerializerContext::FreeBufferMemory(void* buffer) {
+  if (buffer != output_) free(buffer);
+}
+
+Maybe<bool> SerializerContext::WriteArrayBufferView(
+    Local<ArrayBufferView> view) {
+  uint32_t tag;
+  if (view->GetPrototype() == env()->buffer_prototype_object()) {
+    tag = kBuffer;
+#define V(type, size)                                                          \
+  } else if (view->Is##type()) {                                               \
+    tag = k##type;
+  ARRAY_BUFFER_VIEW_TYPES(V)
+#undef V
+  } else {
+    // A type that the JS side would not know how to read back either.
+    return ValueSerializer::Delegate::WriteHostObject(env()->isolate(), view);
+  }
+
+  ArrayBufferViewContents<uint8_t> bytes(view);
+  if (bytes.length() > UINT32_MAX) {
+    THROW_ERR_OUT_OF_RANGE(env(), "The ArrayBufferView is too large");
+    return Nothing<bool>();
+  }
+  serializer_.WriteUint32(tag);
+  serializer_.WriteUint32(static_cast<uint32_t>(bytes.length()));
+  serializer_.WriteRawBytes(bytes.data(), bytes.length());
+  return Just(true);
+}
+
 Maybe<bool> SerializerContext::WriteHostObject(Isolate* isolate,
                                                Local<Object> input) {
+  if (native_array_buffer_views_ && input->IsArrayBufferView()) {
+    return WriteArrayBufferView(input.As<ArrayBufferView>());
+  }
+
   MaybeLocal<Value> ret;
   Local<Value> args[1] = { input };
 
@@ -184,9 +319,29 @@ void SerializerContext::WriteHeader(const FunctionCallbackInfo<Value>& args) {
   ctx->serializer_.WriteHeader();
 }
 
+// The size that `value` takes up at the least once serialized, for growing
+// the buffer to it in one go. This only looks at the value itself, so that it
+// never costs more than the reallocations it saves.
+static size_t EstimateSerializedSize(Local<Value> value) {
+  if (value->IsString()) {
+    Local<String> string = value.As<String>();
+    return string->Length() * (string->IsOneByte() ? 1 : 2);
+  }
+  if (value->IsArrayBufferView()) {
+    return value.As<ArrayBufferView>()->ByteLength();
+  }
+  if (value->IsArrayBuffer()) {
+    return value.As<ArrayBuffer>()->ByteLength();
+  }
+  // Arrays are left out: the length of a sparse one says nothing about how
+  // much it takes up.
+  return 0;
+}
+
 void SerializerContext::WriteValue(const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+  ctx->size_hint_ = EstimateSerializedSize(args[0]);
   Maybe<bool> ret =
       ctx->serializer_.WriteValue(ctx->env()->context(), args[0]);
 
@@ -202,6 +357,15 @@ void SerializerContext::SetTreatArrayBufferViewsAsHostObjects(
   ctx->serializer_.SetTreatArrayBufferViewsAsHostObjects(value);
 }
 
+void SerializerContext::SetNativeArrayBufferViews(
+    const FunctionCallbackInfo<Value>& args) {
+  SerializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+
+  ctx->native_array_buffer_views_ =
+      args[0]->BooleanValue(ctx->env()->isolate());
+}
+
 void SerializerContext::ReleaseBuffer(const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
@@ -209,6 +373,7 @@ void SerializerContext::ReleaseBuffer(const FunctionCallbackInfo<Value>& args) {
   // Note: Both ValueSerializer and this Buffer::New() variant use malloc()
   // as the underlying allocator.
   std::pair<uint8_t*, size_t> ret = ctx->serializer_.Release();
+  ctx->holds_buffer_ = false;
   auto buf = Buffer::New(ctx->env(),
                          reinterpret_cast<char*>(ret.first),
                          ret.second);
@@ -282,6 +447,64 @@ void SerializerContext::WriteRawBytes(const FunctionCallbackInfo<Value>& args) {
   ctx->serializer_.WriteRawBytes(bytes.data(), bytes.length());
 }
 
+// serializeInto(value, buffer, offset) writes the header and `value` into
+// `buffer` at `offset`, without allocating a buffer of its own as long as
+// they fit. Like snprintf(), it returns the size they take up, and if that
+// is more than the space left in `buffer`, only what fitted was written.
+void SerializerContext::SerializeInto(const FunctionCallbackInfo<Value>& args) {
+  SerializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+  Environment* env = ctx->env();
+
+  if (!args[1]->IsArrayBufferView()) {
+    return THROW_ERR_INVALID_ARG_TYPE(
+        env, "buffer must be a TypedArray or a DataView");
+  }
+  Local<ArrayBufferView> view = args[1].As<ArrayBufferView>();
+  Maybe<int64_t> offset_arg = args[2]->IntegerValue(env->context());
+  if (offset_arg.IsNothing()) return;
+  int64_t offset = offset_arg.FromJust();
+  if (offset < 0 || static_cast<uint64_t>(offset) > view->ByteLength()) {
+    return THROW_ERR_OUT_OF_RANGE(env, "offset is out of bounds");
+  }
+  if (ctx->holds_buffer_) {
+    return THROW_ERR_INVALID_STATE(
+        env, "The serializer holds a buffer that has not been released");
+  }
+
+  Local<ArrayBuffer> ab = view->Buffer();
+  std::shared_ptr<BackingStore> store = ab->GetBackingStore();
+  if (store->IsResizableByUserJavaScript()) {
+    return THROW_ERR_INVALID_ARG_VALUE(
+        env, "buffer must not be backed by a resizable ArrayBuffer");
+  }
+  ctx->output_store_ = std::move(store);
+  ctx->output_ =
+      static_cast<uint8_t*>(ab->Data()) + view->ByteOffset() + offset;
+  ctx->output_capacity_ = view->ByteLength() - offset;
+
+  ctx->serializer_.WriteHeader();
+  Maybe<bool> ret = ctx->serializer_.WriteValue(env->context(), args[0]);
+  std::pair<uint8_t*, size_t> result = ctx->serializer_.Release();
+  // V8 asks for more than it needs right away, so a small `buffer` may not
+  // have been used at all. Whatever the serializer wrote to instead is
+  // copied over here.
+  if (ret.IsJust() && result.first != ctx->output_) {
+    memcpy(ctx->output_,
+           result.first,
+           std::min(result.second, ctx->output_capacity_));
+  }
+  ctx->FreeBufferMemory(result.first);
+  ctx->holds_buffer_ = false;
+  ctx->output_ = nullptr;
+  ctx->output_capacity_ = 0;
+  ctx->output_store_.reset();
+
+  if (ret.IsJust()) {
+    args.GetReturnValue().Set(static_cast<double>(result.second));
+  }
+}
+
 DeserializerContext::DeserializerContext(Environment* env,
                                          Local<Object> wrap,
                                          Local<Value> buffer)
@@ -290,11 +513,74 @@ DeserializerContext::DeserializerContext(Environment* env,
     length_(Buffer::Length(buffer)),
     deserializer_(env->isolate(), data_, length_, this) {
   object()->Set(env->context(), env->buffer_string(), buffer).Check();
+  Local<ArrayBufferView> view = buffer.As<ArrayBufferView>();
+  array_buffer_.Reset(env->isolate(), view->Buffer());
+  array_buffer_offset_ = view->ByteOffset();
 
   MakeWeak();
 }
 
+MaybeLocal<Object> DeserializerContext::ReadArrayBufferView() {
+  Isolate* isolate = env()->isolate();
+  uint32_t tag;
+  uint32_t byte_length;
+  const void* bytes;
+  if (!deserializer_.ReadUint32(&tag) ||
+      !deserializer_.ReadUint32(&byte_length) ||
+      !deserializer_.ReadRawBytes(byte_length, &bytes)) {
+    env()->ThrowError("Failed to read an ArrayBufferView");
+    return MaybeLocal<Object>();
+  }
+
+  size_t element_size;
+  switch (tag) {
+#define V(type, size)                                                          \
+  case k##type:                                                                \
+    element_size = size;                                                       \
+    break;
+    ARRAY_BUFFER_VIEW_TYPES(V)
+#undef V
+    case kBuffer:
+      element_size = 1;
+      break;
+    default:
+      env()->ThrowTypeError("Unknown ArrayBufferView type");
+      return MaybeLocal<Object>();
+  }
+  if (byte_length % element_size != 0) {
+    env()->ThrowRangeError("Invalid ArrayBufferView length");
+    return MaybeLocal<Object>();
+  }
+
+  // Create the view on top of the buffer being read, unless it would not be
+  // aligned there.
+  Local<ArrayBuffer> ab = array_buffer_.Get(isolate);
+  size_t offset = array_buffer_offset_ +
+                  (static_cast<const uint8_t*>(bytes) - data_);
+  if (offset % element_size != 0) {
+    ab = ArrayBuffer::New(isolate, byte_length);
+    memcpy(ab->Data(), bytes, byte_length);
+    offset = 0;
+  }
+
+  size_t length = byte_length / element_size;
+  switch (tag) {
+#define V(type, size)                                                          \
+  case k##type:                                                                \
+    return type::New(ab, offset, length);
+    ARRAY_BUFFER_VIEW_TYPES(V)
+#undef V
+    default:
+      return Buffer::New(isolate, ab, offset, length).FromMaybe(
+          Local<Uint8Array>());
+  }
+}
+
 MaybeLocal<Object> DeserializerContext::ReadHostObject(Isolate* isolate) {
+  if (native_array_buffer_views_) {
+    return ReadArrayBufferView();
+  }
+
   Local<Value> read_host_object =
       object()->Get(env()->context(),
                     env()->read_host_object_string()).ToLocalChecked();
@@ -337,6 +623,15 @@ void DeserializerContext::New(const FunctionCallbackInfo<Value>& args) {
   new DeserializerContext(env, args.This(), args[0]);
 }
 
+void DeserializerContext::SetNativeArrayBufferViews(
+    const FunctionCallbackInfo<Value>& args) {
+  DeserializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+
+  ctx->native_array_buffer_views_ =
+      args[0]->BooleanValue(ctx->env()->isolate());
+}
+
 void DeserializerContext::ReadHeader(const FunctionCallbackInfo<Value>& args) {
   DeserializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
@@ -476,10 +771,16 @@ void Initialize(Local<Object> target,
   SetProtoMethod(isolate, ser, "writeDouble", SerializerContext::WriteDouble);
   SetProtoMethod(
       isolate, ser, "writeRawBytes", SerializerContext::WriteRawBytes);
+  SetProtoMethod(
+      isolate, ser, "serializeInto", SerializerContext::SerializeInto);
   SetProtoMethod(isolate,
                  ser,
                  "_setTreatArrayBufferViewsAsHostObjects",
                  SerializerContext::SetTreatArrayBufferViewsAsHostObjects);
+  SetProtoMethod(isolate,
+                 ser,
+                 "_setNativeArrayBufferViews",
+                 SerializerContext::SetNativeArrayBufferViews);
 
   ser->ReadOnlyPrototype();
   SetConstructorFunction(context, target, "Serializer", ser);
@@ -505,6 +806,10 @@ void Initialize(Local<Object> target,
   SetProtoMethod(isolate, des, "readDouble", DeserializerContext::ReadDouble);
   SetProtoMethod(
       isolate, des, "_readRawBytes", DeserializerContext::ReadRawBytes);
+  SetProtoMethod(isolate,
+                 des,
+                 "_setNativeArrayBufferViews",
+                 DeserializerContext::SetNativeArrayBufferViews);
 
   des->SetLength(1);
   des->ReadOnlyPrototype();
@@ -522,7 +827,9 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(SerializerContext::WriteUint64);
   registry->Register(SerializerContext::WriteDouble);
   registry->Register(SerializerContext::WriteRawBytes);
+  registry->Register(SerializerContext::SerializeInto);
   registry->Register(SerializerContext::SetTreatArrayBufferViewsAsHostObjects);
+  registry->Register(SerializerContext::SetNativeArrayBufferViews);
 
   registry->Register(DeserializerContext::New);
   registry->Register(DeserializerContext::ReadHeader);
@@ -533,6 +840,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(DeserializerContext::ReadUint64);
   registry->Register(DeserializerContext::ReadDouble);
   registry->Register(DeserializerContext::ReadRawBytes);
+  registry->Register(DeserializerContext::SetNativeArrayBufferViews);
 }
 
 }  // namespace serdes
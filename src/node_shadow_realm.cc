@@ -1,6 +1,7 @@
 #include "node_shadow_realm.h"
 #include "env-inl.h"
 #include "node_errors.h"
+#include "node_internals.h"
 #include "node_process.h"
 
 namespace node {
@@ -8,6 +9,7 @@ namespace shadow_realm {
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::HandleScope;
+using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
 using v8::Object;
@@ -16,6 +18,27 @@ using v8::Value;
 
 using TryCatchScope = node::errors::TryCatchScope;
 
+namespace {
+
+// The context that NewContext() creates is in the snapshot as well, as the
+// one that workers start from, and deserializing it is a lot cheaper than
+// creating it and running the per-context scripts again for every realm.
+Local<Context> NewShadowRealmContext(Environment* env) {
+  Isolate* isolate = env->isolate();
+  if (env->isolate_data()->snapshot_data() == nullptr) {
+    return NewContext(isolate);
+  }
+  Local<Context> context;
+  if (!Context::FromSnapshot(isolate, SnapshotData::kNodeBaseContextIndex)
+           .ToLocal(&context) ||
+      InitializeContextRuntime(context).IsNothing()) {
+    return Local<Context>();
+  }
+  return context;
+}
+
+}  // anonymous namespace
+
 // static
 ShadowRealm* ShadowRealm::New(Environment* env) {
   ShadowRealm* realm = new ShadowRealm(env);
@@ -75,7 +98,7 @@ void ShadowRealm::DeleteMe(void* data) {
 }
 
 ShadowRealm::ShadowRealm(Environment* env)
-    : Realm(env, NewContext(env->isolate()), kShadowRealm) {
+    : Realm(env, NewShadowRealmContext(env), kShadowRealm) {
   context_.SetWeak(this, WeakCallback, v8::WeakCallbackType::kParameter);
   CreateProperties();
 
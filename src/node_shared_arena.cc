@@ -0,0 +1,296 @@
+#include "node_shared_arena.h"
+
+#include "env-inl.h"
+#include "memory_tracker-inl.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "util-inl.h"
+
+#include <cmath>
+
+namespace node {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::SharedArrayBuffer;
+using v8::Value;
+
+namespace worker {
+
+namespace {
+
+constexpr uint64_t MakeListHead(uint64_t counter, uint32_t block) {
+  return (counter << 32) | block;
+}
+
+}  // anonymous namespace
+
+SharedArenaAllocator::SharedArenaAllocator(size_t capacity)
+    : capacity_(capacity / kMinBlockSize * kMinBlockSize),
+      block_classes_(new std::atomic<uint8_t>[capacity_ / kMinBlockSize]()),
+      next_free_(new std::atomic<uint32_t>[capacity_ / kMinBlockSize]()) {
+  CHECK_LE(capacity_, kMaxCapacity);
+  for (std::atomic<uint64_t>& head : free_lists_)
+    head.store(MakeListHead(0, kNoBlock), std::memory_order_relaxed);
+}
+
+void SharedArenaAllocator::PushFree(size_t size_class, uint32_t block) {
+  std::atomic<uint64_t>& list = free_lists_[size_class];
+  uint64_t head = list.load(std::memory_order_relaxed);
+  uint64_t new_head;
+  do {
+    next_free_[block].store(static_cast<uint32_t>(head),
+                            std::memory_order_relaxed);
+    new_head = MakeListHead((head >> 32) + 1, block);
+  } while (!list.compare_exchange_weak(
+      head, new_head, std::memory_order_release, std::memory_order_relaxed));
+}
+
+uint32_t SharedArenaAllocator::PopFree(size_t size_class) {
+  std::atomic<uint64_t>& list = free_lists_[size_class];
+  uint64_t head = list.load(std::memory_order_acquire);
+  while (true) {
+    uint32_t block = static_cast<uint32_t>(head);
+    if (block == kNoBlock) return kNoBlock;
+    // If another thread takes `block` first, this may read a value that is
+    // already outdated, but then the counter in `head` is outdated as well.
+    uint32_t next = next_free_[block].load(std::memory_order_relaxed);
+    if (list.compare_exchange_weak(head,
+                                   MakeListHead((head >> 32) + 1, next),
+                                   std::memory_order_acquire,
+                                   std::memory_order_acquire)) {
+      return block;
+    }
+  }
+}
+
+std::optional<size_t> SharedArenaAllocator::Allocate(size_t size) {
+  if (size > capacity_) return std::nullopt;
+  size_t size_class = 0;
+  while ((kMinBlockSize << size_class) < size) size_class++;
+  size_t block_size = kMinBlockSize << size_class;
+
+  uint32_t block = PopFree(size_class);
+
+  if (block == kNoBlock) {
+    // Blocks start at a multiple of their size. What is skipped to get
+    // there goes into the free lists of the smaller classes.
+    size_t top = top_.load(std::memory_order_relaxed);
+    size_t start = RoundUp(top, block_size);
+    while (start <= capacity_ && capacity_ - start >= block_size) {
+      if (top_.compare_exchange_weak(
+              top, start + block_size, std::memory_order_relaxed)) {
+        block = static_cast<uint32_t>(start / kMinBlockSize);
+        FreeRange(top, start);
+        break;
+      }
+      start = RoundUp(top, block_size);
+    }
+  }
+
+  if (block == kNoBlock) {
+    // Split the smallest free block that is large enough, and put the
+    // halves that are not needed into the free lists of their classes.
+    for (size_t larger = size_class + 1; larger < kSizeClassCount; larger++) {
+      block = PopFree(larger);
+      if (block == kNoBlock) continue;
+      while (larger > size_class) {
+        larger--;
+        PushFree(larger, block + (uint32_t{1} << larger));
+      }
+      break;
+    }
+  }
+
+  if (block == kNoBlock) return std::nullopt;
+  block_classes_[block].store(static_cast<uint8_t>(size_class + 1),
+                              std::memory_order_relaxed);
+  return size_t{block} * kMinBlockSize;
+}
+
+void SharedArenaAllocator::FreeRange(size_t start, size_t end) {
+  while (start < end) {
+    // The largest block that starts at a multiple of its size and fits.
+    size_t size_class = 0;
+    while (size_class + 1 < kSizeClassCount &&
+           start % (kMinBlockSize << (size_class + 1)) == 0 &&
+           end - start >= (kMinBlockSize << (size_class + 1))) {
+      size_class++;
+    }
+    PushFree(size_class, static_cast<uint32_t>(start / kMinBlockSize));
+    start += kMinBlockSize << size_class;
+  }
+}
+
+bool SharedArenaAllocator::Free(size_t offset) {
+  if (offset % kMinBlockSize != 0 || offset >= capacity_) return false;
+  uint32_t block = static_cast<uint32_t>(offset / kMinBlockSize);
+  // The exchange makes sure that only one of several concurrent Free()
+  // calls for the same block succeeds.
+  uint8_t size_class =
+      block_classes_[block].exchange(0, std::memory_order_relaxed);
+  if (size_class == 0) return false;
+  PushFree(size_class - 1, block);
+  return true;
+}
+
+size_t SharedArenaAllocator::BlockSize(size_t offset) const {
+  if (offset % kMinBlockSize != 0 || offset >= capacity_) return 0;
+  uint8_t size_class = block_classes_[offset / kMinBlockSize].load(
+      std::memory_order_relaxed);
+  if (size_class == 0) return 0;
+  return kMinBlockSize << (size_class - 1);
+}
+
+Local<FunctionTemplate> SharedArena::GetConstructorTemplate(Environment* env) {
+  Local<FunctionTemplate> tmpl = env->shared_arena_constructor_template();
+  if (tmpl.IsEmpty()) {
+    Isolate* isolate = env->isolate();
+    tmpl = NewFunctionTemplate(isolate, New);
+    tmpl->SetClassName(FIXED_ONE_BYTE_STRING(isolate, "SharedArena"));
+    tmpl->InstanceTemplate()->SetInternalFieldCount(
+        SharedArena::kInternalFieldCount);
+    SetProtoMethod(isolate, tmpl, "allocate", Allocate);
+    SetProtoMethod(isolate, tmpl, "free", Free);
+    SetProtoMethodNoSideEffect(isolate, tmpl, "blockSize", BlockSize);
+    SetProtoMethodNoSideEffect(isolate, tmpl, "getBuffer", GetBuffer);
+    env->set_shared_arena_constructor_template(tmpl);
+  }
+  return tmpl;
+}
+
+void SharedArena::Initialize(Environment* env, Local<Object> target) {
+  SetConstructorFunction(env->context(),
+                         target,
+                         "SharedArena",
+                         GetConstructorTemplate(env),
+                         SetConstructorFunctionFlag::NONE);
+}
+
+void SharedArena::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Allocate);
+  registry->Register(Free);
+  registry->Register(BlockSize);
+  registry->Register(GetBuffer);
+}
+
+BaseObjectPtr<SharedArena> SharedArena::Create(
+    Environment* env, std::shared_ptr<Storage> storage) {
+  Local<Object> obj;
+  if (!GetConstructorTemplate(env)
+           ->InstanceTemplate()
+           ->NewInstance(env->context())
+           .ToLocal(&obj)) {
+    return BaseObjectPtr<SharedArena>();
+  }
+
+  return MakeBaseObject<SharedArena>(env, obj, std::move(storage));
+}
+
+SharedArena::SharedArena(Environment* env,
+                         Local<Object> wrap,
+                         std::shared_ptr<Storage> storage)
+    : BaseObject(env, wrap), storage_(std::move(storage)) {
+  MakeWeak();
+}
+
+void SharedArena::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsNumber());  // byteLength
+
+  double byte_length = args[0].As<Number>()->Value();
+  if (!(byte_length >= SharedArenaAllocator::kMinBlockSize &&
+        byte_length <= SharedArenaAllocator::kMaxCapacity)) {
+    return THROW_ERR_OUT_OF_RANGE(
+        env, "The arena size must be between 64 bytes and 4 GiB");
+  }
+  size_t capacity = static_cast<size_t>(byte_length) /
+                    SharedArenaAllocator::kMinBlockSize *
+                    SharedArenaAllocator::kMinBlockSize;
+
+  std::shared_ptr<v8::BackingStore> backing_store =
+      SharedArrayBuffer::NewBackingStore(env->isolate(), capacity);
+  new SharedArena(
+      env,
+      args.This(),
+      std::make_shared<Storage>(std::move(backing_store), capacity));
+}
+
+void SharedArena::Allocate(const FunctionCallbackInfo<Value>& args) {
+  SharedArena* arena;
+  ASSIGN_OR_RETURN_UNWRAP(&arena, args.This());
+  CHECK(args[0]->IsNumber());  // byteLength
+
+  // Returns -1 when the arena is exhausted.
+  // A fractional size is rounded up, so that the block is never smaller.
+  double size = std::ceil(args[0].As<Number>()->Value());
+  std::optional<size_t> offset;
+  if (size >= 0 && size <= arena->storage_->allocator.capacity())
+    offset = arena->storage_->allocator.Allocate(static_cast<size_t>(size));
+  args.GetReturnValue().Set(offset ? static_cast<double>(*offset) : -1.0);
+}
+
+void SharedArena::Free(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SharedArena* arena;
+  ASSIGN_OR_RETURN_UNWRAP(&arena, args.This());
+  CHECK(args[0]->IsNumber());  // offset
+
+  double offset = args[0].As<Number>()->Value();
+  if (!(offset >= 0 && offset < arena->storage_->allocator.capacity()) ||
+      std::trunc(offset) != offset ||
+      !arena->storage_->allocator.Free(static_cast<size_t>(offset))) {
+    return THROW_ERR_INVALID_ARG_VALUE(
+        env, "The offset does not refer to an allocated block");
+  }
+}
+
+void SharedArena::BlockSize(const FunctionCallbackInfo<Value>& args) {
+  SharedArena* arena;
+  ASSIGN_OR_RETURN_UNWRAP(&arena, args.This());
+  CHECK(args[0]->IsNumber());  // offset
+
+  double offset = args[0].As<Number>()->Value();
+  size_t size = 0;
+  if (offset >= 0 && offset < arena->storage_->allocator.capacity() &&
+      std::trunc(offset) == offset) {
+    size = arena->storage_->allocator.BlockSize(static_cast<size_t>(offset));
+  }
+  args.GetReturnValue().Set(static_cast<double>(size));
+}
+
+void SharedArena::GetBuffer(const FunctionCallbackInfo<Value>& args) {
+  SharedArena* arena;
+  ASSIGN_OR_RETURN_UNWRAP(&arena, args.This());
+  args.GetReturnValue().Set(
+      SharedArrayBuffer::New(args.GetIsolate(),
+                             arena->storage_->backing_store));
+}
+
+void SharedArena::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("storage",
+                              storage_->allocator.capacity(),
+                              "SharedArena::Storage");
+}
+
+std::unique_ptr<worker::TransferData> SharedArena::CloneForMessaging() const {
+  return std::make_unique<TransferData>(storage_);
+}
+
+BaseObjectPtr<BaseObject> SharedArena::TransferData::Deserialize(
+    Environment* env,
+    Local<Context> context,
+    std::unique_ptr<worker::TransferData> self) {
+  return Create(env, std::move(storage_));
+}
+
+}  // namespace worker
+}  // namespace node
@@ -0,0 +1,143 @@
+#ifndef SRC_NODE_SHARED_ARENA_H_
+#define SRC_NODE_SHARED_ARENA_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "base_object.h"
+#include "node_messaging.h"
+#include "v8.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace node {
+
+class ExternalReferenceRegistry;
+
+namespace worker {
+
+// Hands out blocks of a fixed-size region from any number of threads
+// without taking a lock. Requests are rounded up to a power-of-two size
+// class, and each size class has a lock-free free list of released blocks.
+// Every block starts at a multiple of its size.
+// New blocks are carved off the unused end of the region. Once that runs
+// out, a free block of a larger class is split. Freed blocks are not
+// coalesced.
+// All bookkeeping lives outside of the region, so that whatever JS code
+// writes into the blocks cannot corrupt the allocator.
+class SharedArenaAllocator {
+ public:
+  static constexpr size_t kMinBlockSize = 64;
+  static constexpr size_t kMaxCapacity = size_t{1} << 32;
+
+  // `capacity` is rounded down to a multiple of kMinBlockSize.
+  explicit SharedArenaAllocator(size_t capacity);
+
+  SharedArenaAllocator(const SharedArenaAllocator&) = delete;
+  SharedArenaAllocator& operator=(const SharedArenaAllocator&) = delete;
+
+  // Returns the offset of a block of at least `size` bytes, or std::nullopt
+  // if there is no room for one.
+  std::optional<size_t> Allocate(size_t size);
+  // Returns false if `offset` is not the start of an allocated block.
+  bool Free(size_t offset);
+  // Returns the size of the allocated block at `offset`, or 0 if there is
+  // none.
+  size_t BlockSize(size_t offset) const;
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  // kMinBlockSize up to kMaxCapacity.
+  static constexpr size_t kSizeClassCount = 27;
+  static constexpr uint32_t kNoBlock = UINT32_MAX;
+
+  void PushFree(size_t size_class, uint32_t block);
+  // Puts the unused range [start, end) into the free lists.
+  void FreeRange(size_t start, size_t end);
+  uint32_t PopFree(size_t size_class);
+
+  const size_t capacity_;
+  // Offset of the unused end of the region.
+  std::atomic<size_t> top_{0};
+  // The first block of each free list in the low 32 bits, and a counter
+  // that changes on every update in the high 32 bits, so that a stale head
+  // never wins a compare-and-swap.
+  std::atomic<uint64_t> free_lists_[kSizeClassCount];
+  // Indexed by offset / kMinBlockSize: one more than the size class of the
+  // allocated block that starts there, or 0.
+  std::unique_ptr<std::atomic<uint8_t>[]> block_classes_;
+  // Indexed by offset / kMinBlockSize: the next block in a free list.
+  std::unique_ptr<std::atomic<uint32_t>[]> next_free_;
+};
+
+// A SharedArrayBuffer with a SharedArenaAllocator for it. Cloning the JS
+// object into another thread shares both, so that records can be put into
+// the buffer on one thread and handed to another by offset.
+class SharedArena : public BaseObject {
+ public:
+  struct Storage {
+    Storage(std::shared_ptr<v8::BackingStore> store, size_t capacity)
+        : backing_store(std::move(store)), allocator(capacity) {}
+
+    std::shared_ptr<v8::BackingStore> backing_store;
+    SharedArenaAllocator allocator;
+  };
+
+  static v8::Local<v8::FunctionTemplate> GetConstructorTemplate(
+      Environment* env);
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+  static BaseObjectPtr<SharedArena> Create(Environment* env,
+                                           std::shared_ptr<Storage> storage);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Allocate(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Free(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void BlockSize(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  SharedArena(Environment* env,
+              v8::Local<v8::Object> wrap,
+              std::shared_ptr<Storage> storage);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(SharedArena)
+  SET_SELF_SIZE(SharedArena)
+
+  BaseObject::TransferMode GetTransferMode() const override {
+    return TransferMode::kCloneable;
+  }
+  std::unique_ptr<worker::TransferData> CloneForMessaging() const override;
+
+  class TransferData : public worker::TransferData {
+   public:
+    explicit TransferData(std::shared_ptr<Storage> storage)
+        : storage_(std::move(storage)) {}
+
+    BaseObjectPtr<BaseObject> Deserialize(
+        Environment* env,
+        v8::Local<v8::Context> context,
+        std::unique_ptr<worker::TransferData> self) override;
+
+    SET_NO_MEMORY_INFO()
+    SET_MEMORY_INFO_NAME(SharedArena::TransferData)
+    SET_SELF_SIZE(TransferData)
+
+   private:
+    std::shared_ptr<Storage> storage_;
+  };
+
+ private:
+  std::shared_ptr<Storage> storage_;
+};
+
+}  // namespace worker
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_SHARED_ARENA_H_
@@ -0,0 +1,356 @@
+#include "node_shm_channel.h"
+#include "async_wrap-inl.h"
+#include "env-inl.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "util-inl.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::LocalVector;
+using v8::Object;
+using v8::Uint8Array;
+using v8::Value;
+
+namespace shm_channel {
+
+ShmRing::ShmRing(void* memory, size_t capacity)
+    : header_(static_cast<Header*>(memory)),
+      data_(static_cast<uint8_t*>(memory) + sizeof(Header)),
+      capacity_(capacity) {
+  CHECK_GT(capacity, kLengthSize);
+  CHECK_EQ(capacity & (capacity - 1), 0);
+}
+
+void ShmRing::CopyIn(uint64_t position, const void* data, size_t length) {
+  size_t offset = position & (capacity_ - 1);
+  size_t first = std::min(length, capacity_ - offset);
+  memcpy(data_ + offset, data, first);
+  memcpy(data_, static_cast<const uint8_t*>(data) + first, length - first);
+}
+
+void ShmRing::CopyOut(uint64_t position, void* data, size_t length) const {
+  size_t offset = position & (capacity_ - 1);
+  size_t first = std::min(length, capacity_ - offset);
+  memcpy(data, data_ + offset, first);
+  memcpy(static_cast<uint8_t*>(data) + first, data_, length - first);
+}
+
+bool ShmRing::Write(const uint8_t* data, size_t length, bool* notify) {
+  if (length > max_record_size()) return false;
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  uint64_t head = header_->head.load(std::memory_order_acquire);
+  // A head that is ahead of the tail, or too far behind it, can only come
+  // from a broken reader, which gets nothing more.
+  uint64_t used = tail - head;
+  if (used > capacity_ || capacity_ - used < kLengthSize + length) {
+    return false;
+  }
+
+  uint32_t size = static_cast<uint32_t>(length);
+  CopyIn(tail, &size, kLengthSize);
+  CopyIn(tail + kLengthSize, data, length);
+  header_->tail.store(tail + kLengthSize + length, std::memory_order_seq_cst);
+  // The reader stores its head before checking the tail for more records,
+  // so if it has not consumed everything up to the old tail yet, it will
+  // see the new record without being woken up.
+  *notify = header_->head.load(std::memory_order_seq_cst) == tail;
+  return true;
+}
+
+ShmRing::ReadResult ShmRing::Peek(size_t* size) const {
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  uint64_t tail = header_->tail.load(std::memory_order_seq_cst);
+  if (tail == head) return ReadResult::kEmpty;
+  uint64_t used = tail - head;
+  if (used > capacity_ || used < kLengthSize) return ReadResult::kCorrupt;
+
+  uint32_t length;
+  CopyOut(head, &length, kLengthSize);
+  if (length > used - kLengthSize) return ReadResult::kCorrupt;
+  *size = length;
+  return ReadResult::kRecord;
+}
+
+void ShmRing::Consume(uint8_t* out, size_t size) {
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  CopyOut(head + kLengthSize, out, size);
+  header_->head.store(head + kLengthSize + size, std::memory_order_seq_cst);
+}
+
+namespace {
+
+void Create(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  uint32_t capacity = args[0].As<v8::Uint32>()->Value();
+  if (!Preamble::IsValidCapacity(capacity)) {
+    return THROW_ERR_OUT_OF_RANGE(
+        env, "The capacity must be a power of two between 64 and 2^30");
+  }
+
+#ifdef __linux__
+  int memory_fd = memfd_create("node-shm-channel", MFD_CLOEXEC);
+  if (memory_fd == -1) return env->ThrowErrnoException(errno, "memfd_create");
+  Preamble preamble = {Preamble::kMagic, capacity, {}};
+  size_t preamble_size = offsetof(Preamble, rings);
+  if (ftruncate(memory_fd, Preamble::MappingSize(capacity)) == -1 ||
+      pwrite(memory_fd, &preamble, preamble_size, 0) !=
+          static_cast<ssize_t>(preamble_size)) {
+    int err = errno;
+    close(memory_fd);
+    return env->ThrowErrnoException(err, "ftruncate");
+  }
+
+  int event_fds[2];
+  for (int i = 0; i < 2; i++) {
+    event_fds[i] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fds[i] == -1) {
+      int err = errno;
+      close(memory_fd);
+      if (i == 1) close(event_fds[0]);
+      return env->ThrowErrnoException(err, "eventfd");
+    }
+  }
+
+  Isolate* isolate = env->isolate();
+  Local<Value> fds[] = {Integer::New(isolate, memory_fd),
+                        Integer::New(isolate, event_fds[0]),
+                        Integer::New(isolate, event_fds[1])};
+  args.GetReturnValue().Set(Array::New(isolate, fds, arraysize(fds)));
+#else
+  env->ThrowUVException(UV_ENOTSUP, "memfd_create");
+#endif  // __linux__
+}
+
+}  // anonymous namespace
+
+#ifdef __linux__
+void ShmChannel::Initialize(Environment* env, Local<Object> target) {
+  Isolate* isolate = env->isolate();
+  Local<FunctionTemplate> constructor = NewFunctionTemplate(isolate, New);
+  constructor->InstanceTemplate()->SetInternalFieldCount(
+      ShmChannel::kInternalFieldCount);
+  constructor->Inherit(HandleWrap::GetConstructorTemplate(env));
+
+  SetProtoMethod(isolate, constructor, "postMessage", PostMessage);
+  SetProtoMethod(isolate, constructor, "start", Start);
+  SetProtoMethod(isolate, constructor, "stop", Stop);
+
+  SetConstructorFunction(env->context(), target, "ShmChannel", constructor);
+}
+
+void ShmChannel::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(PostMessage);
+  registry->Register(Start);
+  registry->Register(Stop);
+}
+
+ShmChannel::ShmChannel(Environment* env,
+                       Local<Object> object,
+                       Preamble* mapping,
+                       size_t capacity,
+                       int side,
+                       int read_fd,
+                       int write_fd)
+    : HandleWrap(env,
+                 object,
+                 reinterpret_cast<uv_handle_t*>(&handle_),
+                 AsyncWrap::PROVIDER_SHMCHANNEL),
+      mapping_(mapping),
+      capacity_(capacity),
+      writer_(mapping->ring(side, capacity), capacity),
+      reader_(mapping->ring(1 - side, capacity), capacity),
+      read_fd_(read_fd),
+      write_fd_(write_fd) {
+  int r = uv_poll_init(env->event_loop(), &handle_, read_fd);
+  CHECK_EQ(r, 0);
+}
+
+ShmChannel::~ShmChannel() {
+  munmap(mapping_, Preamble::MappingSize(capacity_));
+  close(read_fd_);
+  if (write_fd_ != read_fd_) close(write_fd_);
+}
+
+void ShmChannel::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsInt32());
+  CHECK(args[3]->IsInt32());
+  int memory_fd = args[0].As<v8::Int32>()->Value();
+  int side = args[1].As<v8::Int32>()->Value();
+  int read_fd = args[2].As<v8::Int32>()->Value();
+  int write_fd = args[3].As<v8::Int32>()->Value();
+  CHECK(side == 0 || side == 1);
+
+  if (fcntl(read_fd, F_GETFD) == -1 || fcntl(write_fd, F_GETFD) == -1) {
+    return env->ThrowErrnoException(errno, "fcntl");
+  }
+  struct stat st;
+  if (fstat(memory_fd, &st) == -1) {
+    return env->ThrowErrnoException(errno, "fstat");
+  }
+  size_t mapping_size = static_cast<size_t>(st.st_size);
+  if (mapping_size < Preamble::MappingSize(Preamble::kMinCapacity)) {
+    return THROW_ERR_INVALID_ARG_VALUE(env, "Not a shared memory channel");
+  }
+  void* memory = mmap(nullptr,
+                      mapping_size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED,
+                      memory_fd,
+                      0);
+  if (memory == MAP_FAILED) return env->ThrowErrnoException(errno, "mmap");
+
+  // The peer can change the preamble at any time, so it is read only once.
+  Preamble* mapping = static_cast<Preamble*>(memory);
+  uint64_t magic = mapping->magic;
+  uint64_t capacity = mapping->capacity;
+  if (magic != Preamble::kMagic || !Preamble::IsValidCapacity(capacity) ||
+      Preamble::MappingSize(capacity) != mapping_size) {
+    munmap(memory, mapping_size);
+    return THROW_ERR_INVALID_ARG_VALUE(env, "Not a shared memory channel");
+  }
+
+  new ShmChannel(
+      env, args.This(), mapping, capacity, side, read_fd, write_fd);
+}
+
+void ShmChannel::PostMessage(const FunctionCallbackInfo<Value>& args) {
+  ShmChannel* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  CHECK(args[0]->IsArrayBufferView());
+  ArrayBufferViewContents<uint8_t> message(args[0]);
+
+  if (message.length() > wrap->writer_.max_record_size()) {
+    return args.GetReturnValue().Set(UV_EMSGSIZE);
+  }
+  bool notify;
+  if (!wrap->writer_.Write(message.data(), message.length(), &notify)) {
+    return args.GetReturnValue().Set(UV_ENOBUFS);
+  }
+  if (notify) Notify(wrap->write_fd_);
+  args.GetReturnValue().Set(0);
+}
+
+void ShmChannel::Start(const FunctionCallbackInfo<Value>& args) {
+  ShmChannel* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  int err = uv_poll_start(&wrap->handle_, UV_READABLE, OnPoll);
+  args.GetReturnValue().Set(err);
+}
+
+void ShmChannel::Stop(const FunctionCallbackInfo<Value>& args) {
+  ShmChannel* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  int err = uv_poll_stop(&wrap->handle_);
+  args.GetReturnValue().Set(err);
+}
+
+void ShmChannel::Notify(int fd) {
+  uint64_t value = 1;
+  ssize_t r;
+  do {
+    r = write(fd, &value, sizeof(value));
+  } while (r == -1 && errno == EINTR);
+  // EAGAIN means that the counter is about to overflow, in which case the
+  // reader is going to wake up anyway.
+}
+
+void ShmChannel::OnPoll(uv_poll_t* handle, int status, int events) {
+  ShmChannel* wrap = ContainerOf(&ShmChannel::handle_, handle);
+  if (status < 0) {
+    Environment* env = wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> arg = Integer::New(env->isolate(), status);
+    wrap->MakeCallback(env->onerror_string(), 1, &arg);
+    return;
+  }
+
+  uint64_t value;
+  ssize_t r;
+  do {
+    r = read(wrap->read_fd_, &value, sizeof(value));
+  } while (r == -1 && errno == EINTR);
+  wrap->Drain();
+}
+
+void ShmChannel::Drain() {
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  LocalVector<Value> messages(isolate);
+  ShmRing::ReadResult result = ShmRing::ReadResult::kEmpty;
+  size_t size;
+  while (messages.size() < kMaxMessagesPerWakeup &&
+         (result = reader_.Peek(&size)) == ShmRing::ReadResult::kRecord) {
+    Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, size);
+    reader_.Consume(static_cast<uint8_t*>(buffer->Data()), size);
+    messages.push_back(Uint8Array::New(buffer, 0, size));
+  }
+  // Let the other handles run before delivering the rest.
+  if (result == ShmRing::ReadResult::kRecord) Notify(read_fd_);
+  if (result == ShmRing::ReadResult::kCorrupt) uv_poll_stop(&handle_);
+
+  if (!messages.empty()) {
+    Local<Value> arg = Array::New(isolate, messages.data(), messages.size());
+    MakeCallback(env->onmessage_string(), 1, &arg);
+  }
+  if (result == ShmRing::ReadResult::kCorrupt) {
+    Local<Value> arg = Integer::New(isolate, UV_EPROTO);
+    MakeCallback(env->onerror_string(), 1, &arg);
+  }
+}
+#endif  // __linux__
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context,
+                void* priv) {
+  SetMethod(context, target, "create", Create);
+#ifdef __linux__
+  ShmChannel::Initialize(Environment::GetCurrent(context), target);
+#endif
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Create);
+#ifdef __linux__
+  ShmChannel::RegisterExternalReferences(registry);
+#endif
+}
+
+}  // namespace shm_channel
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(shm_channel, node::shm_channel::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(shm_channel,
+                                node::shm_channel::RegisterExternalReferences)
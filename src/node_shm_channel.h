@@ -0,0 +1,163 @@
+#ifndef SRC_NODE_SHM_CHANNEL_H_
+#define SRC_NODE_SHM_CHANNEL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "handle_wrap.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace node {
+
+class ExternalReferenceRegistry;
+
+namespace shm_channel {
+
+// One direction of a channel: a ring of bytes in memory that is shared by
+// the writing and the reading process, holding records that are a 32-bit
+// length in native byte order followed by that many bytes. Like
+// SPSCRingBuffer, each side only ever writes its own index, so there is no
+// lock that a crashed peer could leave taken. The reader does not trust
+// anything in the shared memory, so a broken peer can at worst make it see
+// garbage records or a corrupt ring, never read out of bounds.
+class ShmRing {
+ public:
+  struct Header {
+    // Written by the reader.
+    alignas(64) std::atomic<uint64_t> head;
+    // Written by the writer.
+    alignas(64) std::atomic<uint64_t> tail;
+  };
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "The indices must work across processes");
+
+  enum class ReadResult { kRecord, kEmpty, kCorrupt };
+
+  static constexpr size_t kLengthSize = sizeof(uint32_t);
+
+  // The bytes of shared memory needed for a ring of `capacity` bytes.
+  static constexpr size_t SizeFor(size_t capacity) {
+    return sizeof(Header) + capacity;
+  }
+
+  // `memory` is SizeFor(capacity) bytes, zero-filled for a new ring, and
+  // `capacity` is a power of two.
+  ShmRing(void* memory, size_t capacity);
+
+  // The size of the largest record that fits into the ring.
+  size_t max_record_size() const { return capacity_ - kLengthSize; }
+
+  // Writer side. Returns false if there is no room for the record at the
+  // moment. Otherwise, `*notify` tells whether the reader may have found the
+  // ring empty and needs to be woken up.
+  bool Write(const uint8_t* data, size_t length, bool* notify);
+
+  // Reader side. Stores the size of the next record in `*size`.
+  ReadResult Peek(size_t* size) const;
+  // Copies the record that Peek() returned the size of to `out` and removes
+  // it from the ring.
+  void Consume(uint8_t* out, size_t size);
+
+ private:
+  void CopyIn(uint64_t position, const void* data, size_t length);
+  void CopyOut(uint64_t position, void* data, size_t length) const;
+
+  Header* const header_;
+  uint8_t* const data_;
+  const size_t capacity_;
+};
+
+// The shared memory of a channel is a preamble followed by the rings of both
+// directions. Side 0 writes to the first one and reads from the second one,
+// side 1 the other way around.
+struct Preamble {
+  static constexpr uint64_t kMagic = 0x4c4e4843'4d4853ull;  // "SHMCHNL"
+
+  uint64_t magic;
+  uint64_t capacity;
+  alignas(64) uint8_t rings[1];
+
+  static constexpr size_t kMinCapacity = 64;
+  static constexpr size_t kMaxCapacity = size_t{1} << 30;
+
+  static constexpr bool IsValidCapacity(uint64_t capacity) {
+    return capacity >= kMinCapacity && capacity <= kMaxCapacity &&
+           (capacity & (capacity - 1)) == 0;
+  }
+
+  static constexpr size_t MappingSize(size_t capacity) {
+    return offsetof(Preamble, rings) + 2 * ShmRing::SizeFor(capacity);
+  }
+
+  void* ring(int index, size_t capacity) {
+    return rings + index * ShmRing::SizeFor(capacity);
+  }
+};
+
+void Initialize(v8::Local<v8::Object> target,
+                v8::Local<v8::Value> unused,
+                v8::Local<v8::Context> context,
+                void* priv);
+void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+#ifdef __linux__
+// A channel between two processes, usually a parent and the child it
+// spawned. create(capacity) returns the shared memory and two eventfds as
+// [memoryFd, eventFd0, eventFd1], which the parent passes to the child as
+// extra stdio. Each side then does
+// new ShmChannel(memoryFd, side, readEventFd, writeEventFd), with eventFd0
+// waking up side 0, and closes memoryFd, while the channel takes over the
+// event fds. postMessage(view) returns 0, or UV_ENOBUFS if the ring is full
+// and UV_EMSGSIZE if the message can never fit. After start(), the messages
+// that are waiting are passed to onmessage(array) as Uint8Arrays on every
+// wake-up. A corrupt ring stops the channel and calls onerror(UV_EPROTO).
+class ShmChannel final : public HandleWrap {
+ public:
+  static constexpr size_t kMaxMessagesPerWakeup = 1024;
+
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(ShmChannel)
+  SET_SELF_SIZE(ShmChannel)
+
+ private:
+  ShmChannel(Environment* env,
+             v8::Local<v8::Object> object,
+             Preamble* mapping,
+             size_t capacity,
+             int side,
+             int read_fd,
+             int write_fd);
+  ~ShmChannel() override;
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void PostMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Stop(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void OnPoll(uv_poll_t* handle, int status, int events);
+  void Drain();
+  static void Notify(int fd);
+
+  uv_poll_t handle_;
+  Preamble* const mapping_;
+  const size_t capacity_;
+  ShmRing writer_;
+  ShmRing reader_;
+  const int read_fd_;
+  const int write_fd_;
+};
+#endif  // __linux__
+
+}  // namespace shm_channel
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_SHM_CHANNEL_H_
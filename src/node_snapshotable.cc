@@ -1,5 +1,6 @@
 
 #include "node_snapshotable.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -856,8 +857,11 @@ namespace node {
     WriteCodeCacheInitializer(&ss, item.id, item.data.length);
   }
   ss << R"(
-  }
+  },
   // -- code_cache ends --
+  // -- shared_code_cache begins --
+  {}
+  // -- shared_code_cache ends --
 };
 
 const SnapshotData* SnapshotBuilder::GetEmbeddedSnapshotData() {
@@ -1019,11 +1023,23 @@ ExitCode BuildSnapshotWithoutCodeCache(
   return SnapshotBuilder::CreateSnapshot(out, setup.get());
 }
 
-ExitCode BuildCodeCacheFromSnapshot(SnapshotData* out,
-                                    const std::vector<std::string>& args,
-                                    const std::vector<std::string>& exec_args) {
-  RAIIIsolate raii_isolate(out);
-  Isolate* isolate = raii_isolate.get();
+// The most isolates that compile the builtins for the code cache at once.
+constexpr size_t kMaxCodeCacheThreads = 8;
+
+// A share of the builtins that one isolate, deserialized from the snapshot,
+// compiles for the code cache.
+struct CodeCacheShard {
+  std::unique_ptr<RAIIIsolateWithoutEntering> isolate;
+  const std::vector<std::string>* eager_builtins;
+  std::vector<std::string_view> ids;
+  std::vector<builtins::CodeCacheInfo> code_cache;
+  bool succeeded = false;
+  uv_thread_t thread;
+};
+
+static void BuildCodeCacheShard(void* data) {
+  CodeCacheShard* shard = static_cast<CodeCacheShard*>(data);
+  Isolate* isolate = shard->isolate->get();
   v8::Locker locker(isolate);
   Isolate::Scope isolate_scope(isolate);
   HandleScope handle_scope(isolate);
@@ -1039,11 +1055,61 @@ ExitCode BuildCodeCacheFromSnapshot(SnapshotData* out,
   Local<Context> context = Context::New(isolate);
   Context::Scope context_scope(context);
   builtins::BuiltinLoader builtin_loader;
-  // Regenerate all the code cache.
-  if (!builtin_loader.CompileAllBuiltinsAndCopyCodeCache(
-          context,
-          out->env_info.principal_realm.builtins,
-          &(out->code_cache))) {
+  shard->succeeded = builtin_loader.CompileBuiltinsAndCopyCodeCache(
+      context, *shard->eager_builtins, shard->ids, &shard->code_cache);
+}
+
+ExitCode BuildCodeCacheFromSnapshot(SnapshotData* out,
+                                    const std::vector<std::string>& args,
+                                    const std::vector<std::string>& exec_args) {
+  // Compiling the builtins takes most of the time, and every builtin is
+  // compiled on its own, so they are split between several isolates that
+  // are deserialized from the same snapshot. The isolates are set up here,
+  // because registering them with the platform is not thread-safe.
+  builtins::BuiltinLoader builtin_loader;
+  std::vector<std::string_view> ids = builtin_loader.GetBuiltinIds();
+  size_t thread_count = std::min<size_t>(
+      {uv_available_parallelism(), kMaxCodeCacheThreads, ids.size()});
+  thread_count = std::max<size_t>(thread_count, 1);
+  std::vector<CodeCacheShard> shards(thread_count);
+  for (size_t i = 0; i < ids.size(); i++) {
+    shards[i % thread_count].ids.push_back(ids[i]);
+  }
+  for (CodeCacheShard& shard : shards) {
+    shard.isolate = std::make_unique<RAIIIsolateWithoutEntering>(out);
+    shard.eager_builtins = &out->env_info.principal_realm.builtins;
+  }
+
+  per_process::Debug(DebugCategory::CODE_CACHE,
+                     "Compiling %d builtins in %d isolates\n",
+                     ids.size(),
+                     thread_count);
+  if (thread_count == 1) {
+    BuildCodeCacheShard(&shards[0]);
+  } else {
+    for (CodeCacheShard& shard : shards) {
+      CHECK_EQ(uv_thread_create(&shard.thread, BuildCodeCacheShard, &shard),
+               0);
+    }
+    for (CodeCacheShard& shard : shards) {
+      CHECK_EQ(uv_thread_join(&shard.thread), 0);
+    }
+  }
+
+  bool all_succeeded = true;
+  for (CodeCacheShard& shard : shards) {
+    all_succeeded = all_succeeded && shard.succeeded;
+    for (builtins::CodeCacheInfo& item : shard.code_cache) {
+      out->code_cache.push_back(std::move(item));
+    }
+  }
+  // Keep the blob the same from build to build, however the builtins were
+  // split up and in whatever order the caches came out of the maps.
+  std::sort(out->code_cache.begin(),
+            out->code_cache.end(),
+            [](const builtins::CodeCacheInfo& a,
+               const builtins::CodeCacheInfo& b) { return a.id < b.id; });
+  if (!all_succeeded) {
     return ExitCode::kGenericUserError;
   }
   if (per_process::enabled_debug_list.enabled(DebugCategory::MKSNAPSHOT)) {
@@ -1115,6 +1181,15 @@ ExitCode SnapshotBuilder::CreateSnapshot(SnapshotData* out,
       }
     }
 
+    // The vm context created when the sandbox does not need to be
+    // contextified, see ContextifyContext::MakeContext().
+    Local<Context> vm_vanilla_context;
+    if (!contextify::ContextifyContext::CreateV8Context(
+             isolate, Local<ObjectTemplate>(), nullptr, nullptr)
+             .ToLocal(&vm_vanilla_context)) {
+      return ExitCode::kStartupSnapshotFailure;
+    }
+
     // The Node.js-specific context with primodials, can be used by workers
     // TODO(joyeecheung): investigate if this can be used by vm contexts
     // without breaking compatibility.
@@ -1158,6 +1233,8 @@ ExitCode SnapshotBuilder::CreateSnapshot(SnapshotData* out,
     index = creator->AddContext(main_context,
                                 {SerializeNodeContextInternalFields, env});
     CHECK_EQ(index, SnapshotData::kNodeMainContextIndex);
+    index = creator->AddContext(vm_vanilla_context);
+    CHECK_EQ(index, SnapshotData::kNodeVMVanillaContextIndex);
   }
 
   // Must be out of HandleScope
@@ -1330,8 +1407,18 @@ StartupData SerializeNodeContextInternalFields(Local<Object> holder,
     return StartupData{nullptr, 0};
   }
 
-  // Use the V8 convention and serialize unknown objects verbatim.
   Environment* env = static_cast<Environment*>(callback_data);
+  // TODO(joyeecheung): support cppgc objects.
+  if (holder->InternalFieldCount() >= BaseObject::kInternalFieldCount &&
+      holder->GetAlignedPointerFromInternalField(BaseObject::kEmbedderType) ==
+          env->isolate_data()->embedder_id_for_cppgc()) {
+    fprintf(stderr,
+            "Cannot serialize cppgc-managed object %p into the snapshot\n",
+            *holder);
+    ABORT();
+  }
+
+  // Use the V8 convention and serialize unknown objects verbatim.
   if (!BaseObject::IsBaseObject(env->isolate_data(), holder)) {
     per_process::Debug(DebugCategory::MKSNAPSHOT,
                        "Serialize unknown object, index=%d, holder=%p\n",
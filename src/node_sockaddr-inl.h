@@ -240,7 +240,7 @@ typename T::Type* SocketAddressLRU<T>::Upsert(
     return &it->second->second;
   }
 
-  list_.push_front(Pair(address, { }));
+  list_.emplace_front(address, Type {});
   map_[address] = list_.begin();
   T::Touch(list_.begin()->first, &list_.begin()->second);
 
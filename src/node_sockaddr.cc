@@ -6,6 +6,9 @@
 #include "node_errors.h"
 #include "uv.h"
 
+#include <algorithm>
+#include <bit>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -16,11 +19,13 @@ using v8::Array;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Global;
 using v8::Int32;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
 using v8::Object;
+using v8::String;
 using v8::Uint32;
 using v8::Value;
 
@@ -113,6 +118,62 @@ SocketAddress SocketAddress::FromPeerName(const uv_udp_t& handle) {
   return FromUVHandle(uv_udp_getpeername, handle);
 }
 
+SocketAddressStringCache::SocketAddressStringCache() : lru_(kMaxSize) {}
+
+MaybeLocal<String> SocketAddressStringCache::Get(Environment* env,
+                                                 const sockaddr* addr) {
+  Isolate* isolate = env->isolate();
+  SocketAddress key;
+  memset(key.storage(), 0, sizeof(sockaddr_storage));
+  if (addr->sa_family == AF_INET6) {
+    const sockaddr_in6* a6 = reinterpret_cast<const sockaddr_in6*>(addr);
+    sockaddr_in6* key6 = reinterpret_cast<sockaddr_in6*>(key.storage());
+    key6->sin6_family = AF_INET6;
+    key6->sin6_addr = a6->sin6_addr;
+    key6->sin6_scope_id = a6->sin6_scope_id;
+  } else {
+    CHECK_EQ(addr->sa_family, AF_INET);
+    sockaddr_in* key4 = reinterpret_cast<sockaddr_in*>(key.storage());
+    key4->sin_family = AF_INET;
+    key4->sin_addr = reinterpret_cast<const sockaddr_in*>(addr)->sin_addr;
+  }
+
+  Global<String>* cached = lru_.Upsert(key);
+  if (!cached->IsEmpty()) return cached->Get(isolate);
+
+  char ip[INET6_ADDRSTRLEN + UV_IF_NAMESIZE];
+  if (addr->sa_family == AF_INET6) {
+    const sockaddr_in6* a6 = reinterpret_cast<const sockaddr_in6*>(addr);
+    uv_inet_ntop(AF_INET6, &a6->sin6_addr, ip, sizeof ip);
+    // Add an interface identifier to a link local address.
+    if (IN6_IS_ADDR_LINKLOCAL(&a6->sin6_addr) && a6->sin6_scope_id > 0) {
+      const size_t addrlen = strlen(ip);
+      CHECK_LT(addrlen, sizeof(ip));
+      ip[addrlen] = '%';
+      size_t scopeidlen = sizeof(ip) - addrlen - 1;
+      CHECK_GE(scopeidlen, UV_IF_NAMESIZE);
+      const int r = uv_if_indextoiid(a6->sin6_scope_id,
+                                     ip + addrlen + 1,
+                                     &scopeidlen);
+      if (r) {
+        env->ThrowUVException(r, "uv_if_indextoiid");
+        return {};
+      }
+    }
+  } else {
+    const sockaddr_in* a4 = reinterpret_cast<const sockaddr_in*>(addr);
+    uv_inet_ntop(AF_INET, &a4->sin_addr, ip, sizeof ip);
+  }
+
+  Local<String> address = OneByteString(isolate, ip);
+  cached->Reset(isolate, address);
+  return address;
+}
+
+void SocketAddressStringCache::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackField("lru", lru_);
+}
+
 namespace {
 constexpr uint8_t mask[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
 
@@ -390,6 +451,179 @@ bool SocketAddress::is_in_network(
   return false;
 }
 
+namespace {
+using PrefixKey = SocketAddressBlockList::PrefixIndex::Key;
+
+constexpr uint64_t kAllOnes = std::numeric_limits<uint64_t>::max();
+// ::ffff:0:0/96
+constexpr PrefixKey kIPv4MappedPrefix = {0, uint64_t{0xffff} << 32};
+constexpr int kIPv4MappedPrefixLength = 96;
+
+int GetBit(const PrefixKey& key, int index) {
+  return (key[index / 64] >> (63 - index % 64)) & 1;
+}
+
+// Clears all but the first `length` bits.
+PrefixKey FirstKey(const PrefixKey& key, int length) {
+  PrefixKey ret = key;
+  for (int i = 0; i < 2; i++) {
+    int bits = std::clamp(length - 64 * i, 0, 64);
+    ret[i] &= bits == 0 ? 0 : kAllOnes << (64 - bits);
+  }
+  return ret;
+}
+
+// Sets all but the first `length` bits.
+PrefixKey LastKey(const PrefixKey& key, int length) {
+  PrefixKey ret = key;
+  for (int i = 0; i < 2; i++) {
+    int bits = std::clamp(length - 64 * i, 0, 64);
+    ret[i] |= bits == 64 ? 0 : kAllOnes >> bits;
+  }
+  return ret;
+}
+
+// The number of leading bits that `a` and `b` share, up to `limit`.
+int CommonPrefixLength(const PrefixKey& a, const PrefixKey& b, int limit) {
+  int length = 0;
+  for (int i = 0; i < 2 && length == 64 * i; i++)
+    length += std::countl_zero(a[i] ^ b[i]);
+  return std::min(length, limit);
+}
+
+bool IsIPv4Mapped(const PrefixKey& key) {
+  return FirstKey(key, kIPv4MappedPrefixLength) == kIPv4MappedPrefix;
+}
+}  // namespace
+
+SocketAddressBlockList::PrefixIndex::PrefixIndex() {
+  NewNode({0, 0}, 0, false);
+}
+
+bool SocketAddressBlockList::PrefixIndex::ToKey(
+    const SocketAddress& address,
+    Key* key) {
+  switch (address.family()) {
+    case AF_INET: {
+      const sockaddr_in* in =
+          reinterpret_cast<const sockaddr_in*>(address.data());
+      *key = kIPv4MappedPrefix;
+      (*key)[1] |= ntohl(in->sin_addr.s_addr);
+      return true;
+    }
+    case AF_INET6: {
+      const sockaddr_in6* in =
+          reinterpret_cast<const sockaddr_in6*>(address.data());
+      const uint8_t* ptr = in->sin6_addr.s6_addr;
+      for (int i = 0; i < 2; i++, ptr += 8) {
+        (*key)[i] = (uint64_t{ReadUint32BE(ptr)} << 32) |
+                    ReadUint32BE(ptr + 4);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t SocketAddressBlockList::PrefixIndex::NewNode(
+    const Key& bits,
+    int length,
+    bool terminal) {
+  CHECK_LT(nodes_.size(), std::numeric_limits<uint32_t>::max());
+  nodes_.push_back(
+      Node{bits, {0, 0}, static_cast<uint8_t>(length), terminal});
+  return nodes_.size() - 1;
+}
+
+void SocketAddressBlockList::PrefixIndex::Insert(const Key& key, int length) {
+  CHECK(length >= 0 && length <= kKeyBits);
+  Key bits = FirstKey(key, length);
+  uint32_t index = 0;
+  while (true) {
+    // The prefix of nodes_[index] is a prefix of `bits`.
+    if (nodes_[index].terminal)
+      return;
+    if (nodes_[index].length == length) {
+      // Whatever is below is covered now. The nodes stay in `nodes_`, but
+      // are not reachable anymore.
+      nodes_[index].terminal = true;
+      nodes_[index].children[0] = nodes_[index].children[1] = 0;
+      return;
+    }
+
+    int bit = GetBit(bits, nodes_[index].length);
+    uint32_t child = nodes_[index].children[bit];
+    if (child == 0) {
+      uint32_t leaf = NewNode(bits, length, true);
+      nodes_[index].children[bit] = leaf;
+      return;
+    }
+
+    int common = CommonPrefixLength(
+        bits, nodes_[child].bits, std::min<int>(length, nodes_[child].length));
+    if (common == nodes_[child].length) {
+      index = child;
+      continue;
+    }
+
+    // Split the edge to `child` where `bits` branches off, unless `bits`
+    // ends there and covers `child` completely.
+    uint32_t split = NewNode(FirstKey(bits, common), common, common == length);
+    if (common != length) {
+      nodes_[split].children[GetBit(nodes_[child].bits, common)] = child;
+      uint32_t leaf = NewNode(bits, length, true);
+      nodes_[split].children[GetBit(bits, common)] = leaf;
+    }
+    nodes_[index].children[bit] = split;
+    return;
+  }
+}
+
+void SocketAddressBlockList::PrefixIndex::InsertRange(const Key& start,
+                                                      const Key& end) {
+  if (end < start)
+    return;
+  InsertRange(start, end, {0, 0}, 0);
+}
+
+void SocketAddressBlockList::PrefixIndex::InsertRange(const Key& start,
+                                                      const Key& end,
+                                                      const Key& bits,
+                                                      int length) {
+  Key last = LastKey(bits, length);
+  if (last < start || end < bits)
+    return;
+  if (!(bits < start) && !(end < last))
+    return Insert(bits, length);
+
+  // The range covers part of the prefix, so it cannot be a /128.
+  Key upper = bits;
+  upper[length / 64] |= uint64_t{1} << (63 - length % 64);
+  InsertRange(start, end, bits, length + 1);
+  InsertRange(start, end, upper, length + 1);
+}
+
+bool SocketAddressBlockList::PrefixIndex::Contains(const Key& key) const {
+  uint32_t index = 0;
+  while (true) {
+    const Node& node = nodes_[index];
+    if (CommonPrefixLength(key, node.bits, node.length) != node.length)
+      return false;
+    if (node.terminal)
+      return true;
+    if (node.length == kKeyBits)
+      return false;
+    index = node.children[GetBit(key, node.length)];
+    if (index == 0)
+      return false;
+  }
+}
+
+void SocketAddressBlockList::PrefixIndex::MemoryInfo(
+    node::MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("nodes", nodes_.capacity() * sizeof(Node));
+}
+
 SocketAddressBlockList::SocketAddressBlockList(
     std::shared_ptr<SocketAddressBlockList> parent)
     : parent_(parent) {}
@@ -401,6 +635,7 @@ void SocketAddressBlockList::AddSocketAddress(
       std::make_unique<SocketAddressRule>(address);
   rules_.emplace_front(std::move(rule));
   address_rules_[*address.get()] = rules_.begin();
+  AddToIndex(rules_.front().get());
 }
 
 void SocketAddressBlockList::RemoveSocketAddress(
@@ -410,6 +645,7 @@ void SocketAddressBlockList::RemoveSocketAddress(
   if (it != std::end(address_rules_)) {
     rules_.erase(it->second);
     address_rules_.erase(it);
+    index_stale_ = true;
   }
 }
 
@@ -420,6 +656,7 @@ void SocketAddressBlockList::AddSocketAddressRange(
   std::unique_ptr<Rule> rule =
       std::make_unique<SocketAddressRangeRule>(start, end);
   rules_.emplace_front(std::move(rule));
+  AddToIndex(rules_.front().get());
 }
 
 void SocketAddressBlockList::AddSocketAddressMask(
@@ -429,18 +666,49 @@ void SocketAddressBlockList::AddSocketAddressMask(
   std::unique_ptr<Rule> rule =
       std::make_unique<SocketAddressMaskRule>(network, prefix);
   rules_.emplace_front(std::move(rule));
+  AddToIndex(rules_.front().get());
 }
 
 bool SocketAddressBlockList::Apply(
     const std::shared_ptr<SocketAddress>& address) {
   Mutex::ScopedLock lock(mutex_);
-  for (const auto& rule : rules_) {
-    if (rule->Apply(address))
+  if (index_) {
+    if (index_stale_)
+      BuildIndex();
+    PrefixIndex::Key key;
+    if (PrefixIndex::ToKey(*address.get(), &key) && index_->Contains(key))
       return true;
+    for (Rule* rule : unindexed_rules_) {
+      if (rule->Apply(address))
+        return true;
+    }
+  } else {
+    for (const auto& rule : rules_) {
+      if (rule->Apply(address))
+        return true;
+    }
   }
   return parent_ ? parent_->Apply(address) : false;
 }
 
+void SocketAddressBlockList::Compile() {
+  Mutex::ScopedLock lock(mutex_);
+  BuildIndex();
+}
+
+void SocketAddressBlockList::BuildIndex() {
+  index_ = std::make_unique<PrefixIndex>();
+  unindexed_rules_.clear();
+  index_stale_ = false;
+  for (const auto& rule : rules_)
+    AddToIndex(rule.get());
+}
+
+void SocketAddressBlockList::AddToIndex(Rule* rule) {
+  if (index_ && !index_stale_ && !rule->AddToIndex(index_.get()))
+    unindexed_rules_.push_back(rule);
+}
+
 SocketAddressBlockList::SocketAddressRule::SocketAddressRule(
     const std::shared_ptr<SocketAddress>& address_)
     : address(address_) {}
@@ -462,6 +730,15 @@ bool SocketAddressBlockList::SocketAddressRule::Apply(
   return this->address->is_match(*address.get());
 }
 
+bool SocketAddressBlockList::SocketAddressRule::AddToIndex(
+    PrefixIndex* index) {
+  PrefixIndex::Key key;
+  if (!PrefixIndex::ToKey(*address.get(), &key))
+    return false;
+  index->Insert(key, PrefixIndex::kKeyBits);
+  return true;
+}
+
 std::string SocketAddressBlockList::SocketAddressRule::ToString() {
   std::string ret = "Address: ";
   ret += address->family() == AF_INET ? "IPv4" : "IPv6";
@@ -476,6 +753,27 @@ bool SocketAddressBlockList::SocketAddressRangeRule::Apply(
          *address.get() <= *end.get();
 }
 
+bool SocketAddressBlockList::SocketAddressRangeRule::AddToIndex(
+    PrefixIndex* index) {
+  PrefixIndex::Key first;
+  PrefixIndex::Key last;
+  if (start->family() != end->family() ||
+      !PrefixIndex::ToKey(*start.get(), &first) ||
+      !PrefixIndex::ToKey(*end.get(), &last)) {
+    return false;
+  }
+  // IPv4 addresses are only comparable with IPv6 addresses in ::ffff:0:0/96,
+  // so they never fall into an IPv6 range that reaches outside of it.
+  if (start->family() == AF_INET6 &&
+      !(last < kIPv4MappedPrefix) &&
+      !(LastKey(kIPv4MappedPrefix, kIPv4MappedPrefixLength) < first) &&
+      !(IsIPv4Mapped(first) && IsIPv4Mapped(last))) {
+    return false;
+  }
+  index->InsertRange(first, last);
+  return true;
+}
+
 std::string SocketAddressBlockList::SocketAddressRangeRule::ToString() {
   std::string ret = "Range: ";
   ret += start->family() == AF_INET ? "IPv4" : "IPv6";
@@ -491,6 +789,20 @@ bool SocketAddressBlockList::SocketAddressMaskRule::Apply(
   return address->is_in_network(*network.get(), prefix);
 }
 
+bool SocketAddressBlockList::SocketAddressMaskRule::AddToIndex(
+    PrefixIndex* index) {
+  PrefixIndex::Key key;
+  if (!PrefixIndex::ToKey(*network.get(), &key))
+    return false;
+  int length = prefix;
+  if (network->family() == AF_INET)
+    length += kIPv4MappedPrefixLength;
+  if (prefix < 0 || length > PrefixIndex::kKeyBits)
+    return false;
+  index->Insert(key, length);
+  return true;
+}
+
 std::string SocketAddressBlockList::SocketAddressMaskRule::ToString() {
   std::string ret = "Subnet: ";
   ret += network->family() == AF_INET ? "IPv4" : "IPv6";
@@ -524,6 +836,9 @@ bool SocketAddressBlockList::ListRules(
 
 void SocketAddressBlockList::MemoryInfo(node::MemoryTracker* tracker) const {
   tracker->TrackField("rules", rules_);
+  tracker->TrackField("index", index_);
+  tracker->TrackFieldWithSize("unindexed_rules",
+                              unindexed_rules_.capacity() * sizeof(Rule*));
 }
 
 void SocketAddressBlockList::SocketAddressRule::MemoryInfo(
@@ -669,6 +984,13 @@ void SocketAddressBlockListWrap::Check(
   args.GetReturnValue().Set(wrap->blocklist_->Apply(addr->address()));
 }
 
+void SocketAddressBlockListWrap::Compile(
+    const FunctionCallbackInfo<Value>& args) {
+  SocketAddressBlockListWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  wrap->blocklist_->Compile();
+}
+
 void SocketAddressBlockListWrap::GetRules(
     const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -706,6 +1028,7 @@ Local<FunctionTemplate> SocketAddressBlockListWrap::GetConstructorTemplate(
     SetProtoMethod(isolate, tmpl, "addRange", AddRange);
     SetProtoMethod(isolate, tmpl, "addSubnet", AddSubnet);
     SetProtoMethod(isolate, tmpl, "check", Check);
+    SetProtoMethod(isolate, tmpl, "compile", Compile);
     SetProtoMethod(isolate, tmpl, "getRules", GetRules);
     env->set_blocklist_constructor_template(tmpl);
   }
@@ -11,10 +11,12 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <array>
 #include <memory>
 #include <string>
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 namespace node {
 
@@ -241,6 +243,37 @@ class SocketAddressLRU : public MemoryRetainer {
   size_t max_size_;
 };
 
+// The strings of the IP addresses of the most recently seen peers, so that
+// AddressToJS() does not format the address of a peer that many packets or
+// connections come from again for each of them. The port is not part of the
+// key, while the scope of an IPv6 address is, as the name of its interface
+// is appended to link-local addresses.
+class SocketAddressStringCache final : public MemoryRetainer {
+ public:
+  static constexpr size_t kMaxSize = 1024;
+
+  SocketAddressStringCache();
+
+  // Returns the IP address of |addr|, which must be an IPv4 or IPv6 address.
+  v8::MaybeLocal<v8::String> Get(Environment* env, const sockaddr* addr);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(SocketAddressStringCache)
+  SET_SELF_SIZE(SocketAddressStringCache)
+
+ private:
+  struct Traits final {
+    using Type = v8::Global<v8::String>;
+
+    static bool CheckExpired(const SocketAddress& address, const Type& type) {
+      return false;
+    }
+    static void Touch(const SocketAddress& address, Type* type) {}
+  };
+
+  SocketAddressLRU<Traits> lru_;
+};
+
 // A BlockList is used to evaluate whether a given
 // SocketAddress should be accepted for inbound or
 // outbound network activity.
@@ -264,12 +297,69 @@ class SocketAddressBlockList : public MemoryRetainer {
 
   bool Apply(const std::shared_ptr<SocketAddress>& address);
 
+  // Switches to the compiled mode, in which Apply() looks addresses up in a
+  // prefix trie of the rules instead of checking rule by rule. Rules that
+  // are added later go into the trie right away; after a rule has been
+  // removed, the trie is rebuilt by the next Apply().
+  void Compile();
+  bool is_compiled() const { return index_ != nullptr; }
+
   size_t size() const { return rules_.size(); }
 
   v8::MaybeLocal<v8::Array> ListRules(Environment* env);
 
+  // A path-compressed binary trie (PATRICIA trie) of network prefixes, keyed
+  // by 128-bit addresses. IPv4 addresses are mapped into ::ffff:0:0/96,
+  // which is how the rules already compare IPv4 with IPv6 addresses. A
+  // lookup takes at most one step per bit of the longest prefix, and stops
+  // at the first prefix that matches.
+  class PrefixIndex final : public MemoryRetainer {
+   public:
+    // The most significant 64 bits first.
+    using Key = std::array<uint64_t, 2>;
+    static constexpr int kKeyBits = 128;
+
+    PrefixIndex();
+
+    // Returns false if `address` is neither IPv4 nor IPv6.
+    static bool ToKey(const SocketAddress& address, Key* key);
+
+    void Insert(const Key& key, int length);
+    // Inserts the smallest set of prefixes that covers start...end.
+    void InsertRange(const Key& start, const Key& end);
+    bool Contains(const Key& key) const;
+
+    size_t node_count() const { return nodes_.size(); }
+
+    void MemoryInfo(node::MemoryTracker* tracker) const override;
+    SET_MEMORY_INFO_NAME(SocketAddressBlockList::PrefixIndex)
+    SET_SELF_SIZE(PrefixIndex)
+
+   private:
+    struct Node {
+      Key bits;
+      // Indexes into `nodes_`. 0 is the root, which is nobody's child, so it
+      // doubles as "no child".
+      uint32_t children[2];
+      uint8_t length;
+      bool terminal;
+    };
+
+    uint32_t NewNode(const Key& bits, int length, bool terminal);
+    void InsertRange(const Key& start,
+                     const Key& end,
+                     const Key& bits,
+                     int length);
+
+    std::vector<Node> nodes_;
+  };
+
   struct Rule : public MemoryRetainer {
     virtual bool Apply(const std::shared_ptr<SocketAddress>& address) = 0;
+    // Adds the addresses that the rule matches to `index`. Returns false if
+    // the rule matches differently than a set of prefixes would, in which
+    // case the compiled mode still calls Apply().
+    virtual bool AddToIndex(PrefixIndex* index) = 0;
     inline v8::MaybeLocal<v8::Value> ToV8String(Environment* env);
     virtual std::string ToString() = 0;
   };
@@ -280,6 +370,7 @@ class SocketAddressBlockList : public MemoryRetainer {
     explicit SocketAddressRule(const std::shared_ptr<SocketAddress>& address);
 
     bool Apply(const std::shared_ptr<SocketAddress>& address) override;
+    bool AddToIndex(PrefixIndex* index) override;
     std::string ToString() override;
 
     void MemoryInfo(node::MemoryTracker* tracker) const override;
@@ -296,6 +387,7 @@ class SocketAddressBlockList : public MemoryRetainer {
         const std::shared_ptr<SocketAddress>& end);
 
     bool Apply(const std::shared_ptr<SocketAddress>& address) override;
+    bool AddToIndex(PrefixIndex* index) override;
     std::string ToString() override;
 
     void MemoryInfo(node::MemoryTracker* tracker) const override;
@@ -312,6 +404,7 @@ class SocketAddressBlockList : public MemoryRetainer {
         int prefix);
 
     bool Apply(const std::shared_ptr<SocketAddress>& address) override;
+    bool AddToIndex(PrefixIndex* index) override;
     std::string ToString() override;
 
     void MemoryInfo(node::MemoryTracker* tracker) const override;
@@ -328,10 +421,20 @@ class SocketAddressBlockList : public MemoryRetainer {
       Environment* env,
       std::vector<v8::Local<v8::Value>>* vec);
 
+  // The caller must hold `mutex_`.
+  void BuildIndex();
+  void AddToIndex(Rule* rule);
+
   std::shared_ptr<SocketAddressBlockList> parent_;
   std::list<std::unique_ptr<Rule>> rules_;
   SocketAddress::Map<std::list<std::unique_ptr<Rule>>::iterator> address_rules_;
 
+  // Set in the compiled mode.
+  std::unique_ptr<PrefixIndex> index_;
+  // The rules that are not in `index_`.
+  std::vector<Rule*> unindexed_rules_;
+  bool index_stale_ = false;
+
   Mutex mutex_;
 };
 
@@ -355,6 +458,7 @@ class SocketAddressBlockListWrap : public BaseObject {
   static void AddRange(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void AddSubnet(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Check(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Compile(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetRules(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   SocketAddressBlockListWrap(
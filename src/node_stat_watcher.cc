@@ -26,10 +26,14 @@
 #include "node_external_reference.h"
 #include "node_file-inl.h"
 #include "permission/permission.h"
+#include "threadpoolwork-inl.h"
 #include "util-inl.h"
 
-#include <cstring>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace node {
 
@@ -69,30 +73,80 @@ StatWatcher::StatWatcher(fs::BindingData* binding_data,
                          bool use_bigint)
     : HandleWrap(binding_data->env(),
                  wrap,
-                 reinterpret_cast<uv_handle_t*>(&watcher_),
+                 reinterpret_cast<uv_handle_t*>(&handle_),
                  AsyncWrap::PROVIDER_STATWATCHER),
       use_bigint_(use_bigint),
       binding_data_(binding_data) {
-  CHECK_EQ(0, uv_fs_poll_init(env()->event_loop(), &watcher_));
+  CHECK_EQ(0,
+           uv_async_init(env()->event_loop(), &handle_, [](uv_async_t*) {}));
+}
+
+void StatWatcher::Close(Local<Value> close_callback) {
+  if (state_ != kInitialized) return;
+  // Every watcher that was started is either waiting in the queue of the
+  // poller or being polled.
+  if (queued_ || polling_) binding_data_->stat_poller->Remove(this);
+  HandleWrap::Close(close_callback);
+}
+
+namespace {
+
+// The fields that uv_fs_poll_t compares, which leave out st_atim so that
+// reading the file is not a change.
+bool StatsEqual(const uv_stat_t& a, const uv_stat_t& b) {
+  return a.st_ctim.tv_nsec == b.st_ctim.tv_nsec &&
+         a.st_mtim.tv_nsec == b.st_mtim.tv_nsec &&
+         a.st_birthtim.tv_nsec == b.st_birthtim.tv_nsec &&
+         a.st_ctim.tv_sec == b.st_ctim.tv_sec &&
+         a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+         a.st_birthtim.tv_sec == b.st_birthtim.tv_sec &&
+         a.st_size == b.st_size && a.st_mode == b.st_mode &&
+         a.st_uid == b.st_uid && a.st_gid == b.st_gid &&
+         a.st_ino == b.st_ino && a.st_dev == b.st_dev &&
+         a.st_flags == b.st_flags && a.st_gen == b.st_gen;
 }
 
+}  // anonymous namespace
+
+void StatWatcher::OnStat(int status, const uv_stat_t& statbuf) {
+  bool changed = false;
+  if (status != 0) {
+    if (last_result_ != status) {
+      changed = true;
+      last_result_ = status;
+      uv_stat_t zero_statbuf{};
+      Callback(status, &statbuf_, &zero_statbuf);
+    }
+  } else {
+    if (last_result_ < 0 ||
+        (last_result_ != 0 && !StatsEqual(statbuf_, statbuf))) {
+      changed = true;
+      Callback(0, &statbuf_, &statbuf);
+    }
+    statbuf_ = statbuf;
+    last_result_ = 1;
+  }
+
+  if (changed) {
+    current_interval_ = interval_;
+  } else {
+    current_interval_ = std::min(current_interval_ * 2, max_interval_);
+  }
+}
 
-void StatWatcher::Callback(uv_fs_poll_t* handle,
-                           int status,
+void StatWatcher::Callback(int status,
                            const uv_stat_t* prev,
                            const uv_stat_t* curr) {
-  StatWatcher* wrap = ContainerOf(&StatWatcher::watcher_, handle);
-  Environment* env = wrap->env();
+  Environment* env = this->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
-  Local<Value> arr = fs::FillGlobalStatsArray(
-      wrap->binding_data_.get(), wrap->use_bigint_, curr);
-  USE(fs::FillGlobalStatsArray(
-      wrap->binding_data_.get(), wrap->use_bigint_, prev, true));
+  Local<Value> arr =
+      fs::FillGlobalStatsArray(binding_data_.get(), use_bigint_, curr);
+  USE(fs::FillGlobalStatsArray(binding_data_.get(), use_bigint_, prev, true));
 
   Local<Value> argv[2] = { Integer::New(env->isolate(), status), arr };
-  wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
 }
 
 
@@ -102,13 +156,16 @@ void StatWatcher::New(const FunctionCallbackInfo<Value>& args) {
   new StatWatcher(binding_data, args.This(), args[0]->IsTrue());
 }
 
-// wrap.start(filename, interval)
+// wrap.start(filename, interval[, maxInterval])
+//
+// With maxInterval, the interval doubles after every poll that finds no
+// change, up to maxInterval, and goes back to interval after a change.
 void StatWatcher::Start(const FunctionCallbackInfo<Value>& args) {
-  CHECK_EQ(args.Length(), 2);
+  CHECK_GE(args.Length(), 2);
 
   StatWatcher* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
-  CHECK(!uv_is_active(wrap->GetHandle()));
+  CHECK(!wrap->queued_ && !wrap->polling_);
 
   node::Utf8Value path(args.GetIsolate(), args[0]);
   CHECK_NOT_NULL(*path);
@@ -118,14 +175,160 @@ void StatWatcher::Start(const FunctionCallbackInfo<Value>& args) {
       path.ToStringView());
 
   CHECK(args[1]->IsUint32());
-  const uint32_t interval = args[1].As<Uint32>()->Value();
+  wrap->path_ = path.ToString();
+  wrap->interval_ = std::max(args[1].As<Uint32>()->Value(), 1u);
+  wrap->max_interval_ = wrap->interval_;
+  if (args.Length() > 2 && args[2]->IsUint32()) {
+    wrap->max_interval_ = std::max<uint64_t>(args[2].As<Uint32>()->Value(),
+                                             wrap->interval_);
+  }
+  wrap->current_interval_ = wrap->interval_;
+
+  StatPoller::Get(wrap->binding_data_.get())->Add(wrap);
+}
+
+class StatPoller::PollWork final : public ThreadPoolWork {
+ public:
+  PollWork(StatPoller* poller,
+           std::vector<BaseObjectPtr<StatWatcher>>&& watchers)
+      : ThreadPoolWork(poller->env_, "statwatcher", ThreadPoolWorkKind::kFs),
+        poller_(poller),
+        watchers_(std::move(watchers)),
+        stats_(watchers_.size()),
+        results_(watchers_.size()) {
+    paths_.reserve(watchers_.size());
+    for (const auto& watcher : watchers_) paths_.push_back(watcher->path_);
+  }
+
+  void DoThreadPoolWork() override {
+    for (size_t i = 0; i < paths_.size(); i++) {
+      uv_fs_t req;
+      results_[i] = uv_fs_stat(nullptr, &req, paths_[i].c_str(), nullptr);
+      if (results_[i] == 0) stats_[i] = req.statbuf;
+      uv_fs_req_cleanup(&req);
+    }
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<PollWork> self(this);
+    Environment* env = this->env();
+    bool can_call_into_js = status == 0 && env->can_call_into_js();
+
+    for (size_t i = 0; i < watchers_.size(); i++) {
+      StatWatcher* watcher = watchers_[i].get();
+      if (can_call_into_js && !watcher->IsHandleClosing()) {
+        watcher->OnStat(results_[i], stats_[i]);
+      }
+      watcher->polling_ = false;
+      if (!watcher->IsHandleClosing()) {
+        uint64_t due = watcher->poll_start_ + watcher->current_interval_;
+        poller_->Enqueue(watcher, std::max(due, uv_now(env->event_loop())));
+      }
+    }
+    poller_->OnPollDone();
+  }
+
+ private:
+  StatPoller* poller_;
+  std::vector<BaseObjectPtr<StatWatcher>> watchers_;
+  std::vector<std::string> paths_;
+  std::vector<uv_stat_t> stats_;
+  std::vector<int> results_;
+};
 
-  // Note that uv_fs_poll_start does not return ENOENT, we are handling
-  // mostly memory errors here.
-  const int err = uv_fs_poll_start(&wrap->watcher_, Callback, *path, interval);
-  if (err != 0) {
-    args.GetReturnValue().Set(err);
+StatPoller* StatPoller::Get(fs::BindingData* binding_data) {
+  if (binding_data->stat_poller == nullptr) {
+    binding_data->stat_poller = new StatPoller(binding_data);
   }
+  return binding_data->stat_poller;
+}
+
+StatPoller::StatPoller(fs::BindingData* binding_data)
+    : binding_data_(binding_data),
+      env_(binding_data->env()),
+      timer_(new uv_timer_t()) {
+  CHECK_EQ(uv_timer_init(env_->event_loop(), timer_), 0);
+  timer_->data = this;
+  // The watchers keep the loop alive, or not.
+  uv_unref(reinterpret_cast<uv_handle_t*>(timer_));
+}
+
+void StatPoller::Add(StatWatcher* watcher) {
+  watchers_++;
+  // The first poll is right away, like that of uv_fs_poll_t, but still in a
+  // batch with the watchers that are started in the same tick.
+  Enqueue(watcher, uv_now(env_->event_loop()));
+  Schedule();
+}
+
+void StatPoller::Remove(StatWatcher* watcher) {
+  Dequeue(watcher);
+  CHECK_GT(watchers_, 0);
+  watchers_--;
+  MaybeDelete();
+}
+
+void StatPoller::Enqueue(StatWatcher* watcher, uint64_t due) {
+  CHECK(!watcher->queued_);
+  watcher->due_ = queue_.emplace(due, watcher);
+  watcher->queued_ = true;
+}
+
+void StatPoller::Dequeue(StatWatcher* watcher) {
+  if (!watcher->queued_) return;
+  queue_.erase(watcher->due_);
+  watcher->queued_ = false;
+}
+
+void StatPoller::OnTimer(uv_timer_t* timer) {
+  static_cast<StatPoller*>(timer->data)->Poll();
+}
+
+void StatPoller::Poll() {
+  uint64_t now = uv_now(env_->event_loop());
+  std::vector<BaseObjectPtr<StatWatcher>> chunk;
+  auto dispatch = [&]() {
+    pending_polls_++;
+    (new PollWork(this, std::move(chunk)))->ScheduleWork();
+    chunk.clear();
+  };
+
+  while (!queue_.empty() && queue_.begin()->first <= now + kSlackMs) {
+    StatWatcher* watcher = queue_.begin()->second;
+    Dequeue(watcher);
+    watcher->polling_ = true;
+    watcher->poll_start_ = now;
+    chunk.emplace_back(watcher);
+    if (chunk.size() == kChunkSize) dispatch();
+  }
+  if (!chunk.empty()) dispatch();
+
+  Schedule();
+}
+
+void StatPoller::Schedule() {
+  if (queue_.empty()) {
+    uv_timer_stop(timer_);
+    return;
+  }
+  uint64_t due = queue_.begin()->first;
+  uint64_t now = uv_now(env_->event_loop());
+  CHECK_EQ(uv_timer_start(timer_, OnTimer, due > now ? due - now : 0, 0), 0);
+}
+
+void StatPoller::OnPollDone() {
+  CHECK_GT(pending_polls_, 0);
+  pending_polls_--;
+  Schedule();
+  MaybeDelete();
+}
+
+void StatPoller::MaybeDelete() {
+  if (watchers_ > 0 || pending_polls_ > 0) return;
+  CHECK(queue_.empty());
+  binding_data_->stat_poller = nullptr;
+  env_->CloseHandle(timer_, [](uv_timer_t* timer) { delete timer; });
+  delete this;
 }
 
 }  // namespace node
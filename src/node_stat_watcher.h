@@ -29,6 +29,9 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <map>
+#include <string>
+
 namespace node {
 namespace fs {
 class BindingData;
@@ -36,13 +39,27 @@ class BindingData;
 
 class Environment;
 class ExternalReferenceRegistry;
+class StatPoller;
 
+// A StatWatcher polls one path with stat() and calls onchange whenever the
+// result changes, like uv_fs_poll_t but without a timer and a threadpool
+// request for each watcher: the StatPoller of the realm keeps all of them in
+// one queue ordered by the time they are next due, and stats the paths that
+// are due together in chunks on the threadpool.
+//
+// The handle of the wrap is a uv_async_t that is never sent. It only keeps
+// the loop alive while the watcher is referenced, and costs no file
+// descriptor or timer of its own.
 class StatWatcher : public HandleWrap {
  public:
   static void CreatePerIsolateProperties(IsolateData* isolate_data,
                                          v8::Local<v8::ObjectTemplate> ctor);
   static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
 
+  using HandleWrap::Close;
+  void Close(v8::Local<v8::Value> close_callback = v8::Local<v8::Value>())
+      override;
+
  protected:
   StatWatcher(fs::BindingData* binding_data,
               v8::Local<v8::Object> wrap,
@@ -56,14 +73,68 @@ class StatWatcher : public HandleWrap {
   SET_SELF_SIZE(StatWatcher)
 
  private:
-  static void Callback(uv_fs_poll_t* handle,
-                       int status,
-                       const uv_stat_t* prev,
-                       const uv_stat_t* curr);
+  friend class StatPoller;
+
+  // Called with the result of a poll, with the same semantics as the
+  // callback of uv_fs_poll_t.
+  void OnStat(int status, const uv_stat_t& statbuf);
+  void Callback(int status, const uv_stat_t* prev, const uv_stat_t* curr);
 
-  uv_fs_poll_t watcher_;
+  uv_async_t handle_;
   const bool use_bigint_;
   BaseObjectPtr<fs::BindingData> binding_data_;
+
+  std::string path_;
+  uint64_t interval_ = 0;
+  // Without a change, the interval doubles after every poll, up to this.
+  uint64_t max_interval_ = 0;
+  uint64_t current_interval_ = 0;
+  // Like uv_fs_poll_t: 0 before the first poll, 1 after a successful one,
+  // or the error of the last one.
+  int last_result_ = 0;
+  uv_stat_t statbuf_{};
+
+  bool polling_ = false;
+  uint64_t poll_start_ = 0;
+  std::multimap<uint64_t, StatWatcher*>::iterator due_;
+  bool queued_ = false;
+};
+
+class StatPoller {
+ public:
+  // The paths that one threadpool job stats.
+  static constexpr size_t kChunkSize = 128;
+  // Watchers that are due this soon after the timer fires are polled
+  // together with those that are due already.
+  static constexpr uint64_t kSlackMs = 10;
+
+  // Returns the poller of the realm of `binding_data`, which is created on
+  // demand and deletes itself once no watcher uses it.
+  static StatPoller* Get(fs::BindingData* binding_data);
+
+  void Add(StatWatcher* watcher);
+  void Remove(StatWatcher* watcher);
+
+ private:
+  class PollWork;
+
+  explicit StatPoller(fs::BindingData* binding_data);
+
+  static void OnTimer(uv_timer_t* timer);
+  void Enqueue(StatWatcher* watcher, uint64_t due);
+  void Dequeue(StatWatcher* watcher);
+  // Stats everything that is due, then arms the timer for what is left.
+  void Poll();
+  void Schedule();
+  void OnPollDone();
+  void MaybeDelete();
+
+  fs::BindingData* binding_data_;
+  Environment* env_;
+  uv_timer_t* timer_;
+  std::multimap<uint64_t, StatWatcher*> queue_;
+  size_t watchers_ = 0;
+  size_t pending_polls_ = 0;
 };
 
 }  // namespace node
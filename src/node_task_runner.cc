@@ -1,8 +1,11 @@
 #include "node_task_runner.h"
+#include "compile_cache.h"
 #include "util.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <regex>  // NOLINT(build/c++11)
+#include <unordered_map>
 
 namespace node::task_runner {
 
@@ -12,11 +15,269 @@ static constexpr const char* bin_path = "\\node_modules\\.bin";
 static constexpr const char* bin_path = "/node_modules/.bin";
 #endif  // _WIN32
 
+
+#ifdef _WIN32
+static constexpr char path_separator = ';';
+#else
+static constexpr char path_separator = ':';
+#endif  // _WIN32
+
+const std::string* PackageJson::FindScript(std::string_view name) const {
+  for (const auto& [script_name, command] : scripts) {
+    if (script_name == name) return &command;
+  }
+  return nullptr;
+}
+
+std::optional<PackageJson> ReadPackageJson(const std::string& path,
+                                           std::string* error) {
+  std::string raw_json;
+
+  // No need to exclude BOM since simdjson will skip it.
+  if (ReadFileSync(&raw_json, path.c_str()) < 0) {
+    *error = "Can't read " + path;
+    return std::nullopt;
+  }
+
+  simdjson::ondemand::parser json_parser;
+  simdjson::ondemand::document document;
+  simdjson::ondemand::object main_object;
+  simdjson::error_code json_error =
+      json_parser.iterate(raw_json).get(document);
+
+  // If document is not an object, throw an error.
+  if (json_error || document.get_object().get(main_object)) {
+    *error = "Can't parse " + path;
+    return std::nullopt;
+  }
+
+  PackageJson package_json;
+  bool has_scripts = false;
+  for (auto field : main_object) {
+    std::string_view key;
+    simdjson::ondemand::value value;
+    if (field.unescaped_key().get(key) || field.value().get(value)) {
+      *error = "Can't parse " + path;
+      return std::nullopt;
+    }
+
+    if (key == "scripts") {
+      simdjson::ondemand::object scripts_object;
+      if (value.get_object().get(scripts_object)) continue;
+      has_scripts = true;
+      for (auto script : scripts_object) {
+        std::string_view name;
+        std::string_view command;
+        simdjson::ondemand::value command_value;
+        if (!script.unescaped_key().get(name) &&
+            !script.value().get(command_value) &&
+            !command_value.get_string().get(command)) {
+          package_json.scripts.emplace_back(name, command);
+        }
+      }
+    } else if (key == "workspaces") {
+      // Either an array of patterns, or an object with such an array in
+      // its "packages" field, as Yarn allows.
+      simdjson::ondemand::array patterns;
+      simdjson::ondemand::object workspaces_object;
+      simdjson::ondemand::json_type type;
+      if (value.type().get(type)) continue;
+      if (type == simdjson::ondemand::json_type::object) {
+        if (value.get_object().get(workspaces_object) ||
+            workspaces_object["packages"].get_array().get(patterns)) {
+          continue;
+        }
+      } else if (value.get_array().get(patterns)) {
+        continue;
+      }
+      for (auto pattern : patterns) {
+        std::string_view pattern_str;
+        if (!pattern.get_string().get(pattern_str)) {
+          package_json.workspaces.emplace_back(pattern_str);
+        }
+      }
+    }
+  }
+
+  // If package_json object doesn't have "scripts" field, throw an error.
+  if (!has_scripts && package_json.workspaces.empty()) {
+    *error = "Can't find \"scripts\" field in " + path;
+    return std::nullopt;
+  }
+
+  return package_json;
+}
+
+// Layout of the cache file:
+// [uint32_t] kRunCacheMagic
+// [uint32_t] payload hash
+// .... payload ....
+// where the payload is a sequence of entries of
+// [uint32_t] path length, path
+// [uint64_t] file size
+// [int64_t] mtime seconds
+// [int64_t] mtime nanoseconds
+// [uint32_t] number of scripts, then the name and command of each
+// [uint32_t] number of workspaces, then each of them
+// with every string stored as its uint32_t length followed by its bytes.
+namespace {
+constexpr uint32_t kRunCacheMagic = 0x4e555243;  // "CRUN"
+constexpr const char* kRunCacheFilename = "node_run";
+
+struct RunCacheEntry {
+  uint64_t file_size;
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  PackageJson package_json;
+};
+
+using RunCache = std::unordered_map<std::string, RunCacheEntry>;
+
+RunCache ReadRunCache(const std::string& filename) {
+  RunCache cache;
+  std::string content;
+  if (ReadFileSync(&content, filename.c_str()) < 0) return cache;
+
+  CacheReader reader(content);
+  uint32_t magic;
+  uint32_t hash;
+  constexpr size_t kPayloadOffset = 2 * sizeof(uint32_t);
+  if (!reader.Read(&magic) || !reader.Read(&hash) || magic != kRunCacheMagic ||
+      GetHash(content.data() + kPayloadOffset,
+              content.size() - kPayloadOffset) != hash) {
+    return cache;
+  }
+
+  while (!reader.done()) {
+    std::string path;
+    RunCacheEntry entry;
+    uint32_t script_count;
+    uint32_t workspace_count;
+    bool ok = reader.Read(&path) && reader.Read(&entry.file_size) &&
+              reader.Read(&entry.mtime_sec) && reader.Read(&entry.mtime_nsec) &&
+              reader.Read(&script_count);
+    for (uint32_t i = 0; ok && i < script_count; i++) {
+      std::string name;
+      std::string command;
+      ok = reader.Read(&name) && reader.Read(&command);
+      entry.package_json.scripts.emplace_back(std::move(name),
+                                              std::move(command));
+    }
+    ok = ok && reader.Read(&workspace_count);
+    for (uint32_t i = 0; ok && i < workspace_count; i++) {
+      ok = reader.Read(&entry.package_json.workspaces.emplace_back());
+    }
+    if (!ok) return {};
+    cache.insert_or_assign(std::move(path), std::move(entry));
+  }
+  return cache;
+}
+
+void WriteRunCache(const std::string& filename, const RunCache& cache) {
+  std::string payload;
+  for (const auto& [path, entry] : cache) {
+    AppendString(&payload, path);
+    AppendValue(&payload, entry.file_size);
+    AppendValue(&payload, entry.mtime_sec);
+    AppendValue(&payload, entry.mtime_nsec);
+    AppendValue(&payload,
+                static_cast<uint32_t>(entry.package_json.scripts.size()));
+    for (const auto& [name, command] : entry.package_json.scripts) {
+      AppendString(&payload, name);
+      AppendString(&payload, command);
+    }
+    AppendValue(&payload,
+                static_cast<uint32_t>(entry.package_json.workspaces.size()));
+    for (const std::string& workspace : entry.package_json.workspaces) {
+      AppendString(&payload, workspace);
+    }
+  }
+  uint32_t headers[] = {kRunCacheMagic,
+                        GetHash(payload.data(), payload.size())};
+  uv_buf_t bufs[] = {
+      uv_buf_init(reinterpret_cast<char*>(headers), sizeof(headers)),
+      uv_buf_init(payload.data(), payload.size())};
+
+  // Scripts that run in parallel may update the cache at the same time, so
+  // it is replaced in one go rather than rewritten in place.
+  std::string tmp_filename =
+      filename + "." + std::to_string(uv_os_getpid()) + ".tmp";
+  if (WriteFileSync(tmp_filename.c_str(), bufs, arraysize(bufs)) < 0) return;
+  uv_fs_t req;
+  int err = uv_fs_rename(
+      nullptr, &req, tmp_filename.c_str(), filename.c_str(), nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err < 0) {
+    uv_fs_unlink(nullptr, &req, tmp_filename.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+}
+}  // anonymous namespace
+
+std::optional<PackageJson> ReadPackageJsonCached(const std::string& path,
+                                                 const std::string& cache_dir,
+                                                 std::string* error) {
+  std::error_code ec;
+  std::string absolute_path = std::filesystem::absolute(path, ec).string();
+  uv_fs_t req;
+  int err = uv_fs_stat(nullptr, &req, path.c_str(), nullptr);
+  uv_stat_t stat = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  if (ec || err < 0) return ReadPackageJson(path, error);
+
+  std::string filename =
+      (std::filesystem::path(cache_dir) / kRunCacheFilename).string();
+  RunCache cache = ReadRunCache(filename);
+  auto it = cache.find(absolute_path);
+  if (it != cache.end() && it->second.file_size == stat.st_size &&
+      it->second.mtime_sec == stat.st_mtim.tv_sec &&
+      it->second.mtime_nsec == stat.st_mtim.tv_nsec) {
+    return it->second.package_json;
+  }
+
+  std::optional<PackageJson> package_json = ReadPackageJson(path, error);
+  if (package_json.has_value()) {
+    cache.insert_or_assign(absolute_path,
+                           RunCacheEntry{stat.st_size,
+                                         stat.st_mtim.tv_sec,
+                                         stat.st_mtim.tv_nsec,
+                                         *package_json});
+    std::filesystem::create_directories(cache_dir, ec);
+    WriteRunCache(filename, cache);
+  }
+  return package_json;
+}
+
+RunEnvironment::RunEnvironment() {
+  uv_env_item_t* env_items;
+  int env_count;
+  CHECK_EQ(0, uv_os_environ(&env_items, &env_count));
+
+  for (int i = 0; i < env_count; i++) {
+#ifdef _WIN32
+    // We use comspec environment variable to find cmd.exe path on Windows
+    // Example: 'C:\\Windows\\system32\\cmd.exe'
+    // If we don't find it, we fallback to 'cmd.exe' for Windows
+    if (StringEqualNoCase(env_items[i].name, "comspec")) {
+      file = env_items[i].value;
+    }
+#endif  // _WIN32
+    variables.emplace_back(env_items[i].name, env_items[i].value);
+  }
+  uv_os_free_environ(env_items, env_count);
+}
+
 ProcessRunner::ProcessRunner(std::shared_ptr<InitializationResultImpl> result,
+                             const RunEnvironment& run_environment,
+                             std::string_view directory,
                              std::string_view package_json_path,
                              std::string_view script_name,
                              std::string_view command,
-                             const PositionalArgs& positional_args) {
+                             const PositionalArgs& positional_args,
+                             std::string_view prefix)
+    : init_result(std::move(result)),
+      prefix_(prefix),
+      file_(run_environment.file) {
   memset(&options_, 0, sizeof(uv_process_options_t));
 
   // Get the current working directory.
@@ -25,20 +286,41 @@ ProcessRunner::ProcessRunner(std::shared_ptr<InitializationResultImpl> result,
   CHECK_EQ(uv_cwd(cwd, &cwd_size), 0);
   CHECK_GT(cwd_size, 0);
 
-#ifdef _WIN32
-  std::string current_bin_path = cwd + std::string(bin_path) + ";";
-#else
-  std::string current_bin_path = cwd + std::string(bin_path) + ":";
-#endif  // _WIN32
+  // A script of a workspace finds the binaries of the workspace first, and
+  // then those of the root package.
+  std::string current_bin_path;
+  if (directory.empty()) {
+    cwd_ = std::string(cwd, cwd_size);
+  } else {
+    cwd_ = (std::filesystem::path(std::string(cwd, cwd_size)) /
+            std::string(directory))
+               .string();
+    current_bin_path = cwd_ + std::string(bin_path) + path_separator;
+    options_.cwd = cwd_.c_str();
+  }
+  current_bin_path += cwd + std::string(bin_path) + path_separator;
 
-  // Inherit stdin, stdout, and stderr from the parent process.
   options_.stdio_count = 3;
-  child_stdio[0].flags = UV_INHERIT_FD;
-  child_stdio[0].data.fd = 0;
-  child_stdio[1].flags = UV_INHERIT_FD;
-  child_stdio[1].data.fd = 1;
-  child_stdio[2].flags = UV_INHERIT_FD;
-  child_stdio[2].data.fd = 2;
+  if (prefix_.empty()) {
+    // Inherit stdin, stdout, and stderr from the parent process.
+    child_stdio[0].flags = UV_INHERIT_FD;
+    child_stdio[0].data.fd = 0;
+    child_stdio[1].flags = UV_INHERIT_FD;
+    child_stdio[1].data.fd = 1;
+    child_stdio[2].flags = UV_INHERIT_FD;
+    child_stdio[2].data.fd = 2;
+  } else {
+    // Scripts that run in parallel cannot share stdin.
+    child_stdio[0].flags = UV_IGNORE;
+    for (int i = 0; i < 2; i++) {
+      output_[i].runner = this;
+      output_[i].stream = i == 0 ? stdout : stderr;
+      child_stdio[i + 1].flags =
+          static_cast<uv_stdio_flags>(UV_CREATE_PIPE | UV_WRITABLE_PIPE);
+      child_stdio[i + 1].data.stream =
+          reinterpret_cast<uv_stream_t*>(&output_[i].pipe);
+    }
+  }
   options_.stdio = child_stdio;
   options_.exit_cb = ExitCallback;
 
@@ -46,21 +328,19 @@ ProcessRunner::ProcessRunner(std::shared_ptr<InitializationResultImpl> result,
   options_.flags |= UV_PROCESS_WINDOWS_VERBATIM_ARGUMENTS;
 #endif
 
-  init_result = std::move(result);
-
   // Set the process handle data to this class instance.
   // This is used to access the class instance from the OnExit callback.
   // It is required because libuv doesn't allow passing lambda functions as a
   // callback.
   process_.data = this;
 
-  SetEnvironmentVariables(current_bin_path,
+  SetEnvironmentVariables(run_environment,
+                          current_bin_path,
                           std::string_view(cwd, cwd_size),
                           package_json_path,
                           script_name);
 
   std::string command_str(command);
-
   // Use the stored reference on the instance.
   options_.file = file_.c_str();
 
@@ -106,36 +386,21 @@ ProcessRunner::ProcessRunner(std::shared_ptr<InitializationResultImpl> result,
   options_.args[argc] = nullptr;
 }
 
-void ProcessRunner::SetEnvironmentVariables(const std::string& current_bin_path,
-                                            std::string_view cwd,
-                                            std::string_view package_json_path,
-                                            std::string_view script_name) {
-  uv_env_item_t* env_items;
-  int env_count;
-  CHECK_EQ(0, uv_os_environ(&env_items, &env_count));
-
-  // Iterate over environment variables once to store them in the current
-  // ProcessRunner instance.
-  for (int i = 0; i < env_count; i++) {
-    std::string name = env_items[i].name;
-    std::string value = env_items[i].value;
-
-#ifdef _WIN32
-    // We use comspec environment variable to find cmd.exe path on Windows
-    // Example: 'C:\\Windows\\system32\\cmd.exe'
-    // If we don't find it, we fallback to 'cmd.exe' for Windows
-    if (StringEqualNoCase(name.c_str(), "comspec")) {
-      file_ = value;
-    }
-#endif  // _WIN32
 
+void ProcessRunner::SetEnvironmentVariables(
+    const RunEnvironment& run_environment,
+    const std::string& current_bin_path,
+    std::string_view cwd,
+    std::string_view package_json_path,
+    std::string_view script_name) {
+  for (const auto& [name, value] : run_environment.variables) {
     if (StringEqualNoCase(name.c_str(), "path")) {
       // Add bin_path to the beginning of the PATH
-      value = current_bin_path + value;
+      env_vars_.push_back(name + "=" + current_bin_path + value);
+    } else {
+      env_vars_.push_back(name + "=" + value);
     }
-    env_vars_.push_back(name + "=" + value);
   }
-  uv_os_free_environ(env_items, env_count);
 
   // Add NODE_RUN_SCRIPT_NAME environment variable to the environment
   // to indicate which script is being run.
@@ -220,91 +485,282 @@ void ProcessRunner::ExitCallback(uv_process_t* handle,
                                  int64_t exit_status,
                                  int term_signal) {
   auto self = reinterpret_cast<ProcessRunner*>(handle->data);
-  uv_close(reinterpret_cast<uv_handle_t*>(handle), nullptr);
+  uv_close(reinterpret_cast<uv_handle_t*>(handle), [](uv_handle_t* handle) {
+    static_cast<ProcessRunner*>(handle->data)->OnHandleClosed();
+  });
   self->OnExit(exit_status, term_signal);
 }
 
 void ProcessRunner::OnExit(int64_t exit_status, int term_signal) {
+  // Scripts that run in parallel share the exit code, which a script that
+  // succeeds must not reset.
   if (exit_status > 0) {
     init_result->exit_code_ = ExitCode::kGenericUserError;
-  } else {
-    init_result->exit_code_ = ExitCode::kNoFailure;
   }
 }
 
-void ProcessRunner::Run() {
+void ProcessRunner::OnHandleClosed() {
+  CHECK_GT(open_handles_, 0);
+  if (--open_handles_ == 0 && on_done_) on_done_();
+}
+
+void ProcessRunner::WriteOutput(OutputPipe* output,
+                                std::string_view data,
+                                bool eof) {
+  output->partial_line.append(data);
+  std::string_view lines = output->partial_line;
+  size_t end;
+  while ((end = lines.find('\n')) != std::string_view::npos) {
+    fprintf(output->stream,
+            "[%s] %.*s\n",
+            prefix_.c_str(),
+            static_cast<int>(end),
+            lines.data());
+    lines.remove_prefix(end + 1);
+  }
+  if (eof && !lines.empty()) {
+    fprintf(output->stream,
+            "[%s] %.*s\n",
+            prefix_.c_str(),
+            static_cast<int>(lines.size()),
+            lines.data());
+    lines = {};
+  }
+  fflush(output->stream);
+  output->partial_line.erase(0, output->partial_line.size() - lines.size());
+}
+
+bool ProcessRunner::Start(uv_loop_t* loop, std::function<void()> on_done) {
+  loop_ = loop;
+  if (!prefix_.empty()) {
+    for (OutputPipe& output : output_) {
+      CHECK_EQ(uv_pipe_init(loop_, &output.pipe, 0), 0);
+      output.pipe.data = &output;
+      open_handles_++;
+    }
+  }
+  // uv_spawn() initializes the handle even when it fails.
+  open_handles_++;
+
   if (int r = uv_spawn(loop_, &process_, &options_)) {
     fprintf(stderr, "Error: %s\n", uv_strerror(r));
+    init_result->exit_code_ = ExitCode::kGenericUserError;
+    uv_close(reinterpret_cast<uv_handle_t*>(&process_), [](uv_handle_t* h) {
+      static_cast<ProcessRunner*>(h->data)->OnHandleClosed();
+    });
+    if (!prefix_.empty()) {
+      for (OutputPipe& output : output_) {
+        uv_close(reinterpret_cast<uv_handle_t*>(&output.pipe),
+                 [](uv_handle_t* handle) {
+                   static_cast<OutputPipe*>(handle->data)
+                       ->runner->OnHandleClosed();
+                 });
+      }
+    }
+    return false;
+  }
+
+  on_done_ = std::move(on_done);
+  if (prefix_.empty()) return true;
+
+  for (OutputPipe& output : output_) {
+    int err = uv_read_start(
+        reinterpret_cast<uv_stream_t*>(&output.pipe),
+        [](uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+          // The data is written out before the next read.
+          static char buffer[64 * 1024];
+          *buf = uv_buf_init(buffer, sizeof(buffer));
+        },
+        [](uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+          OutputPipe* output = static_cast<OutputPipe*>(stream->data);
+          if (nread > 0) {
+            output->runner->WriteOutput(
+                output, std::string_view(buf->base, nread), false);
+          } else if (nread < 0) {
+            output->runner->WriteOutput(output, {}, true);
+            uv_close(reinterpret_cast<uv_handle_t*>(stream),
+                     [](uv_handle_t* handle) {
+                       static_cast<OutputPipe*>(handle->data)
+                           ->runner->OnHandleClosed();
+                     });
+          }
+        });
+    CHECK_EQ(err, 0);
   }
+  return true;
+}
 
+void ProcessRunner::Run() {
+  Start(uv_default_loop());
   uv_run(loop_, UV_RUN_DEFAULT);
 }
 
-void RunTask(std::shared_ptr<InitializationResultImpl> result,
-             std::string_view command_id,
-             const std::vector<std::string_view>& positional_args) {
-  std::string_view path = "package.json";
-  std::string raw_json;
+std::vector<std::string> ExpandWorkspaces(
+    std::string_view root,
+    const std::vector<std::string>& patterns,
+    std::string* error) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> directories;
+  std::error_code ec;
+
+  for (std::string pattern : patterns) {
+    if (pattern.starts_with("./")) pattern.erase(0, 2);
+    while (!pattern.empty() && pattern.back() == '/') pattern.pop_back();
+
+    bool all_subdirectories = pattern.ends_with("/*") || pattern == "*";
+    if (all_subdirectories) pattern.resize(pattern.size() - 1);
+    if (pattern.find_first_of("*?[]{}!") != std::string::npos) {
+      *error += "Unsupported workspace pattern: \"" + pattern + "\"\n";
+      continue;
+    }
 
-  // No need to exclude BOM since simdjson will skip it.
-  if (ReadFileSync(&raw_json, path.data()) < 0) {
-    fprintf(stderr, "Can't read package.json\n");
-    result->exit_code_ = ExitCode::kGenericUserError;
-    return;
+    if (!all_subdirectories) {
+      if (fs::is_directory(fs::path(std::string(root)) / pattern, ec)) {
+        directories.push_back(pattern);
+      }
+      continue;
+    }
+
+    std::vector<std::string> found;
+    for (fs::directory_iterator it(fs::path(std::string(root)) / pattern, ec),
+         end;
+         !ec && it != end;
+         it.increment(ec)) {
+      if (it->is_directory(ec) &&
+          fs::exists(it->path() / "package.json", ec)) {
+        found.push_back(pattern + it->path().filename().string());
+      }
+    }
+    std::sort(found.begin(), found.end());
+    directories.insert(directories.end(), found.begin(), found.end());
   }
 
-  simdjson::ondemand::parser json_parser;
-  simdjson::ondemand::document document;
-  simdjson::ondemand::object main_object;
-  simdjson::error_code error = json_parser.iterate(raw_json).get(document);
+  return directories;
+}
 
-  // If document is not an object, throw an error.
-  if (error || document.get_object().get(main_object)) {
-    fprintf(stderr, "Can't parse package.json\n");
-    result->exit_code_ = ExitCode::kGenericUserError;
-    return;
+static void PrintMissingScript(const PackageJson& package_json,
+                               std::string_view command_id) {
+  fprintf(stderr,
+          "Missing script: \"%.*s\"\n\n",
+          static_cast<int>(command_id.size()),
+          command_id.data());
+  fprintf(stderr, "Available scripts are:\n");
+  for (const auto& [name, command] : package_json.scripts) {
+    fprintf(stderr, "  %s: %s\n", name.c_str(), command.c_str());
   }
+}
 
-  // If package_json object doesn't have "scripts" field, throw an error.
-  simdjson::ondemand::object scripts_object;
-  if (main_object["scripts"].get_object().get(scripts_object)) {
-    fprintf(stderr, "Can't find \"scripts\" field in package.json\n");
+void RunTask(std::shared_ptr<InitializationResultImpl> result,
+             const std::vector<std::string>& command_ids,
+             const PositionalArgs& positional_args) {
+  std::string path = "package.json";
+  std::string error;
+
+  std::string cache_dir;
+  credentials::SafeGetenv("NODE_COMPILE_CACHE", &cache_dir);
+  auto read_package_json = [&](const std::string& path) {
+    return cache_dir.empty() ? ReadPackageJson(path, &error)
+                             : ReadPackageJsonCached(path, cache_dir, &error);
+  };
+
+  std::optional<PackageJson> package_json = read_package_json(path);
+  if (!package_json.has_value()) {
+    fprintf(stderr, "%s\n", error.c_str());
     result->exit_code_ = ExitCode::kGenericUserError;
     return;
   }
 
-  // If the command_id is not found in the scripts object, throw an error.
-  std::string_view command;
-  if (scripts_object[command_id].get_string().get(command)) {
-    fprintf(stderr,
-            "Missing script: \"%.*s\"\n\n",
-            static_cast<int>(command_id.size()),
-            command_id.data());
-    fprintf(stderr, "Available scripts are:\n");
-
-    // Reset the object to iterate over it again
-    scripts_object.reset();
-    simdjson::ondemand::value value;
-    for (auto field : scripts_object) {
-      std::string_view key_str;
-      std::string_view value_str;
-      if (!field.unescaped_key().get(key_str) && !field.value().get(value) &&
-          !value.get_string().get(value_str)) {
-        fprintf(stderr,
-                "  %.*s: %.*s\n",
-                static_cast<int>(key_str.size()),
-                key_str.data(),
-                static_cast<int>(value_str.size()),
-                value_str.data());
+  struct Task {
+    std::string directory;
+    std::string package_json_path;
+    std::string script_name;
+    std::string command;
+    std::string prefix;
+  };
+  std::vector<Task> tasks;
+
+  if (!per_process::cli_options->run_workspaces) {
+    for (const std::string& command_id : command_ids) {
+      const std::string* command = package_json->FindScript(command_id);
+      // If the command_id is not found in the scripts object, throw an error.
+      if (command == nullptr) {
+        PrintMissingScript(*package_json, command_id);
+        result->exit_code_ = ExitCode::kGenericUserError;
+        return;
       }
+      tasks.push_back({"", path, command_id, *command, command_id});
+    }
+  } else {
+    // Run the scripts in every workspace that has them, in the order of
+    // the "workspaces" field, but not in the root package.
+    std::vector<std::string> directories =
+        ExpandWorkspaces("", package_json->workspaces, &error);
+    if (!error.empty()) fprintf(stderr, "%s", error.c_str());
+    for (const std::string& directory : directories) {
+      std::string workspace_path =
+          (std::filesystem::path(directory) / "package.json").string();
+      std::optional<PackageJson> workspace = read_package_json(workspace_path);
+      if (!workspace.has_value()) continue;
+      for (const std::string& command_id : command_ids) {
+        const std::string* command = workspace->FindScript(command_id);
+        if (command == nullptr) continue;
+        std::string prefix = directory;
+        if (command_ids.size() > 1) prefix += ":" + command_id;
+        tasks.push_back(
+            {directory, workspace_path, command_id, *command, prefix});
+      }
+    }
+    if (tasks.empty()) {
+      fprintf(stderr, "No workspace has a script named");
+      for (const std::string& command_id : command_ids) {
+        fprintf(stderr, " \"%s\"", command_id.c_str());
+      }
+      fprintf(stderr, "\n");
+      result->exit_code_ = ExitCode::kGenericUserError;
+      return;
     }
-    result->exit_code_ = ExitCode::kGenericUserError;
-    return;
   }
 
-  auto runner =
-      ProcessRunner(result, path, command_id, command, positional_args);
-  runner.Run();
+  // The environment is read once for all the scripts.
+  RunEnvironment run_environment;
+
+  size_t concurrency = per_process::cli_options->run_concurrency;
+  if (concurrency == 0) concurrency = os::GetAvailableParallelism();
+  // Scripts only share the terminal, unprefixed, when they run one at a
+  // time.
+  bool prefix_output = tasks.size() > 1 && concurrency > 1;
+
+  std::vector<std::unique_ptr<ProcessRunner>> runners;
+  for (const Task& task : tasks) {
+    runners.push_back(std::make_unique<ProcessRunner>(
+        result,
+        run_environment,
+        task.directory,
+        task.package_json_path,
+        task.script_name,
+        task.command,
+        positional_args,
+        prefix_output ? std::string_view(task.prefix) : std::string_view()));
+  }
+
+  // No more scripts are started once one of them has failed, like with &&
+  // between them, but those that are running are left to finish.
+  uv_loop_t* loop = uv_default_loop();
+  size_t next = 0;
+  size_t running = 0;
+  std::function<void()> start_next = [&]() {
+    while (running < concurrency && next < runners.size() &&
+           result->exit_code_enum() == ExitCode::kNoFailure) {
+      if (runners[next++]->Start(loop, [&]() {
+            running--;
+            start_next();
+          })) {
+        running++;
+      }
+    }
+  };
+  start_next();
+  uv_run(loop, UV_RUN_DEFAULT);
 }
 
 // GetPositionalArgs returns the positional arguments from the command line.
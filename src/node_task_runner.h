@@ -8,31 +8,90 @@
 #include "spawn_sync.h"
 #include "uv.h"
 
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string_view>
+#include <utility>
 
 namespace node {
 namespace task_runner {
 
 using PositionalArgs = std::vector<std::string_view>;
 
+// The parts of a package.json file that the task runner needs.
+struct PackageJson {
+  std::vector<std::pair<std::string, std::string>> scripts;
+  // The entries of the "workspaces" field, as written.
+  std::vector<std::string> workspaces;
+
+  const std::string* FindScript(std::string_view name) const;
+};
+
+// Returns std::nullopt with `error` set if the file cannot be read or
+// parsed, or has no "scripts" field.
+std::optional<PackageJson> ReadPackageJson(const std::string& path,
+                                           std::string* error);
+
+// Like ReadPackageJson(), but goes through a cache file in `cache_dir`, the
+// compile cache directory, so that a package.json that has not changed is
+// not parsed again. The entries are keyed by the absolute path of the file
+// and checked against its size and modification time.
+std::optional<PackageJson> ReadPackageJsonCached(const std::string& path,
+                                                 const std::string& cache_dir,
+                                                 std::string* error);
+
+// The environment variables and the shell that all the scripts of one
+// `node --run` invocation start from, so that they are read only once.
+struct RunEnvironment {
+  RunEnvironment();
+
+  std::vector<std::pair<std::string, std::string>> variables;
+#ifdef _WIN32
+  std::string file = "cmd.exe";
+#else
+  std::string file = "/bin/sh";
+#endif  // _WIN32
+};
+
 // ProcessRunner is the class responsible for running a process.
 // A class instance is created for each process to be run.
 // The class is responsible for spawning the process and handling its exit.
 // The class also handles the environment variables and arguments.
 class ProcessRunner {
  public:
+  // `directory` is that of the package.json file relative to the current
+  // working directory, where the script runs.
+  // When `prefix` is not empty, the output of the script is read through
+  // pipes and written out line by line, each line starting with `[prefix] `,
+  // so that the output of scripts that run in parallel stays readable.
   ProcessRunner(std::shared_ptr<InitializationResultImpl> result,
+                const RunEnvironment& run_environment,
+                std::string_view directory,
                 std::string_view package_json_path,
                 std::string_view script_name,
                 std::string_view command_id,
-                const PositionalArgs& positional_args);
+                const PositionalArgs& positional_args,
+                std::string_view prefix = {});
+  // Spawns the process on `loop`, and calls `on_done` once it has exited and
+  // all of its output has been written out. Returns false if the process
+  // could not be spawned, in which case `on_done` is never called.
+  bool Start(uv_loop_t* loop, std::function<void()> on_done = {});
+  // Spawns the process on the default loop and waits for it.
   void Run();
   static void ExitCallback(uv_process_t* req,
                            int64_t exit_status,
                            int term_signal);
 
  private:
+  // The output of the script, when it is prefixed.
+  struct OutputPipe {
+    ProcessRunner* runner;
+    FILE* stream;
+    uv_pipe_t pipe;
+    std::string partial_line;
+  };
+
   uv_loop_t* loop_ = uv_default_loop();
   uv_process_t process_{};
   uv_process_options_t options_{};
@@ -42,27 +101,42 @@ class ProcessRunner {
   std::vector<std::string> env_vars_{};
   std::unique_ptr<char* []> env {};  // memory for options_.env
   std::unique_ptr<char* []> arg {};  // memory for options_.args
+  std::string cwd_;
+  std::string prefix_;
+  OutputPipe output_[2]{};
+  // The process handle and the output pipes that are not closed yet.
+  int open_handles_ = 0;
+  std::function<void()> on_done_;
 
   // OnExit is the callback function that is called when the process exits.
   void OnExit(int64_t exit_status, int term_signal);
-  void SetEnvironmentVariables(const std::string& bin_path,
+  void OnHandleClosed();
+  void WriteOutput(OutputPipe* output, std::string_view data, bool eof);
+  void SetEnvironmentVariables(const RunEnvironment& run_environment,
+                               const std::string& bin_path,
                                std::string_view cwd,
                                std::string_view package_json_path,
                                std::string_view script_name);
 
-#ifdef _WIN32
-  std::string file_ = "cmd.exe";
-#else
-  std::string file_ = "/bin/sh";
-#endif  // _WIN32
+  std::string file_;
 };
 
 void RunTask(std::shared_ptr<InitializationResultImpl> result,
-             std::string_view command_id,
+             const std::vector<std::string>& command_ids,
              const PositionalArgs& positional_args);
 PositionalArgs GetPositionalArgs(const std::vector<std::string>& args);
 std::string EscapeShell(const std::string_view command);
 
+// Expands the "workspaces" field of the package.json in `root` into the
+// directories it names. Entries can name a directory, or all the
+// subdirectories of one with a trailing `/*`, which are the forms that
+// package managers document; other patterns are reported in `error` and
+// skipped. The directories are returned relative to `root`, in order.
+std::vector<std::string> ExpandWorkspaces(
+    std::string_view root,
+    const std::vector<std::string>& patterns,
+    std::string* error);
+
 }  // namespace task_runner
 }  // namespace node
 
@@ -1,7 +1,9 @@
 #include "env-inl.h"
 #include "node.h"
 #include "node_external_reference.h"
+#include "v8-fast-api-calls.h"
 
+using v8::CFunction;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::Local;
@@ -42,46 +44,87 @@ namespace {
 #define V(type) \
   static void Is##type(const FunctionCallbackInfo<Value>& args) {             \
     args.GetReturnValue().Set(args[0]->Is##type());                           \
-  }
+  }                                                                           \
+  static bool FastIs##type(Local<Value> receiver, Local<Value> value) {       \
+    return value->Is##type();                                                 \
+  }                                                                           \
+  static CFunction fast_is_##type(CFunction::Make(FastIs##type));
 
   VALUE_METHOD_MAP(V)
 #undef V
 
+static bool IsAnyArrayBufferImpl(Local<Value> value) {
+  return value->IsArrayBuffer() || value->IsSharedArrayBuffer();
+}
+
 static void IsAnyArrayBuffer(const FunctionCallbackInfo<Value>& args) {
-  args.GetReturnValue().Set(
-    args[0]->IsArrayBuffer() || args[0]->IsSharedArrayBuffer());
+  args.GetReturnValue().Set(IsAnyArrayBufferImpl(args[0]));
+}
+
+static bool FastIsAnyArrayBuffer(Local<Value> receiver, Local<Value> value) {
+  return IsAnyArrayBufferImpl(value);
+}
+
+static CFunction fast_is_any_array_buffer(
+    CFunction::Make(FastIsAnyArrayBuffer));
+
+static bool IsBoxedPrimitiveImpl(Local<Value> value) {
+  return value->IsNumberObject() ||
+         value->IsStringObject() ||
+         value->IsBooleanObject() ||
+         value->IsBigIntObject() ||
+         value->IsSymbolObject();
 }
 
 static void IsBoxedPrimitive(const FunctionCallbackInfo<Value>& args) {
-  args.GetReturnValue().Set(
-    args[0]->IsNumberObject() ||
-    args[0]->IsStringObject() ||
-    args[0]->IsBooleanObject() ||
-    args[0]->IsBigIntObject() ||
-    args[0]->IsSymbolObject());
+  args.GetReturnValue().Set(IsBoxedPrimitiveImpl(args[0]));
 }
 
+static bool FastIsBoxedPrimitive(Local<Value> receiver, Local<Value> value) {
+  return IsBoxedPrimitiveImpl(value);
+}
+
+static CFunction fast_is_boxed_primitive(
+    CFunction::Make(FastIsBoxedPrimitive));
+
 void InitializeTypes(Local<Object> target,
                      Local<Value> unused,
                      Local<Context> context,
                      void* priv) {
-#define V(type) SetMethodNoSideEffect(context, target, "is" #type, Is##type);
+#define V(type)                                                               \
+  SetFastMethodNoSideEffect(                                                  \
+      context, target, "is" #type, Is##type, &fast_is_##type);
   VALUE_METHOD_MAP(V)
 #undef V
 
-  SetMethodNoSideEffect(context, target, "isAnyArrayBuffer", IsAnyArrayBuffer);
-  SetMethodNoSideEffect(context, target, "isBoxedPrimitive", IsBoxedPrimitive);
+  SetFastMethodNoSideEffect(context,
+                            target,
+                            "isAnyArrayBuffer",
+                            IsAnyArrayBuffer,
+                            &fast_is_any_array_buffer);
+  SetFastMethodNoSideEffect(context,
+                            target,
+                            "isBoxedPrimitive",
+                            IsBoxedPrimitive,
+                            &fast_is_boxed_primitive);
 }
 
 }  // anonymous namespace
 
 void RegisterTypesExternalReferences(ExternalReferenceRegistry* registry) {
-#define V(type) registry->Register(Is##type);
+#define V(type)                                                               \
+  registry->Register(Is##type);                                               \
+  registry->Register(FastIs##type);                                           \
+  registry->Register(fast_is_##type.GetTypeInfo());
   VALUE_METHOD_MAP(V)
 #undef V
 
   registry->Register(IsAnyArrayBuffer);
+  registry->Register(FastIsAnyArrayBuffer);
+  registry->Register(fast_is_any_array_buffer.GetTypeInfo());
   registry->Register(IsBoxedPrimitive);
+  registry->Register(FastIsBoxedPrimitive);
+  registry->Register(fast_is_boxed_primitive.GetTypeInfo());
 }
 }  // namespace node
 
@@ -6,6 +6,9 @@
 
 #include "v8.h"
 
+#include <atomic>
+#include <cstdint>
+
 namespace node {
 
 // An external resource intended to be used with static lifetime.
@@ -50,14 +53,60 @@ using StaticExternalTwoByteResource =
                                uint16_t,
                                v8::String::ExternalStringResource>;
 
+// An external resource with static lifetime whose data is embedded as a
+// Brotli stream, see `node_compress_builtins` in node.gyp. It is
+// decompressed the first time V8 reads the string, and kept from then on.
+// The resource is not cacheable, so V8 does not ask for the data when it
+// creates or deserializes the string, only when it reads it, which means
+// that builtins that are never compiled are not decompressed either.
+template <typename IChar, typename Base>
+class CompressedExternalByteResource : public Base {
+ public:
+  CompressedExternalByteResource(const uint8_t* compressed,
+                                 size_t compressed_length,
+                                 size_t length)
+      : compressed_(compressed),
+        compressed_length_(compressed_length),
+        length_(length) {}
+  ~CompressedExternalByteResource() override { delete[] data_.load(); }
+
+  const IChar* data() const override;
+  size_t length() const override { return length_; }
+  bool IsCacheable() const override { return false; }
+
+  void Dispose() override {
+    // See StaticExternalByteResource::Dispose().
+  }
+
+  CompressedExternalByteResource(const CompressedExternalByteResource&) =
+      delete;
+  CompressedExternalByteResource& operator=(
+      const CompressedExternalByteResource&) = delete;
+
+ private:
+  const uint8_t* compressed_;
+  const size_t compressed_length_;
+  const size_t length_;
+  // nullptr until the data is first asked for.
+  mutable std::atomic<IChar*> data_{nullptr};
+};
+
+using CompressedExternalOneByteResource =
+    CompressedExternalByteResource<char,
+                                   v8::String::ExternalOneByteStringResource>;
+using CompressedExternalTwoByteResource =
+    CompressedExternalByteResource<uint16_t,
+                                   v8::String::ExternalStringResource>;
+
 // Similar to a v8::String, but it's independent from Isolates
 // and can be materialized in Isolates as external Strings
 // via ToStringChecked.
 class UnionBytes {
  public:
-  explicit UnionBytes(StaticExternalOneByteResource* one_byte_resource)
+  explicit UnionBytes(
+      v8::String::ExternalOneByteStringResource* one_byte_resource)
       : one_byte_resource_(one_byte_resource), two_byte_resource_(nullptr) {}
-  explicit UnionBytes(StaticExternalTwoByteResource* two_byte_resource)
+  explicit UnionBytes(v8::String::ExternalStringResource* two_byte_resource)
       : one_byte_resource_(nullptr), two_byte_resource_(two_byte_resource) {}
 
   UnionBytes(const UnionBytes&) = default;
@@ -70,8 +119,9 @@ class UnionBytes {
   v8::Local<v8::String> ToStringChecked(v8::Isolate* isolate) const;
 
  private:
-  StaticExternalOneByteResource* one_byte_resource_;
-  StaticExternalTwoByteResource* two_byte_resource_;
+  // Either a StaticExternalByteResource or a CompressedExternalByteResource.
+  v8::String::ExternalOneByteStringResource* one_byte_resource_;
+  v8::String::ExternalStringResource* two_byte_resource_;
 };
 
 }  // namespace node
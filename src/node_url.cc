@@ -17,6 +17,8 @@
 namespace node {
 namespace url {
 
+using v8::Array;
+using v8::ArrayBuffer;
 using v8::CFunction;
 using v8::Context;
 using v8::FastOneByteString;
@@ -28,8 +30,31 @@ using v8::NewStringType;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::String;
+using v8::Uint32Array;
 using v8::Value;
 
+namespace {
+
+template <typename T>
+void StoreComponents(const ada::url_components& components,
+                     const ada::scheme::type type,
+                     T* out,
+                     size_t offset = 0) {
+  (*out)[offset + 0] = components.protocol_end;
+  (*out)[offset + 1] = components.username_end;
+  (*out)[offset + 2] = components.host_start;
+  (*out)[offset + 3] = components.host_end;
+  (*out)[offset + 4] = components.port;
+  (*out)[offset + 5] = components.pathname_start;
+  (*out)[offset + 6] = components.search_start;
+  (*out)[offset + 7] = components.hash_start;
+  (*out)[offset + 8] = type;
+  static_assert(BindingData::kURLComponentsLength == 9,
+                "kURLComponentsLength should be up-to-date");
+}
+
+}  // anonymous namespace
+
 void BindingData::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("url_components_buffer", url_components_buffer_);
 }
@@ -270,6 +295,118 @@ void BindingData::Parse(const FunctionCallbackInfo<Value>& args) {
       ToV8Value(realm->context(), out->get_href(), isolate).ToLocalChecked());
 }
 
+void BindingData::ParseMany(const FunctionCallbackInfo<Value>& args) {
+  CHECK_GE(args.Length(), 1);
+  CHECK(args[0]->IsArray() || args[0]->IsArrayBufferView());  // inputs
+  // args[1] // base url
+
+  Realm* realm = Realm::GetCurrent(args);
+  Isolate* isolate = realm->isolate();
+  Local<Context> context = realm->context();
+
+  // The base is only parsed once for all of the inputs.
+  ada::result<ada::url_aggregator> base;
+  ada::url_aggregator* base_pointer = nullptr;
+  if (args[1]->IsString()) {
+    base = ada::parse<ada::url_aggregator>(
+        Utf8Value(isolate, args[1]).ToStringView());
+    if (!base) return;
+    base_pointer = &base.value();
+  }
+
+  std::vector<uint32_t> table;
+  std::string hrefs;
+  auto parse_one = [&](std::string_view input) {
+    const size_t row = table.size();
+    table.resize(row + kParseManyRowLength, 0);
+    auto out = ada::parse<ada::url_aggregator>(input, base_pointer);
+    if (!out) return;
+    // Serialized URLs are ASCII, so their offsets in the one-byte string
+    // below are the same as in `hrefs`.
+    const std::string_view href = out->get_href();
+    table[row] = hrefs.size();
+    table[row + 1] = href.size();
+    StoreComponents(out->get_components(), out->type, &table, row + 2);
+    hrefs.append(href);
+  };
+
+  if (args[0]->IsArray()) {
+    Local<Array> inputs = args[0].As<Array>();
+    const uint32_t length = inputs->Length();
+    table.reserve(length * kParseManyRowLength);
+    for (uint32_t i = 0; i < length; i++) {
+      Local<Value> input;
+      if (!inputs->Get(context, i).ToLocal(&input)) return;
+      CHECK(input->IsString());
+      parse_one(Utf8Value(isolate, input).ToStringView());
+      if (hrefs.size() > String::kMaxLength) break;
+    }
+  } else {
+    ArrayBufferViewContents<char> contents(args[0]);
+    std::string_view rest(contents.data(), contents.length());
+    while (!rest.empty() && hrefs.size() <= String::kMaxLength) {
+      const size_t end = rest.find('\n');
+      std::string_view line = rest.substr(0, end);
+      rest = end == std::string_view::npos ? std::string_view()
+                                           : rest.substr(end + 1);
+      if (line.ends_with('\r')) line.remove_suffix(1);
+      parse_one(line);
+    }
+  }
+
+  if (hrefs.size() > String::kMaxLength) {
+    isolate->ThrowException(ERR_STRING_TOO_LONG(isolate));
+    return;
+  }
+
+  Local<ArrayBuffer> buffer =
+      ArrayBuffer::New(isolate, table.size() * sizeof(uint32_t));
+  if (!table.empty()) {
+    memcpy(buffer->Data(), table.data(), table.size() * sizeof(uint32_t));
+  }
+  Local<String> hrefs_string;
+  if (!String::NewFromOneByte(isolate,
+                              reinterpret_cast<const uint8_t*>(hrefs.data()),
+                              NewStringType::kNormal,
+                              hrefs.size())
+           .ToLocal(&hrefs_string)) {
+    return;
+  }
+  Local<Value> result[] = {Uint32Array::New(buffer, 0, table.size()),
+                           hrefs_string};
+  args.GetReturnValue().Set(Array::New(isolate, result, arraysize(result)));
+}
+
+bool BindingData::ParseInPlaceImpl(std::string_view input) {
+  auto out = ada::parse<ada::url_aggregator>(input);
+  if (!out || out->get_href() != input) return false;
+  UpdateComponents(out->get_components(), out->type);
+  return true;
+}
+
+void BindingData::ParseInPlace(const FunctionCallbackInfo<Value>& args) {
+  CHECK_GE(args.Length(), 1);
+  CHECK(args[0]->IsString());  // input
+
+  Realm* realm = Realm::GetCurrent(args);
+  BindingData* binding_data = realm->GetBindingData<BindingData>();
+  Utf8Value input(realm->isolate(), args[0]);
+  args.GetReturnValue().Set(
+      binding_data->ParseInPlaceImpl(input.ToStringView()));
+}
+
+// Inputs with characters above U+007F never parse to themselves, so it does
+// not matter that they are Latin-1 rather than UTF-8 here.
+bool BindingData::FastParseInPlace(Local<Value> receiver,
+                                   const FastOneByteString& input) {
+  BindingData* binding_data = FromJSObject<BindingData>(receiver);
+  return binding_data->ParseInPlaceImpl(
+      std::string_view(input.data, input.length));
+}
+
+CFunction BindingData::fast_parse_in_place_(
+    CFunction::Make(FastParseInPlace));
+
 void BindingData::Update(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsString());    // href
   CHECK(args[1]->IsNumber());    // action type
@@ -346,17 +483,7 @@ void BindingData::Update(const FunctionCallbackInfo<Value>& args) {
 
 void BindingData::UpdateComponents(const ada::url_components& components,
                                    const ada::scheme::type type) {
-  url_components_buffer_[0] = components.protocol_end;
-  url_components_buffer_[1] = components.username_end;
-  url_components_buffer_[2] = components.host_start;
-  url_components_buffer_[3] = components.host_end;
-  url_components_buffer_[4] = components.port;
-  url_components_buffer_[5] = components.pathname_start;
-  url_components_buffer_[6] = components.search_start;
-  url_components_buffer_[7] = components.hash_start;
-  url_components_buffer_[8] = type;
-  static_assert(kURLComponentsLength == 9,
-                "kURLComponentsLength should be up-to-date");
+  StoreComponents(components, type, &url_components_buffer_);
 }
 
 void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
@@ -367,6 +494,9 @@ void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethodNoSideEffect(isolate, target, "format", Format);
   SetMethodNoSideEffect(isolate, target, "getOrigin", GetOrigin);
   SetMethod(isolate, target, "parse", Parse);
+  SetMethod(isolate, target, "parseMany", ParseMany);
+  SetFastMethod(
+      isolate, target, "parseInPlace", ParseInPlace, &fast_parse_in_place_);
   SetMethod(isolate, target, "update", Update);
   SetFastMethodNoSideEffect(
       isolate, target, "canParse", CanParse, {fast_can_parse_methods_, 2});
@@ -387,6 +517,10 @@ void BindingData::RegisterExternalReferences(
   registry->Register(Format);
   registry->Register(GetOrigin);
   registry->Register(Parse);
+  registry->Register(ParseMany);
+  registry->Register(ParseInPlace);
+  registry->Register(FastParseInPlace);
+  registry->Register(fast_parse_in_place_.GetTypeInfo());
   registry->Register(Update);
   registry->Register(CanParse);
   registry->Register(FastCanParse);
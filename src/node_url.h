@@ -59,6 +59,20 @@ class BindingData : public SnapshotableObject {
   static void Format(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetOrigin(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Parse(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // Parses an array of strings, or the newline-delimited lines of a buffer,
+  // against an optional base. Returns [table, hrefs]: hrefs is the
+  // concatenation of the serialized URLs, and the Uint32Array table has one
+  // row of kParseManyRowLength per input, with the offset and length of its
+  // href in hrefs followed by its components as in urlComponents. Inputs
+  // that fail to parse have an href length of 0.
+  static void ParseMany(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // Like parse() without a base, for inputs that are likely to be
+  // serialized URLs already: if the input parses to itself, this updates
+  // urlComponents and returns true, otherwise it returns false and the
+  // caller has to go through parse().
+  static void ParseInPlace(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static bool FastParseInPlace(v8::Local<v8::Value> receiver,
+                               const v8::FastOneByteString& input);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void CreatePerIsolateProperties(IsolateData* isolate_data,
@@ -69,14 +83,18 @@ class BindingData : public SnapshotableObject {
                                          void* priv);
   static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
 
- private:
   static constexpr size_t kURLComponentsLength = 9;
+  static constexpr size_t kParseManyRowLength = kURLComponentsLength + 2;
+
+ private:
   AliasedUint32Array url_components_buffer_;
 
   void UpdateComponents(const ada::url_components& components,
                         const ada::scheme::type type);
+  bool ParseInPlaceImpl(std::string_view input);
 
   static v8::CFunction fast_can_parse_methods_[];
+  static v8::CFunction fast_parse_in_place_;
 };
 
 void ThrowInvalidURL(Environment* env,
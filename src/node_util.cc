@@ -2,6 +2,7 @@
 #include "node_dotenv.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "node_util_inspect.h"
 #include "util-inl.h"
 #include "v8-fast-api-calls.h"
 
@@ -35,6 +36,7 @@ using v8::SKIP_SYMBOLS;
 using v8::StackFrame;
 using v8::StackTrace;
 using v8::String;
+using v8::Symbol;
 using v8::Uint32;
 using v8::Value;
 
@@ -161,15 +163,22 @@ static void GetCallerLocation(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(Array::New(args.GetIsolate(), ret, arraysize(ret)));
 }
 
+static bool IsArrayBufferDetachedImpl(Local<Value> value) {
+  return value->IsArrayBuffer() && value.As<v8::ArrayBuffer>()->WasDetached();
+}
+
 static void IsArrayBufferDetached(const FunctionCallbackInfo<Value>& args) {
-  if (args[0]->IsArrayBuffer()) {
-    auto buffer = args[0].As<v8::ArrayBuffer>();
-    args.GetReturnValue().Set(buffer->WasDetached());
-    return;
-  }
-  args.GetReturnValue().Set(false);
+  args.GetReturnValue().Set(IsArrayBufferDetachedImpl(args[0]));
+}
+
+static bool FastIsArrayBufferDetached(Local<Value> receiver,
+                                      Local<Value> value) {
+  return IsArrayBufferDetachedImpl(value);
 }
 
+CFunction fast_is_array_buffer_detached_(
+    CFunction::Make(FastIsArrayBufferDetached));
+
 static void PreviewEntries(const FunctionCallbackInfo<Value>& args) {
   if (!args[0]->IsObject())
     return;
@@ -191,6 +200,31 @@ static void PreviewEntries(const FunctionCallbackInfo<Value>& args) {
       Array::New(env->isolate(), ret, arraysize(ret)));
 }
 
+// Returns the output of util.inspect(value, { depth, breakLength }), or
+// undefined if the value needs the JS formatter. The custom inspection
+// symbol is only passed when custom inspection is enabled.
+static void InspectPlain(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsUint32());
+
+  PlainInspectOptions options;
+  options.depth = args[1].As<Uint32>()->Value();
+  options.break_length = args[2].As<Uint32>()->Value();
+  if (args[3]->IsSymbol()) options.custom_inspect = args[3].As<Symbol>();
+
+  std::string result;
+  bool formatted;
+  if (!InspectPlainValue(env->context(), args[0], options, &result)
+           .To(&formatted) ||
+      !formatted) {
+    return;
+  }
+  Local<Value> ret;
+  if (ToV8Value(env->context(), result, env->isolate()).ToLocal(&ret))
+    args.GetReturnValue().Set(ret);
+}
+
 static void Sleep(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsUint32());
   uint32_t msec = args[0].As<Uint32>()->Value();
@@ -202,6 +236,15 @@ void ArrayBufferViewHasBuffer(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(args[0].As<ArrayBufferView>()->HasBuffer());
 }
 
+static bool FastArrayBufferViewHasBuffer(Local<Value> receiver,
+                                         Local<Value> value) {
+  CHECK(value->IsArrayBufferView());
+  return value.As<ArrayBufferView>()->HasBuffer();
+}
+
+CFunction fast_array_buffer_view_has_buffer_(
+    CFunction::Make(FastArrayBufferViewHasBuffer));
+
 static uint32_t GetUVHandleTypeCode(const uv_handle_type type) {
   // TODO(anonrig): We can use an enum here and then create the array in the
   // binding, which will remove the hard-coding in C++ and JS land.
@@ -259,12 +302,17 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetProxyDetails);
   registry->Register(GetCallerLocation);
   registry->Register(IsArrayBufferDetached);
+  registry->Register(FastIsArrayBufferDetached);
+  registry->Register(fast_is_array_buffer_detached_.GetTypeInfo());
   registry->Register(PreviewEntries);
+  registry->Register(InspectPlain);
   registry->Register(GetOwnNonIndexProperties);
   registry->Register(GetConstructorName);
   registry->Register(GetExternalValue);
   registry->Register(Sleep);
   registry->Register(ArrayBufferViewHasBuffer);
+  registry->Register(FastArrayBufferViewHasBuffer);
+  registry->Register(fast_array_buffer_view_has_buffer_.GetTypeInfo());
   registry->Register(GuessHandleType);
   registry->Register(FastGuessHandleType);
   registry->Register(fast_guess_handle_type_.GetTypeInfo());
@@ -357,9 +405,13 @@ void Initialize(Local<Object> target,
   SetMethodNoSideEffect(context, target, "getProxyDetails", GetProxyDetails);
   SetMethodNoSideEffect(
       context, target, "getCallerLocation", GetCallerLocation);
-  SetMethodNoSideEffect(
-      context, target, "isArrayBufferDetached", IsArrayBufferDetached);
+  SetFastMethodNoSideEffect(context,
+                            target,
+                            "isArrayBufferDetached",
+                            IsArrayBufferDetached,
+                            &fast_is_array_buffer_detached_);
   SetMethodNoSideEffect(context, target, "previewEntries", PreviewEntries);
+  SetMethodNoSideEffect(context, target, "inspectPlain", InspectPlain);
   SetMethodNoSideEffect(
       context, target, "getOwnNonIndexProperties", GetOwnNonIndexProperties);
   SetMethodNoSideEffect(
@@ -368,8 +420,11 @@ void Initialize(Local<Object> target,
   SetMethod(context, target, "sleep", Sleep);
   SetMethod(context, target, "parseEnv", ParseEnv);
 
-  SetMethod(
-      context, target, "arrayBufferViewHasBuffer", ArrayBufferViewHasBuffer);
+  SetFastMethod(context,
+                target,
+                "arrayBufferViewHasBuffer",
+                ArrayBufferViewHasBuffer,
+                &fast_array_buffer_view_has_buffer_);
 
   Local<String> should_abort_on_uncaught_toggle =
       FIXED_ONE_BYTE_STRING(env->isolate(), "shouldAbortOnUncaughtToggle");
@@ -0,0 +1,803 @@
+#include "node_util_inspect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+#include <vector>
+#include "util-inl.h"
+
+namespace node {
+namespace util {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::BigInt64Array;
+using v8::BigUint64Array;
+using v8::Context;
+using v8::Float32Array;
+using v8::Float64Array;
+using v8::IndexFilter;
+using v8::Int16Array;
+using v8::Int32;
+using v8::Int32Array;
+using v8::Int8Array;
+using v8::Isolate;
+using v8::Just;
+using v8::KeyCollectionMode;
+using v8::KeyConversionMode;
+using v8::Local;
+using v8::Map;
+using v8::Maybe;
+using v8::Name;
+using v8::Nothing;
+using v8::Number;
+using v8::Object;
+using v8::PropertyFilter;
+using v8::Set;
+using v8::String;
+using v8::Symbol;
+using v8::TypedArray;
+using v8::Uint16Array;
+using v8::Uint32Array;
+using v8::Uint8Array;
+using v8::Uint8ClampedArray;
+using v8::Value;
+
+namespace {
+
+// The defaults of util.inspect() that the output depends on besides the
+// options in PlainInspectOptions.
+constexpr int64_t kCompact = 3;
+constexpr uint32_t kMaxArrayLength = 100;
+constexpr size_t kMaxStringLength = 10000;
+constexpr size_t kMinLineWidth = 16;
+// Arrays with more entries than this may be grouped into columns.
+constexpr size_t kMaxUngroupedEntries = 6;
+
+// Keeps the recursion bounded for callers that ask for a large depth.
+constexpr uint32_t kMaxDepth = 64;
+
+#define TYPED_ARRAY_KINDS(V)                                                   \
+  V(Int8Array)                                                                 \
+  V(Uint8Array)                                                                \
+  V(Uint8ClampedArray)                                                         \
+  V(Int16Array)                                                                \
+  V(Uint16Array)                                                               \
+  V(Int32Array)                                                                \
+  V(Uint32Array)                                                               \
+  V(Float32Array)                                                              \
+  V(Float64Array)                                                              \
+  V(BigInt64Array)                                                             \
+  V(BigUint64Array)
+
+enum Kind {
+  kObject,
+  kArray,
+  kMap,
+  kSet,
+#define V(name) k##name,
+  TYPED_ARRAY_KINDS(V)
+#undef V
+  kKindCount
+};
+
+const char* const kKindNames[] = {
+    "Object",
+    "Array",
+    "Map",
+    "Set",
+#define V(name) #name,
+    TYPED_ARRAY_KINDS(V)
+#undef V
+};
+
+enum class Result { kDone, kUnsupported, kException };
+
+struct Entry {
+  std::string text;
+  // Numbers and bigints are aligned to the right when array entries are
+  // grouped into columns.
+  bool is_number = false;
+};
+
+// What String.prototype.length reports for the UTF-8 `text`.
+size_t Utf16Length(std::string_view text) {
+  size_t length = 0;
+  for (unsigned char c : text) {
+    if ((c & 0xc0) != 0x80) length++;
+    if (c >= 0xf0) length++;
+  }
+  return length;
+}
+
+bool IsAscii(std::string_view text) {
+  return std::all_of(
+      text.begin(), text.end(), [](char c) { return (c & 0x80) == 0; });
+}
+
+void AppendUtf8(uint32_t code_point, std::string* out) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else {
+    out->push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+}
+
+// The escape sequences of `meta` in lib/internal/util/inspect.js.
+void AppendEscaped(uint16_t c, std::string* out) {
+  static const char kHex[] = "0123456789ABCDEF";
+  switch (c) {
+    case '\b': *out += "\\b"; return;
+    case '\t': *out += "\\t"; return;
+    case '\n': *out += "\\n"; return;
+    case '\f': *out += "\\f"; return;
+    case '\r': *out += "\\r"; return;
+    case '\'': *out += "\\'"; return;
+    case '\\': *out += "\\\\"; return;
+  }
+  *out += "\\x";
+  out->push_back(kHex[c >> 4]);
+  out->push_back(kHex[c & 15]);
+}
+
+// Mirrors strEscape() in lib/internal/util/inspect.js: picks the quotes
+// that need no escaping, and escapes control characters, backslashes and
+// unpaired surrogates.
+void AppendQuoted(const uint16_t* str, size_t length, std::string* out) {
+  bool has_single = false;
+  bool has_double = false;
+  bool has_backtick = false;
+  bool has_placeholder = false;
+  for (size_t i = 0; i < length; i++) {
+    if (str[i] == '\'') {
+      has_single = true;
+    } else if (str[i] == '"') {
+      has_double = true;
+    } else if (str[i] == '`') {
+      has_backtick = true;
+    } else if (str[i] == '$' && i + 1 < length && str[i + 1] == '{') {
+      has_placeholder = true;
+    }
+  }
+  char quote = '\'';
+  if (has_single) {
+    if (!has_double) {
+      quote = '"';
+    } else if (!has_backtick && !has_placeholder) {
+      quote = '`';
+    }
+  }
+
+  out->push_back(quote);
+  for (size_t i = 0; i < length; i++) {
+    uint16_t c = str[i];
+    if ((c == '\'' && quote == '\'') || c == '\\' || c < 0x20 ||
+        (c > 0x7e && c < 0xa0)) {
+      AppendEscaped(c, out);
+    } else if (c >= 0xd800 && c <= 0xdfff) {
+      if (c <= 0xdbff && i + 1 < length && str[i + 1] >= 0xdc00 &&
+          str[i + 1] <= 0xdfff) {
+        AppendUtf8(0x10000 + ((c - 0xd800) << 10) + (str[i + 1] - 0xdc00),
+                   out);
+        i++;
+        continue;
+      }
+      static const char kHex[] = "0123456789abcdef";
+      *out += "\\u";
+      for (int shift = 12; shift >= 0; shift -= 4)
+        out->push_back(kHex[(c >> shift) & 15]);
+    } else {
+      AppendUtf8(c, out);
+    }
+  }
+  out->push_back(quote);
+}
+
+void AppendPadded(std::string_view text,
+                  size_t width,
+                  bool pad_start,
+                  std::string* out) {
+  size_t padding = width > text.size() ? width - text.size() : 0;
+  if (!pad_start) *out += text;
+  out->append(padding, ' ');
+  if (pad_start) *out += text;
+}
+
+class PlainInspector {
+ public:
+  PlainInspector(Local<Context> context, const PlainInspectOptions& options)
+      : context_(context),
+        isolate_(context->GetIsolate()),
+        options_(options) {}
+
+  // Appends the output of formatValue() in lib/internal/util/inspect.js to
+  // out->text.
+  Result FormatValue(Local<Value> value, uint32_t recurse_times, Entry* out);
+
+ private:
+  Result FormatPrimitive(Local<Value> value, Entry* out);
+  Result FormatPlainObject(Local<Object> object,
+                           uint32_t recurse_times,
+                           Entry* out);
+  Result FormatArray(Local<Array> array, uint32_t recurse_times, Entry* out);
+  Result FormatTypedArray(Local<TypedArray> array,
+                          Kind kind,
+                          uint32_t recurse_times,
+                          Entry* out);
+  Result FormatCollection(Local<Object> object,
+                          Kind kind,
+                          uint32_t recurse_times,
+                          Entry* out);
+
+  // Mirrors reduceToSingleString() and groupArrayElements().
+  Result Reduce(std::vector<Entry>* output,
+                const std::string& open,
+                char close,
+                bool is_array,
+                uint32_t recurse_times,
+                Entry* out);
+  Result GroupArrayElements(std::vector<Entry>* output);
+  bool IsBelowBreakLength(const std::vector<Entry>& output, size_t start);
+
+  Result CheckPrototype(Local<Object> object, Kind kind);
+  Result CheckNoOwnKeys(Local<Object> object, IndexFilter index_filter);
+  Result GetDataProperty(Local<Object> object,
+                         Local<Name> key,
+                         Local<Value>* value);
+  Local<Object> NewInstance(Kind kind);
+
+  Local<Context> context_;
+  Isolate* isolate_;
+  const PlainInspectOptions& options_;
+
+  // The intrinsic prototype of each kind, once it has been checked.
+  Local<Value> prototypes_[kKindCount];
+  bool usable_[kKindCount] = {};
+
+  // The state of `ctx` in lib/internal/util/inspect.js.
+  size_t indentation_ = 0;
+  uint32_t current_depth_ = 0;
+  std::vector<Local<Object>> seen_;
+};
+
+Result PlainInspector::FormatValue(Local<Value> value,
+                                   uint32_t recurse_times,
+                                   Entry* out) {
+  if (!value->IsObject()) return FormatPrimitive(value, out);
+
+  // Looking at the properties of proxies and host objects could run code,
+  // and functions and arguments objects have a format of their own.
+  if (value->IsProxy() || value->IsFunction() || value->IsArgumentsObject())
+    return Result::kUnsupported;
+  Local<Object> object = value.As<Object>();
+  if (object->InternalFieldCount() > 0) return Result::kUnsupported;
+  // Circular references are marked with a reference index.
+  for (Local<Object> seen : seen_) {
+    if (seen == object) return Result::kUnsupported;
+  }
+
+  if (value->IsArray())
+    return FormatArray(value.As<Array>(), recurse_times, out);
+  if (value->IsMap()) return FormatCollection(object, kMap, recurse_times, out);
+  if (value->IsSet()) return FormatCollection(object, kSet, recurse_times, out);
+#define V(name)                                                                \
+  if (value->Is##name())                                                       \
+    return FormatTypedArray(                                                   \
+        value.As<TypedArray>(), k##name, recurse_times, out);
+  TYPED_ARRAY_KINDS(V)
+#undef V
+  if (value->IsTypedArray()) return Result::kUnsupported;
+  // Everything else that does not inherit from Object.prototype is turned
+  // away by CheckPrototype().
+  return FormatPlainObject(object, recurse_times, out);
+}
+
+Result PlainInspector::FormatPrimitive(Local<Value> value, Entry* out) {
+  if (value->IsString()) {
+    Local<String> string = value.As<String>();
+    size_t length = string->Length();
+    // Long strings are truncated or split into several lines.
+    if (length > kMaxStringLength ||
+        (length > kMinLineWidth &&
+         length + indentation_ + 4 > options_.break_length)) {
+      return Result::kUnsupported;
+    }
+    TwoByteValue str(isolate_, string);
+    AppendQuoted(*str, str.length(), &out->text);
+    return Result::kDone;
+  }
+  if (value->IsNumber()) {
+    out->is_number = true;
+    if (value->IsInt32()) {
+      out->text += std::to_string(value.As<Int32>()->Value());
+      return Result::kDone;
+    }
+    double number = value.As<Number>()->Value();
+    if (number == 0 && std::signbit(number)) {
+      out->text += "-0";
+      return Result::kDone;
+    }
+    Utf8Value str(isolate_, value);
+    out->text.append(*str, str.length());
+    return Result::kDone;
+  }
+  if (value->IsBigInt()) {
+    out->is_number = true;
+    Utf8Value str(isolate_, value);
+    out->text.append(*str, str.length());
+    out->text += "n";
+    return Result::kDone;
+  }
+  if (value->IsBoolean()) {
+    out->text += value->IsTrue() ? "true" : "false";
+    return Result::kDone;
+  }
+  if (value->IsUndefined()) {
+    out->text += "undefined";
+    return Result::kDone;
+  }
+  if (value->IsNull()) {
+    out->text += "null";
+    return Result::kDone;
+  }
+  // Symbols.
+  return Result::kUnsupported;
+}
+
+Result PlainInspector::FormatPlainObject(Local<Object> object,
+                                         uint32_t recurse_times,
+                                         Entry* out) {
+  Result result = CheckPrototype(object, kObject);
+  if (result != Result::kDone) return result;
+
+  Local<Array> keys;
+  if (!object
+           ->GetPropertyNames(context_,
+                              KeyCollectionMode::kOwnOnly,
+                              PropertyFilter::ALL_PROPERTIES,
+                              IndexFilter::kIncludeIndices,
+                              KeyConversionMode::kConvertToString)
+           .ToLocal(&keys)) {
+    return Result::kException;
+  }
+  uint32_t count = keys->Length();
+  if (count == 0) {
+    out->text += "{}";
+    return Result::kDone;
+  }
+  if (recurse_times > options_.depth) {
+    out->text += "[Object]";
+    return Result::kDone;
+  }
+
+  recurse_times++;
+  current_depth_ = recurse_times;
+  seen_.push_back(object);
+  std::vector<Entry> output(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> key;
+    if (!keys->Get(context_, i).ToLocal(&key)) return Result::kException;
+    if (!key->IsString()) return Result::kUnsupported;
+    Local<Value> value;
+    result = GetDataProperty(object, key.As<Name>(), &value);
+    if (result != Result::kDone) return result;
+
+    TwoByteValue name(isolate_, key);
+    static const char16_t kProto[] = u"__proto__";
+    bool is_identifier = name.length() > 0 &&
+                         !(name[0] >= '0' && name[0] <= '9');
+    for (size_t j = 0; j < name.length() && is_identifier; j++) {
+      uint16_t c = name[j];
+      is_identifier = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                      (c >= '0' && c <= '9') || c == '_';
+    }
+    std::string& text = output[i].text;
+    if (name.length() == arraysize(kProto) - 1 &&
+        std::equal(*name, *name + name.length(), kProto)) {
+      text += "['__proto__']";
+    } else if (is_identifier) {
+      text.append(*name, *name + name.length());
+    } else {
+      AppendQuoted(*name, name.length(), &text);
+    }
+    text += ": ";
+
+    indentation_ += 2;
+    result = FormatValue(value, recurse_times, &output[i]);
+    if (result != Result::kDone) return result;
+    indentation_ -= 2;
+  }
+  seen_.pop_back();
+  return Reduce(&output, "{", '}', false, recurse_times, out);
+}
+
+Result PlainInspector::FormatArray(Local<Array> array,
+                                   uint32_t recurse_times,
+                                   Entry* out) {
+  Result result = CheckPrototype(array, kArray);
+  if (result != Result::kDone) return result;
+
+  uint32_t length = array->Length();
+  if (length > kMaxArrayLength) return Result::kUnsupported;
+  // The indices come first, and `length` before any other key, so if the
+  // keys are the indices and `length`, there are no holes and no other
+  // properties.
+  Local<Array> keys;
+  if (!array
+           ->GetPropertyNames(context_,
+                              KeyCollectionMode::kOwnOnly,
+                              PropertyFilter::ALL_PROPERTIES,
+                              IndexFilter::kIncludeIndices,
+                              KeyConversionMode::kConvertToString)
+           .ToLocal(&keys)) {
+    return Result::kException;
+  }
+  if (keys->Length() != length + 1) return Result::kUnsupported;
+  Local<Value> last;
+  if (!keys->Get(context_, length).ToLocal(&last)) return Result::kException;
+  if (!last->IsString() ||
+      !last.As<String>()->StringEquals(FIXED_ONE_BYTE_STRING(isolate_,
+                                                             "length"))) {
+    return Result::kUnsupported;
+  }
+
+  if (length == 0) {
+    out->text += "[]";
+    return Result::kDone;
+  }
+  if (recurse_times > options_.depth) {
+    out->text += "[Array]";
+    return Result::kDone;
+  }
+
+  recurse_times++;
+  current_depth_ = recurse_times;
+  seen_.push_back(array);
+  std::vector<Entry> output(length);
+  for (uint32_t i = 0; i < length; i++) {
+    Local<Value> key;
+    Local<Value> value;
+    if (!keys->Get(context_, i).ToLocal(&key)) return Result::kException;
+    result = GetDataProperty(array, key.As<Name>(), &value);
+    if (result != Result::kDone) return result;
+    indentation_ += 2;
+    result = FormatValue(value, recurse_times, &output[i]);
+    if (result != Result::kDone) return result;
+    indentation_ -= 2;
+  }
+  seen_.pop_back();
+  return Reduce(&output, "[", ']', true, recurse_times, out);
+}
+
+Result PlainInspector::FormatTypedArray(Local<TypedArray> array,
+                                        Kind kind,
+                                        uint32_t recurse_times,
+                                        Entry* out) {
+  Result result = CheckPrototype(array, kind);
+  if (result == Result::kDone)
+    result = CheckNoOwnKeys(array, IndexFilter::kSkipIndices);
+  if (result != Result::kDone) return result;
+
+  size_t length = array->Length();
+  if (length > kMaxArrayLength) return Result::kUnsupported;
+  std::string open = kKindNames[kind];
+  open += "(" + std::to_string(length) + ") [";
+  if (length == 0) {
+    out->text += open + "]";
+    return Result::kDone;
+  }
+  if (recurse_times > options_.depth) {
+    out->text += "[" + std::string(kKindNames[kind]) + "]";
+    return Result::kDone;
+  }
+
+  recurse_times++;
+  current_depth_ = recurse_times;
+  std::vector<Entry> output(length);
+  for (size_t i = 0; i < length; i++) {
+    Local<Value> value;
+    if (!array->Get(context_, static_cast<uint32_t>(i)).ToLocal(&value))
+      return Result::kException;
+    result = FormatPrimitive(value, &output[i]);
+    if (result != Result::kDone) return result;
+  }
+  return Reduce(&output, open, ']', true, recurse_times, out);
+}
+
+Result PlainInspector::FormatCollection(Local<Object> object,
+                                        Kind kind,
+                                        uint32_t recurse_times,
+                                        Entry* out) {
+  Result result = CheckPrototype(object, kind);
+  if (result == Result::kDone)
+    result = CheckNoOwnKeys(object, IndexFilter::kIncludeIndices);
+  if (result != Result::kDone) return result;
+
+  size_t size = kind == kMap ? object.As<Map>()->Size()
+                             : object.As<Set>()->Size();
+  if (size > kMaxArrayLength) return Result::kUnsupported;
+  std::string open = kKindNames[kind];
+  open += "(" + std::to_string(size) + ") {";
+  if (size == 0) {
+    out->text += open + "}";
+    return Result::kDone;
+  }
+  if (recurse_times > options_.depth) {
+    out->text += "[" + std::string(kKindNames[kind]) + "]";
+    return Result::kDone;
+  }
+
+  bool is_key_value;
+  Local<Array> entries;
+  if (!object->PreviewEntries(&is_key_value).ToLocal(&entries))
+    return Result::kException;
+  uint32_t step = is_key_value ? 2 : 1;
+  if (entries->Length() != size * step) return Result::kUnsupported;
+
+  recurse_times++;
+  current_depth_ = recurse_times;
+  seen_.push_back(object);
+  indentation_ += 2;
+  std::vector<Entry> output(size);
+  for (uint32_t i = 0; i < size; i++) {
+    for (uint32_t j = 0; j < step; j++) {
+      Local<Value> value;
+      if (!entries->Get(context_, i * step + j).ToLocal(&value))
+        return Result::kException;
+      if (j == 1) output[i].text += " => ";
+      result = FormatValue(value, recurse_times, &output[i]);
+      if (result != Result::kDone) return result;
+    }
+  }
+  indentation_ -= 2;
+  seen_.pop_back();
+  return Reduce(&output, open, '}', false, recurse_times, out);
+}
+
+Result PlainInspector::Reduce(std::vector<Entry>* output,
+                              const std::string& open,
+                              char close,
+                              bool is_array,
+                              uint32_t recurse_times,
+                              Entry* out) {
+  size_t entries = output->size();
+  if (is_array && entries > kMaxUngroupedEntries) {
+    Result result = GroupArrayElements(output);
+    if (result != Result::kDone) return result;
+  }
+
+  // Line up the entries of the innermost `kCompact` levels on a single line
+  // if they fit.
+  if (static_cast<int64_t>(current_depth_) -
+              static_cast<int64_t>(recurse_times) <
+          kCompact &&
+      entries == output->size()) {
+    size_t start = output->size() + indentation_ + open.size() + 10;
+    if (IsBelowBreakLength(*output, start)) {
+      std::string joined;
+      for (size_t i = 0; i < output->size(); i++) {
+        if (i > 0) joined += ", ";
+        joined += (*output)[i].text;
+      }
+      if (joined.find('\n') == std::string::npos) {
+        out->text += open + " " + joined + " ";
+        out->text.push_back(close);
+        return Result::kDone;
+      }
+    }
+  }
+
+  std::string indentation = "\n" + std::string(indentation_, ' ');
+  out->text += open + indentation + "  ";
+  for (size_t i = 0; i < output->size(); i++) {
+    if (i > 0) out->text += "," + indentation + "  ";
+    out->text += (*output)[i].text;
+  }
+  out->text += indentation;
+  out->text.push_back(close);
+  return Result::kDone;
+}
+
+Result PlainInspector::GroupArrayElements(std::vector<Entry>* output) {
+  // The widths of the entries are only the same as their lengths for ASCII,
+  // and lines that are already broken are not grouped sensibly.
+  constexpr size_t kSeparatorSpace = 2;
+  size_t count = output->size();
+  size_t total_length = 0;
+  size_t max_length = 0;
+  for (const Entry& entry : *output) {
+    if (!IsAscii(entry.text) || entry.text.find('\n') != std::string::npos)
+      return Result::kUnsupported;
+    total_length += entry.text.size() + kSeparatorSpace;
+    max_length = std::max(max_length, entry.text.size());
+  }
+  size_t actual_max = max_length + kSeparatorSpace;
+  if (actual_max * 3 + indentation_ >= options_.break_length ||
+      (static_cast<double>(total_length) / actual_max <= 5 &&
+       max_length > 6)) {
+    return Result::kDone;
+  }
+
+  constexpr double kApproxCharHeights = 2.5;
+  double average_bias =
+      std::sqrt(actual_max - static_cast<double>(total_length) / count);
+  double biased_max = std::max(actual_max - 3 - average_bias, 1.0);
+  double columns = std::min(
+      {std::floor(std::sqrt(kApproxCharHeights * biased_max * count) /
+                      biased_max +
+                  0.5),
+       std::floor(static_cast<double>(options_.break_length - indentation_) /
+                  actual_max),
+       static_cast<double>(kCompact * 4),
+       15.0});
+  if (columns <= 1) return Result::kDone;
+  size_t column_count = static_cast<size_t>(columns);
+
+  std::vector<size_t> max_line_length;
+  for (size_t i = 0; i < column_count; i++) {
+    size_t line_length = 0;
+    for (size_t j = i; j < count; j += column_count)
+      line_length = std::max(line_length, (*output)[j].text.size());
+    max_line_length.push_back(line_length + kSeparatorSpace);
+  }
+  bool pad_start =
+      std::all_of(output->begin(), output->end(), [](const Entry& entry) {
+        return entry.is_number;
+      });
+
+  std::vector<Entry> rows;
+  for (size_t i = 0; i < count; i += column_count) {
+    size_t max = std::min(i + column_count, count);
+    Entry row;
+    size_t j = i;
+    for (; j < max - 1; j++) {
+      AppendPadded((*output)[j].text + ", ",
+                   max_line_length[j - i],
+                   pad_start,
+                   &row.text);
+    }
+    if (pad_start) {
+      AppendPadded((*output)[j].text,
+                   max_line_length[j - i] - kSeparatorSpace,
+                   true,
+                   &row.text);
+    } else {
+      row.text += (*output)[j].text;
+    }
+    rows.push_back(std::move(row));
+  }
+  *output = std::move(rows);
+  return Result::kDone;
+}
+
+bool PlainInspector::IsBelowBreakLength(const std::vector<Entry>& output,
+                                        size_t start) {
+  size_t total_length = output.size() + start;
+  if (total_length + output.size() > options_.break_length) return false;
+  for (const Entry& entry : output) {
+    total_length += Utf16Length(entry.text);
+    if (total_length > options_.break_length) return false;
+  }
+  return true;
+}
+
+Result PlainInspector::CheckPrototype(Local<Object> object, Kind kind) {
+  if (prototypes_[kind].IsEmpty()) {
+    Local<Value> prototype = NewInstance(kind)->GetPrototype();
+    if (!prototype->IsObject()) return Result::kUnsupported;
+    prototypes_[kind] = prototype;
+
+    // Anything added to the prototype that util.inspect() looks up
+    // changes the output.
+    Local<Object> proto = prototype.As<Object>();
+    std::vector<Local<Value>> keys;
+    if (!options_.custom_inspect.IsEmpty())
+      keys.push_back(options_.custom_inspect);
+    if (kind == kObject || kind == kArray)
+      keys.push_back(Symbol::GetToStringTag(isolate_));
+    if (kind == kObject) keys.push_back(Symbol::GetIterator(isolate_));
+    usable_[kind] = true;
+    for (Local<Value> key : keys) {
+      bool has;
+      if (!proto->Has(context_, key).To(&has)) return Result::kException;
+      if (has) usable_[kind] = false;
+    }
+  }
+  if (!usable_[kind] || object->GetPrototype() != prototypes_[kind])
+    return Result::kUnsupported;
+  return Result::kDone;
+}
+
+Result PlainInspector::CheckNoOwnKeys(Local<Object> object,
+                                      IndexFilter index_filter) {
+  Local<Array> keys;
+  if (!object
+           ->GetPropertyNames(context_,
+                              KeyCollectionMode::kOwnOnly,
+                              PropertyFilter::ALL_PROPERTIES,
+                              index_filter)
+           .ToLocal(&keys)) {
+    return Result::kException;
+  }
+  return keys->Length() == 0 ? Result::kDone : Result::kUnsupported;
+}
+
+// Reads the own property `key`, unless it is an accessor or not enumerable.
+Result PlainInspector::GetDataProperty(Local<Object> object,
+                                       Local<Name> key,
+                                       Local<Value>* value) {
+  Local<Value> descriptor;
+  if (!object->GetOwnPropertyDescriptor(context_, key).ToLocal(&descriptor))
+    return Result::kException;
+  if (!descriptor->IsObject()) return Result::kUnsupported;
+  Local<Object> desc = descriptor.As<Object>();
+  bool is_accessor;
+  Local<Value> enumerable;
+  if (!desc->Has(context_, FIXED_ONE_BYTE_STRING(isolate_, "get"))
+           .To(&is_accessor) ||
+      !desc->Get(context_, FIXED_ONE_BYTE_STRING(isolate_, "enumerable"))
+           .ToLocal(&enumerable)) {
+    return Result::kException;
+  }
+  if (is_accessor || !enumerable->IsTrue()) return Result::kUnsupported;
+  if (!desc->Get(context_, FIXED_ONE_BYTE_STRING(isolate_, "value"))
+           .ToLocal(value)) {
+    return Result::kException;
+  }
+  return Result::kDone;
+}
+
+Local<Object> PlainInspector::NewInstance(Kind kind) {
+  switch (kind) {
+    case kObject:
+      return Object::New(isolate_);
+    case kArray:
+      return Array::New(isolate_);
+    case kMap:
+      return Map::New(isolate_);
+    case kSet:
+      return Set::New(isolate_);
+#define V(name)                                                                \
+  case k##name:                                                                \
+    return name::New(ArrayBuffer::New(isolate_, 0), 0, 0);
+      TYPED_ARRAY_KINDS(V)
+#undef V
+    case kKindCount:
+      break;
+  }
+  UNREACHABLE();
+}
+
+}  // anonymous namespace
+
+Maybe<bool> InspectPlainValue(Local<Context> context,
+                              Local<Value> value,
+                              const PlainInspectOptions& options,
+                              std::string* out) {
+  if (options.depth > kMaxDepth) return Just(false);
+  PlainInspector inspector(context, options);
+  Entry entry;
+  switch (inspector.FormatValue(value, 0, &entry)) {
+    case Result::kDone:
+      *out = std::move(entry.text);
+      return Just(true);
+    case Result::kUnsupported:
+      return Just(false);
+    case Result::kException:
+      break;
+  }
+  return Nothing<bool>();
+}
+
+}  // namespace util
+}  // namespace node
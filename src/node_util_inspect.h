@@ -0,0 +1,42 @@
+#ifndef SRC_NODE_UTIL_INSPECT_H_
+#define SRC_NODE_UTIL_INSPECT_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstdint>
+#include <string>
+#include "v8.h"
+
+namespace node {
+namespace util {
+
+// The util.inspect() options that the native formatter takes into account.
+// All other options must have their default values.
+struct PlainInspectOptions {
+  uint32_t depth = 2;
+  uint32_t break_length = 128;
+  // util.inspect.custom, if custom inspection is enabled. Values that
+  // inherit a property with this key are left to the JS formatter.
+  v8::Local<v8::Symbol> custom_inspect;
+};
+
+// Formats `value` into `out` as UTF-8, exactly the way util.inspect() with
+// `options` formats it, when `value` is a primitive or a tree of plain
+// objects, arrays, typed arrays, Maps and Sets whose leaves are primitives.
+//
+// Returns Just(false) without touching `out` as soon as anything turns up
+// that the JS formatter is needed for, e.g. accessors, non-enumerable or
+// symbol keys, holes, proxies, circular references, functions, modified
+// prototypes or output that util.inspect() would split or truncate. Getters
+// are never invoked. Returns Nothing() if an exception is pending.
+v8::Maybe<bool> InspectPlainValue(v8::Local<v8::Context> context,
+                                  v8::Local<v8::Value> value,
+                                  const PlainInspectOptions& options,
+                                  std::string* out);
+
+}  // namespace util
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_UTIL_INSPECT_H_
@@ -106,7 +106,12 @@ BindingData::BindingData(Realm* realm,
       heap_code_statistics_buffer(
           realm->isolate(),
           kHeapCodeStatisticsPropertiesCount,
-          MAYBE_FIELD_PTR(info, heap_code_statistics_buffer)) {
+          MAYBE_FIELD_PTR(info, heap_code_statistics_buffer)),
+      all_heap_space_statistics_buffer(
+          realm->isolate(),
+          realm->isolate()->NumberOfHeapSpaces() *
+              kHeapSpaceStatisticsPropertiesCount,
+          MAYBE_FIELD_PTR(info, all_heap_space_statistics_buffer)) {
   Local<Context> context = realm->context();
   if (info == nullptr) {
     obj->Set(context,
@@ -123,14 +128,70 @@ BindingData::BindingData(Realm* realm,
            FIXED_ONE_BYTE_STRING(realm->isolate(), "heapSpaceStatisticsBuffer"),
            heap_space_statistics_buffer.GetJSArray())
         .Check();
+    obj->Set(context,
+             FIXED_ONE_BYTE_STRING(realm->isolate(),
+                                   "allHeapSpaceStatisticsBuffer"),
+             all_heap_space_statistics_buffer.GetJSArray())
+        .Check();
   } else {
     heap_statistics_buffer.Deserialize(realm->context());
     heap_code_statistics_buffer.Deserialize(realm->context());
     heap_space_statistics_buffer.Deserialize(realm->context());
+    all_heap_space_statistics_buffer.Deserialize(realm->context());
   }
   heap_statistics_buffer.MakeWeak();
   heap_space_statistics_buffer.MakeWeak();
   heap_code_statistics_buffer.MakeWeak();
+  all_heap_space_statistics_buffer.MakeWeak();
+}
+
+BindingData::~BindingData() {
+  SetAutoUpdate(false);
+}
+
+void BindingData::SetAutoUpdate(bool enabled) {
+  if (enabled == auto_update_) return;
+  auto_update_ = enabled;
+  if (enabled) {
+    UpdateHeapStatistics();
+    UpdateAllHeapSpaceStatistics();
+    env()->isolate()->AddGCEpilogueCallback(AfterGC, this);
+  } else {
+    env()->isolate()->RemoveGCEpilogueCallback(AfterGC, this);
+  }
+}
+
+void BindingData::AfterGC(Isolate* isolate,
+                          v8::GCType type,
+                          v8::GCCallbackFlags flags,
+                          void* data) {
+  BindingData* binding = static_cast<BindingData*>(data);
+  binding->UpdateHeapStatistics();
+  binding->UpdateAllHeapSpaceStatistics();
+}
+
+void BindingData::UpdateHeapStatistics() {
+  HeapStatistics s;
+  env()->isolate()->GetHeapStatistics(&s);
+  AliasedFloat64Array& buffer = heap_statistics_buffer;
+#define V(index, name, _) buffer[index] = static_cast<double>(s.name());
+  HEAP_STATISTICS_PROPERTIES(V)
+#undef V
+}
+
+void BindingData::UpdateAllHeapSpaceStatistics() {
+  Isolate* isolate = env()->isolate();
+  size_t number_of_heap_spaces = isolate->NumberOfHeapSpaces();
+  for (size_t i = 0; i < number_of_heap_spaces; i++) {
+    HeapSpaceStatistics s;
+    isolate->GetHeapSpaceStatistics(&s, i);
+    size_t offset = i * kHeapSpaceStatisticsPropertiesCount;
+#define V(index, name, _)                                                      \
+  all_heap_space_statistics_buffer[offset + index] =                           \
+      static_cast<double>(s.name());
+    HEAP_SPACE_STATISTICS_PROPERTIES(V)
+#undef V
+  }
 }
 
 bool BindingData::PrepareForSerialization(Local<Context> context,
@@ -143,6 +204,8 @@ bool BindingData::PrepareForSerialization(Local<Context> context,
       heap_space_statistics_buffer.Serialize(context, creator);
   internal_field_info_->heap_code_statistics_buffer =
       heap_code_statistics_buffer.Serialize(context, creator);
+  internal_field_info_->all_heap_space_statistics_buffer =
+      all_heap_space_statistics_buffer.Serialize(context, creator);
   // Return true because we need to maintain the reference to the binding from
   // JS land.
   return true;
@@ -175,6 +238,8 @@ void BindingData::MemoryInfo(MemoryTracker* tracker) const {
                       heap_space_statistics_buffer);
   tracker->TrackField("heap_code_statistics_buffer",
                       heap_code_statistics_buffer);
+  tracker->TrackField("all_heap_space_statistics_buffer",
+                      all_heap_space_statistics_buffer);
 }
 
 void CachedDataVersionTag(const FunctionCallbackInfo<Value>& args) {
@@ -196,12 +261,12 @@ void SetHeapSnapshotNearHeapLimit(const FunctionCallbackInfo<Value>& args) {
 
 void UpdateHeapStatisticsBuffer(const FunctionCallbackInfo<Value>& args) {
   BindingData* data = Realm::GetBindingData<BindingData>(args);
-  HeapStatistics s;
-  args.GetIsolate()->GetHeapStatistics(&s);
-  AliasedFloat64Array& buffer = data->heap_statistics_buffer;
-#define V(index, name, _) buffer[index] = static_cast<double>(s.name());
-  HEAP_STATISTICS_PROPERTIES(V)
-#undef V
+  data->UpdateHeapStatistics();
+}
+
+void SetHeapStatisticsAutoUpdate(const FunctionCallbackInfo<Value>& args) {
+  BindingData* data = Realm::GetBindingData<BindingData>(args);
+  data->SetAutoUpdate(args[0]->IsTrue());
 }
 
 
@@ -441,6 +506,11 @@ void Initialize(Local<Object> target,
             "updateHeapCodeStatisticsBuffer",
             UpdateHeapCodeStatisticsBuffer);
 
+  SetMethod(context,
+            target,
+            "setHeapStatisticsAutoUpdate",
+            SetHeapStatisticsAutoUpdate);
+
   size_t number_of_heap_spaces = env->isolate()->NumberOfHeapSpaces();
 
   // Heap space names are extracted once and exposed to JavaScript to
@@ -493,6 +563,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(UpdateHeapStatisticsBuffer);
   registry->Register(UpdateHeapCodeStatisticsBuffer);
   registry->Register(UpdateHeapSpaceStatisticsBuffer);
+  registry->Register(SetHeapStatisticsAutoUpdate);
   registry->Register(SetFlagsFromString);
   registry->Register(SetHeapSnapshotNearHeapLimit);
   registry->Register(GCProfiler::New);
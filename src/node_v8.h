@@ -22,10 +22,12 @@ class BindingData : public SnapshotableObject {
     AliasedBufferIndex heap_statistics_buffer;
     AliasedBufferIndex heap_space_statistics_buffer;
     AliasedBufferIndex heap_code_statistics_buffer;
+    AliasedBufferIndex all_heap_space_statistics_buffer;
   };
   BindingData(Realm* realm,
               v8::Local<v8::Object> obj,
               InternalFieldInfo* info = nullptr);
+  ~BindingData() override;
 
   SERIALIZABLE_OBJECT_METHODS()
   SET_BINDING_ID(v8_binding_data)
@@ -33,13 +35,30 @@ class BindingData : public SnapshotableObject {
   AliasedFloat64Array heap_statistics_buffer;
   AliasedFloat64Array heap_space_statistics_buffer;
   AliasedFloat64Array heap_code_statistics_buffer;
+  // The statistics of every heap space, one after the other in the order
+  // of kHeapSpaces.
+  AliasedFloat64Array all_heap_space_statistics_buffer;
+
+  // While enabled, heap_statistics_buffer and
+  // all_heap_space_statistics_buffer are refreshed after every GC, so that
+  // reading them does not take a call into C++ or a walk of the heap
+  // spaces. Between GCs, they lag behind what has been allocated since.
+  void SetAutoUpdate(bool enabled);
+  void UpdateHeapStatistics();
+  void UpdateAllHeapSpaceStatistics();
 
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_SELF_SIZE(BindingData)
   SET_MEMORY_INFO_NAME(BindingData)
 
  private:
+  static void AfterGC(v8::Isolate* isolate,
+                      v8::GCType type,
+                      v8::GCCallbackFlags flags,
+                      void* data);
+
   InternalFieldInfo* internal_field_info_ = nullptr;
+  bool auto_update_ = false;
 };
 
 class GCProfiler : public BaseObject {
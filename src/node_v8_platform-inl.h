@@ -7,6 +7,7 @@
 #include <string_view>
 
 #include "env-inl.h"
+#include "large_pages/node_large_page.h"
 #include "node.h"
 #include "node_metadata.h"
 #include "node_platform.h"
@@ -101,7 +102,8 @@ struct V8Platform {
       StartTracingAgent();
     }
     // Tracing must be initialized before platform threads are created.
-    platform_ = new NodePlatform(thread_pool_size, controller);
+    platform_ = new NodePlatform(
+        thread_pool_size, controller, large_pages::GetHeapPageAllocator());
     v8::V8::InitializePlatform(platform_);
   }
   // Make sure V8Platform don not call into Libuv threadpool,
@@ -142,11 +144,16 @@ struct V8Platform {
       const std::vector<std::string_view> categories =
           SplitString(per_process::cli_options->trace_event_categories, ","sv);
 
+      const tracing::NodeTraceWriter::Format format =
+          per_process::cli_options->trace_event_format == "perfetto"
+              ? tracing::NodeTraceWriter::Format::kPerfetto
+              : tracing::NodeTraceWriter::Format::kJSON;
       tracing_file_writer_ = tracing_agent_->AddClient(
           convert_to_set(categories),
           std::unique_ptr<tracing::AsyncTraceWriter>(
               new tracing::NodeTraceWriter(
-                  per_process::cli_options->trace_event_file_pattern)),
+                  per_process::cli_options->trace_event_file_pattern,
+                  format)),
           tracing::Agent::kUseDefaultCategories);
     }
   }
@@ -3,6 +3,7 @@
 #include "debug_utils-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_mem-inl.h"
+#include "threadpoolwork-inl.h"
 #include "util-inl.h"
 #include "node.h"
 #include "node_errors.h"
@@ -18,6 +19,10 @@ inline void Debug(const WASI& wasi, Args&&... args) {
   Debug(wasi.env(), DebugCategory::WASI, std::forward<Args>(args)...);
 }
 
+// fd_read, fd_write and friends are called for every bit of I/O that a
+// module does, mostly with a handful of iovecs, which then stay off the heap.
+static constexpr size_t kStackIovecs = 16;
+
 #define CHECK_BOUNDS_OR_RETURN(mem_size, offset, buf_size)                     \
   do {                                                                         \
     if (!uvwasi_serdes_check_bounds((offset), (mem_size), (buf_size))) {       \
@@ -34,11 +39,13 @@ using v8::Exception;
 using v8::FastApiCallbackOptions;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
 using v8::Object;
+using v8::Promise;
 using v8::Signature;
 using v8::String;
 using v8::Uint32;
@@ -88,10 +95,21 @@ WASI::WASI(Environment* env,
 
     env->isolate()->ThrowException(exception);
   }
+
+  static const uvwasi_mem_t kUntrackedAllocator = {
+      nullptr,
+      [](size_t size, void*) { return malloc(size); },
+      [](void* ptr, void*) { free(ptr); },
+      [](size_t nmemb, size_t size, void*) { return calloc(nmemb, size); },
+      [](void* ptr, size_t size, void*) { return realloc(ptr, size); },
+  };
+  untracked_uvw_ = uvw_;
+  untracked_uvw_.allocator = &kUntrackedAllocator;
 }
 
 
 WASI::~WASI() {
+  memset(random_pool_, 0, sizeof(random_pool_));
   uvwasi_destroy(&uvw_);
   CHECK_EQ(current_uvwasi_memory_, 0);
 }
@@ -637,17 +655,18 @@ uint32_t WASI::FdPread(WASI& wasi,
   CHECK_BOUNDS_OR_RETURN(
       memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_iovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nread_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_iovec_t> iovs(iovs_len);
+  MaybeStackBuffer<uvwasi_iovec_t, kStackIovecs> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_iovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nread;
-  err = uvwasi_fd_pread(&wasi.uvw_, fd, iovs.data(), iovs_len, offset, &nread);
+  err = uvwasi_fd_pread(
+      &wasi.untracked_uvw_, fd, iovs.out(), iovs_len, offset, &nread);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nread_ptr, nread);
 
@@ -697,18 +716,18 @@ uint32_t WASI::FdPwrite(WASI& wasi,
   CHECK_BOUNDS_OR_RETURN(
       memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_ciovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nwritten_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_ciovec_t> iovs(iovs_len);
+  MaybeStackBuffer<uvwasi_ciovec_t, kStackIovecs> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_ciovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nwritten;
   err = uvwasi_fd_pwrite(
-      &wasi.uvw_, fd, iovs.data(), iovs_len, offset, &nwritten);
+      &wasi.untracked_uvw_, fd, iovs.out(), iovs_len, offset, &nwritten);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nwritten_ptr, nwritten);
 
@@ -725,17 +744,18 @@ uint32_t WASI::FdRead(WASI& wasi,
   CHECK_BOUNDS_OR_RETURN(
       memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_iovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nread_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_iovec_t> iovs(iovs_len);
+  MaybeStackBuffer<uvwasi_iovec_t, kStackIovecs> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_iovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nread;
-  err = uvwasi_fd_read(&wasi.uvw_, fd, iovs.data(), iovs_len, &nread);
+  err = uvwasi_fd_read(
+      &wasi.untracked_uvw_, fd, iovs.out(), iovs_len, &nread);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nread_ptr, nread);
 
@@ -826,17 +846,18 @@ uint32_t WASI::FdWrite(WASI& wasi,
   CHECK_BOUNDS_OR_RETURN(
       memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_ciovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nwritten_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_ciovec_t> iovs(iovs_len);
+  MaybeStackBuffer<uvwasi_ciovec_t, kStackIovecs> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_ciovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nwritten;
-  err = uvwasi_fd_write(&wasi.uvw_, fd, iovs.data(), iovs_len, &nwritten);
+  err = uvwasi_fd_write(
+      &wasi.untracked_uvw_, fd, iovs.out(), iovs_len, &nwritten);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nwritten_ptr, nwritten);
 
@@ -1140,7 +1161,21 @@ uint32_t WASI::RandomGet(WASI& wasi,
                          uint32_t buf_len) {
   Debug(wasi, "random_get(%d, %d)\n", buf_ptr, buf_len);
   CHECK_BOUNDS_OR_RETURN(memory.size, buf_ptr, buf_len);
-  return uvwasi_random_get(&wasi.uvw_, &memory.data[buf_ptr], buf_len);
+  if (buf_len > sizeof(wasi.random_pool_) / 4) {
+    return uvwasi_random_get(&wasi.uvw_, &memory.data[buf_ptr], buf_len);
+  }
+
+  uint8_t* pool = wasi.random_pool_;
+  if (buf_len > sizeof(wasi.random_pool_) - wasi.random_pool_offset_) {
+    uvwasi_errno_t err =
+        uvwasi_random_get(&wasi.uvw_, pool, sizeof(wasi.random_pool_));
+    if (err != UVWASI_ESUCCESS) return err;
+    wasi.random_pool_offset_ = 0;
+  }
+  memcpy(&memory.data[buf_ptr], pool + wasi.random_pool_offset_, buf_len);
+  memset(pool + wasi.random_pool_offset_, 0, buf_len);
+  wasi.random_pool_offset_ += buf_len;
+  return UVWASI_ESUCCESS;
 }
 
 uint32_t WASI::SchedYield(WASI& wasi, WasmMemory) {
@@ -1249,6 +1284,180 @@ uint32_t WASI::SockShutdown(WASI& wasi,
   return uvwasi_sock_shutdown(&wasi.uvw_, sock, how);
 }
 
+// Runs an fd_read or fd_write on the threadpool. As the memory may grow, and
+// move, while the WebAssembly stack is suspended, the bytes go through a
+// buffer of our own: the iovecs are gathered into it before an fd_write and
+// scattered from it after an fd_read, each time with the memory at hand.
+class WASI::IOJob final : public ThreadPoolWork {
+ public:
+  struct Buffer {
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  IOJob(WASI* wasi,
+        Local<Promise::Resolver> resolver,
+        bool write,
+        uint32_t fd,
+        std::vector<Buffer>&& buffers,
+        size_t size,
+        uint32_t nio_ptr)
+      : ThreadPoolWork(wasi->env(),
+                       write ? "wasi_fd_write" : "wasi_fd_read",
+                       ThreadPoolWorkKind::kFs),
+        wasi_(wasi),
+        resolver_(wasi->env()->isolate(), resolver),
+        write_(write),
+        fd_(fd),
+        buffers_(std::move(buffers)),
+        data_(size),
+        nio_ptr_(nio_ptr) {}
+
+  static void Start(const FunctionCallbackInfo<Value>& args, bool write);
+
+  void DoThreadPoolWork() override {
+    if (write_) {
+      uvwasi_ciovec_t iov = {data_.data(),
+                             static_cast<uvwasi_size_t>(data_.size())};
+      err_ = uvwasi_fd_write(&wasi_->untracked_uvw_, fd_, &iov, 1, &nio_);
+    } else {
+      uvwasi_iovec_t iov = {data_.data(),
+                            static_cast<uvwasi_size_t>(data_.size())};
+      err_ = uvwasi_fd_read(&wasi_->untracked_uvw_, fd_, &iov, 1, &nio_);
+    }
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<IOJob> self(this);
+    Environment* env = this->env();
+    if (!env->can_call_into_js()) return;
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    uvwasi_errno_t err = status == UV_ECANCELED ? UVWASI_ECANCELED : err_;
+    if (err == UVWASI_ESUCCESS) err = CopyOut();
+    Local<Value> result = Integer::NewFromUnsigned(env->isolate(), err);
+    USE(PersistentToLocal::Strong(resolver_)->Resolve(env->context(), result));
+  }
+
+ private:
+  // Writes the number of bytes read or written, and the bytes read, into
+  // the memory as it is now.
+  uvwasi_errno_t CopyOut() {
+    Local<ArrayBuffer> ab =
+        PersistentToLocal::Strong(wasi_->memory_)->Buffer();
+    size_t mem_size = ab->ByteLength();
+    char* mem_data = static_cast<char*>(ab->Data());
+    CHECK_BOUNDS_OR_RETURN(mem_size, nio_ptr_, UVWASI_SERDES_SIZE_size_t);
+    if (!write_) {
+      size_t copied = 0;
+      for (const Buffer& buffer : buffers_) {
+        if (copied == nio_) break;
+        CHECK_BOUNDS_OR_RETURN(mem_size, buffer.offset, buffer.length);
+        size_t length = std::min<size_t>(buffer.length, nio_ - copied);
+        memcpy(mem_data + buffer.offset, data_.data() + copied, length);
+        copied += length;
+      }
+    }
+    uvwasi_serdes_write_size_t(mem_data, nio_ptr_, nio_);
+    return UVWASI_ESUCCESS;
+  }
+
+  BaseObjectPtr<WASI> wasi_;
+  v8::Global<Promise::Resolver> resolver_;
+  bool write_;
+  uint32_t fd_;
+  std::vector<Buffer> buffers_;
+  std::vector<char> data_;
+  uint32_t nio_ptr_;
+  uvwasi_errno_t err_ = UVWASI_ESUCCESS;
+  uvwasi_size_t nio_ = 0;
+};
+
+void WASI::IOJob::Start(const FunctionCallbackInfo<Value>& args, bool write) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(env->context()).ToLocal(&resolver)) return;
+  args.GetReturnValue().Set(resolver->GetPromise());
+
+  auto resolve = [&](uvwasi_errno_t err) {
+    USE(resolver->Resolve(env->context(),
+                          Integer::NewFromUnsigned(env->isolate(), err)));
+  };
+
+  if (args.Length() != 4 ||
+      !CheckTypes<uint32_t, uint32_t, uint32_t, uint32_t>(args)) {
+    return resolve(UVWASI_EINVAL);
+  }
+
+  WASI* wasi;
+  ASSIGN_OR_RETURN_UNWRAP(&wasi, args.This());
+  if (wasi->memory_.IsEmpty()) {
+    return THROW_ERR_WASI_NOT_STARTED(env);
+  }
+
+  uint32_t fd = args[0].As<Uint32>()->Value();
+  uint32_t iovs_ptr = args[1].As<Uint32>()->Value();
+  uint32_t iovs_len = args[2].As<Uint32>()->Value();
+  uint32_t nio_ptr = args[3].As<Uint32>()->Value();
+  Debug(*wasi,
+        "%s(%d, %d, %d, %d)\n",
+        write ? "fd_write_async" : "fd_read_async",
+        fd,
+        iovs_ptr,
+        iovs_len,
+        nio_ptr);
+
+  Local<ArrayBuffer> ab = PersistentToLocal::Strong(wasi->memory_)->Buffer();
+  size_t mem_size = ab->ByteLength();
+  char* mem_data = static_cast<char*>(ab->Data());
+  if (!uvwasi_serdes_check_bounds(
+          iovs_ptr, mem_size, iovs_len * UVWASI_SERDES_SIZE_iovec_t) ||
+      !uvwasi_serdes_check_bounds(
+          nio_ptr, mem_size, UVWASI_SERDES_SIZE_size_t)) {
+    return resolve(UVWASI_EOVERFLOW);
+  }
+
+  std::vector<Buffer> buffers(iovs_len);
+  size_t size = 0;
+  for (uint32_t i = 0; i < iovs_len; i++) {
+    size_t ptr = iovs_ptr + i * UVWASI_SERDES_SIZE_iovec_t;
+    buffers[i].offset = uvwasi_serdes_read_uint32_t(mem_data, ptr);
+    buffers[i].length = uvwasi_serdes_read_uint32_t(mem_data, ptr + 4);
+    if (!uvwasi_serdes_check_bounds(
+            buffers[i].offset, mem_size, buffers[i].length)) {
+      return resolve(UVWASI_EOVERFLOW);
+    }
+    size += buffers[i].length;
+  }
+  // The iovecs may overlap, but an fd_read or fd_write can never move more
+  // bytes than fit in a uvwasi_size_t.
+  if (size > std::numeric_limits<uvwasi_size_t>::max()) {
+    return resolve(UVWASI_EINVAL);
+  }
+
+  auto job = new IOJob(
+      wasi, resolver, write, fd, std::move(buffers), size, nio_ptr);
+  if (write) {
+    size_t copied = 0;
+    for (const Buffer& buffer : job->buffers_) {
+      memcpy(job->data_.data() + copied,
+             mem_data + buffer.offset,
+             buffer.length);
+      copied += buffer.length;
+    }
+  }
+  job->ScheduleWork();
+}
+
+void WASI::FdReadAsync(const FunctionCallbackInfo<Value>& args) {
+  IOJob::Start(args, false);
+}
+
+void WASI::FdWriteAsync(const FunctionCallbackInfo<Value>& args) {
+  IOJob::Start(args, true);
+}
+
 void WASI::_SetMemory(const FunctionCallbackInfo<Value>& args) {
   WASI* wasi;
   ASSIGN_OR_RETURN_UNWRAP(&wasi, args.This());
@@ -1324,6 +1533,8 @@ static void InitializePreview1(Local<Object> target,
 #undef V
 
   SetInstanceMethod(isolate, tmpl, "_setMemory", WASI::_SetMemory);
+  SetProtoMethod(isolate, tmpl, "fd_read_async", WASI::FdReadAsync);
+  SetProtoMethod(isolate, tmpl, "fd_write_async", WASI::FdWriteAsync);
 
   SetConstructorFunction(context, target, "WASI", tmpl);
 }
@@ -146,6 +146,14 @@ class WASI : public BaseObject,
 
   static void _SetMemory(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Asynchronous versions of fd_read and fd_write for JavaScript Promise
+  // Integration. They take the same arguments as the synchronous ones but
+  // return a promise for the errno. Imported through WebAssembly.Suspending,
+  // they suspend the calling WebAssembly stack while the threadpool does the
+  // I/O, and the event loop keeps running.
+  static void FdReadAsync(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FdWriteAsync(const v8::FunctionCallbackInfo<v8::Value>& args);
+
   // Implementation for mem::NgLibMemoryManager
   void CheckAllocatedSize(size_t previous_size) const;
   void IncreaseAllocatedSize(size_t size);
@@ -168,8 +176,21 @@ class WASI : public BaseObject,
   };
 
  private:
+  class IOJob;
+
   ~WASI() override;
   uvwasi_t uvw_;
+  // A shallow copy of uvw_ that shares the fd table, which uvwasi locks, but
+  // allocates with plain malloc(). The allocator of uvw_ reports to the
+  // isolate, which must not happen off the main thread and is not worth it
+  // for the iovecs that fd_read and fd_write allocate and free in a call.
+  uvwasi_t untracked_uvw_;
+  // Bytes from the CSPRNG that random_get hands out in small pieces, so that
+  // a module that asks for a few bytes at a time, such as for every UUID it
+  // generates, does not make a system call each time. Handed out bytes are
+  // wiped.
+  uint8_t random_pool_[256];
+  size_t random_pool_offset_ = sizeof(random_pool_);
   v8::Global<v8::WasmMemoryObject> memory_;
   uvwasi_mem_t alloc_info_;
   size_t current_uvwasi_memory_ = 0;
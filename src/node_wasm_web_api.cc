@@ -1,5 +1,7 @@
 #include "node_wasm_web_api.h"
 
+#include "compile_cache.h"
+#include "env-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
@@ -44,6 +46,7 @@ Local<Function> WasmStreamingObject::Initialize(Environment* env) {
 void WasmStreamingObject::RegisterExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(New);
+  registry->Register(SetURL);
   registry->Register(Push);
   registry->Register(Finish);
   registry->Register(Abort);
@@ -86,8 +89,31 @@ void WasmStreamingObject::SetURL(const FunctionCallbackInfo<Value>& args) {
 
   CHECK_EQ(args.Length(), 1);
   CHECK(args[0]->IsString());
-  Utf8Value url(Environment::GetCurrent(args)->isolate(), args[0]);
+  Environment* env = Environment::GetCurrent(args);
+  Utf8Value url(env->isolate(), args[0]);
   obj->streaming_->SetUrl(url.out(), url.length());
+
+  // V8 only takes a cache before the first bytes.
+  if (env->use_compile_cache() && url.length() > 0 && obj->wasm_size_ == 0) {
+    obj->SetUpCompileCache(env, url.ToStringView());
+  }
+}
+
+void WasmStreamingObject::SetUpCompileCache(Environment* env,
+                                            std::string_view url) {
+  CompileCacheHandler* handler = env->compile_cache_handler();
+  CompileCacheEntry* entry = handler->GetOrInsertWasm(url);
+  if (entry->cache != nullptr) {
+    cache_.reset(entry->CopyCache());
+    if (streaming_->SetCompiledModuleBytes(cache_->data, cache_->length)) {
+      cache_code_hash_ = entry->code_hash;
+      cache_code_size_ = entry->code_size;
+    } else {
+      cache_.reset();
+    }
+  }
+  streaming_->SetMoreFunctionsCanBeSerializedCallback(
+      handler->GetWasmSerializer(entry));
 }
 
 void WasmStreamingObject::Push(const FunctionCallbackInfo<Value>& args) {
@@ -124,6 +150,10 @@ void WasmStreamingObject::Push(const FunctionCallbackInfo<Value>& args) {
   obj->streaming_->OnBytesReceived(static_cast<const uint8_t*>(bytes) + offset,
                                    size);
   obj->wasm_size_ += size;
+  if (obj->cache_ != nullptr) {
+    obj->wasm_hash_ = UpdateHash(
+        obj->wasm_hash_, static_cast<const char*>(bytes) + offset, size);
+  }
 }
 
 void WasmStreamingObject::Finish(const FunctionCallbackInfo<Value>& args) {
@@ -132,7 +162,12 @@ void WasmStreamingObject::Finish(const FunctionCallbackInfo<Value>& args) {
   CHECK(obj->streaming_);
 
   CHECK_EQ(args.Length(), 0);
-  obj->streaming_->Finish();
+  // The cache is that of whatever was last fetched from the same URL, so V8
+  // may only use it if the module turned out to be the same.
+  bool can_use_cache = obj->cache_ == nullptr ||
+                       (obj->wasm_size_ == obj->cache_code_size_ &&
+                        obj->wasm_hash_ == obj->cache_code_hash_);
+  obj->streaming_->Finish(can_use_cache);
 }
 
 void WasmStreamingObject::Abort(const FunctionCallbackInfo<Value>& args) {
@@ -38,8 +38,20 @@ class WasmStreamingObject final : public BaseObject {
   static void Finish(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Abort(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Hands V8 the code cache of the module last fetched from `url`, and has
+  // it save the code of this one as it tiers up.
+  void SetUpCompileCache(Environment* env, std::string_view url);
+
   std::shared_ptr<v8::WasmStreaming> streaming_;
   size_t wasm_size_ = 0;
+
+  // The code cache offered to V8, which has to stay alive until the
+  // compilation is finished, and what the bytes received have to add up to
+  // for V8 to be allowed to use it.
+  std::unique_ptr<v8::ScriptCompiler::CachedData> cache_;
+  uint32_t cache_code_hash_ = 0;
+  uint32_t cache_code_size_ = 0;
+  uint32_t wasm_hash_ = 0;
 };
 
 // This is a v8::WasmStreamingCallback implementation that must be passed to
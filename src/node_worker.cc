@@ -6,17 +6,29 @@
 #include "node_buffer.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "node_internals.h"
 #include "node_options-inl.h"
 #include "node_perf.h"
+#include "node_shared_arena.h"
 #include "node_snapshot_builder.h"
 #include "permission/permission.h"
 #include "util-inl.h"
 #include "v8-cppgc.h"
 
+#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
+#ifdef __APPLE__
+#include <mach/mach.h>
+#elif !defined(_WIN32)
+#include <pthread.h>
+#include <time.h>
+#endif
+
 using node::kAllowedInEnvvar;
 using node::kDisallowedInEnvvar;
 using v8::Array;
@@ -26,12 +38,17 @@ using v8::Context;
 using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::GCCallbackFlags;
+using v8::GCType;
 using v8::HandleScope;
+using v8::HeapStatistics;
+using v8::Int32;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::Locker;
 using v8::Maybe;
+using v8::MemoryPressureLevel;
 using v8::Null;
 using v8::Number;
 using v8::Object;
@@ -40,6 +57,7 @@ using v8::ResourceConstraints;
 using v8::SealHandleScope;
 using v8::String;
 using v8::TryCatch;
+using v8::Uint32;
 using v8::Value;
 
 namespace node {
@@ -47,6 +65,47 @@ namespace worker {
 
 constexpr double kMB = 1024 * 1024;
 
+namespace {
+
+// Returns the CPU time that `thread` has used so far in microseconds. The
+// thread must not have exited yet.
+std::optional<uint64_t> GetThreadCpuTime(uv_thread_t* thread) {
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(
+          *thread, &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return std::nullopt;
+  }
+  auto to_100ns = [](const FILETIME& time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) |
+           time.dwLowDateTime;
+  };
+  return (to_100ns(kernel_time) + to_100ns(user_time)) / 10;
+#elif defined(__APPLE__)
+  thread_basic_info_data_t info;
+  mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+  if (thread_info(pthread_mach_thread_np(*thread),
+                  THREAD_BASIC_INFO,
+                  reinterpret_cast<thread_info_t>(&info),
+                  &count) != KERN_SUCCESS) {
+    return std::nullopt;
+  }
+  uint64_t seconds = info.user_time.seconds + info.system_time.seconds;
+  return seconds * 1000000 + info.user_time.microseconds +
+         info.system_time.microseconds;
+#else
+  clockid_t clock;
+  timespec ts;
+  if (pthread_getcpuclockid(*thread, &clock) != 0 ||
+      clock_gettime(clock, &ts) != 0) {
+    return std::nullopt;
+  }
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+}  // anonymous namespace
+
 Worker::Worker(Environment* env,
                Local<Object> wrap,
                const std::string& url,
@@ -63,6 +122,7 @@ Worker::Worker(Environment* env,
       name_(name),
       env_vars_(env_vars),
       embedder_preload_(env->embedder_preload()),
+      isolate_pool_(env->worker_isolate_pool()),
       snapshot_data_(snapshot_data) {
   Debug(this, "Creating new worker instance with thread id %llu",
         thread_id_.id);
@@ -136,6 +196,270 @@ void Worker::UpdateResourceConstraints(ResourceConstraints* constraints) {
   }
 }
 
+namespace {
+
+// Disposes of an isolate created through NewIsolate() along with its
+// IsolateData, and waits on `loop` until the platform has released all
+// resources associated with the isolate.
+void DisposeWorkerIsolate(
+    MultiIsolatePlatform* platform,
+    Isolate* isolate,
+    DeleteFnPtr<IsolateData, FreeIsolateData>* isolate_data,
+    uv_loop_t* loop) {
+  bool platform_finished = false;
+
+  // https://github.com/nodejs/node/issues/51129 - IsolateData destructor
+  // can kick off GC before teardown, so ensure the isolate is entered.
+  {
+    Locker locker(isolate);
+    Isolate::Scope isolate_scope(isolate);
+    isolate_data->reset();
+  }
+
+  platform->AddIsolateFinishedCallback(isolate, [](void* data) {
+    *static_cast<bool*>(data) = true;
+  }, &platform_finished);
+
+  // The order of these calls is important; if the Isolate is first disposed
+  // and then unregistered, there is a race condition window in which no
+  // new Isolate at the same address can successfully be registered with
+  // the platform.
+  // (Refs: https://github.com/nodejs/node/issues/30846)
+  platform->UnregisterIsolate(isolate);
+  isolate->Dispose();
+
+  // Wait until the platform has cleaned up all relevant resources.
+  while (!platform_finished) {
+    uv_run(loop, UV_RUN_ONCE);
+  }
+}
+
+// Shares the memory set aside by --worker-heap-budget between the heaps of
+// all Workers without an explicit maxOldGenerationSizeMb. Each Worker starts
+// out with a fraction of the budget. Its heap limit is raised from
+// Worker::NearHeapLimit() while the budget has room, and lowered again by
+// V8 once the heap has shrunk far enough.
+class WorkerHeapBudget {
+ public:
+  static constexpr size_t kMinGrant = 32 * 1024 * 1024;
+
+  // Returns nullptr if there is no budget.
+  static WorkerHeapBudget* Get() {
+    static WorkerHeapBudget* budget = []() -> WorkerHeapBudget* {
+      uint64_t percent = per_process::cli_options->worker_heap_budget;
+      if (percent == 0) return nullptr;
+      // The same amount of memory that SetIsolateCreateParamsForNode() bases
+      // the default heap limits on, which respects cgroup limits.
+      const uint64_t constrained_memory = uv_get_constrained_memory();
+      const uint64_t total_memory =
+          constrained_memory > 0
+              ? std::min(uv_get_total_memory(), constrained_memory)
+              : uv_get_total_memory();
+      if (total_memory == 0) return nullptr;
+      return new WorkerHeapBudget(total_memory / 100 * percent);
+    }();
+    return budget;
+  }
+
+  // Returns the initial grant for a Worker whose heap limit would be
+  // `default_limit` without the budget.
+  size_t Reserve(size_t default_limit) {
+    Mutex::ScopedLock lock(mutex_);
+    size_t grant = std::min({total_ / 8, total_ - std::min(committed_, total_),
+                             default_limit});
+    grant = std::min(std::max(grant, kMinGrant), default_limit);
+    committed_ += grant;
+    return grant;
+  }
+
+  // Returns how much more than `grant` a Worker may use, at most `step`, or
+  // 0 if the budget is exhausted. `*grant` is updated accordingly.
+  size_t Grow(size_t* grant, size_t step) {
+    Mutex::ScopedLock lock(mutex_);
+    size_t available = total_ - std::min(committed_, total_);
+    size_t delta = std::min(step, available);
+    committed_ += delta;
+    *grant += delta;
+    return delta;
+  }
+
+  void Release(size_t bytes) {
+    Mutex::ScopedLock lock(mutex_);
+    CHECK_GE(committed_, bytes);
+    committed_ -= bytes;
+  }
+
+  void AddIsolate(Isolate* isolate) {
+    Mutex::ScopedLock lock(mutex_);
+    isolates_.insert(isolate);
+  }
+
+  void RemoveIsolate(Isolate* isolate) {
+    Mutex::ScopedLock lock(mutex_);
+    isolates_.erase(isolate);
+  }
+
+  // Asks all Workers but the one that owns `isolate` to collect garbage, so
+  // that they give back unused parts of their grants.
+  void RequestMemoryFromOthers(Isolate* isolate) {
+    Mutex::ScopedLock lock(mutex_);
+    for (Isolate* other : isolates_) {
+      // This may be called while the other isolate is running JS code.
+      if (other != isolate)
+        other->MemoryPressureNotification(MemoryPressureLevel::kCritical);
+    }
+  }
+
+ private:
+  explicit WorkerHeapBudget(size_t total) : total_(total) {}
+
+  const size_t total_;
+  Mutex mutex_;
+  size_t committed_ = 0;
+  std::unordered_set<Isolate*> isolates_;
+};
+
+}  // anonymous namespace
+
+// An isolate that has been created ahead of time, along with the event loop
+// it is registered with and its IsolateData. It is not bound to any thread
+// or Worker yet.
+struct PooledIsolate {
+  ~PooledIsolate() {
+    if (isolate != nullptr)
+      DisposeWorkerIsolate(platform, isolate, &isolate_data, loop.get());
+    if (loop) CheckedUvLoopClose(loop.get());
+  }
+
+  MultiIsolatePlatform* platform = nullptr;
+  std::unique_ptr<uv_loop_t> loop;
+  Isolate* isolate = nullptr;
+  DeleteFnPtr<IsolateData, FreeIsolateData> isolate_data;
+};
+
+// Keeps a number of isolates around that are deserialized from the snapshot
+// of the parent thread on a background thread, so that Workers which use
+// the default heap limits do not have to wait for that when they start.
+class WorkerIsolatePool {
+ public:
+  WorkerIsolatePool(MultiIsolatePlatform* platform,
+                    const SnapshotData* snapshot_data)
+      : platform_(platform), snapshot_data_(snapshot_data) {}
+
+  ~WorkerIsolatePool() {
+    {
+      Mutex::ScopedLock lock(mutex_);
+      stopping_ = true;
+      cond_.Signal(lock);
+    }
+    if (filler_thread_.has_value())
+      CHECK_EQ(uv_thread_join(&filler_thread_.value()), 0);
+  }
+
+  WorkerIsolatePool(const WorkerIsolatePool&) = delete;
+  WorkerIsolatePool& operator=(const WorkerIsolatePool&) = delete;
+
+  // Sets the number of idle isolates to keep around.
+  void SetSize(size_t size) {
+    std::deque<std::unique_ptr<PooledIsolate>> excess;
+    Mutex::ScopedLock lock(mutex_);
+    size_ = size;
+    while (isolates_.size() > size_) {
+      excess.emplace_back(std::move(isolates_.back()));
+      isolates_.pop_back();
+    }
+    if (size_ > 0 && !filler_thread_.has_value()) {
+      auto run = [](void* arg) {
+        static_cast<WorkerIsolatePool*>(arg)->RunFiller();
+      };
+      // If no thread can be created, the pool simply stays empty.
+      if (uv_thread_create(&filler_thread_.emplace(), run, this) != 0)
+        filler_thread_.reset();
+    }
+    cond_.Signal(lock);
+    // Dispose of the excess isolates without holding the lock.
+    Mutex::ScopedUnlock unlock(lock);
+    excess.clear();
+  }
+
+  // Returns an idle isolate, or nullptr if there is none. This may be called
+  // from any thread.
+  std::unique_ptr<PooledIsolate> Take() {
+    Mutex::ScopedLock lock(mutex_);
+    if (isolates_.empty()) return nullptr;
+    std::unique_ptr<PooledIsolate> isolate = std::move(isolates_.front());
+    isolates_.pop_front();
+    cond_.Signal(lock);
+    return isolate;
+  }
+
+  const SnapshotData* snapshot_data() const { return snapshot_data_; }
+
+ private:
+  void RunFiller() {
+    Mutex::ScopedLock lock(mutex_);
+    while (true) {
+      while (!stopping_ && isolates_.size() >= size_) cond_.Wait(lock);
+      if (stopping_) return;
+      std::unique_ptr<PooledIsolate> isolate;
+      {
+        Mutex::ScopedUnlock unlock(lock);
+        isolate = CreateIsolate();
+      }
+      // Workers create their own isolates if this keeps failing.
+      if (!isolate) return;
+      isolates_.emplace_back(std::move(isolate));
+    }
+  }
+
+  // This mirrors what WorkerThreadData does for Workers with the default
+  // resource limits, except for the parts that depend on the Worker.
+  std::unique_ptr<PooledIsolate> CreateIsolate() {
+    auto pooled = std::make_unique<PooledIsolate>();
+    pooled->platform = platform_;
+    auto loop = std::make_unique<uv_loop_t>();
+    if (uv_loop_init(loop.get()) != 0) return nullptr;
+    pooled->loop = std::move(loop);
+    uv_loop_configure(pooled->loop.get(), UV_METRICS_IDLE_TIME);
+
+    std::shared_ptr<ArrayBufferAllocator> allocator =
+        ArrayBufferAllocator::Create();
+    Isolate::CreateParams params;
+    SetIsolateCreateParamsForNode(&params);
+    params.array_buffer_allocator_shared = allocator;
+    Isolate* isolate =
+        NewIsolate(&params, pooled->loop.get(), platform_, snapshot_data_);
+    if (isolate == nullptr) return nullptr;
+    SetIsolateUpForNode(isolate);
+
+    {
+      Locker locker(isolate);
+      Isolate::Scope isolate_scope(isolate);
+      HandleScope handle_scope(isolate);
+      pooled->isolate_data.reset(
+          CreateIsolateData(isolate,
+                            pooled->loop.get(),
+                            platform_,
+                            allocator.get(),
+                            snapshot_data_->AsEmbedderWrapper().get()));
+    }
+    pooled->isolate = isolate;
+    CHECK(pooled->isolate_data);
+    return pooled;
+  }
+
+  MultiIsolatePlatform* const platform_;
+  const SnapshotData* const snapshot_data_;
+
+  // This mutex protects access to all variables listed below it.
+  Mutex mutex_;
+  ConditionVariable cond_;
+  std::deque<std::unique_ptr<PooledIsolate>> isolates_;
+  size_t size_ = 0;
+  bool stopping_ = false;
+  std::optional<uv_thread_t> filler_thread_;
+};
+
 // This class contains data that is only relevant to the child thread itself,
 // and only while it is running.
 // (Eventually, the Environment instance should probably also be moved here.)
@@ -143,39 +467,86 @@ class WorkerThreadData {
  public:
   explicit WorkerThreadData(Worker* w)
     : w_(w) {
-    int ret = uv_loop_init(&loop_);
-    if (ret != 0) {
-      char err_buf[128];
-      uv_err_name_r(ret, err_buf, sizeof(err_buf));
-      // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
-      w->Exit(ExitCode::kGenericUserError, "ERR_WORKER_INIT_FAILED", err_buf);
-      return;
+    WorkerHeapBudget* budget = WorkerHeapBudget::Get();
+    if (budget != nullptr &&
+        w->resource_limits_[kMaxOldGenerationSizeMb] <= 0) {
+      Isolate::CreateParams defaults;
+      SetIsolateCreateParamsForNode(&defaults);
+      w->heap_budget_max_grant_ =
+          defaults.constraints.max_old_generation_size_in_bytes();
+      w->heap_budget_grant_ = w->heap_budget_initial_grant_ =
+          budget->Reserve(w->heap_budget_max_grant_);
+      w->resource_limits_[kMaxOldGenerationSizeMb] =
+          w->heap_budget_grant_ / kMB;
+    }
+
+    // Isolates from the pool are created with the default heap limits.
+    std::unique_ptr<PooledIsolate> pooled;
+    if (w->isolate_pool_ &&
+        w->isolate_pool_->snapshot_data() == w->snapshot_data() &&
+        w->resource_limits_[kMaxYoungGenerationSizeMb] <= 0 &&
+        w->resource_limits_[kMaxOldGenerationSizeMb] <= 0 &&
+        w->resource_limits_[kCodeRangeSizeMb] <= 0 &&
+        w->numa_node_ < 0) {
+      // Pooled isolates have their heap on whichever node the pool's
+      // thread ran on.
+      pooled = w->isolate_pool_->Take();
     }
-    loop_init_failed_ = false;
-    uv_loop_configure(&loop_, UV_METRICS_IDLE_TIME);
 
-    std::shared_ptr<ArrayBufferAllocator> allocator =
-        ArrayBufferAllocator::Create();
     Isolate::CreateParams params;
     SetIsolateCreateParamsForNode(&params);
     w->UpdateResourceConstraints(&params.constraints);
-    params.array_buffer_allocator_shared = allocator;
-    Isolate* isolate =
-        NewIsolate(&params, &loop_, w->platform_, w->snapshot_data());
-    if (isolate == nullptr) {
-      // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
-      w->Exit(ExitCode::kGenericUserError,
-              "ERR_WORKER_INIT_FAILED",
-              "Failed to create new Isolate");
-      return;
-    }
 
-    SetIsolateUpForNode(isolate);
+    std::shared_ptr<ArrayBufferAllocator> allocator;
+    Isolate* isolate;
+    if (pooled) {
+      Debug(w, "Worker %llu uses a pooled isolate", w->thread_id_.id);
+      loop_ = std::move(pooled->loop);
+      loop_init_failed_ = false;
+      isolate = pooled->isolate;
+      isolate_data_ = std::move(pooled->isolate_data);
+      pooled->isolate = nullptr;
+    } else {
+      loop_ = std::make_unique<uv_loop_t>();
+      int ret = uv_loop_init(loop_.get());
+      if (ret != 0) {
+        char err_buf[128];
+        uv_err_name_r(ret, err_buf, sizeof(err_buf));
+        // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
+        w->Exit(ExitCode::kGenericUserError, "ERR_WORKER_INIT_FAILED", err_buf);
+        return;
+      }
+      loop_init_failed_ = false;
+      uv_loop_configure(loop_.get(), UV_METRICS_IDLE_TIME);
+
+      allocator = ArrayBufferAllocator::Create();
+      params.array_buffer_allocator_shared = allocator;
+      isolate =
+          NewIsolate(&params, loop_.get(), w->platform_, w->snapshot_data());
+      if (isolate == nullptr) {
+        // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
+        w->Exit(ExitCode::kGenericUserError,
+                "ERR_WORKER_INIT_FAILED",
+                "Failed to create new Isolate");
+        return;
+      }
+
+      SetIsolateUpForNode(isolate);
+    }
 
     // Be sure it's called before Environment::InitializeDiagnostics()
     // so that this callback stays when the callback of
     // --heapsnapshot-near-heap-limit gets is popped.
     isolate->AddNearHeapLimitCallback(Worker::NearHeapLimit, w);
+    isolate->AddGCPrologueCallback(Worker::GCPrologue, w);
+    isolate->AddGCEpilogueCallback(Worker::GCEpilogue, w);
+    if (w->heap_budget_grant_ > 0) {
+      // Once the heap has shrunk below half of the initial limit, let V8 go
+      // back to that limit. Worker::UpdateHeapUsage() then returns the
+      // difference to the budget.
+      isolate->AutomaticallyRestoreInitialHeapLimit(0.5);
+      budget->AddIsolate(isolate);
+    }
 
     {
       Locker locker(isolate);
@@ -184,13 +555,15 @@ class WorkerThreadData {
       // --stack-size. Reset it to the correct value.
       isolate->SetStackLimit(w->stack_base_);
 
-      HandleScope handle_scope(isolate);
-      isolate_data_.reset(
-          CreateIsolateData(isolate,
-                            &loop_,
-                            w_->platform_,
-                            allocator.get(),
-                            w->snapshot_data()->AsEmbedderWrapper().get()));
+      if (!isolate_data_) {
+        HandleScope handle_scope(isolate);
+        isolate_data_.reset(
+            CreateIsolateData(isolate,
+                              loop_.get(),
+                              w_->platform_,
+                              allocator.get(),
+                              w->snapshot_data()->AsEmbedderWrapper().get()));
+      }
       CHECK(isolate_data_);
       CHECK(!isolate_data_->is_building_snapshot());
       if (w_->per_isolate_opts_)
@@ -198,6 +571,7 @@ class WorkerThreadData {
       isolate_data_->set_worker_context(w_);
       isolate_data_->max_young_gen_size =
           params.constraints.max_young_generation_size_in_bytes();
+      w->UpdateHeapUsage(isolate);
     }
 
     Mutex::ScopedLock lock(w_->mutex_);
@@ -213,37 +587,19 @@ class WorkerThreadData {
       w_->isolate_ = nullptr;
     }
 
+    if (w_->heap_budget_grant_ > 0) {
+      WorkerHeapBudget* budget = WorkerHeapBudget::Get();
+      if (isolate != nullptr) budget->RemoveIsolate(isolate);
+      budget->Release(w_->heap_budget_grant_);
+      w_->heap_budget_grant_ = 0;
+    }
+
     if (isolate != nullptr) {
       CHECK(!loop_init_failed_);
-      bool platform_finished = false;
-
-      // https://github.com/nodejs/node/issues/51129 - IsolateData destructor
-      // can kick off GC before teardown, so ensure the isolate is entered.
-      {
-        Locker locker(isolate);
-        Isolate::Scope isolate_scope(isolate);
-        isolate_data_.reset();
-      }
-
-      w_->platform_->AddIsolateFinishedCallback(isolate, [](void* data) {
-        *static_cast<bool*>(data) = true;
-      }, &platform_finished);
-
-      // The order of these calls is important; if the Isolate is first disposed
-      // and then unregistered, there is a race condition window in which no
-      // new Isolate at the same address can successfully be registered with
-      // the platform.
-      // (Refs: https://github.com/nodejs/node/issues/30846)
-      w_->platform_->UnregisterIsolate(isolate);
-      isolate->Dispose();
-
-      // Wait until the platform has cleaned up all relevant resources.
-      while (!platform_finished) {
-        uv_run(&loop_, UV_RUN_ONCE);
-      }
+      DisposeWorkerIsolate(w_->platform_, isolate, &isolate_data_, loop_.get());
     }
     if (!loop_init_failed_) {
-      CheckedUvLoopClose(&loop_);
+      CheckedUvLoopClose(loop_.get());
     }
   }
 
@@ -251,7 +607,7 @@ class WorkerThreadData {
 
  private:
   Worker* const w_;
-  uv_loop_t loop_;
+  std::unique_ptr<uv_loop_t> loop_;
   bool loop_init_failed_ = true;
   DeleteFnPtr<IsolateData, FreeIsolateData> isolate_data_;
   const SnapshotData* snapshot_data_ = nullptr;
@@ -265,6 +621,30 @@ size_t Worker::NearHeapLimit(void* data, size_t current_heap_limit,
   // crash hard. We are not going to perform further allocations anyway.
   constexpr size_t kExtraHeapAllowance = 16 * 1024 * 1024;
   size_t new_limit = current_heap_limit + kExtraHeapAllowance;
+
+  if (worker->heap_budget_grant_ > 0) {
+    // Grow the heap by half of its current limit where the budget allows it.
+    WorkerHeapBudget* budget = WorkerHeapBudget::Get();
+    size_t step = std::min(
+        std::max(current_heap_limit / 2, WorkerHeapBudget::kMinGrant),
+        worker->heap_budget_max_grant_ -
+            std::min(worker->heap_budget_grant_,
+                     worker->heap_budget_max_grant_));
+    size_t delta = budget->Grow(&worker->heap_budget_grant_, step);
+    if (delta > 0) {
+      worker->heap_budget_pressure_sent_ = false;
+      worker->heap_size_limit_ = current_heap_limit + delta;
+      return worker->heap_size_limit_;
+    }
+    // Before giving up, make the other Workers collect garbage, which may
+    // return parts of their grants, and try again the next time.
+    if (!worker->heap_budget_pressure_sent_) {
+      worker->heap_budget_pressure_sent_ = true;
+      budget->RequestMemoryFromOthers(worker->isolate_);
+      return new_limit;
+    }
+  }
+
   Environment* env = worker->env();
   if (env != nullptr) {
     DCHECK(!env->is_in_heapsnapshot_heap_limit_callback());
@@ -281,6 +661,57 @@ size_t Worker::NearHeapLimit(void* data, size_t current_heap_limit,
   return new_limit;
 }
 
+void Worker::GCPrologue(Isolate* isolate,
+                        GCType type,
+                        GCCallbackFlags flags,
+                        void* data) {
+  Worker* worker = static_cast<Worker*>(data);
+  // V8 does not count allocated bytes for us, so use the growth of the heap
+  // since the end of the previous GC as an approximation.
+  HeapStatistics stats;
+  isolate->GetHeapStatistics(&stats);
+  if (stats.used_heap_size() > worker->used_heap_size_after_gc_) {
+    worker->resource_usage_[kAllocatedBytes].fetch_add(
+        stats.used_heap_size() - worker->used_heap_size_after_gc_,
+        std::memory_order_relaxed);
+  }
+  worker->gc_start_time_ = uv_hrtime();
+}
+
+void Worker::GCEpilogue(Isolate* isolate,
+                        GCType type,
+                        GCCallbackFlags flags,
+                        void* data) {
+  Worker* worker = static_cast<Worker*>(data);
+  worker->resource_usage_[kGCCount].fetch_add(1, std::memory_order_relaxed);
+  worker->resource_usage_[kGCPauseTimeUs].fetch_add(
+      uv_hrtime() - worker->gc_start_time_, std::memory_order_relaxed);
+  worker->UpdateHeapUsage(isolate);
+}
+
+void Worker::UpdateHeapUsage(Isolate* isolate) {
+  HeapStatistics stats;
+  isolate->GetHeapStatistics(&stats);
+  used_heap_size_after_gc_ = stats.used_heap_size();
+  if (heap_budget_grant_ > 0 && stats.heap_size_limit() < heap_size_limit_) {
+    // V8 has restored the initial heap limit.
+    size_t release =
+        std::min(heap_size_limit_ - stats.heap_size_limit(),
+                 heap_budget_grant_ - heap_budget_initial_grant_);
+    WorkerHeapBudget::Get()->Release(release);
+    heap_budget_grant_ -= release;
+  }
+  heap_size_limit_ = stats.heap_size_limit();
+  resource_usage_[kUsedHeapSize].store(stats.used_heap_size(),
+                                       std::memory_order_relaxed);
+  resource_usage_[kTotalHeapSize].store(stats.total_heap_size(),
+                                        std::memory_order_relaxed);
+  resource_usage_[kHeapSizeLimit].store(stats.heap_size_limit(),
+                                        std::memory_order_relaxed);
+  resource_usage_[kExternalMemory].store(stats.external_memory(),
+                                         std::memory_order_relaxed);
+}
+
 void Worker::Run() {
   std::string trace_name = "[worker " + std::to_string(thread_id_.id) + "]" +
                            (name_ == "" ? "" : " " + name_);
@@ -309,6 +740,8 @@ void Worker::Run() {
 
       if (!env_) return;
       env_->set_can_call_into_js(false);
+      // The isolate is disposed once the Environment is gone.
+      env_->set_discarding(true);
 
       {
         Mutex::ScopedLock lock(mutex_);
@@ -400,6 +833,7 @@ void Worker::Run() {
 
     {
       Maybe<ExitCode> exit_code = SpinEventLoopInternal(env_.get());
+      UpdateHeapUsage(isolate_);
       Mutex::ScopedLock lock(mutex_);
       if (exit_code_ == ExitCode::kNoFailure && exit_code.IsJust()) {
         exit_code_ = exit_code.FromJust();
@@ -691,8 +1125,16 @@ void Worker::StartThread(const FunctionCallbackInfo<Value>& args) {
     // some space to do work in C++ land.
     w->stack_base_ = stack_top - (w->stack_size_ - kStackBufferSize);
 
+    // Before anything is allocated, so that the heap of the isolate faults
+    // its pages in on the right node.
+    w->ApplyPlacement();
     w->Run();
 
+    uv_thread_t self = uv_thread_self();
+    w->resource_usage_[kCpuTimeUs].store(GetThreadCpuTime(&self).value_or(0),
+                                         std::memory_order_relaxed);
+    w->cpu_time_final_.store(true, std::memory_order_release);
+
     Mutex::ScopedLock lock(w->mutex_);
     w->env()->SetImmediateThreadsafe(
         [w = std::unique_ptr<Worker>(w)](Environment* env) {
@@ -749,6 +1191,63 @@ void Worker::HasRef(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(w->has_ref_);
 }
 
+// Called with the NUMA node, or -1, and an array of CPUs before the thread is
+// started. If only the node is given, the thread may run on all of its CPUs.
+// Returns false if the node has no CPUs.
+void Worker::SetPlacement(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
+  Environment* env = w->env();
+  CHECK(args[0]->IsInt32());
+  CHECK(args[1]->IsArray());
+
+  int numa_node = args[0].As<Int32>()->Value();
+  Local<Array> array = args[1].As<Array>();
+  std::vector<int> cpus;
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> cpu;
+    if (!array->Get(env->context(), i).ToLocal(&cpu)) return;
+    CHECK(cpu->IsInt32());
+    cpus.push_back(cpu.As<Int32>()->Value());
+  }
+  if (numa_node >= 0 && cpus.empty()) {
+    for (const os::CPUTopology& info : os::GetCPUTopology()) {
+      if (info.numa_node == numa_node) cpus.push_back(info.cpu);
+    }
+    if (cpus.empty()) return args.GetReturnValue().Set(false);
+  }
+
+  Mutex::ScopedLock lock(w->mutex_);
+  CHECK(!w->tid_.has_value());
+  w->numa_node_ = numa_node;
+  w->cpu_affinity_ = std::move(cpus);
+  args.GetReturnValue().Set(true);
+}
+
+// Placement is best effort: a Worker that cannot be pinned still runs.
+void Worker::ApplyPlacement() {
+  uv_thread_t self = uv_thread_self();
+  if (!cpu_affinity_.empty()) {
+    int err = os::SetThreadAffinity(&self, cpu_affinity_);
+    if (err != 0) {
+      Debug(this,
+            "Worker %llu could not set its CPU affinity: %s",
+            thread_id_.id,
+            uv_err_name(err));
+    }
+  }
+  if (numa_node_ >= 0) {
+    int err = os::SetCurrentThreadMemoryNode(numa_node_);
+    if (err != 0) {
+      Debug(this,
+            "Worker %llu could not prefer NUMA node %d: %s",
+            thread_id_.id,
+            numa_node_,
+            uv_err_name(err));
+    }
+  }
+}
+
 void Worker::Unref(const FunctionCallbackInfo<Value>& args) {
   Worker* w;
   ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
@@ -771,6 +1270,37 @@ Local<Float64Array> Worker::GetResourceLimits(Isolate* isolate) const {
   return Float64Array::New(ab, 0, kTotalResourceLimitCount);
 }
 
+void Worker::GetResourceUsage(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), kTotalResourceUsageFieldCount);
+  double* fields = static_cast<double*>(array->Buffer()->Data()) +
+                   array->ByteOffset() / sizeof(double);
+
+  for (int i = 0; i < kTotalResourceUsageFieldCount; i++) {
+    fields[i] = static_cast<double>(
+        w->resource_usage_[i].load(std::memory_order_relaxed));
+  }
+  fields[kGCPauseTimeUs] /= 1e3;
+
+  // tid_ is only modified on this thread. If the thread has not stopped
+  // after its clock was read, the value is accurate; otherwise, use the final
+  // value that the thread stored itself.
+  if (w->tid_.has_value() &&
+      !w->cpu_time_final_.load(std::memory_order_acquire)) {
+    std::optional<uint64_t> cpu_time = GetThreadCpuTime(&w->tid_.value());
+    if (cpu_time.has_value() &&
+        !w->cpu_time_final_.load(std::memory_order_acquire)) {
+      fields[kCpuTimeUs] = static_cast<double>(*cpu_time);
+      return;
+    }
+  }
+  fields[kCpuTimeUs] = static_cast<double>(
+      w->resource_usage_[kCpuTimeUs].load(std::memory_order_acquire));
+}
+
 void Worker::Exit(ExitCode code,
                   const char* error_code,
                   const char* error_message) {
@@ -918,6 +1448,22 @@ void GetEnvMessagePort(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Keeps the given number of isolates ready for Workers started from this
+// thread. A size of 0 disposes of the pooled isolates.
+void SetIsolatePoolSize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());  // size
+  uint32_t size = args[0].As<Uint32>()->Value();
+
+  if (!env->worker_isolate_pool()) {
+    if (size == 0) return;
+    env->set_worker_isolate_pool(std::make_shared<WorkerIsolatePool>(
+        env->isolate_data()->platform(),
+        env->isolate_data()->snapshot_data()));
+  }
+  env->worker_isolate_pool()->SetSize(size);
+}
+
 void CreateWorkerPerIsolateProperties(IsolateData* isolate_data,
                                       Local<ObjectTemplate> target) {
   Isolate* isolate = isolate_data->isolate();
@@ -930,11 +1476,13 @@ void CreateWorkerPerIsolateProperties(IsolateData* isolate_data,
     w->Inherit(AsyncWrap::GetConstructorTemplate(isolate_data));
 
     SetProtoMethod(isolate, w, "startThread", Worker::StartThread);
+    SetProtoMethod(isolate, w, "setPlacement", Worker::SetPlacement);
     SetProtoMethod(isolate, w, "stopThread", Worker::StopThread);
     SetProtoMethod(isolate, w, "hasRef", Worker::HasRef);
     SetProtoMethod(isolate, w, "ref", Worker::Ref);
     SetProtoMethod(isolate, w, "unref", Worker::Unref);
     SetProtoMethod(isolate, w, "getResourceLimits", Worker::GetResourceLimits);
+    SetProtoMethod(isolate, w, "getResourceUsage", Worker::GetResourceUsage);
     SetProtoMethod(isolate, w, "takeHeapSnapshot", Worker::TakeHeapSnapshot);
     SetProtoMethod(isolate, w, "loopIdleTime", Worker::LoopIdleTime);
     SetProtoMethod(isolate, w, "loopStartTime", Worker::LoopStartTime);
@@ -957,6 +1505,7 @@ void CreateWorkerPerIsolateProperties(IsolateData* isolate_data,
   }
 
   SetMethod(isolate, target, "getEnvMessagePort", GetEnvMessagePort);
+  SetMethod(isolate, target, "setIsolatePoolSize", SetIsolatePoolSize);
 }
 
 void CreateWorkerPerContextProperties(Local<Object> target,
@@ -997,20 +1546,36 @@ void CreateWorkerPerContextProperties(Local<Object> target,
   NODE_DEFINE_CONSTANT(target, kCodeRangeSizeMb);
   NODE_DEFINE_CONSTANT(target, kStackSizeMb);
   NODE_DEFINE_CONSTANT(target, kTotalResourceLimitCount);
+
+  NODE_DEFINE_CONSTANT(target, kCpuTimeUs);
+  NODE_DEFINE_CONSTANT(target, kUsedHeapSize);
+  NODE_DEFINE_CONSTANT(target, kTotalHeapSize);
+  NODE_DEFINE_CONSTANT(target, kHeapSizeLimit);
+  NODE_DEFINE_CONSTANT(target, kExternalMemory);
+  NODE_DEFINE_CONSTANT(target, kAllocatedBytes);
+  NODE_DEFINE_CONSTANT(target, kGCCount);
+  NODE_DEFINE_CONSTANT(target, kGCPauseTimeUs);
+  NODE_DEFINE_CONSTANT(target, kTotalResourceUsageFieldCount);
+
+  SharedArena::Initialize(env, target);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetEnvMessagePort);
+  registry->Register(SetIsolatePoolSize);
   registry->Register(Worker::New);
   registry->Register(Worker::StartThread);
+  registry->Register(Worker::SetPlacement);
   registry->Register(Worker::StopThread);
   registry->Register(Worker::HasRef);
   registry->Register(Worker::Ref);
   registry->Register(Worker::Unref);
   registry->Register(Worker::GetResourceLimits);
+  registry->Register(Worker::GetResourceUsage);
   registry->Register(Worker::TakeHeapSnapshot);
   registry->Register(Worker::LoopIdleTime);
   registry->Register(Worker::LoopStartTime);
+  SharedArena::RegisterExternalReferences(registry);
 }
 
 }  // anonymous namespace
@@ -3,6 +3,7 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <atomic>
 #include <optional>
 #include <unordered_map>
 #include "node_exit_code.h"
@@ -15,6 +16,7 @@ struct SnapshotData;
 namespace worker {
 
 class WorkerThreadData;
+class WorkerIsolatePool;
 
 enum ResourceLimits {
   kMaxYoungGenerationSizeMb,
@@ -24,6 +26,18 @@ enum ResourceLimits {
   kTotalResourceLimitCount
 };
 
+enum ResourceUsageFields {
+  kCpuTimeUs,
+  kUsedHeapSize,
+  kTotalHeapSize,
+  kHeapSizeLimit,
+  kExternalMemory,
+  kAllocatedBytes,
+  kGCCount,
+  kGCPauseTimeUs,
+  kTotalResourceUsageFieldCount
+};
+
 // A worker thread, as represented in its parent thread.
 class Worker : public AsyncWrap {
  public:
@@ -66,6 +80,7 @@ class Worker : public AsyncWrap {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetEnvVars(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void StartThread(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetPlacement(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void StopThread(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HasRef(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Ref(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -73,6 +88,7 @@ class Worker : public AsyncWrap {
   static void GetResourceLimits(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   v8::Local<v8::Float64Array> GetResourceLimits(v8::Isolate* isolate) const;
+  static void GetResourceUsage(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void TakeHeapSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void LoopIdleTime(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void LoopStartTime(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -81,6 +97,17 @@ class Worker : public AsyncWrap {
   bool CreateEnvMessagePort(Environment* env);
   static size_t NearHeapLimit(void* data, size_t current_heap_limit,
                               size_t initial_heap_limit);
+  static void GCPrologue(v8::Isolate* isolate,
+                         v8::GCType type,
+                         v8::GCCallbackFlags flags,
+                         void* data);
+  static void GCEpilogue(v8::Isolate* isolate,
+                         v8::GCType type,
+                         v8::GCCallbackFlags flags,
+                         void* data);
+  // Only called from the worker thread.
+  void UpdateHeapUsage(v8::Isolate* isolate);
+  void ApplyPlacement();
 
   std::shared_ptr<PerIsolateOptions> per_isolate_opts_;
   std::vector<std::string> exec_argv_;
@@ -90,6 +117,25 @@ class Worker : public AsyncWrap {
   v8::Isolate* isolate_ = nullptr;
   std::optional<uv_thread_t> tid_;  // Set while the thread is running
 
+  // Written by the worker thread and read by the parent thread without
+  // taking a lock. The heap values are updated after every GC. kCpuTimeUs
+  // only holds the final value once the thread has stopped, which is signaled
+  // through cpu_time_final_; until then the parent reads the CPU clock of the
+  // thread directly. kGCPauseTimeUs is stored in nanoseconds.
+  std::atomic<uint64_t> resource_usage_[kTotalResourceUsageFieldCount] = {};
+  std::atomic<bool> cpu_time_final_{false};
+  // Only accessed from the worker thread.
+  uint64_t gc_start_time_ = 0;
+  size_t used_heap_size_after_gc_ = 0;
+  size_t heap_size_limit_ = 0;
+  // The part of the --worker-heap-budget that this Worker's heap limit takes
+  // up, or 0 if the Worker does not take part in the budget. Only accessed
+  // from the worker thread.
+  size_t heap_budget_grant_ = 0;
+  size_t heap_budget_initial_grant_ = 0;
+  size_t heap_budget_max_grant_ = 0;
+  bool heap_budget_pressure_sent_ = false;
+
   std::unique_ptr<InspectorParentHandle> inspector_parent_handle_;
 
   // This mutex protects access to all variables listed below it.
@@ -112,9 +158,16 @@ class Worker : public AsyncWrap {
   // Stack buffer size that is not available to the JS engine.
   static constexpr size_t kStackBufferSize = 192 * 1024;
 
+  // The NUMA node and CPUs that the thread is placed on, or -1 and none if
+  // it may run anywhere. See SetPlacement().
+  int numa_node_ = -1;
+  std::vector<int> cpu_affinity_;
+
   std::unique_ptr<MessagePortData> child_port_data_;
   std::shared_ptr<KVStore> env_vars_;
   EmbedderPreloadCallback embedder_preload_;
+  // Provides a ready-made isolate if the Worker uses the default heap limits.
+  std::shared_ptr<WorkerIsolatePool> isolate_pool_;
 
   // A raw flag that is used by creator and worker threads to
   // sync up on pre-mature termination of worker  - while in the
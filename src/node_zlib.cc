@@ -22,6 +22,7 @@
 #include "memory_tracker-inl.h"
 #include "node.h"
 #include "node_buffer.h"
+#include "node_checksum.h"
 
 #include "async_wrap-inl.h"
 #include "env-inl.h"
@@ -34,6 +35,9 @@
 #include "brotli/encode.h"
 #include "brotli/decode.h"
 #include "zlib.h"
+#if NODE_HAVE_ZSTD
+#include "zstd.h"
+#endif
 
 #include <sys/types.h>
 
@@ -45,7 +49,10 @@
 namespace node {
 
 using v8::ArrayBuffer;
+using v8::BigInt;
+using v8::CFunction;
 using v8::Context;
+using v8::FastApiTypedArray;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -104,7 +111,9 @@ enum node_zlib_mode {
   INFLATERAW,
   UNZIP,
   BROTLI_DECODE,
-  BROTLI_ENCODE
+  BROTLI_ENCODE,
+  ZSTD_COMPRESS,
+  ZSTD_DECOMPRESS
 };
 
 constexpr uint8_t GZIP_HEADER_ID1 = 0x1f;
@@ -140,12 +149,21 @@ class ZlibContext final : public MemoryRetainer {
   CompressionError GetErrorInfo() const;
   inline void SetMode(node_zlib_mode mode) { mode_ = mode; }
   CompressionError ResetStream();
+  // Like Close(), but hands an initialized deflate stream over to the
+  // process-wide ZlibStreamPool instead of tearing it down. |allocated| is
+  // the number of bytes the stream currently holds. Returns false, leaving
+  // the context untouched, if the stream cannot be pooled.
+  bool Park(size_t allocated);
 
   // Zlib-specific:
   void Init(int level, int window_bits, int mem_level, int strategy,
             std::vector<unsigned char>&& dictionary);
-  void SetAllocationFunctions(alloc_func alloc, free_func free, void* opaque);
+  void SetAllocationFunctions(alloc_func alloc,
+                              free_func free,
+                              void (*adopt)(void*, size_t),
+                              void* opaque);
   CompressionError SetParams(int level, int strategy);
+  inline void SetParallelism(uint32_t threads) { parallelism_ = threads; }
 
   SET_MEMORY_INFO_NAME(ZlibContext)
   SET_SELF_SIZE(ZlibContext)
@@ -161,6 +179,9 @@ class ZlibContext final : public MemoryRetainer {
   CompressionError ErrorForMessage(const char* message) const;
   CompressionError SetDictionary();
   bool InitZlib();
+  bool CanDeflateInParallel() const;
+  void DeflateInParallel();
+  void WriteParallelOutput();
 
   Mutex mutex_;  // Protects zlib_init_done_.
   bool zlib_init_done_ = false;
@@ -174,9 +195,137 @@ class ZlibContext final : public MemoryRetainer {
   unsigned int gzip_id_bytes_read_ = 0;
   std::vector<unsigned char> dictionary_;
 
-  z_stream strm_;
+  // Number of threads a write of a whole deflate stream may be split over,
+  // see DeflateInParallel().
+  uint32_t parallelism_ = 1;
+  bool parallel_output_active_ = false;
+  std::vector<Bytef> parallel_output_;
+  size_t parallel_output_offset_ = 0;
+
+  // Called with the allocator opaque and a byte count when a pooled stream,
+  // whose memory was allocated on behalf of another context, is adopted.
+  void (*adopt_)(void*, size_t) = nullptr;
+
+  // Heap-allocated because zlib keeps a pointer back to the z_stream in its
+  // internal state, so the struct must not move when it changes owners.
+  std::unique_ptr<z_stream> strm_ = std::make_unique<z_stream>();
+};
+
+// Initializing a deflate stream allocates and clears its window and hash
+// tables, which is a significant part of the cost of compressing a small
+// input with the one-shot APIs (zlib.deflateSync() and friends create a new
+// stream per call). Closed streams are therefore reset and kept here, keyed
+// by the parameters they were initialized with, so the next stream with the
+// same parameters can skip deflateInit2().
+//
+// While parked, the memory of a stream is not attributed to any Environment;
+// the adopting stream takes it over in full. The pool is shared by all
+// threads, so that short-lived Workers benefit too.
+class ZlibStreamPool {
+ public:
+  struct Key {
+    node_zlib_mode mode;
+    int level;
+    int window_bits;
+    int mem_level;
+    int strategy;
+
+    bool operator==(const Key& other) const {
+      return mode == other.mode && level == other.level &&
+             window_bits == other.window_bits &&
+             mem_level == other.mem_level && strategy == other.strategy;
+    }
+  };
+
+  // Takes ownership of |*strm| and returns true if there was room for it and
+  // it could be reset, otherwise leaves |*strm| alone.
+  static bool Put(const Key& key,
+                  std::unique_ptr<z_stream>* strm,
+                  size_t allocated);
+  // Returns a reset stream for |key| and the number of bytes it holds, or
+  // nullptr if none is available.
+  static std::unique_ptr<z_stream> Take(const Key& key, size_t* allocated);
+
+ private:
+  static constexpr size_t kMaxEntries = 16;
+
+  struct StreamDeleter {
+    void operator()(z_stream* strm) const {
+      deflateEnd(strm);
+      delete strm;
+    }
+  };
+
+  struct Entry {
+    Key key;
+    std::unique_ptr<z_stream, StreamDeleter> strm;
+    size_t allocated;
+  };
+
+  // Allocation functions used while a stream is parked. They use the same
+  // layout as CompressionStream::AllocForZlib(), with the size of each chunk
+  // stored just before it, so that either side can free the other's memory.
+  static void* Alloc(void* data, uInt items, uInt size);
+  static void Free(void* data, void* pointer);
+
+  static Mutex mutex_;
+  static std::vector<Entry> entries_;
 };
 
+Mutex ZlibStreamPool::mutex_;
+std::vector<ZlibStreamPool::Entry> ZlibStreamPool::entries_;
+
+void* ZlibStreamPool::Alloc(void* data, uInt items, uInt size) {
+  size_t real_size =
+      MultiplyWithOverflowCheck(static_cast<size_t>(items),
+                                static_cast<size_t>(size)) + sizeof(size_t);
+  char* memory = UncheckedMalloc(real_size);
+  if (UNLIKELY(memory == nullptr)) return nullptr;
+  *reinterpret_cast<size_t*>(memory) = real_size;
+  return memory + sizeof(size_t);
+}
+
+void ZlibStreamPool::Free(void* data, void* pointer) {
+  if (UNLIKELY(pointer == nullptr)) return;
+  free(static_cast<char*>(pointer) - sizeof(size_t));
+}
+
+bool ZlibStreamPool::Put(const Key& key,
+                         std::unique_ptr<z_stream>* strm,
+                         size_t allocated) {
+  Mutex::ScopedLock lock(mutex_);
+  if (entries_.size() >= kMaxEntries) return false;
+  if (deflateReset(strm->get()) != Z_OK) return false;
+
+  (*strm)->zalloc = Alloc;
+  (*strm)->zfree = Free;
+  (*strm)->opaque = nullptr;
+  (*strm)->next_in = nullptr;
+  (*strm)->avail_in = 0;
+  (*strm)->next_out = nullptr;
+  (*strm)->avail_out = 0;
+  entries_.push_back(Entry{
+      key, std::unique_ptr<z_stream, StreamDeleter>(strm->release()),
+      allocated});
+  return true;
+}
+
+std::unique_ptr<z_stream> ZlibStreamPool::Take(const Key& key,
+                                               size_t* allocated) {
+  Mutex::ScopedLock lock(mutex_);
+  // Most recently parked streams are at the back and the most likely to
+  // still be in the CPU cache.
+  for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+    if (it->key == key) {
+      *allocated = it->allocated;
+      std::unique_ptr<z_stream> strm(it->strm.release());
+      entries_.erase(std::next(it).base());
+      return strm;
+    }
+  }
+  return nullptr;
+}
+
 // Brotli has different data types for compression and decompression streams,
 // so some of the specifics are implemented in more specific subclasses
 class BrotliContext : public MemoryRetainer {
@@ -248,6 +397,75 @@ class BrotliDecoderContext final : public BrotliContext {
   DeleteFnPtr<BrotliDecoderState, BrotliDecoderDestroyInstance> state_;
 };
 
+#if NODE_HAVE_ZSTD
+class ZstdContext : public MemoryRetainer {
+ public:
+  ZstdContext() = default;
+
+  void SetBuffers(const char* in, uint32_t in_len, char* out, uint32_t out_len);
+  void SetFlush(int flush);
+  void GetAfterWriteOffsets(uint32_t* avail_in, uint32_t* avail_out) const;
+  inline void SetMode(node_zlib_mode mode) { mode_ = mode; }
+
+  ZstdContext(const ZstdContext&) = delete;
+  ZstdContext& operator=(const ZstdContext&) = delete;
+
+ protected:
+  node_zlib_mode mode_ = NONE;
+  ZSTD_inBuffer input_ {nullptr, 0, 0};
+  ZSTD_outBuffer output_ {nullptr, 0, 0};
+  ZSTD_EndDirective flush_ = ZSTD_e_continue;
+  size_t last_result_ = 0;
+};
+
+inline void FreeZstdCCtx(ZSTD_CCtx* ctx) { ZSTD_freeCCtx(ctx); }
+inline void FreeZstdDCtx(ZSTD_DCtx* ctx) { ZSTD_freeDCtx(ctx); }
+
+// zstd allocates through malloc() here, as custom allocators are only part
+// of its experimental API. Memory is reported through MemoryInfo() instead.
+class ZstdEncoderContext final : public ZstdContext {
+ public:
+  void Close();
+  void DoThreadPoolWork();
+  CompressionError Init(std::vector<unsigned char>&& dictionary);
+  CompressionError ResetStream();
+  CompressionError SetParams(int key, int value);
+  CompressionError GetErrorInfo() const;
+
+  SET_MEMORY_INFO_NAME(ZstdEncoderContext)
+  SET_SELF_SIZE(ZstdEncoderContext)
+
+  void MemoryInfo(MemoryTracker* tracker) const override {
+    if (state_)
+      tracker->TrackFieldWithSize("state", ZSTD_sizeof_CCtx(state_.get()));
+  }
+
+ private:
+  DeleteFnPtr<ZSTD_CCtx, FreeZstdCCtx> state_;
+};
+
+class ZstdDecoderContext final : public ZstdContext {
+ public:
+  void Close();
+  void DoThreadPoolWork();
+  CompressionError Init(std::vector<unsigned char>&& dictionary);
+  CompressionError ResetStream();
+  CompressionError SetParams(int key, int value);
+  CompressionError GetErrorInfo() const;
+
+  SET_MEMORY_INFO_NAME(ZstdDecoderContext)
+  SET_SELF_SIZE(ZstdDecoderContext)
+
+  void MemoryInfo(MemoryTracker* tracker) const override {
+    if (state_)
+      tracker->TrackFieldWithSize("state", ZSTD_sizeof_DCtx(state_.get()));
+  }
+
+ private:
+  DeleteFnPtr<ZSTD_DCtx, FreeZstdDCtx> state_;
+};
+#endif  // NODE_HAVE_ZSTD
+
 template <typename CompressionContext>
 class CompressionStream : public AsyncWrap, public ThreadPoolWork {
  public:
@@ -259,7 +477,7 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
 
   CompressionStream(Environment* env, Local<Object> wrap)
       : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_ZLIB),
-        ThreadPoolWork(env, "zlib"),
+        ThreadPoolWork(env, "zlib", ThreadPoolWorkKind::kCpu),
         write_result_(nullptr) {
     MakeWeak();
   }
@@ -282,6 +500,16 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
     CHECK(init_done_ && "close before init");
 
     AllocScope alloc_scope(this);
+    if constexpr (std::is_same_v<CompressionContext, ZlibContext>) {
+      // The memory of a pooled stream is no longer ours; dropping it from
+      // the unreported count lets the AllocScope return it to V8.
+      ssize_t allocated = zlib_memory_ + unreported_allocations_;
+      if (ctx_.Park(allocated)) {
+        unreported_allocations_.fetch_sub(allocated,
+                                          std::memory_order_relaxed);
+        return;
+      }
+    }
     ctx_.Close();
   }
 
@@ -500,6 +728,14 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
     return memory + sizeof(size_t);
   }
 
+  // Called when the context takes over a pooled stream that holds |size|
+  // bytes allocated by AllocForZlib() on behalf of a previous owner.
+  static void AdoptForZlib(void* data, size_t size) {
+    CompressionStream* ctx = static_cast<CompressionStream*>(data);
+    ctx->unreported_allocations_.fetch_add(size,
+                                           std::memory_order_relaxed);
+  }
+
   static void FreeForZlib(void* data, void* pointer) {
     if (UNLIKELY(pointer == nullptr)) return;
     CompressionStream* ctx = static_cast<CompressionStream*>(data);
@@ -519,6 +755,8 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
     CHECK_IMPLIES(report < 0, zlib_memory_ >= static_cast<size_t>(-report));
     zlib_memory_ += report;
     AsyncWrap::env()->isolate()->AdjustAmountOfExternalAllocatedMemory(report);
+    AsyncWrap::env()->native_memory_counters()->Adjust(
+        mem::NativeMemoryCounters::kZlib, report);
   }
 
   struct AllocScope {
@@ -625,11 +863,20 @@ class ZlibStream final : public CompressionStream<ZlibContext> {
 
     AllocScope alloc_scope(wrap);
     wrap->context()->SetAllocationFunctions(
-        AllocForZlib, FreeForZlib, static_cast<CompressionStream*>(wrap));
+        AllocForZlib, FreeForZlib, AdoptForZlib,
+        static_cast<CompressionStream*>(wrap));
     wrap->context()->Init(level, window_bits, mem_level, strategy,
                           std::move(dictionary));
   }
 
+  static void SetParallelism(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.Length() == 1 && "setParallelism(threads)");
+    CHECK(args[0]->IsUint32());
+    ZlibStream* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    wrap->context()->SetParallelism(args[0].As<v8::Uint32>()->Value());
+  }
+
   static void Params(const FunctionCallbackInfo<Value>& args) {
     CHECK(args.Length() == 2 && "params(level, strategy)");
     ZlibStream* wrap;
@@ -730,6 +977,95 @@ class BrotliCompressionStream final :
 using BrotliEncoderStream = BrotliCompressionStream<BrotliEncoderContext>;
 using BrotliDecoderStream = BrotliCompressionStream<BrotliDecoderContext>;
 
+#if NODE_HAVE_ZSTD
+template <typename CompressionContext>
+class ZstdCompressionStream final :
+  public CompressionStream<CompressionContext> {
+ public:
+  ZstdCompressionStream(Environment* env,
+                        Local<Object> wrap,
+                        node_zlib_mode mode)
+    : CompressionStream<CompressionContext>(env, wrap) {
+    context()->SetMode(mode);
+  }
+
+  inline CompressionContext* context() {
+    return this->CompressionStream<CompressionContext>::context();
+  }
+  typedef typename CompressionStream<CompressionContext>::AllocScope AllocScope;
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args[0]->IsInt32());
+    node_zlib_mode mode =
+        static_cast<node_zlib_mode>(args[0].As<Int32>()->Value());
+    new ZstdCompressionStream(env, args.This(), mode);
+  }
+
+  // |params| holds (parameter, value) pairs for ZSTD_CCtx_setParameter() or
+  // ZSTD_DCtx_setParameter().
+  static void Init(const FunctionCallbackInfo<Value>& args) {
+    ZstdCompressionStream* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    CHECK(args.Length() == 4 &&
+          "init(params, writeResult, writeCallback, dictionary)");
+
+    CHECK(args[1]->IsUint32Array());
+    uint32_t* write_result = reinterpret_cast<uint32_t*>(Buffer::Data(args[1]));
+
+    CHECK(args[2]->IsFunction());
+    Local<Function> write_js_callback = args[2].As<Function>();
+    wrap->InitStream(write_result, write_js_callback);
+
+    std::vector<unsigned char> dictionary;
+    if (Buffer::HasInstance(args[3])) {
+      unsigned char* data =
+          reinterpret_cast<unsigned char*>(Buffer::Data(args[3]));
+      dictionary = std::vector<unsigned char>(
+          data,
+          data + Buffer::Length(args[3]));
+    }
+
+    AllocScope alloc_scope(wrap);
+    CompressionError err = wrap->context()->Init(std::move(dictionary));
+    if (err.IsError()) {
+      wrap->EmitError(err);
+      args.GetReturnValue().Set(false);
+      return;
+    }
+
+    CHECK(args[0]->IsInt32Array());
+    Local<v8::Int32Array> params = args[0].As<v8::Int32Array>();
+    const int32_t* data = reinterpret_cast<const int32_t*>(
+        static_cast<const char*>(params->Buffer()->Data()) +
+        params->ByteOffset());
+    size_t len = params->Length();
+    CHECK_EQ(len % 2, 0);
+
+    for (size_t i = 0; i < len; i += 2) {
+      err = wrap->context()->SetParams(data[i], data[i + 1]);
+      if (err.IsError()) {
+        wrap->EmitError(err);
+        args.GetReturnValue().Set(false);
+        return;
+      }
+    }
+
+    args.GetReturnValue().Set(true);
+  }
+
+  static void Params(const FunctionCallbackInfo<Value>& args) {
+    // Currently a no-op, parameters are only set through Init().
+  }
+
+  SET_MEMORY_INFO_NAME(ZstdCompressionStream)
+  SET_SELF_SIZE(ZstdCompressionStream)
+};
+
+using ZstdEncoderStream = ZstdCompressionStream<ZstdEncoderContext>;
+using ZstdDecoderStream = ZstdCompressionStream<ZstdDecoderContext>;
+#endif  // NODE_HAVE_ZSTD
+
 void ZlibContext::Close() {
   {
     Mutex::ScopedLock lock(mutex_);
@@ -744,10 +1080,10 @@ void ZlibContext::Close() {
 
   int status = Z_OK;
   if (mode_ == DEFLATE || mode_ == GZIP || mode_ == DEFLATERAW) {
-    status = deflateEnd(&strm_);
+    status = deflateEnd(strm_.get());
   } else if (mode_ == INFLATE || mode_ == GUNZIP || mode_ == INFLATERAW ||
              mode_ == UNZIP) {
-    status = inflateEnd(&strm_);
+    status = inflateEnd(strm_.get());
   }
 
   CHECK(status == Z_OK || status == Z_DATA_ERROR);
@@ -757,12 +1093,236 @@ void ZlibContext::Close() {
 }
 
 
+bool ZlibContext::Park(size_t allocated) {
+  {
+    Mutex::ScopedLock lock(mutex_);
+    if (!zlib_init_done_) return false;
+  }
+
+  if (mode_ != DEFLATE && mode_ != GZIP && mode_ != DEFLATERAW) return false;
+
+  std::unique_ptr<z_stream> fresh = std::make_unique<z_stream>();
+  fresh->zalloc = strm_->zalloc;
+  fresh->zfree = strm_->zfree;
+  fresh->opaque = strm_->opaque;
+  if (!ZlibStreamPool::Put(
+          {mode_, level_, window_bits_, mem_level_, strategy_},
+          &strm_,
+          allocated)) {
+    return false;
+  }
+
+  strm_ = std::move(fresh);
+  {
+    Mutex::ScopedLock lock(mutex_);
+    zlib_init_done_ = false;
+  }
+  mode_ = NONE;
+  dictionary_.clear();
+  return true;
+}
+
+
+// Inputs are split into blocks of this size for parallel compression. Each
+// block is primed with the last window's worth of the previous one, so the
+// ratio is close to that of a single stream.
+constexpr size_t kParallelDeflateBlockSize = 128 * 1024;
+constexpr size_t kParallelDeflateMinInput = 4 * kParallelDeflateBlockSize;
+
+struct ParallelDeflateBlock {
+  const Bytef* data;
+  size_t length;
+  std::vector<Bytef> output;
+  uLong check;
+  int err;
+};
+
+struct ParallelDeflateJob {
+  std::vector<ParallelDeflateBlock> blocks;
+  std::atomic<size_t> next_block{0};
+  int level;
+  int mem_level;
+  int strategy;
+  int window_bits;
+  // Whether per-block checksums are CRC-32 (gzip) or Adler-32 (zlib).
+  bool crc;
+  bool adler;
+};
+
+// Compresses blocks of |job| until there are none left. The blocks are raw
+// deflate data ending on a byte boundary, so they can simply be
+// concatenated.
+static void RunParallelDeflate(void* data) {
+  ParallelDeflateJob* job = static_cast<ParallelDeflateJob*>(data);
+  const size_t window_size = size_t{1} << job->window_bits;
+  size_t index;
+  while ((index = job->next_block++) < job->blocks.size()) {
+    ParallelDeflateBlock* block = &job->blocks[index];
+    const bool last = index + 1 == job->blocks.size();
+    z_stream strm {};
+    block->err = deflateInit2(&strm, job->level, Z_DEFLATED,
+                              -job->window_bits, job->mem_level,
+                              job->strategy);
+    if (block->err != Z_OK) continue;
+    if (index > 0) {
+      const size_t dict_length =
+          std::min(window_size, job->blocks[index - 1].length);
+      block->err = deflateSetDictionary(
+          &strm, block->data - dict_length, dict_length);
+    }
+    // Leave room for the empty stored block written by Z_SYNC_FLUSH.
+    block->output.resize(deflateBound(&strm, block->length) + 16);
+    strm.next_in = const_cast<Bytef*>(block->data);
+    strm.avail_in = block->length;
+    strm.next_out = block->output.data();
+    strm.avail_out = block->output.size();
+    if (block->err == Z_OK) {
+      block->err = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+      if (block->err == (last ? Z_STREAM_END : Z_OK) && strm.avail_in == 0)
+        block->err = Z_OK;
+      else if (block->err == Z_OK || block->err == Z_STREAM_END)
+        block->err = Z_BUF_ERROR;
+    }
+    block->output.resize(block->output.size() - strm.avail_out);
+    deflateEnd(&strm);
+
+    if (job->crc)
+      block->check = crc32(0, block->data, block->length);
+    else if (job->adler)
+      block->check = adler32(1, block->data, block->length);
+  }
+}
+
+bool ZlibContext::CanDeflateInParallel() const {
+  // Only a single write that makes up the whole stream can be split, as
+  // every block but the first depends on the input that precedes it.
+  return parallelism_ > 1 &&
+         (mode_ == DEFLATE || mode_ == GZIP || mode_ == DEFLATERAW) &&
+         flush_ == Z_FINISH &&
+         strm_->total_in == 0 &&
+         strm_->total_out == 0 &&
+         dictionary_.empty() &&
+         strm_->avail_in >= kParallelDeflateMinInput;
+}
+
+// Splits the input into blocks that are compressed on up to parallelism_
+// threads, like pigz does, and stores the resulting stream in
+// parallel_output_. WriteParallelOutput() then hands it out over one or
+// more writes.
+void ZlibContext::DeflateInParallel() {
+  ParallelDeflateJob job;
+  job.level = level_;
+  job.mem_level = mem_level_;
+  job.strategy = strategy_;
+  job.crc = mode_ == GZIP;
+  job.adler = mode_ == DEFLATE;
+  int window_bits = mode_ == GZIP ? window_bits_ - 16 :
+                    mode_ == DEFLATERAW ? -window_bits_ : window_bits_;
+  // zlib does not support 256 byte windows for raw deflate.
+  job.window_bits = std::max(window_bits, 9);
+
+  const Bytef* input = strm_->next_in;
+  const size_t length = strm_->avail_in;
+  for (size_t offset = 0; offset < length;
+       offset += kParallelDeflateBlockSize) {
+    job.blocks.push_back(ParallelDeflateBlock {
+        input + offset,
+        std::min(kParallelDeflateBlockSize, length - offset),
+        {}, 0, Z_OK });
+  }
+
+  std::vector<uv_thread_t> threads(
+      std::min<size_t>(parallelism_, job.blocks.size()) - 1);
+  size_t started = 0;
+  for (uv_thread_t& thread : threads) {
+    if (uv_thread_create(&thread, RunParallelDeflate, &job) != 0) break;
+    started++;
+  }
+  RunParallelDeflate(&job);
+  for (size_t i = 0; i < started; i++)
+    CHECK_EQ(0, uv_thread_join(&threads[i]));
+
+  size_t total = 18;  // The largest header and trailer, for gzip.
+  for (const ParallelDeflateBlock& block : job.blocks) {
+    if (block.err != Z_OK) {
+      err_ = block.err;
+      return;
+    }
+    total += block.output.size();
+  }
+
+  std::vector<Bytef>& out = parallel_output_;
+  out.clear();
+  out.reserve(total);
+  if (mode_ == GZIP) {
+    const Bytef xfl = level_ == 9 ? 2 : level_ == 1 ? 4 : 0;
+    out.insert(out.end(), {GZIP_HEADER_ID1, GZIP_HEADER_ID2, Z_DEFLATED, 0,
+                           0, 0, 0, 0, xfl, 3});
+  } else if (mode_ == DEFLATE) {
+    const int level = level_ == Z_DEFAULT_COMPRESSION ? 6 : level_;
+    const int flevel = strategy_ >= Z_HUFFMAN_ONLY || level < 2 ? 0 :
+                       level < 6 ? 1 : level == 6 ? 2 : 3;
+    unsigned header = ((Z_DEFLATED + ((job.window_bits - 8) << 4)) << 8) |
+                      (flevel << 6);
+    header += 31 - header % 31;
+    out.push_back(header >> 8);
+    out.push_back(header & 0xff);
+  }
+
+  uLong check = job.crc ? crc32(0, nullptr, 0) : adler32(0, nullptr, 0);
+  for (const ParallelDeflateBlock& block : job.blocks) {
+    out.insert(out.end(), block.output.begin(), block.output.end());
+    if (job.crc)
+      check = crc32_combine(check, block.check, block.length);
+    else if (job.adler)
+      check = adler32_combine(check, block.check, block.length);
+  }
+
+  if (mode_ == GZIP) {
+    for (uLong value : {check, static_cast<uLong>(length)}) {
+      for (int shift = 0; shift < 32; shift += 8)
+        out.push_back((value >> shift) & 0xff);
+    }
+  } else if (mode_ == DEFLATE) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+      out.push_back((check >> shift) & 0xff);
+  }
+
+  strm_->next_in += length;
+  strm_->avail_in = 0;
+  strm_->total_in = length;
+  parallel_output_active_ = true;
+  parallel_output_offset_ = 0;
+}
+
+void ZlibContext::WriteParallelOutput() {
+  size_t remaining = parallel_output_.size() - parallel_output_offset_;
+  size_t length = std::min<size_t>(remaining, strm_->avail_out);
+  memcpy(strm_->next_out,
+         parallel_output_.data() + parallel_output_offset_,
+         length);
+  parallel_output_offset_ += length;
+  strm_->next_out += length;
+  strm_->avail_out -= length;
+  strm_->total_out += length;
+  err_ = length == remaining ? Z_STREAM_END : Z_OK;
+}
+
 void ZlibContext::DoThreadPoolWork() {
   bool first_init_call = InitZlib();
   if (first_init_call && err_ != Z_OK) {
     return;
   }
 
+  if (parallel_output_active_ || CanDeflateInParallel()) {
+    if (!parallel_output_active_) {
+      DeflateInParallel();
+      if (err_ != Z_OK) return;
+    }
+    WriteParallelOutput();
+    return;
+  }
+
   const Bytef* next_expected_header_byte = nullptr;
 
   // If the avail_out is left at 0, then it means that it ran out
@@ -772,11 +1332,11 @@ void ZlibContext::DoThreadPoolWork() {
     case DEFLATE:
     case GZIP:
     case DEFLATERAW:
-      err_ = deflate(&strm_, flush_);
+      err_ = deflate(strm_.get(), flush_);
       break;
     case UNZIP:
-      if (strm_.avail_in > 0) {
-        next_expected_header_byte = strm_.next_in;
+      if (strm_->avail_in > 0) {
+        next_expected_header_byte = strm_->next_in;
       }
 
       switch (gzip_id_bytes_read_) {
@@ -789,7 +1349,7 @@ void ZlibContext::DoThreadPoolWork() {
             gzip_id_bytes_read_ = 1;
             next_expected_header_byte++;
 
-            if (strm_.avail_in == 1) {
+            if (strm_->avail_in == 1) {
               // The only available byte was already read.
               break;
             }
@@ -822,7 +1382,7 @@ void ZlibContext::DoThreadPoolWork() {
     case INFLATE:
     case GUNZIP:
     case INFLATERAW:
-      err_ = inflate(&strm_, flush_);
+      err_ = inflate(strm_.get(), flush_);
 
       // If data was encoded with dictionary (INFLATERAW will have it set in
       // SetDictionary, don't repeat that here)
@@ -830,12 +1390,12 @@ void ZlibContext::DoThreadPoolWork() {
           err_ == Z_NEED_DICT &&
           !dictionary_.empty()) {
         // Load it
-        err_ = inflateSetDictionary(&strm_,
+        err_ = inflateSetDictionary(strm_.get(),
                                     dictionary_.data(),
                                     dictionary_.size());
         if (err_ == Z_OK) {
           // And try to decode again
-          err_ = inflate(&strm_, flush_);
+          err_ = inflate(strm_.get(), flush_);
         } else if (err_ == Z_DATA_ERROR) {
           // Both inflateSetDictionary() and inflate() return Z_DATA_ERROR.
           // Make it possible for After() to tell a bad dictionary from bad
@@ -844,17 +1404,17 @@ void ZlibContext::DoThreadPoolWork() {
         }
       }
 
-      while (strm_.avail_in > 0 &&
+      while (strm_->avail_in > 0 &&
              mode_ == GUNZIP &&
              err_ == Z_STREAM_END &&
-             strm_.next_in[0] != 0x00) {
+             strm_->next_in[0] != 0x00) {
         // Bytes remain in input buffer. Perhaps this is another compressed
         // member in the same archive, or just trailing garbage.
         // Trailing zero bytes are okay, though, since they are frequently
         // used for padding.
 
         ResetStream();
-        err_ = inflate(&strm_, flush_);
+        err_ = inflate(strm_.get(), flush_);
       }
       break;
     default:
@@ -865,10 +1425,10 @@ void ZlibContext::DoThreadPoolWork() {
 
 void ZlibContext::SetBuffers(const char* in, uint32_t in_len,
                              char* out, uint32_t out_len) {
-  strm_.avail_in = in_len;
-  strm_.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(in));
-  strm_.avail_out = out_len;
-  strm_.next_out = reinterpret_cast<Bytef*>(out);
+  strm_->avail_in = in_len;
+  strm_->next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(in));
+  strm_->avail_out = out_len;
+  strm_->next_out = reinterpret_cast<Bytef*>(out);
 }
 
 
@@ -879,14 +1439,14 @@ void ZlibContext::SetFlush(int flush) {
 
 void ZlibContext::GetAfterWriteOffsets(uint32_t* avail_in,
                                        uint32_t* avail_out) const {
-  *avail_in = strm_.avail_in;
-  *avail_out = strm_.avail_out;
+  *avail_in = strm_->avail_in;
+  *avail_out = strm_->avail_out;
 }
 
 
 CompressionError ZlibContext::ErrorForMessage(const char* message) const {
-  if (strm_.msg != nullptr)
-    message = strm_.msg;
+  if (strm_->msg != nullptr)
+    message = strm_->msg;
 
   return CompressionError { message, ZlibStrerror(err_), err_ };
 }
@@ -897,7 +1457,7 @@ CompressionError ZlibContext::GetErrorInfo() const {
   switch (err_) {
   case Z_OK:
   case Z_BUF_ERROR:
-    if (strm_.avail_out != 0 && flush_ == Z_FINISH) {
+    if (strm_->avail_out != 0 && flush_ == Z_FINISH) {
       return ErrorForMessage("unexpected end of file");
     }
   case Z_STREAM_END:
@@ -924,17 +1484,20 @@ CompressionError ZlibContext::ResetStream() {
   }
 
   err_ = Z_OK;
+  parallel_output_active_ = false;
+  parallel_output_.clear();
+  parallel_output_offset_ = 0;
 
   switch (mode_) {
     case DEFLATE:
     case DEFLATERAW:
     case GZIP:
-      err_ = deflateReset(&strm_);
+      err_ = deflateReset(strm_.get());
       break;
     case INFLATE:
     case INFLATERAW:
     case GUNZIP:
-      err_ = inflateReset(&strm_);
+      err_ = inflateReset(strm_.get());
       break;
     default:
       break;
@@ -949,10 +1512,12 @@ CompressionError ZlibContext::ResetStream() {
 
 void ZlibContext::SetAllocationFunctions(alloc_func alloc,
                                          free_func free,
+                                         void (*adopt)(void*, size_t),
                                          void* opaque) {
-  strm_.zalloc = alloc;
-  strm_.zfree = free;
-  strm_.opaque = opaque;
+  strm_->zalloc = alloc;
+  strm_->zfree = free;
+  strm_->opaque = opaque;
+  adopt_ = adopt;
 }
 
 
@@ -1012,19 +1577,37 @@ bool ZlibContext::InitZlib() {
   switch (mode_) {
     case DEFLATE:
     case GZIP:
-    case DEFLATERAW:
-      err_ = deflateInit2(&strm_,
+    case DEFLATERAW: {
+      size_t allocated = 0;
+      std::unique_ptr<z_stream> pooled = ZlibStreamPool::Take(
+          {mode_, level_, window_bits_, mem_level_, strategy_}, &allocated);
+      if (pooled) {
+        // The buffers for the first write may already have been set.
+        pooled->zalloc = strm_->zalloc;
+        pooled->zfree = strm_->zfree;
+        pooled->opaque = strm_->opaque;
+        pooled->next_in = strm_->next_in;
+        pooled->avail_in = strm_->avail_in;
+        pooled->next_out = strm_->next_out;
+        pooled->avail_out = strm_->avail_out;
+        strm_ = std::move(pooled);
+        if (adopt_ != nullptr) adopt_(strm_->opaque, allocated);
+        err_ = Z_OK;
+        break;
+      }
+      err_ = deflateInit2(strm_.get(),
                           level_,
                           Z_DEFLATED,
                           window_bits_,
                           mem_level_,
                           strategy_);
       break;
+    }
     case INFLATE:
     case GUNZIP:
     case INFLATERAW:
     case UNZIP:
-      err_ = inflateInit2(&strm_, window_bits_);
+      err_ = inflateInit2(strm_.get(), window_bits_);
       break;
     default:
       UNREACHABLE();
@@ -1051,14 +1634,14 @@ CompressionError ZlibContext::SetDictionary() {
   switch (mode_) {
     case DEFLATE:
     case DEFLATERAW:
-      err_ = deflateSetDictionary(&strm_,
+      err_ = deflateSetDictionary(strm_.get(),
                                   dictionary_.data(),
                                   dictionary_.size());
       break;
     case INFLATERAW:
       // The other inflate cases will have the dictionary set when inflate()
       // returns Z_NEED_DICT in Process()
-      err_ = inflateSetDictionary(&strm_,
+      err_ = inflateSetDictionary(strm_.get(),
                                   dictionary_.data(),
                                   dictionary_.size());
       break;
@@ -1085,7 +1668,11 @@ CompressionError ZlibContext::SetParams(int level, int strategy) {
   switch (mode_) {
     case DEFLATE:
     case DEFLATERAW:
-      err_ = deflateParams(&strm_, level, strategy);
+      err_ = deflateParams(strm_.get(), level, strategy);
+      if (err_ == Z_OK || err_ == Z_BUF_ERROR) {
+        level_ = level;
+        strategy_ = strategy;
+      }
       break;
     default:
       break;
@@ -1253,6 +1840,158 @@ CompressionError BrotliDecoderContext::GetErrorInfo() const {
   }
 }
 
+#if NODE_HAVE_ZSTD
+void ZstdContext::SetBuffers(const char* in, uint32_t in_len,
+                             char* out, uint32_t out_len) {
+  input_ = ZSTD_inBuffer { in, in_len, 0 };
+  output_ = ZSTD_outBuffer { out, out_len, 0 };
+}
+
+
+void ZstdContext::SetFlush(int flush) {
+  flush_ = static_cast<ZSTD_EndDirective>(flush);
+}
+
+
+void ZstdContext::GetAfterWriteOffsets(uint32_t* avail_in,
+                                       uint32_t* avail_out) const {
+  *avail_in = input_.size - input_.pos;
+  *avail_out = output_.size - output_.pos;
+}
+
+
+void ZstdEncoderContext::DoThreadPoolWork() {
+  CHECK_EQ(mode_, ZSTD_COMPRESS);
+  CHECK(state_);
+  // With multi-threaded compression, a single call may return before all
+  // input is consumed or before a flush is complete even though there is
+  // output space left, so keep going until one of them runs out.
+  do {
+    last_result_ = ZSTD_compressStream2(
+        state_.get(), &output_, &input_, flush_);
+  } while (!ZSTD_isError(last_result_) &&
+           output_.pos < output_.size &&
+           (input_.pos < input_.size ||
+            (flush_ != ZSTD_e_continue && last_result_ != 0)));
+}
+
+
+void ZstdEncoderContext::Close() {
+  state_.reset();
+  mode_ = NONE;
+}
+
+CompressionError ZstdEncoderContext::Init(
+    std::vector<unsigned char>&& dictionary) {
+  state_.reset(ZSTD_createCCtx());
+  if (!state_) {
+    return CompressionError("Could not initialize zstd instance",
+                            "ERR_ZLIB_INITIALIZATION_FAILED",
+                            -1);
+  }
+  if (!dictionary.empty() &&
+      ZSTD_isError(ZSTD_CCtx_loadDictionary(
+          state_.get(), dictionary.data(), dictionary.size()))) {
+    return CompressionError("Loading dictionary failed",
+                            "ERR_ZSTD_DICTIONARY_LOAD_FAILED",
+                            -1);
+  }
+  return CompressionError {};
+}
+
+CompressionError ZstdEncoderContext::ResetStream() {
+  // Parameters and the dictionary stay in place.
+  ZSTD_CCtx_reset(state_.get(), ZSTD_reset_session_only);
+  last_result_ = 0;
+  return CompressionError {};
+}
+
+CompressionError ZstdEncoderContext::SetParams(int key, int value) {
+  if (ZSTD_isError(ZSTD_CCtx_setParameter(
+          state_.get(), static_cast<ZSTD_cParameter>(key), value))) {
+    return CompressionError("Setting parameter failed",
+                            "ERR_ZSTD_PARAM_SET_FAILED",
+                            -1);
+  }
+  return CompressionError {};
+}
+
+CompressionError ZstdEncoderContext::GetErrorInfo() const {
+  if (ZSTD_isError(last_result_)) {
+    return CompressionError(ZSTD_getErrorName(last_result_),
+                            "ERR_ZSTD_COMPRESSION_FAILED",
+                            -1);
+  }
+  return CompressionError {};
+}
+
+
+void ZstdDecoderContext::Close() {
+  state_.reset();
+  mode_ = NONE;
+}
+
+void ZstdDecoderContext::DoThreadPoolWork() {
+  CHECK_EQ(mode_, ZSTD_DECOMPRESS);
+  CHECK(state_);
+  // Concatenated frames are decoded one after the other.
+  do {
+    last_result_ = ZSTD_decompressStream(state_.get(), &output_, &input_);
+  } while (!ZSTD_isError(last_result_) &&
+           input_.pos < input_.size &&
+           output_.pos < output_.size);
+}
+
+CompressionError ZstdDecoderContext::Init(
+    std::vector<unsigned char>&& dictionary) {
+  state_.reset(ZSTD_createDCtx());
+  if (!state_) {
+    return CompressionError("Could not initialize zstd instance",
+                            "ERR_ZLIB_INITIALIZATION_FAILED",
+                            -1);
+  }
+  if (!dictionary.empty() &&
+      ZSTD_isError(ZSTD_DCtx_loadDictionary(
+          state_.get(), dictionary.data(), dictionary.size()))) {
+    return CompressionError("Loading dictionary failed",
+                            "ERR_ZSTD_DICTIONARY_LOAD_FAILED",
+                            -1);
+  }
+  return CompressionError {};
+}
+
+CompressionError ZstdDecoderContext::ResetStream() {
+  ZSTD_DCtx_reset(state_.get(), ZSTD_reset_session_only);
+  last_result_ = 0;
+  return CompressionError {};
+}
+
+CompressionError ZstdDecoderContext::SetParams(int key, int value) {
+  if (ZSTD_isError(ZSTD_DCtx_setParameter(
+          state_.get(), static_cast<ZSTD_dParameter>(key), value))) {
+    return CompressionError("Setting parameter failed",
+                            "ERR_ZSTD_PARAM_SET_FAILED",
+                            -1);
+  }
+  return CompressionError {};
+}
+
+CompressionError ZstdDecoderContext::GetErrorInfo() const {
+  if (ZSTD_isError(last_result_)) {
+    return CompressionError(ZSTD_getErrorName(last_result_),
+                            "ERR_ZSTD_DECOMPRESSION_FAILED",
+                            -1);
+  } else if (flush_ == ZSTD_e_end && last_result_ != 0 &&
+             input_.pos == input_.size && output_.pos < output_.size) {
+    // Match zlib's behaviour, as zstd doesn't have its own code for this.
+    return CompressionError("unexpected end of file",
+                            "Z_BUF_ERROR",
+                            Z_BUF_ERROR);
+  }
+  return CompressionError {};
+}
+#endif  // NODE_HAVE_ZSTD
+
 
 template <typename Stream>
 struct MakeClass {
@@ -1271,6 +2010,8 @@ struct MakeClass {
     SetProtoMethod(isolate, z, "init", Stream::Init);
     SetProtoMethod(isolate, z, "params", Stream::Params);
     SetProtoMethod(isolate, z, "reset", Stream::Reset);
+    if constexpr (std::is_same_v<Stream, ZlibStream>)
+      SetProtoMethod(isolate, z, "setParallelism", Stream::SetParallelism);
 
     SetConstructorFunction(env->context(), target, name, z);
   }
@@ -1283,6 +2024,8 @@ struct MakeClass {
     registry->Register(Stream::Init);
     registry->Register(Stream::Params);
     registry->Register(Stream::Reset);
+    if constexpr (std::is_same_v<Stream, ZlibStream>)
+      registry->Register(Stream::SetParallelism);
   }
 };
 
@@ -1297,8 +2040,12 @@ T CallOnSequence(v8::Isolate* isolate, Local<Value> value, F callback) {
   }
 }
 
-// TODO(joyeecheung): use fast API
-static void CRC32(const FunctionCallbackInfo<Value>& args) {
+using Checksum32Function = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+// crc32(data, value), crc32c(data, value) and adler32(data, value), where
+// |value| is the result for the preceding part of the input.
+template <Checksum32Function checksum>
+static void Checksum32(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsArrayBufferView() || args[0]->IsString());
   CHECK(args[1]->IsUint32());
   uint32_t value = args[1].As<v8::Uint32>()->Value();
@@ -1307,12 +2054,107 @@ static void CRC32(const FunctionCallbackInfo<Value>& args) {
       args.GetIsolate(),
       args[0],
       [&](const char* data, size_t size) -> uint32_t {
-        return crc32(value, reinterpret_cast<const Bytef*>(data), size);
+        return checksum(value, reinterpret_cast<const uint8_t*>(data), size);
       });
 
   args.GetReturnValue().Set(result);
 }
 
+template <Checksum32Function checksum>
+static uint32_t FastChecksum32(Local<Value> receiver,
+                               const FastApiTypedArray<uint8_t>& data,
+                               uint32_t value) {
+  uint8_t* contents;
+  CHECK(data.getStorageIfAligned(&contents));
+  return checksum(value, contents, data.length());
+}
+
+static CFunction fast_crc32(
+    CFunction::Make(FastChecksum32<checksum::Crc32>));
+static CFunction fast_crc32c(
+    CFunction::Make(FastChecksum32<checksum::Crc32c>));
+static CFunction fast_adler32(
+    CFunction::Make(FastChecksum32<checksum::Adler32>));
+
+// xxhash64(data, seed) returns the digest as a BigInt.
+static void XXHash64(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsArrayBufferView() || args[0]->IsString());
+  CHECK(args[1]->IsBigInt());
+  uint64_t seed = args[1].As<BigInt>()->Uint64Value();
+
+  uint64_t result = CallOnSequence<uint64_t>(
+      args.GetIsolate(),
+      args[0],
+      [&](const char* data, size_t size) -> uint64_t {
+        return checksum::XXHash64(
+            seed, reinterpret_cast<const uint8_t*>(data), size);
+      });
+
+  args.GetReturnValue().Set(
+      BigInt::NewFromUnsigned(args.GetIsolate(), result));
+}
+
+// Incremental counterpart of xxhash64(), for inputs that arrive in chunks.
+class XXHash64Stream final : public BaseObject {
+ public:
+  XXHash64Stream(Environment* env, Local<Object> wrap, uint64_t seed)
+      : BaseObject(env, wrap), state_(seed) {
+    MakeWeak();
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args.IsConstructCall());
+    CHECK(args[0]->IsBigInt());
+    new XXHash64Stream(
+        env, args.This(), args[0].As<BigInt>()->Uint64Value());
+  }
+
+  static void Update(const FunctionCallbackInfo<Value>& args) {
+    XXHash64Stream* stream;
+    ASSIGN_OR_RETURN_UNWRAP(&stream, args.This());
+    CHECK(args[0]->IsArrayBufferView() || args[0]->IsString());
+    CallOnSequence<bool>(
+        args.GetIsolate(),
+        args[0],
+        [&](const char* data, size_t size) -> bool {
+          stream->state_.Update(reinterpret_cast<const uint8_t*>(data), size);
+          return true;
+        });
+  }
+
+  static void Digest(const FunctionCallbackInfo<Value>& args) {
+    XXHash64Stream* stream;
+    ASSIGN_OR_RETURN_UNWRAP(&stream, args.This());
+    args.GetReturnValue().Set(BigInt::NewFromUnsigned(
+        args.GetIsolate(), stream->state_.Digest()));
+  }
+
+  static void Initialize(Environment* env, Local<Object> target) {
+    Isolate* isolate = env->isolate();
+    Local<FunctionTemplate> t = NewFunctionTemplate(isolate, New);
+    t->InstanceTemplate()->SetInternalFieldCount(
+        BaseObject::kInternalFieldCount);
+    SetProtoMethod(isolate, t, "update", Update);
+    SetProtoMethodNoSideEffect(isolate, t, "digest", Digest);
+    SetConstructorFunction(env->context(), target, "XXHash64", t);
+  }
+
+  static void RegisterExternalReferences(
+      ExternalReferenceRegistry* registry) {
+    registry->Register(New);
+    registry->Register(Update);
+    registry->Register(Digest);
+  }
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(XXHash64Stream)
+  SET_SELF_SIZE(XXHash64Stream)
+
+ private:
+  checksum::XXHash64State state_;
+};
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context,
@@ -1322,8 +2164,23 @@ void Initialize(Local<Object> target,
   MakeClass<ZlibStream>::Make(env, target, "Zlib");
   MakeClass<BrotliEncoderStream>::Make(env, target, "BrotliEncoder");
   MakeClass<BrotliDecoderStream>::Make(env, target, "BrotliDecoder");
-
-  SetMethod(context, target, "crc32", CRC32);
+#if NODE_HAVE_ZSTD
+  MakeClass<ZstdEncoderStream>::Make(env, target, "ZstdEncoder");
+  MakeClass<ZstdDecoderStream>::Make(env, target, "ZstdDecoder");
+#endif
+
+  XXHash64Stream::Initialize(env, target);
+
+  SetFastMethodNoSideEffect(
+      context, target, "crc32", Checksum32<checksum::Crc32>, &fast_crc32);
+  SetFastMethodNoSideEffect(
+      context, target, "crc32c", Checksum32<checksum::Crc32c>, &fast_crc32c);
+  SetFastMethodNoSideEffect(context,
+                            target,
+                            "adler32",
+                            Checksum32<checksum::Adler32>,
+                            &fast_adler32);
+  SetMethodNoSideEffect(context, target, "xxhash64", XXHash64);
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "ZLIB_VERSION"),
               FIXED_ONE_BYTE_STRING(env->isolate(), ZLIB_VERSION)).Check();
@@ -1333,7 +2190,21 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   MakeClass<ZlibStream>::Make(registry);
   MakeClass<BrotliEncoderStream>::Make(registry);
   MakeClass<BrotliDecoderStream>::Make(registry);
-  registry->Register(CRC32);
+#if NODE_HAVE_ZSTD
+  MakeClass<ZstdEncoderStream>::Make(registry);
+  MakeClass<ZstdDecoderStream>::Make(registry);
+#endif
+  XXHash64Stream::RegisterExternalReferences(registry);
+  registry->Register(Checksum32<checksum::Crc32>);
+  registry->Register(Checksum32<checksum::Crc32c>);
+  registry->Register(Checksum32<checksum::Adler32>);
+  registry->Register(FastChecksum32<checksum::Crc32>);
+  registry->Register(FastChecksum32<checksum::Crc32c>);
+  registry->Register(FastChecksum32<checksum::Adler32>);
+  registry->Register(fast_crc32.GetTypeInfo());
+  registry->Register(fast_crc32c.GetTypeInfo());
+  registry->Register(fast_adler32.GetTypeInfo());
+  registry->Register(XXHash64);
 }
 
 }  // anonymous namespace
@@ -1456,6 +2327,26 @@ void DefineZlibConstants(Local<Object> target) {
   NODE_DEFINE_CONSTANT(target, BROTLI_DECODER_ERROR_ALLOC_RING_BUFFER_2);
   NODE_DEFINE_CONSTANT(target, BROTLI_DECODER_ERROR_ALLOC_BLOCK_TYPE_TREES);
   NODE_DEFINE_CONSTANT(target, BROTLI_DECODER_ERROR_UNREACHABLE);
+
+#if NODE_HAVE_ZSTD
+  NODE_DEFINE_CONSTANT(target, ZSTD_COMPRESS);
+  NODE_DEFINE_CONSTANT(target, ZSTD_DECOMPRESS);
+  NODE_DEFINE_CONSTANT(target, ZSTD_e_continue);
+  NODE_DEFINE_CONSTANT(target, ZSTD_e_flush);
+  NODE_DEFINE_CONSTANT(target, ZSTD_e_end);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_compressionLevel);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_windowLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_checksumFlag);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_contentSizeFlag);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_dictIDFlag);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_nbWorkers);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_jobSize);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_overlapLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_enableLongDistanceMatching);
+  NODE_DEFINE_CONSTANT(target, ZSTD_d_windowLogMax);
+  NODE_DEFINE_CONSTANT(target, ZSTD_CLEVEL_DEFAULT);
+  NODE_DEFINE_CONSTANT(target, ZSTD_VERSION_NUMBER);
+#endif  // NODE_HAVE_ZSTD
 }
 
 }  // namespace node
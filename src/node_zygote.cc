@@ -0,0 +1,337 @@
+#include "node_zygote.h"
+#include "node_exit_code.h"
+#include "node_internals.h"
+#include "util.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __POSIX__
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif  // __POSIX__
+
+namespace node {
+namespace zygote {
+
+namespace {
+
+void AppendUint32(std::string* out, uint32_t value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool ReadUint32(std::string_view* in, uint32_t* value) {
+  if (in->size() < sizeof(*value)) return false;
+  memcpy(value, in->data(), sizeof(*value));
+  in->remove_prefix(sizeof(*value));
+  return true;
+}
+
+bool ReadString(std::string_view* in, std::string* value) {
+  size_t end = in->find('\0');
+  if (end == std::string_view::npos) return false;
+  value->assign(in->data(), end);
+  in->remove_prefix(end + 1);
+  return true;
+}
+
+}  // anonymous namespace
+
+std::string SerializeRequest(const SpawnRequest& request) {
+  std::string out;
+  AppendUint32(&out, static_cast<uint32_t>(request.args.size()));
+  AppendUint32(&out, static_cast<uint32_t>(request.env.size()));
+  for (const std::string& arg : request.args) out.append(arg).push_back('\0');
+  for (const std::string& var : request.env) out.append(var).push_back('\0');
+  out.append(request.cwd).push_back('\0');
+  return out;
+}
+
+bool ParseRequest(std::string_view payload, SpawnRequest* request) {
+  uint32_t argc;
+  uint32_t envc;
+  if (!ReadUint32(&payload, &argc) || !ReadUint32(&payload, &envc)) {
+    return false;
+  }
+  // Every string takes up at least one byte, which bounds the counts before
+  // anything is allocated for them.
+  if (argc == 0 || argc > payload.size() || envc > payload.size()) {
+    return false;
+  }
+
+  request->args.resize(argc);
+  for (std::string& arg : request->args) {
+    if (!ReadString(&payload, &arg)) return false;
+  }
+  request->env.resize(envc);
+  for (std::string& var : request->env) {
+    if (!ReadString(&payload, &var)) return false;
+  }
+  return ReadString(&payload, &request->cwd) && payload.empty();
+}
+
+#ifdef __POSIX__
+namespace {
+
+constexpr int kStdioCount = 3;
+
+int sigchld_pipe[2] = {-1, -1};
+
+void OnSigchld(int signo) {
+  int saved_errno = errno;
+  char c = 0;
+  USE(write(sigchld_pipe[1], &c, 1));
+  errno = saved_errno;
+}
+
+class Server {
+ public:
+  explicit Server(int fd) : fd_(fd) {}
+
+  // Returns only in a child.
+  void Run(int* argc, char*** argv);
+
+ private:
+  // Returns false on EOF or on an error of the socket, after which the
+  // zygote exits.
+  bool ReadRequest(std::string* payload, int stdio[kStdioCount]);
+  void Send(Message::Type type, int32_t pid, int32_t value);
+  void ReapChildren();
+  void SetUpChild(const SpawnRequest& request,
+                  int stdio[kStdioCount],
+                  int* argc,
+                  char*** argv);
+
+  int fd_;
+};
+
+void Server::Run(int* argc, char*** argv) {
+  CHECK_EQ(pipe(sigchld_pipe), 0);
+  for (int fd : sigchld_pipe) {
+    CHECK_NE(fcntl(fd, F_SETFD, FD_CLOEXEC), -1);
+    CHECK_NE(fcntl(fd, F_SETFL, O_NONBLOCK), -1);
+  }
+  struct sigaction act;
+  memset(&act, 0, sizeof(act));
+  act.sa_handler = OnSigchld;
+  act.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  CHECK_EQ(sigaction(SIGCHLD, &act, nullptr), 0);
+  // A requester that goes away must not kill the zygote before it has seen
+  // the end of the socket.
+  signal(SIGPIPE, SIG_IGN);
+
+  for (;;) {
+    struct pollfd fds[2] = {{fd_, POLLIN, 0}, {sigchld_pipe[0], POLLIN, 0}};
+    if (poll(fds, arraysize(fds), -1) == -1) {
+      CHECK_EQ(errno, EINTR);
+      continue;
+    }
+
+    if (fds[1].revents != 0) {
+      char buf[64];
+      while (read(sigchld_pipe[0], buf, sizeof(buf)) > 0) {
+      }
+      ReapChildren();
+    }
+
+    if (fds[0].revents == 0) continue;
+
+    std::string payload;
+    int stdio[kStdioCount] = {-1, -1, -1};
+    if (!ReadRequest(&payload, stdio)) {
+      // The children carry on, and are reparented to init.
+      exit(static_cast<int>(ExitCode::kNoFailure));
+    }
+
+    SpawnRequest request;
+    bool valid = ParseRequest(payload, &request);
+    for (int fd : stdio) valid = valid && fd != -1;
+
+    pid_t pid = -1;
+    int err = EINVAL;
+    if (valid) {
+      pid = fork();
+      err = errno;
+      if (pid == 0) {
+        SetUpChild(request, stdio, argc, argv);
+        return;
+      }
+    }
+
+    for (int fd : stdio) {
+      if (fd != -1) close(fd);
+    }
+    Send(Message::kSpawned, pid, pid == -1 ? err : 0);
+  }
+}
+
+bool Server::ReadRequest(std::string* payload, int stdio[kStdioCount]) {
+  uint32_t size;
+  char* header = reinterpret_cast<char*>(&size);
+  size_t received = 0;
+
+  while (received < sizeof(size)) {
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * 8)];
+    struct iovec iov = {header + received, sizeof(size) - received};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+#ifdef MSG_CMSG_CLOEXEC
+    ssize_t n = recvmsg(fd_, &msg, MSG_CMSG_CLOEXEC);
+#else
+    ssize_t n = recvmsg(fd_, &msg, 0);
+#endif
+    if (n == -1 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    received += n;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        continue;
+      }
+      size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      for (size_t i = 0; i < count; i++) {
+        int fd;
+        memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(fd));
+        if (i < kStdioCount && stdio[i] == -1) {
+          stdio[i] = fd;
+        } else {
+          close(fd);
+        }
+      }
+    }
+  }
+
+  if (size > kMaxRequestSize) return false;
+  payload->resize(size);
+  received = 0;
+  while (received < size) {
+    ssize_t n = read(fd_, payload->data() + received, size - received);
+    if (n == -1 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    received += n;
+  }
+  return true;
+}
+
+void Server::Send(Message::Type type, int32_t pid, int32_t value) {
+  Message message = {type, pid, value};
+  const char* data = reinterpret_cast<const char*>(&message);
+  size_t sent = 0;
+  while (sent < sizeof(message)) {
+    ssize_t n = write(fd_, data + sent, sizeof(message) - sent);
+    if (n == -1 && errno == EINTR) continue;
+    // The requester is gone; the next read will see that.
+    if (n == -1) return;
+    sent += n;
+  }
+}
+
+void Server::ReapChildren() {
+  int status;
+  pid_t pid;
+  while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    Send(Message::kExited, pid, status);
+  }
+}
+
+void Server::SetUpChild(const SpawnRequest& request,
+                        int stdio[kStdioCount],
+                        int* argc,
+                        char*** argv) {
+  close(fd_);
+  close(sigchld_pipe[0]);
+  close(sigchld_pipe[1]);
+  signal(SIGCHLD, SIG_DFL);
+  signal(SIGPIPE, SIG_DFL);
+
+  // Move the received descriptors out of the way first, in case the zygote
+  // was started without stdio and one of them is about to be overwritten.
+  for (int i = 0; i < kStdioCount; i++) {
+    if (stdio[i] < kStdioCount) stdio[i] = fcntl(stdio[i], F_DUPFD, 3);
+    if (stdio[i] == -1) _exit(127);
+  }
+  for (int i = 0; i < kStdioCount; i++) {
+    if (dup2(stdio[i], i) == -1) _exit(127);
+  }
+  for (int i = 0; i < kStdioCount; i++) close(stdio[i]);
+
+  if (!request.cwd.empty() && chdir(request.cwd.c_str()) != 0) {
+    fprintf(stderr,
+            "node: zygote: cannot change directory to %s: %s\n",
+            request.cwd.c_str(),
+            strerror(errno));
+    _exit(static_cast<int>(ExitCode::kGenericUserError));
+  }
+
+  // These live for the rest of the process, like the originals. The
+  // strings are packed into one block, the way the kernel lays them out,
+  // because uv_setup_args() takes the space from the start of argv[0] to
+  // the end of the last argument to be writable by process.title.
+  size_t block_size = 0;
+  for (const std::string& arg : request.args) block_size += arg.size() + 1;
+  for (const std::string& var : request.env) block_size += var.size() + 1;
+  char* block = new char[block_size];
+  char** new_argv = new char*[request.args.size() + 1];
+  char** new_env = new char*[request.env.size() + 1];
+  auto pack = [&block](const std::string& string) {
+    char* packed = block;
+    memcpy(packed, string.c_str(), string.size() + 1);
+    block += string.size() + 1;
+    return packed;
+  };
+  for (size_t i = 0; i < request.args.size(); i++)
+    new_argv[i] = pack(request.args[i]);
+  new_argv[request.args.size()] = nullptr;
+  for (size_t i = 0; i < request.env.size(); i++)
+    new_env[i] = pack(request.env[i]);
+  new_env[request.env.size()] = nullptr;
+
+  environ = new_env;
+  *argc = static_cast<int>(request.args.size());
+  *argv = new_argv;
+}
+
+}  // anonymous namespace
+#endif  // __POSIX__
+
+void MaybeRunServer(int* argc, char*** argv) {
+#ifdef __POSIX__
+  std::string fd_string;
+  if (!credentials::SafeGetenv("NODE_ZYGOTE_FD", &fd_string)) return;
+  // Neither the zygote nor its children pass it on.
+  unsetenv("NODE_ZYGOTE_FD");
+
+  char* end;
+  long fd = strtol(fd_string.c_str(), &end, 10);  // NOLINT(runtime/int)
+  struct stat s;
+  if (*end != '\0' || fd < 0 || fd > INT_MAX ||
+      fstat(static_cast<int>(fd), &s) != 0 || !S_ISSOCK(s.st_mode)) {
+    fprintf(stderr,
+            "%s: NODE_ZYGOTE_FD is not a socket: %s\n",
+            (*argv)[0],
+            fd_string.c_str());
+    exit(static_cast<int>(ExitCode::kInvalidCommandLineArgument));
+  }
+
+  Server server(static_cast<int>(fd));
+  server.Run(argc, argv);
+#endif  // __POSIX__
+}
+
+}  // namespace zygote
+}  // namespace node
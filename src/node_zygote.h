@@ -0,0 +1,67 @@
+#ifndef SRC_NODE_ZYGOTE_H_
+#define SRC_NODE_ZYGOTE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace node {
+namespace zygote {
+
+// A process started with NODE_ZYGOTE_FD set to the file descriptor of a
+// connected Unix domain stream socket becomes a zygote: it does not run any
+// JavaScript, and instead forks a new Node.js process for every request that
+// it reads from the socket. The children skip the exec() and the dynamic
+// loading of the binary, and start with its pages already resident. This is
+// done before the V8 platform, libuv or OpenSSL start any thread, because
+// none of them survive a fork(), so each child still bootstraps from the
+// built-in snapshot on its own.
+//
+// A request is a uint32_t holding the size of the payload in host byte
+// order, followed by the payload that SerializeRequest() makes. The file
+// descriptors that become the stdin, stdout and stderr of the child are sent
+// along with the first byte through SCM_RIGHTS. The zygote answers every
+// request with a kSpawned message, and later sends a kExited message once the
+// child has been reaped, as the requester cannot wait for it itself.
+struct SpawnRequest {
+  std::vector<std::string> args;
+  std::vector<std::string> env;
+  std::string cwd;
+};
+
+struct Message {
+  enum Type : uint32_t {
+    // `pid` is that of the child, or -1 if it could not be created, in which
+    // case `value` is the errno.
+    kSpawned = 1,
+    // `value` is the status that waitpid() reported for the child `pid`.
+    kExited = 2,
+  };
+  uint32_t type;
+  int32_t pid;
+  int32_t value;
+};
+
+static constexpr size_t kMaxRequestSize = 1 << 20;
+
+// The payload is the number of arguments and the number of environment
+// variables as uint32_t, followed by the arguments, the environment variables
+// and the working directory, each terminated by a NUL byte.
+std::string SerializeRequest(const SpawnRequest& request);
+bool ParseRequest(std::string_view payload, SpawnRequest* request);
+
+// Turns this process into a zygote if NODE_ZYGOTE_FD is set. This returns
+// only in the children it forks, with `argc` and `argv` replaced by the
+// arguments of the request, or right away if there is no zygote to run.
+// The zygote itself exits when the other end of the socket is closed.
+void MaybeRunServer(int* argc, char*** argv);
+
+}  // namespace zygote
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_ZYGOTE_H_
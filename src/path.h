@@ -4,6 +4,7 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace node {
@@ -18,6 +19,13 @@ std::string NormalizeString(const std::string_view path,
 
 std::string PathResolve(Environment* env,
                         const std::vector<std::string_view>& args);
+
+#ifndef _WIN32
+// path.posix.normalize().
+std::string PathNormalize(const std::string_view path);
+// Whether PathNormalize() returns `path` unchanged.
+bool IsNormalizedPath(const std::string_view path) noexcept;
+#endif  // _WIN32
 }  // namespace node
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <algorithm>
 #include <filesystem>
+#include <functional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -39,10 +40,8 @@ void FreeRecursivelyNode(
     return;
   }
 
-  if (node->children.size()) {
-    for (auto& c : node->children) {
-      FreeRecursivelyNode(c.second);
-    }
+  for (auto& c : node->children) {
+    FreeRecursivelyNode(c.second);
   }
 
   if (node->wildcard_child != nullptr) {
@@ -51,26 +50,6 @@ void FreeRecursivelyNode(
   delete node;
 }
 
-bool is_tree_granted(
-    node::Environment* env,
-    const node::permission::FSPermission::RadixTree* granted_tree,
-    const std::string_view& param) {
-  std::string resolved_param = node::PathResolve(env, {param});
-#ifdef _WIN32
-  // is UNC file path
-  if (resolved_param.rfind("\\\\", 0) == 0) {
-    // return lookup with normalized param
-    size_t starting_pos = 4;  // "\\?\"
-    if (resolved_param.rfind("\\\\?\\UNC\\") == 0) {
-      starting_pos += 4;  // "UNC\"
-    }
-    auto normalized = param.substr(starting_pos);
-    return granted_tree->Lookup(normalized, true);
-  }
-#endif
-  return granted_tree->Lookup(resolved_param, true);
-}
-
 void PrintTree(const node::permission::FSPermission::RadixTree::Node* node,
                size_t spaces = 0) {
   std::string whitespace(spaces, ' ');
@@ -142,13 +121,84 @@ void FSPermission::GrantAccess(PermissionScope perm, const std::string& res) {
   const std::string path = WildcardIfDir(res);
   if (perm == PermissionScope::kFileSystemRead) {
     granted_in_fs_.Insert(path);
+    in_cache_.Clear();
     deny_all_in_ = false;
   } else if (perm == PermissionScope::kFileSystemWrite) {
     granted_out_fs_.Insert(path);
+    out_cache_.Clear();
     deny_all_out_ = false;
   }
 }
 
+bool FSPermission::DecisionCache::Get(std::string_view path, bool* granted) {
+  size_t hash = std::hash<std::string_view>()(path);
+  for (size_t i = 0; i < size_; i++) {
+    Entry& entry = entries_[i];
+    if (entry.hash == hash && entry.path == path) {
+      entry.last_used = ++clock_;
+      *granted = entry.granted;
+      return true;
+    }
+  }
+  return false;
+}
+
+void FSPermission::DecisionCache::Put(std::string_view path, bool granted) {
+  Entry* entry = &entries_[0];
+  if (size_ < kSize) {
+    entry = &entries_[size_++];
+  } else {
+    for (Entry& candidate : entries_) {
+      if (candidate.last_used < entry->last_used) entry = &candidate;
+    }
+  }
+  entry->hash = std::hash<std::string_view>()(path);
+  entry->path = path;
+  entry->granted = granted;
+  entry->last_used = ++clock_;
+}
+
+void FSPermission::DecisionCache::Clear() {
+  size_ = 0;
+}
+
+bool FSPermission::is_tree_granted(Environment* env,
+                                   const RadixTree* granted_tree,
+                                   DecisionCache* cache,
+                                   std::string_view param) const {
+  bool granted;
+  // An absolute POSIX path resolves the same way whatever the working
+  // directory, so a cached decision saves resolving it, too. Other paths
+  // are cached once they are resolved.
+  bool absolute = false;
+#ifndef _WIN32
+  absolute = !param.empty() && param.front() == '/';
+#endif
+  if (absolute && cache->Get(param, &granted)) {
+    return granted;
+  }
+
+  std::string resolved_param = PathResolve(env, {param});
+#ifdef _WIN32
+  // is UNC file path
+  if (resolved_param.rfind("\\\\", 0) == 0) {
+    // return lookup with normalized param
+    size_t starting_pos = 4;  // "\\?\"
+    if (resolved_param.rfind("\\\\?\\UNC\\") == 0) {
+      starting_pos += 4;  // "UNC\"
+    }
+    auto normalized = param.substr(starting_pos);
+    return granted_tree->Lookup(normalized, true);
+  }
+#endif
+  if (!absolute && cache->Get(resolved_param, &granted)) {
+    return granted;
+  }
+  granted = granted_tree->Lookup(resolved_param, true);
+  cache->Put(absolute ? param : std::string_view(resolved_param), granted);
+  return granted;
+}
+
 bool FSPermission::is_granted(Environment* env,
                               PermissionScope perm,
                               const std::string_view& param = "") const {
@@ -158,11 +208,11 @@ bool FSPermission::is_granted(Environment* env,
     case PermissionScope::kFileSystemRead:
       return !deny_all_in_ &&
              ((param.empty() && allow_all_in_) || allow_all_in_ ||
-              is_tree_granted(env, &granted_in_fs_, param));
+              is_tree_granted(env, &granted_in_fs_, &in_cache_, param));
     case PermissionScope::kFileSystemWrite:
       return !deny_all_out_ &&
              ((param.empty() && allow_all_out_) || allow_all_out_ ||
-              is_tree_granted(env, &granted_out_fs_, param));
+              is_tree_granted(env, &granted_out_fs_, &out_cache_, param));
     default:
       return false;
   }
@@ -181,15 +231,14 @@ bool FSPermission::RadixTree::Lookup(const std::string_view& s,
     return when_empty_return;
   }
   size_t parent_node_prefix_len = current_node->prefix.length();
-  const std::string path(s);
-  auto path_len = path.length();
+  auto path_len = s.length();
 
   while (true) {
     if (parent_node_prefix_len == path_len && current_node->IsEndNode()) {
       return true;
     }
 
-    auto node = current_node->NextNode(path, parent_node_prefix_len);
+    auto node = current_node->NextNode(s, parent_node_prefix_len);
     if (node == nullptr) {
       return false;
     }
@@ -5,7 +5,12 @@
 
 #include "v8.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "permission/permission_base.h"
 #include "util.h"
 
@@ -25,7 +30,9 @@ class FSPermission final : public PermissionBase {
   struct RadixTree {
     struct Node {
       std::string prefix;
-      std::unordered_map<char, Node*> children;
+      // Sorted by label. Most nodes have one or two children, which makes a
+      // flat array both smaller and faster to search than a hash map.
+      std::vector<std::pair<char, Node*>> children;
       Node* wildcard_child;
       bool is_leaf;
 
@@ -34,6 +41,32 @@ class FSPermission final : public PermissionBase {
 
       Node() : wildcard_child(nullptr), is_leaf(false) {}
 
+      Node* FindChild(char label) const {
+        auto it = LowerBound(label);
+        return it != children.end() && it->first == label ? it->second
+                                                           : nullptr;
+      }
+
+      void SetChild(char label, Node* child) {
+        auto it = children.begin() + (LowerBound(label) - children.cbegin());
+        if (it != children.end() && it->first == label) {
+          it->second = child;
+        } else {
+          children.emplace(it, label, child);
+        }
+      }
+
+      std::vector<std::pair<char, Node*>>::const_iterator LowerBound(
+          char label) const {
+        return std::lower_bound(
+            children.begin(),
+            children.end(),
+            label,
+            [](const std::pair<char, Node*>& child, char label) {
+              return child.first < label;
+            });
+      }
+
       Node* CreateChild(const std::string& path_prefix) {
         if (path_prefix.empty() && !is_leaf) {
           is_leaf = true;
@@ -43,10 +76,11 @@ class FSPermission final : public PermissionBase {
         CHECK(!path_prefix.empty());
         char label = path_prefix[0];
 
-        Node* child = children[label];
+        Node* child = FindChild(label);
         if (child == nullptr) {
-          children[label] = new Node(path_prefix);
-          return children[label];
+          child = new Node(path_prefix);
+          SetChild(label, child);
+          return child;
         }
 
         // swap prefix
@@ -59,8 +93,8 @@ class FSPermission final : public PermissionBase {
 
             child->prefix = child_prefix;
             Node* split_child = new Node(parent_prefix);
-            split_child->children[child_prefix[0]] = child;
-            children[parent_prefix[0]] = split_child;
+            split_child->SetChild(child_prefix[0], child);
+            SetChild(parent_prefix[0], split_child);
 
             return split_child->CreateChild(path_prefix.substr(i));
           }
@@ -77,24 +111,23 @@ class FSPermission final : public PermissionBase {
         return wildcard_child;
       }
 
-      Node* NextNode(const std::string& path, size_t idx) const {
+      Node* NextNode(std::string_view path, size_t idx) const {
         if (idx >= path.length()) {
           return nullptr;
         }
 
         // wildcard node takes precedence
         if (children.size() > 1) {
-          auto it = children.find('*');
-          if (it != children.end()) {
-            return it->second;
+          Node* wildcard = FindChild('*');
+          if (wildcard != nullptr) {
+            return wildcard;
           }
         }
 
-        auto it = children.find(path[idx]);
-        if (it == children.end()) {
+        Node* child = FindChild(path[idx]);
+        if (child == nullptr) {
           return nullptr;
         }
-        auto child = it->second;
         // match prefix
         size_t prefix_len = child->prefix.length();
         for (size_t i = 0; i < path.length(); ++i) {
@@ -147,10 +180,41 @@ class FSPermission final : public PermissionBase {
   };
 
  private:
+  // The most recent decisions for one scope, by absolute path. Permissions
+  // belong to an Environment, so a cache is only ever used by the thread of
+  // that Environment.
+  class DecisionCache {
+   public:
+    static constexpr size_t kSize = 16;
+
+    // Returns false if `path` is not in the cache.
+    bool Get(std::string_view path, bool* granted);
+    void Put(std::string_view path, bool granted);
+    void Clear();
+
+   private:
+    struct Entry {
+      size_t hash = 0;
+      std::string path;
+      bool granted = false;
+      uint64_t last_used = 0;
+    };
+
+    std::array<Entry, kSize> entries_;
+    size_t size_ = 0;
+    uint64_t clock_ = 0;
+  };
+
+  bool is_tree_granted(Environment* env,
+                       const RadixTree* granted_tree,
+                       DecisionCache* cache,
+                       std::string_view param) const;
   void GrantAccess(PermissionScope scope, const std::string& param);
   // fs granted on startup
   RadixTree granted_in_fs_;
   RadixTree granted_out_fs_;
+  mutable DecisionCache in_cache_;
+  mutable DecisionCache out_cache_;
 
   bool deny_all_in_ = true;
   bool deny_all_out_ = true;
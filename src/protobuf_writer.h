@@ -0,0 +1,64 @@
+#ifndef SRC_PROTOBUF_WRITER_H_
+#define SRC_PROTOBUF_WRITER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace node {
+namespace protobuf {
+
+// Just enough of the protocol buffer wire format to write the profiles and
+// traces that node produces, without depending on libprotobuf.
+enum WireType { kVarint = 0, kFixed64 = 1, kLengthDelimited = 2 };
+
+inline void WriteVarint(std::string* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+inline void WriteTag(std::string* out, uint32_t field, WireType type) {
+  WriteVarint(out, (field << 3) | type);
+}
+
+inline void WriteInt(std::string* out, uint32_t field, int64_t value) {
+  WriteTag(out, field, kVarint);
+  WriteVarint(out, static_cast<uint64_t>(value));
+}
+
+// For proto3 fields, where zero is the default and does not need to be
+// written.
+inline void WriteNonZeroInt(std::string* out, uint32_t field, int64_t value) {
+  if (value != 0) WriteInt(out, field, value);
+}
+
+inline void WriteDouble(std::string* out, uint32_t field, double value) {
+  uint64_t bits;
+  static_assert(sizeof(bits) == sizeof(value));
+  memcpy(&bits, &value, sizeof(bits));
+  WriteTag(out, field, kFixed64);
+  // The wire format is little-endian.
+  for (int i = 0; i < 8; i++)
+    out->push_back(static_cast<char>(bits >> (8 * i)));
+}
+
+inline void WriteBytes(std::string* out,
+                       uint32_t field,
+                       std::string_view bytes) {
+  WriteTag(out, field, kLengthDelimited);
+  WriteVarint(out, bytes.size());
+  out->append(bytes);
+}
+
+}  // namespace protobuf
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_PROTOBUF_WRITER_H_
@@ -32,8 +32,12 @@ const Session::Application_Options Session::Application_Options::kDefault = {};
 Session::Application_Options::operator const nghttp3_settings() const {
   // In theory, Application_Options might contain options for more than just
   // HTTP/3. Here we extract only the properties that are relevant to HTTP/3.
+  // Every field counts 32 bytes on top of its name and value, per RFC 9204.
+  uint64_t field_section_size = max_field_section_size;
+  if (field_section_size == 0)
+    field_section_size = max_header_length + max_header_pairs * 32;
   return nghttp3_settings{
-      max_field_section_size,
+      field_section_size,
       static_cast<size_t>(qpack_max_dtable_capacity),
       static_cast<size_t>(qpack_encoder_max_dtable_capacity),
       static_cast<size_t>(qpack_blocked_streams),
@@ -241,6 +245,10 @@ void Session::Application::SendPendingData() {
   PathStorage path;
   StreamData stream_data;
 
+  // Hand the packets prepared below to the endpoint as a single batch so
+  // that it can coalesce them.
+  Endpoint::SendBatchScope send_batch(session_->endpoint_.get());
+
   // The maximum size of packet to create.
   const size_t max_packet_size = session_->max_packet_size();
 
@@ -11,6 +11,7 @@
 #include <node_mem-inl.h>
 #include <node_realm-inl.h>
 #include <v8.h>
+#include "tlscontext.h"
 
 namespace node {
 
@@ -50,13 +51,18 @@ void BindingData::CheckAllocatedSize(size_t previous_size) const {
 
 void BindingData::IncreaseAllocatedSize(size_t size) {
   current_ngtcp2_memory_ += size;
+  env()->native_memory_counters()->Increase(
+      mem::NativeMemoryCounters::kQuic, size);
 }
 
 void BindingData::DecreaseAllocatedSize(size_t size) {
   current_ngtcp2_memory_ -= size;
+  env()->native_memory_counters()->Decrease(
+      mem::NativeMemoryCounters::kQuic, size);
 }
 
 void BindingData::InitPerContext(Realm* realm, Local<Object> target) {
+  TLSContext::InitializeCrypto();
   SetMethod(realm->context(), target, "setCallbacks", SetCallbacks);
   SetMethod(
       realm->context(), target, "flushPacketFreelist", FlushPacketFreelist);
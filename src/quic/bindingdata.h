@@ -100,6 +100,7 @@ class Packet;
   V(max_header_length, "maxHeaderLength")                                      \
   V(max_header_pairs, "maxHeaderPairs")                                        \
   V(max_idle_timeout, "maxIdleTimeout")                                        \
+  V(max_pacing_rate, "maxPacingRate")                                          \
   V(max_payload_size, "maxPayloadSize")                                        \
   V(max_retries, "maxRetries")                                                 \
   V(max_stateless_resets, "maxStatelessResetsPerHost")                         \
@@ -117,11 +118,16 @@ class Packet;
   V(reno, "reno")                                                              \
   V(retry_token_expiration, "retryTokenExpiration")                            \
   V(reset_token_secret, "resetTokenSecret")                                    \
+  V(reuse_port, "reusePort")                                                   \
   V(rx_loss, "rxDiagnosticLoss")                                               \
   V(session, "Session")                                                        \
+  V(shard_id, "shardId")                                                       \
+  V(sharded, "sharded")                                                        \
   V(sni, "sni")                                                                \
   V(stream, "Stream")                                                          \
   V(success, "success")                                                        \
+  V(ticket_lifetime, "ticketLifetime")                                         \
+  V(ticket_secret, "ticketSecret")                                             \
   V(tls_options, "tls")                                                        \
   V(token_expiration, "tokenExpiration")                                       \
   V(token_secret, "tokenSecret")                                               \
@@ -142,6 +142,32 @@ class RandomCIDFactory : public CID::Factory {
   mutable uint8_t pool_[kPoolSize];
   mutable Mutex mutex_;
 };
+
+class ShardedCIDFactory : public CID::Factory {
+ public:
+  ShardedCIDFactory() = default;
+  DISALLOW_COPY_AND_MOVE(ShardedCIDFactory)
+
+  void set_shard_id(uint8_t shard_id) { shard_id_ = shard_id; }
+
+  CID Generate(size_t length_hint) const override {
+    uint8_t data[CID::kMaxLength];
+    CID cid = CID::Factory::random().Generate(length_hint);
+    memcpy(data, static_cast<const uint8_t*>(cid), cid.length());
+    data[0] = shard_id_;
+    return CID(data, cid.length());
+  }
+
+  CID GenerateInto(ngtcp2_cid* cid,
+                   size_t length_hint = CID::kMaxLength) const override {
+    CID::Factory::random().GenerateInto(cid, length_hint);
+    cid->data[0] = shard_id_;
+    return CID(cid);
+  }
+
+ private:
+  uint8_t shard_id_ = 0;
+};
 }  // namespace
 
 const CID::Factory& CID::Factory::random() {
@@ -149,6 +175,20 @@ const CID::Factory& CID::Factory::random() {
   return instance;
 }
 
+const CID::Factory& CID::Factory::sharded(uint8_t shard_id) {
+  static ShardedCIDFactory* instances = [] {
+    auto* factories = new ShardedCIDFactory[256];
+    for (int n = 0; n < 256; n++) factories[n].set_shard_id(n);
+    return factories;
+  }();
+  return instances[shard_id];
+}
+
+uint8_t CID::Factory::ShardOf(const CID& cid) {
+  DCHECK(cid);
+  return static_cast<const uint8_t*>(cid)[0];
+}
+
 }  // namespace quic
 }  // namespace node
 #endif  // HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
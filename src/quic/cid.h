@@ -118,6 +118,16 @@ class CID::Factory {
   // The default random CID generator instance.
   static const Factory& random();
 
+  // A random CID generator whose CIDs carry `shard_id` in their first byte.
+  // Endpoints that share a UDP port across threads use this to recognize
+  // packets that belong to a session owned by another thread, even after
+  // the peer migrated to a new path and the kernel steered the packet
+  // elsewhere. The shard is not hidden from observers.
+  static const Factory& sharded(uint8_t shard_id);
+
+  // Returns the shard encoded by a sharded() factory into `cid`.
+  static uint8_t ShardOf(const CID& cid);
+
   // TODO(@jasnell): This will soon also include additional implementations
   // of CID::Factory that implement the QUIC Load Balancers spec.
 };
@@ -15,6 +15,9 @@
 #include <util-inl.h>
 #include <uv.h>
 #include <v8.h>
+#ifdef __linux__
+#include <netinet/udp.h>  // UDP_SEGMENT
+#endif
 #include <limits>
 #include "application.h"
 #include "bindingdata.h"
@@ -249,15 +252,16 @@ Maybe<Endpoint::Options> Endpoint::Options::From(Environment* env,
       !SET(max_stateless_resets) || !SET(address_lru_size) ||
       !SET(max_retries) || !SET(max_payload_size) ||
       !SET(unacknowledged_packet_threshold) || !SET(validate_address) ||
-      !SET(disable_stateless_reset) || !SET(ipv6_only) ||
+      !SET(disable_stateless_reset) || !SET(ipv6_only) || !SET(reuse_port) ||
+      !SET(sharded) || !SET(shard_id) ||
       !SET(handshake_timeout) || !SET(max_stream_window) || !SET(max_window) ||
       !SET(no_udp_payload_size_shaping) ||
 #ifdef DEBUG
       !SET(rx_loss) || !SET(tx_loss) ||
 #endif
       !SET(cc_algorithm) || !SET(udp_receive_buffer_size) ||
-      !SET(udp_send_buffer_size) || !SET(udp_ttl) || !SET(reset_token_secret) ||
-      !SET(token_secret)) {
+      !SET(udp_send_buffer_size) || !SET(udp_ttl) || !SET(max_pacing_rate) ||
+      !SET(reset_token_secret) || !SET(token_secret)) {
     return Nothing<Options>();
   }
 
@@ -348,11 +352,15 @@ std::string Endpoint::Options::ToString() const {
   res += prefix + "reset token secret: " + reset_token_secret.ToString();
   res += prefix + "token secret: " + token_secret.ToString();
   res += prefix + "ipv6 only: " + boolToString(ipv6_only);
+  res += prefix + "reuse port: " + boolToString(reuse_port);
+  res += prefix + "sharded: " + boolToString(sharded);
+  if (sharded) res += prefix + "shard id: " + std::to_string(shard_id);
   res += prefix +
          "udp receive buffer size: " + std::to_string(udp_receive_buffer_size);
   res +=
       prefix + "udp send buffer size: " + std::to_string(udp_send_buffer_size);
   res += prefix + "udp ttl: " + std::to_string(udp_ttl);
+  res += prefix + "max pacing rate: " + std::to_string(max_pacing_rate);
 
   res += indent.Close();
   return res;
@@ -402,7 +410,10 @@ class Endpoint::UDP::Impl final : public HandleWrap {
                    reinterpret_cast<uv_handle_t*>(&handle_),
                    AsyncWrap::PROVIDER_QUIC_UDP),
         endpoint_(endpoint) {
-    CHECK_EQ(uv_udp_init(endpoint->env()->event_loop(), &handle_), 0);
+    CHECK_EQ(uv_udp_init_ex(endpoint->env()->event_loop(),
+                            &handle_,
+                            AF_UNSPEC | UV_UDP_RECVMMSG),
+             0);
     handle_.data = this;
   }
 
@@ -414,7 +425,12 @@ class Endpoint::UDP::Impl final : public HandleWrap {
   static void OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-    *buf = From(handle)->env()->allocate_managed_buffer(suggested_size);
+    Environment* env = From(handle)->env();
+    *buf = uv_buf_init(nullptr, 0);
+    if (uv_udp_using_recvmmsg(reinterpret_cast<uv_udp_t*>(handle)))
+      *buf = env->allocate_udp_batch_buffer();
+    if (buf->base == nullptr)
+      *buf = env->allocate_managed_buffer(suggested_size);
   }
 
   static void OnReceive(uv_udp_t* handle,
@@ -422,23 +438,39 @@ class Endpoint::UDP::Impl final : public HandleWrap {
                         const uv_buf_t* buf,
                         const sockaddr* addr,
                         unsigned int flags) {
+    auto impl = From(handle);
+    DCHECK_NOT_NULL(impl);
+    DCHECK_NOT_NULL(impl->endpoint_);
+    Environment* env = impl->env();
+
+    // Packets read with recvmmsg() into the batch buffer are copied into
+    // managed buffers of their own size, which is what Receive() expects.
+    // The batch buffer is released by the call that does not carry a chunk.
+    bool batched = env->is_udp_batch_buffer(buf->base);
+    if (batched && !(flags & UV_UDP_MMSG_CHUNK)) {
+      env->release_udp_batch_buffer();
+    } else if (flags & UV_UDP_MMSG_FREE) {
+      // The managed buffer was a single chunk and went along with it.
+      return;
+    }
+
     // Nothing to do in these cases. Specifically, if the nread
     // is zero or we've received a partial packet, we're just
     // going to ignore it.
     if (nread == 0 || flags & UV_UDP_PARTIAL) return;
 
-    auto impl = From(handle);
-    DCHECK_NOT_NULL(impl);
-    DCHECK_NOT_NULL(impl->endpoint_);
-
     if (nread < 0) {
       impl->endpoint_->Destroy(CloseContext::RECEIVE_FAILURE,
                                static_cast<int>(nread));
       return;
     }
 
-    impl->endpoint_->Receive(uv_buf_init(buf->base, static_cast<size_t>(nread)),
-                             SocketAddress(addr));
+    uv_buf_t packet = uv_buf_init(buf->base, static_cast<size_t>(nread));
+    if (batched) {
+      packet = env->allocate_managed_buffer(nread);
+      memcpy(packet.base, buf->base, nread);
+    }
+    impl->endpoint_->Receive(packet, SocketAddress(addr));
   }
 
   uv_udp_t handle_;
@@ -462,6 +494,30 @@ int Endpoint::UDP::Bind(const Endpoint::Options& options) {
   int flags = 0;
   if (options.local_address->family() == AF_INET6 && options.ipv6_only)
     flags |= UV_UDP_IPV6ONLY;
+
+  if (options.reuse_port) {
+#ifdef __linux__
+    // libuv only knows about SO_REUSEADDR, which on Linux does not balance
+    // datagrams across sockets, so create the socket ourselves.
+    int fd = socket(
+        options.local_address->family(), SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) return uv_translate_sys_error(errno);
+    int on = 1;
+    int err = 0;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1) {
+      err = uv_translate_sys_error(errno);
+    } else {
+      err = uv_udp_open(&impl_->handle_, fd);
+    }
+    if (err) {
+      close(fd);
+      return err;
+    }
+#else
+    return UV_ENOTSUP;
+#endif  // __linux__
+  }
+
   int err = uv_udp_bind(&impl_->handle_, options.local_address->data(), flags);
   int size;
 
@@ -486,6 +542,28 @@ int Endpoint::UDP::Bind(const Endpoint::Options& options) {
       err = uv_udp_set_ttl(&impl_->handle_, size);
       if (err) return err;
     }
+
+    if (options.max_pacing_rate > 0) {
+#if defined(__linux__) && defined(SO_MAX_PACING_RATE)
+      uv_os_fd_t fd;
+      err = uv_fileno(reinterpret_cast<uv_handle_t*>(&impl_->handle_), &fd);
+      if (err) return err;
+      // Older kernels only take the 32-bit form.
+      uint64_t rate64 = options.max_pacing_rate;
+      uint32_t rate32 = static_cast<uint32_t>(rate64);
+      int ret;
+      if (rate64 == rate32) {
+        ret = setsockopt(
+            fd, SOL_SOCKET, SO_MAX_PACING_RATE, &rate32, sizeof(rate32));
+      } else {
+        ret = setsockopt(
+            fd, SOL_SOCKET, SO_MAX_PACING_RATE, &rate64, sizeof(rate64));
+      }
+      if (ret == -1) return uv_translate_sys_error(errno);
+#else
+      return UV_ENOTSUP;
+#endif  // __linux__ && SO_MAX_PACING_RATE
+    }
   }
 
   return err;
@@ -580,6 +658,65 @@ int Endpoint::UDP::Send(Packet* packet) {
   return err;
 }
 
+size_t Endpoint::UDP::TrySendCoalesced(Packet** packets, size_t count) {
+#if defined(__linux__) && defined(UDP_SEGMENT)
+  // The kernel accepts at most 64 segments per GSO send.
+  if (gso_unavailable_ || count < 2 || count > 64 || is_closed_or_closing())
+    return 0;
+  // Don't let the train overtake packets that libuv has already queued.
+  if (uv_udp_get_send_queue_count(&impl_->handle_) > 0) return 0;
+
+  uv_os_fd_t fd;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&impl_->handle_), &fd) != 0)
+    return 0;
+
+  const size_t segment_size = packets[0]->length();
+  iovec iov[64];
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    uv_buf_t buf = *packets[i];
+    DCHECK(i + 1 == count ? buf.len <= segment_size : buf.len == segment_size);
+    iov[i].iov_base = buf.base;
+    iov[i].iov_len = buf.len;
+    total += buf.len;
+  }
+  if (total > 65507) return 0;
+
+  const SocketAddress& destination = packets[0]->destination();
+  char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+  msghdr h{};
+  h.msg_name = const_cast<sockaddr*>(destination.data());
+  h.msg_namelen = destination.length();
+  h.msg_iov = iov;
+  h.msg_iovlen = count;
+  h.msg_control = control;
+  h.msg_controllen = sizeof(control);
+  cmsghdr* cm = CMSG_FIRSTHDR(&h);
+  cm->cmsg_level = SOL_UDP;
+  cm->cmsg_type = UDP_SEGMENT;
+  cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  uint16_t segment = static_cast<uint16_t>(segment_size);
+  memcpy(CMSG_DATA(cm), &segment, sizeof(segment));
+
+  ssize_t r;
+  do {
+    r = sendmsg(fd, &h, 0);
+  } while (r == -1 && errno == EINTR);
+
+  if (r < 0) {
+    // EIO and EINVAL mean that the socket or device cannot do GSO. Stop
+    // trying; any other error is reported by the regular send path.
+    if (errno == EIO || errno == EINVAL) gso_unavailable_ = true;
+    return 0;
+  }
+
+  for (size_t i = 0; i < count; i++) packets[i]->Done(0);
+  return count;
+#else
+  return 0;
+#endif  // __linux__ && UDP_SEGMENT
+}
+
 void Endpoint::UDP::MemoryInfo(MemoryTracker* tracker) const {
   if (impl_) tracker->TrackField("impl", impl_);
 }
@@ -814,6 +951,17 @@ void Endpoint::Send(Packet* packet) {
   if (is_closed() || is_closing() || packet->length() == 0) return;
   Debug(this, "Sending %s", packet->ToString());
   state_->pending_callbacks++;
+  STAT_INCREMENT_N(Stats, bytes_sent, packet->length());
+  STAT_INCREMENT(Stats, packets_sent);
+
+  if (send_batch_depth_ > 0) {
+    send_batch_.push_back(packet);
+    return;
+  }
+  SendNow(packet);
+}
+
+void Endpoint::SendNow(Packet* packet) {
   int err = udp_.Send(packet);
 
   if (err != 0) {
@@ -821,8 +969,49 @@ void Endpoint::Send(Packet* packet) {
     packet->Done(err);
     Destroy(CloseContext::SEND_FAILURE, err);
   }
-  STAT_INCREMENT_N(Stats, bytes_sent, packet->length());
-  STAT_INCREMENT(Stats, packets_sent);
+}
+
+void Endpoint::FlushSendBatch() {
+  std::vector<Packet*> packets;
+  packets.swap(send_batch_);
+
+  size_t i = 0;
+  while (i < packets.size()) {
+    if (is_closed() || is_closing()) {
+      for (; i < packets.size(); i++) packets[i]->Done(UV_ECANCELED);
+      return;
+    }
+
+    // Find the longest train of packets to the same destination that GSO can
+    // send as one: equally sized packets, optionally followed by a shorter
+    // one.
+    const size_t segment_size = packets[i]->length();
+    size_t count = 1;
+    while (i + count < packets.size() &&
+           packets[i + count - 1]->length() == segment_size &&
+           packets[i + count]->length() <= segment_size &&
+           packets[i + count]->destination() == packets[i]->destination()) {
+      count++;
+    }
+
+    size_t sent = count > 1 ? udp_.TrySendCoalesced(&packets[i], count) : 0;
+    if (sent > 0) {
+      Debug(this, "Sent %zu packets with a single GSO send", sent);
+    }
+    for (size_t n = sent; n < count; n++) SendNow(packets[i + n]);
+    i += count;
+  }
+}
+
+Endpoint::SendBatchScope::SendBatchScope(Endpoint* endpoint)
+    : endpoint_(endpoint) {
+  if (endpoint_) endpoint_->send_batch_depth_++;
+}
+
+Endpoint::SendBatchScope::~SendBatchScope() {
+  if (!endpoint_) return;
+  DCHECK_GT(endpoint_->send_batch_depth_, 0);
+  if (--endpoint_->send_batch_depth_ == 0) endpoint_->FlushSendBatch();
 }
 
 void Endpoint::SendRetry(const PathDescriptor& options) {
@@ -977,6 +1166,10 @@ void Endpoint::Listen(const Session::Options& options) {
       options,
       std::move(context),
   };
+  if (options_.sharded) {
+    server_state_->options.cid_factory =
+        &CID::Factory::sharded(options_.shard_id);
+  }
   if (Start()) {
     Debug(this, "Listening with options %s", server_state_->options);
     state_->listening = 1;
@@ -991,6 +1184,8 @@ BaseObjectPtr<Session> Endpoint::Connect(
   if (!Start()) return BaseObjectPtr<Session>();
 
   Session::Config config(*this, options, local_address(), remote_address);
+  if (options_.sharded)
+    config.options.cid_factory = &CID::Factory::sharded(options_.shard_id);
 
   IF_QUIC_DEBUG(env()) {
     Debug(
@@ -1575,6 +1770,16 @@ void Endpoint::Receive(const uv_buf_t& buf,
       return;  // Stateless reset! Don't do any further processing.
     }
 
+    // A short header packet carrying a CID issued by another shard belongs
+    // to a session on another endpoint sharing our port; the kernel steered
+    // it here, for instance after the peer migrated. Answering it with a
+    // stateless reset would kill that session, so drop it instead.
+    if (!scid && options_.sharded && dcid &&
+        CID::Factory::ShardOf(dcid) != options_.shard_id) {
+      Debug(this, "Ignoring packet for shard %d", CID::Factory::ShardOf(dcid));
+      return;
+    }
+
     // Process the packet as an initial packet...
     return acceptInitialPacket(pversion_cid.version,
                                dcid,
@@ -11,6 +11,7 @@
 #include <v8.h>
 #include <algorithm>
 #include <optional>
+#include <vector>
 #include "bindingdata.h"
 #include "packet.h"
 #include "session.h"
@@ -148,7 +149,8 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
     // BBR. The details of how each works is not relevant here. The choice of
     // which to use by default is arbitrary and we can choose whichever we'd
     // like. Additional performance profiling will be needed to determine which
-    // is the better of the two for our needs.
+    // is the better of the two for our needs. ngtcp2's BBR implements BBRv2,
+    // which also sets the pacing rate from its bandwidth estimate.
     ngtcp2_cc_algo cc_algorithm = CC_ALGO_CUBIC;
 
     // By default, when the endpoint is created, it will generate a
@@ -168,6 +170,20 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
     // flag on the underlying uv_udp_t.
     bool ipv6_only = false;
 
+    // When true, the UDP socket is bound with SO_REUSEPORT so that several
+    // endpoints, typically one per worker thread, can share the same local
+    // address and the kernel spreads incoming flows across them. Only
+    // supported on Linux.
+    bool reuse_port = false;
+
+    // When true, all CIDs issued by this endpoint encode shard_id (see
+    // CID::Factory::sharded()). Short header packets for unknown sessions
+    // whose CID names another shard are then dropped rather than answered
+    // with a stateless reset, because the session lives on another endpoint
+    // bound to the same port.
+    bool sharded = false;
+    uint8_t shard_id = 0;
+
     uint32_t udp_receive_buffer_size = 0;
     uint32_t udp_send_buffer_size = 0;
 
@@ -176,6 +192,15 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
     // Setting to 0 uses the default.
     uint8_t udp_ttl = 0;
 
+    // The number of bytes per second that the kernel may send from the UDP
+    // socket, which it enforces by spacing out the packets, including those
+    // of a GSO train, when the interface uses the fq qdisc. This caps all of
+    // the sessions of the endpoint together, on top of the pacing that ngtcp2
+    // does for each of them, and suits endpoints that serve few connections
+    // over links prone to loss from bursts. 0 leaves it unset. Only supported
+    // on Linux.
+    uint64_t max_pacing_rate = 0;
+
     void MemoryInfo(MemoryTracker* tracker) const override;
     SET_MEMORY_INFO_NAME(Endpoint::Config)
     SET_SELF_SIZE(Options)
@@ -235,6 +260,20 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
 
   void Send(Packet* packet);
 
+  // While a SendBatchScope is active, packets passed to Send() are queued and
+  // flushed when the outermost scope goes away. Consecutive packets to the
+  // same destination are then written with a single UDP GSO send where the
+  // platform supports it, instead of one uv_udp_send() per packet.
+  class SendBatchScope final {
+   public:
+    explicit SendBatchScope(Endpoint* endpoint);
+    DISALLOW_COPY_AND_MOVE(SendBatchScope)
+    ~SendBatchScope();
+
+   private:
+    BaseObjectPtr<Endpoint> endpoint_;
+  };
+
   // Generates and sends a retry packet. This is terminal for the connection.
   // Retry packets are used to force explicit path validation by issuing a token
   // to the peer that it must thereafter include in all subsequent initial
@@ -301,6 +340,12 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
     void Close();
     int Send(Packet* packet);
 
+    // Writes `count` packets to the same destination with one UDP GSO
+    // sendmsg(). All packets but the last must have the same length, and the
+    // last must not be longer. Returns `count` if the packets were sent (and
+    // are done), or 0 if the caller should send them individually.
+    size_t TrySendCoalesced(Packet** packets, size_t count);
+
     // Returns the local UDP socket address to which we are bound,
     // or fail with an assert if we are not bound.
     SocketAddress local_address() const;
@@ -324,6 +369,7 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
     bool is_bound_ = false;
     bool is_started_ = false;
     bool is_closed_ = false;
+    bool gso_unavailable_ = false;
   };
 
   bool is_closed() const;
@@ -409,6 +455,9 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
 
   void Receive(const uv_buf_t& buf, const SocketAddress& from);
 
+  void SendNow(Packet* packet);
+  void FlushSendBatch();
+
   AliasedStruct<Stats> stats_;
   AliasedStruct<State> state_;
   const Options options_;
@@ -448,6 +497,10 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
   CloseContext close_context_ = CloseContext::CLOSE;
   int close_status_ = 0;
 
+  // Packets queued by Send() while a SendBatchScope is active.
+  std::vector<Packet*> send_batch_;
+  size_t send_batch_depth_ = 0;
+
   friend class UDP;
   friend class Packet;
   friend class Session;
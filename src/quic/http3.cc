@@ -371,6 +371,52 @@ class Http3Application final : public Session::Application {
     return 0;
   }
 
+  // The body of a stream is handed to nghttp3 straight from the outbound
+  // DataQueue of the stream. nghttp3 keeps referencing the memory until the
+  // frames that carried it have been acknowledged, which it reports through
+  // on_acked_stream_data, and only then does the stream release it.
+  nghttp3_ssize ReadStreamData(Stream* stream,
+                               nghttp3_vec* vec,
+                               size_t veccnt,
+                               uint32_t* pflags) {
+    ngtcp2_vec data[kMaxVectorCount];
+    nghttp3_ssize result = 0;
+    auto next =
+        [&](int status, const ngtcp2_vec* vecs, size_t count, bob::Done done) {
+          if (status < 0) {
+            result = NGHTTP3_ERR_CALLBACK_FAILURE;
+            return;
+          }
+          switch (status) {
+            case bob::Status::STATUS_BLOCK:
+              // Fall through
+            case bob::Status::STATUS_WAIT:
+              // The stream is resumed once there is more data.
+              result = NGHTTP3_ERR_WOULDBLOCK;
+              return;
+            case bob::Status::STATUS_EOS:
+              *pflags |= NGHTTP3_DATA_FLAG_EOF;
+          }
+
+          size_t length = 0;
+          for (size_t n = 0; n < count; n++) {
+            vec[n] = {vecs[n].base, vecs[n].len};
+            length += vecs[n].len;
+          }
+          result = static_cast<nghttp3_ssize>(count);
+          // nghttp3 keeps track of what it has sent itself, so the data is
+          // committed as soon as it has been handed over.
+          stream->Commit(length);
+        };
+
+    stream->Pull(std::move(next),
+                 bob::Options::OPTIONS_SYNC,
+                 data,
+                 std::min(veccnt, arraysize(data)),
+                 kMaxVectorCount);
+    return result;
+  }
+
   bool StreamCommit(StreamData* data, size_t datalen) override {
     Debug(&session(),
           "HTTP/3 application committing stream %" PRIi64 " data %zu",
@@ -480,7 +526,8 @@ class Http3Application final : public Session::Application {
 
   void OnReceiveHeader(Stream* stream, Http3Header&& header) {
     if (stream->is_destroyed()) return;
-    if (header.name() == ":status") {
+    // The token avoids copying the name of every header to look for this.
+    if (header.token() == NGHTTP3_QPACK_TOKEN__STATUS) {
       if (header.value()[0] == '1') {
         Debug(
             &session(),
@@ -626,7 +673,10 @@ class Http3Application final : public Session::Application {
                                              uint32_t* pflags,
                                              void* conn_user_data,
                                              void* stream_user_data) {
-    return 0;
+    NGHTTP3_CALLBACK_SCOPE(app);
+    auto stream = From(stream_id, stream_user_data);
+    if (stream == nullptr) return NGHTTP3_ERR_CALLBACK_FAILURE;
+    return app->ReadStreamData(stream, vec, veccnt, pflags);
   }
 
   static int on_acked_stream_data(nghttp3_conn* conn,
@@ -637,7 +687,8 @@ class Http3Application final : public Session::Application {
     NGHTTP3_CALLBACK_SCOPE(app);
     auto stream = From(stream_id, stream_user_data);
     if (stream == nullptr) return NGHTTP3_ERR_CALLBACK_FAILURE;
-    app->AcknowledgeStreamData(stream, static_cast<size_t>(datalen));
+    // This is the body data that ReadStreamData() handed out.
+    stream->Acknowledge(static_cast<size_t>(datalen));
     return NGTCP2_SUCCESS;
   }
 
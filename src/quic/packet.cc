@@ -28,6 +28,9 @@ namespace {
 static constexpr size_t kRandlen = NGTCP2_MIN_STATELESS_RESET_RANDLEN * 5;
 static constexpr size_t kMinStatelessResetLen = 41;
 static constexpr size_t kMaxFreeList = 100;
+// Packets on the freelist keep their storage if it is no larger than this,
+// which bounds the memory held by the freelist to a few hundred kilobytes.
+static constexpr size_t kMaxRetainedPacketLength = 4096;
 }  // namespace
 
 std::string PathDescriptor::ToString() const {
@@ -49,7 +52,7 @@ struct Packet::Data final : public MemoryRetainer {
   // The diagnostic_label_ is used only as a debugging tool when
   // logging debug information about the packet. It identifies
   // the purpose of the packet.
-  const std::string diagnostic_label_;
+  std::string diagnostic_label_;
 
   void MemoryInfo(MemoryTracker* tracker) const override {
     tracker->TrackFieldWithSize("data", data_.length());
@@ -62,6 +65,18 @@ struct Packet::Data final : public MemoryRetainer {
     data_.AllocateSufficientStorage(length);
   }
 
+  // Prepares retained storage for reuse by a packet from the freelist.
+  void Reset(size_t length, std::string_view diagnostic_label) {
+    diagnostic_label_ = diagnostic_label;
+    if (length <= data_.capacity()) {
+      data_.SetLength(length);
+    } else {
+      data_.AllocateSufficientStorage(length);
+    }
+  }
+
+  size_t capacity() const { return data_.capacity(); }
+
   size_t length() const { return data_.length(); }
   operator uv_buf_t() {
     return uv_buf_init(reinterpret_cast<char*>(data_.out()), data_.length());
@@ -127,10 +142,14 @@ Packet* Packet::Create(Environment* env,
         env, listener, obj, destination, length, diagnostic_label);
   }
 
-  return FromFreeList(env,
-                      std::make_shared<Data>(length, diagnostic_label),
-                      listener,
-                      destination);
+  // Reuse the storage that the packet kept when it was freelisted, if any.
+  Packet* packet = FromFreeList(env, nullptr, listener, destination);
+  if (packet->data_) {
+    packet->data_->Reset(length, diagnostic_label);
+  } else {
+    packet->data_ = std::make_shared<Data>(length, diagnostic_label);
+  }
+  return packet;
 }
 
 Packet* Packet::Clone() const {
@@ -161,7 +180,7 @@ Packet* Packet::FromFreeList(Environment* env,
   CHECK_NOT_NULL(packet);
   CHECK_EQ(env, packet->env());
   Debug(packet, "Reusing packet from freelist");
-  packet->data_ = std::move(data);
+  if (data) packet->data_ = std::move(data);
   packet->destination_ = destination;
   packet->listener_ = listener;
   return packet;
@@ -205,7 +224,12 @@ void Packet::Done(int status) {
   if (binding.packet_freelist.size() < kMaxFreeList) {
     Debug(this, "Returning packet to freelist");
     listener_ = nullptr;
-    data_.reset();
+    // Keep our storage around for the next packet unless a clone still
+    // shares it or it is unusually large.
+    if (data_ && (data_.use_count() > 1 ||
+                  data_->capacity() > kMaxRetainedPacketLength)) {
+      data_.reset();
+    }
     Reset();
     binding.packet_freelist.push_back(this);
   } else {
@@ -41,7 +41,10 @@ struct PathDescriptor {
 // a Packet, we'll check to see if there is a free
 // packet in the freelist and use it instead of starting
 // fresh with a new packet. The freelist can store at
-// most kMaxFreeList packets
+// most kMaxFreeList packets. Freelisted packets keep
+// their storage (unless it is shared with a clone or
+// unusually large) so that reusing a packet does not
+// allocate either.
 //
 // Packets are always encrypted so their content should
 // be considered opaque to us. We leave it entirely up
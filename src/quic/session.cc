@@ -173,6 +173,10 @@ Session::SendPendingDataScope::SendPendingDataScope(
 Session::SendPendingDataScope::~SendPendingDataScope() {
   if (--session->send_scope_depth_ == 0 && session->can_send_packets()) {
     session->application().SendPendingData();
+    // When pacing held packets back, ngtcp2's expiry is when the next ones
+    // may go out. Without arming the timer for it here, they would wait for
+    // the next packet from the peer, and then leave as a single burst.
+    if (!session->is_destroyed()) session->UpdateTimer();
   }
 }
 
@@ -67,10 +67,20 @@ class Session final : public AsyncWrap, private SessionTicket::AppData::Source {
     uint64_t max_header_length = DEFAULT_MAX_HEADER_LENGTH;
 
     // HTTP/3 specific options.
+    // The largest header block that the peer may send, as advertised in the
+    // SETTINGS frame. If 0, it is derived from max_header_pairs and
+    // max_header_length, which are the limits that are actually enforced.
     uint64_t max_field_section_size = 0;
-    uint64_t qpack_max_dtable_capacity = 0;
-    uint64_t qpack_encoder_max_dtable_capacity = 0;
-    uint64_t qpack_blocked_streams = 0;
+    // The QPACK dynamic table capacity that the peer's encoder may use, and
+    // the number of streams that may wait on table updates at the same time.
+    // A dynamic table lets repeated headers, such as cookies and
+    // authorization headers, shrink to a single index after their first use.
+    uint64_t qpack_max_dtable_capacity = 4096;
+    uint64_t qpack_blocked_streams = 100;
+    // The upper bound for the capacity of our own encoder's dynamic table.
+    // The table that it actually uses is the lesser of this and the
+    // capacity that the peer advertises.
+    uint64_t qpack_encoder_max_dtable_capacity = 4096;
 
     bool enable_connect_protocol = true;
     bool enable_datagrams = true;
@@ -5,7 +5,10 @@
 #include <memory_tracker-inl.h>
 #include <ngtcp2/ngtcp2_crypto.h>
 #include <node_buffer.h>
+#include <node_checksum.h>
 #include <node_errors.h>
+#include <openssl/evp.h>
+#include <algorithm>
 
 namespace node {
 
@@ -171,6 +174,112 @@ SessionTicket::AppData::Status SessionTicket::AppData::Extract(SSL* ssl) {
   return Status::TICKET_IGNORE;
 }
 
+// ============================================================================
+// TicketKeyRing
+
+TicketKeyRing::TicketKeyRing(const TokenSecret& secret,
+                             uint64_t rotation_period)
+    : secret_(secret),
+      rotation_period_(std::max<uint64_t>(rotation_period, 1)) {}
+
+TicketKeyRing::~TicketKeyRing() {
+  memset(keys_, 0, sizeof(keys_));
+}
+
+void TicketKeyRing::Derive(uint64_t period, Key* key) const {
+  static constexpr uint8_t kInfo[] = "node quic session ticket key";
+  uint8_t salt[8];
+  for (size_t n = 0; n < sizeof(salt); n++) {
+    salt[n] = static_cast<uint8_t>(period >> (56 - n * 8));
+  }
+  uint8_t out[kNameLength + sizeof(key->aes) + sizeof(key->hmac)];
+  ngtcp2_crypto_md md;
+  ngtcp2_crypto_md_init(&md, const_cast<EVP_MD*>(EVP_sha256()));
+  CHECK_EQ(ngtcp2_crypto_hkdf(out,
+                              sizeof(out),
+                              &md,
+                              secret_,
+                              TokenSecret::QUIC_TOKENSECRET_LEN,
+                              salt,
+                              sizeof(salt),
+                              kInfo,
+                              sizeof(kInfo) - 1),
+           0);
+  key->period = period;
+  memcpy(key->name, out, kNameLength);
+  memcpy(key->aes, out + kNameLength, sizeof(key->aes));
+  memcpy(key->hmac, out + kNameLength + sizeof(key->aes), sizeof(key->hmac));
+  memset(out, 0, sizeof(out));
+}
+
+const TicketKeyRing::Key& TicketKeyRing::Current(uint64_t now) {
+  uint64_t period = now / rotation_period_;
+  if (!derived_ || keys_[0].period != period) {
+    if (period == 0) {
+      // The first period has no previous one, see Find().
+      memset(&keys_[1], 0, sizeof(keys_[1]));
+    } else if (derived_ && keys_[0].period == period - 1) {
+      keys_[1] = keys_[0];
+    } else {
+      Derive(period - 1, &keys_[1]);
+    }
+    Derive(period, &keys_[0]);
+    derived_ = true;
+  }
+  return keys_[0];
+}
+
+const TicketKeyRing::Key* TicketKeyRing::Find(const uint8_t* name,
+                                              uint64_t now,
+                                              bool* renew) {
+  const Key& current = Current(now);
+  const size_t count = current.period > 0 ? arraysize(keys_) : 1;
+  for (size_t n = 0; n < count; n++) {
+    if (CRYPTO_memcmp(name, keys_[n].name, kNameLength) == 0) {
+      *renew = n > 0;
+      return &keys_[n];
+    }
+  }
+  return nullptr;
+}
+
+// ============================================================================
+// BloomReplayFilter
+
+BloomReplayFilter::BloomReplayFilter(uint64_t window, size_t bits)
+    : window_(std::max<uint64_t>(window, 1)),
+      mask_(bits - 1),
+      current_(bits / 64),
+      previous_(bits / 64) {
+  CHECK_GE(bits, 64);
+  CHECK_EQ(bits & mask_, 0);
+}
+
+bool BloomReplayFilter::Insert(const uint8_t* id, size_t len, uint64_t now) {
+  uint64_t period = now / window_;
+  if (period != period_) {
+    if (period == period_ + 1) {
+      std::swap(current_, previous_);
+    } else {
+      std::fill(previous_.begin(), previous_.end(), 0);
+    }
+    std::fill(current_.begin(), current_.end(), 0);
+    period_ = period;
+  }
+
+  // The id is a secret, so the peer cannot pick ids that collide on purpose.
+  uint64_t a = checksum::XXHash64(0, id, len);
+  uint64_t b = checksum::XXHash64(a, id, len) | 1;
+  bool seen = true;
+  for (int n = 0; n < kHashCount; n++) {
+    size_t bit = (a + n * b) & mask_;
+    uint64_t word = uint64_t{1} << (bit % 64);
+    seen = seen && ((current_[bit / 64] | previous_[bit / 64]) & word) != 0;
+    current_[bit / 64] |= word;
+  }
+  return !seen;
+}
+
 }  // namespace quic
 }  // namespace node
 
@@ -8,8 +8,11 @@
 #include <memory_tracker.h>
 #include <uv.h>
 #include <v8.h>
+#include <memory>
+#include <vector>
 #include "data.h"
 #include "defs.h"
+#include "tokens.h"
 
 namespace node {
 namespace quic {
@@ -103,6 +106,85 @@ class SessionTicket::AppData final {
   SSL* ssl_;
 };
 
+// The keys a server encrypts its session tickets with. Rather than being
+// random, they are derived from a secret and the number of rotation periods
+// since the epoch, so that every server that is given the same secret issues
+// and accepts the same tickets at the same time, without sharing any other
+// state, and the keys rotate on their own. A ticket encrypted with the key of
+// the previous period is still accepted, but is renewed.
+class TicketKeyRing final {
+ public:
+  static constexpr size_t kNameLength = 16;
+
+  struct Key {
+    uint64_t period;
+    uint8_t name[kNameLength];
+    uint8_t aes[32];
+    uint8_t hmac[32];
+  };
+
+  TicketKeyRing(const TokenSecret& secret, uint64_t rotation_period);
+  ~TicketKeyRing();
+  DISALLOW_COPY_AND_MOVE(TicketKeyRing)
+
+  // The key to encrypt new tickets with at `now`, in seconds since the epoch.
+  const Key& Current(uint64_t now);
+
+  // The key named `name` if it is that of the current or the previous period
+  // at `now`, or nullptr. `renew` is set to true for the previous period.
+  // There is no previous period before the first one.
+  const Key* Find(const uint8_t* name, uint64_t now, bool* renew);
+
+ private:
+  void Derive(uint64_t period, Key* key) const;
+
+  TokenSecret secret_;
+  uint64_t rotation_period_;
+  // The keys of the current and the previous period.
+  Key keys_[2] = {};
+  bool derived_ = false;
+};
+
+// Decides whether the early (0-RTT) data that comes with a resumed session
+// can be accepted. As early data is not protected against replay by TLS, it
+// may only be accepted the first time a ticket is used. The default filter
+// only knows about the tickets used with this TLSContext, which is enough
+// when clients are routed back to the same server; a filter shared by the
+// servers of a fleet can be set with TLSContext::set_replay_filter().
+class ReplayFilter {
+ public:
+  virtual ~ReplayFilter() = default;
+
+  // Records that the ticket identified by `id` was used at `now`, in seconds
+  // since the epoch, and returns false if it may have been used before. The
+  // id is a secret that is unique to the ticket.
+  virtual bool Insert(const uint8_t* id, size_t len, uint64_t now) = 0;
+};
+
+// A ReplayFilter made of two bloom filters that each cover `window` seconds.
+// Once the newer one is full, in time, the older one is cleared and takes
+// its place, so a ticket is remembered for at least `window` seconds. A
+// false positive only costs the client a round trip, as the session is still
+// resumed without its early data.
+class BloomReplayFilter final : public ReplayFilter {
+ public:
+  static constexpr size_t kDefaultBits = 1 << 21;
+
+  // `bits` must be a power of two.
+  explicit BloomReplayFilter(uint64_t window, size_t bits = kDefaultBits);
+
+  bool Insert(const uint8_t* id, size_t len, uint64_t now) override;
+
+ private:
+  static constexpr int kHashCount = 4;
+
+  uint64_t window_;
+  uint64_t period_ = 0;
+  size_t mask_;
+  std::vector<uint64_t> current_;
+  std::vector<uint64_t> previous_;
+};
+
 }  // namespace quic
 }  // namespace node
 
@@ -338,7 +338,7 @@ class Stream::Outbound final : public MemoryRetainer {
     // otherwise, return whatever is in the uncommitted queue.
     if (eos_) {
       if (uncommitted_ > 0) {
-        PullUncommitted(std::move(next));
+        PullUncommitted(std::move(next), data, count);
         return bob::Status::STATUS_CONTINUE;
       }
       std::move(next)(bob::Status::STATUS_EOS, nullptr, 0, [](int) {});
@@ -350,7 +350,7 @@ class Stream::Outbound final : public MemoryRetainer {
     // uncommitted bytes currently in the queue rather than reading more from
     // the queue.
     if (uncommitted_ >= kDefaultMaxPacketLength) {
-      PullUncommitted(std::move(next));
+      PullUncommitted(std::move(next), data, count);
       return bob::Status::STATUS_CONTINUE;
     }
 
@@ -448,7 +448,7 @@ class Stream::Outbound final : public MemoryRetainer {
         // If the read returns eos, and there are uncommitted bytes in the
         // queue, we'll set eos_ to true and return the current set of
         // uncommitted bytes.
-        PullUncommitted(std::move(next));
+        PullUncommitted(std::move(next), data, count);
         return bob::STATUS_CONTINUE;
       }
       // If the read returns eos, and there are no uncommitted bytes in the
@@ -461,7 +461,7 @@ class Stream::Outbound final : public MemoryRetainer {
       // If the read returns blocked, and there are uncommitted bytes in the
       // queue, we'll return the current set of uncommitted bytes.
       if (uncommitted_ > 0) {
-        PullUncommitted(std::move(next));
+        PullUncommitted(std::move(next), data, count);
         return bob::Status::STATUS_CONTINUE;
       }
       // If the read returns blocked, and there are no uncommitted bytes in the
@@ -480,7 +480,7 @@ class Stream::Outbound final : public MemoryRetainer {
     }
 
     DCHECK_EQ(ret, bob::Status::STATUS_CONTINUE);
-    PullUncommitted(std::move(next));
+    PullUncommitted(std::move(next), data, count);
     return bob::Status::STATUS_CONTINUE;
   }
 
@@ -500,20 +500,25 @@ class Stream::Outbound final : public MemoryRetainer {
     ~OnComplete() { std::move(done)(0); }
   };
 
-  void PullUncommitted(bob::Next<ngtcp2_vec> next) {
-    MaybeStackBuffer<ngtcp2_vec, 16> chunks;
-    chunks.AllocateSufficientStorage(count_);
+  // Hands up to `count` of the uncommitted chunks to `next`, in the `data`
+  // provided by the caller. The vectors point straight into the memory that
+  // the DataQueue entries provided, which stays referenced by the chunks
+  // until the peer has acknowledged it, so none of it is ever copied.
+  void PullUncommitted(bob::Next<ngtcp2_vec> next,
+                       ngtcp2_vec* data,
+                       size_t count) {
+    DCHECK_NOT_NULL(data);
     auto head = commit_head_;
     size_t n = 0;
-    while (head != nullptr && n < count_) {
+    while (head != nullptr && n < count) {
       // There might only be one byte here but there should never be zero.
       DCHECK_LT(head->offset, head->buf.len);
-      chunks[n].base = head->buf.base + head->offset;
-      chunks[n].len = head->buf.len - head->offset;
+      data[n].base = head->buf.base + head->offset;
+      data[n].len = head->buf.len - head->offset;
       head = head->next.get();
       n++;
     }
-    std::move(next)(bob::Status::STATUS_CONTINUE, chunks.out(), n, [](int) {});
+    std::move(next)(bob::Status::STATUS_CONTINUE, data, n, [](int) {});
   }
 
   void MarkErrored() {
@@ -882,10 +887,9 @@ bool Stream::AddHeader(const Header& header) {
 void Stream::Acknowledge(size_t datalen) {
   if (is_destroyed() || outbound_ == nullptr) return;
 
-  // ngtcp2 guarantees that offset must always be greater than the previously
-  // received offset.
-  DCHECK_GE(datalen, STAT_GET(Stats, max_offset_ack));
-  STAT_SET(Stats, max_offset_ack, datalen);
+  // The data is acknowledged in order, so this is the amount since the
+  // previous acknowledgement rather than an offset.
+  STAT_INCREMENT_N(Stats, max_offset_ack, datalen);
 
   // // Consumes the given number of bytes in the buffer.
   outbound_->Acknowledge(datalen);
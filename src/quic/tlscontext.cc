@@ -34,15 +34,6 @@ namespace quic {
 // ============================================================================
 
 namespace {
-// TODO(@jasnell): One time initialization. ngtcp2 says this is optional but
-// highly recommended to deal with some perf regression. Unfortunately doing
-// this breaks some existing tests and we need to understand the potential
-// impact of calling this.
-// auto _ = []() {
-//   CHECK_EQ(ngtcp2_crypto_quictls_init(), 0);
-//   return 0;
-// }();
-
 void EnableTrace(Environment* env, crypto::BIOPointer* bio, SSL* ssl) {
 #if HAVE_SSL_TRACE
   static bool warn_trace_tls = true;
@@ -145,8 +136,51 @@ bool SetOption(Environment* env,
   }
   return true;
 }
+
+template <typename Opt, std::optional<TokenSecret> Opt::*member>
+bool SetOption(Environment* env,
+               Opt* options,
+               const v8::Local<v8::Object>& object,
+               const v8::Local<v8::String>& name) {
+  v8::Local<v8::Value> value;
+  if (!object->Get(env->context(), name).ToLocal(&value)) return false;
+  if (!value->IsUndefined()) {
+    if (!value->IsArrayBufferView()) {
+      Utf8Value nameStr(env->isolate(), name);
+      THROW_ERR_INVALID_ARG_VALUE(
+          env, "The %s option must be an ArrayBufferView", *nameStr);
+      return false;
+    }
+    Store store(value.As<v8::ArrayBufferView>());
+    if (store.length() != TokenSecret::QUIC_TOKENSECRET_LEN) {
+      Utf8Value nameStr(env->isolate(), name);
+      THROW_ERR_INVALID_ARG_VALUE(
+          env,
+          "The %s option must be an ArrayBufferView of length %d",
+          *nameStr,
+          TokenSecret::QUIC_TOKENSECRET_LEN);
+      return false;
+    }
+    ngtcp2_vec buf = store;
+    (options->*member).emplace(buf.base);
+  }
+  return true;
+}
 }  // namespace
 
+void TLSContext::InitializeCrypto() {
+  // This used to run from a static initializer, before OpenSSL had loaded
+  // its configuration and providers, which is why it was disabled. Doing it
+  // lazily, once the quic binding is loaded, picks up the configured
+  // providers (including FIPS) like every other fetch would.
+  static const bool initialized = ngtcp2_crypto_quictls_init() == 0;
+  if (!initialized) {
+    per_process::Debug(DebugCategory::QUIC,
+                       "ngtcp2_crypto_quictls_init() failed, falling back to "
+                       "implicit algorithm fetches\n");
+  }
+}
+
 std::shared_ptr<TLSContext> TLSContext::CreateClient(const Options& options) {
   return std::make_shared<TLSContext>(Side::CLIENT, options);
 }
@@ -234,6 +268,73 @@ int TLSContext::OnVerifyClientCertificate(int preverify_ok,
   return 1;
 }
 
+int TLSContext::OnTicketKey(SSL* ssl,
+                            unsigned char* name,
+                            unsigned char* iv,
+                            EVP_CIPHER_CTX* ectx,
+                            HMAC_CTX* hctx,
+                            int enc) {
+  auto& context = TLSSession::From(ssl).context();
+  uint64_t now = time(nullptr);
+
+  if (enc) {
+    const auto& key = context.ticket_keys_->Current(now);
+    memcpy(name, key.name, TicketKeyRing::kNameLength);
+    if (crypto::CSPRNG(iv, EVP_MAX_IV_LENGTH).is_err() ||
+        EVP_EncryptInit_ex(ectx, EVP_aes_256_cbc(), nullptr, key.aes, iv) <=
+            0 ||
+        HMAC_Init_ex(
+            hctx, key.hmac, sizeof(key.hmac), EVP_sha256(), nullptr) <= 0) {
+      return -1;
+    }
+    return 1;
+  }
+
+  bool renew = false;
+  const auto* key = context.ticket_keys_->Find(name, now, &renew);
+  if (key == nullptr) {
+    // The ticket is from before the previous rotation, or was issued by a
+    // server with a different secret. Discard it.
+    return 0;
+  }
+  if (EVP_DecryptInit_ex(ectx, EVP_aes_256_cbc(), nullptr, key->aes, iv) <=
+          0 ||
+      HMAC_Init_ex(
+          hctx, key->hmac, sizeof(key->hmac), EVP_sha256(), nullptr) <= 0) {
+    return -1;
+  }
+  return renew ? 2 : 1;
+}
+
+int TLSContext::OnAllowEarlyData(SSL* ssl, void* arg) {
+  auto context = static_cast<TLSContext*>(arg);
+  SSL_SESSION* sess = SSL_get_session(ssl);
+  if (sess == nullptr || !context->replay_filter_) return 0;
+
+  // The replay filter only remembers the tickets used within the lifetime,
+  // so the early data of older tickets could be a replay that it no longer
+  // knows about. Such sessions are still resumed, in 1-RTT.
+  uint64_t now = time(nullptr);
+  uint64_t issued = SSL_SESSION_get_time(sess);
+  if (issued > now || now - issued >= context->options_.ticket_lifetime) {
+    Debug(&TLSSession::From(ssl).session(),
+          "Rejecting early data of a ticket that is too old");
+    return 0;
+  }
+
+  // The resumption secret is unique to the ticket, and not known to anyone
+  // that has not got the ticket.
+  unsigned char secret[SSL_MAX_MASTER_KEY_LENGTH];
+  size_t len = SSL_SESSION_get_master_key(sess, secret, sizeof(secret));
+  bool fresh = len > 0 && context->replay_filter_->Insert(secret, len, now);
+  OPENSSL_cleanse(secret, sizeof(secret));
+  if (!fresh) {
+    Debug(&TLSSession::From(ssl).session(),
+          "Rejecting early data of a ticket that was used before");
+  }
+  return fresh ? 1 : 0;
+}
+
 std::unique_ptr<TLSSession> TLSContext::NewSession(
     Session* session, const std::optional<SessionTicket>& maybeSessionTicket) {
   // Passing a session ticket only makes sense with a client session.
@@ -273,6 +374,19 @@ crypto::SSLCtxPointer TLSContext::Initialize() {
                                              SessionTicket::DecryptedCallback,
                                              nullptr),
                1);
+
+      // OpenSSL's own anti-replay protection needs a session cache, which
+      // would defeat stateless tickets, so replays of early data are caught
+      // by the replay filter instead.
+      ticket_keys_ = std::make_unique<TicketKeyRing>(
+          options_.ticket_secret.has_value() ? *options_.ticket_secret
+                                             : TokenSecret(),
+          options_.ticket_lifetime);
+      replay_filter_ =
+          std::make_shared<BloomReplayFilter>(options_.ticket_lifetime);
+      SSL_CTX_set_timeout(ctx.get(), options_.ticket_lifetime);
+      SSL_CTX_set_tlsext_ticket_key_cb(ctx.get(), OnTicketKey);
+      SSL_CTX_set_allow_early_data_cb(ctx.get(), OnAllowEarlyData, this);
       break;
     }
     case Side::CLIENT: {
@@ -438,7 +552,7 @@ Maybe<TLSContext::Options> TLSContext::Options::From(Environment* env,
 
   if (!SET(verify_client) || !SET(enable_tls_trace) || !SET(alpn) ||
       !SET(sni) || !SET(ciphers) || !SET(groups) || !SET(verify_private_key) ||
-      !SET(keylog) ||
+      !SET(keylog) || !SET(ticket_secret) || !SET(ticket_lifetime) ||
       !SET_VECTOR(std::shared_ptr<crypto::KeyObjectData>, keys) ||
       !SET_VECTOR(Store, certs) || !SET_VECTOR(Store, ca) ||
       !SET_VECTOR(Store, crl)) {
@@ -468,6 +582,10 @@ std::string TLSContext::Options::ToString() const {
   res += prefix + "certs: " + std::to_string(certs.size());
   res += prefix + "ca: " + std::to_string(ca.size());
   res += prefix + "crl: " + std::to_string(crl.size());
+  res += prefix + "ticket secret: " +
+         (ticket_secret.has_value() ? std::string("shared")
+                                    : std::string("random"));
+  res += prefix + "ticket lifetime: " + std::to_string(ticket_lifetime);
   res += indent.Close();
   return res;
 }
@@ -111,6 +111,13 @@ class TLSContext final : public MemoryRetainer,
                                           "SHA256:TLS_AES_128_CCM_SHA256";
   static constexpr auto DEFAULT_GROUPS = "X25519:P-256:P-384:P-521";
 
+  // Fetches the ciphers, digests and the HKDF implementation that ngtcp2's
+  // crypto layer uses once per process. Without this, every token operation
+  // and packet protection key derivation goes through an OpenSSL 3 provider
+  // lookup, which dominates the cost of rejecting a flood of Initial packets.
+  // Must be called after OpenSSL itself has been initialized.
+  static void InitializeCrypto();
+
   struct Options final : public MemoryRetainer {
     // The SNI servername to use for this session. This option is only used by
     // the client.
@@ -161,6 +168,20 @@ class TLSContext final : public MemoryRetainer,
     // JavaScript option name "crl"
     std::vector<Store> crl;
 
+    // The secret the keys that session tickets are encrypted with are
+    // derived from. Servers that share it accept each other's tickets,
+    // including for 0-RTT. When not set, a random secret is used for every
+    // context. This option is only used by the server.
+    // JavaScript option name "ticketSecret"
+    std::optional<TokenSecret> ticket_secret;
+
+    // The number of seconds after which the session ticket keys rotate. A
+    // ticket can be used to resume a session for at least this long, and
+    // for 0-RTT only within this long of being issued. This option is only
+    // used by the server.
+    // JavaScript option name "ticketLifetime"
+    uint64_t ticket_lifetime = 7200;
+
     void MemoryInfo(MemoryTracker* tracker) const override;
     SET_MEMORY_INFO_NAME(TLSContext::Options)
     SET_SELF_SIZE(Options)
@@ -193,6 +214,13 @@ class TLSContext final : public MemoryRetainer,
     return validation_error_;
   }
 
+  // Replaces the filter that decides whether the early data of resumed
+  // sessions is accepted, for instance with one that is shared by the
+  // servers of a fleet. Only used by the server.
+  inline void set_replay_filter(std::shared_ptr<ReplayFilter> filter) {
+    replay_filter_ = std::move(filter);
+  }
+
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_MEMORY_INFO_NAME(TLSContext)
   SET_SELF_SIZE(TLSContext)
@@ -210,11 +238,21 @@ class TLSContext final : public MemoryRetainer,
                           unsigned int inlen,
                           void* arg);
   static int OnVerifyClientCertificate(int preverify_ok, X509_STORE_CTX* ctx);
+  static int OnTicketKey(SSL* ssl,
+                         unsigned char* name,
+                         unsigned char* iv,
+                         EVP_CIPHER_CTX* ectx,
+                         HMAC_CTX* hctx,
+                         int enc);
+  static int OnAllowEarlyData(SSL* ssl, void* arg);
 
   Side side_;
   Options options_;
   crypto::X509Pointer cert_;
   crypto::X509Pointer issuer_;
+  // Set up by Initialize(), so they have to come before ctx_.
+  std::unique_ptr<TicketKeyRing> ticket_keys_;
+  std::shared_ptr<ReplayFilter> replay_filter_;
   crypto::SSLCtxPointer ctx_;
   std::string validation_error_ = "";
 
@@ -27,6 +27,8 @@
 #include "string_bytes.h"
 #include "util-inl.h"
 
+#include <algorithm>
+#include <climits>
 #include <cstring>
 
 
@@ -35,6 +37,7 @@ namespace node {
 using v8::Array;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Int32;
@@ -49,47 +52,59 @@ using v8::Null;
 using v8::Number;
 using v8::Object;
 using v8::String;
+using v8::TryCatch;
+using v8::Undefined;
 using v8::Value;
 
-void SyncProcessOutputBuffer::OnAlloc(size_t suggested_size,
-                                      uv_buf_t* buf) const {
-  if (used() == kBufferSize)
-    *buf = uv_buf_init(nullptr, 0);
-  else
-    *buf = uv_buf_init(data_ + used(), available());
-}
-
-
-void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
-  // If we hand out the same chunk twice, this should catch it.
-  CHECK_EQ(buf->base, data_ + used());
-  used_ += static_cast<unsigned int>(nread);
+SyncProcessOutputBuffer::~SyncProcessOutputBuffer() {
+  free(data_);
 }
 
 
-size_t SyncProcessOutputBuffer::Copy(char* dest) const {
-  if (dest != nullptr) memcpy(dest, data_, used());
-  return used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::available() const {
-  return sizeof data_ - used();
-}
-
-
-unsigned int SyncProcessOutputBuffer::used() const {
-  return used_;
+void SyncProcessOutputBuffer::OnAlloc(size_t limit, uv_buf_t* buf) {
+  if (capacity_ - length_ < kMinReadSize) {
+    // Doubling keeps the number of copies logarithmic in the output size,
+    // and large blocks are usually moved by remapping their pages anyway.
+    size_t capacity = std::max(capacity_ * 2, length_ + kMinReadSize);
+    if (limit > 0) {
+      capacity = std::max(std::min(capacity, limit + kMinReadSize),
+                          length_ + kMinReadSize);
+    }
+    char* data = UncheckedRealloc(data_, capacity);
+    if (data == nullptr) {
+      // libuv reports UV_ENOBUFS for this.
+      *buf = uv_buf_init(nullptr, 0);
+      return;
+    }
+    data_ = data;
+    capacity_ = capacity;
+  }
+  // Use unsigned int because that's what `uv_buf_init` takes.
+  size_t available = std::min<size_t>(capacity_ - length_, UINT_MAX);
+  *buf = uv_buf_init(data_ + length_, static_cast<unsigned int>(available));
 }
 
 
-SyncProcessOutputBuffer* SyncProcessOutputBuffer::next() const {
-  return next_;
+void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
+  // If we hand out the same chunk twice, this should catch it.
+  CHECK_EQ(buf->base, data_ + length_);
+  CHECK_LE(nread, capacity_ - length_);
+  length_ += nread;
 }
 
 
-void SyncProcessOutputBuffer::set_next(SyncProcessOutputBuffer* next) {
-  next_ = next;
+MaybeLocal<Object> SyncProcessOutputBuffer::Release(Environment* env) {
+  if (length_ == 0) return Buffer::New(env, 0);
+  // Give the slack of the last doubling back. This does not copy if the
+  // block can be shrunk in place.
+  if (length_ < capacity_) {
+    if (char* data = UncheckedRealloc(data_, length_)) data_ = data;
+  }
+  char* data = data_;
+  size_t length = length_;
+  data_ = nullptr;
+  length_ = capacity_ = 0;
+  return Buffer::New(env, data, length);
 }
 
 
@@ -102,9 +117,6 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
       writable_(writable),
       input_buffer_(input_buffer),
 
-      first_output_buffer_(nullptr),
-      last_output_buffer_(nullptr),
-
       uv_pipe_(),
       write_req_(),
       shutdown_req_(),
@@ -116,14 +128,6 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
 
 SyncProcessStdioPipe::~SyncProcessStdioPipe() {
   CHECK(lifecycle_ == kUninitialized || lifecycle_ == kClosed);
-
-  SyncProcessOutputBuffer* buf;
-  SyncProcessOutputBuffer* next;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = next) {
-    next = buf->next();
-    delete buf;
-  }
 }
 
 
@@ -185,11 +189,8 @@ void SyncProcessStdioPipe::Close() {
 }
 
 
-Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) const {
-  size_t length = OutputLength();
-  Local<Object> js_buffer = Buffer::New(env, length).ToLocalChecked();
-  CopyOutput(Buffer::Data(js_buffer));
-  return js_buffer;
+MaybeLocal<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) {
+  return output_.Release(env);
 }
 
 
@@ -232,45 +233,16 @@ uv_handle_t* SyncProcessStdioPipe::uv_handle() const {
 }
 
 
-size_t SyncProcessStdioPipe::OutputLength() const {
-  SyncProcessOutputBuffer* buf;
-  size_t size = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    size += buf->used();
-
-  return size;
-}
-
-
-void SyncProcessStdioPipe::CopyOutput(char* dest) const {
-  SyncProcessOutputBuffer* buf;
-  size_t offset = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    offset += buf->Copy(dest + offset);
-}
-
-
 void SyncProcessStdioPipe::OnAlloc(size_t suggested_size, uv_buf_t* buf) {
   // This function assumes that libuv will never allocate two buffers for the
   // same stream at the same time. There's an assert in
   // SyncProcessOutputBuffer::OnRead that would fail if this assumption was
   // ever violated.
-
-  if (last_output_buffer_ == nullptr) {
-    // Allocate the first capture buffer.
-    first_output_buffer_ = new SyncProcessOutputBuffer();
-    last_output_buffer_ = first_output_buffer_;
-
-  } else if (last_output_buffer_->available() == 0) {
-    // The current capture buffer is full so get us a new one.
-    SyncProcessOutputBuffer* buf = new SyncProcessOutputBuffer();
-    last_output_buffer_->set_next(buf);
-    last_output_buffer_ = buf;
-  }
-
-  last_output_buffer_->OnAlloc(suggested_size, buf);
+  double max_buffer = process_handler_->max_buffer_;
+  size_t limit = 0;
+  if (max_buffer > 0 && max_buffer < static_cast<double>(SIZE_MAX / 2))
+    limit = static_cast<size_t>(max_buffer);
+  output_.OnAlloc(limit, buf);
 }
 
 
@@ -284,8 +256,12 @@ void SyncProcessStdioPipe::OnRead(const uv_buf_t* buf, ssize_t nread) {
     uv_read_stop(uv_stream());
 
   } else {
-    last_output_buffer_->OnRead(buf, nread);
+    output_.OnRead(buf, nread);
+    // Count the output first, so that nothing is passed on once the child
+    // has been killed for exceeding maxBuffer.
     process_handler_->IncrementBufferSizeAndCheckOverflow(nread);
+    if (process_handler_->StreamOutput(this, output_.data(), output_.length()))
+      output_.Clear();
   }
 }
 
@@ -445,7 +421,15 @@ MaybeLocal<Object> SyncProcessRunner::Run(Local<Value> options) {
   CloseHandlesAndDeleteLoop();
   if (r.IsNothing()) return MaybeLocal<Object>();
 
-  Local<Object> result = BuildResultObject();
+  Isolate* isolate = env()->isolate();
+  if (isolate->IsExecutionTerminating()) return MaybeLocal<Object>();
+  if (!on_output_exception_.IsEmpty()) {
+    isolate->ThrowException(on_output_exception_.Get(isolate));
+    return MaybeLocal<Object>();
+  }
+
+  Local<Object> result;
+  if (!BuildResultObject().ToLocal(&result)) return MaybeLocal<Object>();
 
   return scope.Escape(result);
 }
@@ -645,6 +629,36 @@ void SyncProcessRunner::IncrementBufferSizeAndCheckOverflow(ssize_t length) {
 }
 
 
+bool SyncProcessRunner::StreamOutput(SyncProcessStdioPipe* pipe,
+                                     const char* data,
+                                     size_t len) {
+  if (on_output_.IsEmpty() || killed_ || !env()->can_call_into_js())
+    return false;
+
+  uint32_t fd = 0;
+  while (stdio_pipes_[fd].get() != pipe) fd++;
+
+  Isolate* isolate = env()->isolate();
+  HandleScope scope(isolate);
+  TryCatch try_catch(isolate);
+  Local<Object> chunk;
+  if (Buffer::Copy(env(), data, len).ToLocal(&chunk)) {
+    Local<Value> argv[] = {Integer::NewFromUnsigned(isolate, fd), chunk};
+    USE(on_output_.Get(isolate)->Call(
+        env()->context(), Undefined(isolate), arraysize(argv), argv));
+  }
+  if (try_catch.HasCaught()) {
+    if (try_catch.HasTerminated())
+      try_catch.ReThrow();
+    else
+      on_output_exception_.Reset(isolate, try_catch.Exception());
+    Kill();
+  }
+  // The output was consumed, or is not wanted anymore.
+  return true;
+}
+
+
 void SyncProcessRunner::OnExit(int64_t exit_status, int term_signal) {
   if (exit_status < 0)
     return SetError(static_cast<int>(exit_status));
@@ -680,7 +694,7 @@ void SyncProcessRunner::SetPipeError(int pipe_error) {
 }
 
 
-Local<Object> SyncProcessRunner::BuildResultObject() {
+MaybeLocal<Object> SyncProcessRunner::BuildResultObject() {
   EscapableHandleScope scope(env()->isolate());
   Local<Context> context = env()->context();
 
@@ -716,10 +730,11 @@ Local<Object> SyncProcessRunner::BuildResultObject() {
     js_result->Set(context, env()->signal_string(),
                    Null(env()->isolate())).Check();
 
-  if (exit_status_ >= 0)
-    js_result->Set(context, env()->output_string(),
-                   BuildOutputArray()).Check();
-  else
+  if (exit_status_ >= 0) {
+    Local<Array> js_output;
+    if (!BuildOutputArray().ToLocal(&js_output)) return MaybeLocal<Object>();
+    js_result->Set(context, env()->output_string(), js_output).Check();
+  } else
     js_result->Set(context, env()->output_string(),
                    Null(env()->isolate())).Check();
 
@@ -730,7 +745,7 @@ Local<Object> SyncProcessRunner::BuildResultObject() {
 }
 
 
-Local<Array> SyncProcessRunner::BuildOutputArray() {
+MaybeLocal<Array> SyncProcessRunner::BuildOutputArray() {
   CHECK_GE(lifecycle_, kInitialized);
   CHECK(!stdio_pipes_.empty());
 
@@ -739,10 +754,14 @@ Local<Array> SyncProcessRunner::BuildOutputArray() {
 
   for (uint32_t i = 0; i < stdio_pipes_.size(); i++) {
     SyncProcessStdioPipe* h = stdio_pipes_[i].get();
-    if (h != nullptr && h->writable())
-      js_output[i] = h->GetOutputAsBuffer(env());
-    else
+    if (h != nullptr && h->writable()) {
+      Local<Object> js_buffer;
+      if (!h->GetOutputAsBuffer(env()).ToLocal(&js_buffer))
+        return MaybeLocal<Array>();
+      js_output[i] = js_buffer;
+    } else {
       js_output[i] = Null(env()->isolate());
+    }
   }
 
   return scope.Escape(
@@ -848,6 +867,13 @@ Maybe<int> SyncProcessRunner::ParseOptions(Local<Value> js_value) {
     max_buffer_ = js_max_buffer->NumberValue(context).FromJust();
   }
 
+  Local<Value> js_on_output =
+      js_options->Get(context, env()->on_output_string()).ToLocalChecked();
+  if (IsSet(js_on_output)) {
+    CHECK(js_on_output->IsFunction());
+    on_output_.Reset(isolate, js_on_output.As<Function>());
+  }
+
   Local<Value> js_kill_signal =
       js_options->Get(context, env()->kill_signal_string()).ToLocalChecked();
   if (IsSet(js_kill_signal)) {
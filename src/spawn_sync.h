@@ -36,29 +36,36 @@ class SyncProcessStdioPipe;
 class SyncProcessRunner;
 
 
+// The output of a pipe, in a single malloc()ed block that grows as needed
+// and that becomes the backing store of the Buffer without another copy.
 class SyncProcessOutputBuffer {
-  static const unsigned int kBufferSize = 65536;
-
  public:
+  // Every read gets at least this much room.
+  static const size_t kMinReadSize = 65536;
+
   inline SyncProcessOutputBuffer() = default;
+  inline ~SyncProcessOutputBuffer();
 
-  inline void OnAlloc(size_t suggested_size, uv_buf_t* buf) const;
-  inline void OnRead(const uv_buf_t* buf, size_t nread);
+  SyncProcessOutputBuffer(const SyncProcessOutputBuffer&) = delete;
+  SyncProcessOutputBuffer& operator=(const SyncProcessOutputBuffer&) = delete;
 
-  inline size_t Copy(char* dest) const;
+  // The block does not grow past `limit` bytes plus one read, if `limit`
+  // is not 0. Hands out an empty buffer if the block cannot grow.
+  inline void OnAlloc(size_t limit, uv_buf_t* buf);
+  inline void OnRead(const uv_buf_t* buf, size_t nread);
 
-  inline unsigned int available() const;
-  inline unsigned int used() const;
+  inline const char* data() const { return data_; }
+  inline size_t length() const { return length_; }
 
-  inline SyncProcessOutputBuffer* next() const;
-  inline void set_next(SyncProcessOutputBuffer* next);
+  // Makes the block the backing store of a new Buffer.
+  v8::MaybeLocal<v8::Object> Release(Environment* env);
+  // Forgets the content, but keeps the block for the next reads.
+  inline void Clear() { length_ = 0; }
 
  private:
-  // Use unsigned int because that's what `uv_buf_init` takes.
-  mutable char data_[kBufferSize];
-  unsigned int used_ = 0;
-
-  SyncProcessOutputBuffer* next_ = nullptr;
+  char* data_ = nullptr;
+  size_t length_ = 0;
+  size_t capacity_ = 0;
 };
 
 
@@ -82,7 +89,7 @@ class SyncProcessStdioPipe {
   int Start();
   void Close();
 
-  v8::Local<v8::Object> GetOutputAsBuffer(Environment* env) const;
+  v8::MaybeLocal<v8::Object> GetOutputAsBuffer(Environment* env);
 
   inline bool readable() const;
   inline bool writable() const;
@@ -93,9 +100,6 @@ class SyncProcessStdioPipe {
   inline uv_handle_t* uv_handle() const;
 
  private:
-  inline size_t OutputLength() const;
-  inline void CopyOutput(char* dest) const;
-
   inline void OnAlloc(size_t suggested_size, uv_buf_t* buf);
   inline void OnRead(const uv_buf_t* buf, ssize_t nread);
   inline void OnWriteDone(int result);
@@ -120,8 +124,7 @@ class SyncProcessStdioPipe {
   bool writable_;
   uv_buf_t input_buffer_;
 
-  SyncProcessOutputBuffer* first_output_buffer_;
-  SyncProcessOutputBuffer* last_output_buffer_;
+  SyncProcessOutputBuffer output_;
 
   mutable uv_pipe_t uv_pipe_;
   uv_write_t write_req_;
@@ -163,6 +166,9 @@ class SyncProcessRunner {
 
   void Kill();
   void IncrementBufferSizeAndCheckOverflow(ssize_t length);
+  // Passes new output to the onOutput callback, if there is one. Returns
+  // false if the output should be buffered instead.
+  bool StreamOutput(SyncProcessStdioPipe* pipe, const char* data, size_t len);
 
   void OnExit(int64_t exit_status, int term_signal);
   void OnKillTimerTimeout();
@@ -171,8 +177,8 @@ class SyncProcessRunner {
   void SetError(int error);
   void SetPipeError(int pipe_error);
 
-  v8::Local<v8::Object> BuildResultObject();
-  v8::Local<v8::Array> BuildOutputArray();
+  v8::MaybeLocal<v8::Object> BuildResultObject();
+  v8::MaybeLocal<v8::Array> BuildOutputArray();
 
   v8::Maybe<int> ParseOptions(v8::Local<v8::Value> js_value);
   int ParseStdioOptions(v8::Local<v8::Value> js_value);
@@ -198,6 +204,11 @@ class SyncProcessRunner {
   static void KillTimerCloseCallback(uv_handle_t* handle);
 
   double max_buffer_;
+  // With an onOutput callback, output is passed to it as it comes in rather
+  // than buffered. An exception that it throws kills the child and is
+  // rethrown once the child is gone.
+  v8::Global<v8::Function> on_output_;
+  v8::Global<v8::Value> on_output_exception_;
   uint64_t timeout_;
   int kill_signal_;
 
@@ -0,0 +1,91 @@
+#ifndef SRC_SPSC_RING_BUFFER_H_
+#define SRC_SPSC_RING_BUFFER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace node {
+
+// A bounded FIFO queue for exactly one producer thread and one consumer
+// thread. Push() and Pop() never block and never take a lock: each side only
+// writes its own index and keeps a cached copy of the other side's index, so
+// that the shared cache lines are only touched when the cached copy says the
+// queue is full or empty.
+// Either side may move to a different thread, as long as something else
+// (e.g. a mutex) orders the hand-over.
+template <typename T>
+class SPSCRingBuffer {
+ public:
+  // `capacity` is rounded up to the next power of two.
+  explicit SPSCRingBuffer(size_t capacity)
+      : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+        slots_(new T[mask_ + 1]) {}
+
+  SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+  SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+  // Producer side. Returns false, leaving `value` untouched, if the queue
+  // is full.
+  bool Push(T&& value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) return false;
+    }
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false if the queue is empty.
+  bool Pop(T* value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) return false;
+    }
+    *value = std::move(slots_[head & mask_]);
+    slots_[head & mask_] = T();
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // These may be called from either side. The result is only a snapshot.
+  bool IsEmpty() const { return Size() == 0; }
+  size_t Size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+  }
+
+  const size_t mask_;
+  const std::unique_ptr<T[]> slots_;
+
+  // Written by the consumer.
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0;
+
+  // Written by the producer.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_SPSC_RING_BUFFER_H_
@@ -18,6 +18,7 @@ namespace node {
 
 using v8::Array;
 using v8::ArrayBuffer;
+using v8::ArrayBufferView;
 using v8::BackingStore;
 using v8::ConstructorBehavior;
 using v8::Context;
@@ -148,6 +149,7 @@ template int StreamBase::WriteString<LATIN1>(
 
 
 int StreamBase::ReadStartJS(const FunctionCallbackInfo<Value>& args) {
+  if (read_into_listener_ != nullptr) return UV_EBUSY;
   return ReadStart();
 }
 
@@ -158,12 +160,25 @@ int StreamBase::ReadStopJS(const FunctionCallbackInfo<Value>& args) {
 
 int StreamBase::UseUserBuffer(const FunctionCallbackInfo<Value>& args) {
   CHECK(Buffer::HasInstance(args[0]));
+  if (read_into_listener_ != nullptr) return UV_EBUSY;
 
   uv_buf_t buf = uv_buf_init(Buffer::Data(args[0]), Buffer::Length(args[0]));
   PushStreamListener(new CustomBufferJSListener(buf));
   return 0;
 }
 
+int StreamBase::ReadInto(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsArrayBufferView());
+
+  if (read_into_listener_ == nullptr) {
+    // Some other listener, e.g. that of useUserBuffer(), owns the reads.
+    if (listener_ != &default_listener_) return UV_EBUSY;
+    read_into_listener_ = new ReadIntoJSListener();
+    PushStreamListener(read_into_listener_);
+  }
+  return read_into_listener_->ReadInto(args[0].As<ArrayBufferView>());
+}
+
 int StreamBase::Shutdown(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsObject());
   Local<Object> req_wrap_obj = args[0].As<Object>();
@@ -241,11 +256,22 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
     }
   }
 
+  // If the string chunks are small enough, flatten them on the stack and
+  // try writing everything synchronously. Only the part that could not be
+  // written is copied into a heap allocation afterwards, so the common case
+  // of a writable socket does not allocate at all. Buffer chunks are never
+  // copied.
+  char stack_storage[16384];  // 16kb
+  bool try_write = storage_size > 0 && HasDoTryWrite() &&
+                   storage_size <= sizeof(stack_storage);
+
   std::unique_ptr<BackingStore> bs;
-  if (storage_size > 0) {
+  if (storage_size > 0 && !try_write) {
     NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
     bs = ArrayBuffer::NewBackingStore(isolate, storage_size);
   }
+  char* storage =
+      try_write ? stack_storage : static_cast<char*>(bs ? bs->Data() : nullptr);
 
   offset = 0;
   if (!all_buffers) {
@@ -263,9 +289,8 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 
       // Write string
       CHECK_LE(offset, storage_size);
-      char* str_storage =
-          static_cast<char*>(bs ? bs->Data() : nullptr) + offset;
-      size_t str_size = (bs ? bs->ByteLength() : 0) - offset;
+      char* str_storage = storage + offset;
+      size_t str_size = storage_size - offset;
 
       Local<String> string;
       if (!chunk->ToString(context).ToLocal(&string))
@@ -285,9 +310,57 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
     }
   }
 
-  StreamWriteResult res = Write(*bufs, count, nullptr, req_wrap_obj);
+  uv_buf_t* pending_bufs = *bufs;
+  size_t synchronously_written = 0;
+
+  if (try_write) {
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < count; i++) total_bytes += bufs[i].len;
+
+    const int err = DoTryWrite(&pending_bufs, &count);
+    size_t pending_bytes = 0;
+    for (size_t i = 0; i < count; i++) pending_bytes += pending_bufs[i].len;
+    // Keep track of the bytes written here, because we're taking a shortcut
+    // by using `DoTryWrite()` directly instead of using the utilities
+    // provided by `Write()`.
+    synchronously_written = total_bytes - pending_bytes;
+    bytes_written_ += synchronously_written;
+
+    // Immediate failure or success
+    if (err != 0 || count == 0) {
+      SetWriteResult(StreamWriteResult { false, err, nullptr, total_bytes, {} });
+      return err;
+    }
+
+    // Partial write: move whatever is left of the string data off the stack.
+    size_t stack_bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (pending_bufs[i].base >= stack_storage &&
+          pending_bufs[i].base < stack_storage + sizeof(stack_storage)) {
+        stack_bytes += pending_bufs[i].len;
+      }
+    }
+    if (stack_bytes > 0) {
+      NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+      bs = ArrayBuffer::NewBackingStore(isolate, stack_bytes);
+      char* heap_storage = static_cast<char*>(bs->Data());
+      for (size_t i = 0; i < count; i++) {
+        if (pending_bufs[i].base < stack_storage ||
+            pending_bufs[i].base >= stack_storage + sizeof(stack_storage)) {
+          continue;
+        }
+        memcpy(heap_storage, pending_bufs[i].base, pending_bufs[i].len);
+        pending_bufs[i].base = heap_storage;
+        heap_storage += pending_bufs[i].len;
+      }
+    }
+  }
+
+  StreamWriteResult res =
+      Write(pending_bufs, count, nullptr, req_wrap_obj, try_write);
+  res.bytes += synchronously_written;
   SetWriteResult(res);
-  if (res.wrap != nullptr && storage_size > 0)
+  if (res.wrap != nullptr && bs)
     res.wrap->SetBackingStore(std::move(bs));
   return res.err;
 }
@@ -474,6 +547,7 @@ MaybeLocal<Value> StreamBase::CallJSOnreadMethod(ssize_t nread,
                             ->GetInternalField(StreamBase::kOnReadFunctionField)
                             .As<Value>();
   CHECK(onread->IsFunction());
+  BatchTaskQueuesScope batch_scope(wrap);
   return wrap->MakeCallback(onread.As<Function>(), arraysize(argv), argv);
 }
 
@@ -488,6 +562,16 @@ int StreamBase::GetFD() {
 }
 
 
+int StreamBase::GetDirectWriteFD() {
+  return -1;
+}
+
+
+bool StreamBase::SetDirectReadTarget(StreamBase* target) {
+  return target == nullptr;
+}
+
+
 Local<Object> StreamBase::GetObject() {
   return GetAsyncWrap()->object();
 }
@@ -568,6 +652,7 @@ void StreamBase::AddMethods(IsolateData* isolate_data,
   SetProtoMethod(isolate, t, "shutdown", JSMethod<&StreamBase::Shutdown>);
   SetProtoMethod(
       isolate, t, "useUserBuffer", JSMethod<&StreamBase::UseUserBuffer>);
+  SetProtoMethod(isolate, t, "readInto", JSMethod<&StreamBase::ReadInto>);
   SetProtoMethod(isolate, t, "writev", JSMethod<&StreamBase::Writev>);
   SetProtoMethod(isolate, t, "writeBuffer", JSMethod<&StreamBase::WriteBuffer>);
   SetProtoMethod(isolate,
@@ -608,6 +693,7 @@ void StreamBase::RegisterExternalReferences(
   registry->Register(JSMethod<&StreamBase::ReadStopJS>);
   registry->Register(JSMethod<&StreamBase::Shutdown>);
   registry->Register(JSMethod<&StreamBase::UseUserBuffer>);
+  registry->Register(JSMethod<&StreamBase::ReadInto>);
   registry->Register(JSMethod<&StreamBase::Writev>);
   registry->Register(JSMethod<&StreamBase::WriteBuffer>);
   registry->Register(JSMethod<&StreamBase::WriteString<ASCII>>);
@@ -686,7 +772,7 @@ void StreamResource::ClearError() {
 uv_buf_t EmitToJSStreamListener::OnStreamAlloc(size_t suggested_size) {
   CHECK_NOT_NULL(stream_);
   Environment* env = static_cast<StreamBase*>(stream_)->stream_env();
-  return env->allocate_managed_buffer(suggested_size);
+  return env->allocate_read_slab_buffer(&read_slab_, suggested_size);
 }
 
 void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf_) {
@@ -696,6 +782,20 @@ void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf_) {
   Isolate* isolate = env->isolate();
   HandleScope handle_scope(isolate);
   Context::Scope context_scope(env->context());
+
+  size_t slab_offset;
+  Local<ArrayBuffer> slab = env->release_read_slab_buffer(
+      &read_slab_, buf_, nread > 0 ? nread : 0, &slab_offset);
+  if (!slab.IsEmpty()) {
+    if (nread <= 0) {
+      if (nread < 0)
+        stream->CallJSOnreadMethod(nread, Local<ArrayBuffer>());
+      return;
+    }
+    stream->CallJSOnreadMethod(nread, slab, slab_offset);
+    return;
+  }
+
   std::unique_ptr<BackingStore> bs = env->release_managed_buffer(buf_);
 
   if (nread <= 0)  {
@@ -740,6 +840,10 @@ void CustomBufferJSListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
 
   CHECK_EQ(buf.base, buffer_.base);
 
+  // Nothing was read into the buffer, and JS land ignores empty reads.
+  if (nread == 0)
+    return;
+
   MaybeLocal<Value> ret = stream->CallJSOnreadMethod(nread,
                              Local<ArrayBuffer>(),
                              0,
@@ -752,6 +856,109 @@ void CustomBufferJSListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
 }
 
 
+// The memory of `view`, or nothing if its buffer has been detached. The
+// length is passed to JS as an int32.
+static uv_buf_t ViewMemory(Local<ArrayBufferView> view) {
+  size_t length = std::min<size_t>(view->ByteLength(), INT_MAX);
+  if (length == 0) return uv_buf_init(nullptr, 0);
+  char* data = static_cast<char*>(view->Buffer()->Data()) + view->ByteOffset();
+  return uv_buf_init(data, length);
+}
+
+
+int ReadIntoJSListener::ReadInto(Local<ArrayBufferView> view) {
+  CHECK_NOT_NULL(stream_);
+  CHECK(view_.IsEmpty());  // Only one read can be pending at a time.
+
+  uv_buf_t memory = ViewMemory(view);
+  if (memory.base == nullptr) return UV_EINVAL;
+
+  if (size_t copied = TakePendingData(memory.base, memory.len))
+    return static_cast<int>(copied);
+  if (pending_error_ != 0) return pending_error_;
+
+  view_.Reset(view->GetIsolate(), view);
+  int err = stream_->ReadStart();
+  if (err != 0) view_.Reset();
+  return err;
+}
+
+
+size_t ReadIntoJSListener::TakePendingData(char* data, size_t length) {
+  size_t count =
+      std::min(length, pending_data_.size() - pending_data_offset_);
+  if (count == 0) return 0;
+  memcpy(data, pending_data_.data() + pending_data_offset_, count);
+  pending_data_offset_ += count;
+  if (pending_data_offset_ == pending_data_.size()) {
+    pending_data_.clear();
+    pending_data_offset_ = 0;
+  }
+  return count;
+}
+
+
+uv_buf_t ReadIntoJSListener::OnStreamAlloc(size_t suggested_size) {
+  if (!view_.IsEmpty()) {
+    // No JS runs between this and the OnStreamRead() call for it, so the
+    // memory cannot go away while the stream writes to it.
+    StreamBase* stream = static_cast<StreamBase*>(stream_);
+    Isolate* isolate = stream->stream_env()->isolate();
+    HandleScope handle_scope(isolate);
+    buffer_ = ViewMemory(view_.Get(isolate));
+    if (buffer_.base != nullptr) return buffer_;
+  }
+
+  // Keep the data for the next read.
+  size_t start = pending_data_.size();
+  pending_data_.resize(start + suggested_size);
+  return uv_buf_init(pending_data_.data() + start, suggested_size);
+}
+
+
+void ReadIntoJSListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
+  CHECK_NOT_NULL(stream_);
+
+  const bool into_view = buf.base != nullptr && buf.base == buffer_.base;
+  buffer_ = uv_buf_init(nullptr, 0);
+  if (buf.base != nullptr && !into_view) {
+    // Trim the space that OnStreamAlloc() added to what was read into it.
+    size_t start = buf.base - pending_data_.data();
+    pending_data_.resize(start + std::max<ssize_t>(nread, 0));
+  }
+
+  if (nread == 0) return;
+
+  if (view_.IsEmpty()) {
+    // Nothing asked for this, so stop reading until the next ReadInto().
+    if (nread < 0) pending_error_ = static_cast<int>(nread);
+    stream_->ReadStop();
+    return;
+  }
+
+  StreamBase* stream = static_cast<StreamBase*>(stream_);
+  Environment* env = stream->stream_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  if (!into_view && nread > 0) {
+    // The buffer of the view was detached, e.g. by transferring it, so its
+    // read fails and the data goes to the next one.
+    uv_buf_t memory = ViewMemory(view_.Get(env->isolate()));
+    if (memory.base != nullptr)
+      nread = TakePendingData(memory.base, memory.len);
+    else
+      nread = UV_ECANCELED;
+  }
+
+  stream_->ReadStop();
+  view_.Reset();
+
+  stream->CallJSOnreadMethod(
+      nread, Local<ArrayBuffer>(), 0, StreamBase::SKIP_NREAD_CHECKS);
+}
+
+
 void ReportWritesToJSStreamListener::OnStreamAfterReqFinished(
     StreamReq* req_wrap, int status) {
   StreamBase* stream = static_cast<StreamBase*>(stream_);
@@ -775,8 +982,10 @@ void ReportWritesToJSStreamListener::OnStreamAfterReqFinished(
     stream->ClearError();
   }
 
-  if (req_wrap_obj->Has(env->context(), env->oncomplete_string()).FromJust())
+  if (req_wrap_obj->Has(env->context(), env->oncomplete_string()).FromJust()) {
+    BatchTaskQueuesScope batch_scope(async_wrap);
     async_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+  }
 }
 
 void ReportWritesToJSStreamListener::OnStreamAfterWrite(
@@ -10,6 +10,9 @@
 
 #include "v8.h"
 
+#include <memory>
+#include <vector>
+
 namespace node {
 
 // Forward declarations
@@ -198,6 +201,9 @@ class EmitToJSStreamListener : public ReportWritesToJSStreamListener {
  public:
   uv_buf_t OnStreamAlloc(size_t suggested_size) override;
   void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+
+ private:
+  Environment::ReadSlab read_slab_;
 };
 
 
@@ -216,6 +222,38 @@ class CustomBufferJSListener : public ReportWritesToJSStreamListener {
 };
 
 
+// A listener that reads straight into the views of BYOB read requests of a
+// ReadableStream byte source. Every ReadInto() call reads once into its
+// view, after which the stream stops reading until the next call. Data that
+// a stream delivers while no read is pending, which some streams do after
+// they have been stopped, is kept and copied into the next view, and so is
+// data for a view whose buffer was detached while the read was pending.
+class ReadIntoJSListener : public ReportWritesToJSStreamListener {
+ public:
+  uv_buf_t OnStreamAlloc(size_t suggested_size) override;
+  void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+  void OnStreamDestroy() override { delete this; }
+
+  // Returns the number of bytes copied into |view| right away, or 0 if the
+  // read is pending and its result is passed to `.onread()`, or a libuv
+  // error code, for example UV_EOF once the stream has ended.
+  int ReadInto(v8::Local<v8::ArrayBufferView> view);
+
+ private:
+  size_t TakePendingData(char* data, size_t length);
+
+  // The view of the pending read. The memory behind it is only looked up
+  // when the stream asks for it, as the buffer may have been transferred
+  // to another thread in the meantime.
+  v8::Global<v8::ArrayBufferView> view_;
+  // The memory of `view_` that the stream is reading into, if any.
+  uv_buf_t buffer_ = uv_buf_init(nullptr, 0);
+  std::vector<char> pending_data_;
+  size_t pending_data_offset_ = 0;
+  int pending_error_ = 0;
+};
+
+
 // A generic stream, comparable to JS land’s `Duplex` streams.
 // A stream is always controlled through one `StreamListener` instance.
 class StreamResource {
@@ -325,6 +363,22 @@ class StreamBase : public StreamResource {
   virtual bool IsIPCPipe();
   virtual int GetFD();
 
+  // Kernel-assisted piping, as used by StreamPipe. Only streams that pass the
+  // bytes of their file descriptor through unchanged may support it, which
+  // rules out e.g. TLS and JS streams.
+  //
+  // Returns a file descriptor that data may be written to directly, bypassing
+  // this stream, or -1 if there is none or if writes are queued.
+  virtual int GetDirectWriteFD();
+  // Makes this stream move what it reads to `target->GetDirectWriteFD()`
+  // itself, with sendfile() or splice(), and report that to its listener as
+  // reads of `nread` bytes with an empty buffer. Whenever `target` has no such
+  // descriptor, or cannot take the data right away, they are read into a
+  // buffer and reported as usual, so that the listener can write them through
+  // the regular path. nullptr switches back to normal reads. Returns false if
+  // this stream cannot read directly.
+  virtual bool SetDirectReadTarget(StreamBase* target);
+
   enum StreamBaseJSChecks { DONT_SKIP_NREAD_CHECKS, SKIP_NREAD_CHECKS };
 
   v8::MaybeLocal<v8::Value> CallJSOnreadMethod(
@@ -388,6 +442,7 @@ class StreamBase : public StreamResource {
   template <enum encoding enc>
   int WriteString(const v8::FunctionCallbackInfo<v8::Value>& args);
   int UseUserBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  int ReadInto(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void GetFD(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetExternal(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -411,6 +466,10 @@ class StreamBase : public StreamResource {
  private:
   Environment* env_;
   EmitToJSStreamListener default_listener_;
+  // Pushed by the first readInto() call, and owned by the stream. The stream
+  // then keeps reading through it, so readStart() and useUserBuffer() fail
+  // with UV_EBUSY from that point on.
+  ReadIntoJSListener* read_into_listener_ = nullptr;
 
   void SetWriteResult(const StreamWriteResult& res);
   static void AddAccessor(v8::Isolate* isolate,
@@ -53,8 +53,10 @@ void StreamPipe::Unpipe(bool is_in_deletion) {
   // Note that we possibly cannot use virtual methods on `source` and `sink`
   // here, because this function can be called from their destructors via
   // `OnStreamDestroy()`.
-  if (!source_destroyed_)
+  if (!source_destroyed_) {
     source()->ReadStop();
+    source()->SetDirectReadTarget(nullptr);
+  }
 
   is_closed_ = true;
   is_reading_ = false;
@@ -135,6 +137,13 @@ void StreamPipe::ReadableListener::OnStreamRead(ssize_t nread,
     return;
   }
 
+  if (buf_.base == nullptr) {
+    // The source has already moved the data to the sink by itself.
+    pipe->pending_writes_++;
+    pipe->writable_listener_.OnStreamAfterWrite(nullptr, 0);
+    return;
+  }
+
   pipe->ProcessData(nread, std::move(bs));
 }
 
@@ -286,6 +295,8 @@ void StreamPipe::Start(const FunctionCallbackInfo<Value>& args) {
   StreamPipe* pipe;
   ASSIGN_OR_RETURN_UNWRAP(&pipe, args.Holder());
   pipe->is_closed_ = false;
+  // Let the source use sendfile() or splice() where both ends allow it.
+  pipe->source()->SetDirectReadTarget(pipe->sink());
   pipe->writable_listener_.OnStreamWantsWrite(65536);
 }
 
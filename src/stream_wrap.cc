@@ -33,13 +33,21 @@
 #include "udp_wrap.h"
 #include "util-inl.h"
 
+#include <algorithm>
 #include <cstring>  // memcpy()
 #include <climits>  // INT_MAX
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 namespace node {
 
 using errors::TryCatchScope;
+using v8::Array;
 using v8::Context;
 using v8::DontDelete;
 using v8::EscapableHandleScope;
@@ -49,6 +57,7 @@ using v8::HandleScope;
 using v8::Isolate;
 using v8::JustVoid;
 using v8::Local;
+using v8::LocalVector;
 using v8::Maybe;
 using v8::MaybeLocal;
 using v8::Nothing;
@@ -199,6 +208,132 @@ bool LibuvStreamWrap::IsIPCPipe() {
   return is_named_pipe_ipc();
 }
 
+
+bool LibuvStreamWrap::IsDirectPipeable() const {
+#ifdef _WIN32
+  return false;
+#else
+  return stream() != nullptr &&
+         (is_tcp() || (is_named_pipe() && !is_named_pipe_ipc()));
+#endif
+}
+
+
+int LibuvStreamWrap::GetDirectWriteFD() {
+  if (!IsDirectPipeable() || !IsAlive() || IsClosing() ||
+      uv_stream_get_write_queue_size(stream()) != 0) {
+    return -1;
+  }
+  return GetFD();
+}
+
+
+// Reading directly needs splice(), which only Linux has.
+bool LibuvStreamWrap::SetDirectReadTarget(StreamBase* target) {
+  if (target == nullptr) {
+    direct_read_target_ = nullptr;
+    CloseSplicePipe();
+    return true;
+  }
+#ifdef __linux__
+  if (!IsDirectPipeable()) return false;
+  if (splice_pipe_[0] == -1 && pipe2(splice_pipe_, O_CLOEXEC | O_NONBLOCK)) {
+    splice_pipe_[0] = splice_pipe_[1] = -1;
+    return false;
+  }
+  direct_read_target_ = target;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+void LibuvStreamWrap::CloseSplicePipe() {
+#ifdef __linux__
+  if (splice_pipe_[0] == -1) return;
+  close(splice_pipe_[0]);
+  close(splice_pipe_[1]);
+  splice_pipe_[0] = splice_pipe_[1] = -1;
+#endif
+}
+
+
+void LibuvStreamWrap::OnClose() {
+  direct_read_target_ = nullptr;
+  CloseSplicePipe();
+}
+
+
+void LibuvStreamWrap::SpliceToTarget(int fd) {
+#ifdef __linux__
+  constexpr size_t kSpliceChunkSize = 65536;
+  constexpr unsigned int kFlags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+
+  ssize_t nread;
+  do {
+    nread = splice(GetFD(),
+                   nullptr,
+                   splice_pipe_[1],
+                   nullptr,
+                   kSpliceChunkSize,
+                   kFlags);
+  } while (nread == -1 && errno == EINTR);
+  if (nread == 0) return EmitRead(UV_EOF);
+  if (nread == -1) {
+    if (errno == EAGAIN) return;
+    return EmitRead(uv_translate_sys_error(errno));
+  }
+
+  size_t buffered = nread;
+  ssize_t nwritten;
+  do {
+    nwritten = splice(splice_pipe_[0],
+                      nullptr,
+                      fd,
+                      nullptr,
+                      buffered,
+                      kFlags);
+  } while (nwritten == -1 && errno == EINTR);
+  if (nwritten > 0) buffered -= nwritten;
+
+  // The target is full, or failed, which the listener will learn about
+  // when it writes the rest through the regular path. The data have already
+  // been taken from this stream, so they have to go somewhere either way.
+  // This happens before the listener hears of anything, because it may stop
+  // reading, which closes the pipe.
+  // Buffers that remain empty are handed back as reads of 0 bytes, so that
+  // the listener frees them.
+  std::vector<uv_buf_t> rest;
+  int err = 0;
+  while (buffered > 0) {
+    uv_buf_t buf = EmitAlloc(buffered);
+    if (buf.len == 0) {
+      err = UV_ENOBUFS;
+      rest.push_back(uv_buf_init(buf.base, 0));
+      break;
+    }
+    ssize_t n;
+    do {
+      n = read(splice_pipe_[0], buf.base, std::min(buf.len, buffered));
+    } while (n == -1 && errno == EINTR);
+    if (n <= 0) {
+      // An empty pipe, whether it says so with 0 or EAGAIN, has nothing
+      // left to deliver.
+      if (n == -1 && errno != EAGAIN) err = uv_translate_sys_error(errno);
+      rest.push_back(uv_buf_init(buf.base, 0));
+      break;
+    }
+    buffered -= n;
+    rest.push_back(uv_buf_init(buf.base, n));
+  }
+
+  if (nwritten > 0) EmitRead(nwritten, uv_buf_init(nullptr, 0));
+  for (const uv_buf_t& buf : rest) EmitRead(buf.len, buf);
+  if (err != 0) EmitRead(err);
+#endif
+}
+
 int LibuvStreamWrap::ReadStart() {
   return uv_read_start(
       stream(),
@@ -221,6 +356,14 @@ int LibuvStreamWrap::ReadStop() {
 
 
 void LibuvStreamWrap::OnUvAlloc(size_t suggested_size, uv_buf_t* buf) {
+  // An empty buffer makes libuv report readability as UV_ENOBUFS without
+  // reading anything, see OnUvRead().
+  if (direct_read_target_ != nullptr &&
+      direct_read_target_->GetDirectWriteFD() != -1) {
+    *buf = uv_buf_init(nullptr, 0);
+    return;
+  }
+
   HandleScope scope(env()->isolate());
   Context::Scope context_scope(env()->context());
 
@@ -265,32 +408,88 @@ Maybe<void> LibuvStreamWrap::OnUvRead(ssize_t nread, const uv_buf_t* buf) {
   // uv_close() on the handle.
   CHECK_EQ(persistent().IsEmpty(), false);
 
+  if (nread == UV_ENOBUFS && direct_read_target_ != nullptr) {
+    int fd = direct_read_target_->GetDirectWriteFD();
+    if (fd != -1) {
+      SpliceToTarget(fd);
+      return JustVoid();
+    }
+  }
+
+  LocalVector<Value> pending_handles(env()->isolate());
+  Local<Array> pending_array;
   if (nread > 0) {
-    MaybeLocal<Object> pending_obj;
-
-    if (type == UV_TCP) {
-      pending_obj = AcceptHandle<TCPWrap>(env(), this);
-    } else if (type == UV_NAMED_PIPE) {
-      pending_obj = AcceptHandle<PipeWrap>(env(), this);
-    } else if (type == UV_UDP) {
-      pending_obj = AcceptHandle<UDPWrap>(env(), this);
-    } else {
-      CHECK_EQ(type, UV_UNKNOWN_HANDLE);
+    // A message can carry several file descriptors, all of which libuv has
+    // queued by now. Accept them all, so that none of them is mistaken for
+    // one that came with a later message.
+    uv_pipe_t* pipe = reinterpret_cast<uv_pipe_t*>(stream());
+    while (type != UV_UNKNOWN_HANDLE) {
+      MaybeLocal<Object> pending_obj;
+      if (type == UV_TCP) {
+        pending_obj = AcceptHandle<TCPWrap>(env(), this);
+      } else if (type == UV_NAMED_PIPE) {
+        pending_obj = AcceptHandle<PipeWrap>(env(), this);
+      } else if (type == UV_UDP) {
+        pending_obj = AcceptHandle<UDPWrap>(env(), this);
+      } else {
+        UNREACHABLE();
+      }
+
+      Local<Object> local_pending_obj;
+      if (!pending_obj.ToLocal(&local_pending_obj)) return Nothing<void>();
+      pending_handles.push_back(local_pending_obj);
+      type = uv_pipe_pending_count(pipe) > 0 ? uv_pipe_pending_type(pipe)
+                                             : UV_UNKNOWN_HANDLE;
     }
 
-    Local<Object> local_pending_obj;
-    if (type != UV_UNKNOWN_HANDLE &&
-        (!pending_obj.ToLocal(&local_pending_obj) ||
-         object()
-             ->Set(env()->context(),
-                   env()->pending_handle_string(),
-                   local_pending_obj)
-             .IsNothing())) {
+    // The first one is where it always was, and the whole list is only set
+    // in the rare case that there is more than one.
+    if (!pending_handles.empty() &&
+        object()
+            ->Set(env()->context(),
+                  env()->pending_handle_string(),
+                  pending_handles[0])
+            .IsNothing()) {
       return Nothing<void>();
     }
+    if (pending_handles.size() > 1) {
+      pending_array = Array::New(
+          env()->isolate(), pending_handles.data(), pending_handles.size());
+      if (object()
+              ->Set(env()->context(),
+                    env()->pending_handles_string(),
+                    pending_array)
+              .IsNothing()) {
+        return Nothing<void>();
+      }
+    }
   }
 
   EmitRead(nread, *buf);
+
+  if (!pending_array.IsEmpty()) {
+    // onread() takes the list by clearing pendingHandles. If it did not,
+    // the list is not left for a later read to be mistaken for its own, and
+    // the handles other than pendingHandle are closed, as nothing else
+    // would ever close them.
+    Local<Value> current;
+    if (!object()
+             ->Get(env()->context(), env()->pending_handles_string())
+             .ToLocal(&current)) {
+      return Nothing<void>();
+    }
+    if (current == pending_array) {
+      for (size_t i = 1; i < pending_handles.size(); i++) {
+        HandleWrap* wrap = Unwrap<HandleWrap>(pending_handles[i].As<Object>());
+        if (wrap != nullptr) wrap->Close();
+      }
+      if (object()
+              ->Delete(env()->context(), env()->pending_handles_string())
+              .IsNothing()) {
+        return Nothing<void>();
+      }
+    }
+  }
   return JustVoid();
 }
 
@@ -44,6 +44,8 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   bool IsAlive() override;
   bool IsClosing() override;
   bool IsIPCPipe() override;
+  int GetDirectWriteFD() override;
+  bool SetDirectReadTarget(StreamBase* target) override;
 
   // JavaScript functions
   int ReadStart() override;
@@ -87,6 +89,7 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
                   AsyncWrap::ProviderType provider);
 
   AsyncWrap* GetAsyncWrap() override;
+  void OnClose() override;
 
   static v8::Local<v8::FunctionTemplate> GetConstructorTemplate(
       Environment* env);
@@ -111,8 +114,17 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   static void AfterUvWrite(uv_write_t* req, int status);
   static void AfterUvShutdown(uv_shutdown_t* req, int status);
 
+  // Whether this stream's descriptor can be used with sendfile()/splice().
+  bool IsDirectPipeable() const;
+  // Moves what is readable to `fd` through splice_pipe_.
+  void SpliceToTarget(int fd);
+  void CloseSplicePipe();
+
   uv_stream_t* const stream_;
 
+  StreamBase* direct_read_target_ = nullptr;
+  int splice_pipe_[2] = {-1, -1};
+
 #ifdef _WIN32
   // We don't always have an FD that we could look up on the stream_
   // object itself on Windows. However, for some cases, we open handles
@@ -33,6 +33,14 @@
 
 #include <algorithm>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NODE_HEX_X64 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define NODE_HEX_NEON 1
+#include <arm_neon.h>
+#endif
+
 // When creating strings >= this length v8's gc spins up and consumes
 // most of the execution time. For these cases it's more performant to
 // use external string resources.
@@ -150,6 +158,29 @@ typedef ExternString<String::ExternalStringResource,
                      uint16_t> ExternTwoByteString;
 
 
+// A one-byte string resource that keeps the storage of an ArrayBuffer alive
+// instead of owning a copy of the characters. The memory is already
+// accounted for by the ArrayBuffer, so it is not reported again.
+class SharedExternOneByteString
+    : public String::ExternalOneByteStringResource {
+ public:
+  SharedExternOneByteString(std::shared_ptr<v8::BackingStore> backing_store,
+                            const char* data,
+                            size_t length)
+      : backing_store_(std::move(backing_store)),
+        data_(data),
+        length_(length) {}
+
+  const char* data() const override { return data_; }
+  size_t length() const override { return length_; }
+
+ private:
+  std::shared_ptr<v8::BackingStore> backing_store_;
+  const char* data_;
+  size_t length_;
+};
+
+
 template <>
 MaybeLocal<Value> ExternOneByteString::NewExternal(
     Isolate* isolate, ExternOneByteString* h_str) {
@@ -198,6 +229,16 @@ MaybeLocal<Value> ExternTwoByteString::NewSimpleFromCopy(Isolate* isolate,
   return str.ToLocalChecked();
 }
 
+// Gives back the unused end of a buffer of `capacity` elements that is about
+// to become the storage of an external string of `length` elements. Shorter
+// strings are copied onto the V8 heap, so theirs is freed anyway.
+template <typename TypeName>
+TypeName* ShrinkForExternal(TypeName* data, size_t capacity, size_t length) {
+  if (length < EXTERN_APEX || length == capacity) return data;
+  TypeName* shrunk = node::UncheckedRealloc(data, length);
+  return shrunk != nullptr ? shrunk : data;
+}
+
 }  // anonymous namespace
 
 // supports regular and URL-safe base64
@@ -244,13 +285,195 @@ static inline unsigned unhex(uint8_t x) {
   return unhex_table[x];
 }
 
+// Vectorized hex kernels. Each one handles as many whole blocks as it can
+// and returns the number of input (encode) or output (decode) bytes it has
+// processed; the scalar loops take care of the rest. The decoders stop
+// before the first block with a non-hex character, so that the scalar loop
+// finds its exact position.
+#if NODE_HEX_X64
+
+static bool HasSsse3() {
+  static const bool result = __builtin_cpu_supports("ssse3");
+  return result;
+}
+
+static bool HasAvx2() {
+  static const bool result = __builtin_cpu_supports("avx2");
+  return result;
+}
+
+__attribute__((target("ssse3"))) static size_t hex_encode_ssse3(
+    const uint8_t* src, size_t slen, char* dst) {
+  const __m128i table = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                      '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= slen; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i high = _mm_shuffle_epi8(
+        table, _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+    __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(bytes, mask));
+    __m128i* out = reinterpret_cast<__m128i*>(dst + i * 2);
+    _mm_storeu_si128(out, _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(high, low));
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) static size_t hex_encode_avx2(
+    const uint8_t* src, size_t slen, char* dst) {
+  const __m256i table = _mm256_broadcastsi128_si256(
+      _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                    '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'));
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= slen; i += 32) {
+    __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    __m256i high = _mm256_shuffle_epi8(
+        table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(bytes, mask));
+    // The unpack instructions work within 128-bit lanes, so the halves
+    // have to be put back in order.
+    __m256i first = _mm256_unpacklo_epi8(high, low);
+    __m256i second = _mm256_unpackhi_epi8(high, low);
+    __m256i* out = reinterpret_cast<__m256i*>(dst + i * 2);
+    _mm256_storeu_si256(out, _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(out + 1,
+                        _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  return i;
+}
+
+// Maps 16 hex characters to their values and marks the other characters in
+// |invalid|. Only SSE2 is needed, which x86-64 always has.
+static inline __m128i hex_nibbles_sse2(__m128i chars, __m128i* invalid) {
+  __m128i is_digit =
+      _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                    _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+  __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+  __m128i is_alpha =
+      _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+  *invalid = _mm_or_si128(
+      *invalid,
+      _mm_andnot_si128(_mm_or_si128(is_digit, is_alpha), _mm_set1_epi8(-1)));
+  __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  __m128i alpha = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+  return _mm_or_si128(_mm_and_si128(is_digit, digit),
+                      _mm_and_si128(is_alpha, alpha));
+}
+
+// Combines pairs of nibbles into 8 bytes, one per 16-bit lane.
+static inline __m128i hex_combine_sse2(__m128i nibbles) {
+  __m128i high =
+      _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4);
+  return _mm_or_si128(high, _mm_srli_epi16(nibbles, 8));
+}
+
+static inline __m128i hex_load_16(const char* src) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+// Saturating the 16-bit values turns everything outside of Latin-1 into a
+// byte that is not a hex character.
+static inline __m128i hex_load_16(const uint16_t* src) {
+  return _mm_packus_epi16(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8)));
+}
+
+template <typename TypeName>
+static size_t hex_decode_vector(char* buf, size_t len, const TypeName* src) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i invalid = _mm_setzero_si128();
+    __m128i first = hex_nibbles_sse2(hex_load_16(src + i * 2), &invalid);
+    __m128i second = hex_nibbles_sse2(hex_load_16(src + i * 2 + 16), &invalid);
+    if (_mm_movemask_epi8(invalid) != 0) break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i),
+                     _mm_packus_epi16(hex_combine_sse2(first),
+                                      hex_combine_sse2(second)));
+  }
+  return i;
+}
+
+#elif NODE_HEX_NEON
+
+static size_t hex_encode_neon(const uint8_t* src, size_t slen, char* dst) {
+  static const uint8_t digits[] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                   '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+  const uint8x16_t table = vld1q_u8(digits);
+  const uint8x16_t mask = vdupq_n_u8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= slen; i += 16) {
+    uint8x16_t bytes = vld1q_u8(src + i);
+    uint8x16x2_t out;
+    out.val[0] = vqtbl1q_u8(table, vshrq_n_u8(bytes, 4));
+    out.val[1] = vqtbl1q_u8(table, vandq_u8(bytes, mask));
+    vst2q_u8(reinterpret_cast<uint8_t*>(dst + i * 2), out);
+  }
+  return i;
+}
+
+// Maps 16 hex characters to their values and clears the lanes of |valid|
+// that hold other characters.
+static inline uint8x16_t hex_nibbles_neon(uint8x16_t chars,
+                                          uint8x16_t* valid) {
+  uint8x16_t digit = vsubq_u8(chars, vdupq_n_u8('0'));
+  uint8x16_t is_digit = vcltq_u8(digit, vdupq_n_u8(10));
+  uint8x16_t alpha =
+      vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+  uint8x16_t is_alpha = vcltq_u8(alpha, vdupq_n_u8(6));
+  *valid = vandq_u8(*valid, vorrq_u8(is_digit, is_alpha));
+  return vbslq_u8(is_digit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+}
+
+// Loads 16 pairs of characters, split into the high and low digits.
+static inline uint8x16x2_t hex_load_pairs(const char* src) {
+  return vld2q_u8(reinterpret_cast<const uint8_t*>(src));
+}
+
+// Saturating the 16-bit values turns everything outside of Latin-1 into a
+// byte that is not a hex character.
+static inline uint8x16x2_t hex_load_pairs(const uint16_t* src) {
+  uint16x8x2_t first = vld2q_u16(src);
+  uint16x8x2_t second = vld2q_u16(src + 16);
+  uint8x16x2_t pairs;
+  pairs.val[0] =
+      vcombine_u8(vqmovn_u16(first.val[0]), vqmovn_u16(second.val[0]));
+  pairs.val[1] =
+      vcombine_u8(vqmovn_u16(first.val[1]), vqmovn_u16(second.val[1]));
+  return pairs;
+}
+
+template <typename TypeName>
+static size_t hex_decode_vector(char* buf, size_t len, const TypeName* src) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint8x16x2_t pairs = hex_load_pairs(src + i * 2);
+    uint8x16_t valid = vdupq_n_u8(0xff);
+    uint8x16_t high = hex_nibbles_neon(pairs.val[0], &valid);
+    uint8x16_t low = hex_nibbles_neon(pairs.val[1], &valid);
+    if (vminvq_u8(valid) == 0) break;
+    vst1q_u8(reinterpret_cast<uint8_t*>(buf + i),
+             vorrq_u8(vshlq_n_u8(high, 4), low));
+  }
+  return i;
+}
+
+#endif  // NODE_HEX_NEON
+
 template <typename TypeName>
 static size_t hex_decode(char* buf,
                          size_t len,
                          const TypeName* src,
                          const size_t srcLen) {
-  size_t i;
-  for (i = 0; i < len && i * 2 + 1 < srcLen; ++i) {
+  size_t i = 0;
+#if NODE_HEX_X64 || NODE_HEX_NEON
+  i = hex_decode_vector(buf, std::min(len, srcLen / 2), src);
+#endif
+  for (; i < len && i * 2 + 1 < srcLen; ++i) {
     unsigned a = unhex(static_cast<uint8_t>(src[i * 2 + 0]));
     unsigned b = unhex(static_cast<uint8_t>(src[i * 2 + 1]));
     if (!~a || !~b)
@@ -456,6 +679,15 @@ size_t StringBytes::Write(Isolate* isolate,
       if (str->IsExternalOneByte()) {
         auto ext = str->GetExternalOneByteStringResource();
         nbytes = hex_decode(buf, buflen, ext->data(), ext->length());
+      } else if (str->IsOneByte()) {
+        // Flatten into a one-byte copy, half the size of String::Value.
+        MaybeStackBuffer<char> value(str->Length());
+        str->WriteOneByte(isolate,
+                          reinterpret_cast<uint8_t*>(value.out()),
+                          0,
+                          -1,
+                          String::NO_NULL_TERMINATION);
+        nbytes = hex_decode(buf, buflen, value.out(), value.length());
       } else {
         String::Value value(isolate, str);
         nbytes = hex_decode(buf, buflen, *value, value.length());
@@ -630,7 +862,17 @@ size_t StringBytes::hex_encode(
         "not enough space provided for hex encode");
 
   dlen = slen * 2;
-  for (size_t i = 0, k = 0; k < dlen; i += 1, k += 2) {
+  size_t done = 0;
+#if NODE_HEX_X64
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+  if (HasAvx2()) done = hex_encode_avx2(bytes, slen, dst);
+  if (HasSsse3()) {
+    done += hex_encode_ssse3(bytes + done, slen - done, dst + done * 2);
+  }
+#elif NODE_HEX_NEON
+  done = hex_encode_neon(reinterpret_cast<const uint8_t*>(src), slen, dst);
+#endif
+  for (size_t i = done, k = done * 2; k < dlen; i += 1, k += 2) {
     static const char hex[] = "0123456789abcdef";
     uint8_t val = static_cast<uint8_t>(src[i]);
     dst[k + 0] = hex[val >> 4];
@@ -647,6 +889,33 @@ std::string StringBytes::hex_encode(const char* src, size_t slen) {
   return dst;
 }
 
+MaybeLocal<Value> StringBytes::EncodeShared(
+    Isolate* isolate,
+    std::shared_ptr<v8::BackingStore> backing_store,
+    const char* buf,
+    size_t buflen,
+    enum encoding encoding,
+    Local<Value>* error) {
+  // Below EXTERN_APEX a copy on the V8 heap is cheaper. Shared memory may be
+  // written to at any time, and ASCII output only matches the input if
+  // there are no bytes with the high bit set.
+  if (buflen < EXTERN_APEX || backing_store->IsShared() ||
+      (encoding != LATIN1 && encoding != ASCII) ||
+      (encoding == ASCII && !simdutf::validate_ascii(buf, buflen))) {
+    return Encode(isolate, buf, buflen, encoding, error);
+  }
+
+  auto* resource =
+      new SharedExternOneByteString(std::move(backing_store), buf, buflen);
+  Local<String> str;
+  if (!String::NewExternalOneByte(isolate, resource).ToLocal(&str)) {
+    delete resource;
+    *error = node::ERR_STRING_TOO_LONG(isolate);
+    return MaybeLocal<Value>();
+  }
+  return str;
+}
+
 #define CHECK_BUFLEN_IN_RANGE(len)                                    \
   do {                                                                \
     if ((len) > Buffer::kMaxLength) {                                 \
@@ -825,4 +1094,70 @@ MaybeLocal<Value> StringBytes::Encode(Isolate* isolate,
   return Encode(isolate, buf, len, encoding, error);
 }
 
+MaybeLocal<String> StringBytes::DecodeUtf8(Isolate* isolate,
+                                           const char* data,
+                                           size_t length) {
+  if (length == 0) return String::Empty(isolate);
+
+  Local<Value> error;
+  MaybeLocal<Value> result;
+  simdutf::result ascii = simdutf::validate_ascii_with_errors(data, length);
+  if (!ascii.error) {
+    result = ExternOneByteString::NewFromCopy(isolate, data, length, &error);
+  } else {
+    // Convert straight into the storage of the string. Only the part after
+    // the ASCII prefix needs converting, and nothing is copied again when
+    // the string becomes external.
+    char* latin1 = node::UncheckedMalloc(length);
+    if (latin1 == nullptr) {
+      isolate->ThrowException(ERR_MEMORY_ALLOCATION_FAILED(isolate));
+      return MaybeLocal<String>();
+    }
+    memcpy(latin1, data, ascii.count);
+    size_t latin1_length = simdutf::convert_utf8_to_latin1(
+        data + ascii.count, length - ascii.count, latin1 + ascii.count);
+    if (latin1_length > 0) {
+      latin1_length += ascii.count;
+      result = ExternOneByteString::New(
+          isolate, ShrinkForExternal(latin1, length, latin1_length),
+          latin1_length, &error);
+    } else {
+      free(latin1);
+      // A UTF-8 sequence has at least as many bytes as UTF-16 code units.
+      uint16_t* utf16 = node::UncheckedMalloc<uint16_t>(length);
+      if (utf16 == nullptr) {
+        isolate->ThrowException(ERR_MEMORY_ALLOCATION_FAILED(isolate));
+        return MaybeLocal<String>();
+      }
+      // This fails on invalid input.
+      size_t utf16_length = simdutf::convert_utf8_to_utf16(
+          data, length, reinterpret_cast<char16_t*>(utf16));
+      if (utf16_length > 0) {
+        result = ExternTwoByteString::New(
+            isolate, ShrinkForExternal(utf16, length, utf16_length),
+            utf16_length, &error);
+      } else {
+        free(utf16);
+        MaybeLocal<String> str;
+        if (length <= static_cast<size_t>(String::kMaxLength)) {
+          str = String::NewFromUtf8(
+              isolate, data, v8::NewStringType::kNormal, length);
+        }
+        if (str.IsEmpty()) {
+          isolate->ThrowException(ERR_STRING_TOO_LONG(isolate));
+        }
+        return str;
+      }
+    }
+  }
+
+  Local<Value> ret;
+  if (!result.ToLocal(&ret)) {
+    CHECK(!error.IsEmpty());
+    isolate->ThrowException(error);
+    return MaybeLocal<String>();
+  }
+  return ret.As<String>();
+}
+
 }  // namespace node
@@ -29,6 +29,7 @@
 #include "v8.h"
 #include "env-inl.h"
 
+#include <memory>
 #include <string>
 
 namespace node {
@@ -98,6 +99,26 @@ class StringBytes {
                                           enum encoding encoding,
                                           v8::Local<v8::Value>* error);
 
+  // Turns UTF-8 into a string in bulk, producing a one-byte string whenever
+  // all code points fit into Latin-1. Large ASCII and Latin-1 results become
+  // external strings. Invalid sequences are replaced with U+FFFD, as
+  // String::NewFromUtf8() does. Throws on failure.
+  static v8::MaybeLocal<v8::String> DecodeUtf8(v8::Isolate* isolate,
+                                               const char* data,
+                                               size_t length);
+
+  // Like Encode(), but large LATIN1 and pure ASCII results are external
+  // strings that point into |backing_store| rather than into a copy of it.
+  // Only for callers that can guarantee that the bytes are never modified
+  // again, because the string would change along with them.
+  static v8::MaybeLocal<v8::Value> EncodeShared(
+      v8::Isolate* isolate,
+      std::shared_ptr<v8::BackingStore> backing_store,
+      const char* buf,
+      size_t buflen,
+      enum encoding encoding,
+      v8::Local<v8::Value>* error);
+
   static size_t hex_encode(const char* src,
                            size_t slen,
                            char* dst,
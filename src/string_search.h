@@ -12,6 +12,17 @@
 #include <cstring>
 #include <algorithm>
 
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define NODE_STRING_SEARCH_SIMD_SSE2 1
+#define NODE_STRING_SEARCH_SIMD 1
+#elif defined(__aarch64__) && defined(__ARM_NEON) &&                          \
+    (defined(__GNUC__) || defined(__clang__))
+#include <arm_neon.h>
+#define NODE_STRING_SEARCH_SIMD_NEON 1
+#define NODE_STRING_SEARCH_SIMD 1
+#endif
+
 namespace node {
 namespace stringsearch {
 
@@ -285,6 +296,105 @@ inline size_t FindFirstCharacter(Vector<const uint8_t> pattern,
   return subject.forward() ? raw_pos : (subj_len - raw_pos - 1);
 }
 
+#ifdef NODE_STRING_SEARCH_SIMD
+// A minimal layer over 16-byte SSE2/NEON vectors. SimdMatchMask() turns the
+// result of a comparison into an integer with (1 << kMatchMaskShift) bits
+// per byte, first byte in the lowest bits.
+#if defined(NODE_STRING_SEARCH_SIMD_SSE2)
+typedef __m128i SimdBytes;
+constexpr int kMatchMaskShift = 0;
+
+inline SimdBytes SimdSplat(uint8_t byte) {
+  return _mm_set1_epi8(static_cast<char>(byte));
+}
+
+inline SimdBytes SimdLoad(const uint8_t* data) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+inline SimdBytes SimdEquals(SimdBytes a, SimdBytes b) {
+  return _mm_cmpeq_epi8(a, b);
+}
+
+inline SimdBytes SimdAnd(SimdBytes a, SimdBytes b) {
+  return _mm_and_si128(a, b);
+}
+
+inline SimdBytes SimdOr(SimdBytes a, SimdBytes b) {
+  return _mm_or_si128(a, b);
+}
+
+inline uint64_t SimdMatchMask(SimdBytes matches) {
+  return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+}
+#else
+typedef uint8x16_t SimdBytes;
+constexpr int kMatchMaskShift = 2;
+
+inline SimdBytes SimdSplat(uint8_t byte) { return vdupq_n_u8(byte); }
+
+inline SimdBytes SimdLoad(const uint8_t* data) { return vld1q_u8(data); }
+
+inline SimdBytes SimdEquals(SimdBytes a, SimdBytes b) {
+  return vceqq_u8(a, b);
+}
+
+inline SimdBytes SimdAnd(SimdBytes a, SimdBytes b) { return vandq_u8(a, b); }
+
+inline SimdBytes SimdOr(SimdBytes a, SimdBytes b) { return vorrq_u8(a, b); }
+
+// Narrowing each 16-bit lane by 4 leaves 4 bits per input byte.
+inline uint64_t SimdMatchMask(SimdBytes matches) {
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+}
+#endif
+
+inline size_t SimdFirstMatch(uint64_t mask) {
+  return static_cast<size_t>(__builtin_ctzll(mask)) >> kMatchMaskShift;
+}
+
+// Clears the bits of the lowest match in the mask.
+inline uint64_t SimdNextMatch(uint64_t mask) {
+  constexpr uint64_t kByteMask = (uint64_t{1} << (1 << kMatchMaskShift)) - 1;
+  return mask & ~(kByteMask << (SimdFirstMatch(mask) << kMatchMaskShift));
+}
+
+constexpr size_t kSimdBlockSize = 16;
+
+// Front-to-back search of a one-byte subject for a short pattern. Each step
+// checks 16 positions for both the first and the last byte of the pattern,
+// which rules out many more candidates than looking for the first byte
+// alone when that byte is common (a newline in log data, say). Returns the
+// position of the first match, or subject.length() after advancing `*index`
+// past every position that has been ruled out.
+inline size_t SimdLinearSearch(Vector<const uint8_t> pattern,
+                               Vector<const uint8_t> subject,
+                               size_t* index) {
+  const uint8_t* s = subject.start();
+  const uint8_t* p = pattern.start();
+  const size_t m = pattern.length();
+  const size_t n = subject.length();
+  const SimdBytes first = SimdSplat(p[0]);
+  const SimdBytes last = SimdSplat(p[m - 1]);
+
+  size_t i = *index;
+  for (; i + kSimdBlockSize + m - 1 <= n; i += kSimdBlockSize) {
+    uint64_t mask = SimdMatchMask(
+        SimdAnd(SimdEquals(SimdLoad(s + i), first),
+                SimdEquals(SimdLoad(s + i + m - 1), last)));
+    while (mask != 0) {
+      const size_t pos = i + SimdFirstMatch(mask);
+      if (memcmp(s + pos + 1, p + 1, m - 2) == 0)
+        return pos;
+      mask = SimdNextMatch(mask);
+    }
+  }
+  *index = i;
+  return n;
+}
+#endif  // NODE_STRING_SEARCH_SIMD
+
 //---------------------------------------------------------------------
 // Single Character Pattern Search Strategy
 //---------------------------------------------------------------------
@@ -308,6 +418,16 @@ size_t StringSearch<Char>::LinearSearch(
     size_t index) {
   CHECK_GT(pattern_.length(), 1);
   const size_t n = subject.length() - pattern_.length();
+#ifdef NODE_STRING_SEARCH_SIMD
+  if constexpr (sizeof(Char) == 1) {
+    if (subject.forward()) {
+      // Only the tail that does not fill a whole block is left afterwards.
+      const size_t pos = SimdLinearSearch(pattern_, subject, &index);
+      if (pos != subject.length())
+        return pos;
+    }
+  }
+#endif
   for (size_t i = index; i <= n; i++) {
     i = FindFirstCharacter(pattern_, subject, i);
     if (i == subject.length())
@@ -585,6 +705,97 @@ size_t SearchString(Vector<const Char> subject,
   StringSearch<Char> search(pattern);
   return search.Search(subject, start_index);
 }
+
+// Checks whether any of the patterns starts at subject[pos], returning the
+// index of the first one that does or `count` if none does.
+inline size_t MatchAnyAt(const uint8_t* subject,
+                         size_t subject_length,
+                         const uint8_t* const* patterns,
+                         const size_t* pattern_lengths,
+                         size_t count,
+                         size_t pos) {
+  for (size_t j = 0; j < count; j++) {
+    if (pattern_lengths[j] <= subject_length - pos &&
+        subject[pos] == patterns[j][0] &&
+        memcmp(subject + pos + 1, patterns[j] + 1, pattern_lengths[j] - 1) ==
+            0) {
+      return j;
+    }
+  }
+  return count;
+}
+
+// Searches a one-byte subject front to back for the first position at which
+// any of several non-empty patterns occurs. This is a single pass over the
+// subject: only positions holding the first byte of some pattern are looked
+// at more closely, and with SIMD support, up to kSimdMaxFirstBytes distinct
+// first bytes are checked 16 positions at a time. If several patterns match
+// at the same position, the one that comes first in the list wins.
+// Returns the position and sets `*which` to the pattern's index, or returns
+// subject_length if there is no match.
+inline size_t SearchAny(const uint8_t* subject,
+                        size_t subject_length,
+                        const uint8_t* const* patterns,
+                        const size_t* pattern_lengths,
+                        size_t count,
+                        size_t start_index,
+                        size_t* which) {
+  bool is_first_byte[256] = {};
+  uint8_t first_bytes[256];
+  size_t first_byte_count = 0;
+  for (size_t j = 0; j < count; j++) {
+    CHECK_GT(pattern_lengths[j], 0);
+    const uint8_t byte = patterns[j][0];
+    if (!is_first_byte[byte]) {
+      is_first_byte[byte] = true;
+      first_bytes[first_byte_count++] = byte;
+    }
+  }
+
+  size_t i = start_index;
+
+#ifdef NODE_STRING_SEARCH_SIMD
+  // Past this many distinct first bytes, the per-block comparisons cost
+  // more than the table lookup per position below.
+  constexpr size_t kSimdMaxFirstBytes = 8;
+  if (first_byte_count <= kSimdMaxFirstBytes) {
+    SimdBytes splats[kSimdMaxFirstBytes];
+    for (size_t k = 0; k < first_byte_count; k++)
+      splats[k] = SimdSplat(first_bytes[k]);
+
+    for (; i + kSimdBlockSize <= subject_length; i += kSimdBlockSize) {
+      const SimdBytes block = SimdLoad(subject + i);
+      SimdBytes matches = SimdEquals(block, splats[0]);
+      for (size_t k = 1; k < first_byte_count; k++)
+        matches = SimdOr(matches, SimdEquals(block, splats[k]));
+
+      uint64_t mask = SimdMatchMask(matches);
+      while (mask != 0) {
+        const size_t pos = i + SimdFirstMatch(mask);
+        const size_t j = MatchAnyAt(
+            subject, subject_length, patterns, pattern_lengths, count, pos);
+        if (j != count) {
+          *which = j;
+          return pos;
+        }
+        mask = SimdNextMatch(mask);
+      }
+    }
+  }
+#endif
+
+  for (; i < subject_length; i++) {
+    if (!is_first_byte[subject[i]])
+      continue;
+    const size_t j = MatchAnyAt(
+        subject, subject_length, patterns, pattern_lengths, count, i);
+    if (j != count) {
+      *which = j;
+      return i;
+    }
+  }
+  return subject_length;
+}
 }  // namespace stringsearch
 }  // namespace node
 
@@ -28,21 +28,35 @@
 #include "node_buffer.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_sockaddr-inl.h"
 #include "stream_base-inl.h"
 #include "stream_wrap.h"
 #include "util-inl.h"
 
+#include <algorithm>
 #include <cstdlib>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
 
 namespace node {
 
+using v8::Array;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Int32;
 using v8::Integer;
 using v8::Isolate;
@@ -93,6 +107,7 @@ void TCPWrap::Initialize(Local<Object> target,
   SetProtoMethod(isolate, t, "connect", Connect);
   SetProtoMethod(isolate, t, "bind6", Bind6);
   SetProtoMethod(isolate, t, "connect6", Connect6);
+  SetProtoMethod(isolate, t, "connectMulti", ConnectMulti);
   SetProtoMethod(isolate,
                  t,
                  "getsockname",
@@ -103,6 +118,12 @@ void TCPWrap::Initialize(Local<Object> target,
                  GetSockOrPeerName<TCPWrap, uv_tcp_getpeername>);
   SetProtoMethod(isolate, t, "setNoDelay", SetNoDelay);
   SetProtoMethod(isolate, t, "setKeepAlive", SetKeepAlive);
+  SetProtoMethod(isolate, t, "setFastOpen", SetFastOpen);
+  SetProtoMethod(isolate, t, "setFastOpenConnect", SetFastOpenConnect);
+  SetProtoMethod(isolate, t, "setQuickAck", SetQuickAck);
+  SetProtoMethod(isolate, t, "setBusyPoll", SetBusyPoll);
+  SetProtoMethod(isolate, t, "setIncomingCpu", SetIncomingCpu);
+  SetProtoMethodNoSideEffect(isolate, t, "getIncomingCpu", GetIncomingCpu);
   SetProtoMethod(isolate, t, "reset", Reset);
 
 #ifdef _WIN32
@@ -123,6 +144,7 @@ void TCPWrap::Initialize(Local<Object> target,
   NODE_DEFINE_CONSTANT(constants, SOCKET);
   NODE_DEFINE_CONSTANT(constants, SERVER);
   NODE_DEFINE_CONSTANT(constants, UV_TCP_IPV6ONLY);
+  NODE_DEFINE_CONSTANT(constants, REUSE_PORT);
   target->Set(context,
               env->constants_string(),
               constants).Check();
@@ -136,11 +158,18 @@ void TCPWrap::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Connect);
   registry->Register(Bind6);
   registry->Register(Connect6);
+  registry->Register(ConnectMulti);
 
   registry->Register(GetSockOrPeerName<TCPWrap, uv_tcp_getsockname>);
   registry->Register(GetSockOrPeerName<TCPWrap, uv_tcp_getpeername>);
   registry->Register(SetNoDelay);
   registry->Register(SetKeepAlive);
+  registry->Register(SetFastOpen);
+  registry->Register(SetFastOpenConnect);
+  registry->Register(SetQuickAck);
+  registry->Register(SetBusyPoll);
+  registry->Register(SetIncomingCpu);
+  registry->Register(GetIncomingCpu);
   registry->Register(Reset);
 #ifdef _WIN32
   registry->Register(SetSimultaneousAccepts);
@@ -207,6 +236,186 @@ void TCPWrap::SetKeepAlive(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+int TCPWrap::SetIntOption(int level, int name, int value) {
+#ifdef __linux__
+  uv_os_fd_t fd;
+  int err = uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd);
+  if (err != 0) return err;
+  if (setsockopt(fd, level, name, &value, sizeof(value)) != 0)
+    return uv_translate_sys_error(errno);
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+// Must be called after bind() and before listen(). `args[0]` is the length
+// of the queue of pending TFO requests.
+void TCPWrap::SetFastOpen(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+#ifdef TCP_FASTOPEN
+  int err = wrap->SetIntOption(IPPROTO_TCP,
+                               TCP_FASTOPEN,
+                               args[0].As<Uint32>()->Value());
+#else
+  int err = UV_ENOTSUP;
+#endif
+  args.GetReturnValue().Set(err);
+}
+
+
+// With TCP_FASTOPEN_CONNECT, connect() completes right away and the SYN
+// goes out together with the first write.
+void TCPWrap::SetFastOpenConnect(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+#ifdef TCP_FASTOPEN_CONNECT
+  bool enable = args[0]->IsTrue();
+  int err = 0;
+  uv_os_fd_t fd;
+  // A socket only exists before connect() if the handle was bound.
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd) == 0) {
+    err = wrap->SetIntOption(IPPROTO_TCP, TCP_FASTOPEN_CONNECT, enable);
+  }
+  if (err == 0) wrap->fast_open_connect_ = enable;
+#else
+  int err = UV_ENOTSUP;
+#endif
+  args.GetReturnValue().Set(err);
+}
+
+
+int TCPWrap::PrepareFastOpenConnect(int family) {
+#ifdef TCP_FASTOPEN_CONNECT
+  uv_os_fd_t fd;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) == 0)
+    return 0;
+  int sock = socket(family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock == -1) return uv_translate_sys_error(errno);
+  int on = 1;
+  int err = 0;
+  if (setsockopt(sock, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &on, sizeof(on)))
+    err = uv_translate_sys_error(errno);
+  if (err == 0) err = uv_tcp_open(&handle_, sock);
+  if (err != 0) close(sock);
+  return err;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+int TCPWrap::PrepareReusePort(int family) {
+#ifdef SO_REUSEPORT
+  int on = 1;
+  uv_os_fd_t fd;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) == 0)
+    return SetIntOption(SOL_SOCKET, SO_REUSEPORT, on);
+  int sock = socket(family, SOCK_STREAM, 0);
+  if (sock == -1) return uv_translate_sys_error(errno);
+  int err = 0;
+  if (fcntl(sock, F_SETFD, FD_CLOEXEC) != 0 ||
+      setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+    err = uv_translate_sys_error(errno);
+  }
+  if (err == 0) err = uv_tcp_open(&handle_, sock);
+  if (err != 0) close(sock);
+  return err;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+
+// The kernel drops out of quick ACK mode on its own, so this has to be
+// repeated whenever it matters, e.g. after every read.
+void TCPWrap::SetQuickAck(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+#ifdef TCP_QUICKACK
+  int err = wrap->SetIntOption(IPPROTO_TCP, TCP_QUICKACK, args[0]->IsTrue());
+#else
+  int err = UV_ENOTSUP;
+#endif
+  args.GetReturnValue().Set(err);
+}
+
+
+// `args[0]` is the time in microseconds to busy poll the device queue for
+// when there is no data to read.
+void TCPWrap::SetBusyPoll(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+#ifdef SO_BUSY_POLL
+  int err = wrap->SetIntOption(SOL_SOCKET,
+                               SO_BUSY_POLL,
+                               args[0].As<Uint32>()->Value());
+#else
+  int err = UV_ENOTSUP;
+#endif
+  args.GetReturnValue().Set(err);
+}
+
+
+// On a listening socket in a SO_REUSEPORT group, this makes the kernel hand
+// connections that arrive on `args[0]` to this socket, so that a worker that
+// is pinned to a NIC queue's CPU accepts the connections from that queue.
+void TCPWrap::SetIncomingCpu(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+#ifdef SO_INCOMING_CPU
+  int err = wrap->SetIntOption(SOL_SOCKET,
+                               SO_INCOMING_CPU,
+                               args[0].As<Uint32>()->Value());
+#else
+  int err = UV_ENOTSUP;
+#endif
+  args.GetReturnValue().Set(err);
+}
+
+
+// Returns the CPU that processes the packets of an accepted socket, or a
+// negative error code. The primary of a cluster can use it to send the
+// socket to the worker that runs on that CPU.
+void TCPWrap::GetIncomingCpu(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+#ifdef SO_INCOMING_CPU
+  uv_os_fd_t fd;
+  int result =
+      uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (result == 0) {
+    int cpu;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == 0)
+      result = cpu;
+    else
+      result = uv_translate_sys_error(errno);
+  }
+#else
+  int result = UV_ENOTSUP;
+#endif
+  args.GetReturnValue().Set(result);
+}
+
+
 #ifdef _WIN32
 void TCPWrap::SetSimultaneousAccepts(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap;
@@ -251,7 +460,7 @@ void TCPWrap::Bind(
   int port;
   unsigned int flags = 0;
   if (!args[1]->Int32Value(env->context()).To(&port)) return;
-  if (family == AF_INET6 &&
+  if (!args[2]->IsUndefined() &&
       !args[2]->Uint32Value(env->context()).To(&flags)) {
     return;
   }
@@ -259,10 +468,11 @@ void TCPWrap::Bind(
   T addr;
   int err = uv_ip_addr(*ip_address, port, &addr);
 
+  if (err == 0 && (flags & REUSE_PORT)) err = wrap->PrepareReusePort(family);
   if (err == 0) {
     err = uv_tcp_bind(&wrap->handle_,
                       reinterpret_cast<const sockaddr*>(&addr),
-                      flags);
+                      flags & ~REUSE_PORT);
   }
   args.GetReturnValue().Set(err);
 }
@@ -333,6 +543,11 @@ void TCPWrap::Connect(const FunctionCallbackInfo<Value>& args,
   T addr;
   int err = uv_ip_addr(*ip_address, &addr);
 
+  if (err == 0 && wrap->fast_open_connect_) {
+    err = wrap->PrepareFastOpenConnect(
+        reinterpret_cast<const sockaddr*>(&addr)->sa_family);
+  }
+
   if (err == 0) {
     AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(wrap);
     ConnectWrap* req_wrap =
@@ -358,6 +573,289 @@ void TCPWrap::Connect(const FunctionCallbackInfo<Value>& args,
 
   args.GetReturnValue().Set(err);
 }
+void TCPWrap::ConnectMulti(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args[0]->IsObject());  // req
+  CHECK(args[1]->IsArray());   // addresses
+  CHECK(args[2]->IsUint32());  // port
+  CHECK(args[3]->IsUint32());  // attemptDelay
+
+  Local<Array> list = args[1].As<Array>();
+  CHECK_GT(list->Length(), 0);
+  int port = static_cast<int>(args[2].As<Uint32>()->Value());
+  std::vector<sockaddr_storage> addresses(list->Length());
+  for (uint32_t i = 0; i < list->Length(); i++) {
+    Local<Value> value;
+    if (!list->Get(env->context(), i).ToLocal(&value)) return;
+    CHECK(value->IsString());
+    node::Utf8Value ip_address(env->isolate(), value);
+    int err = uv_ip6_addr(
+        *ip_address, port, reinterpret_cast<sockaddr_in6*>(&addresses[i]));
+    if (err != 0) {
+      err = uv_ip4_addr(
+          *ip_address, port, reinterpret_cast<sockaddr_in*>(&addresses[i]));
+    }
+    if (err != 0) return args.GetReturnValue().Set(err);
+  }
+
+  AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(wrap);
+  TCPConnectRace* race =
+      new TCPConnectRace(env,
+                         args[0].As<Object>(),
+                         wrap,
+                         std::move(addresses),
+                         args[3].As<Uint32>()->Value());
+  int err = race->Start();
+  if (err) {
+    delete race;
+  } else {
+    TRACE_EVENT_NESTABLE_ASYNC_BEGIN2(TRACING_CATEGORY_NODE2(net, native),
+                                      "connect",
+                                      race,
+                                      "addresses",
+                                      list->Length(),
+                                      "port",
+                                      port);
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+namespace {
+
+#ifdef _WIN32
+constexpr uv_os_sock_t kInvalidSocket = INVALID_SOCKET;
+#else
+constexpr uv_os_sock_t kInvalidSocket = -1;
+#endif
+
+int LastSocketError() {
+#ifdef _WIN32
+  return uv_translate_sys_error(WSAGetLastError());
+#else
+  return uv_translate_sys_error(errno);
+#endif
+}
+
+void CloseSocket(uv_os_sock_t sock) {
+#ifdef _WIN32
+  closesocket(sock);
+#else
+  close(sock);
+#endif
+}
+
+// Creates a non-blocking socket in `*sock` and starts connecting it.
+int StartConnect(const sockaddr* addr, uv_os_sock_t* sock) {
+  const socklen_t addrlen = addr->sa_family == AF_INET6
+                                ? sizeof(sockaddr_in6)
+                                : sizeof(sockaddr_in);
+#ifdef _WIN32
+  *sock = WSASocketW(addr->sa_family,
+                     SOCK_STREAM,
+                     IPPROTO_TCP,
+                     nullptr,
+                     0,
+                     WSA_FLAG_OVERLAPPED | WSA_FLAG_NO_HANDLE_INHERIT);
+  if (*sock == kInvalidSocket) return LastSocketError();
+  u_long on = 1;
+  if (ioctlsocket(*sock, FIONBIO, &on) == 0 &&
+      (connect(*sock, addr, addrlen) == 0 ||
+       WSAGetLastError() == WSAEWOULDBLOCK)) {
+    return 0;
+  }
+#else
+  *sock = socket(addr->sa_family, SOCK_STREAM, 0);
+  if (*sock == kInvalidSocket) return LastSocketError();
+  int flags = fcntl(*sock, F_GETFL);
+  if (fcntl(*sock, F_SETFD, FD_CLOEXEC) == 0 && flags != -1 &&
+      fcntl(*sock, F_SETFL, flags | O_NONBLOCK) == 0) {
+    int r;
+    do {
+      r = connect(*sock, addr, addrlen);
+    } while (r == -1 && errno == EINTR);
+    if (r == 0 || errno == EINPROGRESS) return 0;
+  }
+#endif
+  int err = LastSocketError();
+  CloseSocket(*sock);
+  *sock = kInvalidSocket;
+  return err;
+}
+
+int GetSocketError(uv_os_sock_t sock) {
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (getsockopt(sock,
+                 SOL_SOCKET,
+                 SO_ERROR,
+                 reinterpret_cast<char*>(&error),
+                 &len) != 0) {
+    return LastSocketError();
+  }
+  return error == 0 ? 0 : uv_translate_sys_error(error);
+}
+
+}  // anonymous namespace
+
+TCPConnectRace::TCPConnectRace(Environment* env,
+                               Local<Object> req_wrap_obj,
+                               TCPWrap* wrap,
+                               std::vector<sockaddr_storage>&& addresses,
+                               uint64_t attempt_delay)
+    : AsyncWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_TCPCONNECTWRAP),
+      wrap_(wrap),
+      addresses_(std::move(addresses)),
+      attempt_delay_(attempt_delay) {}
+
+TCPConnectRace::~TCPConnectRace() {
+  CloseAll();
+}
+
+void TCPConnectRace::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackField("wrap", wrap_);
+  tracker->TrackFieldWithSize(
+      "addresses", addresses_.size() * sizeof(sockaddr_storage));
+  tracker->TrackFieldWithSize("attempts", attempts_.size() * sizeof(Attempt));
+}
+
+int TCPConnectRace::Start() {
+  timer_ = new uv_timer_t();
+  timer_->data = this;
+  CHECK_EQ(uv_timer_init(env()->event_loop(), timer_), 0);
+  return StartNextAttempt();
+}
+
+int TCPConnectRace::StartNextAttempt() {
+  while (next_address_ < addresses_.size()) {
+    const size_t index = next_address_++;
+    uv_os_sock_t sock;
+    int err = StartConnect(
+        reinterpret_cast<const sockaddr*>(&addresses_[index]), &sock);
+    if (err == 0) {
+      Attempt* attempt = new Attempt{this, index, sock, {}};
+      err = uv_poll_init_socket(env()->event_loop(), &attempt->poll, sock);
+      if (err == 0) {
+        attempt->poll.data = attempt;
+        attempts_.push_back(attempt);
+        err = uv_poll_start(&attempt->poll, UV_WRITABLE, OnWritable);
+        if (err != 0) CloseAttempt(attempt);
+      } else {
+        CloseSocket(sock);
+        delete attempt;
+      }
+    }
+    if (err == 0) {
+      if (next_address_ < addresses_.size())
+        uv_timer_start(timer_, OnAttemptDelay, attempt_delay_, 0);
+      return 0;
+    }
+    last_error_ = err;
+  }
+  return last_error_;
+}
+
+void TCPConnectRace::CloseAttempt(Attempt* attempt) {
+  attempts_.erase(std::find(attempts_.begin(), attempts_.end(), attempt));
+  env()->CloseHandle(&attempt->poll, [](uv_poll_t* poll) {
+    Attempt* attempt = ContainerOf(&Attempt::poll, poll);
+    if (attempt->sock != kInvalidSocket) CloseSocket(attempt->sock);
+    delete attempt;
+  });
+}
+
+void TCPConnectRace::CloseAll() {
+  if (timer_ != nullptr) {
+    env()->CloseHandle(timer_, [](uv_timer_t* timer) { delete timer; });
+    timer_ = nullptr;
+  }
+  while (!attempts_.empty()) CloseAttempt(attempts_.back());
+}
+
+void TCPConnectRace::OnAttemptDelay(uv_timer_t* timer) {
+  TCPConnectRace* race = static_cast<TCPConnectRace*>(timer->data);
+  if (race->StartNextAttempt() != 0 && race->attempts_.empty())
+    race->Finish(race->last_error_, -1);
+}
+
+void TCPConnectRace::OnWritable(uv_poll_t* poll, int status, int events) {
+  Attempt* attempt = static_cast<Attempt*>(poll->data);
+  TCPConnectRace* race = attempt->race;
+  int err = status < 0 ? status : GetSocketError(attempt->sock);
+
+  if (err != 0) {
+    race->last_error_ = err;
+    race->CloseAttempt(attempt);
+    // A failed attempt does not have to wait for the delay to run out
+    // before the next one starts.
+    uv_timer_stop(race->timer_);
+    if (race->StartNextAttempt() != 0 && race->attempts_.empty())
+      race->Finish(race->last_error_, -1);
+    return;
+  }
+
+  // Take the socket away from the attempt, so that closing the attempt
+  // does not close it as well.
+  uv_os_sock_t sock = attempt->sock;
+  attempt->sock = kInvalidSocket;
+  const int index = static_cast<int>(attempt->index);
+  race->CloseAll();
+
+  TCPWrap* wrap = race->wrap_.get();
+  err = HandleWrap::IsAlive(wrap) ? uv_tcp_open(&wrap->handle_, sock)
+                                  : UV_ECANCELED;
+  if (err != 0) CloseSocket(sock);
+  race->Finish(err, err == 0 ? index : -1);
+}
+
+void TCPConnectRace::Finish(int status, int index) {
+  CHECK(!finished_);
+  finished_ = true;
+  CloseAll();
+
+  BaseObjectPtr<TCPConnectRace> strong_ref{this};
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  bool readable = false, writable = false;
+  if (status == 0) {
+    uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&wrap_->handle_);
+    readable = uv_is_readable(stream) != 0;
+    writable = uv_is_writable(stream) != 0;
+  }
+
+  // Same as ConnectionWrap::AfterConnect(), plus the index of the address
+  // that the connection was made to.
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), status),
+    wrap_->object(),
+    object(),
+    Boolean::New(env->isolate(), readable),
+    Boolean::New(env->isolate(), writable),
+    Integer::New(env->isolate(), index)
+  };
+
+  TRACE_EVENT_NESTABLE_ASYNC_END2(TRACING_CATEGORY_NODE2(net, native),
+                                  "connect",
+                                  this,
+                                  "status",
+                                  status,
+                                  "index",
+                                  index);
+
+  MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+
+  // Delete once strong_ref goes out of scope.
+  Detach();
+}
+
 void TCPWrap::Reset(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(
@@ -371,7 +869,7 @@ void TCPWrap::Reset(const FunctionCallbackInfo<Value>& args) {
 int TCPWrap::Reset(Local<Value> close_callback) {
   if (state_ != kInitialized) return 0;
 
-  int err = uv_tcp_close_reset(&handle_, OnClose);
+  int err = uv_tcp_close_reset(&handle_, HandleWrap::OnClose);
   state_ = kClosing;
   if (!err & !close_callback.IsEmpty() && close_callback->IsFunction() &&
       !persistent().IsEmpty()) {
@@ -387,55 +885,26 @@ MaybeLocal<Object> AddressToJS(Environment* env,
                                const sockaddr* addr,
                                Local<Object> info) {
   EscapableHandleScope scope(env->isolate());
-  char ip[INET6_ADDRSTRLEN + UV_IF_NAMESIZE];
-  const sockaddr_in* a4;
-  const sockaddr_in6* a6;
-
-  int port;
+  Local<String> address;
 
   if (info.IsEmpty())
     info = Object::New(env->isolate());
 
   switch (addr->sa_family) {
   case AF_INET6:
-    a6 = reinterpret_cast<const sockaddr_in6*>(addr);
-    uv_inet_ntop(AF_INET6, &a6->sin6_addr, ip, sizeof ip);
-    // Add an interface identifier to a link local address.
-    if (IN6_IS_ADDR_LINKLOCAL(&a6->sin6_addr) && a6->sin6_scope_id > 0) {
-      const size_t addrlen = strlen(ip);
-      CHECK_LT(addrlen, sizeof(ip));
-      ip[addrlen] = '%';
-      size_t scopeidlen = sizeof(ip) - addrlen - 1;
-      CHECK_GE(scopeidlen, UV_IF_NAMESIZE);
-      const int r = uv_if_indextoiid(a6->sin6_scope_id,
-                                     ip + addrlen + 1,
-                                     &scopeidlen);
-      if (r) {
-        env->ThrowUVException(r, "uv_if_indextoiid");
-        return {};
-      }
-    }
-    port = ntohs(a6->sin6_port);
-    info->Set(env->context(),
-              env->address_string(),
-              OneByteString(env->isolate(), ip)).Check();
-    info->Set(env->context(), env->family_string(), env->ipv6_string()).Check();
-    info->Set(env->context(),
-              env->port_string(),
-              Integer::New(env->isolate(), port)).Check();
-    break;
-
   case AF_INET:
-    a4 = reinterpret_cast<const sockaddr_in*>(addr);
-    uv_inet_ntop(AF_INET, &a4->sin_addr, ip, sizeof ip);
-    port = ntohs(a4->sin_port);
+    if (!env->address_string_cache()->Get(env, addr).ToLocal(&address)) {
+      return {};
+    }
+    info->Set(env->context(), env->address_string(), address).Check();
     info->Set(env->context(),
-              env->address_string(),
-              OneByteString(env->isolate(), ip)).Check();
-    info->Set(env->context(), env->family_string(), env->ipv4_string()).Check();
+              env->family_string(),
+              addr->sa_family == AF_INET6 ? env->ipv6_string()
+                                          : env->ipv4_string()).Check();
     info->Set(env->context(),
               env->port_string(),
-              Integer::New(env->isolate(), port)).Check();
+              Integer::New(env->isolate(), SocketAddress::GetPort(addr)))
+        .Check();
     break;
 
   default:
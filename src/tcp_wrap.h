@@ -27,6 +27,8 @@
 #include "async_wrap.h"
 #include "connection_wrap.h"
 
+#include <vector>
+
 namespace node {
 
 class ExternalReferenceRegistry;
@@ -39,6 +41,12 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
     SERVER
   };
 
+  // A flag for bind() and bind6() on top of libuv's. It sets SO_REUSEPORT,
+  // so that servers in several threads or processes can listen on the same
+  // port and the kernel balances the connections between them. Not
+  // supported on Windows.
+  static constexpr unsigned int REUSE_PORT = 1 << 16;
+
   static v8::MaybeLocal<v8::Object> Instantiate(Environment* env,
                                                 AsyncWrap* parent,
                                                 SocketType type);
@@ -67,6 +75,7 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
   template <typename T,
             int (*F)(const typename T::HandleType*, sockaddr*, int*)>
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
+  friend class TCPConnectRace;
 
   TCPWrap(Environment* env, v8::Local<v8::Object> object,
           ProviderType provider);
@@ -74,11 +83,20 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetNoDelay(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetKeepAlive(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // Linux-only latency options. They return UV_ENOTSUP elsewhere.
+  static void SetFastOpen(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetFastOpenConnect(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetQuickAck(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetBusyPoll(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetIncomingCpu(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetIncomingCpu(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Listen(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ConnectMulti(const v8::FunctionCallbackInfo<v8::Value>& args);
   template <typename T>
   static void Connect(const v8::FunctionCallbackInfo<v8::Value>& args,
       std::function<int(const char* ip_address, T* addr)> uv_ip_addr);
@@ -90,6 +108,15 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
       std::function<int(const char* ip_address, int port, T* addr)> uv_ip_addr);
   static void Reset(const v8::FunctionCallbackInfo<v8::Value>& args);
   int Reset(v8::Local<v8::Value> close_callback = v8::Local<v8::Value>());
+  int SetIntOption(int level, int name, int value);
+  // Creates the socket for a connect() to `family` with TCP_FASTOPEN_CONNECT
+  // enabled, unless the handle already has one.
+  int PrepareFastOpenConnect(int family);
+  // Creates the socket for a bind() to `family` with SO_REUSEPORT set, or
+  // sets it on the existing one.
+  int PrepareReusePort(int family);
+
+  bool fast_open_connect_ = false;
 
 #ifdef _WIN32
   static void SetSimultaneousAccepts(
@@ -97,6 +124,57 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
 #endif
 };
 
+// Connects a TCPWrap to the first of several addresses that accepts the
+// connection, in the manner of Happy Eyeballs (RFC 8305): the attempts are
+// started in order, each `attempt_delay` milliseconds after the previous one
+// or as soon as the previous one fails, and the remaining attempts are
+// cancelled once one of them succeeds.
+//
+// The attempts use plain non-blocking sockets that are watched with uv_poll_t
+// handles, and only the winning socket is handed to the TCPWrap, so that no
+// losing attempt ever reaches JS.
+class TCPConnectRace final : public AsyncWrap {
+ public:
+  TCPConnectRace(Environment* env,
+                 v8::Local<v8::Object> req_wrap_obj,
+                 TCPWrap* wrap,
+                 std::vector<sockaddr_storage>&& addresses,
+                 uint64_t attempt_delay);
+  ~TCPConnectRace() override;
+
+  // Returns an error if not even one attempt could be started.
+  int Start();
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(TCPConnectRace)
+  SET_SELF_SIZE(TCPConnectRace)
+
+ private:
+  struct Attempt {
+    TCPConnectRace* race;
+    size_t index;
+    uv_os_sock_t sock;
+    uv_poll_t poll;
+  };
+
+  // Starts attempts until one is in flight, or there are no more addresses.
+  int StartNextAttempt();
+  void CloseAttempt(Attempt* attempt);
+  void CloseAll();
+  void Finish(int status, int index);
+
+  static void OnAttemptDelay(uv_timer_t* timer);
+  static void OnWritable(uv_poll_t* poll, int status, int events);
+
+  BaseObjectPtr<TCPWrap> wrap_;
+  std::vector<sockaddr_storage> addresses_;
+  std::vector<Attempt*> attempts_;
+  uv_timer_t* timer_ = nullptr;
+  const uint64_t attempt_delay_;
+  size_t next_address_ = 0;
+  int last_error_ = 0;
+  bool finished_ = false;
+};
 
 }  // namespace node
 
@@ -24,16 +24,53 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include "env-inl.h"
 #include "node_internals.h"
 #include "tracing/trace_event.h"
 #include "util-inl.h"
 
+#include <algorithm>
+
 namespace node {
 
+size_t ThreadPoolWork::ConcurrencyLimit(ThreadPoolWorkKind kind) {
+  if (kind == ThreadPoolWorkKind::kCpu)
+    return per_process::cli_options->threadpool_cpu_limit;
+  return 0;
+}
+
+ThreadPoolWorkQueue* ThreadPoolWork::queue() const {
+  return pool_ != nullptr ? pool_ : env_->threadpool_work_queue(kind_);
+}
+
 void ThreadPoolWork::ScheduleWork() {
   env_->IncreaseWaitingRequestCounter();
   TRACE_EVENT_NESTABLE_ASYNC_BEGIN0(
       TRACING_CATEGORY_NODE2(threadpoolwork, async), type_, this);
+
+  ThreadPoolWorkQueue* queue = this->queue();
+  size_t limit = pool_ != nullptr ? pool_->limit : ConcurrencyLimit(kind_);
+  if (limit != 0 && queue->running >= limit) {
+    waiting_ = true;
+    queue->waiting.push_back(this);
+    queue->max_waiting = std::max(queue->max_waiting, queue->waiting.size());
+    return;
+  }
+  QueueWork();
+}
+
+void ThreadPoolWork::RunInline() {
+  env_->IncreaseWaitingRequestCounter();
+  TRACE_EVENT_NESTABLE_ASYNC_BEGIN0(
+      TRACING_CATEGORY_NODE2(threadpoolwork, async), type_, this);
+  TRACE_EVENT_BEGIN0(TRACING_CATEGORY_NODE2(threadpoolwork, sync), type_);
+  DoThreadPoolWork();
+  TRACE_EVENT_END0(TRACING_CATEGORY_NODE2(threadpoolwork, sync), type_);
+  env_->SetImmediate([this](Environment* env) { FinishWork(0); });
+}
+
+void ThreadPoolWork::QueueWork() {
+  queue()->running++;
   int status = uv_queue_work(
       env_->event_loop(),
       &work_req_,
@@ -47,19 +84,45 @@ void ThreadPoolWork::ScheduleWork() {
       },
       [](uv_work_t* req, int status) {
         ThreadPoolWork* self = ContainerOf(&ThreadPoolWork::work_req_, req);
-        self->env_->DecreaseWaitingRequestCounter();
-        TRACE_EVENT_NESTABLE_ASYNC_END1(
-            TRACING_CATEGORY_NODE2(threadpoolwork, async),
-            self->type_,
-            self,
-            "result",
-            status);
-        self->AfterThreadPoolWork(status);
+        // Start the next waiting work first, AfterThreadPoolWork() may
+        // delete |self|.
+        ThreadPoolWorkQueue* queue = self->queue();
+        queue->running--;
+        queue->completed++;
+        if (!queue->waiting.empty()) {
+          ThreadPoolWork* next = queue->waiting.front();
+          queue->waiting.pop_front();
+          next->waiting_ = false;
+          next->QueueWork();
+        }
+        self->FinishWork(status);
       });
   CHECK_EQ(status, 0);
 }
 
+void ThreadPoolWork::FinishWork(int status) {
+  env_->DecreaseWaitingRequestCounter();
+  TRACE_EVENT_NESTABLE_ASYNC_END1(
+      TRACING_CATEGORY_NODE2(threadpoolwork, async),
+      type_,
+      this,
+      "result",
+      status);
+  AfterThreadPoolWork(status);
+}
+
 int ThreadPoolWork::CancelWork() {
+  if (waiting_) {
+    // Work that never made it to the threadpool is canceled like libuv
+    // does it, by reporting UV_ECANCELED from a later loop iteration.
+    std::deque<ThreadPoolWork*>* waiting = &queue()->waiting;
+    waiting->erase(std::find(waiting->begin(), waiting->end(), this));
+    waiting_ = false;
+    env_->SetImmediate([this](Environment* env) {
+      FinishWork(UV_ECANCELED);
+    });
+    return 0;
+  }
   return uv_cancel(reinterpret_cast<uv_req_t*>(&work_req_));
 }
 
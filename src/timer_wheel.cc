@@ -0,0 +1,142 @@
+#include "timer_wheel.h"
+#include "util.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace node {
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now) {
+  std::fill(&slots_[0][0], &slots_[0][0] + kLevels * kSlots, kNone);
+}
+
+TimerWheel::Id TimerWheel::Insert(uint64_t expiry) {
+  Id id;
+  if (!free_ids_.empty()) {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  } else {
+    CHECK_LT(nodes_.size(), kNone);
+    id = static_cast<Id>(nodes_.size());
+    nodes_.emplace_back();
+  }
+  Node& node = nodes_[id];
+  node.expiry = std::max(expiry, now_ + 1);
+  node.active = true;
+  Link(id);
+  size_++;
+  return id;
+}
+
+bool TimerWheel::Reschedule(Id id, uint64_t expiry) {
+  if (!IsActive(id)) return false;
+  Unlink(id);
+  nodes_[id].expiry = std::max(expiry, now_ + 1);
+  Link(id);
+  return true;
+}
+
+bool TimerWheel::Cancel(Id id) {
+  if (!IsActive(id)) return false;
+  Unlink(id);
+  Free(id);
+  return true;
+}
+
+bool TimerWheel::IsActive(Id id) const {
+  return id < nodes_.size() && nodes_[id].active;
+}
+
+void TimerWheel::Link(Id id) {
+  Node& node = nodes_[id];
+  int level = 0;
+  uint64_t block = node.expiry;
+  // The slot of an entry must not be the one that the wheel is in at that
+  // level, or it would only be looked at after a full turn.
+  while (block - (now_ >> (level * kLevelBits)) >= kSlots) {
+    if (level == kLevels - 1) {
+      block = (now_ >> (level * kLevelBits)) + kSlots - 1;
+      break;
+    }
+    level++;
+    block = node.expiry >> (level * kLevelBits);
+  }
+  int slot = static_cast<int>(block & (kSlots - 1));
+
+  node.level = static_cast<uint8_t>(level);
+  node.slot = static_cast<uint8_t>(slot);
+  node.prev = kNone;
+  node.next = slots_[level][slot];
+  if (node.next != kNone) nodes_[node.next].prev = id;
+  slots_[level][slot] = id;
+  occupied_[level] |= uint64_t{1} << slot;
+}
+
+void TimerWheel::Unlink(Id id) {
+  Node& node = nodes_[id];
+  if (node.prev != kNone)
+    nodes_[node.prev].next = node.next;
+  else
+    slots_[node.level][node.slot] = node.next;
+  if (node.next != kNone) nodes_[node.next].prev = node.prev;
+  if (slots_[node.level][node.slot] == kNone)
+    occupied_[node.level] &= ~(uint64_t{1} << node.slot);
+}
+
+void TimerWheel::Free(Id id) {
+  nodes_[id].active = false;
+  free_ids_.push_back(id);
+  size_--;
+}
+
+uint64_t TimerWheel::NextTick() const {
+  uint64_t next = kNever;
+  for (int level = 0; level < kLevels; level++) {
+    if (occupied_[level] == 0) continue;
+    const int shift = level * kLevelBits;
+    const uint64_t current = now_ >> shift;
+    const int position = static_cast<int>(current & (kSlots - 1));
+    const int distance =
+        std::countr_zero(std::rotr(occupied_[level], position));
+    next = std::min(next, (current + distance) << shift);
+  }
+  return next;
+}
+
+void TimerWheel::Advance(uint64_t now, std::vector<Id>* expired) {
+  while (size_ > 0) {
+    const uint64_t next = NextTick();
+    if (next > now) break;
+    now_ = next;
+
+    // Move the entries whose slot starts at this tick down, starting at the
+    // highest level so that they can keep moving in the same step.
+    for (int level = kLevels - 1; level > 0; level--) {
+      const int shift = level * kLevelBits;
+      if ((now_ & ((uint64_t{1} << shift) - 1)) != 0) continue;
+      const int slot = static_cast<int>((now_ >> shift) & (kSlots - 1));
+      Id id = slots_[level][slot];
+      slots_[level][slot] = kNone;
+      occupied_[level] &= ~(uint64_t{1} << slot);
+      while (id != kNone) {
+        const Id next_id = nodes_[id].next;
+        Link(id);
+        id = next_id;
+      }
+    }
+
+    const int slot = static_cast<int>(now_ & (kSlots - 1));
+    Id id = slots_[0][slot];
+    slots_[0][slot] = kNone;
+    occupied_[0] &= ~(uint64_t{1} << slot);
+    while (id != kNone) {
+      const Id next_id = nodes_[id].next;
+      expired->push_back(id);
+      Free(id);
+      id = next_id;
+    }
+  }
+  now_ = std::max(now_, now);
+}
+
+}  // namespace node
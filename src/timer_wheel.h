@@ -0,0 +1,89 @@
+#ifndef SRC_TIMER_WHEEL_H_
+#define SRC_TIMER_WHEEL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace node {
+
+// A hierarchical timing wheel for large numbers of timeouts that are mostly
+// cancelled or pushed back before they expire, such as socket idle timeouts.
+// Time is counted in ticks, whose length is up to the owner.
+//
+// Level 0 has one slot per tick, and each slot of level N covers all 64 slots
+// of level N - 1. An entry is kept in the lowest level that can tell its
+// expiry apart from the current tick, and moves down a level each time the
+// wheel reaches the start of its slot. Inserting, rescheduling and cancelling
+// an entry take constant time.
+class TimerWheel {
+ public:
+  using Id = uint32_t;
+
+  static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+  explicit TimerWheel(uint64_t now = 0);
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Adds an entry that expires at the tick `expiry`. Entries that are already
+  // due expire on the next tick. Ids of entries that have expired or have
+  // been cancelled are reused.
+  Id Insert(uint64_t expiry);
+  // Moves an active entry to a new expiry. Returns false if `id` is not an
+  // active entry.
+  bool Reschedule(Id id, uint64_t expiry);
+  // Returns false if `id` is not an active entry.
+  bool Cancel(Id id);
+  bool IsActive(Id id) const;
+
+  // Moves the wheel forward to `now`, and appends the ids of the entries that
+  // expired on the way to `expired`, in order of expiry.
+  void Advance(uint64_t now, std::vector<Id>* expired);
+  // The earliest tick at which Advance() may have work to do, or kNever if
+  // there are no active entries. Entries that are far out only move down a
+  // level at this tick, so they do not necessarily expire then.
+  uint64_t NextTick() const;
+
+  uint64_t now() const { return now_; }
+  size_t size() const { return size_; }
+
+ private:
+  static constexpr int kLevelBits = 6;
+  static constexpr int kSlots = 1 << kLevelBits;
+  // Enough levels for 2^36 ticks. Entries that expire later than that wait
+  // in the last level until they are in range.
+  static constexpr int kLevels = 6;
+  static constexpr Id kNone = std::numeric_limits<Id>::max();
+
+  struct Node {
+    uint64_t expiry = 0;
+    Id prev = kNone;
+    Id next = kNone;
+    uint8_t level = 0;
+    uint8_t slot = 0;
+    bool active = false;
+  };
+
+  void Link(Id id);
+  void Unlink(Id id);
+  void Free(Id id);
+
+  std::vector<Node> nodes_;
+  std::vector<Id> free_ids_;
+  Id slots_[kLevels][kSlots];
+  // One bit per slot that has entries.
+  uint64_t occupied_[kLevels] = {};
+  uint64_t now_;
+  size_t size_ = 0;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_TIMER_WHEEL_H_
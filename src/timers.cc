@@ -1,22 +1,33 @@
 #include "timers.h"
+#include "async_wrap-inl.h"
 #include "env-inl.h"
+#include "memory_tracker-inl.h"
 #include "node_external_reference.h"
+#include "timer_wrap-inl.h"
 #include "util-inl.h"
 #include "v8.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 
 namespace node {
 namespace timers {
 
+using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
 using v8::Isolate;
 using v8::Local;
+using v8::LocalVector;
 using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
+using v8::Uint32;
 using v8::Value;
 
 void BindingData::SetupTimers(const FunctionCallbackInfo<Value>& args) {
@@ -83,6 +94,107 @@ void BindingData::ToggleImmediateRefImpl(BindingData* data, bool ref) {
   data->env()->ToggleImmediateRef(ref);
 }
 
+TimerWheelWrap::TimerWheelWrap(Environment* env,
+                               Local<Object> object,
+                               uint64_t resolution)
+    : AsyncWrap(env, object, AsyncWrap::PROVIDER_TIMERWHEEL),
+      wheel_((uv_now(env->event_loop()) - env->timer_base()) / resolution),
+      timer_(env, [this] { OnTimeout(); }),
+      resolution_(resolution) {
+  MakeWeak();
+  timer_.Unref();
+}
+
+void TimerWheelWrap::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  // The resolution in milliseconds. Entries expire up to this much late.
+  uint32_t resolution = 1;
+  if (args[0]->IsUint32())
+    resolution = std::max(args[0].As<Uint32>()->Value(), 1u);
+  new TimerWheelWrap(env, args.This(), resolution);
+}
+
+uint64_t TimerWheelWrap::LoopTime() const {
+  return uv_now(env()->event_loop()) - env()->timer_base();
+}
+
+uint64_t TimerWheelWrap::ExpiryFor(double timeout) const {
+  // Like the JS timers, treat anything that is not a positive duration as 1.
+  if (!(timeout >= 1)) timeout = 1;
+  // Round up, so that an entry never expires early.
+  const double ticks =
+      std::ceil((static_cast<double>(LoopTime()) + timeout) / resolution_);
+  if (ticks >= static_cast<double>(TimerWheel::kNever))
+    return TimerWheel::kNever - 1;
+  return static_cast<uint64_t>(ticks);
+}
+
+void TimerWheelWrap::Arm() {
+  const uint64_t next = wheel_.NextTick();
+  // Cancelling or pushing back an entry leaves the timer alone. Firing early
+  // only costs a wakeup, which is cheaper than restarting the timer each time.
+  if (next == TimerWheel::kNever || next >= armed_tick_) return;
+  armed_tick_ = next;
+  const uint64_t now = LoopTime();
+  const uint64_t due = next * resolution_;
+  timer_.Update(due > now ? due - now : 0);
+}
+
+void TimerWheelWrap::Insert(const FunctionCallbackInfo<Value>& args) {
+  TimerWheelWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  CHECK(args[0]->IsNumber());
+  TimerWheel::Id id =
+      wrap->wheel_.Insert(wrap->ExpiryFor(args[0].As<Number>()->Value()));
+  wrap->Arm();
+  args.GetReturnValue().Set(id);
+}
+
+void TimerWheelWrap::Refresh(const FunctionCallbackInfo<Value>& args) {
+  TimerWheelWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsNumber());
+  bool pending =
+      wrap->wheel_.Reschedule(args[0].As<Uint32>()->Value(),
+                              wrap->ExpiryFor(args[1].As<Number>()->Value()));
+  if (pending) wrap->Arm();
+  args.GetReturnValue().Set(pending);
+}
+
+void TimerWheelWrap::Cancel(const FunctionCallbackInfo<Value>& args) {
+  TimerWheelWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  CHECK(args[0]->IsUint32());
+  args.GetReturnValue().Set(
+      wrap->wheel_.Cancel(args[0].As<Uint32>()->Value()));
+}
+
+void TimerWheelWrap::OnTimeout() {
+  armed_tick_ = TimerWheel::kNever;
+  expired_.clear();
+  wheel_.Advance(LoopTime() / resolution_, &expired_);
+  Arm();
+  if (expired_.empty()) return;
+
+  Isolate* isolate = env()->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env()->context());
+  LocalVector<Value> ids(isolate);
+  ids.reserve(expired_.size());
+  for (TimerWheel::Id id : expired_)
+    ids.push_back(Integer::NewFromUnsigned(isolate, id));
+  Local<Value> arg = Array::New(isolate, ids.data(), ids.size());
+  MakeCallback(env()->ontimeout_string(), 1, &arg);
+}
+
+void TimerWheelWrap::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackField("timer", timer_);
+  tracker->TrackFieldWithSize("expired",
+                              expired_.capacity() * sizeof(TimerWheel::Id));
+}
+
 BindingData::BindingData(Realm* realm, Local<Object> object)
     : SnapshotableObject(realm, object, type_int) {}
 
@@ -143,6 +255,16 @@ void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
                 "toggleImmediateRef",
                 SlowToggleImmediateRef,
                 &fast_toggle_immediate_ref_);
+
+  Local<FunctionTemplate> wheel =
+      NewFunctionTemplate(isolate, TimerWheelWrap::New);
+  wheel->InstanceTemplate()->SetInternalFieldCount(
+      TimerWheelWrap::kInternalFieldCount);
+  wheel->Inherit(AsyncWrap::GetConstructorTemplate(isolate_data));
+  SetProtoMethod(isolate, wheel, "insert", TimerWheelWrap::Insert);
+  SetProtoMethod(isolate, wheel, "refresh", TimerWheelWrap::Refresh);
+  SetProtoMethod(isolate, wheel, "cancel", TimerWheelWrap::Cancel);
+  SetConstructorFunction(isolate, target, "TimerWheel", wheel);
 }
 
 void BindingData::CreatePerContextProperties(Local<Object> target,
@@ -187,6 +309,11 @@ void BindingData::RegisterTimerExternalReferences(
   registry->Register(SlowToggleImmediateRef);
   registry->Register(FastToggleImmediateRef);
   registry->Register(fast_toggle_immediate_ref_.GetTypeInfo());
+
+  registry->Register(TimerWheelWrap::New);
+  registry->Register(TimerWheelWrap::Insert);
+  registry->Register(TimerWheelWrap::Refresh);
+  registry->Register(TimerWheelWrap::Cancel);
 }
 
 }  // namespace timers
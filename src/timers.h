@@ -4,7 +4,11 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include <cinttypes>
+#include <vector>
+#include "async_wrap.h"
 #include "node_snapshotable.h"
+#include "timer_wheel.h"
+#include "timer_wrap.h"
 
 namespace node {
 class ExternalReferenceRegistry;
@@ -61,6 +65,52 @@ class BindingData : public SnapshotableObject {
   static v8::CFunction fast_toggle_immediate_ref_;
 };
 
+// Timeouts that are usually cancelled or pushed back before they expire, such
+// as socket and HTTP idle timeouts, kept in a native timer wheel instead of
+// the JS timer lists. Entries are plain integer ids, so scheduling one does not
+// allocate a JS object, and inserting, refreshing and cancelling one takes
+// constant time. All entries share a single libuv timer, which is unrefed, so
+// pending entries do not keep the event loop alive.
+//
+// Expiry is reported by calling `ontimeout` with an array of the ids that
+// expired. Those ids may be handed out again right away.
+class TimerWheelWrap final : public AsyncWrap {
+ public:
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // insert(timeout) returns the id of a new entry that expires after
+  // `timeout` milliseconds.
+  static void Insert(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // refresh(id, timeout) returns false if `id` is not pending.
+  static void Refresh(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // cancel(id) returns false if `id` is not pending.
+  static void Cancel(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(TimerWheelWrap)
+  SET_SELF_SIZE(TimerWheelWrap)
+
+ private:
+  TimerWheelWrap(Environment* env,
+                 v8::Local<v8::Object> object,
+                 uint64_t resolution);
+
+  // The loop time in milliseconds, without updating it first.
+  uint64_t LoopTime() const;
+  uint64_t ExpiryFor(double timeout) const;
+  // Makes sure that the libuv timer fires no later than the next tick that
+  // the wheel needs to look at.
+  void Arm();
+  void OnTimeout();
+
+  TimerWheel wheel_;
+  TimerWrapHandle timer_;
+  // Milliseconds per tick.
+  const uint64_t resolution_;
+  // The tick that the libuv timer is due at.
+  uint64_t armed_tick_ = TimerWheel::kNever;
+  std::vector<TimerWheel::Id> expired_;
+};
+
 }  // namespace timers
 
 }  // namespace node
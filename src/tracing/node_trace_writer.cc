@@ -1,15 +1,33 @@
 #include "tracing/node_trace_writer.h"
 
+#include "tracing/perfetto_trace_writer.h"
 #include "util-inl.h"
 
 #include <fcntl.h>
+#include <algorithm>
 #include <cstring>
 
 namespace node {
 namespace tracing {
 
-NodeTraceWriter::NodeTraceWriter(const std::string& log_file_pattern)
-    : log_file_pattern_(log_file_pattern) {}
+NodeTraceWriter::NodeTraceWriter(const std::string& log_file_pattern,
+                                 Format format)
+    : log_file_pattern_(log_file_pattern),
+      format_(format),
+      gzip_(log_file_pattern.ends_with(".gz")) {
+  if (gzip_) {
+    memset(&zstream_, 0, sizeof(zstream_));
+    // Tracing is meant to be cheap enough to leave on, so use the fastest
+    // level. The extra 16 window bits select the gzip format.
+    CHECK_EQ(Z_OK,
+             deflateInit2(&zstream_,
+                          Z_BEST_SPEED,
+                          Z_DEFLATED,
+                          15 + 16,
+                          8,
+                          Z_DEFAULT_STRATEGY));
+  }
+}
 
 void NodeTraceWriter::InitializeOnThread(uv_loop_t* loop) {
   CHECK_NULL(tracing_loop_);
@@ -54,10 +72,13 @@ NodeTraceWriter::~NodeTraceWriter() {
     uv_fs_req_cleanup(&req);
   }
   uv_async_send(&exit_signal_);
-  Mutex::ScopedLock scoped_lock(request_mutex_);
-  while (!exited_) {
-    exit_cond_.Wait(scoped_lock);
+  {
+    Mutex::ScopedLock scoped_lock(request_mutex_);
+    while (!exited_) {
+      exit_cond_.Wait(scoped_lock);
+    }
   }
+  if (gzip_) deflateEnd(&zstream_);
 }
 
 void replace_substring(std::string* target,
@@ -101,34 +122,44 @@ void NodeTraceWriter::AppendTraceEvent(TraceObject* trace_event) {
   // If this is the first trace event, open a new file for streaming.
   if (total_traces_ == 0) {
     OpenNewFileForStreaming();
-    // Constructing a new JSONTraceWriter object appends "{\"traceEvents\":["
-    // to stream_.
-    // In other words, the constructor initializes the serialization stream
-    // to a state where we can start writing trace events to it.
-    // Repeatedly constructing and destroying json_trace_writer_ allows
-    // us to use V8's JSON writer instead of implementing our own.
-    json_trace_writer_.reset(TraceWriter::CreateJSONTraceWriter(stream_));
+    if (format_ == Format::kPerfetto) {
+      // Every file starts over with new track descriptors.
+      trace_writer_ = std::make_unique<PerfettoTraceWriter>(stream_);
+    } else {
+      // Constructing a new JSONTraceWriter object appends
+      // "{\"traceEvents\":[" to stream_.
+      // In other words, the constructor initializes the serialization stream
+      // to a state where we can start writing trace events to it.
+      // Repeatedly constructing and destroying trace_writer_ allows
+      // us to use V8's JSON writer instead of implementing our own.
+      trace_writer_.reset(TraceWriter::CreateJSONTraceWriter(stream_));
+    }
   }
   ++total_traces_;
-  json_trace_writer_->AppendTraceEvent(trace_event);
+  trace_writer_->AppendTraceEvent(trace_event);
 }
 
 void NodeTraceWriter::FlushPrivate() {
   std::string str;
   int highest_request_id;
+  bool end_of_file = false;
   {
     Mutex::ScopedLock stream_scoped_lock(stream_mutex_);
     if (total_traces_ >= kTracesPerFile) {
       total_traces_ = 0;
+      end_of_file = true;
       // Destroying the member JSONTraceWriter object appends "]}" to
       // stream_ - in other words, ending a JSON file.
-      json_trace_writer_.reset();
+      trace_writer_.reset();
     }
     // str() makes a copy of the contents of the stream.
     str = stream_.str();
     stream_.str("");
     stream_.clear();
   }
+  // Compressing outside of the lock keeps it off the threads that record
+  // trace events.
+  if (gzip_) Compress(&str, end_of_file);
   {
     Mutex::ScopedLock request_scoped_lock(request_mutex_);
     highest_request_id = num_write_requests_;
@@ -136,14 +167,35 @@ void NodeTraceWriter::FlushPrivate() {
   WriteToFile(std::move(str), highest_request_id);
 }
 
+void NodeTraceWriter::Compress(std::string* str, bool end_of_file) {
+  // Each flush ends on a byte boundary, so that everything that has been
+  // written so far can be decompressed even if the process dies.
+  if (str->empty() && !end_of_file) return;
+  std::string out;
+  zstream_.next_in = reinterpret_cast<Bytef*>(str->data());
+  zstream_.avail_in = str->size();
+  do {
+    const size_t offset = out.size();
+    out.resize(offset + std::max<size_t>(str->size() / 2, 16 * 1024));
+    zstream_.next_out = reinterpret_cast<Bytef*>(out.data() + offset);
+    zstream_.avail_out = out.size() - offset;
+    const int err = deflate(&zstream_, end_of_file ? Z_FINISH : Z_SYNC_FLUSH);
+    CHECK_NE(err, Z_STREAM_ERROR);
+  } while (zstream_.avail_out == 0);
+  out.resize(out.size() - zstream_.avail_out);
+  // Every file is a gzip stream of its own.
+  if (end_of_file) CHECK_EQ(Z_OK, deflateReset(&zstream_));
+  *str = std::move(out);
+}
+
 void NodeTraceWriter::Flush(bool blocking) {
   Mutex::ScopedLock scoped_lock(request_mutex_);
   {
     // We need to lock the mutexes here in a nested fashion; stream_mutex_
-    // protects json_trace_writer_, and without request_mutex_ there might be
+    // protects trace_writer_, and without request_mutex_ there might be
     // a time window in which the stream state changes?
     Mutex::ScopedLock stream_mutex_lock(stream_mutex_);
-    if (!json_trace_writer_)
+    if (!trace_writer_)
       return;
   }
   int request_id = ++num_write_requests_;
@@ -0,0 +1,383 @@
+#include "tracing/perfetto_trace_writer.h"
+
+#include "protobuf_writer.h"
+#include "tracing/trace_event_common.h"
+#include "util.h"
+
+#include <functional>
+
+namespace node {
+namespace tracing {
+
+using v8::platform::tracing::TraceObject;
+
+using protobuf::WriteBytes;
+using protobuf::WriteDouble;
+using protobuf::WriteInt;
+using protobuf::WriteTag;
+using protobuf::WriteVarint;
+
+namespace {
+
+// Field numbers, from protos/perfetto/trace/ in the Perfetto repository.
+enum TraceField { kTracePacket = 1 };
+
+enum TracePacketField {
+  kTimestamp = 8,
+  kTrustedPacketSequenceId = 10,
+  kTrackEvent = 11,
+  kSequenceFlags = 13,
+  kTrackDescriptor = 60,
+};
+
+enum TrackEventField {
+  kDebugAnnotations = 4,
+  kType = 9,
+  kTrackUuid = 11,
+  kCategories = 22,
+  kName = 23,
+  kCounterValue = 30,
+  kDoubleCounterValue = 44,
+};
+
+enum TrackEventType {
+  kSliceBegin = 1,
+  kSliceEnd = 2,
+  kInstant = 3,
+  kCounter = 4,
+};
+
+enum DebugAnnotationField {
+  kBoolValue = 2,
+  kUintValue = 3,
+  kIntValue = 4,
+  kDoubleValue = 5,
+  kStringValue = 6,
+  kPointerValue = 7,
+  kLegacyJsonValue = 9,
+  kAnnotationName = 10,
+};
+
+enum TrackDescriptorField {
+  kUuid = 1,
+  kTrackName = 2,
+  kProcess = 3,
+  kThread = 4,
+  kParentUuid = 5,
+  kCounterDescriptor = 8,
+};
+
+enum ProcessDescriptorField { kProcessPid = 1, kProcessName = 6 };
+enum ThreadDescriptorField { kThreadPid = 1, kThreadTid = 2, kThreadName = 5 };
+
+// All events come from the same writer, so they form one sequence.
+constexpr uint64_t kSequenceId = 1;
+constexpr uint64_t kSequenceIncrementalStateCleared = 1;
+
+enum TrackKind { kProcessTrack = 1, kThreadTrack, kAsyncTrack, kCounterTrack };
+
+uint64_t Mix(uint64_t hash, uint64_t value) {
+  // The finalizer of splitmix64.
+  hash ^= value + 0x9e3779b97f4a7c15;
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+  return hash ^ (hash >> 31);
+}
+
+// Track UUIDs only have to be unique within the trace.
+uint64_t TrackUuid(TrackKind kind, int pid, uint64_t value) {
+  return Mix(Mix(kind, static_cast<uint32_t>(pid)), value);
+}
+
+}  // anonymous namespace
+
+PerfettoTraceWriter::PerfettoTraceWriter(std::ostream& stream)
+    : stream_(stream) {}
+
+void PerfettoTraceWriter::AppendTraceEvent(TraceObject* trace_event) {
+  const int pid = trace_event->pid();
+  const int tid = trace_event->tid();
+  switch (trace_event->phase()) {
+    case TRACE_EVENT_PHASE_BEGIN:
+      StartTrackEvent(kSliceBegin, ThreadTrack(pid, tid));
+      WriteNames(trace_event);
+      WriteArgs(trace_event);
+      WriteTrackEvent(trace_event->ts());
+      break;
+    case TRACE_EVENT_PHASE_END:
+      StartTrackEvent(kSliceEnd, ThreadTrack(pid, tid));
+      WriteArgs(trace_event);
+      WriteTrackEvent(trace_event->ts());
+      break;
+    case TRACE_EVENT_PHASE_COMPLETE: {
+      // There is no complete event type, so this becomes a slice that
+      // begins and ends on the same track.
+      const uint64_t track = ThreadTrack(pid, tid);
+      StartTrackEvent(kSliceBegin, track);
+      WriteNames(trace_event);
+      WriteArgs(trace_event);
+      WriteTrackEvent(trace_event->ts());
+      StartTrackEvent(kSliceEnd, track);
+      WriteTrackEvent(trace_event->ts() + trace_event->duration());
+      break;
+    }
+    case TRACE_EVENT_PHASE_INSTANT:
+    case TRACE_EVENT_PHASE_MARK:
+    case 'i':  // The old phase of instant events.
+      StartTrackEvent(kInstant, ThreadTrack(pid, tid));
+      WriteNames(trace_event);
+      WriteArgs(trace_event);
+      WriteTrackEvent(trace_event->ts());
+      break;
+    case TRACE_EVENT_PHASE_ASYNC_BEGIN:
+    case TRACE_EVENT_PHASE_NESTABLE_ASYNC_BEGIN:
+      StartTrackEvent(
+          kSliceBegin,
+          AsyncTrack(pid, trace_event->name(), trace_event->id()));
+      WriteNames(trace_event);
+      WriteArgs(trace_event);
+      WriteTrackEvent(trace_event->ts());
+      break;
+    case TRACE_EVENT_PHASE_ASYNC_END:
+    case TRACE_EVENT_PHASE_NESTABLE_ASYNC_END:
+      StartTrackEvent(
+          kSliceEnd,
+          AsyncTrack(pid, trace_event->name(), trace_event->id()));
+      WriteArgs(trace_event);
+      WriteTrackEvent(trace_event->ts());
+      break;
+    case TRACE_EVENT_PHASE_ASYNC_STEP_INTO:
+    case TRACE_EVENT_PHASE_ASYNC_STEP_PAST:
+    case TRACE_EVENT_PHASE_NESTABLE_ASYNC_INSTANT:
+      StartTrackEvent(
+          kInstant,
+          AsyncTrack(pid, trace_event->name(), trace_event->id()));
+      WriteNames(trace_event);
+      WriteArgs(trace_event);
+      WriteTrackEvent(trace_event->ts());
+      break;
+    case TRACE_EVENT_PHASE_COUNTER:
+      // Every argument is a separate series, with a track of its own.
+      for (int i = 0; i < trace_event->num_args(); i++) {
+        std::string name = trace_event->name();
+        if (trace_event->num_args() > 1)
+          name.append(".").append(trace_event->arg_names()[i]);
+        const TraceObject::ArgValue value = trace_event->arg_values()[i];
+        switch (trace_event->arg_types()[i]) {
+          case TRACE_VALUE_TYPE_BOOL:
+          case TRACE_VALUE_TYPE_UINT:
+          case TRACE_VALUE_TYPE_INT:
+            StartTrackEvent(kCounter, CounterTrack(pid, name));
+            WriteInt(&event_, kCounterValue, value.as_int);
+            break;
+          case TRACE_VALUE_TYPE_DOUBLE:
+            StartTrackEvent(kCounter, CounterTrack(pid, name));
+            WriteDouble(&event_, kDoubleCounterValue, value.as_double);
+            break;
+          default:
+            continue;
+        }
+        WriteTrackEvent(trace_event->ts());
+      }
+      break;
+    case TRACE_EVENT_PHASE_METADATA: {
+      // Only the names of threads and processes have a Perfetto equivalent.
+      if (trace_event->num_args() < 1 ||
+          (trace_event->arg_types()[0] != TRACE_VALUE_TYPE_STRING &&
+           trace_event->arg_types()[0] != TRACE_VALUE_TYPE_COPY_STRING)) {
+        break;
+      }
+      const std::string_view event_name = trace_event->name();
+      const char* value = trace_event->arg_values()[0].as_string;
+      if (value == nullptr) break;
+      if (event_name == "thread_name")
+        WriteThreadName(pid, tid, value);
+      else if (event_name == "process_name")
+        WriteProcessName(pid, value);
+      break;
+    }
+    default:
+      // Flow, object and sample events are dropped.
+      break;
+  }
+}
+
+uint64_t PerfettoTraceWriter::ProcessTrack(int pid) {
+  const uint64_t uuid = TrackUuid(kProcessTrack, pid, 0);
+  if (tracks_.insert(uuid).second) {
+    std::string process;
+    WriteInt(&process, kProcessPid, pid);
+    std::string descriptor;
+    WriteInt(&descriptor, kUuid, uuid);
+    WriteBytes(&descriptor, kProcess, process);
+    WriteTrackDescriptor(descriptor);
+  }
+  return uuid;
+}
+
+uint64_t PerfettoTraceWriter::ThreadTrack(int pid, int tid) {
+  const uint64_t uuid =
+      TrackUuid(kThreadTrack, pid, static_cast<uint32_t>(tid));
+  if (tracks_.insert(uuid).second) {
+    std::string thread;
+    WriteInt(&thread, kThreadPid, pid);
+    WriteInt(&thread, kThreadTid, tid);
+    std::string descriptor;
+    WriteInt(&descriptor, kUuid, uuid);
+    WriteInt(&descriptor, kParentUuid, ProcessTrack(pid));
+    WriteBytes(&descriptor, kThread, thread);
+    WriteTrackDescriptor(descriptor);
+  }
+  return uuid;
+}
+
+uint64_t PerfettoTraceWriter::AsyncTrack(int pid,
+                                         std::string_view name,
+                                         uint64_t id) {
+  // Like in the JSON format, async events are matched by name and id.
+  const uint64_t uuid = Mix(TrackUuid(kAsyncTrack, pid, id),
+                            std::hash<std::string_view>()(name));
+  if (tracks_.insert(uuid).second) {
+    std::string descriptor;
+    WriteInt(&descriptor, kUuid, uuid);
+    WriteInt(&descriptor, kParentUuid, ProcessTrack(pid));
+    WriteBytes(&descriptor, kTrackName, name);
+    WriteTrackDescriptor(descriptor);
+  }
+  return uuid;
+}
+
+uint64_t PerfettoTraceWriter::CounterTrack(int pid, const std::string& name) {
+  const uint64_t uuid =
+      TrackUuid(kCounterTrack, pid, std::hash<std::string>()(name));
+  if (tracks_.insert(uuid).second) {
+    std::string descriptor;
+    WriteInt(&descriptor, kUuid, uuid);
+    WriteInt(&descriptor, kParentUuid, ProcessTrack(pid));
+    WriteBytes(&descriptor, kTrackName, name);
+    WriteBytes(&descriptor, kCounterDescriptor, "");
+    WriteTrackDescriptor(descriptor);
+  }
+  return uuid;
+}
+
+void PerfettoTraceWriter::WriteThreadName(int pid,
+                                          int tid,
+                                          std::string_view name) {
+  // A descriptor for a track that has already been described replaces the
+  // earlier one.
+  const uint64_t uuid = ThreadTrack(pid, tid);
+  std::string thread;
+  WriteInt(&thread, kThreadPid, pid);
+  WriteInt(&thread, kThreadTid, tid);
+  WriteBytes(&thread, kThreadName, name);
+  std::string descriptor;
+  WriteInt(&descriptor, kUuid, uuid);
+  WriteInt(&descriptor, kParentUuid, ProcessTrack(pid));
+  WriteBytes(&descriptor, kThread, thread);
+  WriteTrackDescriptor(descriptor);
+}
+
+void PerfettoTraceWriter::WriteProcessName(int pid, std::string_view name) {
+  const uint64_t uuid = ProcessTrack(pid);
+  std::string process;
+  WriteInt(&process, kProcessPid, pid);
+  WriteBytes(&process, kProcessName, name);
+  std::string descriptor;
+  WriteInt(&descriptor, kUuid, uuid);
+  WriteBytes(&descriptor, kProcess, process);
+  WriteTrackDescriptor(descriptor);
+}
+
+void PerfettoTraceWriter::StartTrackEvent(int type, uint64_t track) {
+  event_.clear();
+  WriteInt(&event_, kType, type);
+  WriteInt(&event_, kTrackUuid, track);
+}
+
+void PerfettoTraceWriter::WriteNames(TraceObject* trace_event) {
+  WriteBytes(&event_,
+             kCategories,
+             v8::platform::tracing::TracingController::GetCategoryGroupName(
+                 trace_event->category_enabled_flag()));
+  WriteBytes(&event_, kName, trace_event->name());
+}
+
+void PerfettoTraceWriter::WriteArgs(TraceObject* trace_event) {
+  for (int i = 0; i < trace_event->num_args(); i++) {
+    annotation_.clear();
+    WriteBytes(&annotation_, kAnnotationName, trace_event->arg_names()[i]);
+    const TraceObject::ArgValue value = trace_event->arg_values()[i];
+    switch (trace_event->arg_types()[i]) {
+      case TRACE_VALUE_TYPE_BOOL:
+        WriteInt(&annotation_, kBoolValue, value.as_uint != 0);
+        break;
+      case TRACE_VALUE_TYPE_UINT:
+        WriteInt(&annotation_, kUintValue, value.as_uint);
+        break;
+      case TRACE_VALUE_TYPE_INT:
+        WriteInt(&annotation_, kIntValue, value.as_int);
+        break;
+      case TRACE_VALUE_TYPE_DOUBLE:
+        WriteDouble(&annotation_, kDoubleValue, value.as_double);
+        break;
+      case TRACE_VALUE_TYPE_POINTER:
+        WriteInt(&annotation_,
+                 kPointerValue,
+                 reinterpret_cast<uintptr_t>(value.as_pointer));
+        break;
+      case TRACE_VALUE_TYPE_STRING:
+      case TRACE_VALUE_TYPE_COPY_STRING:
+        WriteBytes(&annotation_,
+                   kStringValue,
+                   value.as_string != nullptr ? value.as_string : "");
+        break;
+      case TRACE_VALUE_TYPE_CONVERTABLE: {
+        std::string json;
+        trace_event->arg_convertables()[i]->AppendAsTraceFormat(&json);
+        WriteBytes(&annotation_, kLegacyJsonValue, json);
+        break;
+      }
+      default:
+        UNREACHABLE();
+    }
+    WriteBytes(&event_, kDebugAnnotations, annotation_);
+  }
+}
+
+void PerfettoTraceWriter::WriteTrackEvent(int64_t timestamp_us) {
+  StartPacket();
+  WriteInt(&packet_, kTimestamp, timestamp_us * 1000);
+  WriteBytes(&packet_, kTrackEvent, event_);
+  WritePacket();
+}
+
+void PerfettoTraceWriter::WriteTrackDescriptor(const std::string& descriptor) {
+  StartPacket();
+  WriteBytes(&packet_, kTrackDescriptor, descriptor);
+  WritePacket();
+}
+
+void PerfettoTraceWriter::StartPacket() {
+  packet_.clear();
+  WriteInt(&packet_, kTrustedPacketSequenceId, kSequenceId);
+  if (first_packet_) {
+    // Every file starts a new sequence, which does not depend on state
+    // from earlier packets.
+    WriteInt(&packet_, kSequenceFlags, kSequenceIncrementalStateCleared);
+    first_packet_ = false;
+  }
+}
+
+void PerfettoTraceWriter::WritePacket() {
+  // Write the header of the Trace.packet field separately, rather than
+  // copying the packet into one more buffer.
+  std::string prefix;
+  WriteTag(&prefix, kTracePacket, protobuf::kLengthDelimited);
+  WriteVarint(&prefix, packet_.size());
+  stream_.write(prefix.data(), prefix.size());
+  stream_.write(packet_.data(), packet_.size());
+}
+
+}  // namespace tracing
+}  // namespace node
@@ -0,0 +1,61 @@
+#ifndef SRC_TRACING_PERFETTO_TRACE_WRITER_H_
+#define SRC_TRACING_PERFETTO_TRACE_WRITER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "libplatform/v8-tracing.h"
+
+namespace node {
+namespace tracing {
+
+// Writes trace events in Perfetto's protocol buffer format, i.e. as a
+// perfetto.protos.Trace message made of one TracePacket per event, see
+// https://perfetto.dev/docs/reference/trace-packet-proto. That is a lot
+// smaller and cheaper to produce than the JSON format, and can be opened
+// in the Perfetto UI. Like V8's JSON writer, this only serializes events
+// into `stream`. Since a trace is just a sequence of packets, the output is
+// a valid trace after every event, so nothing is written on destruction.
+class PerfettoTraceWriter : public v8::platform::tracing::TraceWriter {
+ public:
+  explicit PerfettoTraceWriter(std::ostream& stream);
+
+  void AppendTraceEvent(
+      v8::platform::tracing::TraceObject* trace_event) override;
+  void Flush() override {}
+
+ private:
+  uint64_t ProcessTrack(int pid);
+  uint64_t ThreadTrack(int pid, int tid);
+  uint64_t AsyncTrack(int pid, std::string_view name, uint64_t id);
+  uint64_t CounterTrack(int pid, const std::string& name);
+
+  void WriteThreadName(int pid, int tid, std::string_view name);
+  void WriteProcessName(int pid, std::string_view name);
+  // These build the TrackEvent message of the current event in event_.
+  void StartTrackEvent(int type, uint64_t track);
+  void WriteNames(v8::platform::tracing::TraceObject* trace_event);
+  void WriteArgs(v8::platform::tracing::TraceObject* trace_event);
+  void WriteTrackEvent(int64_t timestamp_us);
+
+  void WriteTrackDescriptor(const std::string& descriptor);
+  void StartPacket();
+  void WritePacket();
+
+  std::ostream& stream_;
+  // The tracks that have already been described in this file.
+  std::unordered_set<uint64_t> tracks_;
+  bool first_packet_ = true;
+  // Reused between events to avoid allocations.
+  std::string event_;
+  std::string packet_;
+  std::string annotation_;
+};
+
+}  // namespace tracing
+}  // namespace node
+
+#endif  // SRC_TRACING_PERFETTO_TRACE_WRITER_H_
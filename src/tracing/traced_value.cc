@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "tracing/traced_value.h"
+#include "json_utils.h"
 
 #if defined(NODE_HAVE_I18N_SUPPORT)
 #include <unicode/utf8.h>
@@ -26,64 +27,65 @@ namespace tracing {
 
 namespace {
 
-std::string EscapeString(const char* value) {
-  std::string result;
-  result += '"';
+void AppendEscapedString(std::string* result, const char* value) {
+  *result += '"';
   char number_buffer[10];
-#if defined(NODE_HAVE_I18N_SUPPORT)
-  int32_t len = strlen(value);
-  int32_t p = 0;
+  const int32_t len = strlen(value);
   int32_t i = 0;
-  for (; i < len; p = i) {
+  while (i < len) {
+    // Most strings are mostly printable ASCII, which is copied in runs.
+    size_t run = FindJsonEscape(std::string_view(value + i, len - i), true);
+    result->append(value + i, run);
+    i += static_cast<int32_t>(run);
+    if (i == len) break;
+#if defined(NODE_HAVE_I18N_SUPPORT)
+    int32_t p = i;
     UChar32 c;
     U8_NEXT_OR_FFFD(value, i, len, c);
     switch (c) {
-      case '\b': result += "\\b"; break;
-      case '\f': result += "\\f"; break;
-      case '\n': result += "\\n"; break;
-      case '\r': result += "\\r"; break;
-      case '\t': result += "\\t"; break;
-      case '\\': result += "\\\\"; break;
-      case '"': result += "\\\""; break;
+      case '\b': *result += "\\b"; break;
+      case '\f': *result += "\\f"; break;
+      case '\n': *result += "\\n"; break;
+      case '\r': *result += "\\r"; break;
+      case '\t': *result += "\\t"; break;
+      case '\\': *result += "\\\\"; break;
+      case '"': *result += "\\\""; break;
       default:
         if (c < 32 || c > 126) {
           snprintf(
               number_buffer, arraysize(number_buffer), "\\u%04X",
               static_cast<uint16_t>(static_cast<uint16_t>(c)));
-          result += number_buffer;
+          *result += number_buffer;
         } else {
-          result.append(value + p, i - p);
+          result->append(value + p, i - p);
         }
     }
-  }
 #else
-  // If we do not have ICU, use a modified version of the non-UTF8 aware
-  // code from V8's own TracedValue implementation. Note, however, This
-  // will not produce correctly serialized results for UTF8 values.
-  while (*value) {
-    char c = *value++;
+    // If we do not have ICU, use a modified version of the non-UTF8 aware
+    // code from V8's own TracedValue implementation. Note, however, This
+    // will not produce correctly serialized results for UTF8 values.
+    char c = value[i++];
     switch (c) {
-      case '\b': result += "\\b"; break;
-      case '\f': result += "\\f"; break;
-      case '\n': result += "\\n"; break;
-      case '\r': result += "\\r"; break;
-      case '\t': result += "\\t"; break;
-      case '\\': result += "\\\\"; break;
-      case '"': result += "\\\""; break;
+      case '\b': *result += "\\b"; break;
+      case '\f': *result += "\\f"; break;
+      case '\n': *result += "\\n"; break;
+      case '\r': *result += "\\r"; break;
+      case '\t': *result += "\\t"; break;
+      case '\\': *result += "\\\\"; break;
+      case '"': *result += "\\\""; break;
       default:
         if (c < '\x20') {
           snprintf(
               number_buffer, arraysize(number_buffer), "\\u%04X",
               static_cast<unsigned>(static_cast<unsigned char>(c)));
-          result += number_buffer;
+          *result += number_buffer;
         } else {
-          result += c;
+          *result += c;
         }
     }
-  }
 #endif  // defined(NODE_HAVE_I18N_SUPPORT)
-  result += '"';
-  return result;
+  }
+  *result += '"';
 }
 
 std::string DoubleToCString(double v) {
@@ -135,7 +137,7 @@ void TracedValue::SetNull(const char* name) {
 
 void TracedValue::SetString(const char* name, const char* value) {
   WriteName(name);
-  data_ += EscapeString(value);
+  AppendEscapedString(&data_, value);
 }
 
 void TracedValue::BeginDictionary(const char* name) {
@@ -172,7 +174,7 @@ void TracedValue::AppendNull() {
 
 void TracedValue::AppendString(const char* value) {
   WriteComma();
-  data_ += EscapeString(value);
+  AppendEscapedString(&data_, value);
 }
 
 void TracedValue::BeginDictionary() {
@@ -20,6 +20,7 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "udp_wrap.h"
+#include "debug_utils-inl.h"
 #include "env-inl.h"
 #include "handle_wrap.h"
 #include "node_buffer.h"
@@ -29,6 +30,10 @@
 #include "req_wrap-inl.h"
 #include "util-inl.h"
 
+#ifdef __linux__
+#include <netinet/udp.h>  // UDP_SEGMENT
+#endif
+
 namespace node {
 
 using errors::TryCatchScope;
@@ -148,7 +153,11 @@ UDPWrap::UDPWrap(Environment* env, Local<Object> object)
   object->SetAlignedPointerInInternalField(
       UDPWrapBase::kUDPWrapBaseField, static_cast<UDPWrapBase*>(this));
 
-  int r = uv_udp_init(env->event_loop(), &handle_);
+  // Where supported, let libuv read several datagrams per system call.
+  unsigned int flags = AF_UNSPEC;
+  if (!UNLIKELY(env->options()->test_udp_no_recvmmsg))
+    flags |= UV_UDP_RECVMMSG;
+  int r = uv_udp_init_ex(env->event_loop(), &handle_, flags);
   CHECK_EQ(r, 0);  // can't fail anyway
 
   set_listener(this);
@@ -187,6 +196,10 @@ void UDPWrap::Initialize(Local<Object> target,
   SetProtoMethod(isolate, t, "bind6", Bind6);
   SetProtoMethod(isolate, t, "connect6", Connect6);
   SetProtoMethod(isolate, t, "send6", Send6);
+  SetProtoMethod(isolate, t, "sendBatch", SendBatch);
+  SetProtoMethod(isolate, t, "sendBatch6", SendBatch6);
+  SetProtoMethod(isolate, t, "trySend", TrySend);
+  SetProtoMethod(isolate, t, "trySend6", TrySend6);
   SetProtoMethod(isolate, t, "disconnect", Disconnect);
   SetProtoMethod(isolate,
                  t,
@@ -248,6 +261,10 @@ void UDPWrap::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Bind6);
   registry->Register(Connect6);
   registry->Register(Send6);
+  registry->Register(SendBatch);
+  registry->Register(SendBatch6);
+  registry->Register(TrySend);
+  registry->Register(TrySend6);
   registry->Register(Disconnect);
   registry->Register(GetSockOrPeerName<UDPWrap, uv_udp_getpeername>);
   registry->Register(GetSockOrPeerName<UDPWrap, uv_udp_getsockname>);
@@ -564,14 +581,10 @@ void UDPWrap::DoSend(const FunctionCallbackInfo<Value>& args, int family) {
   }
 
   int err = 0;
-  struct sockaddr_storage addr_storage;
-  sockaddr* addr = nullptr;
+  const sockaddr* addr = nullptr;
   if (sendto) {
     const unsigned short port = args[3].As<Uint32>()->Value();
-    node::Utf8Value address(env->isolate(), args[4]);
-    err = sockaddr_for_family(family, address.out(), port, &addr_storage);
-    if (err == 0)
-      addr = reinterpret_cast<sockaddr*>(&addr_storage);
+    err = wrap->GetDestination(family, args[4], port, &addr);
   }
 
   if (err == 0) {
@@ -646,6 +659,97 @@ ssize_t UDPWrap::Send(uv_buf_t* bufs_ptr,
 }
 
 
+ssize_t UDPWrap::TrySendBatch(uv_buf_t* bufs,
+                              size_t count,
+                              size_t segment_size,
+                              const sockaddr* addr) {
+  if (IsHandleClosing()) return UV_EBADF;
+#ifdef __linux__
+  // Don't let the batch overtake sends that libuv has already queued.
+  if (count == 0 || uv_udp_get_send_queue_count(&handle_) > 0) return 0;
+
+  uv_os_fd_t fd;
+  // The socket is created lazily by the first send() or bind().
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) != 0) return 0;
+
+  socklen_t addrlen = 0;
+  if (addr != nullptr) {
+    addrlen = addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6)
+                                          : sizeof(sockaddr_in);
+  }
+
+#ifdef UDP_SEGMENT
+  // With GSO the kernel splits one large write into `segment_size` sized
+  // datagrams. Every datagram but the last one must be exactly that size.
+  bool use_gso = segment_size > 0 && count > 1 && count <= 64;
+  size_t total = 0;
+  for (size_t i = 0; use_gso && i < count; i++) {
+    total += bufs[i].len;
+    use_gso = i + 1 < count ? bufs[i].len == segment_size
+                            : bufs[i].len > 0 && bufs[i].len <= segment_size;
+  }
+  if (use_gso && total <= 65507) {
+    char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+    msghdr h{};
+    h.msg_name = const_cast<sockaddr*>(addr);
+    h.msg_namelen = addrlen;
+    // uv_buf_t is layout compatible with struct iovec.
+    h.msg_iov = reinterpret_cast<iovec*>(bufs);
+    h.msg_iovlen = count;
+    h.msg_control = control;
+    h.msg_controllen = sizeof(control);
+    cmsghdr* cm = CMSG_FIRSTHDR(&h);
+    cm->cmsg_level = SOL_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t segment = static_cast<uint16_t>(segment_size);
+    memcpy(CMSG_DATA(cm), &segment, sizeof(segment));
+
+    ssize_t r;
+    do {
+      r = sendmsg(fd, &h, 0);
+    } while (r == -1 && errno == EINTR);
+    if (r >= 0) return count;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) return 0;
+    // EIO and EINVAL mean that GSO is not available for this socket or
+    // device, in which case sendmmsg() below still does the job.
+    if (errno != EIO && errno != EINVAL) return uv_translate_sys_error(errno);
+  }
+#endif  // UDP_SEGMENT
+
+  size_t sent = 0;
+  while (sent < count) {
+    mmsghdr msgs[64];
+    size_t n = std::min(count - sent, arraysize(msgs));
+    for (size_t i = 0; i < n; i++) {
+      memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_name = const_cast<sockaddr*>(addr);
+      msgs[i].msg_hdr.msg_namelen = addrlen;
+      msgs[i].msg_hdr.msg_iov = reinterpret_cast<iovec*>(&bufs[sent + i]);
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int r;
+    do {
+      r = sendmmsg(fd, msgs, n, 0);
+    } while (r == -1 && errno == EINTR);
+    if (r == -1) {
+      if (sent > 0 || errno == EAGAIN || errno == EWOULDBLOCK ||
+          errno == ENOBUFS) {
+        break;
+      }
+      return uv_translate_sys_error(errno);
+    }
+    sent += r;
+    if (static_cast<size_t>(r) < n) break;
+  }
+  return sent;
+#else
+  return 0;
+#endif  // __linux__
+}
+
+
 ReqWrap<uv_udp_send_t>* UDPWrap::CreateSendWrap(size_t msg_size) {
   SendWrap* req_wrap = new SendWrap(env(),
                                     current_send_req_wrap_,
@@ -660,11 +764,162 @@ void UDPWrap::Send(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  // sendBatch(list, list.length, segmentSize[, port, address])
+  // Every element of `list` is a single datagram. Returns how many of them
+  // were written synchronously; the caller sends the rest through send().
+  CHECK(args.Length() == 3 || args.Length() == 5);
+  CHECK(args[0]->IsArray());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsUint32());
+
+  bool sendto = args.Length() == 5;
+  if (sendto) {
+    CHECK(args[3]->IsUint32());
+    CHECK(args[4]->IsString());
+  }
+
+  Local<Array> chunks = args[0].As<Array>();
+  size_t count = args[1].As<Uint32>()->Value();
+  size_t segment_size = args[2].As<Uint32>()->Value();
+
+  MaybeStackBuffer<uv_buf_t, 16> bufs(count);
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> chunk;
+    if (!chunks->Get(env->context(), i).ToLocal(&chunk)) return;
+    bufs[i] = uv_buf_init(Buffer::Data(chunk), Buffer::Length(chunk));
+  }
+
+  int err = 0;
+  const sockaddr* addr = nullptr;
+  if (sendto) {
+    const unsigned short port = args[3].As<Uint32>()->Value();
+    err = wrap->GetDestination(family, args[4], port, &addr);
+  }
+
+  if (err == 0)
+    err = static_cast<int>(
+        wrap->TrySendBatch(*bufs, count, segment_size, addr));
+
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::DoTrySend(const FunctionCallbackInfo<Value>& args, int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  // trySend(list, list.length[, port, address])
+  // Writes the datagram if the socket accepts it without blocking, and
+  // returns UV_EAGAIN otherwise, in which case the caller creates a SendWrap
+  // and goes through send(). Unlike send(), this needs no request object.
+  CHECK(args.Length() == 2 || args.Length() == 4);
+  CHECK(args[0]->IsArray());
+  CHECK(args[1]->IsUint32());
+
+  bool sendto = args.Length() == 4;
+  if (sendto) {
+    CHECK(args[2]->IsUint32());
+    CHECK(args[3]->IsString());
+  }
+
+  if (wrap->IsHandleClosing()) return args.GetReturnValue().Set(UV_EBADF);
+  if (UNLIKELY(env->options()->test_udp_no_try_send))
+    return args.GetReturnValue().Set(UV_EAGAIN);
+
+  Local<Array> chunks = args[0].As<Array>();
+  size_t count = args[1].As<Uint32>()->Value();
+
+  MaybeStackBuffer<uv_buf_t, 16> bufs(count);
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> chunk;
+    if (!chunks->Get(env->context(), i).ToLocal(&chunk)) return;
+    bufs[i] = uv_buf_init(Buffer::Data(chunk), Buffer::Length(chunk));
+  }
+
+  int err = 0;
+  const sockaddr* addr = nullptr;
+  if (sendto) {
+    const unsigned short port = args[2].As<Uint32>()->Value();
+    err = wrap->GetDestination(family, args[3], port, &addr);
+  }
+
+  if (err == 0) {
+    err = uv_udp_try_send(&wrap->handle_, *bufs, count, addr);
+    if (err == UV_ENOSYS) err = UV_EAGAIN;
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+
+int UDPWrap::GetDestination(int family,
+                            Local<Value> address,
+                            unsigned short port,
+                            const sockaddr** addr) {
+  node::Utf8Value address_value(env()->isolate(), address);
+  std::string_view address_view = address_value.ToStringView();
+  for (const Destination& destination : destinations_) {
+    if (destination.family == family && destination.port == port &&
+        destination.address == address_view) {
+      *addr = reinterpret_cast<const sockaddr*>(&destination.storage);
+      return 0;
+    }
+  }
+
+  Destination& destination = destinations_[next_destination_];
+  int err = sockaddr_for_family(
+      family, address_value.out(), port, &destination.storage);
+  if (err != 0) {
+    destination.family = AF_UNSPEC;
+    return err;
+  }
+  destination.family = family;
+  destination.port = port;
+  destination.address = address_view;
+  next_destination_ = (next_destination_ + 1) % kDestinationCacheSize;
+  *addr = reinterpret_cast<const sockaddr*>(&destination.storage);
+  return 0;
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
   DoSend(args, AF_INET6);
 }
 
 
+void UDPWrap::TrySend(const FunctionCallbackInfo<Value>& args) {
+  DoTrySend(args, AF_INET);
+}
+
+
+void UDPWrap::TrySend6(const FunctionCallbackInfo<Value>& args) {
+  DoTrySend(args, AF_INET6);
+}
+
+
 AsyncWrap* UDPWrap::GetAsyncWrap() {
   return this;
 }
@@ -713,6 +968,7 @@ void UDPWrap::OnSendDone(ReqWrap<uv_udp_send_t>* req, int status) {
       Integer::New(env->isolate(), status),
       Integer::New(env->isolate(), req_wrap->msg_size),
     };
+    BatchTaskQueuesScope batch_scope(req_wrap.get());
     req_wrap->MakeCallback(env->oncomplete_string(), 2, arg);
   }
 }
@@ -723,6 +979,13 @@ void UDPWrap::OnAlloc(uv_handle_t* handle,
                       uv_buf_t* buf) {
   UDPWrap* wrap = ContainerOf(&UDPWrap::handle_,
                               reinterpret_cast<uv_udp_t*>(handle));
+  // Only our own listener knows how to deal with recvmmsg() batches, others
+  // get a buffer that fits exactly one datagram. Where libuv does not use
+  // recvmmsg(), every read is a single datagram, so there is nothing to gain.
+  if (wrap->listener() == wrap && uv_udp_using_recvmmsg(&wrap->handle_)) {
+    *buf = wrap->env()->allocate_udp_batch_buffer();
+    if (buf->base != nullptr) return;
+  }
   *buf = wrap->listener()->OnAlloc(suggested_size);
 }
 
@@ -736,7 +999,60 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const sockaddr* addr,
                      unsigned int flags) {
   UDPWrap* wrap = ContainerOf(&UDPWrap::handle_, handle);
-  wrap->listener()->OnRecv(nread, *buf, addr, flags);
+  if (wrap->env()->is_udp_batch_buffer(buf->base)) {
+    wrap->OnBatchRecv(nread, *buf, addr, flags);
+    return;
+  }
+  // A buffer from OnAlloc() holds a single recvmmsg() chunk, which has
+  // already been passed on together with the datagram.
+  if (flags & UV_UDP_MMSG_FREE) return;
+  wrap->listener()->OnRecv(nread, *buf, addr, flags & ~UV_UDP_MMSG_CHUNK);
+}
+
+void UDPWrap::OnBatchRecv(ssize_t nread,
+                          const uv_buf_t& buf,
+                          const sockaddr* addr,
+                          unsigned int flags) {
+  Environment* env = this->env();
+  // A chunk of a recvmmsg() batch, or a datagram that libuv read on its own
+  // with recvmsg() into the batch buffer.
+  if ((flags & UV_UDP_MMSG_CHUNK) || nread > 0) {
+    CHECK_GE(nread, 0);
+    CHECK_NOT_NULL(addr);
+    CHECK_LE(static_cast<size_t>(nread), buf.len);
+    // The datagram did not fit into its part of the buffer. Handing out the
+    // first part as if it were the whole datagram would corrupt it.
+    if (flags & UV_UDP_PARTIAL) {
+      Debug(this, "dropping a truncated datagram of %d bytes", nread);
+    } else {
+      NoArrayBufferZeroFillScope no_zero_fill_scope(env->isolate_data());
+      std::unique_ptr<BackingStore> bs =
+          ArrayBuffer::NewBackingStore(env->isolate(), nread);
+      memcpy(bs->Data(), buf.base, nread);
+      pending_datagrams_.push_back({std::move(bs), SocketAddress(addr)});
+    }
+    if (flags & UV_UDP_MMSG_CHUNK) return;
+  }
+
+  // Either UV_UDP_MMSG_FREE after a batch, an empty read or error that ended
+  // it, or a single datagram. Everything has been copied out of the batch
+  // buffer by now.
+  env->release_udp_batch_buffer();
+  std::vector<PendingDatagram> datagrams = std::move(pending_datagrams_);
+  pending_datagrams_.clear();
+  if (datagrams.empty() && nread == 0) return;
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  InternalCallbackScope callback_scope(
+      this, InternalCallbackScope::kBatchTaskQueues);
+  for (PendingDatagram& datagram : datagrams) {
+    if (IsHandleClosing()) return;
+    ssize_t length = datagram.store->ByteLength();
+    EmitMessage(length, std::move(datagram.store), datagram.address.data());
+  }
+  if (nread < 0 && !IsHandleClosing())
+    EmitMessage(nread, nullptr, nullptr);
 }
 
 void UDPWrap::OnRecv(ssize_t nread,
@@ -749,7 +1065,31 @@ void UDPWrap::OnRecv(ssize_t nread,
   if (nread == 0 && addr == nullptr) {
     return;
   }
+  if (nread > 0 && (flags & UV_UDP_PARTIAL)) {
+    Debug(this, "dropping a truncated datagram of %d bytes", nread);
+    return;
+  }
 
+  if (nread > 0 && static_cast<size_t>(nread) != bs->ByteLength()) {
+    CHECK_LE(static_cast<size_t>(nread), bs->ByteLength());
+    std::unique_ptr<BackingStore> old_bs = std::move(bs);
+    bs = ArrayBuffer::NewBackingStore(isolate, nread);
+    memcpy(static_cast<char*>(bs->Data()),
+           static_cast<char*>(old_bs->Data()),
+           nread);
+  }
+
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+  BatchTaskQueuesScope batch_scope(this);
+  EmitMessage(nread, std::move(bs), addr);
+}
+
+void UDPWrap::EmitMessage(ssize_t nread,
+                          std::unique_ptr<BackingStore> bs,
+                          const sockaddr* addr) {
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
   HandleScope handle_scope(isolate);
   Context::Scope context_scope(env->context());
 
@@ -764,13 +1104,6 @@ void UDPWrap::OnRecv(ssize_t nread,
     return;
   } else if (nread == 0) {
     bs = ArrayBuffer::NewBackingStore(isolate, 0);
-  } else if (static_cast<size_t>(nread) != bs->ByteLength()) {
-    CHECK_LE(static_cast<size_t>(nread), bs->ByteLength());
-    std::unique_ptr<BackingStore> old_bs = std::move(bs);
-    bs = ArrayBuffer::NewBackingStore(isolate, nread);
-    memcpy(static_cast<char*>(bs->Data()),
-           static_cast<char*>(old_bs->Data()),
-           nread);
   }
 
   Local<Object> address;
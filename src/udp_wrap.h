@@ -30,6 +30,10 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace node {
 
 class ExternalReferenceRegistry;
@@ -138,6 +142,10 @@ class UDPWrap final : public HandleWrap,
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void TrySend(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void TrySend6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Disconnect(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void AddMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DropMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -197,6 +205,37 @@ class UDPWrap final : public HandleWrap,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
+  static void DoTrySend(const v8::FunctionCallbackInfo<v8::Value>& args,
+                        int family);
+
+  // Parses `address` and `port` into a sockaddr, or returns the one that was
+  // parsed for an earlier datagram to the same destination. The result stays
+  // valid until the next call.
+  int GetDestination(int family,
+                     v8::Local<v8::Value> address,
+                     unsigned short port,
+                     const sockaddr** addr);
+
+  // Writes as many of the `count` datagrams in `bufs` as the socket accepts
+  // without blocking, using a single UDP GSO sendmsg() when `segment_size`
+  // allows it and sendmmsg() otherwise. Returns the number of datagrams
+  // that were sent, or a libuv error code.
+  ssize_t TrySendBatch(uv_buf_t* bufs,
+                       size_t count,
+                       size_t segment_size,
+                       const sockaddr* addr);
+
+  // Handles a datagram (or the end of a batch) that libuv read into the
+  // Environment's UDP batch buffer.
+  void OnBatchRecv(ssize_t nread,
+                   const uv_buf_t& buf,
+                   const sockaddr* addr,
+                   unsigned int flags);
+  void EmitMessage(ssize_t nread,
+                   std::unique_ptr<v8::BackingStore> bs,
+                   const sockaddr* addr);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
   static void SetSourceMembership(
@@ -214,6 +253,27 @@ class UDPWrap final : public HandleWrap,
 
   uv_udp_t handle_;
 
+  // Datagrams from the current recvmmsg() batch. They are emitted together,
+  // inside a single callback scope, once libuv reports the end of the batch.
+  struct PendingDatagram {
+    std::unique_ptr<v8::BackingStore> store;
+    SocketAddress address;
+  };
+  std::vector<PendingDatagram> pending_datagrams_;
+
+  // The destinations that were sent to last, so that clients that talk to a
+  // few fixed addresses, like DNS resolvers or StatsD agents, do not parse
+  // them again for every datagram.
+  struct Destination {
+    int family = AF_UNSPEC;
+    unsigned short port = 0;
+    std::string address;
+    sockaddr_storage storage;
+  };
+  static constexpr size_t kDestinationCacheSize = 4;
+  Destination destinations_[kDestinationCacheSize];
+  size_t next_destination_ = 0;
+
   bool current_send_has_callback_;
   v8::Local<v8::Object> current_send_req_wrap_;
 };
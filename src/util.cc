@@ -34,6 +34,8 @@
 #include "string_bytes.h"
 #include "v8-value.h"
 
+#include "brotli/decode.h"
+
 #ifdef _WIN32
 #include <io.h>  // _S_IREAD _S_IWRITE
 #include <time.h>
@@ -699,6 +701,44 @@ void SetConstructorFunction(Isolate* isolate,
   that->Set(name, tmpl);
 }
 
+namespace {
+// Serializes the first decompression of every CompressedExternalByteResource.
+Mutex compressed_resource_mutex;
+}  // anonymous namespace
+
+template <typename IChar, typename Base>
+const IChar* CompressedExternalByteResource<IChar, Base>::data() const {
+  IChar* data = data_.load(std::memory_order_acquire);
+  if (LIKELY(data != nullptr)) return data;
+
+  Mutex::ScopedLock lock(compressed_resource_mutex);
+  data = data_.load(std::memory_order_relaxed);
+  if (data != nullptr) return data;
+
+  // The data was compressed at build time, so this cannot fail.
+  data = new IChar[length_];
+  size_t decompressed_length = length_ * sizeof(IChar);
+  CHECK_EQ(BrotliDecoderDecompress(compressed_length_,
+                                   compressed_,
+                                   &decompressed_length,
+                                   reinterpret_cast<uint8_t*>(data)),
+           BROTLI_DECODER_RESULT_SUCCESS);
+  CHECK_EQ(decompressed_length, length_ * sizeof(IChar));
+  // Two-byte sources are compressed as UTF-16LE.
+  if constexpr (sizeof(IChar) == 2 && IsBigEndian()) {
+    SwapBytes16(reinterpret_cast<char*>(data), decompressed_length);
+  }
+  data_.store(data, std::memory_order_release);
+  return data;
+}
+
+template class CompressedExternalByteResource<
+    char,
+    v8::String::ExternalOneByteStringResource>;
+template class CompressedExternalByteResource<
+    uint16_t,
+    v8::String::ExternalStringResource>;
+
 Local<String> UnionBytes::ToStringChecked(Isolate* isolate) const {
   if (is_one_byte()) {
     return String::NewExternalOneByte(isolate, one_byte_resource_)
@@ -327,6 +327,11 @@ class KVStore {
                                  v8::Local<v8::Object> object);
 
   static std::shared_ptr<KVStore> CreateMapKVStore();
+  // Returns a store that reads through to `base` and falls back to
+  // `defaults` for the keys that `base` does not have. Writes go to `base`.
+  static std::shared_ptr<KVStore> CreateLayeredKVStore(
+      std::shared_ptr<KVStore> base,
+      std::unordered_map<std::string, std::string> defaults);
 };
 
 // Convenience wrapper around v8::String::NewFromOneByte().
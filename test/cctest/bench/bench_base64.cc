@@ -0,0 +1,63 @@
+#include "base64-inl.h"
+#include "encoding_binding.h"
+#include "gtest/gtest.h"
+#include "node_bench.h"
+#include "simdutf.h"
+
+#include <string>
+
+using node::encoding_binding::Base64StreamEncoder;
+using node_bench::DoNotOptimize;
+using node_bench::Measure;
+
+static std::string MakeBytes(size_t length) {
+  std::string bytes(length, '\0');
+  for (size_t i = 0; i < length; i++)
+    bytes[i] = static_cast<char>(i * 37 + 11);
+  return bytes;
+}
+
+static std::string ToBase64(const std::string& bytes) {
+  std::string base64(simdutf::base64_length_from_binary(bytes.size()), '\0');
+  simdutf::binary_to_base64(bytes.data(), bytes.size(), base64.data());
+  return base64;
+}
+
+static const size_t kLengths[] = {64, 16 * 1024};
+
+TEST(Base64, Decode) {
+  for (size_t length : kLengths) {
+    const std::string base64 = ToBase64(MakeBytes(length));
+    std::string out(length, '\0');
+    Measure(std::to_string(length), length, [&]() {
+      DoNotOptimize(node::base64_decode(
+          out.data(), out.size(), base64.data(), base64.size()));
+    });
+  }
+}
+
+TEST(Base64, DecodeWithWhitespace) {
+  // Line breaks every 76 characters, as MIME does, take the slow path.
+  const std::string base64 = ToBase64(MakeBytes(16 * 1024));
+  std::string wrapped;
+  for (size_t i = 0; i < base64.size(); i += 76)
+    wrapped += base64.substr(i, 76) + "\r\n";
+  std::string out(16 * 1024, '\0');
+  Measure("16384", out.size(), [&]() {
+    DoNotOptimize(node::base64_decode(
+        out.data(), out.size(), wrapped.data(), wrapped.size()));
+  });
+}
+
+TEST(Base64, StreamEncode) {
+  for (size_t length : kLengths) {
+    const std::string bytes = MakeBytes(length);
+    Base64StreamEncoder sizer(false);
+    std::string out(sizer.EncodedLength(length, true), '\0');
+    Measure(std::to_string(length), length, [&]() {
+      Base64StreamEncoder encoder(false);
+      DoNotOptimize(
+          encoder.Encode(bytes.data(), bytes.size(), true, out.data()));
+    });
+  }
+}
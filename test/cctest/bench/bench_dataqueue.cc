@@ -0,0 +1,85 @@
+#include "dataqueue/queue.h"
+#include "gtest/gtest.h"
+#include "node_bench.h"
+#include "node_bob-inl.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <memory>
+#include <vector>
+
+using node::DataQueue;
+using node_bench::DoNotOptimize;
+using node_bench::Measure;
+using v8::ArrayBuffer;
+using v8::BackingStore;
+
+// An idempotent queue of |count| in-memory entries of |length| bytes each,
+// like a Blob made of many parts.
+static std::shared_ptr<DataQueue> MakeQueue(std::vector<char>* buffer,
+                                            size_t count,
+                                            size_t length) {
+  buffer->assign(length, 'x');
+  std::shared_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(
+      buffer->data(), length, [](void*, size_t, void*) {}, nullptr);
+  std::vector<std::unique_ptr<DataQueue::Entry>> entries;
+  for (size_t i = 0; i < count; i++) {
+    entries.push_back(
+        DataQueue::CreateInMemoryEntryFromBackingStore(store, 0, length));
+  }
+  std::shared_ptr<DataQueue> queue =
+      DataQueue::CreateIdempotent(std::move(entries));
+  CHECK(queue);
+  return queue;
+}
+
+// Reads all of the queue, as a Blob that is streamed does.
+static void ReadQueue(size_t count, size_t length) {
+  std::vector<char> buffer;
+  std::shared_ptr<DataQueue> queue = MakeQueue(&buffer, count, length);
+
+  Measure(std::to_string(count) + "x" + std::to_string(length),
+          count * length,
+          [&]() {
+            std::shared_ptr<DataQueue::Reader> reader = queue->get_reader();
+            int status;
+            do {
+              status = reader->Pull(
+                  [](int, const DataQueue::Vec* vecs, size_t n, auto done) {
+                    if (n == 0) return;
+                    DoNotOptimize(vecs[0].base[0]);
+                    std::move(done)(0);
+                  },
+                  node::bob::OPTIONS_SYNC,
+                  nullptr,
+                  0,
+                  node::bob::kMaxCountHint);
+            } while (status == node::bob::STATUS_CONTINUE);
+            CHECK_EQ(status, node::bob::STATUS_EOS);
+          });
+}
+
+TEST(DataQueue, ReadInMemory) {
+  ReadQueue(1, 64 * 1024);
+  ReadQueue(64, 1024);
+}
+
+TEST(DataQueue, Slice) {
+  std::vector<char> buffer;
+  std::shared_ptr<DataQueue> queue = MakeQueue(&buffer, 4096, 1024);
+  const uint64_t middle = queue->size().value() / 2;
+
+  // A part in the middle of a multipart body, as a parser slices it out.
+  Measure("4096x1024/small", 0, [&]() {
+    DoNotOptimize(queue->slice(middle + 100, middle + 400));
+  });
+  Measure("4096x1024/half", 0, [&]() {
+    DoNotOptimize(queue->slice(middle));
+  });
+  // Each part of a body that is sliced again after every part.
+  Measure("4096x1024/chain", 0, [&]() {
+    std::shared_ptr<DataQueue> rest = queue;
+    for (int i = 0; i < 16; i++) rest = rest->slice(1000);
+    DoNotOptimize(rest);
+  });
+}
@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "node_bench.h"
+#include "permission/fs_permission.h"
+
+#include <string>
+#include <vector>
+
+using node::permission::FSPermission;
+using node::permission::PermissionScope;
+using node_bench::DoNotOptimize;
+using node_bench::Measure;
+
+#ifndef _WIN32
+// The kind of paths granted with --allow-fs-read for a project: its own
+// directory, a few dependencies and some single files.
+static std::vector<std::string> GrantedPaths() {
+  std::vector<std::string> paths = {
+      "/home/user/project/*",
+      "/etc/ssl/certs/*",
+      "/tmp/app-*",
+  };
+  for (int i = 0; i < 32; i++) {
+    paths.push_back("/opt/lib/module" + std::to_string(i) + "/*");
+    paths.push_back("/var/data/file" + std::to_string(i) + ".json");
+  }
+  return paths;
+}
+
+static const std::pair<const char*, const char*> kPaths[] = {
+    {"granted", "/home/user/project/node_modules/pkg/lib/index.js"},
+    {"file", "/var/data/file17.json"},
+    {"denied", "/home/user/other/index.js"},
+};
+
+TEST(FSPermission, RadixTreeLookup) {
+  FSPermission::RadixTree tree;
+  for (const std::string& path : GrantedPaths()) tree.Insert(path);
+
+  for (const auto& [label, path] : kPaths) {
+    const std::string string = path;
+    Measure(label, 0, [&]() { DoNotOptimize(tree.Lookup(string)); });
+  }
+}
+
+TEST(FSPermission, IsGranted) {
+  // Absolute paths are resolved without looking at the Environment.
+  FSPermission permission;
+  permission.Apply(
+      nullptr, GrantedPaths(), PermissionScope::kFileSystemRead);
+
+  for (const auto& [label, path] : kPaths) {
+    const std::string string = path;
+    Measure(label, 0, [&]() {
+      DoNotOptimize(permission.is_granted(
+          nullptr, PermissionScope::kFileSystemRead, string));
+    });
+  }
+}
+#endif  // _WIN32
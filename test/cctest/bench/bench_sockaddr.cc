@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "node_bench.h"
+#include "node_sockaddr-inl.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+using node::SocketAddress;
+using node::SocketAddressBlockList;
+using node_bench::DoNotOptimize;
+using node_bench::Measure;
+
+static std::shared_ptr<SocketAddress> MakeAddress(int family,
+                                                  const std::string& host) {
+  sockaddr_storage storage;
+  CHECK(SocketAddress::ToSockAddr(family, host.c_str(), 0, &storage));
+  return std::make_shared<SocketAddress>(
+      reinterpret_cast<const sockaddr*>(&storage));
+}
+
+// A list the size of what a server that blocks abusive networks might use:
+// single addresses, subnets and ranges of both families.
+static void AddRules(SocketAddressBlockList* list) {
+  for (int i = 0; i < 64; i++) {
+    std::string octet = std::to_string(i);
+    list->AddSocketAddress(MakeAddress(AF_INET, "203.0.113." + octet));
+    list->AddSocketAddressMask(MakeAddress(AF_INET, "10." + octet + ".0.0"),
+                               16);
+    list->AddSocketAddressRange(
+        MakeAddress(AF_INET, "198.51." + octet + ".10"),
+        MakeAddress(AF_INET, "198.51." + octet + ".20"));
+    list->AddSocketAddressMask(
+        MakeAddress(AF_INET6, "2001:db8:" + octet + "::"), 48);
+  }
+}
+
+static const std::pair<const char*, const char*> kAddresses[] = {
+    {"miss4", "192.0.2.1"},
+    {"hit4", "10.42.1.1"},
+    {"miss6", "2001:db9::1"},
+    {"hit6", "2001:db8:42::1"},
+};
+
+TEST(SocketAddressBlockList, Apply) {
+  for (bool compiled : {false, true}) {
+    SocketAddressBlockList list;
+    if (compiled) list.Compile();
+    AddRules(&list);
+
+    for (const auto& [label, host] : kAddresses) {
+      std::shared_ptr<SocketAddress> address =
+          MakeAddress(strchr(host, ':') ? AF_INET6 : AF_INET, host);
+      Measure(std::string(compiled ? "compiled/" : "linear/") + label,
+              0,
+              [&]() { DoNotOptimize(list.Apply(address)); });
+    }
+  }
+}
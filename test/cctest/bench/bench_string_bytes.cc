@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+#include "node_bench.h"
+#include "node_test_fixture.h"
+#include "string_bytes.h"
+#include "v8.h"
+
+#include <string>
+
+using node::StringBytes;
+using node_bench::DoNotOptimize;
+using node_bench::Measure;
+
+class StringBytesBench : public NodeTestFixture {};
+
+static std::string MakeBytes(size_t length, bool ascii) {
+  std::string bytes(length, '\0');
+  for (size_t i = 0; i < length; i++)
+    bytes[i] = static_cast<char>((i * 37 + 11) & (ascii ? 0x7f : 0xff));
+  return bytes;
+}
+
+static const size_t kLengths[] = {64, 16 * 1024};
+
+static const struct {
+  const char* name;
+  node::encoding encoding;
+} kEncodings[] = {
+    {"latin1", node::LATIN1},
+    {"utf8", node::UTF8},
+    {"hex", node::HEX},
+    {"base64", node::BASE64},
+};
+
+TEST_F(StringBytesBench, Encode) {
+  v8::Isolate::Scope isolate_scope(isolate_);
+  v8::HandleScope handle_scope(isolate_);
+  v8::Local<v8::Context> context = v8::Context::New(isolate_);
+  v8::Context::Scope context_scope(context);
+
+  for (const auto& encoding : kEncodings) {
+    for (size_t length : kLengths) {
+      const std::string bytes = MakeBytes(length, true);
+      Measure(std::string(encoding.name) + "/" + std::to_string(length),
+              length,
+              [&]() {
+                // Every call creates a string, so they need to be freed.
+                v8::HandleScope scope(isolate_);
+                v8::Local<v8::Value> error;
+                DoNotOptimize(StringBytes::Encode(isolate_,
+                                                  bytes.data(),
+                                                  bytes.size(),
+                                                  encoding.encoding,
+                                                  &error));
+              });
+    }
+  }
+}
+
+TEST_F(StringBytesBench, Write) {
+  v8::Isolate::Scope isolate_scope(isolate_);
+  v8::HandleScope handle_scope(isolate_);
+  v8::Local<v8::Context> context = v8::Context::New(isolate_);
+  v8::Context::Scope context_scope(context);
+
+  for (const auto& encoding : kEncodings) {
+    for (size_t length : kLengths) {
+      const std::string bytes = MakeBytes(length, true);
+      v8::Local<v8::Value> error;
+      v8::Local<v8::Value> string =
+          StringBytes::Encode(
+              isolate_, bytes.data(), bytes.size(), encoding.encoding, &error)
+              .ToLocalChecked();
+      size_t storage =
+          StringBytes::StorageSize(isolate_, string, encoding.encoding)
+              .FromJust();
+      std::string out(storage, '\0');
+      Measure(std::string(encoding.name) + "/" + std::to_string(length),
+              length,
+              [&]() {
+                DoNotOptimize(StringBytes::Write(isolate_,
+                                                 out.data(),
+                                                 out.size(),
+                                                 string,
+                                                 encoding.encoding));
+              });
+    }
+  }
+}
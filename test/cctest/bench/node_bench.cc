@@ -0,0 +1,153 @@
+#include "node_bench.h"
+#include "gtest/gtest.h"
+#include "json_utils.h"
+#include "util.h"
+#include "uv.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace node_bench {
+
+namespace {
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  double real_time_ns;  // Per iteration.
+  double cpu_time_ns;   // Per iteration.
+  uint64_t bytes_per_iteration;
+};
+
+constexpr uint64_t kMaxIterations = 1000000000;
+
+double min_time_ns = 0.5e9;
+std::vector<Result> results;
+
+uint64_t CPUTime() {
+  uv_rusage_t usage;
+  CHECK_EQ(uv_getrusage(&usage), 0);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ull +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ull;
+}
+
+void WriteJSON(std::ostream& out, const char* executable) {
+  node::JSONWriter writer(out, false);
+  writer.json_start();
+  writer.json_objectstart("context");
+  writer.json_keyvalue("executable", executable);
+  writer.json_keyvalue("num_cpus", uv_available_parallelism());
+#ifdef DEBUG
+  writer.json_keyvalue("library_build_type", "debug");
+#else
+  writer.json_keyvalue("library_build_type", "release");
+#endif
+  writer.json_objectend();
+  writer.json_arraystart("benchmarks");
+  for (const Result& result : results) {
+    writer.json_start();
+    writer.json_keyvalue("name", result.name);
+    writer.json_keyvalue("run_name", result.name);
+    writer.json_keyvalue("run_type", "iteration");
+    writer.json_keyvalue("iterations", result.iterations);
+    writer.json_keyvalue("real_time", result.real_time_ns);
+    writer.json_keyvalue("cpu_time", result.cpu_time_ns);
+    writer.json_keyvalue("time_unit", "ns");
+    if (result.bytes_per_iteration > 0) {
+      writer.json_keyvalue(
+          "bytes_per_second",
+          result.bytes_per_iteration * 1e9 / result.real_time_ns);
+    }
+    writer.json_end();
+  }
+  writer.json_arrayend();
+  writer.json_objectend();
+}
+
+}  // anonymous namespace
+
+#if defined(_MSC_VER)
+void UseCharPointer(const volatile char* pointer) {}
+#endif
+
+void MeasureBatches(const std::string& label,
+                    uint64_t bytes_per_iteration,
+                    const std::function<void(uint64_t iterations)>& batch) {
+  const ::testing::TestInfo* test =
+      ::testing::UnitTest::GetInstance()->current_test_info();
+  CHECK_NOT_NULL(test);
+  std::string name = std::string(test->test_suite_name()) + "/" + test->name();
+  if (!label.empty()) name += "/" + label;
+
+  // Warm up caches and lazily initialized state before timing anything.
+  batch(1);
+
+  uint64_t iterations = 1;
+  while (true) {
+    uint64_t cpu_start = CPUTime();
+    uint64_t start = uv_hrtime();
+    batch(iterations);
+    double elapsed = static_cast<double>(uv_hrtime() - start);
+    double cpu_elapsed = static_cast<double>(CPUTime() - cpu_start);
+
+    if (elapsed >= min_time_ns || iterations >= kMaxIterations) {
+      results.push_back({name,
+                         iterations,
+                         elapsed / iterations,
+                         cpu_elapsed / iterations,
+                         bytes_per_iteration});
+      printf("%-56s %12.1f ns %12.1f ns %12" PRIu64 "\n",
+             name.c_str(),
+             elapsed / iterations,
+             cpu_elapsed / iterations,
+             iterations);
+      return;
+    }
+
+    // Aim a little past the minimum time, but grow by at most 10x at a time
+    // in case this batch was unusually fast.
+    double scale = elapsed > 0 ? min_time_ns * 1.4 / elapsed : 10;
+    iterations = std::min<uint64_t>(
+        kMaxIterations,
+        std::max<uint64_t>(
+            iterations + 1,
+            static_cast<uint64_t>(iterations * std::min(scale, 10.0))));
+  }
+}
+
+}  // namespace node_bench
+
+int main(int argc, char* argv[]) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  const char* out_path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--benchmark_out=", 16) == 0) {
+      out_path = argv[i] + 16;
+    } else if (strncmp(argv[i], "--benchmark_min_time=", 21) == 0) {
+      node_bench::min_time_ns = strtod(argv[i] + 21, nullptr) * 1e9;
+    } else {
+      fprintf(stderr, "%s: unknown option %s\n", argv[0], argv[i]);
+      return 1;
+    }
+  }
+
+  printf("%-56s %15s %15s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+  int exit_code = RUN_ALL_TESTS();
+
+  if (out_path != nullptr) {
+    std::ofstream out(out_path);
+    node_bench::WriteJSON(out, argv[0]);
+    if (!out) {
+      fprintf(stderr, "%s: could not write %s\n", argv[0], out_path);
+      return 1;
+    }
+  }
+  return exit_code;
+}
@@ -0,0 +1,58 @@
+#ifndef TEST_CCTEST_BENCH_NODE_BENCH_H_
+#define TEST_CCTEST_BENCH_NODE_BENCH_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+
+// A small harness for benchmarking the C++ hot paths in src/. Benchmarks are
+// gtest tests, so that they can use the fixtures of node_test_fixture.h, and
+// each of them times its operations with node_bench::Measure(). The results
+// are written in the JSON format of Google Benchmark, so that its tools can
+// be used to compare two runs:
+//
+//   $ out/Release/node_bench_native --benchmark_out=before.json
+//   $ compare.py benchmarks before.json after.json
+namespace node_bench {
+
+// Keeps the compiler from optimizing away the computation of |value|.
+#if defined(_MSC_VER)
+void UseCharPointer(const volatile char* pointer);
+
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  UseCharPointer(reinterpret_cast<const volatile char*>(&value));
+}
+#else
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+#endif
+
+// Calls |batch| with increasing numbers of iterations until a batch takes
+// at least the minimum time, and records the time per iteration under the
+// name of the current test, followed by "/" and |label| if it is not empty.
+// |bytes_per_iteration| is used to report the throughput.
+void MeasureBatches(const std::string& label,
+                    uint64_t bytes_per_iteration,
+                    const std::function<void(uint64_t iterations)>& batch);
+
+template <typename Fn>
+inline void Measure(const std::string& label,
+                    uint64_t bytes_per_iteration,
+                    Fn&& op) {
+  MeasureBatches(label, bytes_per_iteration, [&](uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; i++) op();
+  });
+}
+
+template <typename Fn>
+inline void Measure(Fn&& op) {
+  Measure("", 0, std::forward<Fn>(op));
+}
+
+}  // namespace node_bench
+
+#endif  // TEST_CCTEST_BENCH_NODE_BENCH_H_
@@ -42,5 +42,33 @@ void NodeTestEnvironment::TearDown() {
   NodeZeroIsolateTestFixture::tracing_agent.reset(nullptr);
 }
 
+std::string EnvironmentTestFixture::RunScriptAndGetResult(
+    const Env& env,
+    const std::string& script,
+    const std::function<void()>& after_load) {
+  (*env)->options()->expose_internals = true;
+  std::string source =
+      "const { internalBinding } = require('internal/test/binding');\n";
+  source += script;
+  node::LoadEnvironment(*env, source.c_str()).ToLocalChecked();
+  if (after_load) after_load();
+  EXPECT_EQ(node::SpinEventLoop(*env).FromJust(), 0);
+
+  v8::Local<v8::Context> context = env.context();
+  v8::Local<v8::Value> result =
+      context->Global()
+          ->Get(context, v8::String::NewFromUtf8Literal(isolate_, "result"))
+          .ToLocalChecked();
+  return *node::Utf8Value(isolate_, result);
+}
+
+std::string EnvironmentTestFixture::RunScriptAndGetResult(
+    const std::string& script) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  return RunScriptAndGetResult(env, script);
+}
+
 ::testing::Environment* const node_env =
 ::testing::AddGlobalTestEnvironment(new NodeTestEnvironment());
@@ -2,7 +2,9 @@
 #define TEST_CCTEST_NODE_TEST_FIXTURE_H_
 
 #include <cstdlib>
+#include <functional>
 #include <memory>
+#include <string>
 #include "gtest/gtest.h"
 #include "node.h"
 #include "node_platform.h"
@@ -191,6 +193,17 @@ class EnvironmentTestFixture : public NodeTestFixture {
     v8::Local<v8::Context> context_;
     node::Environment* environment_;
   };
+
+  // Runs `script` in `env` until its event loop is empty, and returns what
+  // the script left in globalThis.result. The script can require internal
+  // modules, and has `internalBinding` in scope. `after_load` is called once
+  // the script has run, before the event loop does.
+  std::string RunScriptAndGetResult(
+      const Env& env,
+      const std::string& script,
+      const std::function<void()>& after_load = nullptr);
+  // The same, in an Environment of its own.
+  std::string RunScriptAndGetResult(const std::string& script);
 };
 
 #endif  // TEST_CCTEST_NODE_TEST_FIXTURE_H_
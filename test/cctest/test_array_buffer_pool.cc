@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "node_array_buffer_pool.h"
+#include "uv.h"
+
+#include <cstring>
+#include <vector>
+
+using node::ArrayBufferPool;
+
+TEST(ArrayBufferPool, SizeClasses) {
+  EXPECT_EQ(ArrayBufferPool::SizeClassOf(ArrayBufferPool::kMinSize), 0u);
+  EXPECT_EQ(ArrayBufferPool::ClassSize(0), ArrayBufferPool::kMinSize);
+  EXPECT_EQ(ArrayBufferPool::SizeClassOf(ArrayBufferPool::kMaxSize),
+            ArrayBufferPool::kNumClasses - 1);
+  EXPECT_EQ(ArrayBufferPool::ClassSize(ArrayBufferPool::kNumClasses - 1),
+            ArrayBufferPool::kMaxSize);
+  EXPECT_EQ(ArrayBufferPool::ClassSize(ArrayBufferPool::SizeClassOf(513)),
+            640u);
+  EXPECT_EQ(ArrayBufferPool::ClassSize(ArrayBufferPool::SizeClassOf(4096)),
+            4096u);
+  EXPECT_EQ(ArrayBufferPool::ClassSize(ArrayBufferPool::SizeClassOf(4097)),
+            5120u);
+
+  // Every size gets the smallest class that fits, which wastes no more than
+  // a quarter of it.
+  size_t previous = 0;
+  for (size_t size = ArrayBufferPool::kMinSize + 1;
+       size <= ArrayBufferPool::kMaxSize;
+       size++) {
+    size_t size_class = ArrayBufferPool::SizeClassOf(size);
+    size_t class_size = ArrayBufferPool::ClassSize(size_class);
+    ASSERT_GE(class_size, size);
+    ASSERT_LT(ArrayBufferPool::ClassSize(size_class - 1), size);
+    ASSERT_LT(class_size - size, class_size / 4);
+    ASSERT_GE(size_class, previous);
+    previous = size_class;
+  }
+}
+
+#ifndef _WIN32
+TEST(ArrayBufferPool, AllocateAndTrim) {
+  ArrayBufferPool* pool = ArrayBufferPool::Get();
+  if (pool == nullptr) GTEST_SKIP();
+  pool->Trim();
+  ArrayBufferPool::Stats before = pool->GetStats();
+
+  std::vector<char*> buffers;
+  for (int i = 0; i < 1000; i++) {
+    char* data = static_cast<char*>(pool->Allocate(3000));
+    ASSERT_NE(data, nullptr);
+    memset(data, i & 0xff, 3000);
+    buffers.push_back(data);
+  }
+  ArrayBufferPool::Stats live = pool->GetStats();
+  EXPECT_EQ(live.used_bytes - before.used_bytes, 1000u * 3072);
+  EXPECT_GE(live.mapped_bytes - before.mapped_bytes, 1000u * 3072);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(buffers[i][0], static_cast<char>(i & 0xff));
+    EXPECT_EQ(buffers[i][2999], static_cast<char>(i & 0xff));
+  }
+
+  // Freed objects come back first.
+  pool->Free(buffers.back(), 3000);
+  EXPECT_EQ(pool->Allocate(3000), buffers.back());
+
+  for (char* data : buffers) pool->Free(data, 3000);
+  EXPECT_EQ(pool->GetStats().used_bytes, before.used_bytes);
+  pool->Trim();
+  ArrayBufferPool::Stats after = pool->GetStats();
+  EXPECT_EQ(after.mapped_bytes, before.mapped_bytes);
+  EXPECT_GT(after.released_slabs, before.released_slabs);
+}
+
+TEST(ArrayBufferPool, FreeOnOtherThread) {
+  ArrayBufferPool* pool = ArrayBufferPool::Get();
+  if (pool == nullptr) GTEST_SKIP();
+  pool->Trim();
+  ArrayBufferPool::Stats before = pool->GetStats();
+
+  struct Data {
+    ArrayBufferPool* pool;
+    std::vector<void*> buffers;
+  } data{pool, {}};
+  for (int i = 0; i < 500; i++)
+    data.buffers.push_back(pool->Allocate(16 * 1024));
+
+  // The objects end up in the cache of the other thread, which returns them
+  // to the pool when it exits.
+  uv_thread_t thread;
+  ASSERT_EQ(uv_thread_create(
+                &thread,
+                [](void* arg) {
+                  Data* data = static_cast<Data*>(arg);
+                  for (void* buffer : data->buffers)
+                    data->pool->Free(buffer, 16 * 1024);
+                },
+                &data),
+            0);
+  ASSERT_EQ(uv_thread_join(&thread), 0);
+
+  EXPECT_EQ(pool->GetStats().used_bytes, before.used_bytes);
+  pool->Trim();
+  EXPECT_EQ(pool->GetStats().mapped_bytes, before.mapped_bytes);
+}
+#endif  // _WIN32
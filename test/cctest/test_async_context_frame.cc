@@ -0,0 +1,49 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class AsyncContextFrameTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `get` and `set` bound to the accessors of the async
+  // context frame, and returns what it left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const {\n"
+        "  getContinuationPreservedEmbedderData: get,\n"
+        "  setContinuationPreservedEmbedderData: set,\n"
+        "} = internalBinding('async_context_frame');\n"
+        "const fs = require('fs');\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// The callback of a native request runs with the frame that was current
+// when the request was made, and the frame of the event loop is restored
+// once it returns.
+TEST_F(AsyncContextFrameTest, CallbacksRunInTheirFrame) {
+  EXPECT_EQ(Run("const out = [];\n"
+                "set('first');\n"
+                "fs.stat('.', () => {\n"
+                "  out.push(get());\n"
+                "  set('inner');\n"
+                "  fs.stat('.', () => out.push(get()));\n"
+                "});\n"
+                "set('loop');\n"
+                "process.on('exit', () => {\n"
+                "  out.push(get());\n"
+                "  globalThis.result = out.join();\n"
+                "});"),
+            "first,inner,loop");
+}
+
+// A request made while no frame was set does not see the frame that
+// happens to be current when its callback runs.
+TEST_F(AsyncContextFrameTest, CallbacksWithoutFrame) {
+  EXPECT_EQ(Run("fs.stat('.', () => {\n"
+                "  globalThis.result = `${get()}`;\n"
+                "});\n"
+                "set('loop');"),
+            "undefined");
+}
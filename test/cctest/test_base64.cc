@@ -1,12 +1,16 @@
 #include "base64-inl.h"
+#include "encoding_binding.h"
 #include "simdutf.h"
 
 #include <cstddef>
 #include <cstring>
+#include <string>
 
 #include "gtest/gtest.h"
 
 using node::base64_decode;
+using node::encoding_binding::Base64StreamDecoder;
+using node::encoding_binding::Base64StreamEncoder;
 
 TEST(Base64Test, Encode) {
   auto test = [](const char* string, const char* base64_string) {
@@ -147,3 +151,96 @@ TEST(Base64Test, Decode) {
        "dCBjdXBpZGF0YXQgbm9uIHByb2lkZW50LCBzdW50IGluIGN1bHBhIHF1aSBvZmZpY2lh\n"
        "IGRlc2VydW50IG1vbGxpdCBhbmltIGlkIGVzdCBsYWJvcnVtLg", text);
 }
+
+TEST(Base64Test, StreamEncoder) {
+  const std::string input = "The quick brown fox jumps over the lazy dog.";
+  for (bool url : {false, true}) {
+    std::string expected(simdutf::base64_length_from_binary(
+                             input.size(),
+                             url ? simdutf::base64_url
+                                 : simdutf::base64_default),
+                         '\0');
+    simdutf::binary_to_base64(input.data(),
+                              input.size(),
+                              expected.data(),
+                              url ? simdutf::base64_url
+                                  : simdutf::base64_default);
+
+    // Each split of the input into three chunks yields the same output.
+    for (size_t i = 0; i <= input.size(); i++) {
+      for (size_t j = i; j <= input.size(); j++) {
+        Base64StreamEncoder encoder(url);
+        std::string output;
+        auto encode = [&](size_t start, size_t end, bool final) {
+          size_t length = encoder.EncodedLength(end - start, final);
+          std::string chunk(length, '\0');
+          EXPECT_EQ(encoder.Encode(
+                        input.data() + start, end - start, final, chunk.data()),
+                    length);
+          output += chunk;
+        };
+        encode(0, i, false);
+        encode(i, j, false);
+        encode(j, input.size(), true);
+        EXPECT_EQ(output, expected) << url << " " << i << " " << j;
+      }
+    }
+  }
+}
+
+TEST(Base64Test, StreamDecoder) {
+  auto decode = [](const std::string& input, size_t i, size_t j,
+                   std::string* output) {
+    Base64StreamDecoder decoder(false);
+    output->clear();
+    auto chunk = [&](size_t start, size_t end, bool final) {
+      std::string out(Base64StreamDecoder::MaxDecodedLength(
+                          input.data() + start, end - start),
+                      '\0');
+      size_t written;
+      if (!decoder.Decode(
+              input.data() + start, end - start, final, out.data(), &written)) {
+        return false;
+      }
+      output->append(out.data(), written);
+      return true;
+    };
+    return chunk(0, i, false) && chunk(i, j, false) &&
+           chunk(j, input.size(), true);
+  };
+
+  auto test = [&](const std::string& input, const std::string& expected) {
+    for (size_t i = 0; i <= input.size(); i++) {
+      for (size_t j = i; j <= input.size(); j++) {
+        std::string output;
+        EXPECT_TRUE(decode(input, i, j, &output))
+            << input << " " << i << " " << j;
+        EXPECT_EQ(output, expected) << input << " " << i << " " << j;
+      }
+    }
+  };
+  test("", "");
+  test("YQ==", "a");
+  test("YQ", "a");
+  test("YWI=", "ab");
+  test("YWJj", "abc");
+  test("YWJjZA==", "abcd");
+  test(" YW\nJj ZGU =\r\n", "abcde");
+  test("VGhlIHF1aWNrIGJyb3duIGZveA==", "The quick brown fox");
+
+  auto fails = [&](const std::string& input) {
+    for (size_t i = 0; i <= input.size(); i++) {
+      for (size_t j = i; j <= input.size(); j++) {
+        std::string output;
+        EXPECT_FALSE(decode(input, i, j, &output))
+            << input << " " << i << " " << j;
+      }
+    }
+  };
+  fails("Y");
+  fails("YWJjZ");
+  fails("YQ=");
+  fails("YQ===");
+  fails("YQ==YQ==");
+  fails("YWJj*");
+}
@@ -188,3 +188,39 @@ TEST_F(BaseObjectPtrTest, NestedClasses) {
 
   EXPECT_EQ(realm->base_object_created_after_bootstrap(), 3);
 }
+
+// Objects that are deleted while an Environment is discarded leave their
+// JS objects alone. They are deleted all the same.
+TEST_F(BaseObjectPtrTest, Discarding) {
+  const HandleScope handle_scope(isolate_);
+  v8::Global<Object> deleted;
+  v8::Global<Object> discarded;
+  {
+    const Argv argv;
+    Env env_{handle_scope, argv};
+    Environment* env = *env_;
+    Realm* realm = env->principal_realm();
+
+    node::AddEnvironmentCleanupHook(
+        isolate_,
+        [](void* arg) {
+          EXPECT_EQ(static_cast<Realm*>(arg)->base_object_count(), 0);
+        },
+        realm);
+
+    env->set_discarding(true);
+    DummyBaseObject* obj =
+        new DummyBaseObject(env, DummyBaseObject::MakeJSObject(env));
+    deleted.Reset(isolate_, obj->object());
+    // Only objects that the cleanup deletes are affected.
+    delete obj;
+    discarded.Reset(isolate_, DummyBaseObject::New(env)->object());
+  }
+
+  EXPECT_EQ(deleted.Get(isolate_)->GetAlignedPointerFromInternalField(
+                BaseObject::kSlot),
+            nullptr);
+  EXPECT_NE(discarded.Get(isolate_)->GetAlignedPointerFromInternalField(
+                BaseObject::kSlot),
+            nullptr);
+}
@@ -0,0 +1,77 @@
+#include "callback_queue-inl.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+using node::CallbackQueue;
+using node::ThreadsafeCallbackQueue;
+using node::CallbackFlags::kRefed;
+
+using Queue = CallbackQueue<void, std::vector<int>*>;
+
+TEST(CallbackQueue, ShiftInOrder) {
+  Queue queue;
+  std::vector<int> calls;
+  for (int i = 0; i < 3; i++)
+    queue.Push(queue.CreateCallback([i](auto* calls) { calls->push_back(i); },
+                                    kRefed));
+  // Captures that do not fit into a pooled block still work.
+  char large[1024] = {42};
+  queue.Push(queue.CreateCallback(
+      [large](auto* calls) { calls->push_back(large[0]); }, kRefed));
+  EXPECT_EQ(queue.size(), 4u);
+
+  while (auto head = queue.Shift()) head->Call(&calls);
+  EXPECT_EQ(calls, std::vector<int>({0, 1, 2, 42}));
+  EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(ThreadsafeCallbackQueue, ConcurrentPush) {
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 10000;
+  ThreadsafeCallbackQueue<void, std::vector<int>*> threadsafe;
+  EXPECT_TRUE(threadsafe.empty());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&threadsafe, t]() {
+      for (int i = 0; i < kPerThread; i++) {
+        int value = t * kPerThread + i;
+        threadsafe.Push(threadsafe.CreateCallback(
+            [value](auto* calls) { calls->push_back(value); }, kRefed));
+      }
+    });
+  }
+
+  // Drain while the producers are still running.
+  std::vector<int> calls;
+  Queue queue;
+  while (calls.size() < kThreads * kPerThread) {
+    threadsafe.TakeAll(&queue);
+    while (auto head = queue.Shift()) head->Call(&calls);
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_TRUE(threadsafe.empty());
+
+  // Each producer's entries come out in the order in which it pushed them.
+  std::vector<int> next(kThreads);
+  for (int value : calls) {
+    int t = value / kPerThread;
+    EXPECT_EQ(value % kPerThread, next[t]);
+    next[t]++;
+  }
+}
+
+TEST(ThreadsafeCallbackQueue, PushReportsEmptyList) {
+  ThreadsafeCallbackQueue<void, std::vector<int>*> threadsafe;
+  auto noop = [](auto* calls) {};
+  EXPECT_TRUE(threadsafe.Push(threadsafe.CreateCallback(noop, kRefed)));
+  EXPECT_FALSE(threadsafe.Push(threadsafe.CreateCallback(noop, kRefed)));
+
+  Queue queue;
+  threadsafe.TakeAll(&queue);
+  EXPECT_EQ(queue.size(), 2u);
+  EXPECT_TRUE(threadsafe.Push(threadsafe.CreateCallback(noop, kRefed)));
+  // The destructor frees entries that were never taken.
+}
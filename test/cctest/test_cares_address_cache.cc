@@ -0,0 +1,57 @@
+#include "cares_wrap.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using node::cares_wrap::AddressCache;
+
+TEST(AddressCache, StoreAndLookup) {
+  AddressCache cache;
+  std::vector<std::string> addresses;
+  EXPECT_FALSE(cache.Lookup("example.com", AF_INET, 100, &addresses));
+
+  cache.Store("Example.COM", AF_INET, {"192.0.2.1", "192.0.2.2"}, 100, 200);
+  ASSERT_TRUE(cache.Lookup("example.com", AF_INET, 150, &addresses));
+  EXPECT_EQ(addresses, std::vector<std::string>({"192.0.2.1", "192.0.2.2"}));
+
+  // Each family has its own entry.
+  EXPECT_FALSE(cache.Lookup("example.com", AF_INET6, 150, &addresses));
+  EXPECT_FALSE(cache.Lookup("example.com", AF_UNSPEC, 150, &addresses));
+
+  // Expired entries are dropped.
+  EXPECT_FALSE(cache.Lookup("example.com", AF_INET, 200, &addresses));
+  EXPECT_EQ(cache.size(), 0u);
+
+  // Empty answers and answers that have already expired are not stored.
+  cache.Store("example.com", AF_INET, {}, 100, 200);
+  cache.Store("example.com", AF_INET, {"192.0.2.1"}, 100, 100);
+  EXPECT_EQ(cache.size(), 0u);
+
+  cache.Store("example.com", AF_INET6, {"2001:db8::1"}, 100, 200);
+  cache.Clear();
+  EXPECT_FALSE(cache.Lookup("example.com", AF_INET6, 150, &addresses));
+}
+
+TEST(AddressCache, Eviction) {
+  AddressCache cache;
+  for (size_t i = 0; i < AddressCache::kMaxEntries; i++) {
+    cache.Store(
+        "host" + std::to_string(i) + ".test", AF_INET, {"192.0.2.1"}, 0, 10);
+  }
+  EXPECT_EQ(cache.size(), AddressCache::kMaxEntries);
+
+  // Expired entries make room first.
+  cache.Store("fresh.test", AF_INET, {"192.0.2.2"}, 10, 20);
+  EXPECT_EQ(cache.size(), 1u);
+
+  // When nothing has expired, some other entry gives way.
+  for (size_t i = 1; i < AddressCache::kMaxEntries; i++) {
+    cache.Store(
+        "host" + std::to_string(i) + ".test", AF_INET, {"192.0.2.1"}, 10, 20);
+  }
+  cache.Store("another.test", AF_INET, {"192.0.2.3"}, 10, 20);
+  EXPECT_EQ(cache.size(), AddressCache::kMaxEntries);
+  std::vector<std::string> addresses;
+  EXPECT_TRUE(cache.Lookup("another.test", AF_INET, 15, &addresses));
+}
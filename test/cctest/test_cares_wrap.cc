@@ -0,0 +1,49 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+class CaresWrapTest : public EnvironmentTestFixture {};
+
+// Concurrent lookups of the same host, family and flags share one
+// getaddrinfo(), and all get its answer. A lookup started from one of their
+// callbacks gets one of its own.
+TEST_F(CaresWrapTest, SharedGetAddrInfo) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  std::string result = RunScriptAndGetResult(
+      env,
+      "const { GetAddrInfoReqWrap, getaddrinfo, DNS_ORDER_VERBATIM } =\n"
+      "    internalBinding('cares_wrap');\n"
+      "const lookup = (host, family, then) => {\n"
+      "  const req = new GetAddrInfoReqWrap();\n"
+      "  req.oncomplete = (err, addresses) =>\n"
+      "      then(JSON.stringify([err, addresses]));\n"
+      "  return getaddrinfo(req, host, family, 0, DNS_ORDER_VERBATIM);\n"
+      "};\n"
+      "const answers = [];\n"
+      "const errs = [];\n"
+      "let again;\n"
+      "for (let i = 0; i < 8; i++) {\n"
+      "  errs.push(lookup('localhost', 4, (answer) => {\n"
+      "    if (answers.push(answer) === 1) {\n"
+      "      errs.push(lookup('localhost', 4, (answer) => again = answer));\n"
+      "    }\n"
+      "  }));\n"
+      "}\n"
+      "let numeric;\n"
+      "errs.push(lookup('localhost', 0, () => {}));\n"
+      "errs.push(lookup('127.0.0.1', 4, (answer) => numeric = answer));\n"
+      "process.on('exit', () => {\n"
+      "  globalThis.result = [\n"
+      "    errs.join(''), answers.length, new Set(answers).size,\n"
+      "    again === answers[0], numeric,\n"
+      "  ].join();\n"
+      "});",
+      [&]() { EXPECT_EQ((*env)->pending_getaddrinfo()->size(), 3u); });
+  EXPECT_EQ((*env)->pending_getaddrinfo()->size(), 0u);
+  EXPECT_EQ(result, "00000000000,8,1,true,[0,[\"127.0.0.1\"]]");
+}
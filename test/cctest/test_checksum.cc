@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include "node_checksum.h"
+#include "zlib.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using node::checksum::Adler32;
+using node::checksum::Crc32;
+using node::checksum::Crc32c;
+using node::checksum::XXHash64;
+using node::checksum::XXHash64State;
+
+static const uint8_t* Bytes(const std::string& str) {
+  return reinterpret_cast<const uint8_t*>(str.data());
+}
+
+// Deterministic input that covers every byte value, long enough to exercise
+// the vectorized paths as well as their tails.
+static std::vector<uint8_t> MakeInput(size_t length) {
+  std::vector<uint8_t> input(length);
+  uint32_t state = 0x12345678;
+  for (uint8_t& byte : input) {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(state >> 16);
+  }
+  return input;
+}
+
+TEST(Checksum, KnownValues) {
+  const std::string check = "123456789";
+  EXPECT_EQ(Crc32(0, Bytes(check), check.size()), 0xcbf43926u);
+  EXPECT_EQ(Crc32c(0, Bytes(check), check.size()), 0xe3069283u);
+  EXPECT_EQ(Adler32(1, Bytes(check), check.size()), 0x091e01deu);
+
+  EXPECT_EQ(XXHash64(0, nullptr, 0), 0xef46db3751d8e999u);
+  EXPECT_EQ(XXHash64(0, Bytes("abc"), 3), 0x44bc2cf5ad770999u);
+  const std::string spam = "Nobody inspects the spammish repetition";
+  EXPECT_EQ(XXHash64(0, Bytes(spam), spam.size()), 0xfbcea83c8a378bf1u);
+}
+
+TEST(Checksum, Crc32MatchesZlib) {
+  std::vector<uint8_t> input = MakeInput(4096 + 3);
+  for (size_t length : {0, 1, 15, 16, 63, 64, 65, 80, 127, 1000, 4096}) {
+    for (size_t offset = 0; offset < 3; offset++) {
+      const uint8_t* data = input.data() + offset;
+      EXPECT_EQ(Crc32(0, data, length), crc32(0, data, length)) << length;
+      EXPECT_EQ(Crc32(0xdeadbeef, data, length),
+                crc32(0xdeadbeef, data, length))
+          << length;
+    }
+  }
+}
+
+TEST(Checksum, Incremental) {
+  std::vector<uint8_t> input = MakeInput(1000);
+  const uint8_t* data = input.data();
+  for (size_t split : {0, 1, 7, 64, 333, 1000}) {
+    size_t rest = input.size() - split;
+    EXPECT_EQ(Crc32(Crc32(0, data, split), data + split, rest),
+              Crc32(0, data, input.size()));
+    EXPECT_EQ(Crc32c(Crc32c(0, data, split), data + split, rest),
+              Crc32c(0, data, input.size()));
+    EXPECT_EQ(Adler32(Adler32(1, data, split), data + split, rest),
+              Adler32(1, data, input.size()));
+  }
+}
+
+TEST(Checksum, XXHash64StateMatchesOneShot) {
+  std::vector<uint8_t> input = MakeInput(1000);
+  for (size_t length : {0, 5, 31, 32, 33, 100, 1000}) {
+    for (size_t chunk : {1, 3, 32, 50, 1000}) {
+      XXHash64State state(42);
+      for (size_t offset = 0; offset < length; offset += chunk)
+        state.Update(input.data() + offset, std::min(chunk, length - offset));
+      EXPECT_EQ(state.Digest(), XXHash64(42, input.data(), length))
+          << length << " in chunks of " << chunk;
+    }
+  }
+}
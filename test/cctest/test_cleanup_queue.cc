@@ -0,0 +1,97 @@
+#include "cleanup_queue-inl.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using node::CleanupQueue;
+
+namespace {
+
+struct Hook {
+  std::vector<int>* calls;
+  int id;
+  CleanupQueue* queue = nullptr;
+  Hook* other = nullptr;
+};
+
+void Record(void* arg) {
+  Hook* hook = static_cast<Hook*>(arg);
+  hook->calls->push_back(hook->id);
+}
+
+void RecordAndRemoveOther(void* arg) {
+  Record(arg);
+  Hook* hook = static_cast<Hook*>(arg);
+  hook->queue->Remove(Record, hook->other);
+}
+
+void RecordAndAddOther(void* arg) {
+  Record(arg);
+  Hook* hook = static_cast<Hook*>(arg);
+  hook->queue->Add(Record, hook->other);
+}
+
+}  // namespace
+
+TEST(CleanupQueueTest, RunsInReverseOrder) {
+  CleanupQueue queue;
+  std::vector<int> calls;
+  std::vector<Hook> hooks;
+  for (int i = 0; i < 100; i++) hooks.push_back(Hook{&calls, i});
+  for (Hook& hook : hooks) queue.Add(Record, &hook);
+  queue.Remove(Record, &hooks[50]);
+  EXPECT_FALSE(queue.empty());
+
+  queue.Drain();
+  EXPECT_TRUE(queue.empty());
+  ASSERT_EQ(calls.size(), 99u);
+  for (size_t i = 1; i < calls.size(); i++) EXPECT_GT(calls[i - 1], calls[i]);
+  EXPECT_EQ(calls.front(), 99);
+  EXPECT_EQ(calls.back(), 0);
+}
+
+TEST(CleanupQueueTest, EmbeddedHooks) {
+  CleanupQueue queue;
+  std::vector<int> calls;
+  Hook first{&calls, 1};
+  Hook second{&calls, 2};
+  Hook third{&calls, 3};
+  CleanupQueue::CleanupHook first_hook{Record, &first};
+  CleanupQueue::CleanupHook third_hook{Record, &third};
+  queue.Add(&first_hook);
+  queue.Add(Record, &second);
+  queue.Add(&third_hook);
+
+  queue.Remove(&third_hook);
+  // Removing it again is a no-op.
+  queue.Remove(&third_hook);
+
+  queue.Drain();
+  EXPECT_EQ(calls, (std::vector<int>{2, 1}));
+  EXPECT_TRUE(queue.empty());
+
+  // A hook can be added again once it has run.
+  queue.Add(&first_hook);
+  queue.Drain();
+  EXPECT_EQ(calls, (std::vector<int>{2, 1, 1}));
+}
+
+TEST(CleanupQueueTest, ModifiedWhileDraining) {
+  CleanupQueue queue;
+  std::vector<int> calls;
+  Hook removed{&calls, 1};
+  Hook added{&calls, 2};
+  Hook remover{&calls, 3, &queue, &removed};
+  Hook adder{&calls, 4, &queue, &added};
+  queue.Add(Record, &removed);
+  queue.Add(RecordAndRemoveOther, &remover);
+  queue.Add(RecordAndAddOther, &adder);
+
+  // Hooks that are added while draining are run by the next call.
+  queue.Drain();
+  EXPECT_EQ(calls, (std::vector<int>{4, 3}));
+  EXPECT_FALSE(queue.empty());
+  queue.Drain();
+  EXPECT_EQ(calls, (std::vector<int>{4, 3, 2}));
+  EXPECT_TRUE(queue.empty());
+}
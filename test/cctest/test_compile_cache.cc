@@ -0,0 +1,178 @@
+#include "compile_cache.h"
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+class CompileCacheTest : public EnvironmentTestFixture {
+ protected:
+  void SetUp() override {
+    EnvironmentTestFixture::SetUp();
+    char tmpdir[PATH_MAX_BYTES];
+    size_t size = sizeof(tmpdir);
+    ASSERT_EQ(uv_os_tmpdir(tmpdir, &size), 0);
+    uv_fs_t req;
+    std::string templ = std::string(tmpdir, size) + "/ccacheXXXXXX";
+    ASSERT_EQ(uv_fs_mkdtemp(nullptr, &req, templ.c_str(), nullptr), 0);
+    dir_ = req.path;
+    uv_fs_req_cleanup(&req);
+  }
+
+  void TearDown() override {
+    uv_fs_t req;
+    if (!cache_dir_.empty()) {
+      uv_fs_unlink(nullptr, &req, (cache_dir_ + "/pack").c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+      uv_fs_rmdir(nullptr, &req, cache_dir_.c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+    uv_fs_rmdir(nullptr, &req, dir_.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+    EnvironmentTestFixture::TearDown();
+  }
+
+  // Opens the cache in `dir_` with a fresh handler and persists it, and
+  // returns the pack that is left.
+  std::string Persist(node::Environment* env) {
+    {
+      node::CompileCacheHandler handler(env);
+      EXPECT_TRUE(handler.InitializeDirectory(env, dir_));
+      handler.Persist();
+    }
+    if (cache_dir_.empty()) {
+      // The handler keeps its caches in a directory named after the V8
+      // version, which is the only entry of `dir_`.
+      uv_fs_t req;
+      uv_dirent_t dirent;
+      EXPECT_EQ(uv_fs_scandir(nullptr, &req, dir_.c_str(), 0, nullptr), 1);
+      EXPECT_EQ(uv_fs_scandir_next(&req, &dirent), 0);
+      cache_dir_ = dir_ + "/" + dirent.name;
+      uv_fs_req_cleanup(&req);
+    }
+    std::string pack;
+    node::ReadFileSync(&pack, (cache_dir_ + "/pack").c_str());
+    return pack;
+  }
+
+  void WritePack(const std::string& contents) {
+    uv_buf_t buf =
+        uv_buf_init(const_cast<char*>(contents.data()), contents.size());
+    ASSERT_EQ(node::WriteFileSync((cache_dir_ + "/pack").c_str(), buf), 0);
+  }
+
+  std::string dir_;
+  std::string cache_dir_;
+};
+
+// A pack that records could not be appended to is replaced, rather than
+// left to grow with records that are never read back.
+TEST_F(CompileCacheTest, RewritesBrokenPacks) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // Nothing is written out for an empty cache.
+  EXPECT_EQ(Persist(*env), "");
+
+  // The header of a pack: a magic number and the cache version, which the
+  // directory is named after.
+  uint32_t header[] = {
+      0x4b504343,  // "CCPK"
+      static_cast<uint32_t>(strtoul(
+          cache_dir_.substr(cache_dir_.rfind('/') + 1).c_str(), nullptr, 16))};
+  const std::string empty(reinterpret_cast<const char*>(header),
+                          sizeof(header));
+
+  // The header of a different V8 version.
+  std::string other_version = empty;
+  other_version[4] ^= 1;
+  WritePack(other_version);
+  EXPECT_EQ(Persist(*env), empty);
+
+  // A header that was cut short.
+  WritePack("CCP");
+  EXPECT_EQ(Persist(*env), empty);
+
+  // A record that was cut short, e.g. by a crash while appending.
+  WritePack(empty + "CCPR1234");
+  EXPECT_EQ(Persist(*env), empty);
+
+  // A record that is not one.
+  WritePack(empty + std::string(64, 'x'));
+  EXPECT_EQ(Persist(*env), empty);
+
+  // A valid pack is left alone when there is nothing to add.
+  WritePack(empty);
+  EXPECT_EQ(Persist(*env), empty);
+}
+
+TEST(CompileCacheHashTest, UpdateHash) {
+  const char data[] = "a buffer that arrives in several chunks";
+  const size_t size = sizeof(data) - 1;
+  uint32_t hash = node::GetHash(data, 0);
+  hash = node::UpdateHash(hash, data, 7);
+  hash = node::UpdateHash(hash, data + 7, 0);
+  hash = node::UpdateHash(hash, data + 7, size - 7);
+  EXPECT_EQ(hash, node::GetHash(data, size));
+}
+
+// The code that V8 serializes for a streamed WebAssembly module is written
+// out with the other caches, and found again under the same URL along with
+// the size and hash of the module bytes it was made for.
+TEST_F(CompileCacheTest, WasmCache) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // A module with a single function that returns 42.
+  static const uint8_t bytes[] = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,  // header
+      0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f,        // () -> i32
+      0x03, 0x02, 0x01, 0x00,                          // function 0
+      0x0a, 0x06, 0x01, 0x04, 0x00, 0x41, 0x2a, 0x0b,  // i32.const 42
+  };
+  // V8 only serializes code that is fully optimized.
+  v8::V8::SetFlagsFromString("--no-liftoff --no-wasm-lazy-compilation");
+  v8::Local<v8::WasmModuleObject> module =
+      v8::WasmModuleObject::Compile(
+          isolate_, v8::MemorySpan<const uint8_t>(bytes, sizeof(bytes)))
+          .ToLocalChecked();
+  v8::V8::SetFlagsFromString("--liftoff --wasm-lazy-compilation");
+
+  const char* url = "https://example.com/module.wasm";
+  std::function<void(v8::CompiledWasmModule)> serializer;
+  {
+    node::CompileCacheHandler handler(*env);
+    ASSERT_TRUE(handler.InitializeDirectory(*env, dir_));
+    node::CompileCacheEntry* entry = handler.GetOrInsertWasm(url);
+    EXPECT_EQ(entry->type, node::CachedCodeType::kWasm);
+    EXPECT_EQ(entry->cache.get(), nullptr);
+    serializer = handler.GetWasmSerializer(entry);
+    serializer(module->GetCompiledModule());
+    handler.Persist();
+  }
+  // V8 may hold on to the serializer for longer than the handler lives.
+  serializer(module->GetCompiledModule());
+
+  {
+    node::CompileCacheHandler handler(*env);
+    ASSERT_TRUE(handler.InitializeDirectory(*env, dir_));
+    node::CompileCacheEntry* entry = handler.GetOrInsertWasm(url);
+    ASSERT_NE(entry->cache.get(), nullptr);
+    EXPECT_GT(entry->cache->length, 0);
+    EXPECT_EQ(entry->code_size, sizeof(bytes));
+    EXPECT_EQ(entry->code_hash,
+              node::GetHash(reinterpret_cast<const char*>(bytes),
+                            sizeof(bytes)));
+    EXPECT_EQ(handler.GetOrInsertWasm("https://example.com/other.wasm")
+                  ->cache.get(),
+              nullptr);
+  }
+  EXPECT_NE(Persist(*env), "");
+}
@@ -0,0 +1,51 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+class ConnectionWrapTest : public EnvironmentTestFixture {
+ protected:
+  // Accepts four connections that are made together, each of which queues
+  // a tick, and returns in which order the connections (c) and ticks (t)
+  // ran.
+  std::string Run(bool batch) {
+    const v8::HandleScope handle_scope(isolate_);
+    const Argv argv;
+    Env env{handle_scope, argv};
+    (*env)->options()->experimental_batch_io_callbacks = batch;
+
+    return RunScriptAndGetResult(
+        env,
+        "const net = require('net');\n"
+        "const clients = [];\n"
+        "let order = '';\n"
+        "const server = net.createServer((socket) => {\n"
+        "  order += 'c';\n"
+        "  process.nextTick(() => order += 't');\n"
+        "  socket.destroy();\n"
+        "  if (order.split('c').length === 5) {\n"
+        "    for (const client of clients) client.destroy();\n"
+        "    server.close(() => globalThis.result = order);\n"
+        "  }\n"
+        "});\n"
+        "server.listen(0, '127.0.0.1', () => {\n"
+        "  const { port } = server.address();\n"
+        "  for (let i = 0; i < 4; i++) {\n"
+        "    clients.push(net.connect(port, '127.0.0.1')\n"
+        "        .on('error', () => {}));\n"
+        "  }\n"
+        "});");
+  }
+};
+
+TEST_F(ConnectionWrapTest, TicksRunAfterEveryConnection) {
+  EXPECT_EQ(Run(false), "ctctctct");
+}
+
+// With --experimental-batch-io-callbacks, the connections that libuv
+// accepts in one go share one run of the task queues.
+TEST_F(ConnectionWrapTest, BatchedTicksRunOnce) {
+  EXPECT_EQ(Run(true), "cccctttt");
+}
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "node_coverage.h"
+
+#include <string>
+
+using node::coverage::AppendCountsRecord;
+using node::coverage::FunctionCoverage;
+using node::coverage::IsUserScript;
+using node::coverage::ParseCoverage;
+using node::coverage::RangeCoverage;
+using node::coverage::ReadCountsRecord;
+using node::coverage::ScriptCoverage;
+
+namespace {
+
+// A script whose function f() ran `f_count` times. V8 leaves out the range
+// of the block that f() skipped if f() never ran.
+std::string Script(const std::string& url, int f_count) {
+  std::string f_ranges =
+      R"({"startOffset":10,"endOffset":30,"count":)" +
+      std::to_string(f_count) + "}";
+  if (f_count != 0) {
+    f_ranges += R"(,{"startOffset":20,"endOffset":25,"count":0})";
+  }
+  return R"({"scriptId":"1","url":")" + url + R"(","functions":[)" +
+         R"({"functionName":"","ranges":[{"startOffset":0,"endOffset":40,)" +
+         R"("count":1}],"isBlockCoverage":false},)" +
+         R"({"functionName":"f","ranges":[)" + f_ranges +
+         R"(],"isBlockCoverage":true}]})";
+}
+
+bool Parse(const std::string& json,
+           bool user_scripts_only,
+           std::vector<ScriptCoverage>* scripts) {
+  simdjson::ondemand::parser parser;
+  simdjson::padded_string padded(json);
+  simdjson::ondemand::document document;
+  simdjson::ondemand::object result;
+  return !parser.iterate(padded).get(document) &&
+         !document.get_object().get(result) &&
+         ParseCoverage(&result, user_scripts_only, scripts);
+}
+
+}  // anonymous namespace
+
+TEST(Coverage, ParseCoverage) {
+  std::string json = R"({"result":[)" + Script("file:///a.js", 3) + "," +
+                     Script("node:fs", 3) + "," + Script("file:///b.js", 3) +
+                     "," + Script("file:///a.js", 0) + "]}";
+
+  std::vector<ScriptCoverage> scripts;
+  ASSERT_TRUE(Parse(json, false, &scripts));
+  ASSERT_EQ(scripts.size(), 4u);
+  EXPECT_EQ(scripts[0].url, "file:///a.js");
+  EXPECT_EQ(scripts[0].functions,
+            (std::vector<FunctionCoverage>{
+                {"", false, {{0, 40, 1}}},
+                {"f", true, {{10, 30, 3}, {20, 25, 0}}}}));
+  EXPECT_EQ(scripts[1].url, "node:fs");
+  // The hash does not depend on the ranges, which differ between runs.
+  EXPECT_EQ(scripts[3].hash, scripts[0].hash);
+  EXPECT_EQ(scripts[3].functions[1].ranges,
+            (std::vector<RangeCoverage>{{10, 30, 0}}));
+  EXPECT_NE(scripts[2].hash, scripts[0].hash);
+
+  scripts.clear();
+  ASSERT_TRUE(Parse(json, true, &scripts));
+  ASSERT_EQ(scripts.size(), 3u);
+  EXPECT_EQ(scripts[1].url, "file:///b.js");
+
+  EXPECT_FALSE(Parse(R"({"result":[{"url":"file:///a.js"}]})", false,
+                     &scripts));
+  EXPECT_FALSE(Parse(R"({"profile":{}})", false, &scripts));
+}
+
+TEST(Coverage, SkipsScriptsThatDidNotRun) {
+  std::string json =
+      R"({"result":[{"scriptId":"1","url":"file:///a.js","functions":[)"
+      R"({"functionName":"","ranges":[{"startOffset":0,"endOffset":4,)"
+      R"("count":0}],"isBlockCoverage":false}]}]})";
+  std::vector<ScriptCoverage> scripts;
+  ASSERT_TRUE(Parse(json, false, &scripts));
+  EXPECT_TRUE(scripts.empty());
+}
+
+TEST(Coverage, CountsRecordRoundTrip) {
+  ScriptCoverage first = {
+      0x0123456789abcdef,
+      "",
+      {{"", false, {{0, 1000, 1}}},
+       {"f", true, {{10, 30, 300}, {20, 25, 0}}},
+       {"g", false, {{40, 50, 1ull << 40}}}}};
+  ScriptCoverage second = {42, "", {}};
+  std::string records;
+  AppendCountsRecord(first, &records);
+  AppendCountsRecord(second, &records);
+
+  std::string_view in = records;
+  ScriptCoverage script;
+  ASSERT_TRUE(ReadCountsRecord(&in, &script));
+  EXPECT_EQ(script.hash, first.hash);
+  EXPECT_EQ(script.functions, first.functions);
+  ASSERT_TRUE(ReadCountsRecord(&in, &script));
+  EXPECT_EQ(script.hash, second.hash);
+  EXPECT_TRUE(script.functions.empty());
+  EXPECT_TRUE(in.empty());
+
+  for (size_t size = 0; size < records.size() - 9; size++) {
+    in = std::string_view(records).substr(0, size);
+    EXPECT_FALSE(ReadCountsRecord(&in, &script)) << size;
+  }
+}
+
+TEST(Coverage, IsUserScript) {
+  EXPECT_TRUE(IsUserScript("file:///a.js"));
+  EXPECT_FALSE(IsUserScript("node:internal/main/run_main_module"));
+  EXPECT_FALSE(IsUserScript(""));
+}
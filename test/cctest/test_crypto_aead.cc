@@ -0,0 +1,200 @@
+#include "crypto/crypto_aead.h"
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <openssl/evp.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using node::crypto::AEADCipher;
+using node::crypto::AEADRecord;
+using node::crypto::ByteSource;
+using node::crypto::ProcessAEADBatch;
+
+namespace {
+
+const unsigned char kKey[32] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+// Seals with a new context for the message, like CipherBase does.
+std::vector<unsigned char> SealWithNewContext(const EVP_CIPHER* cipher,
+                                              const unsigned char* iv,
+                                              const std::string& data,
+                                              const std::string& aad,
+                                              size_t tag_length) {
+  EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+  std::vector<unsigned char> out(data.size() + tag_length);
+  int length;
+  EXPECT_EQ(EVP_EncryptInit_ex(ctx, cipher, nullptr, kKey, iv), 1);
+  EXPECT_EQ(EVP_EncryptUpdate(ctx,
+                              nullptr,
+                              &length,
+                              reinterpret_cast<const unsigned char*>(
+                                  aad.data()),
+                              aad.size()),
+            1);
+  EXPECT_EQ(EVP_EncryptUpdate(ctx,
+                              out.data(),
+                              &length,
+                              reinterpret_cast<const unsigned char*>(
+                                  data.data()),
+                              data.size()),
+            1);
+  EXPECT_EQ(EVP_EncryptFinal_ex(ctx, out.data() + data.size(), &length), 1);
+  EXPECT_EQ(EVP_CIPHER_CTX_ctrl(ctx,
+                                EVP_CTRL_AEAD_GET_TAG,
+                                tag_length,
+                                out.data() + data.size()),
+            1);
+  EVP_CIPHER_CTX_free(ctx);
+  return out;
+}
+
+const unsigned char* Bytes(const std::string& string) {
+  return reinterpret_cast<const unsigned char*>(string.data());
+}
+
+}  // anonymous namespace
+
+TEST(CryptoAEAD, Create) {
+  EXPECT_TRUE(AEADCipher::Create(EVP_aes_256_gcm(), kKey, 32, 12, 16));
+  EXPECT_TRUE(AEADCipher::Create(EVP_aes_128_gcm(), kKey, 16, 16, 12));
+  EXPECT_TRUE(
+      AEADCipher::Create(EVP_chacha20_poly1305(), kKey, 32, 12, 16));
+  EXPECT_FALSE(AEADCipher::Create(EVP_aes_256_gcm(), kKey, 16, 12, 16));
+  EXPECT_FALSE(AEADCipher::Create(EVP_aes_256_gcm(), kKey, 32, 12, 11));
+  EXPECT_FALSE(AEADCipher::Create(EVP_aes_256_gcm(), kKey, 32, 0, 16));
+  EXPECT_FALSE(AEADCipher::Create(EVP_aes_256_cbc(), kKey, 32, 16, 16));
+  EXPECT_FALSE(AEADCipher::Create(nullptr, kKey, 32, 12, 16));
+}
+
+TEST(CryptoAEAD, SealAndOpen) {
+  const EVP_CIPHER* ciphers[] = {EVP_aes_256_gcm(), EVP_chacha20_poly1305()};
+  for (const EVP_CIPHER* cipher : ciphers) {
+    auto aead = AEADCipher::Create(cipher, kKey, 32, 12, 16);
+    ASSERT_TRUE(aead);
+
+    // The reused contexts give the same results as new ones, message after
+    // message.
+    for (unsigned char n = 0; n < 5; n++) {
+      const unsigned char iv[12] = {n, 1};
+      std::string data(n * 7, 'a' + n);
+      std::string aad(n, 'x');
+      std::vector<unsigned char> sealed(data.size() + 16);
+      ASSERT_TRUE(aead->Seal(iv,
+                             Bytes(data),
+                             data.size(),
+                             Bytes(aad),
+                             aad.size(),
+                             sealed.data()));
+      EXPECT_EQ(sealed, SealWithNewContext(cipher, iv, data, aad, 16));
+
+      std::vector<unsigned char> opened(data.size());
+      ASSERT_TRUE(aead->Open(iv,
+                             sealed.data(),
+                             sealed.size(),
+                             Bytes(aad),
+                             aad.size(),
+                             opened.data()));
+      EXPECT_EQ(memcmp(opened.data(), data.data(), data.size()), 0);
+    }
+  }
+}
+
+TEST(CryptoAEAD, OpenFailure) {
+  auto aead = AEADCipher::Create(EVP_aes_128_gcm(), kKey, 16, 12, 16);
+  ASSERT_TRUE(aead);
+  const unsigned char iv[12] = {};
+  std::string data = "attack at dawn";
+  std::vector<unsigned char> sealed(data.size() + 16);
+  ASSERT_TRUE(aead->Seal(
+      iv, Bytes(data), data.size(), nullptr, 0, sealed.data()));
+
+  sealed[0] ^= 1;
+  std::vector<unsigned char> opened(data.size());
+  EXPECT_FALSE(aead->Open(
+      iv, sealed.data(), sealed.size(), nullptr, 0, opened.data()));
+  // The unauthenticated plaintext is wiped.
+  EXPECT_EQ(opened, std::vector<unsigned char>(data.size()));
+
+  // A failure does not affect the next message.
+  sealed[0] ^= 1;
+  EXPECT_TRUE(aead->Open(
+      iv, sealed.data(), sealed.size(), nullptr, 0, opened.data()));
+  EXPECT_FALSE(aead->Open(iv, sealed.data(), 15, nullptr, 0, opened.data()));
+}
+
+TEST(CryptoAEAD, Batch) {
+  auto aead = AEADCipher::Create(EVP_chacha20_poly1305(), kKey, 32, 12, 16);
+  ASSERT_TRUE(aead);
+  auto clone = aead->Clone();
+  ASSERT_TRUE(clone);
+
+  const unsigned char iv[3][12] = {{1}, {2}, {3}};
+  const std::string data[3] = {"", "one", "three"};
+  std::vector<AEADRecord> records(3);
+  for (int i = 0; i < 3; i++) {
+    records[i].iv = ByteSource::Foreign(iv[i], sizeof(iv[i]));
+    records[i].data = ByteSource::Foreign(data[i].data(), data[i].size());
+  }
+
+  ByteSource sealed;
+  ASSERT_TRUE(
+      ProcessAEADBatch(clone.get(), AEADCipher::kSeal, records, &sealed));
+  ASSERT_EQ(sealed.size(), 3u + 48u + 8u);
+  const unsigned char* status = sealed.data<unsigned char>();
+  EXPECT_EQ(status[0] + status[1] + status[2], 3);
+
+  // Open the outputs again, with the last one tampered with.
+  std::vector<std::vector<unsigned char>> outputs;
+  const unsigned char* output = status + 3;
+  for (int i = 0; i < 3; i++) {
+    size_t length = data[i].size() + 16;
+    outputs.emplace_back(output, output + length);
+    output += length;
+  }
+  outputs[2][0] ^= 1;
+  for (int i = 0; i < 3; i++) {
+    records[i].data = ByteSource::Foreign(outputs[i].data(), outputs[i].size());
+  }
+
+  ByteSource opened;
+  ASSERT_TRUE(
+      ProcessAEADBatch(aead.get(), AEADCipher::kOpen, records, &opened));
+  ASSERT_EQ(opened.size(), 3u + 8u);
+  status = opened.data<unsigned char>();
+  EXPECT_EQ(status[0], 1);
+  EXPECT_EQ(status[1], 1);
+  EXPECT_EQ(status[2], 0);
+  EXPECT_EQ(memcmp(status + 3, "one", 3), 0);
+}
+
+class CryptoAEADKeyTest : public EnvironmentTestFixture {};
+
+// A getter in the batch arrays that transfers the buffer of an earlier
+// record runs before the contents of any record are taken, so the record
+// is read as the empty buffer it has become.
+TEST_F(CryptoAEADKeyTest, BatchGetterTransfersBuffer) {
+  std::string result = RunScriptAndGetResult(
+      "const { AEADKey } = internalBinding('crypto');\n"
+      "const key = new AEADKey('aes-256-gcm', Buffer.alloc(32, 1), 12, 16);\n"
+      "const ivs = [Buffer.alloc(12, 1), Buffer.alloc(12, 2)];\n"
+      "const first = new Uint8Array(1 << 20).fill(7);\n"
+      "const data = [first];\n"
+      "Object.defineProperty(data, 1, {\n"
+      "  enumerable: true,\n"
+      "  get() {\n"
+      "    structuredClone(first.buffer, { transfer: [first.buffer] });\n"
+      "    return Buffer.from('y');\n"
+      "  },\n"
+      "});\n"
+      "const sealed = key.sealBatch(ivs, data);\n"
+      "globalThis.result = [\n"
+      "  sealed[0].length, sealed[1].length,\n"
+      "  sealed[0].equals(key.seal(ivs[0], Buffer.alloc(0))),\n"
+      "].join();");
+  EXPECT_EQ(result, "16,17,true");
+}
@@ -0,0 +1,68 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class CryptoHashTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `inputs` set to a list of strings and buffers and
+  // `expected` to their SHA-256 digests from createHash(), and returns what
+  // it left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const binding = internalBinding('crypto');\n"
+        "const { createHash } = require('crypto');\n"
+        "const inputs = ['', 'abc', '\\u00e9\\u20ac', Buffer.from([1, 2]),\n"
+        "                new Uint8Array(1000).fill(7),\n"
+        "                new Uint16Array([1, 2, 3]).buffer];\n"
+        "const expected = inputs.map((input) => createHash('sha256')\n"
+        "    .update(input instanceof ArrayBuffer ?\n"
+        "            new Uint8Array(input) : input).digest());\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+TEST_F(CryptoHashTest, OneShotDigestMany) {
+  EXPECT_EQ(Run("const digest = (encoding, list = inputs) =>\n"
+                "    binding.oneShotDigestMany(\n"
+                "        'sha256', -1, {}, list, encoding, undefined);\n"
+                "const out = [];\n"
+                "out.push(Buffer.from(digest('buffer'))\n"
+                "    .equals(Buffer.concat(expected)));\n"
+                "out.push(digest('hex').join() ===\n"
+                "    expected.map((d) => d.toString('hex')).join());\n"
+                "out.push(digest('base64')[2] ===\n"
+                "    expected[2].toString('base64'));\n"
+                "out.push(digest('buffer', []).byteLength);\n"
+                "try {\n"
+                "  digest('hex', ['a', 42]);\n"
+                "} catch (err) {\n"
+                "  out.push(err.code);\n"
+                "}\n"
+                "globalThis.result = out.join();"),
+            "true,true,true,0,ERR_INVALID_ARG_TYPE");
+}
+
+TEST_F(CryptoHashTest, HashManyJob) {
+  EXPECT_EQ(Run("const { HashManyJob, kCryptoJobAsync, kCryptoJobSync } =\n"
+                "    binding;\n"
+                "const all = Buffer.concat(expected);\n"
+                "const out = [];\n"
+                "const [err, sync] =\n"
+                "    new HashManyJob(kCryptoJobSync, 'sha256', inputs).run();\n"
+                "out.push(err, Buffer.from(sync).equals(all));\n"
+                "try {\n"
+                "  new HashManyJob(kCryptoJobSync, 'nope', inputs);\n"
+                "} catch (err) {\n"
+                "  out.push(err.code);\n"
+                "}\n"
+                "const job =\n"
+                "    new HashManyJob(kCryptoJobAsync, 'sha256', inputs);\n"
+                "job.ondone = (err, result) => {\n"
+                "  out.push(err, Buffer.from(result).equals(all));\n"
+                "  globalThis.result = out.join();\n"
+                "};\n"
+                "job.run();"),
+            ",true,ERR_CRYPTO_INVALID_DIGEST,,true");
+}
@@ -0,0 +1,81 @@
+#include "crypto/crypto_keygen.h"
+#include "gtest/gtest.h"
+
+#include <openssl/evp.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+using node::crypto::EVPKeyCtxPointer;
+using node::crypto::EVPKeyPointer;
+using node::crypto::KeyPool;
+
+namespace {
+
+EVPKeyCtxPointer SetupX25519() {
+  EVPKeyCtxPointer ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_X25519, nullptr));
+  if (!ctx || EVP_PKEY_keygen_init(ctx.get()) <= 0) return EVPKeyCtxPointer();
+  return ctx;
+}
+
+bool WaitForKeys(KeyPool* pool, const std::string& id, size_t count) {
+  for (int i = 0; i < 1000; i++) {
+    if (pool->available(id) == count) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+}  // anonymous namespace
+
+TEST(CryptoKeyPool, TakeAndRefill) {
+  KeyPool pool;
+  pool.SetSize(3);
+
+  // The first request creates the pool, but there is no key yet.
+  EXPECT_FALSE(pool.Take("x25519", SetupX25519));
+  ASSERT_TRUE(WaitForKeys(&pool, "x25519", 3));
+
+  int setup_calls = 0;
+  auto setup = [&]() {
+    setup_calls++;
+    return SetupX25519();
+  };
+  EVPKeyPointer first = pool.Take("x25519", setup);
+  EVPKeyPointer second = pool.Take("x25519", setup);
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_EQ(setup_calls, 0);
+  EXPECT_EQ(EVP_PKEY_id(first.get()), EVP_PKEY_X25519);
+  unsigned char first_raw[32];
+  unsigned char second_raw[32];
+  size_t length = sizeof(first_raw);
+  ASSERT_EQ(EVP_PKEY_get_raw_public_key(first.get(), first_raw, &length), 1);
+  ASSERT_EQ(EVP_PKEY_get_raw_public_key(second.get(), second_raw, &length), 1);
+  EXPECT_NE(memcmp(first_raw, second_raw, sizeof(first_raw)), 0);
+
+  // The keys that were taken are replaced.
+  EXPECT_TRUE(WaitForKeys(&pool, "x25519", 3));
+}
+
+TEST(CryptoKeyPool, Disabled) {
+  KeyPool pool;
+  EXPECT_FALSE(pool.Take("x25519", SetupX25519));
+  ASSERT_TRUE(WaitForKeys(&pool, "x25519", KeyPool::kDefaultSize));
+
+  pool.SetSize(0);
+  EXPECT_EQ(pool.available("x25519"), 0u);
+  EXPECT_FALSE(pool.Take("x25519", SetupX25519));
+  EXPECT_FALSE(pool.Take("other", SetupX25519));
+  EXPECT_EQ(pool.available("other"), 0u);
+}
+
+TEST(CryptoKeyPool, SetupFailure) {
+  KeyPool pool;
+  EXPECT_FALSE(pool.Take("broken", []() { return EVPKeyCtxPointer(); }));
+  EXPECT_EQ(pool.available("broken"), 0u);
+  // A failed setup does not create the pool, so it is tried again.
+  EXPECT_FALSE(pool.Take("broken", SetupX25519));
+  EXPECT_TRUE(WaitForKeys(&pool, "broken", KeyPool::kDefaultSize));
+}
@@ -0,0 +1,96 @@
+#include "crypto/crypto_keys.h"
+#include "gtest/gtest.h"
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using node::crypto::ByteSource;
+using node::crypto::CipherCtxPointer;
+using node::crypto::HMACCtxPointer;
+using node::crypto::KeyObjectData;
+
+namespace {
+
+const unsigned char kKey[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+const unsigned char kIV[16] = {16, 15, 14, 13, 12, 11};
+
+std::shared_ptr<KeyObjectData> CreateKey() {
+  ByteSource::Builder key(sizeof(kKey));
+  memcpy(key.data<unsigned char>(), kKey, sizeof(kKey));
+  return KeyObjectData::CreateSecret(std::move(key).release());
+}
+
+std::string Sign(HMACCtxPointer ctx, const std::string& data) {
+  unsigned char md[EVP_MAX_MD_SIZE];
+  unsigned int length;
+  EXPECT_TRUE(ctx);
+  EXPECT_EQ(HMAC_Update(ctx.get(),
+                        reinterpret_cast<const unsigned char*>(data.data()),
+                        data.size()),
+            1);
+  EXPECT_EQ(HMAC_Final(ctx.get(), md, &length), 1);
+  return std::string(reinterpret_cast<char*>(md), length);
+}
+
+std::vector<unsigned char> Encrypt(CipherCtxPointer ctx,
+                                   const std::string& data) {
+  EXPECT_TRUE(ctx);
+  std::vector<unsigned char> out(data.size() + EVP_MAX_BLOCK_LENGTH);
+  int length;
+  int final_length;
+  EXPECT_EQ(EVP_CipherInit_ex(ctx.get(), nullptr, nullptr, nullptr, kIV, 1),
+            1);
+  EXPECT_EQ(EVP_CipherUpdate(ctx.get(),
+                             out.data(),
+                             &length,
+                             reinterpret_cast<const unsigned char*>(
+                                 data.data()),
+                             data.size()),
+            1);
+  EXPECT_EQ(EVP_CipherFinal_ex(ctx.get(), out.data() + length, &final_length),
+            1);
+  out.resize(length + final_length);
+  return out;
+}
+
+}  // anonymous namespace
+
+TEST(KeyObjectData, PreparedHMACContexts) {
+  std::shared_ptr<KeyObjectData> key = CreateKey();
+  const std::string data = "The quick brown fox jumps over the lazy dog";
+
+  HMACCtxPointer fresh(HMAC_CTX_new());
+  ASSERT_EQ(
+      HMAC_Init_ex(fresh.get(), kKey, sizeof(kKey), EVP_sha256(), nullptr),
+      1);
+  const std::string expected = Sign(std::move(fresh), data);
+
+  // The first context sets up the key, the others are copies of it.
+  for (int i = 0; i < 3; i++)
+    EXPECT_EQ(Sign(key->NewHMACContext(EVP_sha256()), data), expected);
+  EXPECT_NE(Sign(key->NewHMACContext(EVP_sha1()), data), expected);
+}
+
+TEST(KeyObjectData, PreparedCipherContexts) {
+  std::shared_ptr<KeyObjectData> key = CreateKey();
+  const std::string data = "The quick brown fox jumps over the lazy dog";
+
+  CipherCtxPointer fresh(EVP_CIPHER_CTX_new());
+  ASSERT_EQ(EVP_CipherInit_ex(
+                fresh.get(), EVP_aes_128_cbc(), nullptr, kKey, nullptr, 1),
+            1);
+  const std::vector<unsigned char> expected = Encrypt(std::move(fresh), data);
+
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(Encrypt(key->NewCipherContext(EVP_aes_128_cbc(), true, 16),
+                      data),
+              expected);
+  }
+  EXPECT_NE(Encrypt(key->NewCipherContext(EVP_aes_128_ctr(), true, 16), data),
+            expected);
+}
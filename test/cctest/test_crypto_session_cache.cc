@@ -0,0 +1,160 @@
+#include "crypto/crypto_session_cache.h"
+#include "gtest/gtest.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using node::crypto::TLSSessionCache;
+
+namespace {
+
+TLSSessionCache::Key MakeKey(const std::string& context,
+                             const std::string& id) {
+  TLSSessionCache::Key key;
+  EXPECT_TRUE(TLSSessionCache::MakeKey(
+      reinterpret_cast<const unsigned char*>(context.data()),
+      context.size(),
+      reinterpret_cast<const unsigned char*>(id.data()),
+      id.size(),
+      &key));
+  return key;
+}
+
+bool Store(TLSSessionCache* cache,
+           const TLSSessionCache::Key& key,
+           const std::string& data,
+           uint64_t expires_at) {
+  return cache->Store(key,
+                      reinterpret_cast<const unsigned char*>(data.data()),
+                      data.size(),
+                      expires_at);
+}
+
+std::string Lookup(TLSSessionCache* cache,
+                   const TLSSessionCache::Key& key,
+                   uint64_t now) {
+  std::vector<unsigned char> data;
+  if (!cache->Lookup(key, now, &data)) return "<miss>";
+  return std::string(data.begin(), data.end());
+}
+
+}  // anonymous namespace
+
+TEST(TLSSessionCache, StoreAndLookup) {
+  TLSSessionCache cache(16);
+  TLSSessionCache::Key key = MakeKey("ctx", "session-1");
+
+  EXPECT_EQ(Lookup(&cache, key, 100), "<miss>");
+  EXPECT_TRUE(Store(&cache, key, "der", 200));
+  EXPECT_EQ(Lookup(&cache, key, 100), "der");
+
+  // The context is part of the key, and so is where it ends.
+  EXPECT_EQ(Lookup(&cache, MakeKey("other", "session-1"), 100), "<miss>");
+  EXPECT_EQ(Lookup(&cache, MakeKey("ct", "xsession-1"), 100), "<miss>");
+
+  // Expired sessions are dropped.
+  EXPECT_EQ(Lookup(&cache, key, 200), "<miss>");
+  EXPECT_EQ(Lookup(&cache, key, 100), "<miss>");
+
+  EXPECT_TRUE(Store(&cache, key, "der", 200));
+  cache.Remove(key);
+  EXPECT_EQ(Lookup(&cache, key, 100), "<miss>");
+}
+
+TEST(TLSSessionCache, Limits) {
+  TLSSessionCache cache(1);
+  TLSSessionCache::Key key;
+  std::string long_context(33, 'c');
+  std::string id(32, 'i');
+  EXPECT_FALSE(TLSSessionCache::MakeKey(
+      reinterpret_cast<const unsigned char*>(long_context.data()),
+      long_context.size(),
+      reinterpret_cast<const unsigned char*>(id.data()),
+      id.size(),
+      &key));
+
+  key = MakeKey(std::string(32, 'c'), id);
+  EXPECT_FALSE(Store(
+      &cache, key, std::string(TLSSessionCache::kMaxDataLength + 1, 'x'), 2));
+  std::string largest(TLSSessionCache::kMaxDataLength, 'x');
+  EXPECT_TRUE(Store(&cache, key, largest, 2));
+  EXPECT_EQ(Lookup(&cache, key, 1), largest);
+
+  // With a single slot, every new session replaces the previous one.
+  TLSSessionCache::Key other = MakeKey("ctx", "session-2");
+  EXPECT_TRUE(Store(&cache, other, "newer", 2));
+  EXPECT_EQ(Lookup(&cache, key, 1), "<miss>");
+  EXPECT_EQ(Lookup(&cache, other, 1), "newer");
+}
+
+#ifndef _WIN32
+TEST(TLSSessionCache, SharedFile) {
+  char path[] = "/tmp/node-test-session-cache-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  close(fd);
+
+  int error = 0;
+  std::unique_ptr<TLSSessionCache> first =
+      TLSSessionCache::MapFile(path, 8, &error);
+  ASSERT_NE(first, nullptr) << error;
+  std::unique_ptr<TLSSessionCache> second =
+      TLSSessionCache::MapFile(path, 8, &error);
+  ASSERT_NE(second, nullptr) << error;
+
+  // Both mappings see the same slots.
+  TLSSessionCache::Key key = MakeKey("ctx", "session-1");
+  EXPECT_TRUE(Store(first.get(), key, "der", 200));
+  EXPECT_EQ(Lookup(second.get(), key, 100), "der");
+
+  // A file that was set up for a different table size is rejected.
+  EXPECT_EQ(TLSSessionCache::MapFile(path, 16, &error), nullptr);
+  EXPECT_EQ(error, EINVAL);
+
+  first.reset();
+  second.reset();
+  remove(path);
+}
+
+TEST(TLSSessionCache, CorruptedSlot) {
+  char path[] = "/tmp/node-test-session-cache-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+
+  int error = 0;
+  std::unique_ptr<TLSSessionCache> cache =
+      TLSSessionCache::MapFile(path, 1, &error);
+  ASSERT_NE(cache, nullptr) << error;
+
+  // The only slot starts after the header page, with its lock, then the key
+  // length and the data length.
+  const off_t key_length = TLSSessionCache::kSlotSize + 4;
+  const off_t data_length = TLSSessionCache::kSlotSize + 6;
+  const uint16_t too_long = 0xffff;
+  TLSSessionCache::Key key = MakeKey("ctx", "session-1");
+
+  EXPECT_TRUE(Store(cache.get(), key, "der", 200));
+  ASSERT_EQ(pwrite(fd, &too_long, sizeof(too_long), data_length),
+            static_cast<ssize_t>(sizeof(too_long)));
+  EXPECT_EQ(Lookup(cache.get(), key, 100), "<miss>");
+
+  EXPECT_TRUE(Store(cache.get(), key, "der", 200));
+  ASSERT_EQ(pwrite(fd, &too_long, sizeof(too_long), key_length),
+            static_cast<ssize_t>(sizeof(too_long)));
+  EXPECT_EQ(Lookup(cache.get(), key, 100), "<miss>");
+
+  // The slot can be used again once something valid is stored in it.
+  EXPECT_TRUE(Store(cache.get(), key, "der", 200));
+  EXPECT_EQ(Lookup(cache.get(), key, 100), "der");
+
+  close(fd);
+  cache.reset();
+  remove(path);
+}
+#endif  // _WIN32
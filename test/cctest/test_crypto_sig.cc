@@ -0,0 +1,72 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class CryptoSigTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `verifyMany(mode, keys, data, signatures, ...)`
+  // running a VerifyManyJob on the handles of `keys`, and returns what it
+  // left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const binding = internalBinding('crypto');\n"
+        "const { kHandle } = require('internal/crypto/util');\n"
+        "const crypto = require('crypto');\n"
+        "function verifyMany(mode, keys, data, signatures, ...options) {\n"
+        "  return new binding.VerifyManyJob(\n"
+        "      mode, keys.map((key) => key[kHandle]), data, signatures,\n"
+        "      ...options);\n"
+        "}\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// Every triple is checked on its own. One that does not verify, or cannot
+// be checked at all, does not fail the others.
+TEST_F(CryptoSigTest, VerifyMany) {
+  EXPECT_EQ(
+      Run("const a = crypto.generateKeyPairSync('ec', {\n"
+          "  namedCurve: 'P-256',\n"
+          "});\n"
+          "const b = crypto.generateKeyPairSync('rsa', {\n"
+          "  modulusLength: 1024,\n"
+          "});\n"
+          "const data = [0, 1, 2, 3].map((i) => Buffer.from(`message ${i}`));\n"
+          "const sign = (key, input, options = {}) =>\n"
+          "    crypto.sign('sha256', input, { key, ...options });\n"
+          "const tampered = sign(a.privateKey, data[1]);\n"
+          "tampered[tampered.length - 1] ^= 1;\n"
+          "const keys = [a.publicKey, a.publicKey, b.publicKey, b.publicKey];\n"
+          "const signatures = [\n"
+          "  sign(a.privateKey, data[0]), tampered,\n"
+          "  sign(b.privateKey, data[2]), sign(a.privateKey, data[3]),\n"
+          "];\n"
+          "const out = [];\n"
+          "const [err, sync] = verifyMany(\n"
+          "    binding.kCryptoJobSync, keys, data, signatures, 'sha256')\n"
+          "    .run();\n"
+          "out.push(err, sync.join(' '));\n"
+          "// P1363 signatures are converted to DER first.\n"
+          "const p1363 = data.map((input) =>\n"
+          "    sign(a.privateKey, input, { dsaEncoding: 'ieee-p1363' }));\n"
+          "out.push(verifyMany(\n"
+          "    binding.kCryptoJobSync, data.map(() => a.publicKey), data,\n"
+          "    p1363, 'sha256', undefined, undefined,\n"
+          "    binding.kSigEncP1363).run()[1].join(' '));\n"
+          "try {\n"
+          "  verifyMany(binding.kCryptoJobSync, [], [], [], 'nope');\n"
+          "} catch (err) {\n"
+          "  out.push(err.code);\n"
+          "}\n"
+          "const job = verifyMany(\n"
+          "    binding.kCryptoJobAsync, keys, data, signatures, 'sha256');\n"
+          "job.ondone = (err, result) => {\n"
+          "  out.push(err, result.join(' '));\n"
+          "  globalThis.result = out.join();\n"
+          "};\n"
+          "job.run();"),
+      ",true false true false,true true true true,"
+      "ERR_CRYPTO_INVALID_DIGEST,,true false true false");
+}
@@ -4,6 +4,7 @@
 #include <util-inl.h>
 #include <v8.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 using node::DataQueue;
@@ -658,3 +659,125 @@ TEST(DataQueue, DataQueueEntry) {
   CHECK(!pullIsPending);
   CHECK_EQ(status, node::bob::STATUS_CONTINUE);
 }
+
+static std::string ReadAll(const std::shared_ptr<DataQueue>& data_queue) {
+  std::shared_ptr<DataQueue::Reader> reader = data_queue->get_reader();
+  std::string data;
+  int status;
+  do {
+    status = reader->Pull(
+        [&](int, const DataQueue::Vec* vecs, size_t count, auto done) {
+          if (count == 0) return;
+          for (size_t i = 0; i < count; i++)
+            data.append(reinterpret_cast<char*>(vecs[i].base), vecs[i].len);
+          std::move(done)(0);
+        },
+        node::bob::OPTIONS_SYNC,
+        nullptr,
+        0,
+        node::bob::kMaxCountHint);
+  } while (status == node::bob::STATUS_CONTINUE);
+  CHECK_EQ(status, node::bob::STATUS_EOS);
+  return data;
+}
+
+TEST(DataQueue, IdempotentSlices) {
+  char buffer[] = "abcdefghij";
+  size_t len = strlen(buffer);
+  std::shared_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(
+      &buffer, len, [](void*, size_t, void*) {}, nullptr);
+
+  // Entries of 1, 2, 0, 3 and 4 bytes.
+  std::vector<std::unique_ptr<DataQueue::Entry>> list;
+  list.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(store, 0, 1));
+  list.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(store, 1, 2));
+  list.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(store, 3, 0));
+  list.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(store, 3, 3));
+  list.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(store, 6, 4));
+  std::shared_ptr<DataQueue> data_queue =
+      DataQueue::CreateIdempotent(std::move(list));
+  CHECK_NOT_NULL(data_queue);
+
+  for (size_t start = 0; start <= len; start++) {
+    for (size_t end = start; end <= len; end++) {
+      std::shared_ptr<DataQueue> slice = data_queue->slice(start, end);
+      CHECK_NOT_NULL(slice);
+      EXPECT_EQ(slice->size().value(), end - start);
+      EXPECT_EQ(ReadAll(slice), std::string(buffer + start, end - start))
+          << start << " " << end;
+    }
+  }
+
+  // Slices of slices read from the original entries.
+  std::shared_ptr<DataQueue> slice = data_queue->slice(2, 9)->slice(1);
+  EXPECT_EQ(ReadAll(slice), "defghi");
+  EXPECT_EQ(ReadAll(slice->slice(2, 4)), "fg");
+
+  // A slice of the whole queue is the queue itself.
+  EXPECT_EQ(data_queue->slice(0).get(), data_queue.get());
+
+  // Slicing an entry that starts at an offset without an end keeps the rest
+  // of the entry.
+  std::unique_ptr<DataQueue::Entry> entry =
+      DataQueue::CreateInMemoryEntryFromBackingStore(store, 2, 8);
+  std::unique_ptr<DataQueue::Entry> entry_slice = entry->slice(3);
+  EXPECT_EQ(entry_slice->size().value(), 5u);
+  std::vector<std::unique_ptr<DataQueue::Entry>> entry_list;
+  entry_list.push_back(std::move(entry_slice));
+  EXPECT_EQ(ReadAll(DataQueue::CreateIdempotent(std::move(entry_list))),
+            "fghij");
+}
+
+// The vectors that readers hand out point into the memory of the entries,
+// which the done callbacks keep referenced until they are called. QUIC
+// streams rely on that to send data straight out of their DataQueue and to
+// hold on to it, without a copy, until the peer has acknowledged it.
+TEST(DataQueue, ReadsDoNotCopy) {
+  char buffer1[] = "hello world";
+  char buffer2[] = "what fun this is";
+
+  std::shared_ptr<BackingStore> store1 = ArrayBuffer::NewBackingStore(
+      &buffer1, strlen(buffer1), [](void*, size_t, void*) {}, nullptr);
+  std::shared_ptr<BackingStore> store2 = ArrayBuffer::NewBackingStore(
+      &buffer2, strlen(buffer2), [](void*, size_t, void*) {}, nullptr);
+
+  std::vector<std::unique_ptr<DataQueue::Entry>> list;
+  list.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(store1, 6, 5));
+  list.push_back(DataQueue::CreateInMemoryEntryFromBackingStore(store2, 0, 4));
+  std::shared_ptr<DataQueue> data_queue =
+      DataQueue::CreateIdempotent(std::move(list));
+  const auto uses1 = store1.use_count();
+  const auto uses2 = store2.use_count();
+
+  std::shared_ptr<DataQueue::Reader> reader = data_queue->get_reader();
+  std::vector<DataQueue::Vec> vecs;
+  std::vector<DataQueue::Reader::Done> dones;
+  int status;
+  do {
+    status = reader->Pull(
+        [&](int, const DataQueue::Vec* data, size_t count, auto done) {
+          vecs.insert(vecs.end(), data, data + count);
+          if (count > 0) dones.push_back(std::move(done));
+        },
+        node::bob::OPTIONS_SYNC,
+        nullptr,
+        0,
+        node::bob::kMaxCountHint);
+  } while (status == node::bob::STATUS_CONTINUE);
+  EXPECT_EQ(status, node::bob::STATUS_EOS);
+
+  ASSERT_EQ(vecs.size(), 2u);
+  EXPECT_EQ(vecs[0].base, reinterpret_cast<uint8_t*>(buffer1) + 6);
+  EXPECT_EQ(vecs[0].len, 5u);
+  EXPECT_EQ(vecs[1].base, reinterpret_cast<uint8_t*>(buffer2));
+  EXPECT_EQ(vecs[1].len, 4u);
+
+  // The memory stays referenced until the data is done with.
+  EXPECT_EQ(store1.use_count(), uses1 + 1);
+  EXPECT_EQ(store2.use_count(), uses2 + 1);
+  std::move(dones[0])(0);
+  EXPECT_EQ(store1.use_count(), uses1);
+  EXPECT_EQ(store2.use_count(), uses2 + 1);
+  std::move(dones[1])(0);
+  EXPECT_EQ(store2.use_count(), uses2);
+}
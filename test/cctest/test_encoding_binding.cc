@@ -0,0 +1,96 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class EncodingBindingTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `UTF8Decoder` set to the class of the binding and
+  // `decodeInChunks(input, size, ...args)` decoding `input` in chunks of
+  // `size` bytes, and returns what it left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const { UTF8Decoder } = internalBinding('encoding_binding');\n"
+        "function decodeInChunks(input, size, ...args) {\n"
+        "  const decoder = new UTF8Decoder(...args);\n"
+        "  let out = '';\n"
+        "  for (let i = 0; i < input.length; i += size)\n"
+        "    out += decoder.decode(input.subarray(i, i + size), true);\n"
+        "  return out + decoder.decode(undefined, false);\n"
+        "}\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// However the input is split, the result is the same as that of decoding
+// it at once, including for a BOM and invalid sequences at the edges.
+TEST_F(EncodingBindingTest, UTF8DecoderStreams) {
+  EXPECT_EQ(Run("const inputs = [\n"
+                "  Buffer.from('\\ufeffa\\u00e9\\u20ac\\u{1f600}z'),\n"
+                "  Buffer.from([0x61, 0xf0, 0x9f, 0x41, 0xe2, 0x82]),\n"
+                "  Buffer.from([0xed, 0xa0, 0x80, 0xc3, 0xa9, 0xc3]),\n"
+                "];\n"
+                "const out = [];\n"
+                "for (const input of inputs) {\n"
+                "  const expected = new TextDecoder().decode(input);\n"
+                "  let same = true;\n"
+                "  for (let size = 1; size <= input.length; size++)\n"
+                "    same = same && decodeInChunks(input, size) === expected;\n"
+                "  out.push(same);\n"
+                "}\n"
+                "const kept = decodeInChunks(inputs[0], 1, true);\n"
+                "out.push(kept === inputs[0].toString());\n"
+                "globalThis.result = out.join();"),
+            "true,true,true,true");
+}
+
+TEST_F(EncodingBindingTest, UTF8DecoderFatal) {
+  EXPECT_EQ(Run("const decoder = new UTF8Decoder(false, true);\n"
+                "const input = Buffer.from([0x61, 0xc3]);\n"
+                "const out = [decoder.decode(input, true)];\n"
+                "try {\n"
+                "  decoder.decode(undefined, false);\n"
+                "} catch (err) {\n"
+                "  out.push(err.code);\n"
+                "}\n"
+                "// The decoder starts over after an error.\n"
+                "out.push(decoder.decode(Buffer.from('\\u00e9'), false));\n"
+                "try {\n"
+                "  decodeInChunks(Buffer.from([0x61, 0xff]), 1, false, true);\n"
+                "} catch (err) {\n"
+                "  out.push(err.code);\n"
+                "}\n"
+                "globalThis.result = out.join();"),
+            "a,ERR_ENCODING_INVALID_ENCODED_DATA,\xc3\xa9,"
+            "ERR_ENCODING_INVALID_ENCODED_DATA");
+}
+
+// encodeInto() reports its results through the binding of the realm, not
+// through whatever object it was called on, including once it has been
+// optimized into a fast call.
+TEST_F(EncodingBindingTest, EncodeIntoForeignReceiver) {
+  EXPECT_EQ(Run("require('v8').setFlagsFromString('--allow-natives-syntax');\n"
+                "const { encodeInto, encodeIntoResults } =\n"
+                "    internalBinding('encoding_binding');\n"
+                "const foreign = { encodeInto };\n"
+                "const dest = new Uint8Array(16);\n"
+                "const encode = new Function('foreign', 'source', 'dest', `\n"
+                "  foreign.encodeInto(source, dest);\n"
+                "`);\n"
+                "const out = [];\n"
+                "const run = () => {\n"
+                "  encodeIntoResults.fill(0);\n"
+                "  encode(foreign, 'h\\u00e9llo', dest);\n"
+                "  out.push(`${encodeIntoResults.join(' ')} ` +\n"
+                "           Buffer.from(dest.subarray(0, 6)).toString());\n"
+                "};\n"
+                "new Function('f', '%PrepareFunctionForOptimization(f)')(\n"
+                "    encode);\n"
+                "run();\n"
+                "run();\n"
+                "new Function('f', '%OptimizeFunctionOnNextCall(f)')(encode);\n"
+                "run();\n"
+                "globalThis.result = out.join();"),
+            "5 6 h\xc3\xa9llo,5 6 h\xc3\xa9llo,5 6 h\xc3\xa9llo");
+}
@@ -3,11 +3,15 @@
 #include "libplatform/libplatform.h"
 #include "util.h"
 
+#include <algorithm>
 #include <string>
 #include "gtest/gtest.h"
 #include "node_test_fixture.h"
 #include <stdio.h>
 #include <cstdio>
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 using node::AtExit;
 using node::RunAtExit;
@@ -618,6 +622,51 @@ TEST_F(EnvironmentTest, SetImmediateMicrotasks) {
   EXPECT_EQ(called, 1);
 }
 
+#ifndef _WIN32  // No pollable backend fd on Windows.
+TEST_F(EnvironmentTest, RunEventLoopOnce) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env {handle_scope, argv};
+
+  v8::Local<v8::Context> context = isolate_->GetCurrentContext();
+  node::LoadEnvironment(*env,
+                        "globalThis.ticks = 0;\n"
+                        "setTimeout(() => globalThis.ticks++, 10);\n"
+                        "setTimeout(() => globalThis.ticks++, 20);")
+      .ToLocalChecked();
+
+  int fd = node::GetEventLoopBackendFd(*env);
+  ASSERT_GE(fd, 0);
+  while (node::RunEventLoopOnce(*env).FromJust()) {
+    pollfd pfd = {fd, POLLIN, 0};
+    poll(&pfd, 1, node::GetEventLoopTimeout(*env));
+  }
+  EXPECT_EQ(node::SpinEventLoop(*env).FromJust(), 0);
+
+  v8::Local<v8::Value> ticks =
+      context->Global()
+          ->Get(context, v8::String::NewFromUtf8Literal(isolate_, "ticks"))
+          .ToLocalChecked();
+  EXPECT_EQ(ticks->Int32Value(context).FromJust(), 2);
+}
+#endif  // _WIN32
+
+TEST_F(NodeZeroIsolateTestFixture, IsolateSettingsHeapLimits) {
+  node::IsolateSettings settings;
+  settings.max_old_generation_size_in_bytes = 64 * 1024 * 1024;
+  v8::Isolate* isolate = node::NewIsolate(
+      allocator.get(), &current_loop, platform.get(), nullptr, settings);
+  CHECK_NOT_NULL(isolate);
+
+  v8::HeapStatistics stats;
+  isolate->GetHeapStatistics(&stats);
+  EXPECT_GE(stats.heap_size_limit(), 64u * 1024 * 1024);
+  EXPECT_LT(stats.heap_size_limit(), 128u * 1024 * 1024);
+
+  platform->UnregisterIsolate(isolate);
+  isolate->Dispose();
+}
+
 #ifndef _WIN32  // No SIGINT on Windows.
 TEST_F(NodeZeroIsolateTestFixture, CtrlCWithOnlySafeTerminationTest) {
   // Allocate and initialize Isolate.
@@ -803,3 +852,57 @@ TEST_F(EnvironmentTest, EmbedderPreload) {
   node::Utf8Value main_ret_str(isolate_, main_ret);
   EXPECT_EQ(std::string(*main_ret_str), "preload");
 }
+
+TEST_F(EnvironmentTest, TraceCategoryMask) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env {handle_scope, argv};
+
+  // Without a tracing agent writer there is no observer, so every category
+  // is assumed to be enabled and left for the trace event sites to check.
+  EXPECT_TRUE((*env)->is_trace_category_enabled(
+      node::Environment::kTraceAsyncHooks));
+  EXPECT_TRUE((*env)->is_trace_category_enabled(
+      node::Environment::kTracePerfEventLoop));
+
+  // Tracing is not started in the tests.
+  (*env)->UpdateTraceCategoryMask();
+  EXPECT_FALSE((*env)->is_trace_category_enabled(
+      node::Environment::kTraceAsyncHooks));
+  EXPECT_FALSE((*env)->is_trace_category_enabled(
+      node::Environment::kTraceEnvironment));
+  EXPECT_FALSE((*env)->is_trace_category_enabled(
+      node::Environment::kTracePerfEventLoop));
+}
+
+TEST_F(EnvironmentTest, ReadSlabsAreNotShared) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env {handle_scope, argv};
+  node::Environment::ReadSlab first;
+  node::Environment::ReadSlab second;
+  size_t offset;
+
+  uv_buf_t buf = (*env)->allocate_read_slab_buffer(&first, 1024);
+  memcpy(buf.base, "first", 5);
+  v8::Local<v8::ArrayBuffer> first_ab =
+      (*env)->release_read_slab_buffer(&first, buf, 5, &offset);
+  ASSERT_FALSE(first_ab.IsEmpty());
+  EXPECT_EQ(offset, 0u);
+
+  // The next read of the same stream goes into the same slab.
+  buf = (*env)->allocate_read_slab_buffer(&first, 1024);
+  EXPECT_EQ((*env)->release_read_slab_buffer(&first, buf, 0, &offset),
+            first_ab);
+  EXPECT_EQ(offset, 8u);
+
+  // Another stream gets a slab of its own, which is zeroed.
+  buf = (*env)->allocate_read_slab_buffer(&second, 1024);
+  const char* data = static_cast<const char*>(buf.base);
+  EXPECT_TRUE(std::all_of(data, data + buf.len, [](char c) { return c == 0; }));
+  v8::Local<v8::ArrayBuffer> second_ab =
+      (*env)->release_read_slab_buffer(&second, buf, 0, &offset);
+  ASSERT_FALSE(second_ab.IsEmpty());
+  EXPECT_NE(second_ab, first_ab);
+  EXPECT_EQ(offset, 0u);
+}
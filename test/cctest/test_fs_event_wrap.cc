@@ -0,0 +1,75 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+class FSEventWrapTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `dir` set to a fresh directory that holds a/b, and
+  // `watch` set to a recursive watcher of it, and returns what it left in
+  // globalThis.result. `touch(file)` writes `file` until its change has
+  // been seen, as the subdirectories are only watched once the threadpool
+  // has walked the tree.
+  std::string Run(const char* script) {
+    std::string source =
+        "const { FSEvent } = internalBinding('fs_event_wrap');\n"
+        "const fs = require('fs');\n"
+        "const os = require('os');\n"
+        "const path = require('path');\n"
+        "const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'fsevent-'));\n"
+        "fs.mkdirSync(path.join(dir, 'a', 'b'), { recursive: true });\n"
+        "const seen = new Set();\n"
+        "const watch = new FSEvent();\n"
+        "watch.onchange = (status, type, filename) => seen.add(filename);\n"
+        "const touch = (file) => new Promise((resolve, reject) => {\n"
+        "  const start = Date.now();\n"
+        "  const timer = setInterval(() => {\n"
+        "    if (seen.has(file)) {\n"
+        "      clearInterval(timer);\n"
+        "      resolve(true);\n"
+        "    } else if (Date.now() - start > 10000) {\n"
+        "      clearInterval(timer);\n"
+        "      resolve(false);\n"
+        "    } else {\n"
+        "      fs.writeFileSync(path.join(dir, file), 'x');\n"
+        "    }\n"
+        "  }, 10);\n"
+        "});\n"
+        "const done = (result) => {\n"
+        "  watch.close();\n"
+        "  fs.rmSync(dir, { recursive: true });\n"
+        "  globalThis.result = result;\n"
+        "};\n"
+        "watch.start(dir, true, true, 'utf8');\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+#ifdef __linux__
+// The tree is walked in the threadpool, and the changes in its directories
+// are reported relative to the watched one.
+TEST_F(FSEventWrapTest, WatchesExistingSubdirectories) {
+  EXPECT_EQ(Run("(async () => {\n"
+                "  const ok = [await touch('a/file')];\n"
+                "  ok.push(await touch('a/b/file'));\n"
+                "  done(ok.join());\n"
+                "})();"),
+            "true,true");
+}
+
+// Directories that are created while watching are watched as well, down to
+// the ones that were created inside of them.
+TEST_F(FSEventWrapTest, WatchesNewSubdirectories) {
+  EXPECT_EQ(Run("(async () => {\n"
+                "  await touch('file');\n"
+                "  fs.mkdirSync(path.join(dir, 'c/d'), { recursive: true });\n"
+                "  const ok = [await touch('c/file')];\n"
+                "  ok.push(await touch('c/d/file'));\n"
+                "  done(ok.join());\n"
+                "})();"),
+            "true,true");
+}
+#endif  // __linux__
@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+#include "permission/fs_permission.h"
+
+#include <string>
+
+using node::permission::FSPermission;
+
+#ifndef _WIN32
+TEST(FSPermissionRadixTree, EmptyTree) {
+  FSPermission::RadixTree tree;
+  EXPECT_FALSE(tree.Lookup("/tmp"));
+  EXPECT_TRUE(tree.Lookup("/tmp", true));
+}
+
+TEST(FSPermissionRadixTree, Files) {
+  FSPermission::RadixTree tree;
+  tree.Insert("/tmp/file.js");
+  tree.Insert("/tmp/file.json");
+  tree.Insert("/home/user/app.js");
+
+  EXPECT_TRUE(tree.Lookup("/tmp/file.js"));
+  EXPECT_TRUE(tree.Lookup("/tmp/file.json"));
+  EXPECT_TRUE(tree.Lookup("/home/user/app.js"));
+  EXPECT_FALSE(tree.Lookup("/tmp/file"));
+  EXPECT_FALSE(tree.Lookup("/tmp/file.jsx"));
+  EXPECT_FALSE(tree.Lookup("/tmp/other.js"));
+  EXPECT_FALSE(tree.Lookup("/home/user"));
+  EXPECT_FALSE(tree.Lookup("/"));
+}
+
+TEST(FSPermissionRadixTree, Wildcards) {
+  FSPermission::RadixTree tree;
+  tree.Insert("/home/user/project/*");
+  tree.Insert("/tmp/*");
+  tree.Insert("/var/log/app-*");
+
+  EXPECT_TRUE(tree.Lookup("/home/user/project"));
+  EXPECT_TRUE(tree.Lookup("/home/user/project/"));
+  EXPECT_TRUE(tree.Lookup("/home/user/project/src/index.js"));
+  EXPECT_TRUE(tree.Lookup("/tmp/a"));
+  EXPECT_TRUE(tree.Lookup("/tmp"));
+  EXPECT_TRUE(tree.Lookup("/var/log/app-1.log"));
+  EXPECT_FALSE(tree.Lookup("/home/user"));
+  EXPECT_FALSE(tree.Lookup("/home/user/other"));
+  EXPECT_FALSE(tree.Lookup("/var/log/other.log"));
+  EXPECT_FALSE(tree.Lookup("/etc/passwd"));
+}
+#endif  // _WIN32
+
+#ifndef _WIN32
+TEST(FSPermission, CachedDecisions) {
+  using node::permission::PermissionScope;
+  // Absolute paths are resolved without looking at the Environment.
+  FSPermission permission;
+  permission.Apply(nullptr,
+                   {"/nonexistent/granted.js", "/nonexistent/dir/*"},
+                   PermissionScope::kFileSystemRead);
+
+  // More paths than the cache holds, checked over and over.
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 40; i++) {
+      std::string file = "/nonexistent/dir/" + std::to_string(i);
+      EXPECT_TRUE(permission.is_granted(
+          nullptr, PermissionScope::kFileSystemRead, file));
+      EXPECT_FALSE(permission.is_granted(
+          nullptr, PermissionScope::kFileSystemWrite, file));
+      EXPECT_FALSE(permission.is_granted(nullptr,
+                                         PermissionScope::kFileSystemRead,
+                                         "/nonexistent/" + std::to_string(i)));
+    }
+    EXPECT_TRUE(permission.is_granted(
+        nullptr, PermissionScope::kFileSystemRead, "/nonexistent/granted.js"));
+    EXPECT_TRUE(permission.is_granted(nullptr,
+                                      PermissionScope::kFileSystemRead,
+                                      "/nonexistent/x/../granted.js"));
+    EXPECT_FALSE(permission.is_granted(nullptr,
+                                       PermissionScope::kFileSystemRead,
+                                       "/nonexistent/dir/../other.js"));
+  }
+
+  // Granting more access drops the cached decisions.
+  permission.Apply(
+      nullptr, {"/nonexistent/other.js"}, PermissionScope::kFileSystemRead);
+  EXPECT_TRUE(permission.is_granted(nullptr,
+                                    PermissionScope::kFileSystemRead,
+                                    "/nonexistent/dir/../other.js"));
+}
+#endif  // _WIN32
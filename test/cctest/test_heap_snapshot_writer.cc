@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include "heap_snapshot_writer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using node::heap::HeapSnapshotFileWriter;
+using node::heap::SnapshotStringTruncator;
+
+namespace {
+
+std::string Truncate(size_t max_length,
+                     const std::string& input,
+                     size_t chunk_size) {
+  SnapshotStringTruncator truncator(max_length);
+  std::string out;
+  for (size_t i = 0; i < input.size(); i += chunk_size) {
+    std::string chunk = input.substr(i, chunk_size);
+    truncator.Process(chunk.data(), chunk.size(), &out);
+  }
+  return out;
+}
+
+}  // anonymous namespace
+
+TEST(SnapshotStringTruncator, ShortensStrings) {
+  const std::string snapshot =
+      "{\"snapshot\":{\"meta\":{\"node_types\":[[\"string\"]]}},"
+      "\"nodes\":[1,2,3],\"strings\":[\"\",\"short\",\"a long string\","
+      "\"esc\\\"aped\\u00e9\",\"caf\xc3\xa9s\"]}";
+  const std::string expected =
+      "{\"snapshot\":{\"meta\":{\"node_types\":[[\"string\"]]}},"
+      "\"nodes\":[1,2,3],\"strings\":[\"\",\"short\",\"a lon...\","
+      "\"esc\\\"...\",\"caf\xc3\xa9...\"]}";
+
+  // The result must not depend on where the chunks start and end.
+  for (size_t chunk_size : {1, 2, 3, 7, 1024})
+    EXPECT_EQ(Truncate(5, snapshot, chunk_size), expected) << chunk_size;
+
+  // Nothing is cut before the "strings" table.
+  const std::string no_table = "{\"nodes\":[1],\"edges\":[\"long string\"]}";
+  EXPECT_EQ(Truncate(1, no_table, 4), no_table);
+}
+
+#ifndef _WIN32
+TEST(HeapSnapshotFileWriter, WritesToFd) {
+  char path[] = "/tmp/node-test-heap-snapshot-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+
+  // Enough output to go through the writer thread a few times.
+  std::string chunk = "[" + std::string(60000, '1') + "],";
+  std::string expected;
+  uint64_t progress = 0;
+  {
+    HeapSnapshotFileWriter writer(
+        fd, HeapSnapshotFileWriter::Compression::kNone, 0);
+    writer.SetProgressCallback(
+        [&](uint64_t bytes) {
+          progress = bytes;
+          return true;
+        },
+        1024 * 1024);
+    for (int i = 0; i < 100; i++) {
+      EXPECT_EQ(writer.WriteAsciiChunk(chunk.data(), chunk.size()),
+                v8::OutputStream::kContinue);
+      expected += chunk;
+    }
+    EXPECT_EQ(writer.Finish(), 0);
+    EXPECT_EQ(writer.bytes_serialized(), expected.size());
+  }
+  EXPECT_GT(progress, 0u);
+
+  std::string written(expected.size() + 1, '\0');
+  ASSERT_EQ(pread(fd, written.data(), written.size(), 0),
+            static_cast<ssize_t>(expected.size()));
+  written.resize(expected.size());
+  EXPECT_EQ(written, expected);
+
+  close(fd);
+  remove(path);
+}
+
+TEST(HeapSnapshotFileWriter, Gzip) {
+  char path[] = "/tmp/node-test-heap-snapshot-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+
+  std::string chunk = "{\"nodes\":[" + std::string(50000, '7') + "]}";
+  {
+    HeapSnapshotFileWriter writer(
+        fd, HeapSnapshotFileWriter::Compression::kGzip, 0);
+    for (int i = 0; i < 50; i++)
+      writer.WriteAsciiChunk(chunk.data(), chunk.size());
+    EXPECT_EQ(writer.Finish(), 0);
+  }
+
+  std::string compressed(1024 * 1024, '\0');
+  ssize_t size = pread(fd, compressed.data(), compressed.size(), 0);
+  ASSERT_GT(size, 0);
+  // Long runs of the same digit compress very well.
+  EXPECT_LT(static_cast<size_t>(size), chunk.size());
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  ASSERT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+  std::string inflated(chunk.size() * 50 + 1, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(compressed.data());
+  stream.avail_in = size;
+  stream.next_out = reinterpret_cast<Bytef*>(inflated.data());
+  stream.avail_out = inflated.size();
+  EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+  inflated.resize(stream.total_out);
+  inflateEnd(&stream);
+  EXPECT_EQ(inflated.size(), chunk.size() * 50);
+  EXPECT_EQ(inflated.substr(0, chunk.size()), chunk);
+
+  close(fd);
+  remove(path);
+}
+#endif  // _WIN32
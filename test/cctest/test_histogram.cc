@@ -0,0 +1,84 @@
+#include "gtest/gtest.h"
+#include "histogram-inl.h"
+
+#include <thread>
+#include <vector>
+
+using node::Histogram;
+
+TEST(Histogram, RecordAndRead) {
+  Histogram histogram(Histogram::Options{1, 1000});
+  EXPECT_TRUE(histogram.Record(10));
+  EXPECT_TRUE(histogram.Record(20));
+  EXPECT_TRUE(histogram.Record(30));
+  EXPECT_FALSE(histogram.Record(5000));
+
+  EXPECT_EQ(histogram.Count(), 3u);
+  EXPECT_EQ(histogram.Exceeds(), 1u);
+  EXPECT_EQ(histogram.Min(), 10);
+  EXPECT_EQ(histogram.Max(), 30);
+  EXPECT_EQ(histogram.Mean(), 20);
+  EXPECT_EQ(histogram.Percentile(50), 20);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.Count(), 0u);
+  EXPECT_EQ(histogram.Exceeds(), 0u);
+  EXPECT_EQ(histogram.Max(), 0);
+}
+
+TEST(Histogram, ConcurrentRecord) {
+  constexpr int kThreads = 32;
+  constexpr int kValues = 10000;
+  Histogram histogram(Histogram::Options{});
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; i++) {
+    threads.emplace_back([&histogram, i]() {
+      for (int value = 1; value <= kValues; value++)
+        histogram.Record(value + i * kValues);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  // Every value ends up in one of the stripes, and reading merges them.
+  EXPECT_EQ(histogram.Count(), static_cast<size_t>(kThreads * kValues));
+  EXPECT_EQ(histogram.Min(), 1);
+  // Large values are only kept at a precision of three figures.
+  EXPECT_GE(histogram.Max(), kThreads * kValues);
+  EXPECT_LT(histogram.Max(), kThreads * kValues * 1.001);
+}
+
+TEST(Histogram, Add) {
+  Histogram first(Histogram::Options{});
+  Histogram second(Histogram::Options{});
+  first.Record(5);
+  std::thread([&]() { second.Record(50); }).join();
+  second.Record(500);
+
+  EXPECT_EQ(first.Add(second), 0);
+  EXPECT_EQ(first.Count(), 3u);
+  EXPECT_EQ(first.Min(), 5);
+  EXPECT_EQ(first.Max(), 500);
+}
+
+TEST(Histogram, StripesAndMergeTarget) {
+  Histogram reference(Histogram::Options{});
+  reference.Record(1);
+  const size_t stripe_size = reference.GetMemorySize();
+
+  // A histogram that only one thread records into holds a single stripe,
+  // whichever thread that is.
+  Histogram histogram(Histogram::Options{});
+  std::thread([&]() { histogram.Record(1); }).join();
+  EXPECT_EQ(histogram.GetMemorySize(), stripe_size);
+  EXPECT_EQ(histogram.Max(), 1);
+  EXPECT_EQ(histogram.GetMemorySize(), stripe_size);
+
+  // Reading more than one stripe does not allocate anew every time.
+  histogram.Record(2);
+  EXPECT_EQ(histogram.Max(), 2);
+  const size_t size = histogram.GetMemorySize();
+  EXPECT_EQ(histogram.Min(), 1);
+  EXPECT_EQ(histogram.Max(), 2);
+  EXPECT_EQ(histogram.GetMemorySize(), size);
+}
@@ -133,6 +133,10 @@ class TestInspectorDelegate : public InspectorSocket::Delegate {
     socket_->Write(buf, len);
   }
 
+  void WriteFragment(const char* buf, size_t len, bool first, bool final) {
+    socket_->WriteFragment(buf, len, first, final);
+  }
+
   void ExpectReadError() {
     SPIN_WHILE(frames.empty() || !frames.back().empty());
   }
@@ -409,6 +413,21 @@ TEST_F(InspectorSocketTest, ReadsAndWritesInspectorMessage) {
                          reinterpret_cast<uv_handle_t*>(&client_socket)));
 }
 
+TEST_F(InspectorSocketTest, WritesFragmentedMessage) {
+  ASSERT_TRUE(connected);
+  do_write(const_cast<char*>(HANDSHAKE_REQ), sizeof(HANDSHAKE_REQ) - 1);
+  SPIN_WHILE(!delegate->inspector_ready);
+  expect_handshake();
+
+  // A text frame without the final bit, then continuation frames.
+  const char CLIENT_FRAMES[] = {'\x01', '\x02', 'a', 'b', '\x00', '\x01', 'c',
+                                '\x80', '\x01', 'd'};
+  delegate->WriteFragment("ab", 2, true, false);
+  delegate->WriteFragment("c", 1, false, false);
+  delegate->WriteFragment("d", 1, false, true);
+  expect_on_client(CLIENT_FRAMES, sizeof(CLIENT_FRAMES));
+}
+
 TEST_F(InspectorSocketTest, BufferEdgeCases) {
   do_write(const_cast<char*>(HANDSHAKE_REQ), sizeof(HANDSHAKE_REQ) - 1);
   expect_handshake();
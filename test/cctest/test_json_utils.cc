@@ -1,5 +1,7 @@
 #include "json_utils.h"
 
+#include <sstream>
+
 #include "gtest/gtest.h"
 
 TEST(JSONUtilsTest, EscapeJsonChars) {
@@ -24,3 +26,63 @@ TEST(JSONUtilsTest, EscapeJsonChars) {
     EXPECT_EQ("a" + expected[i], EscapeJsonChars("a" + input));
   }
 }
+
+TEST(JSONUtilsTest, FindJsonEscape) {
+  using node::FindJsonEscape;
+  EXPECT_EQ(FindJsonEscape(""), 0u);
+  // Put each kind of character at every position of strings that are
+  // scanned eight bytes at a time, followed by the byte by byte tail.
+  for (size_t length = 1; length <= 20; length++) {
+    for (size_t pos = 0; pos < length; pos++) {
+      for (char c : {'"', '\\', '\n', '\x1f', '\x7f', '\x80', '\xff'}) {
+        std::string str(length, 'a');
+        str[pos] = c;
+        bool escaped = c == '"' || c == '\\' || c == '\n' || c == '\x1f';
+        EXPECT_EQ(FindJsonEscape(str), escaped ? pos : length)
+            << length << " " << pos << " " << static_cast<int>(c);
+        EXPECT_EQ(FindJsonEscape(str, true), pos)
+            << length << " " << pos << " " << static_cast<int>(c);
+      }
+    }
+    EXPECT_EQ(FindJsonEscape(std::string(length, '~'), true), length);
+    EXPECT_EQ(FindJsonEscape(std::string(length, ' '), true), length);
+  }
+}
+
+TEST(JSONUtilsTest, WriteJsonChars) {
+  const std::string str = "a string that is \"long\"\nenough\\\x01";
+  std::ostringstream out;
+  node::WriteJsonChars(out, str);
+  EXPECT_EQ(out.str(), node::EscapeJsonChars(str));
+  EXPECT_EQ(out.str(),
+            "a string that is \\\"long\\\"\\nenough\\\\\\u0001");
+}
+
+TEST(JSONUtilsTest, Fragment) {
+  using node::JSONWriter;
+  for (bool compact : {false, true}) {
+    std::ostringstream expected_out;
+    JSONWriter expected(expected_out, compact);
+    expected.json_start();
+    expected.json_keyvalue("a", 1);
+    expected.json_arraystart("b");
+    expected.json_element("c");
+    expected.json_arrayend();
+    expected.json_objectend();
+
+    // The same document, with "b" written by another writer.
+    std::ostringstream out;
+    JSONWriter writer(out, compact);
+    writer.json_start();
+    writer.json_keyvalue("a", 1);
+    std::ostringstream fragment_out;
+    JSONWriter fragment(fragment_out, writer);
+    fragment.json_arraystart("b");
+    fragment.json_element("c");
+    fragment.json_arrayend();
+    writer.json_fragment(fragment_out.str());
+    writer.json_objectend();
+
+    EXPECT_EQ(out.str(), expected_out.str());
+  }
+}
@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+#include "node_log_sink.h"
+
+#include <cstdio>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using node::log_sink::LogSink;
+
+#ifndef _WIN32
+namespace {
+
+std::string ReadAll(int fd) {
+  std::string contents;
+  char buffer[4096];
+  off_t offset = 0;
+  ssize_t size;
+  while ((size = pread(fd, buffer, sizeof(buffer), offset)) > 0) {
+    contents.append(buffer, size);
+    offset += size;
+  }
+  return contents;
+}
+
+}  // anonymous namespace
+
+TEST(LogSink, WritesRecordsInOrder) {
+  char path[] = "/tmp/node-test-log-sink-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+
+  // A buffer that is much smaller than the number of records makes the
+  // writer wait for the background thread over and over.
+  std::string expected;
+  {
+    LogSink sink(fd, 4, LogSink::kBlock);
+    ASSERT_TRUE(sink.Start());
+    for (int i = 0; i < 10000; i++) {
+      std::string record = "record " + std::to_string(i) + "\n";
+      expected += record;
+      EXPECT_TRUE(sink.Write(std::move(record)));
+      if (i == 5000) {
+        sink.Flush();
+        EXPECT_EQ(ReadAll(fd), expected);
+      }
+    }
+    sink.Close();
+    EXPECT_EQ(sink.error(), 0);
+    EXPECT_EQ(sink.stats().written, 10000u);
+    EXPECT_EQ(sink.stats().dropped, 0u);
+    EXPECT_FALSE(sink.Write("after close\n"));
+  }
+  EXPECT_EQ(ReadAll(fd), expected);
+
+  close(fd);
+  remove(path);
+}
+
+TEST(LogSink, DropsRecords) {
+  char path[] = "/tmp/node-test-log-sink-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+
+  LogSink sink(fd, 2, LogSink::kDrop);
+  ASSERT_TRUE(sink.Start());
+  size_t accepted = 0;
+  for (int i = 0; i < 10000; i++) {
+    if (sink.Write(std::string(100, 'x') + "\n")) accepted++;
+  }
+  sink.Close();
+  LogSink::Stats stats = sink.stats();
+  EXPECT_EQ(stats.written, accepted);
+  EXPECT_EQ(stats.written + stats.dropped, 10000u);
+  EXPECT_EQ(stats.blocked, 0u);
+  // Only whole records are written.
+  EXPECT_EQ(ReadAll(fd).size(), accepted * 101);
+
+  close(fd);
+  remove(path);
+}
+
+TEST(LogSink, WriteError) {
+  char path[] = "/tmp/node-test-log-sink-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  close(fd);
+  remove(path);
+
+  // `fd` is closed, so the first write fails and everything after it is
+  // dropped.
+  LogSink sink(fd, 16, LogSink::kBlock);
+  ASSERT_TRUE(sink.Start());
+  for (int i = 0; i < 100; i++) sink.Write("record\n");
+  sink.Flush();
+  EXPECT_EQ(sink.error(), UV_EBADF);
+  sink.Close();
+  EXPECT_EQ(sink.stats().written, 0u);
+  EXPECT_EQ(sink.stats().dropped, 100u);
+}
+
+TEST(LogSink, FlushAll) {
+  char path[] = "/tmp/node-test-log-sink-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+
+  LogSink sink(fd, 64, LogSink::kBlock);
+  ASSERT_TRUE(sink.Start());
+  for (int i = 0; i < 50; i++) sink.Write("line\n");
+  LogSink::FlushAll();
+  EXPECT_EQ(ReadAll(fd).size(), 250u);
+  sink.Close();
+
+  close(fd);
+  remove(path);
+}
+#endif  // _WIN32
@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "histogram-inl.h"
+#include "node_metrics.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using node::metrics::Metric;
+using node::metrics::Registry;
+using node::metrics::StatsDEncoder;
+
+TEST(Metrics, Names) {
+  EXPECT_TRUE(Registry::IsValidName("http.requests_total"));
+  EXPECT_TRUE(Registry::IsValidName("_a1"));
+  EXPECT_FALSE(Registry::IsValidName(""));
+  EXPECT_FALSE(Registry::IsValidName("1a"));
+  EXPECT_FALSE(Registry::IsValidName(".a"));
+  EXPECT_FALSE(Registry::IsValidName("a:b"));
+  EXPECT_FALSE(Registry::IsValidName("a|b"));
+}
+
+TEST(Metrics, Registry) {
+  Registry registry;
+  int requests = registry.Get("requests", Metric::kCounter);
+  int memory = registry.Get("memory", Metric::kGauge);
+  ASSERT_EQ(requests, 0);
+  ASSERT_EQ(memory, 1);
+  EXPECT_EQ(registry.Get("requests", Metric::kCounter), requests);
+  EXPECT_EQ(registry.Get("requests", Metric::kGauge), -1);
+  EXPECT_EQ(registry.Get("a b", Metric::kGauge), -1);
+  // Both would be called a_b in Prometheus.
+  EXPECT_EQ(registry.Get("a.b", Metric::kGauge), 2);
+  EXPECT_EQ(registry.Get("a_b", Metric::kGauge), -1);
+  EXPECT_EQ(registry.Get("a.b", Metric::kGauge), 2);
+  EXPECT_EQ(registry.size(), 3u);
+  EXPECT_EQ(registry.metric(3), nullptr);
+  EXPECT_EQ(registry.metric(-1), nullptr);
+}
+
+TEST(Metrics, CounterThreads) {
+  Registry registry;
+  Metric* metric = registry.metric(registry.Get("a", Metric::kCounter));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 10000; j++) metric->counter.Add(1);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(metric->counter.Value(), 40000);
+}
+
+TEST(Metrics, StatsD) {
+  Registry registry;
+  Metric* requests =
+      registry.metric(registry.Get("requests", Metric::kCounter));
+  Metric* offset = registry.metric(registry.Get("offset", Metric::kGauge));
+  Metric* latency =
+      registry.metric(registry.Get("latency", Metric::kHistogram));
+
+  StatsDEncoder encoder("app.");
+  requests->counter.Add(5);
+  offset->gauge = -2.5;
+  latency->histogram->Record(10);
+  std::vector<std::string> packets;
+  encoder.Encode(&registry, &packets);
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_EQ(packets[0],
+            "app.requests:5|c\n"
+            "app.offset:0|g\n"
+            "app.offset:-2.5|g\n"
+            "app.latency.count:1|g\n"
+            "app.latency.min:10|g\n"
+            "app.latency.max:10|g\n"
+            "app.latency.mean:10|g\n"
+            "app.latency.p50:10|g\n"
+            "app.latency.p90:10|g\n"
+            "app.latency.p99:10|g");
+
+  // Counters are sent as deltas, and histograms are reset.
+  requests->counter.Add(2);
+  offset->gauge = 1;
+  packets.clear();
+  encoder.Encode(&registry, &packets);
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_EQ(packets[0], "app.requests:2|c\napp.offset:1|g");
+  latency->histogram->Read([](const node::Histogram& histogram) {
+    EXPECT_EQ(histogram.Count(), 0u);
+  });
+}
+
+// Flushing does not lose or count twice the values that other threads
+// record meanwhile.
+TEST(Metrics, StatsDHistogramThreads) {
+  Registry registry;
+  Metric* latency = registry.metric(registry.Get("l", Metric::kHistogram));
+  std::atomic<int> running{4};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 10000; j++) latency->histogram->Record(j + 1);
+      running--;
+    });
+  }
+
+  StatsDEncoder encoder("");
+  size_t count = 0;
+  bool done;
+  do {
+    done = running == 0;
+    std::vector<std::string> packets;
+    encoder.Encode(&registry, &packets);
+    if (!packets.empty()) {
+      // The first line is "l.count:N|g".
+      count += std::stoul(packets[0].substr(strlen("l.count:")));
+    }
+  } while (!done);
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(count, 40000u);
+}
+
+TEST(Metrics, StatsDPackets) {
+  Registry registry;
+  for (int i = 0; i < 10; i++) {
+    std::string name = "counter" + std::to_string(i);
+    registry.metric(registry.Get(name, Metric::kCounter))->counter.Add(1);
+  }
+
+  // "counterN:1|c" is 12 bytes, so three lines fit into 40 bytes.
+  StatsDEncoder encoder("", 40);
+  std::vector<std::string> packets;
+  encoder.Encode(&registry, &packets);
+  ASSERT_EQ(packets.size(), 4u);
+  EXPECT_EQ(packets[0], "counter0:1|c\ncounter1:1|c\ncounter2:1|c");
+  EXPECT_EQ(packets[3], "counter9:1|c");
+}
+
+TEST(Metrics, Prometheus) {
+  Registry registry;
+  registry.metric(registry.Get("http.requests", Metric::kCounter))
+      ->counter.Add(3);
+  registry.metric(registry.Get("load", Metric::kGauge))->gauge = 0.5;
+  registry.metric(registry.Get("latency", Metric::kHistogram))
+      ->histogram->Record(7);
+
+  EXPECT_EQ(EncodePrometheus(registry),
+            "# TYPE http_requests counter\n"
+            "http_requests 3\n"
+            "# TYPE load gauge\n"
+            "load 0.5\n"
+            "# TYPE latency summary\n"
+            "latency{quantile=\"0.5\"} 7\n"
+            "latency{quantile=\"0.9\"} 7\n"
+            "latency{quantile=\"0.99\"} 7\n"
+            "latency_count 1\n");
+}
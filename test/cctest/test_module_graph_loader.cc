@@ -0,0 +1,165 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "module_graph_loader.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+#include "node_url.h"
+#include "permission/permission.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using node::loader::ModuleGraphLoader;
+using v8::Context;
+using v8::Function;
+using v8::Local;
+using v8::Map;
+using v8::String;
+using v8::TryCatch;
+using v8::Value;
+
+namespace {
+
+class ModuleGraphLoaderTest : public EnvironmentTestFixture {
+ protected:
+  void SetUp() override {
+    EnvironmentTestFixture::SetUp();
+    char tmpdir[PATH_MAX_BYTES];
+    size_t size = sizeof(tmpdir);
+    ASSERT_EQ(uv_os_tmpdir(tmpdir, &size), 0);
+    uv_fs_t req;
+    std::string templ = std::string(tmpdir, size) + "/graphXXXXXX";
+    ASSERT_EQ(uv_fs_mkdtemp(nullptr, &req, templ.c_str(), nullptr), 0);
+    uv_fs_req_cleanup(&req);
+    // Module URLs are those of real paths.
+    ASSERT_EQ(uv_fs_realpath(nullptr, &req, templ.c_str(), nullptr), 0);
+    dir_ = static_cast<const char*>(req.ptr);
+    uv_fs_req_cleanup(&req);
+  }
+
+  void TearDown() override {
+    uv_fs_t req;
+    for (auto it = created_.rbegin(); it != created_.rend(); ++it) {
+      if (uv_fs_unlink(nullptr, &req, it->c_str(), nullptr) != 0) {
+        uv_fs_req_cleanup(&req);
+        uv_fs_rmdir(nullptr, &req, it->c_str(), nullptr);
+      }
+      uv_fs_req_cleanup(&req);
+    }
+    uv_fs_rmdir(nullptr, &req, dir_.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+    EnvironmentTestFixture::TearDown();
+  }
+
+  std::string Path(const std::string& name) { return dir_ + "/" + name; }
+
+  void MakeDirectory(const std::string& name) {
+    uv_fs_t req;
+    ASSERT_EQ(uv_fs_mkdir(nullptr, &req, Path(name).c_str(), 0755, nullptr),
+              0);
+    uv_fs_req_cleanup(&req);
+    created_.push_back(Path(name));
+  }
+
+  void WriteFile(const std::string& name, const std::string& contents) {
+    uv_buf_t buf =
+        uv_buf_init(const_cast<char*>(contents.data()), contents.size());
+    ASSERT_EQ(node::WriteFileSync(Path(name).c_str(), buf), 0);
+    created_.push_back(Path(name));
+  }
+
+  // Returns the number of modules that loadModuleGraph() loaded, or -1 if it
+  // left the graph to the JavaScript loader, or -2 if it threw.
+  int LoadGraph(node::Environment* env, const std::string& name) {
+    Local<Context> context = env->context();
+    Local<Function> load =
+        Function::New(context, ModuleGraphLoader::LoadModuleGraph)
+            .ToLocalChecked();
+    std::string url = node::url::FromFilePath(Path(name));
+    Local<Value> argv[] = {
+        String::NewFromUtf8(isolate_, url.c_str()).ToLocalChecked(),
+        Map::New(isolate_),
+    };
+    TryCatch try_catch(isolate_);
+    Local<Value> result;
+    if (!load->Call(context, context->Global(), node::arraysize(argv), argv)
+             .ToLocal(&result)) {
+      EXPECT_TRUE(try_catch.HasCaught());
+      return -2;
+    }
+    if (result->IsUndefined()) return -1;
+    EXPECT_TRUE(result->IsArray());
+    return result.As<v8::Array>()->Length();
+  }
+
+  std::string dir_;
+  std::vector<std::string> created_;
+};
+
+}  // anonymous namespace
+
+TEST_F(ModuleGraphLoaderTest, LoadsStaticGraphs) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  node::LoadEnvironment(*env, "").ToLocalChecked();
+
+  WriteFile("a.mjs", "import { b } from './b.mjs'; import './c.mjs';");
+  // Larger than one chunk of a streamed source.
+  WriteFile("b.mjs",
+            "import './c.mjs'; export const b = 1;\n" +
+                std::string(100 * 1024, ' '));
+  WriteFile("c.mjs", "export default 1;");
+  WriteFile("bare.mjs", "import 'fs';");
+  WriteFile("broken.mjs", "import './c.mjs'; export {;");
+  WriteFile("imports-broken.mjs", "import './broken.mjs';");
+
+  EXPECT_EQ(LoadGraph(*env, "a.mjs"), 3);
+  EXPECT_EQ(LoadGraph(*env, "c.mjs"), 1);
+  // Bare specifiers and missing files are left to the JavaScript loader.
+  EXPECT_EQ(LoadGraph(*env, "bare.mjs"), -1);
+  EXPECT_EQ(LoadGraph(*env, "missing.mjs"), -1);
+  // Syntax errors are thrown, in dependencies too.
+  EXPECT_EQ(LoadGraph(*env, "broken.mjs"), -2);
+  EXPECT_EQ(LoadGraph(*env, "imports-broken.mjs"), -2);
+}
+
+#ifndef _WIN32
+TEST_F(ModuleGraphLoaderTest, ChecksPermissionsOfRealPaths) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  node::LoadEnvironment(*env, "").ToLocalChecked();
+
+  MakeDirectory("allowed");
+  MakeDirectory("secret");
+  WriteFile("allowed/a.mjs", "import './b.mjs';");
+  WriteFile("allowed/b.mjs", "export default 1;");
+  WriteFile("allowed/imports-secret.mjs", "import '../secret/s.mjs';");
+  WriteFile("allowed/imports-link.mjs", "import './link.mjs';");
+  WriteFile("secret/s.mjs", "export default 2;");
+  ASSERT_EQ(symlink(Path("secret/s.mjs").c_str(),
+                    Path("allowed/link.mjs").c_str()),
+            0);
+  created_.push_back(Path("allowed/link.mjs"));
+
+  node::permission::Permission* permission = (*env)->permission();
+  permission->EnablePermissions();
+  permission->Apply(*env,
+                    {Path("allowed/*")},
+                    node::permission::PermissionScope::kFileSystemRead);
+
+  EXPECT_EQ(LoadGraph(*env, "allowed/a.mjs"), 2);
+  // The JavaScript loader reports these.
+  EXPECT_EQ(LoadGraph(*env, "secret/s.mjs"), -1);
+  EXPECT_EQ(LoadGraph(*env, "allowed/imports-secret.mjs"), -1);
+  EXPECT_EQ(LoadGraph(*env, "allowed/link.mjs"), -1);
+  EXPECT_EQ(LoadGraph(*env, "allowed/imports-link.mjs"), -1);
+}
+#endif  // _WIN32
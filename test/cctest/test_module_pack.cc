@@ -0,0 +1,152 @@
+#include "node_internals.h"
+#include "node_module_pack.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+using node::kPathSeparator;
+using node::module_pack::Entry;
+using node::module_pack::EntryKind;
+using node::module_pack::LookupResult;
+using node::module_pack::ModulePack;
+using node::module_pack::ModulePackBuilder;
+
+namespace {
+
+#ifdef _WIN32
+const std::string kRoot = "C:\\app";
+#else
+const std::string kRoot = "/app";
+#endif
+
+std::string Join(const std::string& relative) {
+  std::string path = kRoot + kPathSeparator;
+  for (char c : relative) path += c == '/' ? kPathSeparator : c;
+  return path;
+}
+
+std::string BuildPack() {
+  ModulePackBuilder builder;
+  builder.AddFile("index.js", "require('./lib/a');", "cache");
+  builder.AddDirectory("lib");
+  builder.AddFile("lib/a.js", "module.exports = 1;");
+  builder.AddFile("package.json", "{\"type\":\"commonjs\"}");
+  builder.AddExternal("lib/addon.node");
+  return builder.Finish();
+}
+
+}  // anonymous namespace
+
+TEST(ModulePackTest, Lookup) {
+  const std::string data = BuildPack();
+  std::unique_ptr<ModulePack> pack = ModulePack::Parse(kRoot, data);
+  ASSERT_TRUE(pack);
+  EXPECT_EQ(pack->entry_count(), 5u);
+
+  Entry entry;
+  ASSERT_EQ(pack->Lookup(Join("index.js"), &entry), LookupResult::kFound);
+  EXPECT_EQ(entry.kind, EntryKind::kFile);
+  EXPECT_EQ(entry.contents, "require('./lib/a');");
+  EXPECT_EQ(entry.code_cache, "cache");
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(entry.code_cache.data()) % 8, 0u);
+
+  ASSERT_EQ(pack->Lookup(Join("lib/a.js"), &entry), LookupResult::kFound);
+  EXPECT_EQ(entry.contents, "module.exports = 1;");
+  EXPECT_TRUE(entry.code_cache.empty());
+
+  ASSERT_EQ(pack->Lookup(Join("lib"), &entry), LookupResult::kFound);
+  EXPECT_EQ(entry.kind, EntryKind::kDirectory);
+  ASSERT_EQ(pack->Lookup(kRoot, &entry), LookupResult::kFound);
+  EXPECT_EQ(entry.kind, EntryKind::kDirectory);
+  ASSERT_EQ(pack->Lookup(Join("lib/addon.node"), &entry), LookupResult::kFound);
+  EXPECT_EQ(entry.kind, EntryKind::kExternal);
+  EXPECT_TRUE(entry.contents.empty());
+
+  EXPECT_EQ(pack->Lookup(Join("lib/b.js"), &entry), LookupResult::kNotFound);
+  EXPECT_EQ(pack->Lookup(Join("lib/a.js/x"), &entry),
+            LookupResult::kNotFound);
+  EXPECT_EQ(pack->Lookup(kRoot + "x", &entry), LookupResult::kOutside);
+  EXPECT_EQ(pack->Lookup(Join("lib/../index.js"), &entry),
+            LookupResult::kOutside);
+  EXPECT_EQ(pack->Lookup(Join("lib/"), &entry), LookupResult::kOutside);
+}
+
+TEST(ModulePackTest, Empty) {
+  const std::string data = ModulePackBuilder().Finish();
+  std::unique_ptr<ModulePack> pack = ModulePack::Parse(kRoot, data);
+  ASSERT_TRUE(pack);
+  Entry entry;
+  EXPECT_EQ(pack->Lookup(Join("index.js"), &entry), LookupResult::kNotFound);
+}
+
+TEST(ModulePackTest, Invalid) {
+  const std::string data = BuildPack();
+  EXPECT_FALSE(ModulePack::Parse(kRoot, ""));
+  EXPECT_FALSE(ModulePack::Parse(kRoot, data.substr(0, 40)));
+
+  // A path that points past the end of the pack.
+  std::string corrupt = data;
+  corrupt[16] = '\xff';
+  corrupt[17] = '\xff';
+  EXPECT_FALSE(ModulePack::Parse(kRoot, corrupt));
+
+  std::string wrong_version = data;
+  wrong_version[4] = 1;
+  EXPECT_FALSE(ModulePack::Parse(kRoot, wrong_version));
+}
+
+TEST(ModulePackTest, OutOfDateFiles) {
+  char tmpdir[PATH_MAX_BYTES];
+  size_t size = sizeof(tmpdir);
+  ASSERT_EQ(uv_os_tmpdir(tmpdir, &size), 0);
+  uv_fs_t req;
+  std::string templ = std::string(tmpdir, size) + kPathSeparator + "packXXXXXX";
+  ASSERT_EQ(uv_fs_mkdtemp(nullptr, &req, templ.c_str(), nullptr), 0);
+  const std::string root = req.path;
+  uv_fs_req_cleanup(&req);
+  const std::string file = root + kPathSeparator + "a.js";
+  auto defer_cleanup = node::OnScopeLeave([&]() {
+    uv_fs_t cleanup_req;
+    uv_fs_unlink(nullptr, &cleanup_req, file.c_str(), nullptr);
+    uv_fs_req_cleanup(&cleanup_req);
+    uv_fs_rmdir(nullptr, &cleanup_req, root.c_str(), nullptr);
+    uv_fs_req_cleanup(&cleanup_req);
+  });
+
+  const std::string contents = "module.exports = 1;";
+  auto write_file = [&](const std::string& data) {
+    uv_buf_t buf = uv_buf_init(const_cast<char*>(data.data()), data.size());
+    return node::WriteFileSync(file.c_str(), buf);
+  };
+  ASSERT_EQ(write_file(contents), 0);
+  ASSERT_EQ(uv_fs_stat(nullptr, &req, file.c_str(), nullptr), 0);
+  const uint64_t mtime_ns =
+      static_cast<uint64_t>(req.statbuf.st_mtim.tv_sec) * 1000000000 +
+      req.statbuf.st_mtim.tv_nsec;
+  uv_fs_req_cleanup(&req);
+
+  ModulePackBuilder builder;
+  builder.AddFile("a.js", contents, {}, mtime_ns);
+  builder.AddFile("b.js", "module.exports = 2;");
+  const std::string data = builder.Finish();
+
+  Entry entry;
+  std::unique_ptr<ModulePack> pack = ModulePack::Parse(root, data);
+  ASSERT_TRUE(pack);
+  pack->CheckAgainstDisk();
+  EXPECT_EQ(pack->Lookup(file, &entry), LookupResult::kFound);
+  // Without a modification time there is nothing to check.
+  EXPECT_EQ(pack->Lookup(root + kPathSeparator + "b.js", &entry),
+            LookupResult::kFound);
+
+  // A file that changed since it was packed is left to the file system.
+  ASSERT_EQ(write_file(contents + "\n"), 0);
+  pack = ModulePack::Parse(root, data);
+  ASSERT_TRUE(pack);
+  EXPECT_EQ(pack->Lookup(file, &entry), LookupResult::kFound);
+  pack->CheckAgainstDisk();
+  EXPECT_EQ(pack->Lookup(file, &entry), LookupResult::kNotFound);
+}
@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+#include "mpsc_queue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using node::MPSCQueue;
+
+TEST(MPSCQueue, PushAndPop) {
+  MPSCQueue<std::unique_ptr<int>> queue;
+  EXPECT_TRUE(queue.IsEmpty());
+
+  std::unique_ptr<int> value;
+  EXPECT_FALSE(queue.Pop(&value));
+
+  // Run the queue empty a few times, so that the stub node is put back.
+  int next_push = 0;
+  int next_pop = 0;
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < round; i++) {
+      queue.Push(std::make_unique<int>(next_push++));
+    }
+    EXPECT_EQ(queue.IsEmpty(), round == 0);
+    while (queue.Pop(&value)) EXPECT_EQ(*value, next_pop++);
+    EXPECT_EQ(next_pop, next_push);
+    EXPECT_TRUE(queue.IsEmpty());
+  }
+
+  // Values that are left behind are destroyed with the queue.
+  queue.Push(std::make_unique<int>(1));
+  queue.Push(std::make_unique<int>(2));
+}
+
+TEST(MPSCQueue, ManyProducers) {
+  constexpr size_t kProducers = 4;
+  constexpr size_t kCount = 50000;
+  MPSCQueue<size_t> queue;
+
+  std::vector<std::thread> producers;
+  for (size_t producer = 0; producer < kProducers; producer++) {
+    producers.emplace_back([&queue, producer]() {
+      for (size_t i = 0; i < kCount; i++) queue.Push(producer * kCount + i);
+    });
+  }
+
+  // Each producer's values arrive in the order in which it pushed them.
+  std::vector<size_t> next(kProducers, 0);
+  size_t received = 0;
+  while (received < kProducers * kCount) {
+    size_t item;
+    if (!queue.Pop(&item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    size_t producer = item / kCount;
+    ASSERT_LT(producer, kProducers);
+    ASSERT_EQ(item % kCount, next[producer]);
+    next[producer]++;
+    received++;
+  }
+  for (std::thread& producer : producers) producer.join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
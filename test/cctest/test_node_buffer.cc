@@ -0,0 +1,54 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+class NodeBufferTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `indexOfAny` set to the binding, and `haystack` and
+  // `needles` set up for it, and returns what it left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "globalThis.indexOfAny = internalBinding('buffer').indexOfAny;\n"
+        "globalThis.haystack = Buffer.from('key=value;next\\r\\n');\n"
+        "globalThis.needles =\n"
+        "    [';', '\\r\\n', '='].map((s) => Buffer.from(s));\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// The first match of any needle is found, along with which needle that was
+// when asked for.
+TEST_F(NodeBufferTest, IndexOfAny) {
+  EXPECT_EQ(Run("globalThis.result = [\n"
+                "  indexOfAny(haystack, needles, 0, false),\n"
+                "  indexOfAny(haystack, needles, 0, true),\n"
+                "  indexOfAny(haystack, needles, 4, true),\n"
+                "  indexOfAny(haystack, needles, 10, true),\n"
+                "  indexOfAny(haystack, [Buffer.from('z')], 0, true),\n"
+                "  indexOfAny(haystack, [], 0, false),\n"
+                "].join(' ');"),
+            "3 3,2 9,0 14,1 -1,0 -1");
+}
+
+#if HAVE_INSPECTOR
+// It writes to none of its arguments, so it can be called where side
+// effects are not allowed, e.g. when the inspector previews an expression.
+TEST_F(NodeBufferTest, IndexOfAnyHasNoSideEffect) {
+  EXPECT_EQ(Run("const { Session } = require('inspector');\n"
+                "const session = new Session();\n"
+                "session.connect();\n"
+                "session.post('Runtime.evaluate', {\n"
+                "  expression: 'indexOfAny(haystack, needles, 4, true)[0]',\n"
+                "  throwOnSideEffect: true,\n"
+                "}, (error, { result, exceptionDetails }) => {\n"
+                "  globalThis.result = error?.message ??\n"
+                "      exceptionDetails?.text ?? result.value;\n"
+                "  session.disconnect();\n"
+                "});"),
+            "9");
+}
+#endif  // HAVE_INSPECTOR
@@ -0,0 +1,104 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_contextify.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+using node::contextify::IsPersistentScriptFilename;
+using node::contextify::ScriptCache;
+using v8::Context;
+using v8::Local;
+using v8::ScriptCompiler;
+using v8::String;
+using v8::Symbol;
+using v8::UnboundScript;
+
+class ScriptCacheTest : public EnvironmentTestFixture {
+ protected:
+  Local<String> Str(const std::string& value) {
+    return String::NewFromUtf8(isolate_, value.c_str()).ToLocalChecked();
+  }
+
+  Local<UnboundScript> Compile(Local<String> code) {
+    ScriptCompiler::Source source(code);
+    return ScriptCompiler::CompileUnboundScript(isolate_, &source)
+        .ToLocalChecked();
+  }
+};
+
+TEST(ScriptCacheFilenameTest, OnlyFilesArePersistent) {
+  EXPECT_TRUE(IsPersistentScriptFilename("/app/index.js"));
+  EXPECT_TRUE(IsPersistentScriptFilename("file:///app/index.mjs"));
+  EXPECT_FALSE(IsPersistentScriptFilename(""));
+  EXPECT_FALSE(IsPersistentScriptFilename("evalmachine.<anonymous>"));
+  EXPECT_FALSE(IsPersistentScriptFilename("REPL3"));
+  EXPECT_FALSE(IsPersistentScriptFilename("[eval]"));
+  EXPECT_FALSE(IsPersistentScriptFilename("[eval]-wrapper"));
+  EXPECT_FALSE(IsPersistentScriptFilename("[stdin]"));
+  EXPECT_FALSE(IsPersistentScriptFilename("[worker eval]"));
+  EXPECT_FALSE(IsPersistentScriptFilename("index.js"));
+#ifdef _WIN32
+  EXPECT_TRUE(IsPersistentScriptFilename("C:\\app\\index.js"));
+  EXPECT_TRUE(IsPersistentScriptFilename("\\\\server\\share\\index.js"));
+#endif
+}
+
+// A script is only reused for the same source, filename, offsets and
+// host-defined options.
+TEST_F(ScriptCacheTest, MatchesAllOrigins) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  Context::Scope context_scope(env.context());
+
+  ScriptCache cache;
+  Local<String> code = Str("1 + 1");
+  Local<String> filename = Str("/app/a.js");
+  Local<Symbol> id = Symbol::New(isolate_);
+  Local<UnboundScript> script = Compile(code);
+  cache.Put(isolate_, code, filename, 0, 0, id, script);
+
+  Local<UnboundScript> found;
+  ASSERT_TRUE(cache.Get(isolate_, Str("1 + 1"), Str("/app/a.js"), 0, 0, id)
+                  .ToLocal(&found));
+  EXPECT_EQ(found, script);
+  EXPECT_TRUE(
+      cache.Get(isolate_, Str("1 + 2"), filename, 0, 0, id).IsEmpty());
+  EXPECT_TRUE(
+      cache.Get(isolate_, code, Str("/app/b.js"), 0, 0, id).IsEmpty());
+  EXPECT_TRUE(cache.Get(isolate_, code, filename, 1, 0, id).IsEmpty());
+  EXPECT_TRUE(cache.Get(isolate_, code, filename, 0, 1, id).IsEmpty());
+  EXPECT_TRUE(cache.Get(isolate_, code, filename, 0, 0, Symbol::New(isolate_))
+                  .IsEmpty());
+}
+
+// The cache holds on to at most kMaxEntries scripts, dropping the least
+// recently used one first.
+TEST_F(ScriptCacheTest, EvictsLeastRecentlyUsed) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  Context::Scope context_scope(env.context());
+
+  ScriptCache cache;
+  Local<Symbol> id = Symbol::New(isolate_);
+  auto code = [&](size_t i) { return Str(std::to_string(i)); };
+  auto filename = [&](size_t i) {
+    return Str("/app/" + std::to_string(i) + ".js");
+  };
+  for (size_t i = 0; i < ScriptCache::kMaxEntries; i++) {
+    cache.Put(isolate_, code(i), filename(i), 0, 0, id, Compile(code(i)));
+  }
+  // Using the oldest entry keeps it over the second oldest.
+  EXPECT_FALSE(cache.Get(isolate_, code(0), filename(0), 0, 0, id).IsEmpty());
+
+  size_t next = ScriptCache::kMaxEntries;
+  cache.Put(isolate_, code(next), filename(next), 0, 0, id,
+            Compile(code(next)));
+  EXPECT_FALSE(cache.Get(isolate_, code(0), filename(0), 0, 0, id).IsEmpty());
+  EXPECT_TRUE(cache.Get(isolate_, code(1), filename(1), 0, 0, id).IsEmpty());
+  EXPECT_FALSE(
+      cache.Get(isolate_, code(next), filename(next), 0, 0, id).IsEmpty());
+}
@@ -0,0 +1,149 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class DirCopyTest : public EnvironmentTestFixture {};
+
+#ifndef _WIN32
+// Copied directories end up with the mode of the original, as mkdir()
+// would have made it, even if that keeps their contents from being written.
+// Relative links point to what the original points to, unless they are
+// copied verbatim.
+TEST_F(DirCopyTest, ModesAndSymlinks) {
+  std::string result = RunScriptAndGetResult(
+      "const { DirCopy } = internalBinding('fs_dir');\n"
+      "const fs = require('fs');\n"
+      "const os = require('os');\n"
+      "const path = require('path');\n"
+      "const tmp = fs.mkdtempSync(path.join(os.tmpdir(), 'dircopy-'));\n"
+      "const src = path.join(tmp, 'src');\n"
+      "fs.mkdirSync(path.join(src, 'sub'), { recursive: true });\n"
+      "fs.writeFileSync(path.join(src, 'sub', 'file'), 'x');\n"
+      "fs.symlinkSync('sub/file', path.join(src, 'link'));\n"
+      "fs.chmodSync(path.join(src, 'sub'), 0o555);\n"
+      "fs.chmodSync(src, 0o751);\n"
+      "const mask = process.umask(0o027);\n"
+      "const copy = (dest, verbatim, callback) => {\n"
+      "  const cp = new DirCopy();\n"
+      "  cp.onprogress = () => {};\n"
+      "  cp.oncomplete = (err) => callback(err);\n"
+      "  cp.start(src, dest, 2, 0, verbatim);\n"
+      "};\n"
+      "const mode = (file) => fs.statSync(file).mode & 0o7777;\n"
+      "const a = path.join(tmp, 'a');\n"
+      "const b = path.join(tmp, 'b');\n"
+      "copy(a, false, (err) => {\n"
+      "  const out = [err, mode(a).toString(8),\n"
+      "               mode(path.join(a, 'sub')).toString(8),\n"
+      "               fs.readFileSync(path.join(a, 'sub', 'file'), 'utf8'),\n"
+      "               fs.readlinkSync(path.join(a, 'link')) ===\n"
+      "                   path.join(src, 'sub', 'file')];\n"
+      "  copy(b, true, (err) => {\n"
+      "    out.push(err, fs.readlinkSync(path.join(b, 'link')));\n"
+      "    process.umask(mask);\n"
+      "    for (const dir of [src, a, b])\n"
+      "      fs.chmodSync(path.join(dir, 'sub'), 0o755);\n"
+      "    fs.rmSync(tmp, { recursive: true });\n"
+      "    globalThis.result = out.join();\n"
+      "  });\n"
+      "});\n");
+  EXPECT_EQ(result, ",750,550,x,true,,sub/file");
+}
+#endif  // _WIN32
+
+class DirWalkTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `tmp` set to a new temporary directory, and `walk(
+  // root, concurrency, withStats)` resolving to the entries and stats of a
+  // DirWalk and the error it completed with. Returns what the script left
+  // in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const { DirWalk } = internalBinding('fs_dir');\n"
+        "const fs = require('fs');\n"
+        "const os = require('os');\n"
+        "const path = require('path');\n"
+        "const tmp = fs.mkdtempSync(path.join(os.tmpdir(), 'dirwalk-'));\n"
+        "const walk = (root, concurrency, withStats) =>\n"
+        "    new Promise((resolve) => {\n"
+        "      const entries = [];\n"
+        "      const stats = [];\n"
+        "      const walk = new DirWalk();\n"
+        "      walk.onentries = (batch, batchStats) => {\n"
+        "        entries.push(...batch);\n"
+        "        if (batchStats) stats.push(...batchStats);\n"
+        "      };\n"
+        "      walk.oncomplete = (err) => resolve({ entries, stats, err });\n"
+        "      walk.start(root, 'utf8', concurrency, withStats);\n"
+        "    });\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+#ifndef _WIN32
+// The walk finds what a recursive readdir() finds, over several batches
+// and threads, and does not follow links.
+TEST_F(DirWalkTest, Walk) {
+  EXPECT_EQ(
+      Run("for (let i = 0; i < 6; i++) {\n"
+          "  const dir = path.join(tmp, `d${i}`, `e${i % 2}`);\n"
+          "  fs.mkdirSync(dir, { recursive: true });\n"
+          "  for (let j = 0; j < 300; j++)\n"
+          "    fs.writeFileSync(path.join(dir, `f${j}`), 'x'.repeat(j));\n"
+          "}\n"
+          "fs.symlinkSync(path.join(tmp, 'd0'), path.join(tmp, 'link'));\n"
+          "const { UV_DIRENT_FILE, UV_DIRENT_DIR, UV_DIRENT_LINK } =\n"
+          "    fs.constants;\n"
+          "const expected = fs.readdirSync(tmp, {\n"
+          "  recursive: true, withFileTypes: true,\n"
+          "}).map((dirent) => {\n"
+          "  const type = dirent.isFile() ? UV_DIRENT_FILE :\n"
+          "      dirent.isDirectory() ? UV_DIRENT_DIR : UV_DIRENT_LINK;\n"
+          "  return `${path.join(dirent.parentPath, dirent.name)} ${type}`;\n"
+          "}).sort();\n"
+          "(async () => {\n"
+          "  const out = [];\n"
+          "  for (const concurrency of [1, 4]) {\n"
+          "    const { entries, err } = await walk(tmp, concurrency, false);\n"
+          "    const found = [];\n"
+          "    for (let i = 0; i < entries.length; i += 2)\n"
+          "      found.push(`${entries[i]} ${entries[i + 1]}`);\n"
+          "    out.push(err, found.sort().join() === expected.join());\n"
+          "  }\n"
+          "  const { entries, stats } = await walk(tmp, 2, true);\n"
+          "  const fields = stats.length / (entries.length / 2);\n"
+          "  let sizes = true;\n"
+          "  for (let i = 0; i < entries.length; i += 2) {\n"
+          "    const size = stats[(i / 2) * fields + 8];\n"
+          "    sizes = sizes && size === fs.lstatSync(entries[i]).size;\n"
+          "  }\n"
+          "  out.push(expected.length, sizes);\n"
+          "  fs.rmSync(tmp, { recursive: true });\n"
+          "  globalThis.result = out.join();\n"
+          "})();"),
+      ",true,,true,1813,true");
+}
+#endif  // _WIN32
+
+TEST_F(DirWalkTest, ErrorsAndStop) {
+  EXPECT_EQ(
+      Run("fs.mkdirSync(path.join(tmp, 'a', 'b'), { recursive: true });\n"
+          "(async () => {\n"
+          "  const missing = await walk(path.join(tmp, 'missing'), 2, false);\n"
+          "  const out = [missing.err.code, missing.entries.length];\n"
+          "  const stopped = new Promise((resolve) => {\n"
+          "    const walk = new DirWalk();\n"
+          "    let batches = 0;\n"
+          "    walk.onentries = () => batches++;\n"
+          "    walk.oncomplete = (err) => resolve([err, batches]);\n"
+          "    walk.start(tmp, 'utf8', 2, false);\n"
+          "    walk.stop();\n"
+          "  });\n"
+          "  out.push(...await stopped);\n"
+          "  fs.rmSync(tmp, { recursive: true });\n"
+          "  globalThis.result = out.join();\n"
+          "})();"),
+      "ENOENT,0,,0");
+}
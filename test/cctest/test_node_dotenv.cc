@@ -0,0 +1,88 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_dotenv.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+using node::Dotenv;
+using node::KVStore;
+using v8::JSON;
+using v8::Local;
+using v8::String;
+
+class DotenvTest : public EnvironmentTestFixture {
+ protected:
+  // Parses `content` and returns the variables as JSON.
+  std::string Parse(const std::string& content) {
+    const v8::HandleScope handle_scope(isolate_);
+    const Argv argv;
+    Env env{handle_scope, argv};
+
+    Dotenv dotenv;
+    dotenv.ParseContent(content);
+    Local<String> json =
+        JSON::Stringify(env.context(), dotenv.ToObject(*env)).ToLocalChecked();
+    return *node::Utf8Value(isolate_, json);
+  }
+};
+
+TEST_F(DotenvTest, ParseContent) {
+  const std::string content =
+      "A=a\n"
+      "# a comment\n"
+      "B=\"x\\ny\\n\"\n"
+      "C='multi\n"
+      "line'\n"
+      "D=`tick`";
+  const std::string expected =
+      "{\"A\":\"a\",\"B\":\"x\\ny\\n\",\"C\":\"multi\\nline\",\"D\":\"tick\"}";
+  EXPECT_EQ(Parse(content), expected);
+
+  // Files with CRLF line endings parse the same.
+  std::string crlf;
+  for (char c : content) {
+    if (c == '\n') crlf += '\r';
+    crlf += c;
+  }
+  EXPECT_EQ(Parse(crlf), expected);
+}
+
+// A quoted value can end the file without a newline after it.
+TEST_F(DotenvTest, QuotedValueOnLastLine) {
+  EXPECT_EQ(Parse("A=\"one\\ntwo\""), "{\"A\":\"one\\ntwo\"}");
+  EXPECT_EQ(Parse("A=b\nC='d'"), "{\"A\":\"b\",\"C\":\"d\"}");
+}
+
+// With a layered store, process.env falls back to the values of the file.
+// Setting or deleting a variable hides its value from the file for good.
+TEST_F(DotenvTest, LayerOverEnvironment) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  std::shared_ptr<KVStore> base = KVStore::CreateMapKVStore();
+  base->Set(isolate_,
+            String::NewFromUtf8Literal(isolate_, "B"),
+            String::NewFromUtf8Literal(isolate_, "base"));
+  (*env)->set_env_vars(base);
+  Dotenv dotenv;
+  dotenv.ParseContent("A=file\nB=file\nC=file\n");
+  dotenv.LayerOverEnvironment(*env);
+  // The values of the file are not written into the store underneath.
+  EXPECT_EQ((*env)->env_vars()->Get("A").FromJust(), "file");
+  EXPECT_TRUE(base->Get("A").IsNothing());
+
+  std::string result = RunScriptAndGetResult(
+      env,
+      "const { env } = process;\n"
+      "const out = [env.A, env.B, 'C' in env, Object.keys(env).sort()];\n"
+      "delete env.A;\n"
+      "env.C = 'set';\n"
+      "delete env.C;\n"
+      "out.push(env.A, 'A' in env, env.C, Object.keys(env).sort());\n"
+      "globalThis.result = out.join(' ');");
+  EXPECT_EQ(result, "file base true A,B,C  false  B");
+  EXPECT_TRUE((*env)->env_vars()->Get("A").IsNothing());
+}
@@ -0,0 +1,85 @@
+#include "env.h"
+#include "gtest/gtest.h"
+#include "node_options.h"
+#include "node_test_fixture.h"
+#include "util-inl.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+using v8::Array;
+using v8::Context;
+using v8::HandleScope;
+using v8::Local;
+using v8::String;
+using v8::Value;
+
+class EnvVarTest : public NodeTestFixture {
+ protected:
+  void TearDown() override {
+    node::per_process::cli_options->experimental_process_env_cache = false;
+    for (const char* name : {kA, kB, kC}) unsetenv(name);
+    NodeTestFixture::TearDown();
+  }
+
+  std::vector<std::string> Enumerate(node::KVStore* store) {
+    Local<Array> keys = store->Enumerate(isolate_);
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < keys->Length(); i++) {
+      Local<Value> key =
+          keys->Get(isolate_->GetCurrentContext(), i).ToLocalChecked();
+      names.push_back(*node::Utf8Value(isolate_, key));
+    }
+    return names;
+  }
+
+  static constexpr const char* kA = "NODE_TEST_ENV_CACHE_A";
+  static constexpr const char* kB = "NODE_TEST_ENV_CACHE_B";
+  static constexpr const char* kC = "NODE_TEST_ENV_CACHE_C";
+};
+
+// With --experimental-process-env-cache, the environment is read from a
+// copy that Set() and Delete() keep in step with the real one.
+TEST_F(EnvVarTest, ProcessEnvCache) {
+  const HandleScope handle_scope(isolate_);
+  Local<Context> context = Context::New(isolate_);
+  Context::Scope context_scope(context);
+
+  setenv(kA, "1", 1);
+  node::per_process::cli_options->experimental_process_env_cache = true;
+  node::KVStore* store = node::per_process::system_environment.get();
+  EXPECT_EQ(store->Get(kA).FromJust(), "1");
+
+  store->Set(isolate_,
+             String::NewFromUtf8(isolate_, kB).ToLocalChecked(),
+             String::NewFromUtf8Literal(isolate_, "2"));
+  EXPECT_STREQ(getenv(kB), "2");
+  EXPECT_EQ(store->Get(kB).FromJust(), "2");
+  EXPECT_EQ(store->Query(kB), 0);
+
+  // Variables are enumerated once each, in the order of the environment.
+  std::vector<std::string> names = Enumerate(store);
+  auto a = std::find(names.begin(), names.end(), kA);
+  auto b = std::find(names.begin(), names.end(), kB);
+  EXPECT_LT(a, b);
+  EXPECT_NE(b, names.end());
+  EXPECT_EQ(std::count(names.begin(), names.end(), kB), 1);
+
+  store->Delete(isolate_, String::NewFromUtf8(isolate_, kA).ToLocalChecked());
+  EXPECT_EQ(getenv(kA), nullptr);
+  EXPECT_EQ(store->Query(kA), -1);
+  EXPECT_TRUE(store->Get(kA).IsNothing());
+  names = Enumerate(store);
+  EXPECT_EQ(std::find(names.begin(), names.end(), kA), names.end());
+
+  // Changes that do not go through the store are not seen until the cache
+  // is turned off again.
+  setenv(kC, "3", 1);
+  EXPECT_TRUE(store->Get(kC).IsNothing());
+  node::per_process::cli_options->experimental_process_env_cache = false;
+  EXPECT_EQ(store->Get(kC).FromJust(), "3");
+}
+#endif  // _WIN32
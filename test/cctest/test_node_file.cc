@@ -0,0 +1,231 @@
+#include "env-inl.h"
+#include "node_file.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#if !defined(_WIN32) && !defined(V8_ENABLE_SANDBOX)
+
+using node::fs::MapFile;
+using v8::BackingStore;
+
+namespace {
+
+class MapFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char tmpdir[PATH_MAX_BYTES];
+    size_t size = sizeof(tmpdir);
+    ASSERT_EQ(uv_os_tmpdir(tmpdir, &size), 0);
+    uv_fs_t req;
+    std::string templ = std::string(tmpdir, size) + "/mapXXXXXX";
+    ASSERT_EQ(uv_fs_mkdtemp(nullptr, &req, templ.c_str(), nullptr), 0);
+    dir_ = req.path;
+    uv_fs_req_cleanup(&req);
+    file_ = dir_ + "/file";
+  }
+
+  void TearDown() override {
+    uv_fs_t req;
+    uv_fs_unlink(nullptr, &req, file_.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+    uv_fs_rmdir(nullptr, &req, dir_.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+
+  void WriteFile(const std::string& contents) {
+    uv_buf_t buf =
+        uv_buf_init(const_cast<char*>(contents.data()), contents.size());
+    ASSERT_EQ(node::WriteFileSync(file_.c_str(), buf), 0);
+  }
+
+  std::string ReadFile() {
+    std::string contents;
+    EXPECT_EQ(node::ReadFileSync(&contents, file_.c_str()), 0);
+    return contents;
+  }
+
+  std::string dir_;
+  std::string file_;
+};
+
+std::string Contents(const std::unique_ptr<BackingStore>& store) {
+  return std::string(static_cast<const char*>(store->Data()),
+                     store->ByteLength());
+}
+
+}  // anonymous namespace
+
+TEST_F(MapFileTest, MapsRanges) {
+  // More than a page, so that the offsets below are not page aligned.
+  std::string contents(10000, 'x');
+  for (size_t i = 0; i < contents.size(); i++) contents[i] = 'a' + i % 26;
+  WriteFile(contents);
+
+  int err = 0;
+  std::unique_ptr<BackingStore> store = MapFile(file_.c_str(), 0, -1, 0, &err);
+  ASSERT_TRUE(store);
+  EXPECT_EQ(Contents(store), contents);
+
+  store = MapFile(file_.c_str(), 4097, 100, 0, &err);
+  ASSERT_TRUE(store);
+  EXPECT_EQ(Contents(store), contents.substr(4097, 100));
+
+  // The length is clamped to the end of the file.
+  store = MapFile(file_.c_str(), 9990, 100, 0, &err);
+  ASSERT_TRUE(store);
+  EXPECT_EQ(Contents(store), contents.substr(9990));
+
+  store = MapFile(file_.c_str(), contents.size(), -1, 0, &err);
+  ASSERT_TRUE(store);
+  EXPECT_EQ(store->ByteLength(), 0u);
+}
+
+TEST_F(MapFileTest, WritesAreNotWrittenBack) {
+  WriteFile("hello world");
+  int err = 0;
+  std::unique_ptr<BackingStore> store =
+      MapFile(file_.c_str(), 0, -1, node::fs::kMapPopulate, &err);
+  ASSERT_TRUE(store);
+  memcpy(store->Data(), "HELLO", 5);
+  EXPECT_EQ(Contents(store), "HELLO world");
+  store.reset();
+  EXPECT_EQ(ReadFile(), "hello world");
+}
+
+TEST_F(MapFileTest, Errors) {
+  WriteFile("hello");
+  int err = 0;
+  EXPECT_FALSE(MapFile(file_.c_str(), 6, -1, 0, &err));
+  EXPECT_EQ(err, UV_EINVAL);
+  EXPECT_FALSE(MapFile(dir_.c_str(), 0, -1, 0, &err));
+  EXPECT_EQ(err, UV_EISDIR);
+  EXPECT_FALSE(MapFile((dir_ + "/missing").c_str(), 0, -1, 0, &err));
+  EXPECT_EQ(err, UV_ENOENT);
+}
+
+#endif  // !defined(_WIN32) && !defined(V8_ENABLE_SANDBOX)
+
+class StatManyTest : public EnvironmentTestFixture {};
+
+TEST_F(StatManyTest, EmptyAndMissingPaths) {
+  std::string result = RunScriptAndGetResult(
+      "const { getSystemErrorName } = require('util');\n"
+      "const fs = internalBinding('fs');\n"
+      "const out = [];\n"
+      "for (const bigint of [false, true]) {\n"
+      "  const [stats, errors] = fs.statMany([], bigint);\n"
+      "  out.push(stats.length, errors.length);\n"
+      "}\n"
+      "const [stats, errors] =\n"
+      "    fs.statMany([process.execPath, '/nonexistent/file'], false);\n"
+      "const fields = stats.length / 2;\n"
+      "out.push(errors[0], getSystemErrorName(errors[1]),\n"
+      "         stats.subarray(0, fields).some((v) => v !== 0),\n"
+      "         stats.subarray(fields).every((v) => v === 0));\n"
+      "fs.statMany([], false, fs.kUsePromises).then(([stats, errors]) => {\n"
+      "  out.push(stats.length, errors.length);\n"
+      "  globalThis.result = out.join();\n"
+      "});");
+  EXPECT_EQ(result, "0,0,0,0,0,ENOENT,true,true,0,0");
+}
+
+class FileHandleTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `read(options, onChunk)` reading a temporary file
+  // with the contents `data` through a FileHandle until the end, and
+  // returns what it left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const { FileHandle } = internalBinding('fs');\n"
+        "const { streamBaseState, kReadBytesOrError, kArrayBufferOffset } =\n"
+        "    internalBinding('stream_wrap');\n"
+        "const fs = require('fs');\n"
+        "const path = require('path');\n"
+        "const dir = fs.mkdtempSync(path.join(require('os').tmpdir(), 'fh'));\n"
+        "const file = path.join(dir, 'data');\n"
+        "const data = Buffer.alloc(1024 * 1024 + 123);\n"
+        "for (let i = 0; i < data.length; i++) data[i] = (i * 7) ^ (i >> 9);\n"
+        "fs.writeFileSync(file, data);\n"
+        "const read = ({ offset, length, readahead }, onChunk) =>\n"
+        "    new Promise((resolve) => {\n"
+        "      const handle =\n"
+        "          new FileHandle(fs.openSync(file), offset, length);\n"
+        "      handle.setReadahead(readahead);\n"
+        "      const chunks = [];\n"
+        "      handle.onread = (arrayBuffer) => {\n"
+        "        const n = streamBaseState[kReadBytesOrError];\n"
+        "        if (n < 0) {\n"
+        "          handle.close().then(() => {\n"
+        "            fs.rmSync(dir, { recursive: true, force: true });\n"
+        "            resolve(Buffer.concat(chunks));\n"
+        "          });\n"
+        "          return;\n"
+        "        }\n"
+        "        chunks.push(Buffer.from(new Uint8Array(\n"
+        "            arrayBuffer, streamBaseState[kArrayBufferOffset], n)));\n"
+        "        onChunk?.(handle, chunks.length);\n"
+        "      };\n"
+        "      handle.readStart();\n"
+        "    });\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// Chunks that are read ahead are emitted in order, also when the consumer
+// pauses, and reads stop at the end of the range.
+TEST_F(FileHandleTest, Readahead) {
+  EXPECT_EQ(Run("(async () => {\n"
+                "  const out = [];\n"
+                "  for (const readahead of [0, 1, 4, 64]) {\n"
+                "    const all = await read({ offset: 0, readahead });\n"
+                "    out.push(all.equals(data));\n"
+                "  }\n"
+                "  const paused = await read(\n"
+                "      { offset: 0, readahead: 8 }, (handle, count) => {\n"
+                "        if (count % 3 !== 1) return;\n"
+                "        handle.readStop();\n"
+                "        setTimeout(() => handle.readStart(), 10);\n"
+                "      });\n"
+                "  out.push(paused.equals(data));\n"
+                "  const range = await read(\n"
+                "      { offset: 1000, length: 300000, readahead: 4 });\n"
+                "  out.push(range.equals(data.subarray(1000, 301000)));\n"
+                "  globalThis.result = out.join();\n"
+                "})();"),
+            "true,true,true,true,true,true");
+}
+
+// Closing the handle while chunks are still being read ahead waits for those
+// reads, and then closes the fd.
+TEST_F(FileHandleTest, CloseDuringReadahead) {
+  EXPECT_EQ(Run("const fd = fs.openSync(file);\n"
+                "const handle = new FileHandle(fd, 0);\n"
+                "handle.setReadahead(64);\n"
+                "let chunks = 0;\n"
+                "handle.onread = () => {\n"
+                "  if (streamBaseState[kReadBytesOrError] <= 0) return;\n"
+                "  if (chunks++ > 0) return;\n"
+                "  handle.readStop();\n"
+                "  handle.close().then(() => {\n"
+                "    let code;\n"
+                "    try {\n"
+                "      fs.fstatSync(fd);\n"
+                "    } catch (e) {\n"
+                "      code = e.code;\n"
+                "    }\n"
+                "    fs.rmSync(dir, { recursive: true, force: true });\n"
+                "    globalThis.result = [chunks, code].join();\n"
+                "  });\n"
+                "};\n"
+                "handle.readStart();"),
+            "1,EBADF");
+}
@@ -0,0 +1,272 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_http2.h"
+#include "node_http_common-inl.h"
+#include "node_test_fixture.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using node::http2::BdpEstimator;
+using node::http2::GatherOutgoingBuffers;
+using node::http2::Http2Header;
+using node::http2::kBdpPingPayload;
+using node::http2::kMaxRecycledStreamHeaders;
+using node::http2::kMaxRecycledStreamHeadersCapacity;
+using node::http2::NgHttp2StreamWrite;
+using node::http2::RecycledHeaders;
+using v8::Local;
+using v8::String;
+
+namespace {
+
+constexpr uint64_t kMs = 1000 * 1000;
+constexpr uint8_t kOtherPayload[8] = {'o', 't', 'h', 'e', 'r', 'p', 'n', 'g'};
+
+// Sends the BDP ping at `now`, receives `bytes` until its ACK arrives
+// `rtt` later, and returns whether the estimate grew.
+bool Sample(BdpEstimator* bdp, uint64_t now, uint64_t rtt, size_t bytes) {
+  EXPECT_TRUE(bdp->OnData(1, now));
+  bdp->PingSent(1, now, 0);
+  EXPECT_FALSE(bdp->OnData(bytes - 1, now + rtt / 2));
+  bool grown;
+  EXPECT_TRUE(bdp->OnPingAck(kBdpPingPayload, now + rtt, &grown));
+  return grown;
+}
+
+}  // anonymous namespace
+
+TEST(Http2BdpEstimator, GrowsWithBandwidth) {
+  BdpEstimator bdp(1 << 20);
+  EXPECT_EQ(bdp.estimate(), 65535u);
+
+  EXPECT_TRUE(Sample(&bdp, 0, 10 * kMs, 100000));
+  EXPECT_EQ(bdp.estimate(), 200000u);
+
+  // Filling the window again at the same bandwidth does not grow it.
+  EXPECT_FALSE(Sample(&bdp, 10 * kMs, 20 * kMs, 200000));
+  EXPECT_EQ(bdp.estimate(), 200000u);
+
+  // Nor does receiving little.
+  EXPECT_FALSE(Sample(&bdp, 1000 * kMs, kMs, 1000));
+
+  // It never grows beyond the maximum.
+  EXPECT_TRUE(Sample(&bdp, 2000 * kMs, kMs, 1000000));
+  EXPECT_EQ(bdp.estimate(), 1u << 20);
+}
+
+// While the estimate does not grow, PINGs are sent less and less often.
+TEST(Http2BdpEstimator, BacksOff) {
+  BdpEstimator bdp(1 << 20);
+  EXPECT_FALSE(Sample(&bdp, 0, kMs, 1000));
+  EXPECT_FALSE(bdp.OnData(1, kMs + 99 * kMs));
+  EXPECT_FALSE(Sample(&bdp, kMs + 100 * kMs, kMs, 1000));
+  EXPECT_FALSE(bdp.OnData(1, 102 * kMs + 199 * kMs));
+  EXPECT_TRUE(bdp.OnData(1, 102 * kMs + 200 * kMs));
+}
+
+// The ACKs of PINGs that were sent before the BDP PING are not taken for
+// its ACK, even with the same payload.
+TEST(Http2BdpEstimator, MatchesAcksInOrder) {
+  BdpEstimator bdp(1 << 20);
+  bool grown;
+  EXPECT_FALSE(bdp.OnPingAck(kBdpPingPayload, 0, &grown));
+
+  EXPECT_TRUE(bdp.OnData(1, 0));
+  bdp.PingSent(1, 0, 2);
+  EXPECT_FALSE(bdp.OnData(100000, kMs));
+  EXPECT_FALSE(bdp.OnPingAck(kBdpPingPayload, 2 * kMs, &grown));
+  EXPECT_FALSE(bdp.OnPingAck(kOtherPayload, 3 * kMs, &grown));
+  // An ACK of something else is not it either.
+  EXPECT_FALSE(bdp.OnPingAck(kOtherPayload, 4 * kMs, &grown));
+  EXPECT_TRUE(bdp.OnPingAck(kBdpPingPayload, 5 * kMs, &grown));
+  EXPECT_TRUE(grown);
+  EXPECT_EQ(bdp.estimate(), 200002u);
+  EXPECT_FALSE(bdp.OnPingAck(kBdpPingPayload, 6 * kMs, &grown));
+}
+
+// Copies that follow each other become one buffer, also across writes that
+// only carry a write request, and referenced data stays where it is.
+TEST(Http2Outgoing, GatherCoalescesCopies) {
+  uint8_t storage[32];
+  char first[100];
+  char second[2000];
+  std::vector<NgHttp2StreamWrite> writes;
+  auto copied = [&](size_t length) {
+    writes.emplace_back(uv_buf_init(nullptr, length));
+  };
+  copied(9);  // A frame header.
+  copied(0);  // The write request of a copied DATA payload.
+  copied(5);  // The payload itself.
+  writes.emplace_back(uv_buf_init(first, sizeof(first)));
+  copied(9);
+  copied(3);  // The copied end of a sliced write.
+  writes.emplace_back(uv_buf_init(second, 1500));  // A slice of a write.
+  writes.emplace_back(uv_buf_init(second + 1500, 500));
+  copied(0);
+
+  uv_buf_t bufs[9];
+  ASSERT_EQ(GatherOutgoingBuffers(writes, storage, bufs), 5u);
+  EXPECT_EQ(bufs[0].base, reinterpret_cast<char*>(storage));
+  EXPECT_EQ(bufs[0].len, 14u);
+  EXPECT_EQ(bufs[1].base, first);
+  EXPECT_EQ(bufs[1].len, sizeof(first));
+  EXPECT_EQ(bufs[2].base, reinterpret_cast<char*>(storage + 14));
+  EXPECT_EQ(bufs[2].len, 12u);
+  EXPECT_EQ(bufs[3].base, second);
+  EXPECT_EQ(bufs[3].len, 1500u);
+  EXPECT_EQ(bufs[4].base, second + 1500);
+  EXPECT_EQ(bufs[4].len, 500u);
+
+  // Nothing is left to write for writes without data.
+  writes.clear();
+  copied(0);
+  copied(0);
+  EXPECT_EQ(GatherOutgoingBuffers(writes, storage, bufs), 0u);
+}
+
+class Http2SessionTest : public EnvironmentTestFixture {};
+
+// Writes of every size, which are copied, referenced or sliced across DATA
+// frames, arrive intact and in order on several concurrent streams, in both
+// directions.
+TEST_F(Http2SessionTest, MixedWritesArriveIntact) {
+  std::string result = RunScriptAndGetResult(
+      "const http2 = require('http2');\n"
+      "const sizes = [10, 0, 33000, 512, 1024, 1025, 16385, 1, 70000];\n"
+      "const chunks = (n) =>\n"
+      "    sizes.map((size, i) => Buffer.alloc(size, n * 16 + i));\n"
+      "const server = http2.createServer();\n"
+      "server.on('stream', (stream) => {\n"
+      "  const received = [];\n"
+      "  stream.on('data', (chunk) => received.push(chunk));\n"
+      "  stream.on('end', () => {\n"
+      "    stream.respond();\n"
+      "    for (const chunk of received) stream.write(chunk);\n"
+      "    stream.end();\n"
+      "  });\n"
+      "});\n"
+      "server.listen(0, '127.0.0.1', () => {\n"
+      "  const { port } = server.address();\n"
+      "  const client = http2.connect(`http://127.0.0.1:${port}`);\n"
+      "  const results = [];\n"
+      "  for (let n = 0; n < 4; n++) {\n"
+      "    const req = client.request({ ':method': 'POST' });\n"
+      "    for (const chunk of chunks(n)) req.write(chunk);\n"
+      "    req.end();\n"
+      "    const response = [];\n"
+      "    req.on('data', (chunk) => response.push(chunk));\n"
+      "    req.on('end', () => {\n"
+      "      results.push(\n"
+      "          Buffer.concat(response).equals(Buffer.concat(chunks(n))));\n"
+      "      if (results.length < 4) return;\n"
+      "      globalThis.result = results.join();\n"
+      "      client.close();\n"
+      "      server.close();\n"
+      "    });\n"
+      "  }\n"
+      "});");
+  EXPECT_EQ(result, "true,true,true,true");
+}
+
+// Header buffers come back empty, but with the capacity they had.
+TEST(Http2RecycledHeaders, TakeWhatWasRecycled) {
+  RecycledHeaders recycled;
+  std::vector<Http2Header> headers;
+  EXPECT_FALSE(recycled.Take(&headers));
+
+  std::vector<Http2Header> buffer;
+  buffer.reserve(12);
+  const Http2Header* data = buffer.data();
+  recycled.Recycle(std::move(buffer));
+  EXPECT_EQ(recycled.size(), 1u);
+  EXPECT_EQ(recycled.memory_size(),
+            kMaxRecycledStreamHeadersCapacity * sizeof(Http2Header));
+
+  ASSERT_TRUE(recycled.Take(&headers));
+  EXPECT_TRUE(headers.empty());
+  EXPECT_EQ(headers.data(), data);
+  EXPECT_GE(headers.capacity(), 12u);
+  EXPECT_EQ(recycled.size(), 0u);
+  EXPECT_FALSE(recycled.Take(&headers));
+}
+
+// Buffers that were never allocated, or that grew for large header blocks,
+// are not kept, and neither are more than the pool holds.
+TEST(Http2RecycledHeaders, Bounds) {
+  RecycledHeaders recycled;
+  recycled.Recycle(std::vector<Http2Header>());
+  std::vector<Http2Header> large;
+  large.reserve(kMaxRecycledStreamHeadersCapacity + 1);
+  recycled.Recycle(std::move(large));
+  EXPECT_EQ(recycled.size(), 0u);
+
+  for (size_t i = 0; i < kMaxRecycledStreamHeaders + 8; i++) {
+    std::vector<Http2Header> buffer;
+    buffer.reserve(kMaxRecycledStreamHeadersCapacity);
+    recycled.Recycle(std::move(buffer));
+  }
+  EXPECT_EQ(recycled.size(), kMaxRecycledStreamHeaders);
+}
+
+// Short-lived streams on one session reuse the header buffers of the ones
+// before them, and their headers are not mixed up.
+TEST_F(Http2SessionTest, ShortLivedStreamsGetTheirHeaders) {
+  std::string result = RunScriptAndGetResult(
+      "const http2 = require('http2');\n"
+      "const server = http2.createServer((req, res) => {\n"
+      "  res.setHeader('x-echo', req.headers['x-id']);\n"
+      "  res.end();\n"
+      "});\n"
+      "server.listen(0, '127.0.0.1', async () => {\n"
+      "  const { port } = server.address();\n"
+      "  const client = http2.connect(`http://127.0.0.1:${port}`);\n"
+      "  let ok = true;\n"
+      "  for (let i = 0; i < 100; i++) {\n"
+      "    const headers = await new Promise((resolve) => {\n"
+      "      const req = client.request({ 'x-id': `${i}` });\n"
+      "      req.on('response', resolve);\n"
+      "      req.resume();\n"
+      "    });\n"
+      "    ok &&= headers['x-echo'] === `${i}` &&\n"
+      "           headers['x-id'] === undefined;\n"
+      "  }\n"
+      "  globalThis.result = ok;\n"
+      "  client.close();\n"
+      "  server.close();\n"
+      "});");
+  EXPECT_EQ(result, "true");
+}
+
+// Every entry of the lists is found, however long it is, and is handed out
+// as the same string each time.
+TEST_F(Http2SessionTest, CommonHeaderStrings) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  auto lookup = [&](std::string_view string) {
+    return node::GetCommonHttpHeaderString(
+        *env, reinterpret_cast<const uint8_t*>(string.data()), string.size());
+  };
+  for (std::string_view string : {
+#define V(name, value) value,
+           HTTP_KNOWN_HEADERS(V)
+#undef V
+#define V(value) value,
+           HTTP_COMMON_HEADER_STRINGS(V)
+#undef V
+       }) {
+    Local<String> first;
+    Local<String> second;
+    ASSERT_TRUE(lookup(string).ToLocal(&first)) << string;
+    ASSERT_TRUE(lookup(std::string(string)).ToLocal(&second)) << string;
+    EXPECT_TRUE(first == second) << string;
+    EXPECT_EQ(*node::Utf8Value(isolate_, first), string);
+  }
+
+  EXPECT_TRUE(lookup("").IsEmpty());
+  EXPECT_TRUE(lookup("x-not-a-common-header").IsEmpty());
+  EXPECT_TRUE(lookup(std::string(64, 'a')).IsEmpty());
+}
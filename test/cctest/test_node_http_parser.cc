@@ -0,0 +1,34 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class HttpParserTest : public EnvironmentTestFixture {};
+
+// Pipelined requests reach kOnBatch together. An upgrade request flushes
+// the batch before its headers go to JS, and what follows them starts a
+// new batch.
+TEST_F(HttpParserTest, BatchesPipelinedRequests) {
+  std::string result = RunScriptAndGetResult(
+      "const { HTTPParser } = internalBinding('http_parser');\n"
+      "const parser = new HTTPParser();\n"
+      "parser.initialize(HTTPParser.REQUEST, {});\n"
+      "const log = [];\n"
+      "parser[HTTPParser.kOnBatch] = (events) => {\n"
+      "  const kinds = events.filter((_, i) => i % 2 === 0);\n"
+      "  log.push(`batch:${kinds.join('')}`);\n"
+      "};\n"
+      "parser[HTTPParser.kOnMessageBegin] = () => log.push('begin');\n"
+      "parser[HTTPParser.kOnHeadersComplete] = (...args) => {\n"
+      "  log.push(`headers:${args[4]}`);\n"
+      "  return 0;\n"
+      "};\n"
+      "parser[HTTPParser.kOnMessageComplete] = () => log.push('complete');\n"
+      "const get = (path, extra = '') =>\n"
+      "    `GET ${path} HTTP/1.1\\r\\nHost: x\\r\\n${extra}\\r\\n`;\n"
+      "parser.execute(Buffer.from(get('/a') + get('/b') +\n"
+      "    get('/c', 'Connection: Upgrade\\r\\nUpgrade: test\\r\\n')));\n"
+      "parser.close();\n"
+      "globalThis.result = log.join(' ');");
+  EXPECT_EQ(result, "batch:0240240 headers:/c batch:4");
+}
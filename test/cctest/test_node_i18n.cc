@@ -0,0 +1,111 @@
+#if defined(NODE_HAVE_I18N_SUPPORT)
+
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_i18n.h"
+#include "node_test_fixture.h"
+
+#include <unicode/ucnv.h>
+
+#include <string>
+
+using node::i18n::ConverterPointer;
+using node::i18n::ConverterPool;
+using node::i18n::DecodeWindows1252;
+using v8::Local;
+using v8::String;
+using v8::Value;
+
+class I18nTest : public EnvironmentTestFixture {};
+
+// The bytes 0x80 to 0x9F are the only ones that do not decode as in
+// Latin-1. Five of them are unassigned and decode as the C1 controls.
+TEST_F(I18nTest, DecodeWindows1252) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  const uint16_t expected[] = {
+      0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+      0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+      0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+      0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178};
+  std::string bytes = "a";
+  for (int c = 0x80; c < 0xA0; c++) bytes += static_cast<char>(c);
+  bytes += "\x7f\xa0\xe9\xff";
+
+  Local<Value> error;
+  Local<Value> value;
+  ASSERT_TRUE(DecodeWindows1252(isolate_, bytes.data(), bytes.size(), &error)
+                  .ToLocal(&value));
+  Local<String> string = value.As<String>();
+  ASSERT_EQ(string->Length(), static_cast<int>(bytes.size()));
+  uint16_t decoded[64];
+  string->Write(isolate_, decoded, 0, string->Length());
+  EXPECT_EQ(decoded[0], 'a');
+  for (int i = 0; i < 32; i++) EXPECT_EQ(decoded[1 + i], expected[i]) << i;
+  EXPECT_EQ(decoded[33], 0x7F);
+  EXPECT_EQ(decoded[34], 0xA0);
+  EXPECT_EQ(decoded[35], 0xE9);
+  EXPECT_EQ(decoded[36], 0xFF);
+
+  // Without any of those bytes, the input is a Latin-1 string as it is.
+  ASSERT_TRUE(DecodeWindows1252(isolate_, "caf\xe9", 4, &error)
+                  .ToLocal(&value));
+  EXPECT_TRUE(value.As<String>()->IsOneByte());
+  EXPECT_TRUE(value.As<String>()->StringEquals(
+      String::NewFromUtf8(isolate_, "caf\xc3\xa9").ToLocalChecked()));
+  ASSERT_TRUE(DecodeWindows1252(isolate_, "", 0, &error).ToLocal(&value));
+  EXPECT_EQ(value.As<String>()->Length(), 0);
+}
+
+namespace {
+
+// Decodes `input` with `converter` without flushing, and returns the UTF-16
+// code units that came out.
+std::u16string ToUnicode(UConverter* converter, const std::string& input) {
+  char16_t buffer[16];
+  UChar* target = reinterpret_cast<UChar*>(buffer);
+  const char* source = input.data();
+  UErrorCode status = U_ZERO_ERROR;
+  ucnv_toUnicode(converter,
+                 &target,
+                 target + 16,
+                 &source,
+                 source + input.size(),
+                 nullptr,
+                 false,
+                 &status);
+  EXPECT_TRUE(U_SUCCESS(status));
+  return std::u16string(buffer, reinterpret_cast<char16_t*>(target));
+}
+
+}  // anonymous namespace
+
+// Converters from the pool start in the initial state, whatever the state
+// of the converters that were handed out before.
+TEST(I18nConverterPool, ClonesStartInInitialState) {
+  ConverterPool pool;
+  UErrorCode status = U_ZERO_ERROR;
+  // Shift_JIS has two-byte characters, such as 0x82 0xA0 for U+3042.
+  ConverterPointer first = pool.Open("Shift_JIS", &status);
+  ASSERT_TRUE(U_SUCCESS(status));
+  EXPECT_EQ(ToUnicode(first.get(), "\x82"), u"");
+
+  ConverterPointer second = pool.Open("Shift_JIS", &status);
+  ASSERT_TRUE(U_SUCCESS(status));
+  EXPECT_EQ(ToUnicode(second.get(), "A\x82"), u"A");
+
+  ConverterPointer third = pool.Open("Shift_JIS", &status);
+  ASSERT_TRUE(U_SUCCESS(status));
+  EXPECT_EQ(ToUnicode(third.get(), "\x82\xa0"), u"あ");
+
+  // The earlier ones keep their own state.
+  EXPECT_EQ(ToUnicode(first.get(), "\xa0"), u"あ");
+  EXPECT_EQ(ToUnicode(second.get(), "\xa0"), u"あ");
+
+  pool.Open("no-such-encoding", &status);
+  EXPECT_TRUE(U_FAILURE(status));
+}
+
+#endif  // defined(NODE_HAVE_I18N_SUPPORT)
@@ -0,0 +1,47 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_mem.h"
+#include "node_test_fixture.h"
+
+using node::mem::NativeMemoryCounters;
+
+TEST(NativeMemoryCountersTest, IncreaseAndDecrease) {
+  NativeMemoryCounters counters;
+  counters.Increase(NativeMemoryCounters::kZlib, 100);
+  counters.Adjust(NativeMemoryCounters::kZlib, 50);
+  counters.Adjust(NativeMemoryCounters::kZlib, -120);
+  counters.Increase(NativeMemoryCounters::kTls, 7);
+  counters.Decrease(NativeMemoryCounters::kTls, 7);
+  EXPECT_EQ(counters.Get(NativeMemoryCounters::kZlib), 30u);
+  EXPECT_EQ(counters.Get(NativeMemoryCounters::kTls), 0u);
+  EXPECT_EQ(counters.Get(NativeMemoryCounters::kHttp2), 0u);
+}
+
+class NativeMemoryUsageTest : public EnvironmentTestFixture {};
+
+// The counters follow the memory of zlib streams and of stored Blobs, and
+// drop back once it is released.
+TEST_F(NativeMemoryUsageTest, FollowsSubsystems) {
+  std::string result = RunScriptAndGetResult(
+      "const { nativeMemoryUsage } = internalBinding('process_methods');\n"
+      "const zlib = require('zlib');\n"
+      "const { Blob } = require('buffer');\n"
+      "const fields = new Float64Array(7);\n"
+      "const usage = () => (nativeMemoryUsage(fields), [...fields]);\n"
+      "const before = usage();\n"
+      "const deflate = zlib.createDeflate();\n"
+      "const url = URL.createObjectURL(new Blob(['x'.repeat(1000)]));\n"
+      "const during = usage();\n"
+      "deflate.close();\n"
+      "URL.revokeObjectURL(url);\n"
+      "setImmediate(() => {\n"
+      "  const after = usage();\n"
+      "  globalThis.result = [\n"
+      "    during[1] > before[1], after[1] === before[1],\n"
+      "    during[4] - before[4], after[4] === before[4],\n"
+      "    during[5] > 0, after[6],\n"
+      "  ].join();\n"
+      "});");
+  EXPECT_EQ(result, "true,true,1000,true,true,0");
+}
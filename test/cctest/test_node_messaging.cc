@@ -0,0 +1,37 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class MessagingTest : public EnvironmentTestFixture {};
+
+// Objects whose prototype was replaced by Object.prototype are still
+// cloned, or refused, according to what they are, rather than as plain
+// objects.
+TEST_F(MessagingTest, CloneExoticObjectsWithObjectPrototype) {
+  std::string result = RunScriptAndGetResult(
+      "const disguise = (value) =>\n"
+      "    Object.setPrototypeOf(value, Object.prototype);\n"
+      "const clone = (value) => {\n"
+      "  try {\n"
+      "    return structuredClone({ value }).value;\n"
+      "  } catch (err) {\n"
+      "    return err.name;\n"
+      "  }\n"
+      "};\n"
+      "const plain = Object.create(null);\n"
+      "plain.a = 1;\n"
+      "globalThis.result = [\n"
+      "  clone(disguise(() => {})),\n"
+      "  clone(disguise(new Map([[1, 2]]))) instanceof Map,\n"
+      "  clone(disguise(new Date(5))).getTime(),\n"
+      "  clone(disguise([1, 2])).length,\n"
+      "  clone(Reflect.construct(Intl.Collator, [], Object)),\n"
+      "  clone(new Proxy({}, {})),\n"
+      "  JSON.stringify(clone({ a: 1, b: { c: 'd' } })),\n"
+      "  clone(plain).a,\n"
+      "].join();");
+  EXPECT_EQ(result,
+            "DataCloneError,true,5,2,DataCloneError,DataCloneError,"
+            "{\"a\":1,\"b\":{\"c\":\"d\"}},1");
+}
@@ -0,0 +1,177 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "histogram-inl.h"
+#include "node_internals.h"
+#include "node_options.h"
+#include "node_perf.h"
+#include "node_test_fixture.h"
+#include "uv.h"
+
+#include <memory>
+#include <string>
+
+using node::performance::EventLoopHistograms;
+using node::performance::GCHistograms;
+using node::performance::NODE_PERFORMANCE_GC_TYPE_MARK_SWEEP_COMPACT;
+using node::performance::NODE_PERFORMANCE_GC_TYPE_SCAVENGE;
+using node::performance::NODE_PERFORMANCE_HEAP_SPACE_OLD;
+using node::performance::NODE_PERFORMANCE_HEAP_SPACE_YOUNG;
+using node::performance::NODE_PERFORMANCE_LOOP_PHASE_CHECK;
+using node::performance::NODE_PERFORMANCE_LOOP_PHASE_PENDING_AND_CLOSE;
+using node::performance::NODE_PERFORMANCE_LOOP_PHASE_POLL_IO;
+using node::performance::NODE_PERFORMANCE_LOOP_PHASE_POLL_WAIT;
+using node::performance::NODE_PERFORMANCE_LOOP_PHASE_TIMERS;
+using v8::Array;
+using v8::Context;
+using v8::Isolate;
+using v8::Local;
+
+class NodePerfTest : public EnvironmentTestFixture {};
+
+// With an ES module as the entry point, the startup profile is written once
+// the promise of its evaluation settles, not when LoadEnvironment() returns.
+TEST_F(NodePerfTest, StartupProfileWaitsForEntryPoint) {
+  char tmpdir[PATH_MAX_BYTES];
+  size_t size = sizeof(tmpdir);
+  ASSERT_EQ(uv_os_tmpdir(tmpdir, &size), 0);
+  const std::string path =
+      std::string(tmpdir, size) + "/startup-profile-" +
+      std::to_string(uv_os_getpid()) + ".json";
+  node::per_process::cli_options->startup_profile = path;
+
+  auto exists = [&]() {
+    uv_fs_t req;
+    int err = uv_fs_stat(nullptr, &req, path.c_str(), nullptr);
+    uv_fs_req_cleanup(&req);
+    return err == 0;
+  };
+
+  {
+    const v8::HandleScope handle_scope(isolate_);
+    const Argv argv;
+    Env env{handle_scope, argv};
+    (*env)->options()->expose_internals = true;
+
+    node::LoadEnvironment(
+        *env,
+        "const { internalBinding } = require('internal/test/binding');\n"
+        "const { entry_point_promise_private_symbol } =\n"
+        "    internalBinding('util').privateSymbols;\n"
+        "globalThis[entry_point_promise_private_symbol] =\n"
+        "    new Promise((resolve) => setTimeout(resolve, 10));")
+        .ToLocalChecked();
+    node::performance::ScheduleStartupProfile(*env);
+    EXPECT_FALSE(exists());
+    EXPECT_EQ(node::SpinEventLoop(*env).FromJust(), 0);
+    EXPECT_TRUE(exists());
+  }
+
+  std::string profile;
+  EXPECT_EQ(node::ReadFileSync(&profile, path.c_str()), 0);
+  EXPECT_NE(profile.find("\"traceEvents\""), std::string::npos);
+
+  uv_fs_t req;
+  uv_fs_unlink(nullptr, &req, path.c_str(), nullptr);
+  uv_fs_req_cleanup(&req);
+  node::per_process::cli_options->startup_profile.clear();
+}
+
+// The time between two polls that is not spent in a phase which is
+// measured on its own is counted towards the pending and close phases.
+TEST(EventLoopHistogramsTest, RecordPhases) {
+  EventLoopHistograms histograms;
+  // Phases before the first poll are recorded, but are not part of an
+  // iteration yet.
+  histograms.RecordPhase(NODE_PERFORMANCE_LOOP_PHASE_TIMERS, 512);
+  histograms.BeforePoll(100000, 0);
+  histograms.AfterPoll(120480, 15360);
+  histograms.RecordPhase(NODE_PERFORMANCE_LOOP_PHASE_CHECK, 2048);
+  histograms.RecordPhase(NODE_PERFORMANCE_LOOP_PHASE_TIMERS, 1024);
+  histograms.BeforePoll(130720, 15360);
+
+  EXPECT_EQ(histograms.phase(NODE_PERFORMANCE_LOOP_PHASE_POLL_WAIT)->Min(),
+            15360);
+  EXPECT_EQ(histograms.phase(NODE_PERFORMANCE_LOOP_PHASE_POLL_IO)->Min(),
+            5120);
+  EXPECT_EQ(histograms.phase(NODE_PERFORMANCE_LOOP_PHASE_CHECK)->Min(), 2048);
+  EXPECT_EQ(histograms.phase(NODE_PERFORMANCE_LOOP_PHASE_TIMERS)->Min(), 512);
+  EXPECT_EQ(histograms.phase(NODE_PERFORMANCE_LOOP_PHASE_TIMERS)->Count(), 2u);
+  EXPECT_EQ(
+      histograms.phase(NODE_PERFORMANCE_LOOP_PHASE_PENDING_AND_CLOSE)->Min(),
+      10240 - 2048 - 1024);
+}
+
+// A histogram for a provider only exists once one of its callbacks ran.
+TEST(EventLoopHistogramsTest, RecordCallbacks) {
+  EventLoopHistograms histograms;
+  EXPECT_EQ(histograms.callback(3), nullptr);
+  histograms.RecordCallback(3, 4096);
+  ASSERT_NE(histograms.callback(3), nullptr);
+  EXPECT_EQ(histograms.callback(3)->Count(), 1u);
+  EXPECT_EQ(histograms.callback(2), nullptr);
+  EXPECT_EQ(histograms.callback(-1), nullptr);
+  EXPECT_EQ(histograms.callback(100), nullptr);
+}
+
+// The histograms of an Environment fill up as its loop runs.
+TEST_F(NodePerfTest, LoopPhaseHistograms) {
+  std::string result = RunScriptAndGetResult(
+      "const {\n"
+      "  constants, getLoopPhaseHistogram, getCallbackHistogram,\n"
+      "} = internalBinding('performance');\n"
+      "const { Providers } = internalBinding('async_wrap');\n"
+      "const phase = (name) => getLoopPhaseHistogram(\n"
+      "    constants[`NODE_PERFORMANCE_LOOP_PHASE_${name}`]);\n"
+      "const before = getCallbackHistogram(Providers.FSREQCALLBACK);\n"
+      "setTimeout(() => {\n"
+      "  require('fs').stat('.', () => setImmediate(() => {\n"
+      "    globalThis.result = [\n"
+      "      before, phase('TIMERS').count() > 0,\n"
+      "      phase('POLL_IO').count() > 0, phase('CHECK').count() > 0,\n"
+      "      getCallbackHistogram(Providers.FSREQCALLBACK).count() > 0,\n"
+      "    ].join();\n"
+      "  }));\n"
+      "}, 1);");
+  EXPECT_EQ(result, ",true,true,true,true");
+}
+
+class GCHistogramsTest : public NodeTestFixture {};
+
+// Every GC records its pause and what it freed, for as long as the
+// histograms exist.
+TEST_F(GCHistogramsTest, RecordsGCs) {
+  const v8::HandleScope handle_scope(isolate_);
+  Local<Context> context = Context::New(isolate_);
+  Context::Scope context_scope(context);
+  v8::V8::SetFlagsFromString("--expose-gc");
+
+  auto histograms = std::make_unique<GCHistograms>(isolate_);
+  const std::shared_ptr<node::Histogram> full =
+      histograms->pause(NODE_PERFORMANCE_GC_TYPE_MARK_SWEEP_COMPACT);
+  {
+    const v8::HandleScope garbage_scope(isolate_);
+    for (int i = 0; i < 1000; i++) Array::New(isolate_, 100);
+  }
+  isolate_->RequestGarbageCollectionForTesting(Isolate::kFullGarbageCollection);
+  isolate_->RequestGarbageCollectionForTesting(
+      Isolate::kMinorGarbageCollection);
+
+  EXPECT_GE(full->Count(), 1u);
+  EXPECT_GT(full->Max(), 0);
+  EXPECT_GE(histograms->pause(NODE_PERFORMANCE_GC_TYPE_SCAVENGE)->Count(), 1u);
+  // What was freed is recorded once for every GC that is not nested in
+  // another one, in every group of spaces.
+  const std::shared_ptr<node::Histogram> young =
+      histograms->freed(NODE_PERFORMANCE_HEAP_SPACE_YOUNG);
+  const std::shared_ptr<node::Histogram> old =
+      histograms->freed(NODE_PERFORMANCE_HEAP_SPACE_OLD);
+  EXPECT_EQ(young->Count(), old->Count());
+  EXPECT_GT(young->Max() + old->Max(), 0);
+
+  // The histograms that were handed out keep their values, but the GCs
+  // after that are not recorded.
+  histograms.reset();
+  const size_t count = full->Count();
+  isolate_->RequestGarbageCollectionForTesting(Isolate::kFullGarbageCollection);
+  EXPECT_EQ(full->Count(), count);
+}
@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_sea.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using node::sea::GetFunctionPositions;
+
+// Lines end at LF, CR, CRLF, U+2028 and U+2029, as they do in JavaScript.
+TEST(NodeSeaTest, FunctionPositionsOfLines) {
+  const std::vector<std::pair<int, int>> lines = {
+      {4, 0}, {3, 0}, {2, 0}, {1, 1}, {0, 0}, {1, 1}, {9, 0}};
+  EXPECT_EQ(GetFunctionPositions("a\nbc\r\nd\re\xE2\x80\xA8" "f", lines),
+            (std::vector<int>{0, 3, 6, 8, 10}));
+  EXPECT_EQ(GetFunctionPositions("a\xE2\x80\xA9" "b", {{1, 0}}),
+            std::vector<int>{2});
+}
+
+// Positions count UTF-16 code units, so characters beyond the BMP take two.
+TEST(NodeSeaTest, FunctionPositionsOfNonAscii) {
+  EXPECT_EQ(GetFunctionPositions("\xC3\xA9\xF0\x9F\x98\x80x\ny",
+                                 {{0, 3}, {1, 0}}),
+            (std::vector<int>{3, 5}));
+}
+
+// A startup profile only guides the generation of code cache.
+TEST(NodeSeaTest, StartupProfileRequiresCodeCache) {
+  char tmpdir[PATH_MAX_BYTES];
+  size_t size = sizeof(tmpdir);
+  ASSERT_EQ(uv_os_tmpdir(tmpdir, &size), 0);
+  const std::string config =
+      std::string(tmpdir, size) + "/sea-config-" +
+      std::to_string(uv_os_getpid()) + ".json";
+  const std::string contents =
+      "{\"main\": \"main.js\", \"output\": \"sea.blob\", "
+      "\"startupProfile\": \"profile.json\"}";
+  uv_buf_t buf =
+      uv_buf_init(const_cast<char*>(contents.data()), contents.size());
+  ASSERT_EQ(node::WriteFileSync(config.c_str(), buf), 0);
+
+  EXPECT_EQ(node::sea::BuildSingleExecutableBlob(config, {}, {}),
+            node::ExitCode::kGenericUserError);
+
+  uv_fs_t req;
+  uv_fs_unlink(nullptr, &req, config.c_str(), nullptr);
+  uv_fs_req_cleanup(&req);
+}
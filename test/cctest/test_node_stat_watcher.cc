@@ -0,0 +1,37 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class StatWatcherTest : public EnvironmentTestFixture {};
+
+// Watchers that share the poller of the realm see the changes of their own
+// path only, including a path that did not exist at first, and the loop
+// exits once the last of them is closed.
+TEST_F(StatWatcherTest, WatchFile) {
+  std::string result = RunScriptAndGetResult(
+      "const fs = require('fs');\n"
+      "const path = require('path');\n"
+      "const os = require('os');\n"
+      "const tmp = fs.mkdtempSync(path.join(os.tmpdir(), 'watchfile-'));\n"
+      "const files = ['a', 'b', 'c', 'missing'].map((name) =>\n"
+      "    path.join(tmp, name));\n"
+      "for (const file of files.slice(0, 3)) fs.writeFileSync(file, '');\n"
+      "const events = [];\n"
+      "const done = () => {\n"
+      "  for (const file of files) fs.unwatchFile(file);\n"
+      "  fs.rmSync(tmp, { recursive: true });\n"
+      "  globalThis.result = events.sort().join(' ');\n"
+      "};\n"
+      "for (const file of files) {\n"
+      "  fs.watchFile(file, { interval: 10 }, (curr, prev) => {\n"
+      "    const name = path.basename(file);\n"
+      "    events.push(`${name}:${prev.size}>${curr.size}`);\n"
+      "    if (name === 'b') fs.writeFileSync(files[3], 'new');\n"
+      "    if (name === 'missing' && curr.size === 3) done();\n"
+      "  });\n"
+      "}\n"
+      "setTimeout(() => fs.writeFileSync(files[1], 'changed'), 50);");
+  // A path that does not exist reports zeroed stats once.
+  EXPECT_EQ(result, "b:0>7 missing:0>0 missing:0>3");
+}
@@ -2,6 +2,9 @@
 #include "node_task_runner.h"
 #include "node_test_fixture.h"
 
+#include <cstdio>
+#include <filesystem>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -41,3 +44,119 @@ TEST_F(TaskRunnerTest, EscapeShell) {
     EXPECT_EQ(node::task_runner::EscapeShell(input), expected);
   }
 }
+
+class TaskRunnerFilesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::error_code ec;
+    root_ = std::filesystem::temp_directory_path(ec) /
+            ("node-task-runner-" + std::to_string(uv_os_getpid()));
+    std::filesystem::remove_all(root_, ec);
+    ASSERT_TRUE(std::filesystem::create_directories(root_, ec));
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(root_, ec);
+  }
+
+  void WriteFile(const std::string& name, const std::string& contents) {
+    std::error_code ec;
+    std::filesystem::path path = root_ / name;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    FILE* file = fopen(path.string().c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    fputs(contents.c_str(), file);
+    fclose(file);
+  }
+
+  std::filesystem::path root_;
+};
+
+TEST_F(TaskRunnerFilesTest, ReadPackageJson) {
+  WriteFile("package.json",
+            R"({"name": "x", "scripts": {"build": "make", "n": 1,)"
+            R"( "test": "make \"test\""}, "workspaces": ["a", "b/*"]})");
+  std::string error;
+  auto package_json = node::task_runner::ReadPackageJson(
+      (root_ / "package.json").string(), &error);
+  ASSERT_TRUE(package_json.has_value()) << error;
+  ASSERT_EQ(package_json->scripts.size(), 2u);
+  EXPECT_EQ(*package_json->FindScript("build"), "make");
+  EXPECT_EQ(*package_json->FindScript("test"), "make \"test\"");
+  EXPECT_EQ(package_json->FindScript("n"), nullptr);
+  EXPECT_EQ(package_json->workspaces, (std::vector<std::string>{"a", "b/*"}));
+
+  WriteFile("package.json", R"({"workspaces": {"packages": ["c"]}})");
+  package_json = node::task_runner::ReadPackageJson(
+      (root_ / "package.json").string(), &error);
+  ASSERT_TRUE(package_json.has_value()) << error;
+  EXPECT_TRUE(package_json->scripts.empty());
+  EXPECT_EQ(package_json->workspaces, std::vector<std::string>{"c"});
+
+  WriteFile("package.json", R"({"name": "x"})");
+  EXPECT_FALSE(node::task_runner::ReadPackageJson(
+      (root_ / "package.json").string(), &error));
+  EXPECT_NE(error.find("\"scripts\""), std::string::npos);
+
+  WriteFile("package.json", "{");
+  EXPECT_FALSE(node::task_runner::ReadPackageJson(
+      (root_ / "package.json").string(), &error));
+}
+
+TEST_F(TaskRunnerFilesTest, ExpandWorkspaces) {
+  WriteFile("tools/package.json", "{}");
+  WriteFile("packages/b/package.json", "{}");
+  WriteFile("packages/a/package.json", "{}");
+  WriteFile("packages/not-a-package/README", "");
+
+  std::string error;
+  std::vector<std::string> directories = node::task_runner::ExpandWorkspaces(
+      root_.string(),
+      {"./tools/", "packages/*", "missing", "missing/*", "packages/**/x"},
+      &error);
+  EXPECT_EQ(directories,
+            (std::vector<std::string>{"tools", "packages/a", "packages/b"}));
+  EXPECT_NE(error.find("packages/**/x"), std::string::npos);
+}
+
+TEST_F(TaskRunnerFilesTest, ReadPackageJsonCached) {
+  std::string path = (root_ / "package.json").string();
+  std::string cache_dir = (root_ / "cache").string();
+  auto set_mtime = [&](double mtime) {
+    uv_fs_t req;
+    ASSERT_EQ(uv_fs_utime(nullptr, &req, path.c_str(), mtime, mtime, nullptr),
+              0);
+    uv_fs_req_cleanup(&req);
+  };
+
+  WriteFile("package.json", R"({"scripts": {"build": "make"}})");
+  set_mtime(1000);
+  std::string error;
+  auto package_json =
+      node::task_runner::ReadPackageJsonCached(path, cache_dir, &error);
+  ASSERT_TRUE(package_json.has_value()) << error;
+  EXPECT_EQ(*package_json->FindScript("build"), "make");
+  EXPECT_TRUE(std::filesystem::exists(root_ / "cache" / "node_run"));
+
+  // A file of the same size and modification time is taken from the cache.
+  WriteFile("package.json", R"({"scripts": {"build": "cake"}})");
+  set_mtime(1000);
+  package_json =
+      node::task_runner::ReadPackageJsonCached(path, cache_dir, &error);
+  ASSERT_TRUE(package_json.has_value()) << error;
+  EXPECT_EQ(*package_json->FindScript("build"), "make");
+
+  set_mtime(2000);
+  package_json =
+      node::task_runner::ReadPackageJsonCached(path, cache_dir, &error);
+  ASSERT_TRUE(package_json.has_value()) << error;
+  EXPECT_EQ(*package_json->FindScript("build"), "cake");
+
+  // A corrupted cache is ignored.
+  WriteFile("cache/node_run", "garbage");
+  package_json =
+      node::task_runner::ReadPackageJsonCached(path, cache_dir, &error);
+  ASSERT_TRUE(package_json.has_value()) << error;
+  EXPECT_EQ(*package_json->FindScript("build"), "cake");
+}
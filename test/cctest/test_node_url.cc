@@ -0,0 +1,56 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class NodeUrlTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with the url binding destructured, and `hrefs(result)`
+  // listing the hrefs of a parseMany() result, and returns what the script
+  // left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const { parseMany, parseInPlace, urlComponents } =\n"
+        "    internalBinding('url');\n"
+        "const hrefs = ([table, all]) => {\n"
+        "  const out = [];\n"
+        "  for (let i = 0; i < table.length; i += 11)\n"
+        "    out.push(all.slice(table[i], table[i] + table[i + 1]));\n"
+        "  return out.join('|');\n"
+        "};\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// Every input gets a row, with an empty href if it does not parse, and the
+// components of its URL after the href.
+TEST_F(NodeUrlTest, ParseManyStrings) {
+  EXPECT_EQ(Run("const result = parseMany(\n"
+                "    ['/x', 'b?q', 'http://[', 'https://c.org/'],\n"
+                "    'https://a.com/p/');\n"
+                "globalThis.result = [\n"
+                "  hrefs(result), result[0].length,\n"
+                "  result[0][2], result[0][2 + 8],\n"
+                "  parseMany(['x'], 'not a base'),\n"
+                "].join();"),
+            "https://a.com/x|https://a.com/p/b?q||https://c.org/,44,6,2,");
+}
+
+// A buffer is parsed line by line, and lines may end with CRLF.
+TEST_F(NodeUrlTest, ParseManyBuffer) {
+  EXPECT_EQ(Run("globalThis.result = hrefs(parseMany(Buffer.from(\n"
+                "    'https://a.com/\\r\\nnot a url\\nhttps://b.com/x')));"),
+            "https://a.com/||https://b.com/x");
+}
+
+// Only inputs that parse to themselves are taken in place.
+TEST_F(NodeUrlTest, ParseInPlace) {
+  EXPECT_EQ(Run("const out = ['HTTPS://a.com/', 'https://a.com', 'x']\n"
+                "    .map((input) => parseInPlace(input));\n"
+                "out.push(parseInPlace('https://a.com/x?y'),\n"
+                "         urlComponents[0], urlComponents[5],\n"
+                "         urlComponents[6]);\n"
+                "globalThis.result = out.join();"),
+            "false,false,false,true,6,13,15");
+}
@@ -0,0 +1,32 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class NodeV8Test : public EnvironmentTestFixture {};
+
+// While auto-update is on, every GC refreshes the statistics buffers, which
+// hold the statistics of all of the heap spaces.
+TEST_F(NodeV8Test, HeapStatisticsAutoUpdate) {
+  std::string result = RunScriptAndGetResult(
+      "const {\n"
+      "  heapStatisticsBuffer: heap, allHeapSpaceStatisticsBuffer: spaces,\n"
+      "  kHeapSpaces, setHeapStatisticsAutoUpdate,\n"
+      "} = internalBinding('v8');\n"
+      "require('v8').setFlagsFromString('--expose-gc');\n"
+      "const gc = require('vm').runInNewContext('gc');\n"
+      "const out = [spaces.length === kHeapSpaces.length * 4];\n"
+      "setHeapStatisticsAutoUpdate(true);\n"
+      "// Enabling it fills the buffers right away.\n"
+      "out.push(heap[0] > 0, spaces.some((value) => value > 0));\n"
+      "heap.fill(-1);\n"
+      "spaces.fill(-1);\n"
+      "gc();\n"
+      "out.push(heap[0] > 0, spaces.every((value) => value >= 0));\n"
+      "setHeapStatisticsAutoUpdate(false);\n"
+      "heap.fill(-1);\n"
+      "gc();\n"
+      "out.push(heap[0]);\n"
+      "globalThis.result = out.join();");
+  EXPECT_EQ(result, "true,true,true,true,true,-1");
+}
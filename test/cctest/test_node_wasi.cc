@@ -0,0 +1,138 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+class NodeWASITest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `wasi` set to a WASI instance whose stdin reads from
+  // `input`, a file holding "hello, world", and whose stdout writes to
+  // `output`, a file in the same directory `dir`. `memory` is its memory,
+  // and `view()` a DataView of it as it is now. Returns what the script
+  // left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const fs = require('fs');\n"
+        "const os = require('os');\n"
+        "const path = require('path');\n"
+        "const { WASI } = internalBinding('wasi');\n"
+        "const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'wasi-'));\n"
+        "fs.writeFileSync(path.join(dir, 'input'), 'hello, world');\n"
+        "const input = fs.openSync(path.join(dir, 'input'), 'r');\n"
+        "const output = fs.openSync(path.join(dir, 'output'), 'w');\n"
+        "const wasi = new WASI([], [], [], [input, output, 2]);\n"
+        "const memory = new WebAssembly.Memory({ initial: 1 });\n"
+        "const view = () => new DataView(memory.buffer);\n"
+        "const done = () => {\n"
+        "  fs.closeSync(input);\n"
+        "  fs.closeSync(output);\n"
+        "  fs.rmSync(dir, { recursive: true });\n"
+        "};\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// The bytes read are scattered into the memory as it is once the read is
+// done, even if it has grown, and so moved, in the meantime.
+TEST_F(NodeWASITest, AsyncReadAndWrite) {
+  EXPECT_EQ(Run("wasi._setMemory(memory);\n"
+                "// Two iovecs at 0, and the count of bytes at 16.\n"
+                "const iovecs = (length) => {\n"
+                "  view().setUint32(0, 100, true);\n"
+                "  view().setUint32(4, 5, true);\n"
+                "  view().setUint32(8, 200, true);\n"
+                "  view().setUint32(12, length, true);\n"
+                "};\n"
+                "const text = (offset, length) => Buffer.from(\n"
+                "    memory.buffer, offset, length).toString();\n"
+                "iovecs(16);\n"
+                "const out = [];\n"
+                "const read = wasi.fd_read_async(0, 0, 2, 16);\n"
+                "const buffer = memory.buffer;\n"
+                "memory.grow(1);\n"
+                "out.push(buffer.byteLength);\n"
+                "read.then((err) => {\n"
+                "  out.push(err, view().getUint32(16, true),\n"
+                "           text(100, 5), text(200, 7));\n"
+                "  iovecs(7);\n"
+                "  return wasi.fd_write_async(1, 0, 2, 16);\n"
+                "}).then((err) => {\n"
+                "  out.push(err, view().getUint32(16, true),\n"
+                "           fs.readFileSync(path.join(dir, 'output')));\n"
+                "  done();\n"
+                "  globalThis.result = out.join();\n"
+                "});"),
+            "0,0,12,hello,, world,0,12,hello, world");
+}
+
+// Errors come back as the errno the promise is resolved with, except for
+// an instance that is not started yet.
+TEST_F(NodeWASITest, AsyncErrors) {
+  EXPECT_EQ(Run("const out = [];\n"
+                "try {\n"
+                "  wasi.fd_read_async(0, 0, 1, 8);\n"
+                "} catch (e) {\n"
+                "  out.push(e.code);\n"
+                "}\n"
+                "wasi._setMemory(memory);\n"
+                "view().setUint32(0, 100, true);\n"
+                "view().setUint32(4, 5, true);\n"
+                "Promise.all([\n"
+                "  wasi.fd_read_async(9, 0, 1, 8),\n"
+                "  wasi.fd_read_async(0, 65536, 1, 8),\n"
+                "  wasi.fd_write_async(1, 0, 1, 65536),\n"
+                "  wasi.fd_write_async(1, 0, 1),\n"
+                "]).then((errs) => {\n"
+                "  out.push(...errs);\n"
+                "  done();\n"
+                "  globalThis.result = out.join();\n"
+                "});"),
+            "ERR_WASI_NOT_STARTED,8,61,61,28");
+}
+
+// More iovecs than fit on the stack take the same path as a few.
+TEST_F(NodeWASITest, ManyIovecs) {
+  EXPECT_EQ(Run("wasi._setMemory(memory);\n"
+                "// 20 iovecs of a byte each at 0, and the count at 512.\n"
+                "for (let i = 0; i < 20; i++) {\n"
+                "  view().setUint32(i * 8, 256 + i, true);\n"
+                "  view().setUint32(i * 8 + 4, 1, true);\n"
+                "}\n"
+                "const bytes = new Uint8Array(memory.buffer);\n"
+                "bytes.set(Buffer.from('abcdefghijklmnopqrst'), 256);\n"
+                "const out = [wasi.fd_write(1, 0, 20, 512),\n"
+                "             view().getUint32(512, true)];\n"
+                "bytes.fill(0, 256, 276);\n"
+                "out.push(wasi.fd_read(0, 0, 20, 512),\n"
+                "         view().getUint32(512, true),\n"
+                "         Buffer.from(memory.buffer, 256, 12).toString());\n"
+                "out.push(fs.readFileSync(path.join(dir, 'output')));\n"
+                "done();\n"
+                "globalThis.result = out.join();"),
+            "0,20,0,12,hello, world,abcdefghijklmnopqrst");
+}
+
+// Small requests are served from a pool that is refilled as it runs out,
+// and no two of them get the same bytes.
+TEST_F(NodeWASITest, RandomGet) {
+  EXPECT_EQ(Run("wasi._setMemory(memory);\n"
+                "const seen = new Set();\n"
+                "const errs = new Set();\n"
+                "for (let i = 0; i < 64; i++) {\n"
+                "  errs.add(wasi.random_get(0, 16));\n"
+                "  const bytes = Buffer.from(memory.buffer, 0, 16);\n"
+                "  seen.add(bytes.toString('hex'));\n"
+                "}\n"
+                "new Uint8Array(memory.buffer).fill(0, 0, 1000);\n"
+                "errs.add(wasi.random_get(0, 1000));\n"
+                "const large = Buffer.from(memory.buffer, 0, 1000);\n"
+                "done();\n"
+                "globalThis.result = [\n"
+                "  [...errs], seen.size, large.some((b) => b !== 0),\n"
+                "  wasi.random_get(65530, 16),\n"
+                "].join();"),
+            "0,64,true,61");
+}
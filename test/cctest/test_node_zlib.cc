@@ -0,0 +1,62 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class ZlibTest : public EnvironmentTestFixture {};
+
+// A whole stream that is written at once is compressed in blocks on
+// several threads. The result is one stream that the usual decompressors
+// read back, and is about as small as that of a single thread.
+TEST_F(ZlibTest, ParallelDeflate) {
+  EXPECT_EQ(
+      RunScriptAndGetResult(
+          "const zlib = require('zlib');\n"
+          "const words = ['alpha', 'beta', 'gamma', 'delta', 'epsilon'];\n"
+          "let text = '';\n"
+          "for (let i = 0; text.length < 3 * 1024 * 1024 + 123; i++)\n"
+          "  text += words[(i * 7919) % 5] + (i % 1000) + ' ';\n"
+          "const input = Buffer.from(text);\n"
+          "const out = [];\n"
+          "for (const [Stream, decompress] of [\n"
+          "  [zlib.Gzip, zlib.gunzipSync],\n"
+          "  [zlib.Deflate, zlib.inflateSync],\n"
+          "  [zlib.DeflateRaw, zlib.inflateRawSync],\n"
+          "]) {\n"
+          "  const serial = new Stream()._processChunk(\n"
+          "      input, zlib.constants.Z_FINISH);\n"
+          "  const stream = new Stream({ chunkSize: 16 * 1024 });\n"
+          "  stream._handle.setParallelism(4);\n"
+          "  const parallel = stream._processChunk(\n"
+          "      input, zlib.constants.Z_FINISH);\n"
+          "  out.push(decompress(parallel).equals(input) &&\n"
+          "           !parallel.equals(serial) &&\n"
+          "           parallel.length < serial.length * 1.01);\n"
+          "}\n"
+          "globalThis.result = out.join();"),
+      "true,true,true");
+}
+
+// Writes that are too small, or are not the whole stream, are compressed
+// as before.
+TEST_F(ZlibTest, ParallelDeflateFallsBack) {
+  EXPECT_EQ(
+      RunScriptAndGetResult(
+          "const zlib = require('zlib');\n"
+          "const input = Buffer.alloc(4 * 1024 * 1024, 'node ');\n"
+          "const compress = (chunks, threads) => {\n"
+          "  const stream = new zlib.Gzip();\n"
+          "  stream._handle.setParallelism(threads);\n"
+          "  const out = chunks.map((chunk, i) => stream._processChunk(\n"
+          "      chunk, i === chunks.length - 1 ?\n"
+          "        zlib.constants.Z_FINISH : zlib.constants.Z_NO_FLUSH));\n"
+          "  return Buffer.concat(out);\n"
+          "};\n"
+          "const small = [input.subarray(0, 1000)];\n"
+          "const split = [input.subarray(0, 10), input.subarray(10)];\n"
+          "globalThis.result = [\n"
+          "  compress(small, 4).equals(compress(small, 1)),\n"
+          "  compress(split, 4).equals(compress(split, 1)),\n"
+          "].join();"),
+      "true,true");
+}
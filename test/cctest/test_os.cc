@@ -0,0 +1,91 @@
+#include "node_internals.h"
+#include "gtest/gtest.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <thread>
+#include <vector>
+
+using node::os::CPUTopology;
+using node::os::GetCPUTopology;
+using node::os::ParseCPUList;
+
+TEST(OS, ParseCPUList) {
+  std::vector<int> cpus;
+  EXPECT_TRUE(ParseCPUList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+
+  cpus.clear();
+  EXPECT_TRUE(ParseCPUList("", &cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  EXPECT_FALSE(ParseCPUList("3-1", &cpus));
+  EXPECT_FALSE(ParseCPUList("a", &cpus));
+  EXPECT_FALSE(ParseCPUList("1,,2", &cpus));
+  EXPECT_FALSE(ParseCPUList("1-2x", &cpus));
+  EXPECT_FALSE(ParseCPUList("1x", &cpus));
+  EXPECT_FALSE(ParseCPUList("1,", &cpus));
+  EXPECT_FALSE(ParseCPUList("1-", &cpus));
+  EXPECT_FALSE(ParseCPUList("-1", &cpus));
+  EXPECT_FALSE(ParseCPUList(" 1", &cpus));
+  // Ranges cannot be larger than an affinity mask, nor overflow.
+  EXPECT_FALSE(ParseCPUList("0-2147483647", &cpus));
+  EXPECT_FALSE(ParseCPUList("99999999999", &cpus));
+}
+
+TEST(OS, CPUTopology) {
+  std::vector<CPUTopology> topology = GetCPUTopology();
+  ASSERT_FALSE(topology.empty());
+  for (const CPUTopology& info : topology) {
+    EXPECT_GE(info.cpu, 0);
+    // The group of CPUs that share a core or cache is named after its
+    // lowest CPU.
+    EXPECT_LE(info.core, info.cpu);
+    EXPECT_LE(info.l3_cache, info.cpu);
+  }
+  EXPECT_GE(node::os::GetAvailableParallelism(), 1u);
+}
+
+TEST(OS, SetCurrentThreadMemoryNode) {
+  EXPECT_EQ(node::os::SetCurrentThreadMemoryNode(-1),
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+            UV_EINVAL);
+#else
+            UV_ENOTSUP);
+#endif
+}
+
+#if defined(__linux__) && defined(SYS_set_mempolicy) && \
+    defined(SYS_get_mempolicy)
+// Memory that a thread allocates after choosing node 0, which every system
+// with NUMA support has, is placed on that node.
+TEST(OS, SetCurrentThreadMemoryNodePlacesMemory) {
+  int err = 0;
+  int policy = -1;
+  int placed_node = -1;
+  // On a thread of its own, as the policy cannot be taken back.
+  std::thread([&]() {
+    err = node::os::SetCurrentThreadMemoryNode(0);
+    if (err != 0) return;
+    unsigned long mask = 0;  // NOLINT(runtime/int)
+    if (syscall(SYS_get_mempolicy, &policy, &mask, 8 * sizeof(mask),
+                nullptr, 0) != 0) {
+      return;
+    }
+    std::vector<char> memory(1 << 20, 1);
+    syscall(SYS_get_mempolicy, &placed_node, nullptr, 0,
+            memory.data() + memory.size() / 2, MPOL_F_NODE | MPOL_F_ADDR);
+  }).join();
+  // Kernels without NUMA support, and sandboxes that do not allow the
+  // system call.
+  if (err == UV_ENOSYS || err == UV_EPERM) GTEST_SKIP();
+
+  ASSERT_EQ(err, 0);
+  EXPECT_EQ(policy, MPOL_PREFERRED);
+  EXPECT_EQ(placed_node, 0);
+}
+#endif
@@ -45,3 +45,45 @@ TEST_F(PathTest, PathResolve) {
             "/foo/tmp.3/cycles/root.js");
 #endif
 }
+
+#ifndef _WIN32
+TEST(PathTest, PathNormalize) {
+  using node::PathNormalize;
+  EXPECT_EQ(PathNormalize(""), ".");
+  EXPECT_EQ(PathNormalize("./"), "./");
+  EXPECT_EQ(PathNormalize("//"), "/");
+  EXPECT_EQ(PathNormalize("/foo/../../../bar"), "/bar");
+  EXPECT_EQ(PathNormalize("a//b//../b"), "a/b");
+  EXPECT_EQ(PathNormalize("a//b//./c"), "a/b/c");
+  EXPECT_EQ(PathNormalize("a//b//."), "a/b");
+  EXPECT_EQ(PathNormalize("/a/b/c/../../../x/y/z"), "/x/y/z");
+  EXPECT_EQ(PathNormalize("///..//./foo/.//bar"), "/foo/bar");
+  EXPECT_EQ(PathNormalize("bar/foo../../"), "bar/");
+  EXPECT_EQ(PathNormalize("bar/foo../.."), "bar");
+  EXPECT_EQ(PathNormalize("bar/foo../../baz"), "bar/baz");
+  EXPECT_EQ(PathNormalize("bar/foo../"), "bar/foo../");
+  EXPECT_EQ(PathNormalize("bar/foo.."), "bar/foo..");
+  EXPECT_EQ(PathNormalize("../foo../../../bar"), "../../bar");
+  EXPECT_EQ(PathNormalize("../.../.././.../../../bar"), "../../bar");
+  EXPECT_EQ(PathNormalize("../../../foo/../../../bar"), "../../../../../bar");
+  EXPECT_EQ(PathNormalize("../foobar/barfoo/foo/../../../bar/../../"),
+            "../../");
+  EXPECT_EQ(PathNormalize("../.../../foobar/../../../bar/../../baz"),
+            "../../../../baz");
+  EXPECT_EQ(PathNormalize("foo/bar\\baz"), "foo/bar\\baz");
+}
+
+TEST(PathTest, IsNormalizedPath) {
+  const char* paths[] = {
+      "",       ".",     "./",      "..",      "../",     "../..",
+      "/",      "//",    "/a",      "/a/",     "/a//",    "/a/.",
+      "/..",    "/a/..", "a",       "a/",      "a/b",     "./a",
+      "a/./b",  "../a",  "../a/..", "../../a", "a/../b",  "...",
+      "/.../a", "a..",   "..a/b",   "/a/b/c",  "a/b/c/",  "a/b//c",
+  };
+  for (const char* path : paths) {
+    EXPECT_EQ(node::IsNormalizedPath(path), node::PathNormalize(path) == path)
+        << path;
+  }
+}
+#endif  // _WIN32
@@ -0,0 +1,190 @@
+#include "tracing/perfetto_trace_writer.h"
+#include "tracing/trace_event_common.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using node::tracing::PerfettoTraceWriter;
+using v8::platform::tracing::TraceObject;
+using v8::platform::tracing::TracingController;
+
+namespace {
+
+// Just enough of a protocol buffer decoder to look at a serialized trace.
+struct Field {
+  uint64_t value;
+  std::string bytes;
+};
+
+using Message = std::multimap<uint64_t, Field>;
+
+uint64_t ReadVarint(const std::string& data, size_t* offset) {
+  uint64_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = data[(*offset)++];
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return value;
+  }
+}
+
+Message Parse(const std::string& data) {
+  Message fields;
+  size_t offset = 0;
+  while (offset < data.size()) {
+    uint64_t tag = ReadVarint(data, &offset);
+    Field field{0, ""};
+    if ((tag & 7) == 0) {
+      field.value = ReadVarint(data, &offset);
+    } else if ((tag & 7) == 1) {
+      field.bytes = data.substr(offset, 8);
+      offset += 8;
+    } else {
+      EXPECT_EQ(tag & 7, 2u);
+      uint64_t length = ReadVarint(data, &offset);
+      field.bytes = data.substr(offset, length);
+      offset += length;
+    }
+    fields.emplace(tag >> 3, field);
+  }
+  EXPECT_EQ(offset, data.size());
+  return fields;
+}
+
+class PerfettoTraceWriterTest : public ::testing::Test {
+ protected:
+  void Append(char phase,
+              const char* name,
+              int tid,
+              int64_t ts,
+              uint64_t duration = 0,
+              int num_args = 0,
+              const char** arg_names = nullptr,
+              const uint8_t* arg_types = nullptr,
+              const uint64_t* arg_values = nullptr) {
+    TraceObject event;
+    event.InitializeForTesting(phase,
+                               controller_.GetCategoryGroupEnabled("node"),
+                               name,
+                               nullptr,
+                               0,
+                               0,
+                               num_args,
+                               arg_names,
+                               arg_types,
+                               arg_values,
+                               nullptr,
+                               0,
+                               42,
+                               tid,
+                               ts,
+                               0,
+                               duration,
+                               0);
+    writer_.AppendTraceEvent(&event);
+  }
+
+  // Returns the TracePackets that have been written so far.
+  std::vector<Message> Packets() {
+    std::vector<Message> packets;
+    Message trace = Parse(stream_.str());
+    EXPECT_EQ(trace.size(), trace.count(1));
+    for (const auto& packet : trace)
+      packets.push_back(Parse(packet.second.bytes));
+    return packets;
+  }
+
+  TracingController controller_;
+  std::ostringstream stream_;
+  PerfettoTraceWriter writer_{stream_};
+};
+
+}  // anonymous namespace
+
+TEST_F(PerfettoTraceWriterTest, Slices) {
+  Append(TRACE_EVENT_PHASE_BEGIN, "outer", 1, 10);
+  Append(TRACE_EVENT_PHASE_COMPLETE, "inner", 1, 20, 5);
+  Append(TRACE_EVENT_PHASE_END, "outer", 1, 30);
+
+  std::vector<Message> packets = Packets();
+  // The process and thread descriptors, then one packet per slice boundary.
+  ASSERT_EQ(packets.size(), 6u);
+  EXPECT_EQ(packets[0].count(60), 1u);
+  EXPECT_EQ(packets[0].find(13)->second.value, 1u);  // sequence_flags
+  Message thread_track = Parse(packets[1].find(60)->second.bytes);
+  Message thread = Parse(thread_track.find(4)->second.bytes);
+  EXPECT_EQ(thread.find(1)->second.value, 42u);  // pid
+  EXPECT_EQ(thread.find(2)->second.value, 1u);  // tid
+
+  const uint64_t expected_types[] = {1, 1, 2, 2};
+  const uint64_t expected_timestamps[] = {10000, 20000, 25000, 30000};
+  for (size_t i = 0; i < 4; i++) {
+    const Message& packet = packets[i + 2];
+    EXPECT_EQ(packet.find(10)->second.value, 1u);  // sequence id
+    EXPECT_EQ(packet.find(8)->second.value, expected_timestamps[i]);
+    Message event = Parse(packet.find(11)->second.bytes);
+    EXPECT_EQ(event.find(9)->second.value, expected_types[i]);
+    EXPECT_EQ(event.find(11)->second.value, thread_track.find(1)->second.value);
+    if (expected_types[i] == 1) {
+      EXPECT_EQ(event.find(22)->second.bytes, "node");
+      EXPECT_EQ(event.find(23)->second.bytes, i == 0 ? "outer" : "inner");
+    } else {
+      EXPECT_EQ(event.count(23), 0u);
+    }
+  }
+}
+
+TEST_F(PerfettoTraceWriterTest, ArgsAndCounters) {
+  const char* names[] = {"count", "label"};
+  const uint8_t types[] = {TRACE_VALUE_TYPE_INT, TRACE_VALUE_TYPE_STRING};
+  const uint64_t values[] = {
+      static_cast<uint64_t>(-3), reinterpret_cast<uint64_t>("hello")};
+  Append(TRACE_EVENT_PHASE_INSTANT, "mark", 1, 1, 0, 2, names, types, values);
+  Append(TRACE_EVENT_PHASE_COUNTER, "heap", 1, 2, 0, 1, names, types, values);
+  Append(TRACE_EVENT_PHASE_COUNTER, "heap", 1, 3, 0, 1, names, types, values);
+
+  std::vector<Message> packets = Packets();
+  // The process and thread descriptors, the instant, one counter track
+  // descriptor and two counter values.
+  ASSERT_EQ(packets.size(), 6u);
+
+  Message instant = Parse(packets[2].find(11)->second.bytes);
+  EXPECT_EQ(instant.find(9)->second.value, 3u);
+  ASSERT_EQ(instant.count(4), 2u);
+  auto annotation = instant.equal_range(4).first;
+  Message count = Parse(annotation->second.bytes);
+  EXPECT_EQ(count.find(10)->second.bytes, "count");
+  EXPECT_EQ(static_cast<int64_t>(count.find(4)->second.value), -3);
+  Message label = Parse((++annotation)->second.bytes);
+  EXPECT_EQ(label.find(10)->second.bytes, "label");
+  EXPECT_EQ(label.find(6)->second.bytes, "hello");
+
+  Message counter_track = Parse(packets[3].find(60)->second.bytes);
+  EXPECT_EQ(counter_track.find(2)->second.bytes, "heap");
+  EXPECT_EQ(counter_track.count(8), 1u);
+  for (size_t i = 4; i < 6; i++) {
+    Message counter = Parse(packets[i].find(11)->second.bytes);
+    EXPECT_EQ(counter.find(9)->second.value, 4u);
+    EXPECT_EQ(counter.find(11)->second.value,
+              counter_track.find(1)->second.value);
+    EXPECT_EQ(static_cast<int64_t>(counter.find(30)->second.value), -3);
+  }
+}
+
+TEST_F(PerfettoTraceWriterTest, ThreadNames) {
+  const char* names[] = {"name"};
+  const uint8_t types[] = {TRACE_VALUE_TYPE_STRING};
+  const uint64_t values[] = {reinterpret_cast<uint64_t>("main")};
+  Append(TRACE_EVENT_PHASE_METADATA, "thread_name", 7, 0, 0, 1, names, types,
+         values);
+
+  std::vector<Message> packets = Packets();
+  ASSERT_EQ(packets.size(), 3u);
+  Message track = Parse(packets[2].find(60)->second.bytes);
+  Message thread = Parse(track.find(4)->second.bytes);
+  EXPECT_EQ(thread.find(2)->second.value, 7u);
+  EXPECT_EQ(thread.find(5)->second.bytes, "main");
+}
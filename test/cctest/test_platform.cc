@@ -1,6 +1,7 @@
 #include "node_internals.h"
 #include "libplatform/libplatform.h"
 
+#include <atomic>
 #include <string>
 #include "gtest/gtest.h"
 #include "node_test_fixture.h"
@@ -39,6 +40,32 @@ class RepostingTask : public v8::Task {
 
 class PlatformTest : public EnvironmentTestFixture {};
 
+// This task counts its runs and posts |children| further tasks from the
+// worker thread it runs on, alternating between task priorities.
+class CountingWorkerTask : public v8::Task {
+ public:
+  CountingWorkerTask(int children,
+                     std::atomic<int>* run_count,
+                     node::NodePlatform* platform)
+      : children_(children), run_count_(run_count), platform_(platform) {}
+
+  // v8::Task implementation
+  void Run() final {
+    ++*run_count_;
+    for (int i = 0; i < children_; i++) {
+      platform_->CallOnWorkerThread(
+          std::make_unique<CountingWorkerTask>(0, run_count_, platform_));
+      platform_->CallBlockingTaskOnWorkerThread(
+          std::make_unique<CountingWorkerTask>(0, run_count_, platform_));
+    }
+  }
+
+ private:
+  int children_;
+  std::atomic<int>* run_count_;
+  node::NodePlatform* platform_;
+};
+
 TEST_F(PlatformTest, SkipNewTasksInFlushForegroundTasks) {
   v8::Isolate::Scope isolate_scope(isolate_);
   const v8::HandleScope handle_scope(isolate_);
@@ -58,6 +85,22 @@ TEST_F(PlatformTest, SkipNewTasksInFlushForegroundTasks) {
   EXPECT_FALSE(platform->FlushForegroundTasks(isolate_));
 }
 
+TEST_F(PlatformTest, DrainTasksWaitsForAllWorkerTasks) {
+  v8::Isolate::Scope isolate_scope(isolate_);
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env {handle_scope, argv};
+  std::atomic<int> run_count{0};
+  constexpr int kTasks = 200;
+  constexpr int kChildren = 4;
+  for (int i = 0; i < kTasks; i++) {
+    platform->CallOnWorkerThread(std::make_unique<CountingWorkerTask>(
+        kChildren, &run_count, platform.get()));
+  }
+  platform->DrainTasks(isolate_);
+  EXPECT_EQ(kTasks * (1 + 2 * kChildren), run_count);
+}
+
 // Tests the registration of an abstract `IsolatePlatformDelegate` instance as
 // opposed to the more common `uv_loop_s*` version of `RegisterIsolate`.
 TEST_F(NodeZeroIsolateTestFixture, IsolatePlatformDelegateTest) {
@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+#include "node_pprof.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using node::pprof::ProfileBuilder;
+
+namespace {
+
+// Just enough of a protocol buffer decoder to look at a serialized profile.
+struct Field {
+  uint64_t number;
+  uint64_t value;
+  std::string bytes;
+};
+
+uint64_t ReadVarint(const std::string& data, size_t* offset) {
+  uint64_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = data[(*offset)++];
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return value;
+  }
+}
+
+std::multimap<uint64_t, Field> Parse(const std::string& data) {
+  std::multimap<uint64_t, Field> fields;
+  size_t offset = 0;
+  while (offset < data.size()) {
+    uint64_t tag = ReadVarint(data, &offset);
+    Field field{tag >> 3, 0, ""};
+    if ((tag & 7) == 0) {
+      field.value = ReadVarint(data, &offset);
+    } else {
+      EXPECT_EQ(tag & 7, 2u);
+      uint64_t length = ReadVarint(data, &offset);
+      field.bytes = data.substr(offset, length);
+      offset += length;
+    }
+    fields.emplace(field.number, field);
+  }
+  EXPECT_EQ(offset, data.size());
+  return fields;
+}
+
+std::vector<uint64_t> ParsePacked(const std::string& data) {
+  std::vector<uint64_t> values;
+  size_t offset = 0;
+  while (offset < data.size()) values.push_back(ReadVarint(data, &offset));
+  return values;
+}
+
+}  // anonymous namespace
+
+TEST(ProfileBuilder, Serialize) {
+  ProfileBuilder builder(
+      {{"samples", "count"}, {"cpu", "nanoseconds"}}, {"cpu", "nanoseconds"},
+      1000);
+  uint64_t main = builder.AddLocation("main", "app.js", 1, 1);
+  uint64_t work = builder.AddLocation("work", "app.js", 10, 10);
+  // Locations and the strings in them are only added once.
+  EXPECT_EQ(builder.AddLocation("main", "app.js", 1, 1), main);
+  EXPECT_NE(work, main);
+  builder.AddSample({work, main}, {3, 3000});
+  builder.set_duration_nanos(5000);
+
+  std::multimap<uint64_t, Field> profile = Parse(builder.Serialize());
+  EXPECT_EQ(profile.count(1), 2u);  // sample_type
+  EXPECT_EQ(profile.count(4), 2u);  // location
+  EXPECT_EQ(profile.count(5), 2u);  // function
+  EXPECT_EQ(profile.find(10)->second.value, 5000u);  // duration_nanos
+  EXPECT_EQ(profile.find(12)->second.value, 1000u);  // period
+
+  std::vector<std::string> strings;
+  auto range = profile.equal_range(6);
+  for (auto it = range.first; it != range.second; ++it)
+    strings.push_back(it->second.bytes);
+  EXPECT_EQ(strings,
+            std::vector<std::string>(
+                {"", "samples", "count", "cpu", "nanoseconds", "main",
+                 "app.js", "work"}));
+
+  ASSERT_EQ(profile.count(2), 1u);
+  std::multimap<uint64_t, Field> sample = Parse(profile.find(2)->second.bytes);
+  EXPECT_EQ(ParsePacked(sample.find(1)->second.bytes),
+            std::vector<uint64_t>({work, main}));
+  EXPECT_EQ(ParsePacked(sample.find(2)->second.bytes),
+            std::vector<uint64_t>({3, 3000}));
+}
@@ -0,0 +1,73 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class ProcessWrapTest : public EnvironmentTestFixture {};
+
+#ifndef _WIN32
+// A child that is given an environment of its own looks up its file in the
+// PATH of that environment, and neither changes the environment of the
+// parent.
+TEST_F(ProcessWrapTest, SpawnWithEnvironment) {
+  std::string result = RunScriptAndGetResult(
+      "const { spawnSync } = require('child_process');\n"
+      "const path = process.env.PATH;\n"
+      "const out = [];\n"
+      "for (let i = 0; i < 16; i++) {\n"
+      "  const child = spawnSync('env', [], {\n"
+      "    env: { PATH: '/usr/bin:/bin', NODE_TEST_CHILD: `${i}` },\n"
+      "  });\n"
+      "  out.push(child.status === 0 &&\n"
+      "           child.stdout.toString().includes(`NODE_TEST_CHILD=${i}`));\n"
+      "}\n"
+      "const missing =\n"
+      "    spawnSync('env', [], { env: { PATH: '/nonexistent' } });\n"
+      "globalThis.result = out.every(Boolean) &&\n"
+      "    missing.error?.code === 'ENOENT' &&\n"
+      "    process.env.PATH === path &&\n"
+      "    process.env.NODE_TEST_CHILD === undefined;");
+  EXPECT_EQ(result, "true");
+}
+
+// The output is captured whole however large it gets, and maxBuffer still
+// stops the child.
+TEST_F(ProcessWrapTest, SpawnSyncOutput) {
+  EXPECT_EQ(RunScriptAndGetResult(
+                "const { spawnSync } = require('child_process');\n"
+                "const big = spawnSync('sh', ['-c',\n"
+                "    'head -c 3000000 /dev/zero | tr \"\\\\0\" a']);\n"
+                "const limited = spawnSync('head', ['-c', '1000000',\n"
+                "    '/dev/zero'], { maxBuffer: 1000 });\n"
+                "globalThis.result = [\n"
+                "  big.stdout.length, big.stdout.every((b) => b === 97),\n"
+                "  limited.error.code,\n"
+                "].join();"),
+            "3000000,true,ENOBUFS");
+}
+
+// With onOutput, the output is passed on as it is read instead of being
+// kept. An exception from it kills the child and comes out of spawnSync().
+TEST_F(ProcessWrapTest, SpawnSyncOnOutput) {
+  EXPECT_EQ(RunScriptAndGetResult(
+                "const { spawnSync } = require('child_process');\n"
+                "const chunks = { 1: '', 2: '' };\n"
+                "const script = 'echo out; echo err >&2';\n"
+                "const child = spawnSync('sh', ['-c', script], {\n"
+                "  onOutput: (fd, chunk) => { chunks[fd] += chunk; },\n"
+                "});\n"
+                "let error;\n"
+                "try {\n"
+                "  spawnSync('sh', ['-c', 'echo out; exec sleep 10'], {\n"
+                "    onOutput() { throw new Error('boom'); },\n"
+                "  });\n"
+                "} catch (e) {\n"
+                "  error = e.message;\n"
+                "}\n"
+                "globalThis.result = [\n"
+                "  child.status, child.stdout.length, child.stderr.length,\n"
+                "  JSON.stringify(chunks), error,\n"
+                "].join();"),
+            "0,0,0,{\"1\":\"out\\n\",\"2\":\"err\\n\"},boom");
+}
+#endif  // _WIN32
@@ -93,4 +93,30 @@ TEST(CID, Basic) {
     }
   }
 }
+
+TEST(CID, Sharded) {
+  auto& shard3 = CID::Factory::sharded(3);
+  auto& shard200 = CID::Factory::sharded(200);
+  {
+    auto cid = shard3.Generate();
+    CHECK_EQ(cid.length(), CID::kMaxLength);
+    CHECK_EQ(CID::Factory::ShardOf(cid), 3);
+  }
+  {
+    auto cid1 = shard200.Generate(5);
+    auto cid2 = shard200.Generate(5);
+    CHECK_EQ(cid1.length(), 5);
+    CHECK_EQ(CID::Factory::ShardOf(cid1), 200);
+    CHECK_EQ(CID::Factory::ShardOf(cid2), 200);
+    CHECK_NE(cid1, cid2);
+  }
+  {
+    ngtcp2_cid cid_;
+    auto cid = shard3.GenerateInto(&cid_, 10);
+    CHECK_EQ(cid_.datalen, 10);
+    CHECK_EQ(cid_.data[0], 3);
+    CHECK_EQ(CID::Factory::ShardOf(cid), 3);
+  }
+  CHECK_EQ(&CID::Factory::sharded(3), &shard3);
+}
 #endif  // HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
@@ -0,0 +1,107 @@
+#if HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
+#include <gtest/gtest.h>
+#include <quic/sessionticket.h>
+#include <quic/tokens.h>
+#include <util-inl.h>
+#include <cstdint>
+#include <cstring>
+
+using node::quic::BloomReplayFilter;
+using node::quic::TicketKeyRing;
+using node::quic::TokenSecret;
+
+TEST(TicketKeyRing, SharedSecret) {
+  uint8_t secret[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6};
+  uint8_t other_secret[] = {6, 5, 4, 3, 2, 1, 0, 9, 8, 7, 6, 5, 4, 3, 2, 1};
+  TicketKeyRing ring(TokenSecret(secret), 100);
+  TicketKeyRing same(TokenSecret(secret), 100);
+  TicketKeyRing other(TokenSecret(other_secret), 100);
+
+  // Rings with the same secret use the same key at the same time, no matter
+  // when they were created.
+  same.Current(50);
+  const TicketKeyRing::Key& key = ring.Current(1050);
+  const TicketKeyRing::Key& same_key = same.Current(1099);
+  EXPECT_EQ(memcmp(key.name, same_key.name, sizeof(key.name)), 0);
+  EXPECT_EQ(memcmp(key.aes, same_key.aes, sizeof(key.aes)), 0);
+  EXPECT_EQ(memcmp(key.hmac, same_key.hmac, sizeof(key.hmac)), 0);
+
+  bool renew = true;
+  EXPECT_EQ(same.Find(key.name, 1099, &renew), &same.Current(1099));
+  EXPECT_FALSE(renew);
+
+  const TicketKeyRing::Key& other_key = other.Current(1050);
+  EXPECT_NE(memcmp(key.name, other_key.name, sizeof(key.name)), 0);
+  EXPECT_NE(memcmp(key.aes, other_key.aes, sizeof(key.aes)), 0);
+  EXPECT_EQ(other.Find(key.name, 1050, &renew), nullptr);
+}
+
+TEST(TicketKeyRing, Rotation) {
+  uint8_t secret[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6};
+  TicketKeyRing ring(TokenSecret(secret), 100);
+
+  uint8_t name[TicketKeyRing::kNameLength];
+  memcpy(name, ring.Current(0).name, sizeof(name));
+  bool renew = true;
+  ASSERT_NE(ring.Find(name, 99, &renew), nullptr);
+  EXPECT_FALSE(renew);
+
+  // The key of the previous period is still accepted, but renewed.
+  EXPECT_NE(memcmp(ring.Current(100).name, name, sizeof(name)), 0);
+  ASSERT_NE(ring.Find(name, 199, &renew), nullptr);
+  EXPECT_TRUE(renew);
+
+  EXPECT_EQ(ring.Find(name, 200, &renew), nullptr);
+
+  // Skipping periods derives the previous key as well.
+  memcpy(name, ring.Current(999).name, sizeof(name));
+  ASSERT_NE(ring.Find(name, 1000, &renew), nullptr);
+  EXPECT_TRUE(renew);
+}
+
+TEST(TicketKeyRing, FirstPeriod) {
+  uint8_t secret[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6};
+  TicketKeyRing ring(TokenSecret(secret), 1);
+  TicketKeyRing last(TokenSecret(secret), 1);
+
+  // The period before the first one does not wrap around to the last one,
+  // including when the ring was used in the last one before, and no name
+  // matches the empty slot it leaves.
+  uint8_t name[TicketKeyRing::kNameLength];
+  memcpy(name, last.Current(UINT64_MAX).name, sizeof(name));
+  uint8_t zero[TicketKeyRing::kNameLength] = {};
+  bool renew = false;
+  EXPECT_EQ(ring.Find(name, 0, &renew), nullptr);
+  EXPECT_EQ(ring.Find(zero, 0, &renew), nullptr);
+  EXPECT_EQ(last.Find(name, 0, &renew), nullptr);
+  ASSERT_NE(last.Find(ring.Current(0).name, 0, &renew), nullptr);
+  EXPECT_FALSE(renew);
+}
+
+TEST(BloomReplayFilter, Window) {
+  BloomReplayFilter filter(100, 1 << 12);
+  uint8_t first[32] = {1};
+  uint8_t second[32] = {2};
+
+  EXPECT_TRUE(filter.Insert(first, sizeof(first), 10));
+  EXPECT_FALSE(filter.Insert(first, sizeof(first), 20));
+  EXPECT_TRUE(filter.Insert(second, sizeof(second), 20));
+
+  // A ticket is remembered for at least a window after it was last used.
+  EXPECT_FALSE(filter.Insert(first, sizeof(first), 150));
+  EXPECT_TRUE(filter.Insert(second, sizeof(second), 200));
+  EXPECT_FALSE(filter.Insert(first, sizeof(first), 200));
+  EXPECT_TRUE(filter.Insert(first, sizeof(first), 1000));
+}
+
+TEST(BloomReplayFilter, FalsePositives) {
+  BloomReplayFilter filter(100);
+  uint8_t id[32] = {};
+  int false_positives = 0;
+  for (uint32_t n = 0; n < 100000; n++) {
+    memcpy(id, &n, sizeof(n));
+    if (!filter.Insert(id, sizeof(id), 0)) false_positives++;
+  }
+  EXPECT_LT(false_positives, 100);
+}
+#endif  // HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
@@ -1,4 +1,5 @@
 #include "node.h"
+#include "node_report.h"
 
 #include <string>
 #include "gtest/gtest.h"
@@ -25,6 +26,22 @@ class ReportTest : public EnvironmentTestFixture {
   }
 };
 
+TEST(ReportSections, Parse) {
+  using node::report::ParseSections;
+  uint32_t sections;
+  ASSERT_TRUE(ParseSections("", &sections));
+  EXPECT_EQ(sections, node::report::kAllSections);
+  ASSERT_TRUE(ParseSections("libuv", &sections));
+  EXPECT_EQ(sections, node::report::kLibuv);
+  ASSERT_TRUE(ParseSections("javascriptStack,libuv,sharedObjects", &sections));
+  EXPECT_EQ(sections,
+            node::report::kJavaScriptStack | node::report::kLibuv |
+                node::report::kSharedObjects);
+  EXPECT_FALSE(ParseSections("libuv,", &sections));
+  EXPECT_FALSE(ParseSections("header", &sections));
+  EXPECT_FALSE(ParseSections("libuv,heap", &sections));
+}
+
 TEST_F(ReportTest, ReportWithNoIsolate) {
   SealHandleScope handle_scope(isolate_);
 
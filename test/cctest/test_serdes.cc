@@ -0,0 +1,42 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class SerdesTest : public EnvironmentTestFixture {};
+
+// Whatever the size of the buffer, serializeInto() writes the same bytes
+// as v8.serialize(), as many of them as fit.
+TEST_F(SerdesTest, SerializeIntoWritesWhatFits) {
+  EXPECT_EQ(RunScriptAndGetResult(
+                "const v8 = require('v8');\n"
+                "const value = { a: 'x'.repeat(100), b: [1, 2, 3] };\n"
+                "const expected = v8.serialize(value);\n"
+                "const out = [];\n"
+                "for (const size of [0, 4, 16, 65, 66, expected.length,\n"
+                "                    expected.length + 200]) {\n"
+                "  const buffer = Buffer.alloc(size + 8, 0xff);\n"
+                "  const n = new v8.Serializer().serializeInto(\n"
+                "      value, buffer, 8);\n"
+                "  const written = Math.min(n, size);\n"
+                "  out.push(n === expected.length &&\n"
+                "           buffer.subarray(8, 8 + written).equals(\n"
+                "               expected.subarray(0, written)) &&\n"
+                "           buffer.subarray(8 + written).every(\n"
+                "               (b) => b === 0xff));\n"
+                "}\n"
+                "globalThis.result = out.join();"),
+            "true,true,true,true,true,true,true");
+}
+
+// Sparse arrays do not get a buffer sized after their length.
+TEST_F(SerdesTest, SparseArrays) {
+  EXPECT_EQ(RunScriptAndGetResult(
+                "const v8 = require('v8');\n"
+                "const value = [];\n"
+                "value[2 ** 32 - 2] = 1;\n"
+                "const copy = v8.deserialize(v8.serialize(value));\n"
+                "globalThis.result = `${copy.length} ${copy[2 ** 32 - 2]} ` +\n"
+                "    `${v8.serialize(value).length < 64}`;"),
+            "4294967295 1 true");
+}
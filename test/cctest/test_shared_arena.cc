@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+#include "node_shared_arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using node::worker::SharedArenaAllocator;
+
+TEST(SharedArenaAllocator, SizeClasses) {
+  SharedArenaAllocator allocator(4096 + 10);
+  EXPECT_EQ(allocator.capacity(), 4096u);
+
+  std::optional<size_t> small = allocator.Allocate(1);
+  ASSERT_TRUE(small.has_value());
+  EXPECT_EQ(allocator.BlockSize(*small), 64u);
+
+  std::optional<size_t> medium = allocator.Allocate(65);
+  ASSERT_TRUE(medium.has_value());
+  EXPECT_EQ(allocator.BlockSize(*medium), 128u);
+  EXPECT_EQ(*medium % 128, 0u);
+  EXPECT_NE(*medium, *small);
+
+  EXPECT_FALSE(allocator.Allocate(4097).has_value());
+  EXPECT_EQ(allocator.BlockSize(*medium + 64), 0u);
+
+  EXPECT_TRUE(allocator.Free(*small));
+  EXPECT_FALSE(allocator.Free(*small));
+  EXPECT_FALSE(allocator.Free(*medium + 64));
+  EXPECT_FALSE(allocator.Free(4096));
+  EXPECT_EQ(allocator.BlockSize(*small), 0u);
+
+  // A freed block is reused for the same size class.
+  EXPECT_EQ(allocator.Allocate(64), small);
+}
+
+TEST(SharedArenaAllocator, SplitsLargerBlocks) {
+  SharedArenaAllocator allocator(1024);
+  std::optional<size_t> whole = allocator.Allocate(1024);
+  ASSERT_TRUE(whole.has_value());
+  EXPECT_FALSE(allocator.Allocate(1).has_value());
+  EXPECT_TRUE(allocator.Free(*whole));
+
+  // The freed 1024 byte block is split into blocks of 64, 64, 128, 256 and
+  // 512 bytes, which then fill the arena without overlapping.
+  std::vector<size_t> offsets;
+  for (size_t size : {64, 64, 128, 256, 512}) {
+    std::optional<size_t> offset = allocator.Allocate(size);
+    ASSERT_TRUE(offset.has_value()) << size;
+    EXPECT_EQ(allocator.BlockSize(*offset), size);
+    offsets.push_back(*offset);
+  }
+  EXPECT_FALSE(allocator.Allocate(1).has_value());
+
+  std::sort(offsets.begin(), offsets.end());
+  EXPECT_EQ(offsets, std::vector<size_t>({0, 64, 128, 256, 512}));
+}
+
+// Blocks start at a multiple of their size, also when smaller blocks were
+// carved off before them. The room that is skipped is not lost.
+TEST(SharedArenaAllocator, AlignsBlocks) {
+  SharedArenaAllocator allocator(4096);
+  std::vector<size_t> offsets;
+  for (size_t size : {64, 1024, 128, 256, 64, 512}) {
+    std::optional<size_t> offset = allocator.Allocate(size);
+    ASSERT_TRUE(offset.has_value()) << size;
+    EXPECT_EQ(*offset % size, 0u) << size;
+    EXPECT_EQ(allocator.BlockSize(*offset), size);
+    offsets.push_back(*offset);
+  }
+  EXPECT_EQ(offsets, std::vector<size_t>({0, 1024, 128, 256, 64, 512}));
+
+  // The rest of the arena makes up another block of 2048 bytes.
+  EXPECT_EQ(allocator.Allocate(2048), 2048u);
+  EXPECT_FALSE(allocator.Allocate(1).has_value());
+}
+
+TEST(SharedArenaAllocator, ConcurrentUse) {
+  constexpr size_t kThreads = 4;
+  constexpr size_t kRounds = 20000;
+  SharedArenaAllocator allocator(64 * 1024);
+  std::vector<std::atomic<char>> owners(allocator.capacity() / 64);
+  std::atomic<bool> overlapped{false};
+
+  // Marks every 64 byte unit of a block as owned by `id`, or as free if `id`
+  // is 0. Finding another owner means that two live blocks overlap.
+  auto mark = [&](size_t offset, char id) {
+    size_t end = offset + allocator.BlockSize(offset);
+    for (size_t unit = offset / 64; unit < end / 64; unit++) {
+      if (id == 0) {
+        owners[unit] = 0;
+        continue;
+      }
+      char expected = 0;
+      if (!owners[unit].compare_exchange_strong(expected, id))
+        overlapped = true;
+    }
+  };
+
+  auto worker = [&](char id) {
+    std::vector<size_t> held;
+    for (size_t i = 0; i < kRounds; i++) {
+      std::optional<size_t> offset = allocator.Allocate(64 << (i % 3));
+      if (offset.has_value()) {
+        mark(*offset, id);
+        held.push_back(*offset);
+      }
+      if (held.size() > 8 || (!offset.has_value() && !held.empty())) {
+        size_t victim = held.front();
+        held.erase(held.begin());
+        mark(victim, 0);
+        EXPECT_TRUE(allocator.Free(victim));
+      }
+    }
+    for (size_t offset : held) {
+      mark(offset, 0);
+      EXPECT_TRUE(allocator.Free(offset));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; i++)
+    threads.emplace_back(worker, static_cast<char>(i + 1));
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_FALSE(overlapped);
+}
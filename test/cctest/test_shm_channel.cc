@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "node_shm_channel.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using node::shm_channel::ShmRing;
+
+namespace {
+
+constexpr size_t kCapacity = 64;
+
+struct Ring {
+  alignas(64) uint8_t memory[ShmRing::SizeFor(kCapacity)] = {};
+  ShmRing writer{memory, kCapacity};
+  ShmRing reader{memory, kCapacity};
+
+  ShmRing::Header* header() {
+    return reinterpret_cast<ShmRing::Header*>(memory);
+  }
+};
+
+}  // anonymous namespace
+
+TEST(ShmRing, WriteAndRead) {
+  Ring ring;
+  size_t size;
+  EXPECT_EQ(ring.reader.Peek(&size), ShmRing::ReadResult::kEmpty);
+  EXPECT_EQ(ring.writer.max_record_size(), kCapacity - 4);
+
+  // Wrap around the end of the ring a few times, with records of all sizes.
+  for (size_t length = 0; length <= ring.writer.max_record_size(); length++) {
+    std::vector<uint8_t> message(length);
+    for (size_t i = 0; i < length; i++) message[i] = length + i;
+
+    bool notify = false;
+    ASSERT_TRUE(ring.writer.Write(message.data(), length, &notify));
+    // The reader is caught up, so it has to be woken up.
+    EXPECT_TRUE(notify);
+
+    ASSERT_EQ(ring.reader.Peek(&size), ShmRing::ReadResult::kRecord);
+    ASSERT_EQ(size, length);
+    std::vector<uint8_t> out(size);
+    ring.reader.Consume(out.data(), size);
+    EXPECT_EQ(out, message);
+    EXPECT_EQ(ring.reader.Peek(&size), ShmRing::ReadResult::kEmpty);
+  }
+}
+
+TEST(ShmRing, Full) {
+  Ring ring;
+  uint8_t message[12] = {1, 2, 3};
+  bool notify;
+  ASSERT_TRUE(ring.writer.Write(message, sizeof(message), &notify));
+  EXPECT_TRUE(notify);
+  // Records that are written while the reader is behind do not wake it up.
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(ring.writer.Write(message, sizeof(message), &notify));
+    EXPECT_FALSE(notify);
+  }
+  EXPECT_FALSE(ring.writer.Write(message, 1, &notify));
+  EXPECT_FALSE(ring.writer.Write(nullptr, kCapacity, &notify));
+
+  size_t size;
+  uint8_t out[12];
+  ASSERT_EQ(ring.reader.Peek(&size), ShmRing::ReadResult::kRecord);
+  ring.reader.Consume(out, size);
+  EXPECT_EQ(memcmp(out, message, sizeof(out)), 0);
+  EXPECT_TRUE(ring.writer.Write(message, sizeof(message), &notify));
+}
+
+TEST(ShmRing, Corrupt) {
+  Ring ring;
+  size_t size;
+  uint8_t message[8] = {};
+  bool notify;
+
+  // A tail that is too far ahead of the head.
+  ring.header()->tail = kCapacity + 1;
+  EXPECT_EQ(ring.reader.Peek(&size), ShmRing::ReadResult::kCorrupt);
+  EXPECT_FALSE(ring.writer.Write(message, sizeof(message), &notify));
+
+  // A record that is longer than what was written.
+  ring.header()->tail = 0;
+  ASSERT_TRUE(ring.writer.Write(message, sizeof(message), &notify));
+  uint32_t length = sizeof(message) + 1;
+  memcpy(ring.memory + sizeof(ShmRing::Header), &length, sizeof(length));
+  EXPECT_EQ(ring.reader.Peek(&size), ShmRing::ReadResult::kCorrupt);
+
+  // Less than a length.
+  ring.header()->tail = 2;
+  EXPECT_EQ(ring.reader.Peek(&size), ShmRing::ReadResult::kCorrupt);
+}
+
+TEST(ShmRing, Threads) {
+  Ring ring;
+  constexpr uint32_t kCount = 10000;
+  std::thread writer([&]() {
+    for (uint32_t n = 0; n < kCount;) {
+      bool notify;
+      if (ring.writer.Write(reinterpret_cast<uint8_t*>(&n), n % 5, &notify)) {
+        n++;
+      }
+    }
+  });
+
+  for (uint32_t n = 0; n < kCount;) {
+    size_t size;
+    ShmRing::ReadResult result = ring.reader.Peek(&size);
+    ASSERT_NE(result, ShmRing::ReadResult::kCorrupt);
+    if (result == ShmRing::ReadResult::kEmpty) continue;
+    ASSERT_EQ(size, n % 5);
+    uint32_t value = 0;
+    ring.reader.Consume(reinterpret_cast<uint8_t*>(&value), size);
+    ASSERT_EQ(memcmp(&value, &n, size), 0);
+    n++;
+  }
+  writer.join();
+}
@@ -1,9 +1,17 @@
 #include "node_sockaddr-inl.h"
 #include "gtest/gtest.h"
+#include "node_test_fixture.h"
 
+#include <string>
+
+using node::Environment;
 using node::SocketAddress;
 using node::SocketAddressBlockList;
 using node::SocketAddressLRU;
+using node::SocketAddressStringCache;
+using v8::HandleScope;
+using v8::Local;
+using v8::String;
 
 TEST(SocketAddress, SocketAddress) {
   CHECK(SocketAddress::is_numeric_host("123.123.123.123"));
@@ -215,3 +223,144 @@ TEST(SocketAddressBlockList, Simple) {
   CHECK(!bl.Apply(addr1));
   CHECK(bl.Apply(addr2));
 }
+
+namespace {
+std::shared_ptr<SocketAddress> MakeAddress(int family, const char* host) {
+  sockaddr_storage storage;
+  CHECK(SocketAddress::ToSockAddr(family, host, 0, &storage));
+  return std::make_shared<SocketAddress>(
+      reinterpret_cast<const sockaddr*>(&storage));
+}
+
+void AddRules(SocketAddressBlockList* bl) {
+  bl->AddSocketAddress(MakeAddress(AF_INET, "8.8.8.8"));
+  bl->AddSocketAddress(MakeAddress(AF_INET6, "::ffff:9.9.9.9"));
+  bl->AddSocketAddress(MakeAddress(AF_INET6, "2001:db9::1"));
+  bl->AddSocketAddressMask(MakeAddress(AF_INET, "10.0.0.0"), 8);
+  bl->AddSocketAddressMask(MakeAddress(AF_INET, "192.168.1.128"), 25);
+  bl->AddSocketAddressMask(MakeAddress(AF_INET6, "2001:db8::"), 32);
+  bl->AddSocketAddressMask(MakeAddress(AF_INET6, "::ffff:172.16.0.0"), 108);
+  bl->AddSocketAddressRange(MakeAddress(AF_INET, "1.1.1.10"),
+                            MakeAddress(AF_INET, "1.1.1.20"));
+  bl->AddSocketAddressRange(MakeAddress(AF_INET6, "fe80::1"),
+                            MakeAddress(AF_INET6, "fe80::1:0"));
+  // Covers ::ffff:0:0/96 in IPv6 terms, but never matches IPv4 addresses.
+  bl->AddSocketAddressRange(MakeAddress(AF_INET6, "::2"),
+                            MakeAddress(AF_INET6, "::1:0:0:0"));
+}
+}  // namespace
+
+TEST(SocketAddressBlockList, Compiled) {
+  SocketAddressBlockList linear;
+  SocketAddressBlockList compiled;
+  AddRules(&linear);
+  compiled.Compile();
+  AddRules(&compiled);
+  CHECK(!linear.is_compiled());
+  CHECK(compiled.is_compiled());
+
+  const std::pair<int, const char*> addresses[] = {
+      {AF_INET, "8.8.8.8"},           {AF_INET, "8.8.8.9"},
+      {AF_INET6, "::ffff:8.8.8.8"},   {AF_INET, "9.9.9.9"},
+      {AF_INET6, "::ffff:9.9.9.9"},   {AF_INET6, "2001:db9::1"},
+      {AF_INET6, "2001:db9::2"},      {AF_INET, "10.255.0.1"},
+      {AF_INET, "11.0.0.0"},          {AF_INET6, "::ffff:10.1.2.3"},
+      {AF_INET6, "::10.1.2.3"},       {AF_INET, "192.168.1.127"},
+      {AF_INET, "192.168.1.128"},     {AF_INET, "192.168.1.255"},
+      {AF_INET6, "2001:db8:ffff::1"}, {AF_INET6, "2001:db7::1"},
+      {AF_INET, "172.16.0.1"},        {AF_INET, "172.31.255.255"},
+      {AF_INET, "172.32.0.0"},        {AF_INET, "1.1.1.9"},
+      {AF_INET, "1.1.1.10"},          {AF_INET, "1.1.1.20"},
+      {AF_INET, "1.1.1.21"},          {AF_INET6, "::ffff:1.1.1.15"},
+      {AF_INET6, "fe80::"},           {AF_INET6, "fe80::1"},
+      {AF_INET6, "fe80::ffff"},       {AF_INET6, "fe80::1:0"},
+      {AF_INET6, "fe80::1:1"},        {AF_INET6, "::1"},
+      {AF_INET6, "::2"},              {AF_INET6, "::ffff:4.4.4.4"},
+      {AF_INET, "4.4.4.4"},           {AF_INET6, "::1:0:0:1"},
+  };
+  for (const auto& [family, host] : addresses) {
+    std::shared_ptr<SocketAddress> address = MakeAddress(family, host);
+    EXPECT_EQ(compiled.Apply(address), linear.Apply(address)) << host;
+  }
+
+  CHECK(compiled.Apply(MakeAddress(AF_INET, "10.1.2.3")));
+  CHECK(compiled.Apply(MakeAddress(AF_INET6, "::ffff:4.4.4.4")));
+  CHECK(!compiled.Apply(MakeAddress(AF_INET, "4.4.4.4")));
+
+  // The trie is rebuilt without the removed rule.
+  std::shared_ptr<SocketAddress> removed = MakeAddress(AF_INET, "8.8.8.8");
+  CHECK(compiled.Apply(removed));
+  compiled.RemoveSocketAddress(removed);
+  CHECK(!compiled.Apply(removed));
+  CHECK(compiled.Apply(MakeAddress(AF_INET6, "2001:db9::1")));
+}
+
+TEST(SocketAddressBlockList, CompiledPrefixIndex) {
+  using PrefixIndex = SocketAddressBlockList::PrefixIndex;
+  PrefixIndex index;
+  CHECK(!index.Contains({0, 0}));
+
+  // 10.0.0.0/8 makes the longer prefixes in it redundant.
+  index.Insert({0, 0xffff0a010000}, 112);
+  index.Insert({0, 0xffff0a000000}, 104);
+  index.Insert({0, 0xffff0a020304}, 128);
+  CHECK(index.Contains({0, 0xffff0a020304}));
+  CHECK(index.Contains({0, 0xffff0affffff}));
+  CHECK(!index.Contains({0, 0xffff0b000000}));
+
+  // A range that is not aligned to a prefix.
+  index.InsertRange({1, 3}, {2, 5});
+  CHECK(!index.Contains({1, 2}));
+  CHECK(index.Contains({1, 3}));
+  CHECK(index.Contains({1, ~uint64_t{0}}));
+  CHECK(index.Contains({2, 0}));
+  CHECK(index.Contains({2, 5}));
+  CHECK(!index.Contains({2, 6}));
+
+  index.Insert({0, 0}, 0);
+  CHECK(index.Contains({~uint64_t{0}, ~uint64_t{0}}));
+}
+
+class SocketAddressStringCacheTest : public EnvironmentTestFixture {};
+
+TEST_F(SocketAddressStringCacheTest, SharesStringsOfSameAddress) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env_{handle_scope, argv};
+  Environment* env = *env_;
+  SocketAddressStringCache* cache = env->address_string_cache();
+  auto get = [&](const SocketAddress& address) {
+    return cache->Get(env, address.data()).ToLocalChecked();
+  };
+  auto str = [&](Local<String> value) {
+    return std::string(*String::Utf8Value(isolate_, value));
+  };
+
+  SocketAddress a, b, c, d;
+  CHECK(SocketAddress::New("123.123.123.123", 80, &a));
+  CHECK(SocketAddress::New("123.123.123.123", 443, &b));
+  CHECK(SocketAddress::New("123.123.123.124", 80, &c));
+  CHECK(SocketAddress::New("::1", 80, &d));
+
+  Local<String> first = get(a);
+  EXPECT_EQ(str(first), "123.123.123.123");
+  // The port is not part of the address.
+  EXPECT_EQ(get(b), first);
+
+  Local<String> other = get(c);
+  EXPECT_NE(other, first);
+  EXPECT_EQ(str(other), "123.123.123.124");
+  EXPECT_EQ(str(get(d)), "::1");
+
+  // The least recently used addresses are evicted once the cache is full.
+  for (size_t i = 0; i < SocketAddressStringCache::kMaxSize; i++) {
+    SocketAddress e;
+    std::string ip = "10.0." + std::to_string(i / 256) + "." +
+                     std::to_string(i % 256);
+    CHECK(SocketAddress::New(ip.c_str(), 80, &e));
+    get(e);
+  }
+  Local<String> again = get(a);
+  EXPECT_NE(again, first);
+  EXPECT_TRUE(again->StrictEquals(first));
+}
@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+#include "spsc_ring_buffer.h"
+
+#include <memory>
+#include <thread>
+
+using node::SPSCRingBuffer;
+
+TEST(SPSCRingBuffer, FillAndDrain) {
+  SPSCRingBuffer<std::unique_ptr<int>> ring(5);
+  EXPECT_EQ(ring.capacity(), 8u);
+  EXPECT_TRUE(ring.IsEmpty());
+
+  std::unique_ptr<int> value;
+  EXPECT_FALSE(ring.Pop(&value));
+
+  // Wrap around the end of the slot array a few times.
+  int next_push = 0;
+  int next_pop = 0;
+  for (int round = 0; round < 5; round++) {
+    while (true) {
+      auto item = std::make_unique<int>(next_push);
+      if (!ring.Push(std::move(item))) {
+        // A failed Push() does not consume its argument.
+        EXPECT_NE(item, nullptr);
+        break;
+      }
+      next_push++;
+    }
+    EXPECT_EQ(ring.Size(), ring.capacity());
+
+    for (int i = 0; i < 3; i++) {
+      ASSERT_TRUE(ring.Pop(&value));
+      EXPECT_EQ(*value, next_pop++);
+    }
+  }
+
+  while (ring.Pop(&value)) EXPECT_EQ(*value, next_pop++);
+  EXPECT_EQ(next_pop, next_push);
+  EXPECT_TRUE(ring.IsEmpty());
+}
+
+TEST(SPSCRingBuffer, TwoThreads) {
+  constexpr size_t kCount = 200000;
+  SPSCRingBuffer<size_t> ring(64);
+
+  std::thread producer([&]() {
+    for (size_t i = 1; i <= kCount; i++) {
+      size_t item = i;
+      while (!ring.Push(std::move(item))) std::this_thread::yield();
+    }
+  });
+
+  size_t expected = 1;
+  while (expected <= kCount) {
+    size_t item;
+    if (!ring.Pop(&item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(item, expected);
+    expected++;
+  }
+  producer.join();
+  EXPECT_TRUE(ring.IsEmpty());
+}
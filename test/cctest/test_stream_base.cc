@@ -0,0 +1,89 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class StreamBaseTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `stream` set to a JSStream whose reads are driven by
+  // readBuffer() and emitEOF(), and returns what it left in
+  // globalThis.result. `reads` collects the nread of every onread() call,
+  // and `reading` tells whether the stream is reading.
+  std::string Run(const char* script) {
+    std::string source =
+        "const { getSystemErrorName } = require('util');\n"
+        "const { JSStream } = internalBinding('js_stream');\n"
+        "const { streamBaseState, kReadBytesOrError } =\n"
+        "    internalBinding('stream_wrap');\n"
+        "const name = (n) => n < 0 ? getSystemErrorName(n) : n;\n"
+        "const stream = new JSStream();\n"
+        "const reads = [];\n"
+        "let reading = false;\n"
+        "stream.onreadstart = () => { reading = true; return 0; };\n"
+        "stream.onreadstop = () => { reading = false; return 0; };\n"
+        "stream.onread = () =>\n"
+        "    reads.push(name(streamBaseState[kReadBytesOrError]));\n"
+        "const text = (view, n) =>\n"
+        "    Buffer.from(view.buffer, 0, n).toString();\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// A pending read gets what fits into its view. The rest is kept and copied
+// right away into the views of the next reads.
+TEST_F(StreamBaseTest, ReadIntoPendingAndBuffered) {
+  EXPECT_EQ(Run("const out = [];\n"
+                "const a = new Uint8Array(2);\n"
+                "out.push(stream.readInto(a), reading);\n"
+                "stream.readBuffer(Buffer.from('hello'));\n"
+                "out.push(reads.join(' '), text(a, 2), reading);\n"
+                "const b = new Uint8Array(2);\n"
+                "out.push(stream.readInto(b), text(b, 2));\n"
+                "const c = new Uint8Array(8);\n"
+                "out.push(stream.readInto(c), text(c, 1), reading);\n"
+                "globalThis.result = out.join();"),
+            "0,true,2,he,false,2,ll,1,o,false");
+}
+
+TEST_F(StreamBaseTest, ReadIntoEOF) {
+  EXPECT_EQ(Run("const out = [];\n"
+                "const a = new Uint8Array(8);\n"
+                "out.push(stream.readInto(a));\n"
+                "stream.emitEOF();\n"
+                "out.push(reads.join(' '), reading);\n"
+                "// An EOF while no read is pending is returned by the next.\n"
+                "stream.emitEOF();\n"
+                "out.push(name(stream.readInto(a)), reads.length);\n"
+                "globalThis.result = out.join();"),
+            "0,EOF,false,EOF,1");
+}
+
+// The memory of a view whose buffer is transferred while its read is
+// pending is not written to. Its read fails and the data goes to the next.
+TEST_F(StreamBaseTest, ReadIntoTransferredBuffer) {
+  EXPECT_EQ(Run("const out = [];\n"
+                "const a = new Uint8Array(8);\n"
+                "out.push(stream.readInto(a));\n"
+                "const moved = structuredClone(a.buffer, {\n"
+                "  transfer: [a.buffer],\n"
+                "});\n"
+                "stream.readBuffer(Buffer.from('xyz'));\n"
+                "out.push(reads.join(' '), new Uint8Array(moved)[0]);\n"
+                "out.push(name(stream.readInto(a)));\n"
+                "const b = new Uint8Array(8);\n"
+                "out.push(stream.readInto(b), text(b, 3));\n"
+                "globalThis.result = out.join();"),
+            "0,ECANCELED,0,EINVAL,3,xyz");
+}
+
+// Once readInto() is used, the stream does not also read through the
+// default listener.
+TEST_F(StreamBaseTest, ReadIntoRefusesReadStart) {
+  EXPECT_EQ(Run("const out = [name(stream.readStart())];\n"
+                "stream.readStop();\n"
+                "out.push(stream.readInto(new Uint8Array(4)));\n"
+                "out.push(name(stream.readStart()));\n"
+                "globalThis.result = out.join();"),
+            "0,0,EBUSY");
+}
@@ -0,0 +1,114 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+class StreamWrapTest : public EnvironmentTestFixture {
+ protected:
+  // Sends one byte with `count` file descriptors, the ends of fresh socket
+  // pairs, over the IPC pipe at `fds[0]`, then runs `script` with `pipe`
+  // reading from `fds[1]`, and returns what it left in globalThis.result.
+  std::string Run(int count, const char* script) {
+    int fds[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    Send(fds[0], count);
+    close(fds[0]);
+
+    std::string source =
+        "const { Pipe, constants } = internalBinding('pipe_wrap');\n"
+        "const pipe = new Pipe(constants.IPC);\n"
+        "pipe.open(" + std::to_string(fds[1]) + ");\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+
+  static void Send(int fd, int count) {
+    int passed[4];
+    for (int i = 0; i < count; i++) {
+      int pair[2];
+      ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pair), 0);
+      passed[i] = pair[0];
+      close(pair[1]);
+    }
+
+    char data = 'x';
+    iovec iov = {&data, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(passed))] = {};
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(count * sizeof(int));
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(count * sizeof(int));
+    memcpy(CMSG_DATA(cmsg), passed, count * sizeof(int));
+    ASSERT_EQ(sendmsg(fd, &msg, 0), 1);
+
+    for (int i = 0; i < count; i++) close(passed[i]);
+  }
+};
+
+// A read with several handles sets pendingHandles, and drops it again once
+// onread() has returned. The handles it did not take are closed.
+TEST_F(StreamWrapTest, UnclaimedPendingHandlesAreClosed) {
+  EXPECT_EQ(Run(3,
+                "pipe.onread = () => {\n"
+                "  const handles = pipe.pendingHandles;\n"
+                "  const first = pipe.pendingHandle;\n"
+                "  pipe.pendingHandle = null;\n"
+                "  setImmediate(() => {\n"
+                "    globalThis.result = [\n"
+                "      handles.length, handles[0] === first,\n"
+                "      pipe.pendingHandles, first.fd >= 0,\n"
+                "      handles[1].fd < 0, handles[2].fd < 0,\n"
+                "    ].join();\n"
+                "    first.close();\n"
+                "    pipe.close();\n"
+                "  });\n"
+                "  pipe.readStop();\n"
+                "};\n"
+                "pipe.readStart();"),
+            "3,true,,true,true,true");
+}
+
+TEST_F(StreamWrapTest, ClaimedPendingHandlesStayOpen) {
+  EXPECT_EQ(Run(2,
+                "pipe.onread = () => {\n"
+                "  const handles = pipe.pendingHandles;\n"
+                "  pipe.pendingHandle = null;\n"
+                "  pipe.pendingHandles = null;\n"
+                "  setImmediate(() => {\n"
+                "    globalThis.result =\n"
+                "        handles.map((handle) => handle.fd >= 0).join();\n"
+                "    for (const handle of handles) handle.close();\n"
+                "    pipe.close();\n"
+                "  });\n"
+                "  pipe.readStop();\n"
+                "};\n"
+                "pipe.readStart();"),
+            "true,true");
+}
+
+// A single handle comes without a list, as it always did.
+TEST_F(StreamWrapTest, SinglePendingHandle) {
+  EXPECT_EQ(Run(1,
+                "pipe.onread = () => {\n"
+                "  const handle = pipe.pendingHandle;\n"
+                "  globalThis.result =\n"
+                "      `${pipe.pendingHandles} ${handle.fd >= 0}`;\n"
+                "  handle.close();\n"
+                "  pipe.close();\n"
+                "};\n"
+                "pipe.readStart();"),
+            "undefined true");
+}
+#endif  // _WIN32
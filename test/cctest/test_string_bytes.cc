@@ -0,0 +1,129 @@
+#include "node_test_fixture.h"
+#include "string_bytes.h"
+#include "v8.h"
+
+#include <algorithm>
+#include <string>
+
+using node::StringBytes;
+
+class StringBytesTest : public NodeTestFixture {};
+
+static std::string MakeBytes(size_t length) {
+  std::string bytes(length, '\0');
+  for (size_t i = 0; i < length; i++)
+    bytes[i] = static_cast<char>(i * 37 + 11);
+  return bytes;
+}
+
+static std::string ScalarHex(const std::string& bytes) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  for (unsigned char byte : bytes) {
+    hex += digits[byte >> 4];
+    hex += digits[byte & 15];
+  }
+  return hex;
+}
+
+// Lengths around the block sizes of the vectorized kernels.
+static const size_t kLengths[] = {
+    0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200};
+
+TEST(StringBytes, HexEncode) {
+  for (size_t length : kLengths) {
+    std::string bytes = MakeBytes(length);
+    EXPECT_EQ(StringBytes::hex_encode(bytes.data(), bytes.size()),
+              ScalarHex(bytes))
+        << length;
+  }
+}
+
+TEST_F(StringBytesTest, HexWrite) {
+  v8::Isolate::Scope isolate_scope(isolate_);
+  v8::HandleScope handle_scope(isolate_);
+  v8::Local<v8::Context> context = v8::Context::New(isolate_);
+  v8::Context::Scope context_scope(context);
+
+  for (size_t length : kLengths) {
+    std::string bytes = MakeBytes(length);
+    std::string hex = ScalarHex(bytes);
+    // Mixed case is accepted.
+    for (size_t i = 0; i < hex.size(); i += 3) hex[i] = toupper(hex[i]);
+
+    std::u16string two_byte(hex.begin(), hex.end());
+    two_byte += u"\u2603";
+    v8::Local<v8::String> strings[] = {
+        v8::String::NewFromUtf8(isolate_, hex.data(),
+                                v8::NewStringType::kNormal, hex.size())
+            .ToLocalChecked(),
+        // The trailing character, which is never read, makes it two-byte.
+        v8::String::NewFromTwoByte(
+            isolate_, reinterpret_cast<const uint16_t*>(two_byte.data()),
+            v8::NewStringType::kNormal, two_byte.size())
+            .ToLocalChecked(),
+    };
+
+    for (v8::Local<v8::String> string : strings) {
+      std::string out(length, '\0');
+      EXPECT_EQ(StringBytes::Write(
+                    isolate_, out.data(), out.size(), string, node::HEX),
+                length);
+      EXPECT_EQ(out, bytes) << length;
+    }
+
+    // Decoding stops at the first character that is not a hex digit.
+    if (length > 20) {
+      hex[21] = 'g';
+      v8::Local<v8::String> invalid =
+          v8::String::NewFromUtf8(isolate_, hex.data(),
+                                  v8::NewStringType::kNormal, hex.size())
+              .ToLocalChecked();
+      std::string out(length, '\0');
+      EXPECT_EQ(StringBytes::Write(
+                    isolate_, out.data(), out.size(), invalid, node::HEX),
+                10u);
+      EXPECT_EQ(out.substr(0, 10), bytes.substr(0, 10));
+    }
+  }
+}
+
+// The result is the same as that of String::NewFromUtf8(), but one-byte
+// whenever it fits, and external when large.
+TEST_F(StringBytesTest, DecodeUtf8) {
+  v8::Isolate::Scope isolate_scope(isolate_);
+  v8::HandleScope handle_scope(isolate_);
+  v8::Local<v8::Context> context = v8::Context::New(isolate_);
+  v8::Context::Scope context_scope(context);
+
+  struct {
+    std::string utf8;
+    bool one_byte;
+  } inputs[] = {
+      {"", true},
+      {"ascii", true},
+      {"caf\xc3\xa9", true},
+      {"\xc3\xa9t\xc3\xa9", true},
+      {"\xe2\x82\xac and \xf0\x9f\x98\x80", false},
+      // Invalid sequences are replaced.
+      {"ab\xff\xc3", false},
+      {"\xc3\xa9\xed\xa0\x80", false},
+      {std::string(1 << 20, 'a'), true},
+      {std::string(1 << 20, 'a') + "\xc3\xa9", true},
+      {std::string(1 << 20, 'a') + "\xe2\x82\xac", false},
+  };
+  for (const auto& input : inputs) {
+    v8::Local<v8::String> expected =
+        v8::String::NewFromUtf8(isolate_, input.utf8.data(),
+                                v8::NewStringType::kNormal, input.utf8.size())
+            .ToLocalChecked();
+    v8::Local<v8::String> actual =
+        StringBytes::DecodeUtf8(isolate_, input.utf8.data(), input.utf8.size())
+            .ToLocalChecked();
+    size_t length = std::min<size_t>(input.utf8.size(), 16);
+    std::string name = input.utf8.substr(0, length);
+    EXPECT_TRUE(actual->StrictEquals(expected)) << name;
+    EXPECT_EQ(actual->IsOneByte(), input.one_byte) << name;
+    EXPECT_EQ(actual->IsExternal(), input.utf8.size() >= (1 << 20)) << name;
+  }
+}
@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include "string_search.h"
+#include "util-inl.h"
+
+#include <string>
+
+using node::SearchString;
+using node::stringsearch::SearchAny;
+
+static size_t Find(const std::string& haystack,
+                   const std::string& needle,
+                   size_t start = 0) {
+  return SearchString(reinterpret_cast<const uint8_t*>(haystack.data()),
+                      haystack.size(),
+                      reinterpret_cast<const uint8_t*>(needle.data()),
+                      needle.size(),
+                      start,
+                      true);
+}
+
+static size_t FindAny(const std::string& haystack,
+                      std::initializer_list<std::string> needle_list,
+                      size_t* which,
+                      size_t start = 0) {
+  std::vector<const uint8_t*> needles;
+  std::vector<size_t> lengths;
+  for (const std::string& needle : needle_list) {
+    needles.push_back(reinterpret_cast<const uint8_t*>(needle.data()));
+    lengths.push_back(needle.size());
+  }
+  return SearchAny(reinterpret_cast<const uint8_t*>(haystack.data()),
+                   haystack.size(),
+                   needles.data(),
+                   lengths.data(),
+                   needles.size(),
+                   start,
+                   which);
+}
+
+TEST(StringSearch, ShortPatterns) {
+  // Long enough to go through the block-wise path as well as the tail.
+  std::string haystack(100, 'a');
+  haystack += "\r\n";
+  haystack += std::string(50, 'a');
+  haystack += "\r\n";
+
+  EXPECT_EQ(Find(haystack, "\r\n"), 100u);
+  EXPECT_EQ(Find(haystack, "\r\n", 101), 152u);
+  EXPECT_EQ(Find(haystack, "a\r\n"), 99u);
+  EXPECT_EQ(Find(haystack, "\r\na"), 100u);
+  EXPECT_EQ(Find(haystack, "\n\r"), haystack.size());
+  EXPECT_EQ(Find(haystack, "aa\r\n", 150), 150u);
+
+  // First and last byte match at many positions, the middle does not.
+  std::string first_last(64, 'x');
+  EXPECT_EQ(Find(first_last, "xyx"), first_last.size());
+  first_last[40] = 'y';
+  EXPECT_EQ(Find(first_last, "xyx"), 39u);
+
+  // A match that ends exactly at the end of the subject.
+  std::string tail(37, '-');
+  tail += "ab";
+  EXPECT_EQ(Find(tail, "ab"), 37u);
+}
+
+TEST(StringSearch, SearchAny) {
+  std::string haystack = std::string(40, '.') + "key=value;next" +
+                         std::string(40, '.') + "\n";
+  size_t which = 0;
+
+  EXPECT_EQ(FindAny(haystack, {";", "="}, &which), 43u);
+  EXPECT_EQ(which, 1u);
+  EXPECT_EQ(FindAny(haystack, {";", "="}, &which, 44), 49u);
+  EXPECT_EQ(which, 0u);
+  EXPECT_EQ(FindAny(haystack, {"\n", "next"}, &which), 50u);
+  EXPECT_EQ(which, 1u);
+  EXPECT_EQ(FindAny(haystack, {"\n"}, &which), haystack.size() - 1);
+  EXPECT_EQ(which, 0u);
+  EXPECT_EQ(FindAny(haystack, {"#", "nope"}, &which), haystack.size());
+
+  // The first pattern in the list wins when several match at one position.
+  EXPECT_EQ(FindAny(haystack, {"key=", "key"}, &which), 40u);
+  EXPECT_EQ(which, 0u);
+  EXPECT_EQ(FindAny(haystack, {"key", "key="}, &which), 40u);
+  EXPECT_EQ(which, 0u);
+
+  // Patterns that would run past the end of the subject do not match.
+  EXPECT_EQ(FindAny(haystack, {"\nmore"}, &which), haystack.size());
+
+  // More distinct first bytes than the vectorized path handles.
+  EXPECT_EQ(FindAny(haystack,
+                    {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", ";"},
+                    &which),
+            49u);
+  EXPECT_EQ(which, 10u);
+}
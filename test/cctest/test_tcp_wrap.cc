@@ -0,0 +1,90 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+class TCPWrapTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `connectMulti(addresses, port, delay)` racing a
+  // connection over a new TCP handle and resolving to the arguments of
+  // req.oncomplete(), and returns what it left in globalThis.result.
+  std::string Run(const char* script) {
+    std::string source =
+        "const { TCP, TCPConnectWrap, constants } =\n"
+        "    internalBinding('tcp_wrap');\n"
+        "const { getSystemErrorName } = require('util');\n"
+        "const net = require('net');\n"
+        "const connectMulti = (addresses, port, delay) =>\n"
+        "    new Promise((resolve) => {\n"
+        "      const handle = new TCP(constants.SOCKET);\n"
+        "      const req = new TCPConnectWrap();\n"
+        "      req.oncomplete = (status, ...rest) => {\n"
+        "        handle.close();\n"
+        "        resolve([status && getSystemErrorName(status), ...rest]);\n"
+        "      };\n"
+        "      const err = handle.connectMulti(req, addresses, port, delay);\n"
+        "      if (err) resolve([getSystemErrorName(err)]);\n"
+        "    });\n";
+    source += script;
+    return RunScriptAndGetResult(source);
+  }
+};
+
+// An attempt that fails starts the next one without waiting for the delay,
+// and the handle takes over the socket that connects. The server listens
+// on IPv4 only, so the connection to ::1 fails, whether or not there is
+// IPv6.
+TEST_F(TCPWrapTest, ConnectMulti) {
+  EXPECT_EQ(
+      Run("const server = net.createServer((socket) => socket.destroy());\n"
+          "server.listen(0, '127.0.0.1', async () => {\n"
+          "  const { port } = server.address();\n"
+          "  const start = Date.now();\n"
+          "  const [status, , , readable, writable, index] =\n"
+          "      await connectMulti(['::1', '127.0.0.1'], port, 60000);\n"
+          "  globalThis.result = [status, readable, writable, index,\n"
+          "                       Date.now() - start < 30000].join();\n"
+          "  server.close();\n"
+          "});"),
+      "0,true,true,1,true");
+}
+
+// Once every attempt has failed, the status is that of the last one.
+TEST_F(TCPWrapTest, ConnectMultiFails) {
+  EXPECT_EQ(
+      Run("const server = net.createServer();\n"
+          "server.listen(0, '127.0.0.1', () => {\n"
+          "  const { port } = server.address();\n"
+          "  server.close(async () => {\n"
+          "    const [status, , , , , index] =\n"
+          "        await connectMulti(['::1', '127.0.0.1'], port, 10);\n"
+          "    globalThis.result = [status, index].join();\n"
+          "  });\n"
+          "});"),
+      "ECONNREFUSED,-1");
+}
+
+#ifndef _WIN32
+// With REUSE_PORT, several servers can listen on the same port. One that
+// does not ask for it still cannot.
+TEST_F(TCPWrapTest, ReusePort) {
+  EXPECT_EQ(
+      Run("const listen = (flags, port) => {\n"
+          "  const handle = new TCP(constants.SERVER);\n"
+          "  const err = handle.bind('127.0.0.1', port, flags) ||\n"
+          "      handle.listen(1);\n"
+          "  return [handle, err && getSystemErrorName(err)];\n"
+          "};\n"
+          "const [first, err1] = listen(constants.REUSE_PORT, 0);\n"
+          "const address = {};\n"
+          "first.getsockname(address);\n"
+          "const [second, err2] = listen(constants.REUSE_PORT, address.port);\n"
+          "const [third, err3] = listen(0, address.port);\n"
+          "const other = {};\n"
+          "second.getsockname(other);\n"
+          "globalThis.result =\n"
+          "    [err1, err2, other.port === address.port, err3].join();\n"
+          "for (const handle of [first, second, third]) handle.close();"),
+      "0,0,true,EADDRINUSE");
+}
+#endif  // _WIN32
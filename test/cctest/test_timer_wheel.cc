@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+#include "timer_wheel.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+using node::TimerWheel;
+
+TEST(TimerWheel, InsertCancelAndExpire) {
+  TimerWheel wheel(1000);
+  EXPECT_EQ(wheel.NextTick(), TimerWheel::kNever);
+
+  TimerWheel::Id soon = wheel.Insert(1010);
+  TimerWheel::Id later = wheel.Insert(1000 + 5000);
+  TimerWheel::Id cancelled = wheel.Insert(1020);
+  // Entries that are already due expire on the next tick.
+  TimerWheel::Id due = wheel.Insert(900);
+  EXPECT_EQ(wheel.size(), 4u);
+  EXPECT_EQ(wheel.NextTick(), 1001u);
+
+  EXPECT_TRUE(wheel.Cancel(cancelled));
+  EXPECT_FALSE(wheel.Cancel(cancelled));
+  EXPECT_FALSE(wheel.IsActive(cancelled));
+
+  std::vector<TimerWheel::Id> expired;
+  wheel.Advance(1009, &expired);
+  EXPECT_EQ(expired, std::vector<TimerWheel::Id>({due}));
+  EXPECT_EQ(wheel.now(), 1009u);
+
+  expired.clear();
+  wheel.Advance(1010, &expired);
+  EXPECT_EQ(expired, std::vector<TimerWheel::Id>({soon}));
+
+  // Entries that are far out are not looked at on every tick.
+  EXPECT_GT(wheel.NextTick(), 1100u);
+  EXPECT_LE(wheel.NextTick(), 6000u);
+
+  EXPECT_TRUE(wheel.Reschedule(later, 7000));
+  expired.clear();
+  wheel.Advance(6999, &expired);
+  EXPECT_TRUE(expired.empty());
+  wheel.Advance(7000, &expired);
+  EXPECT_EQ(expired, std::vector<TimerWheel::Id>({later}));
+  EXPECT_EQ(wheel.size(), 0u);
+  EXPECT_EQ(wheel.NextTick(), TimerWheel::kNever);
+
+  // Ids are reused.
+  EXPECT_EQ(wheel.Insert(8000), later);
+}
+
+TEST(TimerWheel, MatchesOrderedMap) {
+  std::mt19937_64 random(42);
+  TimerWheel wheel(12345);
+  // Expiry for every active id.
+  std::map<TimerWheel::Id, uint64_t> active;
+  uint64_t now = 12345;
+
+  for (int round = 0; round < 20000; round++) {
+    uint64_t range = uint64_t{1} << (random() % 40);
+    switch (random() % 4) {
+      case 0:
+      case 1: {
+        uint64_t expiry = now + 1 + random() % range;
+        TimerWheel::Id id = wheel.Insert(expiry);
+        EXPECT_EQ(active.count(id), 0u);
+        active[id] = expiry;
+        break;
+      }
+      case 2: {
+        if (active.empty()) break;
+        auto it = active.begin();
+        std::advance(it, random() % active.size());
+        if (random() % 2) {
+          EXPECT_TRUE(wheel.Cancel(it->first));
+          active.erase(it);
+        } else {
+          it->second = now + 1 + random() % range;
+          EXPECT_TRUE(wheel.Reschedule(it->first, it->second));
+        }
+        break;
+      }
+      case 3: {
+        uint64_t target = now + random() % (range * 4);
+        std::vector<TimerWheel::Id> expired;
+        wheel.Advance(target, &expired);
+        uint64_t last = 0;
+        for (TimerWheel::Id id : expired) {
+          ASSERT_EQ(active.count(id), 1u);
+          EXPECT_LE(active[id], target);
+          EXPECT_GE(active[id], last);
+          last = active[id];
+          active.erase(id);
+        }
+        for (const auto& [id, expiry] : active) EXPECT_GT(expiry, target);
+        now = target;
+        break;
+      }
+    }
+    ASSERT_EQ(wheel.size(), active.size());
+  }
+}
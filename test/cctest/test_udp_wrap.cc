@@ -0,0 +1,158 @@
+#include "env-inl.h"
+#include "gtest/gtest.h"
+#include "node_internals.h"
+#include "node_test_fixture.h"
+
+#include <string>
+
+class UDPWrapTest : public EnvironmentTestFixture {
+ protected:
+  // Sends a few datagrams to a socket on the loopback interface and returns
+  // the number that arrived intact and in order.
+  int RunPingPong(bool recvmmsg) {
+    const v8::HandleScope handle_scope(isolate_);
+    const Argv argv;
+    Env env{handle_scope, argv};
+    (*env)->options()->test_udp_no_recvmmsg = !recvmmsg;
+
+    return std::stoi(RunScriptAndGetResult(
+        env,
+        "const dgram = require('dgram');\n"
+        "const socket = dgram.createSocket('udp4');\n"
+        "globalThis.result = 0;\n"
+        "socket.on('message', (msg) => {\n"
+        "  if (msg.toString() !== `datagram ${globalThis.result}`)\n"
+        "    return socket.close();\n"
+        "  if (++globalThis.result === 32) socket.close();\n"
+        "});\n"
+        "socket.bind(0, '127.0.0.1', () => {\n"
+        "  const { port } = socket.address();\n"
+        "  for (let i = 0; i < 32; i++)\n"
+        "    socket.send(`datagram ${i}`, port, '127.0.0.1');\n"
+        "});"));
+  }
+};
+
+TEST_F(UDPWrapTest, ReceiveBatches) {
+  EXPECT_EQ(RunPingPong(true), 32);
+}
+
+// This is the only path on platforms where libuv does not use recvmmsg().
+TEST_F(UDPWrapTest, ReceiveWithoutRecvmmsg) {
+  EXPECT_EQ(RunPingPong(false), 32);
+}
+
+class UDPWrapTaskQueuesTest : public EnvironmentTestFixture {
+ protected:
+  // Receives four datagrams that arrive together, each of which queues a
+  // tick, and returns in which order the messages (m) and ticks (t) ran.
+  std::string Run(bool batch) {
+    const v8::HandleScope handle_scope(isolate_);
+    const Argv argv;
+    Env env{handle_scope, argv};
+    (*env)->options()->test_udp_no_recvmmsg = true;
+    (*env)->options()->experimental_batch_io_callbacks = batch;
+
+    return RunScriptAndGetResult(
+        env,
+        "const dgram = require('dgram');\n"
+        "const socket = dgram.createSocket('udp4');\n"
+        "let order = '';\n"
+        "socket.on('message', () => {\n"
+        "  order += 'm';\n"
+        "  process.nextTick(() => order += 't');\n"
+        "  if (order.split('m').length === 5) socket.close();\n"
+        "});\n"
+        "socket.on('close', () => globalThis.result = order);\n"
+        "socket.bind(0, '127.0.0.1', () => {\n"
+        "  const { port } = socket.address();\n"
+        "  for (let i = 0; i < 4; i++)\n"
+        "    socket.send(`datagram ${i}`, port, '127.0.0.1');\n"
+        "});");
+  }
+};
+
+TEST_F(UDPWrapTaskQueuesTest, TicksRunAfterEveryMessage) {
+  EXPECT_EQ(Run(false), "mtmtmtmt");
+}
+
+// With --experimental-batch-io-callbacks, the messages that are read in one
+// go share one run of the task queues.
+TEST_F(UDPWrapTaskQueuesTest, BatchedTicksRunOnce) {
+  EXPECT_EQ(Run(true), "mmmmtttt");
+}
+
+class UDPWrapTrySendTest : public EnvironmentTestFixture {
+ protected:
+  // Runs `script` with `sender` set to a UDP handle bound to the loopback
+  // interface, and `name(err)` giving the name of an error code, and returns
+  // what it left in globalThis.result.
+  std::string Run(const char* script, bool try_send = true) {
+    const v8::HandleScope handle_scope(isolate_);
+    const Argv argv;
+    Env env{handle_scope, argv};
+    (*env)->options()->test_udp_no_try_send = !try_send;
+
+    std::string source =
+        "const { getSystemErrorName } = require('util');\n"
+        "const dgram = require('dgram');\n"
+        "const { UDP } = internalBinding('udp_wrap');\n"
+        "const name = (err) => err && getSystemErrorName(err);\n"
+        "const sender = new UDP();\n"
+        "sender.bind('127.0.0.1', 0, 0);\n";
+    source += script;
+    return RunScriptAndGetResult(env, source);
+  }
+};
+
+// Datagrams to more destinations than are kept parsed each go where they
+// were sent, and an address that does not parse is not kept.
+TEST_F(UDPWrapTrySendTest, Destinations) {
+  EXPECT_EQ(Run("const errs = new Set();\n"
+                "let bad;\n"
+                "let pending = 6 * 3;\n"
+                "let misrouted = 0;\n"
+                "const sockets = [];\n"
+                "const done = () => {\n"
+                "  for (const socket of sockets) socket.close();\n"
+                "  sender.close();\n"
+                "  globalThis.result = [...errs, bad, misrouted].join();\n"
+                "};\n"
+                "const send = () => {\n"
+                "  for (let round = 0; round < 3; round++) {\n"
+                "    sockets.forEach((socket, i) => {\n"
+                "      errs.add(name(sender.trySend(\n"
+                "          [Buffer.from(`${i}`)], 1,\n"
+                "          socket.address().port, '127.0.0.1')));\n"
+                "    });\n"
+                "    const port = sockets[0].address().port;\n"
+                "    bad = name(sender.trySend(\n"
+                "        [Buffer.from('x')], 1, port, 'not an address'));\n"
+                "  }\n"
+                "};\n"
+                "for (let i = 0; i < 6; i++) {\n"
+                "  const socket = dgram.createSocket('udp4');\n"
+                "  socket.on('message', (msg) => {\n"
+                "    if (msg.toString() !== `${i}`) misrouted++;\n"
+                "    if (--pending === 0) done();\n"
+                "  });\n"
+                "  socket.bind(0, '127.0.0.1', () => {\n"
+                "    if (sockets.push(socket) === 6) send();\n"
+                "  });\n"
+                "}"),
+            "0,EINVAL,0");
+}
+
+// Without the fast path, trySend() tells the caller to go through send().
+TEST_F(UDPWrapTrySendTest, WouldBlock) {
+  EXPECT_EQ(Run("const socket = dgram.createSocket('udp4');\n"
+                "socket.bind(0, '127.0.0.1', () => {\n"
+                "  globalThis.result = name(sender.trySend(\n"
+                "      [Buffer.from('x')], 1, socket.address().port,\n"
+                "      '127.0.0.1'));\n"
+                "  socket.close();\n"
+                "  sender.close();\n"
+                "});",
+                false),
+            "EAGAIN");
+}
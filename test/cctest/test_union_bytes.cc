@@ -0,0 +1,61 @@
+#include "brotli/encode.h"
+#include "gtest/gtest.h"
+#include "node_union_bytes.h"
+
+#include <string>
+#include <vector>
+
+using node::CompressedExternalOneByteResource;
+using node::CompressedExternalTwoByteResource;
+
+namespace {
+
+std::vector<uint8_t> Compress(const void* data, size_t length) {
+  size_t compressed_length = BrotliEncoderMaxCompressedSize(length);
+  std::vector<uint8_t> compressed(compressed_length);
+  EXPECT_EQ(BrotliEncoderCompress(BROTLI_DEFAULT_QUALITY,
+                                  BROTLI_DEFAULT_WINDOW,
+                                  BROTLI_MODE_TEXT,
+                                  length,
+                                  static_cast<const uint8_t*>(data),
+                                  &compressed_length,
+                                  compressed.data()),
+            BROTLI_TRUE);
+  compressed.resize(compressed_length);
+  return compressed;
+}
+
+}  // anonymous namespace
+
+TEST(UnionBytesTest, CompressedOneByteResource) {
+  std::string source = "'use strict';\nmodule.exports = 'caf\xe9';\n";
+  for (int i = 0; i < 6; i++) source += source;
+  std::vector<uint8_t> compressed = Compress(source.data(), source.size());
+  ASSERT_LT(compressed.size(), source.size());
+
+  CompressedExternalOneByteResource resource(
+      compressed.data(), compressed.size(), source.size());
+  EXPECT_FALSE(resource.IsCacheable());
+  EXPECT_EQ(resource.length(), source.size());
+  const char* data = resource.data();
+  EXPECT_EQ(std::string(data, resource.length()), source);
+  // Decompressed only once.
+  EXPECT_EQ(resource.data(), data);
+}
+
+TEST(UnionBytesTest, CompressedTwoByteResource) {
+  const std::u16string source = u"exports.x = '—✓';\n";
+  std::vector<uint8_t> utf16le;
+  for (char16_t c : source) {
+    utf16le.push_back(c & 0xff);
+    utf16le.push_back(c >> 8);
+  }
+  std::vector<uint8_t> compressed = Compress(utf16le.data(), utf16le.size());
+
+  CompressedExternalTwoByteResource resource(
+      compressed.data(), compressed.size(), source.size());
+  EXPECT_EQ(resource.length(), source.size());
+  const uint16_t* data = resource.data();
+  for (size_t i = 0; i < source.size(); i++)
+    EXPECT_EQ(data[i], source[i]) << i;
+}
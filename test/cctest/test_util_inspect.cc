@@ -0,0 +1,102 @@
+#include "node_test_fixture.h"
+#include "node_util_inspect.h"
+#include "v8.h"
+
+#include <string>
+
+using node::util::InspectPlainValue;
+using node::util::PlainInspectOptions;
+
+class InspectPlainTest : public NodeTestFixture {
+ protected:
+  // Returns the native output for the value of `source`, or "<fallback>".
+  std::string Inspect(const char* source,
+                      const PlainInspectOptions& options = {}) {
+    v8::Local<v8::Context> context = isolate_->GetCurrentContext();
+    v8::Local<v8::String> code =
+        v8::String::NewFromUtf8(isolate_, source).ToLocalChecked();
+    v8::Local<v8::Value> value = v8::Script::Compile(context, code)
+                                     .ToLocalChecked()
+                                     ->Run(context)
+                                     .ToLocalChecked();
+    std::string out;
+    if (!InspectPlainValue(context, value, options, &out).FromJust())
+      return "<fallback>";
+    return out;
+  }
+};
+
+#define SETUP_CONTEXT()                                                        \
+  v8::Isolate::Scope isolate_scope(isolate_);                                  \
+  v8::HandleScope handle_scope(isolate_);                                      \
+  v8::Local<v8::Context> context = v8::Context::New(isolate_);                 \
+  v8::Context::Scope context_scope(context)
+
+TEST_F(InspectPlainTest, Primitives) {
+  SETUP_CONTEXT();
+  EXPECT_EQ(Inspect("42"), "42");
+  EXPECT_EQ(Inspect("-0"), "-0");
+  EXPECT_EQ(Inspect("1.5e300"), "1.5e+300");
+  EXPECT_EQ(Inspect("NaN"), "NaN");
+  EXPECT_EQ(Inspect("12n"), "12n");
+  EXPECT_EQ(Inspect("null"), "null");
+  EXPECT_EQ(Inspect("undefined"), "undefined");
+  EXPECT_EQ(Inspect("'abc'"), "'abc'");
+  EXPECT_EQ(Inspect("\"it's\""), "\"it's\"");
+  EXPECT_EQ(Inspect("`it's \"quoted\"`"), "`it's \"quoted\"`");
+  EXPECT_EQ(Inspect("'a\\nb\\\\c\\x7f'"), "'a\\nb\\\\c\\x7F'");
+  EXPECT_EQ(Inspect("'\\ud83d\\ude00 \\ud83d'"), "'\xf0\x9f\x98\x80 \\ud83d'");
+  EXPECT_EQ(Inspect("Symbol('s')"), "<fallback>");
+}
+
+TEST_F(InspectPlainTest, Objects) {
+  SETUP_CONTEXT();
+  EXPECT_EQ(Inspect("({})"), "{}");
+  EXPECT_EQ(Inspect("({ a: 1, b: 'two', 'c-d': null, e: undefined, 1: 2n })"),
+            "{ '1': 2n, a: 1, b: 'two', 'c-d': null, e: undefined }");
+  EXPECT_EQ(Inspect("({ a: { b: { c: { d: 1 } } } })"),
+            "{ a: { b: { c: [Object] } } }");
+  EXPECT_EQ(Inspect("({ a: { b: { c: { d: {} } } } })", {3, 128, {}}),
+            "{\n  a: { b: { c: { d: {} } } }\n}");
+  EXPECT_EQ(Inspect("({ a: 'x'.repeat(60), b: 'y'.repeat(60) })"),
+            "{\n  a: '" + std::string(60, 'x') + "',\n  b: '" +
+                std::string(60, 'y') + "'\n}");
+}
+
+TEST_F(InspectPlainTest, Arrays) {
+  SETUP_CONTEXT();
+  EXPECT_EQ(Inspect("[]"), "[]");
+  EXPECT_EQ(Inspect("[1, 'a', [true]]"), "[ 1, 'a', [ true ] ]");
+  EXPECT_EQ(Inspect("[1, 2, 3, 4, 5, 6, 7]"), "[\n  1, 2, 3, 4,\n  5, 6, 7\n]");
+  EXPECT_EQ(Inspect("[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]"),
+            "[\n  0, 1, 2, 3, 4,\n  5, 6, 7, 8, 9\n]");
+  EXPECT_EQ(Inspect("new Uint8Array([1, 2, 3])"), "Uint8Array(3) [ 1, 2, 3 ]");
+  EXPECT_EQ(Inspect("new Float64Array(0)"), "Float64Array(0) []");
+  EXPECT_EQ(Inspect("[1, , 3]"), "<fallback>");
+  EXPECT_EQ(Inspect("Object.assign([1], { extra: true })"), "<fallback>");
+}
+
+TEST_F(InspectPlainTest, Collections) {
+  SETUP_CONTEXT();
+  EXPECT_EQ(Inspect("new Map([['a', 1], ['b', { c: 2 }]])"),
+            "Map(2) { 'a' => 1, 'b' => { c: 2 } }");
+  EXPECT_EQ(Inspect("new Set([1, 'x'])"), "Set(2) { 1, 'x' }");
+  EXPECT_EQ(Inspect("new Map()"), "Map(0) {}");
+}
+
+TEST_F(InspectPlainTest, Fallback) {
+  SETUP_CONTEXT();
+  EXPECT_EQ(Inspect("({ get a() { globalThis.called = true; } })"),
+            "<fallback>");
+  EXPECT_EQ(Inspect("globalThis.called"), "undefined");
+  EXPECT_EQ(Inspect("Object.create(null)"), "<fallback>");
+  EXPECT_EQ(Inspect("new (class Foo {})()"), "<fallback>");
+  EXPECT_EQ(Inspect("({ [Symbol('s')]: 1 })"), "<fallback>");
+  EXPECT_EQ(Inspect("Object.defineProperty({}, 'hidden', { value: 1 })"),
+            "<fallback>");
+  EXPECT_EQ(Inspect("new Proxy({}, {})"), "<fallback>");
+  EXPECT_EQ(Inspect("({ f() {} })"), "<fallback>");
+  EXPECT_EQ(Inspect("const o = {}; o.o = o; o"), "<fallback>");
+  EXPECT_EQ(Inspect("new Date(0)"), "<fallback>");
+  EXPECT_EQ(Inspect("'x'.repeat(200)"), "<fallback>");
+}
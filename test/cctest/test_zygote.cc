@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+#include "node_zygote.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef __POSIX__
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using node::zygote::Message;
+using node::zygote::ParseRequest;
+using node::zygote::SerializeRequest;
+using node::zygote::SpawnRequest;
+
+TEST(Zygote, RequestRoundTrip) {
+  SpawnRequest request;
+  request.args = {"node", "-e", ""};
+  request.env = {"FOO=bar", "EMPTY="};
+  request.cwd = "/tmp";
+
+  SpawnRequest parsed;
+  ASSERT_TRUE(ParseRequest(SerializeRequest(request), &parsed));
+  EXPECT_EQ(parsed.args, request.args);
+  EXPECT_EQ(parsed.env, request.env);
+  EXPECT_EQ(parsed.cwd, request.cwd);
+}
+
+TEST(Zygote, RejectsMalformedRequests) {
+  SpawnRequest request;
+  request.args = {"node", "script.js"};
+  request.env = {"A=1"};
+  std::string payload = SerializeRequest(request);
+
+  SpawnRequest parsed;
+  EXPECT_FALSE(ParseRequest("", &parsed));
+  for (size_t size = 0; size < payload.size(); size++) {
+    EXPECT_FALSE(ParseRequest(payload.substr(0, size), &parsed)) << size;
+  }
+  EXPECT_FALSE(ParseRequest(payload + "x", &parsed));
+
+  // No arguments at all, and counts that do not fit the payload.
+  request.args.clear();
+  EXPECT_FALSE(ParseRequest(SerializeRequest(request), &parsed));
+  payload[0] = '\xff';
+  EXPECT_FALSE(ParseRequest(payload, &parsed));
+}
+
+#ifdef __POSIX__
+TEST(Zygote, ForksChildren) {
+  int sockets[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+  int output[2];
+  ASSERT_EQ(pipe(output), 0);
+
+  pid_t zygote = fork();
+  ASSERT_NE(zygote, -1);
+  if (zygote == 0) {
+    close(sockets[0]);
+    close(output[0]);
+    setenv("NODE_ZYGOTE_FD", std::to_string(sockets[1]).c_str(), 1);
+    int argc = 1;
+    char arg0[] = "node";
+    char* args[] = {arg0, nullptr};
+    char** argv = args;
+    node::zygote::MaybeRunServer(&argc, &argv);
+    // In a child of the zygote.
+    char cwd[256];
+    // The arguments are contiguous, which uv_setup_args() relies on.
+    bool packed = argv[1] == argv[0] + strlen(argv[0]) + 1;
+    std::string line = std::to_string(argc) + " " + argv[1] + " " +
+                       getenv("FOO") + " " + getcwd(cwd, sizeof(cwd)) +
+                       (packed ? " packed" : "") +
+                       (getenv("NODE_ZYGOTE_FD") == nullptr ? " unset" : "");
+    if (write(1, line.data(), line.size()) < 0) _exit(1);
+    _exit(42);
+  }
+  close(sockets[1]);
+
+  SpawnRequest request;
+  request.args = {"node", "script.js"};
+  request.env = {"FOO=bar"};
+  request.cwd = "/";
+  std::string payload = SerializeRequest(request);
+  uint32_t size = payload.size();
+
+  int stdio[3] = {open("/dev/null", O_RDONLY), output[1], output[1]};
+  alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(stdio))];
+  struct iovec iov = {&size, sizeof(size)};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(stdio));
+  memcpy(CMSG_DATA(cmsg), stdio, sizeof(stdio));
+  ASSERT_EQ(sendmsg(sockets[0], &msg, 0), static_cast<ssize_t>(sizeof(size)));
+  ASSERT_EQ(write(sockets[0], payload.data(), payload.size()),
+            static_cast<ssize_t>(payload.size()));
+  close(stdio[0]);
+  close(output[1]);
+
+  Message spawned;
+  ASSERT_EQ(read(sockets[0], &spawned, sizeof(spawned)),
+            static_cast<ssize_t>(sizeof(spawned)));
+  EXPECT_EQ(spawned.type, Message::kSpawned);
+  EXPECT_GT(spawned.pid, 0);
+  EXPECT_EQ(spawned.value, 0);
+
+  Message exited;
+  ASSERT_EQ(read(sockets[0], &exited, sizeof(exited)),
+            static_cast<ssize_t>(sizeof(exited)));
+  EXPECT_EQ(exited.type, Message::kExited);
+  EXPECT_EQ(exited.pid, spawned.pid);
+  ASSERT_TRUE(WIFEXITED(exited.value));
+  EXPECT_EQ(WEXITSTATUS(exited.value), 42);
+
+  char line[256];
+  ssize_t n = read(output[0], line, sizeof(line));
+  ASSERT_GT(n, 0);
+  EXPECT_EQ(std::string(line, n), "2 script.js bar / packed unset");
+  close(output[0]);
+
+  // A request without stdio is refused.
+  ASSERT_EQ(write(sockets[0], &size, sizeof(size)),
+            static_cast<ssize_t>(sizeof(size)));
+  ASSERT_EQ(write(sockets[0], payload.data(), payload.size()),
+            static_cast<ssize_t>(payload.size()));
+  Message refused;
+  ASSERT_EQ(read(sockets[0], &refused, sizeof(refused)),
+            static_cast<ssize_t>(sizeof(refused)));
+  EXPECT_EQ(refused.type, Message::kSpawned);
+  EXPECT_EQ(refused.pid, -1);
+  EXPECT_EQ(refused.value, EINVAL);
+
+  // The zygote exits once the socket is closed.
+  close(sockets[0]);
+  int status;
+  ASSERT_EQ(waitpid(zygote, &status, 0), zygote);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+#endif  // __POSIX__
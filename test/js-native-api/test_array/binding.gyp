@@ -4,7 +4,10 @@
       "target_name": "test_array",
       "sources": [
         "test_array.c"
-      ]
+      ],
+      "defines": [
+        "NAPI_EXPERIMENTAL",
+      ],
     }
   ]
 }
@@ -58,3 +58,17 @@ assert(test_array.NewWithLength(4294967295) instanceof Array);
   assert.strictEqual(arr.length, 4);
   assert.strictEqual(2 in arr, false);
 }
+
+{
+  // Verify that elements can be read and written in bulk.
+  assert.deepStrictEqual(test_array.NewBulk(array), array);
+  assert.deepStrictEqual(test_array.NewBulk([]), []);
+  assert.deepStrictEqual(test_array.NewBulk(new Array(2)),
+                         [undefined, undefined]);
+
+  const arr = ['a', 'b'];
+  test_array.TestSetElements(arr, 1, 'c', 'd');
+  assert.deepStrictEqual(arr, ['a', 'c', 'd']);
+  test_array.TestSetElements(arr, 0);
+  assert.deepStrictEqual(arr, ['a', 'c', 'd']);
+}
@@ -170,6 +170,43 @@ static napi_value NewWithLength(napi_env env, napi_callback_info info) {
   return ret;
 }
 
+static napi_value NewBulk(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  NODE_API_ASSERT(env, argc >= 1, "Wrong number of arguments");
+
+  uint32_t length;
+  NODE_API_CALL(env, napi_get_array_length(env, args[0], &length));
+  NODE_API_ASSERT(env, length <= 16, "Expects at most 16 elements");
+
+  napi_value elements[16];
+  NODE_API_CALL(env, node_api_get_elements(env, args[0], 0, length, elements));
+
+  napi_value ret;
+  NODE_API_CALL(env,
+      node_api_create_array_with_elements(env, elements, length, &ret));
+
+  return ret;
+}
+
+static napi_value TestSetElements(napi_env env, napi_callback_info info) {
+  size_t argc = 4;
+  napi_value args[4];
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  NODE_API_ASSERT(env, argc >= 2, "Wrong number of arguments");
+
+  uint32_t start;
+  NODE_API_CALL(env, napi_get_value_uint32(env, args[1], &start));
+
+  NODE_API_CALL(env,
+      node_api_set_elements(env, args[0], start, argc - 2, args + 2));
+
+  return NULL;
+}
+
 EXTERN_C_START
 napi_value Init(napi_env env, napi_value exports) {
   napi_property_descriptor descriptors[] = {
@@ -178,6 +215,8 @@ napi_value Init(napi_env env, napi_value exports) {
     DECLARE_NODE_API_PROPERTY("TestDeleteElement", TestDeleteElement),
     DECLARE_NODE_API_PROPERTY("New", New),
     DECLARE_NODE_API_PROPERTY("NewWithLength", NewWithLength),
+    DECLARE_NODE_API_PROPERTY("NewBulk", NewBulk),
+    DECLARE_NODE_API_PROPERTY("TestSetElements", TestSetElements),
   };
 
   NODE_API_CALL(env, napi_define_properties(
@@ -0,0 +1,13 @@
+{
+  "targets": [
+    {
+      "target_name": "test_fast_function",
+      "sources": [
+        "test_fast_function.c"
+      ],
+      "defines": [
+        "NAPI_EXPERIMENTAL",
+      ],
+    }
+  ]
+}
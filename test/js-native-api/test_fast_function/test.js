@@ -0,0 +1,37 @@
+'use strict';
+// Flags: --allow-natives-syntax
+
+const common = require('../../common');
+const assert = require('assert');
+
+const binding = require(`./build/${common.buildType}/test_fast_function`);
+
+assert.strictEqual(binding.add.name, 'add');
+assert.strictEqual(binding.testInvalidSignature(), true);
+
+function add(a, b) {
+  return binding.add(a, b);
+}
+
+function sum(array) {
+  return binding.sum(array);
+}
+
+// The results are the same before and after the calls are optimized to go
+// to the fast callbacks.
+const bytes = new Uint8Array([1, 2, 3, 250]);
+for (let i = 0; i < 2; i++) {
+  %PrepareFunctionForOptimization(add);
+  %PrepareFunctionForOptimization(sum);
+  assert.strictEqual(add(1, 2), 103);
+  assert.strictEqual(add(-1, 0), 99);
+  assert.strictEqual(sum(bytes), 256);
+  assert.throws(() => sum(new Uint8Array()),
+                { message: /Expected a non-empty array/ });
+  %OptimizeFunctionOnNextCall(add);
+  %OptimizeFunctionOnNextCall(sum);
+}
+
+// Arguments of other types go to the slow callback.
+assert.strictEqual(add(1.5, 2), 103);
+assert.throws(() => sum([1, 2]), { message: /Invalid argument/ });
@@ -0,0 +1,116 @@
+#include <js_native_api.h>
+#include "../common.h"
+#include "../entry_point.h"
+
+static int32_t offset = 100;
+
+static int32_t AddFast(void* receiver,
+                       int32_t a,
+                       int32_t b,
+                       node_api_fast_options options) {
+  return a + b + *(int32_t*)node_api_get_fast_callback_data(options);
+}
+
+static napi_value Add(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  void* data;
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, &data));
+  NODE_API_ASSERT(env, argc == 2, "Wrong number of arguments");
+
+  int32_t a, b;
+  NODE_API_CALL(env, napi_get_value_int32(env, args[0], &a));
+  NODE_API_CALL(env, napi_get_value_int32(env, args[1], &b));
+
+  napi_value result;
+  NODE_API_CALL(env,
+      napi_create_int32(env, a + b + *(int32_t*)data, &result));
+  return result;
+}
+
+// Empty arrays are left to the slow callback, which throws.
+static uint32_t SumFast(void* receiver,
+                        const node_api_fast_typed_array* array,
+                        node_api_fast_options options) {
+  void* data;
+  size_t length;
+  node_api_get_fast_typed_array_info(array, &data, &length);
+  if (length == 0) {
+    node_api_request_fast_fallback(options);
+    return 0;
+  }
+  uint32_t sum = 0;
+  for (size_t i = 0; i < length; i++) sum += ((uint8_t*)data)[i];
+  return sum;
+}
+
+static napi_value Sum(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value array;
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, &array, NULL, NULL));
+  NODE_API_ASSERT(env, argc == 1, "Wrong number of arguments");
+
+  napi_typedarray_type type;
+  size_t length;
+  void* data;
+  NODE_API_CALL(env,
+      napi_get_typedarray_info(
+          env, array, &type, &length, &data, NULL, NULL));
+  NODE_API_ASSERT(env, type == napi_uint8_array, "Expected a Uint8Array");
+  NODE_API_ASSERT(env, length > 0, "Expected a non-empty array");
+
+  uint32_t sum = 0;
+  for (size_t i = 0; i < length; i++) sum += ((uint8_t*)data)[i];
+  napi_value result;
+  NODE_API_CALL(env, napi_create_uint32(env, sum, &result));
+  return result;
+}
+
+static napi_value TestInvalidSignature(napi_env env,
+                                       napi_callback_info info) {
+  node_api_fast_type arg_types[] = { node_api_fast_void };
+  node_api_fast_signature signature = { node_api_fast_int32, 1, arg_types };
+  napi_value fn;
+  napi_status status = node_api_create_fast_function(
+      env, "invalid", NAPI_AUTO_LENGTH, Add, &signature, AddFast, NULL, &fn);
+
+  napi_value result;
+  NODE_API_CALL(env,
+      napi_get_boolean(env, status == napi_invalid_arg, &result));
+  return result;
+}
+
+EXTERN_C_START
+napi_value Init(napi_env env, napi_value exports) {
+  node_api_fast_type add_types[] = { node_api_fast_int32,
+                                     node_api_fast_int32 };
+  node_api_fast_signature add_signature = {
+    node_api_fast_int32, 2, add_types
+  };
+  napi_value add;
+  NODE_API_CALL(env,
+      node_api_create_fast_function(
+          env, "add", NAPI_AUTO_LENGTH, Add, &add_signature, AddFast,
+          &offset, &add));
+
+  node_api_fast_type sum_types[] = { node_api_fast_uint8_array };
+  node_api_fast_signature sum_signature = {
+    node_api_fast_uint32, 1, sum_types
+  };
+  napi_value sum;
+  NODE_API_CALL(env,
+      node_api_create_fast_function(
+          env, "sum", NAPI_AUTO_LENGTH, Sum, &sum_signature, SumFast,
+          NULL, &sum));
+
+  napi_property_descriptor descriptors[] = {
+    DECLARE_NODE_API_PROPERTY_VALUE("add", add),
+    DECLARE_NODE_API_PROPERTY_VALUE("sum", sum),
+    DECLARE_NODE_API_PROPERTY("testInvalidSignature", TestInvalidSignature),
+  };
+  NODE_API_CALL(env, napi_define_properties(
+      env, exports, sizeof(descriptors) / sizeof(*descriptors), descriptors));
+
+  return exports;
+}
+EXTERN_C_END
@@ -5,7 +5,10 @@
       "sources": [
         "test_null.c",
         "test_object.c"
-      ]
+      ],
+      "defines": [
+        "NAPI_EXPERIMENTAL",
+      ],
     },
     {
       "target_name": "test_exceptions",
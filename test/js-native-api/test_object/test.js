@@ -33,6 +33,22 @@ assert(test_object.Has(newObject, 'test_number'));
 assert.strictEqual(newObject.test_number, 987654321);
 assert.strictEqual(newObject.test_string, 'test string');
 
+{
+  // Verify that objects can be created with their properties in one go.
+  const proto = { inherited: true };
+  const object = test_object.NewWithProperties(proto);
+  assert.strictEqual(Object.getPrototypeOf(object), proto);
+  assert.deepStrictEqual(Object.keys(object), ['test_number', 'test_string']);
+  assert.strictEqual(object.test_number, 987654321);
+  assert.strictEqual(object.test_string, 'test string');
+  assert.strictEqual(object.inherited, true);
+
+  const nullProto = test_object.NewWithProperties(null);
+  assert.strictEqual(Object.getPrototypeOf(nullProto), null);
+  assert.throws(() => test_object.NewWithProperties(1),
+                { message: 'Invalid argument' });
+}
+
 {
   // Verify that napi_get_property() walks the prototype chain.
   function MyObject() {
@@ -418,6 +418,35 @@ static napi_value New(napi_env env, napi_callback_info info) {
   return ret;
 }
 
+static napi_value NewWithProperties(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value prototype;
+  NODE_API_CALL(env,
+      napi_get_cb_info(env, info, &argc, &prototype, NULL, NULL));
+
+  NODE_API_ASSERT(env, argc >= 1, "Wrong number of arguments");
+
+  napi_value names[2];
+  napi_value values[2];
+  NODE_API_CALL(env,
+      node_api_create_property_key_latin1(
+          env, "test_number", NAPI_AUTO_LENGTH, &names[0]));
+  NODE_API_CALL(env, napi_create_int32(env, 987654321, &values[0]));
+  NODE_API_CALL(env,
+      node_api_create_property_key_utf8(
+          env, "test_string", NAPI_AUTO_LENGTH, &names[1]));
+  NODE_API_CALL(env,
+      napi_create_string_utf8(
+          env, "test string", NAPI_AUTO_LENGTH, &values[1]));
+
+  napi_value ret;
+  NODE_API_CALL(env,
+      node_api_create_object_with_properties(
+          env, prototype, names, values, 2, &ret));
+
+  return ret;
+}
+
 static napi_value Inflate(napi_env env, napi_callback_info info) {
   size_t argc = 1;
   napi_value args[1];
@@ -731,6 +760,7 @@ napi_value Init(napi_env env, napi_value exports) {
       DECLARE_NODE_API_PROPERTY("HasOwn", HasOwn),
       DECLARE_NODE_API_PROPERTY("Delete", Delete),
       DECLARE_NODE_API_PROPERTY("New", New),
+      DECLARE_NODE_API_PROPERTY("NewWithProperties", NewWithProperties),
       DECLARE_NODE_API_PROPERTY("Inflate", Inflate),
       DECLARE_NODE_API_PROPERTY("Wrap", Wrap),
       DECLARE_NODE_API_PROPERTY("Unwrap", Unwrap),
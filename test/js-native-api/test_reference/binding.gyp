@@ -11,6 +11,15 @@
       "sources": [
         "test_finalizer.c"
       ]
+    },
+    {
+      "target_name": "test_strong_reference",
+      "sources": [
+        "test_strong_reference.c"
+      ],
+      "defines": [
+        "NAPI_EXPERIMENTAL",
+      ],
     }
   ]
 }
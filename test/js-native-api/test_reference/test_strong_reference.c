@@ -0,0 +1,72 @@
+#include <js_native_api.h>
+#include "../common.h"
+#include "../entry_point.h"
+
+static node_api_strong_ref test_reference = NULL;
+
+static napi_value CreateReference(napi_env env, napi_callback_info info) {
+  NODE_API_ASSERT(env, test_reference == NULL,
+      "The test allows only one reference at a time.");
+
+  size_t argc = 1;
+  napi_value value;
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, &value, NULL, NULL));
+  NODE_API_ASSERT(env, argc == 1, "Expects one argument.");
+
+  NODE_API_CALL(env,
+      node_api_create_strong_reference(env, value, &test_reference));
+  return NULL;
+}
+
+static napi_value DeleteReference(napi_env env, napi_callback_info info) {
+  NODE_API_ASSERT(env, test_reference != NULL,
+      "A reference must have been created.");
+
+  NODE_API_CALL(env, node_api_delete_strong_reference(env, test_reference));
+  test_reference = NULL;
+  return NULL;
+}
+
+static napi_value GetReferenceValue(napi_env env, napi_callback_info info) {
+  NODE_API_ASSERT(env, test_reference != NULL,
+      "A reference must have been created.");
+
+  napi_value result;
+  NODE_API_CALL(env,
+      node_api_get_strong_reference_value(env, test_reference, &result));
+  return result;
+}
+
+// Creates and deletes many references, so that their memory is recycled.
+static napi_value Churn(napi_env env, napi_callback_info info) {
+  napi_value value;
+  NODE_API_CALL(env, napi_create_object(env, &value));
+
+  node_api_strong_ref refs[100];
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 100; i++) {
+      NODE_API_CALL(env,
+          node_api_create_strong_reference(env, value, &refs[i]));
+    }
+    for (int i = 0; i < 100; i++) {
+      NODE_API_CALL(env, node_api_delete_strong_reference(env, refs[i]));
+    }
+  }
+  return NULL;
+}
+
+EXTERN_C_START
+napi_value Init(napi_env env, napi_value exports) {
+  napi_property_descriptor descriptors[] = {
+      DECLARE_NODE_API_PROPERTY("createReference", CreateReference),
+      DECLARE_NODE_API_PROPERTY("deleteReference", DeleteReference),
+      DECLARE_NODE_API_GETTER("referenceValue", GetReferenceValue),
+      DECLARE_NODE_API_PROPERTY("churn", Churn),
+  };
+
+  NODE_API_CALL(env, napi_define_properties(
+      env, exports, sizeof(descriptors) / sizeof(*descriptors), descriptors));
+
+  return exports;
+}
+EXTERN_C_END
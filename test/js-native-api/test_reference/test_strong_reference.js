@@ -0,0 +1,33 @@
+'use strict';
+// Flags: --expose-gc
+
+const common = require('../../common');
+const binding =
+  require(`./build/${common.buildType}/test_strong_reference`);
+const assert = require('assert');
+
+async function runTests() {
+  // Strong references keep objects alive.
+  (() => {
+    binding.createReference({ answer: 42 });
+  })();
+  global.gc();
+  await new Promise((resolve) => setImmediate(resolve));
+  global.gc();
+  assert.deepStrictEqual(binding.referenceValue, { answer: 42 });
+  binding.deleteReference();
+
+  // Any value can be referenced.
+  for (const value of [1, 'string', Symbol('symbol'), null, undefined]) {
+    binding.createReference(value);
+    assert.strictEqual(binding.referenceValue, value);
+    binding.deleteReference();
+  }
+
+  binding.churn();
+
+  // A reference that is not deleted is cleaned up with the env.
+  binding.createReference({});
+}
+
+runTests().then(common.mustCall());
@@ -7,7 +7,9 @@ const test_string = require(`./build/${common.buildType}/test_string`);
 
 const empty = '';
 assert.strictEqual(test_string.TestLatin1(empty), empty);
+assert.strictEqual(test_string.TestPropertyKeyLatin1(empty), empty);
 assert.strictEqual(test_string.TestUtf8(empty), empty);
+assert.strictEqual(test_string.TestPropertyKeyUtf8(empty), empty);
 assert.strictEqual(test_string.TestUtf16(empty), empty);
 assert.strictEqual(test_string.TestLatin1AutoLength(empty), empty);
 assert.strictEqual(test_string.TestUtf8AutoLength(empty), empty);
@@ -23,7 +25,9 @@ assert.strictEqual(test_string.Utf8Length(empty), 0);
 
 const str1 = 'hello world';
 assert.strictEqual(test_string.TestLatin1(str1), str1);
+assert.strictEqual(test_string.TestPropertyKeyLatin1(str1), str1);
 assert.strictEqual(test_string.TestUtf8(str1), str1);
+assert.strictEqual(test_string.TestPropertyKeyUtf8(str1), str1);
 assert.strictEqual(test_string.TestUtf16(str1), str1);
 assert.strictEqual(test_string.TestLatin1AutoLength(str1), str1);
 assert.strictEqual(test_string.TestUtf8AutoLength(str1), str1);
@@ -42,7 +46,9 @@ assert.strictEqual(test_string.Utf8Length(str1), 11);
 
 const str2 = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789';
 assert.strictEqual(test_string.TestLatin1(str2), str2);
+assert.strictEqual(test_string.TestPropertyKeyLatin1(str2), str2);
 assert.strictEqual(test_string.TestUtf8(str2), str2);
+assert.strictEqual(test_string.TestPropertyKeyUtf8(str2), str2);
 assert.strictEqual(test_string.TestUtf16(str2), str2);
 assert.strictEqual(test_string.TestLatin1AutoLength(str2), str2);
 assert.strictEqual(test_string.TestUtf8AutoLength(str2), str2);
@@ -61,7 +67,9 @@ assert.strictEqual(test_string.Utf8Length(str2), 62);
 
 const str3 = '?!@#$%^&*()_+-=[]{}/.,<>\'"\\';
 assert.strictEqual(test_string.TestLatin1(str3), str3);
+assert.strictEqual(test_string.TestPropertyKeyLatin1(str3), str3);
 assert.strictEqual(test_string.TestUtf8(str3), str3);
+assert.strictEqual(test_string.TestPropertyKeyUtf8(str3), str3);
 assert.strictEqual(test_string.TestUtf16(str3), str3);
 assert.strictEqual(test_string.TestLatin1AutoLength(str3), str3);
 assert.strictEqual(test_string.TestUtf8AutoLength(str3), str3);
@@ -80,7 +88,9 @@ assert.strictEqual(test_string.Utf8Length(str3), 27);
 
 const str4 = '¡¢£¤¥¦§¨©ª«¬­®¯°±²³´µ¶·¸¹º»¼½¾¿';
 assert.strictEqual(test_string.TestLatin1(str4), str4);
+assert.strictEqual(test_string.TestPropertyKeyLatin1(str4), str4);
 assert.strictEqual(test_string.TestUtf8(str4), str4);
+assert.strictEqual(test_string.TestPropertyKeyUtf8(str4), str4);
 assert.strictEqual(test_string.TestUtf16(str4), str4);
 assert.strictEqual(test_string.TestLatin1AutoLength(str4), str4);
 assert.strictEqual(test_string.TestUtf8AutoLength(str4), str4);
@@ -97,9 +107,15 @@ assert.strictEqual(test_string.TestPropertyKeyUtf16AutoLength(str4), str4);
 assert.strictEqual(test_string.Utf16Length(str4), 31);
 assert.strictEqual(test_string.Utf8Length(str4), 62);
 
+// ASCII strings are external, others are copied.
+assert.deepStrictEqual(test_string.TestUtf8External(str3), [str3, false]);
+assert.deepStrictEqual(test_string.TestUtf8External(str4), [str4, true]);
+
 const str5 = 'ÀÁÂÃÄÅÆÇÈÉÊËÌÍÎÏÐÑÒÓÔÕÖ×ØÙÚÛÜÝÞßàáâãäåæçèéêëìíîïðñòóôõö÷øùúûüýþ';
 assert.strictEqual(test_string.TestLatin1(str5), str5);
+assert.strictEqual(test_string.TestPropertyKeyLatin1(str5), str5);
 assert.strictEqual(test_string.TestUtf8(str5), str5);
+assert.strictEqual(test_string.TestPropertyKeyUtf8(str5), str5);
 assert.strictEqual(test_string.TestUtf16(str5), str5);
 assert.strictEqual(test_string.TestLatin1AutoLength(str5), str5);
 assert.strictEqual(test_string.TestUtf8AutoLength(str5), str5);
@@ -118,6 +134,7 @@ assert.strictEqual(test_string.Utf8Length(str5), 126);
 
 const str6 = '\u{2003}\u{2101}\u{2001}\u{202}\u{2011}';
 assert.strictEqual(test_string.TestUtf8(str6), str6);
+assert.strictEqual(test_string.TestPropertyKeyUtf8(str6), str6);
 assert.strictEqual(test_string.TestUtf16(str6), str6);
 assert.strictEqual(test_string.TestUtf8AutoLength(str6), str6);
 assert.strictEqual(test_string.TestUtf16AutoLength(str6), str6);
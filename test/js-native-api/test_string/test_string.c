@@ -212,6 +212,32 @@ static napi_value TestLatin1External(napi_env env, napi_callback_info info) {
                          actual_length);
 }
 
+// Returns the external string and whether it was copied.
+static napi_value TestUtf8External(napi_env env, napi_callback_info info) {
+  napi_value args[1];
+  NODE_API_CALL(env, validate_and_retrieve_single_string_arg(env, info, args));
+
+  size_t length;
+  NODE_API_CALL(env,
+      napi_get_value_string_utf8(env, args[0], NULL, 0, &length));
+  char* string = malloc(length + 1);
+  NODE_API_CALL(env,
+      napi_get_value_string_utf8(env, args[0], string, length + 1, NULL));
+
+  napi_value values[2];
+  bool copied;
+  NODE_API_CALL(env,
+      node_api_create_external_string_utf8(
+          env, string, length, free_string, NULL, &values[0], &copied));
+  NODE_API_CALL(env, napi_get_boolean(env, copied, &values[1]));
+
+  napi_value output;
+  NODE_API_CALL(env, napi_create_array_with_length(env, 2, &output));
+  NODE_API_CALL(env, napi_set_element(env, output, 0, values[0]));
+  NODE_API_CALL(env, napi_set_element(env, output, 1, values[1]));
+  return output;
+}
+
 static napi_value TestUtf16External(napi_env env, napi_callback_info info) {
   return TestTwoByteImpl(env,
                          info,
@@ -301,6 +327,23 @@ static napi_value TestPropertyKeyUtf16(napi_env env, napi_callback_info info) {
                          actual_length);
 }
 
+static napi_value TestPropertyKeyLatin1(napi_env env,
+                                        napi_callback_info info) {
+  return TestOneByteImpl(env,
+                         info,
+                         napi_get_value_string_latin1,
+                         node_api_create_property_key_latin1,
+                         actual_length);
+}
+
+static napi_value TestPropertyKeyUtf8(napi_env env, napi_callback_info info) {
+  return TestOneByteImpl(env,
+                         info,
+                         napi_get_value_string_utf8,
+                         node_api_create_property_key_utf8,
+                         actual_length);
+}
+
 static napi_value TestPropertyKeyUtf16AutoLength(napi_env env,
                                                  napi_callback_info info) {
   return TestTwoByteImpl(env,
@@ -409,6 +452,7 @@ napi_value Init(napi_env env, napi_value exports) {
       DECLARE_NODE_API_PROPERTY("TestLatin1External", TestLatin1External),
       DECLARE_NODE_API_PROPERTY("TestLatin1ExternalAutoLength",
                                 TestLatin1ExternalAutoLength),
+      DECLARE_NODE_API_PROPERTY("TestUtf8External", TestUtf8External),
       DECLARE_NODE_API_PROPERTY("TestLatin1Insufficient",
                                 TestLatin1Insufficient),
       DECLARE_NODE_API_PROPERTY("TestUtf8", TestUtf8),
@@ -426,6 +470,8 @@ napi_value Init(napi_env env, napi_value exports) {
       DECLARE_NODE_API_PROPERTY("TestLargeLatin1", TestLargeLatin1),
       DECLARE_NODE_API_PROPERTY("TestLargeUtf16", TestLargeUtf16),
       DECLARE_NODE_API_PROPERTY("TestMemoryCorruption", TestMemoryCorruption),
+      DECLARE_NODE_API_PROPERTY("TestPropertyKeyLatin1", TestPropertyKeyLatin1),
+      DECLARE_NODE_API_PROPERTY("TestPropertyKeyUtf8", TestPropertyKeyUtf8),
       DECLARE_NODE_API_PROPERTY("TestPropertyKeyUtf16", TestPropertyKeyUtf16),
       DECLARE_NODE_API_PROPERTY("TestPropertyKeyUtf16AutoLength",
                                 TestPropertyKeyUtf16AutoLength),
@@ -3,6 +3,11 @@
     {
       "target_name": "test_async",
       "sources": [ "test_async.c" ]
+    },
+    {
+      "target_name": "test_async_pool",
+      "defines": [ "NAPI_EXPERIMENTAL" ],
+      "sources": [ "test_async_pool.c" ]
     }
   ]
 }
@@ -0,0 +1,32 @@
+'use strict';
+const common = require('../../common');
+const assert = require('assert');
+const test_async_pool =
+  require(`./build/${common.buildType}/test_async_pool`);
+
+// A pool that exists already can only be had with the same size.
+assert.deepStrictEqual(test_async_pool.GetInfo('test', 2), {
+  size: 2,
+  running: 0,
+  waiting: 0,
+  maxWaiting: 0,
+  completed: 0,
+});
+assert.throws(() => test_async_pool.GetInfo('test', 3),
+              { message: 'Invalid argument' });
+assert.throws(() => test_async_pool.GetInfo('empty', 0),
+              { message: 'Invalid argument' });
+
+test_async_pool.Run('test', 2, common.mustCall((maxRunning) => {
+  assert(maxRunning <= 2, `${maxRunning} works ran at the same time`);
+  assert.deepStrictEqual(test_async_pool.GetInfo('test', 2), {
+    size: 2,
+    running: 0,
+    waiting: 0,
+    maxWaiting: test_async_pool.WORK_COUNT - 2,
+    completed: test_async_pool.WORK_COUNT,
+  });
+}));
+const info = test_async_pool.GetInfo('test', 2);
+assert.strictEqual(info.running, 2);
+assert.strictEqual(info.waiting, test_async_pool.WORK_COUNT - 2);
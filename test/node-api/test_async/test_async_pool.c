@@ -0,0 +1,134 @@
+#include <node_api.h>
+#include <uv.h>
+#include "../../js-native-api/common.h"
+
+#define WORK_COUNT 6
+
+static napi_async_work works[WORK_COUNT];
+static napi_ref done_ref;
+static uv_mutex_t mutex;
+static int running;
+static int max_running;
+static int completed;
+
+static node_api_async_work_pool GetPool(napi_env env,
+                                        napi_value js_name,
+                                        napi_value js_size) {
+  char name[64];
+  uint32_t size;
+  node_api_async_work_pool pool;
+  NODE_API_CALL(env,
+                napi_get_value_string_utf8(
+                    env, js_name, name, sizeof(name), NULL));
+  NODE_API_CALL(env, napi_get_value_uint32(env, js_size, &size));
+  NODE_API_CALL(env, node_api_create_async_work_pool(env, name, size, &pool));
+  return pool;
+}
+
+static void Execute(napi_env env, void* data) {
+  uv_mutex_lock(&mutex);
+  running++;
+  if (running > max_running) max_running = running;
+  uv_mutex_unlock(&mutex);
+
+  uv_sleep(50);
+
+  uv_mutex_lock(&mutex);
+  running--;
+  uv_mutex_unlock(&mutex);
+}
+
+static void Complete(napi_env env, napi_status status, void* data) {
+  napi_value done, argv[1], undefined;
+  NODE_API_ASSERT_RETURN_VOID(env, status == napi_ok, "Work failed");
+  NODE_API_CALL_RETURN_VOID(
+      env, napi_delete_async_work(env, *(napi_async_work*)data));
+  if (++completed < WORK_COUNT) return;
+
+  NODE_API_CALL_RETURN_VOID(env,
+                            napi_get_reference_value(env, done_ref, &done));
+  NODE_API_CALL_RETURN_VOID(env, napi_delete_reference(env, done_ref));
+  NODE_API_CALL_RETURN_VOID(env, napi_create_int32(env, max_running, &argv[0]));
+  NODE_API_CALL_RETURN_VOID(env, napi_get_undefined(env, &undefined));
+  NODE_API_CALL_RETURN_VOID(
+      env, napi_call_function(env, undefined, done, 1, argv, NULL));
+}
+
+// Run(name, size, done) queues WORK_COUNT works into the pool and calls
+// done() with the most of them that ran at the same time.
+static napi_value Run(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value argv[3], resource_name;
+  node_api_async_work_pool pool;
+  int index;
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  pool = GetPool(env, argv[0], argv[1]);
+  if (pool == NULL) return NULL;
+
+  NODE_API_CALL(env, napi_create_reference(env, argv[2], 1, &done_ref));
+  NODE_API_CALL(env,
+                napi_create_string_utf8(
+                    env, "test_async_pool", NAPI_AUTO_LENGTH, &resource_name));
+  running = max_running = completed = 0;
+  for (index = 0; index < WORK_COUNT; index++) {
+    NODE_API_CALL(env,
+                  napi_create_async_work(env,
+                                         NULL,
+                                         resource_name,
+                                         Execute,
+                                         Complete,
+                                         &works[index],
+                                         &works[index]));
+    NODE_API_CALL(
+        env, node_api_queue_async_work_in_pool(env, works[index], pool));
+  }
+  return NULL;
+}
+
+// GetInfo(name, size) returns the metrics of the pool.
+static napi_value GetInfo(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2], result, value;
+  node_api_async_work_pool pool;
+  node_api_async_work_pool_info pool_info;
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  pool = GetPool(env, argv[0], argv[1]);
+  if (pool == NULL) return NULL;
+  NODE_API_CALL(env, node_api_get_async_work_pool_info(env, pool, &pool_info));
+
+  NODE_API_CALL(env, napi_create_object(env, &result));
+  NODE_API_CALL(env, napi_create_uint32(env, pool_info.size, &value));
+  NODE_API_CALL(env, napi_set_named_property(env, result, "size", value));
+  NODE_API_CALL(env, napi_create_uint32(env, pool_info.running, &value));
+  NODE_API_CALL(env, napi_set_named_property(env, result, "running", value));
+  NODE_API_CALL(env, napi_create_uint32(env, pool_info.waiting, &value));
+  NODE_API_CALL(env, napi_set_named_property(env, result, "waiting", value));
+  NODE_API_CALL(env, napi_create_uint32(env, pool_info.max_waiting, &value));
+  NODE_API_CALL(env,
+                napi_set_named_property(env, result, "maxWaiting", value));
+  NODE_API_CALL(env, napi_create_uint32(env, pool_info.completed, &value));
+  NODE_API_CALL(env, napi_set_named_property(env, result, "completed", value));
+  return result;
+}
+
+static napi_value Init(napi_env env, napi_value exports) {
+  napi_value work_count;
+  NODE_API_ASSERT(env, uv_mutex_init(&mutex) == 0, "Mutex creation");
+  NODE_API_CALL(env, napi_create_int32(env, WORK_COUNT, &work_count));
+
+  napi_property_descriptor properties[] = {
+      DECLARE_NODE_API_PROPERTY_VALUE("WORK_COUNT", work_count),
+      DECLARE_NODE_API_PROPERTY("Run", Run),
+      DECLARE_NODE_API_PROPERTY("GetInfo", GetInfo),
+  };
+
+  NODE_API_CALL(
+      env,
+      napi_define_properties(env,
+                             exports,
+                             sizeof(properties) / sizeof(properties[0]),
+                             properties));
+
+  return exports;
+}
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,166 @@
+#include <node_api.h>
+#include <uv.h>
+#include "../../js-native-api/common.h"
+
+#define THREAD_COUNT 4
+#define ITEMS_PER_THREAD 5000
+
+static uv_thread_t threads[THREAD_COUNT];
+static int items[THREAD_COUNT * ITEMS_PER_THREAD];
+
+typedef struct {
+  napi_threadsafe_function tsfn;
+  int first;
+} producer_data;
+
+static producer_data producers[THREAD_COUNT];
+
+static void Produce(void* arg) {
+  producer_data* producer = (producer_data*)arg;
+  int index;
+  for (index = 0; index < ITEMS_PER_THREAD; index++) {
+    if (napi_call_threadsafe_function(producer->tsfn,
+                                      &items[producer->first + index],
+                                      napi_tsfn_blocking) != napi_ok) {
+      napi_fatal_error("Produce",
+                       NAPI_AUTO_LENGTH,
+                       "napi_call_threadsafe_function failed",
+                       NAPI_AUTO_LENGTH);
+    }
+  }
+  if (napi_release_threadsafe_function(producer->tsfn, napi_tsfn_release) !=
+      napi_ok) {
+    napi_fatal_error("Produce",
+                     NAPI_AUTO_LENGTH,
+                     "napi_release_threadsafe_function failed",
+                     NAPI_AUTO_LENGTH);
+  }
+}
+
+static void CallJsBatch(
+    napi_env env, napi_value cb, void* context, void** data, size_t count) {
+  napi_value batch, undefined;
+  size_t index;
+  if (env == NULL || cb == NULL) return;
+
+  NODE_API_CALL_RETURN_VOID(env, napi_create_array(env, &batch));
+  for (index = 0; index < count; index++) {
+    napi_value value;
+    NODE_API_CALL_RETURN_VOID(
+        env, napi_create_int32(env, *(int*)data[index], &value));
+    NODE_API_CALL_RETURN_VOID(env, napi_set_element(env, batch, index, value));
+  }
+  NODE_API_CALL_RETURN_VOID(env, napi_get_undefined(env, &undefined));
+  NODE_API_CALL_RETURN_VOID(
+      env, napi_call_function(env, undefined, cb, 1, &batch, NULL));
+}
+
+static void Finalize(napi_env env, void* data, void* hint) {
+  napi_ref done_ref = (napi_ref)data;
+  napi_value done, undefined;
+  int index;
+  for (index = 0; index < THREAD_COUNT; index++) {
+    uv_thread_join(&threads[index]);
+  }
+  NODE_API_CALL_RETURN_VOID(env,
+                            napi_get_reference_value(env, done_ref, &done));
+  NODE_API_CALL_RETURN_VOID(env, napi_get_undefined(env, &undefined));
+  NODE_API_CALL_RETURN_VOID(
+      env, napi_call_function(env, undefined, done, 0, NULL, NULL));
+  NODE_API_CALL_RETURN_VOID(env, napi_delete_reference(env, done_ref));
+}
+
+// StartProducers(batchCallback, doneCallback, maxQueueSize, maxBatchSize)
+static napi_value StartProducers(napi_env env, napi_callback_info info) {
+  size_t argc = 4;
+  napi_value argv[4], name;
+  uint32_t max_queue_size, max_batch_size;
+  napi_ref done_ref;
+  napi_threadsafe_function tsfn;
+  int index;
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NODE_API_CALL(env, napi_get_value_uint32(env, argv[2], &max_queue_size));
+  NODE_API_CALL(env, napi_get_value_uint32(env, argv[3], &max_batch_size));
+  NODE_API_CALL(env, napi_create_reference(env, argv[1], 1, &done_ref));
+  NODE_API_CALL(
+      env,
+      napi_create_string_utf8(env, "test_batch", NAPI_AUTO_LENGTH, &name));
+
+  NODE_API_CALL(env,
+                node_api_create_batched_threadsafe_function(env,
+                                                            argv[0],
+                                                            NULL,
+                                                            name,
+                                                            max_queue_size,
+                                                            THREAD_COUNT,
+                                                            done_ref,
+                                                            Finalize,
+                                                            NULL,
+                                                            max_batch_size,
+                                                            CallJsBatch,
+                                                            &tsfn));
+
+  for (index = 0; index < THREAD_COUNT; index++) {
+    producers[index].tsfn = tsfn;
+    producers[index].first = index * ITEMS_PER_THREAD;
+    NODE_API_ASSERT(
+        env,
+        uv_thread_create(&threads[index], Produce, &producers[index]) == 0,
+        "Thread creation");
+  }
+  return NULL;
+}
+
+static napi_value CreateWithoutCallback(napi_env env,
+                                        napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1], name;
+  napi_threadsafe_function tsfn;
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NODE_API_CALL(
+      env,
+      napi_create_string_utf8(env, "test_batch", NAPI_AUTO_LENGTH, &name));
+  NODE_API_CALL(env,
+                node_api_create_batched_threadsafe_function(env,
+                                                            argv[0],
+                                                            NULL,
+                                                            name,
+                                                            0,
+                                                            1,
+                                                            NULL,
+                                                            NULL,
+                                                            NULL,
+                                                            16,
+                                                            NULL,
+                                                            &tsfn));
+  return NULL;
+}
+
+static napi_value Init(napi_env env, napi_value exports) {
+  napi_value thread_count, items_per_thread;
+  int index;
+  for (index = 0; index < THREAD_COUNT * ITEMS_PER_THREAD; index++) {
+    items[index] = index;
+  }
+  NODE_API_CALL(env, napi_create_int32(env, THREAD_COUNT, &thread_count));
+  NODE_API_CALL(env,
+                napi_create_int32(env, ITEMS_PER_THREAD, &items_per_thread));
+
+  napi_property_descriptor properties[] = {
+      DECLARE_NODE_API_PROPERTY_VALUE("THREAD_COUNT", thread_count),
+      DECLARE_NODE_API_PROPERTY_VALUE("ITEMS_PER_THREAD", items_per_thread),
+      DECLARE_NODE_API_PROPERTY("StartProducers", StartProducers),
+      DECLARE_NODE_API_PROPERTY("CreateWithoutCallback",
+                                CreateWithoutCallback),
+  };
+
+  NODE_API_CALL(
+      env,
+      napi_define_properties(env,
+                             exports,
+                             sizeof(properties) / sizeof(properties[0]),
+                             properties));
+
+  return exports;
+}
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,37 @@
+'use strict';
+
+const common = require('../../common');
+const assert = require('assert');
+const binding = require(`./build/${common.buildType}/test_batch`);
+
+const { THREAD_COUNT, ITEMS_PER_THREAD } = binding;
+
+function testBatches(maxQueueSize, maxBatchSize) {
+  return new Promise((resolve) => {
+    const next = new Array(THREAD_COUNT).fill(0);
+    let received = 0;
+    binding.StartProducers((batch) => {
+      assert(Array.isArray(batch));
+      assert(batch.length >= 1 && batch.length <= maxBatchSize);
+      for (const value of batch) {
+        // Each thread's values arrive in the order in which it queued them.
+        const thread = Math.floor(value / ITEMS_PER_THREAD);
+        assert.strictEqual(value % ITEMS_PER_THREAD, next[thread]);
+        next[thread]++;
+      }
+      received += batch.length;
+    }, common.mustCall(() => {
+      assert.strictEqual(received, THREAD_COUNT * ITEMS_PER_THREAD);
+      resolve();
+    }), maxQueueSize, maxBatchSize);
+  });
+}
+
+assert.throws(() => binding.CreateWithoutCallback(() => {}), {
+  message: 'Invalid argument',
+});
+
+testBatches(0, 64)
+  .then(() => testBatches(0, 1))
+  .then(() => testBatches(10, 4))
+  .then(common.mustCall());
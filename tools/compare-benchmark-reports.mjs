@@ -0,0 +1,60 @@
+#!/usr/bin/env node
+
+// Compare two CSV reports of benchmark/run.js --format csv, e.g. the ones
+// that `make bench-napi` writes, and exit with 1 if a benchmark got slower
+// than the baseline by more than the threshold.
+//
+// Usage:
+//   compare-benchmark-reports.mjs [--threshold=<percent>] <baseline> <report>
+
+import fs from 'node:fs';
+import { parseArgs } from 'node:util';
+
+const args = parseArgs({
+  allowPositionals: true,
+  options: { threshold: { type: 'string', default: '10' } },
+});
+
+if (args.positionals.length !== 2) {
+  console.error('Usage: compare-benchmark-reports.mjs ' +
+                '[--threshold=<percent>] <baseline> <report>');
+  process.exit(2);
+}
+const threshold = Number(args.values.threshold);
+
+// Returns the mean rate of every benchmark configuration in the report. A
+// configuration that was run multiple times shows up once per run.
+function readReport(filename) {
+  const line = /^"((?:[^"]|"")*)", "((?:[^"]|"")*)", ([^,]+), ([^,]+)$/;
+  const rates = new Map();
+  for (const row of fs.readFileSync(filename, 'utf8').split('\n')) {
+    const match = line.exec(row.trim());
+    if (match === null || Number.isNaN(Number(match[3]))) continue;
+    const key = `${match[1]} ${match[2]}`.replaceAll('""', '"');
+    const entry = rates.get(key) ?? { sum: 0, count: 0 };
+    entry.sum += Number(match[3]);
+    entry.count++;
+    rates.set(key, entry);
+  }
+  return new Map([...rates].map(([key, { sum, count }]) => [key, sum / count]));
+}
+
+const baseline = readReport(args.positionals[0]);
+const report = readReport(args.positionals[1]);
+
+let regressions = 0;
+for (const [key, rate] of report) {
+  const baselineRate = baseline.get(key);
+  if (baselineRate === undefined) continue;
+  const change = (rate / baselineRate - 1) * 100;
+  const regressed = change < -threshold;
+  if (regressed) regressions++;
+  const mark = regressed ? '!' : ' ';
+  console.log(`${mark} ${change.toFixed(2).padStart(8)}% ${key}`);
+}
+
+if (regressions > 0) {
+  console.error(`${regressions} benchmark(s) regressed by more than ` +
+                `${threshold}%`);
+  process.exit(1);
+}
@@ -107,6 +107,7 @@ def translate_config(out_dir, config, v8_config):
       'node_shared_ngtcp2': 'false',
       'node_shared_openssl': 'false',
       'node_shared_zlib': 'false',
+      'node_shared_zstd': 'false',
     }
   }
   config_gypi['variables'].update(v8_config)
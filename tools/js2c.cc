@@ -16,6 +16,10 @@
 #include "simdutf.h"
 #include "uv.h"
 
+#ifdef NODE_JS2C_COMPRESS_BUILTINS
+#include "brotli/encode.h"
+#endif
+
 #if defined(_WIN32)
 #include <io.h>  // _S_IREAD _S_IWRITE
 #ifndef S_IRUSR
@@ -31,6 +35,12 @@ int Main(int argc, char* argv[]);
 
 static bool is_verbose = false;
 
+#ifdef NODE_JS2C_COMPRESS_BUILTINS
+constexpr bool kCompressBuiltins = true;
+#else
+constexpr bool kCompressBuiltins = false;
+#endif
+
 void Debug(const char* format, ...) {
   va_list arguments;
   va_start(arguments, format);
@@ -428,6 +438,74 @@ constexpr std::string_view array_literal_end = "\n};\n\n";
 // If NODE_JS2C_USE_STRING_LITERALS is defined, the data is output as C++
 // raw strings (i.e. R"JS2C1b732aee(...)JS2C1b732aee") rather than as an
 // array. This speeds up compilation for gcc/clang.
+#ifdef NODE_JS2C_COMPRESS_BUILTINS
+// Definitions with NODE_JS2C_COMPRESS_BUILTINS:
+// static const uint8_t fs_raw[] = {
+//  ....
+// };
+//
+// static CompressedExternalOneByteResource fs_resource(fs_raw, 345, 1234);
+//
+// The data is the Latin-1 or UTF-16LE code units of the source, compressed
+// with Brotli. It is decompressed when the source is first used, see
+// CompressedExternalByteResource.
+template <typename T>
+Fragment GetCompressedDefinition(const std::vector<char>& code,
+                                 const std::string& var,
+                                 size_t count) {
+  constexpr bool is_two_byte = std::is_same_v<T, uint16_t>;
+  std::vector<uint8_t> units;
+  if constexpr (is_two_byte) {
+    std::vector<char16_t> utf16(count);
+    size_t utf16_count = simdutf::convert_utf8_to_utf16(
+        code.data(), code.size(), utf16.data());
+    assert(utf16_count == count);
+    units.reserve(utf16_count * 2);
+    for (size_t i = 0; i < utf16_count; ++i) {
+      units.push_back(static_cast<uint8_t>(utf16[i] & 0xff));
+      units.push_back(static_cast<uint8_t>(utf16[i] >> 8));
+    }
+  } else {
+    units.assign(code.begin(), code.end());
+  }
+
+  size_t compressed_size = BrotliEncoderMaxCompressedSize(units.size());
+  assert(compressed_size != 0);
+  std::vector<uint8_t> compressed(compressed_size);
+  int ok = BrotliEncoderCompress(BROTLI_MAX_QUALITY,
+                                 BROTLI_MAX_WINDOW_BITS,
+                                 BROTLI_MODE_TEXT,
+                                 units.size(),
+                                 units.data(),
+                                 &compressed_size,
+                                 compressed.data());
+  assert(ok == BROTLI_TRUE);
+  Debug("Compressed %zu bytes into %zu\n", units.size(), compressed_size);
+
+  // Avoid using snprintf on large chunks of data because it's much slower.
+  Fragment result(512 + compressed_size * 4, 0);
+  int cur = snprintf(
+      result.data(), result.size(), "static const uint8_t %s_raw[] = {\n",
+      var.c_str());
+  for (size_t i = 0; i < compressed_size; ++i) {
+    const std::string& str = GetCode(compressed[i]);
+    memcpy(result.data() + cur, str.c_str(), str.size());
+    cur += str.size();
+  }
+  cur += snprintf(result.data() + cur,
+                  result.size() - cur,
+                  "\n};\n\nstatic %s %s_resource(%s_raw, %zu, %zu);\n",
+                  is_two_byte ? "CompressedExternalTwoByteResource"
+                              : "CompressedExternalOneByteResource",
+                  var.c_str(),
+                  var.c_str(),
+                  compressed_size,
+                  count);
+  result.resize(cur);
+  return result;
+}
+#endif  // NODE_JS2C_COMPRESS_BUILTINS
+
 enum class CodeType {
   kAscii,   // Code points are all within 0-127
   kLatin1,  // Code points are all within 0-255
@@ -436,13 +514,21 @@ enum class CodeType {
 template <typename T>
 Fragment GetDefinitionImpl(const std::vector<char>& code,
                            const std::string& var,
-                           CodeType type) {
+                           CodeType type,
+                           bool compress) {
   constexpr bool is_two_byte = std::is_same_v<T, uint16_t>;
   static_assert(is_two_byte || std::is_same_v<T, char>);
 
   size_t count = is_two_byte
                      ? simdutf::utf16_length_from_utf8(code.data(), code.size())
                      : code.size();
+#ifdef NODE_JS2C_COMPRESS_BUILTINS
+  if (compress) {
+    return GetCompressedDefinition<T>(code, var, count);
+  }
+#else
+  assert(!compress);
+#endif
   constexpr const char* arr_type = is_two_byte ? "uint16_t" : "uint8_t";
   constexpr const char* resource_type = is_two_byte
                                             ? "StaticExternalTwoByteResource"
@@ -620,13 +706,15 @@ bool Simplify(const std::vector<char>& code,
   return false;
 }
 
-Fragment GetDefinition(const std::string& var, const std::vector<char>& code) {
+Fragment GetDefinition(const std::string& var,
+                       const std::vector<char>& code,
+                       bool compress) {
   Debug("GetDefinition %s, code size %zu\n", var.c_str(), code.size());
   bool is_ascii = simdutf::validate_ascii(code.data(), code.size());
 
   if (is_ascii) {
     Debug("ASCII-only, static size %zu\n", code.size());
-    return GetDefinitionImpl<char>(code, var, CodeType::kAscii);
+    return GetDefinitionImpl<char>(code, var, CodeType::kAscii, compress);
   }
 
   std::vector<char> latin1(code.size());
@@ -637,7 +725,7 @@ Fragment GetDefinition(const std::string& var, const std::vector<char>& code) {
     Debug("Latin-1-only, old size %zu, new size %zu\n",
           code.size(),
           latin1.size());
-    return GetDefinitionImpl<char>(latin1, var, CodeType::kLatin1);
+    return GetDefinitionImpl<char>(latin1, var, CodeType::kLatin1, compress);
   }
 
   // Since V8 only supports Latin-1 and UTF16 as underlying representation
@@ -648,12 +736,12 @@ Fragment GetDefinition(const std::string& var, const std::vector<char>& code) {
   std::vector<char> simplified;
   if (Simplify(code, var, &simplified)) {  // Changed.
     Debug("%s is simplified, re-generate definition\n", var.c_str());
-    return GetDefinition(var, simplified);
+    return GetDefinition(var, simplified, compress);
   }
 
   // Simplification did not turn the code into 1-byte string. Just
   // use the original.
-  return GetDefinitionImpl<uint16_t>(code, var, CodeType::kTwoByte);
+  return GetDefinitionImpl<uint16_t>(code, var, CodeType::kTwoByte, compress);
 }
 
 int AddModule(const std::string& filename,
@@ -674,7 +762,7 @@ int AddModule(const std::string& filename,
   std::string file_id = GetFileId(filename);
   std::string var = GetVariableName(file_id);
 
-  definitions->emplace_back(GetDefinition(var, code));
+  definitions->emplace_back(GetDefinition(var, code, kCompressBuiltins));
 
   // Initializers of the BuiltinSourceMap:
   // {"fs", UnionBytes{&fs_resource}},
@@ -806,7 +894,8 @@ int AddGypi(const std::string& var,
   assert(var == "config");
 
   std::vector<char> transformed = JSONify(code);
-  definitions->emplace_back(GetDefinition(var, transformed));
+  // config.gypi is small and read at startup, so it is never compressed.
+  definitions->emplace_back(GetDefinition(var, transformed, false));
   return 0;
 }
 